@@ -19,6 +19,7 @@ LOCAL_SRC_FILES := \
     AudioController.cpp \
     AudioListener.cpp \
     AudioSource.cpp \
+    BakedAnimation.cpp \
     BoundingBox.cpp \
     BoundingSphere.cpp \
     Bundle.cpp \
@@ -31,17 +32,34 @@ LOCAL_SRC_FILES := \
     DebugNew.cpp \
     DepthStencilTarget.cpp \
     Effect.cpp \
+    EffectWarmup.cpp \
     FileSystem.cpp \
     FlowLayout.cpp \
     Font.cpp \
     Form.cpp \
     FrameBuffer.cpp \
     Frustum.cpp \
+    FrameArena.cpp \
     Game.cpp \
     Gamepad.cpp \
+    FramePacer.cpp \
+    FramePacket.cpp \
+    DynamicResolution.cpp \
+    RenderTargetPool.cpp \
+    FrameGraph.cpp \
+    RenderStats.cpp \
+    Profiler.cpp \
+    GPUProfiler.cpp \
+    LightGrid.cpp \
+    GLStateCache.cpp \
     HeightField.cpp \
+    HotReloader.cpp \
     Image.cpp \
+    InstancedModel.cpp \
 	ImageControl.cpp \
+	Impostor.cpp \
+	IOController.cpp \
+    JobController.cpp \
     Joint.cpp \
     Joystick.cpp \
     Label.cpp \
@@ -56,10 +74,19 @@ LOCAL_SRC_FILES := \
     MeshBatch.cpp \
     MeshPart.cpp \
     MeshSkin.cpp \
+    MemoryPool.cpp \
+    MemoryStats.cpp \
+    Mutex.cpp \
     Model.cpp \
+    MultiView.cpp \
+    NavigationMesh.cpp \
     Node.cpp \
+    OcclusionBuffer.cpp \
+    OcclusionCuller.cpp \
+    OffscreenParticles.cpp \
     ParticleEmitter.cpp \
     Pass.cpp \
+    PerformanceReport.cpp \
     PhysicsCharacter.cpp \
     PhysicsCollisionObject.cpp \
     PhysicsCollisionShape.cpp \
@@ -85,20 +112,31 @@ LOCAL_SRC_FILES := \
     Ref.cpp \
     RenderState.cpp \
     RenderTarget.cpp \
+    RenderQueue.cpp \
     Scene.cpp \
     SceneLoader.cpp \
     ScreenDisplayer.cpp \
     ScriptController.cpp \
     ScriptTarget.cpp \
+    ShadowMap.cpp \
+    Skeleton.cpp \
     Slider.cpp \
+    SpatialHash.cpp \
     SpriteBatch.cpp \
+    StaticBatch.cpp \
+    StringId.cpp \
     Technique.cpp \
     Terrain.cpp \
     TerrainPatch.cpp \
     TextBox.cpp \
     Texture.cpp \
+    TextureAtlas.cpp \
+    TextureStreamer.cpp \
     Theme.cpp \
     ThemeStyle.cpp \
+    TiledTerrain.cpp \
+    TileMap.cpp \
+    TimerWheel.cpp \
     Transform.cpp \
     Vector2.cpp \
     Vector3.cpp \
@@ -106,6 +144,7 @@ LOCAL_SRC_FILES := \
     VertexAttributeBinding.cpp \
     VertexFormat.cpp \
     VerticalLayout.cpp \
+    VirtualList.cpp \
     lua/lua_AbsoluteLayout.cpp \
     lua/lua_AIAgent.cpp \
     lua/lua_AIAgentListener.cpp \
@@ -131,6 +170,7 @@ LOCAL_SRC_FILES := \
     lua/lua_BoundingBox.cpp \
     lua/lua_BoundingSphere.cpp \
     lua/lua_Bundle.cpp \
+    lua/lua_BundleAsyncLoad.cpp \
     lua/lua_Button.cpp \
     lua/lua_Camera.cpp \
     lua/lua_CameraType.cpp \
@@ -23,8 +23,16 @@ varying vec2 v_texCoord;
 #endif
 
 
+#if defined(LOD_FADE)
+#include "lod-fade.frag"
+#endif
+
 void main()
 {
+    #if defined(LOD_FADE)
+    applyLodFade();
+    #endif
+
     // Set base diffuse color
     #if defined(VERTEX_COLOR)
 	gl_FragColor.rgb = v_color;
@@ -41,6 +41,9 @@ varying vec3 v_lightDirection;					// Direction of light in tangent space
 #if defined(SPECULAR)
 varying vec3 v_cameraDirection;                 // Camera direction
 #endif
+#if defined(TILED_LIGHTING)
+varying vec3 v_positionViewSpace;				// Position in view space
+#endif
 
 // Lighting
 #include "lighting.frag"
@@ -51,9 +54,20 @@ varying vec3 v_cameraDirection;                 // Camera direction
 #else
 #include "lighting-directional.frag"
 #endif
+#if defined(TILED_LIGHTING)
+#include "lighting-tiled.frag"
+#endif
+
+#if defined(LOD_FADE)
+#include "lod-fade.frag"
+#endif
 
 void main()
 {
+    #if defined(LOD_FADE)
+    applyLodFade();
+    #endif
+
     // Set base diffuse color
     #if defined(VERTEX_COLOR)
 	_baseColor.rgb = v_color;
@@ -64,6 +78,13 @@ void main()
     // Light the pixel
     gl_FragColor.a = _baseColor.a;
     gl_FragColor.rgb = getLitPixel();
+    #if defined(TILED_LIGHTING)
+    #if defined(SPECULAR)
+    gl_FragColor.rgb += computeTiledLighting(normalize(v_normalVector), v_positionViewSpace, normalize(v_cameraDirection));
+    #else
+    gl_FragColor.rgb += computeTiledLighting(normalize(v_normalVector), v_positionViewSpace);
+    #endif
+    #endif
     
 	#if defined(MODULATE_COLOR)
     gl_FragColor *= u_modulateColor;
@@ -13,12 +13,23 @@ varying vec3 v_color;										// Output Vertex Color
 #endif
 
 // Uniforms
+#if defined(INSTANCED)
+#include "instancing.vert"
+#else
 uniform mat4 u_worldViewProjectionMatrix;					// Matrix to transform a position to clip space.
 uniform mat4 u_inverseTransposeWorldViewMatrix;				// Matrix to transform a normal to view space
 uniform mat4 u_worldViewMatrix;								// Matrix to tranform a position to view space.
+#if defined(SHADOWS)
+uniform mat4 u_worldMatrix;									// Matrix to tranform a position to world space
+#endif
+#endif
 #if defined(SKINNING)
+#if defined(SKINNING_DUAL_QUATERNION)
+uniform vec4 u_dualQuaternionPalette[SKINNING_JOINT_COUNT * 2];	// Array of dual quaternions (real, dual)
+#else
 uniform vec4 u_matrixPalette[SKINNING_JOINT_COUNT * 3];		// Array of 4x3 matrices
 #endif
+#endif
 #if defined(SPECULAR)
 uniform vec3 u_cameraPosition;                 				// Position of the camera in view space.
 #endif
@@ -36,6 +47,9 @@ varying vec3 v_normalVector;								// Normal vector in view space.
 #if defined(SPECULAR)
 varying vec3 v_cameraDirection;								// Direction the camera is looking at in tangent space.
 #endif
+#if defined(TILED_LIGHTING)
+varying vec3 v_positionViewSpace;							// Position in view space.
+#endif
 
 // Lighting
 #if defined(POINT_LIGHT)
@@ -54,10 +68,17 @@ uniform vec3 u_lightDirection;								// Direction of light
 // Skinning
 #if defined(SKINNING)
 #include "skinning.vert"
+#elif defined(VERTEX_ANIMATION)
+#include "vertex-animation.vert"
 #else
 #include "skinning-none.vert" 
 #endif
 
+// Shadows
+#if defined(SHADOWS)
+#include "shadow.vert"
+#endif
+
 
 void main()
 {
@@ -74,6 +95,12 @@ void main()
 
     // Apply light.
     applyLight(position);
+    #if defined(SHADOWS)
+    applyShadow(position);
+    #endif
+    #if defined(TILED_LIGHTING)
+    v_positionViewSpace = (u_worldViewMatrix * position).xyz;
+    #endif
     
     // Pass the vertex color to fragment shader
     #if defined(VERTEX_COLOR)
@@ -0,0 +1,10 @@
+#ifdef OPENGL_ES
+precision mediump float;
+#endif
+
+
+void main()
+{
+    // Only the depth of the fragment is written, color writes are disabled.
+    gl_FragColor = vec4(0.0);
+}
@@ -1,3 +1,7 @@
+#if defined(DISTANCE_FIELD) && defined(OPENGL_ES) && defined(GL_OES_standard_derivatives)
+#extension GL_OES_standard_derivatives : enable
+#endif
+
 #ifdef OPENGL_ES
 precision highp float;
 #endif
@@ -13,5 +17,17 @@ varying vec4 v_color;
 void main()
 {
     gl_FragColor = v_color;
+#ifdef DISTANCE_FIELD
+    // The texture holds the distance to the glyph outline, with the outline at 0.5.
+    // Smooth the edge over about one pixel, whatever size the text is drawn at.
+    float distance = texture2D(u_texture, v_texCoord).a;
+    #if !defined(OPENGL_ES) || defined(GL_OES_standard_derivatives)
+    float smoothing = 0.7 * fwidth(distance);
+    #else
+    float smoothing = 0.1;
+    #endif
+    gl_FragColor.a = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance) * v_color.a;
+#else
     gl_FragColor.a = texture2D(u_texture, v_texCoord).a * v_color.a;
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,19 @@
+#ifdef OPENGL_ES
+precision highp float;
+#endif
+
+// Uniforms
+uniform sampler2D u_texture;
+
+// Varyings
+varying vec2 v_texCoord;
+
+
+void main()
+{
+    gl_FragColor = texture2D(u_texture, v_texCoord);
+
+    // The images are cut out rather than blended, so the instances need no sorting.
+    if (gl_FragColor.a < 0.5)
+        discard;
+}
@@ -0,0 +1,16 @@
+// Attributes
+attribute vec3 a_position;
+attribute vec2 a_texCoord;
+
+// Uniforms
+uniform mat4 u_viewProjectionMatrix;
+
+// Varyings
+varying vec2 v_texCoord;
+
+
+void main()
+{
+    gl_Position = u_viewProjectionMatrix * vec4(a_position, 1);
+    v_texCoord = a_texCoord;
+}
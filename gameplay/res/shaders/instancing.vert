@@ -0,0 +1,12 @@
+// Instanced world matrix. This replaces the per-object world matrix uniforms
+// so that shared geometry can be drawn for many instances in one draw call.
+// The inverse transpose is approximated by the world view matrix, which assumes
+// instances are only scaled uniformly.
+attribute mat4 a_instanceMatrix;							// Instance world matrix
+uniform mat4 u_viewProjectionMatrix;						// Matrix to transform a world position to clip space
+uniform mat4 u_viewMatrix;									// Matrix to transform a world position to view space
+
+#define u_worldMatrix a_instanceMatrix
+#define u_worldViewMatrix (u_viewMatrix * a_instanceMatrix)
+#define u_worldViewProjectionMatrix (u_viewProjectionMatrix * a_instanceMatrix)
+#define u_inverseTransposeWorldViewMatrix (u_viewMatrix * a_instanceMatrix)
@@ -1,3 +1,10 @@
+#if defined(SHADOWS)
+#include "shadow.frag"
+#define DIRECTIONAL_LIGHT_ATTENUATION getShadowAttenuation()
+#else
+#define DIRECTIONAL_LIGHT_ATTENUATION 1.0
+#endif
+
 #if defined(BUMPED)
 
 vec3 getLitPixel()
@@ -9,11 +16,11 @@ vec3 getLitPixel()
     #if defined(SPECULAR)
     
     vec3 cameraDirection = normalize(v_cameraDirection);
-    return computeLighting(normalVector, -lightDirection, 1.0, cameraDirection);
+    return computeLighting(normalVector, -lightDirection, DIRECTIONAL_LIGHT_ATTENUATION, cameraDirection);
     
     #else
     
-    return computeLighting(normalVector, -lightDirection, 1.0);
+    return computeLighting(normalVector, -lightDirection, DIRECTIONAL_LIGHT_ATTENUATION);
     
     #endif
 }
@@ -29,11 +36,11 @@ vec3 getLitPixel()
     #if defined(SPECULAR)
     
     vec3 cameraDirection = normalize(v_cameraDirection);
-    return computeLighting(normalVector, -lightDirection, 1.0, cameraDirection);
+    return computeLighting(normalVector, -lightDirection, DIRECTIONAL_LIGHT_ATTENUATION, cameraDirection);
     
     #else
     
-    return computeLighting(normalVector, -lightDirection, 1.0);
+    return computeLighting(normalVector, -lightDirection, DIRECTIONAL_LIGHT_ATTENUATION);
     
     #endif
 }
@@ -0,0 +1,67 @@
+// Tiled forward lighting.
+// The lights of the tile containing the fragment are listed in u_tileLightTexture, one
+// texel per light holding its index plus one, ending at the first zero. The lights are
+// stored in u_lightTexture, three texels per row:
+//   0: view space position (xyz), inverse range (w)
+//   1: color (rgb), cosine of the inner spot angle (a)
+//   2: view space spot direction (xyz), cosine of the outer spot angle (w)
+// Point lights have a zero direction and cosines that never limit the light.
+
+#ifndef TILE_LIGHT_COUNT
+#define TILE_LIGHT_COUNT 16
+#endif
+
+uniform sampler2D u_lightTexture;				// Light buffer
+uniform sampler2D u_tileLightTexture;			// Light indices of each tile
+uniform vec2 u_lightGridOrigin;					// Viewport origin in pixels
+uniform vec2 u_lightGridSize;					// Number of tiles in x and y
+uniform float u_lightGridTileSize;				// Size of a tile in pixels
+uniform float u_lightTextureHeight;				// Number of rows in the light buffer
+
+#if defined(SPECULAR)
+vec3 computeTiledLighting(vec3 normalVector, vec3 position, vec3 cameraDirection)
+#else
+vec3 computeTiledLighting(vec3 normalVector, vec3 position)
+#endif
+{
+    vec2 tile = floor((gl_FragCoord.xy - u_lightGridOrigin) / u_lightGridTileSize);
+    tile = clamp(tile, vec2(0.0), u_lightGridSize - 1.0);
+    float tileRow = (tile.y + 0.5) / u_lightGridSize.y;
+    float tileColumnScale = 1.0 / (u_lightGridSize.x * float(TILE_LIGHT_COUNT));
+
+    vec3 color = vec3(0.0);
+    for (int i = 0; i < TILE_LIGHT_COUNT; ++i)
+    {
+        float column = tile.x * float(TILE_LIGHT_COUNT) + float(i) + 0.5;
+        float index = floor(texture2D(u_tileLightTexture, vec2(column * tileColumnScale, tileRow)).a * 255.0 + 0.5);
+        if (index < 1.0)
+            break;
+
+        float row = (index - 0.5) / u_lightTextureHeight;
+        vec4 lightPosition = texture2D(u_lightTexture, vec2(0.5 / 3.0, row));
+        vec4 lightColor = texture2D(u_lightTexture, vec2(1.5 / 3.0, row));
+        vec4 lightDirection = texture2D(u_lightTexture, vec2(2.5 / 3.0, row));
+
+        // Range attenuation, as for a point light
+        vec3 vertexToLight = lightPosition.xyz - position;
+        vec3 scaled = vertexToLight * lightPosition.w;
+        float attenuation = clamp(1.0 - dot(scaled, scaled), 0.0, 1.0);
+        vec3 direction = normalize(vertexToLight);
+
+        // Spot cone
+        float spotCos = dot(lightDirection.xyz, -direction);
+        attenuation *= clamp((spotCos - lightDirection.w) / max(lightColor.a - lightDirection.w, 0.0001), 0.0, 1.0);
+
+        // Diffuse
+        float diffuseIntensity = max(0.0, dot(normalVector, direction)) * attenuation;
+        color += lightColor.rgb * _baseColor.rgb * diffuseIntensity;
+
+        // Specular
+        #if defined(SPECULAR)
+        vec3 halfVector = normalize(direction + cameraDirection);
+        float specularIntensity = attenuation * max(0.0, pow(max(0.0, dot(normalVector, halfVector)), u_specularExponent));
+        color += lightColor.rgb * _baseColor.rgb * specularIntensity;
+        #endif
+    }
+    return color;
+}
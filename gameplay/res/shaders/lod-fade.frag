@@ -0,0 +1,10 @@
+uniform float u_lodFade;                        // Level of detail cross-fade, > 0 fading in, < 0 fading out
+
+// Discards the pixels of a level of detail that is fading, with a dither pattern that is
+// the complement of the pattern of the level fading the other way.
+void applyLodFade()
+{
+    float dither = fract(52.9829189 * fract(dot(gl_FragCoord.xy, vec2(0.06711056, 0.00583715))));
+    if ((u_lodFade > 0.0 && dither >= u_lodFade) || (u_lodFade < 0.0 && dither < -u_lodFade))
+        discard;
+}
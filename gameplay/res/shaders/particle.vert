@@ -0,0 +1,63 @@
+#ifndef FRAME_COUNT_MAX
+#define FRAME_COUNT_MAX 32
+#endif
+
+// Attributes
+attribute vec4 a_position;          // xyz: initial position, w: emission time
+attribute vec4 a_velocity;          // xyz: initial velocity, w: energy
+attribute vec4 a_acceleration;      // xyz: acceleration, w: initial angle
+attribute vec4 a_colorStart;
+attribute vec4 a_colorEnd;
+attribute vec4 a_size;              // x: start size, y: end size, z: angular speed, w: initial frame
+attribute vec2 a_corner;            // Corner of the billboard, from (-0.5, -0.5) to (0.5, 0.5)
+
+// Uniforms
+uniform mat4 u_viewProjectionMatrix;
+uniform vec3 u_cameraRight;
+uniform vec3 u_cameraUp;
+uniform float u_time;
+uniform vec4 u_frameCoords[FRAME_COUNT_MAX];
+uniform vec4 u_frameAnimation;      // x: frame count, y: frame duration, z: lifetime per frame, w: 0 static, 1 looped, 2 once
+
+// Varyings
+varying vec2 v_texCoord;
+varying vec4 v_color;
+
+
+void main()
+{
+    float age = u_time - a_position.w;
+    float energy = a_velocity.w;
+    if (age < 0.0 || age >= energy)
+    {
+        // Dead and unused particles collapse to a point outside the clip volume.
+        gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+        v_texCoord = vec2(0.0);
+        v_color = vec4(0.0);
+        return;
+    }
+
+    float percent = age / energy;
+    vec3 position = a_position.xyz + (a_velocity.xyz + 0.5 * a_acceleration.xyz * age) * age;
+    float size = mix(a_size.x, a_size.y, percent);
+
+    // Rotate the billboard around its center in the plane facing the camera.
+    float angle = a_acceleration.w + a_size.z * age;
+    float c = cos(angle);
+    float s = sin(angle);
+    vec2 corner = vec2(c * a_corner.x - s * a_corner.y, s * a_corner.x + c * a_corner.y) * size;
+    gl_Position = u_viewProjectionMatrix * vec4(position + u_cameraRight * corner.x + u_cameraUp * corner.y, 1.0);
+
+    float frame = a_size.w;
+    if (u_frameAnimation.w == 1.0)
+    {
+        frame = mod(frame + floor(age / u_frameAnimation.y), u_frameAnimation.x);
+    }
+    else if (u_frameAnimation.w == 2.0)
+    {
+        frame = min(frame + floor(percent / u_frameAnimation.z), u_frameAnimation.x - 1.0);
+    }
+    vec4 coords = u_frameCoords[int(frame)];
+    v_texCoord = mix(coords.xy, coords.zw, a_corner + 0.5);
+    v_color = mix(a_colorStart, a_colorEnd, percent);
+}
@@ -0,0 +1,12 @@
+#ifdef OPENGL_ES
+precision highp float;
+#endif
+
+
+void main()
+{
+    // The depth of the fragment is packed into the channels of the color, 8 bits each, since
+    // shadow maps are color textures. The carry of each channel is removed from the next one.
+    vec4 depth = fract(gl_FragCoord.z * vec4(256.0 * 256.0 * 256.0, 256.0 * 256.0, 256.0, 1.0));
+    gl_FragColor = depth - depth.xxyz * vec4(0.0, 1.0 / 256.0, 1.0 / 256.0, 1.0 / 256.0);
+}
@@ -0,0 +1,31 @@
+// Shadows of a directional light (see ShadowMap).
+uniform sampler2D u_shadowMap;                              // Atlas of the cascades: static casters on the left, dynamic on the right
+uniform mat4 u_shadowMatrix[SHADOW_CASCADE_COUNT];          // Matrices to transform a world position to the static map of each cascade
+uniform float u_shadowSplits[SHADOW_CASCADE_COUNT];         // Distance from the camera at which each cascade ends
+uniform vec4 u_shadowViewPlane;                             // Plane of the camera, to compute the distance of a world position from it
+uniform float u_shadowBias;                                 // Bias subtracted from the depth of the pixel
+
+varying vec3 v_positionWorldSpace;                          // Position in world space
+
+float unpackShadowDepth(vec4 color)
+{
+    return dot(color, vec4(1.0 / (256.0 * 256.0 * 256.0), 1.0 / (256.0 * 256.0), 1.0 / 256.0, 1.0));
+}
+
+// Returns 0 if the pixel is in the shadow of a caster of either map of its cascade, or 1.
+float getShadowAttenuation()
+{
+    vec4 position = vec4(v_positionWorldSpace, 1.0);
+    float distance = dot(u_shadowViewPlane, position);
+    for (int i = 0; i < SHADOW_CASCADE_COUNT; ++i)
+    {
+        if (distance < u_shadowSplits[i])
+        {
+            vec3 coord = (u_shadowMatrix[i] * position).xyz;
+            float staticDepth = unpackShadowDepth(texture2D(u_shadowMap, coord.xy));
+            float dynamicDepth = unpackShadowDepth(texture2D(u_shadowMap, coord.xy + vec2(0.5, 0.0)));
+            return coord.z - u_shadowBias > min(staticDepth, dynamicDepth) ? 0.0 : 1.0;
+        }
+    }
+    return 1.0;
+}
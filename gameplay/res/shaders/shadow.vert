@@ -0,0 +1,8 @@
+// Shadows of a directional light (see ShadowMap). The position of the vertex is passed in
+// world space, where the fragment shader transforms it to the maps of the cascades.
+varying vec3 v_positionWorldSpace;							// Position in world space
+
+void applyShadow(vec4 position)
+{
+    v_positionWorldSpace = (u_worldMatrix * position).xyz;
+}
@@ -1,3 +1,74 @@
+#if defined(SKINNING_DUAL_QUATERNION)
+
+vec4 _skinnedReal;
+vec4 _skinnedDual;
+
+void blendDualQuaternion(float blendWeight, int index, vec4 firstReal)
+{
+    vec4 real = u_dualQuaternionPalette[index];
+    vec4 dual = u_dualQuaternionPalette[index + 1];
+
+    // Blend the shortest way around, since q and -q are the same rotation.
+    if (dot(real, firstReal) < 0.0)
+        blendWeight = -blendWeight;
+    _skinnedReal += blendWeight * real;
+    _skinnedDual += blendWeight * dual;
+}
+
+vec4 getPosition()
+{
+    // Blend the dual quaternions of the four joints, used for the position and the vectors.
+    vec4 firstReal = u_dualQuaternionPalette[int(a_blendIndices[0]) * 2];
+    _skinnedReal = vec4(0.0);
+    _skinnedDual = vec4(0.0);
+    blendDualQuaternion(a_blendWeights[0], int(a_blendIndices[0]) * 2, firstReal);
+    blendDualQuaternion(a_blendWeights[1], int(a_blendIndices[1]) * 2, firstReal);
+    blendDualQuaternion(a_blendWeights[2], int(a_blendIndices[2]) * 2, firstReal);
+    blendDualQuaternion(a_blendWeights[3], int(a_blendIndices[3]) * 2, firstReal);
+
+    float len = length(_skinnedReal);
+    _skinnedReal /= len;
+    _skinnedDual /= len;
+
+    // Rotate by the real part, then translate by 2 * dual * conjugate(real).
+    vec3 p = a_position.xyz;
+    vec3 r = _skinnedReal.xyz;
+    p += 2.0 * cross(r, cross(r, p) + _skinnedReal.w * p);
+    p += 2.0 * (_skinnedReal.w * _skinnedDual.xyz - _skinnedDual.w * r + cross(r, _skinnedDual.xyz));
+    return vec4(p, a_position.w);
+}
+
+#if defined(LIGHTING)
+
+vec3 getTangentSpaceVector(vec3 vector)
+{
+    // Vectors are only rotated, by the dual quaternion blended in getPosition().
+    vec3 r = _skinnedReal.xyz;
+    return vector + 2.0 * cross(r, cross(r, vector) + _skinnedReal.w * vector);
+}
+
+vec3 getNormal()
+{
+    return getTangentSpaceVector(a_normal);
+}
+
+#if defined(BUMPED)
+
+vec3 getTangent()
+{
+    return getTangentSpaceVector(a_tangent);
+}
+
+vec3 getBinormal()
+{
+    return getTangentSpaceVector(a_binormal);
+}
+
+#endif
+#endif
+
+#else
+
 vec4 _skinnedPosition;
 #if defined(LIGHTING)
 vec3 _skinnedNormal;
@@ -90,4 +161,6 @@ vec3 getBinormal()
 }
 
 #endif
-#endif
\ No newline at end of file
+#endif
+
+#endif
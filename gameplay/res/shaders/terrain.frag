@@ -10,7 +10,13 @@ uniform vec3 u_lightDirection;					// Light direction
 uniform float u_row;                            // Patch row
 uniform float u_column;                         // Patch column
 #endif
+#if defined(SPLAT_MAP)
 #if (LAYER_COUNT > 0)
+uniform sampler2D u_splatMap;                   // Blend weights of layers 1 to 4
+uniform sampler2D u_layerSamplers[LAYER_COUNT]; // Surface layer samplers
+uniform vec2 u_layerRepeats[LAYER_COUNT];       // Surface layer repeat counts
+#endif
+#elif (LAYER_COUNT > 0)
 uniform sampler2D u_samplers[SAMPLER_COUNT];    // Surface layer samplers
 #endif
 #if defined (NORMAL_MAP)
@@ -24,6 +30,7 @@ vec3 v_normalVector;                            // Normal vector variable (from
 varying vec3 v_normalVector;					// Normal vector from vertex shader
 #endif
 varying vec2 v_texCoord0;
+#if !defined(SPLAT_MAP)
 #if (LAYER_COUNT > 0)
 varying vec2 v_texCoordLayer0;
 #endif
@@ -33,6 +40,7 @@ varying vec2 v_texCoordLayer1;
 #if (LAYER_COUNT > 2)
 varying vec2 v_texCoordLayer2;
 #endif
+#endif
 
 // Lighting
 #include "lighting.frag"
@@ -50,7 +58,24 @@ void blendLayer(sampler2D textureMap, vec2 texCoord, float alphaBlend)
 
 void main()
 {
-#if (LAYER_COUNT > 0)
+#if defined(SPLAT_MAP) && (LAYER_COUNT > 0)
+    // Sample base texture, and blend the other layers over it by the channels of the splat map
+    _baseColor.rgb = texture2D(u_layerSamplers[0], mod(v_texCoord0 * u_layerRepeats[0], vec2(1,1))).rgb;
+    _baseColor.a = 1.0;
+#if (LAYER_COUNT > 1)
+    vec4 weights = texture2D(u_splatMap, v_texCoord0);
+    blendLayer(u_layerSamplers[1], v_texCoord0 * u_layerRepeats[1], weights.r);
+#endif
+#if (LAYER_COUNT > 2)
+    blendLayer(u_layerSamplers[2], v_texCoord0 * u_layerRepeats[2], weights.g);
+#endif
+#if (LAYER_COUNT > 3)
+    blendLayer(u_layerSamplers[3], v_texCoord0 * u_layerRepeats[3], weights.b);
+#endif
+#if (LAYER_COUNT > 4)
+    blendLayer(u_layerSamplers[4], v_texCoord0 * u_layerRepeats[4], weights.a);
+#endif
+#elif (LAYER_COUNT > 0)
     // Sample base texture
 	_baseColor.rgb = texture2D(u_samplers[TEXTURE_INDEX_0], mod(v_texCoordLayer0, vec2(1,1))).rgb;
     _baseColor.a = 1.0;
@@ -59,10 +84,10 @@ void main()
     _baseColor = vec4(1,1,1,1);
 #endif
 
-#if (LAYER_COUNT > 1)
+#if !defined(SPLAT_MAP) && (LAYER_COUNT > 1)
     blendLayer(u_samplers[TEXTURE_INDEX_1], v_texCoordLayer1, texture2D(u_samplers[BLEND_INDEX_1], v_texCoord0)[BLEND_CHANNEL_1]);
 #endif
-#if (LAYER_COUNT > 2)
+#if !defined(SPLAT_MAP) && (LAYER_COUNT > 2)
     blendLayer(u_samplers[TEXTURE_INDEX_2], v_texCoordLayer2, texture2D(u_samplers[BLEND_INDEX_2], v_texCoord0)[BLEND_CHANNEL_2]);
 #endif
 
@@ -1,9 +1,9 @@
 // Attributes
-attribute vec4 a_position;									// Vertex Position							(x, y, z, w)
+attribute vec4 a_position;									// Grid position and quantized heights		(x, height, z, morph height)
 #ifndef NORMAL_MAP
-attribute vec3 a_normal;									// Vertex Normal							(x, y, z)
+attribute vec2 a_normal;									// Octahedral encoded normal				(x, z)
 #endif
-attribute vec2 a_texCoord0;
+attribute vec4 a_texCoord2;									// Edge of the patch the vertex lies on		(x1, x2, z1, z2)
 
 // Uniforms
 uniform mat4 u_worldViewProjectionMatrix;					// World view projection matrix
@@ -11,12 +11,17 @@ uniform mat4 u_worldViewProjectionMatrix;					// World view projection matrix
 uniform mat4 u_normalMatrix;					            // Matrix used for normal vector transformation
 #endif
 uniform vec3 u_lightDirection;								// Direction of light
+uniform float u_morph;										// Morph factor towards the next coarser level
+uniform vec4 u_edgeMorph;									// Morph factors of the patch edges			(x1, x2, z1, z2)
+uniform vec4 u_grid;										// Grid offset and texture coordinate scale	(x, z, u, v)
+uniform vec2 u_heightRange;									// Minimum height and quantized height step
 
 // Varyings
 #ifndef NORMAL_MAP
 varying vec3 v_normalVector;								// Normal vector out
 #endif
 varying vec2 v_texCoord0;
+#if !defined(SPLAT_MAP)
 #if LAYER_COUNT > 0
 varying vec2 v_texCoordLayer0;
 #endif
@@ -26,28 +31,43 @@ varying vec2 v_texCoordLayer1;
 #if LAYER_COUNT > 2
 varying vec2 v_texCoordLayer2;
 #endif
+#endif
 
 void main()
 {
+    // Morph the vertex towards the next coarser level. Vertices on the edges of the patch use
+    // the morph factor of their edge, which the neighbouring patch uses as well.
+    float edge = dot(a_texCoord2, vec4(1.0, 1.0, 1.0, 1.0));
+    float morph = mix(u_morph, dot(a_texCoord2, u_edgeMorph), edge);
+    vec4 position = vec4(a_position.x + u_grid.x, u_heightRange.x + mix(a_position.y, a_position.w, morph) * u_heightRange.y, a_position.z + u_grid.y, 1.0);
+
     // Transform position to clip space.
-    gl_Position = u_worldViewProjectionMatrix * a_position;
+    gl_Position = u_worldViewProjectionMatrix * position;
 
 #ifndef NORMAL_MAP
-    // Pass normal to fragment shader
-    v_normalVector = (u_normalMatrix * vec4(a_normal.x, a_normal.y, a_normal.z, 0)).xyz;
+    // Decode the normal and pass it to fragment shader
+    vec3 normal = vec3(a_normal.x, 1.0 - abs(a_normal.x) - abs(a_normal.y), a_normal.y);
+    float fold = max(-normal.y, 0.0);
+    normal.x += normal.x >= 0.0 ? -fold : fold;
+    normal.z += normal.z >= 0.0 ? -fold : fold;
+    v_normalVector = (u_normalMatrix * vec4(normalize(normal), 0)).xyz;
 #endif
 
-    // Pass base texture coord
-    v_texCoord0 = a_texCoord0;
+    // Pass base texture coord, which is derived from the grid position
+    vec2 texCoord0 = vec2(a_position.x * u_grid.z, 1.0 - a_position.z * u_grid.w);
+    v_texCoord0 = texCoord0;
 
-    // Pass repeated texture coordinates for each layer
+    // Pass repeated texture coordinates for each layer. With a splat map, the layers are
+    // repeated in the fragment shader, since their repeat counts are uniforms.
+#if !defined(SPLAT_MAP)
 #if LAYER_COUNT > 0
-    v_texCoordLayer0 = a_texCoord0 * TEXTURE_REPEAT_0;
+    v_texCoordLayer0 = texCoord0 * TEXTURE_REPEAT_0;
 #endif
 #if LAYER_COUNT > 1
-    v_texCoordLayer1 = a_texCoord0 * TEXTURE_REPEAT_1;
+    v_texCoordLayer1 = texCoord0 * TEXTURE_REPEAT_1;
 #endif
 #if LAYER_COUNT > 2
-    v_texCoordLayer2 = a_texCoord0 * TEXTURE_REPEAT_2;
+    v_texCoordLayer2 = texCoord0 * TEXTURE_REPEAT_2;
+#endif
 #endif
 }
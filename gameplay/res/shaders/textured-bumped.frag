@@ -53,8 +53,16 @@ varying vec3 v_cameraDirection;                 // Camera direction
 #endif
 
 
+#if defined(LOD_FADE)
+#include "lod-fade.frag"
+#endif
+
 void main()
 {
+    #if defined(LOD_FADE)
+    applyLodFade();
+    #endif
+
     // Fetch diffuse color from texture.
     _baseColor = texture2D(u_diffuseTexture, v_texCoord);
 
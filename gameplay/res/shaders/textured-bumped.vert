@@ -13,15 +13,25 @@ attribute vec4 a_blendIndices;								// Vertex blend index int u_matrixPalette
 #endif
 
 // Uniforms
+#if defined(INSTANCED)
+#include "instancing.vert"
+#else
 uniform mat4 u_worldViewProjectionMatrix;					// Matrix to transform a position to clip space
 uniform mat4 u_inverseTransposeWorldViewMatrix;				// Matrix to transform a normal to view space
 #if defined(SPECULAR) || defined(SPOT_LIGHT) || defined(POINT_LIGHT)
 uniform mat4 u_worldViewMatrix;								// Matrix to tranform a position to view space
+#endif
+#if defined(SPECULAR) || defined(SPOT_LIGHT) || defined(POINT_LIGHT) || defined(SHADOWS)
 uniform mat4 u_worldMatrix;								    // Matrix to tranform a position to world space
 #endif
+#endif
 #if defined(SKINNING)
+#if defined(SKINNING_DUAL_QUATERNION)
+uniform vec4 u_dualQuaternionPalette[SKINNING_JOINT_COUNT * 2];	// Array of dual quaternions (real, dual)
+#else
 uniform vec4 u_matrixPalette[SKINNING_JOINT_COUNT * 3];		// Array of 4x3 matrices
 #endif
+#endif
 #if defined(SPECULAR)
 uniform vec3 u_cameraPosition;                 				// Position of the camera in view space
 #endif
@@ -71,6 +81,11 @@ varying vec3 v_lightDirection;								// Direction of light
 #include "skinning-none.vert" 
 #endif
 
+// Shadows
+#if defined(SHADOWS)
+#include "shadow.vert"
+#endif
+
 
 void main()
 {
@@ -94,6 +109,9 @@ void main()
     
     // Apply light.
     applyLight(tangentSpaceTransformMatrix);
+    #if defined(SHADOWS)
+    applyShadow(position);
+    #endif
     
     // Texture transformation.
     v_texCoord = a_texCoord;
@@ -21,8 +21,16 @@ varying vec2 v_texCoord1;                   // Second tex coord for multi-textur
 #endif
 
 
+#if defined(LOD_FADE)
+#include "lod-fade.frag"
+#endif
+
 void main()
 {
+    #if defined(LOD_FADE)
+    applyLodFade();
+    #endif
+
     // Sample the texture for the color
     gl_FragColor = texture2D(u_diffuseTexture, v_texCoord0);
     #if defined(TEXTURE_DISCARD_ALPHA)
@@ -10,10 +10,18 @@ attribute vec4 a_blendIndices;								// Vertex blend index int u_matrixPalette
 #endif
 
 // Uniforms
+#if defined(INSTANCED)
+#include "instancing.vert"
+#else
 uniform mat4 u_worldViewProjectionMatrix;					// Matrix to transform a position to clip space
+#endif
 #if defined(SKINNING)
+#if defined(SKINNING_DUAL_QUATERNION)
+uniform vec4 u_dualQuaternionPalette[SKINNING_JOINT_COUNT * 2];	// Array of dual quaternions (real, dual)
+#else
 uniform vec4 u_matrixPalette[SKINNING_JOINT_COUNT * 3];		// Array of 4x3 matrices
 #endif
+#endif
 #if defined(TEXTURE_REPEAT)
 uniform vec2 u_textureRepeat;								// Texture repeat for tiling
 #endif
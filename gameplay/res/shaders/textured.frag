@@ -35,6 +35,9 @@ varying vec3 v_lightDirection;					// Direction of light in tangent space.
 #if defined(SPECULAR)
 varying vec3 v_cameraDirection;                 // Camera direction
 #endif
+#if defined(TILED_LIGHTING)
+varying vec3 v_positionViewSpace;				// Position in view space
+#endif
 
 // Lighting 
 #include "lighting.frag"
@@ -48,10 +51,21 @@ uniform vec3 u_spotLightDirection;              // Direction of a spot light sou
 #else
 #include "lighting-directional.frag"
 #endif
+#if defined(TILED_LIGHTING)
+#include "lighting-tiled.frag"
+#endif
 
 
+#if defined(LOD_FADE)
+#include "lod-fade.frag"
+#endif
+
 void main()
 {
+    #if defined(LOD_FADE)
+    applyLodFade();
+    #endif
+
     // Sample the diffuse texture for base color
     _baseColor = texture2D(u_diffuseTexture, v_texCoord);
 
@@ -62,6 +76,13 @@ void main()
         discard;
     #endif
     gl_FragColor.rgb = getLitPixel();
+    #if defined(TILED_LIGHTING)
+    #if defined(SPECULAR)
+    gl_FragColor.rgb += computeTiledLighting(normalize(v_normalVector), v_positionViewSpace, normalize(v_cameraDirection));
+    #else
+    gl_FragColor.rgb += computeTiledLighting(normalize(v_normalVector), v_positionViewSpace);
+    #endif
+    #endif
 	
 	// Global color modulation
 	#if defined(MODULATE_COLOR)
@@ -10,14 +10,25 @@ attribute vec4 a_blendIndices;								// Vertex blend index int u_matrixPalette
 #endif
 
 // Uniforms
+#if defined(INSTANCED)
+#include "instancing.vert"
+#else
 uniform mat4 u_worldViewProjectionMatrix;					// Matrix to transform a position to clip space
 uniform mat4 u_inverseTransposeWorldViewMatrix;				// Matrix to transform a normal to view space
-#if defined(SPECULAR) || defined(SPOT_LIGHT) || defined(POINT_LIGHT)
+#if defined(SPECULAR) || defined(SPOT_LIGHT) || defined(POINT_LIGHT) || defined(TILED_LIGHTING)
 uniform mat4 u_worldViewMatrix;								// Matrix to tranform a position to view space
 #endif
+#if defined(SHADOWS)
+uniform mat4 u_worldMatrix;									// Matrix to tranform a position to world space
+#endif
+#endif
 #if defined(SKINNING)
+#if defined(SKINNING_DUAL_QUATERNION)
+uniform vec4 u_dualQuaternionPalette[SKINNING_JOINT_COUNT * 2];	// Array of dual quaternions (real, dual)
+#else
 uniform vec4 u_matrixPalette[SKINNING_JOINT_COUNT * 3];		// Array of 4x3 matrices
 #endif
+#endif
 #if defined(SPECULAR)
 uniform vec3 u_cameraPosition;                 				// Position of the camera in view space
 #endif
@@ -43,6 +54,9 @@ varying vec2 v_texCoord;									// Texture coordinate
 #if defined(SPECULAR)
 varying vec3 v_cameraDirection;								// Direction the camera is looking at in tangent space
 #endif
+#if defined(TILED_LIGHTING)
+varying vec3 v_positionViewSpace;							// Position in view space
+#endif
 #if defined(POINT_LIGHT)
 varying vec3 v_vertexToPointLightDirection;					// Direction of point light w.r.t current vertex in tangent space
 varying float v_pointLightAttenuation;						// Attenuation of point light
@@ -60,10 +74,17 @@ varying float v_spotLightAttenuation;						// Attenuation of spot light
 // Skinning
 #if defined(SKINNING)
 #include "skinning.vert"
+#elif defined(VERTEX_ANIMATION)
+#include "vertex-animation.vert"
 #else
 #include "skinning-none.vert" 
 #endif
 
+// Shadows
+#if defined(SHADOWS)
+#include "shadow.vert"
+#endif
+
 
 void main()
 {
@@ -80,6 +101,12 @@ void main()
 
     // Apply light.
     applyLight(position);
+    #if defined(SHADOWS)
+    applyShadow(position);
+    #endif
+    #if defined(TILED_LIGHTING)
+    v_positionViewSpace = (u_worldViewMatrix * position).xyz;
+    #endif
 
     // Texture transformation
     v_texCoord = a_texCoord;
@@ -0,0 +1,51 @@
+// Vertex animation baked into textures by BakedAnimation. The position and normal of each
+// vertex are read from the two frames of its clip around the current time, and blended.
+attribute float a_texCoord7;								// Index of the vertex in each frame
+#if defined(INSTANCED)
+attribute vec4 a_instanceParameters;						// First frame, frame count, time offset and speed of the clip
+#define u_vertexAnimationClip a_instanceParameters
+#else
+uniform vec4 u_vertexAnimationClip;							// First frame, frame count, time offset and speed of the clip
+#endif
+uniform sampler2D u_vertexAnimationPositions;				// Positions of the vertices in each frame
+#if defined(LIGHTING)
+uniform sampler2D u_vertexAnimationNormals;					// Normals of the vertices in each frame, packed to [0, 1]
+#endif
+uniform vec4 u_vertexAnimationLayout;						// Width, height and rows per frame of the textures, and frame rate
+uniform float u_vertexAnimationTime;						// Game time in seconds
+
+vec2 _vertexAnimationTexCoord0;
+vec2 _vertexAnimationTexCoord1;
+float _vertexAnimationBlend;
+
+vec4 getPosition()
+{
+    // Clips loop, so the frame after the last one is the first.
+    float frameCount = max(u_vertexAnimationClip.y, 1.0);
+    float frame = mod((u_vertexAnimationTime * u_vertexAnimationClip.w + u_vertexAnimationClip.z) * u_vertexAnimationLayout.w, frameCount);
+    float frame0 = floor(frame);
+    float frame1 = mod(frame0 + 1.0, frameCount);
+    _vertexAnimationBlend = frame - frame0;
+
+    // Each frame takes whole rows of texels, and the frames are stacked.
+    float row = floor((a_texCoord7 + 0.5) / u_vertexAnimationLayout.x);
+    float column = a_texCoord7 - row * u_vertexAnimationLayout.x;
+    vec2 texelSize = 1.0 / u_vertexAnimationLayout.xy;
+    _vertexAnimationTexCoord0 = (vec2(column, (u_vertexAnimationClip.x + frame0) * u_vertexAnimationLayout.z + row) + 0.5) * texelSize;
+    _vertexAnimationTexCoord1 = (vec2(column, (u_vertexAnimationClip.x + frame1) * u_vertexAnimationLayout.z + row) + 0.5) * texelSize;
+
+    vec3 position0 = texture2DLod(u_vertexAnimationPositions, _vertexAnimationTexCoord0, 0.0).xyz;
+    vec3 position1 = texture2DLod(u_vertexAnimationPositions, _vertexAnimationTexCoord1, 0.0).xyz;
+    return vec4(mix(position0, position1, _vertexAnimationBlend), 1.0);
+}
+
+#if defined(LIGHTING)
+
+vec3 getNormal()
+{
+    vec3 normal0 = texture2DLod(u_vertexAnimationNormals, _vertexAnimationTexCoord0, 0.0).xyz * 2.0 - 1.0;
+    vec3 normal1 = texture2DLod(u_vertexAnimationNormals, _vertexAnimationTexCoord1, 0.0).xyz * 2.0 - 1.0;
+    return normalize(mix(normal0, normal1, _vertexAnimationBlend));
+}
+
+#endif
@@ -6,15 +6,20 @@ namespace gameplay
 {
 
 AIAgent::AIAgent()
-    : _stateMachine(NULL), _node(NULL), _enabled(true), _listener(NULL), _next(NULL)
+    : _stateMachine(NULL), _node(NULL), _enabled(true), _listener(NULL), _prev(NULL), _next(NULL),
+      _updateInterval(0.0f), _highPriority(false), _lastUpdateTime(0.0), _navigationMesh(NULL), _pathQuery(NULL),
+      _pathFound(false), _pathChanged(false)
 {
     _stateMachine = new AIStateMachine(this);
 
     addScriptEvent("message", "<AIMessage>");
+    addScriptEvent("pathFound", "<AIAgent>b");
 }
 
 AIAgent::~AIAgent()
 {
+    SAFE_RELEASE(_pathQuery);
+    SAFE_RELEASE(_navigationMesh);
     SAFE_DELETE(_stateMachine);
 }
 
@@ -51,13 +56,108 @@ void AIAgent::setEnabled(bool enabled)
     _enabled = enabled;
 }
 
+void AIAgent::setUpdateInterval(float interval)
+{
+    _updateInterval = interval;
+}
+
+float AIAgent::getUpdateInterval() const
+{
+    return _updateInterval;
+}
+
+void AIAgent::setHighPriority(bool highPriority)
+{
+    _highPriority = highPriority;
+}
+
+bool AIAgent::isHighPriority() const
+{
+    return _highPriority;
+}
+
 void AIAgent::setListener(Listener* listener)
 {
     _listener = listener;
 }
 
+void AIAgent::setNavigationMesh(NavigationMesh* mesh)
+{
+    if (mesh != _navigationMesh)
+    {
+        clearPath();
+        if (mesh)
+            mesh->addRef();
+        SAFE_RELEASE(_navigationMesh);
+        _navigationMesh = mesh;
+    }
+}
+
+NavigationMesh* AIAgent::getNavigationMesh() const
+{
+    return _navigationMesh;
+}
+
+void AIAgent::setDestination(const Vector3& destination)
+{
+    if (_navigationMesh == NULL || _node == NULL)
+    {
+        GP_WARN("Failed to set the destination of agent '%s', which has no navigation mesh or node.", getId());
+        return;
+    }
+
+    SAFE_RELEASE(_pathQuery);
+    Vector3 start = _node->getTranslationWorld();
+    if (_pathFound && _navigationMesh->updatePath(start, destination, &_path))
+    {
+        _pathChanged = true;
+        return;
+    }
+    _pathFound = false;
+    _pathQuery = _navigationMesh->findPathAsync(start, destination);
+}
+
+bool AIAgent::isPathPending() const
+{
+    return _pathQuery != NULL;
+}
+
+const NavigationMesh::Path* AIAgent::getPath() const
+{
+    return _pathFound ? &_path : NULL;
+}
+
+void AIAgent::clearPath()
+{
+    SAFE_RELEASE(_pathQuery);
+    _path.points.clear();
+    _path.corridor.clear();
+    _pathFound = false;
+    _pathChanged = false;
+}
+
+void AIAgent::updatePath()
+{
+    if (_pathQuery && _pathQuery->isComplete())
+    {
+        _pathFound = _pathQuery->isFound();
+        _path = _pathQuery->getPath();
+        SAFE_RELEASE(_pathQuery);
+        _pathChanged = true;
+    }
+
+    if (_pathChanged)
+    {
+        _pathChanged = false;
+        if (_listener)
+            _listener->pathFound(this, _pathFound);
+        fireScriptEvent<void>("pathFound", this, _pathFound);
+    }
+}
+
 void AIAgent::update(float elapsedTime)
 {
+    updatePath();
     _stateMachine->update(elapsedTime);
 }
 
@@ -5,6 +5,7 @@
 #include "AIStateMachine.h"
 #include "AIMessage.h"
 #include "ScriptTarget.h"
+#include "NavigationMesh.h"
 
 namespace gameplay
 {
@@ -53,6 +54,18 @@ public:
          * @return true to mark the message as handled, false otherwise.
          */
         virtual bool messageReceived(AIMessage* message) = 0;
+
+        /**
+         * Called when the path to the destination of the AIAgent was searched for.
+         *
+         * This is called from the update of the agent that follows the completion of the
+         * search, before its state machine is updated.
+         *
+         * @param agent The agent.
+         * @param found true if a path was found (see AIAgent::getPath), false otherwise.
+         * @script{ignore}
+         */
+        virtual void pathFound(AIAgent* agent, bool found) { }
     };
 
     /**
@@ -111,6 +124,42 @@ public:
      */
     void setEnabled(bool enabled);
 
+    /**
+     * Sets the interval between the updates of the agent's state machine.
+     *
+     * The current state of an agent is updated at most once per interval, with the time
+     * elapsed since its last update. The AIController may delay updates further when it
+     * has an update budget (see AIController::setUpdateBudget).
+     *
+     * @param interval The interval in milliseconds, or zero (the default) to update the agent every frame.
+     */
+    void setUpdateInterval(float interval);
+
+    /**
+     * Returns the interval between the updates of the agent's state machine.
+     *
+     * @return The interval in milliseconds.
+     */
+    float getUpdateInterval() const;
+
+    /**
+     * Sets whether the agent is updated outside the update budget of the AIController.
+     *
+     * High priority agents are updated whenever their update interval has elapsed, even
+     * when the AIController already updated as many agents as its budget allows in a
+     * frame. This suits the few agents the player interacts with directly.
+     *
+     * @param highPriority true to always update the agent when it is due, false (the default) otherwise.
+     */
+    void setHighPriority(bool highPriority);
+
+    /**
+     * Determines whether the agent is updated outside the update budget of the AIController.
+     *
+     * @return true if the agent has a high priority, false otherwise.
+     */
+    bool isHighPriority() const;
+
     /**
      * Sets an event listener for this AIAgent.
      *
@@ -118,6 +167,61 @@ public:
      */
     void setListener(Listener* listener);
 
+    /**
+     * Sets the navigation mesh the agent finds its paths on.
+     *
+     * Changing the navigation mesh discards the current path of the agent.
+     *
+     * @param mesh The navigation mesh, or NULL.
+     * @script{ignore}
+     */
+    void setNavigationMesh(NavigationMesh* mesh);
+
+    /**
+     * Returns the navigation mesh the agent finds its paths on.
+     *
+     * @return The navigation mesh, or NULL.
+     * @script{ignore}
+     */
+    NavigationMesh* getNavigationMesh() const;
+
+    /**
+     * Finds a path from the position of the agent's node to a destination.
+     *
+     * The path is searched for on the worker threads, and the listener of the agent and
+     * the "pathFound" script event are notified at the next update of the agent once it
+     * is found. When the agent is still within the corridor of its current path and the
+     * destination is in the same triangle as before, the corridor is reused and the path
+     * is only straightened again, without a new search. Setting a new destination while
+     * a search is running waits for that search to complete.
+     *
+     * @param destination The destination, in world space.
+     * @script{ignore}
+     */
+    void setDestination(const Vector3& destination);
+
+    /**
+     * Determines whether the path of the agent is being searched for.
+     *
+     * @return true if the search started by setDestination is not complete, false otherwise.
+     * @script{ignore}
+     */
+    bool isPathPending() const;
+
+    /**
+     * Returns the path to the destination of the agent.
+     *
+     * @return The path, or NULL if no path was found.
+     * @script{ignore}
+     */
+    const NavigationMesh::Path* getPath() const;
+
+    /**
+     * Discards the path of the agent, and stops the search for it if it is running.
+     * @script{ignore}
+     */
+    void clearPath();
+
 private:
 
     /**
@@ -156,11 +260,25 @@ private:
      */
     void update(float elapsedTime);
 
+    /**
+     * Takes the result of a completed path search and notifies the listeners of a new path.
+     */
+    void updatePath();
+
     AIStateMachine* _stateMachine;
     Node* _node;
     bool _enabled;
     Listener* _listener;
+    AIAgent* _prev;
     AIAgent* _next;
+    float _updateInterval;
+    bool _highPriority;
+    double _lastUpdateTime;     // The time of the AIController at the last update of the agent.
+    NavigationMesh* _navigationMesh;
+    NavigationMesh::PathQuery* _pathQuery;
+    NavigationMesh::Path _path;
+    bool _pathFound;
+    bool _pathChanged;          // Whether the listeners must be notified of the path at the next update.
 
 };
 
@@ -2,43 +2,96 @@
 #include "AIController.h"
 #include "Game.h"
 
+#ifdef WIN32
+    #include <windows.h>
+#endif
+
 namespace gameplay
 {
 
+static bool compareAndSwap(void* volatile* p, void* expected, void* desired)
+{
+#ifdef WIN32
+    return InterlockedCompareExchangePointer(p, desired, expected) == expected;
+#else
+    return __sync_bool_compare_and_swap(p, expected, desired);
+#endif
+}
+
+static void* exchange(void* volatile* p, void* value)
+{
+#ifdef WIN32
+    return InterlockedExchangePointer(p, value);
+#else
+    void* current;
+    do
+    {
+        current = *p;
+    } while (!__sync_bool_compare_and_swap(p, current, value));
+    return current;
+#endif
+}
+
 AIController::AIController()
-    : _paused(false), _firstMessage(NULL), _firstAgent(NULL)
+    : _paused(false), _time(0.0), _updateBudget(0), _agentCount(0), _roundRobinAgent(NULL), _nextAgent(NULL),
+      _postedMessages(NULL), _firstAgent(NULL), _agentIndex(NULL)
 {
+    _agentIndex = new SpatialHash();
 }
 
 AIController::~AIController()
 {
+    SAFE_DELETE(_agentIndex);
 }
 
 void AIController::initialize()
 {
+    Game* game = Game::getInstance();
+    Properties* config = game->getConfig() ? game->getConfig()->getNamespace("ai", true) : NULL;
+    if (config && config->exists("updateBudget"))
+        _updateBudget = (unsigned int)std::max(config->getInt("updateBudget"), 0);
+    if (config && config->exists("agentCellSize") && _agentIndex->getNodeCount() == 0)
+    {
+        float cellSize = config->getFloat("agentCellSize");
+        if (cellSize > 0.0f)
+        {
+            SAFE_DELETE(_agentIndex);
+            _agentIndex = new SpatialHash(cellSize);
+        }
+    }
 }
 
 void AIController::finalize()
 {
     // Remove all agents
+    _agentIndex->clear();
     AIAgent* agent = _firstAgent;
     while (agent)
     {
         AIAgent* temp = agent;
         agent = agent->_next;
+        temp->_prev = NULL;
+        temp->_next = NULL;
         SAFE_RELEASE(temp);
     }
     _firstAgent = NULL;
+    _agentCount = 0;
+    _roundRobinAgent = NULL;
+    _nextAgent = NULL;
 
     // Remove all messages
-    AIMessage* message = _firstMessage;
+    AIMessage* message = (AIMessage*)exchange((void* volatile*)&_postedMessages, NULL);
     while (message)
     {
         AIMessage* temp = message;
         message = message->_next;
         AIMessage::destroy(temp);
     }
-    _firstMessage = NULL;
+    for (size_t i = 0, count = _delayedMessages.size(); i < count; ++i)
+    {
+        AIMessage::destroy(_delayedMessages[i]);
+    }
+    _delayedMessages.clear();
 }
 
 void AIController::pause()
@@ -53,44 +106,71 @@ void AIController::resume()
 
 void AIController::sendMessage(AIMessage* message, float delay)
 {
+    GP_ASSERT(message);
+
     if (delay <= 0)
     {
         // Send instantly
-        if (message->getReceiver() == NULL || strlen(message->getReceiver()) == 0)
-        {
-            // Broadcast message to all agents
-            AIAgent* agent = _firstAgent;
-            while (agent)
-            {
-                if (agent->processMessage(message))
-                    break; // message consumed by this agent - stop bubbling
-                agent = agent->_next;
-            }
-        }
-        else
+        deliverMessage(message);
+    }
+    else
+    {
+        // Queue for later delivery
+        message->_deliveryTime = Game::getGameTime() + delay;
+        _delayedMessages.push_back(message);
+        std::push_heap(_delayedMessages.begin(), _delayedMessages.end(), isDeliveredLater);
+    }
+}
+
+void AIController::postMessage(AIMessage* message, float delay)
+{
+    GP_ASSERT(message);
+
+    // Push the message on the list of posted messages. The update takes the whole list at once,
+    // so a message is never popped while it is pushed and the list needs no lock.
+    message->_delay = delay;
+    AIMessage* first;
+    do
+    {
+        first = _postedMessages;
+        message->_next = first;
+    } while (!compareAndSwap((void* volatile*)&_postedMessages, first, message));
+}
+
+void AIController::deliverMessage(AIMessage* message)
+{
+    if (message->getReceiver() == NULL || strlen(message->getReceiver()) == 0)
+    {
+        // Broadcast message to all agents
+        AIAgent* agent = _firstAgent;
+        while (agent)
         {
-            // Single recipient
-            AIAgent* agent = findAgent(message->getReceiver());
-            if (agent)
-            {
-                agent->processMessage(message);
-            }
-            else
-            {
-                GP_WARN("Failed to locate AIAgent for message recipient: %s", message->getReceiver());
-            }
+            if (agent->processMessage(message))
+                break; // message consumed by this agent - stop bubbling
+            agent = agent->_next;
         }
-
-        // Delete the message, since it is finished being processed
-        AIMessage::destroy(message);
     }
     else
     {
-        // Queue for later delivery
-        if (_firstMessage)
-            message->_next = _firstMessage;
-        _firstMessage = message;
+        // Single recipient
+        AIAgent* agent = findAgent(message->getReceiver());
+        if (agent)
+        {
+            agent->processMessage(message);
+        }
+        else
+        {
+            GP_WARN("Failed to locate AIAgent for message recipient: %s", message->getReceiver());
+        }
     }
+
+    // Delete the message, since it is finished being processed
+    AIMessage::destroy(message);
+}
+
+bool AIController::isDeliveredLater(AIMessage* a, AIMessage* b)
+{
+    return a->_deliveryTime > b->_deliveryTime;
 }
 
 void AIController::update(float elapsedTime)
@@ -98,75 +178,140 @@ void AIController::update(float elapsedTime)
     if (_paused)
         return;
 
-    static Game* game = Game::getInstance();
-
-    // Send all pending messages that have expired
-    AIMessage* prevMsg = NULL;
-    AIMessage* msg = _firstMessage;
+    // Take the messages posted since the last update, and send them in the order they were posted.
+    AIMessage* posted = (AIMessage*)exchange((void* volatile*)&_postedMessages, NULL);
+    AIMessage* msg = NULL;
+    while (posted)
+    {
+        AIMessage* next = posted->_next;
+        posted->_next = msg;
+        msg = posted;
+        posted = next;
+    }
     while (msg)
     {
-        // If the message delivery time has expired, send it (this also deletes it)
-        if (msg->getDeliveryTime() >= game->getGameTime())
+        AIMessage* next = msg->_next;
+        msg->_next = NULL;
+        sendMessage(msg, msg->_delay);
+        msg = next;
+    }
+
+    // Send all pending messages that have expired, earliest first.
+    double gameTime = Game::getGameTime();
+    while (!_delayedMessages.empty() && _delayedMessages.front()->_deliveryTime <= gameTime)
+    {
+        std::pop_heap(_delayedMessages.begin(), _delayedMessages.end(), isDeliveredLater);
+        msg = _delayedMessages.back();
+        _delayedMessages.pop_back();
+        deliverMessage(msg);
+    }
+
+    // Update the agents that are due, visiting each agent once, round-robin from the first agent the budget
+    // left out in the last update. An agent is never updated twice in a frame, even when updating an agent
+    // changes the list of agents.
+    _time += elapsedTime;
+    unsigned int budget = _updateBudget > 0 ? _updateBudget : UINT_MAX;
+    unsigned int updateCount = 0;
+    unsigned int visitCount = _agentCount;
+    AIAgent* agent = _roundRobinAgent ? _roundRobinAgent : _firstAgent;
+    _roundRobinAgent = NULL;
+    while (agent && visitCount-- > 0)
+    {
+        _nextAgent = agent->_next ? agent->_next : _firstAgent;
+        if (!agent->isEnabled())
         {
-            // Link the message out of our list
-            if (prevMsg)
-                prevMsg->_next = msg->_next;
-
-            AIMessage* temp = msg;
-            msg = msg->_next;
-            temp->_next = NULL;
-            sendMessage(temp);
+            // Disabled agents do not accumulate time.
+            agent->_lastUpdateTime = _time;
         }
-        else
+        else if (agent->_lastUpdateTime < _time && _time - agent->_lastUpdateTime >= agent->_updateInterval)
         {
-            prevMsg = msg;
-            msg = msg->_next;
+            if (agent->_highPriority || updateCount < budget)
+            {
+                if (!agent->_highPriority)
+                    ++updateCount;
+                float agentElapsedTime = (float)(_time - agent->_lastUpdateTime);
+                agent->_lastUpdateTime = _time;
+                agent->update(agentElapsedTime);
+            }
+            else if (_roundRobinAgent == NULL)
+            {
+                _roundRobinAgent = agent;
+            }
         }
+        agent = _nextAgent;
     }
+    _nextAgent = NULL;
+}
 
-    // Update all enabled agents
-    AIAgent* agent = _firstAgent;
-    while (agent)
-    {
-        if (agent->isEnabled())
-            agent->update(elapsedTime);
+void AIController::setUpdateBudget(unsigned int budget)
+{
+    _updateBudget = budget;
+}
 
-        agent = agent->_next;
-    }
+unsigned int AIController::getUpdateBudget() const
+{
+    return _updateBudget;
 }
 
 void AIController::addAgent(AIAgent* agent)
 {
     agent->addRef();
+    agent->_lastUpdateTime = _time;
+    ++_agentCount;
+    if (agent->_node)
+        _agentIndex->insert(agent->_node);
 
     if (_firstAgent)
+    {
         agent->_next = _firstAgent;
+        _firstAgent->_prev = agent;
+    }
 
     _firstAgent = agent;
 }
 
 void AIController::removeAgent(AIAgent* agent)
 {
-    // Search our linked list of agents and link this agent out.
-    AIAgent* prevAgent = NULL;
-    AIAgent* itr = _firstAgent;
-    while (itr)
-    {
-        if (itr == agent)
-        {
-            if (prevAgent)
-                prevAgent->_next = agent->_next;
-            else
-                _firstAgent = agent->_next;
-
-            agent->_next = NULL;
-            agent->release();
-            break;
-        }
+    // Link this agent out of our list of agents, if it is in it.
+    if (agent->_prev == NULL && _firstAgent != agent)
+        return;
+
+    if (agent->_prev)
+        agent->_prev->_next = agent->_next;
+    else
+        _firstAgent = agent->_next;
+    if (agent->_next)
+        agent->_next->_prev = agent->_prev;
+    --_agentCount;
+    if (agent->_node)
+        _agentIndex->remove(agent->_node);
+
+    // Move the agents the update continues from past the removed agent.
+    AIAgent* next = agent->_next ? agent->_next : _firstAgent;
+    if (_nextAgent == agent)
+        _nextAgent = next;
+    if (_roundRobinAgent == agent)
+        _roundRobinAgent = next;
+
+    agent->_prev = NULL;
+    agent->_next = NULL;
+    agent->release();
+}
 
-        prevAgent = itr;
-        itr = itr->_next;
+unsigned int AIController::findAgents(const Vector3& center, float radius, std::vector<AIAgent*>& agents) const
+{
+    std::vector<Node*> nodes;
+    _agentIndex->query(center, radius, nodes);
+    for (size_t i = 0, count = nodes.size(); i < count; ++i)
+    {
+        agents.push_back(nodes[i]->getAgent());
     }
+    return (unsigned int)nodes.size();
+}
+
+SpatialHash* AIController::getAgentIndex() const
+{
+    return _agentIndex;
 }
 
 AIAgent* AIController::findAgent(const char* id) const
@@ -3,6 +3,7 @@
 
 #include "AIAgent.h"
 #include "AIMessage.h"
+#include "SpatialHash.h"
 
 namespace gameplay
 {
@@ -34,6 +35,23 @@ public:
      */
     void sendMessage(AIMessage* message, float delay = 0);
 
+    /**
+     * Queues the specified message to be routed to its intended recipient(s) during the next update.
+     *
+     * Unlike sendMessage, this can be called from any thread, such as from the jobs of the
+     * JobController, and never delivers the message immediately: messages are added to a
+     * queue without locking, and the AIController delivers them on the main thread, in the
+     * order they were posted by each thread, at the start of its next update. The delay is
+     * counted from that update.
+     *
+     * Like with sendMessage, the message is owned and destroyed by the AIController once posted.
+     *
+     * @param message The message to post.
+     * @param delay The delay (in milliseconds) to wait before sending the message.
+     * @script{ignore}
+     */
+    void postMessage(AIMessage* message, float delay = 0);
+
     /**
      * Searches for an AIAgent that is registered with the AIController with the specified ID.
      *
@@ -43,6 +61,53 @@ public:
      */
     AIAgent* findAgent(const char* id) const;
 
+    /**
+     * Finds the agents whose node is within a distance of a point.
+     *
+     * The agents are looked up in an index of the positions of their nodes, so finding the
+     * neighbors of every agent of a crowd does not test every pair of agents. The size of
+     * the cells of the index can be set with 'agentCellSize' in the ai namespace of the
+     * game config, and should be about the most common search radius.
+     *
+     * @param center The point to search around, in world space.
+     * @param radius The distance to search within.
+     * @param agents The array to add the agents to. Agents are appended, in no particular order.
+     *
+     * @return The number of agents found.
+     * @script{ignore}
+     */
+    unsigned int findAgents(const Vector3& center, float radius, std::vector<AIAgent*>& agents) const;
+
+    /**
+     * Returns the index of the positions of the nodes of the agents.
+     *
+     * @return The spatial index of the agents.
+     * @script{ignore}
+     */
+    SpatialHash* getAgentIndex() const;
+
+    /**
+     * Sets the largest number of agents updated in a frame.
+     *
+     * When more agents are due for an update than the budget allows, the remaining ones
+     * are updated in the next frames, starting with those that waited, so that all the
+     * agents take turns. Their state machines are then updated with all the time elapsed
+     * since their last update. High priority agents (see AIAgent::setHighPriority) are
+     * not counted against the budget.
+     *
+     * The budget can also be set with 'updateBudget' in the ai namespace of the game config.
+     *
+     * @param budget The largest number of agents updated per frame, or zero (the default) for no limit.
+     */
+    void setUpdateBudget(unsigned int budget);
+
+    /**
+     * Returns the largest number of agents updated in a frame.
+     *
+     * @return The update budget, or zero if there is no limit.
+     */
+    unsigned int getUpdateBudget() const;
+
 private:
 
     /**
@@ -96,9 +161,26 @@ private:
 
     void removeAgent(AIAgent* agent);
 
+    /**
+     * Delivers a message to its recipient(s) and destroys it.
+     */
+    void deliverMessage(AIMessage* message);
+
+    /**
+     * Orders the delayed messages so that the first one to deliver is at the top of the heap.
+     */
+    static bool isDeliveredLater(AIMessage* a, AIMessage* b);
+
     bool _paused;
-    AIMessage* _firstMessage;
+    double _time;                               // The time the controller has been updated for, in milliseconds.
+    unsigned int _updateBudget;
+    unsigned int _agentCount;
+    AIAgent* _roundRobinAgent;                  // The first agent the budget left out in the last update, where the next update starts.
+    AIAgent* _nextAgent;                        // The next agent to visit in the current update, kept valid when agents are removed.
+    AIMessage* volatile _postedMessages;        // The messages posted since the last update, newest first.
+    std::vector<AIMessage*> _delayedMessages;   // The messages waiting for their delivery time, as a heap.
     AIAgent* _firstAgent;
+    SpatialHash* _agentIndex;                   // The nodes of the agents, by position.
 
 };
 
@@ -5,13 +5,19 @@ namespace gameplay
 {
 
 AIMessage::AIMessage()
-    : _id(0), _deliveryTime(0), _parameters(NULL), _parameterCount(0), _messageType(MESSAGE_TYPE_CUSTOM), _next(NULL)
+    : _id(0), _deliveryTime(0), _parameters(NULL), _parameterCount(0), _messageType(MESSAGE_TYPE_CUSTOM), _next(NULL),
+      _delay(0), _inlineStringsUsed(0)
 {
 }
 
 AIMessage::~AIMessage()
 {
-    SAFE_DELETE_ARRAY(_parameters);
+    for (unsigned int i = 0; i < _parameterCount; ++i)
+    {
+        clearParameter(i);
+    }
+    if (_parameters != _inlineParameters)
+        SAFE_DELETE_ARRAY(_parameters);
 }
 
 AIMessage* AIMessage::create(unsigned int id, const char* sender, const char* receiver, unsigned int parameterCount)
@@ -21,8 +27,10 @@ AIMessage* AIMessage::create(unsigned int id, const char* sender, const char* re
     message->_sender = sender;
     message->_receiver = receiver;
     message->_parameterCount = parameterCount;
-    if (parameterCount > 0)
+    if (parameterCount > INLINE_PARAMETER_COUNT)
         message->_parameters = new AIMessage::Parameter[parameterCount];
+    else
+        message->_parameters = message->_inlineParameters;
     return message;
 }
 
@@ -156,9 +164,18 @@ void AIMessage::setString(unsigned int index, const char* value)
 
     clearParameter(index);
 
-    // Copy the string into our parameter
+    // Copy the string into our parameter, in the storage of the message when it fits.
     size_t len = strlen(value);
-    char* buffer = new char[len + 1];
+    char* buffer;
+    if (_inlineStringsUsed + len + 1 <= INLINE_STRING_SIZE)
+    {
+        buffer = _inlineStrings + _inlineStringsUsed;
+        _inlineStringsUsed += (unsigned int)len + 1;
+    }
+    else
+    {
+        buffer = new char[len + 1];
+    }
     strcpy(buffer, value);
     _parameters[index].stringValue = buffer;
     _parameters[index].type = AIMessage::STRING;
@@ -180,7 +197,15 @@ void AIMessage::clearParameter(unsigned int index)
 {
     GP_ASSERT(index < _parameterCount);
 
-    _parameters[index].clear();
+    Parameter& parameter = _parameters[index];
+    if (parameter.type == AIMessage::STRING)
+    {
+        // Strings stored in the message are freed with it.
+        if (parameter.stringValue < _inlineStrings || parameter.stringValue >= _inlineStrings + INLINE_STRING_SIZE)
+            SAFE_DELETE_ARRAY(parameter.stringValue);
+    }
+
+    parameter.type = AIMessage::UNDEFINED;
 }
 
 AIMessage::Parameter::Parameter()
@@ -188,21 +213,4 @@ AIMessage::Parameter::Parameter()
 {
 }
 
-AIMessage::Parameter::~Parameter()
-{
-    clear();
-}
-
-void AIMessage::Parameter::clear()
-{
-    switch (type)
-    {
-    case AIMessage::STRING:
-        SAFE_DELETE_ARRAY(stringValue);
-        break;
-    }
-
-    type = AIMessage::UNDEFINED;
-}
-
 }
@@ -1,6 +1,8 @@
 #ifndef AIMESSAGE_H_
 #define AIMESSAGE_H_
 
+#include "MemoryPool.h"
+
 namespace gameplay
 {
 
@@ -11,8 +13,12 @@ namespace gameplay
  * Messages can store an arbitrary number of parameters. For the sake of simplicity,
  * each parameter is stored as type double, which is flexible enough to store most
  * data that needs to be passed.
+ *
+ * Messages are allocated from a pool, and store their first few parameters and short
+ * string parameters inside the message, so that creating and sending a typical message
+ * does not allocate from the heap.
  */
-class AIMessage
+class AIMessage : public PoolObject<AIMessage>
 {
     friend class AIAgent;
     friend class AIController;
@@ -214,6 +220,15 @@ private:
         MESSAGE_TYPE_CUSTOM
     };
 
+    /**
+     * The sizes of the storage inside each message.
+     */
+    enum
+    {
+        INLINE_PARAMETER_COUNT = 4,
+        INLINE_STRING_SIZE = 32
+    };
+
     /**
      * Defines a flexible message parameter.
      */
@@ -221,10 +236,6 @@ private:
     {
         Parameter();
 
-        ~Parameter();
-
-        void clear();
-
         union
         {
             int intValue;
@@ -271,10 +282,14 @@ private:
     std::string _sender;
     std::string _receiver;
     double _deliveryTime;
-    Parameter* _parameters;
+    Parameter* _parameters;                             // The parameters, which are _inlineParameters when they fit.
     unsigned int _parameterCount;
     MessageType _messageType;
-    AIMessage* _next;
+    AIMessage* _next;                                   // The next message in the queue of the AIController.
+    float _delay;                                       // The delay the message was posted with, until it is scheduled.
+    Parameter _inlineParameters[INLINE_PARAMETER_COUNT];
+    char _inlineStrings[INLINE_STRING_SIZE];            // The storage of short string parameters, which is not reused when they are replaced.
+    unsigned int _inlineStringsUsed;
 
 };
 
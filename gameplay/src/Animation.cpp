@@ -4,6 +4,7 @@
 #include "AnimationClip.h"
 #include "AnimationTarget.h"
 #include "Game.h"
+#include "Bundle.h"
 #include "Transform.h"
 #include "Properties.h"
 
@@ -15,8 +16,16 @@
 namespace gameplay
 {
 
+// Whether curves of an interpolation type are cubic, so evaluating them from baked segment polynomials is cheaper.
+static bool isCubic(unsigned int type)
+{
+    return type == Curve::BEZIER || type == Curve::BSPLINE || type == Curve::FLAT ||
+           type == Curve::HERMITE || type == Curve::SMOOTH;
+}
+
 Animation::Animation(const char* id, AnimationTarget* target, int propertyId, unsigned int keyCount, unsigned int* keyTimes, float* keyValues, unsigned int type)
-    : _controller(Game::getInstance()->getAnimationController()), _id(id), _duration(0L), _defaultClip(NULL), _clips(NULL)
+    : _controller(Game::getInstance()->getAnimationController()), _id(id), _duration(0L), _defaultClip(NULL), _clips(NULL), _lodNode(NULL),
+      _bundle(NULL), _lastPlayTime(0.0), _idleTracked(false)
 {
     createChannel(target, propertyId, keyCount, keyTimes, keyValues, type);
 
@@ -26,7 +35,8 @@ Animation::Animation(const char* id, AnimationTarget* target, int propertyId, un
 }
 
 Animation::Animation(const char* id, AnimationTarget* target, int propertyId, unsigned int keyCount, unsigned int* keyTimes, float* keyValues, float* keyInValue, float* keyOutValue, unsigned int type)
-    : _controller(Game::getInstance()->getAnimationController()), _id(id), _duration(0L), _defaultClip(NULL), _clips(NULL)
+    : _controller(Game::getInstance()->getAnimationController()), _id(id), _duration(0L), _defaultClip(NULL), _clips(NULL), _lodNode(NULL),
+      _bundle(NULL), _lastPlayTime(0.0), _idleTracked(false)
 {
     createChannel(target, propertyId, keyCount, keyTimes, keyValues, keyInValue, keyOutValue, type);
     // Release the animation because a newly created animation has a ref count of 1 and the channels hold the ref to animation.
@@ -35,7 +45,8 @@ Animation::Animation(const char* id, AnimationTarget* target, int propertyId, un
 }
 
 Animation::Animation(const char* id)
-    : _controller(Game::getInstance()->getAnimationController()), _id(id), _duration(0L), _defaultClip(NULL), _clips(NULL)
+    : _controller(Game::getInstance()->getAnimationController()), _id(id), _duration(0L), _defaultClip(NULL), _clips(NULL), _lodNode(NULL),
+      _bundle(NULL), _lastPlayTime(0.0), _idleTracked(false)
 {
 }
 
@@ -72,10 +83,17 @@ Animation::~Animation()
         _clips->clear();
     }
     SAFE_DELETE(_clips);
+
+    if (_idleTracked)
+    {
+        GP_ASSERT(_controller);
+        _controller->untrackIdleAnimation(this);
+    }
+    SAFE_RELEASE(_bundle);
 }
 
 Animation::Channel::Channel(Animation* animation, AnimationTarget* target, int propertyId, Curve* curve, unsigned long duration)
-    : _animation(animation), _target(target), _propertyId(propertyId), _curve(curve), _duration(duration)
+    : _animation(animation), _target(target), _propertyId(propertyId), _curve(curve), _duration(duration), _dataOffset(-1L)
 {
     GP_ASSERT(_animation);
     GP_ASSERT(_target);
@@ -88,14 +106,27 @@ Animation::Channel::Channel(Animation* animation, AnimationTarget* target, int p
     _animation->addRef();
 }
 
+Animation::Channel::Channel(Animation* animation, AnimationTarget* target, int propertyId, long dataOffset, unsigned long duration)
+    : _animation(animation), _target(target), _propertyId(propertyId), _curve(NULL), _duration(duration), _dataOffset(dataOffset)
+{
+    GP_ASSERT(_animation);
+    GP_ASSERT(_target);
+    GP_ASSERT(_dataOffset >= 0);
+
+    GP_ASSERT(_target->getAnimationPropertyComponentCount(propertyId));
+    _target->addChannel(this);
+    _animation->addRef();
+}
+
 Animation::Channel::Channel(const Channel& copy, Animation* animation, AnimationTarget* target)
-    : _animation(animation), _target(target), _propertyId(copy._propertyId), _curve(copy._curve), _duration(copy._duration)
+    : _animation(animation), _target(target), _propertyId(copy._propertyId), _curve(copy._curve), _duration(copy._duration), _dataOffset(copy._dataOffset)
 {
-    GP_ASSERT(_curve);
+    GP_ASSERT(_curve || _dataOffset >= 0);
     GP_ASSERT(_target);
     GP_ASSERT(_animation);
 
-    _curve->addRef();
+    if (_curve)
+        _curve->addRef();
     _target->addChannel(this);
     _animation->addRef();
 }
@@ -314,10 +345,22 @@ AnimationClip* Animation::findClip(const char* id) const
 }
 
 Animation::Channel* Animation::createChannel(AnimationTarget* target, int propertyId, unsigned int keyCount, unsigned int* keyTimes, float* keyValues, unsigned int type)
+{
+    unsigned long duration;
+    Curve* curve = createCurve(target, propertyId, keyCount, keyTimes, keyValues, type, &duration);
+
+    Channel* channel = new Channel(this, target, propertyId, curve, duration);
+    curve->release();
+    addChannel(channel);
+    return channel;
+}
+
+Curve* Animation::createCurve(AnimationTarget* target, int propertyId, unsigned int keyCount, const unsigned int* keyTimes, const float* keyValues, unsigned int type, unsigned long* duration)
 {
     GP_ASSERT(target);
     GP_ASSERT(keyTimes);
     GP_ASSERT(keyValues);
+    GP_ASSERT(duration);
 
     unsigned int propertyComponentCount = target->getAnimationPropertyComponentCount(propertyId);
     GP_ASSERT(propertyComponentCount > 0);
@@ -326,33 +369,52 @@ Animation::Channel* Animation::createChannel(AnimationTarget* target, int proper
     GP_ASSERT(curve);
     if (target->_targetType == AnimationTarget::TRANSFORM)
         setTransformRotationOffset(curve, propertyId);
+    if (isCubic(type))
+        curve->setBaked(true);
 
     unsigned int lowest = keyTimes[0];
-    unsigned long duration = keyTimes[keyCount-1] - lowest;
+    *duration = keyTimes[keyCount-1] - lowest;
 
     float* normalizedKeyTimes = new float[keyCount];
 
     normalizedKeyTimes[0] = 0.0f;
-    curve->setPoint(0, normalizedKeyTimes[0], keyValues, (Curve::InterpolationType) type);
+    curve->setPoint(0, normalizedKeyTimes[0], const_cast<float*>(keyValues), (Curve::InterpolationType) type);
 
     unsigned int pointOffset = propertyComponentCount;
     unsigned int i = 1;
     for (; i < keyCount - 1; i++)
     {
-        normalizedKeyTimes[i] = (float) (keyTimes[i] - lowest) / (float) duration;
-        curve->setPoint(i, normalizedKeyTimes[i], (keyValues + pointOffset), (Curve::InterpolationType) type);
+        normalizedKeyTimes[i] = (float) (keyTimes[i] - lowest) / (float) *duration;
+        curve->setPoint(i, normalizedKeyTimes[i], const_cast<float*>(keyValues + pointOffset), (Curve::InterpolationType) type);
         pointOffset += propertyComponentCount;
     }
     if (keyCount > 1) {
         i = keyCount - 1;
         normalizedKeyTimes[i] = 1.0f;
-        curve->setPoint(i, normalizedKeyTimes[i], keyValues + pointOffset, (Curve::InterpolationType) type);
+        curve->setPoint(i, normalizedKeyTimes[i], const_cast<float*>(keyValues + pointOffset), (Curve::InterpolationType) type);
     }
 
     SAFE_DELETE_ARRAY(normalizedKeyTimes);
 
+    return curve;
+}
+
+Animation::Channel* Animation::createChannel(AnimationTarget* target, int propertyId, Curve* curve, unsigned long duration)
+{
+    GP_ASSERT(target);
+    GP_ASSERT(curve);
+
     Channel* channel = new Channel(this, target, propertyId, curve, duration);
-    curve->release();
+    addChannel(channel);
+    return channel;
+}
+
+Animation::Channel* Animation::createDeferredChannel(AnimationTarget* target, int propertyId, long dataOffset, unsigned long duration)
+{
+    GP_ASSERT(target);
+    GP_ASSERT(_bundle);
+
+    Channel* channel = new Channel(this, target, propertyId, dataOffset, duration);
     addChannel(channel);
     return channel;
 }
@@ -370,6 +432,8 @@ Animation::Channel* Animation::createChannel(AnimationTarget* target, int proper
     GP_ASSERT(curve);
     if (target->_targetType == AnimationTarget::TRANSFORM)
         setTransformRotationOffset(curve, propertyId);
+    if (isCubic(type))
+        curve->setBaked(true);
 
     unsigned long lowest = keyTimes[0];
     unsigned long duration = keyTimes[keyCount-1] - lowest;
@@ -444,11 +508,98 @@ void Animation::setTransformRotationOffset(Curve* curve, unsigned int propertyId
     return;
 }
 
+void Animation::setLodNode(Node* node)
+{
+    _lodNode = node;
+}
+
+Node* Animation::getLodNode() const
+{
+    return _lodNode;
+}
+
+bool Animation::isLoaded() const
+{
+    for (size_t i = 0, count = _channels.size(); i < count; ++i)
+    {
+        if (_channels[i]->_curve == NULL)
+            return false;
+    }
+    return true;
+}
+
+bool Animation::load()
+{
+    bool loaded = false;
+    for (size_t i = 0, count = _channels.size(); i < count; ++i)
+    {
+        Channel* channel = _channels[i];
+        if (channel->_curve)
+            continue;
+
+        GP_ASSERT(_bundle);
+        channel->_curve = _bundle->readAnimationCurve(_id.c_str(), channel->_target, channel->_propertyId, channel->_dataOffset);
+        if (channel->_curve == NULL)
+        {
+            GP_ERROR("Failed to load channel %d of animation '%s'.", (int)i, _id.c_str());
+            return false;
+        }
+        loaded = true;
+    }
+
+    // Let the controller unload the animation again once its clips stop playing for long enough.
+    _lastPlayTime = Game::getGameTime();
+    if (loaded && !_idleTracked)
+    {
+        GP_ASSERT(_controller);
+        _controller->trackIdleAnimation(this);
+    }
+    return true;
+}
+
+void Animation::unload()
+{
+    if (_bundle == NULL || isPlaying())
+        return;
+
+    for (size_t i = 0, count = _channels.size(); i < count; ++i)
+    {
+        Channel* channel = _channels[i];
+        if (channel->_dataOffset >= 0)
+            SAFE_RELEASE(channel->_curve);
+    }
+
+    if (_idleTracked)
+    {
+        GP_ASSERT(_controller);
+        _controller->untrackIdleAnimation(this);
+    }
+}
+
+bool Animation::isPlaying() const
+{
+    if (_defaultClip && _defaultClip->isClipStateBitSet(AnimationClip::CLIP_IS_PLAYING_BIT))
+        return true;
+
+    if (_clips)
+    {
+        for (size_t i = 0, count = _clips->size(); i < count; ++i)
+        {
+            if ((*_clips)[i]->isClipStateBitSet(AnimationClip::CLIP_IS_PLAYING_BIT))
+                return true;
+        }
+    }
+    return false;
+}
+
 Animation* Animation::clone(Channel* channel, AnimationTarget* target)
 {
     GP_ASSERT(channel);
 
     Animation* animation = new Animation(getId());
+    animation->_bundle = _bundle;
+    if (_bundle)
+        _bundle->addRef();
 
     Animation::Channel* channelCopy = new Animation::Channel(*channel, animation, target);
     animation->addChannel(channelCopy);
@@ -11,6 +11,8 @@ namespace gameplay
 class AnimationTarget;
 class AnimationController;
 class AnimationClip;
+class Node;
+class Bundle;
 
 /**
  * Defines a generic property animation.
@@ -24,6 +26,7 @@ class Animation : public Ref
 {
     friend class AnimationClip;
     friend class AnimationTarget;
+    friend class AnimationController;
     friend class Bundle;
 
 public:
@@ -110,6 +113,68 @@ public:
      */
     bool targets(AnimationTarget* target) const;
 
+    /**
+     * Sets the node that selects the update rate of the clips of this animation when
+     * animation level of detail is enabled on the AnimationController.
+     *
+     * This is typically the node of the model an animation of joints deforms, or the
+     * animated node itself. Clips are updated at a reduced rate while the bounding sphere
+     * of the node is far from the active camera of its scene, and only advance in time
+     * while it is outside the camera's view. The node is not retained, so it must be reset
+     * to NULL before it is destroyed if the animation outlives it.
+     *
+     * @param node The node, or NULL to always update the clips at the full rate (the default).
+     *
+     * @see AnimationController::setLodEnabled
+     * @script{ignore}
+     */
+    void setLodNode(Node* node);
+
+    /**
+     * Returns the node that selects the update rate of the clips of this animation.
+     *
+     * @return The node, or NULL if the clips are always updated at the full rate.
+     * @script{ignore}
+     */
+    Node* getLodNode() const;
+
+    /**
+     * Determines whether the key values of all the channels of this animation are loaded.
+     *
+     * Animations are always loaded unless they were read from a bundle while deferred
+     * loading was enabled on the AnimationController, in which case the key values of
+     * their channels are only read from the bundle when a clip is first played.
+     *
+     * @return True if the animation is loaded, false otherwise.
+     *
+     * @see AnimationController::setDeferredLoadingEnabled
+     * @script{ignore}
+     */
+    bool isLoaded() const;
+
+    /**
+     * Reads the key values of the channels that are not loaded from the bundle the
+     * animation was read from.
+     *
+     * Clips load their animation when they are played, so this only needs to be called to
+     * avoid reading the bundle on the frame a clip is first played.
+     *
+     * @return True if the animation is loaded, false if the key values could not be read.
+     * @script{ignore}
+     */
+    bool load();
+
+    /**
+     * Releases the key values of the channels that were read on demand from a bundle, so
+     * that they are read again the next time a clip is played.
+     *
+     * Nothing is released while a clip of the animation is playing.
+     *
+     * @see AnimationController::setIdleUnloadTime
+     * @script{ignore}
+     */
+    void unload();
+
 private:
 
     /**
@@ -123,10 +188,12 @@ private:
         friend class AnimationClip;
         friend class Animation;
         friend class AnimationTarget;
+        friend class Bundle;
 
     private:
 
         Channel(Animation* animation, AnimationTarget* target, int propertyId, Curve* curve, unsigned long duration);
+        Channel(Animation* animation, AnimationTarget* target, int propertyId, long dataOffset, unsigned long duration);
         Channel(const Channel& copy, Animation* animation, AnimationTarget* target);
         Channel(const Channel&); // Hidden copy constructor.
         ~Channel();
@@ -136,8 +203,9 @@ private:
         Animation* _animation;                // Reference to the animation this channel belongs to.
         AnimationTarget* _target;             // The target of this channel.
         int _propertyId;                      // The target property this channel targets.
-        Curve* _curve;                        // The curve used to represent the animation data.
+        Curve* _curve;                        // The curve used to represent the animation data, or NULL until it is loaded.
         unsigned long _duration;              // The length of the animation (in milliseconds).
+        long _dataOffset;                     // The offset of the channel data in the bundle of the animation, or -1.
     };
 
     /**
@@ -200,6 +268,29 @@ private:
      */
     Channel* createChannel(AnimationTarget* target, int propertyId, unsigned int keyCount, unsigned int* keyTimes, float* keyValues, float* keyInValue, float* keyOutValue, unsigned int type);
 
+    /**
+     * Creates a channel within this animation that evaluates the given curve.
+     */
+    Channel* createChannel(AnimationTarget* target, int propertyId, Curve* curve, unsigned long duration);
+
+    /**
+     * Creates a channel within this animation whose curve is read from the bundle of the
+     * animation, at the given offset, when the animation is loaded.
+     */
+    Channel* createDeferredChannel(AnimationTarget* target, int propertyId, long dataOffset, unsigned long duration);
+
+    /**
+     * Creates a curve for the property of a target from linear key values.
+     *
+     * @param duration Set to the duration of the curve (in milliseconds).
+     */
+    static Curve* createCurve(AnimationTarget* target, int propertyId, unsigned int keyCount, const unsigned int* keyTimes, const float* keyValues, unsigned int type, unsigned long* duration);
+
+    /**
+     * Determines whether a clip of this animation is playing.
+     */
+    bool isPlaying() const;
+
     /**
      * Adds a channel to the animation.
      */
@@ -213,7 +304,7 @@ private:
     /**
      * Sets the rotation offset in a Curve representing a Transform's animation data.
      */
-    void setTransformRotationOffset(Curve* curve, unsigned int propertyId);
+    static void setTransformRotationOffset(Curve* curve, unsigned int propertyId);
 
     /**
      * Clones this animation.
@@ -231,6 +322,10 @@ private:
     std::vector<Channel*> _channels;        // The channels within this Animation.
     AnimationClip* _defaultClip;            // The Animation's default clip.
     std::vector<AnimationClip*>* _clips;    // All the clips created from this Animation.
+    Node* _lodNode;                         // The node that selects the update rate of the clips (not retained).
+    Bundle* _bundle;                        // The bundle deferred channels are read from, or NULL.
+    double _lastPlayTime;                   // The game time a clip of the animation was last seen playing.
+    bool _idleTracked;                      // Whether the AnimationController may unload the animation when idle.
 
 };
 
@@ -9,20 +9,26 @@
 namespace gameplay
 {
 
+// Spreads the frames that clips updated at a reduced rate are evaluated on.
+static unsigned int __lodFrameSeed = 0;
+
 AnimationClip::AnimationClip(const char* id, Animation* animation, unsigned long startTime, unsigned long endTime)
     : _id(id), _animation(animation), _startTime(startTime), _endTime(endTime), _duration(_endTime - _startTime), 
       _stateBits(0x00), _repeatCount(1.0f), _loopBlendTime(0), _activeDuration(_duration * _repeatCount), _speed(1.0f), _timeStarted(0), 
       _elapsedTime(0), _crossFadeToClip(NULL), _crossFadeOutElapsed(0), _crossFadeOutDuration(0), _blendWeight(1.0f), 
-      _beginListeners(NULL), _endListeners(NULL), _listeners(NULL), _listenerItr(NULL), _scriptListeners(NULL)
+      _percentComplete(0.0f), _lodFrame(__lodFrameSeed++), _beginListeners(NULL), _endListeners(NULL), _listeners(NULL), _listenerItr(NULL), _scriptListeners(NULL),
+      _prevRunning(NULL), _nextRunning(NULL)
 {
     GP_ASSERT(_animation);
     GP_ASSERT(0 <= startTime && startTime <= _animation->_duration && 0 <= endTime && endTime <= _animation->_duration);
 
+    // The curves of channels may not be loaded yet, so the values are sized by the target properties.
     for (size_t i = 0, count = _animation->_channels.size(); i < count; i++)
     {
-        GP_ASSERT(_animation->_channels[i]);
-        GP_ASSERT(_animation->_channels[i]->getCurve());
-        _values.push_back(new AnimationValue(_animation->_channels[i]->getCurve()->getComponentCount()));
+        Animation::Channel* channel = _animation->_channels[i];
+        GP_ASSERT(channel);
+        GP_ASSERT(channel->_target);
+        _values.push_back(new AnimationValue(channel->_target->getAnimationPropertyComponentCount(channel->_propertyId)));
     }
 }
 
@@ -207,8 +213,12 @@ void AnimationClip::play()
     }
     else
     {
-        setClipStateBit(CLIP_IS_PLAYING_BIT);
+        // Read the curves of an animation whose loading was deferred.
         GP_ASSERT(_animation);
+        if (!_animation->load())
+            return;
+
+        setClipStateBit(CLIP_IS_PLAYING_BIT);
         GP_ASSERT(_animation->_controller);
         _animation->_controller->schedule(this);
     }
@@ -370,6 +380,23 @@ void AnimationClip::addListener(const char* function, unsigned long eventTime)
 
 bool AnimationClip::update(float elapsedTime)
 {
+    bool finished;
+    if (!advance(elapsedTime, &finished))
+        return finished;
+
+    // Clips skipped by level of detail have not ended, since they are always applied on the frame they end.
+    if (!isLodUpdateDue())
+        return false;
+
+    evaluate();
+    return apply();
+}
+
+bool AnimationClip::advance(float elapsedTime, bool* finished)
+{
+    GP_ASSERT(finished);
+    *finished = false;
+
     if (isClipStateBitSet(CLIP_IS_PAUSED_BIT))
     {
         return false;
@@ -378,10 +405,11 @@ bool AnimationClip::update(float elapsedTime)
     if (isClipStateBitSet(CLIP_IS_MARKED_FOR_REMOVAL_BIT))
     {
         // If the marked for removal bit is set, it means stop() was called on the AnimationClip at some point
-        // after the last update call. Reset the flag, and return true so the AnimationClip is removed from the 
+        // after the last update call. Reset the flag, and set finished so the AnimationClip is removed from the 
         // running clips on the AnimationController.
         onEnd();
-        return true;
+        *finished = true;
+        return false;
     }
 
     if (!isClipStateBitSet(CLIP_IS_STARTED_BIT))
@@ -519,29 +547,70 @@ bool AnimationClip::update(float elapsedTime)
         }
     }
     
+    _percentComplete = percentComplete;
+    return true;
+}
+
+bool AnimationClip::isLodUpdateDue()
+{
+    // Always apply the frame the clip ends on, so that it stops at its end values.
+    if (isClipStateBitSet(CLIP_IS_MARKED_FOR_REMOVAL_BIT) || !isClipStateBitSet(CLIP_IS_STARTED_BIT))
+        return true;
+
+    GP_ASSERT(_animation && _animation->_controller);
+    unsigned int interval = _animation->_controller->getLodInterval(_animation);
+    if (interval == 0)
+    {
+        // Update as soon as the clip is in view again.
+        _lodFrame = 0;
+        return false;
+    }
+    return (_lodFrame++ % interval) == 0;
+}
+
+void AnimationClip::evaluate()
+{
+    GP_ASSERT(_animation);
+
     // Evaluate this clip.
     Animation::Channel* channel = NULL;
     AnimationValue* value = NULL;
-    AnimationTarget* target = NULL;
     size_t channelCount = _animation->_channels.size();
     float percentageStart = (float)_startTime / (float)_animation->_duration;
     float percentageEnd = (float)_endTime / (float)_animation->_duration;
     float percentageBlend = (float)_loopBlendTime / (float)_animation->_duration;
+    if (_cursors.size() != channelCount)
+        _cursors.resize(channelCount, 0);
     for (size_t i = 0; i < channelCount; i++)
     {
         channel = _animation->_channels[i];
         GP_ASSERT(channel);
-        target = channel->_target;
-        GP_ASSERT(target);
         value = _values[i];
         GP_ASSERT(value);
 
         // Evaluate the point on Curve
         GP_ASSERT(channel->getCurve());
-        channel->getCurve()->evaluate(percentComplete, percentageStart, percentageEnd, percentageBlend, value->_value);
+        channel->getCurve()->evaluate(_percentComplete, percentageStart, percentageEnd, percentageBlend, value->_value, &_cursors[i]);
+    }
+}
+
+bool AnimationClip::apply()
+{
+    GP_ASSERT(_animation);
+
+    Animation::Channel* channel = NULL;
+    AnimationTarget* target = NULL;
+    size_t channelCount = _animation->_channels.size();
+    for (size_t i = 0; i < channelCount; i++)
+    {
+        channel = _animation->_channels[i];
+        GP_ASSERT(channel);
+        target = channel->_target;
+        GP_ASSERT(target);
+        GP_ASSERT(_values[i]);
 
-        // Set the animation value on the target property.
-        target->setAnimationPropertyValue(channel->_propertyId, value, _blendWeight);
+        // Blend the animation value into the pose, which is set on the target property once all clips are applied.
+        _animation->_controller->blendPose(target, channel->_propertyId, _values[i], _blendWeight);
     }
 
     // When ended. Probably should move to it's own method so we can call it when the clip is ended early.
@@ -554,6 +623,21 @@ bool AnimationClip::update(float elapsedTime)
     return false;
 }
 
+void AnimationClip::sample(float time)
+{
+    GP_ASSERT(_animation);
+
+    _percentComplete = _duration == 0 ? 1.0f : MATH_CLAMP(time / (float)_duration, 0.0f, 1.0f);
+    evaluate();
+
+    for (size_t i = 0, count = _animation->_channels.size(); i < count; i++)
+    {
+        Animation::Channel* channel = _animation->_channels[i];
+        GP_ASSERT(channel && channel->_target);
+        channel->_target->setAnimationPropertyValue(channel->_propertyId, _values[i]);
+    }
+}
+
 void AnimationClip::onBegin()
 {
     addRef();
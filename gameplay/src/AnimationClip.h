@@ -20,6 +20,7 @@ class AnimationClip : public Ref
 {
     friend class AnimationController;
     friend class Animation;
+    friend class BakedAnimation;
 
 public:
 
@@ -367,6 +368,45 @@ private:
      */
     bool update(float elapsedTime);
 
+    /**
+     * Advances the clip's time, notifies time listeners and updates cross fade blend weights.
+     *
+     * This is the first part of update(), followed by evaluate() and apply().
+     *
+     * @param elapsedTime The elapsed time since the last update.
+     * @param finished Set to true if the clip has ended and must be removed from the AnimationController.
+     *
+     * @return True if the clip's curves must be evaluated and applied this frame, false otherwise.
+     */
+    bool advance(float elapsedTime, bool* finished);
+
+    /**
+     * Evaluates the curves of the clip's channels into its animation values.
+     *
+     * This only writes to data owned by the clip, so different clips may be evaluated concurrently.
+     */
+    void evaluate();
+
+    /**
+     * Determines whether the clip is evaluated and applied this frame, based on the level of
+     * detail of its animation, after it has been advanced.
+     */
+    bool isLodUpdateDue();
+
+    /**
+     * Applies the evaluated animation values to the clip's targets.
+     *
+     * @return True if the clip has ended and must be removed from the AnimationController.
+     */
+    bool apply();
+
+    /**
+     * Evaluates the clip at a time and sets its values on its targets, without playing it.
+     *
+     * @param time The time from the start of the clip, in milliseconds.
+     */
+    void sample(float time);
+
     /**
      * Handles when the AnimationClip begins.
      */
@@ -417,12 +457,17 @@ private:
     float _crossFadeOutElapsed;                         // The amount of time that has elapsed for the crossfade.
     unsigned long _crossFadeOutDuration;                // The duration of the cross fade.
     float _blendWeight;                                 // The clip's blendweight.
+    float _percentComplete;                             // The point on the curves to evaluate, computed by advance().
+    unsigned int _lodFrame;                             // Counts the frames of level of detail updates.
     std::vector<AnimationValue*> _values;               // AnimationValue holder.
+    std::vector<unsigned int> _cursors;                 // The keyframe cursor of every channel's curve.
     std::vector<Listener*>* _beginListeners;            // Collection of begin listeners on the clip.
     std::vector<Listener*>* _endListeners;              // Collection of end listeners on the clip.
     std::list<ListenerEvent*>* _listeners;              // Ordered collection of listeners on the clip.
     std::list<ListenerEvent*>::iterator* _listenerItr;  // Iterator that points to the next listener event to be triggered.
     std::vector<ScriptListener*>* _scriptListeners;     // Collection of listeners that are bound to Lua script functions.
+    AnimationClip* _prevRunning;                        // The previous clip in the controller's list of running clips.
+    AnimationClip* _nextRunning;                        // The next clip in the controller's list of running clips.
 };
 
 }
@@ -2,28 +2,307 @@
 #include "AnimationController.h"
 #include "Game.h"
 #include "Curve.h"
+#include "Node.h"
+#include "Scene.h"
+#include "Camera.h"
+#include "Quaternion.h"
+
+// The minimum number of running clips for them to be evaluated in parallel.
+#define PARALLEL_MIN_CLIPS 8
+
+// The default level of detail distance and update interval of reduced clips.
+#define LOD_DEFAULT_REDUCED_DISTANCE 50.0f
+#define LOD_DEFAULT_UPDATE_INTERVAL 4
 
 namespace gameplay
 {
 
+struct AnimationController::ClipEvaluation : public JobController::Range
+{
+    ClipEvaluation(AnimationClip** clips) : clips(clips) { }
+
+    void run(unsigned int begin, unsigned int end)
+    {
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            clips[i]->evaluate();
+        }
+    }
+
+    AnimationClip** clips;
+};
+
 AnimationController::AnimationController()
-    : _state(STOPPED)
+    : _state(STOPPED), _firstRunningClip(NULL), _lastRunningClip(NULL), _runningClipCount(0), _parallelEvaluation(false), _lodEnabled(false), _lodReducedDistance(LOD_DEFAULT_REDUCED_DISTANCE),
+      _lodFrozenDistance(0.0f), _lodUpdateInterval(LOD_DEFAULT_UPDATE_INTERVAL), _poseEntryCount(0), _deferredLoading(false), _idleUnloadTime(0)
 {
 }
 
 AnimationController::~AnimationController()
 {
+    for (size_t i = 0, count = _poseEntries.size(); i < count; ++i)
+    {
+        SAFE_DELETE(_poseEntries[i].value);
+    }
+}
+
+void AnimationController::setParallelEvaluation(bool enabled)
+{
+    _parallelEvaluation = enabled;
+}
+
+bool AnimationController::isParallelEvaluation() const
+{
+    return _parallelEvaluation;
+}
+
+void AnimationController::setLodEnabled(bool enabled)
+{
+    _lodEnabled = enabled;
+}
+
+bool AnimationController::isLodEnabled() const
+{
+    return _lodEnabled;
+}
+
+void AnimationController::setLodDistances(float reducedDistance, float frozenDistance)
+{
+    _lodReducedDistance = std::max(reducedDistance, 0.0f);
+    _lodFrozenDistance = std::max(frozenDistance, 0.0f);
+}
+
+float AnimationController::getLodReducedDistance() const
+{
+    return _lodReducedDistance;
+}
+
+float AnimationController::getLodFrozenDistance() const
+{
+    return _lodFrozenDistance;
+}
+
+void AnimationController::setLodUpdateInterval(unsigned int frames)
+{
+    _lodUpdateInterval = std::max(frames, 1u);
+}
+
+unsigned int AnimationController::getLodUpdateInterval() const
+{
+    return _lodUpdateInterval;
+}
+
+void AnimationController::setDeferredLoadingEnabled(bool enabled)
+{
+    _deferredLoading = enabled;
+}
+
+bool AnimationController::isDeferredLoadingEnabled() const
+{
+    return _deferredLoading;
+}
+
+void AnimationController::setIdleUnloadTime(unsigned long time)
+{
+    _idleUnloadTime = time;
+}
+
+unsigned long AnimationController::getIdleUnloadTime() const
+{
+    return _idleUnloadTime;
+}
+
+void AnimationController::trackIdleAnimation(Animation* animation)
+{
+    GP_ASSERT(animation && !animation->_idleTracked);
+    animation->_idleTracked = true;
+    _idleAnimations.push_back(animation);
+}
+
+void AnimationController::untrackIdleAnimation(Animation* animation)
+{
+    std::vector<Animation*>::iterator itr = std::find(_idleAnimations.begin(), _idleAnimations.end(), animation);
+    if (itr != _idleAnimations.end())
+        _idleAnimations.erase(itr);
+    animation->_idleTracked = false;
+}
+
+void AnimationController::unloadIdleAnimations()
+{
+    double time = Game::getGameTime();
+    size_t i = 0;
+    while (i < _idleAnimations.size())
+    {
+        Animation* animation = _idleAnimations[i];
+        if (animation->isPlaying())
+        {
+            animation->_lastPlayTime = time;
+        }
+        else if (time - animation->_lastPlayTime >= (double)_idleUnloadTime)
+        {
+            // Unloading removes the animation from the list.
+            animation->unload();
+            GP_ASSERT(!animation->_idleTracked);
+            continue;
+        }
+        ++i;
+    }
+}
+
+int AnimationController::getQuaternionOffset(AnimationTarget* target, int propertyId)
+{
+    if (target->_targetType != AnimationTarget::TRANSFORM)
+        return -1;
+
+    switch (propertyId)
+    {
+    case Transform::ANIMATE_ROTATE:
+    case Transform::ANIMATE_ROTATE_TRANSLATE:
+        return 0;
+    case Transform::ANIMATE_SCALE_ROTATE:
+    case Transform::ANIMATE_SCALE_ROTATE_TRANSLATE:
+        return 3;
+    default:
+        return -1;
+    }
+}
+
+void AnimationController::blendPose(AnimationTarget* target, int propertyId, AnimationValue* value, float blendWeight)
+{
+    GP_ASSERT(target);
+    GP_ASSERT(value);
+
+    // Find the entry of the property, which is usually the first and only one of the target.
+    unsigned int index = target->_poseEntry;
+    while (index != POSE_ENTRY_NONE && _poseEntries[index].propertyId != propertyId)
+    {
+        index = _poseEntries[index].next;
+    }
+
+    unsigned int componentCount = value->_componentCount;
+    if (index == POSE_ENTRY_NONE)
+    {
+        index = _poseEntryCount++;
+        if (index == _poseEntries.size())
+        {
+            PoseEntry entry;
+            entry.value = NULL;
+            _poseEntries.push_back(entry);
+        }
+        PoseEntry& entry = _poseEntries[index];
+        entry.target = target;
+        entry.propertyId = propertyId;
+        entry.quaternionOffset = getQuaternionOffset(target, propertyId);
+        entry.next = target->_poseEntry;
+        target->_poseEntry = index;
+
+        // Entries reuse their value between updates while it has the same size.
+        if (entry.value == NULL || entry.value->_componentCount != componentCount)
+        {
+            SAFE_DELETE(entry.value);
+            entry.value = new AnimationValue(componentCount);
+        }
+
+        // Blend over the value of the property before the update, as setting it on the target would.
+        if (blendWeight < 1.0f)
+        {
+            target->getAnimationPropertyValue(propertyId, entry.value);
+        }
+        else
+        {
+            memcpy(entry.value->_value, value->_value, entry.value->_componentSize);
+            return;
+        }
+    }
+
+    PoseEntry& entry = _poseEntries[index];
+    GP_ASSERT(entry.value->_componentCount == componentCount);
+    float* dst = entry.value->_value;
+    const float* src = value->_value;
+    if (blendWeight >= 1.0f)
+    {
+        memcpy(dst, src, entry.value->_componentSize);
+        return;
+    }
+
+    int q = entry.quaternionOffset;
+    for (unsigned int i = 0; i < componentCount; ++i)
+    {
+        if ((int)i == q)
+        {
+            Quaternion::slerp(dst[i], dst[i + 1], dst[i + 2], dst[i + 3], src[i], src[i + 1], src[i + 2], src[i + 3], blendWeight,
+                &dst[i], &dst[i + 1], &dst[i + 2], &dst[i + 3]);
+            i += 3;
+        }
+        else
+        {
+            dst[i] += (src[i] - dst[i]) * blendWeight;
+        }
+    }
+}
+
+void AnimationController::applyPose()
+{
+    for (unsigned int i = 0; i < _poseEntryCount; ++i)
+    {
+        PoseEntry& entry = _poseEntries[i];
+        if (entry.target)
+        {
+            entry.target->_poseEntry = POSE_ENTRY_NONE;
+        }
+    }
+    for (unsigned int i = 0; i < _poseEntryCount; ++i)
+    {
+        PoseEntry& entry = _poseEntries[i];
+        if (entry.target)
+        {
+            entry.target->setAnimationPropertyValue(entry.propertyId, entry.value, 1.0f);
+            entry.target = NULL;
+        }
+    }
+    _poseEntryCount = 0;
+}
+
+void AnimationController::removePoseTarget(AnimationTarget* target)
+{
+    GP_ASSERT(target);
+    for (unsigned int index = target->_poseEntry; index != POSE_ENTRY_NONE; index = _poseEntries[index].next)
+    {
+        _poseEntries[index].target = NULL;
+    }
+    target->_poseEntry = POSE_ENTRY_NONE;
+}
+
+unsigned int AnimationController::getLodInterval(Animation* animation) const
+{
+    GP_ASSERT(animation);
+
+    Node* node = animation->getLodNode();
+    if (!_lodEnabled || node == NULL)
+        return 1;
+
+    Scene* scene = node->getScene();
+    Camera* camera = scene ? scene->getActiveCamera() : NULL;
+    if (camera == NULL || camera->getNode() == NULL)
+        return 1;
+
+    const BoundingSphere& sphere = node->getBoundingSphere();
+    if (!camera->getFrustum().intersects(sphere))
+        return 0;
+
+    float distance = camera->getNode()->getTranslationWorld().distance(sphere.center) - sphere.radius;
+    if (_lodFrozenDistance > 0.0f && distance > _lodFrozenDistance)
+        return 0;
+    if (distance > _lodReducedDistance)
+        return _lodUpdateInterval;
+    return 1;
 }
 
 void AnimationController::stopAllAnimations() 
 {
-    std::list<AnimationClip*>::iterator clipIter = _runningClips.begin();
-    while (clipIter != _runningClips.end())
+    for (AnimationClip* clip = _firstRunningClip; clip; clip = clip->_nextRunning)
     {
-        AnimationClip* clip = *clipIter;
-        GP_ASSERT(clip);
         clip->stop();
-        clipIter++;
     }
 }
 
@@ -39,19 +318,31 @@ void AnimationController::initialize()
 
 void AnimationController::finalize()
 {
-    std::list<AnimationClip*>::iterator itr = _runningClips.begin();
-    for ( ; itr != _runningClips.end(); itr++)
+    AnimationClip* clip = _firstRunningClip;
+    while (clip)
     {
-        AnimationClip* clip = *itr;
+        AnimationClip* next = clip->_nextRunning;
+        clip->_prevRunning = NULL;
+        clip->_nextRunning = NULL;
         SAFE_RELEASE(clip);
+        clip = next;
     }
-    _runningClips.clear();
+    _firstRunningClip = NULL;
+    _lastRunningClip = NULL;
+    _runningClipCount = 0;
     _state = STOPPED;
+
+    // Animations that outlive the controller must not untrack themselves.
+    for (size_t i = 0, count = _idleAnimations.size(); i < count; ++i)
+    {
+        _idleAnimations[i]->_idleTracked = false;
+    }
+    _idleAnimations.clear();
 }
 
 void AnimationController::resume()
 {
-    if (_runningClips.empty())
+    if (_runningClipCount == 0)
         _state = IDLE;
     else
         _state = RUNNING;
@@ -64,73 +355,194 @@ void AnimationController::pause()
 
 void AnimationController::schedule(AnimationClip* clip)
 {
-    if (_runningClips.empty())
+    if (_runningClipCount == 0)
     {
         _state = RUNNING;
     }
 
     GP_ASSERT(clip);
     clip->addRef();
-    _runningClips.push_back(clip);
+    addRunningClip(clip);
 }
 
 void AnimationController::unschedule(AnimationClip* clip)
 {
-    std::list<AnimationClip*>::iterator clipItr = _runningClips.begin();
-    while (clipItr != _runningClips.end())
+    if (isRunningClip(clip))
     {
-        AnimationClip* rClip = (*clipItr);
-        if (rClip == clip)
-        {
-            _runningClips.erase(clipItr);
-            SAFE_RELEASE(clip);
-            break;
-        }
-        clipItr++;
+        removeRunningClip(clip);
+        SAFE_RELEASE(clip);
     }
 
-    if (_runningClips.empty())
+    if (_runningClipCount == 0)
         _state = IDLE;
 }
 
+void AnimationController::addRunningClip(AnimationClip* clip)
+{
+    GP_ASSERT(!isRunningClip(clip));
+    clip->_prevRunning = _lastRunningClip;
+    clip->_nextRunning = NULL;
+    if (_lastRunningClip)
+        _lastRunningClip->_nextRunning = clip;
+    else
+        _firstRunningClip = clip;
+    _lastRunningClip = clip;
+    ++_runningClipCount;
+}
+
+void AnimationController::removeRunningClip(AnimationClip* clip)
+{
+    GP_ASSERT(isRunningClip(clip));
+    if (clip->_prevRunning)
+        clip->_prevRunning->_nextRunning = clip->_nextRunning;
+    else
+        _firstRunningClip = clip->_nextRunning;
+    if (clip->_nextRunning)
+        clip->_nextRunning->_prevRunning = clip->_prevRunning;
+    else
+        _lastRunningClip = clip->_prevRunning;
+    clip->_prevRunning = NULL;
+    --_runningClipCount;
+}
+
+bool AnimationController::isRunningClip(AnimationClip* clip) const
+{
+    return clip->_prevRunning != NULL || _firstRunningClip == clip;
+}
+
+AnimationClip* AnimationController::moveRunningClipToBack(AnimationClip* clip)
+{
+    AnimationClip* next = clip->_nextRunning;
+    if (next == NULL)
+        return clip;
+    removeRunningClip(clip);
+    addRunningClip(clip);
+    return next;
+}
+
 void AnimationController::update(float elapsedTime)
 {
+    if (_idleUnloadTime > 0 && _state != PAUSED && !_idleAnimations.empty())
+        unloadIdleAnimations();
+
     if (_state != RUNNING)
         return;
     
     Transform::suspendTransformChanged();
 
-    // Loop through running clips and call update() on them.
-    std::list<AnimationClip*>::iterator clipIter = _runningClips.begin();
-    while (clipIter != _runningClips.end())
+    if (_parallelEvaluation && _runningClipCount >= PARALLEL_MIN_CLIPS)
+    {
+        updateParallel(elapsedTime);
+    }
+    else
+    {
+        // Loop through running clips and call update() on them.
+        AnimationClip* clip = _firstRunningClip;
+        while (clip)
+        {
+            AnimationClip* next;
+            clip->addRef();
+            if (clip->isClipStateBitSet(AnimationClip::CLIP_IS_RESTARTED_BIT))
+            {   // If the CLIP_IS_RESTARTED_BIT is set, we should end the clip and 
+                // move it from where it is in the running clips list to the back.
+                clip->onEnd();
+                clip->setClipStateBit(AnimationClip::CLIP_IS_PLAYING_BIT);
+                next = moveRunningClipToBack(clip);
+            }
+            else if (clip->update(elapsedTime))
+            {
+                next = clip->_nextRunning;
+                if (isRunningClip(clip))
+                {
+                    removeRunningClip(clip);
+                    clip->release();
+                }
+            }
+            else
+            {
+                next = clip->_nextRunning;
+            }
+            clip->release();
+            clip = next;
+        }
+    }
+
+    // Set the pose blended from all the clips once on each target property.
+    applyPose();
+
+    Transform::resumeTransformChanged();
+
+    if (_runningClipCount == 0)
+        _state = IDLE;
+}
+
+void AnimationController::updateParallel(float elapsedTime)
+{
+    // Advance the clips in order on the main thread, since this notifies listeners
+    // and updates the blend weights of clips that are cross fading.
+    _evaluatedClips.clear();
+    AnimationClip* clip = _firstRunningClip;
+    while (clip)
     {
-        AnimationClip* clip = (*clipIter);
-        GP_ASSERT(clip);
+        AnimationClip* next;
         clip->addRef();
+        bool finished = false;
         if (clip->isClipStateBitSet(AnimationClip::CLIP_IS_RESTARTED_BIT))
         {   // If the CLIP_IS_RESTARTED_BIT is set, we should end the clip and 
             // move it from where it is in the running clips list to the back.
             clip->onEnd();
             clip->setClipStateBit(AnimationClip::CLIP_IS_PLAYING_BIT);
-            _runningClips.push_back(clip);
-            clipIter = _runningClips.erase(clipIter);
+            next = moveRunningClipToBack(clip);
         }
-        else if (clip->update(elapsedTime))
+        else if (clip->advance(elapsedTime, &finished))
         {
-            clip->release();
-            clipIter = _runningClips.erase(clipIter);
+            // Clips skipped by level of detail have not ended, since they are always applied on the frame they end.
+            if (clip->isLodUpdateDue())
+            {
+                // Keep the clip alive until its values have been applied.
+                clip->addRef();
+                _evaluatedClips.push_back(clip);
+            }
+            next = clip->_nextRunning;
+        }
+        else if (finished)
+        {
+            next = clip->_nextRunning;
+            if (isRunningClip(clip))
+            {
+                removeRunningClip(clip);
+                clip->release();
+            }
         }
         else
         {
-            clipIter++;
+            next = clip->_nextRunning;
         }
         clip->release();
+        clip = next;
     }
 
-    Transform::resumeTransformChanged();
+    if (_evaluatedClips.empty())
+        return;
 
-    if (_runningClips.empty())
-        _state = IDLE;
+    // Evaluate the curves of all the advanced clips.
+    JobController* jobController = Game::getInstance()->getJobController();
+    GP_ASSERT(jobController);
+    ClipEvaluation evaluation(&_evaluatedClips[0]);
+    jobController->parallelFor((unsigned int)_evaluatedClips.size(), &evaluation);
+
+    // Apply the values in the order the clips were advanced, so blending matches a serial update.
+    for (size_t i = 0, count = _evaluatedClips.size(); i < count; ++i)
+    {
+        AnimationClip* clip = _evaluatedClips[i];
+        if (clip->apply() && isRunningClip(clip))
+        {
+            removeRunningClip(clip);
+            clip->release();
+        }
+        clip->release();
+    }
+    _evaluatedClips.clear();
 }
 
 }
@@ -18,6 +18,7 @@ class AnimationController
     friend class Animation;
     friend class AnimationClip;
     friend class SceneLoader;
+    friend class AnimationTarget;
 
 public:
 
@@ -25,9 +26,169 @@ public:
      * Stops all AnimationClips currently playing on the AnimationController.
      */
     void stopAllAnimations();
-       
+
+    /**
+     * Sets whether the curves of running clips are evaluated in parallel.
+     *
+     * When enabled, each update first advances all running clips on the main thread
+     * (which also notifies their listeners). The curves of those clips are then evaluated
+     * by the game's JobController, and the results are applied to the animation targets
+     * on the main thread in the order the clips are running. Clips are evaluated on the
+     * main thread alone while only a few of them are running.
+     *
+     * Parallel evaluation is disabled by default.
+     *
+     * @param enabled True to evaluate clips in parallel, false to update them on the main thread.
+     */
+    void setParallelEvaluation(bool enabled);
+
+    /**
+     * Determines whether the curves of running clips are evaluated in parallel.
+     *
+     * @return True if clips are evaluated in parallel, false otherwise.
+     */
+    bool isParallelEvaluation() const;
+
+    /**
+     * Sets whether clips are updated at rates chosen by the visibility and distance of
+     * the level of detail node of their animation (see Animation::setLodNode).
+     *
+     * When enabled, the clips of an animation whose node is outside the view of the active
+     * camera of its scene, or beyond the frozen distance, only advance in time and notify
+     * their listeners, without evaluating or applying their curves. Clips whose node is
+     * beyond the reduced distance are evaluated once every update interval frames, with
+     * the frames of different clips spread apart. Clips are always applied on the frame
+     * they end, so they stop at their end values.
+     *
+     * Animation level of detail is disabled by default.
+     *
+     * @param enabled True to enable animation level of detail.
+     * @script{ignore}
+     */
+    void setLodEnabled(bool enabled);
+
+    /**
+     * Determines whether animation level of detail is enabled.
+     *
+     * @return True if animation level of detail is enabled.
+     * @script{ignore}
+     */
+    bool isLodEnabled() const;
+
+    /**
+     * Sets the distances from the camera at which clips are updated at a reduced rate and
+     * no longer updated.
+     *
+     * The distances are measured to the bounding sphere of the level of detail node.
+     *
+     * @param reducedDistance The distance beyond which clips are updated at a reduced rate.
+     *      The default is 50.
+     * @param frozenDistance The distance beyond which clips only advance in time, or 0 to
+     *      only freeze clips whose node is outside the view (the default).
+     * @script{ignore}
+     */
+    void setLodDistances(float reducedDistance, float frozenDistance);
+
+    /**
+     * Returns the distance beyond which clips are updated at a reduced rate.
+     *
+     * @return The reduced distance.
+     * @script{ignore}
+     */
+    float getLodReducedDistance() const;
+
+    /**
+     * Returns the distance beyond which clips only advance in time.
+     *
+     * @return The frozen distance, or 0 if clips are only frozen outside the view.
+     * @script{ignore}
+     */
+    float getLodFrozenDistance() const;
+
+    /**
+     * Sets the number of frames between updates of clips beyond the reduced distance.
+     *
+     * @param frames The number of frames, at least 1. The default is 4.
+     * @script{ignore}
+     */
+    void setLodUpdateInterval(unsigned int frames);
+
+    /**
+     * Returns the number of frames between updates of clips beyond the reduced distance.
+     *
+     * @return The number of frames.
+     * @script{ignore}
+     */
+    unsigned int getLodUpdateInterval() const;
+
+    /**
+     * Sets whether animations read from bundles are loaded on demand.
+     *
+     * When enabled, bundles only read the key times of animation channels when loading
+     * scenes and nodes, and keep the offsets of the channels. The key values of all the
+     * channels of an animation are read from the bundle when one of its clips is first
+     * played (or Animation::load is called), so bundles with many animations of which only a
+     * few are played load faster and use less memory. Animations keep their bundle, and its
+     * file, open while they exist.
+     *
+     * Deferred loading is disabled by default. It applies to the bundles loaded after it is set.
+     *
+     * @param enabled True to load the animations of bundles on demand.
+     * @script{ignore}
+     */
+    void setDeferredLoadingEnabled(bool enabled);
+
+    /**
+     * Determines whether animations read from bundles are loaded on demand.
+     *
+     * @return True if deferred loading is enabled.
+     * @script{ignore}
+     */
+    bool isDeferredLoadingEnabled() const;
+
+    /**
+     * Sets the time after which animations that were loaded on demand are unloaded once
+     * none of their clips are playing.
+     *
+     * @param time The time (in milliseconds), or 0 to never unload animations (the default).
+     *
+     * @see Animation::unload
+     * @script{ignore}
+     */
+    void setIdleUnloadTime(unsigned long time);
+
+    /**
+     * Returns the time after which idle animations that were loaded on demand are unloaded.
+     *
+     * @return The time (in milliseconds), or 0 if animations are never unloaded.
+     * @script{ignore}
+     */
+    unsigned long getIdleUnloadTime() const;
+
 private:
 
+    /**
+     * The body of the parallel loop that evaluates clips (defined in AnimationController.cpp).
+     */
+    struct ClipEvaluation;
+
+    /**
+     * The value of a target property in the pose blended from the clips of an update.
+     */
+    struct PoseEntry
+    {
+        AnimationTarget* target;
+        int propertyId;
+        int quaternionOffset;
+        unsigned int next;
+        AnimationValue* value;
+    };
+
+    /**
+     * Marks the end of the pose entries of a target.
+     */
+    static const unsigned int POSE_ENTRY_NONE = 0xFFFFFFFF;
+
     /**
      * The states that the AnimationController may be in.
      */
@@ -90,14 +251,105 @@ private:
      * Unschedules an AnimationClip.
      */
     void unschedule(AnimationClip* clip);
+
+    /**
+     * Appends a clip to the list of running clips.
+     */
+    void addRunningClip(AnimationClip* clip);
+
+    /**
+     * Removes a clip from the list of running clips.
+     *
+     * The clip keeps its pointer to the next clip, so that a loop over the running clips
+     * can continue after the clip it is on was removed.
+     */
+    void removeRunningClip(AnimationClip* clip);
+
+    /**
+     * Determines whether a clip is in the list of running clips.
+     */
+    bool isRunningClip(AnimationClip* clip) const;
+
+    /**
+     * Moves a restarted clip to the back of the list of running clips, so that it is updated
+     * again after the other clips.
+     *
+     * @return The clip to update after it, which is the clip itself when it was already last.
+     */
+    AnimationClip* moveRunningClipToBack(AnimationClip* clip);
     
     /**
      * Callback for when the controller receives a frame update event.
      */
     void update(float elapsedTime);
-    
+
+    /**
+     * Advances all running clips, evaluates their curves in parallel and then
+     * applies the values to their targets.
+     */
+    void updateParallel(float elapsedTime);
+
+    /**
+     * Returns the number of frames between updates of the clips of an animation.
+     *
+     * @return 1 to update the clips every frame, or 0 to only advance them in time.
+     */
+    unsigned int getLodInterval(Animation* animation) const;
+
+    /**
+     * Blends the value of a clip for a target property into the pose of the current update.
+     *
+     * This blends the same way as AnimationTarget::setAnimationPropertyValue, over the
+     * value the property had before the update, but in the contiguous values of the pose,
+     * so that each property is only set on its target once by applyPose().
+     */
+    void blendPose(AnimationTarget* target, int propertyId, AnimationValue* value, float blendWeight);
+
+    /**
+     * Returns the offset of the rotation that Transform slerps in the value of a property, or -1.
+     */
+    static int getQuaternionOffset(AnimationTarget* target, int propertyId);
+
+    /**
+     * Sets the blended values of the pose on their targets and clears the pose.
+     */
+    void applyPose();
+
+    /**
+     * Removes the entries of a target that is being destroyed from the pose.
+     */
+    void removePoseTarget(AnimationTarget* target);
+
+    /**
+     * Adds an animation that was loaded on demand to those unloaded when idle.
+     */
+    void trackIdleAnimation(Animation* animation);
+
+    /**
+     * Removes an animation from those unloaded when idle.
+     */
+    void untrackIdleAnimation(Animation* animation);
+
+    /**
+     * Unloads the animations that have not been playing for the idle unload time.
+     */
+    void unloadIdleAnimations();
+
     State _state;                                 // The current state of the AnimationController.
-    std::list<AnimationClip*> _runningClips;      // A list of running AnimationClips.
+    AnimationClip* _firstRunningClip;             // The first clip of the intrusive list of running clips.
+    AnimationClip* _lastRunningClip;              // The last running clip, after which clips are scheduled.
+    unsigned int _runningClipCount;               // The number of running clips.
+    std::vector<AnimationClip*> _evaluatedClips;  // The clips being evaluated in parallel.
+    bool _parallelEvaluation;                     // Whether clips are evaluated in parallel.
+    bool _lodEnabled;                             // Whether clips are updated at rates chosen by level of detail.
+    float _lodReducedDistance;                    // The distance beyond which clips are updated at a reduced rate.
+    float _lodFrozenDistance;                     // The distance beyond which clips only advance in time.
+    unsigned int _lodUpdateInterval;              // The number of frames between updates of reduced clips.
+    std::vector<PoseEntry> _poseEntries;          // The entries of the pose, whose values are kept between updates.
+    unsigned int _poseEntryCount;                 // The number of entries in the pose of the current update.
+    bool _deferredLoading;                        // Whether bundles defer loading the curves of animations.
+    unsigned long _idleUnloadTime;                // The time after which idle animations are unloaded, or 0.
+    std::vector<Animation*> _idleAnimations;      // The animations loaded on demand (not retained).
 };
 
 }
@@ -10,12 +10,18 @@ namespace gameplay
 {
 
 AnimationTarget::AnimationTarget()
-    : _targetType(SCALAR), _animationChannels(NULL)
+    : _targetType(SCALAR), _animationChannels(NULL), _poseEntry(AnimationController::POSE_ENTRY_NONE)
 {
 }
 
 AnimationTarget::~AnimationTarget()
 {
+    // Drop the values blended for the target this update, if it is destroyed by a listener.
+    if (_poseEntry != AnimationController::POSE_ENTRY_NONE)
+    {
+        Game::getInstance()->getAnimationController()->removePoseTarget(this);
+    }
+
     if (_animationChannels)
     {
         std::vector<Animation::Channel*>::iterator itr = _animationChannels->begin();
@@ -19,6 +19,7 @@ class AnimationTarget
 {
     friend class Animation;
     friend class AnimationClip;
+    friend class AnimationController;
 
 public:
 
@@ -241,6 +242,7 @@ private:
     void convertByValues(float* from, float* by, unsigned int componentCount);
 
     std::vector<Animation::Channel*>* _animationChannels;   // Collection of all animation channels that target the AnimationTarget
+    unsigned int _poseEntry;                                // The first entry of the target in the pose being blended, if any.
 
 };
 }
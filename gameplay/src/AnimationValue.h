@@ -2,6 +2,7 @@
 #define ANIMATIONVALUE_H_
 
 #include "Animation.h"
+#include "MemoryPool.h"
 
 namespace gameplay
 {
@@ -9,9 +10,10 @@ namespace gameplay
 /**
  * The runtime interface to represent an animation value.
  */
-class AnimationValue
+class AnimationValue : public PoolObject<AnimationValue>
 {
     friend class AnimationClip;
+    friend class AnimationController;
 
 public:
 
@@ -1,6 +1,8 @@
 #include "Base.h"
 #include "AudioBuffer.h"
 #include "FileSystem.h"
+#include "MemoryStats.h"
+#include "Game.h"
 
 namespace gameplay
 {
@@ -8,6 +10,9 @@ namespace gameplay
 // Audio buffer cache
 static std::vector<AudioBuffer*> __buffers;
 
+// Incremented each time a buffer is used, to find the least recently used buffers.
+static unsigned int __useTime = 0;
+
 // Callbacks for loading an ogg file using Stream
 static size_t readStream(void *ptr, size_t size, size_t nmemb, void *datasource)
 {
@@ -38,13 +43,41 @@ static long tellStream(void *datasource)
     return stream->position();
 }
 
-AudioBuffer::AudioBuffer(const char* path, ALuint buffer)
-    : _filePath(path), _alBuffer(buffer)
+AudioBuffer::Loader::Loader(Stream* stream, bool wav)
+    : stream(stream), wav(wav), format(AL_FORMAT_MONO16), frequency(0), data(NULL), size(0), loaded(false), jobId(0)
+{
+}
+
+AudioBuffer::Loader::~Loader()
+{
+    SAFE_DELETE_ARRAY(data);
+    SAFE_DELETE(stream);
+}
+
+void AudioBuffer::Loader::run()
+{
+    loaded = wav ? loadWav(stream, this) : loadOgg(stream, this);
+
+    // The file is no longer needed once decoded.
+    SAFE_DELETE(stream);
+}
+
+AudioBuffer::AudioBuffer(const char* path, ALuint buffer, Loader* loader)
+    : _filePath(path), _alBuffer(buffer), _dataSize(0), _duration(0.0f), _loader(loader), _lastUse(++__useTime)
 {
 }
 
 AudioBuffer::~AudioBuffer()
 {
+    // A buffer released while it is being decoded waits for the decoding to complete.
+    if (_loader)
+    {
+        JobController* jobs = Game::getInstance()->getJobController();
+        if (_loader->jobId && jobs)
+            jobs->wait(_loader->jobId);
+        SAFE_DELETE(_loader);
+    }
+
     // Remove the buffer from the cache.
     unsigned int bufferCount = (unsigned int)__buffers.size();
     for (unsigned int i = 0; i < bufferCount; i++)
@@ -61,6 +94,7 @@ AudioBuffer::~AudioBuffer()
         AL_CHECK( alDeleteBuffers(1, &_alBuffer) );
         _alBuffer = 0;
     }
+    MemoryStats::remove(MemoryStats::AUDIO, _dataSize);
 }
 
 AudioBuffer* AudioBuffer::create(const char* path)
@@ -76,11 +110,15 @@ AudioBuffer* AudioBuffer::create(const char* path)
         GP_ASSERT(buffer);
         if (buffer->_filePath.compare(path) == 0)
         {
+            buffer->markUsed();
             buffer->addRef();
             return buffer;
         }
     }
 
+    // The audio controller creates the OpenAL context when it is first used.
+    Game::getInstance()->getAudioController();
+
     ALuint alBuffer;
 
     // Load audio data into a buffer.
@@ -92,7 +130,7 @@ AudioBuffer* AudioBuffer::create(const char* path)
         return NULL;
     }
     
-    // Load sound file.
+    // Open the sound file. Only the header is read here; the rest is decoded as a job.
     std::auto_ptr<Stream> stream(FileSystem::open(path));
     if (stream.get() == NULL || !stream->canRead())
     {
@@ -109,21 +147,14 @@ AudioBuffer* AudioBuffer::create(const char* path)
     }
     
     // Check the file format
+    bool wav;
     if (memcmp(header, "RIFF", 4) == 0)
     {
-        if (!AudioBuffer::loadWav(stream.get(), alBuffer))
-        {
-            GP_ERROR("Invalid wave file: %s", path);
-            goto cleanup;
-        }
+        wav = true;
     }
     else if (memcmp(header, "OggS", 4) == 0)
     {
-        if (!AudioBuffer::loadOgg(stream.get(), alBuffer))
-        {
-            GP_ERROR("Invalid ogg file: %s", path);
-            goto cleanup;
-        }
+        wav = false;
     }
     else
     {
@@ -131,11 +162,20 @@ AudioBuffer* AudioBuffer::create(const char* path)
         goto cleanup;
     }
 
-    buffer = new AudioBuffer(path, alBuffer);
+    {
+        Loader* loader = new Loader(stream.release(), wav);
+        buffer = new AudioBuffer(path, alBuffer, loader);
 
-    // Add the buffer to the cache.
-    __buffers.push_back(buffer);
+        // Add the buffer to the cache, which keeps a reference of its own.
+        __buffers.push_back(buffer);
+        buffer->addRef();
 
+        JobController* jobs = Game::getInstance()->getJobController();
+        if (jobs)
+            loader->jobId = jobs->add(loader);
+        else
+            buffer->finishLoading();
+    }
     return buffer;
     
 cleanup:
@@ -144,9 +184,95 @@ cleanup:
     return NULL;
 }
 
-bool AudioBuffer::loadWav(Stream* stream, ALuint buffer)
+bool AudioBuffer::finishLoading()
+{
+    if (_loader == NULL)
+        return _dataSize > 0;
+
+    JobController* jobs = Game::getInstance()->getJobController();
+    if (_loader->jobId && jobs)
+        jobs->wait(_loader->jobId);
+    else if (_loader->jobId == 0)
+        _loader->run();
+
+    bool loaded = _loader->loaded;
+    if (loaded)
+    {
+        AL_CHECK( alBufferData(_alBuffer, _loader->format, _loader->data, _loader->size, _loader->frequency) );
+        _dataSize = _loader->size;
+        MemoryStats::add(MemoryStats::AUDIO, _dataSize);
+
+        unsigned int frameSize = (_loader->format == AL_FORMAT_MONO8) ? 1 : (_loader->format == AL_FORMAT_STEREO16) ? 4 : 2;
+        if (_loader->frequency > 0)
+            _duration = (float)_dataSize / (float)(frameSize * _loader->frequency);
+    }
+    else
+    {
+        GP_ERROR("Invalid audio file: %s", _filePath.c_str());
+    }
+    SAFE_DELETE(_loader);
+    return loaded;
+}
+
+void AudioBuffer::markUsed()
+{
+    _lastUse = ++__useTime;
+}
+
+void AudioBuffer::updateCache()
+{
+    JobController* jobs = Game::getInstance()->getJobController();
+    std::vector<AudioBuffer*> unused;
+    for (size_t i = 0, count = __buffers.size(); i < count; ++i)
+    {
+        AudioBuffer* buffer = __buffers[i];
+
+        // Decoded buffers are copied to OpenAL here, so playing them does not wait.
+        if (buffer->_loader && buffer->_loader->jobId && jobs && jobs->isComplete(buffer->_loader->jobId))
+            buffer->finishLoading();
+
+        // Buffers only referenced by the cache are unused.
+        if (buffer->getRefCount() == 1 && buffer->_loader == NULL)
+            unused.push_back(buffer);
+    }
+    if (unused.empty())
+        return;
+
+    // Unused buffers are kept for as long as the audio memory is within budget, and the least recently used ones
+    // are released first. Without a budget, they are released right away.
+    size_t budget = MemoryStats::getBudget(MemoryStats::AUDIO);
+    size_t size = MemoryStats::getSize(MemoryStats::AUDIO);
+    if (budget > 0 && size <= budget)
+        return;
+
+    std::sort(unused.begin(), unused.end(), compareLastUse);
+    for (size_t i = 0, count = unused.size(); i < count && (budget == 0 || size > budget); ++i)
+    {
+        size -= std::min(size, (size_t)unused[i]->_dataSize);
+        SAFE_RELEASE(unused[i]);
+    }
+}
+
+void AudioBuffer::clearCache()
+{
+    // Buffers still used by sources are kept until the sources release them.
+    std::vector<AudioBuffer*> buffers;
+    buffers.swap(__buffers);
+    for (size_t i = 0, count = buffers.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(buffers[i]);
+    }
+}
+
+bool AudioBuffer::compareLastUse(const AudioBuffer* a, const AudioBuffer* b)
+{
+    return a->_lastUse < b->_lastUse;
+}
+
+bool AudioBuffer::loadWav(Stream* stream, Loader* loader)
 {
     GP_ASSERT(stream);
+    GP_ASSERT(loader);
 
     unsigned char data[12];
     
@@ -283,8 +409,10 @@ bool AudioBuffer::loadWav(Stream* stream, ALuint buffer)
                 return false;
             }
 
-            AL_CHECK( alBufferData(buffer, format, data, dataSize, frequency) );
-            SAFE_DELETE_ARRAY(data);
+            loader->format = format;
+            loader->frequency = frequency;
+            loader->data = data;
+            loader->size = dataSize;
 
             // We've read the data, so return now.
             return true;
@@ -330,16 +458,10 @@ bool AudioBuffer::loadWav(Stream* stream, ALuint buffer)
     return false;
 }
 
-bool AudioBuffer::loadOgg(Stream* stream, ALuint buffer)
+bool AudioBuffer::openOgg(Stream* stream, OggVorbis_File* file)
 {
     GP_ASSERT(stream);
-
-    OggVorbis_File ogg_file;
-    vorbis_info* info;
-    ALenum format;
-    long result;
-    int section;
-    long size = 0;
+    GP_ASSERT(file);
 
     stream->rewind();
 
@@ -349,11 +471,28 @@ bool AudioBuffer::loadOgg(Stream* stream, ALuint buffer)
     callbacks.close_func = closeStream;
     callbacks.tell_func = tellStream;
 
-    if ((result = ov_open_callbacks(stream, &ogg_file, NULL, 0, callbacks)) < 0)
+    if (ov_open_callbacks(stream, file, NULL, 0, callbacks) < 0)
     {
         GP_ERROR("Failed to open ogg file.");
         return false;
     }
+    return true;
+}
+
+bool AudioBuffer::loadOgg(Stream* stream, Loader* loader)
+{
+    GP_ASSERT(stream);
+    GP_ASSERT(loader);
+
+    OggVorbis_File ogg_file;
+    vorbis_info* info;
+    ALenum format;
+    long result;
+    int section;
+    long size = 0;
+
+    if (!openOgg(stream, &ogg_file))
+        return false;
 
     info = ov_info(&ogg_file, -1);
     GP_ASSERT(info);
@@ -392,9 +531,10 @@ bool AudioBuffer::loadOgg(Stream* stream, ALuint buffer)
         return false;
     }
 
-    AL_CHECK( alBufferData(buffer, format, data, data_size, info->rate) );
-
-    SAFE_DELETE_ARRAY(data);
+    loader->format = format;
+    loader->frequency = (ALsizei)info->rate;
+    loader->data = data;
+    loader->size = (unsigned int)size;
     ov_clear(&ogg_file);
 
     return true;
@@ -3,6 +3,7 @@
 
 #include "Ref.h"
 #include "Stream.h"
+#include "JobController.h"
 
 namespace gameplay
 {
@@ -13,17 +14,45 @@ class AudioSource;
  * The actual audio buffer data.
  *
  * Currently only supports supported formats: .wav, .au and .raw files.
+ *
+ * Buffers are decoded on the worker threads of the JobController, and copied to OpenAL
+ * on the main thread once decoded, or when a source first plays them. Buffers are cached
+ * by path: the cache keeps a reference to each buffer, and the buffers that no source
+ * uses are kept until the audio memory goes over its budget (see MemoryStats::setBudget),
+ * when the least recently used ones are released.
  */
 class AudioBuffer : public Ref
 {
     friend class AudioSource;
+    friend class AudioController;
 
 private:
+
+    /**
+     * Decodes the file of a buffer as a job.
+     */
+    struct Loader : public JobController::Job
+    {
+        Loader(Stream* stream, bool wav);
+
+        ~Loader();
+
+        void run();
+
+        Stream* stream;
+        bool wav;
+        ALenum format;
+        ALsizei frequency;
+        char* data;
+        unsigned int size;
+        bool loaded;
+        JobController::JobId jobId;
+    };
     
     /**
      * Constructor.
      */
-    AudioBuffer(const char* path, ALuint buffer);
+    AudioBuffer(const char* path, ALuint buffer, Loader* loader);
 
     /**
      * Destructor.
@@ -43,13 +72,47 @@ private:
      * @return The buffer from a file.
      */
     static AudioBuffer* create(const char* path);
+
+    /**
+     * Waits for the buffer to be decoded, and copies its data to OpenAL.
+     *
+     * @return true if the buffer has data, false if its file failed to decode.
+     */
+    bool finishLoading();
+
+    /**
+     * Marks the buffer as used, so the least recently used buffers are released first.
+     */
+    void markUsed();
+
+    /**
+     * Copies the buffers that were decoded to OpenAL, and releases the unused buffers that
+     * do not fit the audio memory budget. Called once per frame.
+     */
+    static void updateCache();
+
+    /**
+     * Releases the references of the cache. Called when the audio controller is finalized.
+     */
+    static void clearCache();
+
+    static bool compareLastUse(const AudioBuffer* a, const AudioBuffer* b);
     
-    static bool loadWav(Stream* stream, ALuint buffer);
+    static bool loadWav(Stream* stream, Loader* loader);
     
-    static bool loadOgg(Stream* stream, ALuint buffer);
+    static bool loadOgg(Stream* stream, Loader* loader);
+
+    /**
+     * Opens an ogg file for decoding. The stream is closed when the file is cleared.
+     */
+    static bool openOgg(Stream* stream, OggVorbis_File* file);
 
     std::string _filePath;
     ALuint _alBuffer;
+    unsigned int _dataSize;
+    float _duration;            // In seconds, once loaded.
+    Loader* _loader;            // The decoding of the file, or NULL once the data was copied to OpenAL.
+    unsigned int _lastUse;
 };
 
 }
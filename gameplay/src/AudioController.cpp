@@ -3,21 +3,147 @@
 #include "AudioListener.h"
 #include "AudioBuffer.h"
 #include "AudioSource.h"
+#include "Game.h"
+
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
+
+// The default number of voices that sources which are not streamed play on.
+#define AUDIO_DEFAULT_VOICE_COUNT 32
+
+// The default time between voice updates, in milliseconds.
+#define AUDIO_DEFAULT_VOICE_UPDATE_INTERVAL 100.0
+
+// The number of commands that can be queued for the audio thread.
+#define AUDIO_COMMAND_COUNT 256
+
+// The time the audio thread sleeps between updates of the streamed sources, in milliseconds.
+#define AUDIO_THREAD_INTERVAL 10
 
 namespace gameplay
 {
 
+/**
+ * A command for the audio thread.
+ */
+struct AudioController::Command
+{
+    CommandType type;
+    AudioSource::StreamState* stream;
+    bool restart;
+    unsigned int play;
+    float listener[13];     // The gain, orientation, velocity and position of the listener.
+};
+
+/**
+ * An entry of the ring buffer of commands.
+ *
+ * As for the asynchronous messages of the Logger, the sequence of the entry for index i is
+ * i while it is free to be reserved for index i, i + 1 once its command is ready to run, and
+ * i + AUDIO_COMMAND_COUNT once the audio thread ran it.
+ */
+struct AudioController::CommandEntry
+{
+    volatile long sequence;
+    Command command;
+};
+
+/**
+ * The audio thread, and the streams that it feeds.
+ */
+struct AudioController::AudioThread
+{
+    AudioThread() : running(false) { }
+
+#ifdef WIN32
+    static DWORD WINAPI loop(LPVOID data);
+    HANDLE handle;
+#else
+    static void* loop(void* data);
+    pthread_t handle;
+#endif
+
+    volatile bool running;
+    std::vector<AudioSource::StreamState*> streams;    // Only used by the audio thread while it runs.
+};
+
+static bool compareAndSwap(volatile long* value, long expected, long desired)
+{
+#ifdef WIN32
+    return InterlockedCompareExchange((volatile LONG*)value, (LONG)desired, (LONG)expected) == (LONG)expected;
+#else
+    return __sync_bool_compare_and_swap(value, expected, desired);
+#endif
+}
+
+static void memoryBarrier()
+{
+#ifdef WIN32
+    MemoryBarrier();
+#else
+    __sync_synchronize();
+#endif
+}
+
+static void sleepMilliseconds(unsigned int milliseconds)
+{
+#ifdef WIN32
+    Sleep(milliseconds);
+#else
+    usleep(milliseconds * 1000);
+#endif
+}
+
+static long nextIndex(long index, unsigned long count = 1)
+{
+    return (long)((unsigned long)index + count);
+}
+
+#ifdef WIN32
+DWORD WINAPI AudioController::AudioThread::loop(LPVOID data)
+#else
+void* AudioController::AudioThread::loop(void* data)
+#endif
+{
+    AudioController* controller = static_cast<AudioController*>(data);
+    GP_ASSERT(controller);
+
+    while (controller->_audioThread->running)
+    {
+        controller->runCommands();
+        controller->updateStreams();
+        sleepMilliseconds(AUDIO_THREAD_INTERVAL);
+    }
+    controller->runCommands();
+    return 0;
+}
+
 AudioController::AudioController() 
-    : _alcDevice(NULL), _alcContext(NULL), _pausingSource(NULL)
+    : _alcDevice(NULL), _alcContext(NULL), _pausingSource(NULL), _voiceCount(0), _maxVoices(AUDIO_DEFAULT_VOICE_COUNT),
+      _voiceUpdateInterval(AUDIO_DEFAULT_VOICE_UPDATE_INTERVAL), _lastVoiceUpdate(0.0), _voicesDirty(false),
+      _commands(NULL), _commandWriteIndex(0), _commandReadIndex(0), _audioThread(new AudioThread())
 {
 }
 
 AudioController::~AudioController()
 {
+    SAFE_DELETE_ARRAY(_commands);
+    SAFE_DELETE(_audioThread);
 }
 
 void AudioController::initialize()
 {
+    Game* game = Game::getInstance();
+    Properties* config = game->getConfig() ? game->getConfig()->getNamespace("audio", true) : NULL;
+    if (config && config->exists("voices"))
+        _maxVoices = (unsigned int)std::max(config->getInt("voices"), 1);
+    if (config && config->exists("voiceUpdateInterval"))
+        _voiceUpdateInterval = std::max(config->getFloat("voiceUpdateInterval"), 0.0f);
+
     _alcDevice = alcOpenDevice(NULL);
     if (!_alcDevice)
     {
@@ -40,10 +166,55 @@ void AudioController::initialize()
     {
         GP_ERROR("Unable to make OpenAL context current. Error: %d\n", alcErr);
     }
+
+    _commands = new CommandEntry[AUDIO_COMMAND_COUNT];
+    for (unsigned int i = 0; i < AUDIO_COMMAND_COUNT; ++i)
+        _commands[i].sequence = (long)i;
+    _commandWriteIndex = 0;
+    _commandReadIndex = 0;
+    _audioThread->running = true;
+    memoryBarrier();
+#ifdef WIN32
+    _audioThread->handle = CreateThread(NULL, 0, &AudioThread::loop, this, 0, NULL);
+    bool started = _audioThread->handle != NULL;
+#else
+    bool started = pthread_create(&_audioThread->handle, NULL, &AudioThread::loop, this) == 0;
+#endif
+    if (!started)
+    {
+        _audioThread->running = false;
+        GP_WARN("Failed to start the audio thread; streamed sources will be fed on the game thread.");
+    }
 }
 
 void AudioController::finalize()
 {
+    // Stop the audio thread once it ran the commands that were sent to it.
+    if (_audioThread->running)
+    {
+        _audioThread->running = false;
+#ifdef WIN32
+        WaitForSingleObject(_audioThread->handle, INFINITE);
+        CloseHandle(_audioThread->handle);
+        _audioThread->handle = NULL;
+#else
+        pthread_join(_audioThread->handle, NULL);
+#endif
+    }
+
+    // The streams of the sources still alive are deleted with them, and their OpenAL objects with the context.
+    _audioThread->streams.clear();
+
+    AudioBuffer::clearCache();
+
+    // The voices of sources still alive are deleted with the context.
+    if (!_freeVoices.empty())
+    {
+        AL_CHECK( alDeleteSources((ALsizei)_freeVoices.size(), &_freeVoices[0]) );
+        _freeVoices.clear();
+    }
+    _voiceCount = 0;
+
     alcMakeContextCurrent(NULL);
     if (_alcContext)
     {
@@ -59,18 +230,14 @@ void AudioController::finalize()
 
 void AudioController::pause()
 {
-    std::set<AudioSource*>::iterator itr = _playingSources.begin();
-
     // For each source that is playing, pause it.
-    AudioSource* source = NULL;
-    while (itr != _playingSources.end())
+    for (size_t i = 0, count = _playingSources.size(); i < count; ++i)
     {
-        GP_ASSERT(*itr);
-        source = *itr;
+        AudioSource* source = _playingSources[i];
+        GP_ASSERT(source);
         _pausingSource = source;
         source->pause();
         _pausingSource = NULL;
-        itr++;
     }
 }
 
@@ -78,16 +245,12 @@ void AudioController::resume()
 {   
     alcMakeContextCurrent(_alcContext);
 
-    std::set<AudioSource*>::iterator itr = _playingSources.begin();
-
     // For each source that is playing, resume it.
-    AudioSource* source = NULL;
-    while (itr != _playingSources.end())
+    for (size_t i = 0, count = _playingSources.size(); i < count; ++i)
     {
-        GP_ASSERT(*itr);
-        source = *itr;
+        AudioSource* source = _playingSources[i];
+        GP_ASSERT(source);
         source->resume();
-        itr++;
     }
 }
 
@@ -96,10 +259,257 @@ void AudioController::update(float elapsedTime)
     AudioListener* listener = AudioListener::getInstance();
     if (listener)
     {
-        AL_CHECK( alListenerf(AL_GAIN, listener->getGain()) );
-        AL_CHECK( alListenerfv(AL_ORIENTATION, (ALfloat*)listener->getOrientation()) );
-        AL_CHECK( alListenerfv(AL_VELOCITY, (ALfloat*)&listener->getVelocity()) );
-        AL_CHECK( alListenerfv(AL_POSITION, (ALfloat*)&listener->getPosition()) );
+        Command command;
+        command.type = LISTENER;
+        command.stream = NULL;
+        command.restart = false;
+        command.play = 0;
+        command.listener[0] = listener->getGain();
+        memcpy(&command.listener[1], listener->getOrientation(), sizeof(float) * 6);
+        memcpy(&command.listener[7], &listener->getVelocity().x, sizeof(float) * 3);
+        memcpy(&command.listener[10], &listener->getPosition().x, sizeof(float) * 3);
+        postCommand(command);
+    }
+
+    AudioBuffer::updateCache();
+
+    double time = Game::getGameTime();
+    if (_voicesDirty || time - _lastVoiceUpdate >= _voiceUpdateInterval)
+    {
+        _lastVoiceUpdate = time;
+        _voicesDirty = false;
+        updateVoices();
+    }
+
+    // Streamed sources are fed on the audio thread, which tells when they played to the end.
+    if (!_audioThread->running)
+        updateStreams();
+    for (int i = (int)_playingSources.size() - 1; i >= 0; --i)
+    {
+        AudioSource* source = _playingSources[i];
+        if (source->_stream && source->getState() == AudioSource::STOPPED)
+        {
+            source->_state = AudioSource::STOPPED;
+            removePlayingSource(source);
+        }
+    }
+}
+
+void AudioController::addPlayingSource(AudioSource* source)
+{
+    GP_ASSERT(source);
+    if (source->_playingIndex < 0)
+    {
+        source->_playingIndex = (int)_playingSources.size();
+        _playingSources.push_back(source);
+    }
+}
+
+void AudioController::removePlayingSource(AudioSource* source)
+{
+    GP_ASSERT(source);
+    int index = source->_playingIndex;
+    if (index >= 0)
+    {
+        AudioSource* last = _playingSources.back();
+        _playingSources[index] = last;
+        last->_playingIndex = index;
+        _playingSources.pop_back();
+        source->_playingIndex = -1;
+    }
+}
+
+ALuint AudioController::allocateVoice()
+{
+    if (!_freeVoices.empty())
+    {
+        ALuint voice = _freeVoices.back();
+        _freeVoices.pop_back();
+        return voice;
+    }
+    if (_voiceCount >= _maxVoices)
+        return 0;
+
+    ALuint voice = 0;
+    AL_CHECK( alGenSources(1, &voice) );
+    if (AL_LAST_ERROR())
+    {
+        // The platform has fewer sources than the pool was configured with.
+        GP_WARN("Only %u audio voices are available.", _voiceCount);
+        _maxVoices = _voiceCount;
+        return 0;
+    }
+    ++_voiceCount;
+    return voice;
+}
+
+void AudioController::freeVoice(ALuint voice)
+{
+    GP_ASSERT(voice);
+    _freeVoices.push_back(voice);
+}
+
+void AudioController::updateVoices()
+{
+    AudioListener* listener = AudioListener::getInstance();
+    Vector3 listenerPosition = listener ? listener->getPosition() : Vector3::zero();
+
+    // Sources are removed by moving the last one into their slot, which was already visited.
+    _rankedSources.clear();
+    for (int i = (int)_playingSources.size() - 1; i >= 0; --i)
+    {
+        AudioSource* source = _playingSources[i];
+        if (source->_stream || source->_state != AudioSource::PLAYING)
+            continue;
+
+        if (source->hasEnded())
+        {
+            source->releaseVoice();
+            source->_state = AudioSource::STOPPED;
+            removePlayingSource(source);
+            continue;
+        }
+
+        // Attenuation follows OpenAL's default model, with a reference distance of one.
+        float distance = source->_node ? source->_node->getTranslationWorld().distance(listenerPosition) : 0.0f;
+        source->_audibility = source->_gain / std::max(distance, 1.0f);
+        _rankedSources.push_back(source);
+    }
+    std::sort(_rankedSources.begin(), _rankedSources.end(), compareVoices);
+
+    // The voices of the sources that lose them are freed first, to be given to the sources that gain them.
+    size_t voiceCount = std::min(_rankedSources.size(), (size_t)_maxVoices);
+    for (size_t i = 0, count = _rankedSources.size(); i < count; ++i)
+    {
+        AudioSource* source = _rankedSources[i];
+        if (i >= voiceCount || !source->isAudible())
+            source->releaseVoice();
+    }
+    for (size_t i = 0; i < voiceCount; ++i)
+    {
+        AudioSource* source = _rankedSources[i];
+        if (source->isAudible() && !source->acquireVoice())
+            break;
+    }
+}
+
+bool AudioController::compareVoices(const AudioSource* a, const AudioSource* b)
+{
+    if (a->_priority != b->_priority)
+        return a->_priority > b->_priority;
+    return a->_audibility > b->_audibility;
+}
+
+void AudioController::postStreamCommand(CommandType type, AudioSource* source, bool restart, unsigned int play)
+{
+    GP_ASSERT(source && source->_stream);
+
+    Command command;
+    command.type = type;
+    command.stream = source->_stream;
+    command.restart = restart;
+    command.play = play;
+    postCommand(command);
+}
+
+void AudioController::postCommand(const Command& command)
+{
+    if (!_audioThread->running)
+    {
+        runCommand(command);
+        return;
+    }
+
+    for (;;)
+    {
+        long index = _commandWriteIndex;
+        CommandEntry* entry = &_commands[(unsigned long)index % AUDIO_COMMAND_COUNT];
+        long difference = entry->sequence - index;
+        if (difference == 0)
+        {
+            if (compareAndSwap(&_commandWriteIndex, index, nextIndex(index)))
+            {
+                entry->command = command;
+                memoryBarrier();
+                entry->sequence = nextIndex(index);
+                return;
+            }
+        }
+        else if (difference < 0)
+        {
+            // Commands cannot be dropped, so wait for the audio thread to run some.
+            sleepMilliseconds(1);
+        }
+    }
+}
+
+void AudioController::runCommands()
+{
+    for (;;)
+    {
+        long index = _commandReadIndex;
+        CommandEntry* entry = &_commands[(unsigned long)index % AUDIO_COMMAND_COUNT];
+        if (entry->sequence != nextIndex(index))
+            break;
+
+        // Read the command only after seeing that the entry is ready.
+        memoryBarrier();
+        Command command = entry->command;
+        memoryBarrier();
+        entry->sequence = nextIndex(index, AUDIO_COMMAND_COUNT);
+        _commandReadIndex = nextIndex(index);
+        runCommand(command);
+    }
+}
+
+void AudioController::runCommand(const Command& command)
+{
+    std::vector<AudioSource::StreamState*>& streams = _audioThread->streams;
+    switch (command.type)
+    {
+    case LISTENER:
+        AL_CHECK( alListenerf(AL_GAIN, command.listener[0]) );
+        AL_CHECK( alListenerfv(AL_ORIENTATION, &command.listener[1]) );
+        AL_CHECK( alListenerfv(AL_VELOCITY, &command.listener[7]) );
+        AL_CHECK( alListenerfv(AL_POSITION, &command.listener[10]) );
+        break;
+    case STREAM_PREPARE:
+        AudioSource::prepareStream(command.stream);
+        break;
+    case STREAM_PLAY:
+        AudioSource::playStream(command.stream, command.restart, command.play);
+        if (std::find(streams.begin(), streams.end(), command.stream) == streams.end())
+            streams.push_back(command.stream);
+        break;
+    case STREAM_PAUSE:
+    case STREAM_STOP:
+    case STREAM_DESTROY:
+        streams.erase(std::remove(streams.begin(), streams.end(), command.stream), streams.end());
+        if (command.type == STREAM_PAUSE)
+            AudioSource::pauseStream(command.stream);
+        else if (command.type == STREAM_STOP)
+            AudioSource::stopStream(command.stream);
+        else
+            AudioSource::destroyStream(command.stream);
+        break;
+    }
+}
+
+void AudioController::updateStreams()
+{
+    // Streams that played to the end are no longer fed.
+    std::vector<AudioSource::StreamState*>& streams = _audioThread->streams;
+    for (size_t i = 0; i < streams.size(); )
+    {
+        if (AudioSource::updateStream(streams[i]))
+        {
+            ++i;
+        }
+        else
+        {
+            streams[i] = streams.back();
+            streams.pop_back();
+        }
     }
 }
 
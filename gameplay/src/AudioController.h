@@ -9,6 +9,22 @@ class AudioSource;
 
 /**
  * Defines a class for controlling game audio.
+ *
+ * Sources that are not streamed do not own an OpenAL source: they play on voices taken
+ * from a fixed pool, so a scene can have many more sources than the platform can play at
+ * once. The playing sources are ranked by priority, then by how loud they are at the
+ * listener, a few times per second. The best ranked sources get the voices, and the
+ * others are virtual: they keep track of their position in their sound and pick up from
+ * there when they get a voice again. Sources too quiet to be heard are always virtual.
+ *
+ * The number of voices and how often they are handed out are read from the 'audio'
+ * namespace of the game config: 'voices' and 'voiceUpdateInterval' (in milliseconds).
+ * Streamed sources keep an OpenAL source of their own and do not count against the pool.
+ *
+ * Streamed sources are fed on an audio thread, which refills their buffers every few
+ * milliseconds however long the frames take. The sources send the commands that change
+ * their streams, and the controller sends the state of the listener, through a lock-free
+ * queue that the audio thread runs in order.
  */
 class AudioController
 {
@@ -54,11 +70,101 @@ private:
      */
     void update(float elapsedTime);
 
+    /**
+     * Adds a source to the playing sources, if it is not already playing.
+     */
+    void addPlayingSource(AudioSource* source);
+
+    /**
+     * Removes a source from the playing sources, by moving the last playing source into its slot.
+     */
+    void removePlayingSource(AudioSource* source);
+
+    /**
+     * Takes a voice from the pool, creating it if the pool is not full yet.
+     *
+     * @return The OpenAL source of the voice, or 0 if all the voices are in use.
+     */
+    ALuint allocateVoice();
+
+    /**
+     * Returns a voice to the pool.
+     */
+    void freeVoice(ALuint voice);
+
+    /**
+     * Hands out the voices to the playing sources by rank, and stops the sources that
+     * reached the end of their sound.
+     */
+    void updateVoices();
+
+    /**
+     * Ranks sources by priority, then by audibility.
+     */
+    static bool compareVoices(const AudioSource* a, const AudioSource* b);
+
+    /**
+     * The types of the commands run on the audio thread.
+     */
+    enum CommandType
+    {
+        LISTENER,
+        STREAM_PREPARE,
+        STREAM_PLAY,
+        STREAM_PAUSE,
+        STREAM_STOP,
+        STREAM_DESTROY
+    };
+
+    struct Command;
+    struct CommandEntry;
+    struct AudioThread;
+
+    /**
+     * Sends a command for the stream of a streamed source to the audio thread.
+     *
+     * @param type The type of the command.
+     * @param source The streamed source.
+     * @param restart For STREAM_PLAY, whether the stream plays from the beginning.
+     * @param play For STREAM_PLAY, the number of times the source was played.
+     */
+    void postStreamCommand(CommandType type, AudioSource* source, bool restart = false, unsigned int play = 0);
+
+    /**
+     * Queues a command for the audio thread, or runs it right away if there is no audio thread.
+     */
+    void postCommand(const Command& command);
+
+    /**
+     * Runs the queued commands, in order. Called on the audio thread.
+     */
+    void runCommands();
+
+    /**
+     * Runs a command.
+     */
+    void runCommand(const Command& command);
+
+    /**
+     * Feeds the streamed sources that are playing. Called on the audio thread.
+     */
+    void updateStreams();
 
     ALCdevice* _alcDevice;
     ALCcontext* _alcContext;
-    std::set<AudioSource*> _playingSources;
+    std::vector<AudioSource*> _playingSources;  // Each source stores its index in this array.
     AudioSource* _pausingSource;
+    std::vector<ALuint> _freeVoices;
+    unsigned int _voiceCount;                   // The number of voices created.
+    unsigned int _maxVoices;
+    double _voiceUpdateInterval;                // In milliseconds.
+    double _lastVoiceUpdate;
+    bool _voicesDirty;                          // Whether a source started without a voice since the last voice update.
+    std::vector<AudioSource*> _rankedSources;   // Kept between updates to reuse its memory.
+    CommandEntry* _commands;                    // The ring buffer of commands for the audio thread.
+    volatile long _commandWriteIndex;           // The next entry to reserve.
+    volatile long _commandReadIndex;            // The next entry for the audio thread to run.
+    AudioThread* _audioThread;
 };
 
 }
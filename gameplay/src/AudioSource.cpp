@@ -5,32 +5,206 @@
 #include "AudioSource.h"
 #include "Game.h"
 #include "Node.h"
+#include "FileSystem.h"
+#include "MemoryStats.h"
+
+// The number of buffers a streamed source plays from, and the number of chunks it decodes ahead.
+#define AUDIO_STREAM_BUFFER_COUNT 4
+
+// The size of the chunks a streamed source decodes, in bytes (about 0.4 seconds of 44.1 kHz stereo).
+#define AUDIO_STREAM_CHUNK_SIZE 65536
+
+// The gain at the listener below which a source is not given a voice (-60 dB).
+#define AUDIO_MIN_AUDIBILITY 0.001f
 
 namespace gameplay
 {
 
+/**
+ * The decoder of a streamed source, which decodes chunks of its ogg file on the audio thread.
+ *
+ * The chunks form a ring: the decoder fills the free chunks from decodeIndex, and the
+ * decoded chunks are queued on the OpenAL source from queueIndex. Once the source is
+ * created, the stream is only used by the audio thread, through the commands the source
+ * sends it, except for the fields that tell the audio thread whether to loop and tell the
+ * source when the stream ended.
+ */
+struct AudioSource::StreamState
+{
+    StreamState();
+
+    ~StreamState();
+
+    /**
+     * Decodes into the free chunks.
+     */
+    void decode();
+
+    /**
+     * Queues the decoded chunks on the buffers that are free.
+     */
+    void queue();
+
+    /**
+     * Stops the source and decodes again from the beginning of the file.
+     */
+    void reset();
+
+    std::string path;
+    Stream* file;
+    OggVorbis_File ogg;
+    ALuint source;
+    ALenum format;
+    ALsizei frequency;
+    ALuint buffers[AUDIO_STREAM_BUFFER_COUNT];
+    ALuint freeBuffers[AUDIO_STREAM_BUFFER_COUNT];  // The buffers that are not queued on the source.
+    unsigned int freeBufferCount;
+    char* chunks[AUDIO_STREAM_BUFFER_COUNT];
+    unsigned int chunkSizes[AUDIO_STREAM_BUFFER_COUNT]; // The size of the data of each chunk, or 0 for a free chunk.
+    unsigned int decodeIndex;
+    unsigned int queueIndex;
+    volatile bool looped;                               // Set by the source.
+    bool endOfStream;
+    bool started;                                       // Whether chunks were queued since the stream was last reset.
+    unsigned int playCount;                             // The number of times the source was played, counted by the source.
+    unsigned int play;                                  // The play that the audio thread is feeding.
+    volatile unsigned int endedPlay;                    // The last play that the audio thread played to the end.
+};
+
+AudioSource::StreamState::StreamState()
+    : file(NULL), source(0), format(AL_FORMAT_STEREO16), frequency(0), freeBufferCount(0),
+      decodeIndex(0), queueIndex(0), looped(false), endOfStream(false), started(false),
+      playCount(0), play(0), endedPlay(0)
+{
+    memset(buffers, 0, sizeof(buffers));
+    memset(chunks, 0, sizeof(chunks));
+    memset(chunkSizes, 0, sizeof(chunkSizes));
+}
+
+AudioSource::StreamState::~StreamState()
+{
+    for (unsigned int i = 0; i < AUDIO_STREAM_BUFFER_COUNT; ++i)
+    {
+        SAFE_DELETE_ARRAY(chunks[i]);
+    }
+}
+
+void AudioSource::StreamState::decode()
+{
+    while (!endOfStream && chunkSizes[decodeIndex] == 0)
+    {
+        char* chunk = chunks[decodeIndex];
+        unsigned int size = 0;
+        bool rewound = false;
+        while (size < AUDIO_STREAM_CHUNK_SIZE)
+        {
+            int section;
+            long result = ov_read(&ogg, chunk + size, AUDIO_STREAM_CHUNK_SIZE - size, 0, 2, 1, &section);
+            if (result > 0)
+            {
+                size += (unsigned int)result;
+                rewound = false;
+            }
+            else if (result == OV_HOLE)
+            {
+                // A gap in the data, which the decoder recovers from.
+                continue;
+            }
+            else if (result == 0 && looped && !rewound && ov_pcm_seek(&ogg, 0) == 0)
+            {
+                // A file with no samples reaches its end again right after being rewound, and is ended.
+                rewound = true;
+            }
+            else
+            {
+                endOfStream = true;
+                break;
+            }
+        }
+
+        chunkSizes[decodeIndex] = size;
+        if (size > 0)
+            decodeIndex = (decodeIndex + 1) % AUDIO_STREAM_BUFFER_COUNT;
+    }
+}
+
+void AudioSource::StreamState::queue()
+{
+    while (freeBufferCount > 0 && chunkSizes[queueIndex] > 0)
+    {
+        // The data is copied, so the chunk can be decoded into again right away.
+        ALuint buffer = freeBuffers[--freeBufferCount];
+        AL_CHECK( alBufferData(buffer, format, chunks[queueIndex], chunkSizes[queueIndex], frequency) );
+        AL_CHECK( alSourceQueueBuffers(source, 1, &buffer) );
+        chunkSizes[queueIndex] = 0;
+        queueIndex = (queueIndex + 1) % AUDIO_STREAM_BUFFER_COUNT;
+    }
+}
+
+void AudioSource::StreamState::reset()
+{
+    // A stopped source has played all its buffers.
+    AL_CHECK( alSourceStop(source) );
+    AL_CHECK( alSourcei(source, AL_BUFFER, 0) );
+    for (unsigned int i = 0; i < AUDIO_STREAM_BUFFER_COUNT; ++i)
+    {
+        freeBuffers[i] = buffers[i];
+        chunkSizes[i] = 0;
+    }
+    freeBufferCount = AUDIO_STREAM_BUFFER_COUNT;
+
+    if (ov_pcm_seek(&ogg, 0) != 0)
+    {
+        GP_ERROR("Failed to rewind ogg file: %s", path.c_str());
+    }
+    decodeIndex = 0;
+    queueIndex = 0;
+    endOfStream = false;
+    started = false;
+    decode();
+}
+
 AudioSource::AudioSource(AudioBuffer* buffer, ALuint source) 
-    : _alSource(source), _buffer(buffer), _looped(false), _gain(1.0f), _pitch(1.0f), _node(NULL)
+    : _alSource(source), _buffer(buffer), _stream(NULL), _state(INITIAL), _offset(0.0f), _offsetTime(0.0), _priority(0), _audibility(0.0f),
+      _looped(false), _gain(1.0f), _pitch(1.0f), _node(NULL), _playingIndex(-1)
 {
-    GP_ASSERT(buffer);
-    AL_CHECK( alSourcei(_alSource, AL_BUFFER, buffer->_alBuffer) );
-    AL_CHECK( alSourcei(_alSource, AL_LOOPING, _looped) );
-    AL_CHECK( alSourcef(_alSource, AL_PITCH, _pitch) );
-    AL_CHECK( alSourcef(_alSource, AL_GAIN, _gain) );
-    AL_CHECK( alSourcefv(_alSource, AL_VELOCITY, (const ALfloat*)&_velocity) );
+    // Sources that are not streamed are given a voice when they play, and set it up then.
+    if (_alSource)
+    {
+        AL_CHECK( alSourcei(_alSource, AL_LOOPING, _looped) );
+        AL_CHECK( alSourcef(_alSource, AL_PITCH, _pitch) );
+        AL_CHECK( alSourcef(_alSource, AL_GAIN, _gain) );
+        AL_CHECK( alSourcefv(_alSource, AL_VELOCITY, (const ALfloat*)&_velocity) );
+    }
 }
 
 AudioSource::~AudioSource()
 {
-    if (_alSource)
+    // A source destroyed while playing must not be left in the controller's playing sources.
+    if (_playingIndex >= 0)
     {
-        AL_CHECK( alDeleteSources(1, &_alSource) );
+        AudioController* audioController = Game::getInstance()->getAudioController();
+        GP_ASSERT(audioController);
+        audioController->removePlayingSource(this);
+    }
+    if (_stream)
+    {
+        MemoryStats::remove(MemoryStats::AUDIO, AUDIO_STREAM_BUFFER_COUNT * AUDIO_STREAM_CHUNK_SIZE * 2);
+
+        // The audio thread deletes the stream and its OpenAL source once it ran the commands before.
+        AudioController* audioController = Game::getInstance()->getAudioController();
+        if (audioController)
+            audioController->postStreamCommand(AudioController::STREAM_DESTROY, this);
+        else
+            destroyStream(_stream);
+        _stream = NULL;
         _alSource = 0;
     }
+    releaseVoice();
     SAFE_RELEASE(_buffer);
 }
 
-AudioSource* AudioSource::create(const char* url)
+AudioSource* AudioSource::create(const char* url, bool streamed)
 {
     // Load from a .audio file.
     std::string pathStr = url;
@@ -48,23 +222,105 @@ AudioSource* AudioSource::create(const char* url)
         return audioSource;
     }
 
-    // Create an audio buffer from this URL.
-    AudioBuffer* buffer = AudioBuffer::create(url);
-    if (buffer == NULL)
-        return NULL;
+    // The audio controller creates the OpenAL context when it is first used.
+    AudioController* audioController = Game::getInstance()->getAudioController();
 
-    // Load the audio source.
+    // Open the file for streaming, or create an audio buffer from this URL.
+    StreamState* stream = NULL;
+    AudioBuffer* buffer = NULL;
+    if (streamed)
+        stream = openStream(url);
+    if (stream == NULL)
+    {
+        buffer = AudioBuffer::create(url);
+        if (buffer == NULL)
+            return NULL;
+
+        // The source plays on the voices of the audio controller.
+        return new AudioSource(buffer, 0);
+    }
+
+    // Streamed sources keep their buffers queued on their own OpenAL source.
     ALuint alSource = 0;
 
     AL_CHECK( alGenSources(1, &alSource) );
     if (AL_LAST_ERROR())
     {
-        SAFE_RELEASE(buffer);
+        AL_CHECK( alDeleteBuffers(AUDIO_STREAM_BUFFER_COUNT, stream->buffers) );
+        MemoryStats::remove(MemoryStats::AUDIO, AUDIO_STREAM_BUFFER_COUNT * AUDIO_STREAM_CHUNK_SIZE * 2);
+        ov_clear(&stream->ogg);
+        SAFE_DELETE(stream->file);
+        SAFE_DELETE(stream);
         GP_ERROR("Error generating audio source.");
         return NULL;
     }
     
-    return new AudioSource(buffer, alSource);
+    // Decode the first chunks ahead, so the source is ready to play.
+    stream->source = alSource;
+    AudioSource* audioSource = new AudioSource(NULL, alSource);
+    audioSource->_stream = stream;
+    if (audioController)
+        audioController->postStreamCommand(AudioController::STREAM_PREPARE, audioSource);
+    else
+        prepareStream(stream);
+    return audioSource;
+}
+
+AudioSource::StreamState* AudioSource::openStream(const char* path)
+{
+    GP_ASSERT(path);
+
+    Stream* file = FileSystem::open(path);
+    if (file == NULL || !file->canRead())
+    {
+        GP_ERROR("Failed to load audio file %s.", path);
+        SAFE_DELETE(file);
+        return NULL;
+    }
+
+    char header[4];
+    if (file->read(header, 1, 4) != 4 || memcmp(header, "OggS", 4) != 0)
+    {
+        GP_WARN("Audio file %s is not an ogg file and cannot be streamed; loading it whole.", path);
+        SAFE_DELETE(file);
+        return NULL;
+    }
+
+    StreamState* stream = new StreamState();
+    stream->path = path;
+    stream->file = file;
+    if (!AudioBuffer::openOgg(file, &stream->ogg))
+    {
+        GP_ERROR("Invalid ogg file: %s", path);
+        SAFE_DELETE(stream->file);
+        SAFE_DELETE(stream);
+        return NULL;
+    }
+
+    vorbis_info* info = ov_info(&stream->ogg, -1);
+    GP_ASSERT(info);
+    stream->format = info->channels == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+    stream->frequency = (ALsizei)info->rate;
+
+    AL_CHECK( alGenBuffers(AUDIO_STREAM_BUFFER_COUNT, stream->buffers) );
+    if (AL_LAST_ERROR())
+    {
+        GP_ERROR("Failed to create OpenAL buffers; alGenBuffers error: %d", AL_LAST_ERROR());
+        ov_clear(&stream->ogg);
+        SAFE_DELETE(stream->file);
+        SAFE_DELETE(stream);
+        return NULL;
+    }
+    for (unsigned int i = 0; i < AUDIO_STREAM_BUFFER_COUNT; ++i)
+    {
+        stream->freeBuffers[i] = stream->buffers[i];
+        stream->chunks[i] = new char[AUDIO_STREAM_CHUNK_SIZE];
+    }
+    stream->freeBufferCount = AUDIO_STREAM_BUFFER_COUNT;
+
+    // Only the chunks and the buffers they are copied to are ever in memory.
+    MemoryStats::add(MemoryStats::AUDIO, AUDIO_STREAM_BUFFER_COUNT * AUDIO_STREAM_CHUNK_SIZE * 2);
+    return stream;
 }
 
 AudioSource* AudioSource::create(Properties* properties)
@@ -85,7 +341,7 @@ AudioSource* AudioSource::create(Properties* properties)
     }
 
     // Create the audio source.
-    AudioSource* audio = AudioSource::create(path.c_str());
+    AudioSource* audio = AudioSource::create(path.c_str(), properties->getBool("streamed"));
     if (audio == NULL)
     {
         GP_ERROR("Audio file '%s' failed to load properly.", path.c_str());
@@ -97,6 +353,10 @@ AudioSource* AudioSource::create(Properties* properties)
     {
         audio->setLooped(properties->getBool("looped"));
     }
+    if (properties->exists("priority"))
+    {
+        audio->setPriority(properties->getInt("priority"));
+    }
     if (properties->exists("gain"))
     {
         audio->setGain(properties->getFloat("gain"));
@@ -116,47 +376,72 @@ AudioSource* AudioSource::create(Properties* properties)
 
 AudioSource::State AudioSource::getState() const
 {
-    ALint state;
-    AL_CHECK( alGetSourcei(_alSource, AL_SOURCE_STATE, &state) );
+    // A streamed source is stopped once the audio thread played its last play to the end.
+    if (_stream)
+        return _state == PLAYING && _stream->endedPlay == _stream->playCount ? STOPPED : _state;
 
-    switch (state)
-    {
-        case AL_PLAYING: 
-            return PLAYING;
-        case AL_PAUSED:  
-            return PAUSED;
-        case AL_STOPPED: 
-            return STOPPED;
-        default:         
-            return INITIAL;
-    }
-    return INITIAL;
+    // A source that reached the end of its sound is only stopped at the next voice update.
+    return _state == PLAYING && hasEnded() ? STOPPED : _state;
 }
 
 void AudioSource::play()
 {
-    AL_CHECK( alSourcePlay(_alSource) );
-
-    // Add the source to the controller's list of currently playing sources.
     AudioController* audioController = Game::getInstance()->getAudioController();
     GP_ASSERT(audioController);
-    if (audioController->_playingSources.find(this) == audioController->_playingSources.end())
-        audioController->_playingSources.insert(this);
+
+    if (_stream)
+    {
+        // Playing a source that is not paused plays it from the beginning, as for sources that are loaded whole.
+        bool restart = getState() != PAUSED;
+        _state = PLAYING;
+        audioController->postStreamCommand(AudioController::STREAM_PLAY, this, restart, ++_stream->playCount);
+    }
+    else
+    {
+        // Playing a source that is not paused plays it from the beginning.
+        releaseVoice();
+        if (_state != PAUSED)
+            _offset = 0.0f;
+        _offsetTime = Game::getGameTime();
+        _state = PLAYING;
+        _buffer->markUsed();
+    }
+
+    // Add the source to the controller's list of currently playing sources.
+    audioController->addPlayingSource(this);
+
+    if (!_stream && !acquireVoice())
+    {
+        // The source is virtual until the next voice update, which may find it a voice.
+        audioController->_voicesDirty = true;
+    }
 }
 
 void AudioSource::pause()
 {
-    AL_CHECK( alSourcePause(_alSource) );
+    AudioController* audioController = Game::getInstance()->getAudioController();
+    GP_ASSERT(audioController);
+
+    if (_stream)
+    {
+        if (getState() == PLAYING)
+        {
+            _state = PAUSED;
+            audioController->postStreamCommand(AudioController::STREAM_PAUSE, this);
+        }
+    }
+    else if (_state == PLAYING)
+    {
+        // The voice is given back, and the source picks up where it was when it is resumed.
+        releaseVoice();
+        _state = PAUSED;
+    }
 
     // Remove the source from the controller's set of currently playing sources
     // if the source is being paused by the user and not the controller itself.
-    AudioController* audioController = Game::getInstance()->getAudioController();
-    GP_ASSERT(audioController);
     if (audioController->_pausingSource != this)
     {
-        std::set<AudioSource*>::iterator iter = audioController->_playingSources.find(this);
-        if (iter != audioController->_playingSources.end())
-            audioController->_playingSources.erase(iter);
+        audioController->removePlayingSource(this);
     }
 }
 
@@ -170,19 +455,51 @@ void AudioSource::resume()
 
 void AudioSource::stop()
 {
-    AL_CHECK( alSourceStop(_alSource) );
-
-    // Remove the source from the controller's set of currently playing sources.
     AudioController* audioController = Game::getInstance()->getAudioController();
     GP_ASSERT(audioController);
-    std::set<AudioSource*>::iterator iter = audioController->_playingSources.find(this);
-    if (iter != audioController->_playingSources.end())
-        audioController->_playingSources.erase(iter);
+
+    if (_stream)
+    {
+        audioController->postStreamCommand(AudioController::STREAM_STOP, this);
+        _state = STOPPED;
+    }
+    else
+    {
+        releaseVoice();
+        _state = STOPPED;
+        _offset = 0.0f;
+    }
+
+    // Remove the source from the controller's set of currently playing sources.
+    audioController->removePlayingSource(this);
 }
 
 void AudioSource::rewind()
 {
-    AL_CHECK( alSourceRewind(_alSource) );
+    AudioController* audioController = Game::getInstance()->getAudioController();
+    GP_ASSERT(audioController);
+
+    if (_stream)
+    {
+        // Rewinding a streamed source would only replay its queued buffers, so its file is decoded again.
+        bool playing = getState() == PLAYING;
+        audioController->postStreamCommand(AudioController::STREAM_STOP, this);
+        _state = INITIAL;
+        if (playing)
+        {
+            play();
+            return;
+        }
+    }
+    else
+    {
+        // As with OpenAL, a rewound source is back to its initial state.
+        releaseVoice();
+        _state = INITIAL;
+        _offset = 0.0f;
+    }
+
+    audioController->removePlayingSource(this);
 }
 
 bool AudioSource::isLooped() const
@@ -192,10 +509,21 @@ bool AudioSource::isLooped() const
 
 void AudioSource::setLooped(bool looped)
 {
-    AL_CHECK( alSourcei(_alSource, AL_LOOPING, (looped) ? AL_TRUE : AL_FALSE) );
-    if (AL_LAST_ERROR())
+    // A streamed source loops by rewinding its file when it is decoded to the end.
+    if (_stream)
     {
-        GP_ERROR("Failed to set audio source's looped attribute with error: %d", AL_LAST_ERROR());
+        _stream->looped = looped;
+        _looped = looped;
+        return;
+    }
+
+    if (_alSource)
+    {
+        AL_CHECK( alSourcei(_alSource, AL_LOOPING, (looped) ? AL_TRUE : AL_FALSE) );
+        if (AL_LAST_ERROR())
+        {
+            GP_ERROR("Failed to set audio source's looped attribute with error: %d", AL_LAST_ERROR());
+        }
     }
     _looped = looped;
 }
@@ -207,7 +535,8 @@ float AudioSource::getGain() const
 
 void AudioSource::setGain(float gain)
 {
-    AL_CHECK( alSourcef(_alSource, AL_GAIN, gain) );
+    if (_alSource)
+        AL_CHECK( alSourcef(_alSource, AL_GAIN, gain) );
     _gain = gain;
 }
 
@@ -218,7 +547,16 @@ float AudioSource::getPitch() const
 
 void AudioSource::setPitch(float pitch)
 {
-    AL_CHECK( alSourcef(_alSource, AL_PITCH, pitch) );
+    if (_alSource)
+    {
+        AL_CHECK( alSourcef(_alSource, AL_PITCH, pitch) );
+    }
+    else if (_state == PLAYING)
+    {
+        // The position of a virtual source advances with its pitch, so it is brought up to date first.
+        _offset = getOffset();
+        _offsetTime = Game::getGameTime();
+    }
     _pitch = pitch;
 }
 
@@ -229,7 +567,8 @@ const Vector3& AudioSource::getVelocity() const
 
 void AudioSource::setVelocity(const Vector3& velocity)
 {
-    AL_CHECK( alSourcefv(_alSource, AL_VELOCITY, (ALfloat*)&velocity) );
+    if (_alSource)
+        AL_CHECK( alSourcefv(_alSource, AL_VELOCITY, (ALfloat*)&velocity) );
     _velocity = velocity;
 }
 
@@ -238,6 +577,21 @@ void AudioSource::setVelocity(float x, float y, float z)
     setVelocity(Vector3(x, y, z));
 }
 
+int AudioSource::getPriority() const
+{
+    return _priority;
+}
+
+void AudioSource::setPriority(int priority)
+{
+    _priority = priority;
+}
+
+bool AudioSource::isVirtual() const
+{
+    return _alSource == 0;
+}
+
 Node* AudioSource::getNode() const
 {
     return _node;
@@ -265,9 +619,195 @@ void AudioSource::setNode(Node* node)
     }
 }
 
+bool AudioSource::isStreamed() const
+{
+    return _stream != NULL;
+}
+
+bool AudioSource::acquireVoice()
+{
+    if (_alSource)
+        return true;
+
+    AudioController* audioController = Game::getInstance()->getAudioController();
+    GP_ASSERT(audioController);
+    ALuint voice = audioController->allocateVoice();
+    if (voice == 0)
+        return false;
+
+    float offset = getOffset();
+
+    // OpenAL does not accept data for a buffer attached to a source, so the buffer is attached once loaded.
+    _buffer->finishLoading();
+    _alSource = voice;
+    AL_CHECK( alSourcei(_alSource, AL_BUFFER, _buffer->_alBuffer) );
+    AL_CHECK( alSourcei(_alSource, AL_LOOPING, _looped) );
+    AL_CHECK( alSourcef(_alSource, AL_PITCH, _pitch) );
+    AL_CHECK( alSourcef(_alSource, AL_GAIN, _gain) );
+    AL_CHECK( alSourcefv(_alSource, AL_VELOCITY, (const ALfloat*)&_velocity) );
+    Vector3 translation = _node ? _node->getTranslationWorld() : Vector3::zero();
+    AL_CHECK( alSourcefv(_alSource, AL_POSITION, (const ALfloat*)&translation.x) );
+
+    // Pick up where the source was while it was virtual.
+    float duration = _buffer->_duration;
+    if (_looped && duration > 0.0f)
+        offset = fmodf(offset, duration);
+    if (offset > 0.0f && offset < duration)
+        AL_CHECK( alSourcef(_alSource, AL_SEC_OFFSET, offset) );
+    if (_state == PLAYING)
+        AL_CHECK( alSourcePlay(_alSource) );
+    return true;
+}
+
+void AudioSource::releaseVoice()
+{
+    // Streamed sources keep their OpenAL source.
+    if (_stream)
+        return;
+
+    if (_state == PLAYING)
+    {
+        _offset = getOffset();
+        _offsetTime = Game::getGameTime();
+    }
+    if (_alSource == 0)
+        return;
+
+    AL_CHECK( alSourceStop(_alSource) );
+    AL_CHECK( alSourcei(_alSource, AL_BUFFER, 0) );
+
+    // The controller is gone when sources are released after the game shut down, and the voice went with the context.
+    AudioController* audioController = Game::getInstance()->getAudioController();
+    if (audioController)
+        audioController->freeVoice(_alSource);
+    _alSource = 0;
+}
+
+float AudioSource::getOffset() const
+{
+    if (_alSource)
+    {
+        ALfloat offset = 0.0f;
+        AL_CHECK( alGetSourcef(_alSource, AL_SEC_OFFSET, &offset) );
+        return offset;
+    }
+    if (_state != PLAYING)
+        return _offset;
+    return _offset + (float)((Game::getGameTime() - _offsetTime) * 0.001) * _pitch;
+}
+
+bool AudioSource::hasEnded() const
+{
+    if (_state != PLAYING || _looped)
+        return false;
+
+    if (_alSource)
+    {
+        ALint state;
+        AL_CHECK( alGetSourcei(_alSource, AL_SOURCE_STATE, &state) );
+        return state == AL_STOPPED;
+    }
+
+    // The duration is not known until the buffer is decoded.
+    return _buffer->_duration > 0.0f && getOffset() >= _buffer->_duration;
+}
+
+bool AudioSource::isAudible() const
+{
+    return _audibility >= AUDIO_MIN_AUDIBILITY;
+}
+
+void AudioSource::prepareStream(StreamState* stream)
+{
+    GP_ASSERT(stream);
+    stream->decode();
+}
+
+void AudioSource::playStream(StreamState* stream, bool restart, unsigned int play)
+{
+    GP_ASSERT(stream);
+
+    if (restart && stream->started)
+        stream->reset();
+
+    // The first chunks are decoded when the stream is opened or reset, so this rarely decodes.
+    stream->play = play;
+    stream->decode();
+    stream->queue();
+    stream->decode();
+    stream->started = true;
+    AL_CHECK( alSourcePlay(stream->source) );
+}
+
+void AudioSource::pauseStream(StreamState* stream)
+{
+    GP_ASSERT(stream);
+    AL_CHECK( alSourcePause(stream->source) );
+}
+
+void AudioSource::stopStream(StreamState* stream)
+{
+    GP_ASSERT(stream);
+    stream->reset();
+}
+
+bool AudioSource::updateStream(StreamState* stream)
+{
+    GP_ASSERT(stream);
+
+    // Take back the buffers the source played.
+    ALint processed = 0;
+    AL_CHECK( alGetSourcei(stream->source, AL_BUFFERS_PROCESSED, &processed) );
+    while (processed-- > 0)
+    {
+        ALuint buffer;
+        AL_CHECK( alSourceUnqueueBuffers(stream->source, 1, &buffer) );
+        stream->freeBuffers[stream->freeBufferCount++] = buffer;
+    }
+
+    stream->queue();
+    stream->decode();
+    stream->queue();
+
+    ALint state;
+    ALint queued = 0;
+    AL_CHECK( alGetSourcei(stream->source, AL_SOURCE_STATE, &state) );
+    AL_CHECK( alGetSourcei(stream->source, AL_BUFFERS_QUEUED, &queued) );
+    if (state != AL_STOPPED)
+        return true;
+
+    // A source that ran out of buffers before the next chunk was decoded stops, and is restarted.
+    if (queued > 0)
+    {
+        AL_CHECK( alSourcePlay(stream->source) );
+        return true;
+    }
+    if (!stream->endOfStream)
+        return true;
+
+    stream->endedPlay = stream->play;
+    return false;
+}
+
+void AudioSource::destroyStream(StreamState* stream)
+{
+    GP_ASSERT(stream);
+
+    // The buffers must be detached from the source before they can be deleted.
+    AL_CHECK( alSourceStop(stream->source) );
+    AL_CHECK( alSourcei(stream->source, AL_BUFFER, 0) );
+    AL_CHECK( alDeleteBuffers(AUDIO_STREAM_BUFFER_COUNT, stream->buffers) );
+    AL_CHECK( alDeleteSources(1, &stream->source) );
+
+    // Clearing the ogg file closes its stream.
+    ov_clear(&stream->ogg);
+    SAFE_DELETE(stream->file);
+    SAFE_DELETE(stream);
+}
+
 void AudioSource::transformChanged(Transform* transform, long cookie)
 {
-    if (_node)
+    if (_node && _alSource)
     {
         Vector3 translation = _node->getTranslationWorld();
         AL_CHECK( alSourcefv(_alSource, AL_POSITION, (const ALfloat*)&translation.x) );
@@ -276,18 +816,21 @@ void AudioSource::transformChanged(Transform* transform, long cookie)
 
 AudioSource* AudioSource::clone(NodeCloneContext &context) const
 {
-    GP_ASSERT(_buffer);
-
-    ALuint alSource = 0;
-    AL_CHECK( alGenSources(1, &alSource) );
-    if (AL_LAST_ERROR())
+    AudioSource* audioClone;
+    if (_stream)
     {
-        GP_ERROR("Error generating audio source.");
-        return NULL;
+        // Streamed sources do not share their data, so the clone opens the file again.
+        audioClone = AudioSource::create(_stream->path.c_str(), true);
+        if (audioClone == NULL)
+            return NULL;
     }
-    AudioSource* audioClone = new AudioSource(_buffer, alSource);
-
-    _buffer->addRef();
+    else
+    {
+        GP_ASSERT(_buffer);
+        audioClone = new AudioSource(_buffer, 0);
+        _buffer->addRef();
+    }
+    audioClone->setPriority(getPriority());
     audioClone->setLooped(isLooped());
     audioClone->setGain(getGain());
     audioClone->setPitch(getPitch());
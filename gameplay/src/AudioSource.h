@@ -37,12 +37,19 @@ public:
      * Create an audio source. This is used to instantiate an Audio Source. Currently only wav, au, and raw files are supported.
      * Alternately, a URL specifying a Properties object that defines an audio source can be used (where the URL is of the format
      * "<file-path>.<extension>#<namespace-id>/<namespace-id>/.../<namespace-id>" and "#<namespace-id>/<namespace-id>/.../<namespace-id>" is optional).
+     *
+     * A streamed source decodes its ogg file while it plays, a chunk at a time on the audio thread of the
+     * AudioController, into a small ring of buffers, instead of decoding the whole file into memory when it is
+     * created. Streaming suits music and long ambient sounds. Streamed sources do not share their data, so
+     * short sounds that are played often should not be streamed. Only ogg files can be streamed; other files
+     * are loaded whole. A .audio file selects streaming with the 'streamed' property.
      * 
      * @param url The relative location on disk of the sound file or a URL specifying a Properties object defining an audio source.
+     * @param streamed true to stream the sound file, false to load it whole.
      * @return The newly created audio source, or NULL if an audio source cannot be created.
      * @script{create}
      */
-    static AudioSource* create(const char* url);
+    static AudioSource* create(const char* url, bool streamed = false);
 
     /**
      * Create an audio source from the given properties object.
@@ -157,10 +164,47 @@ public:
      */
     Node* getNode() const;
 
+    /**
+     * Determines whether the audio source is streamed.
+     *
+     * @return true if the audio source is streamed, false if it was loaded whole.
+     */
+    bool isStreamed() const;
+
+    /**
+     * Returns the priority of the audio source.
+     *
+     * @return The priority.
+     */
+    int getPriority() const;
+
+    /**
+     * Sets the priority of the audio source.
+     *
+     * When more sources play than there are voices, the sources with the highest priority
+     * get the voices first, and the loudest sources at the listener among those of equal
+     * priority. The default priority is 0.
+     *
+     * @param priority The priority.
+     */
+    void setPriority(int priority);
+
+    /**
+     * Determines whether the audio source is virtual, that is, whether it has no voice to play on.
+     *
+     * A virtual source that plays keeps track of its position in its sound, and continues
+     * from there when it gets a voice. Streamed sources are never virtual.
+     *
+     * @return true if the source has no voice, false otherwise.
+     */
+    bool isVirtual() const;
+
 private:
 
+    struct StreamState;
+
     /**
-     * Constructor that takes an AudioBuffer.
+     * Constructor that takes an AudioBuffer, or NULL for a streamed source.
      */
     AudioSource(AudioBuffer* buffer, ALuint source);
 
@@ -193,13 +237,89 @@ private:
      */
     AudioSource* clone(NodeCloneContext &context) const;
 
-    ALuint _alSource;
+    /**
+     * Takes a voice from the audio controller and sets it up to play from the current position.
+     *
+     * @return true if the source has a voice, false if no voice is free.
+     */
+    bool acquireVoice();
+
+    /**
+     * Gives the voice back to the audio controller, keeping track of the position in the sound.
+     */
+    void releaseVoice();
+
+    /**
+     * Returns the position in the sound, in seconds.
+     */
+    float getOffset() const;
+
+    /**
+     * Determines whether a playing source reached the end of its sound.
+     */
+    bool hasEnded() const;
+
+    /**
+     * Determines whether the source was loud enough to hear at the last voice update.
+     */
+    bool isAudible() const;
+
+    /**
+     * Opens an ogg file for streaming.
+     */
+    static StreamState* openStream(const char* path);
+
+    /**
+     * Decodes the first chunks of a stream, so it is ready to play. Called on the audio thread.
+     */
+    static void prepareStream(StreamState* stream);
+
+    /**
+     * Queues the decoded chunks of a stream and plays its OpenAL source. Called on the audio thread.
+     *
+     * @param stream The stream.
+     * @param restart Whether to play the stream from the beginning of its file.
+     * @param play The number of times the source was played, which is reported once the stream ends.
+     */
+    static void playStream(StreamState* stream, bool restart, unsigned int play);
+
+    /**
+     * Pauses the OpenAL source of a stream. Called on the audio thread.
+     */
+    static void pauseStream(StreamState* stream);
+
+    /**
+     * Stops a stream and rewinds it to the beginning of its file. Called on the audio thread.
+     */
+    static void stopStream(StreamState* stream);
+
+    /**
+     * Takes back the buffers a stream played, and refills them with decoded chunks. Called on the
+     * audio thread while the stream plays.
+     *
+     * @return false once the stream played to the end.
+     */
+    static bool updateStream(StreamState* stream);
+
+    /**
+     * Deletes a stream and its OpenAL source. Called on the audio thread.
+     */
+    static void destroyStream(StreamState* stream);
+
+    ALuint _alSource;                   // The voice of the source, or 0 while it is virtual.
     AudioBuffer* _buffer;
+    StreamState* _stream;
+    State _state;                       // The state of sources that are not streamed, which OpenAL only knows while they have a voice.
+    float _offset;                      // The position in the sound at _offsetTime, in seconds.
+    double _offsetTime;                 // The game time at which _offset was taken.
+    int _priority;
+    float _audibility;                  // The gain at the listener at the last voice update.
     bool _looped;
     float _gain;
     float _pitch;
     Vector3 _velocity;
     Node* _node;
+    int _playingIndex;
 };
 
 }
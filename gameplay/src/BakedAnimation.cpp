@@ -0,0 +1,395 @@
+#include "Base.h"
+#include "BakedAnimation.h"
+#include "Animation.h"
+#include "AnimationClip.h"
+#include "GLStateCache.h"
+#include "Game.h"
+#include "Joint.h"
+#include "MeshPart.h"
+#include "Model.h"
+#include "RenderState.h"
+
+namespace gameplay
+{
+
+BakedAnimation::BakedAnimation()
+    : _mesh(NULL), _frameRate(0.0f), _positions(NULL), _normals(NULL)
+{
+}
+
+BakedAnimation::~BakedAnimation()
+{
+    SAFE_RELEASE(_mesh);
+    SAFE_RELEASE(_positions);
+    SAFE_RELEASE(_normals);
+}
+
+bool BakedAnimation::isSupported()
+{
+    // Float textures are core wherever the transform feedback of skin caches is supported.
+    return MeshSkin::isCacheSupported();
+}
+
+/**
+ * Creates a texture of floating point texels with the specified data.
+ */
+static Texture* createFloatTexture(unsigned int width, unsigned int height, const float* data)
+{
+    GLuint handle;
+    GL_ASSERT( glGenTextures(1, &handle) );
+    GLStateCache::bindTexture(GL_TEXTURE_2D, handle);
+    GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST) );
+    GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST) );
+    GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 1) );
+#if defined(OPENGL_ES)
+    GL_ASSERT( glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_FLOAT, data) );
+#else
+    GL_ASSERT( glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, data) );
+#endif
+    GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 4) );
+    GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+
+    return Texture::create(handle, width, height);
+}
+
+/**
+ * Creates a sampler that reads texels exactly, since the shader blends the frames itself.
+ */
+static Texture::Sampler* createSampler(Texture* texture)
+{
+    Texture::Sampler* sampler = Texture::Sampler::create(texture);
+    sampler->setFilterMode(Texture::NEAREST, Texture::NEAREST);
+    sampler->setWrapMode(Texture::CLAMP, Texture::CLAMP);
+    texture->release();
+    return sampler;
+}
+
+/**
+ * Returns the offset in floats of the element of a vertex format with the specified usage, or -1.
+ */
+static int getElementOffset(const VertexFormat& format, VertexFormat::Usage usage)
+{
+    unsigned int offset = 0;
+    for (unsigned int i = 0, count = format.getElementCount(); i < count; ++i)
+    {
+        const VertexFormat::Element& e = format.getElement(i);
+        if (e.usage == usage)
+            return (int)offset;
+        offset += e.size;
+    }
+    return -1;
+}
+
+BakedAnimation* BakedAnimation::create(Model* model, Animation* animation, float frameRate, const char** clipIds, unsigned int clipCount)
+{
+    GP_ASSERT(model);
+    GP_ASSERT(animation);
+    GP_ASSERT(frameRate > 0.0f);
+
+    if (!isSupported())
+    {
+        GP_WARN("Animations cannot be baked, since transform feedback is not supported.");
+        return NULL;
+    }
+    MeshSkin* skin = model->getSkin();
+    if (skin == NULL || skin->getJointCount() == 0 || skin->isSkeletonShared())
+    {
+        GP_WARN("Animation '%s' cannot be baked, since the model has no skin with joints.", animation->getId());
+        return NULL;
+    }
+    if (!animation->isLoaded() && !animation->load())
+    {
+        GP_WARN("Failed to load the curves of animation '%s'.", animation->getId());
+        return NULL;
+    }
+
+    std::vector<AnimationClip*> clips;
+    if (clipIds)
+    {
+        for (unsigned int i = 0; i < clipCount; ++i)
+        {
+            AnimationClip* clip = animation->getClip(clipIds[i]);
+            if (clip == NULL)
+            {
+                GP_WARN("Animation '%s' has no clip '%s' to bake.", animation->getId(), clipIds[i]);
+                return NULL;
+            }
+            clips.push_back(clip);
+        }
+    }
+    else if (animation->getClipCount() > 0)
+    {
+        for (unsigned int i = 0, count = animation->getClipCount(); i < count; ++i)
+            clips.push_back(animation->getClip(i));
+    }
+    else
+    {
+        clips.push_back(animation->getClip());
+    }
+
+    // The vertices of each frame take whole rows, and the frames of all clips are stacked.
+    Mesh* mesh = model->getMesh();
+    GP_ASSERT(mesh);
+    const unsigned int vertexCount = mesh->getVertexCount();
+    GLint maxSize = 0;
+    GL_ASSERT( glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize) );
+    const unsigned int width = std::min(vertexCount, (unsigned int)maxSize);
+    const unsigned int rowsPerFrame = (vertexCount + width - 1) / width;
+
+    BakedAnimation* baked = new BakedAnimation();
+    baked->_frameRate = frameRate;
+    unsigned int frameCount = 0;
+    for (size_t i = 0; i < clips.size(); ++i)
+    {
+        Clip clip;
+        clip.id = clips[i]->getId();
+        clip.firstFrame = frameCount;
+        clip.frameCount = std::max(1u, (unsigned int)(clips[i]->getDuration() * 0.001f * frameRate + 0.5f));
+        baked->_clips.push_back(clip);
+        frameCount += clip.frameCount;
+    }
+    const unsigned int height = frameCount * rowsPerFrame;
+    if (height > (unsigned int)maxSize)
+    {
+        GP_WARN("Animation '%s' has too many frames to bake at %g frames per second.", animation->getId(), frameRate);
+        SAFE_RELEASE(baked);
+        return NULL;
+    }
+
+    // Keep the pose of the joints, which sampling the clips changes.
+    const unsigned int jointCount = skin->getJointCount();
+    std::vector<Skeleton::JointTransform> pose(jointCount);
+    for (unsigned int i = 0; i < jointCount; ++i)
+    {
+        Joint* joint = skin->getJoint(i);
+        GP_ASSERT(joint);
+        pose[i].scale = joint->getScale();
+        pose[i].rotation = joint->getRotation();
+        pose[i].translation = joint->getTranslation();
+    }
+
+    const bool cacheEnabled = skin->isCacheEnabled();
+    std::vector<float> positions(width * height * 4, 0.0f);
+    std::vector<unsigned char> normals;
+    std::vector<float> vertices;
+    std::vector<VertexFormat::Element> elements;
+    Vector3 min(FLT_MAX, FLT_MAX, FLT_MAX);
+    Vector3 max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    bool succeeded = true;
+    for (size_t c = 0; c < clips.size() && succeeded; ++c)
+    {
+        const Clip& clip = baked->_clips[c];
+        for (unsigned int f = 0; f < clip.frameCount; ++f)
+        {
+            // Skin the vertices in the pose of the frame into the cache of the mesh, and read them back.
+            clips[c]->sample(f * 1000.0f / frameRate);
+            MeshSkin::Cache* cache = skin->updateCache(mesh);
+            if (cache == NULL)
+            {
+                succeeded = false;
+                break;
+            }
+
+            const VertexFormat& format = cache->skinnedMesh->getVertexFormat();
+            const unsigned int stride = format.getVertexSize() / sizeof(float);
+            const int positionOffset = getElementOffset(format, VertexFormat::POSITION);
+            const int normalOffset = getElementOffset(format, VertexFormat::NORMAL);
+            GP_ASSERT(positionOffset >= 0);
+            if (normalOffset >= 0 && normals.empty())
+                normals.assign(width * height * 4, 0);
+
+            const float* data = NULL;
+#ifdef USE_MAP_BUFFER_RANGE
+            GLStateCache::bindBuffer(GL_ARRAY_BUFFER, cache->skinnedMesh->getVertexBuffer());
+            data = (const float*)glMapBufferRange(GL_ARRAY_BUFFER, 0, vertexCount * stride * sizeof(float), GL_MAP_READ_BIT);
+#endif
+            if (data == NULL)
+            {
+                GP_WARN("Failed to read back the skinned vertices of mesh '%s'.", mesh->getUrl());
+                GLStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
+                succeeded = false;
+                break;
+            }
+
+            // The mesh that plays the animation back starts in the first frame.
+            if (vertices.empty())
+            {
+                for (unsigned int i = 0, count = format.getElementCount(); i < count; ++i)
+                    elements.push_back(format.getElement(i));
+                vertices.assign(data, data + vertexCount * stride);
+            }
+
+            const unsigned int frameStart = (clip.firstFrame + f) * rowsPerFrame * width;
+            for (unsigned int v = 0; v < vertexCount; ++v)
+            {
+                const float* vertex = data + v * stride;
+                float* texel = &positions[(frameStart + v) * 4];
+                const Vector3 position(vertex[positionOffset], vertex[positionOffset + 1], vertex[positionOffset + 2]);
+                texel[0] = position.x;
+                texel[1] = position.y;
+                texel[2] = position.z;
+                texel[3] = 1.0f;
+                min.set(std::min(min.x, position.x), std::min(min.y, position.y), std::min(min.z, position.z));
+                max.set(std::max(max.x, position.x), std::max(max.y, position.y), std::max(max.z, position.z));
+
+                if (normalOffset >= 0)
+                {
+                    // Normals only need the precision of bytes, packed from [-1, 1] to [0, 255].
+                    Vector3 normal(vertex[normalOffset], vertex[normalOffset + 1], vertex[normalOffset + 2]);
+                    normal.normalize();
+                    unsigned char* packed = &normals[(frameStart + v) * 4];
+                    packed[0] = (unsigned char)(MATH_CLAMP(normal.x * 127.5f + 127.5f, 0.0f, 255.0f));
+                    packed[1] = (unsigned char)(MATH_CLAMP(normal.y * 127.5f + 127.5f, 0.0f, 255.0f));
+                    packed[2] = (unsigned char)(MATH_CLAMP(normal.z * 127.5f + 127.5f, 0.0f, 255.0f));
+                    packed[3] = 255;
+                }
+            }
+
+#ifdef USE_MAP_BUFFER_RANGE
+            GL_ASSERT( glUnmapBuffer(GL_ARRAY_BUFFER) );
+#endif
+            GLStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+    }
+
+    // Return the joints to their pose, and release the cache unless the skin uses it to draw.
+    for (unsigned int i = 0; i < jointCount; ++i)
+    {
+        skin->getJoint(i)->set(pose[i].scale, pose[i].rotation, pose[i].translation);
+    }
+    if (!cacheEnabled)
+        skin->clearCaches();
+
+    if (!succeeded)
+    {
+        GP_WARN("Failed to bake animation '%s'.", animation->getId());
+        SAFE_RELEASE(baked);
+        return NULL;
+    }
+
+    baked->_layout.set((float)width, (float)height, (float)rowsPerFrame, frameRate);
+    baked->_positions = createSampler(createFloatTexture(width, height, &positions[0]));
+    if (!normals.empty())
+        baked->_normals = createSampler(Texture::create(Texture::RGBA, width, height, &normals[0]));
+
+    // The mesh has the skinned vertices of the first frame, followed by the index of each vertex.
+    const unsigned int stride = (unsigned int)(vertices.size() / vertexCount);
+    elements.push_back(VertexFormat::Element(VertexFormat::TEXCOORD7, 1));
+    std::vector<float> vertexData(vertexCount * (stride + 1));
+    for (unsigned int v = 0; v < vertexCount; ++v)
+    {
+        float* vertex = &vertexData[v * (stride + 1)];
+        memcpy(vertex, &vertices[v * stride], stride * sizeof(float));
+        vertex[stride] = (float)v;
+    }
+    baked->_mesh = Mesh::createMesh(VertexFormat(&elements[0], (unsigned int)elements.size()), vertexCount);
+    baked->_mesh->setPrimitiveType(mesh->getPrimitiveType());
+    baked->_mesh->setVertexData(&vertexData[0]);
+
+    // The indices of the parts are copied from the buffers of the skinned mesh.
+    for (unsigned int i = 0, count = mesh->getPartCount(); i < count; ++i)
+    {
+        MeshPart* part = mesh->getPart(i);
+        MeshPart* copy = baked->_mesh->addPart(part->getPrimitiveType(), part->getIndexFormat(), part->getIndexCount());
+        const unsigned int indexSize = part->getIndexFormat() == Mesh::INDEX32 ? 4 : (part->getIndexFormat() == Mesh::INDEX16 ? 2 : 1);
+        const void* indices = NULL;
+#ifdef USE_MAP_BUFFER_RANGE
+        GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, part->getIndexBuffer());
+        indices = glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, part->getIndexOffset(), part->getIndexCount() * indexSize, GL_MAP_READ_BIT);
+#endif
+        if (indices)
+        {
+            copy->setIndexData(indices, 0, part->getIndexCount());
+#ifdef USE_MAP_BUFFER_RANGE
+            GL_ASSERT( glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER) );
+#endif
+        }
+        else
+        {
+            GP_WARN("Failed to read back the indices of part %u of mesh '%s'.", i, mesh->getUrl());
+        }
+        GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+
+    // The bounds hold the vertices of every frame, so animated instances are culled correctly.
+    BoundingBox box(min, max);
+    baked->_mesh->setBoundingBox(box);
+    BoundingSphere sphere;
+    sphere.set(box);
+    baked->_mesh->setBoundingSphere(sphere);
+
+    return baked;
+}
+
+Mesh* BakedAnimation::getMesh() const
+{
+    return _mesh;
+}
+
+float BakedAnimation::getFrameRate() const
+{
+    return _frameRate;
+}
+
+unsigned int BakedAnimation::getClipCount() const
+{
+    return (unsigned int)_clips.size();
+}
+
+const char* BakedAnimation::getClipId(unsigned int index) const
+{
+    GP_ASSERT(index < _clips.size());
+    return _clips[index].id.c_str();
+}
+
+int BakedAnimation::getClipIndex(const char* id) const
+{
+    GP_ASSERT(id);
+
+    for (size_t i = 0, count = _clips.size(); i < count; ++i)
+    {
+        if (_clips[i].id == id)
+            return (int)i;
+    }
+    return -1;
+}
+
+unsigned int BakedAnimation::getFrameCount(unsigned int index) const
+{
+    GP_ASSERT(index < _clips.size());
+    return _clips[index].frameCount;
+}
+
+Vector4 BakedAnimation::getClipParameters(unsigned int index, float timeOffset, float speed) const
+{
+    GP_ASSERT(index < _clips.size());
+    return Vector4((float)_clips[index].firstFrame, (float)_clips[index].frameCount, timeOffset, speed);
+}
+
+Texture* BakedAnimation::getPositionTexture() const
+{
+    return _positions ? _positions->getTexture() : NULL;
+}
+
+Texture* BakedAnimation::getNormalTexture() const
+{
+    return _normals ? _normals->getTexture() : NULL;
+}
+
+void BakedAnimation::bind(RenderState* renderState)
+{
+    GP_ASSERT(renderState);
+
+    renderState->getParameter("u_vertexAnimationPositions")->setValue(_positions);
+    if (_normals)
+        renderState->getParameter("u_vertexAnimationNormals")->setValue(_normals);
+    renderState->getParameter("u_vertexAnimationLayout")->setValue(&_layout, 1);
+    renderState->getParameter("u_vertexAnimationTime")->bindValue(this, &BakedAnimation::getTime);
+}
+
+float BakedAnimation::getTime() const
+{
+    return (float)(Game::getGameTime() * 0.001);
+}
+
+}
@@ -0,0 +1,219 @@
+#ifndef BAKEDANIMATION_H_
+#define BAKEDANIMATION_H_
+
+#include "Ref.h"
+#include "Texture.h"
+#include "Vector4.h"
+
+namespace gameplay
+{
+
+class Animation;
+class Mesh;
+class Model;
+class RenderState;
+
+/**
+ * Defines the clips of the animation of a skinned model, baked into textures that hold the
+ * position and normal of every vertex in every frame, so they are played back on the GPU.
+ *
+ * A skinned model updates its joints and its matrix palette on the CPU for every frame it is
+ * drawn. That is what characters near the camera need, but background crowds only play a few
+ * looping clips that nobody looks at closely. A baked animation samples each clip at a fixed
+ * frame rate through the skin of a model, and the vertex shader reads the two frames around
+ * the current time and blends them, so an animated character costs no more CPU time than a
+ * static one. Baking skins the vertices with the transform feedback of MeshSkin caches, so it
+ * is only supported where isSupported() returns true.
+ *
+ * The baked animation has its own mesh, which has the vertex elements of the skinned mesh but
+ * the blend weights and indices, and the index of each vertex in the a_texCoord7 attribute.
+ * Its materials use shaders compiled with the VERTEX_ANIMATION define, which the built-in
+ * colored and textured shaders support, and are bound to the baked animation with bind().
+ * With the INSTANCED define, the clip of each instance of an InstancedModel is read from its
+ * instance parameters, so thousands of characters that each play their own clip from their
+ * own time are drawn with a single draw call per pass:
+ *
+ @verbatim
+    BakedAnimation* baked = BakedAnimation::create(model, animation);
+    Model* crowdModel = Model::create(baked->getMesh());
+    Material* material = crowdModel->setMaterial("res/shaders/textured.vert", "res/shaders/textured.frag", "INSTANCED;VERTEX_ANIMATION;DIRECTIONAL_LIGHT_COUNT 1");
+    baked->bind(material);
+
+    InstancedModel* crowd = InstancedModel::create(crowdModel);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        crowd->addInstance(nodes[i]);
+        crowd->setInstanceParameters(i, baked->getClipParameters(i % baked->getClipCount(), MATH_RANDOM_0_1() * 10.0f));
+    }
+ @endverbatim
+ *
+ * Without the INSTANCED define, the clip is set on the u_vertexAnimationClip uniform of the
+ * material instead.
+ *
+ * @script{ignore}
+ */
+class BakedAnimation : public Ref
+{
+public:
+
+    /**
+     * Determines whether animations can be baked on the current device.
+     *
+     * @return True if transform feedback and floating point textures are supported.
+     */
+    static bool isSupported();
+
+    /**
+     * Bakes the clips of an animation of a skinned model.
+     *
+     * The joints of the skin are returned to their current pose once the clips are baked.
+     *
+     * @param model The skinned model, whose skin has joints.
+     * @param animation The animation of the joints of the skin.
+     * @param frameRate The number of frames sampled per second of each clip.
+     * @param clipIds The IDs of the clips to bake, or NULL to bake all the clips of the animation.
+     * @param clipCount The number of IDs in clipIds.
+     *
+     * @return The baked animation, or NULL if it could not be baked.
+     */
+    static BakedAnimation* create(Model* model, Animation* animation, float frameRate = 30.0f,
+                                  const char** clipIds = NULL, unsigned int clipCount = 0);
+
+    /**
+     * Returns the mesh that the baked animation is played back on.
+     *
+     * @return The mesh, in the pose of the first frame of the first clip.
+     */
+    Mesh* getMesh() const;
+
+    /**
+     * Returns the number of frames sampled per second of each clip.
+     *
+     * @return The frame rate.
+     */
+    float getFrameRate() const;
+
+    /**
+     * Returns the number of baked clips.
+     *
+     * @return The number of clips.
+     */
+    unsigned int getClipCount() const;
+
+    /**
+     * Returns the ID of a baked clip.
+     *
+     * @param index The index of the clip.
+     *
+     * @return The ID of the AnimationClip the clip was baked from.
+     */
+    const char* getClipId(unsigned int index) const;
+
+    /**
+     * Returns the index of the baked clip with the specified ID.
+     *
+     * @param id The ID of the clip.
+     *
+     * @return The index of the clip, or -1 if no clip with the ID was baked.
+     */
+    int getClipIndex(const char* id) const;
+
+    /**
+     * Returns the number of frames of a baked clip.
+     *
+     * @param index The index of the clip.
+     *
+     * @return The number of frames.
+     */
+    unsigned int getFrameCount(unsigned int index) const;
+
+    /**
+     * Returns the parameters that play a baked clip, as the instance parameters of an
+     * InstancedModel or the value of the u_vertexAnimationClip uniform.
+     *
+     * Clips always loop. Giving the instances of a crowd different time offsets keeps them
+     * from moving in step.
+     *
+     * @param index The index of the clip.
+     * @param timeOffset The time in seconds added to the game time.
+     * @param speed The speed of the clip, by which the game time is multiplied.
+     *
+     * @return The first frame, the number of frames, the time offset and the speed.
+     */
+    Vector4 getClipParameters(unsigned int index, float timeOffset = 0.0f, float speed = 1.0f) const;
+
+    /**
+     * Returns the texture of the positions of the vertices in every frame.
+     *
+     * @return The texture.
+     */
+    Texture* getPositionTexture() const;
+
+    /**
+     * Returns the texture of the normals of the vertices in every frame.
+     *
+     * @return The texture, or NULL if the mesh has no normals.
+     */
+    Texture* getNormalTexture() const;
+
+    /**
+     * Binds the uniforms of the VERTEX_ANIMATION define of the built-in shaders to the baked
+     * animation: u_vertexAnimationPositions, u_vertexAnimationNormals, u_vertexAnimationLayout
+     * and u_vertexAnimationTime, which is the game time in seconds.
+     *
+     * The values are bound rather than copied, so this only needs to be called once, and
+     * the baked animation must not be released before the render state.
+     *
+     * @param renderState The material, technique or pass that plays back the animation.
+     */
+    void bind(RenderState* renderState);
+
+private:
+
+    /**
+     * A baked clip.
+     */
+    struct Clip
+    {
+        std::string id;
+        unsigned int firstFrame;
+        unsigned int frameCount;
+    };
+
+    /**
+     * Constructor.
+     */
+    BakedAnimation();
+
+    /**
+     * Destructor.
+     */
+    ~BakedAnimation();
+
+    /**
+     * Hidden copy constructor.
+     */
+    BakedAnimation(const BakedAnimation&);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    BakedAnimation& operator=(const BakedAnimation&);
+
+    /**
+     * Returns the game time in seconds, for the u_vertexAnimationTime uniform.
+     */
+    float getTime() const;
+
+    Mesh* _mesh;
+    float _frameRate;
+    std::vector<Clip> _clips;
+    Texture::Sampler* _positions;
+    Texture::Sampler* _normals;
+    // The width, height and rows per frame of the textures, and the frame rate.
+    Vector4 _layout;
+};
+
+}
+
+#endif
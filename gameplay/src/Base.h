@@ -80,9 +80,12 @@ extern void print(const char* format, ...);
 #else
 #define GP_ERROR(...) do \
     { \
-        gameplay::Logger::log(gameplay::Logger::LEVEL_ERROR, "%s -- ", __current__func__); \
-        gameplay::Logger::log(gameplay::Logger::LEVEL_ERROR, __VA_ARGS__); \
-        gameplay::Logger::log(gameplay::Logger::LEVEL_ERROR, "\n"); \
+        if (gameplay::Logger::isEnabled(gameplay::Logger::LEVEL_ERROR)) \
+        { \
+            gameplay::Logger::log(gameplay::Logger::LEVEL_ERROR, "%s -- ", __current__func__); \
+            gameplay::Logger::log(gameplay::Logger::LEVEL_ERROR, __VA_ARGS__); \
+            gameplay::Logger::log(gameplay::Logger::LEVEL_ERROR, "\n"); \
+        } \
         assert(0); \
         std::exit(-1); \
     } while (0)
@@ -91,9 +94,12 @@ extern void print(const char* format, ...);
 // Warning macro.
 #define GP_WARN(...) do \
     { \
-        gameplay::Logger::log(gameplay::Logger::LEVEL_WARN, "%s -- ", __current__func__); \
-        gameplay::Logger::log(gameplay::Logger::LEVEL_WARN, __VA_ARGS__); \
-        gameplay::Logger::log(gameplay::Logger::LEVEL_WARN, "\n"); \
+        if (gameplay::Logger::isEnabled(gameplay::Logger::LEVEL_WARN)) \
+        { \
+            gameplay::Logger::log(gameplay::Logger::LEVEL_WARN, "%s -- ", __current__func__); \
+            gameplay::Logger::log(gameplay::Logger::LEVEL_WARN, __VA_ARGS__); \
+            gameplay::Logger::log(gameplay::Logger::LEVEL_WARN, "\n"); \
+        } \
     } while (0)
 
 // Bullet Physics
@@ -184,6 +190,12 @@ extern void print(const char* format, ...);
 // Scripting
 using std::va_list;
 #include <lua.hpp>
+#ifdef GP_USE_LUAJIT
+    // LuaJIT 2.1 implements the Lua 5.1 API and parts of 5.2; these are the rest of the 5.2 functions the bindings use.
+    #define luaL_checkunsigned(state, n) ((unsigned int)(lua_Integer)luaL_checknumber(state, n))
+    #define lua_pushunsigned(state, n) lua_pushnumber(state, (lua_Number)(n))
+    #define lua_len(state, index) lua_pushinteger(state, (lua_Integer)lua_objlen(state, index))
+#endif
 
 #define WINDOW_VSYNC        1
 
@@ -197,9 +209,14 @@ using std::va_list;
     extern PFNGLDELETEVERTEXARRAYSOESPROC glDeleteVertexArrays;
     extern PFNGLGENVERTEXARRAYSOESPROC glGenVertexArrays;
     extern PFNGLISVERTEXARRAYOESPROC glIsVertexArray;
+    extern PFNGLGETPROGRAMBINARYOESPROC glGetProgramBinary;
+    extern PFNGLPROGRAMBINARYOESPROC glProgramBinary;
     #define GL_DEPTH24_STENCIL8 GL_DEPTH24_STENCIL8_OES
+    #define GL_PROGRAM_BINARY_LENGTH GL_PROGRAM_BINARY_LENGTH_OES
+    #define GL_NUM_PROGRAM_BINARY_FORMATS GL_NUM_PROGRAM_BINARY_FORMATS_OES
     #define glClearDepth glClearDepthf
     #define OPENGL_ES
+    #define USE_PROGRAM_BINARY
     #define USE_PVRTC
     #ifdef __arm__
         #define USE_NEON
@@ -212,18 +229,57 @@ using std::va_list;
     extern PFNGLDELETEVERTEXARRAYSOESPROC glDeleteVertexArrays;
     extern PFNGLGENVERTEXARRAYSOESPROC glGenVertexArrays;
     extern PFNGLISVERTEXARRAYOESPROC glIsVertexArray;
+    extern PFNGLGETPROGRAMBINARYOESPROC glGetProgramBinary;
+    extern PFNGLPROGRAMBINARYOESPROC glProgramBinary;
+    extern PFNGLGENQUERIESEXTPROC glGenQueries;
+    extern PFNGLDELETEQUERIESEXTPROC glDeleteQueries;
+    extern PFNGLQUERYCOUNTEREXTPROC glQueryCounter;
+    extern PFNGLGETQUERYOBJECTUIVEXTPROC glGetQueryObjectuiv;
+    extern PFNGLGETQUERYOBJECTUI64VEXTPROC glGetQueryObjectui64v;
+    extern PFNGLDISCARDFRAMEBUFFEREXTPROC glDiscardFramebuffer;
     #define GL_DEPTH24_STENCIL8 GL_DEPTH24_STENCIL8_OES
+    #define GL_PROGRAM_BINARY_LENGTH GL_PROGRAM_BINARY_LENGTH_OES
+    #define GL_NUM_PROGRAM_BINARY_FORMATS GL_NUM_PROGRAM_BINARY_FORMATS_OES
+    #define GL_TIMESTAMP GL_TIMESTAMP_EXT
+    #define GL_QUERY_RESULT GL_QUERY_RESULT_EXT
+    #define GL_QUERY_RESULT_AVAILABLE GL_QUERY_RESULT_AVAILABLE_EXT
+    #define GL_GPU_DISJOINT GL_GPU_DISJOINT_EXT
     #define glClearDepth glClearDepthf
     #define OPENGL_ES
+    #define USE_PROGRAM_BINARY
+    #define USE_TIMER_QUERY
+    #define USE_DISCARD_FRAMEBUFFER
 #elif WIN32
     #define WIN32_LEAN_AND_MEAN
     #define GLEW_STATIC
     #include <GL/glew.h>
     #define USE_VAO
+    #define USE_INSTANCED_ARRAYS
+    #define USE_PROGRAM_BINARY
+    #define USE_MAP_BUFFER_RANGE
+    #define USE_PIXEL_BUFFER_OBJECT
+    #define USE_OCCLUSION_QUERY
+    #define USE_TIMER_QUERY
+    #define USE_TRANSFORM_FEEDBACK
+    #define USE_TEXTURE_ARRAY
+    #define USE_BINDLESS_TEXTURE
+    #define USE_INVALIDATE_FRAMEBUFFER
+    #define USE_SAMPLER_OBJECTS
 #elif __linux__
         #define GLEW_STATIC
         #include <GL/glew.h>
         #define USE_VAO
+        #define USE_INSTANCED_ARRAYS
+        #define USE_PROGRAM_BINARY
+        #define USE_MAP_BUFFER_RANGE
+        #define USE_PIXEL_BUFFER_OBJECT
+        #define USE_OCCLUSION_QUERY
+        #define USE_TIMER_QUERY
+        #define USE_TRANSFORM_FEEDBACK
+        #define USE_TEXTURE_ARRAY
+        #define USE_BINDLESS_TEXTURE
+        #define USE_INVALIDATE_FRAMEBUFFER
+        #define USE_SAMPLER_OBJECTS
 #elif __APPLE__
     #include "TargetConditionals.h"
     #if TARGET_OS_IPHONE || TARGET_IPHONE_SIMULATOR
@@ -233,10 +289,21 @@ using std::va_list;
         #define glDeleteVertexArrays glDeleteVertexArraysOES
         #define glGenVertexArrays glGenVertexArraysOES
         #define glIsVertexArray glIsVertexArrayOES
+        #define glGenQueries glGenQueriesEXT
+        #define glDeleteQueries glDeleteQueriesEXT
+        #define glBeginQuery glBeginQueryEXT
+        #define glEndQuery glEndQueryEXT
+        #define glGetQueryObjectuiv glGetQueryObjectuivEXT
+        #define GL_QUERY_RESULT GL_QUERY_RESULT_EXT
+        #define GL_QUERY_RESULT_AVAILABLE GL_QUERY_RESULT_AVAILABLE_EXT
+        #define GL_ANY_SAMPLES_PASSED_CONSERVATIVE GL_ANY_SAMPLES_PASSED_CONSERVATIVE_EXT
         #define GL_DEPTH24_STENCIL8 GL_DEPTH24_STENCIL8_OES
+        #define glDiscardFramebuffer glDiscardFramebufferEXT
         #define glClearDepth glClearDepthf
         #define OPENGL_ES
         #define USE_VAO
+        #define USE_OCCLUSION_QUERY
+        #define USE_DISCARD_FRAMEBUFFER
         #ifdef __arm__
             #define USE_NEON
         #endif
@@ -248,11 +315,23 @@ using std::va_list;
         #define glGenVertexArrays glGenVertexArraysAPPLE
         #define glIsVertexArray glIsVertexArrayAPPLE
         #define USE_VAO
+        #define USE_PIXEL_BUFFER_OBJECT
+        #define USE_OCCLUSION_QUERY
     #else
         #error "Unsupported Apple Device"
     #endif
 #endif
 
+// Use SSE optimized math on x86 processors that support it.
+#if !defined(USE_NEON) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+    #define USE_SSE
+#endif
+
+// Use the AVX variants of the SSE math when the compiler targets AVX (-mavx or /arch:AVX).
+#if defined(USE_SSE) && defined(__AVX__)
+    #define USE_AVX
+#endif
+
 // Graphics (GLSL)
 #define VERTEX_ATTRIBUTE_POSITION_NAME              "a_position"
 #define VERTEX_ATTRIBUTE_NORMAL_NAME                "a_normal"
@@ -262,6 +341,8 @@ using std::va_list;
 #define VERTEX_ATTRIBUTE_BLENDWEIGHTS_NAME          "a_blendWeights"
 #define VERTEX_ATTRIBUTE_BLENDINDICES_NAME          "a_blendIndices"
 #define VERTEX_ATTRIBUTE_TEXCOORD_PREFIX_NAME       "a_texCoord"
+#define VERTEX_ATTRIBUTE_INSTANCE_MATRIX_NAME       "a_instanceMatrix"
+#define VERTEX_ATTRIBUTE_INSTANCE_PARAMETERS_NAME   "a_instanceParameters"
 
 // Hardware buffer
 namespace gameplay
@@ -329,13 +329,12 @@ void BoundingBox::transform(const Matrix& matrix)
     Vector3 corners[8];
     getCorners(corners);
 
-    // Transform the corners, recalculating the min and max points along the way.
-    matrix.transformPoint(&corners[0]);
+    // Transform the corners, then recalculate the min and max points.
+    matrix.transformPoints(corners, corners, 8);
     Vector3 newMin = corners[0];
     Vector3 newMax = corners[0];
     for (int i = 1; i < 8; i++)
     {
-        matrix.transformPoint(&corners[i]);
         updateMinMax(&corners[i], &newMin, &newMax);
     }
     this->min.x = newMin.x;
@@ -1,12 +1,27 @@
 #include "Base.h"
+#include "Profiler.h"
 #include "Bundle.h"
 #include "FileSystem.h"
+#include "Mutex.h"
 #include "MeshPart.h"
 #include "Scene.h"
 #include "Joint.h"
 
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
+
 #define BUNDLE_VERSION_MAJOR            1
-#define BUNDLE_VERSION_MINOR            2
+#define BUNDLE_VERSION_MINOR            8
+#define BUNDLE_VERSION_MINOR_MIN        2
+
+// The size of the header of version 1.8 bundles: the identifier, the version and the flags.
+#define BUNDLE_HEADER_SIZE              15
+
+// The flag of bundles whose contents are compressed in LZ4 blocks.
+#define BUNDLE_FLAG_LZ4                 1
 
 #define BUNDLE_TYPE_SCENE               1
 #define BUNDLE_TYPE_NODE                2
@@ -21,19 +36,64 @@
 #define BUNDLE_TYPE_MESH                34
 #define BUNDLE_TYPE_MESHPART            35
 #define BUNDLE_TYPE_MESHSKIN            36
+#define BUNDLE_TYPE_NAVIGATIONMESH      40
 #define BUNDLE_TYPE_FONT                128
 
 // For sanity checking string reads
 #define BUNDLE_MAX_STRING_LENGTH        5000
 
+// The formats of the key values of animation channels.
+#define BUNDLE_ANIMATION_FORMAT_FLOAT       0
+#define BUNDLE_ANIMATION_FORMAT_COMPRESSED  1
+
+// Size of the chunks in which bundle files are read by asynchronous loads
+#define BUNDLE_ASYNC_READ_CHUNK_SIZE    65536
+
 namespace gameplay
 {
 
 static std::vector<Bundle*> __bundleCache;
 
+/**
+ * A mesh loaded from a bundle, which is shared with later loads of the same mesh.
+ */
+struct CachedMesh
+{
+    Mesh* mesh;
+    unsigned int vertexUsageMask;
+    Mesh::DataResidency dataResidency;
+};
+
+// The meshes loaded from bundles that are alive, by url.
+static std::map<std::string, CachedMesh> __meshCache;
+
+/**
+ * Hashes the ID of a reference.
+ */
+static unsigned int hashId(const char* id)
+{
+    unsigned int hash = 2166136261u;
+    for (const char* c = id; *c; ++c)
+    {
+        hash ^= (unsigned char)*c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Hashes the offset of a reference. Offsets are spread by a multiplicative hash, since they are often aligned.
+ */
+static unsigned int hashOffset(unsigned int offset)
+{
+    return (offset * 2654435761u) >> 7;
+}
+
 Bundle::Bundle(const char* path) :
-    _path(path), _referenceCount(0), _references(NULL), _stream(NULL), _trackedNodes(NULL)
+    _path(path), _referenceCount(0), _references(NULL), _stream(NULL), _meshDataResidency(Mesh::DATA_BOUNDS), _vertexUsageMask(0xFFFFFFFF), _trackedNodes(NULL)
 {
+    _version[0] = BUNDLE_VERSION_MAJOR;
+    _version[1] = BUNDLE_VERSION_MINOR;
 }
 
 Bundle::~Bundle()
@@ -127,6 +187,55 @@ bool Bundle::readArray(unsigned int* length, std::vector<T>* values, unsigned in
     return true;
 }
 
+template <class T>
+bool Bundle::readArrayDirect(unsigned int* length, const T** ptr, std::vector<T>* values)
+{
+    GP_ASSERT(length);
+    GP_ASSERT(ptr);
+    GP_ASSERT(values);
+    GP_ASSERT(_stream);
+
+    if (!read(length))
+    {
+        GP_ERROR("Failed to read the length of an array of data.");
+        return false;
+    }
+    *ptr = NULL;
+    if (*length > 0)
+    {
+        // Only reference the data in place if it is suitably aligned for T.
+        long int position = _stream->position();
+        if (position != -1L && (position % sizeof(T)) == 0)
+        {
+            *ptr = static_cast<const T*>(_stream->readDirect(sizeof(T) * *length));
+        }
+        if (*ptr == NULL)
+        {
+            values->resize(*length);
+            if (_stream->read(&(*values)[0], sizeof(T), *length) != *length)
+            {
+                GP_ERROR("Failed to read an array of data from bundle.");
+                return false;
+            }
+            *ptr = &(*values)[0];
+        }
+    }
+    return true;
+}
+
+bool Bundle::skipArray(unsigned int elementSize)
+{
+    GP_ASSERT(_stream);
+
+    unsigned int length;
+    if (!read(&length))
+    {
+        GP_ERROR("Failed to read the length of an array of data (to be skipped).");
+        return false;
+    }
+    return length == 0 || _stream->seek((long int)length * elementSize, SEEK_CUR);
+}
+
 static std::string readString(Stream* stream)
 {
     GP_ASSERT(stream);
@@ -154,8 +263,186 @@ static std::string readString(Stream* stream)
     return str;
 }
 
+/**
+ * A read-only stream over a bundle whose contents are compressed in LZ4 blocks, which
+ * decompresses the block at the read position when it is read. Positions are those of the
+ * uncompressed bundle, so the offsets of its references are unchanged. Only the contents
+ * after the header can be read, and nothing is read in place with readDirect().
+ *
+ * @script{ignore}
+ */
+class CompressedStream : public Stream
+{
+public:
+
+    /**
+     * Creates a stream over a compressed bundle.
+     *
+     * @param stream The stream of the bundle, positioned after the flags of its header,
+     *      which the returned stream owns.
+     *
+     * @return The stream, positioned after the header, or NULL if the table of blocks is
+     *      invalid, in which case the stream of the bundle is not owned.
+     */
+    static CompressedStream* create(Stream* stream)
+    {
+        GP_ASSERT(stream);
+
+        unsigned int blockCount;
+        if (stream->read(&blockCount, 4, 1) != 1)
+            return NULL;
+        std::vector<Block> blocks;
+        size_t position = BUNDLE_HEADER_SIZE;
+        for (unsigned int i = 0; i < blockCount; ++i)
+        {
+            Block block;
+            if (stream->read(&block.offset, 4, 1) != 1 || stream->read(&block.size, 4, 1) != 1 ||
+                stream->read(&block.storedSize, 4, 1) != 1 || block.size == 0 || block.storedSize > block.size)
+            {
+                return NULL;
+            }
+            block.position = position;
+            position += block.size;
+            blocks.push_back(block);
+        }
+
+        CompressedStream* compressed = new CompressedStream(stream, position);
+        compressed->_blocks.swap(blocks);
+        return compressed;
+    }
+
+    ~CompressedStream() { SAFE_DELETE(_stream); }
+    virtual bool canRead() { return true; }
+    virtual bool canWrite() { return false; }
+    virtual bool canSeek() { return true; }
+    virtual void close() { }
+
+    virtual size_t read(void* ptr, size_t size, size_t count)
+    {
+        if (size == 0 || _position >= _length)
+            return 0;
+        size_t available = (_length - _position) / size;
+        if (count > available)
+            count = available;
+
+        char* dst = (char*)ptr;
+        size_t remaining = size * count;
+        while (remaining > 0)
+        {
+            const Block* block = loadBlock(_position);
+            if (block == NULL)
+                break;
+            size_t offset = _position - block->position;
+            size_t length = std::min(remaining, block->size - offset);
+            memcpy(dst, &_data[offset], length);
+            dst += length;
+            _position += length;
+            remaining -= length;
+        }
+        return count - (remaining + size - 1) / size;
+    }
+
+    virtual char* readLine(char* str, int num)
+    {
+        if (num <= 0)
+            return NULL;
+        int i = 0;
+        char c;
+        while (i < num - 1 && read(&c, 1, 1) == 1)
+        {
+            str[i++] = c;
+            if (c == '\n')
+                break;
+        }
+        str[i] = '\0';
+        return i > 0 ? str : NULL;
+    }
+
+    virtual size_t write(const void* ptr, size_t size, size_t count) { return 0; }
+    virtual bool eof() { return _position >= _length; }
+    virtual size_t length() { return _length; }
+    virtual long int position() { return (long int)_position; }
+
+    virtual bool seek(long int offset, int origin)
+    {
+        long int base = origin == SEEK_CUR ? (long int)_position : (origin == SEEK_END ? (long int)_length : 0);
+        if (base + offset < 0 || base + offset > (long int)_length)
+            return false;
+        _position = (size_t)(base + offset);
+        return true;
+    }
+
+    virtual bool rewind() { _position = 0; return true; }
+
+private:
+
+    /**
+     * A block of the compressed contents, stored compressed if it is smaller than its size.
+     */
+    struct Block
+    {
+        unsigned int offset;
+        unsigned int size;
+        unsigned int storedSize;
+        size_t position;
+    };
+
+    CompressedStream(Stream* stream, size_t length) : _stream(stream), _length(length), _position(BUNDLE_HEADER_SIZE), _block(-1) { }
+
+    static bool compareBlockPosition(size_t position, const Block& block)
+    {
+        return position < block.position;
+    }
+
+    /**
+     * Decompresses the block that holds a position, unless it was the last block read.
+     *
+     * @return The block, or NULL if the position is in the header or the block is invalid.
+     */
+    const Block* loadBlock(size_t position)
+    {
+        std::vector<Block>::const_iterator itr = std::upper_bound(_blocks.begin(), _blocks.end(), position, compareBlockPosition);
+        if (itr == _blocks.begin())
+            return NULL;
+        int index = (int)(itr - _blocks.begin()) - 1;
+        const Block& block = _blocks[index];
+        if (index == _block)
+            return &block;
+
+        _block = -1;
+        _data.resize(block.size);
+        if (!_stream->seek((long int)block.offset, SEEK_SET))
+            return NULL;
+        if (block.storedSize == block.size)
+        {
+            if (_stream->read(&_data[0], 1, block.size) != block.size)
+                return NULL;
+        }
+        else
+        {
+            _storedData.resize(std::max(block.storedSize, 1u));
+            if (_stream->read(&_storedData[0], 1, block.storedSize) != block.storedSize ||
+                !FileSystem::decompressLZ4(&_storedData[0], block.storedSize, &_data[0], block.size))
+            {
+                return NULL;
+            }
+        }
+        _block = index;
+        return &block;
+    }
+
+    Stream* _stream;
+    std::vector<Block> _blocks;
+    size_t _length;
+    size_t _position;
+    int _block;                     // The index of the block in _data, or -1.
+    std::vector<char> _data;
+    std::vector<char> _storedData;
+};
+
 Bundle* Bundle::create(const char* path)
 {
+    GP_PROFILE("Bundle::create");
     GP_ASSERT(path);
 
     // Search the cache for this bundle.
@@ -172,7 +459,8 @@ Bundle* Bundle::create(const char* path)
     }
 
     // Open the bundle.
-    Stream* stream = FileSystem::open(path);
+    // Map the bundle into memory where possible so that mesh and animation data can be read in place.
+    Stream* stream = FileSystem::open(path, FileSystem::READ | FileSystem::MAP);
     if (!stream)
     {
         GP_ERROR("Failed to open file '%s'.", path);
@@ -196,13 +484,33 @@ Bundle* Bundle::create(const char* path)
         GP_ERROR("Failed to read GPB version for bundle '%s'.", path);
         return NULL;
     }
-    if (ver[0] != BUNDLE_VERSION_MAJOR || ver[1] != BUNDLE_VERSION_MINOR)
+    if (ver[0] != BUNDLE_VERSION_MAJOR || ver[1] < BUNDLE_VERSION_MINOR_MIN || ver[1] > BUNDLE_VERSION_MINOR)
     {
         SAFE_DELETE(stream);
         GP_ERROR("Unsupported version (%d.%d) for bundle '%s' (expected %d.%d).", (int)ver[0], (int)ver[1], path, BUNDLE_VERSION_MAJOR, BUNDLE_VERSION_MINOR);
         return NULL;
     }
 
+    // Read flags. The contents of compressed bundles are decompressed as they are read.
+    unsigned int flags = 0;
+    if (ver[1] >= 8 && stream->read(&flags, 4, 1) != 1)
+    {
+        SAFE_DELETE(stream);
+        GP_ERROR("Failed to read GPB flags for bundle '%s'.", path);
+        return NULL;
+    }
+    if (flags & BUNDLE_FLAG_LZ4)
+    {
+        Stream* compressed = CompressedStream::create(stream);
+        if (!compressed)
+        {
+            SAFE_DELETE(stream);
+            GP_ERROR("Invalid compressed blocks for bundle '%s'.", path);
+            return NULL;
+        }
+        stream = compressed;
+    }
+
     // Read ref table.
     unsigned int refCount;
     if (stream->read(&refCount, 4, 1) != 1)
@@ -232,22 +540,58 @@ Bundle* Bundle::create(const char* path)
     bundle->_referenceCount = refCount;
     bundle->_references = refs;
     bundle->_stream = stream;
+    bundle->_version[0] = ver[0];
+    bundle->_version[1] = ver[1];
+    bundle->buildIndex();
 
     return bundle;
 }
 
+void Bundle::buildIndex()
+{
+    // The tables are kept at most half full, so probing stays short.
+    unsigned int slotCount = 16;
+    while (slotCount < _referenceCount * 2)
+        slotCount *= 2;
+    unsigned int mask = slotCount - 1;
+    _idSlots.assign(slotCount, 0);
+    _offsetSlots.assign(slotCount, 0);
+
+    for (unsigned int i = 0; i < _referenceCount; ++i)
+    {
+        // When references share an ID or offset, the first one is found, as the ref table is searched in order.
+        const Reference& ref = _references[i];
+        unsigned int slot = hashId(ref.id.c_str()) & mask;
+        while (_idSlots[slot] != 0 && _references[_idSlots[slot] - 1].id != ref.id)
+            slot = (slot + 1) & mask;
+        if (_idSlots[slot] == 0)
+            _idSlots[slot] = i + 1;
+
+        // Offsets are only looked up for their IDs, so references without one are skipped.
+        if (ref.id.empty())
+            continue;
+        slot = hashOffset(ref.offset) & mask;
+        while (_offsetSlots[slot] != 0 && _references[_offsetSlots[slot] - 1].offset != ref.offset)
+            slot = (slot + 1) & mask;
+        if (_offsetSlots[slot] == 0)
+            _offsetSlots[slot] = i + 1;
+    }
+}
+
 Bundle::Reference* Bundle::find(const char* id) const
 {
     GP_ASSERT(id);
     GP_ASSERT(_references);
 
-    // Search the ref table for the given id (case-sensitive).
-    for (unsigned int i = 0; i < _referenceCount; ++i)
+    // Look the id up in the hash table of the ref table (case-sensitive).
+    unsigned int mask = (unsigned int)_idSlots.size() - 1;
+    for (unsigned int slot = hashId(id) & mask; _idSlots[slot] != 0; slot = (slot + 1) & mask)
     {
-        if (_references[i].id == id)
+        Reference* ref = &_references[_idSlots[slot] - 1];
+        if (ref->id == id)
         {
             // Found a match
-            return &_references[i];
+            return ref;
         }
     }
 
@@ -275,11 +619,13 @@ const char* Bundle::getIdFromOffset(unsigned int offset) const
     if (offset > 0)
     {
         GP_ASSERT(_references);
-        for (unsigned int i = 0; i < _referenceCount; ++i)
+        unsigned int mask = (unsigned int)_offsetSlots.size() - 1;
+        for (unsigned int slot = hashOffset(offset) & mask; _offsetSlots[slot] != 0; slot = (slot + 1) & mask)
         {
-            if (_references[i].offset == offset && _references[i].id.length() > 0)
+            const Reference& ref = _references[_offsetSlots[slot] - 1];
+            if (ref.offset == offset)
             {
-                return _references[i].id.c_str();
+                return ref.id.c_str();
             }
         }
     }
@@ -374,6 +720,31 @@ bool Bundle::readMatrix(float* m)
 
 Scene* Bundle::loadScene(const char* id)
 {
+    GP_PROFILE("Bundle::loadScene");
+    unsigned int childrenCount;
+    Scene* scene = readSceneHeader(id, &childrenCount);
+    if (scene == NULL)
+        return NULL;
+
+    // Read each child directly into the scene.
+    for (unsigned int i = 0; i < childrenCount; i++)
+    {
+        readSceneNode(scene);
+    }
+
+    if (!readSceneFooter(scene))
+    {
+        SAFE_RELEASE(scene);
+        return NULL;
+    }
+
+    return scene;
+}
+
+Scene* Bundle::readSceneHeader(const char* id, unsigned int* nodeCount)
+{
+    GP_ASSERT(nodeCount);
+
     clearLoadSession();
 
     Reference* ref = NULL;
@@ -399,26 +770,32 @@ Scene* Bundle::loadScene(const char* id)
     Scene* scene = Scene::create(getIdFromOffset());
 
     // Read the number of children.
-    unsigned int childrenCount;
-    if (!read(&childrenCount))
+    if (!read(nodeCount))
     {
         GP_ERROR("Failed to read the scene's number of children.");
         SAFE_RELEASE(scene);
         return NULL;
     }
-    if (childrenCount > 0)
+
+    return scene;
+}
+
+void Bundle::readSceneNode(Scene* scene)
+{
+    GP_ASSERT(scene);
+
+    Node* node = readNode(scene, NULL);
+    if (node)
     {
-        // Read each child directly into the scene.
-        for (unsigned int i = 0; i < childrenCount; i++)
-        {
-            Node* node = readNode(scene, NULL);
-            if (node)
-            {
-                scene->addNode(node);
-                node->release(); // scene now owns node
-            }
-        }
+        scene->addNode(node);
+        node->release(); // scene now owns node
     }
+}
+
+bool Bundle::readSceneFooter(Scene* scene)
+{
+    GP_ASSERT(scene);
+
     // Read active camera.
     std::string xref = readString(_stream);
     if (xref.length() > 1 && xref[0] == '#') // TODO: Handle full xrefs
@@ -435,20 +812,17 @@ Scene* Bundle::loadScene(const char* id)
     if (!read(&red))
     {
         GP_ERROR("Failed to read red component of the scene's ambient color in bundle '%s'.", _path.c_str());
-        SAFE_RELEASE(scene);
-        return NULL;
+        return false;
     }
     if (!read(&green))
     {
         GP_ERROR("Failed to read green component of the scene's ambient color in bundle '%s'.", _path.c_str());
-        SAFE_RELEASE(scene);
-        return NULL;
+        return false;
     }
     if (!read(&blue))
     {
         GP_ERROR("Failed to read blue component of the scene's ambient color in bundle '%s'.", _path.c_str());
-        SAFE_RELEASE(scene);
-        return NULL;
+        return false;
     }
     scene->setAmbientColor(red, green, blue);
 
@@ -464,7 +838,7 @@ Scene* Bundle::loadScene(const char* id)
             if (_stream->seek(ref->offset, SEEK_SET) == false)
             {
                 GP_ERROR("Failed to seek to object '%s' in bundle '%s'.", ref->id.c_str(), _path.c_str());
-                return NULL;
+                return false;
             }
             readAnimations(scene);
         }
@@ -472,7 +846,14 @@ Scene* Bundle::loadScene(const char* id)
 
     resolveJointReferences(scene, NULL);
 
-    return scene;
+    return true;
+}
+
+Bundle::AsyncLoad* Bundle::loadSceneAsync(const char* id, AsyncLoad::Listener* listener, float timeBudget)
+{
+    AsyncLoad* load = new AsyncLoad(this, id, listener, timeBudget);
+    load->scheduleStep();
+    return load;
 }
 
 Node* Bundle::loadNode(const char* id)
@@ -1001,6 +1382,35 @@ Model* Bundle::readModel(const char* nodeId)
                     }
                 }
             }
+            // Read levels of detail.
+            if (_version[1] >= 4)
+            {
+                unsigned int lodCount;
+                if (!read(&lodCount))
+                {
+                    GP_ERROR("Failed to load level of detail count for model with mesh '%s' in bundle '%s'.", xref.c_str() + 1, _path.c_str());
+                    return NULL;
+                }
+                for (unsigned int i = 0; i < lodCount; ++i)
+                {
+                    std::string lodXref = readString(_stream);
+                    float screenSize;
+                    if (!read(&screenSize))
+                    {
+                        GP_ERROR("Failed to load level of detail screen size for model with mesh '%s' in bundle '%s'.", xref.c_str() + 1, _path.c_str());
+                        return NULL;
+                    }
+                    if (lodXref.length() > 1 && lodXref[0] == '#')
+                    {
+                        Mesh* lodMesh = loadMesh(lodXref.c_str() + 1, nodeId);
+                        if (lodMesh)
+                        {
+                            model->addLod(lodMesh, screenSize);
+                            SAFE_RELEASE(lodMesh);
+                        }
+                    }
+                }
+            }
             return model;
         }
     }
@@ -1269,108 +1679,295 @@ Animation* Bundle::readAnimationChannelData(Animation* animation, const char* id
 {
     GP_ASSERT(id);
 
-    std::vector<unsigned int> keyTimes;
-    std::vector<float> values;
-    std::vector<float> tangentsIn;
-    std::vector<float> tangentsOut;
-    std::vector<unsigned int> interpolation;
+    // When loading is deferred, only the key times are read now (for the duration of the
+    // animation), and the curve is read from the position of the channel once a clip is played.
+    long position = -1L;
+    if (targetAttribute > 0 && Game::getInstance()->getAnimationController()->isDeferredLoadingEnabled())
+        position = _stream->position();
 
-    // Length of the arrays.
-    unsigned int keyTimesCount;
-    unsigned int valuesCount;
-    unsigned int tangentsInCount;
-    unsigned int tangentsOutCount;
-    unsigned int interpolationCount;
+    Curve* curve = NULL;
+    unsigned long duration = 0;
+    if (!readAnimationCurveData(id, target, targetAttribute, (targetAttribute > 0 && position == -1L) ? &curve : NULL, &duration))
+        return NULL;
+    if (targetAttribute == 0)
+        return animation;
 
-    // Read key times.
-    if (!readArray(&keyTimesCount, &keyTimes, sizeof(unsigned int)))
+    GP_ASSERT(target);
+    bool created = (animation == NULL);
+    if (created)
+        animation = new Animation(id);
+
+    if (curve)
     {
-        GP_ERROR("Failed to read key times for animation '%s'.", id);
-        return NULL;
+        animation->createChannel(target, targetAttribute, curve, duration);
+        curve->release();
     }
-
-    // Read key values.
-    if (!readArray(&valuesCount, &values))
+    else
     {
-        GP_ERROR("Failed to read key values for animation '%s'.", id);
-        return NULL;
+        if (animation->_bundle == NULL)
+        {
+            animation->_bundle = this;
+            addRef();
+        }
+        animation->createDeferredChannel(target, targetAttribute, position, duration);
     }
 
-    // Read in-tangents.
-    if (!readArray(&tangentsInCount, &tangentsIn))
+    if (created)
     {
-        GP_ERROR("Failed to read in tangents for animation '%s'.", id);
-        return NULL;
+        // Release the animation because a newly created animation has a ref count of 1 and the channels hold the ref to animation.
+        animation->release();
     }
 
-    // Read out-tangents.
-    if (!readArray(&tangentsOutCount, &tangentsOut))
+    return animation;
+}
+
+bool Bundle::readAnimationCurveData(const char* id, AnimationTarget* target, unsigned int targetAttribute, Curve** curve, unsigned long* duration)
+{
+    GP_ASSERT(id);
+    GP_ASSERT(duration);
+
+    // Read the format of the key values, which bundles before 1.6 do not have (they are all floats).
+    unsigned int format = BUNDLE_ANIMATION_FORMAT_FLOAT;
+    if (_version[1] >= 6 && !read(&format))
     {
-        GP_ERROR("Failed to read out tangents for animation '%s'.", id);
-        return NULL;
+        GP_ERROR("Failed to read the key value format for animation '%s'.", id);
+        return false;
+    }
+    if (format != BUNDLE_ANIMATION_FORMAT_FLOAT && format != BUNDLE_ANIMATION_FORMAT_COMPRESSED)
+    {
+        GP_ERROR("Invalid key value format (%d) for animation '%s'.", format, id);
+        return false;
     }
 
-    // Read interpolations.
-    if (!readArray(&interpolationCount, &interpolation, sizeof(unsigned int)))
+    // Key times and values are read in place when the bundle is memory mapped;
+    // the vectors are only used when they must be copied.
+    std::vector<unsigned int> keyTimesStorage;
+    const unsigned int* keyTimes;
+    unsigned int keyTimesCount;
+    if (!readArrayDirect(&keyTimesCount, &keyTimes, &keyTimesStorage))
     {
-        GP_ERROR("Failed to read the interpolation values for animation '%s'.", id);
-        return NULL;
+        GP_ERROR("Failed to read key times for animation '%s'.", id);
+        return false;
     }
+    *duration = keyTimesCount > 0 ? keyTimes[keyTimesCount - 1] - keyTimes[0] : 0;
 
-    if (targetAttribute > 0)
+    if (format == BUNDLE_ANIMATION_FORMAT_COMPRESSED)
     {
-        GP_ASSERT(target);
-        GP_ASSERT(keyTimes.size() > 0 && values.size() > 0);
-        if (animation == NULL)
+        std::vector<float> rangesStorage;
+        std::vector<unsigned short> valuesStorage;
+        const float* ranges = NULL;
+        const unsigned short* values = NULL;
+        unsigned int rangesCount = 0;
+        unsigned int valuesCount = 0;
+        unsigned int quaternionOffset;
+
+        if (curve ? !readArrayDirect(&rangesCount, &ranges, &rangesStorage) : !skipArray(sizeof(float)))
         {
-            // TODO: This code currently assumes LINEAR only.
-            animation = target->createAnimation(id, targetAttribute, keyTimesCount, &keyTimes[0], &values[0], Curve::LINEAR);
+            GP_ERROR("Failed to read key value ranges for animation '%s'.", id);
+            return false;
         }
-        else
+        if (!read(&quaternionOffset))
+        {
+            GP_ERROR("Failed to read the quaternion offset for animation '%s'.", id);
+            return false;
+        }
+        if (curve ? !readArrayDirect(&valuesCount, &values, &valuesStorage) : !skipArray(sizeof(unsigned short)))
         {
-            animation->createChannel(target, targetAttribute, keyTimesCount, &keyTimes[0], &values[0], Curve::LINEAR);
+            GP_ERROR("Failed to read key values for animation '%s'.", id);
+            return false;
         }
-    }
 
-    return animation;
-}
+        if (curve == NULL || targetAttribute == 0)
+            return true;
 
-Mesh* Bundle::loadMesh(const char* id)
-{
-    return loadMesh(id, NULL);
-}
+        GP_ASSERT(target);
+        unsigned int componentCount = target->getAnimationPropertyComponentCount(targetAttribute);
+        int offset = (int)quaternionOffset;
+        unsigned int stride = offset < 0 ? componentCount : componentCount - 1;
+        if (keyTimesCount == 0 || rangesCount != componentCount * 2 || valuesCount != keyTimesCount * stride ||
+            (offset >= 0 && (unsigned int)offset + 4 > componentCount))
+        {
+            GP_ERROR("Invalid compressed key values for animation '%s'.", id);
+            return false;
+        }
 
-Mesh* Bundle::loadMesh(const char* id, const char* nodeId)
-{
-    GP_ASSERT(_stream);
-    GP_ASSERT(id);
+        // Normalize the key times as Animation does for float key values.
+        unsigned int lowest = keyTimes[0];
+        std::vector<float> normalizedKeyTimes(keyTimesCount);
+        for (unsigned int i = 0; i < keyTimesCount; ++i)
+        {
+            normalizedKeyTimes[i] = *duration > 0 ? (float)(keyTimes[i] - lowest) / (float)*duration : 0.0f;
+        }
 
-    // Save the file position.
-    long position = _stream->position();
-    if (position == -1L)
-    {
-        GP_ERROR("Failed to save the current file position before loading mesh '%s'.", id);
-        return NULL;
+        *curve = Curve::createPacked(keyTimesCount, componentCount, &normalizedKeyTimes[0], values, ranges, offset);
+        GP_ASSERT(*curve);
+        return true;
     }
 
-    // Seek to the specified mesh.
-    Reference* ref = seekTo(id, BUNDLE_TYPE_MESH);
-    if (ref == NULL)
+    std::vector<float> valuesStorage;
+    const float* values = NULL;
+    unsigned int valuesCount = 0;
+
+    // Read key values.
+    if (curve ? !readArrayDirect(&valuesCount, &values, &valuesStorage) : !skipArray(sizeof(float)))
     {
-        GP_ERROR("Failed to locate ref for mesh '%s'.", id);
-        return NULL;
+        GP_ERROR("Failed to read key values for animation '%s'.", id);
+        return false;
     }
 
-    // Read mesh data.
-    MeshData* meshData = readMeshData();
-    if (meshData == NULL)
+    // Skip in-tangents and out-tangents (currently unused).
+    if (!skipArray(sizeof(float)) || !skipArray(sizeof(float)))
     {
-        GP_ERROR("Failed to load mesh data for mesh '%s'.", id);
-        return NULL;
+        GP_ERROR("Failed to read tangents for animation '%s'.", id);
+        return false;
     }
 
-    // Create mesh.
-    Mesh* mesh = Mesh::createMesh(meshData->vertexFormat, meshData->vertexCount, false);
+    // Skip interpolations (currently unused).
+    if (!skipArray(sizeof(unsigned int)))
+    {
+        GP_ERROR("Failed to read the interpolation values for animation '%s'.", id);
+        return false;
+    }
+
+    if (curve && targetAttribute > 0)
+    {
+        GP_ASSERT(target);
+        GP_ASSERT(keyTimesCount > 0 && valuesCount > 0);
+
+        // TODO: This code currently assumes LINEAR only.
+        *curve = Animation::createCurve(target, targetAttribute, keyTimesCount, keyTimes, values, Curve::LINEAR, duration);
+    }
+
+    return true;
+}
+
+Curve* Bundle::readAnimationCurve(const char* id, AnimationTarget* target, int targetAttribute, long offset)
+{
+    GP_ASSERT(_stream);
+
+    // Restore the file position afterwards, since this is called when a clip is played.
+    long position = _stream->position();
+    if (position == -1L || _stream->seek(offset, SEEK_SET) == false)
+    {
+        GP_ERROR("Failed to seek to the data of animation '%s' in bundle '%s'.", id, _path.c_str());
+        return NULL;
+    }
+
+    Curve* curve = NULL;
+    unsigned long duration;
+    if (!readAnimationCurveData(id, target, targetAttribute, &curve, &duration))
+        curve = NULL;
+
+    _stream->seek(position, SEEK_SET);
+    return curve;
+}
+
+Mesh* Bundle::loadMesh(const char* id)
+{
+    return loadMesh(id, NULL);
+}
+
+/**
+ * Copies the elements of a vertex format from vertices of another format, by usage.
+ *
+ * @return false if the source format has no element for a usage of the destination format.
+ */
+static bool copyVertexElements(const VertexFormat& from, const unsigned char* vertexData, unsigned int vertexCount,
+                               const VertexFormat& to, unsigned char* out)
+{
+    std::vector<unsigned int> offsets(to.getElementCount());
+    for (unsigned int i = 0; i < to.getElementCount(); ++i)
+    {
+        const VertexFormat::Element& e = to.getElement(i);
+        unsigned int offset = 0;
+        unsigned int j = 0;
+        for (; j < from.getElementCount(); ++j)
+        {
+            if (from.getElement(j) == e)
+                break;
+            offset += from.getElement(j).getByteSize();
+        }
+        if (j == from.getElementCount())
+            return false;
+        offsets[i] = offset;
+    }
+
+    const unsigned int fromSize = from.getVertexSize();
+    for (unsigned int v = 0; v < vertexCount; ++v)
+    {
+        const unsigned char* src = vertexData + v * fromSize;
+        for (unsigned int i = 0; i < to.getElementCount(); ++i)
+        {
+            unsigned int size = to.getElement(i).getByteSize();
+            memcpy(out, src + offsets[i], size);
+            out += size;
+        }
+    }
+    return true;
+}
+
+Mesh* Bundle::loadMesh(const char* id, const char* nodeId)
+{
+    GP_ASSERT(_stream);
+    GP_ASSERT(id);
+    GP_PROFILE("Bundle::loadMesh");
+
+    // Share the mesh if it was already loaded the same way from this bundle file.
+    std::string url = _path;
+    url += "#";
+    url += id;
+    std::map<std::string, CachedMesh>::iterator itr = __meshCache.find(url);
+    if (itr != __meshCache.end() && itr->second.vertexUsageMask == _vertexUsageMask && itr->second.dataResidency == _meshDataResidency)
+    {
+        itr->second.mesh->addRef();
+        return itr->second.mesh;
+    }
+
+    // Save the file position.
+    long position = _stream->position();
+    if (position == -1L)
+    {
+        GP_ERROR("Failed to save the current file position before loading mesh '%s'.", id);
+        return NULL;
+    }
+
+    // Seek to the specified mesh.
+    Reference* ref = seekTo(id, BUNDLE_TYPE_MESH);
+    if (ref == NULL)
+    {
+        GP_ERROR("Failed to locate ref for mesh '%s'.", id);
+        return NULL;
+    }
+
+    // Read mesh data (in place if possible, since it is uploaded to buffers straight away).
+    MeshData* meshData = readMeshData(true);
+    if (meshData == NULL)
+    {
+        GP_ERROR("Failed to load mesh data for mesh '%s'.", id);
+        return NULL;
+    }
+
+    // Strip the vertex elements that are not kept before the vertices are uploaded.
+    std::vector<VertexFormat::Element> elements;
+    for (unsigned int i = 0; i < meshData->vertexFormat.getElementCount(); ++i)
+    {
+        const VertexFormat::Element& e = meshData->vertexFormat.getElement(i);
+        if (e.usage == VertexFormat::POSITION || (e.usage < 32 && (_vertexUsageMask & (1u << e.usage))))
+            elements.push_back(e);
+    }
+    bool strip = !elements.empty() && elements.size() < meshData->vertexFormat.getElementCount();
+    VertexFormat vertexFormat = strip ? VertexFormat(&elements[0], (unsigned int)elements.size()) : meshData->vertexFormat;
+    std::vector<unsigned char> strippedVertices;
+    const unsigned char* vertexData = meshData->vertexData;
+    if (strip && meshData->vertexCount > 0)
+    {
+        strippedVertices.resize(vertexFormat.getVertexSize() * meshData->vertexCount);
+        copyVertexElements(meshData->vertexFormat, meshData->vertexData, meshData->vertexCount, vertexFormat, &strippedVertices[0]);
+        vertexData = &strippedVertices[0];
+    }
+
+    // Create mesh.
+    Mesh* mesh = Mesh::createMesh(vertexFormat, meshData->vertexCount, false);
     if (mesh == NULL)
     {
         GP_ERROR("Failed to create mesh '%s'.", id);
@@ -1378,22 +1975,40 @@ Mesh* Bundle::loadMesh(const char* id, const char* nodeId)
         return NULL;
     }
 
-    mesh->_url = _path;
-    mesh->_url += "#";
-    mesh->_url += id;
+    mesh->_url = url;
 
-    mesh->setVertexData((float*)meshData->vertexData, 0, meshData->vertexCount);
+    // Set the residency before the data, which is copied as it is set.
+    mesh->_dataResidency = _meshDataResidency;
+    mesh->setVertexData((const float*)vertexData, 0, meshData->vertexCount);
 
     mesh->_boundingBox.set(meshData->boundingBox);
     mesh->_boundingSphere.set(meshData->boundingSphere);
 
+    // Parts with the same index format share one index buffer of the mesh, so it is only bound once to draw them.
+    bool sharedIndices = meshData->parts.size() > 1;
+    unsigned int indexCount = 0;
+    for (unsigned int i = 0; i < meshData->parts.size(); ++i)
+    {
+        GP_ASSERT(meshData->parts[i]);
+        sharedIndices &= (meshData->parts[i]->indexFormat == meshData->parts[0]->indexFormat);
+        indexCount += meshData->parts[i]->indexCount;
+    }
+    if (sharedIndices)
+        sharedIndices = mesh->createIndexBuffer(meshData->parts[0]->indexFormat, indexCount, false);
+
     // Create mesh parts.
+    unsigned int indexStart = 0;
     for (unsigned int i = 0; i < meshData->parts.size(); ++i)
     {
         MeshPartData* partData = meshData->parts[i];
         GP_ASSERT(partData);
 
-        MeshPart* part = mesh->addPart(partData->primitiveType, partData->indexFormat, partData->indexCount, false);
+        MeshPart* part;
+        if (sharedIndices)
+            part = mesh->addPart(partData->primitiveType, indexStart, partData->indexCount);
+        else
+            part = mesh->addPart(partData->primitiveType, partData->indexFormat, partData->indexCount, false);
+        indexStart += partData->indexCount;
         if (part == NULL)
         {
             GP_ERROR("Failed to create mesh part (with index %d) for mesh '%s'.", i, id);
@@ -1412,10 +2027,123 @@ Mesh* Bundle::loadMesh(const char* id, const char* nodeId)
         return NULL;
     }
 
+    // Meshes loaded another way than the cached one are not shared.
+    if (itr == __meshCache.end())
+    {
+        CachedMesh& cached = __meshCache[url];
+        cached.mesh = mesh;
+        cached.vertexUsageMask = _vertexUsageMask;
+        cached.dataResidency = _meshDataResidency;
+    }
+
     return mesh;
 }
 
-Bundle::MeshData* Bundle::readMeshData()
+void Bundle::uncacheMesh(Mesh* mesh)
+{
+    GP_ASSERT(mesh);
+
+    std::map<std::string, CachedMesh>::iterator itr = __meshCache.find(mesh->_url);
+    if (itr != __meshCache.end() && itr->second.mesh == mesh)
+        __meshCache.erase(itr);
+}
+
+// Converts a 16-bit floating point value to a 32-bit float.
+static float halfToFloat(unsigned short h)
+{
+    float sign = (h & 0x8000) ? -1.0f : 1.0f;
+    int exponent = (h >> 10) & 0x1f;
+    int mantissa = h & 0x3ff;
+    if (exponent == 0)
+        return sign * ldexp((float)mantissa, -24);
+    if (exponent == 31)
+        return sign * FLT_MAX;
+    return sign * ldexp((float)(mantissa | 0x400), exponent - 25);
+}
+
+// Converts the values of a vertex element to floats, the way they are converted when drawn.
+static void unpackVertexElement(const VertexFormat::Element& element, const unsigned char* src, float* dst)
+{
+    for (unsigned int i = 0; i < element.size; ++i)
+    {
+        switch (element.type)
+        {
+        case VertexFormat::HALF_FLOAT:
+            {
+                unsigned short h;
+                memcpy(&h, src + i * 2, 2);
+                dst[i] = halfToFloat(h);
+            }
+            break;
+        case VertexFormat::BYTE:
+            {
+                float v = (float)((const signed char*)src)[i];
+                dst[i] = element.normalized ? std::max(v / 127.0f, -1.0f) : v;
+            }
+            break;
+        case VertexFormat::UNSIGNED_BYTE:
+            dst[i] = element.normalized ? src[i] / 255.0f : (float)src[i];
+            break;
+        case VertexFormat::SHORT:
+            {
+                short s;
+                memcpy(&s, src + i * 2, 2);
+                dst[i] = element.normalized ? std::max(s / 32767.0f, -1.0f) : (float)s;
+            }
+            break;
+        case VertexFormat::UNSIGNED_SHORT:
+            {
+                unsigned short s;
+                memcpy(&s, src + i * 2, 2);
+                dst[i] = element.normalized ? s / 65535.0f : (float)s;
+            }
+            break;
+        case VertexFormat::INT_2_10_10_10_REV:
+            {
+                unsigned int packed;
+                memcpy(&packed, src, 4);
+                int bits = i < 3 ? 10 : 2;
+                int v = (int)(packed << (32 - i * 10 - bits)) >> (32 - bits);
+                dst[i] = element.normalized ? std::max(v / (float)((1 << (bits - 1)) - 1), -1.0f) : (float)v;
+            }
+            break;
+        default:
+            memcpy(&dst[i], src + i * sizeof(float), sizeof(float));
+            break;
+        }
+    }
+}
+
+// Converts vertices to a format with float elements only, returning the new vertex data.
+static unsigned char* unpackVertexData(const VertexFormat& vertexFormat, const unsigned char* vertexData, unsigned int vertexCount, std::vector<VertexFormat::Element>* elements)
+{
+    GP_ASSERT(elements);
+
+    unsigned int vertexSize = 0;
+    for (unsigned int i = 0; i < vertexFormat.getElementCount(); ++i)
+    {
+        const VertexFormat::Element& element = vertexFormat.getElement(i);
+        elements->push_back(VertexFormat::Element(element.usage, element.size));
+        vertexSize += element.size * sizeof(float);
+    }
+
+    unsigned char* data = new unsigned char[vertexCount * vertexSize];
+    float* dst = (float*)data;
+    for (unsigned int v = 0; v < vertexCount; ++v)
+    {
+        const unsigned char* src = vertexData + v * vertexFormat.getVertexSize();
+        for (unsigned int i = 0; i < vertexFormat.getElementCount(); ++i)
+        {
+            const VertexFormat::Element& element = vertexFormat.getElement(i);
+            unpackVertexElement(element, src, dst);
+            src += element.getByteSize();
+            dst += element.size;
+        }
+    }
+    return data;
+}
+
+Bundle::MeshData* Bundle::readMeshData(bool direct)
 {
     // Read vertex format/elements.
     unsigned int vertexElementCount;
@@ -1449,9 +2177,41 @@ Bundle::MeshData* Bundle::readMeshData()
 
         vertexElements[i].usage = (VertexFormat::Usage)vUsage;
         vertexElements[i].size = vSize;
+
+        // Elements are floats in bundles older than version 1.5.
+        if (_version[1] >= 5)
+        {
+            unsigned int vType;
+            unsigned char vNormalized;
+            if (_stream->read(&vType, 4, 1) != 1 || _stream->read(&vNormalized, 1, 1) != 1)
+            {
+                GP_ERROR("Failed to load vertex type.");
+                SAFE_DELETE_ARRAY(vertexElements);
+                return NULL;
+            }
+            if (vType > VertexFormat::INT_2_10_10_10_REV || (vType == VertexFormat::INT_2_10_10_10_REV && vSize != 4))
+            {
+                GP_ERROR("Unsupported vertex type %d.", vType);
+                SAFE_DELETE_ARRAY(vertexElements);
+                return NULL;
+            }
+            vertexElements[i].type = (VertexFormat::Type)vType;
+            vertexElements[i].normalized = vNormalized != 0;
+        }
     }
 
     MeshData* meshData = new MeshData(VertexFormat(vertexElements, vertexElementCount));
+
+    // Types the platform cannot draw are converted to floats once the vertices are read.
+    bool unpack = false;
+    for (unsigned int i = 0; i < vertexElementCount; ++i)
+    {
+        if (!VertexFormat::isTypeSupported(vertexElements[i].type))
+        {
+            unpack = true;
+            break;
+        }
+    }
     SAFE_DELETE_ARRAY(vertexElements);
 
     // Read vertex data.
@@ -1471,12 +2231,28 @@ Bundle::MeshData* Bundle::readMeshData()
 
     GP_ASSERT(meshData->vertexFormat.getVertexSize());
     meshData->vertexCount = vertexByteCount / meshData->vertexFormat.getVertexSize();
-    meshData->vertexData = new unsigned char[vertexByteCount];
-    if (_stream->read(meshData->vertexData, 1, vertexByteCount) != vertexByteCount)
+    if (direct && !unpack)
     {
-        GP_ERROR("Failed to load vertex data.");
-        SAFE_DELETE(meshData);
-        return NULL;
+        meshData->vertexData = (unsigned char*)_stream->readDirect(vertexByteCount);
+        meshData->direct = meshData->vertexData != NULL;
+    }
+    if (!meshData->direct)
+    {
+        meshData->vertexData = new unsigned char[vertexByteCount];
+        if (_stream->read(meshData->vertexData, 1, vertexByteCount) != vertexByteCount)
+        {
+            GP_ERROR("Failed to load vertex data.");
+            SAFE_DELETE(meshData);
+            return NULL;
+        }
+    }
+    if (unpack)
+    {
+        std::vector<VertexFormat::Element> elements;
+        unsigned char* vertexData = unpackVertexData(meshData->vertexFormat, meshData->vertexData, meshData->vertexCount, &elements);
+        SAFE_DELETE_ARRAY(meshData->vertexData);
+        meshData->vertexData = vertexData;
+        meshData->vertexFormat = VertexFormat(&elements[0], (unsigned int)elements.size());
     }
 
     // Read mesh bounds (bounding box and bounding sphere).
@@ -1550,12 +2326,25 @@ Bundle::MeshData* Bundle::readMeshData()
         GP_ASSERT(indexSize);
         partData->indexCount = iByteCount / indexSize;
 
-        partData->indexData = new unsigned char[iByteCount];
-        if (_stream->read(partData->indexData, 1, iByteCount) != iByteCount)
+        if (meshData->direct)
         {
-            GP_ERROR("Failed to read index data for mesh part with index %d.", i);
-            SAFE_DELETE(meshData);
-            return NULL;
+            partData->indexData = (unsigned char*)_stream->readDirect(iByteCount);
+            if (partData->indexData == NULL)
+            {
+                GP_ERROR("Failed to read index data for mesh part with index %d.", i);
+                SAFE_DELETE(meshData);
+                return NULL;
+            }
+        }
+        else
+        {
+            partData->indexData = new unsigned char[iByteCount];
+            if (_stream->read(partData->indexData, 1, iByteCount) != iByteCount)
+            {
+                GP_ERROR("Failed to read index data for mesh part with index %d.", i);
+                SAFE_DELETE(meshData);
+                return NULL;
+            }
         }
     }
 
@@ -1609,6 +2398,26 @@ Bundle::MeshData* Bundle::readMeshData(const char* url)
     return meshData;
 }
 
+bool Bundle::convertMeshData(MeshData* data, const VertexFormat& vertexFormat)
+{
+    GP_ASSERT(data);
+    GP_ASSERT(!data->direct);
+
+    if (data->vertexFormat == vertexFormat)
+        return true;
+
+    unsigned char* vertexData = new unsigned char[vertexFormat.getVertexSize() * data->vertexCount];
+    if (!copyVertexElements(data->vertexFormat, data->vertexData, data->vertexCount, vertexFormat, vertexData))
+    {
+        SAFE_DELETE_ARRAY(vertexData);
+        return false;
+    }
+    SAFE_DELETE_ARRAY(data->vertexData);
+    data->vertexData = vertexData;
+    data->vertexFormat = vertexFormat;
+    return true;
+}
+
 Font* Bundle::loadFont(const char* id)
 {
     GP_ASSERT(id);
@@ -1646,6 +2455,19 @@ Font* Bundle::loadFont(const char* id)
     // Read character set.
     std::string charset = readString(_stream);
 
+    // Read the font format, which 1.2 bundles do not have (they only contain bitmap fonts).
+    unsigned int format = Font::BITMAP;
+    if (_version[1] >= 3 && _stream->read(&format, 4, 1) != 1)
+    {
+        GP_ERROR("Failed to read format for font '%s'.", id);
+        return NULL;
+    }
+    if (format != Font::BITMAP && format != Font::DISTANCE_FIELD)
+    {
+        GP_ERROR("Invalid format (%d) for font '%s'.", format, id);
+        return NULL;
+    }
+
     // Read font glyphs.
     unsigned int glyphCount;
     if (_stream->read(&glyphCount, 4, 1) != 1)
@@ -1718,7 +2540,7 @@ Font* Bundle::loadFont(const char* id)
     }
 
     // Create the font.
-    Font* font = Font::create(family.c_str(), Font::PLAIN, size, glyphs, glyphCount, texture);
+    Font* font = Font::create(family.c_str(), Font::PLAIN, size, glyphs, glyphCount, texture, (Font::Format)format);
 
     // Free the glyph array.
     SAFE_DELETE_ARRAY(glyphs);
@@ -1735,6 +2557,45 @@ Font* Bundle::loadFont(const char* id)
     return font;
 }
 
+NavigationMesh* Bundle::loadNavigationMesh(const char* id)
+{
+    GP_ASSERT(id);
+    GP_ASSERT(_stream);
+
+    // Seek to the specified navigation mesh.
+    Reference* ref = seekTo(id, BUNDLE_TYPE_NAVIGATIONMESH);
+    if (ref == NULL)
+    {
+        GP_ERROR("Failed to load ref for navigation mesh '%s'.", id);
+        return NULL;
+    }
+
+    // Read the vertices (three floats each) and the triangles (three indices each).
+    std::vector<float> vertices;
+    unsigned int vertexLength;
+    if (!readArray(&vertexLength, &vertices) || vertexLength % 3 != 0)
+    {
+        GP_ERROR("Failed to read vertices for navigation mesh '%s'.", id);
+        return NULL;
+    }
+    std::vector<unsigned int> indices;
+    unsigned int indexLength;
+    if (!readArray(&indexLength, &indices) || indexLength % 3 != 0)
+    {
+        GP_ERROR("Failed to read triangles for navigation mesh '%s'.", id);
+        return NULL;
+    }
+
+    NavigationMesh* mesh = NavigationMesh::create(vertexLength > 0 ? &vertices[0] : NULL, vertexLength / 3,
+                                                  indexLength > 0 ? &indices[0] : NULL, indexLength / 3);
+    if (mesh == NULL)
+    {
+        GP_ERROR("Failed to create navigation mesh '%s'.", id);
+        return NULL;
+    }
+    return mesh;
+}
+
 void Bundle::setTransform(const float* values, Transform* transform)
 {
     GP_ASSERT(transform);
@@ -1765,6 +2626,452 @@ const char* Bundle::getObjectId(unsigned int index) const
     return (index >= _referenceCount ? NULL : _references[index].id.c_str());
 }
 
+void Bundle::setMeshDataResidency(Mesh::DataResidency residency)
+{
+    _meshDataResidency = residency;
+}
+
+Mesh::DataResidency Bundle::getMeshDataResidency() const
+{
+    return _meshDataResidency;
+}
+
+void Bundle::setVertexUsageMask(unsigned int mask)
+{
+    _vertexUsageMask = mask;
+}
+
+unsigned int Bundle::getVertexUsageMask() const
+{
+    return _vertexUsageMask;
+}
+
+/**
+ * A read-only stream over a block of memory.
+ *
+ * @script{ignore}
+ */
+class MemoryStream : public Stream
+{
+public:
+
+    MemoryStream(char* data, size_t size) : _data(data), _size(size), _position(0) { }
+    ~MemoryStream() { SAFE_DELETE_ARRAY(_data); }
+    virtual bool canRead() { return true; }
+    virtual bool canWrite() { return false; }
+    virtual bool canSeek() { return true; }
+    virtual void close() { }
+
+    virtual size_t read(void* ptr, size_t size, size_t count)
+    {
+        if (size == 0)
+            return 0;
+        size_t available = (_size - _position) / size;
+        if (count > available)
+            count = available;
+        memcpy(ptr, _data + _position, size * count);
+        _position += size * count;
+        return count;
+    }
+
+    virtual char* readLine(char* str, int num)
+    {
+        if (num <= 0 || _position >= _size)
+            return NULL;
+        int i = 0;
+        while (i < num - 1 && _position < _size)
+        {
+            char c = _data[_position++];
+            str[i++] = c;
+            if (c == '\n')
+                break;
+        }
+        str[i] = '\0';
+        return str;
+    }
+
+    virtual size_t write(const void* ptr, size_t size, size_t count) { return 0; }
+    virtual bool eof() { return _position >= _size; }
+    virtual size_t length() { return _size; }
+    virtual long int position() { return (long int)_position; }
+
+    virtual bool seek(long int offset, int origin)
+    {
+        long int base = origin == SEEK_CUR ? (long int)_position : (origin == SEEK_END ? (long int)_size : 0);
+        if (base + offset < 0 || base + offset > (long int)_size)
+            return false;
+        _position = (size_t)(base + offset);
+        return true;
+    }
+
+    virtual bool rewind() { _position = 0; return true; }
+
+    virtual const void* readDirect(size_t size)
+    {
+        if (size > _size - _position)
+            return NULL;
+        const void* ptr = _data + _position;
+        _position += size;
+        return ptr;
+    }
+
+private:
+
+    char* _data;
+    size_t _size;
+    size_t _position;
+};
+
+/**
+ * Decompresses a bundle read into memory, if its contents are compressed, so that it is
+ * then read from memory as is. No errors are logged, since it is called on worker threads.
+ *
+ * @param data The bundle, which is deleted if it is decompressed.
+ * @param size The size of the bundle, set to the size of the decompressed bundle.
+ *
+ * @return The decompressed bundle, the bundle itself if it is not compressed, or NULL if it
+ *      could not be decompressed.
+ */
+static char* decompressBundle(char* data, size_t* size)
+{
+    GP_ASSERT(data);
+    GP_ASSERT(size);
+
+    unsigned int flags = 0;
+    if (*size >= BUNDLE_HEADER_SIZE && (unsigned char)data[10] >= 8)
+        memcpy(&flags, data + 11, 4);
+    if ((flags & BUNDLE_FLAG_LZ4) == 0)
+        return data;
+
+    // The memory stream owns the compressed bundle, and the compressed stream owns the memory stream.
+    MemoryStream* stream = new MemoryStream(data, *size);
+    stream->seek(BUNDLE_HEADER_SIZE, SEEK_SET);
+    CompressedStream* compressed = CompressedStream::create(stream);
+    if (!compressed)
+    {
+        SAFE_DELETE(stream);
+        return NULL;
+    }
+
+    // The header is kept, without the flag.
+    size_t length = compressed->length();
+    char* decompressed = new char[length];
+    memcpy(decompressed, data, BUNDLE_HEADER_SIZE);
+    flags &= ~BUNDLE_FLAG_LZ4;
+    memcpy(decompressed + 11, &flags, 4);
+    bool valid = compressed->read(decompressed + BUNDLE_HEADER_SIZE, 1, length - BUNDLE_HEADER_SIZE) == length - BUNDLE_HEADER_SIZE;
+    SAFE_DELETE(compressed);
+    if (!valid)
+    {
+        SAFE_DELETE_ARRAY(decompressed);
+        return NULL;
+    }
+    *size = length;
+    return decompressed;
+}
+
+/**
+ * The state of a bundle file that is being read on a worker thread.
+ */
+struct Bundle::AsyncLoad::FileRead
+{
+    std::string path;
+    char* data;
+    size_t size;
+    size_t bytesRead;
+    bool done;
+    bool cancelled;
+    bool threadStarted;                 // Whether the file is read on the thread, rather than synchronously.
+    Mutex mutex;
+#ifdef WIN32
+    HANDLE thread;
+#else
+    pthread_t thread;
+#endif
+
+    void read()
+    {
+        // Errors are not logged here since GP_ERROR is not safe to use off the main thread;
+        // a failed read is reported by the main thread when it finds no data.
+        Stream* stream = FileSystem::open(path.c_str());
+        size_t length = stream ? stream->length() : 0;
+        char* buffer = length > 0 ? new char[length] : NULL;
+
+        mutex.lock();
+        size = length;
+        mutex.unlock();
+
+        size_t offset = 0;
+        while (buffer && offset < length)
+        {
+            size_t count = std::min((size_t)BUNDLE_ASYNC_READ_CHUNK_SIZE, length - offset);
+            if (stream->read(buffer + offset, 1, count) != count)
+                break;
+            offset += count;
+
+            mutex.lock();
+            bytesRead = offset;
+            bool stop = cancelled;
+            mutex.unlock();
+            if (stop)
+                break;
+        }
+        if (offset < length)
+        {
+            SAFE_DELETE_ARRAY(buffer);
+        }
+        SAFE_DELETE(stream);
+
+        // Compressed bundles are decompressed here rather than as the main thread reads them.
+        if (buffer)
+        {
+            buffer = decompressBundle(buffer, &length);
+        }
+
+        mutex.lock();
+        data = buffer;
+        size = length;
+        done = true;
+        mutex.unlock();
+    }
+
+#ifdef WIN32
+    static DWORD WINAPI run(LPVOID param)
+    {
+        ((FileRead*)param)->read();
+        return 0;
+    }
+#else
+    static void* run(void* param)
+    {
+        ((FileRead*)param)->read();
+        return NULL;
+    }
+#endif
+};
+
+Bundle::AsyncLoad::AsyncLoad(Bundle* bundle, const char* id, Listener* listener, float timeBudget) :
+    _bundle(bundle), _sceneId(id ? id : ""), _listener(listener), _timeBudget(timeBudget), _state(READING), _cancelled(false),
+    _fileRead(NULL), _stream(NULL), _position(0), _scene(NULL), _nodeCount(0), _nodesLoaded(0)
+{
+    GP_ASSERT(_bundle);
+    _bundle->addRef();
+
+    // Start reading the bundle file on a worker thread.
+    _fileRead = new FileRead();
+    _fileRead->path = _bundle->_path;
+    _fileRead->data = NULL;
+    _fileRead->size = 0;
+    _fileRead->bytesRead = 0;
+    _fileRead->done = false;
+    _fileRead->cancelled = false;
+#ifdef WIN32
+    _fileRead->thread = CreateThread(NULL, 0, &FileRead::run, _fileRead, 0, NULL);
+    _fileRead->threadStarted = _fileRead->thread != NULL;
+#else
+    _fileRead->threadStarted = pthread_create(&_fileRead->thread, NULL, &FileRead::run, _fileRead) == 0;
+#endif
+    if (!_fileRead->threadStarted)
+    {
+        // Fall back to reading the file now.
+        GP_WARN("Failed to create a thread to load bundle '%s'; the bundle file is read synchronously.", _bundle->_path.c_str());
+        _fileRead->read();
+    }
+}
+
+Bundle::AsyncLoad::~AsyncLoad()
+{
+    if (_fileRead)
+    {
+        // Wait for the worker thread to finish before freeing its state.
+        _fileRead->mutex.lock();
+        _fileRead->cancelled = true;
+        _fileRead->mutex.unlock();
+#ifdef WIN32
+        if (_fileRead->threadStarted)
+        {
+            WaitForSingleObject(_fileRead->thread, INFINITE);
+            CloseHandle(_fileRead->thread);
+        }
+#else
+        if (_fileRead->threadStarted)
+            pthread_join(_fileRead->thread, NULL);
+#endif
+        SAFE_DELETE_ARRAY(_fileRead->data);
+        SAFE_DELETE(_fileRead);
+    }
+
+    for (size_t i = 0, count = _meshSkins.size(); i < count; ++i)
+    {
+        SAFE_DELETE(_meshSkins[i]);
+    }
+    SAFE_DELETE(_stream);
+    SAFE_RELEASE(_scene);
+    SAFE_RELEASE(_bundle);
+}
+
+bool Bundle::AsyncLoad::isComplete() const
+{
+    return _state == COMPLETE;
+}
+
+float Bundle::AsyncLoad::getProgress() const
+{
+    switch (_state)
+    {
+    case READING:
+        {
+            _fileRead->mutex.lock();
+            float progress = _fileRead->size > 0 ? (float)_fileRead->bytesRead / (float)_fileRead->size : 0.0f;
+            _fileRead->mutex.unlock();
+            return progress * 0.5f;
+        }
+    case LOADING_NODES:
+        return 0.5f + (_nodeCount > 0 ? 0.5f * (float)_nodesLoaded / (float)_nodeCount : 0.5f);
+    default:
+        return 1.0f;
+    }
+}
+
+Scene* Bundle::AsyncLoad::getScene() const
+{
+    return _state == COMPLETE ? _scene : NULL;
+}
+
+void Bundle::AsyncLoad::cancel()
+{
+    if (_state != COMPLETE)
+    {
+        // The pending time event completes the cancellation.
+        _cancelled = true;
+        _fileRead->mutex.lock();
+        _fileRead->cancelled = true;
+        _fileRead->mutex.unlock();
+    }
+}
+
+void Bundle::AsyncLoad::scheduleStep()
+{
+    // Keep this load alive until the scheduled event has fired.
+    addRef();
+    Game::getInstance()->schedule(1, this);
+}
+
+void Bundle::AsyncLoad::timeEvent(long timeDiff, void* cookie)
+{
+    if (_cancelled)
+    {
+        SAFE_RELEASE(_scene);
+        SAFE_DELETE(_stream);
+        _state = COMPLETE;
+    }
+    else if (_state == READING)
+    {
+        _fileRead->mutex.lock();
+        bool done = _fileRead->done;
+        _fileRead->mutex.unlock();
+
+        if (done)
+        {
+            // The worker thread has finished, so the data can be taken without locking.
+            char* data = _fileRead->data;
+            _fileRead->data = NULL;
+            if (data == NULL)
+            {
+                GP_ERROR("Failed to read bundle file '%s'.", _bundle->_path.c_str());
+                complete(false);
+            }
+            else
+            {
+                _stream = new MemoryStream(data, _fileRead->size);
+                _state = LOADING_NODES;
+            }
+        }
+    }
+
+    if (_state == LOADING_NODES)
+    {
+        bool finished = false;
+        bool success = loadNodes(&finished);
+        if (!success || finished)
+            complete(success);
+    }
+
+    if (_state != COMPLETE)
+    {
+        scheduleStep();
+    }
+
+    // Release the reference held for this event (this may destroy the load).
+    release();
+}
+
+bool Bundle::AsyncLoad::loadNodes(bool* finished)
+{
+    GP_ASSERT(finished);
+
+    // Read from the in-memory copy of the bundle and with our own load session state, so that
+    // other objects can still be loaded from the bundle between the steps of this load.
+    Stream* bundleStream = _bundle->_stream;
+    _bundle->_stream = _stream;
+    _bundle->_meshSkins.swap(_meshSkins);
+
+    bool success = true;
+    if (_scene == NULL)
+    {
+        _scene = _bundle->readSceneHeader(_sceneId.empty() ? NULL : _sceneId.c_str(), &_nodeCount);
+        success = _scene != NULL;
+    }
+    else
+    {
+        success = _stream->seek(_position, SEEK_SET);
+    }
+
+    if (success)
+    {
+        // Always create at least one node per step so that the load progresses.
+        double startTime = Game::getAbsoluteTime();
+        do
+        {
+            if (_nodesLoaded < _nodeCount)
+            {
+                _bundle->readSceneNode(_scene);
+                ++_nodesLoaded;
+            }
+            if (_nodesLoaded == _nodeCount)
+            {
+                success = _bundle->readSceneFooter(_scene);
+                _bundle->clearLoadSession();
+                *finished = true;
+                break;
+            }
+        } while (Game::getAbsoluteTime() - startTime < _timeBudget);
+        _position = _stream->position();
+    }
+
+    _bundle->_meshSkins.swap(_meshSkins);
+    _bundle->_stream = bundleStream;
+
+    return success;
+}
+
+void Bundle::AsyncLoad::complete(bool success)
+{
+    if (!success)
+    {
+        SAFE_RELEASE(_scene);
+    }
+    _state = COMPLETE;
+
+    // The file contents are no longer needed.
+    SAFE_DELETE(_stream);
+
+    if (_listener)
+    {
+        _listener->loadComplete(this, _scene);
+    }
+}
+
 Bundle::Reference::Reference()
     : type(0), offset(0)
 {
@@ -1785,16 +3092,24 @@ Bundle::MeshPartData::~MeshPartData()
 }
 
 Bundle::MeshData::MeshData(const VertexFormat& vertexFormat)
-    : vertexFormat(vertexFormat), vertexCount(0), vertexData(NULL)
+    : direct(false), vertexFormat(vertexFormat), vertexCount(0), vertexData(NULL)
 {
 }
 
 Bundle::MeshData::~MeshData()
 {
-    SAFE_DELETE_ARRAY(vertexData);
+    // Data read in place belongs to the stream.
+    if (!direct)
+    {
+        SAFE_DELETE_ARRAY(vertexData);
+    }
 
     for (unsigned int i = 0; i < parts.size(); ++i)
     {
+        if (direct && parts[i])
+        {
+            parts[i]->indexData = NULL;
+        }
         SAFE_DELETE(parts[i]);
     }
 }
@@ -3,6 +3,7 @@
 
 #include "Mesh.h"
 #include "Font.h"
+#include "NavigationMesh.h"
 #include "Node.h"
 #include "Game.h"
 
@@ -15,11 +16,165 @@ namespace gameplay
  */
 class Bundle : public Ref
 {
+    friend class Animation;
+    friend class Mesh;
     friend class PhysicsController;
     friend class SceneLoader;
+    friend class AsyncLoad;
+    friend class OcclusionBuffer;
+    friend class StaticBatch;
+
+    struct MeshSkinData;
 
 public:
 
+    /**
+     * Represents a scene that is being loaded asynchronously from a bundle.
+     *
+     * The contents of the bundle file are read into memory on a worker thread, so
+     * loading never blocks on file I/O. Once the file has been read, the scene's nodes,
+     * along with their meshes and materials, are created on the main thread a few at a
+     * time, for at most the time budget of the load in each frame. Loading is advanced
+     * by Game::schedule(), so it only progresses while the game is running.
+     *
+     * @see Bundle::loadSceneAsync
+     */
+    class AsyncLoad : public Ref, public TimeListener
+    {
+        friend class Bundle;
+
+    public:
+
+        /**
+         * Defines a listener that is notified when an asynchronous load completes.
+         *
+         * @script{ignore}
+         */
+        class Listener
+        {
+        public:
+
+            /**
+             * Destructor.
+             */
+            virtual ~Listener() { }
+
+            /**
+             * Called on the main thread when an asynchronous load completes.
+             *
+             * @param load The load that completed.
+             * @param scene The loaded scene, or NULL if the scene could not be loaded.
+             *      The scene is owned by the load; call addRef() on it to keep it.
+             */
+            virtual void loadComplete(AsyncLoad* load, Scene* scene) = 0;
+        };
+
+        /**
+         * Determines whether the load has completed (successfully or not) or was cancelled.
+         *
+         * @return True if the load is complete, false if it is still in progress.
+         */
+        bool isComplete() const;
+
+        /**
+         * Returns the progress of the load, between 0.0 and 1.0.
+         *
+         * The first half of the range covers reading the bundle file and
+         * the second half covers creating the nodes of the scene.
+         *
+         * @return The progress of the load.
+         */
+        float getProgress() const;
+
+        /**
+         * Returns the loaded scene.
+         *
+         * The scene is owned by the load; call addRef() on it to keep it
+         * after the load is released.
+         *
+         * @return The loaded scene, or NULL if the load has not completed or failed.
+         */
+        Scene* getScene() const;
+
+        /**
+         * Cancels the load.
+         *
+         * Any partially loaded scene is released and the listener is not notified.
+         */
+        void cancel();
+
+    private:
+
+        struct FileRead;
+
+        enum State
+        {
+            READING,
+            LOADING_NODES,
+            COMPLETE
+        };
+
+        /**
+         * Constructor.
+         */
+        AsyncLoad(Bundle* bundle, const char* id, Listener* listener, float timeBudget);
+
+        /**
+         * Destructor.
+         */
+        ~AsyncLoad();
+
+        /**
+         * Hidden copy constructor.
+         */
+        AsyncLoad(const AsyncLoad& copy);
+
+        /**
+         * Hidden copy assignment operator.
+         */
+        AsyncLoad& operator=(const AsyncLoad&);
+
+        /**
+         * Schedules the next step of the load for the next frame.
+         */
+        void scheduleStep();
+
+        /**
+         * Advances the load by one step.
+         *
+         * @see TimeListener::timeEvent
+         */
+        void timeEvent(long timeDiff, void* cookie);
+
+        /**
+         * Creates as many scene nodes as the time budget allows.
+         *
+         * @param finished Set to true when the whole scene has been loaded.
+         *
+         * @return True if successful, false if there was an error.
+         */
+        bool loadNodes(bool* finished);
+
+        /**
+         * Completes the load and notifies the listener.
+         */
+        void complete(bool success);
+
+        Bundle* _bundle;
+        std::string _sceneId;
+        Listener* _listener;
+        float _timeBudget;
+        State _state;
+        bool _cancelled;
+        FileRead* _fileRead;
+        Stream* _stream;
+        long _position;
+        Scene* _scene;
+        unsigned int _nodeCount;
+        unsigned int _nodesLoaded;
+        std::vector<MeshSkinData*> _meshSkins;
+    };
+
     /**
      * Returns a Bundle for the given resource path.
      *
@@ -44,6 +199,23 @@ public:
      */
     Scene* loadScene(const char* id = NULL);
 
+    /**
+     * Starts loading the scene with the specified ID from the bundle asynchronously.
+     * If id is NULL then the first scene found is loaded.
+     *
+     * The returned load must be released when no longer needed. Releasing it before
+     * it completes does not stop the load; call AsyncLoad::cancel() to stop it.
+     *
+     * @param id The ID of the scene to load (NULL to load the first scene).
+     * @param listener An optional listener to notify when the load completes.
+     * @param timeBudget The maximum time (in milliseconds) spent creating nodes in each frame.
+     *
+     * @return The asynchronous load.
+     * @see AsyncLoad
+     * @script{create}
+     */
+    AsyncLoad* loadSceneAsync(const char* id = NULL, AsyncLoad::Listener* listener = NULL, float timeBudget = 4.0f);
+
     /**
      * Loads a node with the specified ID from the bundle.
      *
@@ -57,6 +229,11 @@ public:
     /**
      * Loads a mesh with the specified ID from the bundle.
      *
+     * Meshes are shared between loads: while a mesh loaded from a bundle file is alive, loading
+     * the same mesh again, from this bundle or any other bundle of the same file, returns it
+     * with an extra reference instead of creating new buffers for it. Meshes loaded with a
+     * different vertex usage mask or mesh data residency are not shared.
+     *
      * @param id The ID of the mesh to load.
      * 
      * @return The loaded mesh, or NULL if the mesh could not be loaded.
@@ -74,6 +251,18 @@ public:
      */
     Font* loadFont(const char* id);
 
+    /**
+     * Loads a navigation mesh with the specified ID from the bundle.
+     *
+     * Navigation meshes are generated by gameplay-encoder from the geometry of a scene.
+     *
+     * @param id The ID of the navigation mesh to load.
+     *
+     * @return The loaded navigation mesh, or NULL if the navigation mesh could not be loaded.
+     * @script{ignore}
+     */
+    NavigationMesh* loadNavigationMesh(const char* id);
+
     /**
      * Determines if this bundle contains a top-level object with the given ID.
      *
@@ -97,6 +286,51 @@ public:
      */
     const char* getObjectId(unsigned int index) const;
 
+    /**
+     * Sets what the meshes loaded from this bundle afterwards keep in CPU memory once
+     * their data is uploaded to their buffers.
+     *
+     * Meshes keep only their bounds by default, and their data is read again from the
+     * bundle when it is needed, e.g. by PhysicsController to create mesh shapes.
+     *
+     * @param residency The data residency of the meshes.
+     *
+     * @see Mesh::setDataResidency
+     * @script{ignore}
+     */
+    void setMeshDataResidency(Mesh::DataResidency residency);
+
+    /**
+     * Returns what the meshes loaded from this bundle keep in CPU memory.
+     *
+     * @return The data residency of the meshes.
+     * @script{ignore}
+     */
+    Mesh::DataResidency getMeshDataResidency() const;
+
+    /**
+     * Sets the vertex usages kept in the meshes loaded from this bundle afterwards.
+     *
+     * The vertex elements of other usages are stripped from the vertices before they are
+     * uploaded, which saves memory and bandwidth for data that no effect reads, such as
+     * the tangents of meshes drawn without normal maps. Positions are always kept.
+     * Effect::getLoadedVertexUsageMask returns the usages read by the loaded effects.
+     *
+     * All usages are kept by default.
+     *
+     * @param mask A mask with bit (1 << usage) set for each VertexFormat::Usage to keep.
+     * @script{ignore}
+     */
+    void setVertexUsageMask(unsigned int mask);
+
+    /**
+     * Returns the vertex usages kept in the meshes loaded from this bundle.
+     *
+     * @return A mask with bit (1 << usage) set for each VertexFormat::Usage kept.
+     * @script{ignore}
+     */
+    unsigned int getVertexUsageMask() const;
+
 private:
 
     class Reference
@@ -140,6 +374,11 @@ private:
         MeshData(const VertexFormat& vertexFormat);
         ~MeshData();
 
+        /**
+         * True if the vertex and index data point directly into the bundle's stream
+         * and are not owned by the mesh data.
+         */
+        bool direct;
         VertexFormat vertexFormat;
         unsigned int vertexCount;
         unsigned char* vertexData;
@@ -161,6 +400,11 @@ private:
      */
     Bundle& operator=(const Bundle&);
 
+    /**
+     * Builds the hash tables that find the references by ID and by offset.
+     */
+    void buildIndex();
+
     /**
      * Finds a reference by ID.
      */
@@ -216,6 +460,28 @@ private:
      */
     Reference* seekToFirstType(unsigned int type);
 
+    /**
+     * Seeks to the scene with the given ID and creates it, before any of its nodes are read.
+     *
+     * @param id The ID of the scene to load (NULL to load the first scene).
+     * @param nodeCount Populated with the number of top-level nodes in the scene.
+     *
+     * @return The new scene, or NULL if there was an error.
+     */
+    Scene* readSceneHeader(const char* id, unsigned int* nodeCount);
+
+    /**
+     * Reads the next top-level node of a scene from the current file position and adds it to the scene.
+     */
+    void readSceneNode(Scene* scene);
+
+    /**
+     * Reads the scene properties following its nodes, and its animations.
+     *
+     * @return True if successful, false if there was an error.
+     */
+    bool readSceneFooter(Scene* scene);
+
     /**
      * Internal method to load a node.
      *
@@ -238,6 +504,11 @@ private:
      */
     Mesh* loadMesh(const char* id, const char* nodeId);
 
+    /**
+     * Removes a mesh that is destroyed from the meshes shared between loads.
+     */
+    static void uncacheMesh(Mesh* mesh);
+
     /**
      * Reads an unsigned int from the current file position.
      *
@@ -298,6 +569,29 @@ private:
      */
     template <class T>
     bool readArray(unsigned int* length, std::vector<T>* values, unsigned int readSize);
+
+    /**
+     * Reads an array of values and the array length from the current file position without
+     * copying the values when the stream supports direct reads.
+     *
+     * @param length A pointer to where the length of the array will be copied to.
+     * @param ptr A pointer to where the address of the values will be copied to. This points
+     *      into the stream if it supports direct reads and into values otherwise.
+     * @param values The vector the values are copied to when the stream does not support direct reads.
+     *
+     * @return True if successful, false if an error occurred.
+     */
+    template <class T>
+    bool readArrayDirect(unsigned int* length, const T** ptr, std::vector<T>* values);
+
+    /**
+     * Skips over an array of values and its length at the current file position.
+     *
+     * @param elementSize The size of each element of the array.
+     *
+     * @return True if successful, false if an error occurred.
+     */
+    bool skipArray(unsigned int elementSize);
     
     /**
      * Reads 16 floats from the current file position.
@@ -348,8 +642,12 @@ private:
 
     /**
      * Reads mesh data from the current file position.
+     *
+     * @param direct True to reference the vertex and index data in place when the stream
+     *      supports direct reads (for example, a memory mapped file) instead of copying it.
+     *      The returned data is then only valid while the stream is open.
      */
-    MeshData* readMeshData();
+    MeshData* readMeshData(bool direct = false);
 
     /**
      * Reads mesh data for the specified URL.
@@ -364,6 +662,20 @@ private:
      */
     static MeshData* readMeshData(const char* url);
 
+    /**
+     * Converts the vertices of mesh data to another vertex format.
+     *
+     * Each element of the format is copied from the element with the same usage in the
+     * data, so the data read again for a mesh can be matched to the format the mesh was
+     * loaded with (see setVertexUsageMask).
+     *
+     * @param data The mesh data, which must not reference the stream directly.
+     * @param vertexFormat The vertex format to convert the vertices to.
+     *
+     * @return true if successful, false if the data has no element for a usage of the format.
+     */
+    static bool convertMeshData(MeshData* data, const VertexFormat& vertexFormat);
+
     /**
      * Reads a mesh skin from the current file position.
      *
@@ -411,6 +723,32 @@ private:
      */
     Animation* readAnimationChannelData(Animation* animation, const char* id, AnimationTarget* target, unsigned int targetAttribute);
 
+    /**
+     * Reads the key times and values of an animation channel at the current file position.
+     *
+     * The key values are either floats or compressed by the encoder, in which case they are
+     * evaluated by a packed curve. Only the key times are read when no curve is requested.
+     *
+     * @param id The ID of the animation the channel belongs to.
+     * @param target The animation target, or NULL if the target attribute is 0.
+     * @param targetAttribute The target attribute being animated, or 0 to skip the channel.
+     * @param curve Set to the new curve of the channel, or NULL to skip the key values.
+     * @param duration Set to the duration of the channel (in milliseconds).
+     *
+     * @return True if successful, false if there was an error.
+     */
+    bool readAnimationCurveData(const char* id, AnimationTarget* target, unsigned int targetAttribute, Curve** curve, unsigned long* duration);
+
+    /**
+     * Reads the curve of an animation channel whose loading was deferred (see
+     * AnimationController::setDeferredLoadingEnabled) at the given file offset.
+     *
+     * The file position is restored afterwards.
+     *
+     * @return The new curve, or NULL if there was an error.
+     */
+    Curve* readAnimationCurve(const char* id, AnimationTarget* target, int targetAttribute, long offset);
+
     /**
      * Sets the transformation matrix.
      *
@@ -437,7 +775,12 @@ private:
     std::string _materialPath;
     unsigned int _referenceCount;
     Reference* _references;
+    std::vector<unsigned int> _idSlots;         // The index + 1 of the references by the hash of their ID, or 0. The count is a power of two.
+    std::vector<unsigned int> _offsetSlots;     // The index + 1 of the references by the hash of their offset, or 0.
     Stream* _stream;
+    unsigned char _version[2];
+    Mesh::DataResidency _meshDataResidency;
+    unsigned int _vertexUsageMask;
 
     std::vector<MeshSkinData*> _meshSkins;
     std::map<std::string, Node*>* _trackedNodes;
@@ -225,6 +225,18 @@ public:
      */
     const Matrix& getInverseViewProjectionMatrix() const;
 
+    /**
+     * Returns the revision of the camera's matrices and frustum.
+     *
+     * The revision changes whenever the view or the projection of the camera changes, and is
+     * never shared by two cameras, so values derived from the matrices of a camera only need
+     * to be computed again when its revision differs from the one they were computed for.
+     *
+     * @return The revision of the camera.
+     * @script{ignore}
+     */
+    unsigned int getRevision() const;
+
     /**
      * Gets the view bounding frustum.
      *
@@ -327,6 +339,11 @@ private:
      */
     void setNode(Node* node);
 
+    /**
+     * Marks the given matrices dirty and moves the camera to a new revision.
+     */
+    void setDirty(int bits);
+
     Camera::Type _type;
     float _fieldOfView;
     float _zoom[2];
@@ -340,6 +357,7 @@ private:
     mutable Matrix _inverseViewProjection;
     mutable Frustum _bounds;
     mutable int _bits;
+    unsigned int _revision;
     Node* _node;
 };
 
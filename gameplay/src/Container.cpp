@@ -12,6 +12,7 @@
 #include "TextBox.h"
 #include "Joystick.h"
 #include "ImageControl.h"
+#include "VirtualList.h"
 #include "Game.h"
 
 namespace gameplay
@@ -39,6 +40,30 @@ static const float FOCUS_CHANGE_REPEAT_DELAY = 300.0f;
  */
 static bool sortControlsByZOrder(Control* c1, Control* c2);
 
+// The fewest controls a container has for pointer events to be tested against a grid of their bounds.
+#define HIT_GRID_MIN_CONTROLS 16
+
+// The most columns and rows of the grid.
+#define HIT_GRID_MAX_CELLS 16
+
+/**
+ * Whether a pointer event is passed on to the controls it is within, rather than only to those
+ * that are engaged.
+ */
+static bool isPointerPositionEvent(char evt)
+{
+    return (evt == Touch::TOUCH_PRESS ||
+            evt == Mouse::MOUSE_PRESS_LEFT_BUTTON ||
+            evt == Mouse::MOUSE_PRESS_MIDDLE_BUTTON ||
+            evt == Mouse::MOUSE_PRESS_RIGHT_BUTTON ||
+            evt == Mouse::MOUSE_MOVE ||
+            evt == Mouse::MOUSE_WHEEL);
+}
+
+// The number of layouts that were run and skipped since the forms were last updated.
+static unsigned int __layoutUpdateCount = 0;
+static unsigned int __layoutSkipCount = 0;
+
 void Container::clearContacts()
 {
 	for (int i = 0; i < MAX_CONTACT_INDICES; ++i)
@@ -54,13 +79,14 @@ Container::Container()
       _scrollingStartTimeX(0), _scrollingStartTimeY(0), _scrollingLastTime(0),
       _scrollingVelocity(Vector2::zero()), _scrollingFriction(1.0f), _scrollWheelSpeed(400.0f),
       _scrollingRight(false), _scrollingDown(false),
-      _scrollingMouseVertically(false), _scrollingMouseHorizontally(false),
+      _scrollingMouseVertically(false), _scrollingMouseHorizontally(false), _layoutDirty(true),
       _scrollBarOpacityClip(NULL), _zIndexDefault(0), _focusIndexDefault(0), _focusIndexMax(0),
       _focusPressed(0), _selectButtonDown(false),
       _lastFrameTime(0), _focusChangeRepeat(false),
       _focusChangeStartTime(0), _focusChangeRepeatDelay(FOCUS_CHANGE_REPEAT_DELAY), _focusChangeCount(0),
       _totalWidth(0), _totalHeight(0),
-      _initializedWithScroll(false), _scrollWheelRequiresFocus(false)
+      _initializedWithScroll(false), _scrollWheelRequiresFocus(false),
+      _hitGridDirty(true), _hitGridBounds(Rectangle::empty()), _hitGridColumns(0), _hitGridRows(0), _engagedControlsDirty(true)
 {
 	clearContacts();
 }
@@ -129,7 +155,7 @@ Container* Container::create(Theme::Style* style, Properties* properties, Theme*
         container->_scrollWheelSpeed = properties->getFloat("scrollWheelSpeed");
 
     container->addControls(theme, properties);
-    container->_layout->update(container, container->_scrollPosition);
+    container->updateLayout(container->_scrollPosition);
 
     return container;
 }
@@ -194,6 +220,10 @@ void Container::addControls(Theme* theme, Properties* properties)
         {
             control = ImageControl::create(controlStyle, controlSpace);
         }
+        else if (controlName == "VIRTUALLIST")
+        {
+            control = VirtualList::create(controlStyle, controlSpace, theme);
+        }
         else
         {
             // Ignore - not a valid control name.
@@ -250,6 +280,7 @@ unsigned int Container::addControl(Control* control)
         control->addRef();
         control->_parent = this;
         sortControls();
+        _layoutDirty = true;
         return (unsigned int)(_controls.size() - 1);
     }
     else
@@ -287,6 +318,7 @@ void Container::insertControl(Control* control, unsigned int index)
         _controls.insert(it, control);
         control->addRef();
         control->_parent = this;
+        _layoutDirty = true;
     }
 }
 
@@ -294,11 +326,14 @@ void Container::removeControl(unsigned int index)
 {
     GP_ASSERT(index < _controls.size());
 
+    // The area of the removed control has to be redrawn.
     std::vector<Control*>::iterator it = _controls.begin() + index;
-    _controls.erase(it);
     Control* control = *it;
+    _controls.erase(it);
     control->_parent = NULL;
     SAFE_RELEASE(control);
+    _dirty = true;
+    _layoutDirty = true;
 }
 
 void Container::removeControl(const char* id)
@@ -313,6 +348,8 @@ void Container::removeControl(const char* id)
             c->_parent = NULL;
             SAFE_RELEASE(c);
             _controls.erase(it);
+            _dirty = true;
+            _layoutDirty = true;
             return;
         }
     }
@@ -329,6 +366,8 @@ void Container::removeControl(Control* control)
             control->_parent = NULL;
             SAFE_RELEASE(control);
             _controls.erase(it);
+            _dirty = true;
+            _layoutDirty = true;
             return;
         }
     }
@@ -480,44 +519,34 @@ void Container::update(const Control* container, const Vector2& offset)
     }
     else
     {
-        _layout->update(this, Vector2::zero());
+        updateLayout(Vector2::zero());
     }
 }
 
-void Container::draw(SpriteBatch* spriteBatch, const Rectangle& clip, bool needsClear, bool cleared, float targetHeight)
+void Container::draw(SpriteBatch* spriteBatch, const Rectangle& clip, const Rectangle& region)
 {
-    if (needsClear)
-    {
-        GL_ASSERT( glEnable(GL_SCISSOR_TEST) );
-        float clearY = targetHeight - _clearBounds.y - _clearBounds.height;
-        GL_ASSERT( glScissor(_clearBounds.x, clearY, _clearBounds.width, _clearBounds.height) );
-        Game::getInstance()->clear(Game::CLEAR_COLOR, Vector4::zero(), 1.0f, 0);
-        GL_ASSERT( glDisable(GL_SCISSOR_TEST) );
-        needsClear = false;
-        cleared = true;
-    }
-    else if (!cleared)
-    {
-        needsClear = true;
-    }
-
     if (!_visible)
+    {
+        // The controls are not drawn either, so forget where they were drawn.
+        clearDrawnBounds();
         return;
+    }
+    _clearBounds.set(_absoluteClipBounds);
 
     spriteBatch->start();
     Control::drawBorder(spriteBatch, clip);
     spriteBatch->finish();
 
+    // Only the controls within the region need to be redrawn. Dirty controls outside of it
+    // are drawn as well, which updates their state but has no effect on the render target.
     std::vector<Control*>::const_iterator it;
-    Rectangle boundsUnion = Rectangle::empty();
     for (it = _controls.begin(); it < _controls.end(); it++)
     {
         Control* control = *it;
         GP_ASSERT(control);
-        if (!needsClear || control->isDirty() || control->_clearBounds.intersects(boundsUnion))
+        if (control->isDirty() || control->_absoluteClipBounds.intersects(region))
         {
-            control->draw(spriteBatch, _viewportClipBounds, needsClear, cleared, targetHeight);
-            Rectangle::combine(control->_clearBounds, boundsUnion, &boundsUnion);
+            control->draw(spriteBatch, _viewportClipBounds, region);
         }
     }
 
@@ -603,6 +632,47 @@ void Container::draw(SpriteBatch* spriteBatch, const Rectangle& clip, bool needs
     }
 }
 
+void Container::addDirtyRegions(std::vector<Rectangle, FrameAllocator<Rectangle> >* regions)
+{
+    GP_ASSERT(regions);
+
+    // A dirty container is redrawn completely, otherwise only its dirty controls are.
+    if (_dirty)
+    {
+        Control::addDirtyRegions(regions);
+    }
+    else if (_visible)
+    {
+        std::vector<Control*>::const_iterator it;
+        for (it = _controls.begin(); it < _controls.end(); it++)
+        {
+            GP_ASSERT(*it);
+            (*it)->addDirtyRegions(regions);
+        }
+    }
+}
+
+void Container::clearDrawnBounds()
+{
+    _clearBounds = Rectangle::empty();
+    _dirty = false;
+    std::vector<Control*>::const_iterator it;
+    for (it = _controls.begin(); it < _controls.end(); it++)
+    {
+        Control* control = *it;
+        GP_ASSERT(control);
+        if (control->isContainer())
+        {
+            static_cast<Container*>(control)->clearDrawnBounds();
+        }
+        else
+        {
+            control->_clearBounds = Rectangle::empty();
+            control->_dirty = false;
+        }
+    }
+}
+
 bool Container::isDirty()
 {
     if (_dirty)
@@ -1283,7 +1353,7 @@ void Container::updateScroll()
     if (!_initializedWithScroll)
     {
         _initializedWithScroll = true;
-        _layout->update(this, _scrollPosition);
+        updateLayout(_scrollPosition);
     }
 
     // Update time.
@@ -1299,26 +1369,7 @@ void Container::updateScroll()
     const Theme::Padding& containerPadding = getPadding();
 
     // Calculate total width and height.
-    std::vector<Control*> controls = getControls();
-    for (size_t i = 0, controlsCount = controls.size(); i < controlsCount; i++)
-    {
-        Control* control = controls.at(i);
-
-        const Rectangle& bounds = control->getBounds();
-        const Theme::Margin& margin = control->getMargin();
-
-        float newWidth = bounds.x + bounds.width;
-        if (newWidth > _totalWidth)
-        {
-            _totalWidth = newWidth;
-        }
-
-        float newHeight = bounds.y + bounds.height;
-        if (newHeight > _totalHeight)
-        {
-            _totalHeight = newHeight;
-        }
-    }
+    measureContents(&_totalWidth, &_totalHeight);
 
     float vWidth = getImageRegion("verticalScrollBar", _state).width;
     float hHeight = getImageRegion("horizontalScrollBar", _state).height;
@@ -1398,7 +1449,83 @@ void Container::updateScroll()
     }
 
     // Position controls within scroll area.
-    _layout->update(this, _scrollPosition);
+    updateLayout(_scrollPosition);
+}
+
+void Container::measureContents(float* width, float* height)
+{
+    GP_ASSERT(width);
+    GP_ASSERT(height);
+
+    for (size_t i = 0, controlsCount = _controls.size(); i < controlsCount; i++)
+    {
+        Control* control = _controls[i];
+        GP_ASSERT(control);
+
+        const Rectangle& bounds = control->getBounds();
+
+        float newWidth = bounds.x + bounds.width;
+        if (newWidth > *width)
+        {
+            *width = newWidth;
+        }
+
+        float newHeight = bounds.y + bounds.height;
+        if (newHeight > *height)
+        {
+            *height = newHeight;
+        }
+    }
+}
+
+// Returns whether two rectangles are the same.
+static bool equals(const Rectangle& r1, const Rectangle& r2)
+{
+    return r1.x == r2.x && r1.y == r2.y && r1.width == r2.width && r1.height == r2.height;
+}
+
+void Container::updateLayout(const Vector2& offset)
+{
+    GP_ASSERT(_layout);
+
+    // Where the layout places the controls only depends on the controls themselves, the offset and
+    // where the container is, and any change to a control marks it dirty.
+    bool dirty = _layoutDirty || offset != _layoutOffset ||
+        !equals(_viewportBounds, _layoutViewportBounds) || !equals(_viewportClipBounds, _layoutClipBounds);
+    for (size_t i = 0, count = _controls.size(); i < count && !dirty; ++i)
+    {
+        GP_ASSERT(_controls[i]);
+        dirty = _controls[i]->isDirty();
+    }
+    if (!dirty)
+    {
+        ++__layoutSkipCount;
+        return;
+    }
+
+    _layout->update(this, offset);
+    _layoutDirty = false;
+    _hitGridDirty = true;
+    _layoutOffset = offset;
+    _layoutViewportBounds = _viewportBounds;
+    _layoutClipBounds = _viewportClipBounds;
+    ++__layoutUpdateCount;
+}
+
+unsigned int Container::getLayoutUpdateCount()
+{
+    return __layoutUpdateCount;
+}
+
+unsigned int Container::getLayoutSkipCount()
+{
+    return __layoutSkipCount;
+}
+
+void Container::resetLayoutCounts()
+{
+    __layoutUpdateCount = 0;
+    __layoutSkipCount = 0;
 }
 
 void Container::sortControls()
@@ -1407,6 +1534,7 @@ void Container::sortControls()
     {
         std::sort(_controls.begin(), _controls.end(), &sortControlsByZOrder);
     }
+    _hitGridDirty = true;
 }
 
 bool Container::touchEventScroll(Touch::TouchEvent evt, int x, int y, unsigned int contactIndex)
@@ -1676,43 +1804,44 @@ bool Container::pointerEvent(bool mouse, char evt, int x, int y, int data)
         offset = &_scrollPosition;
     }
 
-    std::vector<Control*>::const_iterator it;
-    for (it = _controls.begin(); it < _controls.end(); it++)
+    if (_controls.size() < HIT_GRID_MIN_CONTROLS)
     {
-        Control* control = *it;
-        GP_ASSERT(control);
-        if (!control->isEnabled() || !control->isVisible())
+        std::vector<Control*>::const_iterator it;
+        for (it = _controls.begin(); it < _controls.end(); it++)
         {
-            continue;
+            eventConsumed |= pointerEventControl(*it, mouse, evt, x, y, data, xPos, yPos, offset);
+        }
+    }
+    else
+    {
+        // Only the controls in the cell of the grid the event is in can contain it, and
+        // the engaged controls receive it wherever it is. Both lists are in the order of
+        // the controls, so they are merged to pass the event on in that order.
+        if (_hitGridDirty || _layoutDirty || _engagedControlsDirty)
+            updateHitGrid();
+
+        const unsigned int* cell = NULL;
+        unsigned int cellSize = 0;
+        float gridX = x - xPos - (offset ? offset->x : 0.0f) - _hitGridBounds.x;
+        float gridY = y - yPos - (offset ? offset->y : 0.0f) - _hitGridBounds.y;
+        if (isPointerPositionEvent(evt) && gridX >= 0 && gridX <= _hitGridBounds.width && gridY >= 0 && gridY <= _hitGridBounds.height)
+        {
+            unsigned int column = std::min((unsigned int)(gridX * _hitGridColumns / std::max(_hitGridBounds.width, 1.0f)), _hitGridColumns - 1);
+            unsigned int row = std::min((unsigned int)(gridY * _hitGridRows / std::max(_hitGridBounds.height, 1.0f)), _hitGridRows - 1);
+            unsigned int index = row * _hitGridColumns + column;
+            cellSize = _hitGridCells[index + 1] - _hitGridCells[index];
+            if (cellSize > 0)
+                cell = &_hitGridIndices[_hitGridCells[index]];
         }
 
-        const Rectangle& bounds = control->getBounds();
-        float boundsX = bounds.x;
-        float boundsY = bounds.y;
-        if (offset)
-        {
-            boundsX += offset->x;
-            boundsY += offset->y;
-        }
-
-        Control::State currentState = control->getState();
-        if ((currentState != Control::NORMAL) ||
-            ((evt == Touch::TOUCH_PRESS ||
-              evt == Mouse::MOUSE_PRESS_LEFT_BUTTON ||
-              evt == Mouse::MOUSE_PRESS_MIDDLE_BUTTON ||
-              evt == Mouse::MOUSE_PRESS_RIGHT_BUTTON ||
-              evt == Mouse::MOUSE_MOVE ||
-              evt == Mouse::MOUSE_WHEEL) &&
-                x >= xPos + boundsX &&
-                x <= xPos + boundsX + bounds.width &&
-                y >= yPos + boundsY &&
-                y <= yPos + boundsY + bounds.height))
-        {
-            // Pass on the event's clip relative to the control.
-            if (mouse)
-                eventConsumed |= control->mouseEvent((Mouse::MouseEvent)evt, x - xPos - boundsX, y - yPos - boundsY, data);
-            else
-                eventConsumed |= control->touchEvent((Touch::TouchEvent)evt, x - xPos - boundsX, y - yPos - boundsY, (unsigned int)data);
+        // Listeners can change the controls, so the candidates are copied first.
+        std::vector<unsigned int> candidates(cellSize + _engagedControls.size());
+        std::vector<unsigned int>::iterator end = std::merge(cell, cell + cellSize, _engagedControls.begin(), _engagedControls.end(), candidates.begin());
+        candidates.erase(std::unique(candidates.begin(), end), candidates.end());
+        for (size_t i = 0, count = candidates.size(); i < count; ++i)
+        {
+            if (candidates[i] < _controls.size())
+                eventConsumed |= pointerEventControl(_controls[candidates[i]], mouse, evt, x, y, data, xPos, yPos, offset);
         }
     }
 
@@ -1806,6 +1935,109 @@ bool Container::pointerEvent(bool mouse, char evt, int x, int y, int data)
     return (_consumeInputEvents | eventConsumed);
 }
 
+bool Container::pointerEventControl(Control* control, bool mouse, char evt, int x, int y, int data, float xPos, float yPos, const Vector2* offset)
+{
+    GP_ASSERT(control);
+    if (!control->isEnabled() || !control->isVisible())
+    {
+        return false;
+    }
+
+    const Rectangle& bounds = control->getBounds();
+    float boundsX = bounds.x;
+    float boundsY = bounds.y;
+    if (offset)
+    {
+        boundsX += offset->x;
+        boundsY += offset->y;
+    }
+
+    Control::State currentState = control->getState();
+    if ((currentState != Control::NORMAL) ||
+        (isPointerPositionEvent(evt) &&
+            x >= xPos + boundsX &&
+            x <= xPos + boundsX + bounds.width &&
+            y >= yPos + boundsY &&
+            y <= yPos + boundsY + bounds.height))
+    {
+        // Pass on the event's clip relative to the control.
+        if (mouse)
+            return control->mouseEvent((Mouse::MouseEvent)evt, x - xPos - boundsX, y - yPos - boundsY, data);
+        else
+            return control->touchEvent((Touch::TouchEvent)evt, x - xPos - boundsX, y - yPos - boundsY, (unsigned int)data);
+    }
+    return false;
+}
+
+void Container::updateHitGrid()
+{
+    // The controls that are neither normal nor disabled receive pointer events wherever they are.
+    unsigned int controlCount = (unsigned int)_controls.size();
+    _engagedControls.clear();
+    for (unsigned int i = 0; i < controlCount; ++i)
+    {
+        Control::State state = _controls[i]->getState();
+        if (state != Control::NORMAL && state != Control::DISABLED)
+            _engagedControls.push_back(i);
+    }
+    _engagedControlsDirty = false;
+
+    if (!_hitGridDirty && !_layoutDirty)
+        return;
+    _hitGridDirty = false;
+
+    // The grid covers the bounds of all of the controls, with about as many cells as controls.
+    _hitGridBounds = Rectangle::empty();
+    for (unsigned int i = 0; i < controlCount; ++i)
+    {
+        const Rectangle& bounds = _controls[i]->getBounds();
+        if (i == 0)
+            _hitGridBounds = bounds;
+        else
+            Rectangle::combine(_hitGridBounds, bounds, &_hitGridBounds);
+    }
+    unsigned int cells = (unsigned int)ceil(sqrt((float)controlCount));
+    _hitGridColumns = std::max(std::min(cells, (unsigned int)HIT_GRID_MAX_CELLS), 1u);
+    _hitGridRows = _hitGridColumns;
+    float columnScale = _hitGridColumns / std::max(_hitGridBounds.width, 1.0f);
+    float rowScale = _hitGridRows / std::max(_hitGridBounds.height, 1.0f);
+
+    // Each control is listed in each cell its bounds overlap: the cells are counted first,
+    // then the indices of the controls are written in order, so each cell's list is sorted.
+    unsigned int cellCount = _hitGridColumns * _hitGridRows;
+    _hitGridCells.assign(cellCount + 1, 0);
+    std::vector<unsigned int> next;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        if (pass == 1)
+        {
+            for (unsigned int c = 0; c < cellCount; ++c)
+                _hitGridCells[c + 1] += _hitGridCells[c];
+            _hitGridIndices.resize(_hitGridCells[cellCount]);
+            next.assign(_hitGridCells.begin(), _hitGridCells.end() - 1);
+        }
+        for (unsigned int i = 0; i < controlCount; ++i)
+        {
+            const Rectangle& bounds = _controls[i]->getBounds();
+            unsigned int column1 = std::min((unsigned int)std::max((bounds.x - _hitGridBounds.x) * columnScale, 0.0f), _hitGridColumns - 1);
+            unsigned int column2 = std::min((unsigned int)std::max((bounds.x + bounds.width - _hitGridBounds.x) * columnScale, 0.0f), _hitGridColumns - 1);
+            unsigned int row1 = std::min((unsigned int)std::max((bounds.y - _hitGridBounds.y) * rowScale, 0.0f), _hitGridRows - 1);
+            unsigned int row2 = std::min((unsigned int)std::max((bounds.y + bounds.height - _hitGridBounds.y) * rowScale, 0.0f), _hitGridRows - 1);
+            for (unsigned int row = row1; row <= row2; ++row)
+            {
+                for (unsigned int column = column1; column <= column2; ++column)
+                {
+                    unsigned int c = row * _hitGridColumns + column;
+                    if (pass == 0)
+                        ++_hitGridCells[c + 1];
+                    else
+                        _hitGridIndices[next[c]++] = i;
+                }
+            }
+        }
+    }
+}
+
 Container::Scroll Container::getScroll(const char* scroll)
 {
     if (!scroll)
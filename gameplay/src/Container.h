@@ -50,6 +50,7 @@ namespace gameplay
  */
 class Container : public Control, TimeListener
 {
+    friend class Control;
 
 public:
 
@@ -259,6 +260,21 @@ public:
      */
     void timeEvent(long timeDiff, void* cookie);
 
+    /**
+     * Returns the number of times the layout of a container was run since the forms were last updated.
+     *
+     * @return The number of layouts that were run.
+     */
+    static unsigned int getLayoutUpdateCount();
+
+    /**
+     * Returns the number of times the layout of a container was skipped since the forms were last
+     * updated, because neither the container nor its controls had changed.
+     *
+     * @return The number of layouts that were skipped.
+     */
+    static unsigned int getLayoutSkipCount();
+
 protected:
 
     /**
@@ -363,6 +379,16 @@ protected:
      */
     virtual bool isDirty();
 
+    /**
+     * @see Control::addDirtyRegions
+     */
+    virtual void addDirtyRegions(std::vector<Rectangle, FrameAllocator<Rectangle> >* regions);
+
+    /**
+     * Marks this container and all of its controls as not drawn, when the container is hidden.
+     */
+    void clearDrawnBounds();
+
     /**
      * Adds controls nested within a properties object to this container,
      * searching for styles within the given theme.
@@ -375,19 +401,43 @@ protected:
     /**
      * Draws a sprite batch for the specified clipping rect.
      *
+     * The form's render target has already been cleared within the region, and drawing
+     * outside of it is discarded by the scissor test.
+     *
      * @param spriteBatch The sprite batch to use.
      * @param clip The clipping rectangle.
-     * @param needsClear Whether it needs to be cleared.
-     * @param cleared Whether it was previously cleared
-     * @param targetHeight The targets height
+     * @param region The area of the form that is being redrawn.
      */
-    virtual void draw(SpriteBatch* spriteBatch, const Rectangle& clip, bool needsClear, bool cleared, float targetHeight);
+    virtual void draw(SpriteBatch* spriteBatch, const Rectangle& clip, const Rectangle& region);
 
     /**
      * Update scroll position and velocity.
      */
     void updateScroll();
 
+    /**
+     * Positions and updates the controls with the container's layout, unless the controls,
+     * the offset and the bounds of the container are the same as when the layout last ran.
+     *
+     * @param offset The update offset.
+     */
+    virtual void updateLayout(const Vector2& offset);
+
+    /**
+     * Computes the size of the scrollable content of the container.
+     *
+     * The size is only ever increased, so it is passed in as the size computed previously.
+     *
+     * @param width The width of the content.
+     * @param height The height of the content.
+     */
+    virtual void measureContents(float* width, float* height);
+
+    /**
+     * Resets the layout counters, once per frame.
+     */
+    static void resetLayoutCounts();
+
     /**
      * Sorts controls by Z-Order (for absolute layouts only).
      * This method is used by controls to notify their parent container when
@@ -439,6 +489,20 @@ protected:
      */
     bool pointerEvent(bool mouse, char evt, int x, int y, int data);
 
+    /**
+     * Passes a pointer event on to a control, if it is in a state to receive it or the event
+     * is within its bounds.
+     *
+     * @return True if the control consumed the event.
+     */
+    bool pointerEventControl(Control* control, bool mouse, char evt, int x, int y, int data, float xPos, float yPos, const Vector2* offset);
+
+    /**
+     * Builds the grid of the bounds of the controls that pointer events are tested against,
+     * and finds the controls that receive pointer events wherever they are.
+     */
+    void updateHitGrid();
+
     /**
      * Get a Scroll enum from a matching string.
      *
@@ -568,6 +632,22 @@ protected:
      * Locked to scrolling horizontally by grabbing the scrollbar with the mouse.
      */
     bool _scrollingMouseHorizontally;
+    /**
+     * Whether the controls must be laid out again, because they were added, removed or reordered.
+     */
+    bool _layoutDirty;
+    /**
+     * The offset the layout last ran with.
+     */
+    Vector2 _layoutOffset;
+    /**
+     * The content area of the container when the layout last ran.
+     */
+    Rectangle _layoutViewportBounds;
+    /**
+     * The clipped content area of the container when the layout last ran.
+     */
+    Rectangle _layoutClipBounds;
 
 private:
 
@@ -621,6 +701,21 @@ private:
     bool _contactIndices[MAX_CONTACT_INDICES];
     bool _initializedWithScroll;
     bool _scrollWheelRequiresFocus;
+
+    // A grid over the bounds of the controls, which pointer events are tested against when
+    // the container has many controls. Each cell lists the indices of the controls that
+    // overlap it in order, with the list of cell i starting at _hitGridCells[i].
+    bool _hitGridDirty;
+    Rectangle _hitGridBounds;
+    unsigned int _hitGridColumns;
+    unsigned int _hitGridRows;
+    std::vector<unsigned int> _hitGridCells;
+    std::vector<unsigned int> _hitGridIndices;
+
+    // The indices of the controls that are active, focused or hovered, which receive pointer
+    // events wherever they are. Controls mark it dirty when they change to or from these states.
+    bool _engagedControlsDirty;
+    std::vector<unsigned int> _engagedControls;
 };
 
 }
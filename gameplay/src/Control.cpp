@@ -1,14 +1,16 @@
 #include "Base.h"
 #include "Game.h"
 #include "Control.h"
+#include "Container.h"
 
 namespace gameplay
 {
 
 Control::Control()
     : _id(""), _state(Control::NORMAL), _bounds(Rectangle::empty()), _clipBounds(Rectangle::empty()), _viewportClipBounds(Rectangle::empty()),
-    _clearBounds(Rectangle::empty()), _dirty(true), _consumeInputEvents(false), _alignment(ALIGN_TOP_LEFT), _isAlignmentSet(false), _autoWidth(false), _autoHeight(false), _listeners(NULL), _visible(true),
-    _zIndex(-1), _contactIndex(INVALID_CONTACT_INDEX), _focusIndex(-1), _parent(NULL), _styleOverridden(false), _skin(NULL), _previousState(NORMAL)
+    _clearBounds(Rectangle::empty()), _dirty(true), _consumeInputEvents(false), _alignment(ALIGN_TOP_LEFT), _isAlignmentSet(false), _autoWidth(false), _autoHeight(false), _listeners(NULL), _scriptEventFilter(~0), _visible(true),
+    _zIndex(-1), _contactIndex(INVALID_CONTACT_INDEX), _focusIndex(-1), _parent(NULL), _styleOverridden(false), _skin(NULL), _previousState(NORMAL),
+    _resolvedStyleDirty(true), _resolvedState(NORMAL), _resolvedPreviousState(NORMAL)
 {
     addScriptEvent("controlEvent", "<Control>[Control::Listener::EventType]");
 }
@@ -35,6 +37,7 @@ void Control::initialize(Theme::Style* style, Properties* properties)
 {
     GP_ASSERT(properties);
     _style = style;
+    _resolvedStyleDirty = true;
 
     // Properties not defined by the style.
     _alignment = getAlignment(properties->getString("alignment"));
@@ -310,6 +313,8 @@ void Control::setEnabled(bool enabled)
 	}
 	else if (!enabled && _state != Control::DISABLED)
 	{
+        if (_parent && _state != Control::NORMAL)
+            _parent->_engagedControlsDirty = true;
 		_state = Control::DISABLED;
 		_dirty = true;
 	}
@@ -640,6 +645,7 @@ void Control::setStyle(Theme::Style* style)
     if (style != _style)
     {
         _dirty = true;
+        _resolvedStyleDirty = true;
     }
 
     _style = style;
@@ -655,6 +661,12 @@ void Control::setState(State state)
     if (getOverlay(_state) != getOverlay(state))
         _dirty = true;
 
+    // The parent passes pointer events to the controls that are neither normal nor disabled
+    // wherever the events are.
+    bool engaged = (_state != NORMAL && _state != DISABLED);
+    if (_parent && engaged != (state != NORMAL && state != DISABLED))
+        _parent->_engagedControlsDirty = true;
+
     _state = state;
 }
 
@@ -692,6 +704,16 @@ bool Control::getConsumeInputEvents()
     return _consumeInputEvents;
 }
 
+void Control::setScriptEventFilter(int eventFlags)
+{
+    _scriptEventFilter = eventFlags;
+}
+
+int Control::getScriptEventFilter() const
+{
+    return _scriptEventFilter;
+}
+
 int Control::getZIndex() const
 {
     return _zIndex;
@@ -809,6 +831,8 @@ bool Control::touchEvent(Touch::TouchEvent evt, int x, int y, unsigned int conta
         else
         {
             // If this control was in focus, it's not any more.
+            if (_parent && _state != NORMAL && _state != DISABLED)
+                _parent->_engagedControlsDirty = true;
             _state = NORMAL;
         }
         break;
@@ -941,7 +965,8 @@ void Control::notifyListeners(Control::Listener::EventType eventType)
         }
     }
 
-    fireScriptEvent<void>("controlEvent", this, eventType);
+    if (_scriptEventFilter & eventType)
+        fireScriptEvent<void>("controlEvent", this, eventType);
 
     release();
 }
@@ -951,8 +976,6 @@ void Control::update(const Control* container, const Vector2& offset)
     const Rectangle& clip = container->getClip();
     const Rectangle& absoluteViewport = container->_viewportBounds;
 
-    _clearBounds.set(_absoluteClipBounds);
-
     // Calculate the clipped bounds.
     float x = _bounds.x + offset.x;
     float y = _bounds.y + offset.y;
@@ -1040,16 +1063,13 @@ void Control::update(const Control* container, const Vector2& offset)
     width += border.left + padding.left + border.right + padding.right;
     height += border.top + padding.top + border.bottom + padding.bottom;
     _absoluteClipBounds.set(x - border.left - padding.left, y - border.top - padding.top, max(width, 0.0f), max(height, 0.0f));
-    if (_clearBounds.isEmpty())
-    {
-        _clearBounds.set(_absoluteClipBounds);
-    }
 
     // Cache themed attributes for performance.
-    _skin = getSkin(_state);
+    const ResolvedStyle& style = getResolvedStyle();
+    _skin = style.skin;
 
     // Current opacity should be multiplied by that of the parent container.
-    _opacity = getOpacity(_state) * container->_opacity;
+    _opacity = style.opacity * container->_opacity;
 }
 
 void Control::drawBorder(SpriteBatch* spriteBatch, const Rectangle& clip)
@@ -1069,9 +1089,9 @@ void Control::drawBorder(SpriteBatch* spriteBatch, const Rectangle& clip)
     const Theme::UVs& bottomRight = _skin->getUVs(Theme::Skin::BOTTOM_RIGHT);
 
     // Calculate screen-space positions.
-    const Theme::Border& border = getBorder(_state);
-    const Theme::Padding& padding = getPadding();
-    Vector4 skinColor = _skin->getColor();
+    const ResolvedStyle& style = getResolvedStyle();
+    const Theme::Border& border = style.border;
+    Vector4 skinColor = style.skinColor;
     skinColor.w *= _opacity;
 
     float midWidth = _bounds.width - border.left - border.right;
@@ -1121,18 +1141,15 @@ void Control::drawText(const Rectangle& position)
 {
 }
 
-void Control::draw(SpriteBatch* spriteBatch, const Rectangle& clip, bool needsClear, bool cleared, float targetHeight)
+void Control::draw(SpriteBatch* spriteBatch, const Rectangle& clip, const Rectangle& region)
 {
-    if (needsClear)
-    {
-        GL_ASSERT( glEnable(GL_SCISSOR_TEST) );
-        GL_ASSERT( glScissor(_clearBounds.x, targetHeight - _clearBounds.y - _clearBounds.height, _clearBounds.width, _clearBounds.height) );
-        Game::getInstance()->clear(Game::CLEAR_COLOR, Vector4::zero(), 1.0f, 0);
-        GL_ASSERT( glDisable(GL_SCISSOR_TEST) );
-    }
-
+    _dirty = false;
     if (!_visible)
+    {
+        _clearBounds = Rectangle::empty();
         return;
+    }
+    _clearBounds.set(_absoluteClipBounds);
 
     spriteBatch->start();
     drawBorder(spriteBatch, clip);
@@ -1140,7 +1157,6 @@ void Control::draw(SpriteBatch* spriteBatch, const Rectangle& clip, bool needsCl
     spriteBatch->finish();
 
     drawText(clip);
-    _dirty = false;
 }
 
 bool Control::isDirty()
@@ -1148,6 +1164,19 @@ bool Control::isDirty()
     return _dirty;
 }
 
+void Control::addDirtyRegions(std::vector<Rectangle, FrameAllocator<Rectangle> >* regions)
+{
+    GP_ASSERT(regions);
+
+    if (isDirty())
+    {
+        if (!_clearBounds.isEmpty())
+            regions->push_back(_clearBounds);
+        if (_visible && !_absoluteClipBounds.isEmpty())
+            regions->push_back(_absoluteClipBounds);
+    }
+}
+
 bool Control::isContainer() const
 {
     return false;
@@ -1186,6 +1215,23 @@ Control::State Control::getState(const char* state)
 
 Theme::ThemeImage* Control::getImage(const char* id, State state)
 {
+    // Controls look their images up with literal IDs each time they are updated, so the
+    // images of the current state are kept by the address of the ID.
+    if (state == _state)
+    {
+        const ResolvedStyle& style = getResolvedStyle();
+        for (unsigned int i = 0, count = (unsigned int)style.images.size(); i < count; ++i)
+        {
+            if (style.images[i].first == id)
+                return style.images[i].second;
+        }
+
+        Theme::ImageList* imageList = style.overlay->getImageList();
+        Theme::ThemeImage* image = imageList ? imageList->getImage(id) : NULL;
+        _resolvedStyle.images.push_back(std::make_pair(id, image));
+        return image;
+    }
+
     Theme::Style::Overlay* overlay = getOverlay(state);
     GP_ASSERT(overlay);
     
@@ -1363,8 +1409,37 @@ Theme::Style::Overlay* Control::getOverlay(State state) const
     }
 }
 
+const Control::ResolvedStyle& Control::getResolvedStyle() const
+{
+    if (_resolvedStyleDirty || _resolvedState != _state || _resolvedPreviousState != _previousState)
+    {
+        Theme::Style::Overlay* overlay = getOverlay(_state);
+        GP_ASSERT(overlay);
+
+        _resolvedStyle.overlay = overlay;
+        _resolvedStyle.skin = overlay->getSkin();
+        _resolvedStyle.border = overlay->getBorder();
+        _resolvedStyle.skinColor = overlay->getSkinColor();
+        _resolvedStyle.opacity = overlay->getOpacity();
+        _resolvedStyle.font = overlay->getFont();
+        _resolvedStyle.fontSize = overlay->getFontSize();
+        _resolvedStyle.textColor = overlay->getTextColor();
+        _resolvedStyle.textAlignment = overlay->getTextAlignment();
+        _resolvedStyle.textRightToLeft = overlay->getTextRightToLeft();
+        _resolvedStyle.images.clear();
+
+        _resolvedStyleDirty = false;
+        _resolvedState = _state;
+        _resolvedPreviousState = _previousState;
+    }
+    return _resolvedStyle;
+}
+
 void Control::overrideStyle()
 {
+    // Each of the setters of the themed properties overrides the style before changing it.
+    _resolvedStyleDirty = true;
+
     if (_styleOverridden)
     {
         return;
@@ -704,6 +704,25 @@ public:
      */
     bool getConsumeInputEvents();
 
+    /**
+     * Sets the events for which this control calls its "controlEvent" script callbacks.
+     *
+     * Listeners added with addListener are always notified. Restricting the script callbacks to
+     * the events a script handles keeps frequent events, such as the value changes of a slider
+     * being dragged or the ENTER and LEAVE events of the mouse, from calling into Lua.
+     * All events are delivered by default.
+     *
+     * @param eventFlags A bitwise combination of Listener::EventType values.
+     */
+    void setScriptEventFilter(int eventFlags);
+
+    /**
+     * Gets the events for which this control calls its "controlEvent" script callbacks.
+     *
+     * @return A bitwise combination of Listener::EventType values.
+     */
+    int getScriptEventFilter() const;
+
     /**
      * Set the style this control will use when rendering.
      *
@@ -909,13 +928,14 @@ protected:
     /**
      * Draws a sprite batch for the specified clipping rect.
      *
+     * The form's render target has already been cleared within the region, and drawing
+     * outside of it is discarded by the scissor test.
+     *
      * @param spriteBatch The sprite batch to use.
      * @param clip The clipping rectangle.
-     * @param needsClear Whether it needs to be cleared.
-     * @param cleared Whether it was previously cleared
-     * @param targetHeight The targets height
+     * @param region The area of the form that is being redrawn.
      */
-    virtual void draw(SpriteBatch* spriteBatch, const Rectangle& clip, bool needsClear, bool cleared, float targetHeight);
+    virtual void draw(SpriteBatch* spriteBatch, const Rectangle& clip, const Rectangle& region);
 
     /**
      * Initialize properties common to all Controls from a Properties object.
@@ -932,6 +952,15 @@ protected:
      */
     virtual bool isDirty();
 
+    /**
+     * Adds the areas of the form that must be redrawn because this control changed.
+     *
+     * A dirty control needs to be redrawn both where it was last drawn and where it is now.
+     *
+     * @param regions The list to add the areas to.
+     */
+    virtual void addDirtyRegions(std::vector<Rectangle, FrameAllocator<Rectangle> >* regions);
+
     /**
      * Get a Control::State enum from a matching string.
      *
@@ -951,6 +980,78 @@ protected:
      */
     Theme::ThemeImage* getImage(const char* id, State state);
 
+    /**
+     * The themed properties of a control in its current state, resolved from its style.
+     */
+    struct ResolvedStyle
+    {
+        /**
+         * The overlay of the style the properties are resolved from.
+         */
+        Theme::Style::Overlay* overlay;
+
+        /**
+         * The skin, or NULL if the control has none.
+         */
+        Theme::Skin* skin;
+
+        /**
+         * The border of the skin.
+         */
+        Theme::Border border;
+
+        /**
+         * The color of the skin.
+         */
+        Vector4 skinColor;
+
+        /**
+         * The opacity of the style, not multiplied by that of the parent container.
+         */
+        float opacity;
+
+        /**
+         * The font, or NULL if the control has none.
+         */
+        Font* font;
+
+        /**
+         * The font size.
+         */
+        unsigned int fontSize;
+
+        /**
+         * The text color.
+         */
+        Vector4 textColor;
+
+        /**
+         * The text alignment.
+         */
+        Font::Justify textAlignment;
+
+        /**
+         * Whether the text is drawn right to left.
+         */
+        bool textRightToLeft;
+
+        /**
+         * The images looked up with getImage, by the address of their ID.
+         */
+        std::vector<std::pair<const char*, Theme::ThemeImage*> > images;
+    };
+
+    /**
+     * Gets the themed properties of the control in its current state.
+     *
+     * They are resolved from the style when they are first needed after the state or the
+     * style of the control changes, so that a control reads them without looking them up
+     * through its overlays each time it is updated and drawn.
+     *
+     * @return The themed properties of the current state.
+     */
+    const ResolvedStyle& getResolvedStyle() const;
+
     /**
      * Notify this control's listeners of a specific event.
      *
@@ -1015,7 +1116,7 @@ protected:
     Rectangle _viewportClipBounds;
 
     /**
-     * Previous frame's absolute clip bounds, to be cleared if necessary.
+     * Absolute clip bounds the control was last drawn with, to be cleared when it is redrawn.
      */
     Rectangle _clearBounds;         
 
@@ -1054,6 +1155,11 @@ protected:
      */
     //std::map<Listener::EventType, std::list<Listener*>*>* _listeners;
     std::map<Control::Listener::EventType, std::list<Control::Listener*>*>* _listeners;
+
+    /**
+     * The events for which the "controlEvent" script callbacks are called.
+     */
+    int _scriptEventFilter;
     
     /**
      * The Control's Theme::Style.
@@ -1118,6 +1224,10 @@ private:
     bool _styleOverridden;
     Theme::Skin* _skin;
     State _previousState;
+    mutable ResolvedStyle _resolvedStyle;
+    mutable bool _resolvedStyleDirty;
+    mutable State _resolvedState;
+    mutable State _resolvedPreviousState;
 };
 
 }
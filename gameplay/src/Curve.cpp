@@ -1,5 +1,6 @@
 // Purposely not including Base.h here, or any other gameplay dependencies, so it can be reused between gameplay and gameplay-encoder.
 #include "Curve.h"
+#include "MemoryStats.h"
 #include "Quaternion.h"
 #include <cassert>
 #include <cstring>
@@ -80,6 +81,72 @@ static inline float lerpInl(float s, float from, float to)
     return from + (to - from) * s;
 }
 
+// Whether the interpolation of a segment is a polynomial of the time within it, which baked curves precompute.
+static inline bool isPolynomial(gameplay::Curve::InterpolationType type)
+{
+    switch (type)
+    {
+    case gameplay::Curve::BEZIER:
+    case gameplay::Curve::BSPLINE:
+    case gameplay::Curve::FLAT:
+    case gameplay::Curve::HERMITE:
+    case gameplay::Curve::LINEAR:
+    case gameplay::Curve::SMOOTH:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Sets the coefficients, from the constant term up, of a cubic Bezier curve.
+static inline void bezierCoefficients(float from, float out, float to, float in, float* c)
+{
+    c[0] = from;
+    c[1] = 3.0f * (out - from);
+    c[2] = 3.0f * (from - 2.0f * out + in);
+    c[3] = to - from + 3.0f * (out - in);
+}
+
+// Sets the coefficients, from the constant term up, of a uniform cubic B-spline segment.
+static inline void bsplineCoefficients(float c0, float c1, float c2, float c3, float* c)
+{
+    c[0] = (c0 + 4.0f * c1 + c2) / 6.0f;
+    c[1] = (c2 - c0) * 0.5f;
+    c[2] = (c0 - 2.0f * c1 + c2) * 0.5f;
+    c[3] = (-c0 + 3.0f * (c1 - c2) + c3) / 6.0f;
+}
+
+// Sets the coefficients, from the constant term up, of a cubic Hermite curve.
+static inline void hermiteCoefficients(float from, float out, float to, float in, float* c)
+{
+    c[0] = from;
+    c[1] = out;
+    c[2] = 3.0f * (to - from) - 2.0f * out - in;
+    c[3] = 2.0f * (from - to) + out + in;
+}
+
+// The largest packed time, and value of a packed component.
+#define PACKED_MAX 65535.0f
+
+// The largest packed quaternion component, and the range it is mapped from.
+#define PACKED_QUATERNION_MAX 32767.0f
+#define PACKED_QUATERNION_RANGE 0.70710678f
+
+static inline void unpackQuaternion(const unsigned short* src, float* dst)
+{
+    unsigned int largest = ((src[0] >> 15) << 1) | (src[1] >> 15);
+    float sum = 0.0f;
+    for (unsigned int i = 0, j = 0; i < 4; ++i)
+    {
+        if (i == largest)
+            continue;
+        float v = ((src[j++] & 0x7FFF) / PACKED_QUATERNION_MAX * 2.0f - 1.0f) * PACKED_QUATERNION_RANGE;
+        dst[i] = v;
+        sum += v * v;
+    }
+    dst[largest] = sum < 1.0f ? sqrt(1.0f - sum) : 0.0f;
+}
+
 namespace gameplay
 {
 
@@ -88,25 +155,91 @@ Curve* Curve::create(unsigned int pointCount, unsigned int componentCount)
     return new Curve(pointCount, componentCount);
 }
 
+Curve* Curve::createPacked(unsigned int pointCount, unsigned int componentCount, const float* times,
+                           const unsigned short* values, const float* ranges, int quaternionOffset)
+{
+    assert(pointCount > 0 && times && values && ranges);
+    assert(quaternionOffset < 0 || (unsigned int)quaternionOffset + 4 <= componentCount);
+
+    // Construct without points, since the packed values are evaluated directly.
+    Curve* curve = new Curve();
+    curve->_pointCount = pointCount;
+    curve->_componentCount = componentCount;
+    curve->_componentSize = sizeof(float) * componentCount;
+    curve->_packedStride = quaternionOffset < 0 ? componentCount : componentCount - 1;
+
+    curve->_packedTimes = new unsigned short[pointCount];
+    for (unsigned int i = 0; i < pointCount; ++i)
+    {
+        float time = times[i] < 0.0f ? 0.0f : (times[i] > 1.0f ? 1.0f : times[i]);
+        curve->_packedTimes[i] = (unsigned short)(time * PACKED_MAX + 0.5f);
+    }
+    curve->_packedTimes[0] = 0;
+    if (pointCount > 1)
+        curve->_packedTimes[pointCount - 1] = (unsigned short)PACKED_MAX;
+
+    curve->_packedValues = new unsigned short[pointCount * curve->_packedStride];
+    memcpy(curve->_packedValues, values, sizeof(unsigned short) * pointCount * curve->_packedStride);
+    curve->_packedRanges = new float[componentCount * 2];
+    memcpy(curve->_packedRanges, ranges, sizeof(float) * componentCount * 2);
+    MemoryStats::add(MemoryStats::ANIMATION, curve->getDataSize());
+
+    if (quaternionOffset >= 0)
+        curve->setQuaternionOffset((unsigned int)quaternionOffset);
+
+    return curve;
+}
+
+Curve::Curve()
+    : _pointCount(0), _componentCount(0), _componentSize(0), _quaternionOffset(NULL), _points(NULL), _pointValues(NULL),
+      _packedTimes(NULL), _packedValues(NULL), _packedRanges(NULL), _packedStride(0), _coefficients(NULL)
+{
+}
+
 Curve::Curve(unsigned int pointCount, unsigned int componentCount)
-    : _pointCount(pointCount), _componentCount(componentCount), _componentSize(sizeof(float)*componentCount), _quaternionOffset(NULL), _points(NULL)
+    : _pointCount(pointCount), _componentCount(componentCount), _componentSize(sizeof(float)*componentCount), _quaternionOffset(NULL), _points(NULL), _pointValues(NULL),
+      _packedTimes(NULL), _packedValues(NULL), _packedRanges(NULL), _packedStride(0), _coefficients(NULL)
 {
+    // The arrays of the points are carved out of a single allocation, rather than three per point.
     _points = new Point[_pointCount];
+    _pointValues = new float[_pointCount * _componentCount * 3];
     for (unsigned int i = 0; i < _pointCount; i++)
     {
+        float* values = _pointValues + i * _componentCount * 3;
         _points[i].time = 0.0f;
-        _points[i].value = new float[_componentCount];
-        _points[i].inValue = new float[_componentCount];
-        _points[i].outValue = new float[_componentCount];
+        _points[i].value = values;
+        _points[i].inValue = values + _componentCount;
+        _points[i].outValue = values + _componentCount * 2;
         _points[i].type = LINEAR;
     }
     _points[_pointCount - 1].time = 1.0f;
+    MemoryStats::add(MemoryStats::ANIMATION, getDataSize());
 }
 
 Curve::~Curve()
 {
+    MemoryStats::remove(MemoryStats::ANIMATION, getDataSize());
     SAFE_DELETE_ARRAY(_points);
+    SAFE_DELETE_ARRAY(_pointValues);
     SAFE_DELETE_ARRAY(_quaternionOffset);
+    SAFE_DELETE_ARRAY(_packedTimes);
+    SAFE_DELETE_ARRAY(_packedValues);
+    SAFE_DELETE_ARRAY(_packedRanges);
+    SAFE_DELETE_ARRAY(_coefficients);
+}
+
+size_t Curve::getDataSize() const
+{
+    if (_packedValues)
+        return sizeof(unsigned short) * _pointCount * (_packedStride + 1) + sizeof(float) * _componentCount * 2;
+    if (_points)
+    {
+        size_t size = (sizeof(Point) + sizeof(float) * _componentCount * 3) * _pointCount;
+        if (_coefficients)
+            size += sizeof(float) * _componentCount * 4 * (_pointCount - 1);
+        return size;
+    }
+    return 0;
 }
 
 Curve::Point::Point()
@@ -116,9 +249,7 @@ Curve::Point::Point()
 
 Curve::Point::~Point()
 {
-    SAFE_DELETE_ARRAY(value);
-    SAFE_DELETE_ARRAY(inValue);
-    SAFE_DELETE_ARRAY(outValue);
+    // The arrays are owned by the curve.
 }
 
 unsigned int Curve::getPointCount() const
@@ -133,12 +264,12 @@ unsigned int Curve::getComponentCount() const
 
 float Curve::getStartTime() const
 {
-    return _points[0].time;
+    return _packedTimes ? _packedTimes[0] / PACKED_MAX : _points[0].time;
 }
 
 float Curve::getEndTime() const
 {
-    return _points[_pointCount-1].time;
+    return _packedTimes ? _packedTimes[_pointCount-1] / PACKED_MAX : _points[_pointCount-1].time;
 }
 
 void Curve::setPoint(unsigned int index, float time, float* value, InterpolationType type)
@@ -148,7 +279,7 @@ void Curve::setPoint(unsigned int index, float time, float* value, Interpolation
 
 void Curve::setPoint(unsigned int index, float time, float* value, InterpolationType type, float* inValue, float* outValue)
 {
-    assert(index < _pointCount && time >= 0.0f && time <= 1.0f && !(_pointCount > 1 && index == 0 && time != 0.0f) && !(_pointCount != 1 && index == _pointCount - 1 && time != 1.0f));
+    assert(_points && index < _pointCount && time >= 0.0f && time <= 1.0f && !(_pointCount > 1 && index == 0 && time != 0.0f) && !(_pointCount != 1 && index == _pointCount - 1 && time != 1.0f));
 
     _points[index].time = time;
     _points[index].type = type;
@@ -161,11 +292,14 @@ void Curve::setPoint(unsigned int index, float time, float* value, Interpolation
 
     if (outValue)
         memcpy(_points[index].outValue, outValue, _componentSize);
+
+    if (_coefficients)
+        bakePoint(index);
 }
 
 void Curve::setTangent(unsigned int index, InterpolationType type, float* inValue, float* outValue)
 {
-    assert(index < _pointCount);
+    assert(_points && index < _pointCount);
 
     _points[index].type = type;
 
@@ -174,6 +308,149 @@ void Curve::setTangent(unsigned int index, InterpolationType type, float* inValu
 
     if (outValue)
         memcpy(_points[index].outValue, outValue, _componentSize);
+
+    if (_coefficients)
+        bakePoint(index);
+}
+
+void Curve::setBaked(bool baked)
+{
+    assert(!_packedValues);
+
+    if (baked == (_coefficients != NULL) || _pointCount < 2)
+        return;
+
+    MemoryStats::remove(MemoryStats::ANIMATION, getDataSize());
+    if (baked)
+    {
+        _coefficients = new float[_componentCount * 4 * (_pointCount - 1)];
+        bakeSegments(0, _pointCount - 2);
+    }
+    else
+    {
+        SAFE_DELETE_ARRAY(_coefficients);
+    }
+    MemoryStats::add(MemoryStats::ANIMATION, getDataSize());
+}
+
+bool Curve::isBaked() const
+{
+    return _coefficients != NULL;
+}
+
+void Curve::bakePoint(unsigned int index)
+{
+    // B-spline and smooth segments use the points before and after them.
+    unsigned int first = index > 2 ? index - 2 : 0;
+    unsigned int last = index + 1 < _pointCount - 1 ? index + 1 : _pointCount - 2;
+    bakeSegments(first, last);
+}
+
+void Curve::bakeSegments(unsigned int first, unsigned int last)
+{
+    assert(_coefficients && last < _pointCount - 1);
+
+    const unsigned int quaternionOffset = _quaternionOffset ? *_quaternionOffset : _componentCount;
+    float c[4];
+    for (unsigned int index = first; index <= last; ++index)
+    {
+        float* coefficients = _coefficients + index * _componentCount * 4;
+        const Point* from = &_points[index];
+        const Point* to = &_points[index + 1];
+        const Point* before = index == 0 ? from : from - 1;
+        const Point* after = index == _pointCount - 2 ? to : to + 1;
+
+        for (unsigned int i = 0; i < _componentCount; ++i)
+        {
+            const bool quaternion = i >= quaternionOffset && i < quaternionOffset + 4;
+            if (quaternion && i > quaternionOffset)
+            {
+                // Only the first component of a quaternion holds the polynomial of its interpolation time.
+                c[0] = c[1] = c[2] = c[3] = 0.0f;
+            }
+            else if (!quaternion && from->value[i] == to->value[i])
+            {
+                c[0] = from->value[i];
+                c[1] = c[2] = c[3] = 0.0f;
+            }
+            else
+            {
+                // The interpolation time of a quaternion is interpolated like a component whose
+                // values are the times of the points, as in the functions below.
+                const float fromValue = quaternion ? from->time : from->value[i];
+                const float toValue = quaternion ? to->time : to->value[i];
+                switch (from->type)
+                {
+                case BEZIER:
+                    bezierCoefficients(fromValue, from->outValue[i], toValue, to->inValue[i], c);
+                    break;
+                case BSPLINE:
+                    if (quaternion)
+                    {
+                        c[0] = c[2] = c[3] = 0.0f;
+                        c[1] = 1.0f;
+                    }
+                    else
+                    {
+                        bsplineCoefficients(before->value[i], fromValue, toValue, after->value[i], c);
+                    }
+                    break;
+                case FLAT:
+                    hermiteCoefficients(fromValue, 0.0f, toValue, 0.0f, c);
+                    break;
+                case HERMITE:
+                    hermiteCoefficients(fromValue, from->outValue[i], toValue, to->inValue[i], c);
+                    break;
+                case SMOOTH:
+                {
+                    const float beforeValue = quaternion ? before->time : before->value[i];
+                    const float afterValue = quaternion ? after->time : after->value[i];
+                    float outValue = index == 0 ? toValue - fromValue :
+                        (toValue - beforeValue) * ((from->time - before->time) / (to->time - before->time));
+                    float inValue = index == _pointCount - 2 ? toValue - fromValue :
+                        (afterValue - fromValue) * ((to->time - from->time) / (after->time - from->time));
+                    hermiteCoefficients(fromValue, outValue, toValue, inValue, c);
+                    break;
+                }
+                case LINEAR:
+                    c[0] = quaternion ? 0.0f : fromValue;
+                    c[1] = quaternion ? 1.0f : toValue - fromValue;
+                    c[2] = c[3] = 0.0f;
+                    break;
+                default:
+                    // Evaluated without the coefficients.
+                    c[0] = c[1] = c[2] = c[3] = 0.0f;
+                    break;
+                }
+            }
+
+            coefficients[i] = c[0];
+            coefficients[i + _componentCount] = c[1];
+            coefficients[i + _componentCount * 2] = c[2];
+            coefficients[i + _componentCount * 3] = c[3];
+        }
+    }
+}
+
+void Curve::evaluateBaked(float s, unsigned int index, float* dst) const
+{
+    const float* c0 = _coefficients + index * _componentCount * 4;
+    const float* c1 = c0 + _componentCount;
+    const float* c2 = c1 + _componentCount;
+    const float* c3 = c2 + _componentCount;
+
+    // The coefficients of each power are contiguous across the components, so compilers
+    // vectorize this loop for curves of several components.
+    for (unsigned int i = 0; i < _componentCount; i++)
+    {
+        dst[i] = ((c3[i] * s + c2[i]) * s + c1[i]) * s + c0[i];
+    }
+
+    if (_quaternionOffset)
+    {
+        unsigned int i = *_quaternionOffset;
+        interpolateQuaternion(dst[i], _points[index].value + i, _points[index + 1].value + i, dst + i);
+    }
 }
 
 void Curve::evaluate(float time, float* dst) const
@@ -184,9 +461,32 @@ void Curve::evaluate(float time, float* dst) const
 }
 
 void Curve::evaluate(float time, float startTime, float endTime, float loopBlendTime, float* dst) const
+{
+    evaluate(time, startTime, endTime, loopBlendTime, dst, NULL);
+}
+
+void Curve::evaluate(unsigned int count, const Curve* const* curves, float time, float startTime, float endTime,
+                     float loopBlendTime, float* const* dst, unsigned int* cursors)
+{
+    assert(count == 0 || (curves && dst));
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        assert(curves[i]);
+        curves[i]->evaluate(time, startTime, endTime, loopBlendTime, dst[i], cursors ? cursors + i : NULL);
+    }
+}
+
+void Curve::evaluate(float time, float startTime, float endTime, float loopBlendTime, float* dst, unsigned int* cursor) const
 {
     assert(dst && startTime >= 0.0f && startTime <= endTime && endTime <= 1.0f && loopBlendTime >= 0.0f);
 
+    if (_packedValues)
+    {
+        evaluatePacked(time, startTime, endTime, loopBlendTime, dst, cursor);
+        return;
+    }
+
     // If there's only one point on the curve, return its value.
     if (_pointCount == 1)
     {
@@ -256,14 +556,20 @@ void Curve::evaluate(float time, float startTime, float endTime, float loopBlend
     }
     else
     {
-        // Locate the points we are interpolating between using a binary search.
-        index = determineIndex(localTime, min, max);
+        // Locate the points we are interpolating between.
+        index = determineIndex(localTime, min, max, cursor);
         from = &_points[index];
         to = &_points[index == max ? index : index+1];
 
         // Calculate the fractional time between the two points.
         scale = (to->time - from->time);
         t = (localTime - from->time) / scale;
+
+        if (_coefficients && isPolynomial(from->type))
+        {
+            evaluateBaked(t, index, dst);
+            return;
+        }
     }
 
     // Calculate the value of the curve discretely if appropriate.
@@ -814,6 +1120,9 @@ void Curve::setQuaternionOffset(unsigned int offset)
         _quaternionOffset = new unsigned int[1];
     
     *_quaternionOffset = offset;
+
+    if (_coefficients)
+        bakeSegments(0, _pointCount - 2);
 }
 
 void Curve::interpolateBezier(float s, Point* from, Point* to, float* dst) const
@@ -1220,6 +1529,173 @@ void Curve::interpolateQuaternion(float s, float* from, float* to, float* dst) c
         Quaternion::slerp(to[0], to[1], to[2], to[3], from[0], from[1], from[2], from[3], s, dst, dst + 1, dst + 2, dst + 3);
 }
 
+void Curve::evaluatePacked(float time, float startTime, float endTime, float loopBlendTime, float* dst, unsigned int* cursor) const
+{
+    if (_pointCount == 1)
+    {
+        interpolatePacked(0.0f, 0, 0, dst);
+        return;
+    }
+
+    // Times are compared in units of the packed times.
+    unsigned int min = 0;
+    unsigned int max = _pointCount - 1;
+    float localTime = time * PACKED_MAX;
+    if (startTime > 0.0f || endTime < 1.0f)
+    {
+        min = determinePackedIndex(startTime * PACKED_MAX, 0, max, NULL);
+        max = determinePackedIndex(endTime * PACKED_MAX, min, max, NULL);
+        localTime = _packedTimes[min] + (float)(_packedTimes[max] - _packedTimes[min]) * time;
+    }
+
+    float minTime = _packedTimes[min];
+    float maxTime = _packedTimes[max];
+    if (loopBlendTime == 0.0f)
+    {
+        if (localTime < minTime)
+            localTime = minTime;
+        else if (localTime > maxTime)
+            localTime = maxTime;
+    }
+
+    if (localTime == minTime)
+    {
+        interpolatePacked(0.0f, min, min, dst);
+        return;
+    }
+    if (localTime == maxTime)
+    {
+        interpolatePacked(0.0f, max, max, dst);
+        return;
+    }
+
+    unsigned int from;
+    unsigned int to;
+    float t;
+    if (localTime > maxTime)
+    {
+        // Looping forward
+        from = max;
+        to = min;
+        t = (localTime - maxTime) / (loopBlendTime * PACKED_MAX);
+    }
+    else if (localTime < minTime)
+    {
+        // Looping in reverse
+        from = min;
+        to = max;
+        t = (minTime - localTime) / (loopBlendTime * PACKED_MAX);
+    }
+    else
+    {
+        from = determinePackedIndex(localTime, min, max, cursor);
+        to = from == max ? from : from + 1;
+
+        // Keys closer than the precision of the packed times take the value of the first.
+        float scale = (float)(_packedTimes[to] - _packedTimes[from]);
+        t = scale > 0.0f ? (localTime - _packedTimes[from]) / scale : 0.0f;
+    }
+
+    interpolatePacked(t, from, to, dst);
+}
+
+void Curve::interpolatePacked(float s, unsigned int from, unsigned int to, float* dst) const
+{
+    const unsigned short* fromValue = _packedValues + from * _packedStride;
+    const unsigned short* toValue = _packedValues + to * _packedStride;
+    unsigned int quaternionOffset = _quaternionOffset ? *_quaternionOffset : _componentCount;
+
+    for (unsigned int i = 0, j = 0; i < _componentCount; ++i, ++j)
+    {
+        if (i == quaternionOffset)
+        {
+            float fromQuaternion[4];
+            float toQuaternion[4];
+            unpackQuaternion(fromValue + j, fromQuaternion);
+            unpackQuaternion(toValue + j, toQuaternion);
+            if (from == to)
+                memcpy(dst + i, fromQuaternion, sizeof(float) * 4);
+            else
+                interpolateQuaternion(s, fromQuaternion, toQuaternion, dst + i);
+
+            // The quaternion takes 4 components and 3 packed values.
+            i += 3;
+            j += 2;
+            continue;
+        }
+
+        const float* range = _packedRanges + i * 2;
+        float f = range[0] + range[1] * (fromValue[j] / PACKED_MAX);
+        if (fromValue[j] == toValue[j])
+            dst[i] = f;
+        else
+            dst[i] = lerpInl(s, f, range[0] + range[1] * (toValue[j] / PACKED_MAX));
+    }
+}
+
+int Curve::determinePackedIndex(float time, unsigned int min, unsigned int max, unsigned int* cursor) const
+{
+    if (cursor)
+    {
+        // Check the point of the previous evaluation and the one after it.
+        unsigned int index = *cursor;
+        if (index >= min && index < max && time >= _packedTimes[index])
+        {
+            if (time < _packedTimes[index + 1])
+                return index;
+            if (index + 1 < max && time < _packedTimes[index + 2])
+            {
+                *cursor = index + 1;
+                return index + 1;
+            }
+        }
+
+        index = determinePackedIndex(time, min, max, NULL);
+        *cursor = index;
+        return index;
+    }
+
+    unsigned int mid;
+
+    // Do a binary search to determine the index.
+    do
+    {
+        mid = (min + max) >> 1;
+
+        if (time >= _packedTimes[mid] && time < _packedTimes[mid + 1])
+            return mid;
+        else if (time < _packedTimes[mid])
+            max = mid - 1;
+        else
+            min = mid + 1;
+    } while (min <= max);
+
+    return max;
+}
+
+int Curve::determineIndex(float time, unsigned int min, unsigned int max, unsigned int* cursor) const
+{
+    if (cursor == NULL)
+        return determineIndex(time, min, max);
+
+    // Check the keyframe of the previous evaluation and the one after it.
+    unsigned int index = *cursor;
+    if (index >= min && index < max && time >= _points[index].time)
+    {
+        if (time < _points[index + 1].time)
+            return index;
+        if (index + 1 < max && time < _points[index + 2].time)
+        {
+            *cursor = index + 1;
+            return index + 1;
+        }
+    }
+
+    index = determineIndex(time, min, max);
+    *cursor = index;
+    return index;
+}
+
 int Curve::determineIndex(float time, unsigned int min, unsigned int max) const
 {
     unsigned int mid;
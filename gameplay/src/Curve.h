@@ -284,6 +284,30 @@ public:
      */
     static Curve* create(unsigned int pointCount, unsigned int componentCount);
 
+    /**
+     * Creates a new linear curve that evaluates its points directly from packed 16-bit values.
+     *
+     * Each value is quantized within the range of its component, and the quaternion, if any,
+     * is stored as its three smallest components, which takes a fraction of the memory of a
+     * curve created with create(). Points of packed curves cannot be changed.
+     *
+     * @param pointCount The number of points in the curve.
+     * @param componentCount The number of float component values per key value.
+     * @param times The times of the points, from 0 at the first point to 1 at the last.
+     * @param values The packed values of the points: for each point, one value per component
+     *      as (value - min) / extent * 65535, and 3 for the quaternion. Each of the three
+     *      smallest components of the quaternion is mapped from [-1/sqrt(2), 1/sqrt(2)] to
+     *      15 bits, and bit 15 of the first and second values holds the index of the largest.
+     * @param ranges The minimum and extent of each component (2 * componentCount floats).
+     * @param quaternionOffset The index of the first component of the quaternion, or -1 if
+     *      there is no quaternion.
+     *
+     * @return The new curve.
+     * @script{ignore}
+     */
+    static Curve* createPacked(unsigned int pointCount, unsigned int componentCount, const float* times,
+                               const unsigned short* values, const float* ranges, int quaternionOffset);
+
     /**
      * Gets the number of points in the curve.
      *
@@ -343,6 +367,30 @@ public:
      * @param outValue The tangent leaving the point.
      */
     void setTangent(unsigned int index, InterpolationType type, float* inValue, float* outValue);
+
+    /**
+     * Sets whether the segments of the curve are baked into polynomials.
+     *
+     * The BEZIER, BSPLINE, FLAT, HERMITE, LINEAR and SMOOTH interpolations are cubic polynomials
+     * of the time within a segment. A baked curve computes the coefficients of those polynomials
+     * once for each segment, when it is baked and whenever setPoint or setTangent changes a point,
+     * so evaluating such a segment only takes a Horner evaluation per component, instead of the
+     * basis functions and tangents. Segments of the other interpolation types, and the loop
+     * blend between the end points, are evaluated as before. Baking takes four floats per
+     * component of each segment. Packed curves cannot be baked.
+     *
+     * @param baked True to bake the curve, false to release its coefficients.
+     * @script{ignore}
+     */
+    void setBaked(bool baked);
+
+    /**
+     * Determines whether the segments of the curve are baked into polynomials.
+     *
+     * @return True if the curve is baked.
+     * @script{ignore}
+     */
+    bool isBaked() const;
     
     /**
      * Evaluates the curve at the given position value.
@@ -384,6 +432,44 @@ public:
      */
     void evaluate(float time, float startTime, float endTime, float loopBlendTime, float* dst) const;
 
+    /**
+     * Evaluates the curve within the specified subregion, starting the search for the
+     * keyframe to interpolate from at the keyframe found by the previous evaluation.
+     *
+     * Playback time mostly moves forward within a keyframe or to the next one, so keeping
+     * a cursor for every playback of the curve makes evaluation constant time for it,
+     * instead of a binary search over all the keyframes. The cursor is updated with the
+     * keyframe found, and can start at any value.
+     *
+     * @param time The position within the subregion of the curve to evaluate the curve at.
+     * @param startTime Start time for the subregion (between 0.0 - 1.0).
+     * @param endTime End time for the subregion (between 0.0 - 1.0).
+     * @param loopBlendTime Time (in milliseconds) to blend between the end points of the curve
+     *      for looping purposes when time is outside the range 0-1. A value of zero here
+     *      disables curve looping.
+     * @param dst The evaluated value of the curve at the given time.
+     * @param cursor The keyframe cursor of the playback.
+     * @script{ignore}
+     */
+    void evaluate(float time, float startTime, float endTime, float loopBlendTime, float* dst, unsigned int* cursor) const;
+
+    /**
+     * Evaluates a number of curves at the same position within the same subregion.
+     *
+     * @param count The number of curves.
+     * @param curves The curves to evaluate.
+     * @param time The position within the subregion of the curves to evaluate them at.
+     * @param startTime Start time for the subregion (between 0.0 - 1.0).
+     * @param endTime End time for the subregion (between 0.0 - 1.0).
+     * @param loopBlendTime Time (in milliseconds) to blend between the end points of the curves
+     *      for looping purposes when time is outside the range 0-1.
+     * @param dst The destinations of the evaluated values, one for each curve.
+     * @param cursors The keyframe cursors, one for each curve, or NULL to search all the keyframes.
+     * @script{ignore}
+     */
+    static void evaluate(unsigned int count, const Curve* const* curves, float time, float startTime, float endTime,
+                         float loopBlendTime, float* const* dst, unsigned int* cursors);
+
     /**
      * Linear interpolation function.
      */
@@ -487,12 +573,49 @@ private:
      * Quaternion interpolation function.
      */
     void interpolateQuaternion(float s, float* from, float* to, float* dst) const;
+
+    /**
+     * Computes the polynomial coefficients of the segments from first to last, inclusive.
+     */
+    void bakeSegments(unsigned int first, unsigned int last);
+
+    /**
+     * Computes the polynomial coefficients of the segments that depend on the specified point.
+     */
+    void bakePoint(unsigned int index);
+
+    /**
+     * Evaluates a baked segment at the specified fractional time within it.
+     */
+    void evaluateBaked(float s, unsigned int index, float* dst) const;
+
+    /**
+     * Evaluates a packed curve.
+     */
+    void evaluatePacked(float time, float startTime, float endTime, float loopBlendTime, float* dst, unsigned int* cursor) const;
+
+    /**
+     * Linear interpolation function for the packed values of two points.
+     */
+    void interpolatePacked(float s, unsigned int from, unsigned int to, float* dst) const;
+
+    /**
+     * Determines the packed point to interpolate from based on the specified time, in units of the packed times,
+     * checking the point of the cursor and the next one first if a cursor is given.
+     */
+    int determinePackedIndex(float time, unsigned int min, unsigned int max, unsigned int* cursor) const;
     
     /**
      * Determines the current keyframe to interpolate from based on the specified time.
      */ 
     int determineIndex(float time, unsigned int min, unsigned int max) const;
 
+    /**
+     * Determines the current keyframe to interpolate from, checking the keyframe of the
+     * cursor and the next one before searching, and updates the cursor.
+     */
+    int determineIndex(float time, unsigned int min, unsigned int max, unsigned int* cursor) const;
+
     /**
      * Sets the offset for the beginning of a Quaternion piece of data within the curve's value span at the specified
      * index. The next four components of data starting at the given index will be interpolated as a Quaternion.
@@ -503,6 +626,11 @@ private:
      */
     void setQuaternionOffset(unsigned int index);
 
+    /**
+     * Returns the size of the points or packed values of the curve, as counted in MemoryStats.
+     */
+    size_t getDataSize() const;
+
     /**
      * Gets the InterpolationType value for the given string ID
      *
@@ -516,6 +644,12 @@ private:
     unsigned int _componentSize;        // The component size (in bytes).
     unsigned int* _quaternionOffset;    // Offset for the rotation component.
     Point* _points;                     // The points on the curve.
+    float* _pointValues;                // The values, in and out values of all the points, in one allocation.
+    unsigned short* _packedTimes;       // The times of the points of a packed curve, from 0 to 65535.
+    unsigned short* _packedValues;      // The packed values of the points of a packed curve.
+    float* _packedRanges;               // The minimum and extent of each component of a packed curve.
+    unsigned int _packedStride;         // The number of packed values per point.
+    float* _coefficients;               // The polynomial coefficients of each segment of a baked curve, by power and then component.
 };
 
 }
@@ -1,5 +1,7 @@
 #include "Base.h"
+#include "GLStateCache.h"
 #include "DepthStencilTarget.h"
+#include "MemoryStats.h"
 
 #ifndef GL_DEPTH24_STENCIL8_OES
 #define GL_DEPTH24_STENCIL8_OES 0x88F0
@@ -13,6 +15,12 @@ namespace gameplay
 
 static std::vector<DepthStencilTarget*> __depthStencilTargets;
 
+// Estimates the memory of the renderbuffers of a target, assuming depth takes 4 bytes per pixel and stencil 1.
+static size_t getRenderbuffersSize(unsigned int width, unsigned int height, bool depth, bool stencil)
+{
+    return (size_t)width * height * ((depth ? 4 : 0) + (stencil ? 1 : 0));
+}
+
 DepthStencilTarget::DepthStencilTarget(const char* id, Format format, unsigned int width, unsigned int height)
     : _id(id ? id : ""), _format(format), _depthBuffer(0), _stencilBuffer(0), _width(width), _height(height), _packed(false)
 {
@@ -21,10 +29,11 @@ DepthStencilTarget::DepthStencilTarget(const char* id, Format format, unsigned i
 DepthStencilTarget::~DepthStencilTarget()
 {
     // Destroy GL resources.
+    MemoryStats::remove(MemoryStats::GPU_RENDERBUFFERS, getRenderbuffersSize(_width, _height, _depthBuffer != 0, _stencilBuffer != 0));
     if (_depthBuffer)
-        GL_ASSERT( glDeleteRenderbuffers(1, &_depthBuffer) );
+        GLStateCache::deleteRenderbuffers(1, &_depthBuffer);
     if (_stencilBuffer)
-        GL_ASSERT( glDeleteRenderbuffers(1, &_stencilBuffer) );
+        GLStateCache::deleteRenderbuffers(1, &_stencilBuffer);
 
     // Remove from vector.
     std::vector<DepthStencilTarget*>::iterator it = std::find(__depthStencilTargets.begin(), __depthStencilTargets.end(), this);
@@ -41,7 +50,7 @@ DepthStencilTarget* DepthStencilTarget::create(const char* id, Format format, un
 
     // Create a render buffer for this new depth+stencil target
     GL_ASSERT( glGenRenderbuffers(1, &depthStencilTarget->_depthBuffer) );
-    GL_ASSERT( glBindRenderbuffer(GL_RENDERBUFFER, depthStencilTarget->_depthBuffer) );
+    GLStateCache::bindRenderbuffer(depthStencilTarget->_depthBuffer);
 
     // First try to add storage for the most common standard GL_DEPTH24_STENCIL8 
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
@@ -70,7 +79,7 @@ DepthStencilTarget* DepthStencilTarget::create(const char* id, Format format, un
             if (format == DepthStencilTarget::DEPTH_STENCIL)
             {
                 GL_ASSERT( glGenRenderbuffers(1, &depthStencilTarget->_stencilBuffer) );
-                GL_ASSERT( glBindRenderbuffer(GL_RENDERBUFFER, depthStencilTarget->_stencilBuffer) );
+                GLStateCache::bindRenderbuffer(depthStencilTarget->_stencilBuffer);
                 GL_ASSERT( glRenderbufferStorage(GL_RENDERBUFFER, GL_STENCIL_INDEX8, width, height) );
             }
         }
@@ -81,6 +90,8 @@ DepthStencilTarget* DepthStencilTarget::create(const char* id, Format format, un
         depthStencilTarget->_packed = true;
     }
 
+    MemoryStats::add(MemoryStats::GPU_RENDERBUFFERS, getRenderbuffersSize(width, height, true, depthStencilTarget->_stencilBuffer != 0));
+
     // Add it to the cache.
     __depthStencilTargets.push_back(depthStencilTarget);
 
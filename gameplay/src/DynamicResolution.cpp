@@ -0,0 +1,241 @@
+#include "Base.h"
+#include "DynamicResolution.h"
+#include "Game.h"
+#include "GPUProfiler.h"
+#include "RenderTargetPool.h"
+#include "SpriteBatch.h"
+
+// The number of frames whose times are averaged before the scale is adjusted.
+#define DYNAMIC_RESOLUTION_ADJUST_FRAMES 15
+
+// The step the scale is adjusted and rounded by.
+#define DYNAMIC_RESOLUTION_SCALE_STEP 0.05f
+
+// The fraction of the target time below which the scale is raised.
+#define DYNAMIC_RESOLUTION_RAISE_THRESHOLD 0.85f
+
+namespace gameplay
+{
+
+static bool __enabled = false;
+static float __targetFrameTime = 16.6f;
+static float __minScale = 0.5f;
+static float __maxScale = 1.0f;
+static float __scale = 1.0f;
+static float __frameTimeSum = 0.0f;
+static unsigned int __frameTimeCount = 0;
+static double __lastFrameTime = 0.0;
+static FrameBuffer* __frameBuffer = NULL;
+static FrameBuffer* __previousFrameBuffer = NULL;
+static SpriteBatch* __spriteBatch = NULL;
+static bool __active = false;
+
+void DynamicResolution::setEnabled(bool enabled)
+{
+    __enabled = enabled;
+    if (enabled)
+    {
+        if (GPUProfiler::isSupported())
+            GPUProfiler::setEnabled(true);
+        __frameTimeSum = 0.0f;
+        __frameTimeCount = 0;
+        __lastFrameTime = 0.0;
+    }
+    else
+    {
+        finalize();
+        __scale = 1.0f;
+    }
+}
+
+bool DynamicResolution::isEnabled()
+{
+    return __enabled;
+}
+
+void DynamicResolution::setTargetFrameTime(float time)
+{
+    GP_ASSERT(time > 0.0f);
+    __targetFrameTime = time;
+}
+
+float DynamicResolution::getTargetFrameTime()
+{
+    return __targetFrameTime;
+}
+
+void DynamicResolution::setScaleRange(float minScale, float maxScale)
+{
+    GP_ASSERT(minScale > 0.0f && minScale <= maxScale && maxScale <= 1.0f);
+    __minScale = minScale;
+    __maxScale = maxScale;
+    __scale = std::min(std::max(__scale, __minScale), __maxScale);
+}
+
+float DynamicResolution::getMinScale()
+{
+    return __minScale;
+}
+
+float DynamicResolution::getMaxScale()
+{
+    return __maxScale;
+}
+
+float DynamicResolution::getScale()
+{
+    return __enabled ? __scale : 1.0f;
+}
+
+void DynamicResolution::resolve()
+{
+    if (!__active)
+        return;
+    __active = false;
+
+    GP_ASSERT(__frameBuffer && __previousFrameBuffer);
+    __previousFrameBuffer->bind();
+    __previousFrameBuffer = NULL;
+
+    Game* game = Game::getInstance();
+    Rectangle viewport = game->getViewport();
+    float width = (float)game->getWidth();
+    float height = (float)game->getHeight();
+    game->setViewport(Rectangle(0, 0, width, height));
+
+    if (__spriteBatch == NULL)
+    {
+        __spriteBatch = SpriteBatch::create(__frameBuffer->getRenderTarget()->getTexture());
+        GP_ASSERT(__spriteBatch);
+        __spriteBatch->getSampler()->setFilterMode(Texture::LINEAR, Texture::LINEAR);
+        __spriteBatch->getSampler()->setWrapMode(Texture::CLAMP, Texture::CLAMP);
+        __spriteBatch->getStateBlock()->setBlend(false);
+    }
+
+    // The window may have been resized since the sprite batch was created.
+    Matrix projection;
+    Matrix::createOrthographicOffCenter(0, width, height, 0, 0, 1, &projection);
+    __spriteBatch->setProjectionMatrix(projection);
+    __spriteBatch->start();
+    __spriteBatch->draw(0, 0, width, height, 0, 1, 1, 0, Vector4::one());
+    __spriteBatch->finish();
+
+    game->setViewport(viewport);
+}
+
+void DynamicResolution::initialize(Properties* config)
+{
+    if (config == NULL)
+        return;
+
+    if (config->exists("dynamicResolutionTargetTime"))
+        setTargetFrameTime(config->getFloat("dynamicResolutionTargetTime"));
+    if (config->exists("dynamicResolutionMinScale"))
+        setScaleRange(config->getFloat("dynamicResolutionMinScale"), __maxScale);
+    if (config->getBool("dynamicResolution"))
+        setEnabled(true);
+}
+
+void DynamicResolution::beginFrame()
+{
+    if (!__enabled)
+        return;
+
+    updateScale();
+
+    Game* game = Game::getInstance();
+    unsigned int width = std::max(1u, (unsigned int)(game->getWidth() * __scale + 0.5f));
+    unsigned int height = std::max(1u, (unsigned int)(game->getHeight() * __scale + 0.5f));
+    if (width >= game->getWidth() && height >= game->getHeight())
+    {
+        // At the native resolution the scene is drawn directly to the window.
+        finalize();
+        return;
+    }
+
+    if (__frameBuffer == NULL || __frameBuffer->getWidth() != width || __frameBuffer->getHeight() != height)
+    {
+        finalize();
+        __frameBuffer = RenderTargetPool::acquire(width, height, Texture::RGBA, true);
+        if (__frameBuffer == NULL)
+            return;
+    }
+
+    __previousFrameBuffer = __frameBuffer->bind();
+    __active = true;
+
+    // Apply the current viewport to the frame buffer.
+    game->setViewport(game->getViewport());
+}
+
+void DynamicResolution::endFrame()
+{
+    resolve();
+}
+
+void DynamicResolution::finalize()
+{
+    SAFE_DELETE(__spriteBatch);
+    RenderTargetPool::release(__frameBuffer);
+    __frameBuffer = NULL;
+}
+
+bool DynamicResolution::scaleViewport(const Rectangle& viewport, Rectangle* scaled)
+{
+    GP_ASSERT(scaled);
+
+    // Viewports of other frame buffers, such as those of forms, are not scaled.
+    if (!__active || FrameBuffer::getCurrent() != __frameBuffer)
+        return false;
+
+    Game* game = Game::getInstance();
+    float sx = (float)__frameBuffer->getWidth() / (float)game->getWidth();
+    float sy = (float)__frameBuffer->getHeight() / (float)game->getHeight();
+    scaled->set(viewport.x * sx, viewport.y * sy, viewport.width * sx, viewport.height * sy);
+    return true;
+}
+
+void DynamicResolution::updateScale()
+{
+    float time;
+    if (GPUProfiler::isSupported())
+    {
+        // The results of the GPU profiler lag a few frames behind, and are empty at first.
+        if (!GPUProfiler::isEnabled() || GPUProfiler::getScopeCount() == 0)
+            return;
+        time = GPUProfiler::getScopeTime(0);
+    }
+    else
+    {
+        // Without timer queries the time between frames is used, which includes waiting
+        // for vertical sync, so the scale is only lowered once frames are missed.
+        double now = Game::getAbsoluteTime();
+        time = __lastFrameTime > 0.0 ? (float)(now - __lastFrameTime) : 0.0f;
+        __lastFrameTime = now;
+        if (time <= 0.0f)
+            return;
+    }
+
+    __frameTimeSum += time;
+    if (++__frameTimeCount < DYNAMIC_RESOLUTION_ADJUST_FRAMES)
+        return;
+
+    float average = __frameTimeSum / (float)__frameTimeCount;
+    __frameTimeSum = 0.0f;
+    __frameTimeCount = 0;
+
+    float scale = __scale;
+    if (average > __targetFrameTime)
+    {
+        // The GPU time is roughly proportional to the pixels drawn, the square of the scale.
+        scale *= sqrt(__targetFrameTime / average);
+        scale = floor(scale / DYNAMIC_RESOLUTION_SCALE_STEP) * DYNAMIC_RESOLUTION_SCALE_STEP;
+    }
+    else if (average < __targetFrameTime * DYNAMIC_RESOLUTION_RAISE_THRESHOLD)
+    {
+        scale = floor(scale / DYNAMIC_RESOLUTION_SCALE_STEP + 0.5f) * DYNAMIC_RESOLUTION_SCALE_STEP + DYNAMIC_RESOLUTION_SCALE_STEP;
+    }
+    __scale = std::min(std::max(scale, __minScale), __maxScale);
+}
+
+}
@@ -0,0 +1,165 @@
+#ifndef DYNAMICRESOLUTION_H_
+#define DYNAMICRESOLUTION_H_
+
+#include "Base.h"
+#include "Rectangle.h"
+
+namespace gameplay
+{
+
+class FrameBuffer;
+class Properties;
+class SpriteBatch;
+
+/**
+ * Defines the scaling of the resolution the scene is rendered at to hold a frame time.
+ *
+ * When enabled, Game binds an off-screen frame buffer smaller than the window before
+ * Game::render, and the scene is drawn into it. Viewports set with Game::setViewport
+ * remain in window pixels and are scaled to the frame buffer. The frame buffer is
+ * upscaled to the window by resolve(), which the first Form drawn in screen space calls,
+ * so forms are drawn at the native resolution. Text and sprites that must also be drawn
+ * at the native resolution are drawn after calling resolve() explicitly. If nothing calls
+ * it, the frame buffer is upscaled at the end of the frame.
+ *
+ * The scale is adjusted every few frames from the GPU time of the frame measured by the
+ * GPUProfiler, lowered when the frame is slower than the target time and raised when it
+ * is well within it. Where timer queries are not supported, the time between frames is
+ * used instead. Scales are rounded to steps of 5%, so the frame buffers of the scales
+ * used are reused from the RenderTargetPool.
+ *
+ * Dynamic resolution is enabled from the game.config file:
+ *
+ @verbatim
+    graphics
+    {
+        dynamicResolution = true
+        dynamicResolutionTargetTime = 16.6
+        dynamicResolutionMinScale = 0.5
+    }
+ @endverbatim
+ *
+ * Games that bind the default frame buffer themselves while drawing the scene, such as
+ * to compose post effects, should not enable it.
+ *
+ * @script{ignore}
+ */
+class DynamicResolution
+{
+    friend class Game;
+
+public:
+
+    /**
+     * Sets whether the scene is rendered at a dynamic resolution.
+     *
+     * Enabling it also enables the GPUProfiler, which measures the frame time.
+     *
+     * @param enabled True to scale the resolution from the next frame on.
+     */
+    static void setEnabled(bool enabled);
+
+    /**
+     * Determines whether the scene is rendered at a dynamic resolution.
+     *
+     * @return True if dynamic resolution is enabled.
+     */
+    static bool isEnabled();
+
+    /**
+     * Sets the frame time the scale is adjusted to hold.
+     *
+     * @param time The time in milliseconds. The default is 16.6.
+     */
+    static void setTargetFrameTime(float time);
+
+    /**
+     * Returns the frame time the scale is adjusted to hold.
+     *
+     * @return The time in milliseconds.
+     */
+    static float getTargetFrameTime();
+
+    /**
+     * Sets the range of the scale.
+     *
+     * @param minScale The smallest scale, greater than 0. The default is 0.5.
+     * @param maxScale The largest scale, at most 1. The default is 1.
+     */
+    static void setScaleRange(float minScale, float maxScale);
+
+    /**
+     * Returns the smallest scale.
+     *
+     * @return The smallest scale.
+     */
+    static float getMinScale();
+
+    /**
+     * Returns the largest scale.
+     *
+     * @return The largest scale.
+     */
+    static float getMaxScale();
+
+    /**
+     * Returns the scale of the resolution of the current frame.
+     *
+     * @return The scale of the width and height of the window.
+     */
+    static float getScale();
+
+    /**
+     * Upscales the scene drawn so far to the window, and binds it for the rest of the frame.
+     *
+     * Does nothing if the current frame is not rendered at a scaled resolution, or has
+     * already been upscaled.
+     */
+    static void resolve();
+
+private:
+
+    /**
+     * Hidden constructor.
+     */
+    DynamicResolution();
+
+    /**
+     * Called by Game at startup to read the graphics namespace of the game config.
+     */
+    static void initialize(Properties* config);
+
+    /**
+     * Called by Game before the frame is rendered to adjust the scale and bind the frame buffer.
+     */
+    static void beginFrame();
+
+    /**
+     * Called by Game after the frame is rendered to upscale it if that was not done yet.
+     */
+    static void endFrame();
+
+    /**
+     * Called by Game during shutdown to release the frame buffer.
+     */
+    static void finalize();
+
+    /**
+     * Scales a viewport in window pixels to the frame buffer, while it is bound.
+     *
+     * @param viewport The viewport in window pixels.
+     * @param scaled Populated with the viewport in frame buffer pixels.
+     *
+     * @return True if the viewport was scaled, false if it applies as it is.
+     */
+    static bool scaleViewport(const Rectangle& viewport, Rectangle* scaled);
+
+    /**
+     * Adjusts the scale from the frame time measured since the last call.
+     */
+    static void updateScale();
+};
+
+}
+
+#endif
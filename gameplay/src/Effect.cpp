@@ -1,17 +1,33 @@
 #include "Base.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
 #include "Effect.h"
 #include "FileSystem.h"
+#include "Properties.h"
+#include "VertexFormat.h"
 
 #define OPENGL_ES_DEFINE  "#define OPENGL_ES\n"
 
+#ifndef GL_SAMPLER_2D_ARRAY
+#define GL_SAMPLER_2D_ARRAY 0x8DC1
+#endif
+
+// Identifies (and versions) the format of program binary cache files.
+#define PROGRAM_BINARY_MAGIC    0x42504750
+#define PROGRAM_BINARY_VERSION  1
+
 namespace gameplay
 {
 
 // Cache of unique effects.
 static std::map<std::string, Effect*> __effectCache;
 static Effect* __currentEffect = NULL;
+static std::string __programBinaryCachePath;
+static bool __canonicalAttributeLocations = false;
+// The number of loaded effects that read each vertex usage.
+static unsigned int __vertexUsageEffectCounts[VertexFormat::TEXCOORD7 + 1];
 
-Effect::Effect() : _program(0)
+Effect::Effect() : _program(0), _vertexUsageMask(0), _canonicalAttributes(false)
 {
 }
 
@@ -20,18 +36,28 @@ Effect::~Effect()
     // Remove this effect from the cache.
     __effectCache.erase(_id);
 
+    for (unsigned int usage = VertexFormat::POSITION; usage <= VertexFormat::TEXCOORD7; ++usage)
+    {
+        if (_vertexUsageMask & (1u << usage))
+            --__vertexUsageEffectCounts[usage];
+    }
+
     // Free uniforms.
     for (std::map<std::string, Uniform*>::iterator itr = _uniforms.begin(); itr != _uniforms.end(); ++itr)
     {
         SAFE_DELETE(itr->second);
     }
+    for (size_t i = 0, count = _retiredUniforms.size(); i < count; ++i)
+    {
+        SAFE_DELETE(_retiredUniforms[i]);
+    }
 
     if (_program)
     {
         // If our program object is currently bound, unbind it before we're destroyed.
         if (__currentEffect == this)
         {
-            GL_ASSERT( glUseProgram(0) );
+            GLStateCache::useProgram(0);
             __currentEffect = NULL;
         }
 
@@ -102,6 +128,134 @@ Effect* Effect::createFromSource(const char* vshSource, const char* fshSource, c
     return createFromSource(NULL, vshSource, NULL, fshSource, defines);
 }
 
+void Effect::setProgramBinaryCachePath(const char* path)
+{
+    __programBinaryCachePath = path ? path : "";
+}
+
+const char* Effect::getProgramBinaryCachePath()
+{
+    return __programBinaryCachePath.c_str();
+}
+
+unsigned int Effect::prewarmProgramBinaryCache(const char* url)
+{
+    GP_ASSERT(url);
+
+    Properties* properties = Properties::create(url);
+    if (properties == NULL)
+    {
+        GP_ERROR("Failed to load effect list '%s'.", url);
+        return 0;
+    }
+
+    Properties* effects = (strlen(properties->getNamespace()) > 0) ? properties : properties->getNextNamespace();
+    unsigned int count = 0;
+    Properties* ns;
+    while (effects && (ns = effects->getNextNamespace()) != NULL)
+    {
+        const char* vshPath = ns->getString("vertexShader");
+        const char* fshPath = ns->getString("fragmentShader");
+        if (vshPath == NULL || fshPath == NULL)
+        {
+            GP_WARN("Effect '%s' in effect list '%s' is missing a vertexShader or fragmentShader.", ns->getId(), url);
+            continue;
+        }
+
+        // Creating the effect compiles it and stores its binary if it is not already cached.
+        Effect* effect = createFromFile(vshPath, fshPath, ns->getString("defines"));
+        if (effect)
+        {
+            ++count;
+            SAFE_RELEASE(effect);
+        }
+    }
+    SAFE_DELETE(properties);
+
+    return count;
+}
+
+void Effect::setCanonicalAttributeLocations(bool enabled)
+{
+    __canonicalAttributeLocations = enabled;
+}
+
+bool Effect::isCanonicalAttributeLocations()
+{
+    return __canonicalAttributeLocations;
+}
+
+unsigned int Effect::getLoadedVertexUsageMask()
+{
+    unsigned int mask = 0;
+    for (unsigned int usage = VertexFormat::POSITION; usage <= VertexFormat::TEXCOORD7; ++usage)
+    {
+        if (__vertexUsageEffectCounts[usage] > 0)
+            mask |= (1u << usage);
+    }
+    return mask;
+}
+
+/**
+ * Returns the vertex usage of a standard attribute name, or 0 if the name is not standard.
+ *
+ * Both "a_texCoord" and "a_texCoord0" name the first texture coordinates.
+ */
+static unsigned int getAttributeUsage(const char* name)
+{
+    if (strcmp(name, VERTEX_ATTRIBUTE_POSITION_NAME) == 0)
+        return VertexFormat::POSITION;
+    if (strcmp(name, VERTEX_ATTRIBUTE_NORMAL_NAME) == 0)
+        return VertexFormat::NORMAL;
+    if (strcmp(name, VERTEX_ATTRIBUTE_COLOR_NAME) == 0)
+        return VertexFormat::COLOR;
+    if (strcmp(name, VERTEX_ATTRIBUTE_TANGENT_NAME) == 0)
+        return VertexFormat::TANGENT;
+    if (strcmp(name, VERTEX_ATTRIBUTE_BINORMAL_NAME) == 0)
+        return VertexFormat::BINORMAL;
+    if (strcmp(name, VERTEX_ATTRIBUTE_BLENDWEIGHTS_NAME) == 0)
+        return VertexFormat::BLENDWEIGHTS;
+    if (strcmp(name, VERTEX_ATTRIBUTE_BLENDINDICES_NAME) == 0)
+        return VertexFormat::BLENDINDICES;
+
+    const size_t prefixLength = strlen(VERTEX_ATTRIBUTE_TEXCOORD_PREFIX_NAME);
+    if (strncmp(name, VERTEX_ATTRIBUTE_TEXCOORD_PREFIX_NAME, prefixLength) == 0)
+    {
+        const char* index = name + prefixLength;
+        if (index[0] == '\0')
+            return VertexFormat::TEXCOORD0;
+        if (index[0] >= '0' && index[0] <= '7' && index[1] == '\0')
+            return VertexFormat::TEXCOORD0 + (index[0] - '0');
+    }
+    return 0;
+}
+
+/**
+ * Binds the standard attributes named in a vertex shader to their canonical locations,
+ * which is the vertex usage minus one. Must be called before the program is linked.
+ */
+static void bindCanonicalAttributeLocations(GLuint program, const char* vshSource)
+{
+    GLint maxVertexAttribs = 0;
+    GL_ASSERT( glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &maxVertexAttribs) );
+
+    static const char* names[] =
+    {
+        VERTEX_ATTRIBUTE_POSITION_NAME, VERTEX_ATTRIBUTE_NORMAL_NAME, VERTEX_ATTRIBUTE_COLOR_NAME,
+        VERTEX_ATTRIBUTE_TANGENT_NAME, VERTEX_ATTRIBUTE_BINORMAL_NAME, VERTEX_ATTRIBUTE_BLENDWEIGHTS_NAME,
+        VERTEX_ATTRIBUTE_BLENDINDICES_NAME, VERTEX_ATTRIBUTE_TEXCOORD_PREFIX_NAME,
+        "a_texCoord0", "a_texCoord1", "a_texCoord2", "a_texCoord3", "a_texCoord4", "a_texCoord5", "a_texCoord6", "a_texCoord7"
+    };
+    for (unsigned int i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+    {
+        GLint location = (GLint)getAttributeUsage(names[i]) - 1;
+        if (location < maxVertexAttribs && strstr(vshSource, names[i]))
+        {
+            GL_ASSERT( glBindAttribLocation(program, (GLuint)location, names[i]) );
+        }
+    }
+}
+
 static void replaceDefines(const char* defines, std::string& out)
 {
     if (defines && strlen(defines) != 0)
@@ -120,7 +274,7 @@ static void replaceDefines(const char* defines, std::string& out)
 #endif
 }
 
-static void replaceIncludes(const char* filepath, const char* source, std::string& out)
+static void replaceIncludes(const char* filepath, const char* source, std::string& out, std::vector<std::string>* includes = NULL)
 {
     // Replace the #include "xxxx.xxx" with the sourced file contents of "filepath/xxxx.xxx"
     std::string str = source;
@@ -183,7 +337,9 @@ static void replaceIncludes(const char* filepath, const char* source, std::strin
             else
             {
                 // Valid file so lets attempt to see if we need to append anything to it too (recurse...)
-                replaceIncludes(directoryPath.c_str(), includedSource, out);
+                if (includes)
+                    includes->push_back(directoryPath);
+                replaceIncludes(directoryPath.c_str(), includedSource, out, includes);
                 SAFE_DELETE_ARRAY(includedSource);
             }
         }
@@ -206,11 +362,171 @@ static void writeShaderToErrorFile(const char* filePath, const char* source)
     }
 }
 
-Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, const char* fshPath, const char* fshSource, const char* defines)
+/**
+ * Returns true if linked programs can be retrieved and reloaded as binaries on this device.
+ */
+static bool isProgramBinarySupported()
 {
-    GP_ASSERT(vshSource);
-    GP_ASSERT(fshSource);
+#ifdef USE_PROGRAM_BINARY
+    static int supported = -1;
+    if (supported == -1)
+    {
+        supported = 0;
+#ifdef OPENGL_ES
+        bool extension = (glGetProgramBinary != NULL && glProgramBinary != NULL);
+#else
+        bool extension = (GLEW_ARB_get_program_binary != 0);
+#endif
+        if (extension)
+        {
+            // Some drivers expose the extension but do not support any binary formats.
+            GLint formats = 0;
+            GL_ASSERT( glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats) );
+            supported = formats > 0 ? 1 : 0;
+        }
+    }
+    return supported == 1;
+#else
+    return false;
+#endif
+}
+
+static unsigned long long hashString(const char* str, unsigned long long hash = 14695981039346656037ULL)
+{
+    // FNV-1a, including the terminating null so that concatenated strings hash differently.
+    if (str)
+    {
+        do
+        {
+            hash ^= (unsigned char)*str;
+            hash *= 1099511628211ULL;
+        } while (*str++);
+    }
+    return hash;
+}
+
+/**
+ * Computes the key that identifies the exact program built from the given sources by the current driver.
+ */
+static unsigned long long getProgramSourceKey(const std::string& definesStr, const std::string& vshSource, const std::string& fshSource)
+{
+    unsigned long long key = hashString(definesStr.c_str());
+    key = hashString(vshSource.c_str(), key);
+    key = hashString(fshSource.c_str(), key);
+
+    // A driver update may change the binary format or invalidate existing binaries.
+    key = hashString((const char*)glGetString(GL_VENDOR), key);
+    key = hashString((const char*)glGetString(GL_RENDERER), key);
+    key = hashString((const char*)glGetString(GL_VERSION), key);
+    return key;
+}
+
+/**
+ * Returns the path of the cache file for a program.
+ *
+ * Programs loaded from files are stored under a name derived from their shader paths
+ * and defines, so the cached binary is replaced whenever the shader sources change.
+ */
+static void getProgramBinaryCacheFile(const char* vshPath, const char* fshPath, const char* defines, unsigned long long sourceKey, std::string& out)
+{
+    unsigned long long nameKey = sourceKey;
+    if (vshPath && fshPath)
+    {
+        nameKey = hashString(vshPath);
+        nameKey = hashString(fshPath, nameKey);
+        nameKey = hashString(defines ? defines : "", nameKey);
+    }
+
+    char name[32];
+    sprintf(name, "%08x%08x.bin", (unsigned int)(nameKey >> 32), (unsigned int)(nameKey & 0xFFFFFFFF));
+
+    out = __programBinaryCachePath;
+    if (out[out.length() - 1] != '/')
+        out += '/';
+    out += name;
+}
+
+/**
+ * Creates a program from a cached binary, or returns 0 if the cache file is missing or out of date.
+ */
+static GLuint loadProgramBinary(const char* path, unsigned long long sourceKey)
+{
+#ifdef USE_PROGRAM_BINARY
+    FILE* fp = FileSystem::openFile(path, "rb");
+    if (fp == NULL)
+        return 0;
+
+    unsigned int header[2];
+    unsigned long long key;
+    GLenum format;
+    unsigned int length;
+    if (fread(header, sizeof(unsigned int), 2, fp) != 2 || header[0] != PROGRAM_BINARY_MAGIC || header[1] != PROGRAM_BINARY_VERSION ||
+        fread(&key, sizeof(key), 1, fp) != 1 || key != sourceKey ||
+        fread(&format, sizeof(format), 1, fp) != 1 || fread(&length, sizeof(length), 1, fp) != 1 || length == 0)
+    {
+        fclose(fp);
+        return 0;
+    }
+
+    std::vector<unsigned char> binary(length);
+    bool read = fread(&binary[0], 1, length, fp) == length;
+    fclose(fp);
+    if (!read)
+        return 0;
+
+    GLuint program;
+    GLint success;
+    GL_ASSERT( program = glCreateProgram() );
+    GL_ASSERT( glProgramBinary(program, format, &binary[0], (GLsizei)length) );
+    GL_ASSERT( glGetProgramiv(program, GL_LINK_STATUS, &success) );
+    if (success != GL_TRUE)
+    {
+        // The driver rejected the binary, so it is rebuilt from source and replaced.
+        GL_ASSERT( glDeleteProgram(program) );
+        return 0;
+    }
+    return program;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Writes the binary of a linked program to the cache.
+ */
+static void saveProgramBinary(GLuint program, const char* path, unsigned long long sourceKey)
+{
+#ifdef USE_PROGRAM_BINARY
+    GLint length = 0;
+    GL_ASSERT( glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length) );
+    if (length <= 0)
+        return;
+
+    std::vector<unsigned char> binary(length);
+    GLenum format = 0;
+    GL_ASSERT( glGetProgramBinary(program, length, NULL, &format, &binary[0]) );
+
+    std::auto_ptr<Stream> stream(FileSystem::open(path, FileSystem::WRITE));
+    if (stream.get() == NULL || !stream->canWrite())
+    {
+        GP_WARN("Failed to write program binary cache file '%s'.", path);
+        return;
+    }
 
+    unsigned int header[2] = { PROGRAM_BINARY_MAGIC, PROGRAM_BINARY_VERSION };
+    unsigned int size = (unsigned int)length;
+    stream->write(header, sizeof(unsigned int), 2);
+    stream->write(&sourceKey, sizeof(sourceKey), 1);
+    stream->write(&format, sizeof(format), 1);
+    stream->write(&size, sizeof(size), 1);
+    stream->write(&binary[0], 1, size);
+#endif
+}
+
+static GLuint compileProgram(const char* vshPath, const char* vshSource, const char* fshPath, const char* fshSource, const char* definesStr,
+                             const char** feedbackVaryings, unsigned int feedbackVaryingCount, bool canonicalAttributes,
+                             const std::map<std::string, VertexAttribute>* attributeLocations = NULL)
+{
     const unsigned int SHADER_SOURCE_LENGTH = 3;
     const GLchar* shaderSource[SHADER_SOURCE_LENGTH];
     char* infoLog = NULL;
@@ -220,23 +536,9 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
     GLint length;
     GLint success;
 
-    // Replace all comma separated definitions with #define prefix and \n suffix
-    std::string definesStr = "";
-    replaceDefines(defines, definesStr);
-    
-    shaderSource[0] = definesStr.c_str();
+    shaderSource[0] = definesStr;
     shaderSource[1] = "\n";
-    std::string vshSourceStr = "";
-    if (vshPath)
-    {
-        // Replace the #include "xxxxx.xxx" with the sources that come from file paths
-        replaceIncludes(vshPath, vshSource, vshSourceStr);
-        if (vshSource && strlen(vshSource) != 0)
-            vshSourceStr += "\n";
-            
-        //writeShaderToErrorFile(vshPath, vshSourceStr.c_str());   // Debugging
-    }
-    shaderSource[2] = vshPath ? vshSourceStr.c_str() :  vshSource;
+    shaderSource[2] = vshSource;
     GL_ASSERT( vertexShader = glCreateShader(GL_VERTEX_SHADER) );
     GL_ASSERT( glShaderSource(vertexShader, SHADER_SOURCE_LENGTH, shaderSource, NULL) );
     GL_ASSERT( glCompileShader(vertexShader) );
@@ -265,21 +567,11 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
         // Clean up.
         GL_ASSERT( glDeleteShader(vertexShader) );
 
-        return NULL;
+        return 0;
     }
 
     // Compile the fragment shader.
-    std::string fshSourceStr;
-    if (fshPath)
-    {
-        // Replace the #include "xxxxx.xxx" with the sources that come from file paths
-        replaceIncludes(fshPath, fshSource, fshSourceStr);
-        if (fshSource && strlen(fshSource) != 0)
-            fshSourceStr += "\n";
-
-        //writeShaderToErrorFile(fshPath, fshSourceStr.c_str()); // Debugging
-    }
-    shaderSource[2] = fshPath ? fshSourceStr.c_str() : fshSource;
+    shaderSource[2] = fshSource;
     GL_ASSERT( fragmentShader = glCreateShader(GL_FRAGMENT_SHADER) );
     GL_ASSERT( glShaderSource(fragmentShader, SHADER_SOURCE_LENGTH, shaderSource, NULL) );
     GL_ASSERT( glCompileShader(fragmentShader) );
@@ -309,13 +601,37 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
         GL_ASSERT( glDeleteShader(vertexShader) );
         GL_ASSERT( glDeleteShader(fragmentShader) );
 
-        return NULL;
+        return 0;
     }
 
     // Link program.
     GL_ASSERT( program = glCreateProgram() );
+#if defined(USE_PROGRAM_BINARY) && !defined(OPENGL_ES)
+    if (isProgramBinarySupported())
+    {
+        GL_ASSERT( glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE) );
+    }
+#endif
     GL_ASSERT( glAttachShader(program, vertexShader) );
     GL_ASSERT( glAttachShader(program, fragmentShader) );
+    if (canonicalAttributes)
+    {
+        bindCanonicalAttributeLocations(program, vshSource);
+    }
+    if (attributeLocations)
+    {
+        for (std::map<std::string, VertexAttribute>::const_iterator itr = attributeLocations->begin(); itr != attributeLocations->end(); ++itr)
+        {
+            GL_ASSERT( glBindAttribLocation(program, (GLuint)itr->second, itr->first.c_str()) );
+        }
+    }
+#ifdef USE_TRANSFORM_FEEDBACK
+    if (feedbackVaryingCount > 0)
+    {
+        // The captured varyings must be specified before the program is linked.
+        GL_ASSERT( glTransformFeedbackVaryings(program, (GLsizei)feedbackVaryingCount, feedbackVaryings, GL_INTERLEAVED_ATTRIBS) );
+    }
+#endif
     GL_ASSERT( glLinkProgram(program) );
     GL_ASSERT( glGetProgramiv(program, GL_LINK_STATUS, &success) );
 
@@ -343,12 +659,212 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
         // Clean up.
         GL_ASSERT( glDeleteProgram(program) );
 
-        return NULL;
+        return 0;
     }
 
+    return program;
+}
+
+/**
+ * Expands the defines and includes of the shaders of an effect and links them into a program,
+ * or loads the program from the program binary cache if it is there.
+ *
+ * When attributeLocations is not NULL, the attributes with those names are bound to their
+ * locations before the program is linked. The files included by the shaders are appended to
+ * includes if it is not NULL.
+ *
+ * @return The program, or 0 if the shaders failed to compile or link.
+ */
+static GLuint createProgram(const char* vshPath, const char* vshSource, const char* fshPath, const char* fshSource, const char* defines,
+                            const char** feedbackVaryings, unsigned int feedbackVaryingCount,
+                            const std::map<std::string, VertexAttribute>* attributeLocations, std::vector<std::string>* includes)
+{
+    // Replace all comma separated definitions with #define prefix and \n suffix
+    std::string definesStr = "";
+    replaceDefines(defines, definesStr);
+
+    std::string vshSourceStr = "";
+    if (vshPath)
+    {
+        // Replace the #include "xxxxx.xxx" with the sources that come from file paths
+        replaceIncludes(vshPath, vshSource, vshSourceStr, includes);
+        if (vshSource && strlen(vshSource) != 0)
+            vshSourceStr += "\n";
+            
+        //writeShaderToErrorFile(vshPath, vshSourceStr.c_str());   // Debugging
+    }
+    else
+    {
+        vshSourceStr = vshSource;
+    }
+
+    std::string fshSourceStr;
+    if (fshPath)
+    {
+        // Replace the #include "xxxxx.xxx" with the sources that come from file paths
+        replaceIncludes(fshPath, fshSource, fshSourceStr, includes);
+        if (fshSource && strlen(fshSource) != 0)
+            fshSourceStr += "\n";
+
+        //writeShaderToErrorFile(fshPath, fshSourceStr.c_str()); // Debugging
+    }
+    else
+    {
+        fshSourceStr = fshSource;
+    }
+
+    // Try to load a previously linked binary of this exact program before compiling it.
+    GLuint program = 0;
+    std::string cacheFile;
+    unsigned long long sourceKey = 0;
+    if (isProgramBinarySupported() && !__programBinaryCachePath.empty() && feedbackVaryingCount == 0)
+    {
+        sourceKey = getProgramSourceKey(definesStr, vshSourceStr, fshSourceStr);
+        if (__canonicalAttributeLocations)
+        {
+            // Programs linked with fixed attribute locations are cached separately.
+            sourceKey = hashString("canonical", sourceKey);
+        }
+        getProgramBinaryCacheFile(vshPath, fshPath, defines, sourceKey, cacheFile);
+
+        // A cached binary may have been linked with other attribute locations than those requested.
+        if (attributeLocations == NULL)
+            program = loadProgramBinary(cacheFile.c_str(), sourceKey);
+    }
+
+    if (program == 0)
+    {
+        program = compileProgram(vshPath, vshSourceStr.c_str(), fshPath, fshSourceStr.c_str(), definesStr.c_str(), feedbackVaryings, feedbackVaryingCount,
+                                 __canonicalAttributeLocations, attributeLocations);
+        if (program == 0 && __canonicalAttributeLocations)
+        {
+            // Some drivers reserve attribute locations; let the driver assign them instead.
+            GP_WARN("Relinking program (%s,%s) without canonical attribute locations.", vshPath == NULL ? "NULL" : vshPath, fshPath == NULL ? "NULL" : fshPath);
+            program = compileProgram(vshPath, vshSourceStr.c_str(), fshPath, fshSourceStr.c_str(), definesStr.c_str(), feedbackVaryings, feedbackVaryingCount, false,
+                                     attributeLocations);
+        }
+        if (program == 0)
+            return 0;
+
+        if (!cacheFile.empty())
+        {
+            saveProgramBinary(program, cacheFile.c_str(), sourceKey);
+        }
+    }
+
+    return program;
+}
+
+Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, const char* fshPath, const char* fshSource, const char* defines,
+                                 const char** feedbackVaryings, unsigned int feedbackVaryingCount)
+{
+    GP_PROFILE("Effect::compile");
+    GP_ASSERT(vshSource);
+    GP_ASSERT(fshSource);
+
+    std::vector<std::string> includes;
+    GLuint program = createProgram(vshPath, vshSource, fshPath, fshSource, defines, feedbackVaryings, feedbackVaryingCount, NULL, &includes);
+    if (program == 0)
+        return NULL;
+
     // Create and return the new Effect.
     Effect* effect = new Effect();
-    effect->_program = program;
+    effect->setProgram(program);
+    if (vshPath && fshPath)
+    {
+        // The files the effect is reloaded from.
+        effect->_sourceFiles.push_back(vshPath);
+        effect->_sourceFiles.push_back(fshPath);
+        effect->_sourceFiles.insert(effect->_sourceFiles.end(), includes.begin(), includes.end());
+        effect->_defines = defines ? defines : "";
+    }
+    return effect;
+}
+
+bool Effect::reload()
+{
+    if (_sourceFiles.size() < 2)
+        return false;
+
+    GP_PROFILE("Effect::compile");
+    std::string vshPath = _sourceFiles[0];
+    std::string fshPath = _sourceFiles[1];
+    char* vshSource = FileSystem::readAll(vshPath.c_str());
+    char* fshSource = vshSource ? FileSystem::readAll(fshPath.c_str()) : NULL;
+    if (fshSource == NULL)
+    {
+        GP_WARN("Failed to read the shaders of effect '%s'.", _id.c_str());
+        SAFE_DELETE_ARRAY(vshSource);
+        return false;
+    }
+
+    // The attributes keep their locations, so that the vertex attribute bindings created for
+    // the effect remain valid.
+    std::vector<std::string> includes;
+    GLuint program = createProgram(vshPath.c_str(), vshSource, fshPath.c_str(), fshSource, _defines.empty() ? NULL : _defines.c_str(),
+                                   NULL, 0, &_vertexAttributes, &includes);
+    SAFE_DELETE_ARRAY(vshSource);
+    SAFE_DELETE_ARRAY(fshSource);
+    if (program == 0)
+    {
+        GP_WARN("Failed to reload effect '%s'; its previous program is kept.", _id.c_str());
+        return false;
+    }
+
+    setProgram(program);
+    _sourceFiles.resize(2);
+    _sourceFiles.insert(_sourceFiles.end(), includes.begin(), includes.end());
+    return true;
+}
+
+unsigned int Effect::reloadFile(const char* path)
+{
+    GP_ASSERT(path);
+
+    unsigned int count = 0;
+    for (std::map<std::string, Effect*>::const_iterator itr = __effectCache.begin(); itr != __effectCache.end(); ++itr)
+    {
+        Effect* effect = itr->second;
+        GP_ASSERT(effect);
+        if (std::find(effect->_sourceFiles.begin(), effect->_sourceFiles.end(), path) != effect->_sourceFiles.end() && effect->reload())
+            ++count;
+    }
+    return count;
+}
+
+void Effect::getSourceFiles(std::set<std::string>& files)
+{
+    for (std::map<std::string, Effect*>::const_iterator itr = __effectCache.begin(); itr != __effectCache.end(); ++itr)
+    {
+        GP_ASSERT(itr->second);
+        files.insert(itr->second->_sourceFiles.begin(), itr->second->_sourceFiles.end());
+    }
+}
+
+void Effect::setProgram(GLuint program)
+{
+    GP_ASSERT(program);
+
+    if (_program)
+    {
+        // The program that is replaced may be bound.
+        if (__currentEffect == this)
+        {
+            GLStateCache::useProgram(0);
+            __currentEffect = NULL;
+        }
+        GL_ASSERT( glDeleteProgram(_program) );
+    }
+    _program = program;
+
+    for (unsigned int usage = VertexFormat::POSITION; usage <= VertexFormat::TEXCOORD7; ++usage)
+    {
+        if (_vertexUsageMask & (1u << usage))
+            --__vertexUsageEffectCounts[usage];
+    }
+    _vertexUsageMask = 0;
+    _vertexAttributes.clear();
+    GLint length;
 
     // Query and store vertex attribute meta-data from the program.
     // NOTE: Rather than using glBindAttribLocation to explicitly specify our own
@@ -356,7 +872,9 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
     // automatically bound by the GPU. While it can sometimes be convenient to use
     // glBindAttribLocation, some vendors actually reserve certain attribute indices
     // and therefore using this function can create compatibility issues between
-    // different hardware vendors.
+    // different hardware vendors. Only the standard attributes are bound to fixed
+    // locations, and only when setCanonicalAttributeLocations is enabled.
+    _canonicalAttributes = __canonicalAttributeLocations;
     GLint activeAttributes;
     GL_ASSERT( glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &activeAttributes) );
     if (activeAttributes > 0)
@@ -378,13 +896,21 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
                 GL_ASSERT( attribLocation = glGetAttribLocation(program, attribName) );
 
                 // Assign the vertex attribute mapping for the effect.
-                effect->_vertexAttributes[attribName] = attribLocation;
+                _vertexAttributes[attribName] = attribLocation;
+
+                unsigned int usage = getAttributeUsage(attribName);
+                if (usage != 0)
+                    _vertexUsageMask |= (1u << usage);
+                if (usage == 0 || attribLocation != (GLint)usage - 1)
+                    _canonicalAttributes = false;
             }
             SAFE_DELETE_ARRAY(attribName);
         }
     }
 
     // Query and store uniforms from the program.
+    std::map<std::string, Uniform*> uniforms;
+    uniforms.swap(_uniforms);
     GLint activeUniforms;
     GL_ASSERT( glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &activeUniforms) );
     if (activeUniforms > 0)
@@ -418,12 +944,25 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
                 // Query the pre-assigned uniform location.
                 GL_ASSERT( uniformLocation = glGetUniformLocation(program, uniformName) );
 
-                Uniform* uniform = new Uniform();
-                uniform->_effect = effect;
-                uniform->_name = uniformName;
+                // The uniforms of a reloaded effect are kept, since material parameters hold them.
+                Uniform* uniform;
+                std::map<std::string, Uniform*>::iterator itr = uniforms.find(uniformName);
+                if (itr != uniforms.end())
+                {
+                    uniform = itr->second;
+                    uniforms.erase(itr);
+                }
+                else
+                {
+                    uniform = new Uniform();
+                    uniform->_effect = this;
+                    uniform->_name = uniformName;
+                }
                 uniform->_location = uniformLocation;
                 uniform->_type = uniformType;
-                if (uniformType == GL_SAMPLER_2D)
+                uniform->_layer = NULL;
+                uniform->_value.clear();
+                if (uniformType == GL_SAMPLER_2D || uniformType == GL_SAMPLER_2D_ARRAY)
                 {
                     uniform->_index = samplerIndex;
                     samplerIndex += uniformSize;
@@ -433,13 +972,39 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
                     uniform->_index = 0;
                 }
 
-                effect->_uniforms[uniformName] = uniform;
+                _uniforms[uniformName] = uniform;
             }
             SAFE_DELETE_ARRAY(uniformName);
         }
+
+        // Samplers of texture arrays set the layer they sample on the uniform named after them.
+        for (std::map<std::string, Uniform*>::iterator itr = _uniforms.begin(); itr != _uniforms.end(); ++itr)
+        {
+            if (itr->second->_type == GL_SAMPLER_2D_ARRAY)
+            {
+                std::map<std::string, Uniform*>::iterator layer = _uniforms.find(itr->first + "Layer");
+                if (layer != _uniforms.end())
+                {
+                    itr->second->_layer = layer->second;
+                }
+            }
+        }
     }
 
-    return effect;
+    // The uniforms that are no longer in the program are detached from the effect, so that
+    // the material parameters that hold them look them up again, and deleted with the effect.
+    for (std::map<std::string, Uniform*>::iterator itr = uniforms.begin(); itr != uniforms.end(); ++itr)
+    {
+        itr->second->_effect = NULL;
+        itr->second->_layer = NULL;
+        _retiredUniforms.push_back(itr->second);
+    }
+
+    for (unsigned int usage = VertexFormat::POSITION; usage <= VertexFormat::TEXCOORD7; ++usage)
+    {
+        if (_vertexUsageMask & (1u << usage))
+            ++__vertexUsageEffectCounts[usage];
+    }
 }
 
 const char* Effect::getId() const
@@ -453,6 +1018,16 @@ VertexAttribute Effect::getVertexAttribute(const char* name) const
     return (itr == _vertexAttributes.end() ? -1 : itr->second);
 }
 
+unsigned int Effect::getVertexUsageMask() const
+{
+    return _vertexUsageMask;
+}
+
+bool Effect::hasCanonicalAttributeLocations() const
+{
+    return _canonicalAttributes;
+}
+
 Uniform* Effect::getUniform(const char* name) const
 {
     std::map<std::string, Uniform*>::const_iterator itr = _uniforms.find(name);
@@ -480,106 +1055,183 @@ unsigned int Effect::getUniformCount() const
 void Effect::setValue(Uniform* uniform, float value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform1f(uniform->_location, value) );
+
+    // Uniform values are stored per program, so skip uploading values the program already has.
+    if (uniform->setCachedValue(&value, sizeof(float)))
+    {
+        GL_ASSERT( glUniform1f(uniform->_location, value) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const float* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform1fv(uniform->_location, count, values) );
+    if (uniform->setCachedValue(values, sizeof(float) * count))
+    {
+        GL_ASSERT( glUniform1fv(uniform->_location, count, values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, int value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform1i(uniform->_location, value) );
+    if (uniform->setCachedValue(&value, sizeof(int)))
+    {
+        GL_ASSERT( glUniform1i(uniform->_location, value) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const int* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform1iv(uniform->_location, count, values) );
+    if (uniform->setCachedValue(values, sizeof(int) * count))
+    {
+        GL_ASSERT( glUniform1iv(uniform->_location, count, values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Matrix& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniformMatrix4fv(uniform->_location, 1, GL_FALSE, value.m) );
+    if (uniform->setCachedValue(value.m, sizeof(float) * 16))
+    {
+        GL_ASSERT( glUniformMatrix4fv(uniform->_location, 1, GL_FALSE, value.m) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Matrix* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniformMatrix4fv(uniform->_location, count, GL_FALSE, (GLfloat*)values) );
+    if (uniform->setCachedValue(values, sizeof(Matrix) * count))
+    {
+        GL_ASSERT( glUniformMatrix4fv(uniform->_location, count, GL_FALSE, (GLfloat*)values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector2& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform2f(uniform->_location, value.x, value.y) );
+    if (uniform->setCachedValue(&value, sizeof(Vector2)))
+    {
+        GL_ASSERT( glUniform2f(uniform->_location, value.x, value.y) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector2* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform2fv(uniform->_location, count, (GLfloat*)values) );
+    if (uniform->setCachedValue(values, sizeof(Vector2) * count))
+    {
+        GL_ASSERT( glUniform2fv(uniform->_location, count, (GLfloat*)values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector3& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform3f(uniform->_location, value.x, value.y, value.z) );
+    if (uniform->setCachedValue(&value, sizeof(Vector3)))
+    {
+        GL_ASSERT( glUniform3f(uniform->_location, value.x, value.y, value.z) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector3* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform3fv(uniform->_location, count, (GLfloat*)values) );
+    if (uniform->setCachedValue(values, sizeof(Vector3) * count))
+    {
+        GL_ASSERT( glUniform3fv(uniform->_location, count, (GLfloat*)values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector4& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform4f(uniform->_location, value.x, value.y, value.z, value.w) );
+    if (uniform->setCachedValue(&value, sizeof(Vector4)))
+    {
+        GL_ASSERT( glUniform4f(uniform->_location, value.x, value.y, value.z, value.w) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector4* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform4fv(uniform->_location, count, (GLfloat*)values) );
+    if (uniform->setCachedValue(values, sizeof(Vector4) * count))
+    {
+        GL_ASSERT( glUniform4fv(uniform->_location, count, (GLfloat*)values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Texture::Sampler* sampler)
 {
     GP_ASSERT(uniform);
-    GP_ASSERT(uniform->_type == GL_SAMPLER_2D);
+    GP_ASSERT(uniform->_type == GL_SAMPLER_2D || uniform->_type == GL_SAMPLER_2D_ARRAY);
     GP_ASSERT(sampler);
 
-    GL_ASSERT( glActiveTexture(GL_TEXTURE0 + uniform->_index) );
+    if (uniform->_layer)
+    {
+        setValue(uniform->_layer, (float)sampler->getLayer());
+    }
+
+#ifdef USE_BINDLESS_TEXTURE
+    // Bindless samplers are passed as their handle, and use no texture unit.
+    if (sampler->isBindless())
+    {
+        GLuint64 handle = sampler->getBindlessHandle();
+        if (uniform->setCachedValue(&handle, sizeof(GLuint64)))
+        {
+            GL_ASSERT( glUniformHandleui64ARB(uniform->_location, handle) );
+        }
+        return;
+    }
+#endif
+
+    GLStateCache::activeTexture(GL_TEXTURE0 + uniform->_index);
 
     // Bind the sampler - this binds the texture and applies sampler state
     const_cast<Texture::Sampler*>(sampler)->bind();
 
-    GL_ASSERT( glUniform1i(uniform->_location, uniform->_index) );
+    if (uniform->setCachedValue(&uniform->_index, sizeof(unsigned int)))
+    {
+        GL_ASSERT( glUniform1i(uniform->_location, uniform->_index) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Texture::Sampler** values, unsigned int count)
 {
     GP_ASSERT(uniform);
-    GP_ASSERT(uniform->_type == GL_SAMPLER_2D);
+    GP_ASSERT(uniform->_type == GL_SAMPLER_2D || uniform->_type == GL_SAMPLER_2D_ARRAY);
     GP_ASSERT(values);
 
+#ifdef USE_BINDLESS_TEXTURE
+    // The samplers of an array are either all bindless or all bound to texture units.
+    if (count > 0 && values[0]->isBindless())
+    {
+        GLuint64 handles[32];
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            GP_ASSERT(values[i]->isBindless());
+            handles[i] = values[i]->getBindlessHandle();
+        }
+        if (uniform->setCachedValue(handles, sizeof(GLuint64) * count))
+        {
+            GL_ASSERT( glUniformHandleui64vARB(uniform->_location, count, handles) );
+        }
+        return;
+    }
+#endif
+
     // Set samplers as active and load texture unit array
     GLint units[32];
     for (unsigned int i = 0; i < count; ++i)
     {
-        GL_ASSERT( glActiveTexture(GL_TEXTURE0 + uniform->_index + i) );
+        GLStateCache::activeTexture(GL_TEXTURE0 + uniform->_index + i);
 
         // Bind the sampler - this binds the texture and applies sampler state
         const_cast<Texture::Sampler*>(values[i])->bind();
@@ -587,13 +1239,17 @@ void Effect::setValue(Uniform* uniform, const Texture::Sampler** values, unsigne
         units[i] = uniform->_index + i;
     }
 
-    // Pass texture unit array to GL
-    GL_ASSERT( glUniform1iv(uniform->_location, count, units) );
+    // Pass texture unit array to GL (the textures above are always bound, since they
+    // belong to the current texture units rather than to the program).
+    if (uniform->setCachedValue(units, sizeof(GLint) * count))
+    {
+        GL_ASSERT( glUniform1iv(uniform->_location, count, units) );
+    }
 }
 
 void Effect::bind()
 {
-   GL_ASSERT( glUseProgram(_program) );
+   GLStateCache::useProgram(_program);
 
     __currentEffect = this;
 }
@@ -604,7 +1260,7 @@ Effect* Effect::getCurrentEffect()
 }
 
 Uniform::Uniform() :
-    _location(-1), _type(0), _index(0)
+    _location(-1), _type(0), _index(0), _layer(NULL)
 {
 }
 
@@ -618,6 +1274,16 @@ Effect* Uniform::getEffect() const
     return _effect;
 }
 
+bool Uniform::setCachedValue(const void* value, size_t size)
+{
+    if (_value.size() == size && memcmp(&_value[0], value, size) == 0)
+        return false;
+
+    _value.resize(size);
+    memcpy(&_value[0], value, size);
+    return true;
+}
+
 const char* Uniform::getName() const
 {
     return _name.c_str();
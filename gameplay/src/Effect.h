@@ -25,6 +25,8 @@ class Uniform;
  */
 class Effect: public Ref
 {
+    friend class MeshSkin;
+
 public:
 
     /**
@@ -49,6 +51,131 @@ public:
      */
     static Effect* createFromSource(const char* vshSource, const char* fshSource, const char* defines = NULL);
 
+    /**
+     * Sets the directory used to cache linked programs as driver-specific binaries.
+     *
+     * When a cache directory is set and the device supports program binaries
+     * (GL_ARB_get_program_binary or GL_OES_get_program_binary), every effect that is
+     * created is first looked up in the cache, and its binary is only compiled and linked
+     * from source if it is missing. Cached binaries are keyed by the expanded shader
+     * sources, the defines and the GL vendor, renderer and version strings, so they are
+     * rebuilt automatically whenever the shaders or the driver change.
+     *
+     * The cache is disabled by default. The directory must be writable and is created
+     * automatically on Android; on other platforms it must already exist.
+     *
+     * @param path The cache directory, or NULL to disable the cache.
+     */
+    static void setProgramBinaryCachePath(const char* path);
+
+    /**
+     * Returns the directory used to cache linked programs.
+     *
+     * @return The cache directory, or an empty string if the cache is disabled.
+     */
+    static const char* getProgramBinaryCachePath();
+
+    /**
+     * Creates each effect listed in the specified file so that its program binary is cached.
+     *
+     * This is typically called while a loading screen is displayed, so that the effects
+     * used later can be created from the cache without compiling any shaders. The file
+     * contains a namespace per effect, each with the same vertexShader, fragmentShader
+     * and (optional) defines properties used by passes in material files:
+     *
+     * <pre>
+     * effects
+     * {
+     *     effect
+     *     {
+     *         vertexShader = res/shaders/textured.vert
+     *         fragmentShader = res/shaders/textured.frag
+     *         defines = SPECULAR
+     *     }
+     * }
+     * </pre>
+     *
+     * @param url The path of the effect list file.
+     *
+     * @return The number of effects that were created successfully.
+     * @script{ignore}
+     */
+    static unsigned int prewarmProgramBinaryCache(const char* url);
+
+    /**
+     * Sets whether the standard vertex attributes are bound to fixed locations.
+     *
+     * When enabled, the attributes named with the VERTEX_ATTRIBUTE_*_NAME names are bound
+     * to a location derived from their vertex usage (the usage minus one) before the
+     * program of each effect created afterwards is linked. Effects whose attributes all
+     * have their canonical locations then share the vertex array objects of a mesh, instead
+     * of each requiring their own (see VertexAttributeBinding::create).
+     *
+     * This is disabled by default, since some drivers reserve attribute locations. Effects
+     * whose program fails to link with the fixed locations, or that use other attributes,
+     * keep the locations assigned by the driver.
+     *
+     * @param enabled true to bind the standard attributes to fixed locations, false otherwise.
+     * @script{ignore}
+     */
+    static void setCanonicalAttributeLocations(bool enabled);
+
+    /**
+     * Returns whether the standard vertex attributes are bound to fixed locations.
+     *
+     * @return true if the standard attributes are bound to fixed locations, false otherwise.
+     * @script{ignore}
+     */
+    static bool isCanonicalAttributeLocations();
+
+    /**
+     * Returns the vertex usages read by the effects that are currently loaded.
+     *
+     * Bundle::setVertexUsageMask can be given this mask, once the materials of a level
+     * are loaded, so the meshes loaded afterwards drop the vertex elements that no
+     * effect reads.
+     *
+     * @return A mask with bit (1 << usage) set for each VertexFormat::Usage read by a loaded effect.
+     * @script{ignore}
+     */
+    static unsigned int getLoadedVertexUsageMask();
+
+    /**
+     * Recompiles the effects that are loaded from the specified shader file, or from shader
+     * files that include it (see reload).
+     *
+     * @param path The path of the shader file that changed.
+     *
+     * @return The number of effects that were reloaded.
+     * @see HotReloader
+     * @script{ignore}
+     */
+    static unsigned int reloadFile(const char* path);
+
+    /**
+     * Adds the shader files of the loaded effects, and the files they include, to a set.
+     *
+     * @param files The set to add the files to.
+     * @script{ignore}
+     */
+    static void getSourceFiles(std::set<std::string>& files);
+
+    /**
+     * Recompiles this effect from its shader files, which replaces its program in place.
+     *
+     * The uniforms of the effect that are still in the new program are kept, as are the
+     * locations of its vertex attributes, so the materials and the vertex attribute bindings
+     * that use the effect remain valid. The new program is stored in the program binary
+     * cache, if it is enabled. If the shaders fail to compile or link, the effect keeps its
+     * previous program.
+     *
+     * Only effects created from files can be reloaded.
+     *
+     * @return true if the effect was reloaded, false otherwise.
+     * @script{ignore}
+     */
+    bool reload();
+
     /**
      * Returns the unique string identifier for the effect, which is a concatenation of
      * the shader paths it was loaded from.
@@ -64,6 +191,23 @@ public:
      */
     VertexAttribute getVertexAttribute(const char* name) const;
 
+    /**
+     * Returns the vertex usages read by this effect.
+     *
+     * @return A mask with bit (1 << usage) set for each VertexFormat::Usage read by the effect.
+     * @script{ignore}
+     */
+    unsigned int getVertexUsageMask() const;
+
+    /**
+     * Determines whether every vertex attribute of this effect is a standard attribute
+     * bound to its canonical location (see setCanonicalAttributeLocations).
+     *
+     * @return true if the attributes of the effect are at their canonical locations, false otherwise.
+     * @script{ignore}
+     */
+    bool hasCanonicalAttributeLocations() const;
+
     /**
      * Returns the uniform handle for the uniform with the specified name.
      *
@@ -239,12 +383,31 @@ private:
      */
     Effect& operator=(const Effect&);
 
-    static Effect* createFromSource(const char* vshPath, const char* vshSource, const char* fshPath, const char* fshSource, const char* defines = NULL);
+    /**
+     * Creates an effect from shader sources.
+     *
+     * @param feedbackVaryings The names of the varyings of the vertex shader captured by
+     *      transform feedback, in the order they are interleaved in the buffer, or NULL.
+     * @param feedbackVaryingCount The number of feedback varyings.
+     */
+    static Effect* createFromSource(const char* vshPath, const char* vshSource, const char* fshPath, const char* fshSource, const char* defines = NULL,
+                                    const char** feedbackVaryings = NULL, unsigned int feedbackVaryingCount = 0);
+
+    /**
+     * Sets the linked program of this effect, replacing its previous program, and queries its
+     * vertex attributes and uniforms.
+     */
+    void setProgram(GLuint program);
 
     GLuint _program;
     std::string _id;
+    std::vector<std::string> _sourceFiles;      // The vertex and fragment shader files followed by the files they include.
+    std::string _defines;
     std::map<std::string, VertexAttribute> _vertexAttributes;
     std::map<std::string, Uniform*> _uniforms;
+    std::vector<Uniform*> _retiredUniforms;     // Uniforms that were removed from the program when it was reloaded.
+    unsigned int _vertexUsageMask;
+    bool _canonicalAttributes;
     static Uniform _emptyUniform;
 };
 
@@ -300,11 +463,23 @@ private:
      */
     Uniform& operator=(const Uniform&);
 
+    /**
+     * Stores the value last uploaded to this uniform.
+     *
+     * @param value The raw value to upload.
+     * @param size The size of the value, in bytes.
+     *
+     * @return True if the value differs from the stored value and must be uploaded, false otherwise.
+     */
+    bool setCachedValue(const void* value, size_t size);
+
     std::string _name;
     GLint _location;
     GLenum _type;
     unsigned int _index;
     Effect* _effect;
+    Uniform* _layer;
+    std::vector<unsigned char> _value;
 };
 
 }
@@ -0,0 +1,193 @@
+#include "Base.h"
+#include "EffectWarmup.h"
+#include "Game.h"
+#include "Scene.h"
+#include "Model.h"
+#include "MeshPart.h"
+#include "GLStateCache.h"
+#include "RenderTargetPool.h"
+
+// The width and height of the render target the warm-up draws to.
+#define EFFECT_WARMUP_TARGET_SIZE 4
+
+namespace gameplay
+{
+
+EffectWarmup::EffectWarmup(float timeBudget)
+    : _timeBudget(timeBudget), _drawn(0), _drawCount(0), _cancelled(false)
+{
+}
+
+EffectWarmup::~EffectWarmup()
+{
+    clear();
+}
+
+EffectWarmup* EffectWarmup::create(Scene* scene, float timeBudget)
+{
+    GP_ASSERT(scene);
+
+    EffectWarmup* warmup = new EffectWarmup(timeBudget);
+    scene->visit(warmup, &EffectWarmup::addNode);
+    warmup->_drawCount = (unsigned int)warmup->_draws.size();
+    if (!warmup->isComplete())
+        warmup->scheduleStep();
+    return warmup;
+}
+
+bool EffectWarmup::isComplete() const
+{
+    return _cancelled || _drawn == _drawCount;
+}
+
+float EffectWarmup::getProgress() const
+{
+    return _drawCount > 0 && !_cancelled ? (float)_drawn / (float)_drawCount : 1.0f;
+}
+
+unsigned int EffectWarmup::getDrawCount() const
+{
+    return _drawCount;
+}
+
+void EffectWarmup::cancel()
+{
+    // The pending time event releases the models and materials.
+    _cancelled = true;
+}
+
+bool EffectWarmup::addNode(Node* node)
+{
+    Model* model = node->getModel();
+    if (model && model->getMesh())
+    {
+        // Meshes without parts are drawn with the shared material.
+        unsigned int partCount = model->getMesh()->getPartCount();
+        if (partCount == 0)
+            addMaterial(model, model->getMaterial(), -1);
+        for (unsigned int i = 0; i < partCount; ++i)
+            addMaterial(model, model->getMaterial((int)i), (int)i);
+    }
+    return true;
+}
+
+void EffectWarmup::addMaterial(Model* model, Material* material, int part)
+{
+    if (material == NULL)
+        return;
+
+    const VertexFormat& vertexFormat = model->getMesh()->getVertexFormat();
+    for (unsigned int i = 0, techniqueCount = material->getTechniqueCount(); i < techniqueCount; ++i)
+    {
+        Technique* technique = material->getTechniqueByIndex(i);
+        GP_ASSERT(technique);
+        for (unsigned int j = 0, passCount = technique->getPassCount(); j < passCount; ++j)
+        {
+            Pass* pass = technique->getPassByIndex(j);
+            GP_ASSERT(pass);
+            if (pass->getEffect() == NULL || pass->getVertexAttributeBinding() == NULL)
+                continue;
+
+            // Render states that set the same states to the same values have the same id.
+            unsigned int stateId = pass->getStateId();
+            bool found = false;
+            for (size_t k = 0, count = _draws.size(); k < count && !found; ++k)
+            {
+                const Draw& draw = _draws[k];
+                found = draw.effect == pass->getEffect() && draw.stateId == stateId && draw.vertexFormat == vertexFormat;
+            }
+            if (found)
+                continue;
+
+            Draw draw = { pass->getEffect(), vertexFormat, stateId, model, material, pass, part };
+            model->addRef();
+            material->addRef();
+            _draws.push_back(draw);
+        }
+    }
+}
+
+void EffectWarmup::scheduleStep()
+{
+    // Keep this warm-up alive until the scheduled event has fired.
+    addRef();
+    Game::getInstance()->schedule(1, this);
+}
+
+void EffectWarmup::timeEvent(long timeDiff, void* cookie)
+{
+    if (_cancelled)
+    {
+        clear();
+    }
+    else if (_drawn < _drawCount)
+    {
+        FrameBuffer* frameBuffer = RenderTargetPool::acquire(EFFECT_WARMUP_TARGET_SIZE, EFFECT_WARMUP_TARGET_SIZE, Texture::RGBA, true);
+        if (frameBuffer == NULL)
+        {
+            GP_WARN("Failed to create the render target of an effect warm-up; the effects are not warmed up.");
+            _cancelled = true;
+            clear();
+        }
+        else
+        {
+            Game* game = Game::getInstance();
+            FrameBuffer* previous = frameBuffer->bind();
+            GL_ASSERT( glViewport(0, 0, EFFECT_WARMUP_TARGET_SIZE, EFFECT_WARMUP_TARGET_SIZE) );
+
+            // Always draw at least one combination per step so that the warm-up progresses.
+            double startTime = Game::getAbsoluteTime();
+            do
+            {
+                Draw& draw = _draws[_drawn++];
+                Mesh* mesh = draw.model->getMesh();
+                GP_ASSERT(mesh);
+
+                // Drawing the first primitive is enough for the driver to compile the state.
+                draw.pass->bind();
+                if (draw.part >= 0)
+                {
+                    MeshPart* part = mesh->getPart((unsigned int)draw.part);
+                    GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, part->getIndexBuffer());
+                    GL_ASSERT( glDrawElements(part->getPrimitiveType(), std::min(part->getIndexCount(), 3u), part->getIndexFormat(), (const GLvoid*)part->getIndexOffset()) );
+                }
+                else
+                {
+                    GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+                    GL_ASSERT( glDrawArrays(mesh->getPrimitiveType(), 0, std::min(mesh->getVertexCount(), 3u)) );
+                }
+                draw.pass->unbind();
+
+                SAFE_RELEASE(draw.material);
+                SAFE_RELEASE(draw.model);
+            } while (_drawn < _drawCount && Game::getAbsoluteTime() - startTime < _timeBudget);
+
+            // Nothing that is drawn is kept.
+            frameBuffer->discard(true, true);
+            previous->bind();
+            game->setViewport(game->getViewport());
+            RenderTargetPool::release(frameBuffer);
+        }
+    }
+
+    if (!isComplete())
+    {
+        scheduleStep();
+    }
+
+    // Release the reference held for this event (this may destroy the warm-up).
+    release();
+}
+
+void EffectWarmup::clear()
+{
+    for (size_t i = _drawn, count = _draws.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_draws[i].material);
+        SAFE_RELEASE(_draws[i].model);
+    }
+    _draws.clear();
+    _drawn = _drawCount;
+}
+
+}
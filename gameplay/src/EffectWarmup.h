@@ -0,0 +1,154 @@
+#ifndef EFFECTWARMUP_H_
+#define EFFECTWARMUP_H_
+
+#include "Ref.h"
+#include "TimeListener.h"
+#include "VertexFormat.h"
+
+namespace gameplay
+{
+
+class Effect;
+class Scene;
+class Node;
+class Model;
+class Material;
+class Pass;
+
+/**
+ * Defines a warm-up of the effects of a scene, which draws each combination of effect, vertex
+ * format and render state used by the scene once, off-screen, while the scene is loading.
+ *
+ * Many drivers only finish compiling the state of a shader program when it is first drawn with,
+ * for the vertex format and render state it is drawn with. Without a warm-up, this happens the
+ * first time a material is seen, and stalls that frame. A warm-up draws the first primitive of
+ * one model for each combination to a small render target that is never shown, a few at a time,
+ * for at most its time budget in each frame. It is advanced by Game::schedule(), so it only
+ * progresses while the game is running, typically behind a loading screen:
+ *
+ @verbatim
+    _warmup = EffectWarmup::create(scene);
+    ...
+    // In update(), while the loading screen is shown.
+    if (_warmup->isComplete())
+        SAFE_RELEASE(_warmup);
+ @endverbatim
+ *
+ * The warm-up keeps references to the models and materials it draws until it completes.
+ *
+ * @script{ignore}
+ */
+class EffectWarmup : public Ref, public TimeListener
+{
+public:
+
+    /**
+     * Starts a warm-up of the effects of the materials of the models in a scene.
+     *
+     * @param scene The scene.
+     * @param timeBudget The maximum time (in milliseconds) spent drawing in each frame.
+     *
+     * @return The warm-up.
+     */
+    static EffectWarmup* create(Scene* scene, float timeBudget = 2.0f);
+
+    /**
+     * Determines whether every combination has been drawn, or the warm-up was cancelled.
+     *
+     * @return True if the warm-up is complete, false if it is still in progress.
+     */
+    bool isComplete() const;
+
+    /**
+     * Returns the progress of the warm-up, between 0.0 and 1.0.
+     *
+     * @return The progress of the warm-up.
+     */
+    float getProgress() const;
+
+    /**
+     * Returns the number of combinations of effect, vertex format and render state that are
+     * drawn by the warm-up.
+     *
+     * @return The number of combinations.
+     */
+    unsigned int getDrawCount() const;
+
+    /**
+     * Cancels the warm-up. The combinations that were not drawn yet are not drawn.
+     */
+    void cancel();
+
+private:
+
+    /**
+     * A combination to draw, and the pass and part of the model it is drawn with.
+     */
+    struct Draw
+    {
+        Effect* effect;
+        VertexFormat vertexFormat;
+        unsigned int stateId;
+        Model* model;
+        Material* material;
+        Pass* pass;
+        int part;
+    };
+
+    /**
+     * Constructor.
+     */
+    EffectWarmup(float timeBudget);
+
+    /**
+     * Destructor.
+     */
+    ~EffectWarmup();
+
+    /**
+     * Hidden copy constructor.
+     */
+    EffectWarmup(const EffectWarmup& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    EffectWarmup& operator=(const EffectWarmup&);
+
+    /**
+     * Adds the combinations of the passes of the materials of the model of a node.
+     */
+    bool addNode(Node* node);
+
+    /**
+     * Adds the combinations of the passes of a material, for a part of a model.
+     */
+    void addMaterial(Model* model, Material* material, int part);
+
+    /**
+     * Schedules the next step of the warm-up for the next frame.
+     */
+    void scheduleStep();
+
+    /**
+     * Draws as many combinations as the time budget allows.
+     *
+     * @see TimeListener::timeEvent
+     */
+    void timeEvent(long timeDiff, void* cookie);
+
+    /**
+     * Releases the models and materials that are left to draw.
+     */
+    void clear();
+
+    float _timeBudget;
+    std::vector<Draw> _draws;
+    unsigned int _drawn;
+    unsigned int _drawCount;
+    bool _cancelled;
+};
+
+}
+
+#endif
@@ -1,7 +1,10 @@
 #include "Base.h"
+#include "Profiler.h"
 #include "FileSystem.h"
 #include "Properties.h"
 #include "Stream.h"
+#include "Ref.h"
+#include "Mutex.h"
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -17,6 +20,9 @@
     #define __EXT_POSIX2
     #include <libgen.h>
     #include <dirent.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
     #define gp_stat stat
     #define gp_stat_struct struct stat
 #endif
@@ -26,9 +32,125 @@
 extern AAssetManager* __assetManager;
 #endif
 
+// The identifier at the start of package files, which must match gameplay-encoder.
+#define PACKAGE_IDENTIFIER "\xABGPK"
+#define PACKAGE_VERSION 1
+
+// The flag of package entries that are compressed with LZ4.
+#define PACKAGE_ENTRY_LZ4 1
+
 namespace gameplay
 {
 
+/**
+ * The names in a directory, which fileExists looks files up in instead of asking the OS for each file.
+ */
+struct DirectoryListing
+{
+    bool exists;
+    std::set<std::string> names;            // Lower case on Windows, whose file names are not case sensitive.
+};
+
+/**
+ * Guards the caches of the files that exist, which loaders on other threads use.
+ */
+static Mutex __cacheMutex;
+
+static bool __cacheEnabled = true;
+static std::map<std::string, DirectoryListing> __directories;
+#ifdef __ANDROID__
+static std::map<std::string, bool> __assets;        // Whether each asset that was looked for exists.
+#endif
+
+/**
+ * Splits a path into its directory and file name.
+ */
+static void splitPath(const std::string& path, std::string& dir, std::string& name)
+{
+#ifdef WIN32
+    size_t index = path.find_last_of("/\\");
+#else
+    size_t index = path.find_last_of('/');
+#endif
+    dir = index == std::string::npos ? "" : path.substr(0, index);
+    name = index == std::string::npos ? path : path.substr(index + 1);
+}
+
+/**
+ * Lists the names in a directory.
+ */
+static void listDirectory(const std::string& dir, DirectoryListing& listing)
+{
+    listing.exists = false;
+#ifdef WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA((dir.empty() ? std::string("*") : dir + "/*").c_str(), &data);
+    if (find == INVALID_HANDLE_VALUE)
+        return;
+    listing.exists = true;
+    do
+    {
+        std::string name(data.cFileName);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        listing.names.insert(name);
+    } while (FindNextFileA(find, &data) != 0);
+    FindClose(find);
+#else
+    DIR* handle = opendir(dir.empty() ? "." : dir.c_str());
+    if (handle == NULL)
+        return;
+    listing.exists = true;
+    struct dirent* dp;
+    while ((dp = readdir(handle)) != NULL)
+    {
+        listing.names.insert(dp->d_name);
+    }
+    closedir(handle);
+#endif
+}
+
+/**
+ * Determines whether a file or directory exists, listing its directory the first time a file in it is looked for.
+ */
+static bool pathExists(const std::string& path)
+{
+    std::string dir;
+    std::string name;
+    splitPath(path, dir, name);
+    if (!__cacheEnabled || name.empty() || name == "." || name == "..")
+    {
+        gp_stat_struct s;
+        return stat(path.c_str(), &s) == 0;
+    }
+#ifdef WIN32
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+#endif
+
+    __cacheMutex.lock();
+    std::map<std::string, DirectoryListing>::iterator itr = __directories.find(dir);
+    if (itr == __directories.end())
+    {
+        itr = __directories.insert(std::make_pair(dir, DirectoryListing())).first;
+        listDirectory(dir, itr->second);
+    }
+    bool exists = itr->second.exists && itr->second.names.find(name) != itr->second.names.end();
+    __cacheMutex.unlock();
+    return exists;
+}
+
+/**
+ * Forgets the listing of the directory of a file that is written.
+ */
+static void invalidatePath(const std::string& path)
+{
+    std::string dir;
+    std::string name;
+    splitPath(path, dir, name);
+    __cacheMutex.lock();
+    __directories.erase(dir);
+    __cacheMutex.unlock();
+}
+
 #ifdef __ANDROID__
 #include <unistd.h>
 
@@ -73,14 +195,64 @@ static void makepath(std::string path, int mode)
  */
 static bool androidFileExists(const char* filePath)
 {
+    // The assets of the package never change, so they are only looked for once.
+    if (__cacheEnabled)
+    {
+        __cacheMutex.lock();
+        std::map<std::string, bool>::const_iterator itr = __assets.find(filePath);
+        bool found = itr != __assets.end();
+        bool exists = found && itr->second;
+        __cacheMutex.unlock();
+        if (found)
+            return exists;
+    }
+
+    bool exists = false;
     AAsset* asset = AAssetManager_open(__assetManager, filePath, AASSET_MODE_RANDOM);
     if (asset)
     {
-        int lenght = AAsset_getLength(asset);
+        int length = AAsset_getLength(asset);
         AAsset_close(asset);
-        return length > 0;
+        exists = length > 0;
     }
-    return false;
+
+    if (__cacheEnabled)
+    {
+        __cacheMutex.lock();
+        __assets[filePath] = exists;
+        __cacheMutex.unlock();
+    }
+    return exists;
+}
+
+static int readAsset(void* cookie, char* buffer, int size)
+{
+    return AAsset_read((AAsset*)cookie, buffer, size);
+}
+
+static fpos_t seekAsset(void* cookie, fpos_t offset, int origin)
+{
+    return AAsset_seek((AAsset*)cookie, offset, origin);
+}
+
+static int closeAsset(void* cookie)
+{
+    AAsset_close((AAsset*)cookie);
+    return 0;
+}
+
+/**
+ * Opens a FILE that reads an asset in place from the package, or returns NULL if there is no such asset.
+ */
+static FILE* openAsset(const char* filePath)
+{
+    AAsset* asset = AAssetManager_open(__assetManager, filePath, AASSET_MODE_RANDOM);
+    if (asset == NULL)
+        return NULL;
+    FILE* fp = funopen(asset, readAsset, NULL, seekAsset, closeAsset);
+    if (fp == NULL)
+        AAsset_close(asset);
+    return fp;
 }
 
 #endif
@@ -144,6 +316,46 @@ private:
     bool _canWrite;
 };
 
+/**
+ * A read-only stream over a file that is mapped into memory.
+ *
+ * @script{ignore}
+ */
+class MappedFileStream : public Stream
+{
+public:
+    friend class FileSystem;
+
+    ~MappedFileStream();
+    virtual bool canRead();
+    virtual bool canWrite();
+    virtual bool canSeek();
+    virtual void close();
+    virtual size_t read(void* ptr, size_t size, size_t count);
+    virtual char* readLine(char* str, int num);
+    virtual size_t write(const void* ptr, size_t size, size_t count);
+    virtual bool eof();
+    virtual size_t length();
+    virtual long int position();
+    virtual bool seek(long int offset, int origin);
+    virtual bool rewind();
+    virtual const void* readDirect(size_t size);
+
+    static MappedFileStream* create(const char* filePath);
+
+private:
+    MappedFileStream(const char* data, size_t length);
+
+private:
+    const char* _data;
+    size_t _length;
+    size_t _position;
+#ifdef WIN32
+    HANDLE _file;
+    HANDLE _mapping;
+#endif
+};
+
 #ifdef __ANDROID__
 
 /**
@@ -168,8 +380,9 @@ public:
     virtual long int position();
     virtual bool seek(long int offset, int origin);
     virtual bool rewind();
+    virtual const void* readDirect(size_t size);
 
-    static FileStreamAndroid* create(const char* filePath, const char* mode);
+    static FileStreamAndroid* create(const char* filePath, const char* mode, bool map);
 
 private:
     FileStreamAndroid(AAsset* asset);
@@ -180,6 +393,191 @@ private:
 
 #endif
 
+/**
+ * A package file mounted into the file system: a table of contents followed by the
+ * files it contains, each aligned to 16 bytes and optionally compressed with LZ4.
+ *
+ * The package file is opened once, when it is mounted. When it can be mapped into memory,
+ * the entries that are not compressed are read in place.
+ *
+ * @script{ignore}
+ */
+class Package : public Ref
+{
+public:
+
+    /**
+     * A file in the package.
+     */
+    struct Entry
+    {
+        unsigned int offset;        // The position of the data in the package.
+        unsigned int size;          // The size of the file.
+        unsigned int storedSize;    // The size of the data in the package, which is compressed when smaller than size.
+        unsigned int flags;
+    };
+
+    static Package* create(const char* path, int priority);
+
+    const Entry* findEntry(const std::string& name) const;
+
+    Stream* open(const Entry* entry);
+
+    std::string _path;
+    int _priority;
+
+private:
+
+    Package();
+
+    ~Package();
+
+    Package(const Package& copy);
+
+    Package& operator=(const Package&);
+
+    Stream* _stream;
+    const char* _data;                      // The mapped package file, or NULL if it is read with _stream.
+    std::map<std::string, Entry> _entries;
+    Mutex _mutex;                           // Guards _stream when the package is not mapped.
+};
+
+/**
+ * A read-only stream over a file in a package. The stream keeps a reference to its package.
+ *
+ * @script{ignore}
+ */
+class PackageStream : public Stream
+{
+public:
+
+    PackageStream(Package* package, const char* data, char* buffer, size_t size);
+    ~PackageStream();
+    virtual bool canRead();
+    virtual bool canWrite();
+    virtual bool canSeek();
+    virtual void close();
+    virtual size_t read(void* ptr, size_t size, size_t count);
+    virtual char* readLine(char* str, int num);
+    virtual size_t write(const void* ptr, size_t size, size_t count);
+    virtual bool eof();
+    virtual size_t length();
+    virtual long int position();
+    virtual bool seek(long int offset, int origin);
+    virtual bool rewind();
+    virtual const void* readDirect(size_t size);
+
+private:
+
+    Package* _package;
+    const char* _data;
+    char* _buffer;                          // The data when it is owned by the stream, or NULL.
+    size_t _size;
+    size_t _position;
+};
+
+// The mounted packages, from the highest priority to the lowest.
+static std::vector<Package*> __packages;
+
+bool FileSystem::decompressLZ4(const void* srcData, size_t srcSize, void* dstData, size_t dstSize)
+{
+    GP_ASSERT(srcData || srcSize == 0);
+    GP_ASSERT(dstData || dstSize == 0);
+
+    const unsigned char* src = (const unsigned char*)srcData;
+    unsigned char* dst = (unsigned char*)dstData;
+    const unsigned char* srcEnd = src + srcSize;
+    unsigned char* out = dst;
+    unsigned char* dstEnd = dst + dstSize;
+    while (src < srcEnd)
+    {
+        // Each sequence is a token, literals, and a match, except the last which only has literals.
+        unsigned int token = *src++;
+        size_t literalLength = token >> 4;
+        if (literalLength == 15)
+        {
+            unsigned char byte;
+            do
+            {
+                if (src >= srcEnd)
+                    return false;
+                byte = *src++;
+                literalLength += byte;
+            } while (byte == 255);
+        }
+        if (literalLength > (size_t)(srcEnd - src) || literalLength > (size_t)(dstEnd - out))
+            return false;
+        memcpy(out, src, literalLength);
+        out += literalLength;
+        src += literalLength;
+        if (src >= srcEnd)
+            break;
+
+        if (srcEnd - src < 2)
+            return false;
+        size_t offset = src[0] | (src[1] << 8);
+        src += 2;
+        if (offset == 0 || offset > (size_t)(out - dst))
+            return false;
+        size_t matchLength = token & 15;
+        if (matchLength == 15)
+        {
+            unsigned char byte;
+            do
+            {
+                if (src >= srcEnd)
+                    return false;
+                byte = *src++;
+                matchLength += byte;
+            } while (byte == 255);
+        }
+        matchLength += 4;
+        if (matchLength > (size_t)(dstEnd - out))
+            return false;
+
+        // The match can overlap the output, which repeats the bytes, so it is copied one byte at a time.
+        const unsigned char* match = out - offset;
+        for (size_t i = 0; i < matchLength; ++i)
+            out[i] = match[i];
+        out += matchLength;
+    }
+    return out == dstEnd;
+}
+
+/**
+ * Finds the mounted package entry of a file.
+ *
+ * Entries are named by their path relative to the resource path, so only relative paths are looked up.
+ */
+static const Package::Entry* findPackageEntry(const char* path, Package** package)
+{
+    if (__packages.empty())
+        return NULL;
+
+    const char* resolvedPath = FileSystem::resolvePath(path);
+    if (FileSystem::isAbsolutePath(resolvedPath))
+        return NULL;
+    std::string name(resolvedPath);
+    for (size_t i = 0; i < name.size(); ++i)
+    {
+        if (name[i] == '\\')
+            name[i] = '/';
+    }
+    while (name.compare(0, 2, "./") == 0)
+        name.erase(0, 2);
+
+    for (size_t i = 0, count = __packages.size(); i < count; ++i)
+    {
+        const Package::Entry* entry = __packages[i]->findEntry(name);
+        if (entry)
+        {
+            *package = __packages[i];
+            return entry;
+        }
+    }
+    return NULL;
+}
+
 /////////////////////////////
 
 FileSystem::FileSystem()
@@ -338,6 +736,10 @@ bool FileSystem::fileExists(const char* filePath)
 {
     GP_ASSERT(filePath);
 
+    Package* package;
+    if (findPackageEntry(filePath, &package))
+        return true;
+
 #ifdef __ANDROID__
     if (androidFileExists(resolvePath(filePath)))
     {
@@ -348,32 +750,75 @@ bool FileSystem::fileExists(const char* filePath)
     std::string fullPath;
     getFullPath(filePath, fullPath);
 
-    gp_stat_struct s;
-
 #ifdef WIN32
-    if (!isAbsolutePath(filePath) && stat(fullPath.c_str(), &s) != 0)
+    if (!isAbsolutePath(filePath) && !pathExists(fullPath))
     {
         fullPath = __resourcePath;
         fullPath += "../../gameplay/";
         fullPath += filePath;
         
-        int result = stat(fullPath.c_str(), &s);
-        if (result != 0)
+        if (!pathExists(fullPath))
         {
             fullPath = __resourcePath;
             fullPath += "../gameplay/";
             fullPath += filePath;
-            return stat(fullPath.c_str(), &s) == 0;
+            return pathExists(fullPath);
         }
     }
     return true;
 #else
-    return stat(fullPath.c_str(), &s) == 0;
+    return pathExists(fullPath);
+#endif
+}
+
+bool FileSystem::getModificationTime(const char* filePath, time_t* time)
+{
+    GP_ASSERT(filePath);
+    GP_ASSERT(time);
+
+    Package* package;
+    if (findPackageEntry(filePath, &package))
+        return false;
+
+    std::string fullPath;
+    getFullPath(filePath, fullPath);
+
+    gp_stat_struct s;
+    if (gp_stat(fullPath.c_str(), &s) != 0)
+    {
+#ifdef WIN32
+        // The same fallback directories as fileExists.
+        if (isAbsolutePath(filePath))
+            return false;
+        fullPath = __resourcePath;
+        fullPath += "../../gameplay/";
+        fullPath += filePath;
+        if (gp_stat(fullPath.c_str(), &s) != 0)
+        {
+            fullPath = __resourcePath;
+            fullPath += "../gameplay/";
+            fullPath += filePath;
+            if (gp_stat(fullPath.c_str(), &s) != 0)
+                return false;
+        }
+#else
+        return false;
 #endif
+    }
+    *time = s.st_mtime;
+    return true;
 }
 
 Stream* FileSystem::open(const char* path, size_t mode)
 {
+    if ((mode & WRITE) == 0)
+    {
+        Package* package;
+        const Package::Entry* entry = findPackageEntry(path, &package);
+        if (entry)
+            return package->open(entry);
+    }
+
     char modeStr[] = "rb";
     if ((mode & WRITE) != 0)
         modeStr[0] = 'w';
@@ -392,38 +837,45 @@ Stream* FileSystem::open(const char* path, size_t mode)
             if (stat(directoryPath.c_str(), &s) != 0)
                 makepath(directoryPath, 0777);
         }
+        invalidatePath(fullPath);
         return FileStream::create(fullPath.c_str(), modeStr);
     }
     else
     {
         // Open a file in the read-only asset directory
-        return FileStreamAndroid::create(resolvePath(path), modeStr);
+        return FileStreamAndroid::create(resolvePath(path), modeStr, (mode & MAP) != 0);
     }
 #else
     std::string fullPath;
     getFullPath(path, fullPath);
     
 #ifdef WIN32
-    gp_stat_struct s;
-    if (!isAbsolutePath(path) && stat(fullPath.c_str(), &s) != 0 && (mode & WRITE) == 0)
+    if (!isAbsolutePath(path) && !pathExists(fullPath) && (mode & WRITE) == 0)
     {
         fullPath = __resourcePath;
         fullPath += "../../gameplay/";
         fullPath += path;
         
-        int result = stat(fullPath.c_str(), &s);
-        if (result != 0)
+        if (!pathExists(fullPath))
         {
             fullPath = __resourcePath;
             fullPath += "../gameplay/";
             fullPath += path;
-            if (stat(fullPath.c_str(), &s) != 0)
+            if (!pathExists(fullPath))
             {
                 return NULL;
             }
         }
     }
 #endif
+    if ((mode & WRITE) != 0)
+        invalidatePath(fullPath);
+    if ((mode & MAP) != 0 && (mode & WRITE) == 0)
+    {
+        MappedFileStream* stream = MappedFileStream::create(fullPath.c_str());
+        if (stream)
+            return stream;
+    }
     FileStream* stream = FileStream::create(fullPath.c_str(), modeStr);
     return stream;
 #endif
@@ -434,11 +886,21 @@ FILE* FileSystem::openFile(const char* filePath, const char* mode)
     GP_ASSERT(filePath);
     GP_ASSERT(mode);
 
+#ifdef __ANDROID__
+    // Assets are read in place from the package rather than copied to the file system first.
+    if (!isAbsolutePath(filePath) && strchr(mode, 'w') == NULL && strchr(mode, 'a') == NULL && strchr(mode, '+') == NULL)
+    {
+        FILE* fp = openAsset(resolvePath(filePath));
+        if (fp)
+            return fp;
+    }
+#endif
+
     std::string fullPath;
     getFullPath(filePath, fullPath);
 
-    createFileFromAsset(filePath);
-    
+    if (strchr(mode, 'w') != NULL || strchr(mode, 'a') != NULL)
+        invalidatePath(fullPath);
     FILE* fp = fopen(fullPath.c_str(), mode);
     
 #ifdef WIN32
@@ -465,6 +927,7 @@ FILE* FileSystem::openFile(const char* filePath, const char* mode)
 char* FileSystem::readAll(const char* filePath, int* fileSize)
 {
     GP_ASSERT(filePath);
+    GP_PROFILE("FileSystem::readAll");
 
     // Open file for reading.
     std::auto_ptr<Stream> stream(open(filePath));
@@ -536,6 +999,7 @@ void FileSystem::createFileFromAsset(const char* path)
         {
             const void* data = AAsset_getBuffer(asset);
             int length = AAsset_getLength(asset);
+            invalidatePath(fullPath);
             FILE* file = fopen(fullPath.c_str(), "wb");
             if (file != NULL)
             {
@@ -563,6 +1027,76 @@ void FileSystem::createFileFromAsset(const char* path)
 #endif
 }
 
+void FileSystem::clearCache()
+{
+    __cacheMutex.lock();
+    __directories.clear();
+#ifdef __ANDROID__
+    __assets.clear();
+#endif
+    __cacheMutex.unlock();
+}
+
+void FileSystem::setCacheEnabled(bool enabled)
+{
+    __cacheEnabled = enabled;
+    clearCache();
+}
+
+bool FileSystem::isCacheEnabled()
+{
+    return __cacheEnabled;
+}
+
+bool FileSystem::mountPackage(const char* path, int priority)
+{
+    GP_ASSERT(path);
+
+    Package* package = Package::create(path, priority);
+    if (package == NULL)
+        return false;
+
+    unmountPackage(path);
+
+    // A package comes before those of lower priority and after those of higher or equal priority.
+    std::vector<Package*>::iterator itr = __packages.begin();
+    while (itr != __packages.end() && (*itr)->_priority >= priority)
+        ++itr;
+    __packages.insert(itr, package);
+    return true;
+}
+
+void FileSystem::unmountPackage(const char* path)
+{
+    GP_ASSERT(path);
+
+    for (std::vector<Package*>::iterator itr = __packages.begin(); itr != __packages.end(); ++itr)
+    {
+        if ((*itr)->_path == path)
+        {
+            // Streams opened from the package keep it alive until they are destroyed.
+            SAFE_RELEASE(*itr);
+            __packages.erase(itr);
+            return;
+        }
+    }
+}
+
+bool FileSystem::getPackageLocation(const char* path, std::string* packagePath, unsigned int* offset)
+{
+    GP_ASSERT(path);
+    GP_ASSERT(packagePath);
+    GP_ASSERT(offset);
+
+    Package* package;
+    const Package::Entry* entry = findPackageEntry(path, &package);
+    if (entry == NULL)
+        return false;
+    *packagePath = package->_path;
+    *offset = entry->offset;
+    return true;
+}
+
 std::string FileSystem::getDirectoryName(const char* path)
 {
     if (path == NULL || strlen(path) == 0)
@@ -746,6 +1280,165 @@ bool FileStream::rewind()
 
 ////////////////////////////////
 
+MappedFileStream::MappedFileStream(const char* data, size_t length)
+    : _data(data), _length(length), _position(0)
+{
+}
+
+MappedFileStream::~MappedFileStream()
+{
+    close();
+}
+
+MappedFileStream* MappedFileStream::create(const char* filePath)
+{
+#ifdef WIN32
+    HANDLE file = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+    DWORD length = GetFileSize(file, NULL);
+    HANDLE mapping = length > 0 ? CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+    const char* data = mapping ? (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (data == NULL)
+    {
+        if (mapping)
+            CloseHandle(mapping);
+        CloseHandle(file);
+        return NULL;
+    }
+    MappedFileStream* stream = new MappedFileStream(data, length);
+    stream->_file = file;
+    stream->_mapping = mapping;
+    return stream;
+#else
+    int fd = ::open(filePath, O_RDONLY);
+    if (fd == -1)
+        return NULL;
+    struct stat s;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &s) == 0 && s.st_size > 0)
+    {
+        data = mmap(NULL, (size_t)s.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    // The mapping remains valid after the file descriptor is closed.
+    ::close(fd);
+    if (data == MAP_FAILED)
+        return NULL;
+    return new MappedFileStream((const char*)data, (size_t)s.st_size);
+#endif
+}
+
+bool MappedFileStream::canRead()
+{
+    return _data != NULL;
+}
+
+bool MappedFileStream::canWrite()
+{
+    return false;
+}
+
+bool MappedFileStream::canSeek()
+{
+    return _data != NULL;
+}
+
+void MappedFileStream::close()
+{
+    if (_data)
+    {
+#ifdef WIN32
+        UnmapViewOfFile(_data);
+        CloseHandle(_mapping);
+        CloseHandle(_file);
+#else
+        munmap((void*)_data, _length);
+#endif
+        _data = NULL;
+    }
+}
+
+size_t MappedFileStream::read(void* ptr, size_t size, size_t count)
+{
+    if (!_data || size == 0)
+        return 0;
+    size_t available = (_length - _position) / size;
+    if (count > available)
+        count = available;
+    memcpy(ptr, _data + _position, size * count);
+    _position += size * count;
+    return count;
+}
+
+char* MappedFileStream::readLine(char* str, int num)
+{
+    if (!_data || num <= 0 || _position >= _length)
+        return NULL;
+    int i = 0;
+    while (i < num - 1 && _position < _length)
+    {
+        char c = _data[_position++];
+        str[i++] = c;
+        if (c == '\n')
+            break;
+    }
+    str[i] = '\0';
+    return str;
+}
+
+size_t MappedFileStream::write(const void* ptr, size_t size, size_t count)
+{
+    return 0;
+}
+
+bool MappedFileStream::eof()
+{
+    return !_data || _position >= _length;
+}
+
+size_t MappedFileStream::length()
+{
+    return _length;
+}
+
+long int MappedFileStream::position()
+{
+    if (!_data)
+        return -1;
+    return (long int)_position;
+}
+
+bool MappedFileStream::seek(long int offset, int origin)
+{
+    if (!_data)
+        return false;
+    long int base = 0;
+    if (origin == SEEK_CUR)
+        base = (long int)_position;
+    else if (origin == SEEK_END)
+        base = (long int)_length;
+    if (base + offset < 0 || base + offset > (long int)_length)
+        return false;
+    _position = (size_t)(base + offset);
+    return true;
+}
+
+bool MappedFileStream::rewind()
+{
+    return seek(0, SEEK_SET);
+}
+
+const void* MappedFileStream::readDirect(size_t size)
+{
+    if (!_data || size > _length - _position)
+        return NULL;
+    const void* ptr = _data + _position;
+    _position += size;
+    return ptr;
+}
+
+////////////////////////////////
+
 #ifdef __ANDROID__
 
 FileStreamAndroid::FileStreamAndroid(AAsset* asset)
@@ -759,9 +1452,10 @@ FileStreamAndroid::~FileStreamAndroid()
         close();
 }
 
-FileStreamAndroid* FileStreamAndroid::create(const char* filePath, const char* mode)
+FileStreamAndroid* FileStreamAndroid::create(const char* filePath, const char* mode, bool map)
 {
-    AAsset* asset = AAssetManager_open(__assetManager, filePath, AASSET_MODE_RANDOM);
+    // Buffer mode lets the asset manager map uncompressed assets rather than read them through a file descriptor.
+    AAsset* asset = AAssetManager_open(__assetManager, filePath, map ? AASSET_MODE_BUFFER : AASSET_MODE_RANDOM);
     if (asset)
     {
         FileStreamAndroid* stream = new FileStreamAndroid(asset);
@@ -891,6 +1585,230 @@ bool FileStreamAndroid::rewind()
     return false;
 }
 
+const void* FileStreamAndroid::readDirect(size_t size)
+{
+    // Uncompressed assets are mapped directly from the package; compressed assets are
+    // decompressed into memory once on the first request.
+    const char* buffer = (const char*)AAsset_getBuffer(_asset);
+    long int offset = position();
+    if (buffer == NULL || size > (size_t)AAsset_getRemainingLength(_asset) || !seek((long int)size, SEEK_CUR))
+        return NULL;
+    return buffer + offset;
+}
+
 #endif
 
+////////////////////////////////
+
+Package::Package()
+    : _priority(0), _stream(NULL), _data(NULL)
+{
+}
+
+Package::~Package()
+{
+    SAFE_DELETE(_stream);
+}
+
+Package* Package::create(const char* path, int priority)
+{
+    std::auto_ptr<Stream> stream(FileSystem::open(path, FileSystem::READ | FileSystem::MAP));
+    if (stream.get() == NULL)
+    {
+        GP_WARN("Failed to open package '%s'.", path);
+        return NULL;
+    }
+
+    char identifier[4];
+    unsigned int header[2];
+    if (stream->read(identifier, 1, 4) != 4 || memcmp(identifier, PACKAGE_IDENTIFIER, 4) != 0 ||
+        stream->read(header, sizeof(unsigned int), 2) != 2 || header[0] != PACKAGE_VERSION)
+    {
+        GP_WARN("Failed to mount package '%s': invalid package header.", path);
+        return NULL;
+    }
+
+    Package* package = new Package();
+    package->_path = path;
+    package->_priority = priority;
+    size_t length = stream->length();
+    std::string name;
+    for (unsigned int i = 0; i < header[1]; ++i)
+    {
+        unsigned int nameLength;
+        Entry entry;
+        if (stream->read(&nameLength, sizeof(unsigned int), 1) != 1 || nameLength == 0 || nameLength > length)
+            break;
+        name.resize(nameLength);
+        if (stream->read(&name[0], 1, nameLength) != nameLength || stream->read(&entry, sizeof(Entry), 1) != 1 ||
+            entry.offset > length || entry.storedSize > length - entry.offset)
+        {
+            break;
+        }
+        package->_entries[name] = entry;
+    }
+    if (package->_entries.size() != header[1])
+    {
+        GP_WARN("Failed to mount package '%s': invalid table of contents.", path);
+        SAFE_RELEASE(package);
+        return NULL;
+    }
+
+    // When the package is mapped, entries are read from memory without seeking the stream.
+    if (stream->seek(0, SEEK_SET))
+        package->_data = (const char*)stream->readDirect(length);
+    package->_stream = stream.release();
+    return package;
+}
+
+const Package::Entry* Package::findEntry(const std::string& name) const
+{
+    std::map<std::string, Entry>::const_iterator itr = _entries.find(name);
+    return itr == _entries.end() ? NULL : &itr->second;
+}
+
+Stream* Package::open(const Entry* entry)
+{
+    GP_ASSERT(entry);
+
+    const char* data = NULL;
+    char* buffer = NULL;
+    if (_data)
+    {
+        data = _data + entry->offset;
+    }
+    else
+    {
+        buffer = new char[std::max(entry->storedSize, 1u)];
+        _mutex.lock();
+        bool read = _stream->seek((long int)entry->offset, SEEK_SET) && _stream->read(buffer, 1, entry->storedSize) == entry->storedSize;
+        _mutex.unlock();
+        if (!read)
+        {
+            SAFE_DELETE_ARRAY(buffer);
+            return NULL;
+        }
+        data = buffer;
+    }
+
+    if (entry->flags & PACKAGE_ENTRY_LZ4)
+    {
+        char* decompressed = new char[std::max(entry->size, 1u)];
+        bool valid = FileSystem::decompressLZ4(data, entry->storedSize, decompressed, entry->size);
+        SAFE_DELETE_ARRAY(buffer);
+        if (!valid)
+        {
+            SAFE_DELETE_ARRAY(decompressed);
+            return NULL;
+        }
+        data = buffer = decompressed;
+    }
+    return new PackageStream(this, data, buffer, entry->size);
+}
+
+////////////////////////////////
+
+PackageStream::PackageStream(Package* package, const char* data, char* buffer, size_t size)
+    : _package(package), _data(data), _buffer(buffer), _size(size), _position(0)
+{
+    _package->addRef();
+}
+
+PackageStream::~PackageStream()
+{
+    SAFE_DELETE_ARRAY(_buffer);
+    SAFE_RELEASE(_package);
+}
+
+bool PackageStream::canRead()
+{
+    return true;
+}
+
+bool PackageStream::canWrite()
+{
+    return false;
+}
+
+bool PackageStream::canSeek()
+{
+    return true;
+}
+
+void PackageStream::close()
+{
+}
+
+size_t PackageStream::read(void* ptr, size_t size, size_t count)
+{
+    if (size == 0)
+        return 0;
+    size_t available = (_size - _position) / size;
+    if (count > available)
+        count = available;
+    memcpy(ptr, _data + _position, size * count);
+    _position += size * count;
+    return count;
+}
+
+char* PackageStream::readLine(char* str, int num)
+{
+    if (num <= 0 || _position >= _size)
+        return NULL;
+    int i = 0;
+    while (i < num - 1 && _position < _size)
+    {
+        char c = _data[_position++];
+        str[i++] = c;
+        if (c == '\n')
+            break;
+    }
+    str[i] = '\0';
+    return str;
+}
+
+size_t PackageStream::write(const void* ptr, size_t size, size_t count)
+{
+    return 0;
+}
+
+bool PackageStream::eof()
+{
+    return _position >= _size;
+}
+
+size_t PackageStream::length()
+{
+    return _size;
+}
+
+long int PackageStream::position()
+{
+    return (long int)_position;
+}
+
+bool PackageStream::seek(long int offset, int origin)
+{
+    long int base = origin == SEEK_CUR ? (long int)_position : (origin == SEEK_END ? (long int)_size : 0);
+    if (base + offset < 0 || base + offset > (long int)_size)
+        return false;
+    _position = (size_t)(base + offset);
+    return true;
+}
+
+bool PackageStream::rewind()
+{
+    _position = 0;
+    return true;
+}
+
+const void* PackageStream::readDirect(size_t size)
+{
+    if (size > _size - _position)
+        return NULL;
+    const void* ptr = _data + _position;
+    _position += size;
+    return ptr;
+}
+
 }
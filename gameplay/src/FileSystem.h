@@ -23,7 +23,13 @@ public:
     enum StreamMode
     {
         READ = 1,
-        WRITE = 2
+        WRITE = 2,
+        /**
+         * Maps the file into memory when it is opened for reading, so that its
+         * contents can be accessed with Stream::readDirect() without copying.
+         * If the file cannot be mapped it is opened normally.
+         */
+        MAP = 4
     };
 
     /**
@@ -120,6 +126,19 @@ public:
      */
     static bool fileExists(const char* filePath);
 
+    /**
+     * Gets the time at which the file at the given path was last modified.
+     *
+     * Files in mounted packages and Android assets have no modification time.
+     *
+     * @param filePath The path to the file.
+     * @param time Populated with the modification time of the file.
+     *
+     * @return <code>true</code> if the file exists on disk; <code>false</code> otherwise.
+     * @script{ignore}
+     */
+    static bool getModificationTime(const char* filePath, time_t* time);
+
     /**
      * Opens a byte stream for the given resource path.
      *
@@ -175,8 +194,96 @@ public:
      */
     static bool isAbsolutePath(const char* filePath);
 
+    /**
+     * Clears the cache of the files that exist.
+     *
+     * fileExists lists each directory the first time a file in it is looked for, and looks
+     * the files of the directory up in the listing afterwards, so loaders that probe for
+     * several files do not ask the OS for each one. Files written through the FileSystem
+     * update the cache; files created or deleted by other means are only found after the
+     * cache is cleared.
+     *
+     * @script{ignore}
+     */
+    static void clearCache();
+
+    /**
+     * Sets whether fileExists caches the files that exist (see clearCache). Enabled by default.
+     *
+     * @param enabled true to cache the files that exist, false to ask the OS for each file.
+     * @script{ignore}
+     */
+    static void setCacheEnabled(bool enabled);
+
+    /**
+     * Determines whether fileExists caches the files that exist.
+     *
+     * @return true if the files that exist are cached, false otherwise.
+     * @script{ignore}
+     */
+    static bool isCacheEnabled();
+
+    /**
+     * Mounts a package file, so that the files it contains are read from it.
+     *
+     * A package holds many files in a single file, with a table of contents, and is created
+     * from a directory with gameplay-encoder's -pack option. Its files are named by their
+     * path relative to the packed directory, so packing the resource folder lets every file
+     * be opened by the same path as before. Reading a file that is in a mounted package reads
+     * it from the package, which is opened only once, instead of opening a loose file.
+     *
+     * Packages are searched before loose files, from the highest priority to the lowest, and
+     * in the order they were mounted for equal priorities. Packages should be mounted and
+     * unmounted while no files are being read on other threads.
+     *
+     * @param path The path of the package file.
+     * @param priority The priority of the package.
+     *
+     * @return true if the package was mounted, false if it could not be read.
+     * @script{ignore}
+     */
+    static bool mountPackage(const char* path, int priority = 0);
+
+    /**
+     * Unmounts a package file mounted with mountPackage.
+     *
+     * Streams already opened from the package remain valid.
+     *
+     * @param path The path the package was mounted with.
+     * @script{ignore}
+     */
+    static void unmountPackage(const char* path);
+
+    /**
+     * Finds the mounted package a file is read from, and where its data is stored in it.
+     *
+     * @param path The path of the file.
+     * @param packagePath Set to the path the package was mounted with.
+     * @param offset Set to the position of the data of the file in the package.
+     *
+     * @return true if the file is read from a package, false if it is a loose file.
+     * @script{ignore}
+     */
+    static bool getPackageLocation(const char* path, std::string* packagePath, unsigned int* offset);
+
+    /**
+     * Decompresses a block of LZ4 data, as stored in packages and compressed bundles.
+     *
+     * @param src The compressed data.
+     * @param srcSize The size of the compressed data.
+     * @param dst The buffer the data is decompressed to.
+     * @param dstSize The size of the decompressed data, which must be known.
+     *
+     * @return true if the data was decompressed to exactly dstSize bytes, false if it is invalid.
+     * @script{ignore}
+     */
+    static bool decompressLZ4(const void* src, size_t srcSize, void* dst, size_t dstSize);
+
     /**
      * Creates a file on the file system from the specified asset (Android-specific).
+     *
+     * This is only needed to pass an asset to code that opens files by path: open, openFile
+     * and the Lua loadfile and dofile functions read assets in place from the package.
      * 
      * @param path The path to the file.
      */
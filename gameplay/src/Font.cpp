@@ -3,10 +3,12 @@
 #include "Game.h"
 #include "FileSystem.h"
 #include "Bundle.h"
+#include "MemoryStats.h"
 
 // Default font shaders
 #define FONT_VSH "res/shaders/font.vert"
 #define FONT_FSH "res/shaders/font.frag"
+#define FONT_DISTANCE_FIELD_DEFINES "DISTANCE_FIELD"
 
 namespace gameplay
 {
@@ -14,9 +16,10 @@ namespace gameplay
 static std::vector<Font*> __fontCache;
 
 static Effect* __fontEffect = NULL;
+static Effect* __fontDistanceFieldEffect = NULL;
 
 Font::Font() :
-    _style(PLAIN), _size(0), _glyphs(NULL), _glyphCount(0), _texture(NULL), _batch(NULL)
+    _style(PLAIN), _size(0), _format(BITMAP), _glyphs(NULL), _glyphCount(0), _texture(NULL), _batch(NULL)
 {
 }
 
@@ -30,6 +33,8 @@ Font::~Font()
     }
 
     SAFE_DELETE(_batch);
+    if (_glyphs)
+        MemoryStats::remove(MemoryStats::UI, sizeof(Glyph) * _glyphCount);
     SAFE_DELETE_ARRAY(_glyphs);
     SAFE_RELEASE(_texture);
 }
@@ -90,17 +95,19 @@ Font* Font::create(const char* path, const char* id)
     return font;
 }
 
-Font* Font::create(const char* family, Style style, unsigned int size, Glyph* glyphs, int glyphCount, Texture* texture)
+Font* Font::create(const char* family, Style style, unsigned int size, Glyph* glyphs, int glyphCount, Texture* texture, Format format)
 {
     GP_ASSERT(family);
     GP_ASSERT(glyphs);
     GP_ASSERT(texture);
 
-    // Create the effect for the font's sprite batch.
-    if (__fontEffect == NULL)
+    // Create the effect for the font's sprite batch. Distance field fonts share the font
+    // shaders, compiled to reconstruct the glyph outlines from the distances.
+    Effect*& effect = (format == DISTANCE_FIELD) ? __fontDistanceFieldEffect : __fontEffect;
+    if (effect == NULL)
     {
-        __fontEffect = Effect::createFromFile(FONT_VSH, FONT_FSH);
-        if (__fontEffect == NULL)
+        effect = Effect::createFromFile(FONT_VSH, FONT_FSH, format == DISTANCE_FIELD ? FONT_DISTANCE_FIELD_DEFINES : NULL);
+        if (effect == NULL)
         {
             GP_ERROR("Failed to create effect for font.");
             SAFE_RELEASE(texture);
@@ -109,14 +116,14 @@ Font* Font::create(const char* family, Style style, unsigned int size, Glyph* gl
     }
     else
     {
-        __fontEffect->addRef();
+        effect->addRef();
     }
 
     // Create batch for the font.
-    SpriteBatch* batch = SpriteBatch::create(texture, __fontEffect, 128);
+    SpriteBatch* batch = SpriteBatch::create(texture, effect, 128);
     
-    // Release __fontEffect since the SpriteBatch keeps a reference to it
-    SAFE_RELEASE(__fontEffect);
+    // Release the effect since the SpriteBatch keeps a reference to it
+    SAFE_RELEASE(effect);
 
     if (batch == NULL)
     {
@@ -135,6 +142,7 @@ Font* Font::create(const char* family, Style style, unsigned int size, Glyph* gl
     font->_family = family;
     font->_style = style;
     font->_size = size;
+    font->_format = format;
     font->_texture = texture;
     font->_batch = batch;
 
@@ -142,6 +150,7 @@ Font* Font::create(const char* family, Style style, unsigned int size, Glyph* gl
     font->_glyphs = new Glyph[glyphCount];
     memcpy(font->_glyphs, glyphs, sizeof(Glyph) * glyphCount);
     font->_glyphCount = glyphCount;
+    MemoryStats::add(MemoryStats::UI, sizeof(Glyph) * glyphCount);
 
     return font;
 }
@@ -151,6 +160,11 @@ unsigned int Font::getSize()
     return _size;
 }
 
+Font::Format Font::getFormat() const
+{
+    return _format;
+}
+
 void Font::start()
 {
     GP_ASSERT(_batch);
@@ -161,26 +175,88 @@ Font::Text* Font::createText(const char* text, const Rectangle& area, const Vect
     bool wrap, bool rightToLeft, const Rectangle* clip)
 {
     GP_ASSERT(text);
+
+    Text* batch = new Text(text);
+    layoutText(batch, area, color, size, justify, wrap, rightToLeft, clip);
+    return batch;
+}
+
+bool Font::updateText(Text* text, const char* str, const Rectangle& area, const Vector4& color, unsigned int size, Justify justify,
+    bool wrap, bool rightToLeft, const Rectangle* clip)
+{
+    GP_ASSERT(text);
+    GP_ASSERT(str);
+
+    if (size == 0)
+        size = _size;
+
+    if (text->_text == str && text->_area == area && text->_size == size && text->_justify == justify &&
+        text->_wrap == wrap && text->_rightToLeft == rightToLeft &&
+        (clip ? (text->_clipped && text->_clip == *clip) : !text->_clipped))
+    {
+        // The layout is unchanged; only the color may need updating.
+        if (text->_color != color)
+        {
+            for (unsigned int i = 0; i < text->_vertexCount; ++i)
+            {
+                SpriteBatch::SpriteVertex& v = text->_vertices[i];
+                v.r = color.x;
+                v.g = color.y;
+                v.b = color.z;
+                v.a = color.w;
+            }
+            text->_color = color;
+        }
+        return false;
+    }
+
+    text->_text = str;
+    layoutText(text, area, color, size, justify, wrap, rightToLeft, clip);
+    return true;
+}
+
+void Font::layoutText(Text* batch, const Rectangle& area, const Vector4& color, unsigned int size, Justify justify,
+    bool wrap, bool rightToLeft, const Rectangle* clip)
+{
+    GP_ASSERT(batch);
     GP_ASSERT(_glyphs);
     GP_ASSERT(_batch);
 
     if (size == 0)
         size = _size;
     GP_ASSERT(_size);
+
+    // Remember the layout so that updateText() can tell when the text is up to date.
+    batch->_vertexCount = 0;
+    batch->_indexCount = 0;
+    batch->_color = color;
+    batch->_area = area;
+    batch->_size = size;
+    batch->_justify = justify;
+    batch->_wrap = wrap;
+    batch->_rightToLeft = rightToLeft;
+    batch->_clipped = clip != NULL;
+    if (clip)
+        batch->_clip = *clip;
+
+    const char* text = batch->_text.c_str();
+    if (text[0] == 0)
+        return;
+    batch->reserve(batch->_text.length());
+
     float scale = (float)size / _size;
     int yPos = area.y;
     const float areaHeight = area.height - size;
-    std::vector<int> xPositions;
-    std::vector<unsigned int> lineLengths;
+    std::vector<int, FrameAllocator<int> > xPositions;
+    std::vector<unsigned int, FrameAllocator<unsigned int> > lineLengths;
 
     getMeasurementInfo(text, area, size, justify, wrap, rightToLeft, &xPositions, &yPos, &lineLengths);
 
-    Text* batch = new Text(text);
     GP_ASSERT(batch->_vertices);
     GP_ASSERT(batch->_indices);
 
     int xPos = area.x;
-    std::vector<int>::const_iterator xPositionsIt = xPositions.begin();
+    std::vector<int, FrameAllocator<int> >::const_iterator xPositionsIt = xPositions.begin();
     if (xPositionsIt != xPositions.end())
     {
         xPos = *xPositionsIt++;
@@ -191,7 +267,7 @@ Font::Text* Font::createText(const char* text, const Rectangle& area, const Vect
     unsigned int lineLength;
     unsigned int currentLineLength = 0;
     const char* lineStart;
-    std::vector<unsigned int>::const_iterator lineLengthsIt;
+    std::vector<unsigned int, FrameAllocator<unsigned int> >::const_iterator lineLengthsIt;
     if (rightToLeft)
     {
         lineStart = token;
@@ -247,7 +323,7 @@ Font::Text* Font::createText(const char* text, const Rectangle& area, const Vect
         }
 
         bool draw = true;
-        if (yPos < static_cast<int>(area.y))
+        if (yPos < static_cast<int>(area.y - size))
         {
             // Skip drawing until line break or wrap.
             draw = false;
@@ -383,18 +459,46 @@ Font::Text* Font::createText(const char* text, const Rectangle& area, const Vect
             }
         }
     }
-
-    return batch;
 }
 
 void Font::drawText(Text* text)
 {
     GP_ASSERT(_batch);
+    GP_ASSERT(text);
+    if (text->_vertexCount == 0)
+        return;
+
     GP_ASSERT(text->_vertices);
     GP_ASSERT(text->_indices);
     _batch->draw(text->_vertices, text->_vertexCount, text->_indices, text->_indexCount);
 }
 
+void Font::drawText(Text* text, const Matrix& transform)
+{
+    GP_ASSERT(_batch);
+    GP_ASSERT(text);
+    if (text->_vertexCount == 0)
+        return;
+
+    GP_ASSERT(text->_vertices);
+    GP_ASSERT(text->_indices);
+
+    // Transform a copy of the vertices, leaving the laid out text untouched.
+    _transformedVertices.resize(text->_vertexCount);
+    Vector3 position;
+    for (unsigned int i = 0; i < text->_vertexCount; ++i)
+    {
+        SpriteBatch::SpriteVertex& v = _transformedVertices[i];
+        v = text->_vertices[i];
+        position.set(v.x, v.y, v.z);
+        transform.transformPoint(&position);
+        v.x = position.x;
+        v.y = position.y;
+        v.z = position.z;
+    }
+    _batch->draw(&_transformedVertices[0], text->_vertexCount, text->_indices, text->_indexCount);
+}
+
 void Font::drawText(const char* text, int x, int y, const Vector4& color, unsigned int size, bool rightToLeft)
 {
     if (size == 0)
@@ -530,14 +634,14 @@ void Font::drawText(const char* text, const Rectangle& area, const Vector4& colo
     float scale = (float)size / _size;
     int yPos = area.y;
     const float areaHeight = area.height - size;
-    std::vector<int> xPositions;
-    std::vector<unsigned int> lineLengths;
+    std::vector<int, FrameAllocator<int> > xPositions;
+    std::vector<unsigned int, FrameAllocator<unsigned int> > lineLengths;
 
     getMeasurementInfo(text, area, size, justify, wrap, rightToLeft, &xPositions, &yPos, &lineLengths);
 
     // Now we have the info we need in order to render.
     int xPos = area.x;
-    std::vector<int>::const_iterator xPositionsIt = xPositions.begin();
+    std::vector<int, FrameAllocator<int> >::const_iterator xPositionsIt = xPositions.begin();
     if (xPositionsIt != xPositions.end())
     {
         xPos = *xPositionsIt++;
@@ -548,7 +652,7 @@ void Font::drawText(const char* text, const Rectangle& area, const Vector4& colo
     unsigned int lineLength;
     unsigned int currentLineLength = 0;
     const char* lineStart;
-    std::vector<unsigned int>::const_iterator lineLengthsIt;
+    std::vector<unsigned int, FrameAllocator<unsigned int> >::const_iterator lineLengthsIt;
     if (rightToLeft)
     {
         lineStart = token;
@@ -788,8 +892,8 @@ void Font::measureText(const char* text, const Rectangle& clip, unsigned int siz
     }
 
     const char* token = text;
-    std::vector<bool> emptyLines;
-    std::vector<Vector2> lines;
+    std::vector<bool, FrameAllocator<bool> > emptyLines;
+    std::vector<Vector2, FrameAllocator<Vector2> > lines;
 
     unsigned int lineWidth = 0;
     int yPos = clip.y + size;
@@ -1094,7 +1198,7 @@ void Font::measureText(const char* text, const Rectangle& clip, unsigned int siz
 }
 
 void Font::getMeasurementInfo(const char* text, const Rectangle& area, unsigned int size, Justify justify, bool wrap, bool rightToLeft,
-        std::vector<int>* xPositions, int* yPosition, std::vector<unsigned int>* lineLengths)
+        std::vector<int, FrameAllocator<int> >* xPositions, int* yPosition, std::vector<unsigned int, FrameAllocator<unsigned int> >* lineLengths)
 {
     GP_ASSERT(_size);
     GP_ASSERT(text);
@@ -1302,13 +1406,13 @@ int Font::getIndexOrLocation(const char* text, const Rectangle& area, unsigned i
     float scale = (float)size / _size;
     int yPos = area.y;
     const float areaHeight = area.height - size;
-    std::vector<int> xPositions;
-    std::vector<unsigned int> lineLengths;
+    std::vector<int, FrameAllocator<int> > xPositions;
+    std::vector<unsigned int, FrameAllocator<unsigned int> > lineLengths;
 
     getMeasurementInfo(text, area, size, justify, wrap, rightToLeft, &xPositions, &yPos, &lineLengths);
 
     int xPos = area.x;
-    std::vector<int>::const_iterator xPositionsIt = xPositions.begin();
+    std::vector<int, FrameAllocator<int> >::const_iterator xPositionsIt = xPositions.begin();
     if (xPositionsIt != xPositions.end())
     {
         xPos = *xPositionsIt++;
@@ -1320,7 +1424,7 @@ int Font::getIndexOrLocation(const char* text, const Rectangle& area, unsigned i
     unsigned int lineLength;
     unsigned int currentLineLength = 0;
     const char* lineStart;
-    std::vector<unsigned int>::const_iterator lineLengthsIt;
+    std::vector<unsigned int, FrameAllocator<unsigned int> >::const_iterator lineLengthsIt;
     if (rightToLeft)
     {
         lineStart = token;
@@ -1576,7 +1680,7 @@ unsigned int Font::getReversedTokenLength(const char* token, const char* bufStar
 }
 
 int Font::handleDelimiters(const char** token, const unsigned int size, const int iteration, const int areaX, int* xPos, int* yPos, unsigned int* lineLength,
-                          std::vector<int>::const_iterator* xPositionsIt, std::vector<int>::const_iterator xPositionsEnd, unsigned int* charIndex,
+                          std::vector<int, FrameAllocator<int> >::const_iterator* xPositionsIt, std::vector<int, FrameAllocator<int> >::const_iterator xPositionsEnd, unsigned int* charIndex,
                           const Vector2* stopAtPosition, const int currentIndex, const int destIndex)
 {
     GP_ASSERT(token);
@@ -1659,7 +1763,7 @@ int Font::handleDelimiters(const char** token, const unsigned int size, const in
 }
 
 void Font::addLineInfo(const Rectangle& area, int lineWidth, int lineLength, Justify hAlign,
-                       std::vector<int>* xPositions, std::vector<unsigned int>* lineLengths, bool rightToLeft)
+                       std::vector<int, FrameAllocator<int> >* xPositions, std::vector<unsigned int, FrameAllocator<unsigned int> >* lineLengths, bool rightToLeft)
 {
     int hWhitespace = area.width - lineWidth;
     if (hAlign == ALIGN_HCENTER)
@@ -1680,6 +1784,92 @@ void Font::addLineInfo(const Rectangle& area, int lineWidth, int lineLength, Jus
     }
 }
 
+int Font::layoutParagraph(const char* text, unsigned int start, const Rectangle& area, unsigned int size, int* yPosition,
+                          Vector2* locations, int* right)
+{
+    GP_ASSERT(text);
+    GP_ASSERT(yPosition);
+    GP_ASSERT(locations);
+    GP_ASSERT(right);
+    GP_ASSERT(_glyphs);
+
+    if (size == 0)
+        size = _size;
+    GP_ASSERT(_size);
+
+    // The characters are placed as layoutText() places them when it draws the string.
+    float scale = (float)size / _size;
+    int xPos = area.x;
+    int yPos = *yPosition;
+    *right = xPos;
+    unsigned int i = start;
+    while (true)
+    {
+        // Delimiters advance the position as in handleDelimiters().
+        char c = text[i];
+        while (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+        {
+            locations[i++].set(xPos, yPos);
+            if (c == ' ')
+            {
+                xPos += size >> 1;
+            }
+            else if (c == '\t')
+            {
+                xPos += (size >> 1)*4;
+            }
+            else
+            {
+                yPos += size;
+                xPos = area.x;
+                if (c == '\n')
+                {
+                    *yPosition = yPos;
+                    return (int)i;
+                }
+            }
+            c = text[i];
+        }
+
+        if (c == 0)
+        {
+            locations[i].set(xPos, yPos);
+            *yPosition = yPos;
+            return -1;
+        }
+
+        // Wrap the word to the next line if necessary.
+        unsigned int tokenLength = (unsigned int)strcspn(text + i, " \r\n\t");
+        unsigned int tokenWidth = getTokenWidth(text + i, tokenLength, size, scale);
+        if (xPos + (int)tokenWidth > area.x + area.width)
+        {
+            yPos += size;
+            xPos = area.x;
+        }
+
+        for (unsigned int end = i + tokenLength; i < end; ++i)
+        {
+            locations[i].set(xPos, yPos);
+            int glyphIndex = text[i] - 32; // HACK for ASCII
+            if (glyphIndex >= 0 && glyphIndex < (int)_glyphCount)
+            {
+                Glyph& g = _glyphs[glyphIndex];
+                if (xPos + (int)(g.width*scale) > area.x + area.width)
+                {
+                    // The rest of the line is truncated, so its characters are placed where it ends.
+                    for (; text[i] != 0 && text[i] != '\n'; ++i)
+                    {
+                        locations[i].set(xPos, yPos);
+                    }
+                    break;
+                }
+                xPos += floor(g.width*scale + (float)(size >> 3));
+            }
+        }
+        *right = std::max(*right, xPos);
+    }
+}
+
 SpriteBatch* Font::getSpriteBatch() const
 {
     return _batch;
@@ -1761,11 +1951,10 @@ Font::Justify Font::getJustify(const char* justify)
     return Font::ALIGN_TOP_LEFT;
 }
 
-Font::Text::Text(const char* text) : _text(text ? text : ""), _vertexCount(0), _vertices(NULL), _indexCount(0), _indices(NULL)
+Font::Text::Text(const char* text) : _text(text ? text : ""), _vertexCount(0), _vertices(NULL), _indexCount(0), _indices(NULL), _capacity(0),
+    _size(0), _justify(ALIGN_TOP_LEFT), _wrap(true), _rightToLeft(false), _clipped(false)
 {
-    const size_t length = strlen(text);
-    _vertices = new SpriteBatch::SpriteVertex[length * 4];
-    _indices = new unsigned short[((length - 1) * 6) + 4];
+    reserve(_text.length());
 }
 
 Font::Text::~Text()
@@ -1779,4 +1968,21 @@ const char* Font::Text::getText()
     return _text.c_str();
 }
 
+unsigned int Font::Text::getVertexCount() const
+{
+    return _vertexCount;
+}
+
+void Font::Text::reserve(unsigned int length)
+{
+    if (length <= _capacity)
+        return;
+
+    SAFE_DELETE_ARRAY(_vertices);
+    SAFE_DELETE_ARRAY(_indices);
+    _vertices = new SpriteBatch::SpriteVertex[length * 4];
+    _indices = new unsigned short[((length - 1) * 6) + 4];
+    _capacity = length;
+}
+
 }
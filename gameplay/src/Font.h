@@ -2,6 +2,7 @@
 #define FONT_H_
 
 #include "SpriteBatch.h"
+#include "FrameArena.h"
 
 namespace gameplay
 {
@@ -49,10 +50,31 @@ public:
         ALIGN_BOTTOM_RIGHT = ALIGN_BOTTOM | ALIGN_RIGHT
     };
 
+    /**
+     * Defines the formats of the glyph texture of a font.
+     */
+    enum Format
+    {
+        /**
+         * The texture holds the coverage of the glyphs at the font size.
+         */
+        BITMAP = 0,
+
+        /**
+         * The texture holds the distance of each texel to the outline of the glyphs,
+         * so the font can be drawn sharply at any size.
+         */
+        DISTANCE_FIELD = 1
+    };
+
     /**
      * Vertex coordinates, UVs and indices can be computed and stored in a Text object.
      * For static text labels that do not change frequently, this means these computations
      * need not be performed every frame.
+     *
+     * A Text object keeps the layout it was created with, so it can be kept up to date with
+     * Font::updateText(), which only lays the text out again when the string or the layout
+     * changes.
      */
     class Text
     {
@@ -74,6 +96,13 @@ public:
          */
         const char* getText();
 
+        /**
+         * Get the number of vertices computed for this Text object.
+         *
+         * @return The vertex count, which is zero if no characters are visible.
+         */
+        unsigned int getVertexCount() const;
+
     private:
         /**
          * Hidden copy constructor.
@@ -83,13 +112,26 @@ public:
          * Hidden copy assignment operator.
          */
         Text& operator=(const Text&);
+
+        /**
+         * Makes sure the vertex and index arrays can hold the characters of the string.
+         */
+        void reserve(unsigned int length);
         
         std::string _text;
         unsigned int _vertexCount;
         SpriteBatch::SpriteVertex* _vertices;
         unsigned int _indexCount;
         unsigned short* _indices;
+        unsigned int _capacity;
         Vector4 _color;
+        Rectangle _area;
+        unsigned int _size;
+        Justify _justify;
+        bool _wrap;
+        bool _rightToLeft;
+        bool _clipped;
+        Rectangle _clip;
     };
 
     /**
@@ -115,6 +157,13 @@ public:
      */
     unsigned int getSize();
 
+    /**
+     * Returns the format of the font's glyph texture.
+     *
+     * @return The format of the font.
+     */
+    Format getFormat() const;
+
     /**
      * Starts text drawing for this font.
      */
@@ -170,6 +219,18 @@ public:
      */
     void drawText(Text* text);
 
+    /**
+     * Draw a string from a precomputed Text object, transformed by a matrix.
+     *
+     * The transform is applied to the vertices of the text as they are batched,
+     * so a Text object can be moved, scaled or rotated without laying it out again.
+     *
+     * @param text The text to draw.
+     * @param transform The transform to apply to the text.
+     * @script{ignore}
+     */
+    void drawText(Text* text, const Matrix& transform);
+
     /**
      * Create an immutable Text object from a given string.
      * Vertex coordinates, UVs and indices will be computed and stored in the Text object.
@@ -190,6 +251,28 @@ public:
     Text* createText(const char* text, const Rectangle& area, const Vector4& color, unsigned int size = 0,
                      Justify justify = ALIGN_TOP_LEFT, bool wrap = true, bool rightToLeft = false, const Rectangle* clip = NULL);
 
+    /**
+     * Updates a Text object created by this font to display a string with a given layout.
+     *
+     * The text is only laid out again if the string, area, size, justification, wrapping,
+     * direction or clip differ from the ones it was last laid out with. A change of color
+     * only updates the colors of the existing vertices.
+     *
+     * @param text The Text object to update.
+     * @param str The string to display.
+     * @param area The viewport area to draw within.  Text will be clipped outside this rectangle.
+     * @param color The color of text.
+     * @param size The size to draw text (0 for default size).
+     * @param justify Justification of text within the viewport.
+     * @param wrap Wraps text to fit within the width of the viewport if true.
+     * @param rightToLeft Whether to draw text from right to left.
+     * @param clip A region to clip text within after applying justification to the viewport area.
+     *
+     * @return true if the text was laid out again, false if it was up to date.
+     */
+    bool updateText(Text* text, const char* str, const Rectangle& area, const Vector4& color, unsigned int size = 0,
+                    Justify justify = ALIGN_TOP_LEFT, bool wrap = true, bool rightToLeft = false, const Rectangle* clip = NULL);
+
     /**
      * Finishes text batching for this font and renders all drawn text.
      */
@@ -305,13 +388,17 @@ private:
      * @param glyphs An array of font glyphs, defining each character in the font within the texture map.
      * @param glyphCount The number of items in the glyph array.
      * @param texture A texture map containing rendered glyphs.
+     * @param format The format of the texture map.
      * 
      * @return The new Font.
      */
-    static Font* create(const char* family, Style style, unsigned int size, Glyph* glyphs, int glyphCount, Texture* texture);
+    static Font* create(const char* family, Style style, unsigned int size, Glyph* glyphs, int glyphCount, Texture* texture, Format format = BITMAP);
+
+    void layoutText(Text* batch, const Rectangle& area, const Vector4& color, unsigned int size, Justify justify,
+                    bool wrap, bool rightToLeft, const Rectangle* clip);
 
     void getMeasurementInfo(const char* text, const Rectangle& area, unsigned int size, Justify justify, bool wrap, bool rightToLeft,
-                            std::vector<int>* xPositions, int* yPosition, std::vector<unsigned int>* lineLengths);
+                            std::vector<int, FrameAllocator<int> >* xPositions, int* yPosition, std::vector<unsigned int, FrameAllocator<unsigned int> >* lineLengths);
 
     int getIndexOrLocation(const char* text, const Rectangle& clip, unsigned int size, const Vector2& inLocation, Vector2* outLocation,
                            const int destIndex = -1, Justify justify = ALIGN_TOP_LEFT, bool wrap = true, bool rightToLeft = false);
@@ -321,22 +408,45 @@ private:
     unsigned int getReversedTokenLength(const char* token, const char* bufStart);
 
     int handleDelimiters(const char** token, const unsigned int size, const int iteration, const int areaX, int* xPos, int* yPos, unsigned int* lineLength,
-                         std::vector<int>::const_iterator* xPositionsIt, std::vector<int>::const_iterator xPositionsEnd, unsigned int* charIndex = NULL,
+                         std::vector<int, FrameAllocator<int> >::const_iterator* xPositionsIt, std::vector<int, FrameAllocator<int> >::const_iterator xPositionsEnd, unsigned int* charIndex = NULL,
                          const Vector2* stopAtPosition = NULL, const int currentIndex = -1, const int destIndex = -1);
 
     void addLineInfo(const Rectangle& area, int lineWidth, int lineLength, Justify hAlign,
-                     std::vector<int>* xPositions, std::vector<unsigned int>* lineLengths, bool rightToLeft);
+                     std::vector<int, FrameAllocator<int> >* xPositions, std::vector<unsigned int, FrameAllocator<unsigned int> >* lineLengths, bool rightToLeft);
+
+    /**
+     * Lays out a paragraph of a string as it is drawn left to right from the top left of an
+     * area with wrapping, and stores the location of each of its characters.
+     *
+     * The paragraph begins a line and ends with a newline, or with the end of the string,
+     * whose location is stored as well. Since each paragraph starts on a new line, a string
+     * can be laid out again from the paragraph where it changed.
+     *
+     * @param text The string.
+     * @param start The index of the first character of the paragraph.
+     * @param area The area the string is drawn in.
+     * @param size The size of the font.
+     * @param yPosition The vertical position of the paragraph, which is advanced to that of the next one.
+     * @param locations The locations of the characters of the string, which are stored from start.
+     * @param right Destination for the rightmost position the words of the paragraph reach.
+     *
+     * @return The index of the next paragraph, or -1 if the paragraph ends the string.
+     */
+    int layoutParagraph(const char* text, unsigned int start, const Rectangle& area, unsigned int size, int* yPosition,
+                        Vector2* locations, int* right);
 
     std::string _path;
     std::string _id;
     std::string _family;
     Style _style;
     unsigned int _size;
+    Format _format;
     Glyph* _glyphs;
     unsigned int _glyphCount;
     Texture* _texture;
     SpriteBatch* _batch;
     Rectangle _viewport;
+    std::vector<SpriteBatch::SpriteVertex> _transformedVertices;
 };
 
 }
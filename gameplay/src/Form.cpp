@@ -1,4 +1,7 @@
 #include "Base.h"
+#include "DynamicResolution.h"
+#include "GPUProfiler.h"
+#include "RenderTargetPool.h"
 #include "Form.h"
 #include "AbsoluteLayout.h"
 #include "FlowLayout.h"
@@ -14,6 +17,9 @@
 #define FORM_VSH "res/shaders/form.vert"
 #define FORM_FSH "res/shaders/form.frag"
 
+// Maximum number of separate areas redrawn when a form changes
+#define FORM_DIRTY_REGIONS_MAX 4
+
 namespace gameplay
 {
 
@@ -21,14 +27,13 @@ static Effect* __formEffect = NULL;
 static std::vector<Form*> __forms;
 
 Form::Form() : _theme(NULL), _frameBuffer(NULL), _spriteBatch(NULL), _node(NULL),
-    _nodeQuad(NULL), _nodeMaterial(NULL) , _u2(0), _v1(0), _isGamepad(false)
+    _nodeQuad(NULL), _nodeMaterial(NULL) , _u2(0), _v1(0), _isGamepad(false), _directDraw(false)
 {
 }
 
 Form::~Form()
 {
-    SAFE_DELETE(_spriteBatch);
-    SAFE_RELEASE(_frameBuffer);
+    releaseFrameBuffer();
     SAFE_RELEASE(_theme);
 
     if (__formEffect)
@@ -150,6 +155,8 @@ Form* Form::create(const char* url)
     {
         style = theme->getEmptyStyle();
     }
+    // Read before the form is sized, so that a form that draws directly never acquires a framebuffer.
+    form->_directDraw = formProperties->getBool("directDraw", false);
     form->initialize(style, formProperties);
 
     form->_consumeInputEvents = formProperties->getBool("consumeInputEvents", false);
@@ -186,12 +193,105 @@ Form* Form::create(const char* url)
     SAFE_DELETE(properties);
     
     form->updateBounds();
+    form->_url = url;
 
     __forms.push_back(form);
 
     return form;
 }
 
+unsigned int Form::reloadFile(const char* path)
+{
+    GP_ASSERT(path);
+
+    // Reloading creates and destroys a form, which changes the list of forms.
+    std::vector<Form*> forms(__forms);
+    unsigned int count = 0;
+    for (size_t i = 0, size = forms.size(); i < size; ++i)
+    {
+        Form* form = forms[i];
+        GP_ASSERT(form);
+        if (!form->_url.empty() && form->_url.substr(0, form->_url.find('#')) == path && form->reload())
+            ++count;
+    }
+    return count;
+}
+
+void Form::getSourceFiles(std::set<std::string>& files)
+{
+    for (size_t i = 0, size = __forms.size(); i < size; ++i)
+    {
+        const std::string& url = __forms[i]->_url;
+        if (!url.empty())
+            files.insert(url.substr(0, url.find('#')));
+    }
+}
+
+bool Form::reload()
+{
+    Form* form = Form::create(_url.c_str());
+    if (form == NULL)
+    {
+        GP_WARN("Failed to reload form '%s'.", _url.c_str());
+        return false;
+    }
+    if (form->_theme != _theme)
+    {
+        GP_WARN("The theme of form '%s' changed; the form has to be created again.", _url.c_str());
+        SAFE_RELEASE(form);
+        return false;
+    }
+
+    form->moveListeners(this);
+    while (!_controls.empty())
+    {
+        removeControl((unsigned int)(_controls.size() - 1));
+    }
+    while (!form->_controls.empty())
+    {
+        // Keep the control alive between its removal from the new form and its addition to this one.
+        Control* control = form->_controls.front();
+        control->addRef();
+        form->removeControl((unsigned int)0);
+        addControl(control);
+        control->release();
+    }
+    std::swap(_layout, form->_layout);
+
+    _alignment = form->_alignment;
+    setStyle(form->getStyle());
+    setAutoWidth(form->getAutoWidth());
+    setAutoHeight(form->getAutoHeight());
+    setBounds(form->getBounds());
+    setConsumeInputEvents(form->getConsumeInputEvents());
+    setScroll(form->getScroll());
+    setScrollBarsAutoHide(form->isScrollBarsAutoHide());
+    SAFE_RELEASE(form);
+
+    updateBounds();
+    return true;
+}
+
+void Form::moveListeners(Container* container)
+{
+    GP_ASSERT(container);
+
+    const std::vector<Control*>& controls = container->getControls();
+    for (size_t i = 0, count = controls.size(); i < count; ++i)
+    {
+        Control* control = controls[i];
+        GP_ASSERT(control);
+        Control* replacement = strlen(control->getId()) > 0 ? getControl(control->getId()) : NULL;
+        if (replacement && control->_listeners && !replacement->_listeners)
+        {
+            replacement->_listeners = control->_listeners;
+            control->_listeners = NULL;
+        }
+        if (control->isContainer())
+            moveListeners((Container*)control);
+    }
+}
+
 Form* Form::getForm(const char* id)
 {
     std::vector<Form*>::const_iterator it;
@@ -227,45 +327,104 @@ void Form::setSize(float width, float height)
     if (width != 0.0f && height != 0.0f &&
         (width != _bounds.width || height != _bounds.height))
     {
-        // Width and height must be powers of two to create a texture.
-        unsigned int w = nextPowerOfTwo(width);
-        unsigned int h = nextPowerOfTwo(height);
-        _u2 = width / (float)w;
-        _v1 = height / (float)h;
-
-        // Create framebuffer if necessary. TODO: Use pool to cache.
-        if (_frameBuffer)
-            SAFE_RELEASE(_frameBuffer)
-        
-        _frameBuffer = FrameBuffer::create(_id.c_str(), w, h);
-        GP_ASSERT(_frameBuffer);
+        _bounds.width = width;
+        _bounds.height = height;
 
         // Re-create projection matrix.
         Matrix::createOrthographicOffCenter(0, width, height, 0, 0, 1, &_projectionMatrix);
 
+        if (usesFrameBuffer())
+        {
+            acquireFrameBuffer();
+        }
+    }
+    _bounds.width = width;
+    _bounds.height = height;
+    _dirty = true;
+}
+
+bool Form::usesFrameBuffer() const
+{
+    return _node || !_directDraw;
+}
+
+void Form::acquireFrameBuffer()
+{
+    if (_bounds.width == 0.0f || _bounds.height == 0.0f)
+        return;
+
+    // Width and height must be powers of two to create a texture.
+    unsigned int w = nextPowerOfTwo(_bounds.width);
+    unsigned int h = nextPowerOfTwo(_bounds.height);
+    _u2 = _bounds.width / (float)w;
+    _v1 = _bounds.height / (float)h;
+
+    // Acquire a framebuffer of the new size from the pool, unless the current one fits.
+    if (!_frameBuffer || _frameBuffer->getWidth() != w || _frameBuffer->getHeight() != h)
+    {
+        RenderTargetPool::release(_frameBuffer);
+        _frameBuffer = RenderTargetPool::acquire(w, h);
+        GP_ASSERT(_frameBuffer);
+        Texture* texture = _frameBuffer->getRenderTarget()->getTexture();
+
         // Re-create sprite batch.
         SAFE_DELETE(_spriteBatch);
-        _spriteBatch = SpriteBatch::create(_frameBuffer->getRenderTarget()->getTexture());
+        _spriteBatch = SpriteBatch::create(texture);
         GP_ASSERT(_spriteBatch);
 
-        // Clear the framebuffer black
-        Game* game = Game::getInstance();
-        FrameBuffer* previousFrameBuffer = _frameBuffer->bind();
-        Rectangle previousViewport = game->getViewport();
+        // Point the 3D quad at the new texture, since the previous one may now be reused.
+        if (_nodeMaterial)
+        {
+            Texture::Sampler* sampler = Texture::Sampler::create(texture);
+            GP_ASSERT(sampler);
+            sampler->setWrapMode(Texture::CLAMP, Texture::CLAMP);
+            _nodeMaterial->getParameter("u_texture")->setValue(sampler);
+            sampler->release();
+        }
+    }
 
-        game->setViewport(Rectangle(0, 0, width, height));
-        _theme->setProjectionMatrix(_projectionMatrix);
-        game->clear(Game::CLEAR_COLOR, Vector4::zero(), 1.0, 0);
-        _theme->setProjectionMatrix(_defaultProjectionMatrix);
+    // Clear the framebuffer black
+    Game* game = Game::getInstance();
+    FrameBuffer* previousFrameBuffer = _frameBuffer->bind();
+    Rectangle previousViewport = game->getViewport();
 
-        previousFrameBuffer->bind();
-        game->setViewport(previousViewport);
-    }
-    _bounds.width = width;
-    _bounds.height = height;
+    game->setViewport(Rectangle(0, 0, _bounds.width, _bounds.height));
+    _theme->setProjectionMatrix(_projectionMatrix);
+    game->clear(Game::CLEAR_COLOR, Vector4::zero(), 1.0, 0);
+    _theme->setProjectionMatrix(_defaultProjectionMatrix);
+
+    previousFrameBuffer->bind();
+    game->setViewport(previousViewport);
+
+    // The framebuffer holds none of the controls yet.
     _dirty = true;
 }
 
+void Form::releaseFrameBuffer()
+{
+    SAFE_DELETE(_spriteBatch);
+    RenderTargetPool::release(_frameBuffer);
+    _frameBuffer = NULL;
+}
+
+void Form::setDirectDraw(bool directDraw)
+{
+    if (directDraw == _directDraw)
+        return;
+    _directDraw = directDraw;
+
+    if (usesFrameBuffer())
+        acquireFrameBuffer();
+    else
+        releaseFrameBuffer();
+    _dirty = true;
+}
+
+bool Form::isDirectDraw() const
+{
+    return _directDraw;
+}
+
 void Form::setBounds(const Rectangle& bounds)
 {
     setPosition(bounds.x, bounds.y);
@@ -335,6 +494,13 @@ void Form::setNode(Node* node)
     // If the user wants a custom node then we need to create a 3D quad
     if (node && node != _node)
     {
+        // Forms that draw directly only render into a framebuffer while they have a node.
+        if (!_frameBuffer)
+        {
+            acquireFrameBuffer();
+            GP_ASSERT(_frameBuffer);
+        }
+
         // Set this Form up to be 3D by initializing a quad.
         float x2 = _bounds.width;
         float y2 = _bounds.height;
@@ -387,6 +553,12 @@ void Form::setNode(Node* node)
         rsBlock->setBlendDst(RenderState::BLEND_ONE_MINUS_SRC_ALPHA);
     }
     _node = node;
+
+    if (!usesFrameBuffer())
+    {
+        releaseFrameBuffer();
+        _dirty = true;
+    }
 }
 
 void Form::update(float elapsedTime)
@@ -406,15 +578,13 @@ void Form::update(float elapsedTime)
         }
         else
         {
-            _layout->update(this, Vector2::zero());
+            updateLayout(Vector2::zero());
         }
     }
 }
 
 void Form::updateBounds()
 {   
-    _clearBounds.set(_absoluteClipBounds);
-
     // Calculate the clipped bounds.
     float x = 0;
     float y = 0;
@@ -500,10 +670,6 @@ void Form::updateBounds()
     _absoluteClipBounds.set(x - border.left - padding.left, y - border.top - padding.top,
                             width + border.left + padding.left + border.right + padding.right,
                             height + border.top + padding.top + border.bottom + padding.bottom);
-    if (_clearBounds.isEmpty())
-    {
-        _clearBounds.set(_absoluteClipBounds);
-    }
 
     // Get scrollbar images and diminish clipping bounds to make room for scrollbars.
     if ((_scroll & SCROLL_HORIZONTAL) == SCROLL_HORIZONTAL)
@@ -527,6 +693,20 @@ void Form::updateBounds()
 
 void Form::draw()
 {
+    GP_GPU_PROFILE("forms");
+
+    // Forms in screen space are drawn at the native resolution, over the upscaled scene.
+    if (!_node)
+    {
+        DynamicResolution::resolve();
+    }
+
+    if (!usesFrameBuffer())
+    {
+        drawDirect();
+        return;
+    }
+
     // The first time a form is drawn, its contents are rendered into a framebuffer.
     // The framebuffer will only be drawn into again when the contents of the form change.
     // If this form has a node then it's a 3D form and the framebuffer will be used
@@ -536,7 +716,15 @@ void Form::draw()
     // to render the contents of the framebuffer directly to the display.
 
     // Check whether this form has changed since the last call to draw() and if so, render into the framebuffer.
+    // Only the areas covered by the controls that changed are cleared and redrawn; the rest of the
+    // framebuffer is kept from the previous draw.
+    std::vector<Rectangle, FrameAllocator<Rectangle> > regions;
     if (isDirty())
+    {
+        addDirtyRegions(&regions);
+        mergeDirtyRegions(&regions);
+    }
+    if (!regions.empty())
     {
         GP_ASSERT(_frameBuffer);
         FrameBuffer* previousFrameBuffer = _frameBuffer->bind();
@@ -547,13 +735,17 @@ void Form::draw()
 
         GP_ASSERT(_theme);
         _theme->setProjectionMatrix(_projectionMatrix);
-        
-        // By setting needsClear to true here, an optimization meant to clear and redraw only areas of the form
-        // that have changed is disabled.  Currently, repositioning controls can result in areas of the screen being cleared
-        // after another control has been drawn there.  This should probably be done in two passes -- one to clear areas where
-        // dirty controls were last frame, and another to draw them where they are now.
-        Container::draw(_theme->getSpriteBatch(), Rectangle(0, 0, _bounds.width, _bounds.height),
-                        /*_skin != NULL*/ true, false, _bounds.height);
+
+        // The scissor test keeps the controls that overlap a region from drawing outside of it.
+        GL_ASSERT( glEnable(GL_SCISSOR_TEST) );
+        for (size_t i = 0, count = regions.size(); i < count; ++i)
+        {
+            const Rectangle& region = regions[i];
+            GL_ASSERT( glScissor(region.x, _bounds.height - region.y - region.height, region.width, region.height) );
+            game->clear(Game::CLEAR_COLOR, Vector4::zero(), 1.0f, 0);
+            Container::draw(_theme->getSpriteBatch(), Rectangle(0, 0, _bounds.width, _bounds.height), region);
+        }
+        GL_ASSERT( glDisable(GL_SCISSOR_TEST) );
         _theme->setProjectionMatrix(_defaultProjectionMatrix);
 
         // Restore the previous game viewport.
@@ -582,6 +774,85 @@ void Form::draw()
     }
 }
 
+void Form::drawDirect()
+{
+    Game* game = Game::getInstance();
+    GP_ASSERT(_theme);
+
+    // Offset the projection by the position of the form, so that the controls are drawn
+    // with the same coordinates as in a framebuffer.
+    Matrix projection;
+    Matrix::createOrthographicOffCenter(-_bounds.x, game->getWidth() - _bounds.x, game->getHeight() - _bounds.y, -_bounds.y, 0, 1, &projection);
+    _theme->setProjectionMatrix(projection);
+
+    // The scissor test clips the controls to the bounds of the form, as a framebuffer would.
+    float left = std::max(floorf(_bounds.x), 0.0f);
+    float top = std::max(floorf(_bounds.y), 0.0f);
+    float right = std::min(ceilf(_bounds.right()), (float)game->getWidth());
+    float bottom = std::min(ceilf(_bounds.bottom()), (float)game->getHeight());
+    if (right > left && bottom > top)
+    {
+        GL_ASSERT( glEnable(GL_SCISSOR_TEST) );
+        GL_ASSERT( glScissor(left, game->getHeight() - bottom, right - left, bottom - top) );
+        Rectangle bounds(0, 0, _bounds.width, _bounds.height);
+        Container::draw(_theme->getSpriteBatch(), bounds, bounds);
+        GL_ASSERT( glDisable(GL_SCISSOR_TEST) );
+    }
+
+    _theme->setProjectionMatrix(_defaultProjectionMatrix);
+}
+
+void Form::mergeDirtyRegions(std::vector<Rectangle, FrameAllocator<Rectangle> >* regions) const
+{
+    GP_ASSERT(regions);
+
+    // Snap the regions to whole pixels within the form, since they are used as scissor rectangles.
+    std::vector<Rectangle, FrameAllocator<Rectangle> >& r = *regions;
+    for (size_t i = 0; i < r.size(); )
+    {
+        float left = std::max(floorf(r[i].x), 0.0f);
+        float top = std::max(floorf(r[i].y), 0.0f);
+        float right = std::min(ceilf(r[i].right()), _bounds.width);
+        float bottom = std::min(ceilf(r[i].bottom()), _bounds.height);
+        if (right <= left || bottom <= top)
+        {
+            r.erase(r.begin() + i);
+            continue;
+        }
+        r[i].set(left, top, right - left, bottom - top);
+        ++i;
+    }
+
+    // Combine overlapping regions, so that no area is drawn twice.
+    for (bool merged = true; merged; )
+    {
+        merged = false;
+        for (size_t i = 0; i < r.size() && !merged; ++i)
+        {
+            for (size_t j = i + 1; j < r.size(); ++j)
+            {
+                if (r[i].intersects(r[j]))
+                {
+                    Rectangle::combine(r[i], r[j], &r[i]);
+                    r.erase(r.begin() + j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Each region is a pass over the controls, so redraw a single area when there are many.
+    if (r.size() > FORM_DIRTY_REGIONS_MAX)
+    {
+        for (size_t i = 1, count = r.size(); i < count; ++i)
+        {
+            Rectangle::combine(r[0], r[i], &r[0]);
+        }
+        r.resize(1);
+    }
+}
+
 const char* Form::getType() const
 {
     return "form";
@@ -589,6 +860,8 @@ const char* Form::getType() const
 
 void Form::updateInternal(float elapsedTime)
 {
+    resetLayoutCounts();
+
     size_t size = __forms.size();
     for (size_t i = 0; i < size; ++i)
     {
@@ -34,6 +34,7 @@ class Theme;
         width      = <width>               // Can be used in place of 'size', e.g. with 'autoHeight = true'
         height     = <height>              // Can be used in place of 'size', e.g. with 'autoWidth = true'
         consumeEvents = <bool>             // Whether the form propagates input events to the Game's input event handler. Default is false
+        directDraw = <bool>                // Whether the form is drawn straight to the screen rather than through a framebuffer. Default is false
       
         // All the nested controls within this form.
         container { }
@@ -84,6 +85,30 @@ public:
      * @return A form with the given ID, or null if one was not found.
      */
     static Form* getForm(const char* id);
+
+    /**
+     * Reloads the forms created from the specified form file.
+     *
+     * The controls of each form are created again from the file, and replace its controls.
+     * The listeners of the controls are moved to the new controls that have the same id, but
+     * any other pointer to a control of the form has to be looked up again. A form whose theme
+     * changed is not reloaded.
+     *
+     * @param path The path of the form file that changed.
+     *
+     * @return The number of forms that were reloaded.
+     * @see HotReloader
+     * @script{ignore}
+     */
+    static unsigned int reloadFile(const char* path);
+
+    /**
+     * Adds the files of the forms created from files to a set.
+     *
+     * @param files The set to add the files to.
+     * @script{ignore}
+     */
+    static void getSourceFiles(std::set<std::string>& files);
     
     /**
      * Gets the theme for the form.
@@ -147,6 +172,32 @@ public:
      */
     void setNode(Node* node);
 
+    /**
+     * Sets whether the form draws its controls straight to the screen.
+     *
+     * By default, a form renders its controls into a framebuffer of its own, rounded up to
+     * powers of two, and only redraws the controls that changed, which is then drawn as a
+     * textured quad. On high resolution displays a HUD of several forms spends a lot of
+     * video memory on those framebuffers and a full-screen blit on each of them. A form that
+     * draws directly draws all its controls every frame through the sprite batch shared by
+     * its theme, clipped to its bounds with the scissor test, and has no framebuffer.
+     *
+     * Forms attached to a node always render into a framebuffer, which textures their quad.
+     *
+     * @param directDraw true to draw the controls straight to the screen, false to render them into a framebuffer.
+     * @script{ignore}
+     */
+    void setDirectDraw(bool directDraw);
+
+    /**
+     * Determines whether the form draws its controls straight to the screen.
+     *
+     * @return true if the form draws directly, false if it renders into a framebuffer.
+     * @see setDirectDraw
+     * @script{ignore}
+     */
+    bool isDirectDraw() const;
+
     /**
      * Updates each control within this form, and positions them according to its layout.
      */
@@ -186,11 +237,39 @@ private:
      */
     void initializeQuad(Mesh* mesh);
 
+    /**
+     * Determines whether the form renders into a framebuffer, which it does unless it
+     * draws directly and is not attached to a node.
+     */
+    bool usesFrameBuffer() const;
+
+    /**
+     * Acquires a framebuffer that fits the size of the form and clears it.
+     */
+    void acquireFrameBuffer();
+
+    /**
+     * Releases the framebuffer and the sprite batch that draws it.
+     */
+    void releaseFrameBuffer();
+
+    /**
+     * Draws the controls straight to the screen, clipped to the bounds of the form.
+     */
+    void drawDirect();
+
     /**
      * Update this form's bounds.
      */
     void updateBounds();
 
+    /**
+     * Snaps the dirty regions of the form to whole pixels and combines the ones that overlap.
+     *
+     * @param regions The dirty regions.
+     */
+    void mergeDirtyRegions(std::vector<Rectangle, FrameAllocator<Rectangle> >* regions) const;
+
     /**
      * Updates all visible, enabled forms.
      */
@@ -246,6 +325,16 @@ private:
      */
     bool projectPoint(int x, int y, Vector3* point);
 
+    /**
+     * Creates the form again from its URL, and takes the controls and layout of the new form.
+     */
+    bool reload();
+
+    /**
+     * Moves the listeners of the controls of a container to the controls of this form that have the same id.
+     */
+    void moveListeners(Container* container);
+
     Theme* _theme;                      // The Theme applied to this Form.
     FrameBuffer* _frameBuffer;          // FBO the Form is rendered into for texturing the quad. 
     SpriteBatch* _spriteBatch;
@@ -257,6 +346,8 @@ private:
     Matrix _projectionMatrix;           // Orthographic projection matrix to be set on SpriteBatch objects when rendering into the FBO.
     Matrix _defaultProjectionMatrix;
     bool _isGamepad;
+    bool _directDraw;                   // Whether the controls are drawn straight to the screen when the form has no node.
+    std::string _url;                   // The URL the form was created from, if any.
 };
 
 }
@@ -0,0 +1,189 @@
+#include "Base.h"
+#include "FrameArena.h"
+#include "Mutex.h"
+
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
+
+// The size of the first block of each thread's arena.
+#define FRAME_ARENA_BLOCK_SIZE 65536
+
+namespace gameplay
+{
+
+static FrameArena* __frameArena = NULL;
+
+struct FrameArena::ThreadKey
+{
+#ifdef WIN32
+    DWORD handle;
+    ThreadKey() { handle = TlsAlloc(); }
+    ~ThreadKey() { TlsFree(handle); }
+    void* get() const { return TlsGetValue(handle); }
+    void set(void* value) { TlsSetValue(handle, value); }
+#else
+    pthread_key_t handle;
+    ThreadKey() { pthread_key_create(&handle, NULL); }
+    ~ThreadKey() { pthread_key_delete(handle); }
+    void* get() const { return pthread_getspecific(handle); }
+    void set(void* value) { pthread_setspecific(handle, value); }
+#endif
+};
+
+/**
+ * The memory of one thread. When the block is full, it is kept until the end of the frame
+ * and a larger one is allocated, and at the end of the frame the blocks are replaced by a
+ * single block large enough for the whole frame.
+ */
+struct FrameArena::Arena
+{
+    char* block;
+    size_t size;
+    size_t used;
+    size_t allocated;               // The bytes allocated this frame, over all the blocks.
+    std::vector<char*> fullBlocks;  // The blocks that were filled this frame.
+
+    Arena() : block(NULL), size(0), used(0), allocated(0) { }
+
+    ~Arena()
+    {
+        for (size_t i = 0, count = fullBlocks.size(); i < count; ++i)
+        {
+            SAFE_DELETE_ARRAY(fullBlocks[i]);
+        }
+        SAFE_DELETE_ARRAY(block);
+    }
+};
+
+FrameArena::FrameArena()
+    : _mutex(NULL), _peakSize(0), _key(NULL)
+{
+    _mutex = new Mutex();
+    _key = new ThreadKey();
+    __frameArena = this;
+}
+
+FrameArena::~FrameArena()
+{
+    for (size_t i = 0, count = _arenas.size(); i < count; ++i)
+    {
+        SAFE_DELETE(_arenas[i]);
+    }
+    SAFE_DELETE(_key);
+    SAFE_DELETE(_mutex);
+    if (__frameArena == this)
+        __frameArena = NULL;
+}
+
+FrameArena* FrameArena::getInstance()
+{
+    return __frameArena;
+}
+
+FrameArena::Arena* FrameArena::getArena()
+{
+    Arena* arena = (Arena*)_key->get();
+    if (arena == NULL)
+    {
+        arena = new Arena();
+        _mutex->lock();
+        _arenas.push_back(arena);
+        _mutex->unlock();
+        _key->set(arena);
+    }
+    return arena;
+}
+
+static size_t getAlignedOffset(const char* block, size_t used, size_t alignment)
+{
+    size_t address = ((size_t)(block + used) + alignment - 1) & ~(alignment - 1);
+    return address - (size_t)block;
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment)
+{
+    GP_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    Arena* arena = getArena();
+    size_t offset = getAlignedOffset(arena->block, arena->used, alignment);
+    if (arena->block == NULL || offset + size > arena->size)
+    {
+        // Keep the full block until the end of the frame, since its memory is still in use.
+        if (arena->block)
+            arena->fullBlocks.push_back(arena->block);
+        size_t blockSize = arena->size > 0 ? arena->size * 2 : FRAME_ARENA_BLOCK_SIZE;
+        while (blockSize < size + alignment)
+            blockSize *= 2;
+        arena->block = new char[blockSize];
+        arena->size = blockSize;
+        offset = getAlignedOffset(arena->block, 0, alignment);
+    }
+    arena->used = offset + size;
+    arena->allocated += size;
+    return arena->block + offset;
+}
+
+void FrameArena::deallocate(void* p, size_t size)
+{
+    if (p == NULL)
+        return;
+
+    Arena* arena = getArena();
+    if ((char*)p + size == arena->block + arena->used)
+    {
+        arena->used = (char*)p - arena->block;
+        arena->allocated -= size;
+    }
+}
+
+size_t FrameArena::getAllocatedSize() const
+{
+    size_t size = 0;
+    _mutex->lock();
+    for (size_t i = 0, count = _arenas.size(); i < count; ++i)
+    {
+        size += _arenas[i]->allocated;
+    }
+    _mutex->unlock();
+    return size;
+}
+
+size_t FrameArena::getPeakSize() const
+{
+    return _peakSize;
+}
+
+void FrameArena::reset()
+{
+    size_t size = getAllocatedSize();
+    if (size > _peakSize)
+        _peakSize = size;
+
+    _mutex->lock();
+    for (size_t i = 0, count = _arenas.size(); i < count; ++i)
+    {
+        Arena* arena = _arenas[i];
+        if (!arena->fullBlocks.empty())
+        {
+            // The frame did not fit in one block: replace the blocks with one that holds them all.
+            // Each block is twice as large as the one before, so the sum of their sizes is less
+            // than twice the size of the last one.
+            for (size_t j = 0, blockCount = arena->fullBlocks.size(); j < blockCount; ++j)
+            {
+                SAFE_DELETE_ARRAY(arena->fullBlocks[j]);
+            }
+            arena->fullBlocks.clear();
+            SAFE_DELETE_ARRAY(arena->block);
+            arena->size *= 2;
+            arena->block = new char[arena->size];
+        }
+        arena->used = 0;
+        arena->allocated = 0;
+    }
+    _mutex->unlock();
+}
+
+}
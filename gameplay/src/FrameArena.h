@@ -0,0 +1,190 @@
+#ifndef FRAMEARENA_H_
+#define FRAMEARENA_H_
+
+namespace gameplay
+{
+
+class Mutex;
+
+/**
+ * Defines a linear allocator for memory that is only needed during one frame.
+ *
+ * Each thread allocates from its own arena by moving a pointer forward, and nothing is
+ * freed individually: all the arenas are reset at the start of each frame, which makes
+ * the memory allocated during the previous frame available again. This is used for the
+ * temporary arrays built while laying out text or drawing forms, which would otherwise
+ * be allocated on the heap many times per frame, through FrameAllocator.
+ *
+ * The game owns the frame arena. Memory allocated from it must not be used after the
+ * frame it was allocated in, and destructors of objects placed in it are not called
+ * by the arena. Work that runs across frames, such as asynchronous loading, must use
+ * the heap instead.
+ *
+ * @script{ignore}
+ */
+class FrameArena
+{
+    friend class Game;
+
+public:
+
+    /**
+     * Returns the frame arena of the game.
+     *
+     * @return The frame arena, or NULL when there is no game.
+     */
+    static FrameArena* getInstance();
+
+    /**
+     * Allocates memory in the arena of the calling thread.
+     *
+     * @param size The number of bytes to allocate.
+     * @param alignment The alignment of the memory, which must be a power of two.
+     *
+     * @return The memory, which is valid until the next frame starts.
+     */
+    void* allocate(size_t size, size_t alignment = sizeof(double));
+
+    /**
+     * Frees memory allocated in the arena of the calling thread.
+     *
+     * Memory is only reused before the next frame when it was the last allocation of the
+     * calling thread, which is the case for arrays grown one after the other.
+     *
+     * @param p The memory to free, or NULL.
+     * @param size The number of bytes that were allocated.
+     */
+    void deallocate(void* p, size_t size);
+
+    /**
+     * Returns the number of bytes allocated by all the threads during the current frame.
+     *
+     * @return The size of the memory allocated this frame.
+     */
+    size_t getAllocatedSize() const;
+
+    /**
+     * Returns the largest number of bytes allocated during one frame.
+     *
+     * @return The largest size of the memory allocated in a frame.
+     */
+    size_t getPeakSize() const;
+
+private:
+
+    struct ThreadKey;
+    struct Arena;
+
+    /**
+     * Constructor.
+     */
+    FrameArena();
+
+    /**
+     * Hidden copy constructor.
+     */
+    FrameArena(const FrameArena& copy);
+
+    /**
+     * Destructor.
+     */
+    ~FrameArena();
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    FrameArena& operator=(const FrameArena&);
+
+    /**
+     * Makes all the memory of the arenas available again. Called by the game at the start of each frame.
+     */
+    void reset();
+
+    /**
+     * Returns the arena of the calling thread, creating it the first time the thread allocates.
+     */
+    Arena* getArena();
+
+    Mutex* _mutex;                  // Guards _arenas.
+    std::vector<Arena*> _arenas;    // The arenas of all the threads that allocated.
+    size_t _peakSize;               // The largest size allocated in one frame.
+    ThreadKey* _key;                // The thread-local storage key of the arenas.
+};
+
+// The DebugNew macro would turn the placement new below into a placement new with a file and line.
+#ifdef GAMEPLAY_MEM_LEAK_DETECTION
+#undef new
+#endif
+
+/**
+ * Defines an STL allocator that allocates from the FrameArena.
+ *
+ * This is used for containers that are only used during one frame, such as the arrays of
+ * a function that is called every frame, so that they do not allocate from the heap.
+ * Containers using it must be destroyed before the frame ends.
+ *
+ * @script{ignore}
+ */
+template <class T>
+class FrameAllocator
+{
+public:
+
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template <class U>
+    struct rebind
+    {
+        typedef FrameAllocator<U> other;
+    };
+
+    FrameAllocator() : _arena(FrameArena::getInstance()) { }
+
+    FrameAllocator(const FrameAllocator& copy) : _arena(copy._arena) { }
+
+    template <class U>
+    FrameAllocator(const FrameAllocator<U>& copy) : _arena(copy._arena) { }
+
+    pointer address(reference x) const { return &x; }
+
+    const_pointer address(const_reference x) const { return &x; }
+
+    pointer allocate(size_type n, const void* hint = 0)
+    {
+        return (pointer)(_arena ? _arena->allocate(n * sizeof(T)) : ::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(pointer p, size_type n)
+    {
+        if (_arena)
+            _arena->deallocate(p, n * sizeof(T));
+        else
+            ::operator delete(p);
+    }
+
+    size_type max_size() const { return ((size_type)-1) / sizeof(T); }
+
+    void construct(pointer p, const T& value) { ::new((void*)p) T(value); }
+
+    void destroy(pointer p) { p->~T(); }
+
+    bool operator==(const FrameAllocator& other) const { return _arena == other._arena; }
+
+    bool operator!=(const FrameAllocator& other) const { return _arena != other._arena; }
+
+    FrameArena* _arena;
+};
+
+#ifdef GAMEPLAY_MEM_LEAK_DETECTION
+#define new DEBUG_NEW
+#endif
+
+}
+
+#endif
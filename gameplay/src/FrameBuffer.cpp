@@ -1,9 +1,21 @@
 #include "Base.h"
+#include "GLStateCache.h"
 #include "FrameBuffer.h"
 #include "Game.h"
 
 #define FRAMEBUFFER_ID_DEFAULT "org.gameplay3d.framebuffer.default"
 
+// The attachments of the window-system provided frame buffer, as named by the discard function.
+#if defined(USE_DISCARD_FRAMEBUFFER)
+#define FRAMEBUFFER_DEFAULT_COLOR GL_COLOR_EXT
+#define FRAMEBUFFER_DEFAULT_DEPTH GL_DEPTH_EXT
+#define FRAMEBUFFER_DEFAULT_STENCIL GL_STENCIL_EXT
+#elif defined(USE_INVALIDATE_FRAMEBUFFER)
+#define FRAMEBUFFER_DEFAULT_COLOR GL_COLOR
+#define FRAMEBUFFER_DEFAULT_DEPTH GL_DEPTH
+#define FRAMEBUFFER_DEFAULT_STENCIL GL_STENCIL
+#endif
+
 namespace gameplay
 {
 
@@ -14,7 +26,8 @@ FrameBuffer* FrameBuffer::_currentFrameBuffer = NULL;
 
 FrameBuffer::FrameBuffer(const char* id, unsigned int width, unsigned int height, FrameBufferHandle handle) :
     _id(id ? id : ""), _width(width), _height(height), _handle(handle), 
-    _renderTargets(NULL), _renderTargetCount(0), _depthStencilTarget(NULL)
+    _renderTargets(NULL), _renderTargetCount(0), _depthStencilTarget(NULL),
+    _loadDiscard(0), _storeDiscard(0)
 {
 }
 
@@ -39,7 +52,7 @@ FrameBuffer::~FrameBuffer()
     // Release GL resource.
     if (_handle)
     {
-        GL_ASSERT( glDeleteFramebuffers(1, &_handle) );
+        GLStateCache::deleteFramebuffers(1, &_handle);
     }
 
     // Remove self from vector.
@@ -57,6 +70,7 @@ void FrameBuffer::initialize()
     GLint fbo;
     glGetIntegerv(GL_FRAMEBUFFER_BINDING, &fbo);
     _defaultFrameBuffer = new FrameBuffer(FRAMEBUFFER_ID_DEFAULT, 0, 0, (FrameBufferHandle)fbo);
+    _defaultFrameBuffer->_storeDiscard = DISCARD_DEPTH_STENCIL;
     _currentFrameBuffer = _defaultFrameBuffer;
 
     // Query the max supported color attachments. This glGet operation is not supported
@@ -180,7 +194,7 @@ void FrameBuffer::setRenderTarget(RenderTarget* target, unsigned int index)
         target->addRef();
 
         // Now set this target as the color attachment corresponding to index.
-        GL_ASSERT( glBindFramebuffer(GL_FRAMEBUFFER, _handle) );
+        GLStateCache::bindFramebuffer(_handle);
         GLenum attachment = GL_COLOR_ATTACHMENT0 + index;
         GL_ASSERT( glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, _renderTargets[index]->getTexture()->getHandle(), 0) );
         GLenum fboStatus = glCheckFramebufferStatus(GL_FRAMEBUFFER);
@@ -190,7 +204,7 @@ void FrameBuffer::setRenderTarget(RenderTarget* target, unsigned int index)
         }
 
         // Restore the FBO binding
-        GL_ASSERT( glBindFramebuffer(GL_FRAMEBUFFER, _currentFrameBuffer->_handle) );
+        GLStateCache::bindFramebuffer(_currentFrameBuffer->_handle);
     }
 
 }
@@ -226,7 +240,7 @@ void FrameBuffer::setDepthStencilTarget(DepthStencilTarget* target)
         target->addRef();
 
         // Now set this target as the color attachment corresponding to index.
-        GL_ASSERT( glBindFramebuffer(GL_FRAMEBUFFER, _handle) );
+        GLStateCache::bindFramebuffer(_handle);
 
         // Attach the render buffer to the framebuffer
         GL_ASSERT( glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _depthStencilTarget->_depthBuffer) );
@@ -247,7 +261,7 @@ void FrameBuffer::setDepthStencilTarget(DepthStencilTarget* target)
         }
 
         // Restore the FBO binding
-        GL_ASSERT( glBindFramebuffer(GL_FRAMEBUFFER, _currentFrameBuffer->_handle) );
+        GLStateCache::bindFramebuffer(_currentFrameBuffer->_handle);
     }
 }
 
@@ -263,16 +277,31 @@ bool FrameBuffer::isDefault() const
 
 FrameBuffer* FrameBuffer::bind()
 {
-    GL_ASSERT( glBindFramebuffer(GL_FRAMEBUFFER, _handle) );
     FrameBuffer* previousFrameBuffer = _currentFrameBuffer;
+    if (previousFrameBuffer == this)
+    {
+        GLStateCache::bindFramebuffer(_handle);
+        return previousFrameBuffer;
+    }
+
+    // The default frame buffer applies its discard flags at the frame boundaries instead.
+    if (previousFrameBuffer && previousFrameBuffer->_storeDiscard && !previousFrameBuffer->isDefault())
+    {
+        previousFrameBuffer->discard((previousFrameBuffer->_storeDiscard & DISCARD_COLOR) != 0,
+                                     (previousFrameBuffer->_storeDiscard & DISCARD_DEPTH_STENCIL) != 0);
+    }
+    GLStateCache::bindFramebuffer(_handle);
     _currentFrameBuffer = this;
+    if (_loadDiscard && !isDefault())
+    {
+        discard((_loadDiscard & DISCARD_COLOR) != 0, (_loadDiscard & DISCARD_DEPTH_STENCIL) != 0);
+    }
     return previousFrameBuffer;
 }
 
 FrameBuffer* FrameBuffer::bindDefault()
 {
-    GL_ASSERT( glBindFramebuffer(GL_FRAMEBUFFER, _defaultFrameBuffer->_handle) );
-    _currentFrameBuffer = _defaultFrameBuffer;
+    _defaultFrameBuffer->bind();
     return _defaultFrameBuffer;
 }
 
@@ -281,4 +310,115 @@ FrameBuffer* FrameBuffer::getCurrent()
     return _currentFrameBuffer;
 }
 
+#if defined(USE_DISCARD_FRAMEBUFFER) || defined(USE_INVALIDATE_FRAMEBUFFER)
+/**
+ * Determines whether the driver supports discarding the contents of frame buffers.
+ */
+static bool isDiscardSupported()
+{
+    static int __discardSupported = -1;
+    if (__discardSupported < 0)
+    {
+#ifdef USE_DISCARD_FRAMEBUFFER
+        const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+        __discardSupported = extensions && strstr(extensions, "GL_EXT_discard_framebuffer") ? 1 : 0;
+#else
+        __discardSupported = GLEW_VERSION_4_3 || GLEW_ARB_invalidate_subdata ? 1 : 0;
+#endif
+    }
+    return __discardSupported != 0;
+}
+#endif
+
+void FrameBuffer::discard(bool color, bool depthStencil)
+{
+    GP_ASSERT(_currentFrameBuffer == this);
+
+#if defined(USE_DISCARD_FRAMEBUFFER) || defined(USE_INVALIDATE_FRAMEBUFFER)
+    if (!isDiscardSupported())
+        return;
+
+    std::vector<GLenum> attachments;
+    if (isDefault() && _handle == 0)
+    {
+        if (color)
+            attachments.push_back(FRAMEBUFFER_DEFAULT_COLOR);
+        if (depthStencil)
+        {
+            attachments.push_back(FRAMEBUFFER_DEFAULT_DEPTH);
+            attachments.push_back(FRAMEBUFFER_DEFAULT_STENCIL);
+        }
+    }
+    else if (isDefault())
+    {
+        // A default frame buffer object created by the platform, whose targets are not known.
+        if (color)
+            attachments.push_back(GL_COLOR_ATTACHMENT0);
+        if (depthStencil)
+        {
+            attachments.push_back(GL_DEPTH_ATTACHMENT);
+            attachments.push_back(GL_STENCIL_ATTACHMENT);
+        }
+    }
+    else
+    {
+        for (unsigned int i = 0; color && _renderTargets && i < _maxRenderTargets; ++i)
+        {
+            if (_renderTargets[i])
+                attachments.push_back(GL_COLOR_ATTACHMENT0 + i);
+        }
+        if (depthStencil && _depthStencilTarget)
+        {
+            attachments.push_back(GL_DEPTH_ATTACHMENT);
+            if (_depthStencilTarget->getFormat() == DepthStencilTarget::DEPTH_STENCIL)
+                attachments.push_back(GL_STENCIL_ATTACHMENT);
+        }
+    }
+    if (!attachments.empty())
+    {
+#ifdef USE_DISCARD_FRAMEBUFFER
+        GL_ASSERT( glDiscardFramebuffer(GL_FRAMEBUFFER, (GLsizei)attachments.size(), &attachments[0]) );
+#else
+        GL_ASSERT( glInvalidateFramebuffer(GL_FRAMEBUFFER, (GLsizei)attachments.size(), &attachments[0]) );
+#endif
+    }
+#endif
+}
+
+void FrameBuffer::setLoadDiscard(unsigned int flags)
+{
+    _loadDiscard = flags;
+}
+
+unsigned int FrameBuffer::getLoadDiscard() const
+{
+    return _loadDiscard;
+}
+
+void FrameBuffer::setStoreDiscard(unsigned int flags)
+{
+    _storeDiscard = flags;
+}
+
+unsigned int FrameBuffer::getStoreDiscard() const
+{
+    return _storeDiscard;
+}
+
+void FrameBuffer::beginFrame()
+{
+    unsigned int flags = _defaultFrameBuffer->_loadDiscard;
+    if (flags && _currentFrameBuffer == _defaultFrameBuffer)
+        _defaultFrameBuffer->discard((flags & DISCARD_COLOR) != 0, (flags & DISCARD_DEPTH_STENCIL) != 0);
+}
+
+void FrameBuffer::endFrame()
+{
+    // Drawing to the display usually ends the frame; if another frame buffer is bound, the
+    // default one may still be drawn to in the next frame, so its contents are kept.
+    unsigned int flags = _defaultFrameBuffer->_storeDiscard;
+    if (flags && _currentFrameBuffer == _defaultFrameBuffer)
+        _defaultFrameBuffer->discard((flags & DISCARD_COLOR) != 0, (flags & DISCARD_DEPTH_STENCIL) != 0);
+}
+
 }
@@ -20,13 +20,29 @@ namespace gameplay
  * FrameBuffer::bind and restore it when you are finished drawing to your frame buffer.
  *
  * To bind the default frame buffer, call FrameBuffer::bindDefault.
+ *
+ * On tile-based GPUs, the targets of a frame buffer are loaded into tile memory when drawing
+ * to it starts and stored back when it ends. The load and store discard flags of a frame
+ * buffer tell the driver which of those copies are not needed (see setLoadDiscard and
+ * setStoreDiscard). By default, the depth and stencil of the default frame buffer are
+ * discarded at the end of each frame.
  */
 class FrameBuffer : public Ref
 {
     friend class Game;
+    friend class RenderTargetPool;
 
 public:
 
+    /**
+     * Flags for the targets of a frame buffer whose contents are discarded.
+     */
+    enum DiscardFlags
+    {
+        DISCARD_COLOR = 1,
+        DISCARD_DEPTH_STENCIL = 2
+    };
+
     /**
      * Creates a new, empty FrameBuffer object.
      *
@@ -164,6 +180,62 @@ public:
      * @return The currently bound FrameBuffer.
      */
     static FrameBuffer* getCurrent();
+
+    /**
+     * Tells the driver that the contents of the targets of this frame buffer are no longer
+     * needed, so that tile-based GPUs do not store them to memory after the draws to the
+     * frame buffer, nor load them into tile memory before the next draws.
+     *
+     * Discarding targets before drawing over all of them, or after the last draw that uses
+     * them, saves memory bandwidth. It is only a hint, which does nothing where neither
+     * EXT_discard_framebuffer nor glInvalidateFramebuffer is supported. The frame buffer
+     * must be bound.
+     *
+     * @param color True to discard the render targets.
+     * @param depthStencil True to discard the depth-stencil target.
+     * @script{ignore}
+     */
+    void discard(bool color, bool depthStencil);
+
+    /**
+     * Sets the targets whose contents are discarded when this frame buffer is bound, because
+     * they are cleared or drawn over completely before they are read.
+     *
+     * The load discard flags of the default frame buffer are applied at the start of each
+     * frame instead, since it stays bound across frames.
+     *
+     * @param flags A combination of DiscardFlags, or 0 to keep the contents of all targets.
+     * @script{ignore}
+     */
+    void setLoadDiscard(unsigned int flags);
+
+    /**
+     * Returns the targets whose contents are discarded when this frame buffer is bound.
+     *
+     * @return A combination of DiscardFlags.
+     * @script{ignore}
+     */
+    unsigned int getLoadDiscard() const;
+
+    /**
+     * Sets the targets whose contents are discarded when another frame buffer is bound in
+     * place of this one, because they are not read after drawing to this frame buffer ends.
+     *
+     * The store discard flags of the default frame buffer are applied at the end of each
+     * frame instead, if it is bound, and are DISCARD_DEPTH_STENCIL by default.
+     *
+     * @param flags A combination of DiscardFlags, or 0 to keep the contents of all targets.
+     * @script{ignore}
+     */
+    void setStoreDiscard(unsigned int flags);
+
+    /**
+     * Returns the targets whose contents are discarded when drawing to this frame buffer ends.
+     *
+     * @return A combination of DiscardFlags.
+     * @script{ignore}
+     */
+    unsigned int getStoreDiscard() const;
      
 private:
 
@@ -186,6 +258,16 @@ private:
 
     static void finalize();
 
+    /**
+     * Applies the load discard flags of the default frame buffer at the start of a frame.
+     */
+    static void beginFrame();
+
+    /**
+     * Applies the store discard flags of the default frame buffer at the end of a frame.
+     */
+    static void endFrame();
+
     static bool isPowerOfTwo(unsigned int value);
 
     std::string _id;
@@ -195,6 +277,8 @@ private:
     RenderTarget** _renderTargets;
     unsigned int _renderTargetCount;
     DepthStencilTarget* _depthStencilTarget;
+    unsigned int _loadDiscard;
+    unsigned int _storeDiscard;
 
     static unsigned int _maxRenderTargets;
     static std::vector<FrameBuffer*> _frameBuffers;
@@ -0,0 +1,387 @@
+#include "Base.h"
+#include "FrameGraph.h"
+#include "FrameBuffer.h"
+#include "RenderTargetPool.h"
+#include "Game.h"
+
+// The position of a target that is not used by any pass that is executed.
+#define FRAME_GRAPH_UNUSED 0xFFFFFFFF
+
+namespace gameplay
+{
+
+FrameGraph::FrameGraph()
+    : _compiled(false), _executing(false)
+{
+}
+
+FrameGraph::~FrameGraph()
+{
+    releaseFrameBuffers();
+}
+
+FrameGraph* FrameGraph::create()
+{
+    return new FrameGraph();
+}
+
+void FrameGraph::reset()
+{
+    GP_ASSERT(!_executing);
+
+    releaseFrameBuffers();
+    _targets.clear();
+    _passes.clear();
+    _order.clear();
+    _compiled = false;
+}
+
+unsigned int FrameGraph::createTarget(const char* name, unsigned int width, unsigned int height, Texture::Format format, bool depthStencil)
+{
+    GP_ASSERT(width > 0 && height > 0);
+
+    Target target;
+    target.name = name ? name : "";
+    target.width = width;
+    target.height = height;
+    target.format = format;
+    target.depthStencil = depthStencil;
+    target.imported = false;
+    target.frameBuffer = NULL;
+    target.firstUse = target.lastUse = target.firstWrite = target.lastWrite = FRAME_GRAPH_UNUSED;
+    _targets.push_back(target);
+    _compiled = false;
+    return (unsigned int)_targets.size() - 1;
+}
+
+unsigned int FrameGraph::importTarget(const char* name, FrameBuffer* frameBuffer)
+{
+    GP_ASSERT(frameBuffer);
+
+    Target target;
+    target.name = name ? name : "";
+    target.width = frameBuffer->getWidth();
+    target.height = frameBuffer->getHeight();
+    target.format = Texture::UNKNOWN;
+    target.depthStencil = false;
+    target.imported = true;
+    target.frameBuffer = frameBuffer;
+    target.firstUse = target.lastUse = target.firstWrite = target.lastWrite = FRAME_GRAPH_UNUSED;
+    _targets.push_back(target);
+    _compiled = false;
+    return (unsigned int)_targets.size() - 1;
+}
+
+unsigned int FrameGraph::addPass(const char* name, Listener* listener, void* cookie)
+{
+    GP_ASSERT(listener);
+
+    Pass pass;
+    pass.name = name ? name : "";
+    pass.listener = listener;
+    pass.cookie = cookie;
+    pass.write = -1;
+    pass.culled = false;
+    _passes.push_back(pass);
+    _compiled = false;
+    return (unsigned int)_passes.size() - 1;
+}
+
+void FrameGraph::read(unsigned int pass, unsigned int target)
+{
+    GP_ASSERT(pass < _passes.size());
+    GP_ASSERT(target < _targets.size());
+    GP_ASSERT(_passes[pass].write != (int)target);
+
+    _passes[pass].reads.push_back(target);
+    _compiled = false;
+}
+
+void FrameGraph::write(unsigned int pass, unsigned int target)
+{
+    GP_ASSERT(pass < _passes.size());
+    GP_ASSERT(target < _targets.size());
+    GP_ASSERT(_passes[pass].write < 0);
+
+    _passes[pass].write = (int)target;
+    _compiled = false;
+}
+
+void FrameGraph::getDependencies(unsigned int pass, bool ordering, std::vector<unsigned int>& dependencies) const
+{
+    const Pass& p = _passes[pass];
+
+    // A read depends on the writes added before it, or on all the writes if there are none.
+    for (size_t i = 0, count = p.reads.size(); i < count; ++i)
+    {
+        const int target = (int)p.reads[i];
+        bool found = false;
+        for (unsigned int j = 0; j < pass; ++j)
+        {
+            if (_passes[j].write == target)
+            {
+                dependencies.push_back(j);
+                found = true;
+            }
+        }
+        for (unsigned int j = pass + 1, passCount = (unsigned int)_passes.size(); !found && j < passCount; ++j)
+        {
+            if (_passes[j].write == target)
+                dependencies.push_back(j);
+        }
+    }
+
+    // A write draws over the writes added before it, after the reads added before it.
+    if (p.write >= 0)
+    {
+        for (unsigned int j = 0; j < pass; ++j)
+        {
+            const Pass& other = _passes[j];
+            if (other.write == p.write ||
+                (ordering && std::find(other.reads.begin(), other.reads.end(), (unsigned int)p.write) != other.reads.end()))
+            {
+                dependencies.push_back(j);
+            }
+        }
+    }
+}
+
+bool FrameGraph::compile()
+{
+    GP_ASSERT(!_executing);
+
+    const unsigned int passCount = (unsigned int)_passes.size();
+    const unsigned int targetCount = (unsigned int)_targets.size();
+    _order.clear();
+    _compiled = false;
+
+    // Keep the passes that write imported targets, and the passes they depend on.
+    std::vector<unsigned int> stack;
+    for (unsigned int i = 0; i < passCount; ++i)
+    {
+        Pass& pass = _passes[i];
+        pass.culled = pass.write < 0 || !_targets[pass.write].imported;
+        if (!pass.culled)
+            stack.push_back(i);
+    }
+    std::vector<unsigned int> dependencies;
+    while (!stack.empty())
+    {
+        const unsigned int pass = stack.back();
+        stack.pop_back();
+        dependencies.clear();
+        getDependencies(pass, false, dependencies);
+        for (size_t i = 0, count = dependencies.size(); i < count; ++i)
+        {
+            Pass& dependency = _passes[dependencies[i]];
+            if (dependency.culled)
+            {
+                dependency.culled = false;
+                stack.push_back(dependencies[i]);
+            }
+        }
+    }
+
+    // Order the passes that are kept, taking the first pass that was added whose dependencies
+    // have all been executed.
+    std::vector<unsigned int> remaining(passCount, 0);
+    std::vector<std::vector<unsigned int> > dependents(passCount);
+    unsigned int keptCount = 0;
+    for (unsigned int i = 0; i < passCount; ++i)
+    {
+        if (_passes[i].culled)
+            continue;
+        ++keptCount;
+        dependencies.clear();
+        getDependencies(i, true, dependencies);
+        std::sort(dependencies.begin(), dependencies.end());
+        dependencies.erase(std::unique(dependencies.begin(), dependencies.end()), dependencies.end());
+        for (size_t j = 0, count = dependencies.size(); j < count; ++j)
+        {
+            if (_passes[dependencies[j]].culled)
+                continue;
+            ++remaining[i];
+            dependents[dependencies[j]].push_back(i);
+        }
+    }
+    std::vector<bool> ordered(passCount, false);
+    while (_order.size() < keptCount)
+    {
+        unsigned int next = passCount;
+        for (unsigned int i = 0; i < passCount; ++i)
+        {
+            if (!_passes[i].culled && !ordered[i] && remaining[i] == 0)
+            {
+                next = i;
+                break;
+            }
+        }
+        if (next == passCount)
+        {
+            GP_ERROR("Failed to compile frame graph; its passes depend on each other in a cycle.");
+            _order.clear();
+            return false;
+        }
+        ordered[next] = true;
+        _order.push_back(next);
+        for (size_t i = 0, count = dependents[next].size(); i < count; ++i)
+            --remaining[dependents[next][i]];
+    }
+
+    // Find the lifetimes of the targets.
+    for (unsigned int i = 0; i < targetCount; ++i)
+    {
+        Target& target = _targets[i];
+        target.firstUse = target.lastUse = target.firstWrite = target.lastWrite = FRAME_GRAPH_UNUSED;
+    }
+    for (unsigned int position = 0, count = (unsigned int)_order.size(); position < count; ++position)
+    {
+        const Pass& pass = _passes[_order[position]];
+        for (size_t i = 0, readCount = pass.reads.size(); i < readCount; ++i)
+        {
+            Target& target = _targets[pass.reads[i]];
+            if (target.firstUse == FRAME_GRAPH_UNUSED)
+                target.firstUse = position;
+            target.lastUse = position;
+        }
+        if (pass.write >= 0)
+        {
+            Target& target = _targets[pass.write];
+            if (target.firstUse == FRAME_GRAPH_UNUSED)
+                target.firstUse = position;
+            if (target.firstWrite == FRAME_GRAPH_UNUSED)
+                target.firstWrite = position;
+            target.lastUse = target.lastWrite = position;
+        }
+    }
+
+    _compiled = true;
+    return true;
+}
+
+void FrameGraph::execute()
+{
+    GP_ASSERT(!_executing);
+
+    if (!_compiled && !compile())
+        return;
+
+    _executing = true;
+    Game* game = Game::getInstance();
+    FrameBuffer* previous = FrameBuffer::getCurrent();
+    GP_ASSERT(previous);
+    const unsigned int targetCount = (unsigned int)_targets.size();
+
+    for (unsigned int position = 0, count = (unsigned int)_order.size(); position < count; ++position)
+    {
+        const unsigned int index = _order[position];
+        Pass& pass = _passes[index];
+
+        // Targets whose lifetimes do not overlap are given the same frame buffer by the pool.
+        for (unsigned int i = 0; i < targetCount; ++i)
+        {
+            Target& target = _targets[i];
+            if (!target.imported && target.firstUse == position)
+                target.frameBuffer = RenderTargetPool::acquire(target.width, target.height, target.format, target.depthStencil);
+        }
+
+        Target* target = pass.write >= 0 ? &_targets[pass.write] : NULL;
+        FrameBuffer* frameBuffer = target ? target->frameBuffer : previous;
+        if (frameBuffer == NULL)
+        {
+            GP_WARN("Skipping frame graph pass '%s'; its target '%s' has no frame buffer.", pass.name.c_str(), target->name.c_str());
+        }
+        else
+        {
+            frameBuffer->bind();
+            if (target)
+            {
+                GL_ASSERT( glViewport(0, 0, frameBuffer->getWidth(), frameBuffer->getHeight()) );
+
+                // The previous contents of a transient target do not need to be loaded.
+                if (!target->imported && target->firstWrite == position)
+                    frameBuffer->discard(true, true);
+            }
+            else
+            {
+                game->setViewport(game->getViewport());
+            }
+
+            pass.listener->drawPass(this, index, pass.cookie);
+
+            // Depth and stencil are never read, so they do not need to be stored.
+            if (target && !target->imported && target->depthStencil && target->lastWrite == position)
+                frameBuffer->discard(false, true);
+        }
+
+        for (unsigned int i = 0; i < targetCount; ++i)
+        {
+            Target& t = _targets[i];
+            if (!t.imported && t.lastUse == position && t.frameBuffer)
+            {
+                RenderTargetPool::release(t.frameBuffer);
+                t.frameBuffer = NULL;
+            }
+        }
+    }
+
+    previous->bind();
+    game->setViewport(game->getViewport());
+    _executing = false;
+}
+
+unsigned int FrameGraph::getPassCount() const
+{
+    return (unsigned int)_passes.size();
+}
+
+const char* FrameGraph::getPassName(unsigned int pass) const
+{
+    GP_ASSERT(pass < _passes.size());
+    return _passes[pass].name.c_str();
+}
+
+bool FrameGraph::isPassCulled(unsigned int pass) const
+{
+    GP_ASSERT(pass < _passes.size());
+    return _passes[pass].culled;
+}
+
+unsigned int FrameGraph::getTargetCount() const
+{
+    return (unsigned int)_targets.size();
+}
+
+const char* FrameGraph::getTargetName(unsigned int target) const
+{
+    GP_ASSERT(target < _targets.size());
+    return _targets[target].name.c_str();
+}
+
+FrameBuffer* FrameGraph::getFrameBuffer(unsigned int target) const
+{
+    GP_ASSERT(target < _targets.size());
+    return _targets[target].frameBuffer;
+}
+
+Texture* FrameGraph::getTexture(unsigned int target) const
+{
+    FrameBuffer* frameBuffer = getFrameBuffer(target);
+    RenderTarget* renderTarget = frameBuffer ? frameBuffer->getRenderTarget() : NULL;
+    return renderTarget ? renderTarget->getTexture() : NULL;
+}
+
+void FrameGraph::releaseFrameBuffers()
+{
+    for (size_t i = 0, count = _targets.size(); i < count; ++i)
+    {
+        Target& target = _targets[i];
+        if (!target.imported && target.frameBuffer)
+        {
+            RenderTargetPool::release(target.frameBuffer);
+            target.frameBuffer = NULL;
+        }
+    }
+}
+
+}
@@ -0,0 +1,315 @@
+#ifndef FRAMEGRAPH_H_
+#define FRAMEGRAPH_H_
+
+#include "Ref.h"
+#include "Texture.h"
+
+namespace gameplay
+{
+
+class FrameBuffer;
+
+/**
+ * Defines a graph of the off-screen passes of a frame, which declare the render targets they
+ * read and write, so that the graph manages the frame buffers they draw to.
+ *
+ * Post-processing, shadow maps, reflections and offscreen forms each keep their own frame
+ * buffers, which hold memory for the whole game even though each is only used for part of a
+ * frame. In a frame graph, passes instead write transient targets that only exist from the
+ * first pass that writes them to the last pass that reads them. Each frame, the graph:
+ *
+ * - culls the passes whose targets are not read by another pass, or written to an imported
+ *   target such as the display;
+ * - orders the remaining passes so that each target is written before it is read, keeping the
+ *   order the passes were added in where the targets allow it;
+ * - acquires the frame buffers of transient targets from the RenderTargetPool at their first
+ *   pass, and releases them after their last pass, so that targets of the same size and format
+ *   whose lifetimes do not overlap share a frame buffer;
+ * - tells tile-based GPUs that the contents of a transient target need not be loaded before
+ *   the first pass that writes it, and that its depth and stencil need not be stored after the
+ *   last pass that writes it (see FrameBuffer::discard).
+ *
+ @verbatim
+    graph->reset();
+    unsigned int scene = graph->createTarget("scene", width, height, Texture::RGBA, true);
+    unsigned int bloom = graph->createTarget("bloom", width / 2, height / 2);
+    unsigned int display = graph->importTarget("display", FrameBuffer::bindDefault());
+
+    unsigned int pass = graph->addPass("scene", this);
+    graph->write(pass, scene);
+    pass = graph->addPass("bloom", this);
+    graph->read(pass, scene);
+    graph->write(pass, bloom);
+    pass = graph->addPass("composite", this);
+    graph->read(pass, scene);
+    graph->read(pass, bloom);
+    graph->write(pass, display);
+
+    graph->execute();
+ @endverbatim
+ *
+ * Each pass draws to the frame buffer of the single target it writes, which is bound with a
+ * viewport that covers it when the listener of the pass is called. The listener reads the
+ * textures of the targets the pass reads with getTexture(). Passes that write no target are
+ * drawn to the frame buffer that was bound before the graph was executed. Frame buffers of
+ * transient targets are only valid while the passes that use them are executed.
+ *
+ * @script{ignore}
+ */
+class FrameGraph : public Ref
+{
+public:
+
+    /**
+     * Defines the interface for drawing the passes of a frame graph.
+     */
+    class Listener
+    {
+    public:
+
+        /**
+         * Destructor.
+         */
+        virtual ~Listener() { }
+
+        /**
+         * Called when a pass is executed, with the frame buffer of the target it writes bound.
+         *
+         * @param graph The frame graph.
+         * @param pass The pass.
+         * @param cookie The cookie the pass was added with.
+         */
+        virtual void drawPass(FrameGraph* graph, unsigned int pass, void* cookie) = 0;
+    };
+
+    /**
+     * Creates an empty frame graph.
+     *
+     * @return The frame graph.
+     */
+    static FrameGraph* create();
+
+    /**
+     * Removes all the passes and targets, to declare the graph of the next frame.
+     *
+     * Must not be called while the graph is executed.
+     */
+    void reset();
+
+    /**
+     * Declares a transient target, which only exists during the passes that use it.
+     *
+     * @param name The name of the target, for debugging.
+     * @param width The width of the target.
+     * @param height The height of the target.
+     * @param format The format of the render target.
+     * @param depthStencil True if the target has a depth-stencil target. It is never read,
+     *      so it is discarded after the last pass that writes the target.
+     *
+     * @return The target.
+     */
+    unsigned int createTarget(const char* name, unsigned int width, unsigned int height, Texture::Format format = Texture::RGBA, bool depthStencil = false);
+
+    /**
+     * Declares a target that is drawn to an existing frame buffer, such as the display.
+     *
+     * The contents of imported targets are kept, so the passes that write them are never
+     * culled, and the contents they had before the first of those passes are loaded.
+     *
+     * @param name The name of the target, for debugging.
+     * @param frameBuffer The frame buffer, which must not be released while the graph uses it.
+     *
+     * @return The target.
+     */
+    unsigned int importTarget(const char* name, FrameBuffer* frameBuffer);
+
+    /**
+     * Adds a pass.
+     *
+     * @param name The name of the pass, for debugging.
+     * @param listener The listener that draws the pass.
+     * @param cookie A value passed to the listener.
+     *
+     * @return The pass.
+     */
+    unsigned int addPass(const char* name, Listener* listener, void* cookie = NULL);
+
+    /**
+     * Declares that a pass reads a target.
+     *
+     * The pass reads what the passes added before it wrote to the target, or what all the
+     * passes that write the target wrote if none of them were added before it.
+     *
+     * @param pass The pass.
+     * @param target The target.
+     */
+    void read(unsigned int pass, unsigned int target);
+
+    /**
+     * Declares that a pass writes a target. A pass writes a single target.
+     *
+     * The passes that write the same target are executed in the order they were added in,
+     * after the passes added before them that read it.
+     *
+     * @param pass The pass.
+     * @param target The target.
+     */
+    void write(unsigned int pass, unsigned int target);
+
+    /**
+     * Culls and orders the passes, and computes the lifetimes of the transient targets.
+     *
+     * This is called by execute() if the graph changed since it was last compiled.
+     *
+     * @return True if successful, false if the passes depend on each other in a cycle.
+     */
+    bool compile();
+
+    /**
+     * Executes the passes that are not culled, in order.
+     *
+     * The frame buffer that was bound before is bound again once the passes are executed.
+     */
+    void execute();
+
+    /**
+     * Returns the number of passes.
+     *
+     * @return The number of passes.
+     */
+    unsigned int getPassCount() const;
+
+    /**
+     * Returns the name of a pass.
+     *
+     * @param pass The pass.
+     *
+     * @return The name of the pass.
+     */
+    const char* getPassName(unsigned int pass) const;
+
+    /**
+     * Determines whether a pass was culled when the graph was compiled.
+     *
+     * @param pass The pass.
+     *
+     * @return True if the pass is not executed.
+     */
+    bool isPassCulled(unsigned int pass) const;
+
+    /**
+     * Returns the number of targets.
+     *
+     * @return The number of targets.
+     */
+    unsigned int getTargetCount() const;
+
+    /**
+     * Returns the name of a target.
+     *
+     * @param target The target.
+     *
+     * @return The name of the target.
+     */
+    const char* getTargetName(unsigned int target) const;
+
+    /**
+     * Returns the frame buffer of a target.
+     *
+     * @param target The target.
+     *
+     * @return The frame buffer, or NULL if the target is transient and not used by the pass
+     *      being executed.
+     */
+    FrameBuffer* getFrameBuffer(unsigned int target) const;
+
+    /**
+     * Returns the texture of the render target of a target, for the passes that read it.
+     *
+     * @param target The target.
+     *
+     * @return The texture, or NULL if the target has no frame buffer or its frame buffer has
+     *      no texture.
+     */
+    Texture* getTexture(unsigned int target) const;
+
+private:
+
+    /**
+     * A render target of the graph.
+     */
+    struct Target
+    {
+        std::string name;
+        unsigned int width;
+        unsigned int height;
+        Texture::Format format;
+        bool depthStencil;
+        bool imported;
+        FrameBuffer* frameBuffer;
+        // The positions in the execution order of the first and last passes that use the
+        // target, and of the first and last passes that write it.
+        unsigned int firstUse;
+        unsigned int lastUse;
+        unsigned int firstWrite;
+        unsigned int lastWrite;
+    };
+
+    /**
+     * A pass of the graph.
+     */
+    struct Pass
+    {
+        std::string name;
+        Listener* listener;
+        void* cookie;
+        std::vector<unsigned int> reads;
+        int write;
+        bool culled;
+    };
+
+    /**
+     * Constructor.
+     */
+    FrameGraph();
+
+    /**
+     * Destructor.
+     */
+    ~FrameGraph();
+
+    /**
+     * Hidden copy constructor.
+     */
+    FrameGraph(const FrameGraph&);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    FrameGraph& operator=(const FrameGraph&);
+
+    /**
+     * Adds the passes that must be executed before a pass to a list.
+     *
+     * @param pass The pass.
+     * @param ordering False to only add the passes whose contents the pass uses, true to also
+     *      add the passes added before it that read the target it writes.
+     * @param dependencies The list of passes.
+     */
+    void getDependencies(unsigned int pass, bool ordering, std::vector<unsigned int>& dependencies) const;
+
+    /**
+     * Releases the frame buffers of the transient targets.
+     */
+    void releaseFrameBuffers();
+
+    std::vector<Target> _targets;
+    std::vector<Pass> _passes;
+    std::vector<unsigned int> _order;
+    bool _compiled;
+    bool _executing;
+};
+
+}
+
+#endif
@@ -0,0 +1,137 @@
+#include "Base.h"
+#include "FramePacer.h"
+#include "Game.h"
+#include "Platform.h"
+
+// The time before a frame is due that is waited without sleeping, since sleeps can
+// overshoot by about a millisecond on most platforms.
+#define FRAME_PACER_SPIN_TIME 2.0
+
+// The default rate of frames while the game is paused or idle.
+#define FRAME_PACER_DEFAULT_IDLE_RATE 10
+
+namespace gameplay
+{
+
+static unsigned int __targetRate = 0;
+static unsigned int __idleRate = FRAME_PACER_DEFAULT_IDLE_RATE;
+static float __idleTimeout = 0.0f;
+static double __lastInputTime = 0.0;
+static double __nextFrameTime = 0.0;
+static bool __displayPaced = false;
+
+void FramePacer::setTargetFrameRate(unsigned int rate)
+{
+    __targetRate = rate;
+    __nextFrameTime = 0.0;
+}
+
+unsigned int FramePacer::getTargetFrameRate()
+{
+    return __targetRate;
+}
+
+void FramePacer::setIdleFrameRate(unsigned int rate)
+{
+    __idleRate = rate;
+    __nextFrameTime = 0.0;
+}
+
+unsigned int FramePacer::getIdleFrameRate()
+{
+    return __idleRate;
+}
+
+void FramePacer::setIdleTimeout(float timeout)
+{
+    __idleTimeout = std::max(timeout, 0.0f);
+}
+
+float FramePacer::getIdleTimeout()
+{
+    return __idleTimeout;
+}
+
+bool FramePacer::isIdle()
+{
+    Game* game = Game::getInstance();
+    if (game && game->getState() == Game::PAUSED)
+        return true;
+    return __idleTimeout > 0.0f && Game::getAbsoluteTime() - __lastInputTime >= __idleTimeout;
+}
+
+unsigned int FramePacer::getFrameRate()
+{
+    if (__idleRate > 0 && isIdle())
+        return __targetRate > 0 ? std::min(__idleRate, __targetRate) : __idleRate;
+    return __targetRate;
+}
+
+void FramePacer::notifyInput()
+{
+    __lastInputTime = Game::getAbsoluteTime();
+}
+
+void FramePacer::setDisplayPaced(bool paced)
+{
+    __displayPaced = paced;
+}
+
+unsigned int FramePacer::getSyncInterval(unsigned int displayRate)
+{
+    unsigned int rate = getFrameRate();
+    if (rate == 0 || rate >= displayRate)
+        return 1;
+
+    // Round to the nearest interval, so that 30 on a 60 Hz display is every other refresh.
+    return std::max((displayRate + rate / 2) / rate, 1u);
+}
+
+void FramePacer::initialize(Properties* config)
+{
+    __lastInputTime = Game::getAbsoluteTime();
+    if (config == NULL)
+        return;
+
+    if (config->exists("frameRate"))
+        setTargetFrameRate((unsigned int)config->getInt("frameRate"));
+    if (config->exists("idleFrameRate"))
+        setIdleFrameRate((unsigned int)config->getInt("idleFrameRate"));
+    if (config->exists("idleTimeout"))
+        setIdleTimeout(config->getFloat("idleTimeout"));
+}
+
+void FramePacer::beginFrame()
+{
+    unsigned int rate = getFrameRate();
+    if (__displayPaced || rate == 0)
+    {
+        __nextFrameTime = 0.0;
+        return;
+    }
+
+    double interval = 1000.0 / (double)rate;
+    double now = Game::getAbsoluteTime();
+    if (__nextFrameTime > now)
+    {
+        // Sleep for most of the wait, and yield for the rest to be on time.
+        double remaining = __nextFrameTime - now;
+        if (remaining > FRAME_PACER_SPIN_TIME)
+        {
+            Platform::sleep((long)(remaining - FRAME_PACER_SPIN_TIME));
+        }
+        while (Game::getAbsoluteTime() < __nextFrameTime)
+        {
+            Platform::sleep(0);
+        }
+        __nextFrameTime += interval;
+    }
+    else
+    {
+        // A frame that is late, or the first one, starts a new schedule rather than
+        // running the frames it missed back to back.
+        __nextFrameTime = now + interval;
+    }
+}
+
+}
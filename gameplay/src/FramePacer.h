@@ -0,0 +1,149 @@
+#ifndef FRAMEPACER_H_
+#define FRAMEPACER_H_
+
+namespace gameplay
+{
+
+class Properties;
+
+/**
+ * Defines the pacing of frames to a target frame rate.
+ *
+ * By default frames are run as fast as the platform allows, which is the display refresh
+ * rate with vertical sync. A target frame rate, such as 30, spaces frames evenly at that
+ * rate instead, leaving the CPU and GPU idle in between to save battery. When the game is
+ * paused, or when no input has been received for the idle timeout, frames are run at the
+ * lower idle frame rate, so that menus and pause screens do not drain the battery.
+ *
+ * On Android, where Choreographer is available, and on iOS, frames are run on the vertical
+ * sync callbacks of the display, skipping callbacks to reach the frame rate. On the other
+ * platforms Game sleeps before each frame until it is due.
+ *
+ * The rates can be set from the game.config file:
+ *
+ @verbatim
+    graphics
+    {
+        frameRate = 30
+        idleFrameRate = 10
+        idleTimeout = 5000
+    }
+ @endverbatim
+ *
+ * @script{ignore}
+ */
+class FramePacer
+{
+    friend class Game;
+
+public:
+
+    /**
+     * Sets the rate frames are run at while the game is active.
+     *
+     * @param rate The number of frames per second, or 0 to run frames as fast as the
+     *      platform allows, which is the default.
+     */
+    static void setTargetFrameRate(unsigned int rate);
+
+    /**
+     * Returns the rate frames are run at while the game is active.
+     *
+     * @return The number of frames per second, or 0 if frames are not limited.
+     */
+    static unsigned int getTargetFrameRate();
+
+    /**
+     * Sets the rate frames are run at while the game is paused or idle.
+     *
+     * @param rate The number of frames per second, or 0 to keep the target frame rate.
+     *      The default is 10.
+     */
+    static void setIdleFrameRate(unsigned int rate);
+
+    /**
+     * Returns the rate frames are run at while the game is paused or idle.
+     *
+     * @return The number of frames per second, or 0 if the target frame rate is kept.
+     */
+    static unsigned int getIdleFrameRate();
+
+    /**
+     * Sets how long the game runs without input before it is considered idle.
+     *
+     * @param timeout The time in milliseconds, or 0 for the game to only be idle while it
+     *      is paused, which is the default.
+     */
+    static void setIdleTimeout(float timeout);
+
+    /**
+     * Returns how long the game runs without input before it is considered idle.
+     *
+     * @return The time in milliseconds, or 0 if the game is only idle while it is paused.
+     */
+    static float getIdleTimeout();
+
+    /**
+     * Determines whether frames are run at the idle frame rate.
+     *
+     * @return True if the game is paused, or has not received input for the idle timeout.
+     */
+    static bool isIdle();
+
+    /**
+     * Returns the rate frames are currently run at.
+     *
+     * @return The number of frames per second, or 0 if frames are not limited.
+     */
+    static unsigned int getFrameRate();
+
+    /**
+     * Records that input was received, so that the game is no longer idle.
+     *
+     * This is called by the platform for touch, key, mouse, gesture and gamepad events, and
+     * can be called by games for other activity that should run at the target frame rate.
+     */
+    static void notifyInput();
+
+    /**
+     * Sets whether the platform runs frames on the vertical sync callbacks of the display,
+     * in which case Game does not sleep between frames.
+     *
+     * This is called by the platform.
+     *
+     * @param paced True if the platform paces frames with getSyncInterval().
+     */
+    static void setDisplayPaced(bool paced);
+
+    /**
+     * Returns the number of display refreshes each frame should last.
+     *
+     * This is used by platforms that pace frames to the display.
+     *
+     * @param displayRate The refresh rate of the display, in frames per second.
+     *
+     * @return The number of vertical sync callbacks per frame, at least 1.
+     */
+    static unsigned int getSyncInterval(unsigned int displayRate);
+
+private:
+
+    /**
+     * Hidden constructor.
+     */
+    FramePacer();
+
+    /**
+     * Called by Game at startup to read the graphics namespace of the game config.
+     */
+    static void initialize(Properties* config);
+
+    /**
+     * Called by Game before each frame to sleep until the frame is due.
+     */
+    static void beginFrame();
+};
+
+}
+
+#endif
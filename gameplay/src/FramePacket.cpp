@@ -0,0 +1,351 @@
+#include "Base.h"
+#include "FramePacket.h"
+#include "Model.h"
+#include "MeshPart.h"
+#include "Technique.h"
+#include "Pass.h"
+#include "Node.h"
+#include "RenderStats.h"
+
+// Sort key layout for opaque items (by effect, then front-to-back).
+#define KEY_OPAQUE_EFFECT_SHIFT     32
+#define KEY_OPAQUE_DEPTH_SHIFT      0
+
+// Sort key layout for blended items (back-to-front, then by effect).
+#define KEY_BLEND_BIT               (1ULL << 63)
+#define KEY_BLEND_DEPTH_SHIFT       32
+#define KEY_BLEND_EFFECT_SHIFT      0
+
+#define KEY_EFFECT_MASK             0x7FFFFFFF
+#define KEY_DEPTH_MASK              0xFFFFFFFF
+
+// The alignment of the values copied into the packet.
+#define VALUE_ALIGNMENT 16
+
+namespace gameplay
+{
+
+FramePacket::FramePacket() : _sorted(true)
+{
+}
+
+FramePacket::~FramePacket()
+{
+}
+
+FramePacket* FramePacket::create(unsigned int initialCapacity)
+{
+    FramePacket* packet = new FramePacket();
+    packet->_items.reserve(initialCapacity);
+    return packet;
+}
+
+/**
+ * Returns the depth of a node's bounding sphere center along the view direction of the
+ * active camera, as an integer that orders like the depth.
+ */
+static unsigned int getDepthKey(Node* node)
+{
+    if (node == NULL)
+        return 0;
+
+    Vector3 center;
+    node->getViewMatrix().transformPoint(node->getBoundingSphere().center, &center);
+
+    // The bit pattern of a positive IEEE float increases monotonically with its value.
+    union
+    {
+        float f;
+        unsigned int i;
+    } depth;
+    depth.f = center.z < 0.0f ? -center.z : 0.0f;
+    return depth.i;
+}
+
+void FramePacket::add(Model* model)
+{
+    GP_ASSERT(model);
+    GP_ASSERT(model->getMesh());
+
+    unsigned int depth = getDepthKey(model->getNode());
+
+    unsigned int lod = model->updateLod();
+    Mesh* mesh = model->getLodMesh(lod);
+    unsigned int partCount = mesh->getPartCount();
+    if (partCount == 0)
+    {
+        // No mesh parts (index buffers), so only a shared material can be used.
+        addItem(model, lod, NULL, model->getMaterial(), depth);
+    }
+    else
+    {
+        for (unsigned int i = 0; i < partCount; ++i)
+        {
+            addItem(model, lod, mesh->getPart(i), model->getPartMaterial(i), depth);
+        }
+    }
+}
+
+void FramePacket::addItem(Model* model, unsigned int lod, MeshPart* part, Material* material, unsigned int depth)
+{
+    if (material == NULL)
+        return;
+
+    Technique* technique = material->getTechnique();
+    GP_ASSERT(technique);
+    for (unsigned int i = 0, passCount = technique->getPassCount(); i < passCount; ++i)
+    {
+        Pass* pass = technique->getPassByIndex(i);
+        GP_ASSERT(pass);
+        Effect* effect = pass->getEffect();
+        GP_ASSERT(effect);
+
+        unsigned long long effectId = getEffectId(effect) & KEY_EFFECT_MASK;
+
+        Item item;
+        if (pass->isBlendEnabled())
+        {
+            item.key = KEY_BLEND_BIT |
+                ((unsigned long long)(KEY_DEPTH_MASK - depth) << KEY_BLEND_DEPTH_SHIFT) |
+                (effectId << KEY_BLEND_EFFECT_SHIFT);
+        }
+        else
+        {
+            item.key = (effectId << KEY_OPAQUE_EFFECT_SHIFT) |
+                ((unsigned long long)depth << KEY_OPAQUE_DEPTH_SHIFT);
+        }
+        item.model = model;
+        item.mesh = model->getLodMesh(lod);
+        item.part = part;
+        item.pass = pass;
+        item.binding = model->getLodBinding(lod, pass);
+
+        // Copy the values the parameters of the pass hierarchy would set, top-down as
+        // RenderState::bind sets them, so that lower levels override upper ones.
+        item.firstValue = (unsigned int)_values.size();
+        RenderState* rs = NULL;
+        while ((rs = pass->getTopmost(rs)))
+        {
+            for (size_t j = 0, count = rs->_parameters.size(); j < count; ++j)
+            {
+                GP_ASSERT(rs->_parameters[j]);
+                rs->_parameters[j]->bind(this, effect);
+            }
+        }
+        item.valueCount = (unsigned int)_values.size() - item.firstValue;
+
+        _items.push_back(item);
+    }
+
+    _sorted = false;
+}
+
+void FramePacket::addValue(Uniform* uniform, ValueType type, const void* data, size_t size, unsigned int count)
+{
+    GP_ASSERT(uniform);
+    GP_ASSERT(data || size == 0);
+
+    Value value;
+    value.uniform = uniform;
+    value.type = type;
+    value.count = count;
+    value.offset = (_data.size() + VALUE_ALIGNMENT - 1) & ~(size_t)(VALUE_ALIGNMENT - 1);
+    _data.resize(value.offset + size);
+    memcpy(&_data[value.offset], data, size);
+    _values.push_back(value);
+}
+
+void FramePacket::setValue(Uniform* uniform, float value)
+{
+    addValue(uniform, FLOAT, &value, sizeof(float), 1);
+}
+
+void FramePacket::setValue(Uniform* uniform, const float* values, unsigned int count)
+{
+    addValue(uniform, FLOAT, values, sizeof(float) * count, count);
+}
+
+void FramePacket::setValue(Uniform* uniform, int value)
+{
+    addValue(uniform, INT, &value, sizeof(int), 1);
+}
+
+void FramePacket::setValue(Uniform* uniform, const int* values, unsigned int count)
+{
+    addValue(uniform, INT, values, sizeof(int) * count, count);
+}
+
+void FramePacket::setValue(Uniform* uniform, const Matrix& value)
+{
+    addValue(uniform, MATRIX, value.m, sizeof(Matrix), 1);
+}
+
+void FramePacket::setValue(Uniform* uniform, const Matrix* values, unsigned int count)
+{
+    addValue(uniform, MATRIX, values, sizeof(Matrix) * count, count);
+}
+
+void FramePacket::setValue(Uniform* uniform, const Vector2& value)
+{
+    addValue(uniform, VECTOR2, &value, sizeof(Vector2), 1);
+}
+
+void FramePacket::setValue(Uniform* uniform, const Vector2* values, unsigned int count)
+{
+    addValue(uniform, VECTOR2, values, sizeof(Vector2) * count, count);
+}
+
+void FramePacket::setValue(Uniform* uniform, const Vector3& value)
+{
+    addValue(uniform, VECTOR3, &value, sizeof(Vector3), 1);
+}
+
+void FramePacket::setValue(Uniform* uniform, const Vector3* values, unsigned int count)
+{
+    addValue(uniform, VECTOR3, values, sizeof(Vector3) * count, count);
+}
+
+void FramePacket::setValue(Uniform* uniform, const Vector4& value)
+{
+    addValue(uniform, VECTOR4, &value, sizeof(Vector4), 1);
+}
+
+void FramePacket::setValue(Uniform* uniform, const Vector4* values, unsigned int count)
+{
+    addValue(uniform, VECTOR4, values, sizeof(Vector4) * count, count);
+}
+
+void FramePacket::setValue(Uniform* uniform, const Texture::Sampler* sampler)
+{
+    // Samplers are kept by pointer, since they are resources of the material.
+    addValue(uniform, SAMPLER, &sampler, sizeof(const Texture::Sampler*), 1);
+}
+
+void FramePacket::setValue(Uniform* uniform, const Texture::Sampler** values, unsigned int count)
+{
+    addValue(uniform, SAMPLER, values, sizeof(const Texture::Sampler*) * count, count);
+}
+
+void FramePacket::bindValue(const Value& value) const
+{
+    Effect* effect = value.uniform->getEffect();
+    GP_ASSERT(effect);
+    const void* data = &_data[value.offset];
+
+    RenderStats::add(RenderStats::UNIFORM_UPLOADS);
+
+    switch (value.type)
+    {
+    case FLOAT:
+        effect->setValue(value.uniform, static_cast<const float*>(data), value.count);
+        break;
+    case INT:
+        effect->setValue(value.uniform, static_cast<const int*>(data), value.count);
+        break;
+    case VECTOR2:
+        effect->setValue(value.uniform, static_cast<const Vector2*>(data), value.count);
+        break;
+    case VECTOR3:
+        effect->setValue(value.uniform, static_cast<const Vector3*>(data), value.count);
+        break;
+    case VECTOR4:
+        effect->setValue(value.uniform, static_cast<const Vector4*>(data), value.count);
+        break;
+    case MATRIX:
+        effect->setValue(value.uniform, static_cast<const Matrix*>(data), value.count);
+        break;
+    case SAMPLER:
+        if (value.count == 1)
+            effect->setValue(value.uniform, *static_cast<const Texture::Sampler* const*>(data));
+        else
+            effect->setValue(value.uniform, const_cast<const Texture::Sampler**>(static_cast<const Texture::Sampler* const*>(data)), value.count);
+        break;
+    default:
+        GP_ERROR("Unsupported frame packet value type (%d).", value.type);
+        break;
+    }
+}
+
+unsigned int FramePacket::getEffectId(Effect* effect)
+{
+    std::map<Effect*, unsigned int>::const_iterator itr = _effectIds.find(effect);
+    if (itr != _effectIds.end())
+        return itr->second;
+
+    unsigned int id = (unsigned int)_effectIds.size();
+    _effectIds[effect] = id;
+    return id;
+}
+
+void FramePacket::clear()
+{
+    _items.clear();
+    _values.clear();
+    _data.clear();
+    _effectIds.clear();
+    _sorted = true;
+}
+
+unsigned int FramePacket::getItemCount() const
+{
+    return (unsigned int)_items.size();
+}
+
+bool FramePacket::sortItems(const Item& a, const Item& b)
+{
+    return a.key < b.key;
+}
+
+void FramePacket::draw(bool wireframe)
+{
+    if (_items.empty())
+        return;
+
+    if (!_sorted)
+    {
+        std::sort(_items.begin(), _items.end(), &FramePacket::sortItems);
+        _sorted = true;
+    }
+
+    Effect* currentEffect = NULL;
+    VertexAttributeBinding* currentBinding = NULL;
+    for (size_t i = 0, count = _items.size(); i < count; ++i)
+    {
+        const Item& item = _items[i];
+        Pass* pass = item.pass;
+
+        Effect* effect = pass->getEffect();
+        GP_ASSERT(effect);
+        if (effect != currentEffect || Effect::getCurrentEffect() != effect)
+        {
+            effect->bind();
+            currentEffect = effect;
+        }
+
+        // The render state is bound without its parameters, whose copies are set instead.
+        pass->bindStateBlocks();
+        for (unsigned int j = item.firstValue, end = item.firstValue + item.valueCount; j < end; ++j)
+        {
+            bindValue(_values[j]);
+        }
+
+        VertexAttributeBinding* binding = item.binding;
+        if (binding != currentBinding)
+        {
+            if (currentBinding)
+                currentBinding->unbind();
+            if (binding)
+                binding->bind();
+            currentBinding = binding;
+        }
+
+        item.model->drawPart(item.mesh, item.part, wireframe);
+    }
+
+    if (currentBinding)
+    {
+        currentBinding->unbind();
+    }
+}
+
+}
@@ -0,0 +1,203 @@
+#ifndef FRAMEPACKET_H_
+#define FRAMEPACKET_H_
+
+#include "Effect.h"
+
+namespace gameplay
+{
+
+class Material;
+class Model;
+class Mesh;
+class MeshPart;
+class Pass;
+class VertexAttributeBinding;
+
+/**
+ * Defines a packet of the draw items of a frame, with a snapshot of their uniform values.
+ *
+ * When a Model is added to a packet, every mesh part and pass of the model becomes a draw
+ * item, and the values of all the material parameters of the pass, including those bound
+ * to nodes, cameras and lights by auto-bindings, are copied into the packet. Drawing the
+ * packet then sets these copies, so it does not read the scene at all: the nodes can be
+ * moved, animated or simulated while a packet built from them earlier is drawn.
+ *
+ * This is what Game uses to overlap simulation with rendering when frame pipelining is
+ * enabled (see Game::setFramePipelining). The packet of a frame is built on a worker
+ * thread by Game::buildFramePacket while the packet of the previous frame is drawn.
+ *
+ * The meshes, materials, effects and textures of the items must remain valid, and must not
+ * be changed, until the packet is cleared. Items are sorted by effect and view depth when
+ * the packet is drawn, with blended items drawn last from back to front.
+ *
+ * @script{ignore}
+ */
+class FramePacket
+{
+public:
+
+    /**
+     * Creates a new, empty frame packet.
+     *
+     * @param initialCapacity An optional initial capacity of the packet (number of draw items).
+     *
+     * @return A new frame packet.
+     */
+    static FramePacket* create(unsigned int initialCapacity = 0);
+
+    /**
+     * Destructor.
+     */
+    ~FramePacket();
+
+    /**
+     * Adds the draw items for all mesh parts and passes of the specified model, and copies
+     * the current values of their material parameters.
+     *
+     * @param model The model to add.
+     */
+    void add(Model* model);
+
+    /**
+     * Removes all draw items and values from the packet.
+     */
+    void clear();
+
+    /**
+     * Returns the number of draw items in the packet.
+     *
+     * @return The number of draw items.
+     */
+    unsigned int getItemCount() const;
+
+    /**
+     * Sorts and draws all the items in the packet with the values copied when they were added.
+     *
+     * @param wireframe If true, draw the items in wireframe mode.
+     */
+    void draw(bool wireframe = false);
+
+    /**
+     * Copies a uniform value into the item being added.
+     *
+     * These mirror Effect::setValue and are called by the material parameters of a pass
+     * while its item is added, in place of setting the values on the effect.
+     */
+    void setValue(Uniform* uniform, float value);
+
+    /** @see setValue(Uniform*, float) */
+    void setValue(Uniform* uniform, const float* values, unsigned int count = 1);
+
+    /** @see setValue(Uniform*, float) */
+    void setValue(Uniform* uniform, int value);
+
+    /** @see setValue(Uniform*, float) */
+    void setValue(Uniform* uniform, const int* values, unsigned int count = 1);
+
+    /** @see setValue(Uniform*, float) */
+    void setValue(Uniform* uniform, const Matrix& value);
+
+    /** @see setValue(Uniform*, float) */
+    void setValue(Uniform* uniform, const Matrix* values, unsigned int count = 1);
+
+    /** @see setValue(Uniform*, float) */
+    void setValue(Uniform* uniform, const Vector2& value);
+
+    /** @see setValue(Uniform*, float) */
+    void setValue(Uniform* uniform, const Vector2* values, unsigned int count = 1);
+
+    /** @see setValue(Uniform*, float) */
+    void setValue(Uniform* uniform, const Vector3& value);
+
+    /** @see setValue(Uniform*, float) */
+    void setValue(Uniform* uniform, const Vector3* values, unsigned int count = 1);
+
+    /** @see setValue(Uniform*, float) */
+    void setValue(Uniform* uniform, const Vector4& value);
+
+    /** @see setValue(Uniform*, float) */
+    void setValue(Uniform* uniform, const Vector4* values, unsigned int count = 1);
+
+    /** @see setValue(Uniform*, float) */
+    void setValue(Uniform* uniform, const Texture::Sampler* sampler);
+
+    /** @see setValue(Uniform*, float) */
+    void setValue(Uniform* uniform, const Texture::Sampler** values, unsigned int count);
+
+private:
+
+    /**
+     * The types of the copied uniform values.
+     */
+    enum ValueType
+    {
+        FLOAT,
+        INT,
+        VECTOR2,
+        VECTOR3,
+        VECTOR4,
+        MATRIX,
+        SAMPLER
+    };
+
+    /**
+     * A uniform value copied into the packet.
+     */
+    struct Value
+    {
+        Uniform* uniform;
+        ValueType type;
+        unsigned int count;
+        size_t offset;
+    };
+
+    /**
+     * A single draw call for a mesh part and a pass, and the values it sets.
+     */
+    struct Item
+    {
+        unsigned long long key;
+        Model* model;
+        Mesh* mesh;
+        MeshPart* part;
+        Pass* pass;
+        VertexAttributeBinding* binding;
+        unsigned int firstValue;
+        unsigned int valueCount;
+    };
+
+    /**
+     * Constructor.
+     */
+    FramePacket();
+
+    /**
+     * Hidden copy constructor.
+     */
+    FramePacket(const FramePacket& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    FramePacket& operator=(const FramePacket&);
+
+    void addItem(Model* model, unsigned int lod, MeshPart* part, Material* material, unsigned int depth);
+
+    void addValue(Uniform* uniform, ValueType type, const void* data, size_t size, unsigned int count);
+
+    void bindValue(const Value& value) const;
+
+    unsigned int getEffectId(Effect* effect);
+
+    static bool sortItems(const Item& a, const Item& b);
+
+    std::vector<Item> _items;
+    std::vector<Value> _values;
+    std::vector<unsigned char> _data;
+    std::map<Effect*, unsigned int> _effectIds;
+    bool _sorted;
+};
+
+}
+
+#endif
@@ -3,9 +3,54 @@
 #include "BoundingSphere.h"
 #include "BoundingBox.h"
 
+#if defined(USE_NEON)
+    #include <arm_neon.h>
+#elif defined(USE_SSE)
+    #include <xmmintrin.h>
+#endif
+
 namespace gameplay
 {
 
+// Four lanes of floats, used to test four volumes against a plane at a time.
+#if defined(USE_NEON)
+
+typedef float32x4_t Float4;
+typedef uint32x4_t Mask4;
+
+static inline Float4 loadFloat4(const float* p) { return vld1q_f32(p); }
+static inline Float4 splatFloat4(float f) { return vdupq_n_f32(f); }
+static inline Float4 addFloat4(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+static inline Float4 mulFloat4(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+static inline Float4 negateFloat4(Float4 a) { return vnegq_f32(a); }
+static inline Mask4 allMask4() { return vdupq_n_u32(0xFFFFFFFF); }
+static inline Mask4 andGreaterEqualMask4(Mask4 m, Float4 a, Float4 b) { return vandq_u32(m, vcgeq_f32(a, b)); }
+static inline Mask4 andGreaterMask4(Mask4 m, Float4 a, Float4 b) { return vandq_u32(m, vcgtq_f32(a, b)); }
+static inline unsigned int bitsMask4(Mask4 m)
+{
+    static const uint32_t bits[4] = { 1, 2, 4, 8 };
+    uint32x4_t set = vandq_u32(m, vld1q_u32(bits));
+    uint32x2_t halves = vadd_u32(vget_low_u32(set), vget_high_u32(set));
+    return vget_lane_u32(vpadd_u32(halves, halves), 0);
+}
+
+#elif defined(USE_SSE)
+
+typedef __m128 Float4;
+typedef __m128 Mask4;
+
+static inline Float4 loadFloat4(const float* p) { return _mm_loadu_ps(p); }
+static inline Float4 splatFloat4(float f) { return _mm_set1_ps(f); }
+static inline Float4 addFloat4(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+static inline Float4 mulFloat4(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+static inline Float4 negateFloat4(Float4 a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+static inline Mask4 allMask4() { return _mm_cmpeq_ps(_mm_setzero_ps(), _mm_setzero_ps()); }
+static inline Mask4 andGreaterEqualMask4(Mask4 m, Float4 a, Float4 b) { return _mm_and_ps(m, _mm_cmpge_ps(a, b)); }
+static inline Mask4 andGreaterMask4(Mask4 m, Float4 a, Float4 b) { return _mm_and_ps(m, _mm_cmpgt_ps(a, b)); }
+static inline unsigned int bitsMask4(Mask4 m) { return (unsigned int)_mm_movemask_ps(m); }
+
+#endif
+
 Frustum::Frustum()
 {
     set(Matrix::identity());
@@ -130,6 +175,103 @@ float Frustum::intersects(const Ray& ray) const
     return ray.intersects(*this);
 }
 
+unsigned int Frustum::intersectsSpheres(const float* centerX, const float* centerY, const float* centerZ, const float* radius,
+                                        unsigned int count, unsigned int* visible, unsigned int* inside) const
+{
+    return intersectsVolumes(centerX, centerY, centerZ, radius, NULL, NULL, true, count, visible, inside);
+}
+
+unsigned int Frustum::intersectsBoxes(const float* centerX, const float* centerY, const float* centerZ,
+                                      const float* extentX, const float* extentY, const float* extentZ,
+                                      unsigned int count, unsigned int* visible, unsigned int* inside) const
+{
+    GP_ASSERT(extentY || count == 0);
+    GP_ASSERT(extentZ || count == 0);
+    return intersectsVolumes(centerX, centerY, centerZ, extentX, extentY, extentZ, false, count, visible, inside);
+}
+
+unsigned int Frustum::intersectsVolumes(const float* centerX, const float* centerY, const float* centerZ,
+                                        const float* extentX, const float* extentY, const float* extentZ, bool spheres,
+                                        unsigned int count, unsigned int* visible, unsigned int* inside) const
+{
+    GP_ASSERT((centerX && centerY && centerZ && extentX) || count == 0);
+    GP_ASSERT(visible || count == 0);
+
+    const Plane* planes[6] = { &_near, &_far, &_left, &_right, &_bottom, &_top };
+    float nx[6], ny[6], nz[6], nd[6], ax[6], ay[6], az[6];
+    for (unsigned int p = 0; p < 6; ++p)
+    {
+        const Vector3& normal = planes[p]->getNormal();
+        nx[p] = normal.x;
+        ny[p] = normal.y;
+        nz[p] = normal.z;
+        nd[p] = planes[p]->getDistance();
+        ax[p] = fabsf(normal.x);
+        ay[p] = fabsf(normal.y);
+        az[p] = fabsf(normal.z);
+    }
+
+    // A volume is visible unless it is entirely behind a plane (its signed distance is below
+    // -reach), and entirely inside when it is entirely in front of every plane.
+    memset(visible, 0, ((count + 31) / 32) * sizeof(unsigned int));
+    if (inside)
+        memset(inside, 0, ((count + 31) / 32) * sizeof(unsigned int));
+    unsigned int visibleCount = 0;
+    unsigned int i = 0;
+
+#if defined(USE_NEON) || defined(USE_SSE)
+    for (; i + 4 <= count; i += 4)
+    {
+        Float4 x = loadFloat4(&centerX[i]);
+        Float4 y = loadFloat4(&centerY[i]);
+        Float4 z = loadFloat4(&centerZ[i]);
+        Float4 ex = loadFloat4(&extentX[i]);
+        Float4 ey = spheres ? ex : loadFloat4(&extentY[i]);
+        Float4 ez = spheres ? ex : loadFloat4(&extentZ[i]);
+        Mask4 visibleMask = allMask4();
+        Mask4 insideMask = allMask4();
+        for (unsigned int p = 0; p < 6; ++p)
+        {
+            Float4 distance = addFloat4(addFloat4(mulFloat4(x, splatFloat4(nx[p])), mulFloat4(y, splatFloat4(ny[p]))),
+                                        addFloat4(mulFloat4(z, splatFloat4(nz[p])), splatFloat4(nd[p])));
+            Float4 reach = spheres ? ex : addFloat4(addFloat4(mulFloat4(ex, splatFloat4(ax[p])), mulFloat4(ey, splatFloat4(ay[p]))),
+                                                    mulFloat4(ez, splatFloat4(az[p])));
+            visibleMask = andGreaterEqualMask4(visibleMask, distance, negateFloat4(reach));
+            insideMask = andGreaterMask4(insideMask, distance, reach);
+        }
+
+        // Groups of four never straddle two words, since i is a multiple of four.
+        unsigned int bits = bitsMask4(visibleMask);
+        visible[i / 32] |= bits << (i % 32);
+        if (inside)
+            inside[i / 32] |= bitsMask4(insideMask) << (i % 32);
+        visibleCount += (bits & 1) + ((bits >> 1) & 1) + ((bits >> 2) & 1) + ((bits >> 3) & 1);
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        bool isVisible = true;
+        bool isInside = true;
+        for (unsigned int p = 0; p < 6 && isVisible; ++p)
+        {
+            float distance = centerX[i] * nx[p] + centerY[i] * ny[p] + centerZ[i] * nz[p] + nd[p];
+            float reach = spheres ? extentX[i] : extentX[i] * ax[p] + extentY[i] * ay[p] + extentZ[i] * az[p];
+            isVisible = distance >= -reach;
+            isInside = isInside && distance > reach;
+        }
+        if (isVisible)
+        {
+            visible[i / 32] |= 1u << (i % 32);
+            if (inside && isInside)
+                inside[i / 32] |= 1u << (i % 32);
+            ++visibleCount;
+        }
+    }
+
+    return visibleCount;
+}
+
 void Frustum::set(const Frustum& frustum)
 {
     _near = frustum._near;
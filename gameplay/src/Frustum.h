@@ -193,6 +193,53 @@ public:
      */
     float intersects(const Ray& ray) const;
 
+    /**
+     * Tests an array of bounding spheres against this frustum, several at a time.
+     *
+     * The spheres are given as separate arrays of their components, so they are tested
+     * four at a time with SIMD instructions where they are available. Bit i % 32 of word
+     * i / 32 of visible is set when sphere i intersects this frustum, as with
+     * intersects(const BoundingSphere&), and the same bit of inside is set when the sphere
+     * is entirely inside this frustum.
+     *
+     * @param centerX The x-coordinates of the centers of the spheres.
+     * @param centerY The y-coordinates of the centers of the spheres.
+     * @param centerZ The z-coordinates of the centers of the spheres.
+     * @param radius The radii of the spheres.
+     * @param count The number of spheres.
+     * @param visible An array of (count + 31) / 32 words to store the visible spheres in.
+     * @param inside An array of (count + 31) / 32 words to store the spheres entirely inside in, or NULL.
+     *
+     * @return The number of spheres that intersect this frustum.
+     * @script{ignore}
+     */
+    unsigned int intersectsSpheres(const float* centerX, const float* centerY, const float* centerZ, const float* radius,
+                                   unsigned int count, unsigned int* visible, unsigned int* inside = NULL) const;
+
+    /**
+     * Tests an array of axis-aligned bounding boxes against this frustum, several at a time.
+     *
+     * The boxes are given by their centers and their extents from the center along each
+     * axis (half their size), as separate arrays of their components. The results are
+     * stored as with intersectsSpheres, and match intersects(const BoundingBox&).
+     *
+     * @param centerX The x-coordinates of the centers of the boxes.
+     * @param centerY The y-coordinates of the centers of the boxes.
+     * @param centerZ The z-coordinates of the centers of the boxes.
+     * @param extentX The extents of the boxes along the x-axis.
+     * @param extentY The extents of the boxes along the y-axis.
+     * @param extentZ The extents of the boxes along the z-axis.
+     * @param count The number of boxes.
+     * @param visible An array of (count + 31) / 32 words to store the visible boxes in.
+     * @param inside An array of (count + 31) / 32 words to store the boxes entirely inside in, or NULL.
+     *
+     * @return The number of boxes that intersect this frustum.
+     * @script{ignore}
+     */
+    unsigned int intersectsBoxes(const float* centerX, const float* centerY, const float* centerZ,
+                                 const float* extentX, const float* extentY, const float* extentZ,
+                                 unsigned int count, unsigned int* visible, unsigned int* inside = NULL) const;
+
     /**
      * Sets this frustum to the specified frustum.
      *
@@ -214,6 +261,14 @@ private:
      */
     void updatePlanes();
 
+    /**
+     * Tests volumes against the planes, given their centers and their reach from the
+     * center towards each plane, computed from the absolute values of its normal.
+     */
+    unsigned int intersectsVolumes(const float* centerX, const float* centerY, const float* centerZ,
+                                   const float* extentX, const float* extentY, const float* extentZ, bool spheres,
+                                   unsigned int count, unsigned int* visible, unsigned int* inside) const;
+
     Plane _near;
     Plane _far;
     Plane _bottom;
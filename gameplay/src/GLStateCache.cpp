@@ -0,0 +1,268 @@
+#include "Base.h"
+#include "GLStateCache.h"
+#include "RenderStats.h"
+
+// The number of texture units whose bindings are cached.
+#define MAX_TEXTURE_UNITS 32
+
+// The value of bindings that are not known, such as those of a new context.
+#define UNKNOWN_BINDING ((GLuint)-1)
+
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#endif
+
+namespace gameplay
+{
+
+static GLuint __program = UNKNOWN_BINDING;
+static GLuint __activeTexture = UNKNOWN_BINDING;
+static GLuint __textures[MAX_TEXTURE_UNITS];
+static GLuint __samplers[MAX_TEXTURE_UNITS];
+static GLuint __arrayBuffer = UNKNOWN_BINDING;
+static GLuint __elementArrayBuffer = UNKNOWN_BINDING;
+static GLuint __pixelUnpackBuffer = UNKNOWN_BINDING;
+static GLuint __vertexArray = UNKNOWN_BINDING;
+static GLuint __framebuffer = UNKNOWN_BINDING;
+static GLuint __renderbuffer = UNKNOWN_BINDING;
+static bool __texturesKnown = false;
+static unsigned int __issuedCount = 0;
+static unsigned int __skippedCount = 0;
+
+// Sets a binding that a deleted object is unbound from to zero, as GL does.
+static void unbind(GLuint* cached, GLsizei count, const GLuint* handles)
+{
+    for (GLsizei i = 0; i < count; ++i)
+    {
+        if (*cached == handles[i])
+        {
+            *cached = 0;
+        }
+    }
+}
+
+bool GLStateCache::update(GLuint* cached, GLuint value)
+{
+    GP_ASSERT(cached);
+
+    if (*cached == value)
+    {
+        ++__skippedCount;
+        return false;
+    }
+    *cached = value;
+    ++__issuedCount;
+    return true;
+}
+
+void GLStateCache::useProgram(GLuint program)
+{
+    if (update(&__program, program))
+    {
+        GL_ASSERT( glUseProgram(program) );
+    }
+}
+
+void GLStateCache::activeTexture(GLenum unit)
+{
+    if (update(&__activeTexture, unit))
+    {
+        GL_ASSERT( glActiveTexture(unit) );
+    }
+}
+
+// Forgets the texture and sampler bindings of all the units, if they are not known yet.
+static void initializeTextureUnits()
+{
+    if (!__texturesKnown)
+    {
+        for (unsigned int i = 0; i < MAX_TEXTURE_UNITS; ++i)
+        {
+            __textures[i] = UNKNOWN_BINDING;
+            __samplers[i] = UNKNOWN_BINDING;
+        }
+        __texturesKnown = true;
+    }
+}
+
+void GLStateCache::bindTexture(GLenum target, GLuint texture)
+{
+    initializeTextureUnits();
+
+    unsigned int unit = __activeTexture - GL_TEXTURE0;
+    if (target == GL_TEXTURE_2D && __activeTexture != UNKNOWN_BINDING && unit < MAX_TEXTURE_UNITS)
+    {
+        if (!update(&__textures[unit], texture))
+            return;
+    }
+    else
+    {
+        ++__issuedCount;
+    }
+    RenderStats::add(RenderStats::TEXTURE_BINDS);
+    GL_ASSERT( glBindTexture(target, texture) );
+}
+
+void GLStateCache::bindSampler(GLuint sampler)
+{
+#ifdef USE_SAMPLER_OBJECTS
+    initializeTextureUnits();
+
+    unsigned int unit = __activeTexture - GL_TEXTURE0;
+    if (__activeTexture == UNKNOWN_BINDING || unit >= MAX_TEXTURE_UNITS)
+    {
+        GLint active = GL_TEXTURE0;
+        GL_ASSERT( glGetIntegerv(GL_ACTIVE_TEXTURE, &active) );
+        unit = (unsigned int)active - GL_TEXTURE0;
+        ++__issuedCount;
+    }
+    else if (!update(&__samplers[unit], sampler))
+    {
+        return;
+    }
+    GL_ASSERT( glBindSampler(unit, sampler) );
+#endif
+}
+
+void GLStateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+    GLuint* cached = NULL;
+    switch (target)
+    {
+    case GL_ARRAY_BUFFER:
+        cached = &__arrayBuffer;
+        break;
+    case GL_ELEMENT_ARRAY_BUFFER:
+        cached = &__elementArrayBuffer;
+        break;
+    case GL_PIXEL_UNPACK_BUFFER:
+        cached = &__pixelUnpackBuffer;
+        break;
+    }
+
+    if (cached == NULL)
+    {
+        ++__issuedCount;
+    }
+    else if (!update(cached, buffer))
+    {
+        return;
+    }
+    GL_ASSERT( glBindBuffer(target, buffer) );
+}
+
+void GLStateCache::bindVertexArray(GLuint array)
+{
+#ifdef USE_VAO
+    if (update(&__vertexArray, array))
+    {
+        // The element array buffer binding belongs to the vertex array.
+        __elementArrayBuffer = UNKNOWN_BINDING;
+        GL_ASSERT( glBindVertexArray(array) );
+    }
+#else
+    GP_ASSERT(array == 0);
+#endif
+}
+
+void GLStateCache::bindFramebuffer(GLuint framebuffer)
+{
+    if (update(&__framebuffer, framebuffer))
+    {
+        GL_ASSERT( glBindFramebuffer(GL_FRAMEBUFFER, framebuffer) );
+    }
+}
+
+void GLStateCache::bindRenderbuffer(GLuint renderbuffer)
+{
+    if (update(&__renderbuffer, renderbuffer))
+    {
+        GL_ASSERT( glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer) );
+    }
+}
+
+void GLStateCache::deleteTextures(GLsizei count, const GLuint* textures)
+{
+    GP_ASSERT(textures);
+
+    GL_ASSERT( glDeleteTextures(count, textures) );
+    if (__texturesKnown)
+    {
+        for (unsigned int i = 0; i < MAX_TEXTURE_UNITS; ++i)
+        {
+            unbind(&__textures[i], count, textures);
+        }
+    }
+}
+
+void GLStateCache::deleteBuffers(GLsizei count, const GLuint* buffers)
+{
+    GP_ASSERT(buffers);
+
+    GL_ASSERT( glDeleteBuffers(count, buffers) );
+    unbind(&__arrayBuffer, count, buffers);
+    unbind(&__elementArrayBuffer, count, buffers);
+    unbind(&__pixelUnpackBuffer, count, buffers);
+}
+
+void GLStateCache::deleteVertexArrays(GLsizei count, const GLuint* arrays)
+{
+    GP_ASSERT(arrays);
+
+#ifdef USE_VAO
+    GL_ASSERT( glDeleteVertexArrays(count, arrays) );
+    GLuint previous = __vertexArray;
+    unbind(&__vertexArray, count, arrays);
+    if (__vertexArray != previous)
+    {
+        __elementArrayBuffer = UNKNOWN_BINDING;
+    }
+#endif
+}
+
+void GLStateCache::deleteFramebuffers(GLsizei count, const GLuint* framebuffers)
+{
+    GP_ASSERT(framebuffers);
+
+    GL_ASSERT( glDeleteFramebuffers(count, framebuffers) );
+    unbind(&__framebuffer, count, framebuffers);
+}
+
+void GLStateCache::deleteRenderbuffers(GLsizei count, const GLuint* renderbuffers)
+{
+    GP_ASSERT(renderbuffers);
+
+    GL_ASSERT( glDeleteRenderbuffers(count, renderbuffers) );
+    unbind(&__renderbuffer, count, renderbuffers);
+}
+
+void GLStateCache::invalidate()
+{
+    __program = UNKNOWN_BINDING;
+    __activeTexture = UNKNOWN_BINDING;
+    __texturesKnown = false;
+    __arrayBuffer = UNKNOWN_BINDING;
+    __elementArrayBuffer = UNKNOWN_BINDING;
+    __pixelUnpackBuffer = UNKNOWN_BINDING;
+    __vertexArray = UNKNOWN_BINDING;
+    __framebuffer = UNKNOWN_BINDING;
+    __renderbuffer = UNKNOWN_BINDING;
+}
+
+unsigned int GLStateCache::getIssuedCount()
+{
+    return __issuedCount;
+}
+
+unsigned int GLStateCache::getSkippedCount()
+{
+    return __skippedCount;
+}
+
+void GLStateCache::resetCounters()
+{
+    __issuedCount = 0;
+    __skippedCount = 0;
+}
+
+}
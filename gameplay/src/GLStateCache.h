@@ -0,0 +1,166 @@
+#ifndef GLSTATECACHE_H_
+#define GLSTATECACHE_H_
+
+#include "Base.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a cache of the OpenGL bindings, which skips binds that would not change them.
+ *
+ * All engine code binds programs, textures, buffers, vertex arrays, frame buffers and render
+ * buffers through this class, and deletes those objects through it so that the bindings GL
+ * resets on deletion are tracked. Each call that matches the binding already in place is
+ * skipped instead of reaching the driver, which is costly on mobile GPUs even for
+ * redundant binds. Only 2D texture bindings are cached; other targets are passed through.
+ *
+ * Code that changes these bindings by calling OpenGL directly must call invalidate()
+ * afterwards, so that the next bind of each kind is issued.
+ *
+ * @script{ignore}
+ */
+class GLStateCache
+{
+public:
+
+    /**
+     * Makes a program current, as glUseProgram does.
+     *
+     * @param program The program handle.
+     */
+    static void useProgram(GLuint program);
+
+    /**
+     * Selects the active texture unit, as glActiveTexture does.
+     *
+     * @param unit The texture unit, starting at GL_TEXTURE0.
+     */
+    static void activeTexture(GLenum unit);
+
+    /**
+     * Binds a texture to the active texture unit, as glBindTexture does.
+     *
+     * @param target The texture target.
+     * @param texture The texture handle.
+     */
+    static void bindTexture(GLenum target, GLuint texture);
+
+    /**
+     * Binds a sampler object to the active texture unit, as glBindSampler does.
+     *
+     * Does nothing where sampler objects are not supported.
+     *
+     * @param sampler The sampler object handle, or 0 to sample with the texture parameters.
+     */
+    static void bindSampler(GLuint sampler);
+
+    /**
+     * Binds a buffer, as glBindBuffer does.
+     *
+     * The element array buffer binding is part of the vertex array state, so it is forgotten
+     * whenever a different vertex array is bound.
+     *
+     * @param target The buffer target.
+     * @param buffer The buffer handle.
+     */
+    static void bindBuffer(GLenum target, GLuint buffer);
+
+    /**
+     * Binds a vertex array object, as glBindVertexArray does.
+     *
+     * @param array The vertex array handle.
+     */
+    static void bindVertexArray(GLuint array);
+
+    /**
+     * Binds a frame buffer to GL_FRAMEBUFFER, as glBindFramebuffer does.
+     *
+     * @param framebuffer The frame buffer handle.
+     */
+    static void bindFramebuffer(GLuint framebuffer);
+
+    /**
+     * Binds a render buffer to GL_RENDERBUFFER, as glBindRenderbuffer does.
+     *
+     * @param renderbuffer The render buffer handle.
+     */
+    static void bindRenderbuffer(GLuint renderbuffer);
+
+    /**
+     * Deletes textures, as glDeleteTextures does, and unbinds them from every texture unit.
+     *
+     * @param count The number of textures.
+     * @param textures The texture handles.
+     */
+    static void deleteTextures(GLsizei count, const GLuint* textures);
+
+    /**
+     * Deletes buffers, as glDeleteBuffers does, and unbinds them.
+     *
+     * @param count The number of buffers.
+     * @param buffers The buffer handles.
+     */
+    static void deleteBuffers(GLsizei count, const GLuint* buffers);
+
+    /**
+     * Deletes vertex array objects, as glDeleteVertexArrays does, and unbinds them.
+     *
+     * @param count The number of vertex arrays.
+     * @param arrays The vertex array handles.
+     */
+    static void deleteVertexArrays(GLsizei count, const GLuint* arrays);
+
+    /**
+     * Deletes frame buffers, as glDeleteFramebuffers does, and unbinds them.
+     *
+     * @param count The number of frame buffers.
+     * @param framebuffers The frame buffer handles.
+     */
+    static void deleteFramebuffers(GLsizei count, const GLuint* framebuffers);
+
+    /**
+     * Deletes render buffers, as glDeleteRenderbuffers does, and unbinds them.
+     *
+     * @param count The number of render buffers.
+     * @param renderbuffers The render buffer handles.
+     */
+    static void deleteRenderbuffers(GLsizei count, const GLuint* renderbuffers);
+
+    /**
+     * Forgets all cached bindings, so that the next bind of each kind is issued.
+     */
+    static void invalidate();
+
+    /**
+     * Returns the number of binds passed to OpenGL since the counters were reset.
+     *
+     * @return The number of calls.
+     */
+    static unsigned int getIssuedCount();
+
+    /**
+     * Returns the number of redundant binds skipped since the counters were reset.
+     *
+     * @return The number of calls.
+     */
+    static unsigned int getSkippedCount();
+
+    /**
+     * Resets the issued and skipped counters to zero.
+     */
+    static void resetCounters();
+
+private:
+
+    /**
+     * Hidden constructor.
+     */
+    GLStateCache();
+
+    static bool update(GLuint* cached, GLuint value);
+};
+
+}
+
+#endif
@@ -0,0 +1,269 @@
+#include "Base.h"
+#include "GPUProfiler.h"
+#include "Font.h"
+
+// The number of frames whose queries can be in flight.
+#define GPU_PROFILER_FRAMES 3
+
+namespace gameplay
+{
+
+#ifdef USE_TIMER_QUERY
+#if defined(OPENGL_ES)
+typedef GLuint64EXT TimerValue;
+#else
+typedef GLuint64 TimerValue;
+#endif
+#endif
+
+/**
+ * The queries of a scope of a frame.
+ */
+struct GPUProfilerQuery
+{
+    const char* name;
+    unsigned int depth;
+    GLuint queries[2];
+};
+
+/**
+ * The scopes of a frame whose queries may not have been read yet.
+ */
+struct GPUProfilerFrame
+{
+    std::vector<GPUProfilerQuery> queries;
+    unsigned int count;
+    bool pending;
+};
+
+/**
+ * A scope of the most recent frame whose queries were read.
+ */
+struct GPUProfilerResult
+{
+    std::string name;
+    unsigned int depth;
+    float time;
+};
+
+static int __supported = -1;
+static bool __enabled = false;
+static bool __inFrame = false;
+static unsigned int __frameIndex = 0;
+static GPUProfilerFrame __frames[GPU_PROFILER_FRAMES];
+static std::vector<unsigned int> __stack;
+static std::vector<GPUProfilerResult> __results;
+
+#ifdef USE_TIMER_QUERY
+static bool readFrame(GPUProfilerFrame& frame)
+{
+    if (frame.count == 0)
+    {
+        frame.pending = false;
+        return false;
+    }
+
+    // Timestamps are written in order, so the whole frame is available once its last query is.
+    GLuint available = 0;
+    GL_ASSERT( glGetQueryObjectuiv(frame.queries[0].queries[1], GL_QUERY_RESULT_AVAILABLE, &available) );
+    if (!available)
+        return false;
+
+    frame.pending = false;
+
+#ifdef OPENGL_ES
+    // Timer results are undefined if the GPU was interrupted, such as by a power event.
+    GLint disjoint = 0;
+    GL_ASSERT( glGetIntegerv(GL_GPU_DISJOINT, &disjoint) );
+    if (disjoint)
+        return false;
+#endif
+
+    __results.resize(frame.count);
+    for (unsigned int i = 0; i < frame.count; ++i)
+    {
+        const GPUProfilerQuery& query = frame.queries[i];
+        TimerValue begin = 0, end = 0;
+        GL_ASSERT( glGetQueryObjectui64v(query.queries[0], GL_QUERY_RESULT, &begin) );
+        GL_ASSERT( glGetQueryObjectui64v(query.queries[1], GL_QUERY_RESULT, &end) );
+        __results[i].name = query.name;
+        __results[i].depth = query.depth;
+        __results[i].time = end > begin ? (float)((double)(end - begin) * 0.000001) : 0.0f;
+    }
+    return true;
+}
+#endif
+
+GPUProfiler::Scope::Scope(const char* name)
+{
+    GPUProfiler::begin(name);
+}
+
+GPUProfiler::Scope::~Scope()
+{
+    GPUProfiler::end();
+}
+
+bool GPUProfiler::isSupported()
+{
+    if (__supported == -1)
+    {
+#if defined(USE_TIMER_QUERY) && defined(OPENGL_ES)
+        __supported = glQueryCounter ? 1 : 0;
+#elif defined(USE_TIMER_QUERY) && defined(__glew_h__)
+        __supported = (GLEW_VERSION_3_3 || GLEW_ARB_timer_query) ? 1 : 0;
+#else
+        __supported = 0;
+#endif
+    }
+    return __supported == 1;
+}
+
+void GPUProfiler::setEnabled(bool enabled)
+{
+    __enabled = enabled;
+}
+
+bool GPUProfiler::isEnabled()
+{
+    return __enabled;
+}
+
+void GPUProfiler::begin(const char* name)
+{
+#ifdef USE_TIMER_QUERY
+    if (!__inFrame)
+        return;
+
+    GPUProfilerFrame& frame = __frames[__frameIndex];
+    if (frame.count == frame.queries.size())
+    {
+        GPUProfilerQuery query;
+        GL_ASSERT( glGenQueries(2, query.queries) );
+        frame.queries.push_back(query);
+    }
+
+    GPUProfilerQuery& query = frame.queries[frame.count];
+    query.name = name;
+    query.depth = __stack.size();
+    GL_ASSERT( glQueryCounter(query.queries[0], GL_TIMESTAMP) );
+    __stack.push_back(frame.count);
+    ++frame.count;
+#endif
+}
+
+void GPUProfiler::end()
+{
+#ifdef USE_TIMER_QUERY
+    if (!__inFrame || __stack.empty())
+        return;
+
+    GPUProfilerFrame& frame = __frames[__frameIndex];
+    GL_ASSERT( glQueryCounter(frame.queries[__stack.back()].queries[1], GL_TIMESTAMP) );
+    __stack.pop_back();
+#endif
+}
+
+void GPUProfiler::beginFrame()
+{
+#ifdef USE_TIMER_QUERY
+    if (!__enabled || !isSupported())
+        return;
+
+    // Read the frames in the order they were drawn, from the one that will be reused now.
+    for (unsigned int i = 0; i < GPU_PROFILER_FRAMES; ++i)
+    {
+        GPUProfilerFrame& frame = __frames[(__frameIndex + i) % GPU_PROFILER_FRAMES];
+        if (frame.pending && !readFrame(frame) && frame.pending)
+            break;
+    }
+
+    // A frame whose queries are still not available is dropped.
+    GPUProfilerFrame& frame = __frames[__frameIndex];
+    frame.pending = false;
+    frame.count = 0;
+    __inFrame = true;
+    begin("frame");
+#endif
+}
+
+void GPUProfiler::endFrame()
+{
+#ifdef USE_TIMER_QUERY
+    if (!__inFrame)
+        return;
+
+    // Scopes left open, and the frame itself, end with the frame.
+    while (!__stack.empty())
+    {
+        end();
+    }
+    __inFrame = false;
+    __frames[__frameIndex].pending = true;
+    __frameIndex = (__frameIndex + 1) % GPU_PROFILER_FRAMES;
+#endif
+}
+
+void GPUProfiler::finalize()
+{
+#ifdef USE_TIMER_QUERY
+    for (unsigned int i = 0; i < GPU_PROFILER_FRAMES; ++i)
+    {
+        GPUProfilerFrame& frame = __frames[i];
+        for (size_t j = 0, count = frame.queries.size(); j < count; ++j)
+        {
+            GL_ASSERT( glDeleteQueries(2, frame.queries[j].queries) );
+        }
+        frame.queries.clear();
+        frame.count = 0;
+        frame.pending = false;
+    }
+#endif
+    __stack.clear();
+    __results.clear();
+    __inFrame = false;
+}
+
+unsigned int GPUProfiler::getScopeCount()
+{
+    return __results.size();
+}
+
+const char* GPUProfiler::getScopeName(unsigned int index)
+{
+    GP_ASSERT(index < __results.size());
+    return __results[index].name.c_str();
+}
+
+unsigned int GPUProfiler::getScopeDepth(unsigned int index)
+{
+    GP_ASSERT(index < __results.size());
+    return __results[index].depth;
+}
+
+float GPUProfiler::getScopeTime(unsigned int index)
+{
+    GP_ASSERT(index < __results.size());
+    return __results[index].time;
+}
+
+void GPUProfiler::draw(Font* font, int x, int y, const Vector4& color)
+{
+    GP_ASSERT(font);
+
+    if (__results.empty())
+        return;
+
+    char line[128];
+    int lineHeight = (int)font->getSize();
+    font->start();
+    for (size_t i = 0, count = __results.size(); i < count; ++i)
+    {
+        const GPUProfilerResult& result = __results[i];
+        sprintf(line, "%-24.24s %7.3f ms", result.name.c_str(), result.time);
+        font->drawText(line, x + (int)result.depth * lineHeight, y + (int)i * lineHeight, color);
+    }
+    font->finish();
+}
+
+}
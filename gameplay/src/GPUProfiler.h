@@ -0,0 +1,185 @@
+#ifndef GPUPROFILER_H_
+#define GPUPROFILER_H_
+
+#include "Base.h"
+#include "Vector4.h"
+
+namespace gameplay
+{
+
+class Font;
+
+/**
+ * Defines a profiler that measures the GPU time of named scopes of a frame.
+ *
+ * Scopes are measured with timestamp queries at their beginning and end, so they can be
+ * nested. The queries of a frame are read a few frames later, once the GPU has reached
+ * them, so the profiler never waits for the GPU; the results returned are those of the
+ * most recent frame whose queries were available. Each frame is itself measured as a
+ * scope named "frame", which contains all the scopes of the frame.
+ *
+ * The engine measures the drawing of terrains, particle emitters and forms. Other passes,
+ * such as the drawing of a scene or post effects, are measured by applications with the
+ * GP_GPU_PROFILE macro or with begin() and end():
+ *
+ @verbatim
+    void MyGame::render(float elapsedTime)
+    {
+        {
+            GP_GPU_PROFILE("scene");
+            _scene->visit(this, &MyGame::drawScene);
+        }
+        GPUProfiler::draw(_font, 10, 10, Vector4::one());
+    }
+ @endverbatim
+ *
+ * Timer queries require OpenGL 3.3 or ARB_timer_query, or EXT_disjoint_timer_query on
+ * OpenGL ES. Where they are not available, the profiler does nothing.
+ *
+ * @script{ignore}
+ */
+class GPUProfiler
+{
+    friend class Game;
+
+public:
+
+    /**
+     * Defines a scope that is measured from its construction to its destruction.
+     */
+    class Scope
+    {
+    public:
+
+        /**
+         * Begins measuring a scope.
+         *
+         * @param name The name of the scope, which must remain valid while the profiler is
+         *      enabled, such as a string literal.
+         */
+        Scope(const char* name);
+
+        /**
+         * Ends the scope.
+         */
+        ~Scope();
+
+    private:
+
+        Scope(const Scope&);
+        Scope& operator=(const Scope&);
+    };
+
+    /**
+     * Determines whether timer queries are supported on this platform.
+     *
+     * @return True if scopes can be measured.
+     */
+    static bool isSupported();
+
+    /**
+     * Sets whether scopes are measured. The profiler is disabled by default.
+     *
+     * @param enabled True to measure scopes from the next frame on.
+     */
+    static void setEnabled(bool enabled);
+
+    /**
+     * Determines whether scopes are measured.
+     *
+     * @return True if the profiler is enabled.
+     */
+    static bool isEnabled();
+
+    /**
+     * Begins measuring a scope, which is ended by the next call to end().
+     *
+     * Scopes outside of Game::render are ignored.
+     *
+     * @param name The name of the scope, which must remain valid while the profiler is
+     *      enabled, such as a string literal.
+     */
+    static void begin(const char* name);
+
+    /**
+     * Ends the scope begun by the last call to begin().
+     */
+    static void end();
+
+    /**
+     * Returns the number of scopes measured in the most recent frame whose results are available.
+     *
+     * @return The number of scopes, including the frame itself.
+     */
+    static unsigned int getScopeCount();
+
+    /**
+     * Returns the name of a measured scope.
+     *
+     * The scopes are in the order they began, so each scope follows the scope that contains it.
+     *
+     * @param index The index of the scope, less than getScopeCount().
+     *
+     * @return The name of the scope.
+     */
+    static const char* getScopeName(unsigned int index);
+
+    /**
+     * Returns the number of scopes that contain a measured scope.
+     *
+     * @param index The index of the scope, less than getScopeCount().
+     *
+     * @return The nesting depth of the scope, 0 for the frame.
+     */
+    static unsigned int getScopeDepth(unsigned int index);
+
+    /**
+     * Returns the GPU time of a measured scope.
+     *
+     * @param index The index of the scope, less than getScopeCount().
+     *
+     * @return The time in milliseconds.
+     */
+    static float getScopeTime(unsigned int index);
+
+    /**
+     * Draws the measured scopes and their times, indented by depth.
+     *
+     * @param font The font to draw with.
+     * @param x The left of the text in pixels.
+     * @param y The top of the text in pixels.
+     * @param color The color of the text.
+     */
+    static void draw(Font* font, int x, int y, const Vector4& color);
+
+private:
+
+    /**
+     * Hidden constructor.
+     */
+    GPUProfiler();
+
+    /**
+     * Called by Game before the frame is rendered.
+     */
+    static void beginFrame();
+
+    /**
+     * Called by Game after the frame is rendered.
+     */
+    static void endFrame();
+
+    /**
+     * Called by Game during shutdown to delete the queries.
+     */
+    static void finalize();
+};
+
+}
+
+/**
+ * Measures the GPU time of the rest of the enclosing block as a scope of the GPUProfiler.
+ */
+#define GP_GPU_PROFILE(name) gameplay::GPUProfiler::Scope __gpuProfilerScope(name)
+
+#endif
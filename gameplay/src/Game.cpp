@@ -5,6 +5,17 @@
 #include "FileSystem.h"
 #include "FrameBuffer.h"
 #include "SceneLoader.h"
+#include "GPUProfiler.h"
+#include "Profiler.h"
+#include "DynamicResolution.h"
+#include "OffscreenParticles.h"
+#include "FramePacket.h"
+#include "FramePacer.h"
+#include "MemoryPool.h"
+#include "RenderStats.h"
+#include "MemoryStats.h"
+#include "RenderTargetPool.h"
+#include "TimerWheel.h"
 
 /** @script{ignore} */
 GLenum __gl_error_code = GL_NO_ERROR;
@@ -15,6 +26,9 @@ namespace gameplay
 {
 
 static Game* __gameInstance = NULL;
+
+// The names of the subsystems in the 'subsystems' namespace of the game config, in the order of their flags.
+static const char* __subsystemNames[] = { "animation", "audio", "physics", "ai", "script" };
 double Game::_pausedTimeLast = 0.0;
 double Game::_pausedTimeTotal = 0.0;
 
@@ -23,12 +37,16 @@ Game::Game()
       _frameLastFPS(0), _frameCount(0), _frameRate(0),
       _clearDepth(1.0f), _clearStencil(0), _properties(NULL),
       _animationController(NULL), _audioController(NULL),
-      _physicsController(NULL), _aiController(NULL), _audioListener(NULL),
-      _timeEvents(NULL), _scriptController(NULL), _scriptListeners(NULL)
+      _physicsController(NULL), _aiController(NULL), _lazySubsystems(0), _jobController(NULL), _ioController(NULL), _textureStreamer(NULL), _frameArena(NULL),
+      _framePipelining(false), _simulationJob(NULL),
+      _fixedUpdateStep(0.0f), _fixedUpdateMaxSteps(5), _fixedUpdateTime(0.0f), _interpolationAlpha(1.0f), _fixedFrameTime(0.0f), _audioListener(NULL),
+      _timers(NULL), _firingTimer(0), _scriptController(NULL), _scriptListeners(NULL)
 {
     GP_ASSERT(__gameInstance == NULL);
     __gameInstance = this;
-    _timeEvents = new std::priority_queue<TimeEvent, std::vector<TimeEvent>, std::less<TimeEvent> >();
+    _timers = new TimerWheel();
+    _framePackets[0] = _framePackets[1] = NULL;
+    _frameArena = new FrameArena();
 }
 
 Game::~Game()
@@ -37,9 +55,12 @@ Game::~Game()
 
     // Do not call any virtual functions from the destructor.
     // Finalization is done from outside this class.
-    SAFE_DELETE(_timeEvents);
+    SAFE_DELETE(_timers);
+    SAFE_DELETE(_frameArena);
+    Ref::destroyDeferred();
 #ifdef GAMEPLAY_MEM_LEAK_DETECTION
     Ref::printLeaks();
+    MemoryPool::printLeaks();
     printMemoryLeaks();
 #endif
 }
@@ -60,6 +81,11 @@ double Game::getGameTime()
     return Platform::getAbsoluteTime() - _pausedTimeTotal;
 }
 
+double Game::getInputEventTime()
+{
+    return Platform::getInputEventTime();
+}
+
 void Game::setVsync(bool enable)
 {
     Platform::setVsync(enable);
@@ -98,21 +124,45 @@ bool Game::startup()
     setViewport(Rectangle(0.0f, 0.0f, (float)_width, (float)_height));
     RenderState::initialize();
     FrameBuffer::initialize();
+    if (_properties)
+    {
+        Properties* graphics = _properties->getNamespace("graphics", true);
+        DynamicResolution::initialize(graphics);
+        FramePacer::initialize(graphics);
+        if (graphics && graphics->getBool("framePipelining"))
+        {
+            setFramePipelining(true);
+        }
+    }
 
-    _animationController = new AnimationController();
-    _animationController->initialize();
-
-    _audioController = new AudioController();
-    _audioController->initialize();
+    // Start the job controller first, since the other controllers may use it.
+    _jobController = new JobController();
+    _jobController->initialize();
 
-    _physicsController = new PhysicsController();
-    _physicsController->initialize();
+    _ioController = new IOController();
+    _ioController->initialize();
 
-    _aiController = new AIController();
-    _aiController->initialize();
+    _textureStreamer = new TextureStreamer();
 
-    _scriptController = new ScriptController();
-    _scriptController->initialize();
+    // The subsystems are initialized when they are first used, unless the game config
+    // initializes them at startup. A pipelined frame is simulated on a
+    // worker thread, so they are all initialized at startup then.
+    _lazySubsystems = ALL_SUBSYSTEMS;
+    unsigned int startupSubsystems = 0;
+    Properties* subsystems = _properties ? _properties->getNamespace("subsystems", true) : NULL;
+    for (unsigned int i = 0; subsystems && i < SUBSYSTEM_COUNT; ++i)
+    {
+        const char* initialization = subsystems->getString(__subsystemNames[i]);
+        if (initialization == NULL || strcmp(initialization, "LAZY") == 0)
+            continue;
+        if (strcmp(initialization, "STARTUP") == 0)
+            startupSubsystems |= 1 << i;
+        else
+            GP_WARN("Invalid initialization '%s' for subsystem '%s' in game config.", initialization, __subsystemNames[i]);
+    }
+    if (_framePipelining)
+        startupSubsystems = ALL_SUBSYSTEMS;
+    initializeSubsystems(startupSubsystems);
 
     // Load any gamepads, ui or physical.
     loadGamepads();
@@ -137,7 +187,7 @@ bool Game::startup()
                 }
                 else
                 {
-                    _scriptController->loadScript(file.c_str());
+                    getScriptController()->loadScript(file.c_str());
                     _scriptController->registerCallback(callback, id.c_str());
                 }
             }
@@ -154,28 +204,30 @@ void Game::shutdown()
     // Call user finalization.
     if (_state != UNINITIALIZED)
     {
-        GP_ASSERT(_animationController);
-        GP_ASSERT(_audioController);
-        GP_ASSERT(_physicsController);
-        GP_ASSERT(_aiController);
-
         Platform::signalShutdown();
 
 		// Call user finalize
         finalize();
 
+        // The subsystems that were never used are not initialized during shutdown.
+        _lazySubsystems = 0;
+
 		// Shutdown scripting system first so that any objects allocated in script are released before our subsystems are released
-		_scriptController->finalizeGame();
+		if (_scriptController)
+			_scriptController->finalizeGame();
 		if (_scriptListeners)
 		{
-			for (size_t i = 0; i < _scriptListeners->size(); i++)
+			for (std::map<unsigned int, ScriptListener*>::iterator itr = _scriptListeners->begin(); itr != _scriptListeners->end(); ++itr)
 			{
-				SAFE_DELETE((*_scriptListeners)[i]);
+				_timers->remove(itr->first);
+				SAFE_DELETE(itr->second);
 			}
 			SAFE_DELETE(_scriptListeners);
 		}
-		_scriptController->finalize();
+		if (_scriptController)
+			_scriptController->finalize();
 
+        Gamepad::setPollingFrequency(0);
         unsigned int gamepadCount = Gamepad::getGamepadCount();
         for (unsigned int i = 0; i < gamepadCount; i++)
         {
@@ -183,27 +235,70 @@ void Game::shutdown()
             SAFE_DELETE(gamepad);
         }
 
-        _animationController->finalize();
-        SAFE_DELETE(_animationController);
+        if (_animationController)
+        {
+            _animationController->finalize();
+            SAFE_DELETE(_animationController);
+        }
+
+        if (_audioController)
+        {
+            _audioController->finalize();
+            SAFE_DELETE(_audioController);
+        }
+
+        if (_physicsController)
+        {
+            _physicsController->finalize();
+            SAFE_DELETE(_physicsController);
+        }
+        if (_aiController)
+        {
+            _aiController->finalize();
+            SAFE_DELETE(_aiController);
+        }
+
+        // Wait for the texture loads in progress before the job controller stops.
+        _textureStreamer->finalize();
+        SAFE_DELETE(_textureStreamer);
+
+        // Cancel the reads in progress; the listeners of those already read are called by the job controller.
+        _ioController->finalize();
+        SAFE_DELETE(_ioController);
 
-        _audioController->finalize();
-        SAFE_DELETE(_audioController);
+        GPUProfiler::finalize();
+        RenderStats::finalize();
+        MemoryStats::finalize();
 
-        _physicsController->finalize();
-        SAFE_DELETE(_physicsController);
-        _aiController->finalize();
-        SAFE_DELETE(_aiController);
+        SAFE_DELETE(_framePackets[0]);
+        SAFE_DELETE(_framePackets[1]);
+        SAFE_DELETE(_simulationJob);
+        _framePipelining = false;
+
+        // Finalize the job controller last, since it runs any jobs the other controllers left behind.
+        _jobController->finalize();
+        SAFE_DELETE(_jobController);
+        Ref::destroyDeferred();
 
         // Note: we do not clean up the script controller here
         // because users can call Game::exit() from a script.
 
         SAFE_DELETE(_audioListener);
 
+        // Release the textures the cache keeps for reuse.
+        Texture::setCacheBudget(0);
+
+        DynamicResolution::finalize();
+        OffscreenParticles::finalize();
+        RenderTargetPool::finalize();
         FrameBuffer::finalize();
         RenderState::finalize();
 
         SAFE_DELETE(_properties);
 
+        // Write the messages still queued by the asynchronous logger.
+        Logger::setAsync(false);
+
 		_state = UNINITIALIZED;
     }
 }
@@ -212,16 +307,16 @@ void Game::pause()
 {
     if (_state == RUNNING)
     {
-        GP_ASSERT(_animationController);
-        GP_ASSERT(_audioController);
-        GP_ASSERT(_physicsController);
-        GP_ASSERT(_aiController);
         _state = PAUSED;
         _pausedTimeLast = Platform::getAbsoluteTime();
-        _animationController->pause();
-        _audioController->pause();
-        _physicsController->pause();
-        _aiController->pause();
+        if (_animationController)
+            _animationController->pause();
+        if (_audioController)
+            _audioController->pause();
+        if (_physicsController)
+            _physicsController->pause();
+        if (_aiController)
+            _aiController->pause();
     }
 
     ++_pausedCount;
@@ -235,16 +330,16 @@ void Game::resume()
 
         if (_pausedCount == 0)
         {
-            GP_ASSERT(_animationController);
-            GP_ASSERT(_audioController);
-            GP_ASSERT(_physicsController);
-            GP_ASSERT(_aiController);
             _state = RUNNING;
             _pausedTimeTotal += Platform::getAbsoluteTime() - _pausedTimeLast;
-            _animationController->resume();
-            _audioController->resume();
-            _physicsController->resume();
-            _aiController->resume();
+            if (_animationController)
+                _animationController->resume();
+            if (_audioController)
+                _audioController->resume();
+            if (_physicsController)
+                _physicsController->resume();
+            if (_aiController)
+                _aiController->resume();
         }
     }
 }
@@ -281,59 +376,118 @@ void Game::frame()
     {
         // Perform lazy first time initialization
         initialize();
-        _scriptController->initializeGame();
+        if (_scriptController)
+            _scriptController->initializeGame();
         _initialized = true;
 
         // Fire first game resize event
         Platform::resizeEventInternal(_width, _height);
     }
 
+    // Wait until this frame is due at the current frame rate.
+    FramePacer::beginFrame();
+
+    GP_PROFILE("Game::frame");
+
+    // The memory allocated for the last frame is not used anymore.
+    _frameArena->reset();
+
+    // Keep the render statistics of the last frame and count this one from zero.
+    RenderStats::beginFrame();
+    MemoryStats::beginFrame();
+    RenderTargetPool::beginFrame();
+
 	static double lastFrameTime = Game::getGameTime();
 	double frameTime = getGameTime();
 
     // Fire time events to scheduled TimeListeners
     fireTimeEvents(frameTime);
 
-    if (_state == Game::RUNNING)
+    // Run the jobs that must run on the main thread.
+    GP_ASSERT(_jobController);
     {
-        GP_ASSERT(_animationController);
-        GP_ASSERT(_audioController);
-        GP_ASSERT(_physicsController);
-        GP_ASSERT(_aiController);
+        GP_PROFILE("JobController::update");
+        _jobController->update();
+    }
 
+    // Destroy the objects that were released on the worker threads.
+    Ref::destroyDeferred();
+
+    if (_state == Game::RUNNING)
+    {
         // Update Time.
-        float elapsedTime = (frameTime - lastFrameTime);
+        float elapsedTime = _fixedFrameTime > 0.0f ? _fixedFrameTime : (float)(frameTime - lastFrameTime);
         lastFrameTime = frameTime;
 
-        // Update the scheduled and running animations.
-        _animationController->update(elapsedTime);
+        if (_framePipelining)
+        {
+            framePipelined(elapsedTime);
+        }
+        else
+        {
+            // Update animations, physics and AI.
+            updateControllers(elapsedTime);
+            _interpolationAlpha = _fixedUpdateStep > 0.0f ? _fixedUpdateTime / _fixedUpdateStep : 1.0f;
 
-        // Update the physics.
-        _physicsController->update(elapsedTime);
+            // Update gamepads.
+            {
+                GP_PROFILE("Gamepad::update");
+                Gamepad::updateInternal(elapsedTime);
+            }
 
-        // Update AI.
-        _aiController->update(elapsedTime);
+            // Application Update.
+            {
+                GP_PROFILE("Game::update");
+                update(elapsedTime);
+            }
 
-        // Update gamepads.
-        Gamepad::updateInternal(elapsedTime);
+            // Update forms.
+            {
+                GP_PROFILE("Form::update");
+                Form::updateInternal(elapsedTime);
+            }
 
-        // Application Update.
-        update(elapsedTime);
+            // Run script update.
+            if (_scriptController)
+            {
+                GP_PROFILE("ScriptController::update");
+                _scriptController->update(elapsedTime);
+            }
 
-        // Update forms.
-        Form::updateInternal(elapsedTime);
+            // Resume the script coroutines whose awaited operations completed.
+            if (_scriptController)
+            {
+                GP_PROFILE("ScriptController::resumeCoroutines");
+                _scriptController->resumeCoroutines();
+            }
 
-        // Run script update.
-        _scriptController->update(elapsedTime);
+            // Notify the listeners of transforms that changed during the update.
+            Transform::flushTransformChanged();
 
-        // Audio Rendering.
-        _audioController->update(elapsedTime);
+            // Audio Rendering.
+            if (_audioController)
+            {
+                GP_PROFILE("AudioController::update");
+                _audioController->update(elapsedTime);
+            }
 
-        // Graphics Rendering.
-        render(elapsedTime);
+            // Graphics Rendering.
+            GPUProfiler::beginFrame();
+            DynamicResolution::beginFrame();
+            {
+                GP_PROFILE("Game::render");
+                render(elapsedTime);
+            }
 
-        // Run script render.
-        _scriptController->render(elapsedTime);
+            // Run script render.
+            if (_scriptController)
+            {
+                GP_PROFILE("ScriptController::render");
+                _scriptController->render(elapsedTime);
+            }
+            DynamicResolution::endFrame();
+            GPUProfiler::endFrame();
+        }
 
         // Update FPS.
         ++_frameCount;
@@ -356,29 +510,196 @@ void Game::frame()
         Form::updateInternal(0);
 
         // Script update.
-        _scriptController->update(0);
+        if (_scriptController)
+            _scriptController->update(0);
+
+        // Notify the listeners of transforms that changed during the update.
+        Transform::flushTransformChanged();
 
         // Graphics Rendering.
+        GPUProfiler::beginFrame();
+        DynamicResolution::beginFrame();
         render(0);
 
         // Script render.
-        _scriptController->render(0);
+        if (_scriptController)
+            _scriptController->render(0);
+        DynamicResolution::endFrame();
+        GPUProfiler::endFrame();
     }
 }
 
 void Game::renderOnce(const char* function)
 {
-    _scriptController->executeFunction<void>(function, NULL);
+    ScriptController* scriptController = getScriptController();
+    GP_ASSERT(scriptController);
+    scriptController->executeFunction<void>(function, NULL);
     Platform::swapBuffers();
 }
 
-void Game::updateOnce()
+void Game::setFramePipelining(bool enabled)
 {
-    GP_ASSERT(_animationController);
-    GP_ASSERT(_audioController);
-    GP_ASSERT(_physicsController);
-    GP_ASSERT(_aiController);
+    if (enabled && _simulationJob == NULL)
+    {
+        _framePackets[0] = FramePacket::create();
+        _framePackets[1] = FramePacket::create();
+        _simulationJob = new SimulationJob();
+        _simulationJob->game = this;
+        _simulationJob->elapsedTime = 0;
+    }
+    _framePipelining = enabled;
+
+    // The simulation of pipelined frames on a worker thread must not initialize subsystems.
+    if (enabled)
+        initializeSubsystems(_lazySubsystems);
+}
+
+void Game::buildFramePacket(FramePacket* packet)
+{
+}
+
+void Game::framePipelined(float elapsedTime)
+{
+    // Input, forms and scripts are handled on the main thread before the simulation starts.
+    {
+        GP_PROFILE("Gamepad::update");
+        Gamepad::updateInternal(elapsedTime);
+    }
+    {
+        GP_PROFILE("Form::update");
+        Form::updateInternal(elapsedTime);
+    }
+    if (_scriptController)
+    {
+        GP_PROFILE("ScriptController::update");
+        _scriptController->update(elapsedTime);
+    }
+    if (_scriptController)
+    {
+        GP_PROFILE("ScriptController::resumeCoroutines");
+        _scriptController->resumeCoroutines();
+    }
+
+    // Simulate this frame on a worker thread while the packet of the last frame is drawn.
+    _simulationJob->elapsedTime = elapsedTime;
+    JobController::JobId simulation = _jobController->add(_simulationJob);
+
+    // Graphics Rendering.
+    GPUProfiler::beginFrame();
+    FrameBuffer::beginFrame();
+    DynamicResolution::beginFrame();
+    {
+        GP_PROFILE("Game::render");
+        render(elapsedTime);
+    }
+
+    // Run script render.
+    if (_scriptController)
+    {
+        GP_PROFILE("ScriptController::render");
+        _scriptController->render(elapsedTime);
+    }
+    DynamicResolution::endFrame();
+    FrameBuffer::endFrame();
+    GPUProfiler::endFrame();
 
+    {
+        GP_PROFILE("Game::waitForSimulation");
+        _jobController->wait(simulation);
+    }
+
+    // The packet just built is drawn during the next frame, along with its interpolation.
+    std::swap(_framePackets[0], _framePackets[1]);
+    _interpolationAlpha = _fixedUpdateStep > 0.0f ? _fixedUpdateTime / _fixedUpdateStep : 1.0f;
+}
+
+void Game::simulate(float elapsedTime)
+{
+    updateControllers(elapsedTime);
+    update(elapsedTime);
+    Transform::flushTransformChanged();
+    if (_audioController)
+        _audioController->update(elapsedTime);
+
+    _framePackets[1]->clear();
+    buildFramePacket(_framePackets[1]);
+}
+
+void Game::setFixedUpdateRate(float rate, unsigned int maxSteps)
+{
+    GP_ASSERT(rate >= 0.0f);
+    GP_ASSERT(maxSteps > 0);
+
+    _fixedUpdateStep = rate > 0.0f ? 1000.0f / rate : 0.0f;
+    _fixedUpdateMaxSteps = maxSteps;
+    _fixedUpdateTime = 0.0f;
+    _interpolationAlpha = 1.0f;
+}
+
+void Game::setFixedFrameTime(float time)
+{
+    GP_ASSERT(time >= 0.0f);
+    _fixedFrameTime = time;
+}
+
+void Game::fixedUpdate(float stepTime)
+{
+}
+
+void Game::updateControllers(float elapsedTime)
+{
+    if (_fixedUpdateStep <= 0.0f)
+    {
+        // Update the scheduled and running animations.
+        if (_animationController)
+        {
+            GP_PROFILE("AnimationController::update");
+            _animationController->update(elapsedTime);
+        }
+
+        // Update the physics.
+        if (_physicsController)
+            _physicsController->update(elapsedTime);
+
+        // Update AI.
+        if (_aiController)
+        {
+            GP_PROFILE("AIController::update");
+            _aiController->update(elapsedTime);
+        }
+        return;
+    }
+
+    _fixedUpdateTime += elapsedTime;
+    unsigned int steps = 0;
+    while (_fixedUpdateTime >= _fixedUpdateStep && steps < _fixedUpdateMaxSteps)
+    {
+        GP_PROFILE("Game::fixedUpdate");
+        if (_animationController)
+            _animationController->update(_fixedUpdateStep);
+        if (_physicsController)
+            _physicsController->update(_fixedUpdateStep);
+        if (_aiController)
+            _aiController->update(_fixedUpdateStep);
+        fixedUpdate(_fixedUpdateStep);
+        _fixedUpdateTime -= _fixedUpdateStep;
+        ++steps;
+    }
+
+    // Drop the time the steps of this frame could not catch up on.
+    if (_fixedUpdateTime >= _fixedUpdateStep)
+    {
+        _fixedUpdateTime = fmod(_fixedUpdateTime, _fixedUpdateStep);
+    }
+}
+
+void Game::SimulationJob::run()
+{
+    game->simulate(elapsedTime);
+}
+
+void Game::updateOnce()
+{
     // Update Time.
     static double lastFrameTime = getGameTime();
     double frameTime = getGameTime();
@@ -386,17 +707,67 @@ void Game::updateOnce()
     lastFrameTime = frameTime;
 
     // Update the internal controllers.
-    _animationController->update(elapsedTime);
-    _physicsController->update(elapsedTime);
-    _aiController->update(elapsedTime);
-    _audioController->update(elapsedTime);
-    _scriptController->update(elapsedTime);
+    if (_animationController)
+        _animationController->update(elapsedTime);
+    if (_physicsController)
+        _physicsController->update(elapsedTime);
+    if (_aiController)
+        _aiController->update(elapsedTime);
+    if (_audioController)
+        _audioController->update(elapsedTime);
+    if (_scriptController)
+        _scriptController->update(elapsedTime);
+}
+
+void Game::initializeSubsystems(unsigned int subsystems)
+{
+    // Only the subsystems that may still be initialized are, in the order of their flags.
+    subsystems &= _lazySubsystems;
+    _lazySubsystems &= ~subsystems;
+
+    if (subsystems & ANIMATION_SUBSYSTEM)
+    {
+        _animationController = new AnimationController();
+        _animationController->initialize();
+        if (_state == PAUSED)
+            _animationController->pause();
+    }
+
+    if (subsystems & AUDIO_SUBSYSTEM)
+    {
+        _audioController = new AudioController();
+        _audioController->initialize();
+    }
+
+    if (subsystems & PHYSICS_SUBSYSTEM)
+    {
+        _physicsController = new PhysicsController();
+        _physicsController->initialize();
+    }
+
+    if (subsystems & AI_SUBSYSTEM)
+    {
+        _aiController = new AIController();
+        _aiController->initialize();
+        if (_state == PAUSED)
+            _aiController->pause();
+    }
+
+    if (subsystems & SCRIPT_SUBSYSTEM)
+    {
+        _scriptController = new ScriptController();
+        _scriptController->initialize();
+    }
 }
 
 void Game::setViewport(const Rectangle& viewport)
 {
     _viewport = viewport;
-    glViewport((GLuint)viewport.x, (GLuint)viewport.y, (GLuint)viewport.width, (GLuint)viewport.height);
+
+    // While the scene is drawn at a dynamic resolution, viewports remain in window pixels.
+    Rectangle scaled;
+    const Rectangle& v = DynamicResolution::scaleViewport(viewport, &scaled) ? scaled : viewport;
+    glViewport((GLuint)v.x, (GLuint)v.y, (GLuint)v.width, (GLuint)v.height);
 }
 
 void Game::clear(ClearFlags flags, const Vector4& clearColor, float clearDepth, int clearStencil)
@@ -518,37 +889,91 @@ void Game::getArguments(int* argc, char*** argv) const
     Platform::getArguments(argc, argv);
 }
 
-void Game::schedule(float timeOffset, TimeListener* timeListener, void* cookie)
+unsigned int Game::schedule(float timeOffset, TimeListener* timeListener, void* cookie)
 {
-    GP_ASSERT(_timeEvents);
-    TimeEvent timeEvent(getGameTime() + timeOffset, timeListener, cookie);
-    _timeEvents->push(timeEvent);
+    GP_ASSERT(_timers);
+    return _timers->add(getGameTime() + timeOffset, 0.0f, timeListener, cookie);
 }
 
-void Game::schedule(float timeOffset, const char* function)
+unsigned int Game::schedule(float timeOffset, const char* function)
 {
+    return scheduleScript(timeOffset, 0.0f, function);
+}
+
+unsigned int Game::scheduleRepeating(float interval, TimeListener* timeListener, void* cookie)
+{
+    GP_ASSERT(_timers);
+    GP_ASSERT(interval > 0.0f);
+    return _timers->add(getGameTime() + interval, interval, timeListener, cookie);
+}
+
+unsigned int Game::scheduleRepeating(float interval, const char* function)
+{
+    GP_ASSERT(interval > 0.0f);
+    return scheduleScript(interval, interval, function);
+}
+
+unsigned int Game::scheduleScript(float timeOffset, float interval, const char* function)
+{
+    GP_ASSERT(_timers);
     if (!_scriptListeners)
-        _scriptListeners = new std::vector<ScriptListener*>();
+        _scriptListeners = new std::map<unsigned int, ScriptListener*>();
 
     ScriptListener* listener = new ScriptListener(function);
-    _scriptListeners->push_back(listener);
-    schedule(timeOffset, listener, NULL);
+    unsigned int handle = _timers->add(getGameTime() + timeOffset, interval, listener, NULL);
+    (*_scriptListeners)[handle] = listener;
+    return handle;
 }
 
-void Game::fireTimeEvents(double frameTime)
+bool Game::unschedule(unsigned int handle)
 {
-    while (_timeEvents->size() > 0)
+    GP_ASSERT(_timers);
+    if (!_timers->remove(handle))
+        return false;
+
+    // A script function that cancels its own event is released once it returns.
+    if (handle != _firingTimer)
+        releaseScriptListener(handle);
+    return true;
+}
+
+void Game::unschedule(TimeListener* timeListener)
+{
+    GP_ASSERT(_timers);
+    _timers->remove(timeListener);
+}
+
+void Game::releaseScriptListener(unsigned int handle)
+{
+    if (_scriptListeners)
     {
-        const TimeEvent* timeEvent = &_timeEvents->top();
-        if (timeEvent->time > frameTime)
+        std::map<unsigned int, ScriptListener*>::iterator itr = _scriptListeners->find(handle);
+        if (itr != _scriptListeners->end())
         {
-            break;
+            SAFE_DELETE(itr->second);
+            _scriptListeners->erase(itr);
         }
-        if (timeEvent->listener)
+    }
+}
+
+void Game::fireTimeEvents(double frameTime)
+{
+    // The event is removed, or a repeating one moved to its next time, before it is fired,
+    // since the listener may schedule and cancel events.
+    TimerWheel::Timer timer;
+    bool finished;
+    while (_timers->next(frameTime, &timer, &finished))
+    {
+        if (timer.listener)
         {
-            timeEvent->listener->timeEvent(frameTime - timeEvent->time, timeEvent->cookie);
+            _firingTimer = timer.handle;
+            timer.listener->timeEvent(frameTime - timer.time, timer.cookie);
+            _firingTimer = 0;
         }
-        _timeEvents->pop();
+
+        // Release the script listener once its event will not fire again.
+        if (finished || !_timers->contains(timer.handle))
+            releaseScriptListener(timer.handle);
     }
 }
 
@@ -562,17 +987,6 @@ void Game::ScriptListener::timeEvent(long timeDiff, void* cookie)
     Game::getInstance()->getScriptController()->executeFunction<void>(function.c_str(), "l", timeDiff);
 }
 
-Game::TimeEvent::TimeEvent(double time, TimeListener* timeListener, void* cookie)
-    : time(time), listener(timeListener), cookie(cookie)
-{
-}
-
-bool Game::TimeEvent::operator<(const TimeEvent& v) const
-{
-    // The first element of std::priority_queue is the greatest.
-    return time > v.time;
-}
-
 Properties* Game::getConfig() const
 {
     if (_properties == NULL)
@@ -596,6 +1010,17 @@ void Game::loadConfig()
             {
                 FileSystem::loadResourceAliases(aliases);
             }
+
+            // Mount packages, each given as a path and a priority.
+            Properties* packages = _properties->getNamespace("packages", true);
+            if (packages)
+            {
+                const char* name;
+                while ((name = packages->getNextProperty()) != NULL)
+                {
+                    FileSystem::mountPackage(name, packages->getInt());
+                }
+            }
         }
         else
         {
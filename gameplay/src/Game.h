@@ -10,6 +10,10 @@
 #include "AnimationController.h"
 #include "PhysicsController.h"
 #include "AIController.h"
+#include "JobController.h"
+#include "IOController.h"
+#include "TextureStreamer.h"
+#include "FrameArena.h"
 #include "AudioListener.h"
 #include "Rectangle.h"
 #include "Vector4.h"
@@ -19,9 +23,31 @@ namespace gameplay
 {
 
 class ScriptController;
+class FramePacket;
+class TimerWheel;
 
 /**
  * Defines the basic game initialization, logic and platform delegates.
+ *
+ * The animation, audio, physics, AI and script controllers are initialized when they are
+ * first used, so that a game does not create a physics world, an audio context or a Lua
+ * state it does not use, and the controllers it does not use are not updated each frame.
+ * The 'subsystems' namespace of the game config can instead initialize a controller at
+ * startup, to avoid the cost of initializing it during the game:
+ *
+ @verbatim
+    subsystems
+    {
+        animation = LAZY        // LAZY (default) or STARTUP
+        audio = LAZY
+        physics = STARTUP
+        ai = LAZY
+        script = STARTUP
+    }
+ @endverbatim
+ *
+ * Controllers must be first used on the main thread; all of them are initialized at startup
+ * when frame pipelining is enabled.
  */
 class Game
 {
@@ -97,6 +123,19 @@ public:
      */
     static double getGameTime();
 
+    /**
+     * Gets the absolute time (in milliseconds) at which the input event being handled occurred.
+     *
+     * Input events are delivered at the start of the frame, so they can be handled some time
+     * after they occurred. Games can compare this time with getAbsoluteTime to compensate for
+     * that delay, for example to place a shot where the target was when the button was pressed.
+     * Platforms that do not timestamp their input events return the current absolute time.
+     *
+     * @return The time of the input event (in milliseconds).
+     * @script{ignore}
+     */
+    static double getInputEventTime();
+
     /**
      * Gets the game state.
      *
@@ -220,7 +259,7 @@ public:
 
     /**
      * Gets the audio controller for managing control of audio
-     * associated with the game.
+     * associated with the game, initializing it on first use.
      *
      * @return The audio controller for this game.
      */
@@ -228,7 +267,7 @@ public:
 
     /**
      * Gets the animation controller for managing control of animations
-     * associated with the game.
+     * associated with the game, initializing it on first use.
      * 
      * @return The animation controller for this game.
      */
@@ -236,7 +275,7 @@ public:
 
     /**
      * Gets the physics controller for managing control of physics
-     * associated with the game.
+     * associated with the game, initializing it on first use.
      * 
      * @return The physics controller for this game.
      */
@@ -244,7 +283,7 @@ public:
 
     /** 
      * Gets the AI controller for managing control of artificial
-     * intelligence associated with the game.
+     * intelligence associated with the game, initializing it on first use.
      *
      * @return The AI controller for this game.
      */
@@ -252,12 +291,160 @@ public:
 
     /**
      * Gets the script controller for managing control of Lua scripts
-     * associated with the game.
+     * associated with the game, initializing it on first use.
      * 
      * @return The script controller for this game.
      */
     inline ScriptController* getScriptController() const;
 
+    /**
+     * Determines whether the script controller has been initialized, without initializing it.
+     *
+     * @return true if the script controller is initialized, false otherwise.
+     * @script{ignore}
+     */
+    inline bool isScriptControllerInitialized() const;
+
+    /**
+     * Gets the job controller for running work on the worker threads
+     * associated with the game.
+     *
+     * @return The job controller for this game.
+     * @script{ignore}
+     */
+    inline JobController* getJobController() const;
+
+    /**
+     * Gets the I/O controller for reading files asynchronously.
+     *
+     * @return The I/O controller for this game.
+     * @script{ignore}
+     */
+    inline IOController* getIOController() const;
+
+    /**
+     * Gets the frame arena, which allocates the memory of temporary data
+     * that is only used during the current frame.
+     *
+     * @return The frame arena for this game.
+     * @script{ignore}
+     */
+    inline FrameArena* getFrameArena() const;
+
+    /**
+     * Gets the texture streamer, which loads the mip levels of textures
+     * within a GPU memory budget.
+     *
+     * @return The texture streamer for this game.
+     * @script{ignore}
+     */
+    inline TextureStreamer* getTextureStreamer() const;
+
+    /**
+     * Sets whether the simulation of each frame overlaps with the rendering of the previous one.
+     *
+     * When frame pipelining is enabled, the animations, physics, AI, Game::update and audio
+     * of a frame run on a worker thread, after which Game::buildFramePacket records what the
+     * frame draws into a FramePacket. Meanwhile the main thread, which owns the GL context,
+     * calls Game::render, which draws the packet built during the previous frame, returned
+     * by getFramePacket(). Gamepads, forms and scripts are updated on the main thread before
+     * the simulation starts.
+     *
+     * Game::update must then not make GL calls, such as loading models or textures, and
+     * Game::render must only draw the packet and user interface, since the scene is being
+     * changed while it runs. Frame pipelining can also be enabled with 'framePipelining = true'
+     * in the graphics namespace of the game config.
+     *
+     * @param enabled True to pipeline frames from the next frame on.
+     * @script{ignore}
+     */
+    void setFramePipelining(bool enabled);
+
+    /**
+     * Determines whether frame pipelining is enabled.
+     *
+     * @return True if the simulation of frames overlaps with rendering.
+     * @script{ignore}
+     */
+    inline bool isFramePipelining() const;
+
+    /**
+     * Gets the frame packet to draw in Game::render when frame pipelining is enabled.
+     *
+     * @return The packet built during the previous frame, or NULL if frame pipelining has
+     *      never been enabled.
+     * @script{ignore}
+     */
+    inline FramePacket* getFramePacket() const;
+
+    /**
+     * Sets the rate at which animations, physics and AI are updated, independently of the frame rate.
+     *
+     * When a fixed update rate is set, the elapsed time of each frame is accumulated, and
+     * the animation, physics and AI controllers and Game::fixedUpdate are run once for each
+     * whole step of the accumulated time, with the step time. Game::update and Game::render
+     * are still called once per frame with the elapsed time of the frame. The time left in
+     * the accumulator after the steps of a frame is returned by getInterpolationAlpha(), so
+     * that render can interpolate between the last two steps.
+     *
+     * To keep the cost of slow frames bounded, at most maxSteps steps are run per frame and
+     * the rest of the accumulated time is dropped, which slows the simulation down rather
+     * than falling further behind.
+     *
+     * @param rate The number of updates per second, or 0 to update once per frame with the
+     *      elapsed time of the frame, which is the default.
+     * @param maxSteps The largest number of steps run in a frame.
+     * @script{ignore}
+     */
+    void setFixedUpdateRate(float rate, unsigned int maxSteps = 5);
+
+    /**
+     * Gets the number of fixed updates per second.
+     *
+     * @return The fixed update rate, or 0 if the simulation is updated once per frame.
+     * @script{ignore}
+     */
+    inline float getFixedUpdateRate() const;
+
+    /**
+     * Gets the largest number of fixed updates run in a frame.
+     *
+     * @return The largest number of steps.
+     * @script{ignore}
+     */
+    inline unsigned int getFixedUpdateMaxSteps() const;
+
+    /**
+     * Gets how far the frame being rendered is between the last fixed update and the next.
+     *
+     * @return The fraction of a step accumulated since the last fixed update, from 0 to 1,
+     *      or 1 if the simulation is updated once per frame.
+     * @script{ignore}
+     */
+    inline float getInterpolationAlpha() const;
+
+    /**
+     * Sets a fixed time that each frame advances the game by, regardless of the time that
+     * actually elapsed.
+     *
+     * Every frame then passes the same elapsed time to the controllers, update and render,
+     * so a run of frames always simulates the same content, which makes benchmarks and
+     * captures repeatable. Time events and getGameTime are not affected.
+     *
+     * @param time The time of each frame in milliseconds, or 0 to use the elapsed time,
+     *      which is the default.
+     * @script{ignore}
+     */
+    void setFixedFrameTime(float time);
+
+    /**
+     * Gets the fixed time that each frame advances the game by.
+     *
+     * @return The time of each frame in milliseconds, or 0 if the elapsed time is used.
+     * @script{ignore}
+     */
+    inline float getFixedFrameTime() const;
+
     /**
      * Gets the audio listener for 3D audio.
      * 
@@ -557,9 +744,11 @@ public:
      * @param timeOffset The number of game milliseconds in the future to schedule the event to be fired.
      * @param timeListener The TimeListener that will receive the event.
      * @param cookie The cookie data that the time event will contain.
+     *
+     * @return The handle of the time event, which can be passed to unschedule().
      * @script{ignore}
      */
-    void schedule(float timeOffset, TimeListener* timeListener, void* cookie = 0);
+    unsigned int schedule(float timeOffset, TimeListener* timeListener, void* cookie = 0);
 
     /**
      * Schedules a time event to be sent to the given TimeListener a given number of game milliseconds from now.
@@ -570,8 +759,58 @@ public:
      * 
      * @param timeOffset The number of game milliseconds in the future to schedule the event to be fired.
      * @param function The Lua script function that will receive the event.
+     *
+     * @return The handle of the time event, which can be passed to unschedule().
      */
-    void schedule(float timeOffset, const char* function);
+    unsigned int schedule(float timeOffset, const char* function);
+
+    /**
+     * Schedules a time event to be sent to the given TimeListener every given number of game milliseconds,
+     * until it is unscheduled. The first event is fired one interval from now.
+     *
+     * Events are fired on the same period however long the frames are, and at most once a frame, so the
+     * intervals the game misses during a long frame are skipped.
+     *
+     * @param interval The number of game milliseconds between the events.
+     * @param timeListener The TimeListener that will receive the events.
+     * @param cookie The cookie data that the time events will contain.
+     *
+     * @return The handle of the time event, which can be passed to unschedule().
+     * @script{ignore}
+     */
+    unsigned int scheduleRepeating(float interval, TimeListener* timeListener, void* cookie = 0);
+
+    /**
+     * Schedules a time event to be sent to the given Lua function every given number of game milliseconds,
+     * until it is unscheduled. The first event is fired one interval from now.
+     *
+     * @param interval The number of game milliseconds between the events.
+     * @param function The Lua script function that will receive the events.
+     *
+     * @return The handle of the time event, which can be passed to unschedule().
+     */
+    unsigned int scheduleRepeating(float interval, const char* function);
+
+    /**
+     * Cancels a time event that was scheduled, so it is not fired.
+     *
+     * A time event that is not repeating can no longer be cancelled once it has been fired.
+     *
+     * @param handle The handle returned when the time event was scheduled.
+     *
+     * @return True if the time event was cancelled, false if it had already been fired or cancelled.
+     */
+    bool unschedule(unsigned int handle);
+
+    /**
+     * Cancels all of the time events scheduled for a TimeListener.
+     *
+     * A listener that schedules time events should call this before it is destroyed.
+     *
+     * @param timeListener The TimeListener.
+     * @script{ignore}
+     */
+    void unschedule(TimeListener* timeListener);
 
     /**
      * Opens an URL in an external browser, if available.
@@ -609,6 +848,18 @@ protected:
      */
     virtual void update(float elapsedTime) = 0;
 
+    /**
+     * Fixed update callback for handling simulation at a constant rate.
+     *
+     * Called after the animation, physics and AI controllers are updated for each step when
+     * a fixed update rate is set (see Game::setFixedUpdateRate), before update. The default
+     * implementation does nothing.
+     *
+     * @param stepTime The time of a step, in milliseconds.
+     * @script{ignore}
+     */
+    virtual void fixedUpdate(float stepTime);
+
     /**
      * Render callback for handling rendering routines.
      *
@@ -619,6 +870,18 @@ protected:
      */
     virtual void render(float elapsedTime) = 0;
 
+    /**
+     * Frame packet callback for recording what a frame draws when frame pipelining is enabled.
+     *
+     * Called on a worker thread just after update, once per frame when game is running.
+     * The packet is empty, and is drawn by Game::render during the next frame. The default
+     * implementation adds nothing.
+     *
+     * @param packet The packet to add the draw items of the frame to.
+     * @script{ignore}
+     */
+    virtual void buildFramePacket(FramePacket* packet);
+
     /**
      * Renders a single frame once and then swaps it to the display.
      *
@@ -671,17 +934,31 @@ private:
 	};
 
     /**
-     * TimeEvent represents the event that is sent to TimeListeners as a result of calling Game::schedule().
+     * The subsystems that are initialized on first use.
+     */
+    enum Subsystem
+    {
+        ANIMATION_SUBSYSTEM = 1,
+        AUDIO_SUBSYSTEM = 2,
+        PHYSICS_SUBSYSTEM = 4,
+        AI_SUBSYSTEM = 8,
+        SCRIPT_SUBSYSTEM = 16,
+        ALL_SUBSYSTEMS = 31,
+        SUBSYSTEM_COUNT = 5
+    };
+
+    /**
+     * Runs the simulation of a pipelined frame on a worker thread.
      */
-    class TimeEvent
+    struct SimulationJob : public JobController::Job
     {
-    public:
+        /**
+         * @see JobController::Job::run
+         */
+        void run();
 
-        TimeEvent(double time, TimeListener* timeListener, void* cookie);
-        bool operator<(const TimeEvent& v) const;
-        double time;
-        TimeListener* listener;
-        void* cookie;
+        Game* game;
+        float elapsedTime;
     };
 
     /**
@@ -701,6 +978,16 @@ private:
      */
     void shutdown();
 
+    /**
+     * Schedules a time event for a Lua script function.
+     */
+    unsigned int scheduleScript(float timeOffset, float interval, const char* function);
+
+    /**
+     * Deletes the script listener of a time event, if it has one.
+     */
+    void releaseScriptListener(unsigned int handle);
+
     /**
      * Fires the time events that were scheduled to be called.
      * 
@@ -718,6 +1005,35 @@ private:
      */
     void loadGamepads();
 
+    /**
+     * Runs a frame whose simulation overlaps with the rendering of the previous frame.
+     *
+     * @param elapsedTime The elapsed game time.
+     */
+    void framePipelined(float elapsedTime);
+
+    /**
+     * Updates the simulation of a pipelined frame and builds its frame packet.
+     *
+     * @param elapsedTime The elapsed game time.
+     */
+    void simulate(float elapsedTime);
+
+    /**
+     * Updates the animation, physics and AI controllers for a frame, in fixed steps if a
+     * fixed update rate is set.
+     *
+     * @param elapsedTime The elapsed game time.
+     */
+    void updateControllers(float elapsedTime);
+
+    /**
+     * Initializes the controllers of subsystems that have not been initialized yet.
+     *
+     * @param subsystems A combination of Subsystem flags.
+     */
+    void initializeSubsystems(unsigned int subsystems);
+
     bool _initialized;                          // If game has initialized yet.
     State _state;                               // The game state.
     unsigned int _pausedCount;                  // Number of times pause() has been called.
@@ -737,10 +1053,24 @@ private:
     AudioController* _audioController;          // Controls audio sources that are playing in the game.
     PhysicsController* _physicsController;      // Controls the simulation of a physics scene and entities.
     AIController* _aiController;                // Controls AI simulation.
+    unsigned int _lazySubsystems;               // The subsystems that are initialized when they are first used.
+    JobController* _jobController;              // Runs jobs on the worker threads.
+    IOController* _ioController;                // Reads files on the I/O thread.
+    TextureStreamer* _textureStreamer;          // Streams the mip levels of textures.
+    FrameArena* _frameArena;                    // Allocates the memory used during one frame.
+    bool _framePipelining;                      // If simulation overlaps with rendering.
+    FramePacket* _framePackets[2];              // The packet drawn this frame, and the one being built.
+    SimulationJob* _simulationJob;              // The job simulating a pipelined frame.
+    float _fixedUpdateStep;                     // The time of a fixed update step, or 0.
+    unsigned int _fixedUpdateMaxSteps;          // The largest number of fixed updates per frame.
+    float _fixedUpdateTime;                     // The time accumulated since the last fixed update.
+    float _interpolationAlpha;                  // The fraction of a step accumulated.
+    float _fixedFrameTime;                      // The time each frame advances the game by, or 0.
     AudioListener* _audioListener;              // The audio listener in 3D space.
-    std::priority_queue<TimeEvent, std::vector<TimeEvent>, std::less<TimeEvent> >* _timeEvents;     // Contains the scheduled time events.
+    TimerWheel* _timers;                        // Contains the scheduled time events.
+    unsigned int _firingTimer;                  // The handle of the time event being fired, or 0.
     ScriptController* _scriptController;            // Controls the scripting engine.
-    std::vector<ScriptListener*>* _scriptListeners; // Lua script listeners.
+    std::map<unsigned int, ScriptListener*>* _scriptListeners; // Lua script listeners, by the handle of their time event.
 
     // Note: Do not add STL object member variables on the stack; this will cause false memory leaks to be reported.
 
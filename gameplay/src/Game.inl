@@ -41,28 +41,93 @@ inline const Rectangle& Game::getViewport() const
 
 inline AnimationController* Game::getAnimationController() const
 {
+    if (_lazySubsystems & ANIMATION_SUBSYSTEM)
+        const_cast<Game*>(this)->initializeSubsystems(ANIMATION_SUBSYSTEM);
     return _animationController;
 }
 
 inline AudioController* Game::getAudioController() const
 {
+    if (_lazySubsystems & AUDIO_SUBSYSTEM)
+        const_cast<Game*>(this)->initializeSubsystems(AUDIO_SUBSYSTEM);
     return _audioController;
 }
 
 inline PhysicsController* Game::getPhysicsController() const
 {
+    if (_lazySubsystems & PHYSICS_SUBSYSTEM)
+        const_cast<Game*>(this)->initializeSubsystems(PHYSICS_SUBSYSTEM);
     return _physicsController;
 }
 
 inline ScriptController* Game::getScriptController() const
 {
+    if (_lazySubsystems & SCRIPT_SUBSYSTEM)
+        const_cast<Game*>(this)->initializeSubsystems(SCRIPT_SUBSYSTEM);
     return _scriptController;
 }
+
+inline bool Game::isScriptControllerInitialized() const
+{
+    return _scriptController != NULL;
+}
 inline AIController* Game::getAIController() const
 {
+    if (_lazySubsystems & AI_SUBSYSTEM)
+        const_cast<Game*>(this)->initializeSubsystems(AI_SUBSYSTEM);
     return _aiController;
 }
 
+inline JobController* Game::getJobController() const
+{
+    return _jobController;
+}
+
+inline IOController* Game::getIOController() const
+{
+    return _ioController;
+}
+
+inline FrameArena* Game::getFrameArena() const
+{
+    return _frameArena;
+}
+
+inline bool Game::isFramePipelining() const
+{
+    return _framePipelining;
+}
+
+inline FramePacket* Game::getFramePacket() const
+{
+    return _framePackets[0];
+}
+
+inline float Game::getFixedUpdateRate() const
+{
+    return _fixedUpdateStep > 0.0f ? 1000.0f / _fixedUpdateStep : 0.0f;
+}
+
+inline unsigned int Game::getFixedUpdateMaxSteps() const
+{
+    return _fixedUpdateMaxSteps;
+}
+
+inline float Game::getFixedFrameTime() const
+{
+    return _fixedFrameTime;
+}
+
+inline float Game::getInterpolationAlpha() const
+{
+    return _interpolationAlpha;
+}
+
+inline TextureStreamer* Game::getTextureStreamer() const
+{
+    return _textureStreamer;
+}
+
 template <class T>
 void Game::renderOnce(T* instance, void (T::*method)(void*), void* cookie)
 {
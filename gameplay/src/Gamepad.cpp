@@ -5,15 +5,82 @@
 #include "Platform.h"
 #include "Form.h"
 #include "Joystick.h"
+#include "Mutex.h"
+
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
 
 namespace gameplay
 {
 
 static std::vector<Gamepad*> __gamepads;
 
+Gamepad::Poller* Gamepad::_poller = NULL;
+
+static void memoryBarrier()
+{
+#ifdef WIN32
+    MemoryBarrier();
+#else
+    __sync_synchronize();
+#endif
+}
+
+struct Gamepad::Poller
+{
+    unsigned int frequency;
+    volatile bool quit;
+    Mutex mutex;                        // Guards __gamepads while the input thread polls.
+#ifdef WIN32
+    HANDLE thread;
+
+    void sleep(unsigned int milliseconds) { Sleep(milliseconds); }
+
+    static DWORD WINAPI run(LPVOID data)
+    {
+        static_cast<Poller*>(data)->loop();
+        return 0;
+    }
+#else
+    pthread_t thread;
+
+    void sleep(unsigned int milliseconds) { usleep(milliseconds * 1000); }
+
+    static void* run(void* data)
+    {
+        static_cast<Poller*>(data)->loop();
+        return NULL;
+    }
+#endif
+
+    void loop()
+    {
+        unsigned int interval = std::max(1000u / frequency, 1u);
+        while (!quit)
+        {
+            mutex.lock();
+            for (size_t i = 0, count = __gamepads.size(); i < count; ++i)
+            {
+                Gamepad* gamepad = __gamepads[i];
+                if (gamepad->_polled)
+                {
+                    Platform::pollGamepadState(gamepad->_polled);
+                    gamepad->publishState();
+                }
+            }
+            mutex.unlock();
+            sleep(interval);
+        }
+    }
+};
+
 Gamepad::Gamepad(const char* formPath)
     : _handle((GamepadHandle)INT_MAX), _buttonCount(0), _joystickCount(0), _triggerCount(0), _vendorId(0), _productId(0),
-      _form(NULL), _buttons(0)
+      _form(NULL), _buttons(0), _polled(NULL), _pollingCopy(false), _sequence(0)
 {
     GP_ASSERT(formPath);
     _form = Form::create(formPath);
@@ -40,7 +107,7 @@ Gamepad::Gamepad(const char* formPath)
 Gamepad::Gamepad(GamepadHandle handle, unsigned int buttonCount, unsigned int joystickCount, unsigned int triggerCount,
                  unsigned int vendorId, unsigned int productId, const char* vendorString, const char* productString)
     : _handle(handle), _buttonCount(buttonCount), _joystickCount(joystickCount), _triggerCount(triggerCount),
-      _vendorId(vendorId), _productId(productId), _form(NULL), _buttons(0)
+      _vendorId(vendorId), _productId(productId), _form(NULL), _buttons(0), _polled(NULL), _pollingCopy(false), _sequence(0)
 {
     if (vendorString)
     {
@@ -64,6 +131,7 @@ Gamepad::~Gamepad()
     {
         SAFE_RELEASE(_form);
     }
+    SAFE_DELETE(_polled);
 }
 
 Gamepad* Gamepad::add(GamepadHandle handle, unsigned int buttonCount, unsigned int joystickCount, unsigned int triggerCount,
@@ -72,7 +140,17 @@ Gamepad* Gamepad::add(GamepadHandle handle, unsigned int buttonCount, unsigned i
 {
     Gamepad* gamepad = new Gamepad(handle, buttonCount, joystickCount, triggerCount, vendorId, productId, vendorString, productString);
 
-    __gamepads.push_back(gamepad);
+    if (_poller)
+    {
+        gamepad->setPolled(true);
+        _poller->mutex.lock();
+        __gamepads.push_back(gamepad);
+        _poller->mutex.unlock();
+    }
+    else
+    {
+        __gamepads.push_back(gamepad);
+    }
     Game::getInstance()->gamepadEvent(CONNECTED_EVENT, gamepad);
     return gamepad;
 }
@@ -94,7 +172,11 @@ void Gamepad::remove(GamepadHandle handle)
         Gamepad* gamepad = *it;
         if (gamepad->_handle == handle)
         {
+            if (_poller)
+                _poller->mutex.lock();
             it = __gamepads.erase(it);
+            if (_poller)
+                _poller->mutex.unlock();
             Game::getInstance()->gamepadEvent(DISCONNECTED_EVENT, gamepad);
             SAFE_DELETE(gamepad);
         }
@@ -113,7 +195,11 @@ void Gamepad::remove(Gamepad* gamepad)
         Gamepad* g = *it;
         if (g == gamepad)
         {
+            if (_poller)
+                _poller->mutex.lock();
             it = __gamepads.erase(it);
+            if (_poller)
+                _poller->mutex.unlock();
             Game::getInstance()->gamepadEvent(DISCONNECTED_EVENT, g);
             SAFE_DELETE(gamepad);
         }
@@ -276,7 +362,10 @@ void Gamepad::update(float elapsedTime)
 {
     if (!_form)
     {
-        Platform::pollGamepadState(this);
+        if (_polled)
+            readState();
+        else
+            Platform::pollGamepadState(this);
     }
 }
 
@@ -389,7 +478,8 @@ void Gamepad::setButtons(unsigned int buttons)
     if (buttons != _buttons)
     {
         _buttons = buttons;
-        Platform::gamepadEventInternal(BUTTON_EVENT, this);
+        if (!_pollingCopy)
+            Platform::gamepadEventInternal(BUTTON_EVENT, this);
     }
 }
 
@@ -398,7 +488,8 @@ void Gamepad::setJoystickValue(unsigned int index, float x, float y)
     if (_joysticks[index].x != x || _joysticks[index].y != y)
     {
         _joysticks[index].set(x, y);
-        Platform::gamepadEventInternal(JOYSTICK_EVENT, this, index);
+        if (!_pollingCopy)
+            Platform::gamepadEventInternal(JOYSTICK_EVENT, this, index);
     }
 }
 
@@ -407,7 +498,126 @@ void Gamepad::setTriggerValue(unsigned int index, float value)
     if (_triggers[index] != value)
     {
         _triggers[index] = value;
-        Platform::gamepadEventInternal(TRIGGER_EVENT, this, index);
+        if (!_pollingCopy)
+            Platform::gamepadEventInternal(TRIGGER_EVENT, this, index);
+    }
+}
+
+void Gamepad::setPollingFrequency(unsigned int frequency)
+{
+    if (_poller)
+    {
+        if (_poller->frequency == frequency)
+            return;
+
+        _poller->quit = true;
+#ifdef WIN32
+        WaitForSingleObject(_poller->thread, INFINITE);
+        CloseHandle(_poller->thread);
+#else
+        pthread_join(_poller->thread, NULL);
+#endif
+        SAFE_DELETE(_poller);
+        for (size_t i = 0, count = __gamepads.size(); i < count; ++i)
+        {
+            __gamepads[i]->setPolled(false);
+        }
+    }
+
+    if (frequency == 0)
+        return;
+
+    for (size_t i = 0, count = __gamepads.size(); i < count; ++i)
+    {
+        __gamepads[i]->setPolled(true);
+    }
+    _poller = new Poller();
+    _poller->frequency = frequency;
+    _poller->quit = false;
+#ifdef WIN32
+    _poller->thread = CreateThread(NULL, 0, Poller::run, _poller, 0, NULL);
+    bool started = _poller->thread != NULL;
+#else
+    bool started = pthread_create(&_poller->thread, NULL, Poller::run, _poller) == 0;
+#endif
+    if (!started)
+    {
+        GP_WARN("Failed to create the gamepad polling thread; polling on the main thread.");
+        SAFE_DELETE(_poller);
+        for (size_t i = 0, count = __gamepads.size(); i < count; ++i)
+        {
+            __gamepads[i]->setPolled(false);
+        }
+    }
+}
+
+unsigned int Gamepad::getPollingFrequency()
+{
+    return _poller ? _poller->frequency : 0;
+}
+
+void Gamepad::setPolled(bool polled)
+{
+    if (!polled)
+    {
+        SAFE_DELETE(_polled);
+        return;
+    }
+    if (_form || _polled)
+        return;
+
+    // The copy starts from the current state, so the first snapshot only differs by what changed since.
+    _polled = new Gamepad(_handle, _buttonCount, _joystickCount, _triggerCount, _vendorId, _productId, _vendorString.c_str(), _productString.c_str());
+    _polled->_pollingCopy = true;
+    _polled->_buttons = _buttons;
+    for (int i = 0; i < 2; ++i)
+    {
+        _polled->_joysticks[i] = _joysticks[i];
+        _polled->_triggers[i] = _triggers[i];
+    }
+    _sequence = 0;
+    publishState();
+}
+
+void Gamepad::publishState()
+{
+    GP_ASSERT(_polled);
+
+    // The sequence is odd while the state is written, so readState can detect a torn read and retry.
+    unsigned int sequence = _sequence;
+    _sequence = sequence + 1;
+    memoryBarrier();
+    _state.buttons = _polled->_buttons;
+    for (int i = 0; i < 2; ++i)
+    {
+        _state.joysticks[i] = _polled->_joysticks[i];
+        _state.triggers[i] = _polled->_triggers[i];
+    }
+    memoryBarrier();
+    _sequence = sequence + 2;
+}
+
+void Gamepad::readState()
+{
+    State state;
+    unsigned int sequence;
+    do
+    {
+        sequence = _sequence;
+        memoryBarrier();
+        state = _state;
+        memoryBarrier();
+    } while ((sequence & 1) != 0 || sequence != _sequence);
+
+    // The events are sent here, on the main thread.
+    setButtons(state.buttons);
+    for (unsigned int i = 0; i < _joystickCount && i < 2; ++i)
+    {
+        setJoystickValue(i, state.joysticks[i].x, state.joysticks[i].y);
+    }
+    for (unsigned int i = 0; i < _triggerCount && i < 2; ++i)
+    {
+        setTriggerValue(i, state.triggers[i]);
     }
 }
 
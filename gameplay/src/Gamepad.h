@@ -168,8 +168,44 @@ public:
      */
     void draw();
 
+    /**
+     * Sets how often physical gamepads are polled on a background input thread.
+     *
+     * By default physical gamepads are polled on the main thread in update(), so input is
+     * sampled at the frame rate. With a polling frequency, an input thread polls the devices at
+     * that rate and publishes their latest state, which update() copies without taking a lock.
+     * Gamepad events are still sent on the main thread, from update().
+     *
+     * @param frequency The number of polls per second, or zero to poll on the main thread.
+     * @script{ignore}
+     */
+    static void setPollingFrequency(unsigned int frequency);
+
+    /**
+     * Returns how often physical gamepads are polled on the input thread.
+     *
+     * @return The number of polls per second, or zero when gamepads are polled on the main thread.
+     * @script{ignore}
+     */
+    static unsigned int getPollingFrequency();
+
 private:
 
+    /**
+     * The input thread that polls physical gamepads.
+     */
+    struct Poller;
+
+    /**
+     * The state of a physical gamepad published by the input thread.
+     */
+    struct State
+    {
+        unsigned int buttons;
+        Vector2 joysticks[2];
+        float triggers[2];
+    };
+
     /**
      * Constructs a gamepad from the specified .form file.
      *
@@ -231,6 +267,21 @@ private:
     
     void bindGamepadControls(Container* container);
 
+    /**
+     * Creates or destroys the copy of the gamepad that the input thread polls.
+     */
+    void setPolled(bool polled);
+
+    /**
+     * Publishes the state of the polled copy. Called on the input thread.
+     */
+    void publishState();
+
+    /**
+     * Sets the gamepad to the state last published by the input thread.
+     */
+    void readState();
+
     GamepadHandle _handle;        // The handle of the Gamepad.
     unsigned int _buttonCount;    // Number of buttons.
     unsigned int _joystickCount;  // Number of joysticks.
@@ -245,6 +296,11 @@ private:
     unsigned int _buttons;
     Vector2 _joysticks[2];
     float _triggers[2];
+    Gamepad* _polled;                   // The copy of the gamepad that the input thread polls, or NULL.
+    bool _pollingCopy;                  // Whether this is a polled copy, which sends no events.
+    State _state;                       // The state last published by the input thread.
+    volatile unsigned int _sequence;    // Odd while the input thread writes _state.
+    static Poller* _poller;             // The input thread, or NULL when gamepads are polled on the main thread.
 };
 
 }
@@ -7,14 +7,20 @@ namespace gameplay
 {
 
 HeightField::HeightField(unsigned int columns, unsigned int rows)
-    : _array(NULL), _cols(columns), _rows(rows)
+    : _array(NULL), _cols(columns), _rows(rows), _stream(NULL), _data(NULL), _bits(0), _heightMin(0), _heightScale(1)
 {
     _array = new float[columns * rows];
 }
 
+HeightField::HeightField(unsigned int columns, unsigned int rows, Stream* stream, const unsigned char* data, unsigned int bits, float heightMin, float heightScale)
+    : _array(NULL), _cols(columns), _rows(rows), _stream(stream), _data(data), _bits(bits), _heightMin(heightMin), _heightScale(heightScale)
+{
+}
+
 HeightField::~HeightField()
 {
     SAFE_DELETE_ARRAY(_array);
+    SAFE_DELETE(_stream);
 }
 
 HeightField* HeightField::create(unsigned int columns, unsigned int rows)
@@ -35,6 +41,114 @@ float normalizedHeightPacked(float r, float g, float b)
     return (256.0f*r + g + 0.00390625f*b) / 65536.0f;
 }
 
+/**
+ * Converts consecutive samples of a RAW file to heights.
+ *
+ * @script{ignore}
+ */
+static void convertRAW(const unsigned char* data, unsigned int bits, unsigned int index, unsigned int count, float heightMin, float heightScale, float* heights)
+{
+    if (bits == 32)
+    {
+        // 32-bit float (0-1)
+        const unsigned char* bytes = data + (index << 2);
+        float value;
+        for (unsigned int i = 0; i < count; ++i, bytes += 4)
+        {
+            memcpy(&value, bytes, sizeof(float));
+            heights[i] = heightMin + value * heightScale;
+        }
+    }
+    else if (bits == 16)
+    {
+        // 16-bit (0-65535)
+        const unsigned char* bytes = data + (index << 1);
+        for (unsigned int i = 0; i < count; ++i, bytes += 2)
+        {
+            heights[i] = heightMin + ((bytes[0] | (int)bytes[1] << 8) / 65535.0f) * heightScale;
+        }
+    }
+    else
+    {
+        // 8-bit (0-255)
+        const unsigned char* bytes = data + index;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            heights[i] = heightMin + (bytes[i] / 255.0f) * heightScale;
+        }
+    }
+}
+
+/**
+ * Reads single heights from the samples of a mapped RAW file.
+ *
+ * @script{ignore}
+ */
+struct RawSamples
+{
+    const unsigned char* data;
+    unsigned int bits;
+    float heightMin;
+    float heightScale;
+
+    float operator[](unsigned int index) const
+    {
+        float height;
+        convertRAW(data, bits, index, 1, heightMin, heightScale, &height);
+        return height;
+    }
+};
+
+/**
+ * Samples the heights of a heightfield at a number of points (see HeightField::getHeights).
+ *
+ * The samples are either an array of floats or the samples of a mapped RAW file.
+ *
+ * @script{ignore}
+ */
+template <class Samples>
+static void sampleHeights(const Samples& samples, unsigned int cols, unsigned int rows,
+                          const float* columns, const float* pointRows, unsigned int count, float* heights, Vector3* normals)
+{
+    // The first sample of each point is clamped to one before the last row and column, so
+    // the point is always between two samples and a point on the edge has a factor of one.
+    const float maxColumn = (float)(cols - 1);
+    const float maxRow = (float)(rows - 1);
+    const unsigned int lastColumn = cols > 1 ? cols - 2 : 0;
+    const unsigned int lastRow = rows > 1 ? rows - 2 : 0;
+    const unsigned int columnStep = cols > 1 ? 1 : 0;
+    const unsigned int rowStep = rows > 1 ? cols : 0;
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        const float column = std::min(std::max(columns[i], 0.0f), maxColumn);
+        const float row = std::min(std::max(pointRows[i], 0.0f), maxRow);
+        const unsigned int x = std::min((unsigned int)column, lastColumn);
+        const unsigned int y = std::min((unsigned int)row, lastRow);
+        const float xFactor = column - x;
+        const float yFactor = row - y;
+
+        const unsigned int h = x + y * cols;
+        const float h11 = samples[h];
+        const float h21 = samples[h + columnStep];
+        const float h12 = samples[h + rowStep];
+        const float h22 = samples[h + rowStep + columnStep];
+
+        const float top = h11 + (h21 - h11) * xFactor;
+        const float bottom = h12 + (h22 - h12) * xFactor;
+        heights[i] = top + (bottom - top) * yFactor;
+
+        if (normals)
+        {
+            // The normal is perpendicular to the slopes of the bilinear surface at the point.
+            const float slopeX = (h21 - h11) + ((h22 - h12) - (h21 - h11)) * yFactor;
+            const float slopeZ = bottom - top;
+            normals[i].set(-slopeX, 1.0f, -slopeZ);
+            normals[i].normalize();
+        }
+    }
+}
+
 HeightField* HeightField::createFromImage(const char* path, float heightMin, float heightMax)
 {
     return create(path, 0, 0, heightMin, heightMax);
@@ -94,7 +208,7 @@ HeightField* HeightField::create(const char* path, unsigned int width, unsigned
 
         SAFE_RELEASE(image);
     }
-    else if (ext == ".RAW" || ext == ".R16")
+    else if (ext == ".RAW" || ext == ".R16" || ext == ".R32")
     {
         // RAW image (headerless)
         if (width < 2 || height < 2 || heightMax < 0)
@@ -103,53 +217,47 @@ HeightField* HeightField::create(const char* path, unsigned int width, unsigned
             return NULL;
         }
 
-        // Load raw bytes
-        int fileSize = 0;
-        unsigned char* bytes = (unsigned char*)FileSystem::readAll(path, &fileSize);
-        if (bytes == NULL)
+        // Map the file into memory where possible, so that its heights are converted where
+        // they are read instead of all being copied to floats when it is loaded.
+        Stream* stream = FileSystem::open(path, FileSystem::READ | FileSystem::MAP);
+        if (stream == NULL)
         {
-            GP_WARN("Falied to read bytes from RAW heightfield image: %s.", path);
+            GP_WARN("Failed to open RAW heightfield image: %s.", path);
             return NULL;
         }
 
-        // Determine if the RAW file is 8-bit or 16-bit based on file size.
-        int bits = (fileSize / (width * height)) * 8;
-        if (bits != 8 && bits != 16)
+        // Determine if the RAW file is 8-bit, 16-bit or 32-bit based on file size.
+        size_t fileSize = stream->length();
+        unsigned int bits = (unsigned int)(fileSize / (width * height)) * 8;
+        if (bits != 8 && bits != 16 && bits != 32)
         {
-            GP_WARN("Invalid RAW file - must be 8-bit or 16-bit, but found neither: %s.", path);
-            SAFE_DELETE_ARRAY(bytes);
+            GP_WARN("Invalid RAW file - must be 8-bit, 16-bit or 32-bit, but found none: %s.", path);
+            SAFE_DELETE(stream);
             return NULL;
         }
 
-        heightfield = HeightField::create(width, height);
-        float* heights = heightfield->getArray();
-
-        if (bits == 16)
+        const unsigned char* data = (const unsigned char*)stream->readDirect(fileSize);
+        if (data)
         {
-            // 16-bit (0-65535)
-            int idx;
-            for (unsigned int y = 0, i = 0; y < height; ++y)
-            {
-                for (unsigned int x = 0; x < width; ++x, ++i)
-                {
-                    idx = (y * width + x) << 1;
-                    heights[i] = heightMin + ((bytes[idx] | (int)bytes[idx+1] << 8) / 65535.0f) * heightScale;
-                }
-            }
+            heightfield = new HeightField(width, height, stream, data, bits, heightMin, heightScale);
         }
         else
         {
-            // 8-bit (0-255)
-            for (unsigned int y = 0, i = 0; y < height; ++y)
+            // The file is not mapped, so read it and convert all of its heights.
+            unsigned char* bytes = new unsigned char[fileSize];
+            size_t read = stream->read(bytes, 1, fileSize);
+            SAFE_DELETE(stream);
+            if (read != fileSize)
             {
-                for (unsigned int x = 0; x < width; ++x, ++i)
-                {
-                    heights[i] = heightMin + (bytes[y * width + x] / 255.0f) * heightScale;
-                }
+                GP_WARN("Falied to read bytes from RAW heightfield image: %s.", path);
+                SAFE_DELETE_ARRAY(bytes);
+                return NULL;
             }
-        }
 
-        SAFE_DELETE_ARRAY(bytes);
+            heightfield = HeightField::create(width, height);
+            convertRAW(bytes, bits, 0, width * height, heightMin, heightScale, heightfield->getArray());
+            SAFE_DELETE_ARRAY(bytes);
+        }
     }
     else
     {
@@ -161,11 +269,23 @@ HeightField* HeightField::create(const char* path, unsigned int width, unsigned
 
 float* HeightField::getArray() const
 {
+    if (_array == NULL)
+    {
+        _array = new float[_cols * _rows];
+        convertRAW(_data, _bits, 0, _cols * _rows, _heightMin, _heightScale, _array);
+    }
     return _array;
 }
 
 float HeightField::getHeight(float column, float row) const
 {
+    if (_array == NULL)
+    {
+        float height;
+        getHeights(&column, &row, 1, &height);
+        return height;
+    }
+
     // Clamp to heightfield boundaries
     column = column < 0 ? 0 : (column > (_cols-1) ? (_cols-1) : column);
     row = row < 0 ? 0 : (row > (_rows-1) ? (_rows-1) : row);
@@ -203,6 +323,44 @@ float HeightField::getHeight(float column, float row) const
     }
 }
 
+void HeightField::getHeights(const float* columns, const float* rows, unsigned int count, float* heights, Vector3* normals) const
+{
+    GP_ASSERT(columns);
+    GP_ASSERT(rows);
+    GP_ASSERT(heights);
+
+    if (_array)
+    {
+        const float* samples = _array;
+        sampleHeights(samples, _cols, _rows, columns, rows, count, heights, normals);
+    }
+    else
+    {
+        RawSamples samples = { _data, _bits, _heightMin, _heightScale };
+        sampleHeights(samples, _cols, _rows, columns, rows, count, heights, normals);
+    }
+}
+
+void HeightField::getBlock(unsigned int column, unsigned int row, unsigned int columnCount, unsigned int rowCount, float* heights) const
+{
+    GP_ASSERT(heights);
+    GP_ASSERT(column + columnCount <= _cols && row + rowCount <= _rows);
+
+    for (unsigned int y = 0; y < rowCount; ++y, heights += columnCount)
+    {
+        const unsigned int index = column + (row + y) * _cols;
+        if (_array)
+            memcpy(heights, _array + index, columnCount * sizeof(float));
+        else
+            convertRAW(_data, _bits, index, columnCount, _heightMin, _heightScale, heights);
+    }
+}
+
+bool HeightField::isMapped() const
+{
+    return _data != NULL;
+}
+
 unsigned int HeightField::getColumnCount() const
 {
     return _cols;
@@ -2,10 +2,13 @@
 #define HEIGHTFIELD_H_
 
 #include "Ref.h"
+#include "Vector3.h"
 
 namespace gameplay
 {
 
+    class Stream;
+
     /**
      * Defines a reference counted class that holds heightfeild data.
      *
@@ -46,13 +49,17 @@ namespace gameplay
         static HeightField* createFromImage(const char* path, float heightMin = 0, float heightMax = 1);
 
         /**
-         * Creates a HeightField from the specified RAW8 or RAW16 file.
+         * Creates a HeightField from the specified RAW8, RAW16 or RAW32 file.
          *
          * RAW files are header-less files containing intensity values, either in 8-bit (RAW8)
-         * or 16-bit (RAW16) format. RAW16 files must have little endian (PC) byte ordering. Since
-         * RAW files have no header, you must specify the dimensions of the data in the file.
-         * This method automatically determines (based on file size) whether the input file
-         * is RAW8 or RAW16. RAW files must have a .raw or .r16 file extension.
+         * or 16-bit (RAW16) format, or as 32-bit floats from 0 to 1 (RAW32). RAW16 and RAW32
+         * files must have little endian (PC) byte ordering. Since RAW files have no header, you
+         * must specify the dimensions of the data in the file. This method automatically
+         * determines (based on file size) whether the input file is RAW8, RAW16 or RAW32. RAW
+         * files must have a .raw, .r16 or .r32 file extension.
+         *
+         * The file is mapped into memory where the platform allows it, in which case its heights
+         * are only converted to floats where they are read (see isMapped()).
          *
          * RAW files are commonly used in software that produces heightmap images. Using RAW16 is 
          * preferred or any 8-bit heightfield source since it allows greater precision, resulting in
@@ -62,7 +69,7 @@ namespace gameplay
          * intensity to height values. The minHeight parameter is mapped to zero intensity
          * pixel, while maxHeight maxHeight is mapped to full intensity pixels.
          *
-         * @param path Path to the RAW file (must end in a .raw or .r16 file extension).
+         * @param path Path to the RAW file (must end in a .raw, .r16 or .r32 file extension).
          * @param width Width of the RAW data.
          * @param height Height of the RAW data.
          * @param heightMin Minimum height value for a zero intensity pixel.
@@ -78,6 +85,9 @@ namespace gameplay
          * The array is packed in row major order, meaning that the data is aligned in rows,
          * from top left to bottom right.
          *
+         * The heights of a mapped heightfield are all converted to floats the first time this
+         * is called, so getBlock() should be used to read parts of large mapped heightfields.
+         *
          * @return The underlying height array.
          */
         float* getArray() const;
@@ -99,6 +109,46 @@ namespace gameplay
          */
         float getHeight(float column, float row) const;
 
+        /**
+         * Returns the heights at a number of points, as getHeight() returns the height at one
+         * point, and optionally the normals of the heightfield at the points.
+         *
+         * The points are clamped and filtered without branches, so that large batches of
+         * queries, such as the wheels of vehicles or the placement of foliage, are cheap.
+         *
+         * @param columns The columns of the points.
+         * @param rows The rows of the points.
+         * @param count The number of points.
+         * @param heights Destination array of count heights.
+         * @param normals Optional destination array of count unit normals, in the space where
+         *      columns and rows are one unit apart and heights are in the units of the array.
+         * @script{ignore}
+         */
+        void getHeights(const float* columns, const float* rows, unsigned int count, float* heights, Vector3* normals = NULL) const;
+
+        /**
+         * Copies the heights of a block of rows and columns to an array.
+         *
+         * The heights of a mapped heightfield are converted from the mapped file, without
+         * converting the rest of the heightfield.
+         *
+         * @param column The first column of the block.
+         * @param row The first row of the block.
+         * @param columnCount The number of columns of the block.
+         * @param rowCount The number of rows of the block.
+         * @param heights Destination array of columnCount * rowCount heights, in row major order.
+         * @script{ignore}
+         */
+        void getBlock(unsigned int column, unsigned int row, unsigned int columnCount, unsigned int rowCount, float* heights) const;
+
+        /**
+         * Determines whether the heights are read from a RAW file mapped into memory, rather
+         * than from an array of floats.
+         *
+         * @return true if the heightfield is mapped, false otherwise.
+         */
+        bool isMapped() const;
+
         /**
          * Returns the number of rows in the heightfield.
          *
@@ -120,6 +170,11 @@ namespace gameplay
          */
         HeightField(unsigned int columns, unsigned int rows);
 
+        /**
+         * Hidden constructor for a heightfield mapped from a RAW file.
+         */
+        HeightField(unsigned int columns, unsigned int rows, Stream* stream, const unsigned char* data, unsigned int bits, float heightMin, float heightScale);
+
         /**
          * Hidden destructor (use Ref::release()).
          */
@@ -130,9 +185,14 @@ namespace gameplay
          */
         static HeightField* create(const char* path, unsigned int width, unsigned int height, float heightMin, float heightMax);
 
-        float* _array;
+        mutable float* _array;              // The heights, which are only converted on demand for mapped heightfields.
         unsigned int _cols;
         unsigned int _rows;
+        Stream* _stream;                    // The mapped RAW file, or NULL.
+        const unsigned char* _data;         // The samples of the mapped RAW file.
+        unsigned int _bits;                 // The bits per sample of the mapped RAW file.
+        float _heightMin;
+        float _heightScale;
     };
 
 }
@@ -0,0 +1,136 @@
+#include "Base.h"
+#include "HotReloader.h"
+#include "Game.h"
+#include "FileSystem.h"
+#include "Effect.h"
+#include "Material.h"
+#include "Form.h"
+#include "ScriptController.h"
+
+namespace gameplay
+{
+
+HotReloader::HotReloader(float interval)
+    : _interval(interval), _stopped(false)
+{
+}
+
+HotReloader::~HotReloader()
+{
+}
+
+HotReloader* HotReloader::create(float interval)
+{
+    HotReloader* reloader = new HotReloader(interval);
+
+    // Record the current times, so that only the changes made from now on are reloaded.
+    reloader->poll();
+    reloader->scheduleStep();
+    return reloader;
+}
+
+unsigned int HotReloader::poll()
+{
+    std::set<std::string> files;
+    Effect::getSourceFiles(files);
+    Material::getSourceFiles(files);
+    Form::getSourceFiles(files);
+    // Scripts are only watched once scripting is used, so polling does not create a Lua state.
+    std::set<std::string> scripts;
+    Game* game = Game::getInstance();
+    if (game->isScriptControllerInitialized())
+        game->getScriptController()->getSourceFiles(scripts);
+    files.insert(scripts.begin(), scripts.end());
+
+    unsigned int count = 0;
+    for (std::set<std::string>::const_iterator itr = files.begin(); itr != files.end(); ++itr)
+    {
+        time_t time;
+        if (!FileSystem::getModificationTime(itr->c_str(), &time))
+            continue;
+
+        std::map<std::string, time_t>::iterator found = _times.find(*itr);
+        if (found == _times.end())
+        {
+            _times[*itr] = time;
+        }
+        else if (found->second != time)
+        {
+            found->second = time;
+            if (reloadFile(*itr, scripts))
+            {
+                ++count;
+                for (size_t i = 0, size = _listeners.size(); i < size; ++i)
+                    _listeners[i]->fileReloaded(itr->c_str());
+            }
+        }
+    }
+    return count;
+}
+
+bool HotReloader::reloadFile(const std::string& path, const std::set<std::string>& scripts)
+{
+    GP_INFO("Reloading '%s'.", path.c_str());
+
+    // A file can be used by several kinds of resources, such as a scene file that defines materials.
+    bool reloaded = false;
+    reloaded |= Effect::reloadFile(path.c_str()) > 0;
+    reloaded |= Material::reloadFile(path.c_str()) > 0;
+    reloaded |= Form::reloadFile(path.c_str()) > 0;
+    if (scripts.find(path) != scripts.end())
+    {
+        Game::getInstance()->getScriptController()->loadScript(path.c_str(), true);
+        reloaded = true;
+    }
+    return reloaded;
+}
+
+void HotReloader::stop()
+{
+    // The pending time event releases the reloader.
+    _stopped = true;
+}
+
+float HotReloader::getInterval() const
+{
+    return _interval;
+}
+
+void HotReloader::setInterval(float interval)
+{
+    _interval = interval;
+}
+
+void HotReloader::addListener(Listener* listener)
+{
+    GP_ASSERT(listener);
+    _listeners.push_back(listener);
+}
+
+void HotReloader::removeListener(Listener* listener)
+{
+    std::vector<Listener*>::iterator itr = std::find(_listeners.begin(), _listeners.end(), listener);
+    if (itr != _listeners.end())
+        _listeners.erase(itr);
+}
+
+void HotReloader::scheduleStep()
+{
+    // Keep this reloader alive until the scheduled event has fired.
+    addRef();
+    Game::getInstance()->schedule(_interval, this);
+}
+
+void HotReloader::timeEvent(long timeDiff, void* cookie)
+{
+    if (!_stopped)
+    {
+        poll();
+        scheduleStep();
+    }
+
+    // Release the reference held for this event (this may destroy the reloader).
+    release();
+}
+
+}
@@ -0,0 +1,159 @@
+#ifndef HOTRELOADER_H_
+#define HOTRELOADER_H_
+
+#include "Ref.h"
+#include "TimeListener.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a hot reloader, which watches the files of the loaded effects, materials, forms and
+ * scripts and reloads them while the game runs when they change on disk.
+ *
+ * The reloader polls the modification times of the files at a fixed interval, advanced by
+ * Game::schedule(), and reloads the changed files in place:
+ *
+ * - A changed shader (or a file it includes) recompiles the effects that use it (see
+ *   Effect::reload()). An effect that fails to compile keeps its previous program.
+ * - A changed material file updates the parameters and render states of the materials
+ *   created from it (see Material::reloadFile()).
+ * - A changed form file replaces the controls of the forms created from it (see
+ *   Form::reloadFile()). Pointers to the controls have to be looked up again.
+ * - A changed script is run again (see ScriptController::loadScript()).
+ *
+ @verbatim
+    #ifdef _DEBUG
+    _reloader = HotReloader::create();
+    #endif
+ @endverbatim
+ *
+ * Reloading is meant for development. Errors in an edited file are reported the same way as
+ * when the file is first loaded, which exits the game unless it is built with
+ * GP_ERRORS_AS_WARNINGS. Files in packages are not watched.
+ *
+ * @script{ignore}
+ */
+class HotReloader : public Ref, public TimeListener
+{
+public:
+
+    /**
+     * Defines a listener that is told about the files that were reloaded.
+     */
+    class Listener
+    {
+    public:
+
+        /**
+         * Destructor.
+         */
+        virtual ~Listener() { }
+
+        /**
+         * Called after a changed file was reloaded.
+         *
+         * @param path The path of the file.
+         */
+        virtual void fileReloaded(const char* path) = 0;
+    };
+
+    /**
+     * Starts watching the files of the loaded effects, materials, forms and scripts.
+     *
+     * @param interval The time (in milliseconds) between two checks of the files.
+     *
+     * @return The hot reloader.
+     */
+    static HotReloader* create(float interval = 1000.0f);
+
+    /**
+     * Checks the files now, and reloads the ones that changed since the last check.
+     *
+     * Files that are seen for the first time are only recorded, not reloaded.
+     *
+     * @return The number of files that were reloaded.
+     */
+    unsigned int poll();
+
+    /**
+     * Stops watching the files.
+     */
+    void stop();
+
+    /**
+     * Returns the time between two checks of the files.
+     *
+     * @return The interval, in milliseconds.
+     */
+    float getInterval() const;
+
+    /**
+     * Sets the time between two checks of the files.
+     *
+     * @param interval The interval, in milliseconds.
+     */
+    void setInterval(float interval);
+
+    /**
+     * Adds a listener that is told about the files that are reloaded.
+     *
+     * @param listener The listener.
+     */
+    void addListener(Listener* listener);
+
+    /**
+     * Removes a listener.
+     *
+     * @param listener The listener.
+     */
+    void removeListener(Listener* listener);
+
+private:
+
+    /**
+     * Constructor.
+     */
+    HotReloader(float interval);
+
+    /**
+     * Destructor.
+     */
+    ~HotReloader();
+
+    /**
+     * Hidden copy constructor.
+     */
+    HotReloader(const HotReloader& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    HotReloader& operator=(const HotReloader&);
+
+    /**
+     * Schedules the next check of the files.
+     */
+    void scheduleStep();
+
+    /**
+     * Checks the files.
+     *
+     * @see TimeListener::timeEvent
+     */
+    void timeEvent(long timeDiff, void* cookie);
+
+    /**
+     * Reloads the effects, materials, forms and script that were loaded from a file.
+     */
+    bool reloadFile(const std::string& path, const std::set<std::string>& scripts);
+
+    float _interval;
+    std::map<std::string, time_t> _times;
+    std::vector<Listener*> _listeners;
+    bool _stopped;
+};
+
+}
+
+#endif
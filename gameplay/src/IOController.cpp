@@ -0,0 +1,374 @@
+#include "Base.h"
+#include "IOController.h"
+#include "FileSystem.h"
+#include "Game.h"
+#include "Mutex.h"
+
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
+
+namespace gameplay
+{
+
+struct IOController::Thread
+{
+    IOController* controller;
+#ifdef WIN32
+    HANDLE handle;
+
+    static DWORD WINAPI run(LPVOID data)
+    {
+        static_cast<Thread*>(data)->controller->ioLoop();
+        return 0;
+    }
+#else
+    pthread_t handle;
+
+    static void* run(void* data)
+    {
+        static_cast<Thread*>(data)->controller->ioLoop();
+        return NULL;
+    }
+#endif
+};
+
+IOController::Request::Request(IOController* controller, const char* path, unsigned int offset, unsigned int size, Listener* listener, int priority, Dispatch dispatch)
+    : _controller(controller), _path(path), _offset(offset), _size(size), _listener(listener), _priority(priority), _dispatch(dispatch),
+      _packageOffset(0), _state(QUEUED), _cancelled(false), _data(NULL), _dataSize(0)
+{
+}
+
+IOController::Request::~Request()
+{
+    SAFE_DELETE_ARRAY(_data);
+}
+
+const char* IOController::Request::getPath() const
+{
+    return _path.c_str();
+}
+
+IOController::Request::State IOController::Request::getState() const
+{
+    return _state;
+}
+
+bool IOController::Request::isComplete() const
+{
+    State state = _state;
+    return state != QUEUED && state != READING;
+}
+
+const char* IOController::Request::getData() const
+{
+    return _data;
+}
+
+unsigned int IOController::Request::getSize() const
+{
+    return _dataSize;
+}
+
+char* IOController::Request::releaseData()
+{
+    char* data = _data;
+    _data = NULL;
+    return data;
+}
+
+void IOController::Request::cancel()
+{
+    IOController* controller = _controller;
+    controller->_mutex->lock();
+    _cancelled = true;
+    bool queued = false;
+    if (_state == QUEUED)
+    {
+        std::vector<Request*>::iterator itr = std::find(controller->_queue.begin(), controller->_queue.end(), this);
+        if (itr != controller->_queue.end())
+        {
+            controller->_queue.erase(itr);
+            queued = true;
+        }
+        _state = CANCELLED;
+        controller->_completeCondition->broadcast();
+    }
+    else if (_state == READING)
+    {
+        // The I/O thread drops the data when it sees the request was cancelled.
+        _state = CANCELLED;
+    }
+    controller->_mutex->unlock();
+
+    // Release the reference the queue held.
+    if (queued)
+        release();
+}
+
+void IOController::Request::wait()
+{
+    IOController* controller = _controller;
+    controller->_mutex->lock();
+    while (_state == QUEUED || _state == READING)
+    {
+        controller->_completeCondition->wait(controller->_mutex);
+    }
+    controller->_mutex->unlock();
+}
+
+void IOController::Request::run()
+{
+    // This may run after the controller is finalized, so it does not use the controller.
+    if (_listener && !_cancelled)
+        _listener->readComplete(this);
+
+    // Release the reference the controller held until the listener was called.
+    release();
+}
+
+IOController::IOController()
+    : _jobController(NULL), _mutex(NULL), _queueCondition(NULL), _completeCondition(NULL), _thread(NULL),
+      _readingCount(0), _lastPackageOffset(0), _running(false)
+{
+    _mutex = new Mutex();
+    _queueCondition = new Condition();
+    _completeCondition = new Condition();
+}
+
+IOController::~IOController()
+{
+    SAFE_DELETE(_completeCondition);
+    SAFE_DELETE(_queueCondition);
+    SAFE_DELETE(_mutex);
+}
+
+void IOController::initialize()
+{
+    _jobController = Game::getInstance()->getJobController();
+    _running = true;
+
+    Thread* thread = new Thread();
+    thread->controller = this;
+#ifdef WIN32
+    thread->handle = CreateThread(NULL, 0, &Thread::run, thread, 0, NULL);
+    bool started = thread->handle != NULL;
+#else
+    bool started = pthread_create(&thread->handle, NULL, &Thread::run, thread) == 0;
+#endif
+    if (!started)
+    {
+        // Without the I/O thread, requests are read as soon as they are made.
+        GP_WARN("Failed to start the I/O thread; files will be read synchronously.");
+        SAFE_DELETE(thread);
+    }
+    _thread = thread;
+}
+
+void IOController::finalize()
+{
+    // Cancel the queued requests, then wait for the request being read.
+    _mutex->lock();
+    std::vector<Request*> cancelled;
+    cancelled.swap(_queue);
+    for (size_t i = 0, count = cancelled.size(); i < count; ++i)
+    {
+        cancelled[i]->_cancelled = true;
+        cancelled[i]->_state = Request::CANCELLED;
+    }
+    _running = false;
+    _queueCondition->signal();
+    _completeCondition->broadcast();
+    _mutex->unlock();
+
+    for (size_t i = 0, count = cancelled.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(cancelled[i]);
+    }
+
+    if (_thread)
+    {
+#ifdef WIN32
+        WaitForSingleObject(_thread->handle, INFINITE);
+        CloseHandle(_thread->handle);
+#else
+        pthread_join(_thread->handle, NULL);
+#endif
+        SAFE_DELETE(_thread);
+    }
+    _lastPackagePath.clear();
+    _lastPackageOffset = 0;
+}
+
+IOController::Request* IOController::read(const char* path, Listener* listener, int priority, Dispatch dispatch)
+{
+    return read(path, 0, 0, listener, priority, dispatch);
+}
+
+IOController::Request* IOController::read(const char* path, unsigned int offset, unsigned int size, Listener* listener, int priority, Dispatch dispatch)
+{
+    GP_ASSERT(path);
+
+    return add(new Request(this, path, offset, size, listener, priority, dispatch));
+}
+
+unsigned int IOController::getPendingCount() const
+{
+    _mutex->lock();
+    unsigned int count = (unsigned int)_queue.size() + _readingCount;
+    _mutex->unlock();
+    return count;
+}
+
+IOController::Request* IOController::add(Request* request)
+{
+    // The packages are looked up here rather than on the I/O thread, since they are only changed on this thread.
+    FileSystem::getPackageLocation(request->_path.c_str(), &request->_packagePath, &request->_packageOffset);
+
+    // The controller keeps a reference until the listener is called.
+    request->addRef();
+
+    _mutex->lock();
+    if (_thread)
+    {
+        _queue.push_back(request);
+        _queueCondition->signal();
+        _mutex->unlock();
+        return request;
+    }
+    _mutex->unlock();
+
+    char* data = NULL;
+    unsigned int size = 0;
+    bool success = readFile(request, &data, &size);
+    request->_data = data;
+    request->_dataSize = size;
+    request->_state = success ? Request::COMPLETE : Request::FAILED;
+    if (request->_listener && _jobController)
+        _jobController->add(request, request->_dispatch == MAIN_THREAD ? JobController::MAIN_THREAD : JobController::ANY_THREAD);
+    else
+        request->release();
+    return request;
+}
+
+IOController::Request* IOController::next()
+{
+    GP_ASSERT(!_queue.empty());
+
+    int priority = _queue[0]->_priority;
+    for (size_t i = 1, count = _queue.size(); i < count; ++i)
+    {
+        if (_queue[i]->_priority > priority)
+            priority = _queue[i]->_priority;
+    }
+
+    // Of the requests with the highest priority, read the next file stored in the last package read from,
+    // or the oldest request when there is none.
+    size_t oldest = _queue.size();
+    size_t nearest = _queue.size();
+    for (size_t i = 0, count = _queue.size(); i < count; ++i)
+    {
+        Request* request = _queue[i];
+        if (request->_priority != priority)
+            continue;
+        if (oldest == count)
+            oldest = i;
+        if (!_lastPackagePath.empty() && request->_packageOffset > _lastPackageOffset && request->_packagePath == _lastPackagePath &&
+            (nearest == count || request->_packageOffset < _queue[nearest]->_packageOffset))
+        {
+            nearest = i;
+        }
+    }
+    size_t index = nearest < _queue.size() ? nearest : oldest;
+    Request* request = _queue[index];
+    _queue.erase(_queue.begin() + index);
+
+    _lastPackagePath = request->_packagePath;
+    _lastPackageOffset = request->_packageOffset;
+    return request;
+}
+
+bool IOController::readFile(Request* request, char** data, unsigned int* size)
+{
+    // This runs on the I/O thread, so failures are reported by the state of the request rather than with GP_ERROR.
+    Stream* stream = FileSystem::open(request->_path.c_str());
+    if (stream == NULL)
+        return false;
+
+    bool success = false;
+    size_t length = stream->length();
+    if (request->_offset <= length)
+    {
+        size_t readSize = request->_size > 0 ? request->_size : length - request->_offset;
+        if (readSize <= length - request->_offset && (request->_offset == 0 || stream->seek(request->_offset, SEEK_SET)))
+        {
+            char* buffer = new char[readSize + 1];
+            if (stream->read(buffer, 1, readSize) == readSize)
+            {
+                buffer[readSize] = '\0';
+                *data = buffer;
+                *size = (unsigned int)readSize;
+                success = true;
+            }
+            else
+            {
+                SAFE_DELETE_ARRAY(buffer);
+            }
+        }
+    }
+    SAFE_DELETE(stream);
+    return success;
+}
+
+void IOController::ioLoop()
+{
+    _mutex->lock();
+    while (true)
+    {
+        while (_running && _queue.empty())
+        {
+            _queueCondition->wait(_mutex);
+        }
+        if (!_running)
+            break;
+
+        Request* request = next();
+        request->_state = Request::READING;
+        ++_readingCount;
+        _mutex->unlock();
+
+        char* data = NULL;
+        unsigned int size = 0;
+        bool success = readFile(request, &data, &size);
+
+        _mutex->lock();
+        --_readingCount;
+        bool dispatch = false;
+        if (request->_state == Request::CANCELLED)
+        {
+            SAFE_DELETE_ARRAY(data);
+        }
+        else
+        {
+            request->_data = data;
+            request->_dataSize = size;
+            request->_state = success ? Request::COMPLETE : Request::FAILED;
+            dispatch = request->_listener && !request->_cancelled;
+        }
+        _completeCondition->broadcast();
+        _mutex->unlock();
+
+        // Requests with a listener are released by the job that calls it.
+        if (dispatch && _jobController)
+            _jobController->add(request, request->_dispatch == MAIN_THREAD ? JobController::MAIN_THREAD : JobController::ANY_THREAD);
+        else
+            request->release();
+
+        _mutex->lock();
+    }
+    _mutex->unlock();
+}
+
+}
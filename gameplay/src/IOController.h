@@ -0,0 +1,286 @@
+#ifndef IOCONTROLLER_H_
+#define IOCONTROLLER_H_
+
+#include "Ref.h"
+#include "JobController.h"
+
+namespace gameplay
+{
+
+class Mutex;
+class Condition;
+
+/**
+ * Defines a class that reads files asynchronously on a dedicated I/O thread.
+ *
+ * Each read request reads a whole file, or a range of it, into memory through
+ * FileSystem::open, so files in mounted packages and Android assets are read like any
+ * other. Requests are served from the highest priority to the lowest, and in the order
+ * they were made for equal priorities. Among the requests of the highest priority, the
+ * files of the package the last file was read from are read in the order they are stored
+ * in it, so that loading many small files from a package reads it forward rather than
+ * seeking back and forth.
+ *
+ * When a request completes, its listener is called on the main thread, by the job
+ * controller before the game is updated, or on the worker threads if the request asked
+ * for it. A request can be cancelled at any time: a queued request is never read, and the
+ * data of a request that is being read is dropped without calling its listener.
+ *
+ * Packages should not be mounted or unmounted while requests are queued.
+ *
+ * @script{ignore}
+ */
+class IOController
+{
+    friend class Game;
+    friend class Request;
+
+public:
+
+    class Request;
+
+    /**
+     * Defines the interface for receiving the completion of read requests.
+     */
+    class Listener
+    {
+    public:
+
+        /**
+         * Destructor.
+         */
+        virtual ~Listener() { }
+
+        /**
+         * Called when a read request completes or fails. It is not called for cancelled requests.
+         *
+         * @param request The request, whose data is valid until it is destroyed.
+         */
+        virtual void readComplete(Request* request) = 0;
+    };
+
+    /**
+     * The threads that the listener of a request may be called on.
+     */
+    enum Dispatch
+    {
+        MAIN_THREAD,
+        WORKER_THREAD
+    };
+
+    /**
+     * Defines a read request.
+     *
+     * The controller keeps a reference to the request until its listener has been called,
+     * so the caller may release it at any time.
+     */
+    class Request : public Ref, public JobController::Job
+    {
+        friend class IOController;
+
+    public:
+
+        /**
+         * The states of a request.
+         */
+        enum State
+        {
+            QUEUED,
+            READING,
+            COMPLETE,
+            FAILED,
+            CANCELLED
+        };
+
+        /**
+         * Returns the path of the file that is read.
+         *
+         * @return The path.
+         */
+        const char* getPath() const;
+
+        /**
+         * Returns the state of the request.
+         *
+         * @return The state.
+         */
+        State getState() const;
+
+        /**
+         * Determines whether the request is complete, failed or was cancelled.
+         *
+         * @return true if the request is no longer queued or being read, false otherwise.
+         */
+        bool isComplete() const;
+
+        /**
+         * Returns the data that was read. Only valid once the request is complete.
+         *
+         * The data is followed by a null character, which is not counted in its size, so
+         * text files can be used as strings.
+         *
+         * @return The data, or NULL if the request failed or was cancelled.
+         */
+        const char* getData() const;
+
+        /**
+         * Returns the size of the data that was read.
+         *
+         * @return The size in bytes.
+         */
+        unsigned int getSize() const;
+
+        /**
+         * Takes the ownership of the data that was read, which the caller must delete with delete[].
+         *
+         * @return The data, or NULL if the request failed, was cancelled or its data was already taken.
+         */
+        char* releaseData();
+
+        /**
+         * Cancels the request. The listener is not called for a cancelled request.
+         *
+         * Cancelling a request that is already complete only prevents its listener from being
+         * called, if it was not called yet.
+         */
+        void cancel();
+
+        /**
+         * Waits for the request to complete, fail or be cancelled.
+         */
+        void wait();
+
+        /**
+         * @see JobController::Job::run
+         */
+        void run();
+
+    private:
+
+        Request(IOController* controller, const char* path, unsigned int offset, unsigned int size, Listener* listener, int priority, Dispatch dispatch);
+
+        ~Request();
+
+        Request(const Request& copy);
+
+        Request& operator=(const Request&);
+
+        IOController* _controller;
+        std::string _path;
+        unsigned int _offset;
+        unsigned int _size;                 // The size to read, or 0 to read to the end of the file.
+        Listener* _listener;
+        int _priority;
+        Dispatch _dispatch;
+        std::string _packagePath;           // The package the file is in, or empty.
+        unsigned int _packageOffset;        // The position of the file in its package.
+        volatile State _state;
+        volatile bool _cancelled;           // Whether the listener must not be called.
+        char* _data;
+        unsigned int _dataSize;
+    };
+
+    /**
+     * Requests a whole file to be read.
+     *
+     * @param path The path of the file.
+     * @param listener The listener to call when the file is read, or NULL.
+     * @param priority The priority of the request. Higher priorities are read first.
+     * @param dispatch The threads the listener may be called on.
+     *
+     * @return The request, which the caller must release.
+     */
+    Request* read(const char* path, Listener* listener = NULL, int priority = 0, Dispatch dispatch = MAIN_THREAD);
+
+    /**
+     * Requests a range of a file to be read.
+     *
+     * The request fails if the range is not within the file.
+     *
+     * @param path The path of the file.
+     * @param offset The position of the first byte to read.
+     * @param size The number of bytes to read, or 0 to read to the end of the file.
+     * @param listener The listener to call when the range is read, or NULL.
+     * @param priority The priority of the request. Higher priorities are read first.
+     * @param dispatch The threads the listener may be called on.
+     *
+     * @return The request, which the caller must release.
+     */
+    Request* read(const char* path, unsigned int offset, unsigned int size, Listener* listener = NULL, int priority = 0, Dispatch dispatch = MAIN_THREAD);
+
+    /**
+     * Returns the number of requests that are queued or being read.
+     *
+     * @return The number of requests.
+     */
+    unsigned int getPendingCount() const;
+
+private:
+
+    struct Thread;
+
+    /**
+     * Constructor.
+     */
+    IOController();
+
+    /**
+     * Destructor.
+     */
+    ~IOController();
+
+    /**
+     * Hidden copy constructor.
+     */
+    IOController(const IOController& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    IOController& operator=(const IOController&);
+
+    /**
+     * Starts the I/O thread.
+     */
+    void initialize();
+
+    /**
+     * Cancels the queued requests and stops the I/O thread.
+     */
+    void finalize();
+
+    /**
+     * Adds a request to the queue.
+     */
+    Request* add(Request* request);
+
+    /**
+     * Removes the next request to read from the queue. Called with the mutex locked.
+     */
+    Request* next();
+
+    /**
+     * Reads the file of a request. Called on the I/O thread without the mutex locked.
+     */
+    bool readFile(Request* request, char** data, unsigned int* size);
+
+    /**
+     * The loop of the I/O thread.
+     */
+    void ioLoop();
+
+    JobController* _jobController;
+    Mutex* _mutex;                          // Guards the queue and the state of the requests.
+    Condition* _queueCondition;             // Signaled when a request is queued or the thread must stop.
+    Condition* _completeCondition;          // Broadcast when a request completes.
+    Thread* _thread;
+    std::vector<Request*> _queue;           // The queued requests, in the order they were made.
+    unsigned int _readingCount;
+    std::string _lastPackagePath;           // The package the last file was read from.
+    unsigned int _lastPackageOffset;        // The position in the package after the last file read from it.
+    bool _running;
+};
+
+}
+
+#endif
@@ -1,6 +1,8 @@
 #include "Base.h"
+#include "Profiler.h"
 #include "FileSystem.h"
 #include "Image.h"
+#include "MemoryStats.h"
 
 namespace gameplay
 {
@@ -18,11 +20,26 @@ Image* Image::create(const char* path)
 {
     GP_ASSERT(path);
 
+    std::string error;
+    Image* image = load(path, &error);
+    if (image == NULL)
+    {
+        GP_ERROR("Failed to load image file '%s': %s", path, error.c_str());
+    }
+    return image;
+}
+
+Image* Image::load(const char* path, std::string* error)
+{
+    GP_ASSERT(path);
+    GP_ASSERT(error);
+    GP_PROFILE("Image::load");
+
     // Open the file.
     std::auto_ptr<Stream> stream(FileSystem::open(path));
     if (stream.get() == NULL || !stream->canRead())
     {
-        GP_ERROR("Failed to open image file '%s'.", path);
+        *error = "failed to open the file.";
         return NULL;
     }
 
@@ -30,7 +47,7 @@ Image* Image::create(const char* path)
     unsigned char sig[8];
     if (stream->read(sig, 1, 8) != 8 || png_sig_cmp(sig, 0, 8) != 0)
     {
-        GP_ERROR("Failed to load file '%s'; not a valid PNG.", path);
+        *error = "not a valid PNG.";
         return NULL;
     }
 
@@ -38,7 +55,7 @@ Image* Image::create(const char* path)
     png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
     if (png == NULL)
     {
-        GP_ERROR("Failed to create PNG structure for reading PNG file '%s'.", path);
+        *error = "failed to create PNG structure for reading.";
         return NULL;
     }
 
@@ -46,7 +63,7 @@ Image* Image::create(const char* path)
     png_infop info = png_create_info_struct(png);
     if (info == NULL)
     {
-        GP_ERROR("Failed to create PNG info structure for PNG file '%s'.", path);
+        *error = "failed to create PNG info structure.";
         png_destroy_read_struct(&png, NULL, NULL);
         return NULL;
     }
@@ -54,7 +71,7 @@ Image* Image::create(const char* path)
     // Set up error handling (required without using custom error handlers above).
     if (setjmp(png_jmpbuf(png)))
     {
-        GP_ERROR("Failed to set up error handling for reading PNG file '%s'.", path);
+        *error = "failed to read the PNG data.";
         png_destroy_read_struct(&png, &info, NULL);
         return NULL;
     }
@@ -68,31 +85,34 @@ Image* Image::create(const char* path)
     // Read the entire image into memory.
     png_read_png(png, info, PNG_TRANSFORM_STRIP_16 | PNG_TRANSFORM_PACKING | PNG_TRANSFORM_EXPAND, NULL);
 
-    Image* image = new Image();
-    image->_width = png_get_image_width(png, info);
-    image->_height = png_get_image_height(png, info);
-
+    Format format;
     png_byte colorType = png_get_color_type(png, info);
     switch (colorType)
     {
     case PNG_COLOR_TYPE_RGBA:
-        image->_format = Image::RGBA;
+        format = Image::RGBA;
         break;
 
     case PNG_COLOR_TYPE_RGB:
-        image->_format = Image::RGB;
+        format = Image::RGB;
         break;
 
     default:
-        GP_ERROR("Unsupported PNG color type (%d) for image file '%s'.", (int)colorType, path);
+        *error = "unsupported PNG color type.";
         png_destroy_read_struct(&png, &info, NULL);
         return NULL;
     }
 
+    Image* image = new Image();
+    image->_width = png_get_image_width(png, info);
+    image->_height = png_get_image_height(png, info);
+    image->_format = format;
+
     size_t stride = png_get_rowbytes(png, info);
 
     // Allocate image data.
     image->_data = new unsigned char[stride * image->_height];
+    MemoryStats::add(MemoryStats::TEXTURE_CPU, image->getDataSize());
 
     // Read rows into image data.
     png_bytepp rows = png_get_rows(png, info);
@@ -107,13 +127,117 @@ Image* Image::create(const char* path)
     return image;
 }
 
-Image::Image()
+Image::Image() : _data(NULL), _format(RGB), _height(0), _width(0)
+{
+}
+
+unsigned int Image::getBytesPerPixel(Format format)
+{
+    switch (format)
+    {
+    case RGB:
+        return 3;
+    case RGBA:
+        return 4;
+    case LUMINANCE:
+    case ALPHA:
+        return 1;
+    default:
+        return 2;
+    }
+}
+
+// The thresholds of ordered dithering, in sixteenths of a quantization step.
+static const unsigned char BAYER_MATRIX[4][4] =
+{
+    {  0,  8,  2, 10 },
+    { 12,  4, 14,  6 },
+    {  3, 11,  1,  9 },
+    { 15,  7, 13,  5 }
+};
+
+// Reduces an 8-bit channel to the specified number of bits. The threshold (0-254) is
+// the remainder above which the channel is rounded up, which is 127 to round to nearest.
+static inline unsigned int quantize(unsigned int value, unsigned int bits, unsigned int threshold)
+{
+    return (value * ((1u << bits) - 1) + threshold) / 255;
+}
+
+bool Image::convert(Format format, bool dither)
+{
+    if (format == _format)
+        return true;
+    if (_format != RGB && _format != RGBA)
+        return false;
+
+    const unsigned int srcBpp = getBytesPerPixel(_format);
+    const unsigned int dstBpp = getBytesPerPixel(format);
+    unsigned char* data = new unsigned char[(size_t)_width * _height * dstBpp];
+    const unsigned char* src = _data;
+    unsigned char* dst = data;
+    for (unsigned int y = 0; y < _height; ++y)
+    {
+        for (unsigned int x = 0; x < _width; ++x, src += srcBpp, dst += dstBpp)
+        {
+            const unsigned int r = src[0];
+            const unsigned int g = src[1];
+            const unsigned int b = src[2];
+            const unsigned int a = srcBpp == 4 ? src[3] : 255;
+            const unsigned int threshold = dither ? BAYER_MATRIX[y & 3][x & 3] * 16 + 8 : 127;
+            unsigned short packed;
+            switch (format)
+            {
+            case RGB:
+                dst[0] = (unsigned char)r;
+                dst[1] = (unsigned char)g;
+                dst[2] = (unsigned char)b;
+                break;
+            case RGBA:
+                dst[0] = (unsigned char)r;
+                dst[1] = (unsigned char)g;
+                dst[2] = (unsigned char)b;
+                dst[3] = (unsigned char)a;
+                break;
+            case LUMINANCE:
+                dst[0] = (unsigned char)((r * 77 + g * 150 + b * 29 + 128) >> 8);
+                break;
+            case ALPHA:
+                dst[0] = (unsigned char)(srcBpp == 4 ? a : (r * 77 + g * 150 + b * 29 + 128) >> 8);
+                break;
+            case RGB565:
+                packed = (unsigned short)((quantize(r, 5, threshold) << 11) | (quantize(g, 6, threshold) << 5) | quantize(b, 5, threshold));
+                memcpy(dst, &packed, 2);
+                break;
+            case RGBA4444:
+                packed = (unsigned short)((quantize(r, 4, threshold) << 12) | (quantize(g, 4, threshold) << 8) | (quantize(b, 4, threshold) << 4) | quantize(a, 4, threshold));
+                memcpy(dst, &packed, 2);
+                break;
+            case RGBA5551:
+                packed = (unsigned short)((quantize(r, 5, threshold) << 11) | (quantize(g, 5, threshold) << 6) | (quantize(b, 5, threshold) << 1) | quantize(a, 1, 127));
+                memcpy(dst, &packed, 2);
+                break;
+            }
+        }
+    }
+
+    MemoryStats::remove(MemoryStats::TEXTURE_CPU, getDataSize());
+    SAFE_DELETE_ARRAY(_data);
+    _data = data;
+    _format = format;
+    MemoryStats::add(MemoryStats::TEXTURE_CPU, getDataSize());
+
+    return true;
+}
+
+size_t Image::getDataSize() const
 {
-    // Unused
+    return (size_t)_width * _height * getBytesPerPixel(_format);
 }
 
 Image::~Image()
 {
+    if (_data)
+        MemoryStats::remove(MemoryStats::TEXTURE_CPU, getDataSize());
     SAFE_DELETE_ARRAY(_data);
 }
 
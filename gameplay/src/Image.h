@@ -11,15 +11,26 @@ namespace gameplay
  */
 class Image : public Ref
 {
+    friend class Texture;
+
 public:
 
     /**
      * Defines the set of supported image formats.
+     *
+     * Images are decoded as RGB or RGBA. The other formats are only produced by convert(),
+     * and the 16-bit formats pack each pixel into a native-endian unsigned short, with the
+     * first channel in the most significant bits.
      */
     enum Format
     {
         RGB,
-        RGBA
+        RGBA,
+        LUMINANCE,
+        ALPHA,
+        RGB565,
+        RGBA4444,
+        RGBA5551
     };
 
     /**
@@ -60,6 +71,33 @@ public:
      */
     inline unsigned int getWidth() const;
 
+    /**
+     * Converts the pixels of the image to another format, in place.
+     *
+     * Only RGB and RGBA images can be converted. LUMINANCE is computed from the red, green
+     * and blue channels, and ALPHA is the alpha channel, or the luminance of RGB images.
+     * Reducing the precision of the channels bands smooth gradients, so the 16-bit formats
+     * can be ordered dithered with a 4x4 Bayer matrix, which trades the bands for a fine,
+     * regular pattern. The single alpha bit of RGBA5551 is never dithered.
+     *
+     * @param format The format to convert to.
+     * @param dither True to dither the channels that lose precision, false to round them.
+     *
+     * @return True if the image was converted, false if its format cannot be converted.
+     * @script{ignore}
+     */
+    bool convert(Format format, bool dither = false);
+
+    /**
+     * Returns the number of bytes of each pixel of an image format.
+     *
+     * @param format The image format.
+     *
+     * @return The number of bytes per pixel.
+     * @script{ignore}
+     */
+    static unsigned int getBytesPerPixel(Format format);
+
 private:
 
     /**
@@ -77,6 +115,21 @@ private:
      */
     Image& operator=(const Image&);
 
+    /**
+     * Loads an image without reporting errors, so that it can be called from worker threads.
+     *
+     * @param path The path to the image file.
+     * @param error Set to the reason the image could not be loaded.
+     *
+     * @return The newly created image, or NULL if it could not be loaded.
+     */
+    static Image* load(const char* path, std::string* error);
+
+    /**
+     * Returns the size of the pixel data, as counted in MemoryStats.
+     */
+    size_t getDataSize() const;
+
     unsigned char* _data;
     Format _format;
     unsigned int _height;
@@ -0,0 +1,334 @@
+#include "Base.h"
+#include "Impostor.h"
+#include "Model.h"
+#include "Game.h"
+#include "Scene.h"
+#include "FrameBuffer.h"
+#include "DepthStencilTarget.h"
+#include "GLStateCache.h"
+#include "RenderStats.h"
+
+// The instances drawn by each draw call, whose vertices can be addressed by 16-bit indices.
+#define IMPOSTOR_BATCH_SIZE 16384
+
+// The position and texture coordinates of a vertex.
+#define IMPOSTOR_VERTEX_FLOATS 5
+#define IMPOSTOR_VERTEX_SIZE (IMPOSTOR_VERTEX_FLOATS * sizeof(float))
+
+// Impostor shaders
+#define IMPOSTOR_VSH "res/shaders/impostor.vert"
+#define IMPOSTOR_FSH "res/shaders/impostor.frag"
+
+namespace gameplay
+{
+
+Impostor::Impostor()
+    : _sampler(NULL), _material(NULL), _viewCount(0), _viewSize(0), _atlasColumns(0), _atlasRows(0),
+      _vertexBuffer(0), _indexBuffer(0)
+{
+}
+
+Impostor::~Impostor()
+{
+    if (_vertexBuffer)
+    {
+        GLStateCache::deleteBuffers(1, &_vertexBuffer);
+    }
+    if (_indexBuffer)
+    {
+        GLStateCache::deleteBuffers(1, &_indexBuffer);
+    }
+    SAFE_RELEASE(_material);
+    SAFE_RELEASE(_sampler);
+}
+
+Impostor* Impostor::create(Model* model, unsigned int viewCount, unsigned int viewSize)
+{
+    GP_ASSERT(model);
+    GP_ASSERT(model->getMesh());
+
+    if (viewCount == 0 || viewSize == 0)
+    {
+        GP_WARN("Invalid impostor of %u views of %u pixels.", viewCount, viewSize);
+        return NULL;
+    }
+
+    Material* material = Material::create(IMPOSTOR_VSH, IMPOSTOR_FSH);
+    if (material == NULL)
+    {
+        GP_ERROR("Failed to create the impostor material.");
+        return NULL;
+    }
+
+    // The images are cut out with an alpha test, so instances need no sorting.
+    material->getStateBlock()->setDepthTest(true);
+    material->getStateBlock()->setDepthWrite(true);
+    material->getStateBlock()->setCullFace(false);
+
+    Impostor* impostor = new Impostor();
+    impostor->_material = material;
+    impostor->_bounds = model->getMesh()->getBoundingSphere();
+    impostor->_viewCount = viewCount;
+    impostor->_viewSize = viewSize;
+    impostor->_atlasColumns = (unsigned int)ceil(sqrt((float)viewCount));
+    impostor->_atlasRows = (viewCount + impostor->_atlasColumns - 1) / impostor->_atlasColumns;
+    if (impostor->_bounds.radius <= 0.0f || !impostor->capture(model))
+    {
+        GP_ERROR("Failed to capture the impostor of a model.");
+        SAFE_RELEASE(impostor);
+        return NULL;
+    }
+    return impostor;
+}
+
+bool Impostor::capture(Model* model)
+{
+    unsigned int width = _atlasColumns * _viewSize;
+    unsigned int height = _atlasRows * _viewSize;
+    FrameBuffer* frameBuffer = FrameBuffer::create("Impostor", width, height);
+    if (frameBuffer == NULL)
+        return false;
+    DepthStencilTarget* depthTarget = DepthStencilTarget::create("Impostor", DepthStencilTarget::DEPTH, width, height);
+    frameBuffer->setDepthStencilTarget(depthTarget);
+    SAFE_RELEASE(depthTarget);
+
+    // The model is drawn in a scene of its own, by a clone with materials bound to a node of that scene.
+    float radius = _bounds.radius;
+    Scene* scene = Scene::create();
+    Camera* camera = Camera::createOrthographic(radius * 2.0f, radius * 2.0f, 1.0f, radius * 0.5f, radius * 3.5f);
+    Node* cameraNode = scene->addNode();
+    cameraNode->setCamera(camera);
+    scene->setActiveCamera(camera);
+    SAFE_RELEASE(camera);
+    NodeCloneContext context;
+    Model* clone = model->clone(context);
+    clone->setImpostor(NULL, 0.0f);
+    Node* modelNode = scene->addNode();
+    modelNode->setModel(clone);
+    SAFE_RELEASE(clone);
+
+    Game* game = Game::getInstance();
+    Rectangle viewport = game->getViewport();
+    FrameBuffer* previousFrameBuffer = frameBuffer->bind();
+    game->clear(Game::CLEAR_COLOR_DEPTH, Vector4::zero(), 1.0f, 0);
+
+    // Each view looks at the model from a direction around its vertical axis, at an angle
+    // from the +Z axis that increases towards +X.
+    for (unsigned int i = 0; i < _viewCount; ++i)
+    {
+        float angle = MATH_PIX2 * i / _viewCount;
+        Quaternion rotation;
+        Quaternion::createFromAxisAngle(Vector3::unitY(), angle, &rotation);
+        cameraNode->setRotation(rotation);
+        cameraNode->setTranslation(_bounds.center + Vector3(sin(angle), 0.0f, cos(angle)) * (radius * 2.0f));
+
+        game->setViewport(Rectangle((float)((i % _atlasColumns) * _viewSize), (float)((i / _atlasColumns) * _viewSize),
+                                    (float)_viewSize, (float)_viewSize));
+        modelNode->getModel()->draw();
+    }
+
+    previousFrameBuffer->bind();
+    game->setViewport(viewport);
+    SAFE_RELEASE(scene);
+
+    // Distant instances are minified, so the images are filtered through mipmaps.
+    Texture* texture = frameBuffer->getRenderTarget()->getTexture();
+    texture->generateMipmaps();
+    _sampler = Texture::Sampler::create(texture);
+    _sampler->setFilterMode(Texture::LINEAR_MIPMAP_LINEAR, Texture::LINEAR);
+    _sampler->setWrapMode(Texture::CLAMP, Texture::CLAMP);
+    _material->getParameter("u_texture")->setValue(_sampler);
+    SAFE_RELEASE(frameBuffer);
+
+    // Every batch of instances uses the same indices, relative to its first vertex.
+    std::vector<unsigned short> indices(IMPOSTOR_BATCH_SIZE * 6);
+    for (unsigned int i = 0; i < IMPOSTOR_BATCH_SIZE; i++)
+    {
+        unsigned short v = (unsigned short)(i * 4);
+        unsigned short* index = &indices[i * 6];
+        index[0] = v;
+        index[1] = v + 1;
+        index[2] = v + 2;
+        index[3] = v + 2;
+        index[4] = v + 1;
+        index[5] = v + 3;
+    }
+    GL_ASSERT( glGenBuffers(1, &_indexBuffer) );
+    GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer);
+    GL_ASSERT( glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned short), &indices[0], GL_STATIC_DRAW) );
+    GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    return true;
+}
+
+Texture* Impostor::getTexture() const
+{
+    return _sampler ? _sampler->getTexture() : NULL;
+}
+
+unsigned int Impostor::getViewCount() const
+{
+    return _viewCount;
+}
+
+Material* Impostor::getMaterial() const
+{
+    return _material;
+}
+
+void Impostor::addInstance(Node* node)
+{
+    GP_ASSERT(node);
+    _instances.push_back(node);
+}
+
+unsigned int Impostor::getInstanceCount() const
+{
+    return (unsigned int)_instances.size();
+}
+
+void Impostor::getViewCoords(unsigned int view, float* u1, float* v1, float* u2, float* v2) const
+{
+    // The views are laid out from the bottom left of the frame buffer, as textures are stored.
+    float cellWidth = 1.0f / _atlasColumns;
+    float cellHeight = 1.0f / _atlasRows;
+    *u1 = (view % _atlasColumns) * cellWidth;
+    *v1 = (view / _atlasColumns) * cellHeight;
+    *u2 = *u1 + cellWidth;
+    *v2 = *v1 + cellHeight;
+}
+
+unsigned int Impostor::draw(Camera* camera)
+{
+    GP_ASSERT(camera);
+
+    unsigned int instanceCount = (unsigned int)_instances.size();
+    if (instanceCount == 0)
+        return 0;
+
+    Node* cameraNode = camera->getNode();
+    Vector3 eye = cameraNode ? cameraNode->getTranslationWorld() : Vector3::zero();
+    bool perspective = camera->getCameraType() == Camera::PERSPECTIVE;
+    Vector3 cameraBack;
+    if (cameraNode)
+        cameraNode->getWorldMatrix().getBackVector(&cameraBack);
+    else
+        cameraBack.set(0.0f, 0.0f, 1.0f);
+
+    // Build a quad for each instance, facing the camera around the vertical axis of its node.
+    _vertices.resize(instanceCount * 4 * IMPOSTOR_VERTEX_FLOATS);
+    float* vertex = &_vertices[0];
+    float sector = MATH_PIX2 / _viewCount;
+    for (unsigned int i = 0; i < instanceCount; ++i)
+    {
+        const Matrix& world = _instances[i]->getWorldMatrix();
+        BoundingSphere bounds(_bounds);
+        bounds.transform(world);
+
+        Vector3 right, up, back;
+        world.getRightVector(&right);
+        world.getUpVector(&up);
+        world.getBackVector(&back);
+        right.normalize();
+        up.normalize();
+        back.normalize();
+
+        // Select the view captured from the direction closest to that of the camera.
+        Vector3 toEye = perspective ? eye - bounds.center : cameraBack;
+        float angle = atan2(toEye.dot(right), toEye.dot(back));
+        if (angle < 0.0f)
+            angle += MATH_PIX2;
+        unsigned int view = (unsigned int)(angle / sector + 0.5f) % _viewCount;
+        float u1, v1, u2, v2;
+        getViewCoords(view, &u1, &v1, &u2, &v2);
+
+        Vector3 side;
+        Vector3::cross(up, toEye, &side);
+        if (side.lengthSquared() < MATH_EPSILON)
+            side = right;
+        side.normalize();
+        side *= bounds.radius;
+        Vector3 height = up * bounds.radius;
+
+        const Vector3 corners[4] =
+        {
+            bounds.center - side - height,
+            bounds.center - side + height,
+            bounds.center + side - height,
+            bounds.center + side + height
+        };
+        const float u[4] = { u1, u1, u2, u2 };
+        const float v[4] = { v1, v2, v1, v2 };
+        for (unsigned int c = 0; c < 4; ++c)
+        {
+            vertex[0] = corners[c].x;
+            vertex[1] = corners[c].y;
+            vertex[2] = corners[c].z;
+            vertex[3] = u[c];
+            vertex[4] = v[c];
+            vertex += IMPOSTOR_VERTEX_FLOATS;
+        }
+    }
+    _instances.clear();
+
+    // Re-specify the buffer storage every frame so the driver can orphan the previous
+    // contents instead of waiting for draws that still use them.
+    if (_vertexBuffer == 0)
+    {
+        GL_ASSERT( glGenBuffers(1, &_vertexBuffer) );
+    }
+    GLStateCache::bindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
+    GL_ASSERT( glBufferData(GL_ARRAY_BUFFER, _vertices.size() * sizeof(float), &_vertices[0], GL_STREAM_DRAW) );
+    RenderStats::add(RenderStats::BUFFER_UPLOADS);
+
+    Pass* pass = _material->getTechnique()->getPassByIndex(0);
+    GP_ASSERT(pass);
+    pass->getParameter("u_viewProjectionMatrix")->setValue(camera->getViewProjectionMatrix());
+    pass->bind();
+
+    Effect* effect = pass->getEffect();
+    GP_ASSERT(effect);
+    VertexAttribute position = effect->getVertexAttribute("a_position");
+    VertexAttribute texCoord = effect->getVertexAttribute("a_texCoord");
+    if (position != -1)
+    {
+        GL_ASSERT( glEnableVertexAttribArray(position) );
+    }
+    if (texCoord != -1)
+    {
+        GL_ASSERT( glEnableVertexAttribArray(texCoord) );
+    }
+    GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer);
+
+    for (unsigned int first = 0; first < instanceCount; first += IMPOSTOR_BATCH_SIZE)
+    {
+        unsigned int count = std::min(instanceCount - first, (unsigned int)IMPOSTOR_BATCH_SIZE);
+        size_t base = first * 4 * IMPOSTOR_VERTEX_SIZE;
+        if (position != -1)
+        {
+            GL_ASSERT( glVertexAttribPointer(position, 3, GL_FLOAT, GL_FALSE, IMPOSTOR_VERTEX_SIZE, (const GLvoid*)base) );
+        }
+        if (texCoord != -1)
+        {
+            GL_ASSERT( glVertexAttribPointer(texCoord, 2, GL_FLOAT, GL_FALSE, IMPOSTOR_VERTEX_SIZE, (const GLvoid*)(base + 3 * sizeof(float))) );
+        }
+        GL_ASSERT( glDrawElements(GL_TRIANGLES, count * 6, GL_UNSIGNED_SHORT, 0) );
+        RenderStats::addDraw(GL_TRIANGLES, count * 6);
+    }
+
+    GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GLStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
+    if (position != -1)
+    {
+        GL_ASSERT( glDisableVertexAttribArray(position) );
+    }
+    if (texCoord != -1)
+    {
+        GL_ASSERT( glDisableVertexAttribArray(texCoord) );
+    }
+
+    pass->unbind();
+    return instanceCount;
+}
+
+}
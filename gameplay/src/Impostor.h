@@ -0,0 +1,146 @@
+#ifndef IMPOSTOR_H_
+#define IMPOSTOR_H_
+
+#include "Ref.h"
+#include "Texture.h"
+#include "Material.h"
+#include "BoundingSphere.h"
+
+namespace gameplay
+{
+
+class Model;
+class Node;
+class Camera;
+
+/**
+ * Defines an impostor of a Model: images of the model captured from around it, which are
+ * drawn on camera-facing quads in place of the model when it is far away.
+ *
+ * The model is drawn from a number of directions around its vertical axis into the cells
+ * of a texture atlas when the impostor is created. A model that has an impostor set with
+ * Model::setImpostor() is not drawn when it covers less than the given fraction of the
+ * viewport. Its node is queued in the impostor instead, and draw() then draws all the
+ * queued nodes with a single draw call, each with the image captured from the direction
+ * closest to that of the camera. Forests and crowds at long range thus cost one draw call
+ * for all of the instances that share the impostor.
+ *
+ * The images are lit as the model was when they were captured, and are drawn upright
+ * around the vertical axis of each node.
+ *
+ @verbatim
+    Impostor* impostor = Impostor::create(treeModel, 8, 128);
+    treeModel->setImpostor(impostor, 0.05f);
+
+    // In Game::render, after the scene is drawn:
+    impostor->draw(scene->getActiveCamera());
+ @endverbatim
+ *
+ * @script{ignore}
+ */
+class Impostor : public Ref
+{
+public:
+
+    /**
+     * Creates an impostor by capturing the images of a model.
+     *
+     * This draws the model into a frame buffer, so it must be called from the rendering
+     * thread, outside of the drawing of a frame to another frame buffer.
+     *
+     * @param model The model to capture.
+     * @param viewCount The number of directions the model is captured from.
+     * @param viewSize The width and height in pixels of the image of each direction.
+     *
+     * @return The new impostor, or NULL if it could not be created.
+     */
+    static Impostor* create(Model* model, unsigned int viewCount = 8, unsigned int viewSize = 128);
+
+    /**
+     * Returns the atlas of the captured images.
+     *
+     * @return The texture of the images.
+     */
+    Texture* getTexture() const;
+
+    /**
+     * Returns the number of directions the model was captured from.
+     *
+     * @return The number of images.
+     */
+    unsigned int getViewCount() const;
+
+    /**
+     * Returns the material the impostors are drawn with, which can be used to change its state.
+     *
+     * @return The material.
+     */
+    Material* getMaterial() const;
+
+    /**
+     * Queues a node to be drawn by the next call to draw().
+     *
+     * Model::draw() calls this when the model is drawn through its impostor.
+     *
+     * @param node The node of an instance of the model.
+     */
+    void addInstance(Node* node);
+
+    /**
+     * Returns the number of nodes queued to be drawn.
+     *
+     * @return The number of instances.
+     */
+    unsigned int getInstanceCount() const;
+
+    /**
+     * Draws the queued nodes, and clears the queue.
+     *
+     * @param camera The camera the nodes are drawn for.
+     *
+     * @return The number of instances drawn.
+     */
+    unsigned int draw(Camera* camera);
+
+private:
+
+    /**
+     * Constructor.
+     */
+    Impostor();
+
+    /**
+     * Destructor.
+     */
+    ~Impostor();
+
+    /**
+     * Hidden copy constructor.
+     */
+    Impostor(const Impostor&);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    Impostor& operator=(const Impostor&);
+
+    bool capture(Model* model);
+
+    void getViewCoords(unsigned int view, float* u1, float* v1, float* u2, float* v2) const;
+
+    Texture::Sampler* _sampler;
+    Material* _material;
+    BoundingSphere _bounds;
+    unsigned int _viewCount;
+    unsigned int _viewSize;
+    unsigned int _atlasColumns;
+    unsigned int _atlasRows;
+    std::vector<Node*> _instances;
+    std::vector<float> _vertices;
+    VertexBufferHandle _vertexBuffer;
+    IndexBufferHandle _indexBuffer;
+};
+
+}
+
+#endif
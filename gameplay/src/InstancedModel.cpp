@@ -0,0 +1,326 @@
+#include "Base.h"
+#include "GLStateCache.h"
+#include "RenderStats.h"
+#include "InstancedModel.h"
+#include "MeshPart.h"
+#include "Technique.h"
+#include "Pass.h"
+#include "Node.h"
+
+// Number of vertex attribute locations occupied by a mat4 attribute.
+#define INSTANCE_MATRIX_COLUMNS 4
+
+// Number of floats per instance in the instance buffer: the world matrix, then the parameters.
+#define INSTANCE_FLOATS 20
+
+namespace gameplay
+{
+
+InstancedModel::InstancedModel(Model* model) :
+    _model(model), _instanceBuffer(0)
+{
+}
+
+InstancedModel::~InstancedModel()
+{
+    removeAllInstances();
+
+    if (_instanceBuffer)
+    {
+        GLStateCache::deleteBuffers(1, &_instanceBuffer);
+        _instanceBuffer = 0;
+    }
+
+    SAFE_RELEASE(_model);
+}
+
+InstancedModel* InstancedModel::create(Model* model, unsigned int initialCapacity)
+{
+    GP_ASSERT(model);
+
+    if (model->getSkin())
+    {
+        GP_ERROR("Skinned models cannot be instanced.");
+        return NULL;
+    }
+
+    model->addRef();
+    InstancedModel* instancedModel = new InstancedModel(model);
+    instancedModel->_instances.reserve(initialCapacity);
+    instancedModel->_instanceParameters.reserve(initialCapacity);
+    instancedModel->_instanceData.reserve(initialCapacity * INSTANCE_FLOATS);
+
+    // Bind the view and projection matrices that replace the per-object world matrices.
+    if (model->getMaterial())
+    {
+        instancedModel->setMaterialAutoBindings(model->getMaterial());
+    }
+    for (unsigned int i = 0, count = model->getMeshPartCount(); i < count; ++i)
+    {
+        if (model->hasMaterial(i))
+        {
+            instancedModel->setMaterialAutoBindings(model->getMaterial(i));
+        }
+    }
+
+    return instancedModel;
+}
+
+bool InstancedModel::isHardwareInstancingSupported()
+{
+#ifdef USE_INSTANCED_ARRAYS
+    return GLEW_ARB_instanced_arrays && GLEW_ARB_draw_instanced;
+#else
+    return false;
+#endif
+}
+
+void InstancedModel::setMaterialAutoBindings(Material* material)
+{
+    GP_ASSERT(material);
+
+    for (unsigned int i = 0, tCount = material->getTechniqueCount(); i < tCount; ++i)
+    {
+        Technique* technique = material->getTechniqueByIndex(i);
+        GP_ASSERT(technique);
+        for (unsigned int j = 0, pCount = technique->getPassCount(); j < pCount; ++j)
+        {
+            Pass* pass = technique->getPassByIndex(j);
+            GP_ASSERT(pass);
+            Effect* effect = pass->getEffect();
+            GP_ASSERT(effect);
+
+            if (effect->getVertexAttribute(VERTEX_ATTRIBUTE_INSTANCE_MATRIX_NAME) == -1)
+            {
+                GP_WARN("Effect '%s' has no '%s' attribute; it must be compiled with the INSTANCED define to be instanced.", effect->getId(), VERTEX_ATTRIBUTE_INSTANCE_MATRIX_NAME);
+                continue;
+            }
+
+            // Only bind the uniforms the effect actually uses to avoid missing parameter warnings.
+            if (effect->getUniform("u_viewProjectionMatrix"))
+            {
+                pass->setParameterAutoBinding("u_viewProjectionMatrix", RenderState::VIEW_PROJECTION_MATRIX);
+            }
+            if (effect->getUniform("u_viewMatrix"))
+            {
+                pass->setParameterAutoBinding("u_viewMatrix", RenderState::VIEW_MATRIX);
+            }
+        }
+    }
+}
+
+Model* InstancedModel::getModel() const
+{
+    return _model;
+}
+
+void InstancedModel::addInstance(Node* node)
+{
+    GP_ASSERT(node);
+
+    node->addRef();
+    _instances.push_back(node);
+    _instanceParameters.push_back(Vector4::zero());
+}
+
+void InstancedModel::removeInstance(Node* node)
+{
+    std::vector<Node*>::iterator itr = std::find(_instances.begin(), _instances.end(), node);
+    if (itr != _instances.end())
+    {
+        _instanceParameters.erase(_instanceParameters.begin() + (itr - _instances.begin()));
+        _instances.erase(itr);
+        SAFE_RELEASE(node);
+    }
+}
+
+void InstancedModel::removeAllInstances()
+{
+    for (size_t i = 0, count = _instances.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_instances[i]);
+    }
+    _instances.clear();
+    _instanceParameters.clear();
+}
+
+unsigned int InstancedModel::getInstanceCount() const
+{
+    return (unsigned int)_instances.size();
+}
+
+Node* InstancedModel::getInstance(unsigned int index) const
+{
+    GP_ASSERT(index < _instances.size());
+    return _instances[index];
+}
+
+void InstancedModel::setInstanceParameters(unsigned int index, const Vector4& parameters)
+{
+    GP_ASSERT(index < _instanceParameters.size());
+    _instanceParameters[index] = parameters;
+}
+
+const Vector4& InstancedModel::getInstanceParameters(unsigned int index) const
+{
+    GP_ASSERT(index < _instanceParameters.size());
+    return _instanceParameters[index];
+}
+
+void InstancedModel::updateInstanceBuffer()
+{
+    // Gather the world matrices (column-major mat4) and parameters of all instances.
+    size_t count = _instances.size();
+    _instanceData.resize(count * INSTANCE_FLOATS);
+    for (size_t i = 0; i < count; ++i)
+    {
+        GP_ASSERT(_instances[i]);
+        float* data = &_instanceData[i * INSTANCE_FLOATS];
+        memcpy(data, _instances[i]->getWorldMatrix().m, sizeof(float) * 16);
+        const Vector4& parameters = _instanceParameters[i];
+        data[16] = parameters.x;
+        data[17] = parameters.y;
+        data[18] = parameters.z;
+        data[19] = parameters.w;
+    }
+
+    if (isHardwareInstancingSupported())
+    {
+        if (_instanceBuffer == 0)
+        {
+            GL_ASSERT( glGenBuffers(1, &_instanceBuffer) );
+        }
+
+        // Re-specify the buffer storage every frame so the driver can orphan the previous
+        // contents instead of waiting for draws that still use them.
+        GLStateCache::bindBuffer(GL_ARRAY_BUFFER, _instanceBuffer);
+        GL_ASSERT( glBufferData(GL_ARRAY_BUFFER, _instanceData.size() * sizeof(float), &_instanceData[0], GL_STREAM_DRAW) );
+        RenderStats::add(RenderStats::BUFFER_UPLOADS);
+        GLStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+}
+
+void InstancedModel::draw()
+{
+    GP_ASSERT(_model);
+    Mesh* mesh = _model->getMesh();
+    GP_ASSERT(mesh);
+
+    if (_instances.empty())
+        return;
+
+    updateInstanceBuffer();
+
+    unsigned int partCount = mesh->getPartCount();
+    for (unsigned int i = 0; i < (partCount == 0 ? 1 : partCount); ++i)
+    {
+        MeshPart* part = partCount == 0 ? NULL : mesh->getPart(i);
+        Material* material = partCount == 0 ? _model->getMaterial() : _model->getMaterial(i);
+        if (material == NULL)
+            continue;
+
+        Technique* technique = material->getTechnique();
+        GP_ASSERT(technique);
+        for (unsigned int j = 0, passCount = technique->getPassCount(); j < passCount; ++j)
+        {
+            Pass* pass = technique->getPassByIndex(j);
+            GP_ASSERT(pass);
+            pass->bind();
+            drawInstances(pass, part);
+            pass->unbind();
+        }
+    }
+}
+
+void InstancedModel::drawInstances(Pass* pass, MeshPart* part)
+{
+    Mesh* mesh = _model->getMesh();
+    VertexAttribute attrib = pass->getEffect()->getVertexAttribute(VERTEX_ATTRIBUTE_INSTANCE_MATRIX_NAME);
+    if (attrib == -1)
+        return;
+    VertexAttribute parametersAttrib = pass->getEffect()->getVertexAttribute(VERTEX_ATTRIBUTE_INSTANCE_PARAMETERS_NAME);
+
+    GLsizei instanceCount = (GLsizei)_instances.size();
+
+    if (part)
+    {
+        GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, part->getIndexBuffer());
+    }
+    else
+    {
+        GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+
+#ifdef USE_INSTANCED_ARRAYS
+    if (isHardwareInstancingSupported())
+    {
+        // Source one matrix column per attribute location, advancing once per instance.
+        GLStateCache::bindBuffer(GL_ARRAY_BUFFER, _instanceBuffer);
+        for (unsigned int c = 0; c < INSTANCE_MATRIX_COLUMNS; ++c)
+        {
+            GL_ASSERT( glEnableVertexAttribArray(attrib + c) );
+            GL_ASSERT( glVertexAttribPointer(attrib + c, 4, GL_FLOAT, GL_FALSE, sizeof(float) * INSTANCE_FLOATS, (const GLvoid*)(sizeof(float) * 4 * c)) );
+            GL_ASSERT( glVertexAttribDivisorARB(attrib + c, 1) );
+        }
+        if (parametersAttrib != -1)
+        {
+            GL_ASSERT( glEnableVertexAttribArray(parametersAttrib) );
+            GL_ASSERT( glVertexAttribPointer(parametersAttrib, 4, GL_FLOAT, GL_FALSE, sizeof(float) * INSTANCE_FLOATS, (const GLvoid*)(sizeof(float) * 16)) );
+            GL_ASSERT( glVertexAttribDivisorARB(parametersAttrib, 1) );
+        }
+        GLStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
+
+        if (part)
+        {
+            GL_ASSERT( glDrawElementsInstancedARB(part->getPrimitiveType(), part->getIndexCount(), part->getIndexFormat(), (const GLvoid*)part->getIndexOffset(), instanceCount) );
+            RenderStats::addDraw(part->getPrimitiveType(), part->getIndexCount(), instanceCount);
+        }
+        else
+        {
+            GL_ASSERT( glDrawArraysInstancedARB(mesh->getPrimitiveType(), 0, mesh->getVertexCount(), instanceCount) );
+            RenderStats::addDraw(mesh->getPrimitiveType(), mesh->getVertexCount(), instanceCount);
+        }
+
+        // Restore the attribute state so other users of the vertex array are unaffected.
+        for (unsigned int c = 0; c < INSTANCE_MATRIX_COLUMNS; ++c)
+        {
+            GL_ASSERT( glVertexAttribDivisorARB(attrib + c, 0) );
+            GL_ASSERT( glDisableVertexAttribArray(attrib + c) );
+        }
+        if (parametersAttrib != -1)
+        {
+            GL_ASSERT( glVertexAttribDivisorARB(parametersAttrib, 0) );
+            GL_ASSERT( glDisableVertexAttribArray(parametersAttrib) );
+        }
+        return;
+    }
+#endif
+
+    // Fallback: the matrix attribute is left disabled, so the constant attribute value set
+    // before each draw call is used for every vertex of that instance.
+    for (GLsizei i = 0; i < instanceCount; ++i)
+    {
+        const float* m = &_instanceData[i * INSTANCE_FLOATS];
+        for (unsigned int c = 0; c < INSTANCE_MATRIX_COLUMNS; ++c)
+        {
+            GL_ASSERT( glVertexAttrib4fv(attrib + c, m + c * 4) );
+        }
+        if (parametersAttrib != -1)
+        {
+            GL_ASSERT( glVertexAttrib4fv(parametersAttrib, m + 16) );
+        }
+
+        if (part)
+        {
+            GL_ASSERT( glDrawElements(part->getPrimitiveType(), part->getIndexCount(), part->getIndexFormat(), (const GLvoid*)part->getIndexOffset()) );
+            RenderStats::addDraw(part->getPrimitiveType(), part->getIndexCount());
+        }
+        else
+        {
+            GL_ASSERT( glDrawArrays(mesh->getPrimitiveType(), 0, mesh->getVertexCount()) );
+            RenderStats::addDraw(mesh->getPrimitiveType(), mesh->getVertexCount());
+        }
+    }
+}
+
+}
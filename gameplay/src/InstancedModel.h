@@ -0,0 +1,161 @@
+#ifndef INSTANCEDMODEL_H_
+#define INSTANCEDMODEL_H_
+
+#include "Model.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a set of instances of a Model that are drawn together.
+ *
+ * Every instance is a Node whose world matrix is used to position a copy of the model.
+ * All instances share the Mesh and Material of the model, so the material is bound
+ * only once per pass and the per-instance world matrices are streamed into a dynamic
+ * vertex buffer. Where hardware instancing is supported, a single instanced draw call
+ * is issued per mesh part and pass. Otherwise, the world matrix of each instance is set
+ * as a constant vertex attribute before drawing it, which still avoids rebinding the
+ * material for every instance.
+ *
+ * The model's material must use shaders compiled with the INSTANCED define, which
+ * reads the world matrix from the a_instanceMatrix vertex attribute. The built-in
+ * colored and textured shaders support this define. The model itself must be attached
+ * to a Node in the scene, which provides the active camera for the view and projection
+ * auto-bindings of the material.
+ *
+ * Each instance also has a vector of parameters, streamed with its world matrix into the
+ * a_instanceParameters vertex attribute of effects that declare it, such as the clip and
+ * time offset of a BakedAnimation.
+ *
+ * Skinned models cannot be instanced.
+ */
+class InstancedModel : public Ref
+{
+public:
+
+    /**
+     * Creates a new set of instances for the specified model.
+     *
+     * @param model The model to instance.
+     * @param initialCapacity An optional initial capacity (number of instances).
+     *
+     * @return The new instanced model.
+     * @script{create}
+     */
+    static InstancedModel* create(Model* model, unsigned int initialCapacity = 0);
+
+    /**
+     * Determines whether hardware instanced drawing is supported on this platform.
+     *
+     * @return True if instanced draw calls are used, false if instances are drawn one at a time.
+     */
+    static bool isHardwareInstancingSupported();
+
+    /**
+     * Returns the model being instanced.
+     *
+     * @return The model.
+     */
+    Model* getModel() const;
+
+    /**
+     * Adds an instance whose world matrix is taken from the specified node.
+     *
+     * @param node The node of the instance.
+     */
+    void addInstance(Node* node);
+
+    /**
+     * Removes the instance for the specified node.
+     *
+     * @param node The node of the instance to remove.
+     */
+    void removeInstance(Node* node);
+
+    /**
+     * Removes all instances.
+     */
+    void removeAllInstances();
+
+    /**
+     * Returns the number of instances.
+     *
+     * @return The number of instances.
+     */
+    unsigned int getInstanceCount() const;
+
+    /**
+     * Returns the node of the instance at the specified index.
+     *
+     * @param index The index of the instance.
+     *
+     * @return The node of the instance.
+     */
+    Node* getInstance(unsigned int index) const;
+
+    /**
+     * Sets the parameters of the instance at the specified index, which are zero by default.
+     *
+     * @param index The index of the instance.
+     * @param parameters The values of the a_instanceParameters attribute for the instance.
+     * @script{ignore}
+     */
+    void setInstanceParameters(unsigned int index, const Vector4& parameters);
+
+    /**
+     * Returns the parameters of the instance at the specified index.
+     *
+     * @param index The index of the instance.
+     *
+     * @return The values of the a_instanceParameters attribute for the instance.
+     * @script{ignore}
+     */
+    const Vector4& getInstanceParameters(unsigned int index) const;
+
+    /**
+     * Draws all the instances.
+     *
+     * The world matrices of the instance nodes are read every time this method is
+     * called, so instances can move freely between draws.
+     */
+    void draw();
+
+private:
+
+    /**
+     * Constructor.
+     */
+    InstancedModel(Model* model);
+
+    /**
+     * Destructor. Hidden use release() instead.
+     */
+    ~InstancedModel();
+
+    /**
+     * Hidden copy constructor.
+     */
+    InstancedModel(const InstancedModel& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    InstancedModel& operator=(const InstancedModel&);
+
+    void setMaterialAutoBindings(Material* material);
+
+    void updateInstanceBuffer();
+
+    void drawInstances(Pass* pass, MeshPart* part);
+
+    Model* _model;
+    std::vector<Node*> _instances;
+    std::vector<Vector4> _instanceParameters;
+    // The world matrix and parameters of each instance, interleaved.
+    std::vector<float> _instanceData;
+    VertexBufferHandle _instanceBuffer;
+};
+
+}
+
+#endif
@@ -0,0 +1,530 @@
+#include "Base.h"
+#include "JobController.h"
+#include "Mutex.h"
+
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <sched.h>
+    #include <unistd.h>
+#endif
+
+// The number of parts per thread that a parallel loop is split into by default.
+#define PARALLEL_FOR_PARTS_PER_THREAD 4
+
+namespace gameplay
+{
+
+#ifdef WIN32
+static DWORD __mainThread = 0;
+static bool __mainThreadSet = false;
+static DWORD __workerIndexKey = TLS_OUT_OF_INDEXES;
+#else
+static pthread_t __mainThread;
+static bool __mainThreadSet = false;
+static pthread_key_t __workerIndexKey;
+static bool __workerIndexKeyCreated = false;
+#endif
+
+struct JobController::Task
+{
+    JobId id;
+    Job* job;
+    Affinity affinity;
+    unsigned int dependencies;      // The number of dependencies that are not complete.
+    std::vector<Task*> dependents;  // The tasks that depend on this one.
+};
+
+struct JobController::Queue
+{
+    Mutex mutex;
+    std::deque<Task*> tasks;
+};
+
+struct JobController::Worker
+{
+    JobController* controller;
+    int index;
+#ifdef WIN32
+    HANDLE thread;
+
+    static DWORD WINAPI run(LPVOID data)
+    {
+        Worker* worker = static_cast<Worker*>(data);
+        TlsSetValue(__workerIndexKey, (LPVOID)(size_t)(worker->index + 1));
+        worker->controller->workerLoop(worker->index);
+        return 0;
+    }
+#else
+    pthread_t thread;
+
+    static void* run(void* data)
+    {
+        Worker* worker = static_cast<Worker*>(data);
+        pthread_setspecific(__workerIndexKey, (void*)(size_t)(worker->index + 1));
+        worker->controller->workerLoop(worker->index);
+        return NULL;
+    }
+#endif
+};
+
+/**
+ * A job that runs a part of a parallel loop.
+ */
+class RangeJob : public JobController::Job
+{
+public:
+
+    RangeJob() : range(NULL), begin(0), end(0) { }
+
+    void run()
+    {
+        range->run(begin, end);
+    }
+
+    JobController::Range* range;
+    unsigned int begin;
+    unsigned int end;
+};
+
+/**
+ * Returns the index of the queue of the calling worker thread, or -1 if the calling thread is not a worker.
+ */
+static int getCurrentQueueIndex()
+{
+#ifdef WIN32
+    if (__workerIndexKey == TLS_OUT_OF_INDEXES)
+        return -1;
+    return (int)(size_t)TlsGetValue(__workerIndexKey) - 1;
+#else
+    if (!__workerIndexKeyCreated)
+        return -1;
+    return (int)(size_t)pthread_getspecific(__workerIndexKey) - 1;
+#endif
+}
+
+static unsigned int getProcessorCount()
+{
+#ifdef WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (unsigned int)info.dwNumberOfProcessors : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (unsigned int)count : 1;
+#endif
+}
+
+static void yieldThread()
+{
+#ifdef WIN32
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+JobController::JobController()
+    : _mainQueue(NULL), _nextId(0), _tasksMutex(NULL), _sleepMutex(NULL), _sleepCondition(NULL),
+      _queuedTasks(0), _nextQueue(0), _quit(false)
+{
+    _tasksMutex = new Mutex();
+    _sleepMutex = new Mutex();
+    _sleepCondition = new Condition();
+}
+
+JobController::~JobController()
+{
+    SAFE_DELETE(_sleepCondition);
+    SAFE_DELETE(_sleepMutex);
+    SAFE_DELETE(_tasksMutex);
+}
+
+void JobController::initialize()
+{
+#ifdef WIN32
+    __mainThread = GetCurrentThreadId();
+    __mainThreadSet = true;
+    if (__workerIndexKey == TLS_OUT_OF_INDEXES)
+        __workerIndexKey = TlsAlloc();
+    bool canStartWorkers = __workerIndexKey != TLS_OUT_OF_INDEXES;
+#else
+    __mainThread = pthread_self();
+    __mainThreadSet = true;
+    if (!__workerIndexKeyCreated)
+        __workerIndexKeyCreated = pthread_key_create(&__workerIndexKey, NULL) == 0;
+    bool canStartWorkers = __workerIndexKeyCreated;
+#endif
+
+    _quit = false;
+    _mainQueue = new Queue();
+
+    // The main thread runs jobs too while it waits, so start one worker less than there are cores.
+    // All queues are created before any worker starts, since the workers steal from each of them.
+    unsigned int workerCount = canStartWorkers ? getProcessorCount() - 1 : 0;
+    for (unsigned int i = 0; i < workerCount; ++i)
+    {
+        _queues.push_back(new Queue());
+    }
+    for (unsigned int i = 0; i < workerCount; ++i)
+    {
+        Worker* worker = new Worker();
+        worker->controller = this;
+        worker->index = (int)i;
+#ifdef WIN32
+        worker->thread = CreateThread(NULL, 0, &Worker::run, worker, 0, NULL);
+        bool started = worker->thread != NULL;
+#else
+        bool started = pthread_create(&worker->thread, NULL, &Worker::run, worker) == 0;
+#endif
+        if (!started)
+        {
+            GP_WARN("Failed to start job worker thread %u; using %u worker threads.", i, i);
+            SAFE_DELETE(worker);
+            break;
+        }
+        _workers.push_back(worker);
+    }
+}
+
+void JobController::finalize()
+{
+    // Run all remaining jobs.
+    while (true)
+    {
+        _tasksMutex->lock();
+        bool done = _tasks.empty();
+        _tasksMutex->unlock();
+        if (done)
+            break;
+        if (!runPendingTask())
+            yieldThread();
+    }
+
+    _sleepMutex->lock();
+    _quit = true;
+    _sleepCondition->broadcast();
+    _sleepMutex->unlock();
+
+    for (size_t i = 0, count = _workers.size(); i < count; ++i)
+    {
+        Worker* worker = _workers[i];
+#ifdef WIN32
+        WaitForSingleObject(worker->thread, INFINITE);
+        CloseHandle(worker->thread);
+#else
+        pthread_join(worker->thread, NULL);
+#endif
+        SAFE_DELETE(worker);
+    }
+    _workers.clear();
+
+    for (size_t i = 0, count = _queues.size(); i < count; ++i)
+    {
+        SAFE_DELETE(_queues[i]);
+    }
+    _queues.clear();
+    SAFE_DELETE(_mainQueue);
+}
+
+void JobController::update()
+{
+    GP_ASSERT(_mainQueue);
+
+    // Only run the jobs that are already queued, so that main thread jobs which
+    // queue more main thread jobs cannot stall the frame.
+    _mainQueue->mutex.lock();
+    size_t count = _mainQueue->tasks.size();
+    _mainQueue->mutex.unlock();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        _mainQueue->mutex.lock();
+        Task* task = NULL;
+        if (!_mainQueue->tasks.empty())
+        {
+            task = _mainQueue->tasks.front();
+            _mainQueue->tasks.pop_front();
+        }
+        _mainQueue->mutex.unlock();
+
+        if (task == NULL)
+            break;
+        execute(task);
+    }
+}
+
+JobController::JobId JobController::add(Job* job, Affinity affinity)
+{
+    return add(job, NULL, 0, affinity);
+}
+
+JobController::JobId JobController::add(Job* job, JobId dependency, Affinity affinity)
+{
+    return add(job, &dependency, 1, affinity);
+}
+
+JobController::JobId JobController::add(Job* job, const JobId* dependencies, unsigned int dependencyCount, Affinity affinity)
+{
+    GP_ASSERT(job);
+    GP_ASSERT(dependencies || dependencyCount == 0);
+
+    Task* task = new Task();
+    task->job = job;
+    task->affinity = affinity;
+    task->dependencies = 0;
+
+    _tasksMutex->lock();
+    if (++_nextId == 0)
+        _nextId = 1;
+    task->id = _nextId;
+
+    // Dependencies that are no longer in the table are already complete.
+    for (unsigned int i = 0; i < dependencyCount; ++i)
+    {
+        std::map<JobId, Task*>::iterator itr = _tasks.find(dependencies[i]);
+        if (itr != _tasks.end())
+        {
+            itr->second->dependents.push_back(task);
+            ++task->dependencies;
+        }
+    }
+    _tasks[task->id] = task;
+    bool ready = task->dependencies == 0;
+    JobId id = task->id;
+    _tasksMutex->unlock();
+
+    if (ready)
+    {
+        enqueue(task);
+    }
+    return id;
+}
+
+void JobController::enqueue(Task* task)
+{
+    GP_ASSERT(task);
+    GP_ASSERT(_mainQueue);
+
+    // Without worker threads, all jobs are run by the main thread.
+    if (task->affinity == MAIN_THREAD || _queues.empty())
+    {
+        _mainQueue->mutex.lock();
+        _mainQueue->tasks.push_back(task);
+        _mainQueue->mutex.unlock();
+        return;
+    }
+
+    int index = getCurrentQueueIndex();
+
+    _sleepMutex->lock();
+    if (index < 0)
+    {
+        // Spread jobs added from other threads over all workers.
+        index = (int)(_nextQueue++ % _queues.size());
+    }
+    Queue* queue = _queues[index];
+    queue->mutex.lock();
+    queue->tasks.push_back(task);
+    queue->mutex.unlock();
+    ++_queuedTasks;
+    _sleepCondition->signal();
+    _sleepMutex->unlock();
+}
+
+JobController::Task* JobController::dequeue(int queueIndex, bool mainThread)
+{
+    Task* task = NULL;
+
+    if (mainThread)
+    {
+        _mainQueue->mutex.lock();
+        if (!_mainQueue->tasks.empty())
+        {
+            task = _mainQueue->tasks.front();
+            _mainQueue->tasks.pop_front();
+        }
+        _mainQueue->mutex.unlock();
+        if (task)
+            return task;
+    }
+
+    size_t queueCount = _queues.size();
+    if (queueCount == 0)
+        return NULL;
+
+    // Take the newest job from the thread's own queue, since its data is the most likely to be cached.
+    if (queueIndex >= 0)
+    {
+        Queue* queue = _queues[queueIndex];
+        queue->mutex.lock();
+        if (!queue->tasks.empty())
+        {
+            task = queue->tasks.back();
+            queue->tasks.pop_back();
+        }
+        queue->mutex.unlock();
+    }
+
+    // Otherwise steal the oldest job from another queue.
+    size_t start = queueIndex >= 0 ? (size_t)queueIndex + 1 : 0;
+    for (size_t i = 0; task == NULL && i < queueCount; ++i)
+    {
+        Queue* queue = _queues[(start + i) % queueCount];
+        queue->mutex.lock();
+        if (!queue->tasks.empty())
+        {
+            task = queue->tasks.front();
+            queue->tasks.pop_front();
+        }
+        queue->mutex.unlock();
+    }
+
+    if (task)
+    {
+        _sleepMutex->lock();
+        --_queuedTasks;
+        _sleepMutex->unlock();
+    }
+    return task;
+}
+
+void JobController::execute(Task* task)
+{
+    GP_ASSERT(task);
+    GP_ASSERT(task->job);
+
+    task->job->run();
+
+    // Remove the task and collect the dependents that are now ready.
+    std::vector<Task*> ready;
+    _tasksMutex->lock();
+    _tasks.erase(task->id);
+    for (size_t i = 0, count = task->dependents.size(); i < count; ++i)
+    {
+        Task* dependent = task->dependents[i];
+        if (--dependent->dependencies == 0)
+            ready.push_back(dependent);
+    }
+    _tasksMutex->unlock();
+
+    for (size_t i = 0, count = ready.size(); i < count; ++i)
+    {
+        enqueue(ready[i]);
+    }
+    SAFE_DELETE(task);
+}
+
+bool JobController::runPendingTask()
+{
+    Task* task = dequeue(getCurrentQueueIndex(), isMainThread());
+    if (task == NULL)
+        return false;
+
+    execute(task);
+    return true;
+}
+
+void JobController::workerLoop(int queueIndex)
+{
+    while (true)
+    {
+        Task* task = dequeue(queueIndex, false);
+        if (task)
+        {
+            execute(task);
+            continue;
+        }
+
+        // Sleep until more jobs are queued; remaining jobs are still run when quitting.
+        _sleepMutex->lock();
+        while (!_quit && _queuedTasks == 0)
+        {
+            _sleepCondition->wait(_sleepMutex);
+        }
+        bool quit = _quit && _queuedTasks == 0;
+        _sleepMutex->unlock();
+
+        if (quit)
+            break;
+    }
+}
+
+bool JobController::isComplete(JobId id) const
+{
+    _tasksMutex->lock();
+    bool complete = _tasks.find(id) == _tasks.end();
+    _tasksMutex->unlock();
+    return complete;
+}
+
+void JobController::wait(JobId id)
+{
+    wait(&id, 1);
+}
+
+void JobController::wait(const JobId* ids, unsigned int count)
+{
+    GP_ASSERT(ids || count == 0);
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        while (!isComplete(ids[i]))
+        {
+            // The job is queued behind others or running on another thread, so help out.
+            if (!runPendingTask())
+                yieldThread();
+        }
+    }
+}
+
+void JobController::parallelFor(unsigned int count, Range* range, unsigned int grainSize)
+{
+    GP_ASSERT(range);
+
+    if (count == 0)
+        return;
+
+    unsigned int threadCount = getThreadCount();
+    if (grainSize == 0)
+        grainSize = std::max(count / (threadCount * PARALLEL_FOR_PARTS_PER_THREAD), 1u);
+    unsigned int partCount = (count + grainSize - 1) / grainSize;
+    if (threadCount == 1 || partCount == 1)
+    {
+        range->run(0, count);
+        return;
+    }
+
+    // Queue all parts but the first, which is run by the calling thread.
+    std::vector<RangeJob> jobs(partCount - 1);
+    std::vector<JobId> ids(partCount - 1);
+    for (unsigned int i = 1; i < partCount; ++i)
+    {
+        RangeJob& job = jobs[i - 1];
+        job.range = range;
+        job.begin = i * grainSize;
+        job.end = std::min(job.begin + grainSize, count);
+        ids[i - 1] = add(&job);
+    }
+    range->run(0, grainSize);
+    wait(&ids[0], partCount - 1);
+}
+
+unsigned int JobController::getThreadCount() const
+{
+    return (unsigned int)_workers.size() + 1;
+}
+
+bool JobController::isMainThread()
+{
+    if (!__mainThreadSet)
+        return true;
+#ifdef WIN32
+    return GetCurrentThreadId() == __mainThread;
+#else
+    return pthread_equal(pthread_self(), __mainThread) != 0;
+#endif
+}
+
+}
@@ -0,0 +1,246 @@
+#ifndef JOBCONTROLLER_H_
+#define JOBCONTROLLER_H_
+
+namespace gameplay
+{
+
+class Mutex;
+class Condition;
+
+/**
+ * Defines a class for running work on a pool of worker threads.
+ *
+ * The job controller owns one worker thread per additional processor core. Each worker
+ * has its own queue of jobs: jobs added from a worker thread are queued on that worker,
+ * and workers that run out of jobs take them from the other queues (work stealing).
+ * A thread that waits for a job also runs queued jobs until the job is complete,
+ * so the main thread is never idle while it waits.
+ *
+ * Jobs can depend on other jobs, in which case they are only started once all of their
+ * dependencies are complete. Jobs added with MAIN_THREAD affinity are always run on the
+ * main thread, either once per frame before the game is updated or while the main
+ * thread waits for jobs. This allows work that uses the graphics, audio or scripting
+ * APIs to be chained after work done on the worker threads.
+ *
+ * Jobs are not owned by the controller; they must remain valid until they are complete.
+ * GP_ERROR, GP_WARN and the scripting system must not be used from jobs that do not have
+ * MAIN_THREAD affinity.
+ *
+ * @script{ignore}
+ */
+class JobController
+{
+    friend class Game;
+
+public:
+
+    /**
+     * Defines the interface for a unit of work run by the job controller.
+     */
+    class Job
+    {
+    public:
+
+        /**
+         * Destructor.
+         */
+        virtual ~Job() { }
+
+        /**
+         * Called to do the work of the job.
+         */
+        virtual void run() = 0;
+    };
+
+    /**
+     * Defines the interface for the body of a parallel loop.
+     *
+     * @see JobController::parallelFor
+     */
+    class Range
+    {
+    public:
+
+        /**
+         * Destructor.
+         */
+        virtual ~Range() { }
+
+        /**
+         * Called to process a part of the loop's iterations.
+         *
+         * This is called concurrently from several threads for different parts of the loop.
+         *
+         * @param begin The first iteration to process.
+         * @param end One past the last iteration to process.
+         */
+        virtual void run(unsigned int begin, unsigned int end) = 0;
+    };
+
+    /**
+     * The threads that a job may run on.
+     */
+    enum Affinity
+    {
+        ANY_THREAD,
+        MAIN_THREAD
+    };
+
+    /**
+     * Identifies a job that was added to the controller. 0 is never used as an identifier.
+     */
+    typedef unsigned int JobId;
+
+    /**
+     * Adds a job to be run.
+     *
+     * @param job The job to run.
+     * @param affinity The threads the job may run on.
+     *
+     * @return The identifier of the job.
+     */
+    JobId add(Job* job, Affinity affinity = ANY_THREAD);
+
+    /**
+     * Adds a job to be run once another job is complete.
+     *
+     * @param job The job to run.
+     * @param dependency The job that must be complete before this job is started.
+     * @param affinity The threads the job may run on.
+     *
+     * @return The identifier of the job.
+     */
+    JobId add(Job* job, JobId dependency, Affinity affinity = ANY_THREAD);
+
+    /**
+     * Adds a job to be run once a set of other jobs are complete.
+     *
+     * @param job The job to run.
+     * @param dependencies The jobs that must be complete before this job is started.
+     * @param dependencyCount The number of jobs in dependencies.
+     * @param affinity The threads the job may run on.
+     *
+     * @return The identifier of the job.
+     */
+    JobId add(Job* job, const JobId* dependencies, unsigned int dependencyCount, Affinity affinity = ANY_THREAD);
+
+    /**
+     * Determines whether a job is complete.
+     *
+     * @param id The identifier of the job.
+     *
+     * @return True if the job has run, false if it is queued, waiting for dependencies or running.
+     */
+    bool isComplete(JobId id) const;
+
+    /**
+     * Waits for a job to complete, running other queued jobs in the meantime.
+     *
+     * @param id The identifier of the job to wait for.
+     */
+    void wait(JobId id);
+
+    /**
+     * Waits for a set of jobs to complete, running other queued jobs in the meantime.
+     *
+     * @param ids The identifiers of the jobs to wait for.
+     * @param count The number of identifiers.
+     */
+    void wait(const JobId* ids, unsigned int count);
+
+    /**
+     * Runs the iterations of a loop in parallel and returns when all of them are done.
+     *
+     * The iterations are split into contiguous parts of at least grainSize iterations,
+     * which are run by the worker threads and the calling thread.
+     *
+     * @param count The number of iterations.
+     * @param range The body of the loop.
+     * @param grainSize The minimum number of iterations processed by a single call to
+     *      Range::run(), or 0 to split the loop into a few parts per thread.
+     */
+    void parallelFor(unsigned int count, Range* range, unsigned int grainSize = 0);
+
+    /**
+     * Returns the number of threads that run jobs, including the main thread.
+     *
+     * @return The number of threads.
+     */
+    unsigned int getThreadCount() const;
+
+    /**
+     * Determines whether the calling thread is the main (game) thread.
+     *
+     * Before a job controller is initialized, every thread is considered to be the main thread.
+     *
+     * @return True if called from the main thread, false otherwise.
+     */
+    static bool isMainThread();
+
+private:
+
+    struct Task;
+    struct Queue;
+    struct Worker;
+
+    /**
+     * Constructor.
+     */
+    JobController();
+
+    /**
+     * Destructor.
+     */
+    ~JobController();
+
+    /**
+     * Hidden copy constructor.
+     */
+    JobController(const JobController&);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    JobController& operator=(const JobController&);
+
+    /**
+     * Called during startup to start the worker threads.
+     */
+    void initialize();
+
+    /**
+     * Called during shutdown to run all remaining jobs and stop the worker threads.
+     */
+    void finalize();
+
+    /**
+     * Called once per frame to run the jobs with MAIN_THREAD affinity that are ready.
+     */
+    void update();
+
+    void enqueue(Task* task);
+
+    Task* dequeue(int queueIndex, bool mainThread);
+
+    void execute(Task* task);
+
+    bool runPendingTask();
+
+    void workerLoop(int queueIndex);
+
+    std::vector<Worker*> _workers;      // The worker threads.
+    std::vector<Queue*> _queues;        // The job queue of each worker thread.
+    Queue* _mainQueue;                  // The queue of jobs that run on the main thread.
+    std::map<JobId, Task*> _tasks;      // All jobs that are not complete, by identifier.
+    JobId _nextId;                      // The identifier of the next job.
+    Mutex* _tasksMutex;                 // Guards _tasks, _nextId and the dependencies of tasks.
+    Mutex* _sleepMutex;                 // Guards _queuedTasks, _nextQueue and _quit.
+    Condition* _sleepCondition;         // Signaled when jobs are queued or the workers must quit.
+    unsigned int _queuedTasks;          // The number of jobs in the worker queues.
+    unsigned int _nextQueue;            // The worker queue that the next job added from another thread goes to.
+    bool _quit;                         // Set when the workers must quit.
+};
+
+}
+
+#endif
@@ -12,7 +12,7 @@ class Bundle;
 /**
  * Defines a basic hierarchical structure of transformation spaces.
  */
-class Joint : public Node
+class Joint : public Node, public PoolObject<Joint>
 {
     friend class Node;
     friend class MeshSkin;
@@ -20,6 +20,10 @@ class Joint : public Node
 
 public:
 
+    // Joints are allocated from their own pool rather than from the pool of nodes.
+    using PoolObject<Joint>::operator new;
+    using PoolObject<Joint>::operator delete;
+
     /**
      * @see Node::getType()
      */
@@ -75,14 +79,6 @@ protected:
      */
     void setInverseBindPose(const Matrix& m);
 
-    /**
-     * Updates the joint matrix.
-     * 
-     * @param bindShape The bind shape matrix.
-     * @param matrixPalette The matrix palette to update.
-     */
-    void updateJointMatrix(const Matrix& bindShape, Vector4* matrixPalette);
-
     /**
      * Called when this Joint's transform changes.
      */
@@ -122,9 +118,17 @@ private:
     Matrix _bindPose;
 
     /**
-     * Flag used to mark if the Joint's matrix is dirty.
+     * Incremented whenever the world matrix or the bind pose of the Joint changes.
+     *
+     * Each MeshSkin compares this to the revision its matrix palette was last updated
+     * with, so a joint shared by several skins is only recomputed where it changed.
+     */
+    unsigned int _revision;
+
+    /**
+     * Incremented whenever the bind pose of the Joint changes.
      */
-    bool _jointMatrixDirty;
+    unsigned int _bindPoseRevision;
 
     /**
      * Linked list of mesh skins that are referenced by this joint.
@@ -4,12 +4,13 @@
 namespace gameplay
 {
 
-Label::Label() : _text(""), _font(NULL)
+Label::Label() : _text(""), _font(NULL), _fontText(NULL)
 {
 }
 
 Label::~Label()
 {
+    SAFE_DELETE(_fontText);
 }
 
 Label* Label::create(const char* id, Theme::Style* style)
@@ -89,8 +90,15 @@ void Label::update(const Control* container, const Vector2& offset)
 
     _textBounds.set(_viewportBounds);
 
-    _font = getFont(_state);
-    _textColor = getTextColor(_state);
+    const ResolvedStyle& style = getResolvedStyle();
+    Font* font = style.font;
+    if (font != _font)
+    {
+        // The laid out text belongs to the previous font.
+        SAFE_DELETE(_fontText);
+        _font = font;
+    }
+    _textColor = style.textColor;
     _textColor.w *= _opacity;
 }
 
@@ -102,8 +110,19 @@ void Label::drawText(const Rectangle& clip)
     // Draw the text.
     if (_font)
     {
+        // Lay the text out only when it or its layout has changed since it was last drawn.
+        const ResolvedStyle& style = getResolvedStyle();
+        if (_fontText)
+        {
+            _font->updateText(_fontText, _text.c_str(), _textBounds, _textColor, style.fontSize, style.textAlignment, true, style.textRightToLeft, &_viewportClipBounds);
+        }
+        else
+        {
+            _fontText = _font->createText(_text.c_str(), _textBounds, _textColor, style.fontSize, style.textAlignment, true, style.textRightToLeft, &_viewportClipBounds);
+        }
+
         _font->start();
-        _font->drawText(_text.c_str(), _textBounds, _textColor, getFontSize(_state), getTextAlignment(_state), true, getTextRightToLeft(_state), &_viewportClipBounds);
+        _font->drawText(_fontText);
         _font->finish();
     }
 }
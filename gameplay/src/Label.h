@@ -128,6 +128,11 @@ protected:
      * The font being used to display the label.
      */
     Font* _font;
+
+    /**
+     * The text laid out by the font, which is kept until the text or its layout changes.
+     */
+    Font::Text* _fontText;
     
     /**
      * The text color being used to display the label.
@@ -0,0 +1,363 @@
+#include "Base.h"
+#include "GLStateCache.h"
+#include "LightGrid.h"
+#include "Scene.h"
+#include "Node.h"
+#include "Camera.h"
+#include "Light.h"
+#include "RenderState.h"
+#include "MaterialParameter.h"
+
+// The number of texels of a light in the light buffer.
+#define LIGHT_TEXELS 3
+
+namespace gameplay
+{
+
+static int __supported = -1;
+
+LightGrid::LightGrid(unsigned int maxLights, unsigned int tileSize, unsigned int maxLightsPerTile)
+    : _maxLights(maxLights), _tileSize(tileSize), _maxLightsPerTile(maxLightsPerTile), _columns(0), _rows(0), _lightCount(0),
+      _lightSampler(NULL), _tileSampler(NULL)
+{
+    _lightData.resize(_maxLights * LIGHT_TEXELS * 4, 0.0f);
+
+    Texture* texture = Texture::create(createHandle(LIGHT_TEXELS, _maxLights, true), LIGHT_TEXELS, _maxLights, Texture::RGBA);
+    _lightSampler = createSampler(texture);
+    SAFE_RELEASE(texture);
+
+    resize(1, 1);
+}
+
+LightGrid::~LightGrid()
+{
+    SAFE_RELEASE(_lightSampler);
+    SAFE_RELEASE(_tileSampler);
+}
+
+LightGrid* LightGrid::create(unsigned int maxLights, unsigned int tileSize, unsigned int maxLightsPerTile)
+{
+    if (!isSupported())
+    {
+        GP_WARN("Tiled lighting requires floating point textures, which are not supported.");
+        return NULL;
+    }
+    if (maxLights == 0 || maxLights > 255)
+    {
+        GP_WARN("Light grid supports from 1 to 255 lights; clamping %u.", maxLights);
+        maxLights = maxLights == 0 ? 1 : 255;
+    }
+    GP_ASSERT(tileSize > 0);
+    GP_ASSERT(maxLightsPerTile > 0);
+
+    return new LightGrid(maxLights, tileSize, maxLightsPerTile);
+}
+
+bool LightGrid::isSupported()
+{
+    if (__supported == -1)
+    {
+#if defined(OPENGL_ES)
+        const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+        __supported = (extensions && strstr(extensions, "GL_OES_texture_float")) ? 1 : 0;
+#elif defined(__glew_h__)
+        __supported = (GLEW_VERSION_3_0 || GLEW_ARB_texture_float) ? 1 : 0;
+#else
+        __supported = 1;
+#endif
+    }
+    return __supported == 1;
+}
+
+Texture::Sampler* LightGrid::createSampler(Texture* texture)
+{
+    // The textures are read texel by texel, and the parameters set by createHandle() are
+    // recorded so that binding the sampler does not change them.
+    texture->_minFilter = Texture::NEAREST;
+    texture->_magFilter = Texture::NEAREST;
+    texture->_wrapS = Texture::CLAMP;
+    texture->_wrapT = Texture::CLAMP;
+
+    Texture::Sampler* sampler = Texture::Sampler::create(texture);
+    sampler->setFilterMode(Texture::NEAREST, Texture::NEAREST);
+    sampler->setWrapMode(Texture::CLAMP, Texture::CLAMP);
+    return sampler;
+}
+
+GLuint LightGrid::createHandle(unsigned int width, unsigned int height, bool floatingPoint)
+{
+    GLuint handle;
+    GL_ASSERT( glGenTextures(1, &handle) );
+    GLStateCache::bindTexture(GL_TEXTURE_2D, handle);
+    GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST) );
+    GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST) );
+    GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE) );
+    GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE) );
+    GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 1) );
+    if (floatingPoint)
+    {
+#if defined(OPENGL_ES)
+        GL_ASSERT( glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_FLOAT, NULL) );
+#else
+        GL_ASSERT( glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, NULL) );
+#endif
+    }
+    else
+    {
+        std::vector<unsigned char> zeros(width * height, 0);
+        GL_ASSERT( glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, width, height, 0, GL_ALPHA, GL_UNSIGNED_BYTE, &zeros[0]) );
+    }
+    GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 4) );
+
+    return handle;
+}
+
+void LightGrid::resize(unsigned int columns, unsigned int rows)
+{
+    if (columns == _columns && rows == _rows)
+        return;
+
+    _columns = columns;
+    _rows = rows;
+    _tileData.assign(_columns * _maxLightsPerTile * _rows, 0);
+    _tileCounts.assign(_columns * _rows, 0);
+
+    unsigned int width = _columns * _maxLightsPerTile;
+    GLuint handle = createHandle(width, _rows, false);
+    if (_tileSampler)
+    {
+        // The sampler is bound to materials by pointer, so the handle of its texture is replaced in place.
+        Texture* texture = _tileSampler->getTexture();
+        GLStateCache::deleteTextures(1, &texture->_handle);
+        texture->_handle = handle;
+        texture->_width = width;
+        texture->_height = _rows;
+    }
+    else
+    {
+        Texture* texture = Texture::create(handle, width, _rows, Texture::ALPHA);
+        _tileSampler = createSampler(texture);
+        SAFE_RELEASE(texture);
+    }
+}
+
+bool LightGrid::collectLights(Node* node, std::vector<Node*>* nodes)
+{
+    if (node->getLight())
+        nodes->push_back(node);
+    return true;
+}
+
+void LightGrid::update(Scene* scene, const Rectangle& viewport)
+{
+    GP_ASSERT(scene);
+
+    Camera* camera = scene->getActiveCamera();
+    if (!camera)
+        return;
+
+    std::vector<Node*> nodes;
+    scene->visit(this, &LightGrid::collectLights, &nodes);
+    update(camera, viewport, nodes);
+}
+
+void LightGrid::update(Camera* camera, const Rectangle& viewport, const std::vector<Node*>& nodes)
+{
+    GP_ASSERT(camera);
+
+    _origin.set(viewport.x, viewport.y);
+    unsigned int width = viewport.width > 0.0f ? (unsigned int)viewport.width : 1;
+    unsigned int height = viewport.height > 0.0f ? (unsigned int)viewport.height : 1;
+    resize((width + _tileSize - 1) / _tileSize, (height + _tileSize - 1) / _tileSize);
+
+    const Matrix& view = camera->getViewMatrix();
+    const Matrix& projection = camera->getProjectionMatrix();
+    const float nearPlane = camera->getNearPlane();
+
+    // Sort the lights by distance to the camera, so that the closest are kept when the
+    // light buffer or a tile is full.
+    std::vector<std::pair<float, Node*> > lights;
+    lights.reserve(nodes.size());
+    for (size_t i = 0, count = nodes.size(); i < count; ++i)
+    {
+        Node* node = nodes[i];
+        Light* light = node->getLight();
+        if (!light || light->getLightType() == Light::DIRECTIONAL)
+            continue;
+
+        Vector3 position;
+        view.transformPoint(node->getTranslationWorld(), &position);
+
+        // Skip lights whose range is entirely behind the near plane.
+        if (position.z - light->getRange() > -nearPlane)
+            continue;
+
+        lights.push_back(std::make_pair(position.lengthSquared(), node));
+    }
+    std::sort(lights.begin(), lights.end());
+    if (lights.size() > _maxLights)
+        lights.resize(_maxLights);
+
+    std::fill(_tileData.begin(), _tileData.end(), 0);
+    std::fill(_tileCounts.begin(), _tileCounts.end(), 0);
+    _lightCount = lights.size();
+
+    for (unsigned int i = 0; i < _lightCount; ++i)
+    {
+        Node* node = lights[i].second;
+        Light* light = node->getLight();
+        const float range = light->getRange();
+
+        Vector3 position;
+        view.transformPoint(node->getTranslationWorld(), &position);
+
+        float* data = &_lightData[i * LIGHT_TEXELS * 4];
+        data[0] = position.x;
+        data[1] = position.y;
+        data[2] = position.z;
+        data[3] = light->getRangeInverse();
+        const Vector3& color = light->getColor();
+        data[4] = color.x;
+        data[5] = color.y;
+        data[6] = color.z;
+        if (light->getLightType() == Light::SPOT)
+        {
+            Vector3 direction;
+            view.transformVector(node->getForwardVectorWorld(), &direction);
+            direction.normalize();
+            data[7] = light->getInnerAngleCos();
+            data[8] = direction.x;
+            data[9] = direction.y;
+            data[10] = direction.z;
+            data[11] = light->getOuterAngleCos();
+        }
+        else
+        {
+            // Cosines that never limit the light, for any direction.
+            data[7] = -1.0f;
+            data[8] = 0.0f;
+            data[9] = 0.0f;
+            data[10] = 0.0f;
+            data[11] = -2.0f;
+        }
+
+        // Find the screen rectangle of the range of the light, from the corners of its
+        // bounds in view space. Ranges that cross the near plane cover the whole screen.
+        unsigned int minColumn = 0, maxColumn = _columns - 1;
+        unsigned int minRow = 0, maxRow = _rows - 1;
+        if (position.z + range < -nearPlane)
+        {
+            Vector4 corners[8];
+            for (unsigned int c = 0; c < 8; ++c)
+            {
+                corners[c].set(position.x + ((c & 1) ? range : -range),
+                               position.y + ((c & 2) ? range : -range),
+                               position.z + ((c & 4) ? range : -range), 1.0f);
+            }
+            projection.transformVectors(corners, corners, 8);
+
+            float minX = 1.0f, minY = 1.0f, maxX = -1.0f, maxY = -1.0f;
+            for (unsigned int c = 0; c < 8; ++c)
+            {
+                const Vector4& corner = corners[c];
+                float x = corner.x / corner.w;
+                float y = corner.y / corner.w;
+                minX = std::min(minX, x);
+                maxX = std::max(maxX, x);
+                minY = std::min(minY, y);
+                maxY = std::max(maxY, y);
+            }
+            if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f)
+                continue;
+
+            const float tileScale = 0.5f / (float)_tileSize;
+            minColumn = (unsigned int)(std::max(minX + 1.0f, 0.0f) * width * tileScale);
+            maxColumn = std::min((unsigned int)(std::min(maxX + 1.0f, 2.0f) * width * tileScale), _columns - 1);
+            minRow = (unsigned int)(std::max(minY + 1.0f, 0.0f) * height * tileScale);
+            maxRow = std::min((unsigned int)(std::min(maxY + 1.0f, 2.0f) * height * tileScale), _rows - 1);
+        }
+
+        // Append the light to the lists of the tiles it reaches, as its index plus one.
+        for (unsigned int row = minRow; row <= maxRow; ++row)
+        {
+            for (unsigned int column = minColumn; column <= maxColumn; ++column)
+            {
+                unsigned char& count = _tileCounts[row * _columns + column];
+                if (count < _maxLightsPerTile)
+                {
+                    _tileData[(row * _columns + column) * _maxLightsPerTile + count] = (unsigned char)(i + 1);
+                    ++count;
+                }
+            }
+        }
+    }
+
+    GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 1) );
+    if (_lightCount > 0)
+    {
+        GLStateCache::bindTexture(GL_TEXTURE_2D, _lightSampler->getTexture()->getHandle());
+        GL_ASSERT( glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, LIGHT_TEXELS, _lightCount, GL_RGBA, GL_FLOAT, &_lightData[0]) );
+    }
+    GLStateCache::bindTexture(GL_TEXTURE_2D, _tileSampler->getTexture()->getHandle());
+    GL_ASSERT( glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, _columns * _maxLightsPerTile, _rows, GL_ALPHA, GL_UNSIGNED_BYTE, &_tileData[0]) );
+    GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 4) );
+}
+
+void LightGrid::bind(RenderState* state)
+{
+    GP_ASSERT(state);
+
+    state->getParameter("u_lightTexture")->bindValue(this, &LightGrid::getLightSampler);
+    state->getParameter("u_tileLightTexture")->bindValue(this, &LightGrid::getTileSampler);
+    state->getParameter("u_lightGridOrigin")->bindValue(this, &LightGrid::getOrigin);
+    state->getParameter("u_lightGridSize")->bindValue(this, &LightGrid::getSize);
+    state->getParameter("u_lightGridTileSize")->bindValue(this, &LightGrid::getTileSize);
+    state->getParameter("u_lightTextureHeight")->bindValue(this, &LightGrid::getLightTextureHeight);
+}
+
+const Texture::Sampler* LightGrid::getLightSampler() const
+{
+    return _lightSampler;
+}
+
+const Texture::Sampler* LightGrid::getTileSampler() const
+{
+    return _tileSampler;
+}
+
+Vector2 LightGrid::getOrigin() const
+{
+    return _origin;
+}
+
+Vector2 LightGrid::getSize() const
+{
+    return Vector2((float)_columns, (float)_rows);
+}
+
+float LightGrid::getTileSize() const
+{
+    return (float)_tileSize;
+}
+
+float LightGrid::getLightTextureHeight() const
+{
+    return (float)_maxLights;
+}
+
+unsigned int LightGrid::getLightCount() const
+{
+    return _lightCount;
+}
+
+unsigned int LightGrid::getMaxLights() const
+{
+    return _maxLights;
+}
+
+unsigned int LightGrid::getMaxLightsPerTile() const
+{
+    return _maxLightsPerTile;
+}
+
+}
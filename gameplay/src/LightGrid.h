@@ -0,0 +1,201 @@
+#ifndef LIGHTGRID_H_
+#define LIGHTGRID_H_
+
+#include "Ref.h"
+#include "Texture.h"
+#include "Rectangle.h"
+#include "Vector2.h"
+
+namespace gameplay
+{
+
+class Node;
+class Camera;
+class Scene;
+class RenderState;
+
+/**
+ * Defines a grid of screen tiles that the point and spot lights of a scene are binned into,
+ * for tiled forward lighting of many dynamic lights in a single pass.
+ *
+ * Each frame, update() projects the range of each light onto the screen and lists the lights
+ * that can reach each tile. The lights are written to a light buffer texture and the lists of
+ * the tiles to a second texture. Materials whose effects are compiled with the TILED_LIGHTING
+ * define read both textures in colored.frag and textured.frag, and add the lights that reach
+ * the tile of each fragment to the light of the pass, without a pass per light. Parameters
+ * are bound to a material, technique or pass with bind(), once.
+ *
+ * The grid is used as follows:
+ *
+ @verbatim
+    LightGrid* grid = LightGrid::create();
+    grid->bind(material);
+    // ... each frame ...
+    grid->update(scene, viewport);
+    // ... draw the scene ...
+ @endverbatim
+ *
+ * Tiled lighting does not apply to bumped materials, whose lighting is computed in tangent
+ * space. The number of lights per tile must match the TILE_LIGHT_COUNT define of the effects,
+ * which is 16 by default. When a tile is reached by more lights, those closest to the camera
+ * are kept.
+ *
+ * The light buffer uses floating point textures, which require OpenGL 3.0 or
+ * OES_texture_float on OpenGL ES. Where they are not available, create() returns NULL.
+ *
+ * @script{ignore}
+ */
+class LightGrid : public Ref
+{
+public:
+
+    /**
+     * Creates a light grid.
+     *
+     * @param maxLights The maximum number of lights in the light buffer, up to 255.
+     * @param tileSize The width and height of a tile in pixels.
+     * @param maxLightsPerTile The maximum number of lights that reach a tile, which must match
+     *      the TILE_LIGHT_COUNT define of the effects.
+     *
+     * @return The new light grid, or NULL if floating point textures are not supported.
+     */
+    static LightGrid* create(unsigned int maxLights = 128, unsigned int tileSize = 32, unsigned int maxLightsPerTile = 16);
+
+    /**
+     * Determines whether tiled lighting is supported on this platform.
+     *
+     * @return True if floating point textures are supported.
+     */
+    static bool isSupported();
+
+    /**
+     * Bins the point and spot lights of a scene, as seen by its active camera.
+     *
+     * @param scene The scene whose lights are binned.
+     * @param viewport The viewport the scene is drawn into.
+     */
+    void update(Scene* scene, const Rectangle& viewport);
+
+    /**
+     * Bins a set of point and spot lights, and uploads the light buffer and tile textures.
+     *
+     * Nodes without a light, and nodes with a directional light, are ignored.
+     *
+     * @param camera The camera the scene is drawn with.
+     * @param viewport The viewport the scene is drawn into.
+     * @param nodes The nodes of the lights.
+     */
+    void update(Camera* camera, const Rectangle& viewport, const std::vector<Node*>& nodes);
+
+    /**
+     * Binds the uniforms of tiled lighting in a render state to this grid.
+     *
+     * @param state The material, technique or pass to bind.
+     */
+    void bind(RenderState* state);
+
+    /**
+     * Returns the sampler of the light buffer texture.
+     *
+     * @return The sampler bound to u_lightTexture.
+     */
+    const Texture::Sampler* getLightSampler() const;
+
+    /**
+     * Returns the sampler of the texture listing the lights of each tile.
+     *
+     * @return The sampler bound to u_tileLightTexture.
+     */
+    const Texture::Sampler* getTileSampler() const;
+
+    /**
+     * Returns the origin of the viewport of the last update.
+     *
+     * @return The position in pixels, bound to u_lightGridOrigin.
+     */
+    Vector2 getOrigin() const;
+
+    /**
+     * Returns the number of tiles of the grid.
+     *
+     * @return The number of columns and rows, bound to u_lightGridSize.
+     */
+    Vector2 getSize() const;
+
+    /**
+     * Returns the width and height of a tile.
+     *
+     * @return The size in pixels, bound to u_lightGridTileSize.
+     */
+    float getTileSize() const;
+
+    /**
+     * Returns the number of lights binned by the last update.
+     *
+     * @return The number of lights in the light buffer.
+     */
+    unsigned int getLightCount() const;
+
+    /**
+     * Returns the maximum number of lights in the light buffer.
+     *
+     * @return The number of lights.
+     */
+    unsigned int getMaxLights() const;
+
+    /**
+     * Returns the maximum number of lights that reach a tile.
+     *
+     * @return The number of lights.
+     */
+    unsigned int getMaxLightsPerTile() const;
+
+private:
+
+    /**
+     * Constructor.
+     */
+    LightGrid(unsigned int maxLights, unsigned int tileSize, unsigned int maxLightsPerTile);
+
+    /**
+     * Destructor.
+     */
+    ~LightGrid();
+
+    /**
+     * Hidden copy constructor.
+     */
+    LightGrid(const LightGrid&);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    LightGrid& operator=(const LightGrid&);
+
+    bool collectLights(Node* node, std::vector<Node*>* nodes);
+
+    float getLightTextureHeight() const;
+
+    void resize(unsigned int columns, unsigned int rows);
+
+    static Texture::Sampler* createSampler(Texture* texture);
+
+    static GLuint createHandle(unsigned int width, unsigned int height, bool floatingPoint);
+
+    unsigned int _maxLights;
+    unsigned int _tileSize;
+    unsigned int _maxLightsPerTile;
+    unsigned int _columns;
+    unsigned int _rows;
+    unsigned int _lightCount;
+    Vector2 _origin;
+    Texture::Sampler* _lightSampler;
+    Texture::Sampler* _tileSampler;
+    std::vector<float> _lightData;
+    std::vector<unsigned char> _tileData;
+    std::vector<unsigned char> _tileCounts;
+};
+
+}
+
+#endif
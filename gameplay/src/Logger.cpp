@@ -2,11 +2,195 @@
 #include "Game.h"
 #include "ScriptController.h"
 
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
+
+#ifndef va_copy
+    #define va_copy(dst, src) ((dst) = (src))
+#endif
+
+// The number of entries in the ring buffer of asynchronous messages.
+#define LOG_ENTRY_COUNT 256
+
+// The size of an entry, including the null terminator.
+#define LOG_ENTRY_SIZE 512
+
 namespace gameplay
 {
 
 Logger::State Logger::_state[3];
 
+/**
+ * An entry of the ring buffer of asynchronous messages.
+ *
+ * The sequence of the entry for index i is i while it is free to be reserved for index i,
+ * and i + 1 once its message is ready to be written. Once written, the entry is freed for
+ * index i + LOG_ENTRY_COUNT. So producers never take an entry the background thread has
+ * not written, even when one of them is preempted for a whole turn of the ring.
+ */
+struct LogEntry
+{
+    volatile long sequence;
+    char text[LOG_ENTRY_SIZE];
+};
+
+static LogEntry* __entries = NULL;              // The ring buffer, or NULL when messages are written synchronously.
+static volatile long __writeIndex = 0;          // The next entry to reserve.
+static volatile long __readIndex = 0;           // The next entry for the background thread to write.
+static volatile long __dropped = 0;             // The messages dropped because the ring buffer was full.
+static volatile bool __writerRunning = false;
+#ifdef WIN32
+static HANDLE __writerThread = NULL;
+#else
+static pthread_t __writerThread;
+#endif
+
+static bool compareAndSwap(volatile long* value, long expected, long desired)
+{
+#ifdef WIN32
+    return InterlockedCompareExchange((volatile LONG*)value, (LONG)desired, (LONG)expected) == (LONG)expected;
+#else
+    return __sync_bool_compare_and_swap(value, expected, desired);
+#endif
+}
+
+static long exchange(volatile long* value, long desired)
+{
+#ifdef WIN32
+    return (long)InterlockedExchange((volatile LONG*)value, (LONG)desired);
+#else
+    return __sync_lock_test_and_set(value, desired);
+#endif
+}
+
+static void memoryBarrier()
+{
+#ifdef WIN32
+    MemoryBarrier();
+#else
+    __sync_synchronize();
+#endif
+}
+
+static void sleepMilliseconds(unsigned int milliseconds)
+{
+#ifdef WIN32
+    Sleep(milliseconds);
+#else
+    usleep(milliseconds * 1000);
+#endif
+}
+
+static LogEntry* getEntry(long index)
+{
+    return &__entries[(unsigned long)index % LOG_ENTRY_COUNT];
+}
+
+static long nextIndex(long index, unsigned long count = 1)
+{
+    return (long)((unsigned long)index + count);
+}
+
+/**
+ * Writes the entries that are ready, in order.
+ *
+ * @return True if any message was written.
+ */
+static bool writeEntries()
+{
+    bool written = false;
+    for (;;)
+    {
+        long index = __readIndex;
+        LogEntry* entry = getEntry(index);
+        if (entry->sequence != nextIndex(index))
+            break;
+
+        // Read the text only after seeing that the entry is ready.
+        memoryBarrier();
+        if (entry->text[0])
+            gameplay::print("%s", entry->text);
+        memoryBarrier();
+        entry->sequence = nextIndex(index, LOG_ENTRY_COUNT);
+        __readIndex = nextIndex(index);
+        written = true;
+    }
+
+    long dropped = exchange(&__dropped, 0);
+    if (dropped > 0)
+        gameplay::print("Logger: %ld messages were dropped because the log buffer was full.\n", dropped);
+    return written || dropped > 0;
+}
+
+#ifdef WIN32
+static DWORD WINAPI writerLoop(LPVOID)
+#else
+static void* writerLoop(void*)
+#endif
+{
+    while (__writerRunning)
+    {
+        if (!writeEntries())
+            sleepMilliseconds(1);
+    }
+    writeEntries();
+    return 0;
+}
+
+/**
+ * Copies or formats a message into the next entry of the ring buffer.
+ *
+ * @return False if the message is longer than an entry and must be written synchronously.
+ */
+static bool logAsync(const char* message, va_list args)
+{
+    // Reserve the next entry, unless the background thread has not written it yet.
+    long index;
+    LogEntry* entry;
+    for (;;)
+    {
+        index = __writeIndex;
+        entry = getEntry(index);
+        long difference = (long)((unsigned long)entry->sequence - (unsigned long)index);
+        if (difference < 0)
+        {
+            long dropped;
+            do
+            {
+                dropped = __dropped;
+            } while (!compareAndSwap(&__dropped, dropped, dropped + 1));
+            return true;
+        }
+        if (difference == 0 && compareAndSwap(&__writeIndex, index, nextIndex(index)))
+            break;
+    }
+
+    bool fits;
+    if (strchr(message, '%') == NULL)
+    {
+        size_t length = strlen(message);
+        fits = length < LOG_ENTRY_SIZE;
+        if (fits)
+            memcpy(entry->text, message, length + 1);
+    }
+    else
+    {
+        int needed = vsnprintf(entry->text, LOG_ENTRY_SIZE, message, args);
+        fits = needed >= 0 && needed < LOG_ENTRY_SIZE;
+    }
+
+    // A message that does not fit is published empty, to keep the entries after it in order.
+    if (!fits)
+        entry->text[0] = '\0';
+    memoryBarrier();
+    entry->sequence = nextIndex(index);
+    return fits;
+}
+
 Logger::State::State() : logFunctionC(NULL), logFunctionLua(NULL), enabled(true)
 {
 }
@@ -28,6 +212,24 @@ void Logger::log(Level level, const char* message, ...)
     va_list args;
     va_start(args, message);
 
+    if (__entries)
+    {
+        // Errors and messages for log functions are written on this thread, after the pending messages.
+        if (level != LEVEL_ERROR && !state.logFunctionC && !state.logFunctionLua)
+        {
+            va_list asyncArgs;
+            va_copy(asyncArgs, args);
+            bool queued = logAsync(message, asyncArgs);
+            va_end(asyncArgs);
+            if (queued)
+            {
+                va_end(args);
+                return;
+            }
+        }
+        flush();
+    }
+
     // Declare a moderately sized buffer on the stack that should be
     // large enough to accommodate most log requests.
     int size = 1024;
@@ -72,11 +274,6 @@ void Logger::log(Level level, const char* message, ...)
     va_end(args);
 }
 
-bool Logger::isEnabled(Level level)
-{
-    return _state[level].enabled;
-}
-
 void Logger::setEnabled(Level level, bool enabled)
 {
     _state[level].enabled = enabled;
@@ -96,4 +293,65 @@ void Logger::set(Level level, const char* logFunction)
     state.logFunctionC = NULL;
 }
 
+void Logger::setAsync(bool async)
+{
+    if (async == (__entries != NULL))
+        return;
+
+    if (async)
+    {
+        LogEntry* entries = new LogEntry[LOG_ENTRY_COUNT];
+        for (unsigned int i = 0; i < LOG_ENTRY_COUNT; ++i)
+            entries[i].sequence = (long)i;
+        __writeIndex = 0;
+        __readIndex = 0;
+        __dropped = 0;
+        __writerRunning = true;
+        __entries = entries;
+        memoryBarrier();
+#ifdef WIN32
+        __writerThread = CreateThread(NULL, 0, &writerLoop, NULL, 0, NULL);
+        bool started = __writerThread != NULL;
+#else
+        bool started = pthread_create(&__writerThread, NULL, &writerLoop, NULL) == 0;
+#endif
+        if (!started)
+        {
+            __writerRunning = false;
+            __entries = NULL;
+            SAFE_DELETE_ARRAY(entries);
+            GP_WARN("Failed to start the logging thread; messages will be written synchronously.");
+        }
+    }
+    else
+    {
+        flush();
+        __writerRunning = false;
+#ifdef WIN32
+        WaitForSingleObject(__writerThread, INFINITE);
+        CloseHandle(__writerThread);
+        __writerThread = NULL;
+#else
+        pthread_join(__writerThread, NULL);
+#endif
+        LogEntry* entries = __entries;
+        __entries = NULL;
+        SAFE_DELETE_ARRAY(entries);
+    }
+}
+
+bool Logger::isAsync()
+{
+    return __entries != NULL;
+}
+
+void Logger::flush()
+{
+    if (!__entries)
+        return;
+
+    while (__readIndex != __writeIndex || __dropped > 0)
+        sleepMilliseconds(1);
+}
+
 }
@@ -12,7 +12,12 @@ namespace gameplay
  * as well as to other possibly platform specific locations. Logging behavior
  * can be modified for a specific log level by passing a custom C or Lua logging
  * function to the Logger::set method. Logging can also be toggled using the
- * setEnabled method.
+ * setEnabled method, and the GP_WARN and GP_ERROR macros only test a flag for
+ * levels that are disabled.
+ *
+ * Writing to the platform output blocks the logging thread, and is slow on some
+ * platforms such as Android. With setAsync, the messages for the default output
+ * are written by a background thread instead.
  */
 class Logger
 {
@@ -85,6 +90,42 @@ public:
      */
     static void set(Level level, const char* logFunction);
 
+    /**
+     * Sets whether the messages logged to the default output are written by a background thread.
+     *
+     * When enabled, log formats each message into an entry of a fixed ring buffer, without
+     * locking or allocating, and a background thread writes the entries to the default output
+     * in order. Messages without format specifiers are copied without being formatted.
+     *
+     * Only the levels without a C or Lua log function are written asynchronously, since those
+     * functions are expected to be called on the logging thread. Errors, which usually end the
+     * program, and messages longer than an entry (512 characters) are written synchronously
+     * once the messages before them have been written. When the writer falls behind and the
+     * buffer is full, messages are dropped, and the number dropped is written in their place.
+     *
+     * This should be called from the main thread while no other thread is logging.
+     *
+     * @param async True to write messages on a background thread, false to write them on the
+     *      thread that logs them, once the pending messages have been written.
+     * @script{ignore}
+     */
+    static void setAsync(bool async);
+
+    /**
+     * Determines whether messages are written by a background thread.
+     *
+     * @return True if messages are written asynchronously.
+     * @script{ignore}
+     */
+    static bool isAsync();
+
+    /**
+     * Waits until the messages logged asynchronously have been written.
+     *
+     * @script{ignore}
+     */
+    static void flush();
+
 private:
 
     struct State
@@ -119,6 +160,11 @@ private:
 
 };
 
+inline bool Logger::isEnabled(Level level)
+{
+    return _state[level].enabled;
+}
+
 }
 
 #endif
@@ -1,4 +1,5 @@
 #include "Base.h"
+#include "Profiler.h"
 #include "Material.h"
 #include "FileSystem.h"
 #include "Effect.h"
@@ -10,8 +11,11 @@
 namespace gameplay
 {
 
+// The templates of the materials created from URLs, which remove themselves when destroyed.
+static std::map<std::string, Material*> __templates;
+
 Material::Material() :
-    _currentTechnique(NULL)
+    _currentTechnique(NULL), _cached(false)
 {
 }
 
@@ -23,26 +27,202 @@ Material::~Material()
         Technique* technique = _techniques[i];
         SAFE_RELEASE(technique);
     }
+
+    if (_cached)
+    {
+        for (std::map<std::string, Material*>::iterator itr = __templates.begin(); itr != __templates.end(); ++itr)
+        {
+            if (itr->second == this)
+            {
+                __templates.erase(itr);
+                break;
+            }
+        }
+    }
+
+    // Instances hold a reference to their template.
+    SAFE_RELEASE(_template);
 }
 
 Material* Material::create(const char* url)
 {
-    // Load the material properties from file.
+    return createFromTemplate(url, NULL);
+}
+
+Material* Material::createFromTemplate(const char* url, Properties* materialProperties)
+{
+    GP_ASSERT(url);
+
+    std::map<std::string, Material*>::const_iterator itr = __templates.find(url);
+    if (itr != __templates.end())
+    {
+        return itr->second->createInstance();
+    }
+
+    Material* materialTemplate = NULL;
+    if (materialProperties)
+    {
+        materialTemplate = create(materialProperties);
+    }
+    else
+    {
+        // Load the material properties from file.
+        Properties* properties = Properties::create(url);
+        if (properties == NULL)
+        {
+            GP_ERROR("Failed to create material from file.");
+            return NULL;
+        }
+
+        materialTemplate = create((strlen(properties->getNamespace()) > 0) ? properties : properties->getNextNamespace());
+        SAFE_DELETE(properties);
+    }
+    if (materialTemplate == NULL)
+        return NULL;
+
+    // The template is only referenced by the materials created from it.
+    materialTemplate->_cached = true;
+    __templates[url] = materialTemplate;
+    Material* material = materialTemplate->createInstance();
+    SAFE_RELEASE(materialTemplate);
+    return material;
+}
+
+Material* Material::createInstance()
+{
+    Material* material = new Material();
+    material->shareFrom(this);
+    addRef();
+
+    for (size_t i = 0, count = _techniques.size(); i < count; ++i)
+    {
+        Technique* technique = _techniques[i];
+        GP_ASSERT(technique);
+        Technique* techniqueInstance = new Technique(technique->getId(), material);
+        for (size_t j = 0, passCount = technique->_passes.size(); j < passCount; ++j)
+        {
+            Pass* pass = technique->_passes[j];
+            GP_ASSERT(pass && pass->getEffect());
+            pass->getEffect()->addRef();
+            Pass* passInstance = new Pass(pass->getId(), techniqueInstance, pass->getEffect());
+            passInstance->shareFrom(pass);
+            passInstance->_parent = techniqueInstance;
+            techniqueInstance->_passes.push_back(passInstance);
+        }
+        techniqueInstance->shareFrom(technique);
+        techniqueInstance->_parent = material;
+        material->_techniques.push_back(techniqueInstance);
+        if (_currentTechnique == technique)
+        {
+            material->_currentTechnique = techniqueInstance;
+        }
+    }
+    return material;
+}
+
+/**
+ * Returns the path of the file of a URL, without the namespace path that follows '#'.
+ */
+static std::string getFilePath(const std::string& url)
+{
+    return url.substr(0, url.find('#'));
+}
+
+unsigned int Material::reloadFile(const char* path)
+{
+    GP_ASSERT(path);
+
+    unsigned int count = 0;
+    for (std::map<std::string, Material*>::const_iterator itr = __templates.begin(); itr != __templates.end(); ++itr)
+    {
+        GP_ASSERT(itr->second);
+        if (getFilePath(itr->first) == path && itr->second->reload(itr->first.c_str()))
+            ++count;
+    }
+    return count;
+}
+
+void Material::getSourceFiles(std::set<std::string>& files)
+{
+    for (std::map<std::string, Material*>::const_iterator itr = __templates.begin(); itr != __templates.end(); ++itr)
+    {
+        files.insert(getFilePath(itr->first));
+    }
+}
+
+bool Material::reload(const char* url)
+{
     Properties* properties = Properties::create(url);
     if (properties == NULL)
     {
-        GP_ERROR("Failed to create material from file.");
-        return NULL;
+        GP_WARN("Failed to reload material '%s'.", url);
+        return false;
     }
+    Properties* materialProperties = (strlen(properties->getNamespace()) > 0) ? properties : properties->getNextNamespace();
+    if (!materialProperties || strcmp(materialProperties->getNamespace(), "material") != 0)
+    {
+        GP_WARN("Failed to reload material '%s'; it has no 'material' namespace.", url);
+        SAFE_DELETE(properties);
+        return false;
+    }
+
+    // The parameters of the template are shared with the materials created from it, so
+    // setting them in place updates those materials too.
+    bool matched = true;
+    size_t techniqueIndex = 0;
+    Properties* techniqueProperties;
+    while ((techniqueProperties = materialProperties->getNextNamespace()))
+    {
+        if (strcmp(techniqueProperties->getNamespace(), "technique") != 0)
+            continue;
+        if (techniqueIndex >= _techniques.size())
+        {
+            matched = false;
+            break;
+        }
+
+        Technique* technique = _techniques[techniqueIndex++];
+        size_t passIndex = 0;
+        techniqueProperties->rewind();
+        Properties* passProperties;
+        while ((passProperties = techniqueProperties->getNextNamespace()))
+        {
+            if (strcmp(passProperties->getNamespace(), "pass") != 0)
+                continue;
+            if (passIndex >= technique->_passes.size())
+            {
+                matched = false;
+                break;
+            }
 
-    Material* material = create((strlen(properties->getNamespace()) > 0) ? properties : properties->getNextNamespace());
+            // The id of an effect is made of its shader paths and defines (see Effect::createFromFile).
+            Pass* pass = technique->_passes[passIndex++];
+            const char* vertexShaderPath = passProperties->getString("vertexShader");
+            const char* fragmentShaderPath = passProperties->getString("fragmentShader");
+            const char* defines = passProperties->getString("defines");
+            std::string effectId = std::string(vertexShaderPath ? vertexShaderPath : "") + ';' +
+                                   (fragmentShaderPath ? fragmentShaderPath : "") + ';' + (defines ? defines : "");
+            if (pass->getEffect() == NULL || effectId != pass->getEffect()->getId())
+                matched = false;
+
+            loadRenderState(pass, passProperties);
+        }
+        loadRenderState(technique, techniqueProperties);
+    }
+    loadRenderState(this, materialProperties);
     SAFE_DELETE(properties);
 
-    return material;
+    if (!matched)
+    {
+        GP_WARN("The techniques, passes or shaders of material '%s' changed; they are only applied to the materials created from now on.", url);
+    }
+    return true;
 }
 
 Material* Material::create(Properties* materialProperties)
 {
+    GP_PROFILE("Material::create");
+
     // Check if the Properties is valid and has a valid namespace.
     if (!materialProperties || !(strcmp(materialProperties->getNamespace(), "material") == 0))
     {
@@ -169,6 +349,11 @@ Material* Material::clone(NodeCloneContext &context) const
 {
     Material* material = new Material();
     RenderState::cloneInto(material, context);
+    if (material->_template)
+    {
+        // The clone of an instance shares its template too.
+        material->_template->addRef();
+    }
 
     for (std::vector<Technique*>::const_iterator it = _techniques.begin(); it != _techniques.end(); ++it)
     {
@@ -328,6 +513,29 @@ static Texture::Wrap parseTextureWrapMode(const char* str, Texture::Wrap default
     }
 }
 
+static Texture::Format parseTextureFormat(const char* str)
+{
+    if (str == NULL || strlen(str) == 0)
+        return Texture::UNKNOWN;
+    else if (strcmp(str, "RGB") == 0)
+        return Texture::RGB;
+    else if (strcmp(str, "RGBA") == 0)
+        return Texture::RGBA;
+    else if (strcmp(str, "ALPHA") == 0)
+        return Texture::ALPHA;
+    else if (strcmp(str, "LUMINANCE") == 0)
+        return Texture::LUMINANCE;
+    else if (strcmp(str, "RGB565") == 0)
+        return Texture::RGB565;
+    else if (strcmp(str, "RGBA4444") == 0)
+        return Texture::RGBA4444;
+    else if (strcmp(str, "RGBA5551") == 0)
+        return Texture::RGBA5551;
+
+    GP_ERROR("Unsupported texture format string ('%s').", str);
+    return Texture::UNKNOWN;
+}
+
 void Material::loadRenderState(RenderState* renderState, Properties* properties)
 {
     GP_ASSERT(renderState);
@@ -415,8 +623,14 @@ void Material::loadRenderState(RenderState* renderState, Properties* properties)
             std::string path;
             if (!ns->getPath("path", &path))
             {
-                GP_ERROR("Texture sampler '%s' is missing required image file path.", name);
-                continue;
+                // A path without an extension names a texture stored in several formats (see Texture::create).
+                const char* value = ns->getString("path");
+                if (value == NULL || !FileSystem::getExtension(value).empty())
+                {
+                    GP_ERROR("Texture sampler '%s' is missing required image file path.", name);
+                    continue;
+                }
+                path = value;
             }
 
             // Read texture state (booleans default to 'false' if not present).
@@ -426,13 +640,34 @@ void Material::loadRenderState(RenderState* renderState, Properties* properties)
             Texture::Filter minFilter = parseTextureFilterMode(ns->getString("minFilter"), mipmap ? Texture::NEAREST_MIPMAP_LINEAR : Texture::LINEAR);
             Texture::Filter magFilter = parseTextureFilterMode(ns->getString("magFilter"), Texture::LINEAR);
 
+            // An optional format converts PNG images when they are decoded, e.g. 'format = RGB565' and 'dither = true'.
+            Texture::Format format = parseTextureFormat(ns->getString("format"));
+
             // Set the sampler parameter.
             GP_ASSERT(renderState->getParameter(name));
-            Texture::Sampler* sampler = renderState->getParameter(name)->setValue(path.c_str(), mipmap);
+            Texture::Sampler* sampler;
+            if (format != Texture::UNKNOWN)
+            {
+                sampler = Texture::Sampler::create(path.c_str(), mipmap, format, ns->getBool("dither"));
+                if (sampler)
+                {
+                    // The parameter holds its own reference to the sampler.
+                    renderState->getParameter(name)->setValue(sampler);
+                    sampler->release();
+                }
+            }
+            else
+            {
+                sampler = renderState->getParameter(name)->setValue(path.c_str(), mipmap);
+            }
             if (sampler)
             {
                 sampler->setWrapMode(wrapS, wrapT);
                 sampler->setFilterMode(minFilter, magFilter);
+                if (ns->exists("layer"))
+                {
+                    sampler->setLayer((unsigned int)std::max(ns->getInt("layer"), 0));
+                }
             }
         }
         else if (strcmp(ns->getNamespace(), "renderState") == 0)
@@ -25,6 +25,7 @@ class Material : public RenderState
     friend class RenderState;
     friend class Node;
     friend class Model;
+    friend class SceneLoader;
 
 public:
 
@@ -32,6 +33,12 @@ public:
      * Creates a material using the data from the Properties object defined at the specified URL, 
      * where the URL is of the format "<file-path>.<extension>#<namespace-id>/<namespace-id>/.../<namespace-id>"
      * (and "#<namespace-id>/<namespace-id>/.../<namespace-id>" is optional). 
+     *
+     * The material file is only loaded the first time a URL is used, into a template that
+     * is kept while materials created from it exist. The materials share the effects,
+     * render states and parameter values of the template, and copy a parameter or render
+     * state only when it is accessed to be changed, so creating many materials from the
+     * same URL is cheap in both time and memory.
      * 
      * @param url The URL pointing to the Properties object defining the material.
      * 
@@ -117,6 +124,32 @@ public:
      */
     void setTechnique(const char* id);
 
+    /**
+     * Reloads the materials created from URLs in the specified material or scene file.
+     *
+     * The file is read again and the values of its parameters and render states are applied
+     * to the templates loaded from it (see create(const char*)), in place. The materials
+     * created from a template see the new values, except for the parameters and render
+     * states they have changed. The techniques and passes are matched in the order they
+     * appear in the file; new techniques, passes and parameters, and changes to the shaders
+     * of a pass, are only applied to the materials created afterwards.
+     *
+     * @param path The path of the file that changed.
+     *
+     * @return The number of material templates that were reloaded.
+     * @see HotReloader
+     * @script{ignore}
+     */
+    static unsigned int reloadFile(const char* path);
+
+    /**
+     * Adds the files of the material templates that are loaded to a set.
+     *
+     * @param files The set to add the files to.
+     * @script{ignore}
+     */
+    static void getSourceFiles(std::set<std::string>& files);
+
 private:
 
     /**
@@ -159,8 +192,25 @@ private:
      */
     static void loadRenderState(RenderState* renderState, Properties* properties);
 
+    /**
+     * Creates a material from the template loaded for a URL, loading the template from the
+     * specified properties, or from the URL if they are NULL, the first time the URL is used.
+     */
+    static Material* createFromTemplate(const char* url, Properties* materialProperties);
+
+    /**
+     * Creates a material that shares the techniques, passes and parameters of this one.
+     */
+    Material* createInstance();
+
+    /**
+     * Applies the parameters and render states defined at the specified URL to this template.
+     */
+    bool reload(const char* url);
+
     Technique* _currentTechnique;
     std::vector<Technique*> _techniques;
+    bool _cached;
 };
 
 }
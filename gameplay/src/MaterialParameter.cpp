@@ -1,12 +1,14 @@
 #include "Base.h"
+#include "RenderStats.h"
 #include "MaterialParameter.h"
+#include "StringId.h"
 #include "Node.h"
 
 namespace gameplay
 {
 
 MaterialParameter::MaterialParameter(const char* name) :
-    _type(MaterialParameter::NONE), _count(1), _dynamic(false), _name(name ? name : ""), _uniform(NULL)
+    _type(MaterialParameter::NONE), _count(1), _dynamic(false), _nameId(StringId::intern(name)), _uniform(NULL)
 {
     clearValue();
 }
@@ -77,7 +79,7 @@ void MaterialParameter::clearValue()
 
 const char* MaterialParameter::getName() const
 {
-    return _name.c_str();
+    return StringId::getString(_nameId);
 }
 
 Texture::Sampler* MaterialParameter::getSampler(unsigned int index) const
@@ -450,55 +452,81 @@ void MaterialParameter::bind(Effect* effect)
 {
     GP_ASSERT(effect);
 
+    if (!updateUniform(effect))
+        return;
+
+    RenderStats::add(RenderStats::UNIFORM_UPLOADS);
+
+    uploadValue(effect);
+}
+
+void MaterialParameter::bind(FramePacket* packet, Effect* effect)
+{
+    GP_ASSERT(packet);
+    GP_ASSERT(effect);
+
+    if (!updateUniform(effect))
+        return;
+
+    uploadValue(packet);
+}
+
+bool MaterialParameter::updateUniform(Effect* effect)
+{
     // If we had a Uniform cached that is not from the passed in effect,
     // we need to update our uniform to point to the new effect's uniform.
     if (!_uniform || _uniform->getEffect() != effect)
     {
-        _uniform = effect->getUniform(_name.c_str());
+        _uniform = effect->getUniform(getName());
 
         if (!_uniform)
         {
             // This parameter was not found in the specified effect, so do nothing.
-            GP_WARN("Warning: Material parameter '%s' not found in effect '%s'.", _name.c_str(), effect->getId());
-            return;
+            GP_WARN("Warning: Material parameter '%s' not found in effect '%s'.", getName(), effect->getId());
+            return false;
         }
     }
+    return true;
+}
 
+template <class ValueTarget>
+void MaterialParameter::uploadValue(ValueTarget* target)
+{
     switch (_type)
     {
     case MaterialParameter::FLOAT:
-        effect->setValue(_uniform, _value.floatValue);
+        target->setValue(_uniform, _value.floatValue);
         break;
     case MaterialParameter::FLOAT_ARRAY:
-        effect->setValue(_uniform, _value.floatPtrValue, _count);
+        target->setValue(_uniform, _value.floatPtrValue, _count);
         break;
     case MaterialParameter::INT:
-        effect->setValue(_uniform, _value.intValue);
+        target->setValue(_uniform, _value.intValue);
         break;
     case MaterialParameter::INT_ARRAY:
-        effect->setValue(_uniform, _value.intPtrValue, _count);
+        target->setValue(_uniform, _value.intPtrValue, _count);
         break;
     case MaterialParameter::VECTOR2:
-        effect->setValue(_uniform, reinterpret_cast<Vector2*>(_value.floatPtrValue), _count);
+        target->setValue(_uniform, reinterpret_cast<Vector2*>(_value.floatPtrValue), _count);
         break;
     case MaterialParameter::VECTOR3:
-        effect->setValue(_uniform, reinterpret_cast<Vector3*>(_value.floatPtrValue), _count);
+        target->setValue(_uniform, reinterpret_cast<Vector3*>(_value.floatPtrValue), _count);
         break;
     case MaterialParameter::VECTOR4:
-        effect->setValue(_uniform, reinterpret_cast<Vector4*>(_value.floatPtrValue), _count);
+        target->setValue(_uniform, reinterpret_cast<Vector4*>(_value.floatPtrValue), _count);
         break;
     case MaterialParameter::MATRIX:
-        effect->setValue(_uniform, reinterpret_cast<Matrix*>(_value.floatPtrValue), _count);
+        target->setValue(_uniform, reinterpret_cast<Matrix*>(_value.floatPtrValue), _count);
         break;
     case MaterialParameter::SAMPLER:
-        effect->setValue(_uniform, _value.samplerValue);
+        target->setValue(_uniform, _value.samplerValue);
         break;
     case MaterialParameter::SAMPLER_ARRAY:
-        effect->setValue(_uniform, _value.samplerArrayValue, _count);
+        target->setValue(_uniform, _value.samplerArrayValue, _count);
         break;
     case MaterialParameter::METHOD:
         GP_ASSERT(_value.method);
-        _value.method->setValue(effect);
+        _value.method->setValue(target);
         break;
     default:
         GP_ERROR("Unsupported material parameter type (%d).", _type);
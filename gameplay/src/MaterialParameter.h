@@ -8,6 +8,8 @@
 #include "Matrix.h"
 #include "Texture.h"
 #include "Effect.h"
+#include "FramePacket.h"
+#include "MemoryPool.h"
 
 namespace gameplay
 {
@@ -34,9 +36,11 @@ namespace gameplay
  * you pass in are valid for the lifetime of the MaterialParameter
  * object.
  */
-class MaterialParameter : public AnimationTarget, public Ref
+class MaterialParameter : public AnimationTarget, public Ref, public PoolObject<MaterialParameter>
 {
     friend class RenderState;
+    friend class TextureStreamer;
+    friend class FramePacket;
 
 public:
 
@@ -374,6 +378,8 @@ private:
 
         virtual void setValue(Effect* effect) = 0;
 
+        virtual void setValue(FramePacket* packet) = 0;
+
     protected:
 
         /**
@@ -405,6 +411,7 @@ private:
     public:
         MethodValueBinding(MaterialParameter* param, ClassType* instance, ValueMethod valueMethod);
         void setValue(Effect* effect);
+        void setValue(FramePacket* packet);
     private:
         ClassType* _instance;
         ValueMethod _valueMethod;
@@ -422,6 +429,7 @@ private:
     public:
         MethodArrayBinding(MaterialParameter* param, ClassType* instance, ValueMethod valueMethod, CountMethod countMethod);
         void setValue(Effect* effect);
+        void setValue(FramePacket* packet);
     private:
         ClassType* _instance;
         ValueMethod _valueMethod;
@@ -432,6 +440,22 @@ private:
 
     void bind(Effect* effect);
 
+    /**
+     * Copies the value this parameter would set on the effect into a frame packet.
+     */
+    void bind(FramePacket* packet, Effect* effect);
+
+    /**
+     * Looks up the uniform of this parameter in the effect, returning false if it has none.
+     */
+    bool updateUniform(Effect* effect);
+
+    /**
+     * Sets the value of this parameter on an effect, or copies it into a frame packet.
+     */
+    template <class ValueTarget>
+    void uploadValue(ValueTarget* target);
+
     void applyAnimationValue(AnimationValue* value, float blendWeight, int components);
 
     void cloneInto(MaterialParameter* materialParameter) const;
@@ -472,7 +496,7 @@ private:
     
     unsigned int _count;
     bool _dynamic;
-    std::string _name;
+    unsigned int _nameId;
     Uniform* _uniform;
 };
 
@@ -508,6 +532,12 @@ void MaterialParameter::MethodValueBinding<ClassType, ParameterType>::setValue(E
     effect->setValue(_parameter->_uniform, (_instance->*_valueMethod)());
 }
 
+template <class ClassType, class ParameterType>
+void MaterialParameter::MethodValueBinding<ClassType, ParameterType>::setValue(FramePacket* packet)
+{
+    packet->setValue(_parameter->_uniform, (_instance->*_valueMethod)());
+}
+
 template <class ClassType, class ParameterType>
 MaterialParameter::MethodArrayBinding<ClassType, ParameterType>::MethodArrayBinding(MaterialParameter* param, ClassType* instance, ValueMethod valueMethod, CountMethod countMethod) :
     MethodBinding(param), _instance(instance), _valueMethod(valueMethod), _countMethod(countMethod)
@@ -520,6 +550,12 @@ void MaterialParameter::MethodArrayBinding<ClassType, ParameterType>::setValue(E
     effect->setValue(_parameter->_uniform, (_instance->*_valueMethod)(), (_instance->*_countMethod)());
 }
 
+template <class ClassType, class ParameterType>
+void MaterialParameter::MethodArrayBinding<ClassType, ParameterType>::setValue(FramePacket* packet)
+{
+    packet->setValue(_parameter->_uniform, (_instance->*_valueMethod)(), (_instance->*_countMethod)());
+}
+
 }
 
 #endif
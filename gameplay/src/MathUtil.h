@@ -10,6 +10,7 @@ class MathUtil
 {
     friend class Matrix;
     friend class Vector3;
+    friend class MeshSkin;
 
 public:
 
@@ -54,6 +55,12 @@ private:
 
     inline static void multiplyMatrix(const float* m1, const float* m2, float* dst);
 
+    /**
+     * Multiplies two matrices and stores the first three rows of the product
+     * (12 floats, row-wise) as used by skinning matrix palettes.
+     */
+    inline static void multiplyMatrixPalette(const float* m1, const float* m2, float* dst);
+
     inline static void negateMatrix(const float* m, float* dst);
 
     inline static void transposeMatrix(const float* m, float* dst);
@@ -62,6 +69,17 @@ private:
 
     inline static void transformVector4(const float* m, const float* v, float* dst);
 
+    /**
+     * Transforms an array of three-component vectors, with the given w coordinate,
+     * and stores three components of each result. v and dst may be the same array.
+     */
+    inline static void transformVector3Array(const float* m, const float* v, float w, float* dst, unsigned int count);
+
+    /**
+     * Transforms an array of four-component vectors. v and dst may be the same array.
+     */
+    inline static void transformVector4Array(const float* m, const float* v, float* dst, unsigned int count);
+
     inline static void crossVector3(const float* v1, const float* v2, float* dst);
 
     MathUtil();
@@ -73,6 +91,8 @@ private:
 
 #ifdef USE_NEON
 #include "MathUtilNeon.inl"
+#elif defined(USE_SSE)
+#include "MathUtilSSE.inl"
 #else
 #include "MathUtil.inl"
 #endif
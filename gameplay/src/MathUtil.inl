@@ -109,6 +109,25 @@ inline void MathUtil::multiplyMatrix(const float* m1, const float* m2, float* ds
     memcpy(dst, product, MATRIX_SIZE);
 }
 
+inline void MathUtil::multiplyMatrixPalette(const float* m1, const float* m2, float* dst)
+{
+    float product[16];
+    multiplyMatrix(m1, m2, product);
+
+    dst[0]  = product[0];
+    dst[1]  = product[4];
+    dst[2]  = product[8];
+    dst[3]  = product[12];
+    dst[4]  = product[1];
+    dst[5]  = product[5];
+    dst[6]  = product[9];
+    dst[7]  = product[13];
+    dst[8]  = product[2];
+    dst[9]  = product[6];
+    dst[10] = product[10];
+    dst[11] = product[14];
+}
+
 inline void MathUtil::negateMatrix(const float* m, float* dst)
 {
     dst[0]  = -m[0];
@@ -161,6 +180,28 @@ inline void MathUtil::transformVector4(const float* m, const float* v, float* ds
     dst[3] = w;
 }
 
+inline void MathUtil::transformVector3Array(const float* m, const float* v, float w, float* dst, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i, v += 3, dst += 3)
+    {
+        float x = v[0] * m[0] + v[1] * m[4] + v[2] * m[8] + w * m[12];
+        float y = v[0] * m[1] + v[1] * m[5] + v[2] * m[9] + w * m[13];
+        float z = v[0] * m[2] + v[1] * m[6] + v[2] * m[10] + w * m[14];
+
+        dst[0] = x;
+        dst[1] = y;
+        dst[2] = z;
+    }
+}
+
+inline void MathUtil::transformVector4Array(const float* m, const float* v, float* dst, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i, v += 4, dst += 4)
+    {
+        transformVector4(m, v, dst);
+    }
+}
+
 inline void MathUtil::crossVector3(const float* v1, const float* v2, float* dst)
 {
     float x = (v1[1] * v2[2]) - (v1[2] * v2[1]);
@@ -0,0 +1,295 @@
+#include <xmmintrin.h>
+#ifdef USE_AVX
+#include <immintrin.h>
+#endif
+
+namespace gameplay
+{
+
+// All inputs are loaded before any output is stored, so dst may be the same array as any input.
+// Loads and stores are unaligned since matrices and vectors are not required to be 16-byte aligned.
+
+inline __m128 linearCombinationSSE(const __m128* columns, const float* v)
+{
+    __m128 r0 = _mm_mul_ps(columns[0], _mm_set1_ps(v[0]));
+    __m128 r1 = _mm_mul_ps(columns[1], _mm_set1_ps(v[1]));
+    __m128 r2 = _mm_mul_ps(columns[2], _mm_set1_ps(v[2]));
+    __m128 r3 = _mm_mul_ps(columns[3], _mm_set1_ps(v[3]));
+    return _mm_add_ps(_mm_add_ps(r0, r1), _mm_add_ps(r2, r3));
+}
+
+#ifdef USE_AVX
+// Computes two columns of the product m1 * m2 per instruction: c01 holds columns 0 and 1,
+// and c23 holds columns 2 and 3.
+inline void multiplyMatrixAVX(const float* m1, const float* m2, __m256* c01, __m256* c23)
+{
+    // Each column of m1 in both halves of a register.
+    __m256 a0 = _mm256_broadcast_ps((const __m128*)&m1[0]);
+    __m256 a1 = _mm256_broadcast_ps((const __m128*)&m1[4]);
+    __m256 a2 = _mm256_broadcast_ps((const __m128*)&m1[8]);
+    __m256 a3 = _mm256_broadcast_ps((const __m128*)&m1[12]);
+
+    __m256 b01 = _mm256_loadu_ps(&m2[0]);
+    __m256 b23 = _mm256_loadu_ps(&m2[8]);
+
+    // Shuffling within each half spreads one element of each column of m2 over that half.
+    *c01 = _mm256_add_ps(
+        _mm256_add_ps(_mm256_mul_ps(a0, _mm256_shuffle_ps(b01, b01, 0x00)), _mm256_mul_ps(a1, _mm256_shuffle_ps(b01, b01, 0x55))),
+        _mm256_add_ps(_mm256_mul_ps(a2, _mm256_shuffle_ps(b01, b01, 0xAA)), _mm256_mul_ps(a3, _mm256_shuffle_ps(b01, b01, 0xFF))));
+    *c23 = _mm256_add_ps(
+        _mm256_add_ps(_mm256_mul_ps(a0, _mm256_shuffle_ps(b23, b23, 0x00)), _mm256_mul_ps(a1, _mm256_shuffle_ps(b23, b23, 0x55))),
+        _mm256_add_ps(_mm256_mul_ps(a2, _mm256_shuffle_ps(b23, b23, 0xAA)), _mm256_mul_ps(a3, _mm256_shuffle_ps(b23, b23, 0xFF))));
+}
+#endif
+
+inline void MathUtil::addMatrix(const float* m, float scalar, float* dst)
+{
+    __m128 s = _mm_set1_ps(scalar);
+    __m128 c0 = _mm_add_ps(_mm_loadu_ps(&m[0]), s);
+    __m128 c1 = _mm_add_ps(_mm_loadu_ps(&m[4]), s);
+    __m128 c2 = _mm_add_ps(_mm_loadu_ps(&m[8]), s);
+    __m128 c3 = _mm_add_ps(_mm_loadu_ps(&m[12]), s);
+
+    _mm_storeu_ps(&dst[0], c0);
+    _mm_storeu_ps(&dst[4], c1);
+    _mm_storeu_ps(&dst[8], c2);
+    _mm_storeu_ps(&dst[12], c3);
+}
+
+inline void MathUtil::addMatrix(const float* m1, const float* m2, float* dst)
+{
+    __m128 c0 = _mm_add_ps(_mm_loadu_ps(&m1[0]), _mm_loadu_ps(&m2[0]));
+    __m128 c1 = _mm_add_ps(_mm_loadu_ps(&m1[4]), _mm_loadu_ps(&m2[4]));
+    __m128 c2 = _mm_add_ps(_mm_loadu_ps(&m1[8]), _mm_loadu_ps(&m2[8]));
+    __m128 c3 = _mm_add_ps(_mm_loadu_ps(&m1[12]), _mm_loadu_ps(&m2[12]));
+
+    _mm_storeu_ps(&dst[0], c0);
+    _mm_storeu_ps(&dst[4], c1);
+    _mm_storeu_ps(&dst[8], c2);
+    _mm_storeu_ps(&dst[12], c3);
+}
+
+inline void MathUtil::subtractMatrix(const float* m1, const float* m2, float* dst)
+{
+    __m128 c0 = _mm_sub_ps(_mm_loadu_ps(&m1[0]), _mm_loadu_ps(&m2[0]));
+    __m128 c1 = _mm_sub_ps(_mm_loadu_ps(&m1[4]), _mm_loadu_ps(&m2[4]));
+    __m128 c2 = _mm_sub_ps(_mm_loadu_ps(&m1[8]), _mm_loadu_ps(&m2[8]));
+    __m128 c3 = _mm_sub_ps(_mm_loadu_ps(&m1[12]), _mm_loadu_ps(&m2[12]));
+
+    _mm_storeu_ps(&dst[0], c0);
+    _mm_storeu_ps(&dst[4], c1);
+    _mm_storeu_ps(&dst[8], c2);
+    _mm_storeu_ps(&dst[12], c3);
+}
+
+inline void MathUtil::multiplyMatrix(const float* m, float scalar, float* dst)
+{
+    __m128 s = _mm_set1_ps(scalar);
+    __m128 c0 = _mm_mul_ps(_mm_loadu_ps(&m[0]), s);
+    __m128 c1 = _mm_mul_ps(_mm_loadu_ps(&m[4]), s);
+    __m128 c2 = _mm_mul_ps(_mm_loadu_ps(&m[8]), s);
+    __m128 c3 = _mm_mul_ps(_mm_loadu_ps(&m[12]), s);
+
+    _mm_storeu_ps(&dst[0], c0);
+    _mm_storeu_ps(&dst[4], c1);
+    _mm_storeu_ps(&dst[8], c2);
+    _mm_storeu_ps(&dst[12], c3);
+}
+
+inline void MathUtil::multiplyMatrix(const float* m1, const float* m2, float* dst)
+{
+#ifdef USE_AVX
+    __m256 c01, c23;
+    multiplyMatrixAVX(m1, m2, &c01, &c23);
+    _mm256_storeu_ps(&dst[0], c01);
+    _mm256_storeu_ps(&dst[8], c23);
+#else
+    __m128 columns[4] =
+    {
+        _mm_loadu_ps(&m1[0]),
+        _mm_loadu_ps(&m1[4]),
+        _mm_loadu_ps(&m1[8]),
+        _mm_loadu_ps(&m1[12])
+    };
+
+    // Each column of the product is a combination of the columns of m1.
+    __m128 c0 = linearCombinationSSE(columns, &m2[0]);
+    __m128 c1 = linearCombinationSSE(columns, &m2[4]);
+    __m128 c2 = linearCombinationSSE(columns, &m2[8]);
+    __m128 c3 = linearCombinationSSE(columns, &m2[12]);
+
+    _mm_storeu_ps(&dst[0], c0);
+    _mm_storeu_ps(&dst[4], c1);
+    _mm_storeu_ps(&dst[8], c2);
+    _mm_storeu_ps(&dst[12], c3);
+#endif
+}
+
+inline void MathUtil::multiplyMatrixPalette(const float* m1, const float* m2, float* dst)
+{
+#ifdef USE_AVX
+    __m256 c01, c23;
+    multiplyMatrixAVX(m1, m2, &c01, &c23);
+    __m128 r0 = _mm256_castps256_ps128(c01);
+    __m128 r1 = _mm256_extractf128_ps(c01, 1);
+    __m128 r2 = _mm256_castps256_ps128(c23);
+    __m128 r3 = _mm256_extractf128_ps(c23, 1);
+#else
+    __m128 columns[4] =
+    {
+        _mm_loadu_ps(&m1[0]),
+        _mm_loadu_ps(&m1[4]),
+        _mm_loadu_ps(&m1[8]),
+        _mm_loadu_ps(&m1[12])
+    };
+
+    __m128 r0 = linearCombinationSSE(columns, &m2[0]);
+    __m128 r1 = linearCombinationSSE(columns, &m2[4]);
+    __m128 r2 = linearCombinationSSE(columns, &m2[8]);
+    __m128 r3 = linearCombinationSSE(columns, &m2[12]);
+#endif
+
+    // Turn the columns of the product into rows and store the first three.
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(&dst[0], r0);
+    _mm_storeu_ps(&dst[4], r1);
+    _mm_storeu_ps(&dst[8], r2);
+}
+
+inline void MathUtil::negateMatrix(const float* m, float* dst)
+{
+    // Flip the sign bits so that zeros are negated as well.
+    __m128 sign = _mm_set1_ps(-0.0f);
+    __m128 c0 = _mm_xor_ps(_mm_loadu_ps(&m[0]), sign);
+    __m128 c1 = _mm_xor_ps(_mm_loadu_ps(&m[4]), sign);
+    __m128 c2 = _mm_xor_ps(_mm_loadu_ps(&m[8]), sign);
+    __m128 c3 = _mm_xor_ps(_mm_loadu_ps(&m[12]), sign);
+
+    _mm_storeu_ps(&dst[0], c0);
+    _mm_storeu_ps(&dst[4], c1);
+    _mm_storeu_ps(&dst[8], c2);
+    _mm_storeu_ps(&dst[12], c3);
+}
+
+inline void MathUtil::transposeMatrix(const float* m, float* dst)
+{
+    __m128 c0 = _mm_loadu_ps(&m[0]);
+    __m128 c1 = _mm_loadu_ps(&m[4]);
+    __m128 c2 = _mm_loadu_ps(&m[8]);
+    __m128 c3 = _mm_loadu_ps(&m[12]);
+
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+    _mm_storeu_ps(&dst[0], c0);
+    _mm_storeu_ps(&dst[4], c1);
+    _mm_storeu_ps(&dst[8], c2);
+    _mm_storeu_ps(&dst[12], c3);
+}
+
+inline void MathUtil::transformVector4(const float* m, float x, float y, float z, float w, float* dst)
+{
+    __m128 columns[4] =
+    {
+        _mm_loadu_ps(&m[0]),
+        _mm_loadu_ps(&m[4]),
+        _mm_loadu_ps(&m[8]),
+        _mm_loadu_ps(&m[12])
+    };
+    float v[4] = { x, y, z, w };
+    float r[4];
+    _mm_storeu_ps(r, linearCombinationSSE(columns, v));
+
+    // Only the x, y and z components are written (dst is a Vector3).
+    dst[0] = r[0];
+    dst[1] = r[1];
+    dst[2] = r[2];
+}
+
+inline void MathUtil::transformVector4(const float* m, const float* v, float* dst)
+{
+    __m128 columns[4] =
+    {
+        _mm_loadu_ps(&m[0]),
+        _mm_loadu_ps(&m[4]),
+        _mm_loadu_ps(&m[8]),
+        _mm_loadu_ps(&m[12])
+    };
+    _mm_storeu_ps(dst, linearCombinationSSE(columns, v));
+}
+
+inline void MathUtil::transformVector3Array(const float* m, const float* v, float w, float* dst, unsigned int count)
+{
+    __m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2 = _mm_set1_ps(m[2]);
+    __m128 m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]), m6 = _mm_set1_ps(m[6]);
+    __m128 m8 = _mm_set1_ps(m[8]), m9 = _mm_set1_ps(m[9]), m10 = _mm_set1_ps(m[10]);
+    __m128 tx = _mm_set1_ps(m[12] * w), ty = _mm_set1_ps(m[13] * w), tz = _mm_set1_ps(m[14] * w);
+
+    // Four vectors at a time: the 12 floats are split into the x, y and z of the four vectors,
+    // transformed, and interleaved again.
+    unsigned int i = 0;
+    for (; i + 4 <= count; i += 4, v += 12, dst += 12)
+    {
+        __m128 p0 = _mm_loadu_ps(&v[0]);    // x0 y0 z0 x1
+        __m128 p1 = _mm_loadu_ps(&v[4]);    // y1 z1 x2 y2
+        __m128 p2 = _mm_loadu_ps(&v[8]);    // z2 x3 y3 z3
+
+        __m128 a = _mm_shuffle_ps(p1, p2, _MM_SHUFFLE(2, 1, 3, 2)); // x2 y2 x3 y3
+        __m128 b = _mm_shuffle_ps(p0, p1, _MM_SHUFFLE(1, 0, 2, 1)); // y0 z0 y1 z1
+        __m128 x = _mm_shuffle_ps(p0, a, _MM_SHUFFLE(2, 0, 3, 0));
+        __m128 y = _mm_shuffle_ps(b, a, _MM_SHUFFLE(3, 1, 2, 0));
+        __m128 z = _mm_shuffle_ps(b, p2, _MM_SHUFFLE(3, 0, 3, 1));
+
+        __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m0), _mm_mul_ps(y, m4)), _mm_add_ps(_mm_mul_ps(z, m8), tx));
+        __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m1), _mm_mul_ps(y, m5)), _mm_add_ps(_mm_mul_ps(z, m9), ty));
+        __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m2), _mm_mul_ps(y, m6)), _mm_add_ps(_mm_mul_ps(z, m10), tz));
+
+        __m128 xy01 = _mm_unpacklo_ps(rx, ry);                          // x0 y0 x1 y1
+        __m128 xy23 = _mm_unpackhi_ps(rx, ry);                          // x2 y2 x3 y3
+        __m128 zx01 = _mm_shuffle_ps(rz, rx, _MM_SHUFFLE(1, 1, 0, 0));  // z0 z0 x1 x1
+        __m128 yz11 = _mm_shuffle_ps(ry, rz, _MM_SHUFFLE(1, 1, 1, 1));  // y1 y1 z1 z1
+        __m128 zx23 = _mm_shuffle_ps(rz, rx, _MM_SHUFFLE(3, 3, 2, 2));  // z2 z2 x3 x3
+        __m128 yz33 = _mm_shuffle_ps(ry, rz, _MM_SHUFFLE(3, 3, 3, 3));  // y3 y3 z3 z3
+
+        _mm_storeu_ps(&dst[0], _mm_shuffle_ps(xy01, zx01, _MM_SHUFFLE(2, 0, 1, 0)));
+        _mm_storeu_ps(&dst[4], _mm_shuffle_ps(yz11, xy23, _MM_SHUFFLE(1, 0, 2, 0)));
+        _mm_storeu_ps(&dst[8], _mm_shuffle_ps(zx23, yz33, _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+    for (; i < count; ++i, v += 3, dst += 3)
+    {
+        transformVector4(m, v[0], v[1], v[2], w, dst);
+    }
+}
+
+inline void MathUtil::transformVector4Array(const float* m, const float* v, float* dst, unsigned int count)
+{
+    __m128 columns[4] =
+    {
+        _mm_loadu_ps(&m[0]),
+        _mm_loadu_ps(&m[4]),
+        _mm_loadu_ps(&m[8]),
+        _mm_loadu_ps(&m[12])
+    };
+    for (unsigned int i = 0; i < count; ++i, v += 4, dst += 4)
+    {
+        __m128 p = _mm_loadu_ps(v);
+        __m128 r0 = _mm_mul_ps(columns[0], _mm_shuffle_ps(p, p, _MM_SHUFFLE(0, 0, 0, 0)));
+        __m128 r1 = _mm_mul_ps(columns[1], _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1)));
+        __m128 r2 = _mm_mul_ps(columns[2], _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2)));
+        __m128 r3 = _mm_mul_ps(columns[3], _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 3, 3)));
+        _mm_storeu_ps(dst, _mm_add_ps(_mm_add_ps(r0, r1), _mm_add_ps(r2, r3)));
+    }
+}
+
+inline void MathUtil::crossVector3(const float* v1, const float* v2, float* dst)
+{
+    // Vector3 only has three components, so this is not worth vectorizing.
+    float x = (v1[1] * v2[2]) - (v1[2] * v2[1]);
+    float y = (v1[2] * v2[0]) - (v1[0] * v2[2]);
+    float z = (v1[0] * v2[1]) - (v1[1] * v2[0]);
+
+    dst[0] = x;
+    dst[1] = y;
+    dst[2] = z;
+}
+
+}
@@ -927,6 +927,30 @@ void Matrix::transformVector(const Vector4& vector, Vector4* dst) const
     MathUtil::transformVector4(m, (const float*) &vector, (float*)dst);
 }
 
+void Matrix::transformPoints(const Vector3* points, Vector3* dst, unsigned int count) const
+{
+    GP_ASSERT(points || count == 0);
+    GP_ASSERT(dst || count == 0);
+
+    MathUtil::transformVector3Array(m, (const float*)points, 1.0f, (float*)dst, count);
+}
+
+void Matrix::transformVectors(const Vector3* vectors, Vector3* dst, unsigned int count) const
+{
+    GP_ASSERT(vectors || count == 0);
+    GP_ASSERT(dst || count == 0);
+
+    MathUtil::transformVector3Array(m, (const float*)vectors, 0.0f, (float*)dst, count);
+}
+
+void Matrix::transformVectors(const Vector4* vectors, Vector4* dst, unsigned int count) const
+{
+    GP_ASSERT(vectors || count == 0);
+    GP_ASSERT(dst || count == 0);
+
+    MathUtil::transformVector4Array(m, (const float*)vectors, (float*)dst, count);
+}
+
 void Matrix::translate(float x, float y, float z)
 {
     translate(x, y, z, this);
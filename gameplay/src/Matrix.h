@@ -39,6 +39,10 @@ class Plane;
  * (which is optimized for that kind of usage).
  *
  * @see Transform
+ *
+ * Values of this type are copied into their Lua userdata when returned to scripts.
+ *
+ * @script{value}
  */
 class Matrix
 {
@@ -798,6 +802,40 @@ public:
      */
     void transformVector(const Vector4& vector, Vector4* dst) const;
 
+    /**
+     * Transforms an array of points by this matrix.
+     *
+     * The points are transformed several at a time with SIMD instructions
+     * where they are available.
+     *
+     * @param points The points to transform.
+     * @param dst The array to store the transformed points in, which may be points.
+     * @param count The number of points.
+     * @script{ignore}
+     */
+    void transformPoints(const Vector3* points, Vector3* dst, unsigned int count) const;
+
+    /**
+     * Transforms an array of vectors by this matrix by treating the fourth (w)
+     * coordinate as zero.
+     *
+     * @param vectors The vectors to transform.
+     * @param dst The array to store the transformed vectors in, which may be vectors.
+     * @param count The number of vectors.
+     * @script{ignore}
+     */
+    void transformVectors(const Vector3* vectors, Vector3* dst, unsigned int count) const;
+
+    /**
+     * Transforms an array of vectors by this matrix.
+     *
+     * @param vectors The vectors to transform.
+     * @param dst The array to store the transformed vectors in, which may be vectors.
+     * @param count The number of vectors.
+     * @script{ignore}
+     */
+    void transformVectors(const Vector4* vectors, Vector4* dst, unsigned int count) const;
+
     /**
      * Post-multiplies this matrix by the matrix corresponding to the
      * specified translation.
@@ -0,0 +1,138 @@
+#include "Base.h"
+#include "MemoryPool.h"
+
+namespace gameplay
+{
+
+// The list of all the pools, which are usually static objects, so this is zero-initialized
+// before any pool is constructed.
+static MemoryPool* __pools = NULL;
+
+// Each chunk starts with a pointer to the next chunk, followed by its blocks.
+static const size_t CHUNK_HEADER_SIZE = sizeof(double) > sizeof(void*) ? sizeof(double) : sizeof(void*);
+
+MemoryPool::MemoryPool(const char* name, size_t blockSize, unsigned int blocksPerChunk)
+    : _name(name ? name : ""), _blockSize(blockSize), _blocksPerChunk(blocksPerChunk), _blockCount(0), _chunkCount(0),
+      _freeList(NULL), _chunks(NULL), _next(NULL)
+{
+    GP_ASSERT(blocksPerChunk > 0);
+
+    // Free blocks hold the pointer to the next free block, and blocks stay aligned for any type.
+    if (_blockSize < sizeof(void*))
+        _blockSize = sizeof(void*);
+    _blockSize = (_blockSize + CHUNK_HEADER_SIZE - 1) / CHUNK_HEADER_SIZE * CHUNK_HEADER_SIZE;
+
+    _next = __pools;
+    __pools = this;
+}
+
+MemoryPool::~MemoryPool()
+{
+    MemoryPool** pool = &__pools;
+    while (*pool && *pool != this)
+        pool = &(*pool)->_next;
+    if (*pool)
+        *pool = _next;
+
+    // Blocks still in use are leaked with their chunks, since pools are destroyed at exit
+    // and the objects in them may be destroyed later.
+    if (_blockCount == 0)
+    {
+        while (_chunks)
+        {
+            void* next = *(void**)_chunks;
+            free(_chunks);
+            _chunks = next;
+        }
+    }
+}
+
+void* MemoryPool::allocate()
+{
+    _mutex.lock();
+    if (_freeList == NULL)
+    {
+        unsigned char* chunk = (unsigned char*)malloc(CHUNK_HEADER_SIZE + _blockSize * _blocksPerChunk);
+        if (chunk == NULL)
+        {
+            _mutex.unlock();
+            GP_ERROR("Failed to allocate a chunk of memory pool '%s'.", _name);
+            return NULL;
+        }
+        *(void**)chunk = _chunks;
+        _chunks = chunk;
+        ++_chunkCount;
+
+        // Link the blocks of the new chunk, in order.
+        unsigned char* block = chunk + CHUNK_HEADER_SIZE;
+        for (unsigned int i = 0; i < _blocksPerChunk - 1; ++i, block += _blockSize)
+            *(void**)block = block + _blockSize;
+        *(void**)block = NULL;
+        _freeList = chunk + CHUNK_HEADER_SIZE;
+    }
+
+    void* block = _freeList;
+    _freeList = *(void**)block;
+    ++_blockCount;
+    _mutex.unlock();
+
+    return block;
+}
+
+void MemoryPool::deallocate(void* block)
+{
+    if (block == NULL)
+        return;
+
+    ScopedLock lock(_mutex);
+    GP_ASSERT(_blockCount > 0);
+    *(void**)block = _freeList;
+    _freeList = block;
+    --_blockCount;
+}
+
+const char* MemoryPool::getName() const
+{
+    return _name;
+}
+
+size_t MemoryPool::getBlockSize() const
+{
+    return _blockSize;
+}
+
+unsigned int MemoryPool::getBlockCount() const
+{
+    return _blockCount;
+}
+
+size_t MemoryPool::getReservedSize() const
+{
+    return (size_t)_chunkCount * (CHUNK_HEADER_SIZE + _blockSize * _blocksPerChunk);
+}
+
+void MemoryPool::printStats()
+{
+    for (MemoryPool* pool = __pools; pool; pool = pool->_next)
+    {
+        print("[memory] Pool '%s': %u blocks of %u bytes in use, %u bytes reserved.\n",
+            pool->_name, pool->_blockCount, (unsigned int)pool->_blockSize, (unsigned int)pool->getReservedSize());
+    }
+}
+
+void MemoryPool::printLeaks()
+{
+    unsigned int count = 0;
+    for (MemoryPool* pool = __pools; pool; pool = pool->_next)
+    {
+        if (pool->_blockCount > 0)
+        {
+            print("[memory] LEAK: %u blocks of %u bytes still in use in pool '%s'.\n", pool->_blockCount, (unsigned int)pool->_blockSize, pool->_name);
+            count += pool->_blockCount;
+        }
+    }
+    if (count == 0)
+        print("[memory] All POOL allocations successfully cleaned up (no leaks detected).\n");
+}
+
+}
@@ -0,0 +1,252 @@
+#ifndef MEMORYPOOL_H_
+#define MEMORYPOOL_H_
+
+#include "Mutex.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines an allocator of memory blocks of one size.
+ *
+ * Blocks are carved out of chunks that hold many blocks each, and freed blocks are kept
+ * on a free list to be reused, so allocating and freeing a block only moves a pointer
+ * instead of going through the heap. This is used for small objects that are created
+ * and destroyed in large numbers, such as nodes, models, material parameters, animation
+ * values and AI messages, through PoolObject and PoolAllocator.
+ *
+ * Chunks are only returned to the heap when the pool is destroyed. A pool can be used
+ * from any thread.
+ *
+ * @script{ignore}
+ */
+class MemoryPool
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param name The name of the pool, used in memory reports.
+     * @param blockSize The size of each block in bytes.
+     * @param blocksPerChunk The number of blocks allocated at once when the pool is empty.
+     */
+    MemoryPool(const char* name, size_t blockSize, unsigned int blocksPerChunk = 256);
+
+    /**
+     * Destructor.
+     */
+    ~MemoryPool();
+
+    /**
+     * Allocates a block.
+     *
+     * @return A block of the pool's block size.
+     */
+    void* allocate();
+
+    /**
+     * Returns a block to the pool.
+     *
+     * @param block A block returned by allocate(), or NULL.
+     */
+    void deallocate(void* block);
+
+    /**
+     * Returns the name of the pool.
+     *
+     * @return The name of the pool.
+     */
+    const char* getName() const;
+
+    /**
+     * Returns the size of the blocks of the pool.
+     *
+     * @return The block size in bytes.
+     */
+    size_t getBlockSize() const;
+
+    /**
+     * Returns the number of blocks that are allocated and not freed yet.
+     *
+     * @return The number of blocks in use.
+     */
+    unsigned int getBlockCount() const;
+
+    /**
+     * Returns the number of bytes the pool took from the heap.
+     *
+     * @return The size of all the chunks of the pool in bytes.
+     */
+    size_t getReservedSize() const;
+
+    /**
+     * Prints the blocks in use and the memory reserved by every pool.
+     */
+    static void printStats();
+
+private:
+
+    friend class Game;
+
+    MemoryPool(const MemoryPool& copy);
+
+    MemoryPool& operator=(const MemoryPool&);
+
+    /**
+     * Prints the pools that still have blocks in use (only used when GAMEPLAY_MEM_LEAK_DETECTION is defined).
+     */
+    static void printLeaks();
+
+    const char* _name;
+    size_t _blockSize;
+    unsigned int _blocksPerChunk;
+    unsigned int _blockCount;
+    unsigned int _chunkCount;
+    void* _freeList;
+    void* _chunks;
+    Mutex _mutex;
+    MemoryPool* _next;
+};
+
+// The DebugNew macro would turn the operator declarations below into placement new expressions.
+#ifdef GAMEPLAY_MEM_LEAK_DETECTION
+#undef new
+#endif
+
+/**
+ * Base class of small objects that are allocated from a MemoryPool.
+ *
+ * Objects of the class T passed as the template argument are allocated from a pool of blocks
+ * of sizeof(T). Objects of classes derived from T have a different size and are allocated
+ * from the heap.
+ *
+ * @script{ignore}
+ */
+template <class T>
+class PoolObject
+{
+public:
+
+    /**
+     * Returns the pool the objects are allocated from.
+     *
+     * @return The pool of T.
+     */
+    static MemoryPool& getPool()
+    {
+        static MemoryPool pool(typeid(T).name(), sizeof(T));
+        return pool;
+    }
+
+    /**
+     * Allocates an object from the pool.
+     */
+    static void* operator new(size_t size)
+    {
+        return size == sizeof(T) ? getPool().allocate() : ::operator new(size);
+    }
+
+    /**
+     * Returns an object to the pool.
+     */
+    static void operator delete(void* p, size_t size)
+    {
+        if (size == sizeof(T))
+            getPool().deallocate(p);
+        else
+            ::operator delete(p);
+    }
+
+#ifdef GAMEPLAY_MEM_LEAK_DETECTION
+    /**
+     * Allocates an object from the pool, for the DebugNew version of new.
+     *
+     * Objects of T are tracked by the pool rather than by DebugNew, and reported by
+     * MemoryPool when they leak.
+     */
+    static void* operator new(size_t size, const char* file, int line)
+    {
+        return size == sizeof(T) ? getPool().allocate() : ::operator new(size, file, line);
+    }
+
+    /**
+     * Returns an object to the pool when its constructor throws.
+     */
+    static void operator delete(void* p, const char* file, int line)
+    {
+        operator delete(p, sizeof(T));
+    }
+#endif
+};
+
+/**
+ * Defines an STL allocator that allocates single elements from a MemoryPool.
+ *
+ * This is used for node based containers, such as std::list and std::map, which allocate
+ * one node per element. Each node type gets its own pool. Arrays of elements are
+ * allocated from the heap.
+ *
+ * @script{ignore}
+ */
+template <class T>
+class PoolAllocator
+{
+public:
+
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template <class U>
+    struct rebind
+    {
+        typedef PoolAllocator<U> other;
+    };
+
+    PoolAllocator() { }
+
+    PoolAllocator(const PoolAllocator&) { }
+
+    template <class U>
+    PoolAllocator(const PoolAllocator<U>&) { }
+
+    pointer address(reference x) const { return &x; }
+
+    const_pointer address(const_reference x) const { return &x; }
+
+    pointer allocate(size_type n, const void* hint = 0)
+    {
+        return (pointer)(n == 1 ? PoolObject<T>::getPool().allocate() : ::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(pointer p, size_type n)
+    {
+        if (n == 1)
+            PoolObject<T>::getPool().deallocate(p);
+        else
+            ::operator delete(p);
+    }
+
+    size_type max_size() const { return ((size_type)-1) / sizeof(T); }
+
+    void construct(pointer p, const T& value) { ::new((void*)p) T(value); }
+
+    void destroy(pointer p) { p->~T(); }
+
+    bool operator==(const PoolAllocator&) const { return true; }
+
+    bool operator!=(const PoolAllocator&) const { return false; }
+};
+
+#ifdef GAMEPLAY_MEM_LEAK_DETECTION
+#define new DEBUG_NEW
+#endif
+
+}
+
+#endif
@@ -0,0 +1,189 @@
+#include "Base.h"
+#include "MemoryStats.h"
+#include "Font.h"
+
+#ifdef WIN32
+    #include <windows.h>
+#endif
+
+// The font drawn with when none is given.
+#define MEMORY_STATS_DEFAULT_FONT "res/ui/arial.gpb"
+
+namespace gameplay
+{
+
+static volatile long long __sizes[MemoryStats::CATEGORY_COUNT];
+static long long __peakSizes[MemoryStats::CATEGORY_COUNT];
+static size_t __budgets[MemoryStats::CATEGORY_COUNT];
+static bool __warned[MemoryStats::CATEGORY_COUNT];
+static Font* __defaultFont = NULL;
+static bool __defaultFontLoaded = false;
+
+static long long addSize(volatile long long* size, long long bytes)
+{
+#ifdef WIN32
+    return InterlockedExchangeAdd64((volatile LONGLONG*)size, bytes) + bytes;
+#else
+    return __sync_add_and_fetch(size, bytes);
+#endif
+}
+
+void MemoryStats::add(Category category, size_t bytes)
+{
+    GP_ASSERT(category < CATEGORY_COUNT);
+    long long size = addSize(&__sizes[category], (long long)bytes);
+
+    // The peak may miss a concurrent update, which only makes it slightly lower.
+    if (size > __peakSizes[category])
+        __peakSizes[category] = size;
+}
+
+void MemoryStats::remove(Category category, size_t bytes)
+{
+    GP_ASSERT(category < CATEGORY_COUNT);
+    addSize(&__sizes[category], -(long long)bytes);
+}
+
+size_t MemoryStats::getSize(Category category)
+{
+    GP_ASSERT(category < CATEGORY_COUNT);
+    long long size = __sizes[category];
+    return size > 0 ? (size_t)size : 0;
+}
+
+size_t MemoryStats::getPeakSize(Category category)
+{
+    GP_ASSERT(category < CATEGORY_COUNT);
+    return (size_t)__peakSizes[category];
+}
+
+const char* MemoryStats::getName(Category category)
+{
+    switch (category)
+    {
+    case MESH:
+        return "Meshes";
+    case TEXTURE_CPU:
+        return "Textures (CPU)";
+    case ANIMATION:
+        return "Animations";
+    case PHYSICS:
+        return "Physics";
+    case UI:
+        return "UI";
+    case SCRIPT:
+        return "Scripts";
+    case AUDIO:
+        return "Audio";
+    case GPU_BUFFERS:
+        return "Buffers (GPU)";
+    case GPU_TEXTURES:
+        return "Textures (GPU)";
+    case GPU_RENDERBUFFERS:
+        return "Renderbuffers (GPU)";
+    default:
+        return "";
+    }
+}
+
+void MemoryStats::setBudget(Category category, size_t bytes)
+{
+    GP_ASSERT(category < CATEGORY_COUNT);
+    __budgets[category] = bytes;
+    __warned[category] = false;
+}
+
+size_t MemoryStats::getBudget(Category category)
+{
+    GP_ASSERT(category < CATEGORY_COUNT);
+    return __budgets[category];
+}
+
+bool MemoryStats::isOverBudget(Category category)
+{
+    GP_ASSERT(category < CATEGORY_COUNT);
+    return __budgets[category] > 0 && getSize(category) > __budgets[category];
+}
+
+void MemoryStats::print()
+{
+    size_t total = 0;
+    for (unsigned int i = 0; i < CATEGORY_COUNT; ++i)
+    {
+        Category category = (Category)i;
+        size_t size = getSize(category);
+        total += size;
+        if (__budgets[i] > 0)
+        {
+            gameplay::print("[memory] %-20s %10u KB (peak %u KB, budget %u KB)%s\n", getName(category), (unsigned int)(size / 1024),
+                (unsigned int)(getPeakSize(category) / 1024), (unsigned int)(__budgets[i] / 1024), isOverBudget(category) ? " OVER BUDGET" : "");
+        }
+        else
+        {
+            gameplay::print("[memory] %-20s %10u KB (peak %u KB)\n", getName(category), (unsigned int)(size / 1024), (unsigned int)(getPeakSize(category) / 1024));
+        }
+    }
+    gameplay::print("[memory] %-20s %10u KB\n", "Total", (unsigned int)(total / 1024));
+}
+
+void MemoryStats::draw(Font* font, int x, int y, const Vector4& color)
+{
+    if (font == NULL)
+    {
+        // The default font is only looked for once, so a missing font warns once.
+        if (!__defaultFontLoaded)
+        {
+            __defaultFontLoaded = true;
+            __defaultFont = Font::create(MEMORY_STATS_DEFAULT_FONT);
+        }
+        font = __defaultFont;
+        if (font == NULL)
+            return;
+    }
+
+    static const Vector4 overBudgetColor(1.0f, 0.25f, 0.25f, 1.0f);
+    char line[128];
+    int lineHeight = (int)font->getSize();
+    font->start();
+    for (unsigned int i = 0; i < CATEGORY_COUNT; ++i)
+    {
+        Category category = (Category)i;
+        unsigned int size = (unsigned int)(getSize(category) / 1024);
+        if (__budgets[i] > 0)
+            sprintf(line, "%-20s %8u / %u KB", getName(category), size, (unsigned int)(__budgets[i] / 1024));
+        else
+            sprintf(line, "%-20s %8u KB", getName(category), size);
+        font->drawText(line, x, y + (int)i * lineHeight, isOverBudget(category) ? overBudgetColor : color);
+    }
+    font->finish();
+}
+
+void MemoryStats::beginFrame()
+{
+    // Warnings are only given on the main thread, once each time a category goes over budget.
+    for (unsigned int i = 0; i < CATEGORY_COUNT; ++i)
+    {
+        Category category = (Category)i;
+        if (isOverBudget(category))
+        {
+            if (!__warned[i])
+            {
+                __warned[i] = true;
+                GP_WARN("%s use %u KB of memory, over the budget of %u KB.", getName(category),
+                    (unsigned int)(getSize(category) / 1024), (unsigned int)(__budgets[i] / 1024));
+            }
+        }
+        else
+        {
+            __warned[i] = false;
+        }
+    }
+}
+
+void MemoryStats::finalize()
+{
+    SAFE_RELEASE(__defaultFont);
+    __defaultFontLoaded = false;
+}
+
+}
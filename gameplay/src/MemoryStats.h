@@ -0,0 +1,201 @@
+#ifndef MEMORYSTATS_H_
+#define MEMORYSTATS_H_
+
+#include "Base.h"
+#include "Vector4.h"
+
+namespace gameplay
+{
+
+class Font;
+
+/**
+ * Defines counters of the memory used by each subsystem of the engine.
+ *
+ * The engine adds the size of its large allocations to the category of the subsystem that
+ * makes them, such as the pixels of images, the curves of animations, or the state of the
+ * script interpreter, and removes it when they are freed. The memory of the buffers,
+ * textures and renderbuffers created through Mesh, Texture and FrameBuffer is counted in
+ * separate GPU categories, from the size and format they were created with.
+ *
+ * A budget can be set for each category. The game checks the categories at the start of each
+ * frame, and warns once each time a category goes over its budget. The overlay drawn by
+ * draw() highlights the categories over budget, and print() logs a report of all of them.
+ *
+ * The counters can be updated from any thread, and are always compiled in, so they can be
+ * used in release builds.
+ *
+ * @script{ignore}
+ */
+class MemoryStats
+{
+    friend class Game;
+
+public:
+
+    /**
+     * The categories of memory.
+     */
+    enum Category
+    {
+        /**
+         * Mesh data kept in CPU memory, such as the vertices of mesh batches.
+         */
+        MESH,
+
+        /**
+         * The pixels of images in CPU memory.
+         */
+        TEXTURE_CPU,
+
+        /**
+         * The curves of animations.
+         */
+        ANIMATION,
+
+        /**
+         * The triangles and heights of physics collision shapes.
+         */
+        PHYSICS,
+
+        /**
+         * The glyphs and text vertices of fonts.
+         */
+        UI,
+
+        /**
+         * The memory of the script interpreter.
+         */
+        SCRIPT,
+
+        /**
+         * The sound data of audio buffers.
+         */
+        AUDIO,
+
+        /**
+         * The vertex and index buffers of meshes.
+         */
+        GPU_BUFFERS,
+
+        /**
+         * The textures, including the color targets of frame buffers.
+         */
+        GPU_TEXTURES,
+
+        /**
+         * The depth and stencil targets of frame buffers.
+         */
+        GPU_RENDERBUFFERS,
+
+        /**
+         * The number of categories.
+         */
+        CATEGORY_COUNT
+    };
+
+    /**
+     * Adds memory to a category.
+     *
+     * @param category The category.
+     * @param bytes The size of the memory allocated.
+     */
+    static void add(Category category, size_t bytes);
+
+    /**
+     * Removes memory from a category.
+     *
+     * @param category The category.
+     * @param bytes The size of the memory freed, which must have been added before.
+     */
+    static void remove(Category category, size_t bytes);
+
+    /**
+     * Returns the memory currently used by a category.
+     *
+     * @param category The category.
+     *
+     * @return The size in bytes.
+     */
+    static size_t getSize(Category category);
+
+    /**
+     * Returns the largest memory a category used since the game started.
+     *
+     * @param category The category.
+     *
+     * @return The size in bytes.
+     */
+    static size_t getPeakSize(Category category);
+
+    /**
+     * Returns the name of a category.
+     *
+     * @param category The category.
+     *
+     * @return The name, such as "Textures (CPU)".
+     */
+    static const char* getName(Category category);
+
+    /**
+     * Sets the budget of a category.
+     *
+     * @param category The category.
+     * @param bytes The largest size allowed, or 0 for no budget.
+     */
+    static void setBudget(Category category, size_t bytes);
+
+    /**
+     * Returns the budget of a category.
+     *
+     * @param category The category.
+     *
+     * @return The largest size allowed, or 0 if there is no budget.
+     */
+    static size_t getBudget(Category category);
+
+    /**
+     * Determines whether a category currently uses more memory than its budget.
+     *
+     * @param category The category.
+     *
+     * @return True if the category has a budget and exceeds it.
+     */
+    static bool isOverBudget(Category category);
+
+    /**
+     * Logs the current, peak and budget sizes of every category.
+     */
+    static void print();
+
+    /**
+     * Draws the current sizes of the categories, with those over budget in red.
+     *
+     * @param font The font to draw with, or NULL to use the default font "res/ui/arial.gpb".
+     * @param x The left of the text in pixels.
+     * @param y The top of the text in pixels.
+     * @param color The color of the categories within budget.
+     */
+    static void draw(Font* font = NULL, int x = 0, int y = 0, const Vector4& color = Vector4::one());
+
+private:
+
+    /**
+     * Hidden constructor.
+     */
+    MemoryStats();
+
+    /**
+     * Called by Game at the start of each frame to warn about the categories that went over budget.
+     */
+    static void beginFrame();
+
+    /**
+     * Called by Game during shutdown to release the default font.
+     */
+    static void finalize();
+};
+
+}
+
+#endif
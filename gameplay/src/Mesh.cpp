@@ -1,21 +1,110 @@
 #include "Base.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include "MemoryStats.h"
 #include "Mesh.h"
 #include "MeshPart.h"
 #include "Effect.h"
 #include "Model.h"
 #include "Material.h"
+#include "Bundle.h"
 
 namespace gameplay
 {
 
+static bool isMapBufferRangeSupported()
+{
+#ifdef USE_MAP_BUFFER_RANGE
+    return GLEW_ARB_map_buffer_range || GLEW_VERSION_3_0;
+#else
+    return false;
+#endif
+}
+
+Mesh::BufferRing::BufferRing(unsigned int copies, unsigned int count, unsigned int stride)
+    : copies(copies), current(0), count(count), stride(stride), data(NULL), dirtyStart(copies, 0), dirtyEnd(copies, count), pending(true)
+{
+    data = new unsigned char[count * stride];
+    memset(data, 0, count * stride);
+    MemoryStats::add(MemoryStats::MESH, count * stride);
+}
+
+Mesh::BufferRing::~BufferRing()
+{
+    MemoryStats::remove(MemoryStats::MESH, count * stride);
+    SAFE_DELETE_ARRAY(data);
+}
+
+void Mesh::BufferRing::write(const void* source, unsigned int start, unsigned int length)
+{
+    GP_ASSERT(start + length <= count);
+
+    memcpy(data + start * stride, source, length * stride);
+    for (unsigned int i = 0; i < copies; ++i)
+    {
+        if (dirtyStart[i] < dirtyEnd[i])
+        {
+            dirtyStart[i] = std::min(dirtyStart[i], start);
+            dirtyEnd[i] = std::max(dirtyEnd[i], start + length);
+        }
+        else
+        {
+            dirtyStart[i] = start;
+            dirtyEnd[i] = start + length;
+        }
+    }
+    pending = true;
+}
+
+void Mesh::BufferRing::upload(GLenum target, GLuint buffer)
+{
+    if (!pending)
+        return;
+    pending = false;
+
+    // The draw calls of previous frames may still read the current copy, so the next one is written.
+    current = (current + 1) % copies;
+    const unsigned int start = dirtyStart[current];
+    const unsigned int end = dirtyEnd[current];
+    dirtyStart[current] = dirtyEnd[current] = 0;
+    if (start >= end)
+        return;
+
+    const GLintptr offset = (GLintptr)(current * count + start) * stride;
+    const GLsizeiptr size = (GLsizeiptr)(end - start) * stride;
+    GLStateCache::bindBuffer(target, buffer);
+    RenderStats::add(RenderStats::BUFFER_UPLOADS);
+
+#ifdef USE_MAP_BUFFER_RANGE
+    if (isMapBufferRangeSupported())
+    {
+        // No draw call that is still pending reads the copy, so there is nothing to wait for.
+        void* mapped = glMapBufferRange(target, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (mapped)
+        {
+            memcpy(mapped, data + start * stride, size);
+            if (glUnmapBuffer(target))
+                return;
+        }
+    }
+#endif
+
+    GL_ASSERT( glBufferSubData(target, offset, size, data + start * stride) );
+}
+
 Mesh::Mesh(const VertexFormat& vertexFormat) 
     : _vertexFormat(vertexFormat), _vertexCount(0), _vertexBuffer(0), _primitiveType(TRIANGLES), 
-      _partCount(0), _parts(NULL), _dynamic(false)
+      _partCount(0), _parts(NULL), _indexBuffer(0), _indexFormat(INDEX16), _indexCount(0), _dynamic(false), _dataResidency(DATA_BOUNDS), _positionData(NULL),
+      _vertexRing(NULL)
 {
 }
 
 Mesh::~Mesh()
 {
+    if (!_url.empty())
+        Bundle::uncacheMesh(this);
+
     if (_parts)
     {
         for (unsigned int i = 0; i < _partCount; ++i)
@@ -25,10 +114,26 @@ Mesh::~Mesh()
         SAFE_DELETE_ARRAY(_parts);
     }
 
+    if (_indexBuffer)
+    {
+        GLStateCache::deleteBuffers(1, &_indexBuffer);
+        _indexBuffer = 0;
+        unsigned int indexSize = _indexFormat == INDEX32 ? 4 : (_indexFormat == INDEX16 ? 2 : 1);
+        MemoryStats::remove(MemoryStats::GPU_BUFFERS, indexSize * _indexCount);
+    }
+
     if (_vertexBuffer)
     {
-        glDeleteBuffers(1, &_vertexBuffer);
+        GLStateCache::deleteBuffers(1, &_vertexBuffer);
         _vertexBuffer = 0;
+        MemoryStats::remove(MemoryStats::GPU_BUFFERS, _vertexFormat.getVertexSize() * _vertexCount * getBufferCount());
+    }
+    SAFE_DELETE(_vertexRing);
+
+    if (_positionData)
+    {
+        MemoryStats::remove(MemoryStats::MESH, sizeof(float) * 3 * _vertexCount);
+        SAFE_DELETE_ARRAY(_positionData);
     }
 }
 
@@ -36,9 +141,11 @@ Mesh* Mesh::createMesh(const VertexFormat& vertexFormat, unsigned int vertexCoun
 {
     GLuint vbo;
     GL_ASSERT( glGenBuffers(1, &vbo) );
-    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, vbo) );
+    GLStateCache::bindBuffer(GL_ARRAY_BUFFER, vbo);
     GL_ASSERT( glBufferData(GL_ARRAY_BUFFER, vertexFormat.getVertexSize() * vertexCount, NULL, dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW) );
 
+    MemoryStats::add(MemoryStats::GPU_BUFFERS, vertexFormat.getVertexSize() * vertexCount);
+
     Mesh* mesh = new Mesh(vertexFormat);
     mesh->_vertexCount = vertexCount;
     mesh->_vertexBuffer = vbo;
@@ -264,11 +371,19 @@ void Mesh::setPrimitiveType(PrimitiveType type)
 
 void Mesh::setVertexData(const float* vertexData, unsigned int vertexStart, unsigned int vertexCount)
 {
-    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer) );
+    GP_PROFILE("Mesh::setVertexData");
 
-    if (vertexStart == 0 && vertexCount == 0)
+    if (_vertexRing)
     {
+        // The data is written to the next copy of the buffer when the mesh is drawn.
+        GP_ASSERT(vertexData);
+        _vertexRing->write(vertexData, vertexStart, vertexCount == 0 ? _vertexCount - vertexStart : vertexCount);
+    }
+    else if (vertexStart == 0 && vertexCount == 0)
+    {
+        GLStateCache::bindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
         GL_ASSERT( glBufferData(GL_ARRAY_BUFFER, _vertexFormat.getVertexSize() * _vertexCount, vertexData, _dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW) );
+        RenderStats::add(RenderStats::BUFFER_UPLOADS);
     }
     else
     {
@@ -277,33 +392,250 @@ void Mesh::setVertexData(const float* vertexData, unsigned int vertexStart, unsi
             vertexCount = _vertexCount - vertexStart;
         }
 
+        GLStateCache::bindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
         GL_ASSERT( glBufferSubData(GL_ARRAY_BUFFER, vertexStart * _vertexFormat.getVertexSize(), vertexCount * _vertexFormat.getVertexSize(), vertexData) );
+        RenderStats::add(RenderStats::BUFFER_UPLOADS);
     }
+
+    if (_dataResidency == DATA_POSITIONS)
+        copyPositions(vertexData, vertexStart, vertexCount == 0 ? _vertexCount - vertexStart : vertexCount);
 }
 
-MeshPart* Mesh::addPart(PrimitiveType primitiveType, IndexFormat indexFormat, unsigned int indexCount, bool dynamic)
+bool Mesh::setBufferCount(unsigned int count)
 {
-    MeshPart* part = MeshPart::create(this, _partCount, primitiveType, indexFormat, indexCount, dynamic);
-    if (part)
+    GP_ASSERT(count > 0);
+
+    if (count == getBufferCount())
+        return true;
+    if (!_dynamic)
+    {
+        GP_ERROR("Only dynamic meshes can have more than one copy of their buffers.");
+        return false;
+    }
+
+    // The copies are consecutive in the vertex buffer, which keeps its handle, so the
+    // existing vertex attribute bindings of the mesh remain valid.
+    const unsigned int vertexSize = _vertexFormat.getVertexSize();
+    MemoryStats::remove(MemoryStats::GPU_BUFFERS, vertexSize * _vertexCount * getBufferCount());
+    SAFE_DELETE(_vertexRing);
+    GLStateCache::bindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
+    GL_ASSERT( glBufferData(GL_ARRAY_BUFFER, vertexSize * _vertexCount * count, NULL, GL_DYNAMIC_DRAW) );
+    MemoryStats::add(MemoryStats::GPU_BUFFERS, vertexSize * _vertexCount * count);
+    if (count > 1)
+        _vertexRing = new BufferRing(count, _vertexCount, vertexSize);
+
+    for (unsigned int i = 0; i < _partCount; ++i)
+    {
+        if (_parts[i]->_dynamic && !_parts[i]->_sharedBuffer)
+            _parts[i]->setBufferCount(count);
+    }
+    return true;
+}
+
+unsigned int Mesh::getBufferCount() const
+{
+    return _vertexRing ? _vertexRing->copies : 1;
+}
+
+void Mesh::updateBuffers()
+{
+    if (_vertexRing == NULL)
+        return;
+
+    _vertexRing->upload(GL_ARRAY_BUFFER, _vertexBuffer);
+    for (unsigned int i = 0; i < _partCount; ++i)
+    {
+        MeshPart* part = _parts[i];
+        if (part->_ring && part->_ring->pending)
+        {
+            // The element array buffer binding belongs to the bound vertex array.
+            GLStateCache::bindVertexArray(0);
+            part->_ring->upload(GL_ELEMENT_ARRAY_BUFFER, part->_indexBuffer);
+        }
+    }
+}
+
+unsigned int Mesh::getVertexOffset() const
+{
+    return _vertexRing ? _vertexRing->current * _vertexCount * _vertexFormat.getVertexSize() : 0;
+}
+
+Mesh::DataResidency Mesh::getDataResidency() const
+{
+    return _dataResidency;
+}
+
+void Mesh::setDataResidency(DataResidency residency)
+{
+    if (residency == _dataResidency)
+        return;
+    _dataResidency = residency;
+
+    if (residency != DATA_POSITIONS)
     {
-        // Increase size of part array and copy old subets into it.
-        MeshPart** oldParts = _parts;
-        _parts = new MeshPart*[_partCount + 1];
+        if (_positionData)
+        {
+            MemoryStats::remove(MemoryStats::MESH, sizeof(float) * 3 * _vertexCount);
+            SAFE_DELETE_ARRAY(_positionData);
+        }
         for (unsigned int i = 0; i < _partCount; ++i)
         {
-            _parts[i] = oldParts[i];
+            _parts[i]->releaseIndices();
         }
+        return;
+    }
+
+    // The data of a mesh loaded from a bundle was not kept, so read it again.
+    if (_url.empty())
+        return;
+    Bundle::MeshData* data = Bundle::readMeshData(_url.c_str());
+    if (data == NULL)
+    {
+        GP_WARN("Failed to read the data of mesh '%s' to keep it in memory.", _url.c_str());
+        return;
+    }
+    // The mesh may have been loaded with some of its vertex elements stripped.
+    if (data->vertexCount == _vertexCount && Bundle::convertMeshData(data, _vertexFormat))
+        copyPositions((const float*)data->vertexData, 0, _vertexCount);
+    for (unsigned int i = 0; i < _partCount && i < data->parts.size(); ++i)
+    {
+        Bundle::MeshPartData* partData = data->parts[i];
+        if (partData->indexCount == _parts[i]->_indexCount && partData->indexFormat == _parts[i]->_indexFormat)
+            _parts[i]->copyIndices(partData->indexData, 0, partData->indexCount);
+    }
+    SAFE_DELETE(data);
+}
+
+const float* Mesh::getPositionData() const
+{
+    return _positionData;
+}
+
+void Mesh::copyPositions(const float* vertexData, unsigned int vertexStart, unsigned int vertexCount)
+{
+    // Find the offset of the position in a vertex.
+    unsigned int offset = 0;
+    unsigned int size = 0;
+    for (unsigned int i = 0, count = _vertexFormat.getElementCount(); i < count; ++i)
+    {
+        const VertexFormat::Element& element = _vertexFormat.getElement(i);
+        if (element.usage == VertexFormat::POSITION)
+        {
+            if (element.type == VertexFormat::FLOAT && (element.size == 2 || element.size == 3))
+                size = element.size;
+            break;
+        }
+        offset += element.getByteSize();
+    }
+    if (size == 0 || vertexData == NULL)
+        return;
+
+    if (_positionData == NULL)
+    {
+        _positionData = new float[_vertexCount * 3];
+        memset(_positionData, 0, sizeof(float) * 3 * _vertexCount);
+        MemoryStats::add(MemoryStats::MESH, sizeof(float) * 3 * _vertexCount);
+    }
+
+    unsigned int stride = _vertexFormat.getVertexSize();
+    const unsigned char* source = (const unsigned char*)vertexData + offset;
+    float* position = _positionData + vertexStart * 3;
+    for (unsigned int i = 0; i < vertexCount; ++i, source += stride, position += 3)
+    {
+        memcpy(position, source, sizeof(float) * size);
+    }
+}
 
-        // Add new part to array.
-        _parts[_partCount++] = part;
+MeshPart* Mesh::addPart(PrimitiveType primitiveType, IndexFormat indexFormat, unsigned int indexCount, bool dynamic)
+{
+    MeshPart* part = MeshPart::create(this, _partCount, primitiveType, indexFormat, indexCount, dynamic);
+    if (part)
+    {
+        if (dynamic && _vertexRing)
+            part->setBufferCount(_vertexRing->copies);
+        appendPart(part);
+    }
+
+    return part;
+}
+
+bool Mesh::createIndexBuffer(Mesh::IndexFormat indexFormat, unsigned int indexCount, bool dynamic)
+{
+    if (_indexBuffer)
+    {
+        GP_ERROR("The mesh already has an index buffer.");
+        return false;
+    }
 
-        // Delete old part array.
-        SAFE_DELETE_ARRAY(oldParts);
+    unsigned int indexSize = 0;
+    switch (indexFormat)
+    {
+    case INDEX8:
+        indexSize = 1;
+        break;
+    case INDEX16:
+        indexSize = 2;
+        break;
+    case INDEX32:
+        indexSize = 4;
+        break;
+    default:
+        GP_ERROR("Unsupported index format (%d).", indexFormat);
+        return false;
     }
 
+    GLuint vbo;
+    GL_ASSERT( glGenBuffers(1, &vbo) );
+    GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo);
+    GL_ASSERT( glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexSize * indexCount, NULL, dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW) );
+    MemoryStats::add(MemoryStats::GPU_BUFFERS, indexSize * indexCount);
+
+    _indexBuffer = vbo;
+    _indexFormat = indexFormat;
+    _indexCount = indexCount;
+    return true;
+}
+
+MeshPart* Mesh::addPart(PrimitiveType primitiveType, unsigned int indexStart, unsigned int indexCount)
+{
+    if (_indexBuffer == 0 || indexStart + indexCount > _indexCount)
+    {
+        GP_ERROR("The range of indices of the part is not in the index buffer of the mesh.");
+        return NULL;
+    }
+
+    MeshPart* part = new MeshPart();
+    part->_mesh = this;
+    part->_meshIndex = _partCount;
+    part->_primitiveType = primitiveType;
+    part->_indexFormat = _indexFormat;
+    part->_indexCount = indexCount;
+    part->_indexBuffer = _indexBuffer;
+    part->_indexStart = indexStart;
+    part->_sharedBuffer = true;
+    part->_dynamic = _dynamic;
+    appendPart(part);
+
     return part;
 }
 
+void Mesh::appendPart(MeshPart* part)
+{
+    // Increase size of part array and copy old subets into it.
+    MeshPart** oldParts = _parts;
+    _parts = new MeshPart*[_partCount + 1];
+    for (unsigned int i = 0; i < _partCount; ++i)
+    {
+        _parts[i] = oldParts[i];
+    }
+
+    // Add new part to array.
+    _parts[_partCount++] = part;
+
+    // Delete old part array.
+    SAFE_DELETE_ARRAY(oldParts);
+}
+
 unsigned int Mesh::getPartCount() const
 {
     return _partCount;
@@ -22,6 +22,7 @@ class Mesh : public Ref
 {
     friend class Model;
     friend class Bundle;
+    friend class MeshPart;
 
 public:
 
@@ -47,6 +48,29 @@ public:
         POINTS = GL_POINTS
     };
 
+    /**
+     * Defines what a mesh keeps in CPU memory once its data is uploaded to its buffers.
+     */
+    enum DataResidency
+    {
+        /**
+         * Only the bounds are kept. The data of meshes loaded from a bundle is read again
+         * from the bundle when it is needed, e.g. to create a physics mesh shape (the default).
+         */
+        DATA_BOUNDS,
+
+        /**
+         * The vertex positions and the indices of the parts are kept, for physics and picking.
+         */
+        DATA_POSITIONS,
+
+        /**
+         * Only the bounds are kept, and the data is never read again, so no physics mesh
+         * shape can be created from the mesh.
+         */
+        DATA_DISCARD
+    };
+
     /**
      * Constructs a new mesh with the specified vertex format.
      *
@@ -209,6 +233,89 @@ public:
      */
     void setVertexData(const float* vertexData, unsigned int vertexStart = 0, unsigned int vertexCount = 0);
 
+    /**
+     * Sets the number of copies of its vertices and indices that a dynamic mesh cycles through.
+     *
+     * Updating a buffer that the GPU may still be reading for a previous frame stalls the
+     * pipeline until those draw calls are done, which happens every frame to meshes that are
+     * deformed on the CPU, such as cloth or water. With more than one copy, the vertices and
+     * the indices of the dynamic parts that have their own index buffer are also kept in CPU
+     * memory. setVertexData and MeshPart::setIndexData only copy the data there and record
+     * the range that changed, however many times they are called. When the mesh is next
+     * drawn, everything the next copy lacks is written to it in a single transfer without
+     * waiting for the GPU, and the mesh is drawn from that copy.
+     *
+     * The number of copies should exceed the number of frames the GPU lags behind, which
+     * is usually 2, and the data should only change once per frame. The vertices and
+     * indices must be set again after the number of copies changed.
+     *
+     * @param count The number of copies, or 1 to update the buffers directly (the default).
+     *
+     * @return true if the number of copies was set, false if the mesh is not dynamic.
+     * @script{ignore}
+     */
+    bool setBufferCount(unsigned int count);
+
+    /**
+     * Returns the number of copies of its vertices and indices that the mesh cycles through.
+     *
+     * @return The number of copies.
+     * @script{ignore}
+     */
+    unsigned int getBufferCount() const;
+
+    /**
+     * Writes the data set since the mesh was last drawn to the next copy of its buffers, and
+     * makes that the copy that is drawn, when the mesh has more than one copy.
+     *
+     * This is called whenever a VertexAttributeBinding of the mesh is bound, so only code
+     * that draws from the buffers of the mesh by other means needs to call it.
+     *
+     * @script{ignore}
+     */
+    void updateBuffers();
+
+    /**
+     * Returns the offset in the vertex buffer of the copy of the vertices that is drawn.
+     *
+     * @return The offset, in bytes, which is 0 unless the mesh has more than one copy.
+     * @script{ignore}
+     */
+    unsigned int getVertexOffset() const;
+
+    /**
+     * Returns what the mesh keeps in CPU memory besides its bounds.
+     *
+     * @return The data residency of the mesh.
+     * @script{ignore}
+     */
+    DataResidency getDataResidency() const;
+
+    /**
+     * Sets what the mesh keeps in CPU memory besides its bounds.
+     *
+     * The data is copied when it is set, so the residency of meshes created
+     * programmatically should be set before their vertex and index data. Meshes loaded from
+     * a bundle get the residency set on the bundle (see Bundle::setMeshDataResidency). When
+     * DATA_POSITIONS is set on a mesh loaded from a bundle that did not keep its data, the
+     * data is read again from the bundle. Setting another residency releases the data.
+     *
+     * Only positions made of 2 or 3 floats are kept.
+     *
+     * @param residency The data residency.
+     * @script{ignore}
+     */
+    void setDataResidency(DataResidency residency);
+
+    /**
+     * Returns the vertex positions kept in CPU memory, when the residency of the
+     * mesh is DATA_POSITIONS.
+     *
+     * @return The positions (3 floats per vertex), or NULL if they are not kept.
+     * @script{ignore}
+     */
+    const float* getPositionData() const;
+
     /**
      * Creates and adds a new part of primitive data defining how the vertices are connected.
      *
@@ -221,6 +328,36 @@ public:
      */
     MeshPart* addPart(PrimitiveType primitiveType, Mesh::IndexFormat indexFormat, unsigned int indexCount, bool dynamic = false);
 
+    /**
+     * Creates an index buffer that is shared by the parts added to the mesh with
+     * addPart(PrimitiveType, unsigned int, unsigned int).
+     *
+     * Parts that share an index buffer are drawn from ranges of the buffer, so the buffer
+     * does not need to be bound again between the parts of the mesh.
+     *
+     * @param indexFormat The format of the indices of all the parts that share the buffer.
+     * @param indexCount The number of indices of all the parts that share the buffer.
+     * @param dynamic true if the index data is dynamic; false otherwise.
+     *
+     * @return true if the index buffer was created, false if the mesh already has one or the format is not supported.
+     * @script{ignore}
+     */
+    bool createIndexBuffer(Mesh::IndexFormat indexFormat, unsigned int indexCount, bool dynamic = false);
+
+    /**
+     * Adds a part whose indices are a range of the index buffer of the mesh (see createIndexBuffer).
+     *
+     * The indices of the part are set with MeshPart::setIndexData, relative to the start of the part.
+     *
+     * @param primitiveType The type of primitive data to connect the indices as.
+     * @param indexStart The index in the index buffer of the mesh of the first index of the part.
+     * @param indexCount The number of indices to be contained in the part.
+     *
+     * @return The newly created/added mesh part, or NULL if the range is not in the index buffer.
+     * @script{ignore}
+     */
+    MeshPart* addPart(PrimitiveType primitiveType, unsigned int indexStart, unsigned int indexCount);
+
     /**
      * Gets the number of mesh parts contained within the mesh.
      *
@@ -302,6 +439,36 @@ public:
 
 private:
 
+    /**
+     * A buffer with several copies in GPU memory, of which one is drawn, and its data in CPU
+     * memory. Every copy records the range of elements it lacks.
+     */
+    struct BufferRing
+    {
+        BufferRing(unsigned int copies, unsigned int count, unsigned int stride);
+        ~BufferRing();
+
+        /**
+         * Copies a range of elements into the data and marks it as lacking from every copy.
+         */
+        void write(const void* source, unsigned int start, unsigned int length);
+
+        /**
+         * Writes what the next copy lacks to it if data was written since the last upload,
+         * and makes it the current copy.
+         */
+        void upload(GLenum target, GLuint buffer);
+
+        unsigned int copies;
+        unsigned int current;
+        unsigned int count;
+        unsigned int stride;
+        unsigned char* data;
+        std::vector<unsigned int> dirtyStart;
+        std::vector<unsigned int> dirtyEnd;
+        bool pending;
+    };
+
     /**
      * Constructor.
      */
@@ -317,6 +484,16 @@ private:
      */
     Mesh& operator=(const Mesh&);
 
+    /**
+     * Appends a part to the parts of the mesh.
+     */
+    void appendPart(MeshPart* part);
+
+    /**
+     * Copies the positions of the given range of vertices into the positions kept in CPU memory.
+     */
+    void copyPositions(const float* vertexData, unsigned int vertexStart, unsigned int vertexCount);
+
     std::string _url;
     const VertexFormat _vertexFormat;
     unsigned int _vertexCount;
@@ -324,9 +501,15 @@ private:
     PrimitiveType _primitiveType;
     unsigned int _partCount;
     MeshPart** _parts;
+    IndexBufferHandle _indexBuffer;
+    Mesh::IndexFormat _indexFormat;
+    unsigned int _indexCount;
     bool _dynamic;
     BoundingBox _boundingBox;
     BoundingSphere _boundingSphere;
+    DataResidency _dataResidency;
+    float* _positionData;
+    BufferRing* _vertexRing;
 };
 
 }
@@ -1,25 +1,88 @@
 #include "Base.h"
+#include "GLStateCache.h"
+#include "RenderStats.h"
+#include "MemoryStats.h"
 #include "MeshBatch.h"
 #include "Material.h"
 
+// The number of batches that fit in the streaming buffers before they are orphaned.
+#define MESH_BATCH_BUFFER_BATCHES 4
+
 namespace gameplay
 {
 
-MeshBatch::MeshBatch(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, Material* material, bool indexed, unsigned int initialCapacity, unsigned int growSize)
-    : _vertexFormat(vertexFormat), _primitiveType(primitiveType), _material(material), _indexed(indexed), _capacity(0), _growSize(growSize),
-      _vertexCapacity(0), _indexCapacity(0), _vertexCount(0), _indexCount(0), _vertices(NULL), _verticesPtr(NULL), _indices(NULL), _indicesPtr(NULL)
+static bool isMapBufferRangeSupported()
+{
+#ifdef USE_MAP_BUFFER_RANGE
+    return GLEW_ARB_map_buffer_range || GLEW_VERSION_3_0;
+#else
+    return false;
+#endif
+}
+
+static bool isIndex32Supported()
+{
+#ifdef OPENGL_ES
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    return extensions && strstr(extensions, "GL_OES_element_index_uint") != NULL;
+#else
+    return true;
+#endif
+}
+
+// Copies indices from one format to another, offsetting them by the specified base vertex.
+template <class S, class D>
+static void copyIndices(D* dst, const S* src, unsigned int count, unsigned int base)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        dst[i] = (D)(src[i] + base);
+    }
+}
+
+MeshBatch::MeshBatch(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, Material* material, bool indexed, unsigned int initialCapacity, unsigned int growSize,
+                     Mesh::IndexFormat indexFormat)
+    : _vertexFormat(vertexFormat), _primitiveType(primitiveType), _material(material), _indexed(indexed), _indexFormat(indexFormat), _indexSize(0),
+      _capacity(0), _growSize(growSize), _vertexCapacity(0), _indexCapacity(0), _vertexCount(0), _indexCount(0), _currentSubBatch(0),
+      _streaming(true), _vertexBuffer(0), _indexBuffer(0), _vertexBufferCapacity(0), _indexBufferCapacity(0), _bufferCopies(1), _bufferCopy(0)
 {
+    if (_indexFormat == Mesh::INDEX32 && !isIndex32Supported())
+    {
+        GP_WARN("32-bit indices are not supported on this device; using 16-bit indices for mesh batch.");
+        _indexFormat = Mesh::INDEX16;
+    }
+    else if (_indexFormat != Mesh::INDEX32)
+    {
+        _indexFormat = Mesh::INDEX16;
+    }
+    _indexSize = _indexFormat == Mesh::INDEX32 ? sizeof(unsigned int) : sizeof(unsigned short);
+
+    // Gather the passes of all techniques, which each need their own vertex attribute bindings.
+    GP_ASSERT(_material);
+    for (unsigned int i = 0, techniqueCount = _material->getTechniqueCount(); i < techniqueCount; ++i)
+    {
+        Technique* t = _material->getTechniqueByIndex(i);
+        GP_ASSERT(t);
+        for (unsigned int j = 0, passCount = t->getPassCount(); j < passCount; ++j)
+        {
+            GP_ASSERT(t->getPassByIndex(j));
+            _passes.push_back(t->getPassByIndex(j));
+        }
+    }
+
+    createBuffers();
     resize(initialCapacity);
 }
 
 MeshBatch::~MeshBatch()
 {
+    deleteSubBatches();
+    deleteBuffers();
     SAFE_RELEASE(_material);
-    SAFE_DELETE_ARRAY(_vertices);
-    SAFE_DELETE_ARRAY(_indices);
 }
 
-MeshBatch* MeshBatch::create(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, const char* materialPath, bool indexed, unsigned int initialCapacity, unsigned int growSize)
+MeshBatch* MeshBatch::create(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, const char* materialPath, bool indexed, unsigned int initialCapacity, unsigned int growSize,
+                             Mesh::IndexFormat indexFormat)
 {
     Material* material = Material::create(materialPath);
     if (material == NULL)
@@ -27,102 +90,264 @@ MeshBatch* MeshBatch::create(const VertexFormat& vertexFormat, Mesh::PrimitiveTy
         GP_ERROR("Failed to create material for mesh batch from file '%s'.", materialPath);
         return NULL;
     }
-    MeshBatch* batch = create(vertexFormat, primitiveType, material, indexed, initialCapacity, growSize);
+    MeshBatch* batch = create(vertexFormat, primitiveType, material, indexed, initialCapacity, growSize, indexFormat);
     SAFE_RELEASE(material); // batch now owns the material
     return batch;
 }
 
-MeshBatch* MeshBatch::create(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, Material* material, bool indexed, unsigned int initialCapacity, unsigned int growSize)
+MeshBatch* MeshBatch::create(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, Material* material, bool indexed, unsigned int initialCapacity, unsigned int growSize,
+                             Mesh::IndexFormat indexFormat)
 {
     GP_ASSERT(material);
 
-    MeshBatch* batch = new MeshBatch(vertexFormat, primitiveType, material, indexed, initialCapacity, growSize);
+    MeshBatch* batch = new MeshBatch(vertexFormat, primitiveType, material, indexed, initialCapacity, growSize, indexFormat);
 
     material->addRef();
 
     return batch;
 }
 
-void MeshBatch::add(const void* vertices, size_t size, unsigned int vertexCount, const unsigned short* indices, unsigned int indexCount)
+bool MeshBatch::fits(const SubBatch* subBatch, unsigned int vertexCount, unsigned int indexCount) const
+{
+    GP_ASSERT(subBatch);
+
+    if (_primitiveType == Mesh::TRIANGLE_STRIP && subBatch->vertexCount > 0)
+        indexCount += 2; // need an extra 2 indices for connecting strips with degenerate triangles
+
+    return subBatch->vertexCount + vertexCount <= subBatch->vertexCapacity &&
+        (!_indexed || subBatch->indexCount + indexCount <= subBatch->indexCapacity);
+}
+
+void MeshBatch::add(const void* vertices, size_t size, unsigned int vertexCount, const void* indices, Mesh::IndexFormat indexFormat, unsigned int indexCount)
 {
     GP_ASSERT(vertices);
-    
-    unsigned int newVertexCount = _vertexCount + vertexCount;
-    unsigned int newIndexCount = _indexCount + indexCount;
-    if (_primitiveType == Mesh::TRIANGLE_STRIP && _vertexCount > 0)
-        newIndexCount += 2; // need an extra 2 indices for connecting strips with degenerate triangles
-    
-    // Do we need to grow the batch?
-    while (newVertexCount > _vertexCapacity || (_indexed && newIndexCount > _indexCapacity))
+    GP_ASSERT(!_subBatches.empty());
+
+    // The primitives of a single call cannot be split between sub-batches.
+    unsigned int vertexCapacityMax = getVertexCapacity(getSubBatchCapacityMax());
+    if (vertexCount > vertexCapacityMax || (_indexed && indexCount > vertexCapacityMax))
     {
-        if (_growSize == 0)
-            return; // growing disabled, just clip batch
-        if (!resize(_capacity + _growSize))
-            return; // failed to grow
+        GP_ERROR("Too many vertices (%d) added to mesh batch with %d-bit indices.", vertexCount, _indexSize * 8);
+        return;
+    }
+
+    // Move on to the next sub-batch that can hold the primitives, adding one if needed.
+    // Existing sub-batches are never reallocated.
+    SubBatch* subBatch = _subBatches[_currentSubBatch];
+    while (!fits(subBatch, vertexCount, indexCount))
+    {
+        if (_currentSubBatch + 1 == _subBatches.size())
+        {
+            if (_growSize == 0)
+                return; // growing disabled, just clip batch
+
+            // Grow by at least enough for the primitives being added.
+            unsigned int capacity = _growSize;
+            while (capacity < getSubBatchCapacityMax() && (getVertexCapacity(capacity) < vertexCount || (_indexed && getVertexCapacity(capacity) < indexCount)))
+            {
+                capacity += _growSize;
+            }
+            if (!addSubBatch(std::min(capacity, getSubBatchCapacityMax())))
+                return; // failed to grow
+        }
+        subBatch = _subBatches[++_currentSubBatch];
     }
-    
+
     // Copy vertex data.
-    GP_ASSERT(_verticesPtr);
-    unsigned int vBytes = vertexCount * _vertexFormat.getVertexSize();
-    memcpy(_verticesPtr, vertices, vBytes);
-    
+    GP_ASSERT(subBatch->vertices);
+    unsigned int vertexSize = _vertexFormat.getVertexSize();
+    memcpy(subBatch->vertices + subBatch->vertexCount * vertexSize, vertices, vertexCount * vertexSize);
+
     // Copy index data.
     if (_indexed)
     {
         GP_ASSERT(indices);
-        GP_ASSERT(_indicesPtr);
+        GP_ASSERT(subBatch->indices);
 
-        if (_vertexCount == 0)
-        {
-            // Simply copy values directly into the start of the index array.
-            memcpy(_indicesPtr, indices, indexCount * sizeof(unsigned short));
-        }
-        else
+        unsigned int base = subBatch->vertexCount;
+        unsigned int first = subBatch->indexCount;
+        if (_primitiveType == Mesh::TRIANGLE_STRIP && base > 0)
         {
-            if (_primitiveType == Mesh::TRIANGLE_STRIP)
+            // Create a degenerate triangle to connect separate triangle strips
+            // by duplicating the previous and next vertices.
+            if (_indexFormat == Mesh::INDEX32)
             {
-                // Create a degenerate triangle to connect separate triangle strips
-                // by duplicating the previous and next vertices.
-                _indicesPtr[0] = *(_indicesPtr-1);
-                _indicesPtr[1] = _vertexCount;
-                _indicesPtr += 2;
+                unsigned int* dst = (unsigned int*)subBatch->indices + first;
+                dst[0] = dst[-1];
+                dst[1] = base;
             }
-            
-            // Loop through all indices and insert them, with their values offset by
-            // 'vertexCount' so that they are relative to the first newly inserted vertex.
-            for (unsigned int i = 0; i < indexCount; ++i)
+            else
             {
-                _indicesPtr[i] = indices[i] + _vertexCount;
+                unsigned short* dst = (unsigned short*)subBatch->indices + first;
+                dst[0] = dst[-1];
+                dst[1] = (unsigned short)base;
             }
+            first += 2;
+        }
+
+        // Insert the indices with their values offset by the number of vertices already in the
+        // sub-batch, so that they are relative to the first newly inserted vertex.
+        if (_indexFormat == Mesh::INDEX32)
+        {
+            unsigned int* dst = (unsigned int*)subBatch->indices + first;
+            if (indexFormat == Mesh::INDEX32)
+                copyIndices(dst, (const unsigned int*)indices, indexCount, base);
+            else
+                copyIndices(dst, (const unsigned short*)indices, indexCount, base);
+        }
+        else
+        {
+            unsigned short* dst = (unsigned short*)subBatch->indices + first;
+            if (indexFormat == Mesh::INDEX32)
+                copyIndices(dst, (const unsigned int*)indices, indexCount, base);
+            else
+                copyIndices(dst, (const unsigned short*)indices, indexCount, base);
         }
-        _indicesPtr += indexCount;
-        _indexCount = newIndexCount;
+
+        _indexCount += first + indexCount - subBatch->indexCount;
+        subBatch->indexCount = first + indexCount;
     }
-    
-    _verticesPtr += vBytes;
-    _vertexCount = newVertexCount;
+
+    subBatch->vertexCount += vertexCount;
+    _vertexCount += vertexCount;
 }
 
-void MeshBatch::updateVertexAttributeBinding()
+unsigned int MeshBatch::getVertexCapacity(unsigned int capacity) const
 {
-    GP_ASSERT(_material);
+    switch (_primitiveType)
+    {
+    case Mesh::LINES:
+        return capacity * 2;
+    case Mesh::LINE_STRIP:
+        return capacity + 1;
+    case Mesh::POINTS:
+        return capacity;
+    case Mesh::TRIANGLES:
+        return capacity * 3;
+    case Mesh::TRIANGLE_STRIP:
+        return capacity + 2;
+    default:
+        return 0;
+    }
+}
 
-    // Update our vertex attribute bindings.
-    for (unsigned int i = 0, techniqueCount = _material->getTechniqueCount(); i < techniqueCount; ++i)
+unsigned int MeshBatch::getSubBatchCapacityMax() const
+{
+    if (_indexed && _indexFormat == Mesh::INDEX16)
     {
-        Technique* t = _material->getTechniqueByIndex(i);
-        GP_ASSERT(t);
-        for (unsigned int j = 0, passCount = t->getPassCount(); j < passCount; ++j)
+        // All the vertices of a sub-batch must be addressable with 16-bit indices.
+        unsigned int vertexCount = USHRT_MAX + 1;
+        switch (_primitiveType)
+        {
+        case Mesh::LINES:
+            return vertexCount / 2;
+        case Mesh::LINE_STRIP:
+            return vertexCount - 1;
+        case Mesh::TRIANGLES:
+            return vertexCount / 3;
+        case Mesh::TRIANGLE_STRIP:
+            return vertexCount - 2;
+        default:
+            return vertexCount;
+        }
+    }
+    return UINT_MAX;
+}
+
+bool MeshBatch::addSubBatch(unsigned int capacity)
+{
+    unsigned int vertexCapacity = getVertexCapacity(capacity);
+    if (vertexCapacity == 0)
+    {
+        GP_ERROR("Unsupported primitive type for mesh batch (%d).", _primitiveType);
+        return false;
+    }
+
+    // We have no way of knowing how many vertices will be stored in the batch
+    // (we only know how many indices will be stored). Assume the worst case
+    // for now, which is the same number of vertices as indices.
+    SubBatch* subBatch = new SubBatch();
+    subBatch->capacity = capacity;
+    subBatch->vertexCapacity = vertexCapacity;
+    subBatch->indexCapacity = _indexed ? vertexCapacity : 0;
+    subBatch->vertexCount = 0;
+    subBatch->indexCount = 0;
+    subBatch->vertexBufferOffset = _vertexCapacity * _bufferCopies;
+    subBatch->indexBufferOffset = _indexCapacity * _bufferCopies;
+    subBatch->vertices = new unsigned char[vertexCapacity * _vertexFormat.getVertexSize()];
+    subBatch->indices = _indexed ? new unsigned char[subBatch->indexCapacity * _indexSize] : NULL;
+    _subBatches.push_back(subBatch);
+    MemoryStats::add(MemoryStats::MESH, vertexCapacity * _vertexFormat.getVertexSize() + subBatch->indexCapacity * _indexSize);
+
+    _capacity += capacity;
+    _vertexCapacity += vertexCapacity;
+    _indexCapacity += subBatch->indexCapacity;
+
+    return true;
+}
+
+VertexAttributeBinding* MeshBatch::getVertexAttributeBinding(SubBatch* subBatch, unsigned int passIndex)
+{
+    GP_ASSERT(subBatch);
+    GP_ASSERT(passIndex < _passes.size());
+
+    // Streamed sub-batches have a binding for each copy in the buffers; client-side arrays only one.
+    unsigned int copies = _streaming ? _bufferCopies : 1;
+    if (subBatch->bindings.size() != copies * _passes.size())
+    {
+        subBatch->bindings.resize(copies * _passes.size(), NULL);
+    }
+
+    unsigned int copy = _streaming ? _bufferCopy : 0;
+    VertexAttributeBinding*& b = subBatch->bindings[copy * _passes.size() + passIndex];
+    if (b == NULL)
+    {
+        Effect* effect = _passes[passIndex]->getEffect();
+        if (_streaming)
+        {
+            unsigned int firstVertex = subBatch->vertexBufferOffset + copy * subBatch->vertexCapacity;
+            b = VertexAttributeBinding::create(_vertexBuffer, _vertexFormat, firstVertex * _vertexFormat.getVertexSize(), effect);
+        }
+        else
+        {
+            b = VertexAttributeBinding::create(_vertexFormat, subBatch->vertices, effect);
+        }
+    }
+    return b;
+}
+
+void MeshBatch::deleteVertexAttributeBindings()
+{
+    for (size_t i = 0, count = _subBatches.size(); i < count; ++i)
+    {
+        std::vector<VertexAttributeBinding*>& bindings = _subBatches[i]->bindings;
+        for (size_t j = 0, bindingCount = bindings.size(); j < bindingCount; ++j)
         {
-            Pass* p = t->getPassByIndex(j);
-            GP_ASSERT(p);
-            VertexAttributeBinding* b = VertexAttributeBinding::create(_vertexFormat, _vertices, p->getEffect());
-            p->setVertexAttributeBinding(b);
-            SAFE_RELEASE(b);
+            SAFE_RELEASE(bindings[j]);
         }
+        bindings.clear();
     }
 }
 
+void MeshBatch::deleteSubBatches()
+{
+    deleteVertexAttributeBindings();
+    MemoryStats::remove(MemoryStats::MESH, _vertexCapacity * _vertexFormat.getVertexSize() + _indexCapacity * _indexSize);
+    for (size_t i = 0, count = _subBatches.size(); i < count; ++i)
+    {
+        SAFE_DELETE_ARRAY(_subBatches[i]->vertices);
+        SAFE_DELETE_ARRAY(_subBatches[i]->indices);
+        SAFE_DELETE(_subBatches[i]);
+    }
+    _subBatches.clear();
+    _currentSubBatch = 0;
+    _capacity = 0;
+    _vertexCapacity = 0;
+    _indexCapacity = 0;
+    _vertexCount = 0;
+    _indexCount = 0;
+}
+
 unsigned int MeshBatch::getCapacity() const
 {
     return _capacity;
@@ -133,6 +358,16 @@ void MeshBatch::setCapacity(unsigned int capacity)
     resize(capacity);
 }
 
+Mesh::IndexFormat MeshBatch::getIndexFormat() const
+{
+    return _indexFormat;
+}
+
+unsigned int MeshBatch::getSubBatchCount() const
+{
+    return (unsigned int)_subBatches.size();
+}
+
 bool MeshBatch::resize(unsigned int capacity)
 {
     if (capacity == 0)
@@ -144,94 +379,215 @@ bool MeshBatch::resize(unsigned int capacity)
     if (capacity == _capacity)
         return true;
 
-    // Store old batch data.
-    unsigned char* oldVertices = _vertices;
-    unsigned short* oldIndices = _indices;
+    if (capacity < _capacity)
+    {
+        // Shrinking replaces all sub-batches, which clears the batch.
+        deleteSubBatches();
+    }
 
-    unsigned int vertexCapacity = 0;
-    switch (_primitiveType)
+    // Add sub-batches for the additional capacity; the existing ones are kept as they are.
+    unsigned int subBatchCapacityMax = getSubBatchCapacityMax();
+    while (_capacity < capacity)
     {
-    case Mesh::LINES:
-        vertexCapacity = capacity * 2;
-        break;
-    case Mesh::LINE_STRIP:
-        vertexCapacity = capacity + 1;
-        break;
-    case Mesh::POINTS:
-        vertexCapacity = capacity;
-        break;
-    case Mesh::TRIANGLES:
-        vertexCapacity = capacity * 3;
-        break;
-    case Mesh::TRIANGLE_STRIP:
-        vertexCapacity = capacity + 2;
-        break;
-    default:
-        GP_ERROR("Unsupported primitive type for mesh batch (%d).", _primitiveType);
-        return false;
+        if (!addSubBatch(std::min(capacity - _capacity, subBatchCapacityMax)))
+            return false;
     }
 
-    // We have no way of knowing how many vertices will be stored in the batch
-    // (we only know how many indices will be stored). Assume the worst case
-    // for now, which is the same number of vertices as indices.
-    unsigned int indexCapacity = vertexCapacity;
-    if (_indexed && indexCapacity > USHRT_MAX)
+    return true;
+}
+
+void MeshBatch::add(const float* vertices, unsigned int vertexCount, const unsigned short* indices, unsigned int indexCount)
+{
+    add(vertices, sizeof(float), vertexCount, indices, Mesh::INDEX16, indexCount);
+}
+
+void MeshBatch::add(const float* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+{
+    add(vertices, sizeof(float), vertexCount, indices, Mesh::INDEX32, indexCount);
+}
+
+void MeshBatch::setStreaming(bool streaming)
+{
+    if (_streaming == streaming)
+        return;
+
+    // The bindings of one mode cannot be used by the other.
+    deleteVertexAttributeBindings();
+    _streaming = streaming;
+    if (_streaming)
     {
-        GP_ERROR("Index capacity is greater than the maximum unsigned short value (%d > %d).", indexCapacity, USHRT_MAX);
-        return false;
+        createBuffers();
     }
+    else
+    {
+        deleteBuffers();
+    }
+}
 
-    // Allocate new data and reset pointers.
-    unsigned int voffset = _verticesPtr - _vertices;
-    unsigned int vBytes = vertexCapacity * _vertexFormat.getVertexSize();
-    _vertices = new unsigned char[vBytes];
-    if (voffset >= vBytes)
-        voffset = vBytes - 1;
-    _verticesPtr = _vertices + voffset;
+bool MeshBatch::isStreaming() const
+{
+    return _streaming;
+}
+
+void MeshBatch::createBuffers()
+{
+    if (!_streaming || _vertexBuffer)
+        return;
 
+    // The buffer storage is allocated when the first batch is finished.
+    GL_ASSERT( glGenBuffers(1, &_vertexBuffer) );
     if (_indexed)
     {
-        unsigned int ioffset = _indicesPtr - _indices;
-        _indices = new unsigned short[indexCapacity];
-        if (ioffset >= indexCapacity)
-            ioffset = indexCapacity - 1;
-        _indicesPtr = _indices + ioffset;
+        GL_ASSERT( glGenBuffers(1, &_indexBuffer) );
     }
 
-    // Copy old data back in
-    if (oldVertices)
-        memcpy(_vertices, oldVertices, std::min(_vertexCapacity, vertexCapacity) * _vertexFormat.getVertexSize());
-    SAFE_DELETE_ARRAY(oldVertices);
-    if (oldIndices)
-        memcpy(_indices, oldIndices, std::min(_indexCapacity, indexCapacity) * sizeof(unsigned short));
-    SAFE_DELETE_ARRAY(oldIndices);
+    // Without unsynchronized mapping the buffers are orphaned for every batch, so they only need to hold one.
+    unsigned int copies = isMapBufferRangeSupported() ? MESH_BATCH_BUFFER_BATCHES : 1;
+    if (copies != _bufferCopies)
+    {
+        // Each sub-batch has a region in the buffers with room for all copies.
+        _bufferCopies = copies;
+        for (size_t i = 0, count = _subBatches.size(); i < count; ++i)
+        {
+            _subBatches[i]->vertexBufferOffset = (i == 0) ? 0 : _subBatches[i - 1]->vertexBufferOffset + _subBatches[i - 1]->vertexCapacity * copies;
+            _subBatches[i]->indexBufferOffset = (i == 0) ? 0 : _subBatches[i - 1]->indexBufferOffset + _subBatches[i - 1]->indexCapacity * copies;
+        }
+    }
+    _bufferCopy = _bufferCopies - 1;
+}
 
-    // Assign new capacities
-    _capacity = capacity;
-    _vertexCapacity = vertexCapacity;
-    _indexCapacity = indexCapacity;
+void MeshBatch::updateBuffers()
+{
+    if (!_streaming || _vertexCount == 0 || (_indexed && _indexCount == 0))
+        return;
+
+    GP_ASSERT(_vertexBuffer);
+    GP_ASSERT(!_indexed || _indexBuffer);
+    unsigned int vertexSize = _vertexFormat.getVertexSize();
+    unsigned int vertexBufferCapacity = _vertexCapacity * _bufferCopies;
+    unsigned int indexBufferCapacity = _indexCapacity * _bufferCopies;
+
+    // Every batch is written to the next copy in the buffers. The buffers are orphaned when
+    // they wrap around or have to grow.
+    bool orphan = _bufferCopy + 1 == _bufferCopies || vertexBufferCapacity != _vertexBufferCapacity || indexBufferCapacity != _indexBufferCapacity;
+    _bufferCopy = orphan ? 0 : _bufferCopy + 1;
+
+#ifdef USE_MAP_BUFFER_RANGE
+    if (!orphan)
+    {
+        // Write the batch without waiting for draw calls that still use the other copies.
+        const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+        for (size_t i = 0, count = _subBatches.size(); i < count && !orphan; ++i)
+        {
+            SubBatch* s = _subBatches[i];
+            if (s->vertexCount == 0)
+                continue;
+
+            GLStateCache::bindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
+            unsigned int firstVertex = s->vertexBufferOffset + _bufferCopy * s->vertexCapacity;
+            void* vertices = glMapBufferRange(GL_ARRAY_BUFFER, firstVertex * vertexSize, s->vertexCount * vertexSize, access);
+            if (vertices)
+            {
+                memcpy(vertices, s->vertices, s->vertexCount * vertexSize);
+                GL_ASSERT( glUnmapBuffer(GL_ARRAY_BUFFER) );
+            }
+            else
+            {
+                orphan = true;
+            }
 
-    // Update our vertex attribute bindings now that our client array pointers have changed
-    updateVertexAttributeBinding();
+            if (!orphan && _indexed && s->indexCount > 0)
+            {
+                GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer);
+                unsigned int firstIndex = s->indexBufferOffset + _bufferCopy * s->indexCapacity;
+                void* indices = glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, firstIndex * _indexSize, s->indexCount * _indexSize, access);
+                if (indices)
+                {
+                    memcpy(indices, s->indices, s->indexCount * _indexSize);
+                    GL_ASSERT( glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER) );
+                }
+                else
+                {
+                    orphan = true;
+                }
+            }
+        }
+        if (orphan)
+        {
+            _bufferCopy = 0;
+        }
+    }
+#endif
 
-    return true;
+    if (orphan)
+    {
+        // Give the driver new storage, so that it can keep the old storage alive for
+        // pending draw calls instead of waiting for them, and write the first copy.
+        MemoryStats::remove(MemoryStats::GPU_BUFFERS, _vertexBufferCapacity * vertexSize + _indexBufferCapacity * _indexSize);
+        GLStateCache::bindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
+        GL_ASSERT( glBufferData(GL_ARRAY_BUFFER, vertexBufferCapacity * vertexSize, NULL, GL_STREAM_DRAW) );
+        _vertexBufferCapacity = vertexBufferCapacity;
+        if (_indexed)
+        {
+            GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer);
+            GL_ASSERT( glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBufferCapacity * _indexSize, NULL, GL_STREAM_DRAW) );
+            _indexBufferCapacity = indexBufferCapacity;
+        }
+        MemoryStats::add(MemoryStats::GPU_BUFFERS, _vertexBufferCapacity * vertexSize + _indexBufferCapacity * _indexSize);
+
+        for (size_t i = 0, count = _subBatches.size(); i < count; ++i)
+        {
+            SubBatch* s = _subBatches[i];
+            if (s->vertexCount == 0)
+                continue;
+
+            GLStateCache::bindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
+            GL_ASSERT( glBufferSubData(GL_ARRAY_BUFFER, s->vertexBufferOffset * vertexSize, s->vertexCount * vertexSize, s->vertices) );
+            RenderStats::add(RenderStats::BUFFER_UPLOADS);
+            if (_indexed && s->indexCount > 0)
+            {
+                GL_ASSERT( glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, s->indexBufferOffset * _indexSize, s->indexCount * _indexSize, s->indices) );
+                RenderStats::add(RenderStats::BUFFER_UPLOADS);
+            }
+        }
+    }
+
+    GLStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
-void MeshBatch::add(const float* vertices, unsigned int vertexCount, const unsigned short* indices, unsigned int indexCount)
+void MeshBatch::deleteBuffers()
 {
-    add(vertices, sizeof(float), vertexCount, indices, indexCount);
+    if (_vertexBuffer)
+    {
+        GLStateCache::deleteBuffers(1, &_vertexBuffer);
+        _vertexBuffer = 0;
+    }
+    if (_indexBuffer)
+    {
+        GLStateCache::deleteBuffers(1, &_indexBuffer);
+        _indexBuffer = 0;
+    }
+    MemoryStats::remove(MemoryStats::GPU_BUFFERS, _vertexBufferCapacity * _vertexFormat.getVertexSize() + _indexBufferCapacity * _indexSize);
+    _vertexBufferCapacity = 0;
+    _indexBufferCapacity = 0;
 }
-    
+
 void MeshBatch::start()
 {
+    for (size_t i = 0, count = _subBatches.size(); i < count; ++i)
+    {
+        _subBatches[i]->vertexCount = 0;
+        _subBatches[i]->indexCount = 0;
+    }
+    _currentSubBatch = 0;
     _vertexCount = 0;
     _indexCount = 0;
-    _verticesPtr = _vertices;
-    _indicesPtr = _indices;
 }
 
 void MeshBatch::finish()
 {
+    updateBuffers();
 }
 
 void MeshBatch::draw()
@@ -239,15 +595,14 @@ void MeshBatch::draw()
     if (_vertexCount == 0 || (_indexed && _indexCount == 0))
         return; // nothing to draw
 
-    // Not using VBOs, so unbind the element array buffer.
-    // ARRAY_BUFFER will be unbound automatically during pass->bind().
-    GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0 ) );
-
-    GP_ASSERT(_material);
-    if (_indexed)
-        GP_ASSERT(_indices);
+    // Client-side arrays are drawn with the element array buffer unbound.
+    if (!_streaming)
+    {
+        GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
 
     // Bind the material.
+    GP_ASSERT(_material);
     Technique* technique = _material->getTechnique();
     GP_ASSERT(technique);
     unsigned int passCount = technique->getPassCount();
@@ -255,20 +610,52 @@ void MeshBatch::draw()
     {
         Pass* pass = technique->getPassByIndex(i);
         GP_ASSERT(pass);
+        unsigned int passIndex = (unsigned int)(std::find(_passes.begin(), _passes.end(), pass) - _passes.begin());
         pass->bind();
 
-        if (_indexed)
+        // Draw every sub-batch with its own vertex attribute binding.
+        for (size_t j = 0, count = _subBatches.size(); j < count; ++j)
         {
-            GL_ASSERT( glDrawElements(_primitiveType, _indexCount, GL_UNSIGNED_SHORT, (GLvoid*)_indices) );
-        }
-        else
-        {
-            GL_ASSERT( glDrawArrays(_primitiveType, 0, _vertexCount) );
+            SubBatch* s = _subBatches[j];
+            if (s->vertexCount == 0 || (_indexed && s->indexCount == 0))
+                continue;
+
+            VertexAttributeBinding* b = getVertexAttributeBinding(s, passIndex);
+            GP_ASSERT(b);
+            b->bind();
+
+            if (_indexed)
+            {
+                if (_streaming)
+                {
+                    // Bound after the vertex attribute binding so that it is recorded in its vertex array object.
+                    unsigned int firstIndex = s->indexBufferOffset + _bufferCopy * s->indexCapacity;
+                    GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer);
+                    GL_ASSERT( glDrawElements(_primitiveType, s->indexCount, _indexFormat, (GLvoid*)(firstIndex * _indexSize)) );
+                    RenderStats::addDraw(_primitiveType, s->indexCount);
+                }
+                else
+                {
+                    GL_ASSERT( glDrawElements(_primitiveType, s->indexCount, _indexFormat, (GLvoid*)s->indices) );
+                    RenderStats::addDraw(_primitiveType, s->indexCount);
+                }
+            }
+            else
+            {
+                GL_ASSERT( glDrawArrays(_primitiveType, 0, s->vertexCount) );
+                RenderStats::addDraw(_primitiveType, s->vertexCount);
+            }
+
+            b->unbind();
         }
 
         pass->unbind();
     }
+
+    if (_streaming && _indexed)
+    {
+        GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
 }
-    
 
 }
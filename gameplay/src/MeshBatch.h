@@ -7,9 +7,18 @@ namespace gameplay
 {
 
 class Material;
+class Pass;
+class VertexAttributeBinding;
 
 /**
  * Defines a class for rendering multiple mesh into a single draw call on the graphics device.
+ *
+ * The primitives of a batch are stored in one or more sub-batches. When the batch grows,
+ * a new sub-batch is added instead of reallocating and copying the existing ones. Each
+ * sub-batch is drawn with its own draw call; when the batch is streamed, all sub-batches
+ * are stored in the same vertex and index buffers. Indices are relative to the first
+ * vertex of their sub-batch, so a batch with 16-bit indices is only limited to 65536
+ * vertices per sub-batch, not in total.
  */
 class MeshBatch
 {
@@ -24,11 +33,13 @@ public:
      * @param indexed True if the batched primitives will contain index data, false otherwise.
      * @param initialCapacity The initial capacity of the batch, in triangles.
      * @param growSize Amount to grow the batch by when it overflows (a value of zero prevents batch growing).
+     * @param indexFormat The format of the indices of the batch (INDEX16 or INDEX32).
      *
      * @return A new mesh batch.
      * @script{create}
      */
-    static MeshBatch* create(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, const char* materialPath, bool indexed, unsigned int initialCapacity = 1024, unsigned int growSize = 1024);
+    static MeshBatch* create(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, const char* materialPath, bool indexed, unsigned int initialCapacity = 1024, unsigned int growSize = 1024,
+                             Mesh::IndexFormat indexFormat = Mesh::INDEX16);
 
     /**
      * Creates a new mesh batch.
@@ -39,11 +50,13 @@ public:
      * @param indexed True if the batched primitives will contain index data, false otherwise.
      * @param initialCapacity The initial capacity of the batch, in triangles.
      * @param growSize Amount to grow the batch by when it overflows (a value of zero prevents batch growing).
+     * @param indexFormat The format of the indices of the batch (INDEX16 or INDEX32).
      *
      * @return A new mesh batch.
      * @script{create}
      */
-    static MeshBatch* create(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, Material* material, bool indexed, unsigned int initialCapacity = 1024, unsigned int growSize = 1024);
+    static MeshBatch* create(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, Material* material, bool indexed, unsigned int initialCapacity = 1024, unsigned int growSize = 1024,
+                             Mesh::IndexFormat indexFormat = Mesh::INDEX16);
 
     /**
      * Destructor.
@@ -60,10 +73,31 @@ public:
     /**
      * Explicitly sets a new capacity for the batch.
      *
+     * Increasing the capacity adds sub-batches and keeps the primitives in the batch.
+     * Decreasing the capacity replaces all sub-batches with a single one and clears the batch.
+     *
      * @param capacity The new batch capacity.
      */
     void setCapacity(unsigned int capacity);
 
+    /**
+     * Returns the format of the indices of the batch.
+     *
+     * Batches with 32-bit indices can hold more than 65536 vertices in a single sub-batch,
+     * which allows primitives with that many vertices to be added in a single call to add().
+     * They are only supported on OpenGL ES when GL_OES_element_index_uint is available.
+     *
+     * @return The index format.
+     */
+    Mesh::IndexFormat getIndexFormat() const;
+
+    /**
+     * Returns the number of sub-batches that the primitives of the batch are stored in.
+     *
+     * @return The number of sub-batches.
+     */
+    unsigned int getSubBatchCount() const;
+
     /**
      * Returns the material for this mesh batch.
      *
@@ -71,6 +105,29 @@ public:
      */
     inline Material* getMaterial() const;
 
+    /**
+     * Sets whether the batch streams its primitives to the graphics device through vertex buffers.
+     *
+     * When streaming is enabled (the default), finish() copies the primitives of the batch
+     * into vertex and index buffers that are used as rings: every batch is written after
+     * the previous one, through unsynchronized buffer mapping where it is supported, and the
+     * buffers are orphaned when they are full. The driver therefore never waits for draw
+     * calls that still use earlier batches and does not copy vertices when drawing.
+     *
+     * When streaming is disabled, the primitives are drawn from client-side arrays, which
+     * requires the driver to copy them for every draw call.
+     *
+     * @param streaming True to stream primitives through vertex buffers, false to use client-side arrays.
+     */
+    void setStreaming(bool streaming);
+
+    /**
+     * Determines whether the batch streams its primitives through vertex buffers.
+     *
+     * @return True if primitives are streamed through vertex buffers, false if client-side arrays are used.
+     */
+    bool isStreaming() const;
+
     /**
      * Adds a group of primitives to the batch.
      *
@@ -114,6 +171,36 @@ public:
      */
     void add(const float* vertices, unsigned int vertexCount, const unsigned short* indices = NULL, unsigned int indexCount = 0);
 
+    /**
+     * Adds a group of primitives with 32-bit indices to the batch.
+     *
+     * This behaves like the add() method that takes 16-bit indices. The indices are converted
+     * to the index format of the batch, so a batch with 16-bit indices can only accept groups
+     * of up to 65536 vertices.
+     *
+     * @param vertices Array of vertices.
+     * @param vertexCount Number of vertices.
+     * @param indices Array of indices into the vertex array.
+     * @param indexCount Number of indices.
+     */
+    template <class T>
+    void add(const T* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+
+    /**
+     * Adds a group of primitives with 32-bit indices to the batch.
+     *
+     * This behaves like the add() method that takes 16-bit indices. The indices are converted
+     * to the index format of the batch, so a batch with 16-bit indices can only accept groups
+     * of up to 65536 vertices.
+     *
+     * @param vertices Array of vertices.
+     * @param vertexCount Number of vertices.
+     * @param indices Array of indices into the vertex array.
+     * @param indexCount Number of indices.
+     * @script{ignore}
+     */
+    void add(const float* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+
     /**
      * Starts batching.
      *
@@ -141,7 +228,25 @@ private:
     /**
      * Constructor.
      */
-    MeshBatch(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, Material* material, bool indexed, unsigned int initialCapacity, unsigned int growSize);
+    MeshBatch(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, Material* material, bool indexed, unsigned int initialCapacity, unsigned int growSize,
+              Mesh::IndexFormat indexFormat);
+
+    /**
+     * A part of the batch with its own vertex and index storage.
+     */
+    struct SubBatch
+    {
+        unsigned int capacity;
+        unsigned int vertexCapacity;
+        unsigned int indexCapacity;
+        unsigned int vertexCount;
+        unsigned int indexCount;
+        unsigned int vertexBufferOffset;    // The first vertex of the sub-batch's region of the vertex buffer.
+        unsigned int indexBufferOffset;     // The first index of the sub-batch's region of the index buffer.
+        unsigned char* vertices;
+        unsigned char* indices;             // Relative to the first vertex of the sub-batch.
+        std::vector<VertexAttributeBinding*> bindings;  // Per buffer copy and pass, created when first drawn.
+    };
 
     /**
      * Hidden copy constructor.
@@ -153,26 +258,52 @@ private:
      */
     MeshBatch& operator=(const MeshBatch&);
 
-    void add(const void* vertices, size_t size, unsigned int vertexCount, const unsigned short* indices, unsigned int indexCount);
+    void add(const void* vertices, size_t size, unsigned int vertexCount, const void* indices, Mesh::IndexFormat indexFormat, unsigned int indexCount);
+
+    unsigned int getVertexCapacity(unsigned int capacity) const;
+
+    unsigned int getSubBatchCapacityMax() const;
+
+    bool addSubBatch(unsigned int capacity);
+
+    bool fits(const SubBatch* subBatch, unsigned int vertexCount, unsigned int indexCount) const;
 
-    void updateVertexAttributeBinding();
+    VertexAttributeBinding* getVertexAttributeBinding(SubBatch* subBatch, unsigned int passIndex);
+
+    void deleteSubBatches();
+
+    void deleteVertexAttributeBindings();
 
     bool resize(unsigned int capacity);
 
+    void createBuffers();
+
+    void updateBuffers();
+
+    void deleteBuffers();
+
     const VertexFormat _vertexFormat;
     Mesh::PrimitiveType _primitiveType;
     Material* _material;
     bool _indexed;
+    Mesh::IndexFormat _indexFormat;
+    unsigned int _indexSize;
     unsigned int _capacity;
     unsigned int _growSize;
     unsigned int _vertexCapacity;
     unsigned int _indexCapacity;
     unsigned int _vertexCount;
     unsigned int _indexCount;
-    unsigned char* _vertices;
-    unsigned char* _verticesPtr;
-    unsigned short* _indices;
-    unsigned short* _indicesPtr;
+    std::vector<SubBatch*> _subBatches;
+    unsigned int _currentSubBatch;
+    std::vector<Pass*> _passes;
+    bool _streaming;
+    VertexBufferHandle _vertexBuffer;
+    IndexBufferHandle _indexBuffer;
+    unsigned int _vertexBufferCapacity;
+    unsigned int _indexBufferCapacity;
+    unsigned int _bufferCopies;
+    unsigned int _bufferCopy;
 
 };
 
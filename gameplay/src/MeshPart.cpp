@@ -1,20 +1,30 @@
 #include "Base.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include "MemoryStats.h"
 #include "MeshPart.h"
 
 namespace gameplay
 {
 
 MeshPart::MeshPart() :
-    _mesh(NULL), _meshIndex(0), _primitiveType(Mesh::TRIANGLES), _indexCount(0), _indexBuffer(0), _dynamic(false)
+    _mesh(NULL), _meshIndex(0), _primitiveType(Mesh::TRIANGLES), _indexCount(0), _indexBuffer(0), _indexStart(0), _sharedBuffer(false), _dynamic(false), _indexData(NULL),
+    _ring(NULL)
 {
 }
 
 MeshPart::~MeshPart()
 {
-    if (_indexBuffer)
+    releaseIndices();
+
+    // The index buffer shared by the parts of a mesh is deleted by the mesh.
+    if (_indexBuffer && !_sharedBuffer)
     {
-        glDeleteBuffers(1, &_indexBuffer);
+        GLStateCache::deleteBuffers(1, &_indexBuffer);
+        MemoryStats::remove(MemoryStats::GPU_BUFFERS, getIndexSize() * _indexCount * (_ring ? _ring->copies : 1));
     }
+    SAFE_DELETE(_ring);
 }
 
 MeshPart* MeshPart::create(Mesh* mesh, unsigned int meshIndex, Mesh::PrimitiveType primitiveType,
@@ -23,7 +33,7 @@ MeshPart* MeshPart::create(Mesh* mesh, unsigned int meshIndex, Mesh::PrimitiveTy
     // Create a VBO for our index buffer.
     GLuint vbo;
     GL_ASSERT( glGenBuffers(1, &vbo) );
-    GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo) );
+    GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo);
 
     unsigned int indexSize = 0;
     switch (indexFormat)
@@ -39,11 +49,12 @@ MeshPart* MeshPart::create(Mesh* mesh, unsigned int meshIndex, Mesh::PrimitiveTy
         break;
     default:
         GP_ERROR("Unsupported index format (%d).", indexFormat);
-        glDeleteBuffers(1, &vbo);
+        GLStateCache::deleteBuffers(1, &vbo);
         return NULL;
     }
 
     GL_ASSERT( glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexSize * indexCount, NULL, dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW) );
+    MemoryStats::add(MemoryStats::GPU_BUFFERS, indexSize * indexCount);
 
     MeshPart* part = new MeshPart();
     part->_mesh = mesh;
@@ -82,6 +93,11 @@ IndexBufferHandle MeshPart::getIndexBuffer() const
     return _indexBuffer;
 }
 
+unsigned int MeshPart::getIndexOffset() const
+{
+    return (_indexStart + (_ring ? _ring->current * _indexCount : 0)) * getIndexSize();
+}
+
 bool MeshPart::isDynamic() const
 {
     return _dynamic;
@@ -89,7 +105,23 @@ bool MeshPart::isDynamic() const
 
 void MeshPart::setIndexData(const void* indexData, unsigned int indexStart, unsigned int indexCount)
 {
-    GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer) );
+    GP_PROFILE("MeshPart::setIndexData");
+
+    if (_ring)
+    {
+        // The data is written to the next copy of the buffer when the mesh is drawn.
+        GP_ASSERT(indexData);
+        if (indexCount == 0)
+            indexCount = _indexCount - indexStart;
+        _ring->write(indexData, indexStart, indexCount);
+
+        GP_ASSERT(_mesh);
+        if (_mesh->getDataResidency() == Mesh::DATA_POSITIONS)
+            copyIndices(indexData, indexStart, indexCount);
+        return;
+    }
+
+    GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer);
 
     unsigned int indexSize = 0;
     switch (_indexFormat)
@@ -108,9 +140,10 @@ void MeshPart::setIndexData(const void* indexData, unsigned int indexStart, unsi
         return;
     }
 
-    if (indexStart == 0 && indexCount == 0)
+    if (indexStart == 0 && indexCount == 0 && !_sharedBuffer)
     {
         GL_ASSERT( glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexSize * _indexCount, indexData, _dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW) );
+        RenderStats::add(RenderStats::BUFFER_UPLOADS);
     }
     else
     {
@@ -119,7 +152,66 @@ void MeshPart::setIndexData(const void* indexData, unsigned int indexStart, unsi
             indexCount = _indexCount - indexStart;
         }
 
-        GL_ASSERT( glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indexStart * indexSize, indexCount * indexSize, indexData) );
+        // The indices of a part that shares the index buffer of its mesh start at the offset of the part.
+        GL_ASSERT( glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, (_indexStart + indexStart) * indexSize, indexCount * indexSize, indexData) );
+        RenderStats::add(RenderStats::BUFFER_UPLOADS);
+    }
+
+    GP_ASSERT(_mesh);
+    if (_mesh->getDataResidency() == Mesh::DATA_POSITIONS)
+        copyIndices(indexData, indexStart, indexCount == 0 ? _indexCount - indexStart : indexCount);
+}
+
+const void* MeshPart::getIndexData() const
+{
+    return _indexData;
+}
+
+unsigned int MeshPart::getIndexSize() const
+{
+    return _indexFormat == Mesh::INDEX32 ? 4 : (_indexFormat == Mesh::INDEX16 ? 2 : 1);
+}
+
+void MeshPart::copyIndices(const void* indexData, unsigned int indexStart, unsigned int indexCount)
+{
+    if (indexData == NULL)
+        return;
+
+    unsigned int indexSize = getIndexSize();
+    if (_indexData == NULL)
+    {
+        _indexData = new unsigned char[indexSize * _indexCount];
+        memset(_indexData, 0, indexSize * _indexCount);
+        MemoryStats::add(MemoryStats::MESH, indexSize * _indexCount);
+    }
+    memcpy(_indexData + indexStart * indexSize, indexData, indexCount * indexSize);
+}
+
+void MeshPart::setBufferCount(unsigned int count)
+{
+    GP_ASSERT(_dynamic && !_sharedBuffer);
+
+    const unsigned int copies = _ring ? _ring->copies : 1;
+    if (count == copies)
+        return;
+
+    const unsigned int indexSize = getIndexSize();
+    MemoryStats::remove(MemoryStats::GPU_BUFFERS, indexSize * _indexCount * copies);
+    SAFE_DELETE(_ring);
+    GLStateCache::bindVertexArray(0);
+    GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer);
+    GL_ASSERT( glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexSize * _indexCount * count, NULL, GL_DYNAMIC_DRAW) );
+    MemoryStats::add(MemoryStats::GPU_BUFFERS, indexSize * _indexCount * count);
+    if (count > 1)
+        _ring = new Mesh::BufferRing(count, _indexCount, indexSize);
+}
+
+void MeshPart::releaseIndices()
+{
+    if (_indexData)
+    {
+        MemoryStats::remove(MemoryStats::MESH, getIndexSize() * _indexCount);
+        SAFE_DELETE_ARRAY(_indexData);
     }
 }
 
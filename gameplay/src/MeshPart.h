@@ -57,6 +57,18 @@ public:
      */
     IndexBufferHandle getIndexBuffer() const;
 
+    /**
+     * Returns the offset of the indices of the part in its index buffer, which is not 0
+     * when the parts of the mesh share an index buffer (see Mesh::createIndexBuffer), or
+     * the buffer has several copies of the indices (see Mesh::setBufferCount).
+     *
+     * This is the offset that is passed to glDrawElements to draw the part.
+     *
+     * @return The offset of the indices, in bytes.
+     * @script{ignore}
+     */
+    unsigned int getIndexOffset() const;
+
     /**
      * Determines if the indices are dynamic.
      *
@@ -66,6 +78,8 @@ public:
 
     /**
      * Sets the specified index data into the mapped index buffer.
+     * When the buffer has several copies, the data is written to the next copy when the
+     * mesh is drawn (see Mesh::setBufferCount).
      *
      * @param indexData The index data to be set.
      * @param indexStart The index to start from.
@@ -74,6 +88,15 @@ public:
      */
     void setIndexData(const void* indexData, unsigned int indexStart, unsigned int indexCount);
 
+    /**
+     * Returns the indices kept in CPU memory, when the data residency of the mesh
+     * is Mesh::DATA_POSITIONS.
+     *
+     * @return The indices (in the index format of the part), or NULL if they are not kept.
+     * @script{ignore}
+     */
+    const void* getIndexData() const;
+
 private:
 
     /**
@@ -98,13 +121,37 @@ private:
      */
     static MeshPart* create(Mesh* mesh, unsigned int meshIndex, Mesh::PrimitiveType primitiveType, Mesh::IndexFormat indexFormat, unsigned int indexCount, bool dynamic = false);
 
+    /**
+     * Returns the size of an index, in bytes.
+     */
+    unsigned int getIndexSize() const;
+
+    /**
+     * Copies the given range of indices into the indices kept in CPU memory.
+     */
+    void copyIndices(const void* indexData, unsigned int indexStart, unsigned int indexCount);
+
+    /**
+     * Releases the indices kept in CPU memory.
+     */
+    void releaseIndices();
+
+    /**
+     * Sets the number of copies of the index buffer of a dynamic part (see Mesh::setBufferCount).
+     */
+    void setBufferCount(unsigned int count);
+
     Mesh* _mesh;
     unsigned int _meshIndex;
     Mesh::PrimitiveType _primitiveType;
     Mesh::IndexFormat _indexFormat;
     unsigned int _indexCount;
     IndexBufferHandle _indexBuffer;
+    unsigned int _indexStart;
+    bool _sharedBuffer;
     bool _dynamic;
+    unsigned char* _indexData;
+    Mesh::BufferRing* _ring;
 };
 
 }
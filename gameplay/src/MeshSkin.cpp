@@ -1,23 +1,48 @@
 #include "Base.h"
 #include "MeshSkin.h"
 #include "Joint.h"
+#include "MathUtil.h"
+#include "Mesh.h"
+#include "Effect.h"
+#include "VertexAttributeBinding.h"
+#include "RenderStats.h"
+#include "Node.h"
 
 // The number of rows in each palette matrix.
 #define PALETTE_ROWS 3
 
+// The number of Vector4s of each dual quaternion in the palette (real and dual parts).
+#define DUAL_QUATERNION_ROWS 2
+
 namespace gameplay
 {
 
 MeshSkin::MeshSkin()
-    : _rootJoint(NULL), _rootNode(NULL), _matrixPalette(NULL), _model(NULL)
+    : _rootJoint(NULL), _rootNode(NULL), _matrixPalette(NULL), _dualQuaternionPalette(NULL),
+      _bindMatrices(NULL), _jointRevisions(NULL), _bindPoseRevisions(NULL), _dualQuaternionRevisions(NULL), _model(NULL),
+      _paletteRevision(0), _cacheEnabled(false), _skeleton(NULL), _pose(NULL), _poseMatrices(NULL), _poseDirty(false)
 {
 }
 
 MeshSkin::~MeshSkin()
 {
     clearJoints();
+    clearCaches();
+
+    for (size_t i = 0, count = _attachments.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_attachments[i].second);
+    }
+    SAFE_RELEASE(_skeleton);
+    SAFE_DELETE_ARRAY(_pose);
+    SAFE_DELETE_ARRAY(_poseMatrices);
 
     SAFE_DELETE_ARRAY(_matrixPalette);
+    SAFE_DELETE_ARRAY(_dualQuaternionPalette);
+    SAFE_DELETE_ARRAY(_bindMatrices);
+    SAFE_DELETE_ARRAY(_jointRevisions);
+    SAFE_DELETE_ARRAY(_bindPoseRevisions);
+    SAFE_DELETE_ARRAY(_dualQuaternionRevisions);
 }
 
 const Matrix& MeshSkin::getBindShape() const
@@ -28,15 +53,27 @@ const Matrix& MeshSkin::getBindShape() const
 void MeshSkin::setBindShape(const float* matrix)
 {
     _bindShape.set(matrix);
+    if (_pose == NULL)
+        SAFE_RELEASE(_skeleton);
+
+    // Recompute the bind matrices and the palette of every joint.
+    for (size_t i = 0, count = _joints.size(); i < count; ++i)
+    {
+        _jointRevisions[i] = 0;
+        _bindPoseRevisions[i] = 0;
+        _dualQuaternionRevisions[i] = 0;
+    }
 }
 
 unsigned int MeshSkin::getJointCount() const
 {
-    return (unsigned int)_joints.size();
+    return _pose ? _skeleton->getJointCount() : (unsigned int)_joints.size();
 }
 
 Joint* MeshSkin::getJoint(unsigned int index) const
 {
+    if (_pose)
+        return NULL;
     GP_ASSERT(index < _joints.size());
     return _joints[index];
 }
@@ -59,8 +96,13 @@ Joint* MeshSkin::getJoint(const char* id) const
 
 MeshSkin* MeshSkin::clone(NodeCloneContext &context) const
 {
+    // A skin without joints can only be cloned into another skin that shares its skeleton.
+    if (_pose || (context.isSkeletonShared() && getSkeleton()))
+        return cloneShared();
+
     MeshSkin* skin = new MeshSkin();
     skin->_bindShape = _bindShape;
+    skin->_cacheEnabled = _cacheEnabled;
     if (_rootNode && _rootJoint)
     {
         const unsigned int jointCount = getJointCount();
@@ -79,14 +121,15 @@ MeshSkin* MeshSkin::clone(NodeCloneContext &context) const
             skin->_rootNode = _rootNode->cloneRecursive(context);
         }
         
-        Node* node = NULL;
-        if (strcmp(skin->_rootNode->getId(), _rootJoint->getId()) == 0)
-        {
-            node = skin->_rootNode;
-        }
-        else
+        // The joints were cloned with the root node, so they are found in the context rather
+        // than by searching the hierarchy for their IDs.
+        Node* node = context.findClonedNode(_rootJoint);
+        if (!node)
         {
-            node = skin->_rootNode->findNode(_rootJoint->getId());
+            if (strcmp(skin->_rootNode->getId(), _rootJoint->getId()) == 0)
+                node = skin->_rootNode;
+            else
+                node = skin->_rootNode->findNode(_rootJoint->getId());
         }
         GP_ASSERT(node);
         skin->_rootJoint = static_cast<Joint*>(node);
@@ -95,7 +138,9 @@ MeshSkin* MeshSkin::clone(NodeCloneContext &context) const
             Joint* oldJoint = getJoint(i);
             GP_ASSERT(oldJoint);
             
-            Joint* newJoint = static_cast<Joint*>(skin->_rootNode->findNode(oldJoint->getId()));
+            Joint* newJoint = static_cast<Joint*>(context.findClonedNode(oldJoint));
+            if (!newJoint)
+                newJoint = static_cast<Joint*>(skin->_rootNode->findNode(oldJoint->getId()));
             if (!newJoint)
             {
                 if (strcmp(skin->_rootJoint->getId(), oldJoint->getId()) == 0)
@@ -112,6 +157,10 @@ void MeshSkin::setJointCount(unsigned int jointCount)
 {
     // Erase the joints vector and release all joints.
     clearJoints();
+    SAFE_RELEASE(_skeleton);
+
+    // The skinning effects of the caches are made for the size of the palette.
+    clearCaches();
 
     // Resize the joints vector and initialize to NULL.
     _joints.resize(jointCount);
@@ -119,9 +168,18 @@ void MeshSkin::setJointCount(unsigned int jointCount)
     {
         _joints[i] = NULL;
     }
+    allocatePalette(jointCount);
+}
 
+void MeshSkin::allocatePalette(unsigned int jointCount)
+{
     // Rebuild the matrix palette. Each matrix is 3 rows of Vector4.
     SAFE_DELETE_ARRAY(_matrixPalette);
+    SAFE_DELETE_ARRAY(_dualQuaternionPalette);
+    SAFE_DELETE_ARRAY(_bindMatrices);
+    SAFE_DELETE_ARRAY(_jointRevisions);
+    SAFE_DELETE_ARRAY(_bindPoseRevisions);
+    SAFE_DELETE_ARRAY(_dualQuaternionRevisions);
 
     if (jointCount > 0)
     {
@@ -132,6 +190,23 @@ void MeshSkin::setJointCount(unsigned int jointCount)
             _matrixPalette[i+1].set(0.0f, 1.0f, 0.0f, 0.0f);
             _matrixPalette[i+2].set(0.0f, 0.0f, 1.0f, 0.0f);
         }
+
+        // Each dual quaternion is its real (rotation) part followed by its dual (translation) part.
+        _dualQuaternionPalette = new Vector4[jointCount * DUAL_QUATERNION_ROWS];
+        for (unsigned int i = 0; i < jointCount * DUAL_QUATERNION_ROWS; i+=DUAL_QUATERNION_ROWS)
+        {
+            _dualQuaternionPalette[i+0].set(0.0f, 0.0f, 0.0f, 1.0f);
+            _dualQuaternionPalette[i+1].set(0.0f, 0.0f, 0.0f, 0.0f);
+        }
+
+        // Joint revisions start at 1, so a revision of 0 forces an update.
+        _bindMatrices = new float[jointCount * 16];
+        _jointRevisions = new unsigned int[jointCount];
+        _bindPoseRevisions = new unsigned int[jointCount];
+        memset(_jointRevisions, 0, sizeof(unsigned int) * jointCount);
+        memset(_bindPoseRevisions, 0, sizeof(unsigned int) * jointCount);
+        _dualQuaternionRevisions = new unsigned int[jointCount];
+        memset(_dualQuaternionRevisions, 0, sizeof(unsigned int) * jointCount);
     }
 }
 
@@ -146,6 +221,10 @@ void MeshSkin::setJoint(Joint* joint, unsigned int index)
     }
 
     _joints[index] = joint;
+    SAFE_RELEASE(_skeleton);
+    _jointRevisions[index] = 0;
+    _bindPoseRevisions[index] = 0;
+    _dualQuaternionRevisions[index] = 0;
 
     if (joint)
     {
@@ -158,17 +237,81 @@ Vector4* MeshSkin::getMatrixPalette() const
 {
     GP_ASSERT(_matrixPalette);
 
+    if (_pose)
+    {
+        evaluatePose();
+        return _matrixPalette;
+    }
+
+    float* palette = &_matrixPalette[0].x;
+    bool changed = false;
     for (size_t i = 0, count = _joints.size(); i < count; i++)
     {
-        GP_ASSERT(_joints[i]);
-        _joints[i]->updateJointMatrix(getBindShape(), &_matrixPalette[i * PALETTE_ROWS]);
+        Joint* joint = _joints[i];
+        GP_ASSERT(joint);
+
+        // Skip joints that have not moved since the palette was last updated.
+        if (_jointRevisions[i] == joint->_revision)
+            continue;
+
+        float* bindMatrix = &_bindMatrices[i * 16];
+        if (_bindPoseRevisions[i] != joint->_bindPoseRevision)
+        {
+            MathUtil::multiplyMatrix(joint->getInverseBindPose().m, _bindShape.m, bindMatrix);
+            _bindPoseRevisions[i] = joint->_bindPoseRevision;
+        }
+
+        // palette = (world * inverseBindPose * bindShape), first three rows.
+        MathUtil::multiplyMatrixPalette(joint->getWorldMatrix().m, bindMatrix, palette + i * PALETTE_ROWS * 4);
+        _jointRevisions[i] = joint->_revision;
+        changed = true;
     }
+    if (changed)
+        ++_paletteRevision;
     return _matrixPalette;
 }
 
 unsigned int MeshSkin::getMatrixPaletteSize() const
 {
-    return (unsigned int)_joints.size() * PALETTE_ROWS;
+    return getJointCount() * PALETTE_ROWS;
+}
+
+Vector4* MeshSkin::getDualQuaternionPalette() const
+{
+    GP_ASSERT(_dualQuaternionPalette);
+
+    // The dual quaternions are converted from the rows of the matrix palette.
+    const Vector4* matrixPalette = getMatrixPalette();
+    for (unsigned int i = 0, count = getJointCount(); i < count; i++)
+    {
+        if (_dualQuaternionRevisions[i] == _jointRevisions[i])
+            continue;
+
+        const Vector4* rows = &matrixPalette[i * PALETTE_ROWS];
+        Matrix m(rows[0].x, rows[0].y, rows[0].z, rows[0].w,
+                 rows[1].x, rows[1].y, rows[1].z, rows[1].w,
+                 rows[2].x, rows[2].y, rows[2].z, rows[2].w,
+                 0.0f, 0.0f, 0.0f, 1.0f);
+
+        // Scale cannot be represented, so it is removed from the rotation.
+        Quaternion real;
+        m.getRotation(&real);
+
+        // dual = 0.5 * translation * real, with the translation as a pure quaternion.
+        Quaternion dual;
+        Quaternion::multiply(Quaternion(rows[0].w, rows[1].w, rows[2].w, 0.0f), real, &dual);
+
+        Vector4* dq = &_dualQuaternionPalette[i * DUAL_QUATERNION_ROWS];
+        dq[0].set(real.x, real.y, real.z, real.w);
+        dq[1].set(dual.x * 0.5f, dual.y * 0.5f, dual.z * 0.5f, dual.w * 0.5f);
+        _dualQuaternionRevisions[i] = _jointRevisions[i];
+    }
+    return _dualQuaternionPalette;
+}
+
+unsigned int MeshSkin::getDualQuaternionPaletteSize() const
+{
+    return getJointCount() * DUAL_QUATERNION_ROWS;
 }
 
 Model* MeshSkin::getModel() const
@@ -257,6 +400,182 @@ void MeshSkin::setRootNode(Node* node)
         {
             _rootNode->addRef();
         }
+        ++Node::_hierarchyRevision;
+    }
+}
+
+Skeleton* MeshSkin::getSkeleton() const
+{
+    if (_skeleton == NULL && !_joints.empty())
+        _skeleton = Skeleton::create(this);
+    return _skeleton;
+}
+
+bool MeshSkin::isSkeletonShared() const
+{
+    return _pose != NULL;
+}
+
+MeshSkin* MeshSkin::cloneShared() const
+{
+    Skeleton* skeleton = getSkeleton();
+    GP_ASSERT(skeleton);
+
+    MeshSkin* skin = new MeshSkin();
+    skin->_bindShape = _bindShape;
+    skin->_cacheEnabled = _cacheEnabled;
+    skin->_skeleton = skeleton;
+    skeleton->addRef();
+
+    const unsigned int jointCount = skeleton->getJointCount();
+    skin->allocatePalette(jointCount);
+    skin->_pose = new Skeleton::JointTransform[jointCount];
+    skin->_poseMatrices = new Matrix[jointCount];
+    skin->copyPose(this);
+    return skin;
+}
+
+void MeshSkin::setJointTransform(unsigned int index, const Vector3& scale, const Quaternion& rotation, const Vector3& translation)
+{
+    GP_ASSERT(_pose);
+    GP_ASSERT(index < _skeleton->getJointCount());
+
+    Skeleton::JointTransform& transform = _pose[index];
+    transform.scale = scale;
+    transform.rotation = rotation;
+    transform.translation = translation;
+    _poseDirty = true;
+}
+
+const Skeleton::JointTransform& MeshSkin::getJointTransform(unsigned int index) const
+{
+    GP_ASSERT(_pose);
+    GP_ASSERT(index < _skeleton->getJointCount());
+
+    return _pose[index];
+}
+
+void MeshSkin::copyPose(const MeshSkin* source)
+{
+    GP_ASSERT(source);
+    if (_pose == NULL)
+    {
+        GP_WARN("Only the pose of a skin that shares a skeleton can be copied.");
+        return;
+    }
+    const unsigned int jointCount = _skeleton->getJointCount();
+    if (source->getJointCount() != jointCount)
+    {
+        GP_WARN("Cannot copy the pose of a skin with %u joints to a skin with %u joints.", source->getJointCount(), jointCount);
+        return;
+    }
+
+    if (source->_pose)
+    {
+        std::copy(source->_pose, source->_pose + jointCount, _pose);
+    }
+    else
+    {
+        for (unsigned int i = 0; i < jointCount; ++i)
+            _skeleton->getLocalTransform(source, i, &_pose[i]);
+    }
+    _poseDirty = true;
+}
+
+void MeshSkin::updatePose()
+{
+    evaluatePose();
+}
+
+void MeshSkin::evaluatePose() const
+{
+    if (_pose == NULL || !_poseDirty)
+        return;
+    _poseDirty = false;
+
+    // Parents come first in the order of the skeleton, so their matrices are up to date.
+    const std::vector<unsigned int>& order = _skeleton->_order;
+    const std::vector<Skeleton::JointDefinition>& joints = _skeleton->_joints;
+    float* palette = &_matrixPalette[0].x;
+    Matrix local;
+    for (size_t k = 0, count = order.size(); k < count; ++k)
+    {
+        const unsigned int i = order[k];
+        const Skeleton::JointTransform& transform = _pose[i];
+        Matrix::createRotation(transform.rotation, &local);
+        local.m[0] *= transform.scale.x; local.m[1] *= transform.scale.x; local.m[2] *= transform.scale.x;
+        local.m[4] *= transform.scale.y; local.m[5] *= transform.scale.y; local.m[6] *= transform.scale.y;
+        local.m[8] *= transform.scale.z; local.m[9] *= transform.scale.z; local.m[10] *= transform.scale.z;
+        local.m[12] = transform.translation.x;
+        local.m[13] = transform.translation.y;
+        local.m[14] = transform.translation.z;
+
+        const int parent = joints[i].parent;
+        Matrix::multiply(parent >= 0 ? _poseMatrices[parent] : _skeleton->_rootMatrix, local, &_poseMatrices[i]);
+        MathUtil::multiplyMatrixPalette(_poseMatrices[i].m, &_skeleton->_bindMatrices[i * 16], palette + i * PALETTE_ROWS * 4);
+    }
+
+    // The whole palette changed, so every dual quaternion is converted again.
+    ++_paletteRevision;
+    for (size_t i = 0, count = order.size(); i < count; ++i)
+        _jointRevisions[i] = _paletteRevision;
+
+    Vector3 scale;
+    Quaternion rotation;
+    Vector3 translation;
+    for (size_t i = 0, count = _attachments.size(); i < count; ++i)
+    {
+        _poseMatrices[_attachments[i].first].decompose(&scale, &rotation, &translation);
+        _attachments[i].second->set(scale, rotation, translation);
+    }
+}
+
+const Matrix& MeshSkin::getJointMatrix(unsigned int index) const
+{
+    if (_pose == NULL)
+    {
+        GP_ASSERT(index < _joints.size() && _joints[index]);
+        return _joints[index]->getWorldMatrix();
+    }
+
+    GP_ASSERT(index < _skeleton->getJointCount());
+    evaluatePose();
+    return _poseMatrices[index];
+}
+
+Node* MeshSkin::createAttachment(const char* jointId)
+{
+    GP_ASSERT(jointId);
+    if (_pose == NULL)
+        return NULL;
+    int index = _skeleton->getJointIndex(jointId);
+    if (index < 0)
+        return NULL;
+
+    Node* node = Node::create(jointId);
+    node->addRef();
+    _attachments.push_back(std::make_pair((unsigned int)index, node));
+
+    // The node is placed at the joint right away, rather than at the next update of the pose.
+    evaluatePose();
+    Vector3 scale;
+    Quaternion rotation;
+    Vector3 translation;
+    _poseMatrices[index].decompose(&scale, &rotation, &translation);
+    node->set(scale, rotation, translation);
+    return node;
+}
+
+void MeshSkin::removeAttachment(Node* node)
+{
+    for (std::vector<std::pair<unsigned int, Node*> >::iterator itr = _attachments.begin(); itr != _attachments.end(); ++itr)
+    {
+        if (itr->second == node)
+        {
+            SAFE_RELEASE(itr->second);
+            _attachments.erase(itr);
+            return;
+        }
     }
 }
 
@@ -270,5 +589,277 @@ void MeshSkin::clearJoints()
     }
     _joints.clear();
 }
+bool MeshSkin::isCacheSupported()
+{
+#if defined(USE_TRANSFORM_FEEDBACK) && defined(__glew_h__)
+    return GLEW_VERSION_3_0 ? true : false;
+#else
+    return false;
+#endif
+}
+
+void MeshSkin::setCacheEnabled(bool enabled)
+{
+    if (enabled && !isCacheSupported())
+    {
+        GP_WARN("Skinned vertices cannot be cached, since transform feedback is not supported.");
+        enabled = false;
+    }
+
+    _cacheEnabled = enabled;
+    if (!_cacheEnabled)
+    {
+        clearCaches();
+    }
+}
+
+bool MeshSkin::isCacheEnabled() const
+{
+    return _cacheEnabled;
+}
+
+/**
+ * Returns the GLSL type of a vertex element with the specified number of values.
+ */
+static const char* getShaderType(unsigned int size)
+{
+    switch (size)
+    {
+    case 1:
+        return "float";
+    case 2:
+        return "vec2";
+    case 3:
+        return "vec3";
+    default:
+        return "vec4";
+    }
+}
+
+/**
+ * Returns the name of the vertex attribute of a vertex element in shaders.
+ */
+static std::string getAttributeName(VertexFormat::Usage usage)
+{
+    switch (usage)
+    {
+    case VertexFormat::POSITION:
+        return VERTEX_ATTRIBUTE_POSITION_NAME;
+    case VertexFormat::NORMAL:
+        return VERTEX_ATTRIBUTE_NORMAL_NAME;
+    case VertexFormat::COLOR:
+        return VERTEX_ATTRIBUTE_COLOR_NAME;
+    case VertexFormat::TANGENT:
+        return VERTEX_ATTRIBUTE_TANGENT_NAME;
+    case VertexFormat::BINORMAL:
+        return VERTEX_ATTRIBUTE_BINORMAL_NAME;
+    case VertexFormat::BLENDWEIGHTS:
+        return VERTEX_ATTRIBUTE_BLENDWEIGHTS_NAME;
+    case VertexFormat::BLENDINDICES:
+        return VERTEX_ATTRIBUTE_BLENDINDICES_NAME;
+    case VertexFormat::TEXCOORD0:
+        return VERTEX_ATTRIBUTE_TEXCOORD_PREFIX_NAME;
+    default:
+        {
+            std::string name = VERTEX_ATTRIBUTE_TEXCOORD_PREFIX_NAME;
+            name += (char)('0' + (usage - VertexFormat::TEXCOORD0));
+            return name;
+        }
+    }
+}
+
+MeshSkin::Cache* MeshSkin::createCache(Mesh* mesh)
+{
+    GP_ASSERT(mesh);
+
+    // The skinned vertices keep every element of the mesh but the blend weights and indices.
+    const VertexFormat& format = mesh->getVertexFormat();
+    std::vector<VertexFormat::Element> elements;
+    unsigned int weightCount = 4;
+    bool hasWeights = false;
+    bool hasIndices = false;
+    for (unsigned int i = 0, count = format.getElementCount(); i < count; ++i)
+    {
+        const VertexFormat::Element& e = format.getElement(i);
+        if (e.usage == VertexFormat::BLENDWEIGHTS || e.usage == VertexFormat::BLENDINDICES)
+        {
+            weightCount = std::min(weightCount, e.size);
+            hasWeights |= e.usage == VertexFormat::BLENDWEIGHTS;
+            hasIndices |= e.usage == VertexFormat::BLENDINDICES;
+        }
+        else
+        {
+            // Transform feedback writes floats, whatever the type of the source values.
+            elements.push_back(VertexFormat::Element(e.usage, e.size));
+        }
+    }
+    if (!hasWeights || !hasIndices || elements.empty())
+    {
+        GP_WARN("Mesh '%s' has no blend weights and indices to skin into a cache.", mesh->getUrl());
+        return NULL;
+    }
+
+    // Generate a vertex shader that skins positions, normals, tangents and binormals,
+    // and copies the other elements, into varyings laid out like the skinned vertices.
+    std::ostringstream vsh;
+    std::ostringstream body;
+    std::vector<std::string> varyings;
+    vsh << "attribute vec4 " VERTEX_ATTRIBUTE_BLENDWEIGHTS_NAME ";\n";
+    vsh << "attribute vec4 " VERTEX_ATTRIBUTE_BLENDINDICES_NAME ";\n";
+    vsh << "uniform vec4 u_matrixPalette[" << getMatrixPaletteSize() << "];\n";
+    body << "void main()\n{\n";
+    body << "    vec4 row0 = vec4(0.0);\n    vec4 row1 = vec4(0.0);\n    vec4 row2 = vec4(0.0);\n    int index;\n";
+    for (unsigned int i = 0; i < weightCount; ++i)
+    {
+        const char component = "xyzw"[i];
+        body << "    index = int(" VERTEX_ATTRIBUTE_BLENDINDICES_NAME "." << component << ") * 3;\n";
+        body << "    row0 += " VERTEX_ATTRIBUTE_BLENDWEIGHTS_NAME "." << component << " * u_matrixPalette[index];\n";
+        body << "    row1 += " VERTEX_ATTRIBUTE_BLENDWEIGHTS_NAME "." << component << " * u_matrixPalette[index + 1];\n";
+        body << "    row2 += " VERTEX_ATTRIBUTE_BLENDWEIGHTS_NAME "." << component << " * u_matrixPalette[index + 2];\n";
+    }
+    for (size_t i = 0; i < elements.size(); ++i)
+    {
+        const VertexFormat::Element& e = elements[i];
+        std::string attribute = getAttributeName(e.usage);
+        std::string varying = "v_" + attribute.substr(2);
+        varyings.push_back(varying);
+        vsh << "varying " << getShaderType(e.size) << " " << varying << ";\n";
+
+        if (e.usage == VertexFormat::POSITION)
+        {
+            static const char* swizzles[] = { ".x", ".xy", ".xyz", "" };
+            vsh << "attribute vec4 " << attribute << ";\n";
+            body << "    " << varying << " = vec4(dot(" << attribute << ", row0), dot(" << attribute << ", row1), dot(" << attribute << ", row2), "
+                 << attribute << ".w)" << swizzles[std::min(e.size, 4u) - 1] << ";\n";
+        }
+        else if (e.size == 3 && (e.usage == VertexFormat::NORMAL || e.usage == VertexFormat::TANGENT || e.usage == VertexFormat::BINORMAL))
+        {
+            vsh << "attribute vec3 " << attribute << ";\n";
+            body << "    " << varying << " = vec3(dot(" << attribute << ", row0.xyz), dot(" << attribute << ", row1.xyz), dot(" << attribute << ", row2.xyz));\n";
+        }
+        else
+        {
+            vsh << "attribute " << getShaderType(e.size) << " " << attribute << ";\n";
+            body << "    " << varying << " = " << attribute << ";\n";
+        }
+    }
+    body << "    gl_Position = vec4(0.0);\n}\n";
+    vsh << body.str();
+
+    // Nothing is rasterized, so the fragment shader only has to link.
+    const char* fsh = "void main()\n{\n    gl_FragColor = vec4(0.0);\n}\n";
+
+    std::vector<const char*> names;
+    for (size_t i = 0; i < varyings.size(); ++i)
+    {
+        names.push_back(varyings[i].c_str());
+    }
+    std::string source = vsh.str();
+    Effect* effect = Effect::createFromSource(NULL, source.c_str(), NULL, fsh, NULL, &names[0], (unsigned int)names.size());
+    if (effect == NULL)
+    {
+        GP_WARN("Failed to create the effect that skins mesh '%s' into a cache.", mesh->getUrl());
+        return NULL;
+    }
+
+    Cache* cache = new Cache();
+    cache->mesh = mesh;
+    mesh->addRef();
+    cache->skinnedMesh = Mesh::createMesh(VertexFormat(&elements[0], (unsigned int)elements.size()), mesh->getVertexCount(), true);
+    cache->effect = effect;
+    cache->binding = VertexAttributeBinding::create(mesh, effect);
+    cache->paletteRevision = 0;
+    cache->skinned = false;
+    return cache;
+}
+
+MeshSkin::Cache* MeshSkin::updateCache(Mesh* mesh)
+{
+    GP_ASSERT(mesh);
+
+    Cache* cache = NULL;
+    for (size_t i = 0, count = _caches.size(); i < count; ++i)
+    {
+        if (_caches[i]->mesh == mesh)
+        {
+            cache = _caches[i];
+            break;
+        }
+    }
+    if (cache == NULL)
+    {
+        cache = createCache(mesh);
+        if (cache == NULL)
+        {
+            // Draw the mesh as it is rather than failing on every frame.
+            _cacheEnabled = false;
+            return NULL;
+        }
+        _caches.push_back(cache);
+    }
+
+    // Updating the palette tells whether the joints have moved since the vertices were skinned.
+    getMatrixPalette();
+    if (cache->skinned && cache->paletteRevision == _paletteRevision)
+        return cache;
+
+#ifdef USE_TRANSFORM_FEEDBACK
+    Effect* effect = cache->effect;
+    effect->bind();
+    Uniform* uniform = effect->getUniform("u_matrixPalette");
+    if (uniform)
+        effect->setValue(uniform, _matrixPalette, getMatrixPaletteSize());
+    cache->binding->bind();
+
+    // Run the vertex shader over every vertex once, capturing its varyings without drawing.
+    GL_ASSERT( glEnable(GL_RASTERIZER_DISCARD) );
+    GL_ASSERT( glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, cache->skinnedMesh->getVertexBuffer()) );
+    GL_ASSERT( glBeginTransformFeedback(GL_POINTS) );
+    GL_ASSERT( glDrawArrays(GL_POINTS, 0, mesh->getVertexCount()) );
+    GL_ASSERT( glEndTransformFeedback() );
+    GL_ASSERT( glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0) );
+    GL_ASSERT( glDisable(GL_RASTERIZER_DISCARD) );
+    RenderStats::addDraw(GL_POINTS, mesh->getVertexCount());
+
+    cache->binding->unbind();
+#endif
+
+    cache->paletteRevision = _paletteRevision;
+    cache->skinned = true;
+    return cache;
+}
+
+VertexAttributeBinding* MeshSkin::getCacheBinding(Cache* cache, Effect* effect)
+{
+    GP_ASSERT(cache);
+    GP_ASSERT(effect);
+
+    // Bindings keep a reference to their effect, so the effect cannot be replaced by another at the same address.
+    std::map<Effect*, VertexAttributeBinding*>::const_iterator itr = cache->bindings.find(effect);
+    if (itr != cache->bindings.end())
+        return itr->second;
+
+    VertexAttributeBinding* binding = VertexAttributeBinding::create(cache->skinnedMesh, effect);
+    cache->bindings[effect] = binding;
+    return binding;
+}
+
+void MeshSkin::clearCaches()
+{
+    for (size_t i = 0, count = _caches.size(); i < count; ++i)
+    {
+        Cache* cache = _caches[i];
+        for (std::map<Effect*, VertexAttributeBinding*>::iterator itr = cache->bindings.begin(); itr != cache->bindings.end(); ++itr)
+        {
+            SAFE_RELEASE(itr->second);
+        }
+        SAFE_RELEASE(cache->binding);
+        SAFE_RELEASE(cache->effect);
+        SAFE_RELEASE(cache->skinnedMesh);
+        SAFE_RELEASE(cache->mesh);
+        SAFE_DELETE(cache);
+    }
+    _caches.clear();
+}
 
 }
@@ -3,14 +3,18 @@
 
 #include "Matrix.h"
 #include "Transform.h"
+#include "Skeleton.h"
 
 namespace gameplay
 {
 
 class Bundle;
+class Effect;
+class Mesh;
 class Model;
 class Joint;
 class Node;
+class VertexAttributeBinding;
 
 /**
  * Represents the skin for a mesh.
@@ -19,6 +23,7 @@ class MeshSkin : public Transform::Listener
 {
     friend class Bundle;
     friend class Model;
+    friend class BakedAnimation;
     friend class Joint;
     friend class Node;
     friend class Scene;
@@ -49,7 +54,7 @@ public:
      * 
      * @param index The index.
      * 
-     * @return The joint.
+     * @return The joint, or NULL if the skin shares a skeleton and has no joints.
      */
     Joint* getJoint(unsigned int index) const;
 
@@ -101,6 +106,28 @@ public:
      */
     unsigned int getMatrixPaletteSize() const;
 
+    /**
+     * Returns the pointer to the Vector4 array of the dual quaternion palette for the
+     * purpose of binding to a shader.
+     *
+     * Each joint is represented by 2 Vector4s rather than the 3 rows of its palette matrix,
+     * so more joints fit in the uniforms of a single draw. Dual quaternions represent
+     * rotations and translations only, so the scale of joints is ignored. The palette is
+     * bound with the DUAL_QUATERNION_PALETTE auto-binding, and is skinned by the built-in
+     * shaders when SKINNING_DUAL_QUATERNION is defined along with SKINNING.
+     *
+     * @return The pointer to the dual quaternion palette.
+     */
+    Vector4* getDualQuaternionPalette() const;
+
+    /**
+     * Returns the number of elements in the dual quaternion palette array.
+     * Each dual quaternion is represented by 2 Vector4s, its real part and its dual part.
+     *
+     * @return The dual quaternion palette size.
+     */
+    unsigned int getDualQuaternionPaletteSize() const;
+
     /**
      * Returns our parent Model.
      */
@@ -111,8 +138,154 @@ public:
      */
     void transformChanged(Transform* transform, long cookie);
 
+    /**
+     * Returns the skeleton the skins cloned with shared skeletons share with this skin.
+     *
+     * For a skin with joints, the skeleton is created from its joints the first time it is
+     * requested, and is created again if the joints are changed.
+     *
+     * @return The skeleton, or NULL if the skin has no joints.
+     * @script{ignore}
+     */
+    Skeleton* getSkeleton() const;
+
+    /**
+     * Determines whether the skin poses a shared skeleton rather than joints of its own.
+     *
+     * Such skins are cloned by Node::cloneInstances() with shared skeletons. They hold the
+     * local transform of each joint in an array, which animations do not target: the pose
+     * is set with setJointTransform(), or copied from an animated skin with copyPose().
+     *
+     * @return True if the skin shares a skeleton.
+     * @script{ignore}
+     */
+    bool isSkeletonShared() const;
+
+    /**
+     * Sets the local transform of a joint of a skin that shares a skeleton.
+     *
+     * @param index The index of the joint.
+     * @param scale The scale of the joint.
+     * @param rotation The rotation of the joint.
+     * @param translation The translation of the joint.
+     * @see Skeleton
+     * @script{ignore}
+     */
+    void setJointTransform(unsigned int index, const Vector3& scale, const Quaternion& rotation, const Vector3& translation);
+
+    /**
+     * Returns the local transform of a joint of a skin that shares a skeleton.
+     *
+     * @param index The index of the joint.
+     *
+     * @return The transform of the joint.
+     * @script{ignore}
+     */
+    const Skeleton::JointTransform& getJointTransform(unsigned int index) const;
+
+    /**
+     * Copies the pose of another skin with the same skeleton into a skin that shares a skeleton.
+     *
+     * The source is typically the animated skin the instances were cloned from, or another
+     * instance, so a crowd follows the animations of a few skins with joints.
+     *
+     * @param source The skin to copy the transforms of the joints from.
+     * @script{ignore}
+     */
+    void copyPose(const MeshSkin* source);
+
+    /**
+     * Computes the matrix palette and moves the attachments of a skin that shares a skeleton
+     * to the pose set since the last update.
+     *
+     * This is done when the palette is bound, so it only needs to be called explicitly for
+     * the attachments to follow the pose before the skin is drawn.
+     * @script{ignore}
+     */
+    void updatePose();
+
+    /**
+     * Returns the matrix of a joint relative to the node of the model, as it transforms the
+     * vertices of the skin.
+     *
+     * @param index The index of the joint.
+     *
+     * @return The matrix of the joint.
+     * @script{ignore}
+     */
+    const Matrix& getJointMatrix(unsigned int index) const;
+
+    /**
+     * Creates a node that follows a joint of a skin that shares a skeleton, such as to attach
+     * a weapon to the hand of a character.
+     *
+     * The transform of the node is set to the matrix of the joint whenever the pose is
+     * updated, so the node is added as a child of the node of the model. Skins with joints
+     * of their own have no attachments, since nodes are attached to their joints instead.
+     *
+     * @param jointId The ID of the joint to follow.
+     *
+     * @return The new node, or NULL if the skin does not share a skeleton or has no such joint.
+     * @script{ignore}
+     */
+    Node* createAttachment(const char* jointId);
+
+    /**
+     * Stops moving a node created by createAttachment().
+     *
+     * @param node The attached node.
+     * @script{ignore}
+     */
+    void removeAttachment(Node* node);
+
+    /**
+     * Determines whether skinned vertices can be cached on the current device.
+     *
+     * Caching requires transform feedback, which is part of OpenGL 3.0.
+     *
+     * @return True if setCacheEnabled() can be used.
+     */
+    static bool isCacheSupported();
+
+    /**
+     * Sets whether the vertices of the mesh are skinned into a cache before the model is drawn.
+     *
+     * By default every pass of a skinned model skins its vertices again in its vertex shader.
+     * When the cache is enabled, the model skins its vertices once into a vertex buffer when
+     * the joints have moved, and every pass draws that buffer as static geometry. The passes
+     * of the materials of the model must then use effects without the SKINNING define and
+     * without a u_matrixPalette parameter.
+     *
+     * Frame packets do not draw from the cache, so models added to a FramePacket should not
+     * enable it.
+     *
+     * @param enabled True to cache the skinned vertices, if isCacheSupported().
+     */
+    void setCacheEnabled(bool enabled);
+
+    /**
+     * Determines whether the skinned vertices are cached.
+     *
+     * @return True if the skinned vertices are cached.
+     */
+    bool isCacheEnabled() const;
+
 private:
 
+    /**
+     * The skinned vertices of a mesh, with the bindings of the effects that draw them.
+     */
+    struct Cache
+    {
+        Mesh* mesh;
+        Mesh* skinnedMesh;
+        Effect* effect;
+        VertexAttributeBinding* binding;
+        std::map<Effect*, VertexAttributeBinding*> bindings;
+        unsigned int paletteRevision;
+        bool skinned;
+    };
+
     /**
      * Constructor.
      */
@@ -142,6 +315,21 @@ private:
      */
     MeshSkin* clone(NodeCloneContext &context) const;
 
+    /**
+     * Creates a skin that shares the skeleton of this skin, in its current pose.
+     */
+    MeshSkin* cloneShared() const;
+
+    /**
+     * Allocates the palettes and the per-joint arrays used to update them.
+     */
+    void allocatePalette(unsigned int jointCount);
+
+    /**
+     * Computes the joint matrices and the palette of a skin that shares a skeleton, if its pose changed.
+     */
+    void evaluatePose() const;
+
     /**
      * Sets the number of joints that can be stored in this skin.
      * This method allocates the necessary memory.
@@ -170,6 +358,30 @@ private:
      */
     void clearJoints();
 
+    /**
+     * Skins the vertices of a mesh into its cache, if the joints have moved since they were last skinned.
+     *
+     * @param mesh The mesh of the model, or of one of its levels of detail.
+     *
+     * @return The cache of the mesh, or NULL if it could not be created.
+     */
+    Cache* updateCache(Mesh* mesh);
+
+    /**
+     * Returns the binding of the skinned vertices of a cache to an effect.
+     */
+    VertexAttributeBinding* getCacheBinding(Cache* cache, Effect* effect);
+
+    /**
+     * Creates the cache of a mesh, with the effect that skins its vertices.
+     */
+    Cache* createCache(Mesh* mesh);
+
+    /**
+     * Releases the caches of all meshes.
+     */
+    void clearCaches();
+
     Matrix _bindShape;
     std::vector<Joint*> _joints;
     Joint* _rootJoint;
@@ -184,7 +396,37 @@ private:
     // Each 4x3 row-wise matrix is represented as 3 Vector4's.
     // The number of Vector4's is (_joints.size() * 3).
     Vector4* _matrixPalette;
+
+    // Pointer to the array of dual quaternions, 2 Vector4's per joint, converted from
+    // the matrix palette when it is requested.
+    Vector4* _dualQuaternionPalette;
+
+    // Per-joint data used to update the matrix palette, stored in flat arrays
+    // indexed by joint so that the update loop walks memory linearly.
+    // _bindMatrices holds the column-major product of each joint's inverse
+    // bind pose and the bind shape (16 floats per joint), which only changes
+    // when either of them changes. The revision arrays hold the joint revisions
+    // that the palette and the bind matrices were last computed from.
+    float* _bindMatrices;
+    unsigned int* _jointRevisions;
+    unsigned int* _bindPoseRevisions;
+    unsigned int* _dualQuaternionRevisions;
     Model* _model;
+
+    // Incremented whenever the palette changes, so that caches skin only when the joints move.
+    mutable unsigned int _paletteRevision;
+    std::vector<Cache*> _caches;
+    bool _cacheEnabled;
+
+    // The skeleton created from the joints of this skin, or shared with the skin it was cloned from.
+    mutable Skeleton* _skeleton;
+
+    // The local transforms and the matrices of the joints of a skin that shares a skeleton,
+    // and the nodes that follow them. Skins with joints have no pose.
+    Skeleton::JointTransform* _pose;
+    Matrix* _poseMatrices;
+    mutable bool _poseDirty;
+    std::vector<std::pair<unsigned int, Node*> > _attachments;
 };
 
 }
@@ -1,16 +1,27 @@
 #include "Base.h"
+#include "GLStateCache.h"
+#include "RenderStats.h"
 #include "Model.h"
 #include "MeshPart.h"
 #include "Scene.h"
 #include "Technique.h"
 #include "Pass.h"
 #include "Node.h"
+#include "Camera.h"
+#include "Game.h"
+#include "Impostor.h"
+
+// The fraction by which the screen size of a node must go back over the threshold of
+// a level it crossed before a finer level is selected again, so levels do not flicker.
+#define LOD_HYSTERESIS 0.1f
 
 namespace gameplay
 {
 
 Model::Model(Mesh* mesh) :
-    _mesh(mesh), _material(NULL), _partCount(0), _partMaterials(NULL), _node(NULL), _skin(NULL)
+    _mesh(mesh), _material(NULL), _partCount(0), _partMaterials(NULL), _node(NULL), _skin(NULL),
+    _lod(0), _fadeLod(0), _fadeStartTime(0.0), _fadeTime(0.0f), _impostor(NULL), _impostorScreenSize(0.0f),
+    _impostorActive(false)
 {
     GP_ASSERT(mesh);
     _partCount = mesh->getPartCount();
@@ -29,6 +40,9 @@ Model::~Model()
         SAFE_DELETE_ARRAY(_partMaterials);
     }
 
+    clearLods();
+    SAFE_RELEASE(_impostor);
+
     SAFE_RELEASE(_mesh);
 
     SAFE_DELETE(_skin);
@@ -224,6 +238,9 @@ void Model::setSkin(MeshSkin* skin)
         _skin = skin;
         if (_skin)
             _skin->_model = this;
+
+        // The joints of the skin are part of the hierarchy of the model's node.
+        ++Node::_hierarchyRevision;
     }
 }
 
@@ -289,6 +306,7 @@ static bool drawWireframe(Mesh* mesh)
 static bool drawWireframe(MeshPart* part)
 {
     unsigned int indexCount = part->getIndexCount();
+    unsigned int indexOffset = part->getIndexOffset();
     unsigned int indexSize = 0;
     switch (part->getIndexFormat())
     {
@@ -312,7 +330,7 @@ static bool drawWireframe(MeshPart* part)
         {
             for (unsigned int i = 0; i < indexCount; i += 3)
             {
-                GL_ASSERT( glDrawElements(GL_LINE_LOOP, 3, part->getIndexFormat(), ((const GLvoid*)(i*indexSize))) );
+                GL_ASSERT( glDrawElements(GL_LINE_LOOP, 3, part->getIndexFormat(), ((const GLvoid*)(indexOffset + i*indexSize))) );
             }
         }
         return true;
@@ -321,7 +339,7 @@ static bool drawWireframe(MeshPart* part)
         {
             for (unsigned int i = 2; i < indexCount; ++i)
             {
-                GL_ASSERT( glDrawElements(GL_LINE_LOOP, 3, part->getIndexFormat(), ((const GLvoid*)((i-2)*indexSize))) );
+                GL_ASSERT( glDrawElements(GL_LINE_LOOP, 3, part->getIndexFormat(), ((const GLvoid*)(indexOffset + (i-2)*indexSize))) );
             }
         }
         return true;
@@ -336,58 +354,279 @@ void Model::draw(bool wireframe)
 {
     GP_ASSERT(_mesh);
 
-    unsigned int partCount = _mesh->getPartCount();
-    if (partCount == 0)
+    if (_impostor)
     {
-        // No mesh parts (index buffers).
-        if (_material)
+        float size = getScreenSize(NULL);
+        float threshold = _impostorScreenSize;
+        if (_impostorActive)
+            threshold *= 1.0f + LOD_HYSTERESIS;
+        _impostorActive = size >= 0.0f && size < threshold;
+        if (_impostorActive)
         {
-            Technique* technique = _material->getTechnique();
-            GP_ASSERT(technique);
-            unsigned int passCount = technique->getPassCount();
-            for (unsigned int i = 0; i < passCount; ++i)
-            {
-                Pass* pass = technique->getPassByIndex(i);
-                GP_ASSERT(pass);
-                pass->bind();
-                GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
-                if (!wireframe || !drawWireframe(_mesh))
-                {
-                    GL_ASSERT( glDrawArrays(_mesh->getPrimitiveType(), 0, _mesh->getVertexCount()) );
-                }
-                pass->unbind();
-            }
+            _impostor->addInstance(_node);
+            return;
+        }
+    }
+
+    if (_lods.empty())
+    {
+        drawLod(0, 0.0f, wireframe);
+        return;
+    }
+
+    updateLod();
+    if (_fadeLod != _lod)
+    {
+        float t = (float)(Game::getAbsoluteTime() - _fadeStartTime) / _fadeTime;
+        if (t < 1.0f)
+        {
+            // The dither patterns of the two levels are complementary, so together they cover every pixel once.
+            float fade = std::max(t, 0.001f);
+            drawLod(_lod, fade, wireframe);
+            drawLod(_fadeLod, -fade, wireframe);
+            return;
+        }
+        _fadeLod = _lod;
+    }
+    drawLod(_lod, 0.0f, wireframe);
+}
+
+void Model::drawLod(unsigned int lod, float fade, bool wireframe)
+{
+    Mesh* mesh = getLodMesh(lod);
+    GP_ASSERT(mesh);
+
+    // A cached skin is skinned once here, and every pass then draws its vertices as they are.
+    MeshSkin::Cache* skinCache = _skin && _skin->isCacheEnabled() ? _skin->updateCache(mesh) : NULL;
+
+    // Meshes without parts (index buffers) are drawn once, with the shared material.
+    unsigned int partCount = mesh->getPartCount();
+    for (unsigned int i = 0, count = std::max(partCount, 1u); i < count; ++i)
+    {
+        MeshPart* part = partCount > 0 ? mesh->getPart(i) : NULL;
+        Material* material = part ? getPartMaterial(i) : _material;
+        if (material == NULL)
+            continue;
+
+        Technique* technique = material->getTechnique();
+        GP_ASSERT(technique);
+        unsigned int passCount = technique->getPassCount();
+        for (unsigned int j = 0; j < passCount; ++j)
+        {
+            Pass* pass = technique->getPassByIndex(j);
+            GP_ASSERT(pass);
+            pass->bind();
+
+            // The bindings of passes are made for the mesh of the model, so other levels and cached skins bind their own.
+            VertexAttributeBinding* binding = NULL;
+            if (skinCache)
+                binding = _skin->getCacheBinding(skinCache, pass->getEffect());
+            else if (lod > 0)
+                binding = getLodBinding(lod, pass);
+            if (binding)
+                binding->bind();
+
+            Uniform* fadeUniform = fade != 0.0f ? pass->getEffect()->getUniform("u_lodFade") : NULL;
+            if (fadeUniform)
+                pass->getEffect()->setValue(fadeUniform, fade);
+
+            drawPart(mesh, part, wireframe);
+
+            if (fadeUniform)
+                pass->getEffect()->setValue(fadeUniform, 0.0f);
+            if (binding)
+                binding->unbind();
+            pass->unbind();
+        }
+    }
+}
+
+void Model::drawPart(MeshPart* part, bool wireframe)
+{
+    drawPart(getLodMesh(_lod), part, wireframe);
+}
+
+void Model::drawPart(Mesh* mesh, MeshPart* part, bool wireframe)
+{
+    GP_ASSERT(mesh);
+
+    if (part == NULL)
+    {
+        GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        if (!wireframe || !drawWireframe(mesh))
+        {
+            GL_ASSERT( glDrawArrays(mesh->getPrimitiveType(), 0, mesh->getVertexCount()) );
+            RenderStats::addDraw(mesh->getPrimitiveType(), mesh->getVertexCount());
         }
     }
     else
     {
-        for (unsigned int i = 0; i < partCount; ++i)
+        // Parts that share the index buffer of their mesh only bind it once, through the state cache.
+        GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, part->_indexBuffer);
+        if (!wireframe || !drawWireframe(part))
         {
-            MeshPart* part = _mesh->getPart(i);
-            GP_ASSERT(part);
+            GL_ASSERT( glDrawElements(part->getPrimitiveType(), part->getIndexCount(), part->getIndexFormat(), (const GLvoid*)part->getIndexOffset()) );
+            RenderStats::addDraw(part->getPrimitiveType(), part->getIndexCount());
+        }
+    }
+}
 
-            // Get the material for this mesh part.
-            Material* material = getMaterial(i);
-            if (material)
-            {
-                Technique* technique = material->getTechnique();
-                GP_ASSERT(technique);
-                unsigned int passCount = technique->getPassCount();
-                for (unsigned int j = 0; j < passCount; ++j)
-                {
-                    Pass* pass = technique->getPassByIndex(j);
-                    GP_ASSERT(pass);
-                    pass->bind();
-                    GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, part->_indexBuffer) );
-                    if (!wireframe || !drawWireframe(part))
-                    {
-                        GL_ASSERT( glDrawElements(part->getPrimitiveType(), part->getIndexCount(), part->getIndexFormat(), 0) );
-                    }
-                    pass->unbind();
-                }
-            }
+void Model::addLod(Mesh* mesh, float screenSize)
+{
+    GP_ASSERT(mesh);
+    GP_ASSERT(mesh != _mesh);
+
+    Lod* level = new Lod();
+    level->mesh = mesh;
+    level->screenSize = std::max(std::min(screenSize, 1.0f), 0.0f);
+    mesh->addRef();
+
+    std::vector<Lod*>::iterator itr = _lods.begin();
+    while (itr != _lods.end() && (*itr)->screenSize >= level->screenSize)
+        ++itr;
+    _lods.insert(itr, level);
+    _lod = _fadeLod = 0;
+}
+
+void Model::clearLods()
+{
+    for (size_t i = 0, count = _lods.size(); i < count; ++i)
+    {
+        Lod* level = _lods[i];
+        for (std::map<Effect*, VertexAttributeBinding*>::iterator itr = level->bindings.begin(); itr != level->bindings.end(); ++itr)
+        {
+            SAFE_RELEASE(itr->second);
         }
+        SAFE_RELEASE(level->mesh);
+        SAFE_DELETE(level);
     }
+    _lods.clear();
+    _lod = _fadeLod = 0;
+}
+
+unsigned int Model::getLodCount() const
+{
+    return (unsigned int)_lods.size() + 1;
+}
+
+Mesh* Model::getLodMesh(unsigned int lod) const
+{
+    GP_ASSERT(lod <= _lods.size());
+    return lod == 0 ? _mesh : _lods[lod - 1]->mesh;
+}
+
+float Model::getLodScreenSize(unsigned int lod) const
+{
+    GP_ASSERT(lod <= _lods.size());
+    return lod == 0 ? 1.0f : _lods[lod - 1]->screenSize;
+}
+
+unsigned int Model::getLod() const
+{
+    return _lod;
+}
+
+float Model::getScreenSize(Camera* camera) const
+{
+    if (_node == NULL)
+        return -1.0f;
+
+    if (camera == NULL && _node->getScene())
+        camera = _node->getScene()->getActiveCamera();
+    if (camera == NULL)
+        return -1.0f;
+
+    BoundingSphere bounds(_mesh->getBoundingSphere());
+    bounds.transform(_node->getWorldMatrix());
+    float size = bounds.radius * camera->getProjectionMatrix().m[5];
+    if (camera->getCameraType() == Camera::PERSPECTIVE)
+    {
+        Node* cameraNode = camera->getNode();
+        Vector3 eye = cameraNode ? cameraNode->getTranslationWorld() : Vector3::zero();
+        float distance = eye.distance(bounds.center);
+        size = distance > bounds.radius ? size / distance : 1.0f;
+    }
+    return size;
+}
+
+unsigned int Model::updateLod(Camera* camera)
+{
+    if (_lods.empty())
+        return _lod;
+
+    float size = getScreenSize(camera);
+    if (size < 0.0f)
+        return _lod;
+
+    unsigned int lod = 0;
+    for (unsigned int i = 0, count = (unsigned int)_lods.size(); i < count; ++i)
+    {
+        float threshold = _lods[i]->screenSize;
+        if (i < _lod)
+            threshold *= 1.0f + LOD_HYSTERESIS;
+        if (size >= threshold)
+            break;
+        lod = i + 1;
+    }
+
+    if (lod != _lod)
+    {
+        // A level that changes in the middle of a cross-fade fades from the level that was fully drawn.
+        _fadeLod = _fadeTime > 0.0f ? _lod : lod;
+        _fadeStartTime = Game::getAbsoluteTime();
+        _lod = lod;
+    }
+    return _lod;
+}
+
+void Model::setLodFadeTime(float time)
+{
+    _fadeTime = std::max(time, 0.0f);
+    if (_fadeTime == 0.0f)
+        _fadeLod = _lod;
+}
+
+float Model::getLodFadeTime() const
+{
+    return _fadeTime;
+}
+
+void Model::setImpostor(Impostor* impostor, float screenSize)
+{
+    if (impostor)
+        impostor->addRef();
+    SAFE_RELEASE(_impostor);
+    _impostor = impostor;
+    _impostorScreenSize = screenSize;
+    _impostorActive = false;
+}
+
+Impostor* Model::getImpostor() const
+{
+    return _impostor;
+}
+
+VertexAttributeBinding* Model::getLodBinding(unsigned int lod, Pass* pass)
+{
+    GP_ASSERT(pass);
+    if (lod == 0)
+        return pass->getVertexAttributeBinding();
+
+    // Bindings keep a reference to their effect, so the effect cannot be replaced by another at the same address.
+    Lod* level = _lods[lod - 1];
+    Effect* effect = pass->getEffect();
+    std::map<Effect*, VertexAttributeBinding*>::const_iterator itr = level->bindings.find(effect);
+    if (itr != level->bindings.end())
+        return itr->second;
+
+    VertexAttributeBinding* binding = VertexAttributeBinding::create(level->mesh, effect);
+    level->bindings[effect] = binding;
+    return binding;
+}
+
+Material* Model::getPartMaterial(unsigned int partIndex)
+{
+    return partIndex < _partCount ? getMaterial((int)partIndex) : _material;
 }
 
 void Model::validatePartCount()
@@ -431,6 +670,12 @@ Model* Model::clone(NodeCloneContext &context)
     {
         model->setSkin(getSkin()->clone(context));
     }
+    for (size_t i = 0, count = _lods.size(); i < count; ++i)
+    {
+        model->addLod(_lods[i]->mesh, _lods[i]->screenSize);
+    }
+    model->_fadeTime = _fadeTime;
+    model->setImpostor(_impostor, _impostorScreenSize);
     if (getMaterial())
     {
         Material* materialClone = getMaterial()->clone(context);
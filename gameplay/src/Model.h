@@ -12,17 +12,28 @@ class Bundle;
 class MeshSkin;
 class Node;
 class NodeCloneContext;
+class Camera;
+class Impostor;
 
 /**
  * Defines a Model which is an instance of a Mesh that can be drawn
  * with the specified Materials.
+ *
+ * A model can have levels of detail: lower resolution meshes that are drawn in place
+ * of its mesh when its node covers a small part of the screen (see addLod). Level 0 is
+ * always the mesh of the model. The level is selected every time the model is drawn,
+ * from the bounding sphere of its node and the active camera of the node's scene.
  */
-class Model : public Ref
+class Model : public Ref, public PoolObject<Model>
 {
     friend class Node;
     friend class Scene;
     friend class Mesh;
     friend class Bundle;
+    friend class RenderQueue;
+    friend class FramePacket;
+    friend class TerrainPatch;
+    friend class Impostor;
 
 public:
 
@@ -157,8 +168,131 @@ public:
      */
     void draw(bool wireframe = false);
 
+    /**
+     * Adds a level of detail to this model.
+     *
+     * The mesh is drawn instead of the meshes of the finer levels when the bounding sphere
+     * of the node covers less than the given fraction of the height of the viewport. Levels
+     * are kept sorted by decreasing screen size, so they can be added in any order.
+     *
+     * The mesh must have the same vertex attributes as the mesh of the model, since it is
+     * drawn with the same materials, and either the same number of parts or fewer. Parts
+     * beyond those of the model's mesh are drawn with the shared material.
+     *
+     * @param mesh The mesh of the level.
+     * @param screenSize The fraction of the viewport height below which the level is used, in (0, 1].
+     * @script{ignore}
+     */
+    void addLod(Mesh* mesh, float screenSize);
+
+    /**
+     * Removes all the levels of detail that were added to this model.
+     * @script{ignore}
+     */
+    void clearLods();
+
+    /**
+     * Returns the number of levels of detail, including the mesh of the model.
+     *
+     * @return The number of levels, which is at least 1.
+     * @script{ignore}
+     */
+    unsigned int getLodCount() const;
+
+    /**
+     * Returns the mesh of a level of detail.
+     *
+     * @param lod The level, where 0 is the mesh of the model.
+     *
+     * @return The mesh of the level.
+     * @script{ignore}
+     */
+    Mesh* getLodMesh(unsigned int lod) const;
+
+    /**
+     * Returns the fraction of the viewport height below which a level of detail is used.
+     *
+     * @param lod The level, where 0 is the mesh of the model, whose screen size is 1.
+     *
+     * @return The screen size of the level.
+     * @script{ignore}
+     */
+    float getLodScreenSize(unsigned int lod) const;
+
+    /**
+     * Returns the level of detail that was selected when the model was last drawn.
+     *
+     * @return The current level.
+     * @script{ignore}
+     */
+    unsigned int getLod() const;
+
+    /**
+     * Selects the level of detail for a camera.
+     *
+     * This is called by draw() with the active camera of the node's scene, and only needs
+     * to be called explicitly to select the level before the model is drawn.
+     *
+     * @param camera The camera to select the level for, or NULL for the active camera of the node's scene.
+     *
+     * @return The selected level.
+     * @script{ignore}
+     */
+    unsigned int updateLod(Camera* camera = NULL);
+
+    /**
+     * Sets the time taken to cross-fade between two levels of detail.
+     *
+     * While fading, both levels are drawn and their pixels are discarded with complementary
+     * dither patterns, so no blending or sorting is needed. This requires the shaders of the
+     * materials to be compiled with the LOD_FADE define, which adds the u_lodFade uniform.
+     * A time of 0, the default, switches levels immediately.
+     *
+     * @param time The duration of the cross-fade, in milliseconds.
+     * @script{ignore}
+     */
+    void setLodFadeTime(float time);
+
+    /**
+     * Returns the time taken to cross-fade between two levels of detail.
+     *
+     * @return The duration of the cross-fade, in milliseconds.
+     * @script{ignore}
+     */
+    float getLodFadeTime() const;
+
+    /**
+     * Sets the impostor the model is drawn with when it covers a small part of the screen.
+     *
+     * Below the screen size, draw() queues the node of the model in the impostor instead
+     * of drawing its mesh, and the impostor draws it when Impostor::draw() is called.
+     *
+     * @param impostor The impostor of the model, or NULL to always draw the mesh.
+     * @param screenSize The fraction of the viewport height below which the impostor is used.
+     * @script{ignore}
+     */
+    void setImpostor(Impostor* impostor, float screenSize);
+
+    /**
+     * Returns the impostor the model is drawn with when it covers a small part of the screen.
+     *
+     * @return The impostor, or NULL if the model has none.
+     * @script{ignore}
+     */
+    Impostor* getImpostor() const;
+
 private:
 
+    /**
+     * A level of detail, with the vertex attribute bindings of its mesh for each effect it is drawn with.
+     */
+    struct Lod
+    {
+        Mesh* mesh;
+        float screenSize;
+        std::map<Effect*, VertexAttributeBinding*> bindings;
+    };
+
     /**
      * Constructor.
      */
@@ -188,6 +322,47 @@ private:
 
     void validatePartCount();
 
+    /**
+     * Issues the draw call for the geometry of the specified mesh part.
+     *
+     * The pass used to draw the part must already be bound.
+     *
+     * @param part The mesh part to draw, or NULL to draw the vertices of a mesh without parts.
+     * @param wireframe If true, draw the geometry in wireframe mode.
+     */
+    void drawPart(MeshPart* part, bool wireframe);
+
+    /**
+     * Issues the draw call for the geometry of a mesh part of the specified mesh.
+     */
+    void drawPart(Mesh* mesh, MeshPart* part, bool wireframe);
+
+    /**
+     * Draws the parts of a level of detail with every pass of their materials.
+     *
+     * @param lod The level to draw.
+     * @param fade The value of the u_lodFade uniform, or 0 when the level is not fading.
+     * @param wireframe If true, draw the geometry in wireframe mode.
+     */
+    void drawLod(unsigned int lod, float fade, bool wireframe);
+
+    /**
+     * Returns the vertex attribute binding a pass draws a level of detail with.
+     */
+    VertexAttributeBinding* getLodBinding(unsigned int lod, Pass* pass);
+
+    /**
+     * Returns the material a part of a level of detail is drawn with, which is the shared
+     * material for parts beyond those of the model's mesh.
+     */
+    Material* getPartMaterial(unsigned int partIndex);
+
+    /**
+     * Returns the fraction of the viewport height covered by the bounds of the mesh for a
+     * camera, or -1 if the model has no node or there is no camera.
+     */
+    float getScreenSize(Camera* camera) const;
+
     /**
      * Clones the model and returns a new model.
      * 
@@ -202,6 +377,14 @@ private:
     Material** _partMaterials;
     Node* _node;
     MeshSkin* _skin;
+    std::vector<Lod*> _lods;
+    unsigned int _lod;
+    unsigned int _fadeLod;
+    double _fadeStartTime;
+    float _fadeTime;
+    Impostor* _impostor;
+    float _impostorScreenSize;
+    bool _impostorActive;
 };
 
 }
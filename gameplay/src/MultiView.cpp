@@ -0,0 +1,186 @@
+#include "Base.h"
+#include "MultiView.h"
+#include "Scene.h"
+#include "RenderQueue.h"
+#include "Game.h"
+
+// The most views a multi-view can have, which is the number of bits in a mask of views.
+#define MULTIVIEW_VIEW_COUNT_MAX 32
+
+namespace gameplay
+{
+
+MultiView::MultiView(Scene* scene) : _scene(scene), _maxLights(0)
+{
+    GP_ASSERT(scene);
+    scene->addRef();
+}
+
+MultiView::~MultiView()
+{
+    clearViews();
+    SAFE_RELEASE(_scene);
+}
+
+MultiView* MultiView::create(Scene* scene)
+{
+    return new MultiView(scene);
+}
+
+int MultiView::addView(Camera* camera, const Rectangle& viewport)
+{
+    GP_ASSERT(camera);
+    if (_views.size() >= MULTIVIEW_VIEW_COUNT_MAX)
+    {
+        GP_WARN("A multi-view cannot have more than %d views.", MULTIVIEW_VIEW_COUNT_MAX);
+        return -1;
+    }
+
+    View view;
+    view.camera = camera;
+    view.viewport = viewport;
+    view.queue = RenderQueue::create();
+    camera->addRef();
+    _views.push_back(view);
+    return (int)_views.size() - 1;
+}
+
+void MultiView::clearViews()
+{
+    for (size_t i = 0, count = _views.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_views[i].camera);
+        SAFE_DELETE(_views[i].queue);
+    }
+    _views.clear();
+    _visibleNodes.clear();
+    _visibleMasks.clear();
+}
+
+unsigned int MultiView::getViewCount() const
+{
+    return (unsigned int)_views.size();
+}
+
+Camera* MultiView::getCamera(unsigned int view) const
+{
+    GP_ASSERT(view < _views.size());
+    return _views[view].camera;
+}
+
+void MultiView::setCamera(unsigned int view, Camera* camera)
+{
+    GP_ASSERT(view < _views.size());
+    GP_ASSERT(camera);
+    camera->addRef();
+    SAFE_RELEASE(_views[view].camera);
+    _views[view].camera = camera;
+}
+
+const Rectangle& MultiView::getViewport(unsigned int view) const
+{
+    GP_ASSERT(view < _views.size());
+    return _views[view].viewport;
+}
+
+void MultiView::setViewport(unsigned int view, const Rectangle& viewport)
+{
+    GP_ASSERT(view < _views.size());
+    _views[view].viewport = viewport;
+}
+
+RenderQueue* MultiView::getRenderQueue(unsigned int view) const
+{
+    GP_ASSERT(view < _views.size());
+    return _views[view].queue;
+}
+
+void MultiView::setMaxLights(unsigned int maxLights)
+{
+    _maxLights = maxLights;
+}
+
+void MultiView::cull()
+{
+    unsigned int viewCount = (unsigned int)_views.size();
+    _frusta.resize(viewCount);
+    for (unsigned int i = 0; i < viewCount; ++i)
+    {
+        _frusta[i].set(_views[i].camera->getFrustum());
+    }
+
+    _visibleNodes.clear();
+    _visibleMasks.clear();
+    if (viewCount > 0)
+    {
+        _scene->findVisibleNodes(&_frusta[0], viewCount, _visibleNodes, _visibleMasks);
+    }
+    if (_maxLights > 0)
+    {
+        _scene->assignLights(_visibleNodes, _maxLights);
+    }
+}
+
+const std::vector<Node*>& MultiView::getVisibleNodes() const
+{
+    return _visibleNodes;
+}
+
+unsigned int MultiView::getVisibleNodes(unsigned int view, std::vector<Node*>& nodes) const
+{
+    GP_ASSERT(view < _views.size());
+    unsigned int bit = 1u << view;
+    unsigned int count = 0;
+    for (size_t i = 0, nodeCount = _visibleNodes.size(); i < nodeCount; ++i)
+    {
+        if (_visibleMasks[i] & bit)
+        {
+            nodes.push_back(_visibleNodes[i]);
+            ++count;
+        }
+    }
+    return count;
+}
+
+void MultiView::draw(bool wireframe)
+{
+    Game* game = Game::getInstance();
+    Rectangle viewport = game->getViewport();
+    Camera* activeCamera = _scene->getActiveCamera();
+    if (activeCamera)
+    {
+        activeCamera->addRef();
+    }
+
+    for (unsigned int i = 0, viewCount = (unsigned int)_views.size(); i < viewCount; ++i)
+    {
+        View& view = _views[i];
+        _scene->setActiveCamera(view.camera);
+        game->setViewport(view.viewport);
+
+        // Terrains are drawn by their patches rather than through the queue.
+        unsigned int bit = 1u << i;
+        view.queue->clear();
+        for (size_t n = 0, nodeCount = _visibleNodes.size(); n < nodeCount; ++n)
+        {
+            if (!(_visibleMasks[n] & bit))
+                continue;
+            Node* node = _visibleNodes[n];
+            if (node->getModel())
+            {
+                view.queue->add(node->getModel());
+            }
+            if (node->getTerrain())
+            {
+                node->getTerrain()->draw(wireframe);
+            }
+        }
+        view.queue->draw(wireframe);
+    }
+
+    _scene->setActiveCamera(activeCamera);
+    SAFE_RELEASE(activeCamera);
+    game->setViewport(viewport);
+}
+
+}
@@ -0,0 +1,202 @@
+#ifndef MULTIVIEW_H_
+#define MULTIVIEW_H_
+
+#include "Rectangle.h"
+#include "Frustum.h"
+
+namespace gameplay
+{
+
+class Scene;
+class Camera;
+class Node;
+class RenderQueue;
+
+/**
+ * Defines the drawing of a scene from several cameras, such as for a split screen.
+ *
+ * Drawing a scene once per camera visits and culls the whole scene for each of them.
+ * A multi-view instead culls the scene once against the frusta of all of its views (see
+ * Scene::findVisibleNodes), and assigns lights to the visible nodes once for all of them.
+ * Each view then only filters the shared list of visible nodes by the mask of the views
+ * each node is visible from, and fills and draws a render queue of its own. The queues
+ * are kept from frame to frame, so their storage and their caches of effects are reused.
+ *
+ * Each view is drawn in its own viewport, with its camera set as the active camera of the
+ * scene, so auto-bindings and levels of detail use the camera of the view. The aspect ratio
+ * of each camera should match its viewport.
+ *
+ @verbatim
+    MultiView* views = MultiView::create(scene);
+    views->addView(player1Camera, Rectangle(0, 0, width, height / 2));
+    views->addView(player2Camera, Rectangle(0, height / 2, width, height / 2));
+
+    // In Game::render:
+    views->cull();
+    views->draw();
+ @endverbatim
+ *
+ * @script{ignore}
+ */
+class MultiView
+{
+public:
+
+    /**
+     * Creates a multi-view of a scene, without any view.
+     *
+     * @param scene The scene to draw.
+     *
+     * @return The new multi-view.
+     */
+    static MultiView* create(Scene* scene);
+
+    /**
+     * Destructor.
+     */
+    ~MultiView();
+
+    /**
+     * Adds a view.
+     *
+     * @param camera The camera of the view.
+     * @param viewport The viewport the view is drawn in, in window pixels.
+     *
+     * @return The index of the view, or -1 if the multi-view already has 32 views.
+     */
+    int addView(Camera* camera, const Rectangle& viewport);
+
+    /**
+     * Removes all the views.
+     */
+    void clearViews();
+
+    /**
+     * Returns the number of views.
+     *
+     * @return The number of views.
+     */
+    unsigned int getViewCount() const;
+
+    /**
+     * Returns the camera of a view.
+     *
+     * @param view The index of the view.
+     *
+     * @return The camera of the view.
+     */
+    Camera* getCamera(unsigned int view) const;
+
+    /**
+     * Sets the camera of a view.
+     *
+     * @param view The index of the view.
+     * @param camera The camera of the view.
+     */
+    void setCamera(unsigned int view, Camera* camera);
+
+    /**
+     * Returns the viewport of a view.
+     *
+     * @param view The index of the view.
+     *
+     * @return The viewport of the view, in window pixels.
+     */
+    const Rectangle& getViewport(unsigned int view) const;
+
+    /**
+     * Sets the viewport of a view.
+     *
+     * @param view The index of the view.
+     * @param viewport The viewport of the view, in window pixels.
+     */
+    void setViewport(unsigned int view, const Rectangle& viewport);
+
+    /**
+     * Returns the render queue of a view, which can be used to set how it draws.
+     *
+     * @param view The index of the view.
+     *
+     * @return The render queue of the view.
+     */
+    RenderQueue* getRenderQueue(unsigned int view) const;
+
+    /**
+     * Sets the number of point and spot lights cull() assigns to each visible node.
+     *
+     * @param maxLights The maximum number of lights of a node, or 0, the default, not to assign lights.
+     * @see Scene::assignLights
+     */
+    void setMaxLights(unsigned int maxLights);
+
+    /**
+     * Finds the nodes visible from any of the views, and assigns them lights.
+     *
+     * This is called once per frame, after the nodes and cameras have moved.
+     */
+    void cull();
+
+    /**
+     * Returns the nodes found visible by the last call to cull().
+     *
+     * @return The nodes visible from any of the views.
+     */
+    const std::vector<Node*>& getVisibleNodes() const;
+
+    /**
+     * Returns the nodes found visible from a view by the last call to cull().
+     *
+     * @param view The index of the view.
+     * @param nodes Vector of nodes to be populated with the visible nodes.
+     *
+     * @return The number of nodes visible from the view.
+     */
+    unsigned int getVisibleNodes(unsigned int view, std::vector<Node*>& nodes) const;
+
+    /**
+     * Draws the nodes found visible by the last call to cull() in each view.
+     *
+     * The active camera of the scene and the viewport of the game are restored afterwards.
+     *
+     * @param wireframe If true, draw the models in wireframe mode.
+     */
+    void draw(bool wireframe = false);
+
+private:
+
+    /**
+     * A camera and the viewport and render queue it is drawn with.
+     */
+    struct View
+    {
+        Camera* camera;
+        Rectangle viewport;
+        RenderQueue* queue;
+    };
+
+    /**
+     * Constructor.
+     */
+    MultiView(Scene* scene);
+
+    /**
+     * Hidden copy constructor.
+     */
+    MultiView(const MultiView& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    MultiView& operator=(const MultiView&);
+
+    Scene* _scene;
+    std::vector<View> _views;
+    std::vector<Frustum> _frusta;
+    std::vector<Node*> _visibleNodes;
+    std::vector<unsigned int> _visibleMasks;
+    unsigned int _maxLights;
+};
+
+}
+
+#endif
@@ -0,0 +1,105 @@
+#include "Base.h"
+#include "Mutex.h"
+
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
+
+namespace gameplay
+{
+
+#ifdef WIN32
+typedef CRITICAL_SECTION MutexHandle;
+typedef CONDITION_VARIABLE ConditionHandle;
+#else
+typedef pthread_mutex_t MutexHandle;
+typedef pthread_cond_t ConditionHandle;
+#endif
+
+// These fail to compile if MUTEX_HANDLE_SIZE is too small for the platform's handles.
+typedef char MutexHandleSizeCheck[sizeof(MutexHandle) <= MUTEX_HANDLE_SIZE ? 1 : -1];
+typedef char ConditionHandleSizeCheck[sizeof(ConditionHandle) <= MUTEX_HANDLE_SIZE ? 1 : -1];
+
+Mutex::Mutex()
+{
+#ifdef WIN32
+    InitializeCriticalSection((MutexHandle*)_handle);
+#else
+    pthread_mutex_init((MutexHandle*)_handle, NULL);
+#endif
+}
+
+Mutex::~Mutex()
+{
+#ifdef WIN32
+    DeleteCriticalSection((MutexHandle*)_handle);
+#else
+    pthread_mutex_destroy((MutexHandle*)_handle);
+#endif
+}
+
+void Mutex::lock()
+{
+#ifdef WIN32
+    EnterCriticalSection((MutexHandle*)_handle);
+#else
+    pthread_mutex_lock((MutexHandle*)_handle);
+#endif
+}
+
+void Mutex::unlock()
+{
+#ifdef WIN32
+    LeaveCriticalSection((MutexHandle*)_handle);
+#else
+    pthread_mutex_unlock((MutexHandle*)_handle);
+#endif
+}
+
+Condition::Condition()
+{
+#ifdef WIN32
+    InitializeConditionVariable((ConditionHandle*)_handle);
+#else
+    pthread_cond_init((ConditionHandle*)_handle, NULL);
+#endif
+}
+
+Condition::~Condition()
+{
+#ifndef WIN32
+    pthread_cond_destroy((ConditionHandle*)_handle);
+#endif
+}
+
+void Condition::wait(Mutex* mutex)
+{
+    GP_ASSERT(mutex);
+#ifdef WIN32
+    SleepConditionVariableCS((ConditionHandle*)_handle, (MutexHandle*)mutex->_handle, INFINITE);
+#else
+    pthread_cond_wait((ConditionHandle*)_handle, (MutexHandle*)mutex->_handle);
+#endif
+}
+
+void Condition::signal()
+{
+#ifdef WIN32
+    WakeConditionVariable((ConditionHandle*)_handle);
+#else
+    pthread_cond_signal((ConditionHandle*)_handle);
+#endif
+}
+
+void Condition::broadcast()
+{
+#ifdef WIN32
+    WakeAllConditionVariable((ConditionHandle*)_handle);
+#else
+    pthread_cond_broadcast((ConditionHandle*)_handle);
+#endif
+}
+
+}
@@ -0,0 +1,163 @@
+#ifndef MUTEX_H_
+#define MUTEX_H_
+
+// The size of the storage of a platform mutex or condition variable, which is checked in Mutex.cpp.
+#define MUTEX_HANDLE_SIZE 64
+
+namespace gameplay
+{
+
+class Condition;
+
+/**
+ * Defines a mutual exclusion lock for the data shared by several threads.
+ *
+ * A mutex is a critical section on Windows and a pthread mutex elsewhere, which is stored
+ * in the mutex itself, so mutexes can be static objects and do not allocate memory. It is
+ * not recursive: a thread must not lock a mutex it has already locked.
+ *
+ * @script{ignore}
+ */
+class Mutex
+{
+    friend class Condition;
+
+public:
+
+    /**
+     * Constructor.
+     */
+    Mutex();
+
+    /**
+     * Destructor. The mutex must not be locked.
+     */
+    ~Mutex();
+
+    /**
+     * Locks the mutex, waiting for the thread that holds it to unlock it.
+     */
+    void lock();
+
+    /**
+     * Unlocks the mutex, which must be held by the calling thread.
+     */
+    void unlock();
+
+private:
+
+    /**
+     * Hidden copy constructor.
+     */
+    Mutex(const Mutex& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    Mutex& operator=(const Mutex&);
+
+    union
+    {
+        double _align;
+        void* _alignPointer;
+        char _handle[MUTEX_HANDLE_SIZE];
+    };
+};
+
+/**
+ * Defines a lock that holds a mutex for the scope it is declared in.
+ *
+ * @script{ignore}
+ */
+class ScopedLock
+{
+public:
+
+    /**
+     * Constructor. Locks the mutex.
+     *
+     * @param mutex The mutex.
+     */
+    explicit ScopedLock(Mutex& mutex) : _mutex(mutex) { _mutex.lock(); }
+
+    /**
+     * Destructor. Unlocks the mutex.
+     */
+    ~ScopedLock() { _mutex.unlock(); }
+
+private:
+
+    /**
+     * Hidden copy constructor.
+     */
+    ScopedLock(const ScopedLock& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    ScopedLock& operator=(const ScopedLock&);
+
+    Mutex& _mutex;
+};
+
+/**
+ * Defines a condition variable, which threads wait on until another thread signals it.
+ *
+ * @script{ignore}
+ */
+class Condition
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    Condition();
+
+    /**
+     * Destructor. No thread may be waiting on the condition.
+     */
+    ~Condition();
+
+    /**
+     * Unlocks a mutex and waits until the condition is signaled, then locks the mutex again.
+     *
+     * Waits can end without a signal, so the waiting thread must check what it waits for again.
+     *
+     * @param mutex The mutex, which must be held by the calling thread.
+     */
+    void wait(Mutex* mutex);
+
+    /**
+     * Wakes one of the threads that wait on the condition.
+     */
+    void signal();
+
+    /**
+     * Wakes all the threads that wait on the condition.
+     */
+    void broadcast();
+
+private:
+
+    /**
+     * Hidden copy constructor.
+     */
+    Condition(const Condition& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    Condition& operator=(const Condition&);
+
+    union
+    {
+        double _align;
+        void* _alignPointer;
+        char _handle[MUTEX_HANDLE_SIZE];
+    };
+};
+
+}
+
+#endif
@@ -0,0 +1,560 @@
+#include "Base.h"
+#include "NavigationMesh.h"
+#include "Game.h"
+#include "Mutex.h"
+
+// The largest number of cells of the triangle grid along each axis.
+#define NAVIGATION_MESH_MAX_GRID_SIZE 256
+
+// The number of corridors kept in the cache by default.
+#define NAVIGATION_MESH_CACHE_SIZE 256
+
+namespace gameplay
+{
+
+/**
+ * Returns twice the signed area of the triangle abc projected on the XZ plane, which is
+ * positive when c is counterclockwise from b around a.
+ */
+static float cross2D(const Vector3& a, const Vector3& b, const Vector3& c)
+{
+    return (b.x - a.x) * (c.z - a.z) - (b.z - a.z) * (c.x - a.x);
+}
+
+NavigationMesh::NavigationMesh()
+    : _gridWidth(0), _gridHeight(0), _cellWidth(0.0f), _cellHeight(0.0f), _cacheTime(0),
+      _cacheSize(NAVIGATION_MESH_CACHE_SIZE), _cacheMutex(NULL)
+{
+    _cacheMutex = new Mutex();
+}
+
+NavigationMesh::~NavigationMesh()
+{
+    SAFE_DELETE(_cacheMutex);
+}
+
+NavigationMesh* NavigationMesh::create(const float* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int triangleCount)
+{
+    GP_ASSERT(vertices || vertexCount == 0);
+    GP_ASSERT(indices || triangleCount == 0);
+
+    for (unsigned int i = 0, count = triangleCount * 3; i < count; ++i)
+    {
+        if (indices[i] >= vertexCount)
+        {
+            GP_WARN("Invalid vertex index (%u) in navigation mesh with %u vertices.", indices[i], vertexCount);
+            return NULL;
+        }
+    }
+
+    NavigationMesh* mesh = new NavigationMesh();
+    mesh->_vertices.resize(vertexCount);
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        mesh->_vertices[i].set(vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2]);
+    }
+    mesh->_indices.assign(indices, indices + triangleCount * 3);
+    if (!mesh->initialize())
+    {
+        SAFE_RELEASE(mesh);
+        return NULL;
+    }
+    return mesh;
+}
+
+bool NavigationMesh::initialize()
+{
+    unsigned int triangleCount = getTriangleCount();
+
+    // Link the triangles that share an edge. Edges shared by more than two triangles only link the first two.
+    _neighbors.assign(triangleCount * 3, -1);
+    std::map<std::pair<unsigned int, unsigned int>, unsigned int> edges;
+    for (unsigned int i = 0, count = triangleCount * 3; i < count; ++i)
+    {
+        unsigned int a = _indices[i];
+        unsigned int b = _indices[i - i % 3 + (i + 1) % 3];
+        std::pair<unsigned int, unsigned int> key(std::min(a, b), std::max(a, b));
+        std::map<std::pair<unsigned int, unsigned int>, unsigned int>::iterator itr = edges.find(key);
+        if (itr == edges.end())
+        {
+            edges[key] = i;
+        }
+        else if (_neighbors[itr->second] < 0 && itr->second / 3 != i / 3)
+        {
+            _neighbors[itr->second] = (int)(i / 3);
+            _neighbors[i] = (int)(itr->second / 3);
+        }
+    }
+
+    // Compute the centers of the triangles and the bounds of the mesh.
+    _centers.resize(triangleCount);
+    _min.set(FLT_MAX, FLT_MAX, FLT_MAX);
+    _max.set(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (unsigned int i = 0; i < triangleCount; ++i)
+    {
+        const Vector3& a = _vertices[_indices[i * 3]];
+        const Vector3& b = _vertices[_indices[i * 3 + 1]];
+        const Vector3& c = _vertices[_indices[i * 3 + 2]];
+        _centers[i].set((a.x + b.x + c.x) / 3.0f, (a.y + b.y + c.y) / 3.0f, (a.z + b.z + c.z) / 3.0f);
+        _min.set(std::min(_min.x, std::min(a.x, std::min(b.x, c.x))), std::min(_min.y, std::min(a.y, std::min(b.y, c.y))),
+                 std::min(_min.z, std::min(a.z, std::min(b.z, c.z))));
+        _max.set(std::max(_max.x, std::max(a.x, std::max(b.x, c.x))), std::max(_max.y, std::max(a.y, std::max(b.y, c.y))),
+                 std::max(_max.z, std::max(a.z, std::max(b.z, c.z))));
+    }
+
+    // Sort the triangles into a grid on the XZ plane, with about one triangle per cell, so that the
+    // triangle under a point is found by only testing the triangles of its cell.
+    unsigned int gridSize = (unsigned int)ceilf(sqrtf((float)triangleCount));
+    _gridWidth = std::max(1u, std::min(gridSize, (unsigned int)NAVIGATION_MESH_MAX_GRID_SIZE));
+    _gridHeight = _gridWidth;
+    _cellWidth = triangleCount > 0 ? std::max((_max.x - _min.x) / _gridWidth, MATH_EPSILON) : 1.0f;
+    _cellHeight = triangleCount > 0 ? std::max((_max.z - _min.z) / _gridHeight, MATH_EPSILON) : 1.0f;
+    _cellStarts.assign(_gridWidth * _gridHeight + 1, 0);
+    std::vector<unsigned int> cellEnds;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (unsigned int i = 0; i < triangleCount; ++i)
+        {
+            const Vector3& a = _vertices[_indices[i * 3]];
+            const Vector3& b = _vertices[_indices[i * 3 + 1]];
+            const Vector3& c = _vertices[_indices[i * 3 + 2]];
+            unsigned int minX = std::min((unsigned int)((std::min(a.x, std::min(b.x, c.x)) - _min.x) / _cellWidth), _gridWidth - 1);
+            unsigned int maxX = std::min((unsigned int)((std::max(a.x, std::max(b.x, c.x)) - _min.x) / _cellWidth), _gridWidth - 1);
+            unsigned int minZ = std::min((unsigned int)((std::min(a.z, std::min(b.z, c.z)) - _min.z) / _cellHeight), _gridHeight - 1);
+            unsigned int maxZ = std::min((unsigned int)((std::max(a.z, std::max(b.z, c.z)) - _min.z) / _cellHeight), _gridHeight - 1);
+            for (unsigned int z = minZ; z <= maxZ; ++z)
+            {
+                for (unsigned int x = minX; x <= maxX; ++x)
+                {
+                    // The first pass counts the triangles of each cell, the second pass places them.
+                    unsigned int cell = z * _gridWidth + x;
+                    if (pass == 0)
+                        ++_cellStarts[cell + 1];
+                    else
+                        _cellTriangles[cellEnds[cell]++] = i;
+                }
+            }
+        }
+        if (pass == 0)
+        {
+            for (unsigned int i = 1, count = (unsigned int)_cellStarts.size(); i < count; ++i)
+            {
+                _cellStarts[i] += _cellStarts[i - 1];
+            }
+            _cellTriangles.resize(_cellStarts.back());
+            cellEnds.assign(_cellStarts.begin(), _cellStarts.end() - 1);
+        }
+    }
+
+    return true;
+}
+
+unsigned int NavigationMesh::getTriangleCount() const
+{
+    return (unsigned int)_indices.size() / 3;
+}
+
+int NavigationMesh::findTriangle(const Vector3& point, Vector3* closestPoint) const
+{
+    unsigned int triangleCount = getTriangleCount();
+    if (triangleCount == 0)
+        return -1;
+
+    // Look for the triangle above or below the point that is vertically nearest to it.
+    int best = -1;
+    float bestDistance = FLT_MAX;
+    float bestHeight = 0.0f;
+    if (point.x >= _min.x && point.x <= _max.x && point.z >= _min.z && point.z <= _max.z)
+    {
+        unsigned int x = std::min((unsigned int)((point.x - _min.x) / _cellWidth), _gridWidth - 1);
+        unsigned int z = std::min((unsigned int)((point.z - _min.z) / _cellHeight), _gridHeight - 1);
+        unsigned int cell = z * _gridWidth + x;
+        for (unsigned int i = _cellStarts[cell], end = _cellStarts[cell + 1]; i < end; ++i)
+        {
+            unsigned int triangle = _cellTriangles[i];
+            const Vector3& a = _vertices[_indices[triangle * 3]];
+            const Vector3& b = _vertices[_indices[triangle * 3 + 1]];
+            const Vector3& c = _vertices[_indices[triangle * 3 + 2]];
+            float area = cross2D(a, b, c);
+            if (area == 0.0f)
+                continue;
+            float u = cross2D(b, c, point) / area;
+            float v = cross2D(c, a, point) / area;
+            float w = 1.0f - u - v;
+            if (u < 0.0f || v < 0.0f || w < 0.0f)
+                continue;
+            float height = a.y * u + b.y * v + c.y * w;
+            float distance = fabs(height - point.y);
+            if (distance < bestDistance)
+            {
+                best = (int)triangle;
+                bestDistance = distance;
+                bestHeight = height;
+            }
+        }
+    }
+    if (best >= 0)
+    {
+        if (closestPoint)
+            closestPoint->set(point.x, bestHeight, point.z);
+        return best;
+    }
+
+    // The point is off the mesh: find the nearest triangle.
+    Vector3 bestPoint;
+    for (unsigned int i = 0; i < triangleCount; ++i)
+    {
+        Vector3 p = getClosestPoint(i, point);
+        float distance = p.distanceSquared(point);
+        if (distance < bestDistance)
+        {
+            best = (int)i;
+            bestDistance = distance;
+            bestPoint = p;
+        }
+    }
+    if (closestPoint)
+        *closestPoint = bestPoint;
+    return best;
+}
+
+Vector3 NavigationMesh::getClosestPoint(unsigned int triangle, const Vector3& point) const
+{
+    // From "Real-Time Collision Detection" (Ericson), 5.1.5: find the Voronoi region of the triangle the point is in.
+    const Vector3& a = _vertices[_indices[triangle * 3]];
+    const Vector3& b = _vertices[_indices[triangle * 3 + 1]];
+    const Vector3& c = _vertices[_indices[triangle * 3 + 2]];
+    Vector3 ab = b - a;
+    Vector3 ac = c - a;
+    Vector3 ap = point - a;
+    float d1 = ab.dot(ap);
+    float d2 = ac.dot(ap);
+    if (d1 <= 0.0f && d2 <= 0.0f)
+        return a;
+
+    Vector3 bp = point - b;
+    float d3 = ab.dot(bp);
+    float d4 = ac.dot(bp);
+    if (d3 >= 0.0f && d4 <= d3)
+        return b;
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+        return a + ab * (d1 / (d1 - d3));
+
+    Vector3 cp = point - c;
+    float d5 = ab.dot(cp);
+    float d6 = ac.dot(cp);
+    if (d6 >= 0.0f && d5 <= d6)
+        return c;
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+        return a + ac * (d2 / (d2 - d6));
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+    float denominator = 1.0f / (va + vb + vc);
+    return a + ab * (vb * denominator) + ac * (vc * denominator);
+}
+
+bool NavigationMesh::findPath(const Vector3& start, const Vector3& end, Path* path) const
+{
+    GP_ASSERT(path);
+
+    path->points.clear();
+    path->corridor.clear();
+
+    Vector3 startPoint, endPoint;
+    int startTriangle = findTriangle(start, &startPoint);
+    int endTriangle = findTriangle(end, &endPoint);
+    if (startTriangle < 0 || endTriangle < 0)
+        return false;
+
+    // Failed searches are cached as empty corridors, since searching for a path between two parts
+    // of the mesh that are not connected visits every triangle it can reach.
+    if (!findCachedCorridor(startTriangle, endTriangle, path->corridor))
+    {
+        findCorridor(startTriangle, endTriangle, path->corridor);
+        cacheCorridor(startTriangle, endTriangle, path->corridor);
+    }
+    if (path->corridor.empty())
+        return false;
+
+    straightenPath(startPoint, endPoint, path->corridor, path->points);
+    return true;
+}
+
+NavigationMesh::PathQuery* NavigationMesh::findPathAsync(const Vector3& start, const Vector3& end)
+{
+    PathQuery* query = new PathQuery(this, start, end);
+    JobController* jobs = Game::getInstance() ? Game::getInstance()->getJobController() : NULL;
+    if (jobs)
+        query->_jobId = jobs->add(query);
+    else
+        query->run();
+    return query;
+}
+
+bool NavigationMesh::updatePath(const Vector3& start, const Vector3& end, Path* path) const
+{
+    GP_ASSERT(path);
+
+    if (path->corridor.empty())
+        return false;
+
+    Vector3 endPoint;
+    if (findTriangle(end, &endPoint) != (int)path->corridor.back())
+        return false;
+
+    Vector3 startPoint;
+    int startTriangle = findTriangle(start, &startPoint);
+    std::vector<unsigned int>::iterator itr = std::find(path->corridor.begin(), path->corridor.end(), (unsigned int)startTriangle);
+    if (itr == path->corridor.end())
+        return false;
+
+    path->corridor.erase(path->corridor.begin(), itr);
+    straightenPath(startPoint, endPoint, path->corridor, path->points);
+    return true;
+}
+
+void NavigationMesh::setCacheSize(unsigned int size)
+{
+    _cacheMutex->lock();
+    _cacheSize = size;
+    while (_cache.size() > _cacheSize)
+    {
+        _cache.erase(_cache.begin());
+    }
+    _cacheMutex->unlock();
+}
+
+bool NavigationMesh::findCorridor(unsigned int startTriangle, unsigned int endTriangle, std::vector<unsigned int>& corridor) const
+{
+    // A* over the triangles, with the distances between their centers as costs.
+    unsigned int triangleCount = getTriangleCount();
+    std::vector<float> costs(triangleCount, FLT_MAX);
+    std::vector<int> parents(triangleCount, -1);
+    std::vector<bool> closed(triangleCount, false);
+    std::priority_queue<std::pair<float, unsigned int>, std::vector<std::pair<float, unsigned int> >, std::greater<std::pair<float, unsigned int> > > open;
+
+    const Vector3& goal = _centers[endTriangle];
+    costs[startTriangle] = 0.0f;
+    open.push(std::make_pair(_centers[startTriangle].distance(goal), startTriangle));
+    while (!open.empty())
+    {
+        unsigned int triangle = open.top().second;
+        open.pop();
+
+        // Triangles are pushed again when a cheaper way to them is found, rather than updated in the queue.
+        if (closed[triangle])
+            continue;
+        closed[triangle] = true;
+
+        if (triangle == endTriangle)
+        {
+            for (int i = (int)endTriangle; i >= 0; i = parents[i])
+            {
+                corridor.push_back((unsigned int)i);
+            }
+            std::reverse(corridor.begin(), corridor.end());
+            return true;
+        }
+
+        for (unsigned int i = 0; i < 3; ++i)
+        {
+            int neighbor = _neighbors[triangle * 3 + i];
+            if (neighbor < 0 || closed[neighbor])
+                continue;
+
+            float cost = costs[triangle] + _centers[triangle].distance(_centers[neighbor]);
+            if (cost < costs[neighbor])
+            {
+                costs[neighbor] = cost;
+                parents[neighbor] = (int)triangle;
+                open.push(std::make_pair(cost + _centers[neighbor].distance(goal), (unsigned int)neighbor));
+            }
+        }
+    }
+    return false;
+}
+
+bool NavigationMesh::findCachedCorridor(unsigned int startTriangle, unsigned int endTriangle, std::vector<unsigned int>& corridor) const
+{
+    unsigned long long key = ((unsigned long long)startTriangle << 32) | endTriangle;
+    bool found = false;
+    _cacheMutex->lock();
+    std::map<unsigned long long, CachedCorridor>::iterator itr = _cache.find(key);
+    if (itr != _cache.end())
+    {
+        itr->second.lastUse = ++_cacheTime;
+        corridor = itr->second.corridor;
+        found = true;
+    }
+    _cacheMutex->unlock();
+    return found;
+}
+
+void NavigationMesh::cacheCorridor(unsigned int startTriangle, unsigned int endTriangle, const std::vector<unsigned int>& corridor) const
+{
+    unsigned long long key = ((unsigned long long)startTriangle << 32) | endTriangle;
+    _cacheMutex->lock();
+    if (_cacheSize > 0)
+    {
+        if (_cache.size() >= _cacheSize && _cache.find(key) == _cache.end())
+        {
+            std::map<unsigned long long, CachedCorridor>::iterator oldest = _cache.begin();
+            for (std::map<unsigned long long, CachedCorridor>::iterator itr = _cache.begin(); itr != _cache.end(); ++itr)
+            {
+                if (itr->second.lastUse < oldest->second.lastUse)
+                    oldest = itr;
+            }
+            _cache.erase(oldest);
+        }
+        CachedCorridor& cached = _cache[key];
+        cached.corridor = corridor;
+        cached.lastUse = ++_cacheTime;
+    }
+    _cacheMutex->unlock();
+}
+
+void NavigationMesh::straightenPath(const Vector3& start, const Vector3& end, const std::vector<unsigned int>& corridor, std::vector<Vector3>& points) const
+{
+    points.clear();
+    points.push_back(start);
+
+    // The portals are the edges between consecutive triangles of the corridor, with the left vertex
+    // counterclockwise from the right one as seen from the triangle before the edge. The start and
+    // end points are portals of zero width.
+    unsigned int portalCount = (unsigned int)corridor.size() + 1;
+    std::vector<Vector3> lefts(portalCount);
+    std::vector<Vector3> rights(portalCount);
+    lefts[0] = rights[0] = start;
+    for (unsigned int i = 0; i + 1 < corridor.size(); ++i)
+    {
+        unsigned int triangle = corridor[i];
+        unsigned int edge = 0;
+        while (edge < 2 && _neighbors[triangle * 3 + edge] != (int)corridor[i + 1])
+            ++edge;
+        const Vector3& p = _vertices[_indices[triangle * 3 + edge]];
+        const Vector3& q = _vertices[_indices[triangle * 3 + (edge + 1) % 3]];
+        if (cross2D(_centers[triangle], p, q) > 0.0f)
+        {
+            lefts[i + 1] = q;
+            rights[i + 1] = p;
+        }
+        else
+        {
+            lefts[i + 1] = p;
+            rights[i + 1] = q;
+        }
+    }
+    lefts[portalCount - 1] = rights[portalCount - 1] = end;
+
+    // The funnel algorithm: the funnel from the apex narrows portal by portal, and when a side would
+    // cross over the other, the other side's vertex is a corner of the path and becomes the new apex.
+    Vector3 apex = start;
+    Vector3 left = start;
+    Vector3 right = start;
+    unsigned int apexIndex = 0;
+    unsigned int leftIndex = 0;
+    unsigned int rightIndex = 0;
+    for (unsigned int i = 1; i < portalCount; ++i)
+    {
+        const Vector3& portalLeft = lefts[i];
+        const Vector3& portalRight = rights[i];
+
+        // Narrow the right side of the funnel.
+        if (cross2D(apex, right, portalRight) >= 0.0f)
+        {
+            if (apex == right || cross2D(apex, left, portalRight) < 0.0f)
+            {
+                right = portalRight;
+                rightIndex = i;
+            }
+            else
+            {
+                // The right side crosses the left side: the left vertex is a corner.
+                if (points.back() != left)
+                    points.push_back(left);
+                apex = left;
+                apexIndex = leftIndex;
+                right = apex;
+                rightIndex = apexIndex;
+                i = apexIndex;
+                continue;
+            }
+        }
+
+        // Narrow the left side of the funnel.
+        if (cross2D(apex, left, portalLeft) <= 0.0f)
+        {
+            if (apex == left || cross2D(apex, right, portalLeft) > 0.0f)
+            {
+                left = portalLeft;
+                leftIndex = i;
+            }
+            else
+            {
+                // The left side crosses the right side: the right vertex is a corner.
+                if (points.back() != right)
+                    points.push_back(right);
+                apex = right;
+                apexIndex = rightIndex;
+                left = apex;
+                leftIndex = apexIndex;
+                i = apexIndex;
+                continue;
+            }
+        }
+    }
+
+    if (points.back() != end || points.size() == 1)
+        points.push_back(end);
+}
+
+NavigationMesh::PathQuery::PathQuery(NavigationMesh* mesh, const Vector3& start, const Vector3& end)
+    : _mesh(mesh), _start(start), _end(end), _found(false), _jobId(0)
+{
+    _mesh->addRef();
+}
+
+NavigationMesh::PathQuery::~PathQuery()
+{
+    // The job controller does not own the job, so it must be complete before it is destroyed.
+    wait();
+    SAFE_RELEASE(_mesh);
+}
+
+bool NavigationMesh::PathQuery::isComplete() const
+{
+    return _jobId == 0 || Game::getInstance()->getJobController()->isComplete(_jobId);
+}
+
+void NavigationMesh::PathQuery::wait()
+{
+    if (_jobId != 0)
+    {
+        Game::getInstance()->getJobController()->wait(_jobId);
+        _jobId = 0;
+    }
+}
+
+bool NavigationMesh::PathQuery::isFound() const
+{
+    return _found;
+}
+
+const NavigationMesh::Path& NavigationMesh::PathQuery::getPath() const
+{
+    return _path;
+}
+
+void NavigationMesh::PathQuery::run()
+{
+    _found = _mesh->findPath(_start, _end, &_path);
+}
+
+}
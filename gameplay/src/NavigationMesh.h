@@ -0,0 +1,268 @@
+#ifndef NAVIGATIONMESH_H_
+#define NAVIGATIONMESH_H_
+
+#include "Ref.h"
+#include "Vector3.h"
+#include "JobController.h"
+
+namespace gameplay
+{
+
+class Mutex;
+
+/**
+ * Defines a mesh of the walkable surfaces of a scene, for finding paths between points.
+ *
+ * A navigation mesh is made of triangles that share edges with their neighbors. Paths are
+ * found with A* over the triangles, which gives the corridor of triangles the path goes
+ * through, and are then straightened within the corridor with the funnel algorithm, so
+ * they only turn at the corners of obstacles.
+ *
+ * Navigation meshes are generated by gameplay-encoder from the geometry of a scene (see
+ * the -nav option) and loaded with Bundle::loadNavigationMesh. A navigation mesh is never
+ * modified once created, so paths can be found from any thread: findPathAsync finds a
+ * path on the worker threads of the JobController.
+ *
+ * The corridors found between triangles are kept in a cache, so the agents of a crowd
+ * that head for the same area only search for the corridor once. updatePath reuses the
+ * corridor of a path when its start and end move within it, which is what happens when
+ * an agent follows a path to a moving target.
+ *
+ * @script{ignore}
+ */
+class NavigationMesh : public Ref
+{
+    friend class Bundle;
+
+public:
+
+    /**
+     * Defines a path found on a navigation mesh.
+     */
+    struct Path
+    {
+        /**
+         * The points of the path, from the start to the end, in world space.
+         */
+        std::vector<Vector3> points;
+
+        /**
+         * The triangles the path goes through, from the start to the end.
+         */
+        std::vector<unsigned int> corridor;
+    };
+
+    /**
+     * Defines a path query that runs on the worker threads of the JobController.
+     *
+     * The query keeps a reference to its navigation mesh until it is destroyed. Releasing a
+     * query that is not complete waits for it to complete.
+     */
+    class PathQuery : public Ref, public JobController::Job
+    {
+        friend class NavigationMesh;
+
+    public:
+
+        /**
+         * Determines whether the query is complete.
+         *
+         * @return true if the path was searched for, false if the query is still queued or running.
+         */
+        bool isComplete() const;
+
+        /**
+         * Waits for the query to complete, running other jobs in the meantime.
+         */
+        void wait();
+
+        /**
+         * Determines whether a path was found. Only valid once the query is complete.
+         *
+         * @return true if a path was found, false otherwise.
+         */
+        bool isFound() const;
+
+        /**
+         * Returns the path that was found. Only valid once the query is complete.
+         *
+         * @return The path.
+         */
+        const Path& getPath() const;
+
+        /**
+         * @see JobController::Job::run
+         */
+        void run();
+
+    private:
+
+        PathQuery(NavigationMesh* mesh, const Vector3& start, const Vector3& end);
+
+        ~PathQuery();
+
+        PathQuery(const PathQuery& copy);
+
+        PathQuery& operator=(const PathQuery&);
+
+        NavigationMesh* _mesh;
+        Vector3 _start;
+        Vector3 _end;
+        Path _path;
+        bool _found;
+        JobController::JobId _jobId;
+    };
+
+    /**
+     * Creates a navigation mesh from triangles.
+     *
+     * Triangles that share two vertices are neighbors. Vertices must therefore be shared
+     * between triangles rather than duplicated.
+     *
+     * @param vertices The positions of the vertices, three floats each, in world space.
+     * @param vertexCount The number of vertices.
+     * @param indices The indices of the vertices of the triangles, three for each triangle.
+     * @param triangleCount The number of triangles.
+     *
+     * @return The navigation mesh, or NULL if the triangles are invalid.
+     */
+    static NavigationMesh* create(const float* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int triangleCount);
+
+    /**
+     * Returns the number of triangles of the mesh.
+     *
+     * @return The number of triangles.
+     */
+    unsigned int getTriangleCount() const;
+
+    /**
+     * Finds the triangle a point is on.
+     *
+     * The point is projected onto the mesh vertically. When the point is not above or below
+     * the mesh, the triangle nearest to it is returned.
+     *
+     * @param point The point, in world space.
+     * @param closestPoint Set to the point of the triangle closest to the point, if not NULL.
+     *
+     * @return The index of the triangle, or -1 if the mesh has no triangles.
+     */
+    int findTriangle(const Vector3& point, Vector3* closestPoint = NULL) const;
+
+    /**
+     * Finds a path between two points.
+     *
+     * The points are moved onto the mesh first (see findTriangle). This can be called from
+     * any thread.
+     *
+     * @param start The start of the path, in world space.
+     * @param end The end of the path, in world space.
+     * @param path The path to fill.
+     *
+     * @return true if a path was found, false if the points are not connected.
+     */
+    bool findPath(const Vector3& start, const Vector3& end, Path* path) const;
+
+    /**
+     * Starts finding a path between two points on the worker threads.
+     *
+     * When there is no job controller, the path is found before this returns.
+     *
+     * @param start The start of the path, in world space.
+     * @param end The end of the path, in world space.
+     *
+     * @return The query, which the caller must release.
+     */
+    PathQuery* findPathAsync(const Vector3& start, const Vector3& end);
+
+    /**
+     * Updates a path for new start and end points without searching for a new corridor.
+     *
+     * This succeeds when the new start is on one of the triangles of the corridor of the
+     * path and the new end is on its last triangle. The triangles before the start are
+     * removed from the corridor and the points are straightened again.
+     *
+     * @param start The new start of the path, in world space.
+     * @param end The new end of the path, in world space.
+     * @param path The path to update, which must have been found on this mesh.
+     *
+     * @return true if the path was updated, false if a new path must be found.
+     */
+    bool updatePath(const Vector3& start, const Vector3& end, Path* path) const;
+
+    /**
+     * Sets the largest number of corridors kept in the cache.
+     *
+     * @param size The number of corridors, or zero to disable the cache.
+     */
+    void setCacheSize(unsigned int size);
+
+private:
+
+    /**
+     * A corridor found between two triangles.
+     */
+    struct CachedCorridor
+    {
+        std::vector<unsigned int> corridor;
+        unsigned int lastUse;
+    };
+
+    NavigationMesh();
+
+    ~NavigationMesh();
+
+    NavigationMesh(const NavigationMesh& copy);
+
+    NavigationMesh& operator=(const NavigationMesh&);
+
+    /**
+     * Finds the neighbors of the triangles and their centers, and builds the grid.
+     */
+    bool initialize();
+
+    /**
+     * Searches for the corridor of triangles between two triangles with A*.
+     */
+    bool findCorridor(unsigned int startTriangle, unsigned int endTriangle, std::vector<unsigned int>& corridor) const;
+
+    /**
+     * Looks for a corridor in the cache.
+     */
+    bool findCachedCorridor(unsigned int startTriangle, unsigned int endTriangle, std::vector<unsigned int>& corridor) const;
+
+    /**
+     * Adds a corridor to the cache, replacing the least recently used one when the cache is full.
+     */
+    void cacheCorridor(unsigned int startTriangle, unsigned int endTriangle, const std::vector<unsigned int>& corridor) const;
+
+    /**
+     * Straightens the path between two points within a corridor with the funnel algorithm.
+     */
+    void straightenPath(const Vector3& start, const Vector3& end, const std::vector<unsigned int>& corridor, std::vector<Vector3>& points) const;
+
+    /**
+     * Returns the point of a triangle closest to a point.
+     */
+    Vector3 getClosestPoint(unsigned int triangle, const Vector3& point) const;
+
+    std::vector<Vector3> _vertices;
+    std::vector<unsigned int> _indices;         // Three vertices per triangle.
+    std::vector<int> _neighbors;                // The triangle across each edge of each triangle, or -1. Edge i goes from vertex i to vertex i + 1.
+    std::vector<Vector3> _centers;              // The center of each triangle.
+    Vector3 _min;                               // The bounds of the mesh.
+    Vector3 _max;
+    unsigned int _gridWidth;                    // The grid of triangles by position on the XZ plane.
+    unsigned int _gridHeight;
+    float _cellWidth;
+    float _cellHeight;
+    std::vector<unsigned int> _cellStarts;      // The first triangle of each cell in _cellTriangles, with one more at the end.
+    std::vector<unsigned int> _cellTriangles;
+    mutable std::map<unsigned long long, CachedCorridor> _cache;
+    mutable unsigned int _cacheTime;
+    unsigned int _cacheSize;
+    Mutex* _cacheMutex;                         // Guards _cache and _cacheTime.
+};
+
+}
+
+#endif
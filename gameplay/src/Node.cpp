@@ -1,5 +1,6 @@
 #include "Base.h"
 #include "Node.h"
+#include "StringId.h"
 #include "AudioSource.h"
 #include "Scene.h"
 #include "Joint.h"
@@ -19,15 +20,16 @@
 namespace gameplay
 {
 
+unsigned int Node::_hierarchyRevision = 0;
+unsigned int Node::_idRevision = 0;
+unsigned int Node::_componentRevision = 0;
+
 Node::Node(const char* id)
-    : _scene(NULL), _firstChild(NULL), _nextSibling(NULL), _prevSibling(NULL), _parent(NULL), _childCount(0),
+    : _scene(NULL), _id(StringId::intern(id)), _firstChild(NULL), _nextSibling(NULL), _prevSibling(NULL), _parent(NULL), _childCount(0),
     _tags(NULL), _camera(NULL), _light(NULL), _model(NULL), _terrain(NULL), _form(NULL), _audioSource(NULL), _particleEmitter(NULL),
-    _collisionObject(NULL), _agent(NULL), _dirtyBits(NODE_DIRTY_ALL), _notifyHierarchyChanged(true), _userData(NULL)
+    _collisionObject(NULL), _agent(NULL), _dirtyBits(NODE_DIRTY_ALL), _worldRevision(1),
+    _worldViewProjWorldRevision(0), _worldViewProjCameraRevision(0), _notifyHierarchyChanged(true), _occluder(false), _userData(NULL)
 {
-    if (id)
-    {
-        _id = id;
-    }
 }
 
 Node::~Node()
@@ -72,14 +74,15 @@ Node* Node::create(const char* id)
 
 const char* Node::getId() const
 {
-    return _id.c_str();
+    return StringId::getString(_id);
 }
 
 void Node::setId(const char* id)
 {
     if (id)
     {
-        _id = id;
+        _id = StringId::intern(id);
+        ++_idRevision;
     }
 }
 
@@ -125,6 +128,14 @@ void Node::addChild(Node* child)
     child->_parent = this;
 
     ++_childCount;
+    ++_hierarchyRevision;
+
+    // A node that is waiting for deferred notification does not mark its children again
+    // (see transformChanged), so mark the new one itself.
+    if ((_dirtyBits & NODE_DIRTY_WORLD) && _notifyDeferred)
+    {
+        child->transformChanged();
+    }
 
     setBoundsDirty();
 
@@ -188,6 +199,7 @@ void Node::remove()
     _nextSibling = NULL;
     _prevSibling = NULL;
     _parent = NULL;
+    ++_hierarchyRevision;
 
     if (parent && parent->_notifyHierarchyChanged)
     {
@@ -219,7 +231,7 @@ bool Node::hasTag(const char* name) const
 {
     GP_ASSERT(name);
 
-    return (_tags ? _tags->find(name) != _tags->end() : false);
+    return (_tags ? _tags->find(StringId::find(name)) != _tags->end() : false);
 }
 
 const char* Node::getTag(const char* name) const
@@ -229,7 +241,7 @@ const char* Node::getTag(const char* name) const
     if (!_tags)
         return NULL;
 
-    std::map<std::string, std::string>::const_iterator itr = _tags->find(name);
+    std::map<unsigned int, std::string>::const_iterator itr = _tags->find(StringId::find(name));
     return (itr == _tags->end() ? NULL : itr->second.c_str());
 }
 
@@ -242,21 +254,33 @@ void Node::setTag(const char* name, const char* value)
         // Removing tag
         if (_tags)
         {
-            _tags->erase(name);
+            _tags->erase(StringId::find(name));
             if (_tags->size() == 0)
                 SAFE_DELETE(_tags);
+            ++_idRevision;
         }
     }
     else
     {
         // Setting tag
         if (_tags == NULL)
-            _tags = new std::map<std::string, std::string>();
+            _tags = new std::map<unsigned int, std::string>();
 
-        (*_tags)[name] = value;
+        (*_tags)[StringId::intern(name)] = value;
+        ++_idRevision;
     }
 }
 
+bool Node::isOccluder() const
+{
+    return _occluder;
+}
+
+void Node::setOccluder(bool occluder)
+{
+    _occluder = occluder;
+}
+
 void* Node::getUserPointer() const
 {
     return (_userData ? _userData->pointer : NULL);
@@ -291,18 +315,35 @@ unsigned int Node::getChildCount() const
     return _childCount;
 }
 
+bool Node::matchesId(const char* id, unsigned int idAtom, bool exactMatch) const
+{
+    if (exactMatch)
+        return _id == idAtom;
+    return strncmp(StringId::getString(_id), id, strlen(id)) == 0;
+}
+
 Node* Node::findNode(const char* id, bool recursive, bool exactMatch) const
 {
     GP_ASSERT(id);
 
+    // A string that was never interned is not the ID of any node.
+    unsigned int idAtom = StringId::find(id);
+    if (exactMatch && idAtom == 0 && *id != '\0')
+        return NULL;
+
+    return findNode(id, idAtom, recursive, exactMatch);
+}
+
+Node* Node::findNode(const char* id, unsigned int idAtom, bool recursive, bool exactMatch) const
+{
     // If the node has a model with a mesh skin, search the skin's hierarchy as well.
     Node* rootNode = NULL;
     if (_model != NULL && _model->getSkin() != NULL && (rootNode = _model->getSkin()->_rootNode) != NULL)
     {
-        if ((exactMatch && rootNode->_id == id) || (!exactMatch && rootNode->_id.find(id) == 0))
+        if (rootNode->matchesId(id, idAtom, exactMatch))
             return rootNode;
         
-        Node* match = rootNode->findNode(id, true, exactMatch);
+        Node* match = rootNode->findNode(id, idAtom, true, exactMatch);
         if (match)
         {
             return match;
@@ -313,7 +354,7 @@ Node* Node::findNode(const char* id, bool recursive, bool exactMatch) const
     for (Node* child = getFirstChild(); child != NULL; child = child->getNextSibling())
     {
         // Does this child's ID match?
-        if ((exactMatch && child->_id == id) || (!exactMatch && child->_id.find(id) == 0))
+        if (child->matchesId(id, idAtom, exactMatch))
         {
             return child;
         }
@@ -324,7 +365,7 @@ Node* Node::findNode(const char* id, bool recursive, bool exactMatch) const
     {
         for (Node* child = getFirstChild(); child != NULL; child = child->getNextSibling())
         {
-            Node* match = child->findNode(id, true, exactMatch);
+            Node* match = child->findNode(id, idAtom, true, exactMatch);
             if (match)
             {
                 return match;
@@ -338,26 +379,35 @@ Node* Node::findNode(const char* id, bool recursive, bool exactMatch) const
 unsigned int Node::findNodes(const char* id, std::vector<Node*>& nodes, bool recursive, bool exactMatch) const
 {
     GP_ASSERT(id);
-    
+
+    unsigned int idAtom = StringId::find(id);
+    if (exactMatch && idAtom == 0 && *id != '\0')
+        return 0;
+
+    return findNodes(id, idAtom, nodes, recursive, exactMatch);
+}
+
+unsigned int Node::findNodes(const char* id, unsigned int idAtom, std::vector<Node*>& nodes, bool recursive, bool exactMatch) const
+{
     unsigned int count = 0;
 
     // If the node has a model with a mesh skin, search the skin's hierarchy as well.
     Node* rootNode = NULL;
     if (_model != NULL && _model->getSkin() != NULL && (rootNode = _model->getSkin()->_rootNode) != NULL)
     {
-        if ((exactMatch && rootNode->_id == id) || (!exactMatch && rootNode->_id.find(id) == 0))
+        if (rootNode->matchesId(id, idAtom, exactMatch))
         {
             nodes.push_back(rootNode);
             ++count;
         }
-        count += rootNode->findNodes(id, nodes, true, exactMatch);
+        count += rootNode->findNodes(id, idAtom, nodes, true, exactMatch);
     }
 
     // Search immediate children first.
     for (Node* child = getFirstChild(); child != NULL; child = child->getNextSibling())
     {
         // Does this child's ID match?
-        if ((exactMatch && child->_id == id) || (!exactMatch && child->_id.find(id) == 0))
+        if (child->matchesId(id, idAtom, exactMatch))
         {
             nodes.push_back(child);
             ++count;
@@ -369,7 +419,7 @@ unsigned int Node::findNodes(const char* id, std::vector<Node*>& nodes, bool rec
     {
         for (Node* child = getFirstChild(); child != NULL; child = child->getNextSibling())
         {
-            count += child->findNodes(id, nodes, true, exactMatch);
+            count += child->findNodes(id, idAtom, nodes, true, exactMatch);
         }
     }
 
@@ -441,6 +491,28 @@ const Matrix& Node::getWorldMatrix() const
     return _world;
 }
 
+void Node::updateWorldMatrix() const
+{
+    if (!(_dirtyBits & NODE_DIRTY_WORLD))
+        return;
+
+    _dirtyBits &= ~NODE_DIRTY_WORLD;
+    if (isStatic())
+        return;
+
+    // The parent was updated first, so its world matrix is current.
+    Node* parent = getParent();
+    if (parent && (!_collisionObject || _collisionObject->isKinematic()))
+    {
+        GP_ASSERT(!(parent->_dirtyBits & NODE_DIRTY_WORLD));
+        Matrix::multiply(parent->_world, getMatrix(), &_world);
+    }
+    else
+    {
+        _world = getMatrix();
+    }
+}
+
 const Matrix& Node::getWorldViewMatrix() const
 {
     static Matrix worldView;
@@ -538,13 +610,33 @@ const Matrix& Node::getInverseViewProjectionMatrix() const
 
 const Matrix& Node::getWorldViewProjectionMatrix() const
 {
-    static Matrix worldViewProj;
+    Scene* scene = getScene();
+    Camera* camera = scene ? scene->getActiveCamera() : NULL;
+
+    // Resolve the world matrix first, since that is what brings a dirty world up to date.
+    const Matrix& world = getWorldMatrix();
+    if (camera == NULL)
+    {
+        _worldViewProj = world;
+        _worldViewProjCameraRevision = 0;
+        return _worldViewProj;
+    }
 
-    // Always re-calculate worldViewProjection matrix since it's extremely difficult
-    // to track whether the camera has changed (it may frequently change every frame).
-    Matrix::multiply(getViewProjectionMatrix(), getWorldMatrix(), &worldViewProj);
+    // Camera revisions are unique across cameras, so this also catches a change of active camera.
+    unsigned int cameraRevision = camera->getRevision();
+    if (_worldViewProjCameraRevision != cameraRevision || _worldViewProjWorldRevision != _worldRevision)
+    {
+        Matrix::multiply(camera->getViewProjectionMatrix(), world, &_worldViewProj);
+        _worldViewProjCameraRevision = cameraRevision;
+        _worldViewProjWorldRevision = _worldRevision;
+    }
 
-    return worldViewProj;
+    return _worldViewProj;
+}
+
+unsigned int Node::getWorldRevision() const
+{
+    return _worldRevision;
 }
 
 Vector3 Node::getTranslationWorld() const
@@ -554,6 +646,12 @@ Vector3 Node::getTranslationWorld() const
     return translation;
 }
 
+void Node::getTranslationWorld(Vector3* dst) const
+{
+    GP_ASSERT(dst);
+    getWorldMatrix().getTranslation(dst);
+}
+
 Vector3 Node::getTranslationView() const
 {
     Vector3 translation;
@@ -562,6 +660,13 @@ Vector3 Node::getTranslationView() const
     return translation;
 }
 
+void Node::getTranslationView(Vector3* dst) const
+{
+    GP_ASSERT(dst);
+    getWorldMatrix().getTranslation(dst);
+    getViewMatrix().transformPoint(dst);
+}
+
 Vector3 Node::getForwardVectorWorld() const
 {
     Vector3 vector;
@@ -569,6 +674,12 @@ Vector3 Node::getForwardVectorWorld() const
     return vector;
 }
 
+void Node::getForwardVectorWorld(Vector3* dst) const
+{
+    GP_ASSERT(dst);
+    getWorldMatrix().getForwardVector(dst);
+}
+
 Vector3 Node::getForwardVectorView() const
 {
     Vector3 vector;
@@ -577,6 +688,13 @@ Vector3 Node::getForwardVectorView() const
     return vector;
 }
 
+void Node::getForwardVectorView(Vector3* dst) const
+{
+    GP_ASSERT(dst);
+    getWorldMatrix().getForwardVector(dst);
+    getViewMatrix().transformVector(dst);
+}
+
 Vector3 Node::getRightVectorWorld() const
 {
     Vector3 vector;
@@ -584,6 +702,12 @@ Vector3 Node::getRightVectorWorld() const
     return vector;
 }
 
+void Node::getRightVectorWorld(Vector3* dst) const
+{
+    GP_ASSERT(dst);
+    getWorldMatrix().getRightVector(dst);
+}
+
 Vector3 Node::getUpVectorWorld() const
 {
     Vector3 vector;
@@ -591,6 +715,12 @@ Vector3 Node::getUpVectorWorld() const
     return vector;
 }
 
+void Node::getUpVectorWorld(Vector3* dst) const
+{
+    GP_ASSERT(dst);
+    getWorldMatrix().getUpVector(dst);
+}
+
 Vector3 Node::getActiveCameraTranslationWorld() const
 {
     Scene* scene = getScene();
@@ -637,8 +767,16 @@ void Node::hierarchyChanged()
 
 void Node::transformChanged()
 {
+    // While notifications are deferred, a node that is still dirty and waiting to notify
+    // its listeners has already marked its children and queued them.
+    if ((_dirtyBits & NODE_DIRTY_WORLD) && _notifyDeferred)
+        return;
+
     // Our local transform was changed, so mark our world matrices dirty.
-    _dirtyBits |= NODE_DIRTY_WORLD | NODE_DIRTY_BOUNDS;
+    // Our bounds (and those of all our parents, which contain them) are now also out of date.
+    _dirtyBits |= NODE_DIRTY_WORLD;
+    ++_worldRevision;
+    setBoundsDirty();
 
     // Notify our children that their transform has also changed (since transforms are inherited).
     for (Node* n = getFirstChild(); n != NULL; n = n->getNextSibling())
@@ -663,12 +801,13 @@ void Node::transformChanged()
 
 void Node::setBoundsDirty()
 {
-    // Mark ourself and our parent nodes as dirty
-    _dirtyBits |= NODE_DIRTY_BOUNDS;
-
-    // Mark our parent bounds as dirty as well
-    if (_parent)
-        _parent->setBoundsDirty();
+    // Mark ourself and our parent nodes as dirty. A node's bounds are never clean while
+    // the bounds of one of its children are dirty, so we can stop at the first node that
+    // is already dirty.
+    for (Node* node = this; node != NULL && !(node->_dirtyBits & NODE_DIRTY_BOUNDS); node = node->_parent)
+    {
+        node->_dirtyBits |= NODE_DIRTY_BOUNDS;
+    }
 }
 
 Animation* Node::getAnimation(const char* id) const
@@ -747,6 +886,7 @@ void Node::setCamera(Camera* camera)
         }
 
         _camera = camera;
+        ++_componentRevision;
 
         if (_camera)
         {
@@ -772,6 +912,7 @@ void Node::setLight(Light* light)
         }
 
         _light = light;
+        ++_componentRevision;
 
         if (_light)
         {
@@ -783,6 +924,28 @@ void Node::setLight(Light* light)
     }
 }
 
+unsigned int Node::getAssignedLightCount() const
+{
+    return _assignedLights.size();
+}
+
+Node* Node::getAssignedLight(unsigned int index) const
+{
+    GP_ASSERT(index < _assignedLights.size());
+    return _assignedLights[index];
+}
+
+Node* Node::findAssignedLight(Light::Type type) const
+{
+    for (size_t i = 0, count = _assignedLights.size(); i < count; ++i)
+    {
+        Light* light = _assignedLights[i]->getLight();
+        if (light && light->getLightType() == type)
+            return _assignedLights[i];
+    }
+    return NULL;
+}
+
 Model* Node::getModel() const
 {
     return _model;
@@ -799,12 +962,17 @@ void Node::setModel(Model* model)
         }
 
         _model = model;
+        ++_componentRevision;
 
         if (_model)
         {
             _model->addRef();
             _model->setNode(this);
         }
+
+        // The joints of the model's skin are part of this node's hierarchy.
+        ++_hierarchyRevision;
+        setBoundsDirty();
     }
 }
 
@@ -824,6 +992,7 @@ void Node::setTerrain(Terrain* terrain)
         }
 
         _terrain = terrain;
+        ++_componentRevision;
 
         if (_terrain)
         {
@@ -851,6 +1020,7 @@ void Node::setForm(Form* form)
         }
 
         _form = form;
+        ++_componentRevision;
 
         if (_form)
         {
@@ -929,8 +1099,21 @@ const BoundingSphere& Node::getBoundingSphere() const
                 // since joint parent nodes that are not in the matrix palette do not need to
                 // be considered as directly transforming vertices on the GPU (they can instead
                 // be applied directly to the bounding volume transformation below).
-                GP_ASSERT(_model->getSkin()->getRootJoint());
-                Node* jointParent = _model->getSkin()->getRootJoint()->getParent();
+                MeshSkin* skin = _model->getSkin();
+                Node* jointParent = NULL;
+                if (skin->isSkeletonShared())
+                {
+                    // The skeleton keeps the matrix of the parent of its root joint.
+                    Matrix boundsMatrix;
+                    Matrix::multiply(getWorldMatrix(), skin->getSkeleton()->getRootMatrix(), &boundsMatrix);
+                    _bounds.transform(boundsMatrix);
+                    applyWorldTransform = false;
+                }
+                else
+                {
+                    GP_ASSERT(skin->getRootJoint());
+                    jointParent = skin->getRootJoint()->getParent();
+                }
                 if (jointParent)
                 {
                     // TODO: Should we protect against the case where joints are nested directly
@@ -975,6 +1158,19 @@ Node* Node::clone() const
     return cloneRecursive(context);
 }
 
+void Node::cloneInstances(unsigned int count, Node** instances, bool shareSkeletons) const
+{
+    GP_ASSERT(instances || count == 0);
+
+    NodeCloneContext context;
+    context.setSkeletonShared(shareSkeletons);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        instances[i] = cloneRecursive(context);
+        context.clear();
+    }
+}
+
 Node* Node::cloneSingleNode(NodeCloneContext &context) const
 {
     Node* copy = Node::create(getId());
@@ -998,6 +1194,10 @@ Node* Node::cloneRecursive(NodeCloneContext &context) const
     // Loop through the nodes backwards because addChild adds the node to the front.
     for (Node* child = lastChild; child != NULL; child = child->getPreviousSibling())
     {
+        // Skins that share their skeleton have no joints to clone.
+        if (context.isSkeletonShared() && child->getType() == Node::JOINT)
+            continue;
+
         Node* childCopy = child->cloneRecursive(context);
         GP_ASSERT(childCopy);
         copy->addChild(childCopy);
@@ -1040,13 +1240,14 @@ void Node::cloneInto(Node* node, NodeCloneContext &context) const
     }
     node->_world = _world;
     node->_bounds = _bounds;
+    node->_occluder = _occluder;
 
     // Note: Do not clone _userData - we can't make any assumptions about its content and how it's managed,
     // so it's the caller's responsibility to clone user data if needed.
 
     if (_tags)
     {
-        node->_tags = new std::map<std::string, std::string>(_tags->begin(), _tags->end());
+        node->_tags = new std::map<unsigned int, std::string>(_tags->begin(), _tags->end());
     }
 }
 
@@ -1066,6 +1267,7 @@ void Node::setAudioSource(AudioSource* audio)
         }
         
         _audioSource = audio;
+        ++_componentRevision;
 
         if (_audioSource)
         {
@@ -1091,6 +1293,7 @@ void Node::setParticleEmitter(ParticleEmitter* emitter)
         }
         
         _particleEmitter = emitter;
+        ++_componentRevision;
 
         if (_particleEmitter)
         {
@@ -1273,6 +1476,7 @@ void Node::setAgent(AIAgent* agent)
 }
 
 NodeCloneContext::NodeCloneContext()
+    : _skeletonShared(false)
 {
 }
 
@@ -1280,11 +1484,27 @@ NodeCloneContext::~NodeCloneContext()
 {
 }
 
+void NodeCloneContext::clear()
+{
+    _clonedAnimations.clear();
+    _clonedNodes.clear();
+}
+
+void NodeCloneContext::setSkeletonShared(bool shared)
+{
+    _skeletonShared = shared;
+}
+
+bool NodeCloneContext::isSkeletonShared() const
+{
+    return _skeletonShared;
+}
+
 Animation* NodeCloneContext::findClonedAnimation(const Animation* animation)
 {
     GP_ASSERT(animation);
 
-    std::map<const Animation*, Animation*>::iterator it = _clonedAnimations.find(animation);
+    std::map<const Animation*, Animation*, std::less<const Animation*>, PoolAllocator<std::pair<const Animation* const, Animation*> > >::iterator it = _clonedAnimations.find(animation);
     return it != _clonedAnimations.end() ? it->second : NULL;
 }
 
@@ -1300,7 +1520,7 @@ Node* NodeCloneContext::findClonedNode(const Node* node)
 {
     GP_ASSERT(node);
 
-    std::map<const Node*, Node*>::iterator it = _clonedNodes.find(node);
+    std::map<const Node*, Node*, std::less<const Node*>, PoolAllocator<std::pair<const Node* const, Node*> > >::iterator it = _clonedNodes.find(node);
     return it != _clonedNodes.end() ? it->second : NULL;
 }
 
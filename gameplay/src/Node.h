@@ -23,13 +23,17 @@ class Terrain;
 
 /**
  * Defines a basic hierarchical structure of transformation spaces.
+ *
+ * Nodes are allocated from a MemoryPool, so the nodes created together, such as the
+ * instances of cloneInstances(), are mostly contiguous in memory.
  */
-class Node : public Transform, public Ref
+class Node : public Transform, public Ref, public PoolObject<Node>
 {
     friend class Scene;
     friend class Bundle;
     friend class MeshSkin;
     friend class Light;
+    friend class Model;
 
 public:
 
@@ -151,6 +155,26 @@ public:
      */
     void setTag(const char* name, const char* value = "");
 
+    /**
+     * Determines whether the model of this node hides the nodes behind it from an OcclusionBuffer.
+     *
+     * @return True if the node is an occluder.
+     * @script{ignore}
+     */
+    bool isOccluder() const;
+
+    /**
+     * Sets whether the model of this node is drawn into an OcclusionBuffer, to hide the
+     * nodes behind it when occlusion queries are not available.
+     *
+     * Occluders should have simple, closed models loaded from a bundle. A node is not
+     * an occluder by default.
+     *
+     * @param occluder True if the node is an occluder.
+     * @script{ignore}
+     */
+    void setOccluder(bool occluder);
+
     /**
      * Returns the user pointer for this node.
      *
@@ -318,10 +342,25 @@ public:
      * Gets the world * view * projection matrix corresponding to this node based
      * on the scene's active camera.
      *
+     * The matrix is cached, and only computed again when the world matrix of the node or
+     * the revision of the camera changes (see getWorldRevision and Camera::getRevision).
+     *
      * @return The world * view * projection matrix of this node.
      */
     const Matrix& getWorldViewProjectionMatrix() const;
 
+    /**
+     * Returns the revision of the world matrix of this node.
+     *
+     * The revision is incremented whenever the transform of this node or of one of its
+     * parents changes, so values derived from the world matrix only need to be computed
+     * again when it differs from the revision they were computed for.
+     *
+     * @return The revision of the world matrix.
+     * @script{ignore}
+     */
+    unsigned int getWorldRevision() const;
+
     /**
      * Gets the translation vector (or position) of this Node in world space.
      *
@@ -329,6 +368,13 @@ public:
      */
     Vector3 getTranslationWorld() const;
 
+    /**
+     * Gets the translation vector (or position) of this Node in world space.
+     *
+     * @param dst The vector to store the result in.
+     */
+    void getTranslationWorld(Vector3* dst) const;
+
     /**
      * Gets the translation vector (or position) of this Node in view space.
      *
@@ -336,6 +382,13 @@ public:
      */
     Vector3 getTranslationView() const;
 
+    /**
+     * Gets the translation vector (or position) of this Node in view space.
+     *
+     * @param dst The vector to store the result in.
+     */
+    void getTranslationView(Vector3* dst) const;
+
     /**
      * Returns the forward vector of the Node in world space.
      *
@@ -343,6 +396,13 @@ public:
      */
     Vector3 getForwardVectorWorld() const;
 
+    /**
+     * Returns the forward vector of the Node in world space.
+     *
+     * @param dst The vector to store the result in.
+     */
+    void getForwardVectorWorld(Vector3* dst) const;
+
     /**
      * Returns the forward vector of the Node in view space.
      *
@@ -350,6 +410,13 @@ public:
      */
     Vector3 getForwardVectorView() const;
 
+    /**
+     * Returns the forward vector of the Node in view space.
+     *
+     * @param dst The vector to store the result in.
+     */
+    void getForwardVectorView(Vector3* dst) const;
+
     /**
      * Returns the right vector of the Node in world space.
      *
@@ -357,6 +424,13 @@ public:
      */
     Vector3 getRightVectorWorld() const;
 
+    /**
+     * Returns the right vector of the Node in world space.
+     *
+     * @param dst The vector to store the result in.
+     */
+    void getRightVectorWorld(Vector3* dst) const;
+
     /**
      * Returns the up vector of the Node in world space.
      *
@@ -364,6 +438,13 @@ public:
      */
     Vector3 getUpVectorWorld() const;
 
+    /**
+     * Returns the up vector of the Node in world space.
+     *
+     * @param dst The vector to store the result in.
+     */
+    void getUpVectorWorld(Vector3* dst) const;
+
     /**
      * Returns the translation vector of the currently active camera for this node's scene.
      *
@@ -420,6 +501,38 @@ public:
      */
     void setLight(Light* light);
 
+    /**
+     * Returns the number of light nodes assigned to this node by Scene::assignLights.
+     *
+     * @return The number of assigned lights.
+     * @script{ignore}
+     */
+    unsigned int getAssignedLightCount() const;
+
+    /**
+     * Returns a light node assigned to this node by Scene::assignLights.
+     *
+     * The lights are ordered from the most to the least influential. The nodes are not
+     * referenced, so they are only valid until they are removed from the scene, and until
+     * the lights are next assigned.
+     *
+     * @param index The index of the light, less than getAssignedLightCount().
+     *
+     * @return The node of the light.
+     * @script{ignore}
+     */
+    Node* getAssignedLight(unsigned int index) const;
+
+    /**
+     * Returns the most influential light node of a type assigned to this node by Scene::assignLights.
+     *
+     * @param type The type of light.
+     *
+     * @return The node of the light, or NULL if no light of the type is assigned.
+     * @script{ignore}
+     */
+    Node* findAssignedLight(Light::Type type) const;
+
     /**
      * Returns the pointer to this node's model.
      * 
@@ -650,6 +763,26 @@ public:
      */
     Node* clone() const;
 
+    /**
+     * Clones the node and all of its child nodes a number of times, such as to spawn the
+     * instances of a prefab.
+     *
+     * The instances share the meshes, material templates and animation curves of this node,
+     * as clone() does, and are cloned with a single clone context that is cleared between
+     * instances. Each instance is returned with a reference count of one.
+     *
+     * When skeletons are shared, the skinned models of the instances share the Skeleton of the
+     * skins of this node instead of cloning their joints, and Joint nodes are not cloned. Each
+     * skin of an instance keeps an array of the local transforms of its joints, which is posed
+     * with MeshSkin::setJointTransform or MeshSkin::copyPose.
+     *
+     * @param count The number of instances.
+     * @param instances Destination array of count nodes for the instances.
+     * @param shareSkeletons Whether the skinned models of the instances share their skeletons.
+     * @script{ignore}
+     */
+    void cloneInstances(unsigned int count, Node** instances, bool shareSkeletons = false) const;
+
 protected:
 
     /**
@@ -703,6 +836,33 @@ protected:
      */
     void hierarchyChanged();
 
+    /**
+     * Computes the world matrix of this Node from the world matrix of its parent if it is
+     * dirty, without updating its children.
+     *
+     * Used by Scene::updateWorldMatrices, which updates parents before their children.
+     */
+    void updateWorldMatrix() const;
+
+    /**
+     * Determines whether this Node's ID matches an ID searched for.
+     *
+     * @param id The ID searched for.
+     * @param idAtom The interned ID searched for, used for exact matches.
+     * @param exactMatch True to match the whole ID, false to match a prefix of it.
+     */
+    bool matchesId(const char* id, unsigned int idAtom, bool exactMatch) const;
+
+    /**
+     * Implements findNode with the ID interned once for the whole search.
+     */
+    Node* findNode(const char* id, unsigned int idAtom, bool recursive, bool exactMatch) const;
+
+    /**
+     * Implements findNodes with the ID interned once for the whole search.
+     */
+    unsigned int findNodes(const char* id, unsigned int idAtom, std::vector<Node*>& nodes, bool recursive, bool exactMatch) const;
+
     /**
      * Marks the bounding volume of the node as dirty.
      */
@@ -749,9 +909,9 @@ protected:
     Scene* _scene;
 
     /**
-     * The Node's ID.
+     * The Node's ID, interned in the StringId table.
      */ 
-    std::string _id;
+    unsigned int _id;
 
     /**
      * Pointer to the Node's first child.
@@ -779,9 +939,9 @@ protected:
     unsigned int _childCount;
 
     /**
-     * List of custom tags for a node.
+     * List of custom tags for a node, keyed by their interned names.
      */
-    std::map<std::string, std::string>* _tags;
+    std::map<unsigned int, std::string>* _tags;
 
     /**
      * Pointer to the Camera attached to the Node.
@@ -837,12 +997,52 @@ protected:
      * Dirty bits flag for the Node.
      */
     mutable int _dirtyBits;
+
+    /**
+     * Revision of the world matrix, incremented whenever it is marked dirty.
+     */
+    unsigned int _worldRevision;
+
+    /**
+     * The cached world * view * projection matrix, and the revisions it was computed for.
+     */
+    mutable Matrix _worldViewProj;
+    mutable unsigned int _worldViewProjWorldRevision;
+    mutable unsigned int _worldViewProjCameraRevision;
     
     /**
      * A flag indicating if the Node's hierarchy has changed.
      */ 
     bool _notifyHierarchyChanged;
 
+    /**
+     * Incremented whenever a node is attached to or detached from a parent, a scene or a
+     * skin, so that scenes know when to rebuild their flattened hierarchies.
+     */
+    static unsigned int _hierarchyRevision;
+
+    /**
+     * Incremented whenever the ID or the tags of a node change, so that scenes know when to
+     * rebuild their node indices.
+     */
+    static unsigned int _idRevision;
+
+    /**
+     * Incremented whenever a model, light, camera, particle emitter, terrain, form or audio
+     * source is set on a node, so that scenes know when to rebuild their component lists.
+     */
+    static unsigned int _componentRevision;
+
+    /**
+     * Whether the model of the Node is drawn into occlusion buffers.
+     */
+    bool _occluder;
+
+    /**
+     * The light nodes assigned by Scene::assignLights, from the most influential.
+     */
+    std::vector<Node*> _assignedLights;
+
     /**
      * The Bounding Sphere containing the Node.
      */
@@ -881,6 +1081,11 @@ public:
      */
     ~NodeCloneContext();
 
+    /**
+     * Forgets the animations and nodes that were registered, so the context can be used to clone again.
+     */
+    void clear();
+
     /**
      * Finds the cloned animation of the given animation or NULL if this animation was not registered with this context.
      * 
@@ -915,6 +1120,20 @@ public:
      */
     void registerClonedNode(const Node* original, Node* clone);
 
+    /**
+     * Sets whether cloned skins share the skeleton of their original rather than clone its joints.
+     *
+     * @param shared Whether skeletons are shared.
+     */
+    void setSkeletonShared(bool shared);
+
+    /**
+     * Returns whether cloned skins share the skeleton of their original.
+     *
+     * @return Whether skeletons are shared.
+     */
+    bool isSkeletonShared() const;
+
 private:
     
     /**
@@ -927,8 +1146,9 @@ private:
      */
     NodeCloneContext& operator=(const NodeCloneContext&);
 
-    std::map<const Animation*, Animation*> _clonedAnimations;
-    std::map<const Node*, Node*> _clonedNodes;
+    std::map<const Animation*, Animation*, std::less<const Animation*>, PoolAllocator<std::pair<const Animation* const, Animation*> > > _clonedAnimations;
+    std::map<const Node*, Node*, std::less<const Node*>, PoolAllocator<std::pair<const Node* const, Node*> > > _clonedNodes;
+    bool _skeletonShared;
 };
 
 }
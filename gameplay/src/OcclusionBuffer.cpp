@@ -0,0 +1,403 @@
+#include "Base.h"
+#include "OcclusionBuffer.h"
+#include "Node.h"
+#include "Model.h"
+#include "Bundle.h"
+
+#if defined(USE_NEON)
+    #include <arm_neon.h>
+#elif defined(USE_SSE)
+    #include <xmmintrin.h>
+#endif
+
+namespace gameplay
+{
+
+// Four lanes of floats, used to rasterize and test four pixels of a row at a time.
+#if defined(USE_NEON)
+
+typedef float32x4_t Float4;
+
+static inline Float4 loadFloat4(const float* p) { return vld1q_f32(p); }
+static inline void storeFloat4(float* p, Float4 v) { vst1q_f32(p, v); }
+static inline Float4 splatFloat4(float f) { return vdupq_n_f32(f); }
+static inline Float4 addFloat4(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+static inline Float4 mulFloat4(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+static inline Float4 minFloat4(Float4 a, Float4 b) { return vminq_f32(a, b); }
+static inline Float4 rampFloat4()
+{
+    static const float ramp[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+    return vld1q_f32(ramp);
+}
+static inline Float4 selectInsideFloat4(Float4 e0, Float4 e1, Float4 e2, Float4 inside, Float4 outside)
+{
+    float32x4_t zero = vdupq_n_f32(0.0f);
+    uint32x4_t mask = vandq_u32(vandq_u32(vcgeq_f32(e0, zero), vcgeq_f32(e1, zero)), vcgeq_f32(e2, zero));
+    return vbslq_f32(mask, inside, outside);
+}
+static inline bool anyLessEqualFloat4(Float4 a, Float4 b)
+{
+    uint32x4_t mask = vcleq_f32(a, b);
+    uint32x2_t halves = vorr_u32(vget_low_u32(mask), vget_high_u32(mask));
+    return (vget_lane_u32(halves, 0) | vget_lane_u32(halves, 1)) != 0;
+}
+
+#elif defined(USE_SSE)
+
+typedef __m128 Float4;
+
+static inline Float4 loadFloat4(const float* p) { return _mm_loadu_ps(p); }
+static inline void storeFloat4(float* p, Float4 v) { _mm_storeu_ps(p, v); }
+static inline Float4 splatFloat4(float f) { return _mm_set1_ps(f); }
+static inline Float4 addFloat4(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+static inline Float4 mulFloat4(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+static inline Float4 minFloat4(Float4 a, Float4 b) { return _mm_min_ps(a, b); }
+static inline Float4 rampFloat4() { return _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f); }
+static inline Float4 selectInsideFloat4(Float4 e0, Float4 e1, Float4 e2, Float4 inside, Float4 outside)
+{
+    __m128 zero = _mm_setzero_ps();
+    __m128 mask = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+    return _mm_or_ps(_mm_and_ps(mask, inside), _mm_andnot_ps(mask, outside));
+}
+static inline bool anyLessEqualFloat4(Float4 a, Float4 b) { return _mm_movemask_ps(_mm_cmple_ps(a, b)) != 0; }
+
+#else
+
+struct Float4
+{
+    float v[4];
+};
+
+static inline Float4 loadFloat4(const float* p) { Float4 r = { { p[0], p[1], p[2], p[3] } }; return r; }
+static inline void storeFloat4(float* p, Float4 v) { p[0] = v.v[0]; p[1] = v.v[1]; p[2] = v.v[2]; p[3] = v.v[3]; }
+static inline Float4 splatFloat4(float f) { Float4 r = { { f, f, f, f } }; return r; }
+static inline Float4 addFloat4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+static inline Float4 mulFloat4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+static inline Float4 minFloat4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] = std::min(a.v[i], b.v[i]); return a; }
+static inline Float4 rampFloat4() { Float4 r = { { 0.0f, 1.0f, 2.0f, 3.0f } }; return r; }
+static inline Float4 selectInsideFloat4(Float4 e0, Float4 e1, Float4 e2, Float4 inside, Float4 outside)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        if (e0.v[i] < 0.0f || e1.v[i] < 0.0f || e2.v[i] < 0.0f)
+            inside.v[i] = outside.v[i];
+    }
+    return inside;
+}
+static inline bool anyLessEqualFloat4(Float4 a, Float4 b)
+{
+    return a.v[0] <= b.v[0] || a.v[1] <= b.v[1] || a.v[2] <= b.v[2] || a.v[3] <= b.v[3];
+}
+
+#endif
+
+/**
+ * Transforms a point to clip space and then to the pixels and depth of a buffer.
+ *
+ * @return False if the point is in front of the near plane.
+ */
+static bool projectPoint(const Matrix& m, float x, float y, float z, float width, float height, Vector3* dst)
+{
+    float cx = m.m[0] * x + m.m[4] * y + m.m[8] * z + m.m[12];
+    float cy = m.m[1] * x + m.m[5] * y + m.m[9] * z + m.m[13];
+    float cz = m.m[2] * x + m.m[6] * y + m.m[10] * z + m.m[14];
+    float cw = m.m[3] * x + m.m[7] * y + m.m[11] * z + m.m[15];
+    if (cz < -cw || cw <= MATH_EPSILON)
+        return false;
+
+    float invW = 1.0f / cw;
+    dst->x = (cx * invW * 0.5f + 0.5f) * width;
+    dst->y = (cy * invW * 0.5f + 0.5f) * height;
+    dst->z = cz * invW * 0.5f + 0.5f;
+    return true;
+}
+
+OcclusionBuffer::OcclusionBuffer(unsigned int width, unsigned int height)
+    : _width(width), _height(height), _depth(NULL), _triangleCount(0)
+{
+    _depth = new float[_width * _height];
+    for (unsigned int i = 0, count = _width * _height; i < count; ++i)
+        _depth[i] = 1.0f;
+}
+
+OcclusionBuffer::~OcclusionBuffer()
+{
+    for (std::map<Mesh*, Geometry*>::iterator itr = _geometries.begin(); itr != _geometries.end(); ++itr)
+    {
+        itr->first->release();
+        SAFE_DELETE(itr->second);
+    }
+    _geometries.clear();
+
+    SAFE_DELETE_ARRAY(_depth);
+}
+
+OcclusionBuffer* OcclusionBuffer::create(unsigned int width, unsigned int height)
+{
+    // Rows are processed in blocks of four pixels.
+    width = std::max((width + 3) & ~3u, 4u);
+    height = std::max(height, 1u);
+    return new OcclusionBuffer(width, height);
+}
+
+unsigned int OcclusionBuffer::getWidth() const
+{
+    return _width;
+}
+
+unsigned int OcclusionBuffer::getHeight() const
+{
+    return _height;
+}
+
+void OcclusionBuffer::clear(const Matrix& viewProjection)
+{
+    _viewProjection = viewProjection;
+    _triangleCount = 0;
+
+    Float4 farDepth = splatFloat4(1.0f);
+    for (unsigned int i = 0, count = _width * _height; i < count; i += 4)
+        storeFloat4(_depth + i, farDepth);
+}
+
+bool OcclusionBuffer::drawOccluder(Node* node)
+{
+    GP_ASSERT(node);
+
+    Model* model = node->getModel();
+    const Geometry* geometry = model ? getGeometry(model->getMesh()) : NULL;
+    if (geometry == NULL)
+        return false;
+
+    // Project every vertex once; triangles with a vertex in front of the near plane are skipped.
+    Matrix m;
+    Matrix::multiply(_viewProjection, node->getWorldMatrix(), &m);
+    size_t vertexCount = geometry->positions.size() / 3;
+    _screenPositions.resize(vertexCount);
+    _clipped.resize(vertexCount);
+    const float* p = &geometry->positions[0];
+    for (size_t i = 0; i < vertexCount; ++i, p += 3)
+    {
+        _clipped[i] = !projectPoint(m, p[0], p[1], p[2], (float)_width, (float)_height, &_screenPositions[i]);
+    }
+
+    const std::vector<unsigned int>& indices = geometry->indices;
+    for (size_t i = 0, count = indices.size(); i + 2 < count; i += 3)
+    {
+        unsigned int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+        if (!_clipped[a] && !_clipped[b] && !_clipped[c])
+            drawTriangle(_screenPositions[a], _screenPositions[b], _screenPositions[c]);
+    }
+
+    return true;
+}
+
+void OcclusionBuffer::drawTriangle(const Vector3& v0, const Vector3& v1, const Vector3& v2)
+{
+    // Front faces wind counter-clockwise, with y pointing up the buffer.
+    float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+    if (area <= MATH_EPSILON)
+        return;
+
+    int minX = std::max((int)std::min(v0.x, std::min(v1.x, v2.x)), 0);
+    int maxX = std::min((int)std::max(v0.x, std::max(v1.x, v2.x)), (int)_width - 1);
+    int minY = std::max((int)std::min(v0.y, std::min(v1.y, v2.y)), 0);
+    int maxY = std::min((int)std::max(v0.y, std::max(v1.y, v2.y)), (int)_height - 1);
+    if (minX > maxX || minY > maxY)
+        return;
+    ++_triangleCount;
+
+    // Edge functions and depth are linear in screen space, so they are stepped across the pixels.
+    // An edge function is non-negative on the inner side of its edge.
+    float invArea = 1.0f / area;
+    float dzdx = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) * invArea;
+    float dzdy = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) * invArea;
+    const Vector3* a[3] = { &v0, &v1, &v2 };
+    const Vector3* b[3] = { &v1, &v2, &v0 };
+    float stepX[3], stepY[3], origin[3];
+
+    // Start at the centre of the first pixel of the first block of the bounds.
+    minX &= ~3;
+    float x = minX + 0.5f;
+    float y = minY + 0.5f;
+    for (int i = 0; i < 3; ++i)
+    {
+        stepX[i] = -(b[i]->y - a[i]->y);
+        stepY[i] = b[i]->x - a[i]->x;
+        origin[i] = stepY[i] * (y - a[i]->y) + stepX[i] * (x - a[i]->x);
+    }
+    float depthOrigin = v0.z + dzdx * (x - v0.x) + dzdy * (y - v0.y);
+
+    Float4 ramp = rampFloat4();
+    Float4 edgeStep0 = mulFloat4(ramp, splatFloat4(stepX[0]));
+    Float4 edgeStep1 = mulFloat4(ramp, splatFloat4(stepX[1]));
+    Float4 edgeStep2 = mulFloat4(ramp, splatFloat4(stepX[2]));
+    Float4 depthStep = mulFloat4(ramp, splatFloat4(dzdx));
+    Float4 farDepth = splatFloat4(1.0f);
+    for (int row = minY; row <= maxY; ++row)
+    {
+        float* depth = _depth + row * _width;
+        for (int column = minX; column <= maxX; column += 4)
+        {
+            float offset = (float)(column - minX);
+            Float4 e0 = addFloat4(splatFloat4(origin[0] + stepX[0] * offset), edgeStep0);
+            Float4 e1 = addFloat4(splatFloat4(origin[1] + stepX[1] * offset), edgeStep1);
+            Float4 e2 = addFloat4(splatFloat4(origin[2] + stepX[2] * offset), edgeStep2);
+            Float4 z = addFloat4(splatFloat4(depthOrigin + dzdx * offset), depthStep);
+
+            // Keep the nearest depth of the pixels inside the triangle.
+            Float4 current = loadFloat4(depth + column);
+            storeFloat4(depth + column, minFloat4(current, selectInsideFloat4(e0, e1, e2, z, farDepth)));
+        }
+
+        for (int i = 0; i < 3; ++i)
+            origin[i] += stepY[i];
+        depthOrigin += dzdy;
+    }
+}
+
+bool OcclusionBuffer::isVisible(const BoundingBox& bounds) const
+{
+    if (bounds.isEmpty())
+        return false;
+
+    // Boxes that cross the near plane cannot be projected, and are assumed visible.
+    Vector3 corners[8];
+    bounds.getCorners(corners);
+    Vector3 screen;
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX, minZ = FLT_MAX;
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+        if (!projectPoint(_viewProjection, corners[i].x, corners[i].y, corners[i].z, (float)_width, (float)_height, &screen))
+            return true;
+        minX = std::min(minX, screen.x);
+        maxX = std::max(maxX, screen.x);
+        minY = std::min(minY, screen.y);
+        maxY = std::max(maxY, screen.y);
+        minZ = std::min(minZ, screen.z);
+    }
+
+    // Test the nearest depth of the box against every pixel its screen rectangle touches.
+    int x1 = std::max((int)floorf(minX), 0);
+    int x2 = std::min((int)ceilf(maxX), (int)_width - 1);
+    int y1 = std::max((int)floorf(minY), 0);
+    int y2 = std::min((int)ceilf(maxY), (int)_height - 1);
+    if (x1 > x2 || y1 > y2)
+        return true;
+
+    Float4 z = splatFloat4(minZ);
+    x1 &= ~3;
+    for (int row = y1; row <= y2; ++row)
+    {
+        const float* depth = _depth + row * _width;
+        for (int column = x1; column <= x2; column += 4)
+        {
+            if (anyLessEqualFloat4(z, loadFloat4(depth + column)))
+                return true;
+        }
+    }
+    return false;
+}
+
+unsigned int OcclusionBuffer::getTriangleCount() const
+{
+    return _triangleCount;
+}
+
+const OcclusionBuffer::Geometry* OcclusionBuffer::getGeometry(Mesh* mesh)
+{
+    GP_ASSERT(mesh);
+
+    std::map<Mesh*, Geometry*>::iterator itr = _geometries.find(mesh);
+    if (itr != _geometries.end())
+        return itr->second;
+
+    // Meshes whose triangles cannot be read are remembered as well, so they are only read once.
+    Geometry* geometry = readGeometry(mesh);
+    mesh->addRef();
+    _geometries[mesh] = geometry;
+    return geometry;
+}
+
+OcclusionBuffer::Geometry* OcclusionBuffer::readGeometry(Mesh* mesh)
+{
+    GP_ASSERT(mesh);
+
+    if (mesh->getPrimitiveType() != Mesh::TRIANGLES || strlen(mesh->getUrl()) == 0)
+    {
+        GP_WARN("Occluder meshes must be loaded from a bundle and have the TRIANGLES primitive type.");
+        return NULL;
+    }
+
+    Bundle::MeshData* data = Bundle::readMeshData(mesh->getUrl());
+    if (data == NULL)
+    {
+        GP_WARN("Failed to load occluder mesh data from url '%s'.", mesh->getUrl());
+        return NULL;
+    }
+
+    // Find the positions among the elements of the vertices.
+    unsigned int offset = 0;
+    bool found = false;
+    for (unsigned int i = 0, count = data->vertexFormat.getElementCount(); i < count; ++i)
+    {
+        const VertexFormat::Element& element = data->vertexFormat.getElement(i);
+        if (element.usage == VertexFormat::POSITION)
+        {
+            found = element.size >= 3 && element.type == VertexFormat::FLOAT;
+            break;
+        }
+        offset += element.getByteSize();
+    }
+    if (!found)
+    {
+        GP_WARN("Occluder mesh '%s' has no vertex positions.", mesh->getUrl());
+        SAFE_DELETE(data);
+        return NULL;
+    }
+
+    Geometry* geometry = new Geometry();
+    unsigned int stride = data->vertexFormat.getVertexSize();
+    geometry->positions.resize(data->vertexCount * 3);
+    for (unsigned int i = 0; i < data->vertexCount; ++i)
+    {
+        memcpy(&geometry->positions[i * 3], data->vertexData + i * stride + offset, sizeof(float) * 3);
+    }
+
+    if (data->parts.empty())
+    {
+        for (unsigned int i = 0; i < data->vertexCount; ++i)
+            geometry->indices.push_back(i);
+    }
+    for (size_t i = 0, count = data->parts.size(); i < count; ++i)
+    {
+        const Bundle::MeshPartData* part = data->parts[i];
+        if (part->primitiveType != Mesh::TRIANGLES)
+            continue;
+
+        for (unsigned int j = 0; j < part->indexCount; ++j)
+        {
+            unsigned int index;
+            switch (part->indexFormat)
+            {
+            case Mesh::INDEX8:
+                index = part->indexData[j];
+                break;
+            case Mesh::INDEX16:
+                index = ((const unsigned short*)part->indexData)[j];
+                break;
+            default:
+                index = ((const unsigned int*)part->indexData)[j];
+                break;
+            }
+            geometry->indices.push_back(std::min(index, data->vertexCount - 1));
+        }
+    }
+    SAFE_DELETE(data);
+
+    if (geometry->positions.empty())
+        SAFE_DELETE(geometry);
+    return geometry;
+}
+
+}
@@ -0,0 +1,139 @@
+#ifndef OCCLUSIONBUFFER_H_
+#define OCCLUSIONBUFFER_H_
+
+#include "Ref.h"
+#include "Matrix.h"
+#include "BoundingBox.h"
+
+namespace gameplay
+{
+
+class Node;
+class Mesh;
+
+/**
+ * Defines a low resolution depth buffer that occluders are rasterized into on the CPU.
+ *
+ * The buffer is used to cull nodes on hardware without occlusion queries. The models of
+ * nodes marked as occluders (see Node::setOccluder) are drawn into the buffer, and the
+ * bounding boxes of other nodes are then tested against it before they are drawn. Pixels
+ * are rasterized and tested four at a time, using SSE or NEON where they are available.
+ *
+ * The triangles of occluders are read from the bundles their meshes were loaded from,
+ * the first time each mesh is drawn, and kept until the buffer is destroyed. Occluders
+ * should therefore be simple, closed meshes, such as the walls of buildings. Triangles
+ * that cross the near plane of the camera are not drawn, and back faces are culled.
+ *
+ * @script{ignore}
+ */
+class OcclusionBuffer : public Ref
+{
+public:
+
+    /**
+     * Creates an occlusion buffer.
+     *
+     * @param width The width of the buffer in pixels, which is rounded up to a multiple of four.
+     * @param height The height of the buffer in pixels.
+     *
+     * @return The new occlusion buffer.
+     */
+    static OcclusionBuffer* create(unsigned int width = 256, unsigned int height = 128);
+
+    /**
+     * Returns the width of the buffer.
+     *
+     * @return The width in pixels.
+     */
+    unsigned int getWidth() const;
+
+    /**
+     * Returns the height of the buffer.
+     *
+     * @return The height in pixels.
+     */
+    unsigned int getHeight() const;
+
+    /**
+     * Clears the buffer, and sets the view projection matrix that occluders are drawn and
+     * bounds are tested with until the next call to clear().
+     *
+     * @param viewProjection The view projection matrix of the camera.
+     */
+    void clear(const Matrix& viewProjection);
+
+    /**
+     * Draws the model of a node into the buffer.
+     *
+     * @param node The node, which should have a model loaded from a bundle.
+     *
+     * @return True if the model was drawn, false if its triangles could not be read.
+     */
+    bool drawOccluder(Node* node);
+
+    /**
+     * Determines whether any part of a bounding box is in front of the occluders drawn since the last clear().
+     *
+     * @param bounds The bounding box, in world space.
+     *
+     * @return True if the box may be visible, false if it is hidden by the occluders.
+     */
+    bool isVisible(const BoundingBox& bounds) const;
+
+    /**
+     * Returns the number of triangles drawn since the last call to clear().
+     *
+     * @return The number of triangles.
+     */
+    unsigned int getTriangleCount() const;
+
+private:
+
+    /**
+     * The triangles of an occluder mesh.
+     */
+    struct Geometry
+    {
+        std::vector<float> positions;
+        std::vector<unsigned int> indices;
+    };
+
+    /**
+     * Constructor.
+     */
+    OcclusionBuffer(unsigned int width, unsigned int height);
+
+    /**
+     * Destructor.
+     */
+    ~OcclusionBuffer();
+
+    /**
+     * Hidden copy constructor.
+     */
+    OcclusionBuffer(const OcclusionBuffer&);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    OcclusionBuffer& operator=(const OcclusionBuffer&);
+
+    const Geometry* getGeometry(Mesh* mesh);
+
+    static Geometry* readGeometry(Mesh* mesh);
+
+    void drawTriangle(const Vector3& v0, const Vector3& v1, const Vector3& v2);
+
+    unsigned int _width;
+    unsigned int _height;
+    float* _depth;
+    Matrix _viewProjection;
+    std::map<Mesh*, Geometry*> _geometries;
+    std::vector<Vector3> _screenPositions;
+    std::vector<bool> _clipped;
+    unsigned int _triangleCount;
+};
+
+}
+
+#endif
@@ -0,0 +1,350 @@
+#include "Base.h"
+#include "GLStateCache.h"
+#include "RenderStats.h"
+#include "OcclusionCuller.h"
+#include "Node.h"
+#include "Camera.h"
+#include "Model.h"
+#include "MeshPart.h"
+#include "MeshSkin.h"
+#include "Terrain.h"
+#include "OcclusionBuffer.h"
+
+namespace gameplay
+{
+
+// Indices of the triangles of a box, with the corners in the order of BoundingBox::getCorners().
+static const unsigned short __boxIndices[36] =
+{
+    0, 1, 2, 0, 2, 3,   // front
+    4, 5, 6, 4, 6, 7,   // back
+    3, 2, 5, 3, 5, 4,   // right
+    7, 6, 1, 7, 1, 0,   // left
+    0, 3, 4, 0, 4, 7,   // top
+    1, 6, 5, 1, 5, 2    // bottom
+};
+
+static int __supported = -1;
+
+#ifdef USE_OCCLUSION_QUERY
+static GLenum getQueryTarget()
+{
+#if defined(OPENGL_ES)
+    return GL_ANY_SAMPLES_PASSED_CONSERVATIVE;
+#elif defined(__glew_h__)
+    // Any samples passed queries can stop counting at the first sample.
+    return GLEW_ARB_occlusion_query2 ? GL_ANY_SAMPLES_PASSED : GL_SAMPLES_PASSED;
+#else
+    return GL_SAMPLES_PASSED;
+#endif
+}
+#endif
+
+OcclusionCuller::OcclusionCuller(Mode mode)
+    : _mode(mode), _buffer(NULL), _box(NULL), _frame(0), _occludedCount(0), _queryCount(0)
+{
+    if (_mode == SOFTWARE)
+        _buffer = OcclusionBuffer::create();
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+    for (std::map<Node*, NodeState>::iterator itr = _states.begin(); itr != _states.end(); ++itr)
+    {
+#ifdef USE_OCCLUSION_QUERY
+        if (itr->second.query)
+            GL_ASSERT( glDeleteQueries(1, &itr->second.query) );
+#endif
+        itr->first->release();
+    }
+    _states.clear();
+
+    SAFE_RELEASE(_box);
+    SAFE_RELEASE(_buffer);
+}
+
+OcclusionCuller* OcclusionCuller::create()
+{
+    return new OcclusionCuller(isSupported() ? HARDWARE : SOFTWARE);
+}
+
+OcclusionCuller* OcclusionCuller::create(Mode mode)
+{
+    return new OcclusionCuller(mode);
+}
+
+bool OcclusionCuller::isSupported()
+{
+    if (__supported == -1)
+    {
+#if defined(USE_OCCLUSION_QUERY) && defined(OPENGL_ES)
+        const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+        __supported = (extensions && strstr(extensions, "GL_EXT_occlusion_query_boolean")) ? 1 : 0;
+#elif defined(USE_OCCLUSION_QUERY)
+        __supported = 1;
+#else
+        __supported = 0;
+#endif
+    }
+    return __supported == 1;
+}
+
+OcclusionCuller::Mode OcclusionCuller::getMode() const
+{
+    return _mode;
+}
+
+OcclusionBuffer* OcclusionCuller::getOcclusionBuffer() const
+{
+    return _buffer;
+}
+
+void OcclusionCuller::initialize()
+{
+    // Vertex shader for drawing the bounding boxes of nodes, which are already in world space.
+    const char* vs_str =
+    {
+        "uniform mat4 u_viewProjectionMatrix;\n"
+        "attribute vec4 a_position;\n"
+        "void main(void) {\n"
+        "    gl_Position = u_viewProjectionMatrix * a_position;\n"
+        "}"
+    };
+
+    // Fragment shader for drawing the bounding boxes, whose color is not written.
+    const char* fs_str =
+    {
+    #ifdef OPENGL_ES
+        "precision mediump float;\n"
+    #endif
+        "void main(void) {\n"
+        "   gl_FragColor = vec4(1.0);\n"
+        "}"
+    };
+
+    VertexFormat::Element element(VertexFormat::POSITION, 3);
+    Mesh* mesh = Mesh::createMesh(VertexFormat(&element, 1), 8, true);
+    MeshPart* part = mesh->addPart(Mesh::TRIANGLES, Mesh::INDEX16, 36, false);
+    part->setIndexData(__boxIndices, 0, 36);
+    _box = Model::create(mesh);
+    SAFE_RELEASE(mesh);
+
+    Effect* effect = Effect::createFromSource(vs_str, fs_str);
+    Material* material = Material::create(effect);
+    SAFE_RELEASE(effect);
+    GP_ASSERT(material && material->getStateBlock());
+
+    // Boxes are tested against the depth of the scene without changing it, and must be
+    // counted even when the camera sees their back faces.
+    RenderState::StateBlock* state = material->getStateBlock();
+    state->setDepthTest(true);
+    state->setDepthWrite(false);
+    state->setCullFace(false);
+    _box->setMaterial(material);
+    SAFE_RELEASE(material);
+}
+
+bool OcclusionCuller::isCullable(Node* node)
+{
+    GP_ASSERT(node);
+
+    // Skinned models are animated beyond the bounds of their mesh.
+    Model* model = node->getModel();
+    return model && model->getSkin() == NULL && node->getTerrain() == NULL && !model->getMesh()->getBoundingBox().isEmpty();
+}
+
+bool OcclusionCuller::isInside(Camera* camera, const BoundingBox& bounds) const
+{
+    // The near plane clips boxes the camera is in or very close to, so their queries would fail.
+    Node* cameraNode = camera->getNode();
+    Vector3 eye = cameraNode ? cameraNode->getTranslationWorld() : Vector3::zero();
+    float margin = camera->getNearPlane() * 2.0f;
+    return eye.x >= bounds.min.x - margin && eye.x <= bounds.max.x + margin &&
+           eye.y >= bounds.min.y - margin && eye.y <= bounds.max.y + margin &&
+           eye.z >= bounds.min.z - margin && eye.z <= bounds.max.z + margin;
+}
+
+unsigned int OcclusionCuller::cull(Camera* camera, std::vector<Node*>& nodes)
+{
+    GP_ASSERT(camera);
+
+    ++_frame;
+    _occludedCount = 0;
+    _queryNodes.clear();
+
+    if (_mode == SOFTWARE)
+    {
+        cullSoftware(camera, nodes);
+        return _occludedCount;
+    }
+
+    size_t visibleCount = 0;
+    for (size_t i = 0, count = nodes.size(); i < count; ++i)
+    {
+        Node* node = nodes[i];
+        bool visible = true;
+
+        if (isSupported() && isCullable(node))
+        {
+            std::map<Node*, NodeState>::iterator itr = _states.find(node);
+            if (itr == _states.end())
+            {
+                // Nodes that just came into view are drawn until they are found to be occluded.
+                NodeState state;
+                state.query = 0;
+                state.visible = true;
+                state.pending = false;
+                itr = _states.insert(std::make_pair(node, state)).first;
+                node->addRef();
+            }
+
+            NodeState& state = itr->second;
+#ifdef USE_OCCLUSION_QUERY
+            if (state.pending)
+            {
+                GLuint available = 0;
+                GL_ASSERT( glGetQueryObjectuiv(state.query, GL_QUERY_RESULT_AVAILABLE, &available) );
+                if (available)
+                {
+                    GLuint samples = 0;
+                    GL_ASSERT( glGetQueryObjectuiv(state.query, GL_QUERY_RESULT, &samples) );
+                    state.visible = samples > 0;
+                    state.pending = false;
+                }
+            }
+#endif
+            state.frame = _frame;
+            visible = state.visible;
+            _queryNodes.push_back(node);
+        }
+
+        if (visible)
+            nodes[visibleCount++] = node;
+        else
+            ++_occludedCount;
+    }
+    nodes.resize(visibleCount);
+
+    // Forget the nodes that left the frustum; they are assumed visible when they come back.
+    for (std::map<Node*, NodeState>::iterator itr = _states.begin(); itr != _states.end(); )
+    {
+        if (itr->second.frame != _frame)
+        {
+#ifdef USE_OCCLUSION_QUERY
+            if (itr->second.query)
+                GL_ASSERT( glDeleteQueries(1, &itr->second.query) );
+#endif
+            itr->first->release();
+            _states.erase(itr++);
+        }
+        else
+        {
+            ++itr;
+        }
+    }
+
+    return _occludedCount;
+}
+
+void OcclusionCuller::cullSoftware(Camera* camera, std::vector<Node*>& nodes)
+{
+    GP_ASSERT(_buffer);
+
+    // Draw the occluders before testing anything, so the order of the nodes does not matter.
+    _buffer->clear(camera->getViewProjectionMatrix());
+    bool drawn = false;
+    for (size_t i = 0, count = nodes.size(); i < count; ++i)
+    {
+        if (nodes[i]->isOccluder() && nodes[i]->getModel())
+            drawn |= _buffer->drawOccluder(nodes[i]);
+    }
+    if (!drawn)
+        return;
+
+    size_t visibleCount = 0;
+    for (size_t i = 0, count = nodes.size(); i < count; ++i)
+    {
+        Node* node = nodes[i];
+        bool visible = true;
+        if (!node->isOccluder() && isCullable(node))
+        {
+            BoundingBox bounds(node->getModel()->getMesh()->getBoundingBox());
+            bounds.transform(node->getWorldMatrix());
+            visible = _buffer->isVisible(bounds);
+        }
+
+        if (visible)
+            nodes[visibleCount++] = node;
+        else
+            ++_occludedCount;
+    }
+    nodes.resize(visibleCount);
+}
+
+void OcclusionCuller::query(Camera* camera)
+{
+    GP_ASSERT(camera);
+
+    _queryCount = 0;
+    if (_mode == SOFTWARE || _queryNodes.empty())
+        return;
+
+#ifdef USE_OCCLUSION_QUERY
+    if (_box == NULL)
+        initialize();
+
+    Material* material = _box->getMaterial();
+    material->getParameter("u_viewProjectionMatrix")->setValue(camera->getViewProjectionMatrix());
+    Pass* pass = material->getTechnique()->getPassByIndex(0);
+    pass->bind();
+    GL_ASSERT( glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE) );
+    GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _box->getMesh()->getPart(0)->getIndexBuffer());
+
+    GLenum target = getQueryTarget();
+    Vector3 corners[8];
+    for (size_t i = 0, count = _queryNodes.size(); i < count; ++i)
+    {
+        Node* node = _queryNodes[i];
+        NodeState& state = _states[node];
+
+        // Wait for the previous query of the node, rather than stalling on its result.
+        if (state.pending)
+            continue;
+
+        BoundingBox bounds(node->getModel()->getMesh()->getBoundingBox());
+        bounds.transform(node->getWorldMatrix());
+        if (isInside(camera, bounds))
+        {
+            state.visible = true;
+            continue;
+        }
+
+        if (state.query == 0)
+            GL_ASSERT( glGenQueries(1, &state.query) );
+
+        bounds.getCorners(corners);
+        _box->getMesh()->setVertexData(&corners[0].x, 0, 8);
+        GL_ASSERT( glBeginQuery(target, state.query) );
+        GL_ASSERT( glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_SHORT, 0) );
+        RenderStats::addDraw(GL_TRIANGLES, 36);
+        GL_ASSERT( glEndQuery(target) );
+        state.pending = true;
+        ++_queryCount;
+    }
+
+    GL_ASSERT( glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE) );
+    pass->unbind();
+#endif
+}
+
+unsigned int OcclusionCuller::getOccludedNodeCount() const
+{
+    return _occludedCount;
+}
+
+unsigned int OcclusionCuller::getQueryCount() const
+{
+    return _queryCount;
+}
+
+}
@@ -0,0 +1,201 @@
+#ifndef OCCLUSIONCULLER_H_
+#define OCCLUSIONCULLER_H_
+
+#include "Ref.h"
+#include "BoundingBox.h"
+
+namespace gameplay
+{
+
+class Node;
+class Camera;
+class Model;
+class OcclusionBuffer;
+
+/**
+ * Defines a culler that rejects nodes hidden behind other geometry.
+ *
+ * The culler either uses GPU occlusion queries, or rasterizes the nodes marked as occluders
+ * (see Node::setOccluder) into an OcclusionBuffer on the CPU, for hardware without queries.
+ *
+ * The culler filters the nodes that passed frustum culling (see Scene::findVisibleNodes).
+ * The bounding box of each node is drawn into the depth buffer of the scene, after the scene
+ * was drawn, with a query that tells whether any of it is in front of the drawn geometry.
+ * The queries are read a frame later, so the pipeline never waits for them: nodes are drawn
+ * or skipped based on the results of the previous frame. A node that becomes visible is
+ * therefore drawn one frame late, and nodes for which no result is available yet are
+ * assumed to keep their visibility. Nodes the camera is inside, nodes with a terrain and
+ * nodes with a skinned model are never culled.
+ *
+ * In software mode, the occluders among the nodes passed to cull() are drawn into the
+ * buffer first, and the bounds of the other nodes are tested against it right away, so
+ * there is no frame of latency and query() does nothing. Occluders themselves are never
+ * culled in this mode.
+ *
+ * A frame is drawn with the culler as follows:
+ *
+ @verbatim
+    std::vector<Node*> nodes;
+    scene->findVisibleNodes(nodes);
+    culler->cull(camera, nodes);
+    // ... draw nodes ...
+    culler->query(camera);
+ @endverbatim
+ *
+ * Occlusion queries require OpenGL 1.5 or EXT_occlusion_query_boolean on OpenGL ES. Where
+ * they are not available, create() returns a culler in software mode.
+ *
+ * @script{ignore}
+ */
+class OcclusionCuller : public Ref
+{
+public:
+
+    /**
+     * Defines the ways nodes can be tested for occlusion.
+     */
+    enum Mode
+    {
+        /**
+         * The bounds of nodes are tested with GPU occlusion queries, a frame late.
+         */
+        HARDWARE,
+
+        /**
+         * The bounds of nodes are tested against occluders rasterized on the CPU.
+         */
+        SOFTWARE
+    };
+
+    /**
+     * Creates an occlusion culler that uses occlusion queries if they are supported,
+     * and an occlusion buffer otherwise.
+     *
+     * @return The new occlusion culler.
+     */
+    static OcclusionCuller* create();
+
+    /**
+     * Creates an occlusion culler.
+     *
+     * A culler in HARDWARE mode never removes nodes if queries are not supported.
+     *
+     * @param mode The way nodes are tested for occlusion.
+     *
+     * @return The new occlusion culler.
+     */
+    static OcclusionCuller* create(Mode mode);
+
+    /**
+     * Determines whether occlusion queries are supported on this platform.
+     *
+     * @return True if nodes can be culled in HARDWARE mode.
+     */
+    static bool isSupported();
+
+    /**
+     * Returns the way this culler tests nodes for occlusion.
+     *
+     * @return The mode of the culler.
+     */
+    Mode getMode() const;
+
+    /**
+     * Returns the occlusion buffer of a culler in SOFTWARE mode.
+     *
+     * @return The occlusion buffer, or NULL in HARDWARE mode.
+     */
+    OcclusionBuffer* getOcclusionBuffer() const;
+
+    /**
+     * Removes the nodes that were occluded when query() was last called.
+     *
+     * The nodes that are left are remembered, and their bounds are tested by the next call to
+     * query(), along with the nodes that were removed. In SOFTWARE mode, the nodes hidden
+     * behind the occluders among the nodes are removed instead.
+     *
+     * @param camera The camera the nodes are drawn with.
+     * @param nodes The nodes that passed frustum culling, from which the occluded nodes are removed.
+     *
+     * @return The number of nodes that were removed.
+     */
+    unsigned int cull(Camera* camera, std::vector<Node*>& nodes);
+
+    /**
+     * Tests the bounds of the nodes passed to the last call to cull() against the depth buffer.
+     *
+     * This must be called after the scene was drawn, with the depth buffer the scene was drawn into bound.
+     * It does nothing in SOFTWARE mode.
+     *
+     * @param camera The camera the scene was drawn with.
+     */
+    void query(Camera* camera);
+
+    /**
+     * Returns the number of nodes removed by the last call to cull().
+     *
+     * @return The number of occluded nodes.
+     */
+    unsigned int getOccludedNodeCount() const;
+
+    /**
+     * Returns the number of queries issued by the last call to query().
+     *
+     * @return The number of queries.
+     */
+    unsigned int getQueryCount() const;
+
+private:
+
+    /**
+     * The occlusion state of a node.
+     */
+    struct NodeState
+    {
+        unsigned int query;
+        unsigned int frame;
+        bool visible;
+        bool pending;
+    };
+
+    /**
+     * Constructor.
+     */
+    OcclusionCuller(Mode mode);
+
+    /**
+     * Destructor.
+     */
+    ~OcclusionCuller();
+
+    /**
+     * Hidden copy constructor.
+     */
+    OcclusionCuller(const OcclusionCuller&);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    OcclusionCuller& operator=(const OcclusionCuller&);
+
+    static bool isCullable(Node* node);
+
+    bool isInside(Camera* camera, const BoundingBox& bounds) const;
+
+    void initialize();
+
+    void cullSoftware(Camera* camera, std::vector<Node*>& nodes);
+
+    Mode _mode;
+    OcclusionBuffer* _buffer;
+    std::map<Node*, NodeState> _states;
+    std::vector<Node*> _queryNodes;
+    Model* _box;
+    unsigned int _frame;
+    unsigned int _occludedCount;
+    unsigned int _queryCount;
+};
+
+}
+
+#endif
@@ -0,0 +1,135 @@
+#include "Base.h"
+#include "OffscreenParticles.h"
+#include "Game.h"
+#include "RenderQueue.h"
+#include "RenderTargetPool.h"
+#include "SpriteBatch.h"
+
+namespace gameplay
+{
+
+static FrameBuffer* __frameBuffer = NULL;
+static SpriteBatch* __spriteBatch = NULL;
+static Texture* __spriteTexture = NULL;
+static float __scale = 1.0f;
+static bool __active = false;
+
+void OffscreenParticles::begin(float scale, RenderQueue* occluders)
+{
+    GP_ASSERT(scale > 0.0f && scale <= 1.0f);
+    if (__active)
+    {
+        GP_WARN("Off-screen particles have already begun.");
+        return;
+    }
+
+    Game* game = Game::getInstance();
+    const Rectangle& viewport = game->getViewport();
+    unsigned int width = std::max(1u, (unsigned int)(viewport.width * scale + 0.5f));
+    unsigned int height = std::max(1u, (unsigned int)(viewport.height * scale + 0.5f));
+    __frameBuffer = RenderTargetPool::acquire(width, height, Texture::RGBA, true);
+    if (__frameBuffer == NULL)
+        return;
+    __scale = scale;
+    __active = true;
+
+    // Nothing drawn yet covers the scene, which shows through entirely.
+    FrameBuffer* previous = bind();
+    game->clear(Game::CLEAR_COLOR_DEPTH, Vector4(0.0f, 0.0f, 0.0f, 1.0f), 1.0f, 0);
+    if (occluders)
+    {
+        occluders->drawDepth();
+    }
+    unbind(previous);
+}
+
+void OffscreenParticles::end()
+{
+    if (!__active)
+        return;
+    __active = false;
+    __scale = 1.0f;
+
+    Texture* texture = __frameBuffer->getRenderTarget()->getTexture();
+    if (__spriteBatch == NULL || __spriteTexture != texture)
+    {
+        SAFE_DELETE(__spriteBatch);
+        __spriteBatch = SpriteBatch::create(texture);
+        GP_ASSERT(__spriteBatch);
+        __spriteTexture = texture;
+        __spriteBatch->getSampler()->setFilterMode(Texture::LINEAR, Texture::LINEAR);
+        __spriteBatch->getSampler()->setWrapMode(Texture::CLAMP, Texture::CLAMP);
+
+        // The scene is scaled by the fraction that shows through the particles, which are
+        // added over it with their colors already weighted by their alpha.
+        __spriteBatch->getStateBlock()->setBlend(true);
+        __spriteBatch->getStateBlock()->setBlendSrc(RenderState::BLEND_ONE);
+        __spriteBatch->getStateBlock()->setBlendDst(RenderState::BLEND_SRC_ALPHA);
+        __spriteBatch->getStateBlock()->setDepthTest(false);
+    }
+
+    const Rectangle& viewport = Game::getInstance()->getViewport();
+    Matrix projection;
+    Matrix::createOrthographicOffCenter(0, viewport.width, viewport.height, 0, 0, 1, &projection);
+    __spriteBatch->setProjectionMatrix(projection);
+    __spriteBatch->start();
+    __spriteBatch->draw(0, 0, viewport.width, viewport.height, 0, 1, 1, 0, Vector4::one());
+    __spriteBatch->finish();
+
+    RenderTargetPool::release(__frameBuffer);
+    __frameBuffer = NULL;
+}
+
+bool OffscreenParticles::isActive()
+{
+    return __active;
+}
+
+float OffscreenParticles::getScale()
+{
+    return __scale;
+}
+
+FrameBuffer* OffscreenParticles::bind()
+{
+    GP_ASSERT(__frameBuffer);
+    FrameBuffer* previous = __frameBuffer->bind();
+    GL_ASSERT( glViewport(0, 0, __frameBuffer->getWidth(), __frameBuffer->getHeight()) );
+    return previous;
+}
+
+void OffscreenParticles::unbind(FrameBuffer* previous)
+{
+    GP_ASSERT(previous);
+    previous->bind();
+    Game* game = Game::getInstance();
+    game->setViewport(game->getViewport());
+}
+
+void OffscreenParticles::bindBlend(bool additive)
+{
+    // Alpha blended particles hide the fraction of the scene given by their alpha, while
+    // additive particles hide none of it.
+    GLenum dst = additive ? GL_ONE : GL_ONE_MINUS_SRC_ALPHA;
+    GL_ASSERT( glBlendFuncSeparate(GL_SRC_ALPHA, dst, GL_ZERO, dst) );
+}
+
+void OffscreenParticles::unbindBlend(bool additive)
+{
+    GL_ASSERT( glBlendFunc(GL_SRC_ALPHA, additive ? GL_ONE : GL_ONE_MINUS_SRC_ALPHA) );
+}
+
+void OffscreenParticles::finalize()
+{
+    SAFE_DELETE(__spriteBatch);
+    __spriteTexture = NULL;
+    if (__frameBuffer)
+    {
+        RenderTargetPool::release(__frameBuffer);
+        __frameBuffer = NULL;
+    }
+    __active = false;
+    __scale = 1.0f;
+}
+
+}
@@ -0,0 +1,119 @@
+#ifndef OFFSCREENPARTICLES_H_
+#define OFFSCREENPARTICLES_H_
+
+#include "Base.h"
+#include "Rectangle.h"
+
+namespace gameplay
+{
+
+class FrameBuffer;
+class RenderQueue;
+
+/**
+ * Defines the drawing of particles into an off-screen frame buffer of a reduced resolution.
+ *
+ * Large particles of smoke and fire cover the screen many times over, so they are bound by
+ * the fill rate. Between begin() and end(), the emitters set with ParticleEmitter::setOffscreen
+ * draw their particles into a frame buffer of half or a quarter of the resolution of the
+ * viewport, and end() composites it over the scene. At half the resolution, the particles
+ * fill a quarter of the pixels.
+ *
+ * The frame buffer has a depth buffer of its own, into which begin() draws the depth of the
+ * opaque items of a RenderQueue at the reduced resolution, so the particles are hidden by
+ * the scene as they would be at the native resolution. Its alpha channel holds the fraction
+ * of the scene that shows through the particles drawn over it, so alpha blended and additive
+ * emitters are composited in a single pass. Emitters that multiply the scene are drawn at
+ * the native resolution.
+ *
+ * The frame buffer is upscaled with bilinear filtering. The engine has no depth textures,
+ * so the upscale is not guided by the depth of the scene, and the particles can bleed by
+ * a pixel of the reduced resolution over the edges of the objects in front of them.
+ *
+ @verbatim
+    void MyGame::render(float elapsedTime)
+    {
+        _queue->draw();
+        OffscreenParticles::begin(0.5f, _queue);
+        _scene->visit(this, &MyGame::drawParticles);
+        OffscreenParticles::end();
+    }
+ @endverbatim
+ *
+ * @script{ignore}
+ */
+class OffscreenParticles
+{
+    friend class Game;
+    friend class ParticleEmitter;
+
+public:
+
+    /**
+     * Begins drawing particles off-screen for the current viewport.
+     *
+     * @param scale The scale of the resolution of the viewport, such as 0.5 or 0.25.
+     * @param occluders The queue whose opaque items hide the particles, or NULL.
+     */
+    static void begin(float scale, RenderQueue* occluders = NULL);
+
+    /**
+     * Composites the particles drawn off-screen over the current frame buffer.
+     */
+    static void end();
+
+    /**
+     * Determines whether emitters are currently drawn off-screen.
+     *
+     * @return True between begin() and end().
+     */
+    static bool isActive();
+
+    /**
+     * Returns the scale of the resolution the particles are drawn at.
+     *
+     * @return The scale given to begin(), or 1 if there is no off-screen drawing.
+     */
+    static float getScale();
+
+private:
+
+    /**
+     * Hidden constructor.
+     */
+    OffscreenParticles();
+
+    /**
+     * Binds the off-screen frame buffer and its viewport for an emitter.
+     *
+     * @return The frame buffer that was bound.
+     */
+    static FrameBuffer* bind();
+
+    /**
+     * Binds the frame buffer bound before bind() and the viewport of the game again.
+     */
+    static void unbind(FrameBuffer* previous);
+
+    /**
+     * Sets the blending of an emitter so that the alpha channel accumulates the fraction of
+     * the scene that shows through the particles. The blend state of the emitter must be bound.
+     *
+     * @param additive True if the emitter adds to the scene, false if it is alpha blended.
+     */
+    static void bindBlend(bool additive);
+
+    /**
+     * Sets the blending of an emitter back to the blend function of its state.
+     */
+    static void unbindBlend(bool additive);
+
+    /**
+     * Called by Game during shutdown to release the frame buffer.
+     */
+    static void finalize();
+};
+
+}
+
+#endif
@@ -1,20 +1,162 @@
 #include "Base.h"
+#include "GLStateCache.h"
+#include "GPUProfiler.h"
+#include "RenderStats.h"
 #include "ParticleEmitter.h"
 #include "Game.h"
 #include "Node.h"
 #include "Scene.h"
 #include "Quaternion.h"
 #include "Properties.h"
+#include "Material.h"
+#include "Technique.h"
+#include "Pass.h"
+#include "FrameBuffer.h"
+#include "OffscreenParticles.h"
 
 #define PARTICLE_COUNT_MAX                       100
 #define PARTICLE_EMISSION_RATE                   10
 #define PARTICLE_EMISSION_RATE_TIME_INTERVAL     1000.0f / (float)PARTICLE_EMISSION_RATE
 
+#define PARTICLE_GPU_VSH                         "res/shaders/particle.vert"
+#define PARTICLE_GPU_FSH                         "res/shaders/sprite.frag"
+// Must match FRAME_COUNT_MAX in the vertex shader.
+#define PARTICLE_GPU_FRAME_COUNT_MAX             32
+// The number of particles drawn per draw call, so that all their vertices can be addressed with 16-bit indices.
+#define PARTICLE_GPU_BATCH_SIZE                  16384
+// The number of particles from which their view depths are computed by the job controller.
+#define PARTICLE_PARALLEL_MIN_COUNT              4096
+// The longest step, in milliseconds, and the most steps a culled emitter catches up with the time it slept in.
+#define PARTICLE_CATCH_UP_STEP                   50.0f
+#define PARTICLE_CATCH_UP_STEP_COUNT_MAX         16
+
+#if defined(USE_NEON)
+    #include <arm_neon.h>
+#elif defined(USE_SSE)
+    #include <xmmintrin.h>
+#endif
+
 namespace gameplay
 {
 
+// Four lanes of floats, used to update four particles at a time.
+#if defined(USE_NEON)
+
+typedef float32x4_t Float4;
+
+static inline Float4 loadFloat4(const float* p) { return vld1q_f32(p); }
+static inline void storeFloat4(float* p, Float4 v) { vst1q_f32(p, v); }
+static inline Float4 splatFloat4(float f) { return vdupq_n_f32(f); }
+static inline Float4 addFloat4(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+static inline Float4 subFloat4(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+static inline Float4 mulFloat4(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+static inline Float4 maddFloat4(Float4 a, Float4 b, Float4 c) { return vmlaq_f32(a, b, c); }
+static inline Float4 minFloat4(Float4 a, Float4 b) { return vminq_f32(a, b); }
+static inline Float4 maxFloat4(Float4 a, Float4 b) { return vmaxq_f32(a, b); }
+static inline Float4 selectPositiveFloat4(Float4 d, Float4 v)
+{
+    return vreinterpretq_f32_u32(vandq_u32(vcgtq_f32(d, vdupq_n_f32(0.0f)), vreinterpretq_u32_f32(v)));
+}
+
+#elif defined(USE_SSE)
+
+typedef __m128 Float4;
+
+static inline Float4 loadFloat4(const float* p) { return _mm_loadu_ps(p); }
+static inline void storeFloat4(float* p, Float4 v) { _mm_storeu_ps(p, v); }
+static inline Float4 splatFloat4(float f) { return _mm_set1_ps(f); }
+static inline Float4 addFloat4(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+static inline Float4 subFloat4(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+static inline Float4 mulFloat4(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+static inline Float4 maddFloat4(Float4 a, Float4 b, Float4 c) { return _mm_add_ps(a, _mm_mul_ps(b, c)); }
+static inline Float4 minFloat4(Float4 a, Float4 b) { return _mm_min_ps(a, b); }
+static inline Float4 maxFloat4(Float4 a, Float4 b) { return _mm_max_ps(a, b); }
+static inline Float4 selectPositiveFloat4(Float4 d, Float4 v)
+{
+    return _mm_and_ps(_mm_cmpgt_ps(d, _mm_setzero_ps()), v);
+}
+
+#else
+
+struct Float4
+{
+    float v[4];
+};
+
+static inline Float4 loadFloat4(const float* p) { Float4 r = { { p[0], p[1], p[2], p[3] } }; return r; }
+static inline void storeFloat4(float* p, Float4 v) { p[0] = v.v[0]; p[1] = v.v[1]; p[2] = v.v[2]; p[3] = v.v[3]; }
+static inline Float4 splatFloat4(float f) { Float4 r = { { f, f, f, f } }; return r; }
+static inline Float4 addFloat4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+static inline Float4 subFloat4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] -= b.v[i]; return a; }
+static inline Float4 mulFloat4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+static inline Float4 maddFloat4(Float4 a, Float4 b, Float4 c) { for (int i = 0; i < 4; ++i) a.v[i] += b.v[i] * c.v[i]; return a; }
+static inline Float4 minFloat4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] = std::min(a.v[i], b.v[i]); return a; }
+static inline Float4 maxFloat4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] = std::max(a.v[i], b.v[i]); return a; }
+static inline Float4 selectPositiveFloat4(Float4 d, Float4 v) { for (int i = 0; i < 4; ++i) v.v[i] = d.v[i] > 0.0f ? v.v[i] : 0.0f; return v; }
+
+#endif
+
+// The vertex of a particle simulated on the GPU; each particle has four.
+struct GPUParticleVertex
+{
+    float position[4];
+    float velocity[4];
+    float acceleration[4];
+    float colorStart[4];
+    float colorEnd[4];
+    float size[4];
+    float corner[2];
+};
+
+// The vertex attributes of particles simulated on the GPU.
+static const struct
+{
+    const char* name;
+    GLint size;
+    size_t offset;
+} __gpuParticleAttributes[] =
+{
+    { "a_position", 4, offsetof(GPUParticleVertex, position) },
+    { "a_velocity", 4, offsetof(GPUParticleVertex, velocity) },
+    { "a_acceleration", 4, offsetof(GPUParticleVertex, acceleration) },
+    { "a_colorStart", 4, offsetof(GPUParticleVertex, colorStart) },
+    { "a_colorEnd", 4, offsetof(GPUParticleVertex, colorEnd) },
+    { "a_size", 4, offsetof(GPUParticleVertex, size) },
+    { "a_corner", 2, offsetof(GPUParticleVertex, corner) }
+};
+
+#define GPU_PARTICLE_ATTRIBUTE_COUNT (sizeof(__gpuParticleAttributes) / sizeof(__gpuParticleAttributes[0]))
+#define GPU_PARTICLE_VERTEX_FLOATS (sizeof(GPUParticleVertex) / sizeof(float))
+
+// Returns the smallest and largest of the four lanes.
+static inline float minLanes(Float4 v)
+{
+    float f[4];
+    storeFloat4(f, v);
+    return std::min(std::min(f[0], f[1]), std::min(f[2], f[3]));
+}
+
+static inline float maxLanes(Float4 v)
+{
+    float f[4];
+    storeFloat4(f, v);
+    return std::max(std::max(f[0], f[1]), std::max(f[2], f[3]));
+}
+
+// Returns the signed distances of four points to a plane.
+static inline Float4 planeDistanceFloat4(const Plane& plane, Float4 x, Float4 y, Float4 z)
+{
+    const Vector3& n = plane.getNormal();
+    Float4 d = maddFloat4(splatFloat4(plane.getDistance()), splatFloat4(n.x), x);
+    d = maddFloat4(d, splatFloat4(n.y), y);
+    return maddFloat4(d, splatFloat4(n.z), z);
+}
+
 ParticleEmitter::ParticleEmitter(SpriteBatch* batch, unsigned int particleCountMax) :
-    _particleCountMax(particleCountMax), _particleCount(0), _particles(NULL),
+    _particleCountMax(particleCountMax), _particleCount(0), _particleStride(0), _particleData(NULL), _particleIndices(NULL),
+    _gpuSimulated(false), _offscreen(false), _depthSorted(false), _maxScreenSize(0.0f),
+    _cullingEnabled(true), _cullDistance(0.0f), _culled(false), _sleepTime(0.0f), _gpuTime(0.0), _gpuDeathTimeMax(0.0f), _gpuDeathTimes(NULL), _gpuNextSlot(0), _gpuSlotCount(0),
+    _gpuVertexBuffer(0), _gpuIndexBuffer(0), _gpuMaterial(NULL),
     _emissionRate(PARTICLE_EMISSION_RATE), _started(false), _ellipsoid(false),
     _sizeStartMin(1.0f), _sizeStartMax(1.0f), _sizeEndMin(1.0f), _sizeEndMax(1.0f),
     _energyMin(1000L), _energyMax(1000L),
@@ -31,7 +173,12 @@ ParticleEmitter::ParticleEmitter(SpriteBatch* batch, unsigned int particleCountM
     _timePerEmission(PARTICLE_EMISSION_RATE_TIME_INTERVAL), _timeRunning(0)
 {
     GP_ASSERT(particleCountMax);
-    _particles = new Particle[particleCountMax];
+
+    // Round the arrays up to a multiple of four particles so that the update never reads past them.
+    _particleStride = (particleCountMax + 3) & ~3;
+    _particleData = new float[_particleStride * PARTICLE_COMPONENT_COUNT];
+    memset(_particleData, 0, sizeof(float) * _particleStride * PARTICLE_COMPONENT_COUNT);
+    _particleIndices = new unsigned int[_particleStride];
 
     GP_ASSERT(_spriteBatch);
     GP_ASSERT(_spriteBatch->getStateBlock());
@@ -42,8 +189,21 @@ ParticleEmitter::ParticleEmitter(SpriteBatch* batch, unsigned int particleCountM
 ParticleEmitter::~ParticleEmitter()
 {
     SAFE_DELETE(_spriteBatch);
-    SAFE_DELETE_ARRAY(_particles);
+    SAFE_DELETE_ARRAY(_particleData);
+    SAFE_DELETE_ARRAY(_particleIndices);
+    SAFE_DELETE_ARRAY(_gpuDeathTimes);
     SAFE_DELETE_ARRAY(_spriteTextureCoords);
+    SAFE_RELEASE(_gpuMaterial);
+    if (_gpuVertexBuffer)
+    {
+        GLStateCache::deleteBuffers(1, &_gpuVertexBuffer);
+        _gpuVertexBuffer = 0;
+    }
+    if (_gpuIndexBuffer)
+    {
+        GLStateCache::deleteBuffers(1, &_gpuIndexBuffer);
+        _gpuIndexBuffer = 0;
+    }
 }
 
 ParticleEmitter* ParticleEmitter::create(const char* textureFile, TextureBlending textureBlending, unsigned int particleCountMax)
@@ -182,6 +342,12 @@ ParticleEmitter* ParticleEmitter::create(Properties* properties)
     bool orbitPosition = properties->getBool("orbitPosition");
     bool orbitVelocity = properties->getBool("orbitVelocity");
     bool orbitAcceleration = properties->getBool("orbitAcceleration");
+    bool gpuSimulated = properties->getBool("gpuSimulated");
+    bool offscreen = properties->getBool("offscreen");
+    bool depthSorted = properties->getBool("depthSorted");
+    float maxScreenSize = properties->getFloat("maxScreenSize");
+    bool culling = properties->getBool("culling", true);
+    float cullDistance = properties->getFloat("cullDistance");
 
     // Apply all properties to a newly created ParticleEmitter.
     ParticleEmitter* emitter = ParticleEmitter::create(texturePath.c_str(), textureBlending, particleCountMax);
@@ -208,6 +374,16 @@ ParticleEmitter* ParticleEmitter::create(Properties* properties)
     emitter->setSpriteFrameCoords(spriteFrameCount, spriteWidth, spriteHeight);
 
     emitter->setOrbit(orbitPosition, orbitVelocity, orbitAcceleration);
+    emitter->setOffscreen(offscreen);
+    emitter->setDepthSorted(depthSorted);
+    emitter->setMaxScreenSize(maxScreenSize);
+    emitter->setCullingEnabled(culling);
+    emitter->setCullDistance(cullDistance);
+
+    if (gpuSimulated)
+    {
+        emitter->setGPUSimulated(true);
+    }
 
     return emitter;
 }
@@ -247,11 +423,15 @@ bool ParticleEmitter::isActive() const
     if (!_node)
         return false;
 
-    GP_ASSERT(_particles);
+    if (_gpuSimulated)
+        return _gpuTime < _gpuDeathTimeMax;
+
+    GP_ASSERT(_particleData);
+    const float* energy = getParticleComponent(PARTICLE_ENERGY);
     bool active = false;
     for (unsigned int i = 0; i < _particleCount; i++)
     {
-        if (_particles[i]._energy > 0)
+        if (energy[i] > 0)
         {
             active = true;
             break;
@@ -264,13 +444,20 @@ bool ParticleEmitter::isActive() const
 void ParticleEmitter::emitOnce(unsigned int particleCount)
 {
     GP_ASSERT(_node);
-    GP_ASSERT(_particles);
+    GP_ASSERT(_particleData);
 
     // Limit particleCount so as not to go over _particleCountMax.
-    if (particleCount + _particleCount > _particleCountMax)
+    // Particles simulated on the GPU replace the oldest ones instead.
+    if (_gpuSimulated)
+    {
+        particleCount = std::min(particleCount, _particleCountMax);
+        _gpuVertices.clear();
+    }
+    else if (particleCount + _particleCount > _particleCountMax)
     {
         particleCount = _particleCountMax - _particleCount;
     }
+    unsigned int firstSlot = _gpuNextSlot;
 
     Vector3 translation;
     Matrix world = _node->getWorldMatrix();
@@ -281,75 +468,328 @@ void ParticleEmitter::emitOnce(unsigned int particleCount)
     world.m[13] = 0.0f;
     world.m[14] = 0.0f;
 
+    float* c[PARTICLE_COMPONENT_COUNT];
+    for (unsigned int i = 0; i < PARTICLE_COMPONENT_COUNT; i++)
+    {
+        c[i] = getParticleComponent((ParticleComponent)i);
+    }
+
     // Emit the new particles.
     for (unsigned int i = 0; i < particleCount; i++)
     {
-        Particle* p = &_particles[_particleCount];
-        p->_visible = true;
+        Vector4 colorStart;
+        Vector4 colorEnd;
+        generateColor(_colorStart, _colorStartVar, &colorStart);
+        generateColor(_colorEnd, _colorEndVar, &colorEnd);
 
-        generateColor(_colorStart, _colorStartVar, &p->_colorStart);
-        generateColor(_colorEnd, _colorEndVar, &p->_colorEnd);
-        p->_color.set(p->_colorStart);
-
-        p->_energy = p->_energyStart = generateScalar(_energyMin, _energyMax);
-        p->_size = p->_sizeStart = generateScalar(_sizeStartMin, _sizeStartMax);
-        p->_sizeEnd = generateScalar(_sizeEndMin, _sizeEndMax);
-        p->_rotationPerParticleSpeed = generateScalar(_rotationPerParticleSpeedMin, _rotationPerParticleSpeedMax);
-        p->_angle = generateScalar(0.0f, p->_rotationPerParticleSpeed);
-        p->_rotationSpeed = generateScalar(_rotationSpeedMin, _rotationSpeedMax);
+        float energy = generateScalar(_energyMin, _energyMax);
+        float sizeStart = generateScalar(_sizeStartMin, _sizeStartMax);
+        float rotationPerParticleSpeed = generateScalar(_rotationPerParticleSpeedMin, _rotationPerParticleSpeedMax);
+        float rotationSpeed = generateScalar(_rotationSpeedMin, _rotationSpeedMax);
 
         // Only initial position can be generated within an ellipsoidal domain.
-        generateVector(_position, _positionVar, &p->_position, _ellipsoid);
-        generateVector(_velocity, _velocityVar, &p->_velocity, false);
-        generateVector(_acceleration, _accelerationVar, &p->_acceleration, false);
-        generateVector(_rotationAxis, _rotationAxisVar, &p->_rotationAxis, false);
+        Vector3 position;
+        Vector3 velocity;
+        Vector3 acceleration;
+        Vector3 rotationAxis;
+        generateVector(_position, _positionVar, &position, _ellipsoid);
+        generateVector(_velocity, _velocityVar, &velocity, false);
+        generateVector(_acceleration, _accelerationVar, &acceleration, false);
+        generateVector(_rotationAxis, _rotationAxisVar, &rotationAxis, false);
 
         // Initial position, velocity and acceleration can all be relative to the emitter's transform.
         // Rotate specified properties by the node's rotation.
         if (_orbitPosition)
         {
-            world.transformPoint(p->_position, &p->_position);
+            world.transformPoint(position, &position);
         }
 
         if (_orbitVelocity)
         {
-            world.transformPoint(p->_velocity, &p->_velocity);
+            world.transformPoint(velocity, &velocity);
         }
 
         if (_orbitAcceleration)
         {
-            world.transformPoint(p->_acceleration, &p->_acceleration);
+            world.transformPoint(acceleration, &acceleration);
         }
 
         // The rotation axis always orbits the node.
-        if (p->_rotationSpeed != 0.0f && !p->_rotationAxis.isZero())
+        if (rotationSpeed != 0.0f && !rotationAxis.isZero())
         {
-            world.transformPoint(p->_rotationAxis, &p->_rotationAxis);
+            world.transformPoint(rotationAxis, &rotationAxis);
         }
 
         // Translate position relative to the node's world space.
-        p->_position.add(translation);
+        position.add(translation);
 
-        // Initial sprite frame.
-        if (_spriteFrameRandomOffset > 0)
-        {
-            p->_frame = rand() % _spriteFrameRandomOffset;
-        }
-        else
+        float frame = _spriteFrameRandomOffset > 0 ? (float)(rand() % _spriteFrameRandomOffset) : 0.0f;
+
+        if (_gpuSimulated)
         {
-            p->_frame = 0;
+            // The vertex shader only has the coordinates of the first frames.
+            frame = fmodf(frame, (float)std::min(_spriteFrameCount, (unsigned int)PARTICLE_GPU_FRAME_COUNT_MAX));
+
+            // Times are in seconds on the GPU.
+            float time = (float)_gpuTime;
+            float energySecs = energy * 0.001f;
+            GPUParticleVertex v =
+            {
+                { position.x, position.y, position.z, time },
+                { velocity.x, velocity.y, velocity.z, energySecs },
+                { acceleration.x, acceleration.y, acceleration.z, generateScalar(0.0f, rotationPerParticleSpeed) },
+                { colorStart.x, colorStart.y, colorStart.z, colorStart.w },
+                { colorEnd.x, colorEnd.y, colorEnd.z, colorEnd.w },
+                { sizeStart, generateScalar(_sizeEndMin, _sizeEndMax), rotationPerParticleSpeed, frame },
+                { 0.0f, 0.0f }
+            };
+            static const float corners[4][2] = { { -0.5f, -0.5f }, { 0.5f, -0.5f }, { -0.5f, 0.5f }, { 0.5f, 0.5f } };
+            for (unsigned int k = 0; k < 4; k++)
+            {
+                v.corner[0] = corners[k][0];
+                v.corner[1] = corners[k][1];
+                _gpuVertices.insert(_gpuVertices.end(), (const float*)&v, (const float*)&v + GPU_PARTICLE_VERTEX_FLOATS);
+            }
+
+            _gpuDeathTimes[_gpuNextSlot] = time + energySecs;
+            _gpuDeathTimeMax = std::max(_gpuDeathTimeMax, time + energySecs);
+            _gpuSlotCount = std::max(_gpuSlotCount, _gpuNextSlot + 1);
+            if (++_gpuNextSlot == _particleCountMax)
+            {
+                // Wrap around to the start of the ring.
+                uploadGPUParticles(firstSlot);
+                _gpuVertices.clear();
+                _gpuNextSlot = firstSlot = 0;
+            }
+            continue;
         }
-        p->_timeOnCurrentFrame = 0.0f;
+
+        unsigned int p = _particleCount;
+        c[PARTICLE_POSITION_X][p] = position.x;
+        c[PARTICLE_POSITION_Y][p] = position.y;
+        c[PARTICLE_POSITION_Z][p] = position.z;
+        c[PARTICLE_VELOCITY_X][p] = velocity.x;
+        c[PARTICLE_VELOCITY_Y][p] = velocity.y;
+        c[PARTICLE_VELOCITY_Z][p] = velocity.z;
+        c[PARTICLE_ACCELERATION_X][p] = acceleration.x;
+        c[PARTICLE_ACCELERATION_Y][p] = acceleration.y;
+        c[PARTICLE_ACCELERATION_Z][p] = acceleration.z;
+        c[PARTICLE_COLOR_START_R][p] = c[PARTICLE_COLOR_R][p] = colorStart.x;
+        c[PARTICLE_COLOR_START_G][p] = c[PARTICLE_COLOR_G][p] = colorStart.y;
+        c[PARTICLE_COLOR_START_B][p] = c[PARTICLE_COLOR_B][p] = colorStart.z;
+        c[PARTICLE_COLOR_START_A][p] = c[PARTICLE_COLOR_A][p] = colorStart.w;
+        c[PARTICLE_COLOR_END_R][p] = colorEnd.x;
+        c[PARTICLE_COLOR_END_G][p] = colorEnd.y;
+        c[PARTICLE_COLOR_END_B][p] = colorEnd.z;
+        c[PARTICLE_COLOR_END_A][p] = colorEnd.w;
+        c[PARTICLE_ROTATION_PER_PARTICLE_SPEED][p] = rotationPerParticleSpeed;
+        c[PARTICLE_ROTATION_AXIS_X][p] = rotationAxis.x;
+        c[PARTICLE_ROTATION_AXIS_Y][p] = rotationAxis.y;
+        c[PARTICLE_ROTATION_AXIS_Z][p] = rotationAxis.z;
+        c[PARTICLE_ROTATION_SPEED][p] = rotationSpeed;
+        c[PARTICLE_ANGLE][p] = generateScalar(0.0f, rotationPerParticleSpeed);
+        c[PARTICLE_ENERGY][p] = energy;
+        c[PARTICLE_ENERGY_START_RECIPROCAL][p] = energy > 0.0f ? 1.0f / energy : 0.0f;
+        c[PARTICLE_SIZE_START][p] = c[PARTICLE_SIZE][p] = sizeStart;
+        c[PARTICLE_SIZE_END][p] = generateScalar(_sizeEndMin, _sizeEndMax);
+
+        // Initial sprite frame.
+        c[PARTICLE_FRAME][p] = frame;
+        c[PARTICLE_TIME_ON_CURRENT_FRAME][p] = 0.0f;
+        c[PARTICLE_VISIBLE][p] = 1.0f;
 
         ++_particleCount;
     }
+
+    if (_gpuSimulated)
+    {
+        uploadGPUParticles(firstSlot);
+    }
 }
 
 unsigned int ParticleEmitter::getParticlesCount() const
 {
+    if (_gpuSimulated)
+    {
+        unsigned int count = 0;
+        for (unsigned int i = 0; i < _gpuSlotCount; i++)
+        {
+            if (_gpuDeathTimes[i] > _gpuTime)
+                ++count;
+        }
+        return count;
+    }
     return _particleCount;
 }
 
+/**
+ * Warns that the vertex shader of GPU simulation only uses the first frames of a sprite.
+ */
+static void warnGPUFrameCount(unsigned int frameCount)
+{
+    if (frameCount > PARTICLE_GPU_FRAME_COUNT_MAX)
+    {
+        GP_WARN("Only the first %d of the %u sprite frames are used by particles simulated on the GPU.", PARTICLE_GPU_FRAME_COUNT_MAX, frameCount);
+    }
+}
+
+void ParticleEmitter::setGPUSimulated(bool gpuSimulated)
+{
+    if (gpuSimulated == _gpuSimulated)
+        return;
+
+    if (gpuSimulated && !createGPUResources())
+    {
+        GP_ERROR("Failed to create the resources for simulating particles on the GPU.");
+        return;
+    }
+
+    if (gpuSimulated && (_rotationSpeedMin != 0.0f || _rotationSpeedMax != 0.0f))
+    {
+        GP_WARN("Rotation around the rotation axis is not supported for particles simulated on the GPU.");
+    }
+    if (gpuSimulated)
+    {
+        warnGPUFrameCount(_spriteFrameCount);
+    }
+
+    // Remove all particles of the previous mode.
+    _gpuSimulated = gpuSimulated;
+    _particleCount = 0;
+    _gpuTime = 0.0;
+    _gpuDeathTimeMax = 0.0f;
+    _gpuNextSlot = 0;
+    _gpuSlotCount = 0;
+}
+
+bool ParticleEmitter::isGPUSimulated() const
+{
+    return _gpuSimulated;
+}
+
+void ParticleEmitter::setOffscreen(bool offscreen)
+{
+    _offscreen = offscreen;
+}
+
+bool ParticleEmitter::isOffscreen() const
+{
+    return _offscreen;
+}
+
+void ParticleEmitter::setDepthSorted(bool depthSorted)
+{
+    _depthSorted = depthSorted;
+    if (!depthSorted)
+    {
+        std::vector<unsigned long long>().swap(_sortKeys);
+        std::vector<unsigned long long>().swap(_sortScratch);
+    }
+}
+
+bool ParticleEmitter::isDepthSorted() const
+{
+    return _depthSorted;
+}
+
+void ParticleEmitter::setMaxScreenSize(float maxScreenSize)
+{
+    _maxScreenSize = std::max(maxScreenSize, 0.0f);
+}
+
+float ParticleEmitter::getMaxScreenSize() const
+{
+    return _maxScreenSize;
+}
+
+void ParticleEmitter::setCullingEnabled(bool enabled)
+{
+    _cullingEnabled = enabled;
+    _culled = false;
+}
+
+bool ParticleEmitter::isCullingEnabled() const
+{
+    return _cullingEnabled;
+}
+
+void ParticleEmitter::setCullDistance(float distance)
+{
+    _cullDistance = std::max(distance, 0.0f);
+}
+
+float ParticleEmitter::getCullDistance() const
+{
+    return _cullDistance;
+}
+
+bool ParticleEmitter::isCulled() const
+{
+    return _culled;
+}
+
+const BoundingBox& ParticleEmitter::getBounds() const
+{
+    return _bounds;
+}
+
+bool ParticleEmitter::createGPUResources()
+{
+    if (_gpuMaterial)
+        return true;
+
+    _gpuMaterial = Material::create(PARTICLE_GPU_VSH, PARTICLE_GPU_FSH);
+    if (!_gpuMaterial)
+        return false;
+
+    // Share the texture and the blending and depth state of the sprite batch.
+    GP_ASSERT(_spriteBatch);
+    _gpuMaterial->setStateBlock(_spriteBatch->getStateBlock());
+    _gpuMaterial->getParameter("u_texture")->setValue(_spriteBatch->getSampler());
+
+    _gpuDeathTimes = new float[_particleCountMax];
+    memset(_gpuDeathTimes, 0, sizeof(float) * _particleCountMax);
+
+    // The vertices of all slots start out zeroed, which makes them dead.
+    std::vector<float> vertices(_particleCountMax * 4 * GPU_PARTICLE_VERTEX_FLOATS, 0.0f);
+    GL_ASSERT( glGenBuffers(1, &_gpuVertexBuffer) );
+    GLStateCache::bindBuffer(GL_ARRAY_BUFFER, _gpuVertexBuffer);
+    GL_ASSERT( glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), &vertices[0], GL_DYNAMIC_DRAW) );
+    GLStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Every batch of particles uses the same indices, relative to the first vertex of the batch.
+    unsigned int batchSize = std::min(_particleCountMax, (unsigned int)PARTICLE_GPU_BATCH_SIZE);
+    std::vector<unsigned short> indices(batchSize * 6);
+    for (unsigned int i = 0; i < batchSize; i++)
+    {
+        unsigned short v = (unsigned short)(i * 4);
+        unsigned short* index = &indices[i * 6];
+        index[0] = v;
+        index[1] = v + 1;
+        index[2] = v + 2;
+        index[3] = v + 2;
+        index[4] = v + 1;
+        index[5] = v + 3;
+    }
+    GL_ASSERT( glGenBuffers(1, &_gpuIndexBuffer) );
+    GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _gpuIndexBuffer);
+    GL_ASSERT( glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned short), &indices[0], GL_STATIC_DRAW) );
+    GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    return true;
+}
+
+void ParticleEmitter::uploadGPUParticles(unsigned int firstSlot)
+{
+    if (_gpuVertices.empty())
+        return;
+
+    GLStateCache::bindBuffer(GL_ARRAY_BUFFER, _gpuVertexBuffer);
+    GL_ASSERT( glBufferSubData(GL_ARRAY_BUFFER, firstSlot * sizeof(GPUParticleVertex) * 4, _gpuVertices.size() * sizeof(float), &_gpuVertices[0]) );
+    RenderStats::add(RenderStats::BUFFER_UPLOADS);
+    GLStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 void ParticleEmitter::setEllipsoid(bool ellipsoid)
 {
     _ellipsoid = ellipsoid;
@@ -529,6 +969,7 @@ void ParticleEmitter::setTextureBlending(TextureBlending textureBlending)
     GP_ASSERT(_spriteBatch);
     GP_ASSERT(_spriteBatch->getStateBlock());
 
+    _spriteTextureBlending = textureBlending;
     switch (textureBlending)
     {
         case BLEND_OPAQUE:
@@ -555,6 +996,11 @@ void ParticleEmitter::setTextureBlending(TextureBlending textureBlending)
     }
 }
 
+ParticleEmitter::TextureBlending ParticleEmitter::getTextureBlending() const
+{
+    return _spriteTextureBlending;
+}
+
 void ParticleEmitter::setSpriteAnimated(bool animated)
 {
     _spriteAnimated = animated;
@@ -604,6 +1050,10 @@ void ParticleEmitter::setSpriteTexCoords(unsigned int frameCount, float* texCoor
 
     _spriteFrameCount = frameCount;
     _spritePercentPerFrame = 1.0f / (float)frameCount;
+    if (_gpuSimulated)
+    {
+        warnGPUFrameCount(frameCount);
+    }
 
     SAFE_DELETE_ARRAY(_spriteTextureCoords);
     _spriteTextureCoords = new float[frameCount * 4];
@@ -617,6 +1067,10 @@ void ParticleEmitter::setSpriteFrameCoords(unsigned int frameCount, Rectangle* f
 
     _spriteFrameCount = frameCount;
     _spritePercentPerFrame = 1.0f / (float)frameCount;
+    if (_gpuSimulated)
+    {
+        warnGPUFrameCount(frameCount);
+    }
 
     SAFE_DELETE_ARRAY(_spriteTextureCoords);
     _spriteTextureCoords = new float[frameCount * 4];
@@ -796,9 +1250,59 @@ void ParticleEmitter::update(float elapsedTime)
         return;
     }
 
-    // Calculate the time passed since last update.
-    float elapsedSecs = elapsedTime * 0.001f;
+    if (_gpuSimulated)
+    {
+        // Particles emitted below start at the current time.
+        _gpuTime += elapsedTime * 0.001f;
+
+        // The GPU computes the state of each particle from its age.
+        emitParticles(elapsedTime);
+        _culled = false;
+        _sleepTime = 0.0f;
+        return;
+    }
+
+    GP_ASSERT(_node && _node->getScene() && _node->getScene()->getActiveCamera());
+    Camera* camera = _node->getScene()->getActiveCamera();
+    const Frustum& frustum = camera->getFrustum();
+
+    // Sleep while the particles, including those emitted while sleeping, cannot be seen.
+    if (_cullingEnabled)
+    {
+        computeBounds(_sleepTime + elapsedTime, &_bounds);
+        _culled = !frustum.intersects(_bounds);
+        if (!_culled && _cullDistance > 0.0f && camera->getNode())
+        {
+            Vector3 eye = camera->getNode()->getTranslationWorld();
+            Vector3 closest(MATH_CLAMP(eye.x, _bounds.min.x, _bounds.max.x),
+                            MATH_CLAMP(eye.y, _bounds.min.y, _bounds.max.y),
+                            MATH_CLAMP(eye.z, _bounds.min.z, _bounds.max.z));
+            _culled = eye.distanceSquared(closest) > _cullDistance * _cullDistance;
+        }
+        if (_culled)
+        {
+            // A stopped emitter has nothing left to catch up with once its particles have died.
+            _sleepTime += elapsedTime;
+            if (!_started && _sleepTime >= _energyMax)
+            {
+                _particleCount = 0;
+                _sleepTime = 0.0f;
+            }
+            return;
+        }
+    }
+
+    if (_sleepTime > 0.0f)
+    {
+        catchUp(_sleepTime, frustum);
+        _sleepTime = 0.0f;
+    }
+
+    simulate(elapsedTime, frustum);
+}
 
+void ParticleEmitter::emitParticles(float elapsedTime)
+{
     if (_started && _emissionRate)
     {
         // Calculate how much time has passed since we last emitted particles.
@@ -817,113 +1321,326 @@ void ParticleEmitter::update(float elapsedTime)
             emitOnce(emitCount);
         }
     }
+}
 
-    GP_ASSERT(_node && _node->getScene() && _node->getScene()->getActiveCamera());
-    const Frustum& frustum = _node->getScene()->getActiveCamera()->getFrustum();
+void ParticleEmitter::simulate(float elapsedTime, const Frustum& frustum)
+{
+    emitParticles(elapsedTime);
 
     // Now update all currently living particles.
-    GP_ASSERT(_particles);
-    for (unsigned int particlesIndex = 0; particlesIndex < _particleCount; ++particlesIndex)
+    GP_ASSERT(_particleData);
+    updateParticles(elapsedTime, frustum);
+
+    // Handle sprite animations.
+    if (_spriteAnimated)
+    {
+        updateParticleFrames(elapsedTime * 0.001f);
+    }
+
+    removeDeadParticles();
+}
+
+void ParticleEmitter::catchUp(float sleepTime, const Frustum& frustum)
+{
+    // Particles alive when the emitter fell asleep have died if it slept longer than they
+    // live, so only the lifetime of the particles emitted since then is simulated.
+    if (sleepTime >= _energyMax)
+    {
+        _particleCount = 0;
+        sleepTime = _energyMax;
+    }
+
+    unsigned int stepCount = (unsigned int)ceil(sleepTime / PARTICLE_CATCH_UP_STEP);
+    stepCount = std::max(1u, std::min(stepCount, (unsigned int)PARTICLE_CATCH_UP_STEP_COUNT_MAX));
+    float step = sleepTime / (float)stepCount;
+    for (unsigned int i = 0; i < stepCount; ++i)
+    {
+        simulate(step, frustum);
+    }
+}
+
+void ParticleEmitter::computeBounds(float sleepTime, BoundingBox* dst) const
+{
+    GP_ASSERT(dst);
+    GP_ASSERT(_node);
+
+    // Properties that orbit the node are scaled by it.
+    const Matrix& world = _node->getWorldMatrix();
+    float scale = 1.0f;
+    if (_orbitPosition || _orbitVelocity || _orbitAcceleration)
+    {
+        Vector3 s;
+        world.getScale(&s);
+        scale = std::max(fabs(s.x), std::max(fabs(s.y), fabs(s.z)));
+    }
+    float positionRadius = (_position.length() + _positionVar.length()) * (_orbitPosition ? scale : 1.0f);
+    float speed = (_velocity.length() + _velocityVar.length()) * (_orbitVelocity ? scale : 1.0f);
+    float acceleration = (_acceleration.length() + _accelerationVar.length()) * (_orbitAcceleration ? scale : 1.0f);
+    float size = std::max(_sizeStartMax, _sizeEndMax);
+    float lifetime = _energyMax * 0.001f;
+
+    // Rotating the velocity and acceleration of a particle does not change their lengths,
+    // so the particles emitted at the current position stay within this distance of it.
+    bool empty = true;
+    if (_started && _emissionRate)
+    {
+        Vector3 translation;
+        world.getTranslation(&translation);
+        float radius = positionRadius + lifetime * (speed + 0.5f * acceleration * lifetime) + size;
+        dst->set(translation.x - radius, translation.y - radius, translation.z - radius,
+                 translation.x + radius, translation.y + radius, translation.z + radius);
+        empty = false;
+    }
+
+    // The particles alive at the last simulation move at most this far while the emitter sleeps.
+    if (_particleCount > 0 && sleepTime < _energyMax)
     {
-        Particle* p = &_particles[particlesIndex];
-        p->_energy -= elapsedTime;
+        float t = sleepTime * 0.001f;
+        float distance = t * (speed + acceleration * lifetime + 0.5f * acceleration * t) + size;
+        BoundingBox particles(_particleMin.x - distance, _particleMin.y - distance, _particleMin.z - distance,
+                              _particleMax.x + distance, _particleMax.y + distance, _particleMax.z + distance);
+        if (empty)
+            dst->set(particles);
+        else
+            dst->merge(particles);
+        empty = false;
+    }
+
+    if (empty)
+    {
+        dst->set(BoundingBox::empty());
+    }
+}
+
+float* ParticleEmitter::getParticleComponent(ParticleComponent component) const
+{
+    return _particleData + component * _particleStride;
+}
+
+void ParticleEmitter::updateParticles(float elapsedTime, const Frustum& frustum)
+{
+    float elapsedSecs = elapsedTime * 0.001f;
 
-        if (p->_energy > 0L)
+    float* px = getParticleComponent(PARTICLE_POSITION_X);
+    float* py = getParticleComponent(PARTICLE_POSITION_Y);
+    float* pz = getParticleComponent(PARTICLE_POSITION_Z);
+    float* vx = getParticleComponent(PARTICLE_VELOCITY_X);
+    float* vy = getParticleComponent(PARTICLE_VELOCITY_Y);
+    float* vz = getParticleComponent(PARTICLE_VELOCITY_Z);
+    float* ax = getParticleComponent(PARTICLE_ACCELERATION_X);
+    float* ay = getParticleComponent(PARTICLE_ACCELERATION_Y);
+    float* az = getParticleComponent(PARTICLE_ACCELERATION_Z);
+
+    // Particles that rotate around an axis are rare, so their velocity and acceleration
+    // are rotated one at a time before the rest of the update is done four at a time.
+    const float* rotationSpeed = getParticleComponent(PARTICLE_ROTATION_SPEED);
+    const float* rx = getParticleComponent(PARTICLE_ROTATION_AXIS_X);
+    const float* ry = getParticleComponent(PARTICLE_ROTATION_AXIS_Y);
+    const float* rz = getParticleComponent(PARTICLE_ROTATION_AXIS_Z);
+    for (unsigned int i = 0; i < _particleCount; i++)
+    {
+        if (rotationSpeed[i] != 0.0f && (rx[i] != 0.0f || ry[i] != 0.0f || rz[i] != 0.0f))
         {
-            if (p->_rotationSpeed != 0.0f && !p->_rotationAxis.isZero())
-            {
-                Matrix::createRotation(p->_rotationAxis, p->_rotationSpeed * elapsedSecs, &_rotation);
+            Matrix::createRotation(Vector3(rx[i], ry[i], rz[i]), rotationSpeed[i] * elapsedSecs, &_rotation);
+
+            Vector3 v(vx[i], vy[i], vz[i]);
+            Vector3 a(ax[i], ay[i], az[i]);
+            _rotation.transformPoint(&v);
+            _rotation.transformPoint(&a);
+            vx[i] = v.x; vy[i] = v.y; vz[i] = v.z;
+            ax[i] = a.x; ay[i] = a.y; az[i] = a.z;
+        }
+    }
 
-                _rotation.transformPoint(p->_velocity, &p->_velocity);
-                _rotation.transformPoint(p->_acceleration, &p->_acceleration);
-            }
+    float* energy = getParticleComponent(PARTICLE_ENERGY);
+    const float* energyStartReciprocal = getParticleComponent(PARTICLE_ENERGY_START_RECIPROCAL);
+    float* angle = getParticleComponent(PARTICLE_ANGLE);
+    const float* rotationPerParticleSpeed = getParticleComponent(PARTICLE_ROTATION_PER_PARTICLE_SPEED);
+    float* visible = getParticleComponent(PARTICLE_VISIBLE);
+    float* size = getParticleComponent(PARTICLE_SIZE);
+    const float* sizeStart = getParticleComponent(PARTICLE_SIZE_START);
+    const float* sizeEnd = getParticleComponent(PARTICLE_SIZE_END);
+    float* color[4];
+    const float* colorStart[4];
+    const float* colorEnd[4];
+    for (unsigned int c = 0; c < 4; c++)
+    {
+        color[c] = getParticleComponent((ParticleComponent)(PARTICLE_COLOR_R + c));
+        colorStart[c] = getParticleComponent((ParticleComponent)(PARTICLE_COLOR_START_R + c));
+        colorEnd[c] = getParticleComponent((ParticleComponent)(PARTICLE_COLOR_END_R + c));
+    }
 
-            // Particle is still alive.
-            p->_velocity.x += p->_acceleration.x * elapsedSecs;
-            p->_velocity.y += p->_acceleration.y * elapsedSecs;
-            p->_velocity.z += p->_acceleration.z * elapsedSecs;
+    const Plane* planes[6] = { &frustum.getNear(), &frustum.getFar(), &frustum.getLeft(), &frustum.getRight(), &frustum.getTop(), &frustum.getBottom() };
 
-            p->_position.x += p->_velocity.x * elapsedSecs;
-            p->_position.y += p->_velocity.y * elapsedSecs;
-            p->_position.z += p->_velocity.z * elapsedSecs;
+    const Float4 elapsed = splatFloat4(elapsedTime);
+    const Float4 dt = splatFloat4(elapsedSecs);
+    const Float4 one = splatFloat4(1.0f);
+    Float4 minX = splatFloat4(FLT_MAX), minY = minX, minZ = minX;
+    Float4 maxX = splatFloat4(-FLT_MAX), maxY = maxX, maxZ = maxX;
+    const unsigned int groupedCount = _particleCount & ~3u;
 
-            if (!frustum.intersects(p->_position))
-            {
-                p->_visible = false;
-                continue;
-            }
+    // The arrays are padded to a multiple of four, so the last group may include unused particles.
+    for (unsigned int i = 0; i < _particleCount; i += 4)
+    {
+        Float4 e = subFloat4(loadFloat4(&energy[i]), elapsed);
+        storeFloat4(&energy[i], e);
+
+        Float4 velX = maddFloat4(loadFloat4(&vx[i]), loadFloat4(&ax[i]), dt);
+        Float4 velY = maddFloat4(loadFloat4(&vy[i]), loadFloat4(&ay[i]), dt);
+        Float4 velZ = maddFloat4(loadFloat4(&vz[i]), loadFloat4(&az[i]), dt);
+        storeFloat4(&vx[i], velX);
+        storeFloat4(&vy[i], velY);
+        storeFloat4(&vz[i], velZ);
+
+        Float4 posX = maddFloat4(loadFloat4(&px[i]), velX, dt);
+        Float4 posY = maddFloat4(loadFloat4(&py[i]), velY, dt);
+        Float4 posZ = maddFloat4(loadFloat4(&pz[i]), velZ, dt);
+        storeFloat4(&px[i], posX);
+        storeFloat4(&py[i], posY);
+        storeFloat4(&pz[i], posZ);
+
+        // The unused particles of the last group are left out of the bounds.
+        if (i < groupedCount)
+        {
+            minX = minFloat4(minX, posX); minY = minFloat4(minY, posY); minZ = minFloat4(minZ, posZ);
+            maxX = maxFloat4(maxX, posX); maxY = maxFloat4(maxY, posY); maxZ = maxFloat4(maxZ, posZ);
+        }
+
+        // A particle is visible if it is in front of all planes of the frustum.
+        Float4 vis = one;
+        for (unsigned int p = 0; p < 6; p++)
+        {
+            vis = selectPositiveFloat4(planeDistanceFloat4(*planes[p], posX, posY, posZ), vis);
+        }
+        storeFloat4(&visible[i], vis);
 
-            p->_angle += p->_rotationPerParticleSpeed * elapsedSecs;
+        storeFloat4(&angle[i], maddFloat4(loadFloat4(&angle[i]), loadFloat4(&rotationPerParticleSpeed[i]), dt));
 
-            // Simple linear interpolation of color and size.
-            float percent = 1.0f - ((float)p->_energy / (float)p->_energyStart);
+        // Simple linear interpolation of color and size.
+        Float4 percent = subFloat4(one, mulFloat4(e, loadFloat4(&energyStartReciprocal[i])));
+        for (unsigned int c = 0; c < 4; c++)
+        {
+            Float4 start = loadFloat4(&colorStart[c][i]);
+            storeFloat4(&color[c][i], maddFloat4(start, subFloat4(loadFloat4(&colorEnd[c][i]), start), percent));
+        }
+        Float4 start = loadFloat4(&sizeStart[i]);
+        storeFloat4(&size[i], maddFloat4(start, subFloat4(loadFloat4(&sizeEnd[i]), start), percent));
+    }
 
-            p->_color.x = p->_colorStart.x + (p->_colorEnd.x - p->_colorStart.x) * percent;
-            p->_color.y = p->_colorStart.y + (p->_colorEnd.y - p->_colorStart.y) * percent;
-            p->_color.z = p->_colorStart.z + (p->_colorEnd.z - p->_colorStart.z) * percent;
-            p->_color.w = p->_colorStart.w + (p->_colorEnd.w - p->_colorStart.w) * percent;
+    _particleMin.set(minLanes(minX), minLanes(minY), minLanes(minZ));
+    _particleMax.set(maxLanes(maxX), maxLanes(maxY), maxLanes(maxZ));
+    for (unsigned int i = groupedCount; i < _particleCount; i++)
+    {
+        _particleMin.set(std::min(_particleMin.x, px[i]), std::min(_particleMin.y, py[i]), std::min(_particleMin.z, pz[i]));
+        _particleMax.set(std::max(_particleMax.x, px[i]), std::max(_particleMax.y, py[i]), std::max(_particleMax.z, pz[i]));
+    }
+}
 
-            p->_size = p->_sizeStart + (p->_sizeEnd - p->_sizeStart) * percent;
+void ParticleEmitter::updateParticleFrames(float elapsedSecs)
+{
+    const float* energy = getParticleComponent(PARTICLE_ENERGY);
+    const float* energyStartReciprocal = getParticleComponent(PARTICLE_ENERGY_START_RECIPROCAL);
+    float* frame = getParticleComponent(PARTICLE_FRAME);
+    float* timeOnCurrentFrame = getParticleComponent(PARTICLE_TIME_ON_CURRENT_FRAME);
+    const float lastFrame = (float)(_spriteFrameCount - 1);
 
-            // Handle sprite animations.
-            if (_spriteAnimated)
+    for (unsigned int i = 0; i < _particleCount; i++)
+    {
+        if (!_spriteLooped)
+        {
+            // The last frame should finish exactly when the particle dies.
+            float percent = 1.0f - energy[i] * energyStartReciprocal[i];
+            timeOnCurrentFrame[i] = percent - frame[i] * _spritePercentPerFrame;
+            if (frame[i] < lastFrame && timeOnCurrentFrame[i] >= _spritePercentPerFrame)
             {
-                if (!_spriteLooped)
-                {
-                    // The last frame should finish exactly when the particle dies.
-                    float percentSpent = 0.0f;
-                    for (unsigned int i = 0; i < p->_frame; i++)
-                    {
-                        percentSpent += _spritePercentPerFrame;
-                    }
-                    p->_timeOnCurrentFrame = percent - percentSpent;
-                    if (p->_frame < _spriteFrameCount - 1 &&
-                        p->_timeOnCurrentFrame >= _spritePercentPerFrame)
-                    {
-                        ++p->_frame;
-                    }
-                }
-                else
-                {
-                    // _spriteFrameDurationSecs is an absolute time measured in seconds,
-                    // and the animation repeats indefinitely.
-                    p->_timeOnCurrentFrame += elapsedSecs;
-                    if (p->_timeOnCurrentFrame >= _spriteFrameDurationSecs)
-                    {
-                        p->_timeOnCurrentFrame -= _spriteFrameDurationSecs;
-                        ++p->_frame;
-                        if (p->_frame == _spriteFrameCount)
-                        {
-                            p->_frame = 0;
-                        }
-                    }
-                }
+                frame[i] += 1.0f;
             }
         }
         else
         {
-            // Particle is dead.  Move the particle furthest from the start of the array
-            // down to take its place, and re-use the slot at the end of the list of living particles.
-            if (particlesIndex != _particleCount - 1)
+            // _spriteFrameDurationSecs is an absolute time measured in seconds,
+            // and the animation repeats indefinitely.
+            timeOnCurrentFrame[i] += elapsedSecs;
+            if (timeOnCurrentFrame[i] >= _spriteFrameDurationSecs)
             {
-                _particles[particlesIndex] = _particles[_particleCount - 1];
+                timeOnCurrentFrame[i] -= _spriteFrameDurationSecs;
+                frame[i] += 1.0f;
+                if (frame[i] > lastFrame)
+                {
+                    frame[i] = 0.0f;
+                }
             }
-            --_particleCount;
         }
     }
 }
 
+void ParticleEmitter::removeDeadParticles()
+{
+    // Compute the new index of every particle: particles that are alive are moved down
+    // over the dead ones. Dead particles are written to the slot of the next living one,
+    // which overwrites them, so no branches are needed.
+    const float* energy = getParticleComponent(PARTICLE_ENERGY);
+    unsigned int aliveCount = 0;
+    for (unsigned int i = 0; i < _particleCount; i++)
+    {
+        _particleIndices[i] = aliveCount;
+        aliveCount += energy[i] > 0.0f ? 1 : 0;
+    }
+
+    if (aliveCount == _particleCount)
+    {
+        return;
+    }
+
+    // Indices never increase, so each component can be compacted in place.
+    for (unsigned int c = 0; c < PARTICLE_COMPONENT_COUNT; c++)
+    {
+        float* values = getParticleComponent((ParticleComponent)c);
+        for (unsigned int i = 0; i < _particleCount; i++)
+        {
+            values[_particleIndices[i]] = values[i];
+        }
+    }
+    _particleCount = aliveCount;
+}
+
 void ParticleEmitter::draw()
 {
-    if (!isActive())
+    if (!isActive() || _culled)
     {
         return;
     }
 
+    GP_GPU_PROFILE("particles");
+
+    // The blending of emitters that multiply the scene cannot be composited.
+    bool offscreen = _offscreen && OffscreenParticles::isActive() &&
+        (_spriteTextureBlending == BLEND_TRANSPARENT || _spriteTextureBlending == BLEND_ADDITIVE);
+    if (offscreen)
+    {
+        FrameBuffer* previous = OffscreenParticles::bind();
+        if (_gpuSimulated)
+            drawGPU(true);
+        else
+            drawSprites(true);
+        OffscreenParticles::unbind(previous);
+    }
+    else if (_gpuSimulated)
+    {
+        drawGPU(false);
+    }
+    else
+    {
+        drawSprites(false);
+    }
+}
+
+void ParticleEmitter::drawSprites(bool offscreen)
+{
     if (_particleCount > 0)
     {
         GP_ASSERT(_spriteBatch);
-        GP_ASSERT(_particles);
+        GP_ASSERT(_particleData);
         GP_ASSERT(_spriteTextureCoords);
 
         // Set our node's view projection matrix to this emitter's effect.
@@ -940,28 +1657,249 @@ void ParticleEmitter::draw()
 
         // 3D Rotation so that particles always face the camera.
         GP_ASSERT(_node && _node->getScene() && _node->getScene()->getActiveCamera() && _node->getScene()->getActiveCamera()->getNode());
-        const Matrix& cameraWorldMatrix = _node->getScene()->getActiveCamera()->getNode()->getWorldMatrix();
+        Camera* camera = _node->getScene()->getActiveCamera();
+        const Matrix& cameraWorldMatrix = camera->getNode()->getWorldMatrix();
 
         Vector3 right;
         cameraWorldMatrix.getRightVector(&right);
         Vector3 up;
         cameraWorldMatrix.getUpVector(&up);
 
-        for (unsigned int i = 0; i < _particleCount; i++)
+        // A particle covers the fraction size * m[5] / (2 * depth) of the viewport height.
+        bool perspective = camera->getCameraType() == Camera::PERSPECTIVE;
+        float sizeLimit = _maxScreenSize * 2.0f / camera->getProjectionMatrix().m[5];
+        if (_depthSorted || (_maxScreenSize > 0.0f && perspective))
         {
-            Particle* p = &_particles[i];
+            Vector3 forward;
+            cameraWorldMatrix.getForwardVector(&forward);
+            forward.normalize();
+            computeDepths(camera->getNode()->getTranslationWorld(), forward);
+        }
 
-            if (p->_visible)
+        const float* px = getParticleComponent(PARTICLE_POSITION_X);
+        const float* py = getParticleComponent(PARTICLE_POSITION_Y);
+        const float* pz = getParticleComponent(PARTICLE_POSITION_Z);
+        const float* r = getParticleComponent(PARTICLE_COLOR_R);
+        const float* g = getParticleComponent(PARTICLE_COLOR_G);
+        const float* b = getParticleComponent(PARTICLE_COLOR_B);
+        const float* a = getParticleComponent(PARTICLE_COLOR_A);
+        const float* size = getParticleComponent(PARTICLE_SIZE);
+        const float* angle = getParticleComponent(PARTICLE_ANGLE);
+        const float* frame = getParticleComponent(PARTICLE_FRAME);
+        const float* visible = getParticleComponent(PARTICLE_VISIBLE);
+
+        for (unsigned int n = 0; n < _particleCount; n++)
+        {
+            unsigned int i = _depthSorted ? (unsigned int)(_sortKeys[n] & 0xFFFFFFFF) : n;
+            if (visible[i] != 0.0f)
             {
-                _spriteBatch->draw(p->_position, right, up, p->_size, p->_size,
-                                   _spriteTextureCoords[p->_frame * 4], _spriteTextureCoords[p->_frame * 4 + 1], _spriteTextureCoords[p->_frame * 4 + 2], _spriteTextureCoords[p->_frame * 4 + 3],
-                                   p->_color, pivot, p->_angle);
+                float s = size[i];
+                if (_maxScreenSize > 0.0f)
+                    s = std::min(s, perspective ? sizeLimit * std::max(_particleDepths[i], 0.0f) : sizeLimit);
+                const float* uvs = &_spriteTextureCoords[(unsigned int)frame[i] * 4];
+                _spriteBatch->draw(Vector3(px[i], py[i], pz[i]), right, up, s, s,
+                                   uvs[0], uvs[1], uvs[2], uvs[3],
+                                   Vector4(r[i], g[i], b[i], a[i]), pivot, angle[i]);
             }
         }
 
         // Render.
-        _spriteBatch->finish();
+        if (offscreen)
+        {
+            // The blend state of the batch is bound first, so binding it with the batch
+            // does not replace the blending of the off-screen frame buffer.
+            _spriteBatch->getStateBlock()->bind();
+            OffscreenParticles::bindBlend(_spriteTextureBlending == BLEND_ADDITIVE);
+            _spriteBatch->finish();
+            OffscreenParticles::unbindBlend(_spriteTextureBlending == BLEND_ADDITIVE);
+        }
+        else
+        {
+            _spriteBatch->finish();
+        }
+    }
+}
+
+/**
+ * Computes the view depths of a range of particles, and the keys that order them from back to front.
+ */
+struct ParticleDepths : public JobController::Range
+{
+    ParticleDepths(const float* px, const float* py, const float* pz, const Vector3& eye, const Vector3& forward,
+                   float* depths, unsigned long long* keys)
+        : px(px), py(py), pz(pz), eye(eye), forward(forward), depths(depths), keys(keys)
+    {
+    }
+
+    void run(unsigned int begin, unsigned int end)
+    {
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            float depth = (px[i] - eye.x) * forward.x + (py[i] - eye.y) * forward.y + (pz[i] - eye.z) * forward.z;
+            depths[i] = depth;
+            if (keys)
+            {
+                // The bit pattern of a positive float increases with its value, so inverting
+                // it gives the farthest particles the smallest keys.
+                union
+                {
+                    float f;
+                    unsigned int i;
+                } bits;
+                bits.f = depth > 0.0f ? depth : 0.0f;
+                keys[i] = ((unsigned long long)(0xFFFFFFFFu - bits.i) << 32) | i;
+            }
+        }
+    }
+
+    const float* px;
+    const float* py;
+    const float* pz;
+    Vector3 eye;
+    Vector3 forward;
+    float* depths;
+    unsigned long long* keys;
+};
+
+/**
+ * Sorts keys by their upper 32 bits, a byte at a time, keeping the order of equal keys.
+ * Passes over a byte that is the same in all the keys are skipped.
+ */
+static void radixSort(std::vector<unsigned long long>& keys, std::vector<unsigned long long>& scratch)
+{
+    unsigned int count = (unsigned int)keys.size();
+    scratch.resize(count);
+    unsigned long long* src = &keys[0];
+    unsigned long long* dst = &scratch[0];
+    for (unsigned int shift = 32; shift < 64; shift += 8)
+    {
+        unsigned int offsets[256];
+        memset(offsets, 0, sizeof(offsets));
+        for (unsigned int i = 0; i < count; ++i)
+            offsets[(src[i] >> shift) & 0xFF]++;
+        if (offsets[(src[0] >> shift) & 0xFF] == count)
+            continue;
+
+        unsigned int sum = 0;
+        for (unsigned int b = 0; b < 256; ++b)
+        {
+            unsigned int bucketCount = offsets[b];
+            offsets[b] = sum;
+            sum += bucketCount;
+        }
+        for (unsigned int i = 0; i < count; ++i)
+            dst[offsets[(src[i] >> shift) & 0xFF]++] = src[i];
+        std::swap(src, dst);
+    }
+    if (src != &keys[0])
+        keys.swap(scratch);
+}
+
+void ParticleEmitter::computeDepths(const Vector3& eye, const Vector3& forward)
+{
+    _particleDepths.resize(_particleCount);
+    if (_depthSorted)
+        _sortKeys.resize(_particleCount);
+
+    ParticleDepths depths(getParticleComponent(PARTICLE_POSITION_X), getParticleComponent(PARTICLE_POSITION_Y),
+                          getParticleComponent(PARTICLE_POSITION_Z), eye, forward, &_particleDepths[0],
+                          _depthSorted ? &_sortKeys[0] : NULL);
+    JobController* jobController = Game::getInstance()->getJobController();
+    if (jobController && _particleCount >= PARTICLE_PARALLEL_MIN_COUNT)
+        jobController->parallelFor(_particleCount, &depths);
+    else
+        depths.run(0, _particleCount);
+
+    if (_depthSorted)
+        radixSort(_sortKeys, _sortScratch);
+}
+
+void ParticleEmitter::drawGPU(bool offscreen)
+{
+    GP_ASSERT(_gpuMaterial);
+    GP_ASSERT(_spriteTextureCoords);
+    if (_gpuSlotCount == 0)
+        return;
+
+    GP_ASSERT(_node && _node->getScene() && _node->getScene()->getActiveCamera() && _node->getScene()->getActiveCamera()->getNode());
+    const Matrix& cameraWorldMatrix = _node->getScene()->getActiveCamera()->getNode()->getWorldMatrix();
+    Vector3 right;
+    cameraWorldMatrix.getRightVector(&right);
+    Vector3 up;
+    cameraWorldMatrix.getUpVector(&up);
+
+    // Select how the vertex shader picks the sprite frame of each particle.
+    unsigned int frameCount = std::min(_spriteFrameCount, (unsigned int)PARTICLE_GPU_FRAME_COUNT_MAX);
+    float frameAnimation = 0.0f;
+    if (_spriteAnimated && frameCount > 1)
+    {
+        if (_spriteLooped && _spriteFrameDurationSecs > 0.0f)
+            frameAnimation = 1.0f;
+        else if (!_spriteLooped && _spritePercentPerFrame > 0.0f)
+            frameAnimation = 2.0f;
+    }
+
+    Pass* pass = _gpuMaterial->getTechnique()->getPassByIndex(0);
+    GP_ASSERT(pass);
+    pass->getParameter("u_viewProjectionMatrix")->setValue(_node->getViewProjectionMatrix());
+    pass->getParameter("u_cameraRight")->setValue(right);
+    pass->getParameter("u_cameraUp")->setValue(up);
+    pass->getParameter("u_time")->setValue((float)_gpuTime);
+    pass->getParameter("u_frameCoords")->setValue((const Vector4*)_spriteTextureCoords, frameCount);
+    pass->getParameter("u_frameAnimation")->setValue(Vector4((float)frameCount, _spriteFrameDurationSecs, _spritePercentPerFrame, frameAnimation));
+    pass->bind();
+    if (offscreen)
+    {
+        OffscreenParticles::bindBlend(_spriteTextureBlending == BLEND_ADDITIVE);
+    }
+
+    Effect* effect = pass->getEffect();
+    GP_ASSERT(effect);
+    VertexAttribute attributes[GPU_PARTICLE_ATTRIBUTE_COUNT];
+    for (unsigned int i = 0; i < GPU_PARTICLE_ATTRIBUTE_COUNT; i++)
+    {
+        attributes[i] = effect->getVertexAttribute(__gpuParticleAttributes[i].name);
+        if (attributes[i] != -1)
+        {
+            GL_ASSERT( glEnableVertexAttribArray(attributes[i]) );
+        }
+    }
+
+    GLStateCache::bindBuffer(GL_ARRAY_BUFFER, _gpuVertexBuffer);
+    GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _gpuIndexBuffer);
+
+    // Draw the particles in batches whose vertices can be addressed by the 16-bit indices.
+    for (unsigned int first = 0; first < _gpuSlotCount; first += PARTICLE_GPU_BATCH_SIZE)
+    {
+        unsigned int count = std::min(_gpuSlotCount - first, (unsigned int)PARTICLE_GPU_BATCH_SIZE);
+        size_t base = first * 4 * sizeof(GPUParticleVertex);
+        for (unsigned int i = 0; i < GPU_PARTICLE_ATTRIBUTE_COUNT; i++)
+        {
+            if (attributes[i] != -1)
+            {
+                GL_ASSERT( glVertexAttribPointer(attributes[i], __gpuParticleAttributes[i].size, GL_FLOAT, GL_FALSE,
+                    sizeof(GPUParticleVertex), (const GLvoid*)(base + __gpuParticleAttributes[i].offset)) );
+            }
+        }
+        GL_ASSERT( glDrawElements(GL_TRIANGLES, count * 6, GL_UNSIGNED_SHORT, 0) );
+        RenderStats::addDraw(GL_TRIANGLES, count * 6);
+    }
+
+    GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GLStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
+    for (unsigned int i = 0; i < GPU_PARTICLE_ATTRIBUTE_COUNT; i++)
+    {
+        if (attributes[i] != -1)
+        {
+            GL_ASSERT( glDisableVertexAttribArray(attributes[i]) );
+        }
+    }
+
+    if (offscreen)
+    {
+        OffscreenParticles::unbindBlend(_spriteTextureBlending == BLEND_ADDITIVE);
     }
+    pass->unbind();
 }
 
 }
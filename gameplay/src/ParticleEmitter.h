@@ -14,6 +14,7 @@ namespace gameplay
 {
 
 class Node;
+class Frustum;
 
 /**
  * Defines a particle emitter that can be made to simulate and render a particle system.
@@ -135,6 +136,39 @@ class Node;
  * be set before rendering the particle system and then will be reset to their original
  * values.  Accepts the same symbolic constants as glBlendFunc().
  *
+ * <h2>GPU simulation:</h2>
+ *
+ * By default particles are simulated on the CPU in update() and streamed to a SpriteBatch
+ * in draw().  An emitter can instead be set to simulate its particles on the GPU; see
+ * setGPUSimulated().  In that mode the CPU only writes the initial state of newly emitted
+ * particles into a vertex buffer, and the vertex shader computes the position, rotation,
+ * color, size and sprite frame of every particle from its age, so the cost on the CPU no
+ * longer depends on the number of living particles.  The rotation of particles around the
+ * RotationAxis is not supported by GPU simulation.
+ *
+ * <h2>Off-screen drawing:</h2>
+ *
+ * Emitters of large particles, such as smoke and fire, can be drawn at a reduced resolution
+ * to save fill rate; see setOffscreen() and OffscreenParticles.
+ *
+ * <h2>Draw order and overdraw:</h2>
+ *
+ * Particles are drawn in the order they are stored, which is only correct for additive
+ * blending. Alpha blended emitters can be set to draw their particles from back to front;
+ * see setDepthSorted(). Emitters are ordered among each other and with the blended parts of
+ * models when they are added to a RenderQueue. The size of particles can be limited by the
+ * fraction of the viewport they cover, which bounds the overdraw of particles close to the
+ * camera; see setMaxScreenSize().
+ *
+ * <h2>Culling:</h2>
+ *
+ * Emitters simulated on the CPU whose particles cannot be seen, because they are outside the
+ * view frustum of the active camera or further from it than the cull distance, sleep instead
+ * of being simulated. Their bounds are computed from the positions, velocities, accelerations
+ * and energies their particles are emitted with, so they do not need to be simulated to be
+ * tested. When an emitter wakes, it catches up with the time it slept in a few large steps.
+ * See setCullingEnabled() and setCullDistance().
+ *
  */
 class ParticleEmitter : public Ref
 {
@@ -247,6 +281,142 @@ public:
      */
     unsigned int getParticlesCount() const;
 
+    /**
+     * Sets whether the particles of this emitter are simulated on the GPU.
+     *
+     * GPU simulation supports the same properties as CPU simulation, except for the
+     * rotation of particles around the RotationAxis, and is well suited to emitters with many
+     * thousands of particles.  Particles are assigned to the slots of a ring buffer of
+     * particleCountMax slots as they are emitted, so once the maximum is reached the oldest
+     * particles are replaced by new ones instead of new particles being dropped.
+     *
+     * Only the first 32 frames of the sprite are used by particles simulated on the GPU.
+     *
+     * Changing the simulation mode removes all living particles.  This can also be set
+     * with the 'gpuSimulated' property of the particle namespace.
+     *
+     * @param gpuSimulated Whether to simulate particles on the GPU.
+     */
+    void setGPUSimulated(bool gpuSimulated);
+
+    /**
+     * Determines whether the particles of this emitter are simulated on the GPU.
+     *
+     * @return True if particles are simulated on the GPU, false if they are simulated on the CPU.
+     */
+    bool isGPUSimulated() const;
+
+    /**
+     * Sets whether the particles of this emitter are drawn at the reduced resolution of
+     * OffscreenParticles while it is active.
+     *
+     * Only alpha blended and additive emitters are drawn off-screen. This can also be set
+     * with the 'offscreen' property of the particle namespace.
+     *
+     * @param offscreen Whether to draw the particles off-screen.
+     */
+    void setOffscreen(bool offscreen);
+
+    /**
+     * Determines whether the particles of this emitter are drawn off-screen.
+     *
+     * @return True if the particles are drawn at the reduced resolution of OffscreenParticles.
+     */
+    bool isOffscreen() const;
+
+    /**
+     * Sets whether the particles of this emitter are drawn from back to front.
+     *
+     * The particles are sorted every time they are drawn, by their depth along the view
+     * direction of the active camera, with a radix sort. The depths of large emitters are
+     * computed by the job controller. Particles simulated on the GPU are not sorted.
+     * This can also be set with the 'depthSorted' property of the particle namespace.
+     *
+     * @param depthSorted Whether to sort the particles before drawing them.
+     */
+    void setDepthSorted(bool depthSorted);
+
+    /**
+     * Determines whether the particles of this emitter are drawn from back to front.
+     *
+     * @return True if the particles are sorted before they are drawn.
+     */
+    bool isDepthSorted() const;
+
+    /**
+     * Sets the largest fraction of the viewport height a particle can cover.
+     *
+     * Particles closer to the camera are drawn smaller, so a few particles in front of
+     * the camera do not cover the viewport many times over. Particles simulated on the
+     * GPU are not limited. This can also be set with the 'maxScreenSize' property of the
+     * particle namespace.
+     *
+     * @param maxScreenSize The fraction of the viewport height, or 0 for no limit, the default.
+     */
+    void setMaxScreenSize(float maxScreenSize);
+
+    /**
+     * Returns the largest fraction of the viewport height a particle can cover.
+     *
+     * @return The fraction of the viewport height, or 0 if the size of particles is not limited.
+     */
+    float getMaxScreenSize() const;
+
+    /**
+     * Sets whether this emitter sleeps while its particles cannot be seen.
+     *
+     * A culled emitter neither simulates nor draws its particles. When it is visible again,
+     * it simulates the time it slept in at most a few steps, or only the lifetime of its
+     * particles if it slept longer than that, so it looks as if it never stopped. Culling is
+     * enabled by default; it should be disabled for emitters whose particles must be
+     * simulated exactly. Particles simulated on the GPU are never culled. This can also be
+     * set with the 'culling' property of the particle namespace.
+     *
+     * @param enabled Whether to cull the emitter.
+     */
+    void setCullingEnabled(bool enabled);
+
+    /**
+     * Determines whether this emitter sleeps while its particles cannot be seen.
+     *
+     * @return True if the emitter is culled when it is outside the view frustum or too far from the camera.
+     */
+    bool isCullingEnabled() const;
+
+    /**
+     * Sets the distance from the camera beyond which this emitter is culled.
+     *
+     * This can also be set with the 'cullDistance' property of the particle namespace.
+     *
+     * @param distance The distance from the camera to the bounds of the emitter, or 0 for no limit, the default.
+     */
+    void setCullDistance(float distance);
+
+    /**
+     * Returns the distance from the camera beyond which this emitter is culled.
+     *
+     * @return The distance, or 0 if emitters are only culled by the view frustum.
+     */
+    float getCullDistance() const;
+
+    /**
+     * Determines whether this emitter was culled at its last update.
+     *
+     * @return True if the emitter is sleeping.
+     */
+    bool isCulled() const;
+
+    /**
+     * Returns the world space bounds the emitter was tested against the camera with at its last update.
+     *
+     * The bounds contain the particles that were alive, and those that may be emitted, while
+     * the emitter slept. They are only computed while culling is enabled.
+     *
+     * @return The bounds of the particles of the emitter.
+     * @script{ignore}
+     */
+    const BoundingBox& getBounds() const;
+
     /**
      * Sets whether the positions of newly emitted particles are generated within an ellipsoidal domain.
      *
@@ -628,6 +798,13 @@ public:
      */
     void setTextureBlending(TextureBlending blending);
 
+    /**
+     * Returns the blending the particles are drawn with.
+     *
+     * @return The texture blending.
+     */
+    TextureBlending getTextureBlending() const;
+
 private:
 
     /**
@@ -667,35 +844,121 @@ private:
     void generateColor(const Vector4& base, const Vector4& variance, Vector4* dst);
 
     /**
-     * Defines the data for a single particle in the system.
+     * Defines the components of the particles in the system.
+     *
+     * Particles are stored as a structure of arrays: each component of all the particles
+     * is stored in its own array of floats, so that the particles can be updated four at
+     * a time with SIMD instructions and dead particles can be removed without branches.
      */
-    class Particle
+    enum ParticleComponent
     {
-
-    public:
-        Vector3 _position;
-        Vector3 _velocity;
-        Vector3 _acceleration;
-        Vector4 _colorStart;
-        Vector4 _colorEnd;
-        Vector4 _color;
-        float _rotationPerParticleSpeed;
-        Vector3 _rotationAxis;
-        float _rotationSpeed;
-        float _angle;
-        long _energyStart;
-        long _energy;
-        float _sizeStart;
-        float _sizeEnd;
-        float _size;
-        unsigned int _frame;
-        float _timeOnCurrentFrame;
-        bool _visible;
+        PARTICLE_POSITION_X,
+        PARTICLE_POSITION_Y,
+        PARTICLE_POSITION_Z,
+        PARTICLE_VELOCITY_X,
+        PARTICLE_VELOCITY_Y,
+        PARTICLE_VELOCITY_Z,
+        PARTICLE_ACCELERATION_X,
+        PARTICLE_ACCELERATION_Y,
+        PARTICLE_ACCELERATION_Z,
+        PARTICLE_COLOR_START_R,
+        PARTICLE_COLOR_START_G,
+        PARTICLE_COLOR_START_B,
+        PARTICLE_COLOR_START_A,
+        PARTICLE_COLOR_END_R,
+        PARTICLE_COLOR_END_G,
+        PARTICLE_COLOR_END_B,
+        PARTICLE_COLOR_END_A,
+        PARTICLE_COLOR_R,
+        PARTICLE_COLOR_G,
+        PARTICLE_COLOR_B,
+        PARTICLE_COLOR_A,
+        PARTICLE_ROTATION_PER_PARTICLE_SPEED,
+        PARTICLE_ROTATION_AXIS_X,
+        PARTICLE_ROTATION_AXIS_Y,
+        PARTICLE_ROTATION_AXIS_Z,
+        PARTICLE_ROTATION_SPEED,
+        PARTICLE_ANGLE,
+        PARTICLE_ENERGY,
+        PARTICLE_ENERGY_START_RECIPROCAL,
+        PARTICLE_SIZE_START,
+        PARTICLE_SIZE_END,
+        PARTICLE_SIZE,
+        PARTICLE_FRAME,
+        PARTICLE_TIME_ON_CURRENT_FRAME,
+        PARTICLE_VISIBLE,
+
+        PARTICLE_COMPONENT_COUNT
     };
 
+    // Returns the array of the specified component of all particles.
+    float* getParticleComponent(ParticleComponent component) const;
+
+    // Emits the particles due in the specified time, in milliseconds.
+    void emitParticles(float elapsedTime);
+
+    // Emits and simulates the particles on the CPU for the specified time, in milliseconds.
+    void simulate(float elapsedTime, const Frustum& frustum);
+
+    // Simulates the time a culled emitter slept, in a few large steps.
+    void catchUp(float sleepTime, const Frustum& frustum);
+
+    // Computes bounds that contain the particles after the emitter slept for the specified time.
+    void computeBounds(float sleepTime, BoundingBox* dst) const;
+
+    // Integrates the motion of the living particles and interpolates their color and size.
+    // Also computes the bounds of their positions.
+    void updateParticles(float elapsedTime, const Frustum& frustum);
+
+    // Advances the sprite animation of the living particles.
+    void updateParticleFrames(float elapsedSecs);
+
+    // Removes the particles whose energy has run out, keeping the others in order.
+    void removeDeadParticles();
+
+    // Creates the vertex and index buffers and the material used by GPU simulation.
+    bool createGPUResources();
+
+    // Uploads the vertices of the particles emitted since firstSlot to the GPU.
+    void uploadGPUParticles(unsigned int firstSlot);
+
+    // Draws the particles simulated on the CPU with the sprite batch.
+    void drawSprites(bool offscreen);
+
+    // Computes the view depths of the particles and, if they are sorted, their order from back to front.
+    void computeDepths(const Vector3& eye, const Vector3& forward);
+
+    // Draws the particles simulated on the GPU.
+    void drawGPU(bool offscreen);
+
     unsigned int _particleCountMax;
     unsigned int _particleCount;
-    Particle* _particles;
+    unsigned int _particleStride;
+    float* _particleData;
+    unsigned int* _particleIndices;
+    bool _gpuSimulated;
+    bool _offscreen;
+    bool _depthSorted;
+    float _maxScreenSize;
+    bool _cullingEnabled;
+    float _cullDistance;
+    bool _culled;
+    float _sleepTime;                   // The time the emitter has been culled for, in milliseconds.
+    BoundingBox _bounds;
+    Vector3 _particleMin;               // The bounds of the positions of the particles at the last simulation.
+    Vector3 _particleMax;
+    std::vector<float> _particleDepths;
+    std::vector<unsigned long long> _sortKeys;
+    std::vector<unsigned long long> _sortScratch;
+    double _gpuTime;
+    float _gpuDeathTimeMax;
+    float* _gpuDeathTimes;
+    unsigned int _gpuNextSlot;
+    unsigned int _gpuSlotCount;
+    std::vector<float> _gpuVertices;
+    VertexBufferHandle _gpuVertexBuffer;
+    IndexBufferHandle _gpuIndexBuffer;
+    Material* _gpuMaterial;
     unsigned int _emissionRate;
     bool _started;
     bool _ellipsoid;
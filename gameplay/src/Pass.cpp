@@ -1,4 +1,5 @@
 #include "Base.h"
+#include "RenderStats.h"
 #include "Pass.h"
 #include "Technique.h"
 #include "Material.h"
@@ -63,6 +64,8 @@ void Pass::bind()
 {
     GP_ASSERT(_effect);
 
+    RenderStats::add(RenderStats::STATE_CHANGES);
+
     // Bind our effect.
     _effect->bind();
 
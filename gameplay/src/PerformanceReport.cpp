@@ -0,0 +1,159 @@
+#include "Base.h"
+#include "PerformanceReport.h"
+#include "Profiler.h"
+#include "MemoryStats.h"
+#include "FileSystem.h"
+
+namespace gameplay
+{
+
+// The scopes of Game::frame that are reported.
+static const char* __stageNames[] =
+{
+    "Game::frame",
+    "JobController::update",
+    "AnimationController::update",
+    "PhysicsController::update",
+    "AIController::update",
+    "Game::update",
+    "Form::update",
+    "ScriptController::update",
+    "AudioController::update",
+    "Game::render",
+    "ScriptController::render"
+};
+
+#define STAGE_COUNT (sizeof(__stageNames) / sizeof(__stageNames[0]))
+
+/**
+ * Returns the frame time below which the specified percentage of the sorted frame times are.
+ */
+static float getPercentile(const std::vector<float>& sortedTimes, float percent)
+{
+    if (sortedTimes.empty())
+        return 0.0f;
+    unsigned int rank = (unsigned int)ceil(percent * 0.01f * sortedTimes.size());
+    return sortedTimes[rank > 0 ? rank - 1 : 0];
+}
+
+static void writeString(Stream* stream, const char* str)
+{
+    stream->write(str, 1, strlen(str));
+}
+
+static void writeEscaped(Stream* stream, const char* str)
+{
+    for (const char* c = str; *c; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+            stream->write("\\", 1, 1);
+        if ((unsigned char)*c >= 0x20)
+            stream->write(c, 1, 1);
+    }
+}
+
+PerformanceReport::PerformanceReport()
+    : _stageTimes(STAGE_COUNT, 0.0), _wasProfilerEnabled(Profiler::isEnabled())
+{
+    memset(_counters, 0, sizeof(_counters));
+}
+
+PerformanceReport::~PerformanceReport()
+{
+    Profiler::setEnabled(_wasProfilerEnabled);
+}
+
+void PerformanceReport::begin()
+{
+    _frameTimes.clear();
+    _stageTimes.assign(STAGE_COUNT, 0.0);
+    memset(_counters, 0, sizeof(_counters));
+    Profiler::clear();
+    Profiler::setEnabled(true);
+}
+
+void PerformanceReport::addFrame(double frameTime)
+{
+    for (unsigned int i = 0; i < STAGE_COUNT; ++i)
+        _stageTimes[i] += Profiler::getTotalTime(__stageNames[i]);
+    Profiler::clear();
+
+    // The counters of a frame are kept when the next one begins, so the counters of the
+    // first frame of the run are those of the frame before it, which are skipped.
+    if (!_frameTimes.empty())
+    {
+        for (unsigned int i = 0; i < RenderStats::COUNTER_COUNT; ++i)
+            _counters[i] += RenderStats::getCount((RenderStats::Counter)i);
+    }
+    _frameTimes.push_back((float)frameTime);
+}
+
+unsigned int PerformanceReport::getFrameCount() const
+{
+    return (unsigned int)_frameTimes.size();
+}
+
+bool PerformanceReport::write(const char* path, const char* name) const
+{
+    GP_ASSERT(path);
+
+    Stream* stream = FileSystem::open(path, FileSystem::WRITE);
+    if (stream == NULL)
+    {
+        GP_WARN("Failed to open performance report '%s' for writing.", path);
+        return false;
+    }
+
+    std::vector<float> times(_frameTimes);
+    std::sort(times.begin(), times.end());
+    double total = 0.0;
+    for (unsigned int i = 0; i < times.size(); ++i)
+        total += times[i];
+    unsigned int frames = (unsigned int)times.size();
+
+    char buffer[256];
+    writeString(stream, "{\n  \"name\": \"");
+    writeEscaped(stream, name ? name : "");
+    sprintf(buffer, "\",\n  \"frames\": %u,\n  \"totalTime\": %.3f,\n", frames, total);
+    writeString(stream, buffer);
+    sprintf(buffer, "  \"frameTime\": {\"mean\": %.3f, \"min\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f},\n",
+        frames > 0 ? total / frames : 0.0, frames > 0 ? times.front() : 0.0f, getPercentile(times, 50), getPercentile(times, 90),
+        getPercentile(times, 95), getPercentile(times, 99), frames > 0 ? times.back() : 0.0f);
+    writeString(stream, buffer);
+
+    // The average time of each stage per frame, in milliseconds.
+    writeString(stream, "  \"stages\": {");
+    for (unsigned int i = 0; i < STAGE_COUNT; ++i)
+    {
+        sprintf(buffer, "%s\n    \"%s\": %.4f", i > 0 ? "," : "", __stageNames[i], frames > 0 ? _stageTimes[i] / frames : 0.0);
+        writeString(stream, buffer);
+    }
+
+    // The average of each counter per frame.
+    writeString(stream, "\n  },\n  \"counters\": {");
+    unsigned int counterFrames = frames > 1 ? frames - 1 : 1;
+    for (unsigned int i = 0; i < RenderStats::COUNTER_COUNT; ++i)
+    {
+        writeString(stream, i > 0 ? ",\n    \"" : "\n    \"");
+        writeEscaped(stream, RenderStats::getName((RenderStats::Counter)i));
+        sprintf(buffer, "\": %.2f", _counters[i] / counterFrames);
+        writeString(stream, buffer);
+    }
+
+    // The peak memory of each category, in bytes.
+    writeString(stream, "\n  },\n  \"peakMemory\": {");
+    for (unsigned int i = 0; i < MemoryStats::CATEGORY_COUNT; ++i)
+    {
+        writeString(stream, i > 0 ? ",\n    \"" : "\n    \"");
+        writeEscaped(stream, MemoryStats::getName((MemoryStats::Category)i));
+        sprintf(buffer, "\": %lu", (unsigned long)MemoryStats::getPeakSize((MemoryStats::Category)i));
+        writeString(stream, buffer);
+    }
+    writeString(stream, "\n  }\n}\n");
+
+    stream->close();
+    SAFE_DELETE(stream);
+    return true;
+}
+
+}
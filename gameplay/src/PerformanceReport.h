@@ -0,0 +1,92 @@
+#ifndef PERFORMANCEREPORT_H_
+#define PERFORMANCEREPORT_H_
+
+#include "RenderStats.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a report of the performance of a run of frames, which is written as JSON.
+ *
+ * The report records the time of each frame, and after each frame collects the time the
+ * Profiler recorded for the stages of Game::frame and the RenderStats counters. It is
+ * written with the percentiles of the frame times, the average time of each stage and the
+ * average of each counter per frame, and the peak memory of each MemoryStats category,
+ * so the reports of automated runs can be compared between builds.
+ *
+ * The headless mode of the platforms uses it to report the frames it runs.
+ *
+ @verbatim
+    PerformanceReport report;
+    report.begin();
+    for (unsigned int i = 0; i < frames; ++i)
+    {
+        double start = Game::getAbsoluteTime();
+        game->frame();
+        report.addFrame(Game::getAbsoluteTime() - start);
+    }
+    report.write("perf.json");
+ @endverbatim
+ *
+ * @script{ignore}
+ */
+class PerformanceReport
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    PerformanceReport();
+
+    /**
+     * Destructor.
+     */
+    ~PerformanceReport();
+
+    /**
+     * Begins recording, enabling the profiler and discarding any frames already added.
+     */
+    void begin();
+
+    /**
+     * Adds a frame that has completed, and collects its stage times and counters.
+     *
+     * The profiler is cleared after its scopes are collected, so the run can be of any length.
+     *
+     * @param frameTime The time the frame took in milliseconds.
+     */
+    void addFrame(double frameTime);
+
+    /**
+     * Returns the number of frames added.
+     *
+     * @return The number of frames.
+     */
+    unsigned int getFrameCount() const;
+
+    /**
+     * Writes the report.
+     *
+     * @param path The path of the file to write.
+     * @param name The name of the run, such as the context it used, or NULL.
+     *
+     * @return True if the report was written.
+     */
+    bool write(const char* path, const char* name = NULL) const;
+
+private:
+
+    PerformanceReport(const PerformanceReport&);
+    PerformanceReport& operator=(const PerformanceReport&);
+
+    std::vector<float> _frameTimes;
+    std::vector<double> _stageTimes;
+    double _counters[RenderStats::COUNTER_COUNT];
+    bool _wasProfilerEnabled;
+};
+
+}
+
+#endif
@@ -10,9 +10,17 @@
 #include "Game.h"
 #include "PhysicsController.h"
 
+// The squared distance a character may move in a step, and its squared vertical speed, for it to
+// still come to rest, which absorbs the small corrections of the sweeps against the ground.
+#define CHARACTER_REST_THRESHOLD_SQUARED 1.0e-8f
+
 namespace gameplay
 {
 
+std::vector<PhysicsCharacter*> PhysicsCharacter::_characters;
+std::vector<PhysicsCharacter*> PhysicsCharacter::_moving;
+PhysicsCharacter::ActionInterface* PhysicsCharacter::_actionInterface = NULL;
+
 /**
  * @script{ignore}
  */
@@ -53,7 +61,8 @@ PhysicsCharacter::PhysicsCharacter(Node* node, const PhysicsCollisionShape::Defi
     : PhysicsGhostObject(node, shape), _moveVelocity(0,0,0), _forwardVelocity(0.0f), _rightVelocity(0.0f),
     _verticalVelocity(0, 0, 0), _currentVelocity(0,0,0), _normalizedVelocity(0,0,0),
     _colliding(false), _collisionNormal(0,0,0), _currentPosition(0,0,0), _stepHeight(0.1f),
-    _slopeAngle(0.0f), _cosSlopeAngle(0.0f), _physicsEnabled(true), _mass(mass), _actionInterface(NULL)
+    _slopeAngle(0.0f), _cosSlopeAngle(0.0f), _physicsEnabled(true), _mass(mass),
+    _resting(false), _restingPosition(0, 0, 0), _restingOverlapCount(0), _characterIndex(0)
 {
     setMaxSlopeAngle(45.0f);
 
@@ -61,19 +70,34 @@ PhysicsCharacter::PhysicsCharacter(Node* node, const PhysicsCollisionShape::Defi
     GP_ASSERT(_ghostObject);
     _ghostObject->setCollisionFlags(_ghostObject->getCollisionFlags() | btCollisionObject::CF_CHARACTER_OBJECT | btCollisionObject::CF_NO_CONTACT_RESPONSE);
 
-    // Register ourselves as an action on the physics world so we are called back during physics ticks.
+    // Add ourselves to the characters updated by the shared action, which is registered
+    // on the physics world with the first character so it is called back during physics ticks.
     GP_ASSERT(Game::getInstance()->getPhysicsController() && Game::getInstance()->getPhysicsController()->_world);
-    _actionInterface = new ActionInterface(this);
-    Game::getInstance()->getPhysicsController()->_world->addAction(_actionInterface);
+    if (_characters.empty())
+    {
+        _actionInterface = new ActionInterface();
+        Game::getInstance()->getPhysicsController()->_world->addAction(_actionInterface);
+    }
+    _characterIndex = (unsigned int)_characters.size();
+    _characters.push_back(this);
 }
 
 PhysicsCharacter::~PhysicsCharacter()
 {
-    // Unregister ourselves as action from world.
-    GP_ASSERT(Game::getInstance()->getPhysicsController() && Game::getInstance()->getPhysicsController()->_world);
-    Game::getInstance()->getPhysicsController()->_world->removeAction(_actionInterface);
-    SAFE_DELETE(_actionInterface);
-
+    // Remove ourselves from the characters, and unregister the action from the world with the last character.
+    GP_ASSERT(_characterIndex < _characters.size() && _characters[_characterIndex] == this);
+    _characters[_characterIndex] = _characters.back();
+    _characters[_characterIndex]->_characterIndex = _characterIndex;
+    _characters.pop_back();
+    std::vector<PhysicsCharacter*>::iterator moving = std::find(_moving.begin(), _moving.end(), this);
+    if (moving != _moving.end())
+        *moving = NULL;
+    if (_characters.empty())
+    {
+        GP_ASSERT(Game::getInstance()->getPhysicsController() && Game::getInstance()->getPhysicsController()->_world);
+        Game::getInstance()->getPhysicsController()->_world->removeAction(_actionInterface);
+        SAFE_DELETE(_actionInterface);
+    }
 }
 
 PhysicsCharacter* PhysicsCharacter::create(Node* node, Properties* properties)
@@ -160,6 +184,11 @@ void PhysicsCharacter::setPhysicsEnabled(bool enabled)
     _physicsEnabled = enabled;
 }
 
+bool PhysicsCharacter::isResting() const
+{
+    return _resting;
+}
+
 float PhysicsCharacter::getMaxStepHeight() const
 {
     return _stepHeight;
@@ -631,13 +660,9 @@ bool PhysicsCharacter::fixCollision(btCollisionWorld* world)
     return collision;
 }
 
-PhysicsCharacter::ActionInterface::ActionInterface(PhysicsCharacter* character) : character(character)
-{
-}
-
 void PhysicsCharacter::ActionInterface::updateAction(btCollisionWorld* collisionWorld, btScalar deltaTimeStep)
 {
-    character->updateAction(collisionWorld, deltaTimeStep);
+    PhysicsCharacter::updateCharacters(collisionWorld, deltaTimeStep);
 }
 
 void PhysicsCharacter::ActionInterface::debugDraw(btIDebugDraw* debugDrawer)
@@ -645,6 +670,77 @@ void PhysicsCharacter::ActionInterface::debugDraw(btIDebugDraw* debugDrawer)
     // Not used yet.
 }
 
+void PhysicsCharacter::updateCharacters(btCollisionWorld* collisionWorld, btScalar deltaTimeStep)
+{
+    // Find the characters that must move before moving any of them, so that a character is
+    // only woken up by changes made before this step.
+    _moving.clear();
+    for (size_t i = 0, count = _characters.size(); i < count; ++i)
+    {
+        PhysicsCharacter* character = _characters[i];
+        if (!character->canRest())
+        {
+            character->_resting = false;
+            _moving.push_back(character);
+        }
+    }
+
+    // Moving a character can destroy other characters through its node's listeners, which
+    // clear their entries.
+    for (size_t i = 0; i < _moving.size(); ++i)
+    {
+        if (_moving[i])
+            _moving[i]->updateAction(collisionWorld, deltaTimeStep);
+    }
+}
+
+bool PhysicsCharacter::canRest() const
+{
+    GP_ASSERT(_ghostObject);
+
+    if (!_resting || !_physicsEnabled)
+        return false;
+
+    // The character must not have been given a velocity, or have jumped.
+    if (!_moveVelocity.isZero() || _forwardVelocity != 0.0f || _rightVelocity != 0.0f || !_verticalVelocity.isZero())
+        return false;
+
+    // The character must not have been moved, and nothing may have come close to it or moved away from it.
+    if (_ghostObject->getWorldTransform().getOrigin() != _restingPosition || _ghostObject->getNumOverlappingObjects() != _restingOverlapCount)
+        return false;
+
+    return isSurroundingAtRest();
+}
+
+bool PhysicsCharacter::isSurroundingAtRest() const
+{
+    GP_ASSERT(_ghostObject);
+
+    for (int i = 0, count = _ghostObject->getNumOverlappingObjects(); i < count; ++i)
+    {
+        const btCollisionObject* object = _ghostObject->getOverlappingObject(i);
+        PhysicsCollisionObject* o = reinterpret_cast<PhysicsCollisionObject*>(object->getUserPointer());
+        if (o == NULL)
+            continue;
+
+        // Ghost objects do not block characters, and other characters must be at rest themselves.
+        switch (o->getType())
+        {
+        case PhysicsCollisionObject::GHOST_OBJECT:
+            break;
+        case PhysicsCollisionObject::CHARACTER:
+            if (!static_cast<PhysicsCharacter*>(o)->_resting)
+                return false;
+            break;
+        default:
+            if (!object->isStaticObject() && object->isActive())
+                return false;
+            break;
+        }
+    }
+    return true;
+}
+
 void PhysicsCharacter::updateAction(btCollisionWorld* collisionWorld, btScalar deltaTimeStep)
 {
     GP_ASSERT(_ghostObject);
@@ -692,6 +788,17 @@ void PhysicsCharacter::updateAction(btCollisionWorld* collisionWorld, btScalar d
     Vector3 translation = Vector3(newPosition.x(), newPosition.y(), newPosition.z());
     if (translation !=  Vector3::zero())
         _node->translate(translation);
+
+    // The character comes to rest when it stood still on the ground during this step, with nothing
+    // that could push it around it, so that the next steps can skip its sweeps until something changes.
+    _resting = _physicsEnabled && !_colliding && _currentVelocity.isZero() && _verticalVelocity.length2() < CHARACTER_REST_THRESHOLD_SQUARED &&
+        newPosition.length2() < CHARACTER_REST_THRESHOLD_SQUARED && isSurroundingAtRest();
+    if (_resting)
+    {
+        _verticalVelocity.setZero();
+        _restingPosition = _ghostObject->getWorldTransform().getOrigin();
+        _restingOverlapCount = _ghostObject->getNumOverlappingObjects();
+    }
 }
 
 
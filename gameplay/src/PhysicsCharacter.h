@@ -18,6 +18,11 @@ namespace gameplay
  * PhysicsCharacter class. This results in a more responsive and typical game
  * character than would be possible if trying to move a character by applying
  * physical simulation with forces.
+ *
+ * All the characters of the physics world are moved by a single action at each physics
+ * step. A character that stands still on the ground, among objects that are static or
+ * asleep, is at rest: its collision checks and sweeps are skipped until it is given a
+ * velocity, is moved, or something around it moves or appears.
  */
 class PhysicsCharacter : public PhysicsGhostObject
 {
@@ -53,6 +58,14 @@ public:
      */
     void setPhysicsEnabled(bool enabled);
 
+    /**
+     * Returns whether the character is at rest, which means that it stands still on the ground
+     * and is not simulated until something changes around it.
+     *
+     * @return true if the character is at rest, false otherwise.
+     */
+    bool isResting() const;
+
     /**
      * Returns the maximum step height for the character.
      *
@@ -228,6 +241,12 @@ private:
 
     bool fixCollision(btCollisionWorld* world);
 
+    // Determines whether the character can stay at rest for the next step.
+    bool canRest() const;
+
+    // Determines whether all the objects overlapping the character are static or asleep.
+    bool isSurroundingAtRest() const;
+
     /**
      * Hides the callback interfaces within the PhysicsCharacter.
      * @script{ignore}
@@ -236,17 +255,16 @@ private:
     {
     public:
 
-        ActionInterface(PhysicsCharacter* character);
-
         void updateAction(btCollisionWorld* collisionWorld, btScalar deltaTimeStep);
 
         void debugDraw(btIDebugDraw* debugDrawer);
-        
-        PhysicsCharacter* character;
     };
 
     void updateAction(btCollisionWorld* collisionWorld, btScalar deltaTimeStep);
 
+    // Moves all the characters that are not at rest, from the action shared by the characters.
+    static void updateCharacters(btCollisionWorld* collisionWorld, btScalar deltaTimeStep);
+
     btVector3 _moveVelocity;
     float _forwardVelocity;
     float _rightVelocity;
@@ -262,7 +280,14 @@ private:
     float _cosSlopeAngle;
     bool _physicsEnabled;
     float _mass;
-    ActionInterface* _actionInterface;
+    bool _resting;                  // Whether the character stood still at the end of its last update.
+    btVector3 _restingPosition;     // The position the character came to rest at.
+    int _restingOverlapCount;       // The number of objects overlapping the character when it came to rest.
+    unsigned int _characterIndex;   // The index of the character in _characters.
+
+    static std::vector<PhysicsCharacter*> _characters;  // All the characters, which are updated by _actionInterface.
+    static std::vector<PhysicsCharacter*> _moving;      // The characters that are not at rest in the current step.
+    static ActionInterface* _actionInterface;           // The action that updates the characters, registered while there are characters.
 };
 
 }
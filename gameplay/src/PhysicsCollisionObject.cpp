@@ -230,8 +230,11 @@ bool PhysicsCollisionObject::CollisionPair::operator < (const CollisionPair& col
     return false;
 }
 
+bool PhysicsCollisionObject::PhysicsMotionState::_syncDeferred = false;
+std::vector<PhysicsCollisionObject::PhysicsMotionState*> PhysicsCollisionObject::PhysicsMotionState::_syncQueue;
+
 PhysicsCollisionObject::PhysicsMotionState::PhysicsMotionState(Node* node, PhysicsCollisionObject* collisionObject, const Vector3* centerOfMassOffset) :
-    _node(node), _collisionObject(collisionObject), _centerOfMassOffset(btTransform::getIdentity())
+    _node(node), _collisionObject(collisionObject), _centerOfMassOffset(btTransform::getIdentity()), _syncPending(false)
 {
     if (centerOfMassOffset)
     {
@@ -244,6 +247,12 @@ PhysicsCollisionObject::PhysicsMotionState::PhysicsMotionState(Node* node, Physi
 
 PhysicsCollisionObject::PhysicsMotionState::~PhysicsMotionState()
 {
+    if (_syncPending)
+    {
+        std::vector<PhysicsMotionState*>::iterator itr = std::find(_syncQueue.begin(), _syncQueue.end(), this);
+        if (itr != _syncQueue.end())
+            _syncQueue.erase(itr);
+    }
 }
 
 void PhysicsCollisionObject::PhysicsMotionState::getWorldTransform(btTransform &transform) const
@@ -261,13 +270,61 @@ void PhysicsCollisionObject::PhysicsMotionState::setWorldTransform(const btTrans
 {
     GP_ASSERT(_node);
 
-    _worldTransform = transform * _centerOfMassOffset;
-        
+    // Bullet passes the transform interpolated to the current time; without interpolation the node follows the last step.
+    PhysicsController* physicsController = Game::getInstance()->getPhysicsController();
+    if (physicsController && !physicsController->isInterpolationEnabled() && _collisionObject && _collisionObject->getCollisionObject())
+        _worldTransform = _collisionObject->getCollisionObject()->getWorldTransform() * _centerOfMassOffset;
+    else
+        _worldTransform = transform * _centerOfMassOffset;
+
+    // Bullet only sets the transforms of the bodies that are awake, so during a step the
+    // queue holds the active bodies alone.
+    if (_syncDeferred)
+    {
+        if (!_syncPending)
+        {
+            _syncPending = true;
+            _syncQueue.push_back(this);
+        }
+    }
+    else
+    {
+        syncNode();
+    }
+}
+
+void PhysicsCollisionObject::PhysicsMotionState::syncNode()
+{
+    GP_ASSERT(_node);
+
     const btQuaternion& rot = _worldTransform.getRotation();
     const btVector3& pos = _worldTransform.getOrigin();
 
-    _node->setRotation(rot.x(), rot.y(), rot.z(), rot.w());
-    _node->setTranslation(pos.x(), pos.y(), pos.z());
+    // The rotation and translation are set together, so the node is dirtied once.
+    _node->set(_node->getScale(), Quaternion(rot.x(), rot.y(), rot.z(), rot.w()), Vector3(pos.x(), pos.y(), pos.z()));
+}
+
+void PhysicsCollisionObject::PhysicsMotionState::deferSync()
+{
+    _syncDeferred = true;
+}
+
+void PhysicsCollisionObject::PhysicsMotionState::syncNodes()
+{
+    _syncDeferred = false;
+    if (_syncQueue.empty())
+        return;
+
+    GP_PROFILE("PhysicsMotionState::syncNodes");
+    Transform::suspendTransformChanged();
+    for (size_t i = 0, count = _syncQueue.size(); i < count; ++i)
+    {
+        PhysicsMotionState* motionState = _syncQueue[i];
+        motionState->_syncPending = false;
+        motionState->syncNode();
+    }
+    _syncQueue.clear();
+    Transform::resumeTransformChanged();
 }
 
 void PhysicsCollisionObject::PhysicsMotionState::updateTransformFromNode() const
@@ -402,13 +402,33 @@ private:
          * Sets the center of mass offset for the associated collision shape.
          */
         void setCenterOfMassOffset(const Vector3& centerOfMassOffset);
+
+        /**
+         * Defers the writes of the transforms Bullet sets on motion states to their nodes
+         * until syncNodes() is called, such as during a simulation step.
+         */
+        static void deferSync();
+
+        /**
+         * Writes the transforms deferred since deferSync() to their nodes in one pass, with
+         * the transform change notifications suspended, so each node is notified once.
+         */
+        static void syncNodes();
         
     private:
+
+        /**
+         * Writes the world transform to the node.
+         */
+        void syncNode();
         
         Node* _node;
         PhysicsCollisionObject* _collisionObject;
         btTransform _centerOfMassOffset;
         mutable btTransform _worldTransform;
+        bool _syncPending;
+        static bool _syncDeferred;
+        static std::vector<PhysicsMotionState*> _syncQueue;
     };
 
     /** 
@@ -241,15 +241,16 @@ private:
     {
         float* vertexData;
         std::vector<unsigned char*> indexData;
+        std::string url;        // The URL of the mesh and the scale of the vertices, which identify the shape in the shape cache.
+        Vector3 scale;
     };
 
     struct HeightfieldData
     {
-        HeightField* heightfield;
-        bool inverseIsDirty;
-        Matrix inverse;
+        HeightField* heightfield;   // The heights, which the Bullet shape reads directly.
         float minHeight;
         float maxHeight;
+        Vector3 scale;              // The local scaling of the Bullet shape, which identifies the shape in the shape cache with the heightfield.
     };
 
     /**
@@ -1,16 +1,25 @@
 #include "Base.h"
+#include "Profiler.h"
 #include "PhysicsController.h"
 #include "PhysicsRigidBody.h"
 #include "PhysicsCharacter.h"
+#include "PhysicsVehicle.h"
 #include "Game.h"
 #include "MeshPart.h"
 #include "Bundle.h"
 #include "Terrain.h"
+#include "MemoryStats.h"
 
 #ifdef GAMEPLAY_MEM_LEAK_DETECTION
 #undef new
 #endif
 #include "BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h"
+#ifdef BT_THREADSAFE
+#include "LinearMath/btThreads.h"
+#include "BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h"
+#include "BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h"
+#include "BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h"
+#endif
 #ifdef GAMEPLAY_MEM_LEAK_DETECTION
 #define new DEBUG_NEW
 #endif
@@ -18,29 +27,160 @@
 // The initial capacity of the Bullet debug drawer's vertex batch.
 #define INITIAL_CAPACITY 280
 
+// The number of hits kept for each wheel ray of a vehicle, so that the chassis the rays start
+// in, and the objects the vehicle does not stand on, can be skipped.
+#define VEHICLE_RAY_HITS 4
+
 namespace gameplay
 {
 
-const int PhysicsController::DIRTY         = 0x01;
-const int PhysicsController::COLLISION     = 0x02;
-const int PhysicsController::REGISTERED    = 0x04;
-const int PhysicsController::REMOVE        = 0x08;
+// The size of the header that records the size of each Bullet allocation, which keeps the alignment of malloc.
+#define BULLET_ALLOCATION_HEADER 16
+
+// The allocator of Bullet, which counts the memory of the physics world in MemoryStats.
+static void* bulletAllocate(size_t size)
+{
+    char* p = (char*)malloc(size + BULLET_ALLOCATION_HEADER);
+    if (p == NULL)
+        return NULL;
+    *(size_t*)p = size;
+    MemoryStats::add(MemoryStats::PHYSICS, size);
+    return p + BULLET_ALLOCATION_HEADER;
+}
+
+static void bulletFree(void* memory)
+{
+    if (memory == NULL)
+        return;
+    char* p = (char*)memory - BULLET_ALLOCATION_HEADER;
+    MemoryStats::remove(MemoryStats::PHYSICS, *(size_t*)p);
+    free(p);
+}
+
+#ifdef BT_THREADSAFE
+
+/**
+ * Runs the parallel loops of Bullet on the job controller.
+ */
+class PhysicsController::TaskScheduler : public btITaskScheduler
+{
+public:
+
+    TaskScheduler(JobController* jobController)
+        : btITaskScheduler("gameplay"), _jobController(jobController), _threadCount(1)
+    {
+        GP_ASSERT(_jobController);
+        _threadCount = std::min((int)_jobController->getThreadCount(), BT_MAX_THREAD_COUNT);
+    }
+
+    int getMaxNumThreads() const
+    {
+        return _threadCount;
+    }
+
+    int getNumThreads() const
+    {
+        return _threadCount;
+    }
+
+    void setNumThreads(int numThreads)
+    {
+        // The job controller owns its threads.
+    }
+
+    void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body)
+    {
+        ForRange range(iBegin, body);
+        _jobController->parallelFor((unsigned int)(iEnd - iBegin), &range, (unsigned int)std::max(grainSize, 1));
+    }
+
+    btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body)
+    {
+        // Each part of the loop writes its own sum, which are added in order so the result is deterministic.
+        grainSize = std::max(grainSize, 1);
+        unsigned int partCount = (unsigned int)((iEnd - iBegin + grainSize - 1) / grainSize);
+        std::vector<btScalar> sums(partCount, btScalar(0));
+        SumRange range(iBegin, iEnd, grainSize, body, partCount > 0 ? &sums[0] : NULL);
+        _jobController->parallelFor(partCount, &range, 1);
+        btScalar sum = 0;
+        for (unsigned int i = 0; i < partCount; ++i)
+        {
+            sum += sums[i];
+        }
+        return sum;
+    }
+
+private:
+
+    class ForRange : public JobController::Range
+    {
+    public:
+
+        ForRange(int first, const btIParallelForBody& body) : _first(first), _body(body) { }
+
+        void run(unsigned int begin, unsigned int end)
+        {
+            _body.forLoop(_first + (int)begin, _first + (int)end);
+        }
+
+    private:
+
+        int _first;
+        const btIParallelForBody& _body;
+    };
+
+    class SumRange : public JobController::Range
+    {
+    public:
+
+        SumRange(int first, int last, int grainSize, const btIParallelSumBody& body, btScalar* sums)
+            : _first(first), _last(last), _grainSize(grainSize), _body(body), _sums(sums) { }
+
+        void run(unsigned int begin, unsigned int end)
+        {
+            for (unsigned int i = begin; i < end; ++i)
+            {
+                int first = _first + (int)i * _grainSize;
+                _sums[i] = _body.sumLoop(first, std::min(first + _grainSize, _last));
+            }
+        }
+
+    private:
+
+        int _first;
+        int _last;
+        int _grainSize;
+        const btIParallelSumBody& _body;
+        btScalar* _sums;
+    };
+
+    JobController* _jobController;
+    int _threadCount;
+};
+
+#else
+
+class PhysicsController::TaskScheduler
+{
+};
+
+#endif
+
+const int PhysicsController::REGISTERED    = 0x01;
+const int PhysicsController::REMOVE        = 0x02;
 
 PhysicsController::PhysicsController()
   : _isUpdating(false), _collisionConfiguration(NULL), _dispatcher(NULL),
-    _overlappingPairCache(NULL), _solver(NULL), _world(NULL), _ghostPairCallback(NULL),
-    _debugDrawer(NULL), _status(PhysicsController::Listener::DEACTIVATED), _listeners(NULL),
-    _gravity(btScalar(0.0), btScalar(-9.8), btScalar(0.0)), _collisionCallback(NULL)
+    _overlappingPairCache(NULL), _queryBroadphase(NULL), _broadphase(BROADPHASE_DBVT), _solver(NULL), _solverMt(NULL), _taskScheduler(NULL), _world(NULL), _ghostPairCallback(NULL),
+    _stepRate(60.0f), _maxSubSteps(10), _interpolation(true), _linearSleepingThreshold(0.8f), _angularSleepingThreshold(1.0f), _debugDrawer(NULL), _status(PhysicsController::Listener::DEACTIVATED), _listeners(NULL),
+    _gravity(btScalar(0.0), btScalar(-9.8), btScalar(0.0))
 {
     // Default gravity is 9.8 along the negative Y axis.
-    _collisionCallback = new CollisionCallback(this);
-
     addScriptEvent("statusEvent", "[PhysicsController::Listener::EventType]");
 }
 
 PhysicsController::~PhysicsController()
 {
-    SAFE_DELETE(_collisionCallback);
     SAFE_DELETE(_ghostPairCallback);
     SAFE_DELETE(_debugDrawer);
     SAFE_DELETE(_listeners);
@@ -146,6 +286,114 @@ const Vector3& PhysicsController::getGravity() const
     return _gravity;
 }
 
+bool PhysicsController::isMultithreaded() const
+{
+    return _taskScheduler != NULL;
+}
+
+void PhysicsController::setStepRate(float rate, unsigned int maxSubSteps)
+{
+    GP_ASSERT(rate >= 0.0f);
+    GP_ASSERT(maxSubSteps > 0);
+
+    _stepRate = rate;
+    _maxSubSteps = maxSubSteps;
+}
+
+float PhysicsController::getStepRate() const
+{
+    return _stepRate;
+}
+
+unsigned int PhysicsController::getMaxSubSteps() const
+{
+    return _maxSubSteps;
+}
+
+void PhysicsController::setInterpolationEnabled(bool enabled)
+{
+    _interpolation = enabled;
+}
+
+bool PhysicsController::isInterpolationEnabled() const
+{
+    return _interpolation;
+}
+
+PhysicsController::Broadphase PhysicsController::getBroadphase() const
+{
+    return _broadphase;
+}
+
+void PhysicsController::setSleepingThresholds(float linear, float angular)
+{
+    _linearSleepingThreshold = linear;
+    _angularSleepingThreshold = angular;
+}
+
+float PhysicsController::getLinearSleepingThreshold() const
+{
+    return _linearSleepingThreshold;
+}
+
+float PhysicsController::getAngularSleepingThreshold() const
+{
+    return _angularSleepingThreshold;
+}
+
+void PhysicsController::setDeactivationTime(float seconds)
+{
+    gDeactivationTime = seconds;
+}
+
+float PhysicsController::getDeactivationTime() const
+{
+    return gDeactivationTime;
+}
+
+void PhysicsController::setSleepingEnabled(bool enabled)
+{
+    gDisableDeactivation = !enabled;
+}
+
+bool PhysicsController::isSleepingEnabled() const
+{
+    return !gDisableDeactivation;
+}
+
+PhysicsController::Stats::Stats()
+    : objectCount(0), activeObjectCount(0), islandCount(0), broadphasePairCount(0), contactManifoldCount(0)
+{
+}
+
+PhysicsController::Stats PhysicsController::getStats() const
+{
+    Stats stats;
+    if (_world == NULL)
+        return stats;
+
+    // Bullet keeps the island of each object from the last step, so islands are counted from the tags of the objects.
+    std::vector<int> islands;
+    const btCollisionObjectArray& objects = _world->getCollisionObjectArray();
+    stats.objectCount = (unsigned int)objects.size();
+    for (int i = 0; i < objects.size(); ++i)
+    {
+        const btCollisionObject* object = objects[i];
+        if (object->isStaticObject())
+            continue;
+        if (object->isActive())
+            ++stats.activeObjectCount;
+        if (object->getIslandTag() >= 0)
+            islands.push_back(object->getIslandTag());
+    }
+    std::sort(islands.begin(), islands.end());
+    stats.islandCount = (unsigned int)(std::unique(islands.begin(), islands.end()) - islands.begin());
+
+    stats.broadphasePairCount = (unsigned int)_overlappingPairCache->getOverlappingPairCache()->getNumOverlappingPairs();
+    stats.contactManifoldCount = (unsigned int)_dispatcher->getNumManifolds();
+    return stats;
+}
+
 void PhysicsController::setGravity(const Vector3& gravity)
 {
     _gravity = gravity;
@@ -161,6 +409,12 @@ void PhysicsController::drawDebug(const Matrix& viewProjection)
 
     _debugDrawer->begin(viewProjection);
     _world->debugDrawWorld();
+
+    // The vehicles are not actions of the world, so they are drawn here.
+    for (size_t i = 0, count = _vehicles.size(); i < count; ++i)
+    {
+        _vehicles[i]->_vehicle->debugDraw(_debugDrawer);
+    }
     _debugDrawer->end();
 }
 
@@ -354,89 +608,582 @@ bool PhysicsController::sweepTest(PhysicsCollisionObject* object, const Vector3&
     return false;
 }
 
-btScalar PhysicsController::CollisionCallback::addSingleResult(btManifoldPoint& cp, const btCollisionObjectWrapper* a, int partIdA, int indexA, 
-    const btCollisionObjectWrapper* b, int partIdB, int indexB)
+/**
+ * Collects the hits of one query of a batch into its part of the caller's buffer.
+ */
+class BatchHitCollector
 {
-    GP_ASSERT(_pc);
+public:
 
-    // Get pointers to the PhysicsCollisionObject objects.
-    PhysicsCollisionObject* objectA = _pc->getCollisionObject(a->m_collisionObject);
-    PhysicsCollisionObject* objectB = _pc->getCollisionObject(b->m_collisionObject);
-
-    // If the given collision object pair has collided in the past, then
-    // we notify the listeners only if the pair was not colliding
-    // during the previous frame. Otherwise, it's a new pair, so add a
-    // new entry to the cache with the appropriate listeners and notify them.
-    PhysicsCollisionObject::CollisionPair pair(objectA, objectB);
-
-    CollisionInfo* collisionInfo;
-    if (_pc->_collisionStatus.count(pair) > 0)
+    BatchHitCollector(PhysicsController::HitResult* hits, unsigned int maxHits)
+        : _hits(hits), _maxHits(maxHits), _count(0)
     {
-        collisionInfo = &_pc->_collisionStatus[pair];
     }
-    else
+
+    /**
+     * Adds a hit and returns the fraction beyond which hits are no longer needed.
+     */
+    btScalar add(const btCollisionObject* collisionObject, const btVector3& point, const btVector3& normal, btScalar fraction)
     {
-        // Add a new collision pair for these objects.
-        collisionInfo = &_pc->_collisionStatus[pair];
+        PhysicsCollisionObject* object = reinterpret_cast<PhysicsCollisionObject*>(collisionObject->getUserPointer());
+        if (object == NULL)
+            return getMaxFraction();
 
-        // Add the appropriate listeners.
-        PhysicsCollisionObject::CollisionPair p1(pair.objectA, NULL);
-        if (_pc->_collisionStatus.count(p1) > 0)
+        // When the buffer is full, the hit replaces the farthest one.
+        unsigned int index = _count;
+        if (_count == _maxHits)
         {
-            const CollisionInfo& ci = _pc->_collisionStatus[p1];
-            std::vector<PhysicsCollisionObject::CollisionListener*>::const_iterator iter = ci._listeners.begin();
-            for (; iter != ci._listeners.end(); iter++)
+            index = 0;
+            for (unsigned int i = 1; i < _count; ++i)
             {
-                GP_ASSERT(*iter);
-                collisionInfo->_listeners.push_back(*iter);
+                if (_hits[i].fraction > _hits[index].fraction)
+                    index = i;
             }
+            if (fraction >= _hits[index].fraction)
+                return getMaxFraction();
+        }
+        else
+        {
+            ++_count;
         }
-        PhysicsCollisionObject::CollisionPair p2(pair.objectB, NULL);
-        if (_pc->_collisionStatus.count(p2) > 0)
+
+        PhysicsController::HitResult& hit = _hits[index];
+        hit.object = object;
+        hit.point.set(point.x(), point.y(), point.z());
+        hit.fraction = fraction;
+        hit.normal.set(normal.x(), normal.y(), normal.z());
+        return getMaxFraction();
+    }
+
+    /**
+     * Sorts the hits from the closest and returns their number.
+     */
+    unsigned int finish()
+    {
+        for (unsigned int i = 1; i < _count; ++i)
         {
-            const CollisionInfo& ci = _pc->_collisionStatus[p2];
-            std::vector<PhysicsCollisionObject::CollisionListener*>::const_iterator iter = ci._listeners.begin();
-            for (; iter != ci._listeners.end(); iter++)
+            for (unsigned int j = i; j > 0 && _hits[j].fraction < _hits[j - 1].fraction; --j)
             {
-                GP_ASSERT(*iter);
-                collisionInfo->_listeners.push_back(*iter);
+                std::swap(_hits[j], _hits[j - 1]);
             }
         }
+        return _count;
     }
 
-    // Fire collision event.
-    if ((collisionInfo->_status & COLLISION) == 0)
+private:
+
+    btScalar getMaxFraction() const
     {
-        std::vector<PhysicsCollisionObject::CollisionListener*>::const_iterator iter = collisionInfo->_listeners.begin();
-        for (; iter != collisionInfo->_listeners.end(); iter++)
+        // Once the buffer is full, only hits closer than the farthest one kept are needed.
+        if (_count < _maxHits)
+            return btScalar(1.0);
+        btScalar fraction = _hits[0].fraction;
+        for (unsigned int i = 1; i < _count; ++i)
         {
-            GP_ASSERT(*iter);
-            if ((collisionInfo->_status & REMOVE) == 0)
+            fraction = std::max(fraction, (btScalar)_hits[i].fraction);
+        }
+        return fraction;
+    }
+
+    PhysicsController::HitResult* _hits;
+    unsigned int _maxHits;
+    unsigned int _count;
+};
+
+/**
+ * Tests a ray against the leaves of the broadphase it crosses.
+ */
+class BatchRayTest : public btDbvt::ICollide, public btCollisionWorld::RayResultCallback
+{
+public:
+
+    BatchRayTest(const btVector3& from, const btVector3& to, int mask, BatchHitCollector* collector)
+        : _collector(collector)
+    {
+        _from.setIdentity();
+        _from.setOrigin(from);
+        _to.setIdentity();
+        _to.setOrigin(to);
+        m_collisionFilterMask = mask;
+    }
+
+    void Process(const btDbvtNode* leaf)
+    {
+        btBroadphaseProxy* proxy = reinterpret_cast<btBroadphaseProxy*>(leaf->data);
+        if ((proxy->m_collisionFilterGroup & m_collisionFilterMask) == 0)
+            return;
+        btCollisionObject* co = reinterpret_cast<btCollisionObject*>(proxy->m_clientObject);
+        if (co->getUserPointer() == NULL)
+            return;
+        btCollisionWorld::rayTestSingle(_from, _to, co, co->getCollisionShape(), co->getWorldTransform(), *this);
+    }
+
+    btScalar addSingleResult(btCollisionWorld::LocalRayResult& rayResult, bool normalInWorldSpace)
+    {
+        const btCollisionObject* co = rayResult.m_collisionObject;
+        btVector3 normal = normalInWorldSpace ? rayResult.m_hitNormalLocal : co->getWorldTransform().getBasis() * rayResult.m_hitNormalLocal;
+        btVector3 point = _from.getOrigin().lerp(_to.getOrigin(), rayResult.m_hitFraction);
+        m_closestHitFraction = _collector->add(co, point, normal, rayResult.m_hitFraction);
+        return m_closestHitFraction;
+    }
+
+private:
+
+    btTransform _from;
+    btTransform _to;
+    BatchHitCollector* _collector;
+};
+
+/**
+ * Tests a swept convex shape against the leaves of the broadphase its path overlaps.
+ */
+class BatchSweepTest : public btDbvt::ICollide, public btCollisionWorld::ConvexResultCallback
+{
+public:
+
+    BatchSweepTest(const btConvexShape* shape, const btTransform& from, const btTransform& to, int mask, const PhysicsCollisionObject* me,
+                   btScalar allowedPenetration, BatchHitCollector* collector)
+        : _shape(shape), _from(from), _to(to), _me(me), _allowedPenetration(allowedPenetration), _collector(collector)
+    {
+        m_collisionFilterMask = mask;
+    }
+
+    void Process(const btDbvtNode* leaf)
+    {
+        btBroadphaseProxy* proxy = reinterpret_cast<btBroadphaseProxy*>(leaf->data);
+        if ((proxy->m_collisionFilterGroup & m_collisionFilterMask) == 0)
+            return;
+        btCollisionObject* co = reinterpret_cast<btCollisionObject*>(proxy->m_clientObject);
+        if (co->getUserPointer() == NULL || co->getUserPointer() == _me)
+            return;
+        btCollisionWorld::objectQuerySingle(_shape, _from, _to, co, co->getCollisionShape(), co->getWorldTransform(), *this, _allowedPenetration);
+    }
+
+    btScalar addSingleResult(btCollisionWorld::LocalConvexResult& convexResult, bool normalInWorldSpace)
+    {
+        const btCollisionObject* co = convexResult.m_hitCollisionObject;
+        btVector3 normal = normalInWorldSpace ? convexResult.m_hitNormalLocal : co->getWorldTransform().getBasis() * convexResult.m_hitNormalLocal;
+        m_closestHitFraction = _collector->add(co, convexResult.m_hitPointLocal, normal, convexResult.m_hitFraction);
+        return m_closestHitFraction;
+    }
+
+private:
+
+    const btConvexShape* _shape;
+    btTransform _from;
+    btTransform _to;
+    const PhysicsCollisionObject* _me;
+    btScalar _allowedPenetration;
+    BatchHitCollector* _collector;
+};
+
+/**
+ * An axis sweep broadphase that gives access to the tree it keeps to accelerate ray tests,
+ * which the batched queries traverse.
+ */
+template <class T, class Index>
+class AxisSweepBroadphase : public T
+{
+public:
+
+    AxisSweepBroadphase(const btVector3& worldMin, const btVector3& worldMax, Index maxObjects)
+        : T(worldMin, worldMax, maxObjects)
+    {
+    }
+
+    btDbvtBroadphase* getRaycastAccelerator() const
+    {
+        return this->m_raycastAccelerator;
+    }
+};
+
+// Determines whether a Bullet object is a ghost object in a trigger mode.
+static bool isTrigger(const btCollisionObject* collisionObject)
+{
+    const PhysicsCollisionObject* object = reinterpret_cast<const PhysicsCollisionObject*>(collisionObject->getUserPointer());
+    return object && object->getType() == PhysicsCollisionObject::GHOST_OBJECT &&
+        static_cast<const PhysicsGhostObject*>(object)->getTriggerMode() != PhysicsGhostObject::CONTACTS;
+}
+
+/**
+ * A collision dispatcher that leaves the pairs of trigger ghost objects out of the narrowphase,
+ * since the objects they touch are found from their broadphase overlaps.
+ */
+template <class T>
+class TriggerDispatcher : public T
+{
+public:
+
+    TriggerDispatcher(btCollisionConfiguration* collisionConfiguration)
+        : T(collisionConfiguration)
+    {
+    }
+
+    bool needsCollision(const btCollisionObject* body0, const btCollisionObject* body1)
+    {
+        return !isTrigger(body0) && !isTrigger(body1) && T::needsCollision(body0, body1);
+    }
+};
+
+/**
+ * Runs a part of a batch of ray tests.
+ */
+class RayTestBatchRange : public JobController::Range
+{
+public:
+
+    RayTestBatchRange(btDbvtBroadphase* broadphase, const PhysicsController::RayQuery* queries, PhysicsController::HitResult* hits,
+                      unsigned int* hitCounts, unsigned int maxHits)
+        : _broadphase(broadphase), _queries(queries), _hits(hits), _hitCounts(hitCounts), _maxHits(maxHits)
+    {
+    }
+
+    void run(unsigned int begin, unsigned int end)
+    {
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            const PhysicsController::RayQuery& query = _queries[i];
+            btVector3 from(BV(query.ray.getOrigin()));
+            btVector3 to(from + BV(query.ray.getDirection() * query.distance));
+
+            BatchHitCollector collector(_hits + i * _maxHits, _maxHits);
+            BatchRayTest test(from, to, query.mask, &collector);
+            btDbvt::rayTest(_broadphase->m_sets[0].m_root, from, to, test);
+            btDbvt::rayTest(_broadphase->m_sets[1].m_root, from, to, test);
+            _hitCounts[i] = collector.finish();
+        }
+    }
+
+private:
+
+    btDbvtBroadphase* _broadphase;
+    const PhysicsController::RayQuery* _queries;
+    PhysicsController::HitResult* _hits;
+    unsigned int* _hitCounts;
+    unsigned int _maxHits;
+};
+
+/**
+ * Runs a part of a batch of sweep tests.
+ */
+class SweepTestBatchRange : public JobController::Range
+{
+public:
+
+    SweepTestBatchRange(btDbvtBroadphase* broadphase, const PhysicsController::SweepQuery* queries, PhysicsController::HitResult* hits,
+                        unsigned int* hitCounts, unsigned int maxHits, btScalar allowedPenetration)
+        : _broadphase(broadphase), _queries(queries), _hits(hits), _hitCounts(hitCounts), _maxHits(maxHits), _allowedPenetration(allowedPenetration)
+    {
+    }
+
+    void run(unsigned int begin, unsigned int end)
+    {
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            const PhysicsController::SweepQuery& query = _queries[i];
+            _hitCounts[i] = 0;
+            if (query.object == NULL || query.object->getCollisionShape() == NULL)
+                continue;
+            btCollisionShape* shape = query.object->getCollisionShape()->getShape();
+            if (shape == NULL || !shape->isConvex())
+                continue;
+
+            // The sweep starts at the world position and rotation of the object's node.
+            btTransform from;
+            from.setIdentity();
+            if (query.object->getNode())
             {
-                (*iter)->collisionEvent(PhysicsCollisionObject::CollisionListener::COLLIDING, pair, Vector3(cp.getPositionWorldOnA().x(), cp.getPositionWorldOnA().y(), cp.getPositionWorldOnA().z()),
-                    Vector3(cp.getPositionWorldOnB().x(), cp.getPositionWorldOnB().y(), cp.getPositionWorldOnB().z()));
+                Vector3 translation;
+                Quaternion rotation;
+                const Matrix& m = query.object->getNode()->getWorldMatrix();
+                m.getTranslation(&translation);
+                m.getRotation(&rotation);
+                from.setOrigin(BV(translation));
+                from.setRotation(BQ(rotation));
             }
+            btTransform to(from);
+            to.setOrigin(BV(query.endPosition));
+
+            // The leaves tested are those overlapping the bounds of the whole path of the shape.
+            btVector3 min, max, endMin, endMax;
+            shape->getAabb(from, min, max);
+            shape->getAabb(to, endMin, endMax);
+            min.setMin(endMin);
+            max.setMax(endMax);
+            btDbvtVolume bounds = btDbvtVolume::FromMM(min, max);
+
+            BatchHitCollector collector(_hits + i * _maxHits, _maxHits);
+            BatchSweepTest test(static_cast<btConvexShape*>(shape), from, to, query.mask, query.object, _allowedPenetration, &collector);
+            _broadphase->m_sets[0].collideTV(_broadphase->m_sets[0].m_root, bounds, test);
+            _broadphase->m_sets[1].collideTV(_broadphase->m_sets[1].m_root, bounds, test);
+            _hitCounts[i] = collector.finish();
+        }
+    }
+
+private:
+
+    btDbvtBroadphase* _broadphase;
+    const PhysicsController::SweepQuery* _queries;
+    PhysicsController::HitResult* _hits;
+    unsigned int* _hitCounts;
+    unsigned int _maxHits;
+    btScalar _allowedPenetration;
+};
+
+unsigned int PhysicsController::rayTestBatch(const RayQuery* queries, unsigned int queryCount, HitResult* hits, unsigned int* hitCounts, unsigned int maxHits)
+{
+    GP_ASSERT(_world);
+    GP_ASSERT(queries || queryCount == 0);
+    GP_ASSERT(hits && hitCounts && maxHits > 0);
+
+    // The broadphase is only read by the queries, each of which traverses it with its own stack.
+    RayTestBatchRange range(_queryBroadphase, queries, hits, hitCounts, maxHits);
+    JobController* jobController = Game::getInstance()->getJobController();
+    if (jobController)
+        jobController->parallelFor(queryCount, &range);
+    else
+        range.run(0, queryCount);
+
+    unsigned int hitCount = 0;
+    for (unsigned int i = 0; i < queryCount; ++i)
+    {
+        hitCount += hitCounts[i];
+    }
+    return hitCount;
+}
+
+unsigned int PhysicsController::sweepTestBatch(const SweepQuery* queries, unsigned int queryCount, HitResult* hits, unsigned int* hitCounts, unsigned int maxHits)
+{
+    GP_ASSERT(_world);
+    GP_ASSERT(queries || queryCount == 0);
+    GP_ASSERT(hits && hitCounts && maxHits > 0);
+
+    SweepTestBatchRange range(_queryBroadphase, queries, hits, hitCounts, maxHits,
+                              _world->getDispatchInfo().m_allowedCcdPenetration);
+    JobController* jobController = Game::getInstance()->getJobController();
+    if (jobController)
+        jobController->parallelFor(queryCount, &range);
+    else
+        range.run(0, queryCount);
+
+    unsigned int hitCount = 0;
+    for (unsigned int i = 0; i < queryCount; ++i)
+    {
+        hitCount += hitCounts[i];
+    }
+    return hitCount;
+}
+
+PhysicsController::RayQuery::RayQuery()
+    : distance(0.0f), mask(-1)
+{
+}
+
+PhysicsController::RayQuery::RayQuery(const Ray& ray, float distance, int mask)
+    : ray(ray), distance(distance), mask(mask)
+{
+}
+
+PhysicsController::SweepQuery::SweepQuery()
+    : object(NULL), mask(-1)
+{
+}
+
+PhysicsController::SweepQuery::SweepQuery(PhysicsCollisionObject* object, const Vector3& endPosition, int mask)
+    : object(object), endPosition(endPosition), mask(mask)
+{
+}
+
+PhysicsController::ContactEvent::ContactEvent(Type type, PhysicsCollisionObject* objectA, PhysicsCollisionObject* objectB, const Vector3& pointA, const Vector3& pointB)
+    : type(type), pair(objectA, objectB), pointA(pointA), pointB(pointB)
+{
+}
+
+const std::vector<PhysicsController::ContactEvent>& PhysicsController::getContactEvents() const
+{
+    return _contactEvents;
+}
+
+PhysicsController::ContactPairTable::ContactPairTable()
+    : _count(0)
+{
+}
+
+void PhysicsController::ContactPairTable::clear(unsigned int capacity)
+{
+    // Keep the table at most half full so that probe sequences stay short.
+    unsigned int size = 16;
+    while (size < capacity * 2)
+        size *= 2;
+
+    _slots.assign(size, ContactPair());
+    _count = 0;
+}
+
+static unsigned int hashContactPair(const PhysicsCollisionObject* objectA, const PhysicsCollisionObject* objectB)
+{
+    // The low bits of the addresses are the same for all the objects, since they are aligned.
+    size_t a = (size_t)objectA >> 4;
+    size_t b = (size_t)objectB >> 4;
+    return (unsigned int)((a * 2654435761u) ^ (b * 40503u + (b >> 16)));
+}
+
+PhysicsController::ContactPair* PhysicsController::ContactPairTable::insert(PhysicsCollisionObject* objectA, PhysicsCollisionObject* objectB, bool* inserted)
+{
+    GP_ASSERT(objectA && objectB);
+    GP_ASSERT(_count * 2 < _slots.size());
+
+    unsigned int mask = (unsigned int)_slots.size() - 1;
+    unsigned int i = hashContactPair(objectA, objectB) & mask;
+    while (_slots[i].objectA)
+    {
+        if (_slots[i].objectA == objectA && _slots[i].objectB == objectB)
+        {
+            *inserted = false;
+            return &_slots[i];
         }
+        i = (i + 1) & mask;
     }
 
-    // Update the collision status cache (we remove the dirty bit
-    // set in the controller's update so that this particular collision pair's
-    // status is not reset to 'no collision' when the controller's update completes).
-    collisionInfo->_status &= ~DIRTY;
-    collisionInfo->_status |= COLLISION;
-    return 0.0f;
+    _slots[i].objectA = objectA;
+    _slots[i].objectB = objectB;
+    ++_count;
+    *inserted = true;
+    return &_slots[i];
+}
+
+const PhysicsController::ContactPair* PhysicsController::ContactPairTable::find(PhysicsCollisionObject* objectA, PhysicsCollisionObject* objectB) const
+{
+    if (_count == 0)
+        return NULL;
+
+    unsigned int mask = (unsigned int)_slots.size() - 1;
+    unsigned int i = hashContactPair(objectA, objectB) & mask;
+    while (_slots[i].objectA)
+    {
+        if (_slots[i].objectA == objectA && _slots[i].objectB == objectB)
+            return &_slots[i];
+        i = (i + 1) & mask;
+    }
+    return NULL;
+}
+
+unsigned int PhysicsController::ContactPairTable::getCount() const
+{
+    return _count;
+}
+
+void PhysicsController::ContactPairTable::swap(ContactPairTable& table)
+{
+    _slots.swap(table._slots);
+    std::swap(_count, table._count);
 }
 
 void PhysicsController::initialize()
 {
+    btAlignedAllocSetCustom(bulletAllocate, bulletFree);
+
+    Game* game = Game::getInstance();
+    Properties* config = game->getConfig() ? game->getConfig()->getNamespace("physics", true) : NULL;
+    bool multithreaded = config && config->getBool("multithreaded");
+    if (config)
+    {
+        if (config->exists("stepRate") || config->exists("maxSubSteps"))
+        {
+            int maxSubSteps = config->exists("maxSubSteps") ? config->getInt("maxSubSteps") : (int)_maxSubSteps;
+            setStepRate(config->exists("stepRate") ? config->getFloat("stepRate") : _stepRate, (unsigned int)std::max(maxSubSteps, 1));
+        }
+        if (config->exists("interpolation"))
+            _interpolation = config->getBool("interpolation");
+
+        const char* broadphase = config->getString("broadphase");
+        if (broadphase)
+        {
+            if (strcmp(broadphase, "AXIS_SWEEP") == 0)
+                _broadphase = BROADPHASE_AXIS_SWEEP;
+            else if (strcmp(broadphase, "DBVT") != 0)
+                GP_WARN("Unknown physics broadphase '%s'; using DBVT.", broadphase);
+        }
+
+        if (config->exists("deactivationTime"))
+            setDeactivationTime(config->getFloat("deactivationTime"));
+        if (config->exists("sleeping"))
+            setSleepingEnabled(config->getBool("sleeping"));
+        if (config->exists("linearSleepingThreshold"))
+            _linearSleepingThreshold = config->getFloat("linearSleepingThreshold");
+        if (config->exists("angularSleepingThreshold"))
+            _angularSleepingThreshold = config->getFloat("angularSleepingThreshold");
+    }
+
     _collisionConfiguration = bullet_new<btDefaultCollisionConfiguration>();
-    _dispatcher = bullet_new<btCollisionDispatcher>(_collisionConfiguration);
-    _overlappingPairCache = bullet_new<btDbvtBroadphase>();
-    _solver = bullet_new<btSequentialImpulseConstraintSolver>();
+    if (_broadphase == BROADPHASE_AXIS_SWEEP)
+    {
+        Vector3 worldMin(-1000.0f, -1000.0f, -1000.0f);
+        Vector3 worldMax(1000.0f, 1000.0f, 1000.0f);
+        int maxObjects = 16384;
+        if (config)
+        {
+            if (config->exists("worldMin"))
+                config->getVector3("worldMin", &worldMin);
+            if (config->exists("worldMax"))
+                config->getVector3("worldMax", &worldMax);
+            if (config->exists("maxObjects"))
+                maxObjects = std::max(config->getInt("maxObjects"), 1);
+        }
+
+        // The 16 bit version of the broadphase takes less memory, but only holds up to 32766 objects.
+        if (maxObjects < 32767)
+        {
+            AxisSweepBroadphase<btAxisSweep3, unsigned short>* axisSweep =
+                bullet_new<AxisSweepBroadphase<btAxisSweep3, unsigned short> >(BV(worldMin), BV(worldMax), (unsigned short)maxObjects);
+            _queryBroadphase = axisSweep->getRaycastAccelerator();
+            _overlappingPairCache = axisSweep;
+        }
+        else
+        {
+            AxisSweepBroadphase<bt32BitAxisSweep3, unsigned int>* axisSweep =
+                bullet_new<AxisSweepBroadphase<bt32BitAxisSweep3, unsigned int> >(BV(worldMin), BV(worldMax), (unsigned int)maxObjects);
+            _queryBroadphase = axisSweep->getRaycastAccelerator();
+            _overlappingPairCache = axisSweep;
+        }
+    }
+    else
+    {
+        btDbvtBroadphase* dbvt = bullet_new<btDbvtBroadphase>();
+        _queryBroadphase = dbvt;
+        _overlappingPairCache = dbvt;
+    }
+
+#ifdef BT_THREADSAFE
+    if (multithreaded && game->getJobController() && game->getJobController()->getThreadCount() > 1)
+    {
+        _taskScheduler = new TaskScheduler(game->getJobController());
+        btSetTaskScheduler(_taskScheduler);
+
+        // Each thread solves islands with its own solver from the pool, and large islands are solved by the multithreaded solver.
+        _dispatcher = bullet_new<TriggerDispatcher<btCollisionDispatcherMt> >(_collisionConfiguration);
+        _solver = bullet_new<btConstraintSolverPoolMt>(_taskScheduler->getNumThreads());
+        _solverMt = bullet_new<btSequentialImpulseConstraintSolverMt>();
+        _world = bullet_new<btDiscreteDynamicsWorldMt>(_dispatcher, _overlappingPairCache, (btConstraintSolverPoolMt*)_solver, _solverMt, _collisionConfiguration);
+    }
+#else
+    if (multithreaded)
+    {
+        GP_WARN("Multithreaded physics requires Bullet to be built with BT_THREADSAFE; the world is simulated on the main thread.");
+    }
+#endif
 
     // Create the world.
-    _world = bullet_new<btDiscreteDynamicsWorld>(_dispatcher, _overlappingPairCache, _solver, _collisionConfiguration);
+    if (_world == NULL)
+    {
+        _dispatcher = bullet_new<TriggerDispatcher<btCollisionDispatcher> >(_collisionConfiguration);
+        _solver = bullet_new<btSequentialImpulseConstraintSolver>();
+        _world = bullet_new<btDiscreteDynamicsWorld>(_dispatcher, _overlappingPairCache, _solver, _collisionConfiguration);
+    }
     _world->setGravity(BV(_gravity));
+    _world->setInternalTickCallback(tickCallback, this);
+    if (config && config->exists("splitIslands"))
+        static_cast<btDiscreteDynamicsWorld*>(_world)->getSimulationIslandManager()->setSplitIslands(config->getBool("splitIslands"));
 
     // Register ghost pair callback so bullet detects collisions with ghost objects (used for character collisions).
     GP_ASSERT(_world->getPairCache());
@@ -454,10 +1201,19 @@ void PhysicsController::finalize()
     // Clean up the world and its various components.
     SAFE_DELETE(_world);
     SAFE_DELETE(_ghostPairCallback);
+    SAFE_DELETE(_solverMt);
     SAFE_DELETE(_solver);
     SAFE_DELETE(_overlappingPairCache);
+    _queryBroadphase = NULL;
     SAFE_DELETE(_dispatcher);
     SAFE_DELETE(_collisionConfiguration);
+#ifdef BT_THREADSAFE
+    if (_taskScheduler)
+    {
+        btSetTaskScheduler(NULL);
+        SAFE_DELETE(_taskScheduler);
+    }
+#endif
 }
 
 void PhysicsController::pause()
@@ -472,15 +1228,24 @@ void PhysicsController::resume()
 
 void PhysicsController::update(float elapsedTime)
 {
+    GP_PROFILE("PhysicsController::update");
     GP_ASSERT(_world);
     _isUpdating = true;
 
-    // Update the physics simulation, with a maximum
-    // of 10 simulation steps being performed in a given frame.
+    // Update the physics simulation in fixed steps, or in one step of the elapsed time when
+    // there is no step rate, which Bullet does when the maximum number of steps is 0.
     //
     // Note that stepSimulation takes elapsed time in seconds
     // so we divide by 1000 to convert from milliseconds.
-    _world->stepSimulation(elapsedTime * 0.001f, 10);
+    //
+    // The transforms of the bodies are written to their nodes once the step is done, in a
+    // single pass that notifies each node once.
+    PhysicsCollisionObject::PhysicsMotionState::deferSync();
+    if (_stepRate > 0.0f)
+        _world->stepSimulation(elapsedTime * 0.001f, (int)_maxSubSteps, 1.0f / _stepRate);
+    else
+        _world->stepSimulation(elapsedTime * 0.001f, 0);
+    PhysicsCollisionObject::PhysicsMotionState::syncNodes();
 
     // If we have status listeners, then check if our status has changed.
     if (_listeners || _callbacks["statusEvent"])
@@ -532,66 +1297,164 @@ void PhysicsController::update(float elapsedTime)
         }
     }
 
-    // All statuses are set with the DIRTY bit before collision processing occurs.
-    // During collision processing, if a collision occurs, the status is 
-    // set to COLLISION and the DIRTY bit is cleared. Then, after collision processing 
-    // is finished, if a given status is still dirty, the COLLISION bit is cleared.
-    //
-    // If an entry was marked for removal in the last frame, remove it now.
-
-    // Dirty the collision status cache entries.
-    std::map<PhysicsCollisionObject::CollisionPair, CollisionInfo>::iterator iter = _collisionStatus.begin();
-    for (; iter != _collisionStatus.end();)
+    // Remove the collision listeners that were marked for removal in the last frame.
+    CollisionListenerMap::iterator iter = _collisionListeners.begin();
+    while (iter != _collisionListeners.end())
     {
         if ((iter->second._status & REMOVE) != 0)
+            _collisionListeners.erase(iter++);
+        else
+            ++iter;
+    }
+
+    updateContacts();
+
+    _isUpdating = false;
+}
+
+void PhysicsController::updateContacts()
+{
+    GP_ASSERT(_dispatcher);
+
+    _contactEvents.clear();
+
+    // Collect the pairs that are touching from the contact manifolds the dispatcher kept while stepping
+    // the world. A manifold keeps its points until they move apart by more than the contact breaking
+    // threshold, so resting objects do not flicker between touching and not touching.
+    int manifoldCount = _dispatcher->getNumManifolds();
+    unsigned int overlapCount = 0;
+    for (size_t i = 0, count = _triggers.size(); i < count; ++i)
+        overlapCount += (unsigned int)_triggers[i]->_ghostObject->getNumOverlappingObjects();
+    _newContacts.clear(manifoldCount + overlapCount);
+    for (int i = 0; i < manifoldCount; ++i)
+    {
+        btPersistentManifold* manifold = _dispatcher->getManifoldByIndexInternal(i);
+        int pointCount = manifold->getNumContacts();
+        if (pointCount == 0)
+            continue;
+
+        PhysicsCollisionObject* objectA = getCollisionObject(manifold->getBody0());
+        PhysicsCollisionObject* objectB = getCollisionObject(manifold->getBody1());
+        if (objectA == NULL || objectB == NULL)
+            continue;
+
+        // Report the deepest point of the manifold.
+        int deepest = 0;
+        for (int j = 1; j < pointCount; ++j)
+        {
+            if (manifold->getContactPoint(j).getDistance() < manifold->getContactPoint(deepest).getDistance())
+                deepest = j;
+        }
+        const btManifoldPoint& point = manifold->getContactPoint(deepest);
+        const btVector3& pointA = point.getPositionWorldOnA();
+        const btVector3& pointB = point.getPositionWorldOnB();
+
+        // Store the pair with its objects in address order, so that it is found whichever way Bullet ordered them.
+        bool inserted;
+        ContactPair* contact;
+        if (objectA < objectB)
         {
-            std::map<PhysicsCollisionObject::CollisionPair, CollisionInfo>::iterator eraseIter = iter;
-            iter++;
-            _collisionStatus.erase(eraseIter);
+            contact = _newContacts.insert(objectA, objectB, &inserted);
+            contact->pointA.set(pointA.x(), pointA.y(), pointA.z());
+            contact->pointB.set(pointB.x(), pointB.y(), pointB.z());
         }
         else
         {
-            iter->second._status |= DIRTY;
-            iter++;
+            contact = _newContacts.insert(objectB, objectA, &inserted);
+            contact->pointA.set(pointB.x(), pointB.y(), pointB.z());
+            contact->pointB.set(pointA.x(), pointA.y(), pointA.z());
         }
     }
 
-    // Go through the collision status cache and perform all registered collision tests.
-    iter = _collisionStatus.begin();
-    for (; iter != _collisionStatus.end(); iter++)
+    // Trigger ghost objects touch the objects whose bounding boxes overlap theirs in the broadphase, which
+    // the ghost object keeps a list of, without contact points.
+    for (size_t i = 0, count = _triggers.size(); i < count; ++i)
     {
-        // If this collision pair was one that was registered for listening, then perform the collision test.
-        // (In the case where we register for all collisions with a rigid body, there will be a lot
-        // of collision pairs in the status cache that we did not explicitly register for.)
-        if ((iter->second._status & REGISTERED) != 0 && (iter->second._status & REMOVE) == 0)
+        PhysicsGhostObject* trigger = _triggers[i];
+        btPairCachingGhostObject* ghost = trigger->_ghostObject;
+        for (int j = 0, overlapping = ghost->getNumOverlappingObjects(); j < overlapping; ++j)
         {
-            if (iter->first.objectB)
-                _world->contactPairTest(iter->first.objectA->getCollisionObject(), iter->first.objectB->getCollisionObject(), *_collisionCallback);
-            else
-                _world->contactTest(iter->first.objectA->getCollisionObject(), *_collisionCallback);
+            PhysicsCollisionObject* other = getCollisionObject(ghost->getOverlappingObject(j));
+            if (other == NULL)
+                continue;
+
+            PhysicsCollisionObject* objectA = trigger < other ? (PhysicsCollisionObject*)trigger : other;
+            PhysicsCollisionObject* objectB = trigger < other ? other : (PhysicsCollisionObject*)trigger;
+
+            // An object only enters an exact trigger once their shapes touch, and then stays in it until their bounding boxes stop overlapping.
+            if (trigger->_triggerMode == PhysicsGhostObject::TRIGGER_EXACT_ENTER && _contacts.find(objectA, objectB) == NULL && !trigger->collidesWith(other))
+                continue;
+
+            bool inserted;
+            ContactPair* contact = _newContacts.insert(objectA, objectB, &inserted);
+            if (inserted)
+            {
+                contact->pointA = Vector3::zero();
+                contact->pointB = Vector3::zero();
+            }
         }
     }
 
-    // Update all the collision status cache entries.
-    iter = _collisionStatus.begin();
-    for ( ; iter != _collisionStatus.end(); iter++)
+    // Compare the touching pairs with those of the last update.
+    for (size_t i = 0, count = _newContacts._slots.size(); i < count; ++i)
     {
-        if ((iter->second._status & DIRTY) != 0)
+        const ContactPair& contact = _newContacts._slots[i];
+        if (contact.objectA)
         {
-            if ((iter->second._status & COLLISION) != 0 && iter->first.objectB)
-            {
-                size_t size = iter->second._listeners.size();
-                for (size_t i = 0; i < size; i++)
-                {
-                    iter->second._listeners[i]->collisionEvent(PhysicsCollisionObject::CollisionListener::NOT_COLLIDING, iter->first);
-                }
-            }
+            bool persist = _contacts.find(contact.objectA, contact.objectB) != NULL;
+            _contactEvents.push_back(ContactEvent(persist ? ContactEvent::PERSIST : ContactEvent::BEGIN,
+                contact.objectA, contact.objectB, contact.pointA, contact.pointB));
+        }
+    }
+    for (size_t i = 0, count = _contacts._slots.size(); i < count; ++i)
+    {
+        const ContactPair& contact = _contacts._slots[i];
+        if (contact.objectA && _newContacts.find(contact.objectA, contact.objectB) == NULL)
+        {
+            _contactEvents.push_back(ContactEvent(ContactEvent::END, contact.objectA, contact.objectB, Vector3::zero(), Vector3::zero()));
+        }
+    }
+    _contacts.swap(_newContacts);
 
-            iter->second._status &= ~COLLISION;
+    // Notify the collision listeners of the pairs that started or stopped touching.
+    if (!_collisionListeners.empty())
+    {
+        for (size_t i = 0, count = _contactEvents.size(); i < count; ++i)
+        {
+            const ContactEvent& event = _contactEvents[i];
+            if (event.type == ContactEvent::BEGIN)
+                notifyCollisionListeners(PhysicsCollisionObject::CollisionListener::COLLIDING, event.pair, event.pointA, event.pointB);
+            else if (event.type == ContactEvent::END)
+                notifyCollisionListeners(PhysicsCollisionObject::CollisionListener::NOT_COLLIDING, event.pair, event.pointA, event.pointB);
         }
     }
+}
 
-    _isUpdating = false;
+void PhysicsController::notifyCollisionListeners(PhysicsCollisionObject::CollisionListener::EventType type, const PhysicsCollisionObject::CollisionPair& pair,
+    const Vector3& pointA, const Vector3& pointB)
+{
+    // Each listener gets the pair with the object it registered for first. Listeners are looked up for each
+    // registration in turn, and by index, since a listener may add or remove listeners while it is notified.
+    for (int k = 0; k < 4; ++k)
+    {
+        PhysicsCollisionObject::CollisionPair eventPair = (k & 1) ? PhysicsCollisionObject::CollisionPair(pair.objectB, pair.objectA) : pair;
+        PhysicsCollisionObject::CollisionPair key(eventPair.objectA, k < 2 ? eventPair.objectB : NULL);
+        const Vector3& eventPointA = (k & 1) ? pointB : pointA;
+        const Vector3& eventPointB = (k & 1) ? pointA : pointB;
+
+        CollisionListenerMap::iterator iter = _collisionListeners.find(key);
+        if (iter == _collisionListeners.end())
+            continue;
+
+        for (size_t i = 0; i < iter->second._listeners.size(); ++i)
+        {
+            if ((iter->second._status & REMOVE) != 0)
+                break;
+
+            GP_ASSERT(iter->second._listeners[i]);
+            iter->second._listeners[i]->collisionEvent(type, eventPair, eventPointA, eventPointB);
+        }
+    }
 }
 
 void PhysicsController::addCollisionListener(PhysicsCollisionObject::CollisionListener* listener, PhysicsCollisionObject* objectA, PhysicsCollisionObject* objectB)
@@ -603,7 +1466,7 @@ void PhysicsController::addCollisionListener(PhysicsCollisionObject::CollisionLi
     PhysicsCollisionObject::CollisionPair pair(objectA, objectB);
 
     // Add the listener and ensure the status includes that this collision pair is registered.
-    CollisionInfo& info = _collisionStatus[pair];
+    CollisionInfo& info = _collisionListeners[pair];
     info._listeners.push_back(listener);
     info._status |= PhysicsController::REGISTERED;
 }
@@ -615,9 +1478,10 @@ void PhysicsController::removeCollisionListener(PhysicsCollisionObject::Collisio
     PhysicsCollisionObject::CollisionPair pair(objectA, objectB);
 
     // Mark the collision pair for these objects for removal.
-    if (_collisionStatus.count(pair) > 0)
+    CollisionListenerMap::iterator iter = _collisionListeners.find(pair);
+    if (iter != _collisionListeners.end())
     {
-        _collisionStatus[pair]._status |= REMOVE;
+        iter->second._status |= REMOVE;
     }
 }
 
@@ -677,18 +1541,118 @@ void PhysicsController::removeCollisionObject(PhysicsCollisionObject* object, bo
         }
     }
 
-    // Find all references to the object in the collision status cache and mark them for removal.
+    // Find all references to the object in the collision listeners and contacts and remove them, since the object
+    // is being destroyed. An object that is only disabled stays in the contacts, so that its listeners are told
+    // that it stopped touching the objects it touched on the next update.
     if (removeListeners)
     {
-        std::map<PhysicsCollisionObject::CollisionPair, CollisionInfo>::iterator iter = _collisionStatus.begin();
-        for (; iter != _collisionStatus.end(); iter++)
+        CollisionListenerMap::iterator iter = _collisionListeners.begin();
+        for (; iter != _collisionListeners.end(); iter++)
         {
             if (iter->first.objectA == object || iter->first.objectB == object)
                 iter->second._status |= REMOVE;
         }
+
+        _newContacts.clear(_contacts.getCount());
+        for (size_t i = 0, count = _contacts._slots.size(); i < count; ++i)
+        {
+            const ContactPair& contact = _contacts._slots[i];
+            if (contact.objectA && contact.objectA != object && contact.objectB != object)
+            {
+                bool inserted;
+                *_newContacts.insert(contact.objectA, contact.objectB, &inserted) = contact;
+            }
+        }
+        _contacts.swap(_newContacts);
+
+        for (size_t i = 0; i < _contactEvents.size();)
+        {
+            if (_contactEvents[i].pair.objectA == object || _contactEvents[i].pair.objectB == object)
+                _contactEvents.erase(_contactEvents.begin() + i);
+            else
+                ++i;
+        }
     }
 }
 
+void PhysicsController::addTrigger(PhysicsGhostObject* ghost)
+{
+    GP_ASSERT(ghost && ghost->_ghostObject);
+    GP_ASSERT(_world);
+
+    _triggers.push_back(ghost);
+
+    // Remove the collision algorithms of the pairs of the ghost object, with the contacts they generated.
+    btBroadphaseProxy* proxy = ghost->_ghostObject->getBroadphaseHandle();
+    if (proxy)
+        _world->getPairCache()->cleanProxyFromPairs(proxy, _dispatcher);
+}
+
+void PhysicsController::removeTrigger(PhysicsGhostObject* ghost)
+{
+    std::vector<PhysicsGhostObject*>::iterator itr = std::find(_triggers.begin(), _triggers.end(), ghost);
+    if (itr != _triggers.end())
+        _triggers.erase(itr);
+}
+
+void PhysicsController::addVehicle(PhysicsVehicle* vehicle)
+{
+    GP_ASSERT(vehicle);
+    if (std::find(_vehicles.begin(), _vehicles.end(), vehicle) == _vehicles.end())
+        _vehicles.push_back(vehicle);
+}
+
+void PhysicsController::removeVehicle(PhysicsVehicle* vehicle)
+{
+    std::vector<PhysicsVehicle*>::iterator itr = std::find(_vehicles.begin(), _vehicles.end(), vehicle);
+    if (itr != _vehicles.end())
+        _vehicles.erase(itr);
+}
+
+void PhysicsController::tickCallback(btDynamicsWorld* world, btScalar timeStep)
+{
+    GP_ASSERT(world);
+    PhysicsController* controller = reinterpret_cast<PhysicsController*>(world->getWorldUserInfo());
+    GP_ASSERT(controller);
+    controller->updateVehicles(timeStep);
+}
+
+void PhysicsController::updateVehicles(float timeStep)
+{
+    if (_vehicles.empty())
+        return;
+
+    // Vehicles are updated where Bullet updates its actions, at the end of each step, but
+    // the rays of all their wheels are cast together in one parallel batch, instead of
+    // one after the other into the world.
+    _vehicleRays.clear();
+    for (size_t i = 0, count = _vehicles.size(); i < count; ++i)
+    {
+        if (_vehicles[i]->getRigidBody()->isEnabled())
+            _vehicles[i]->getRays(_vehicleRays);
+    }
+    const unsigned int rayCount = (unsigned int)_vehicleRays.size();
+    if (rayCount > 0)
+    {
+        _vehicleHits.resize(rayCount * VEHICLE_RAY_HITS);
+        _vehicleHitCounts.resize(rayCount);
+        rayTestBatch(&_vehicleRays[0], rayCount, &_vehicleHits[0], &_vehicleHitCounts[0], VEHICLE_RAY_HITS);
+    }
+
+    // The rays of each vehicle follow those of the vehicles before it.
+    unsigned int ray = 0;
+    for (size_t i = 0, count = _vehicles.size(); i < count; ++i)
+    {
+        PhysicsVehicle* vehicle = _vehicles[i];
+        if (!vehicle->getRigidBody()->isEnabled())
+            continue;
+        const unsigned int* hitCounts = rayCount > 0 ? &_vehicleHitCounts[0] + ray : NULL;
+        const HitResult* hits = rayCount > 0 ? &_vehicleHits[0] + ray * VEHICLE_RAY_HITS : NULL;
+        ray += vehicle->step(timeStep, hits, hitCounts, VEHICLE_RAY_HITS);
+    }
+    GP_ASSERT(ray == rayCount);
+}
+
 PhysicsCollisionObject* PhysicsController::getCollisionObject(const btCollisionObject* collisionObject) const
 {
     // Gameplay collision objects are stored in the userPointer data of Bullet collision objects.
@@ -763,6 +1727,7 @@ static void computeCenterOfMass(const Vector3& center, const Vector3& scale, Vec
 PhysicsCollisionShape* PhysicsController::createShape(Node* node, const PhysicsCollisionShape::Definition& shape, Vector3* centerOfMassOffset)
 {
     GP_ASSERT(node);
+    GP_PROFILE("PhysicsController::createShape");
 
     PhysicsCollisionShape* collisionShape = NULL;
 
@@ -868,8 +1833,13 @@ PhysicsCollisionShape* PhysicsController::createShape(Node* node, const PhysicsC
         {
             if (shape.isExplicit)
             {
-                // Build heightfield rigid body from the passed in shape.
-                collisionShape = createHeightfield(node, shape.data.heightfield, centerOfMassOffset);
+                // Build heightfield rigid body from the passed in shape. When it was loaded from the same heights as
+                // the node's terrain, use the terrain's heightfield so that the heights are only kept once.
+                HeightField* heightfield = shape.data.heightfield;
+                Terrain* terrain = node->getTerrain();
+                if (terrain && isSameHeightField(heightfield, terrain->_heightfield))
+                    heightfield = terrain->_heightfield;
+                collisionShape = createHeightfield(node, heightfield, centerOfMassOffset);
             }
             else
             {
@@ -996,12 +1966,52 @@ PhysicsCollisionShape* PhysicsController::createCapsule(float radius, float heig
     return shape;
 }
 
+bool PhysicsController::isSameHeightField(HeightField* a, HeightField* b)
+{
+    GP_ASSERT(a && b);
+    if (a == b)
+        return true;
+    if (a->getColumnCount() != b->getColumnCount() || a->getRowCount() != b->getRowCount())
+        return false;
+    return memcmp(a->getArray(), b->getArray(), sizeof(float) * a->getColumnCount() * a->getRowCount()) == 0;
+}
+
 PhysicsCollisionShape* PhysicsController::createHeightfield(Node* node, HeightField* heightfield, Vector3* centerOfMassOffset)
 {
     GP_ASSERT(node);
     GP_ASSERT(heightfield);
     GP_ASSERT(centerOfMassOffset);
 
+    // Compute initial heightfield scale by pulling the current world scale out of the node
+    Vector3 scale;
+    node->getWorldMatrix().getScale(&scale);
+
+    // If the node has a terrain, apply the terrain's local scale to the world scale
+    if (node->getTerrain())
+    {
+        Vector3& tScale = node->getTerrain()->_localScale;
+        scale.set(scale.x * tScale.x, scale.y * tScale.y, scale.z * tScale.z);
+    }
+
+    PhysicsCollisionShape* shape;
+
+    // Return the heightfield shape from the cache if it already exists.
+    for (unsigned int i = 0; i < _shapes.size(); ++i)
+    {
+        shape = _shapes[i];
+        GP_ASSERT(shape);
+        if (shape->getType() == PhysicsCollisionShape::SHAPE_HEIGHTFIELD)
+        {
+            PhysicsCollisionShape::HeightfieldData* data = shape->_shapeData.heightfieldData;
+            if (data && data->heightfield == heightfield && data->scale == scale)
+            {
+                centerOfMassOffset->set(0, -(data->minHeight + (data->maxHeight - data->minHeight)*0.5f) * scale.y, 0);
+                shape->addRef();
+                return shape;
+            }
+        }
+    }
+
     // Inspect the height array for the min and max values
     float* heights = heightfield->getArray();
     float minHeight = FLT_MAX, maxHeight = -FLT_MAX;
@@ -1014,17 +2024,6 @@ PhysicsCollisionShape* PhysicsController::createHeightfield(Node* node, HeightFi
             maxHeight = h;
     }
 
-    // Compute initial heightfield scale by pulling the current world scale out of the node
-    Vector3 scale;
-    node->getWorldMatrix().getScale(&scale);
-
-    // If the node has a terrain, apply the terrain's local scale to the world scale
-    if (node->getTerrain())
-    {
-        Vector3& tScale = node->getTerrain()->_localScale;
-        scale.set(scale.x * tScale.x, scale.y * tScale.y, scale.z * tScale.z);
-    }
-
     // Compute initial center of mass offset necessary to move the height from its position in bullet
     // physics (always centered around origin) to its intended location.
     centerOfMassOffset->set(0, -(minHeight + (maxHeight-minHeight)*0.5f) * scale.y, 0);
@@ -1033,11 +2032,11 @@ PhysicsCollisionShape* PhysicsController::createHeightfield(Node* node, HeightFi
     PhysicsCollisionShape::HeightfieldData* heightfieldData = new PhysicsCollisionShape::HeightfieldData();
     heightfieldData->heightfield = heightfield;
     heightfieldData->heightfield->addRef();
-    heightfieldData->inverseIsDirty = true;
     heightfieldData->minHeight = minHeight;
     heightfieldData->maxHeight = maxHeight;
+    heightfieldData->scale = scale;
 
-    // Create the bullet terrain shape
+    // Create the bullet terrain shape, which reads the heights from the heightfield rather than copying them.
     btHeightfieldTerrainShape* terrainShape = bullet_new<btHeightfieldTerrainShape>(
         heightfield->getColumnCount(), heightfield->getRowCount(), heightfield->getArray(), 1.0f, minHeight, maxHeight, 1, PHY_FLOAT, false);
 
@@ -1045,7 +2044,7 @@ PhysicsCollisionShape* PhysicsController::createHeightfield(Node* node, HeightFi
     terrainShape->setLocalScaling(BV(scale));
 
     // Create our collision shape object and store heightfieldData in it.
-    PhysicsCollisionShape* shape = new PhysicsCollisionShape(PhysicsCollisionShape::SHAPE_HEIGHTFIELD, terrainShape);
+    shape = new PhysicsCollisionShape(PhysicsCollisionShape::SHAPE_HEIGHTFIELD, terrainShape);
     shape->_shapeData.heightfieldData = heightfieldData;
 
     _shapes.push_back(shape);
@@ -1081,55 +2080,110 @@ PhysicsCollisionShape* PhysicsController::createMesh(Mesh* mesh, const Vector3&
         return NULL;
     }
 
-    // The mesh must have a valid URL (i.e. it must have been loaded from a Bundle)
-    // in order to fetch mesh data for computing mesh rigid body.
-    if (strlen(mesh->getUrl()) == 0)
+    // The positions and indices are taken from the copy kept by the mesh (see Mesh::setDataResidency),
+    // or otherwise read again from the bundle the mesh was loaded from, which requires a valid URL.
+    const float* positions = mesh->getPositionData();
+    if (positions == NULL)
     {
-        GP_ERROR("Cannot create mesh rigid body for mesh without valid URL.");
-        return NULL;
+        if (mesh->getDataResidency() == Mesh::DATA_DISCARD)
+        {
+            GP_ERROR("Cannot create mesh rigid body for mesh whose data was discarded.");
+            return NULL;
+        }
+        if (strlen(mesh->getUrl()) == 0)
+        {
+            GP_ERROR("Cannot create mesh rigid body for mesh without valid URL.");
+            return NULL;
+        }
     }
 
-    Bundle::MeshData* data = Bundle::readMeshData(mesh->getUrl());
-    if (data == NULL)
+    PhysicsCollisionShape* shape;
+
+    // Return the mesh shape from the cache if it already exists, which also saves reading the mesh data again.
+    // Meshes without a URL are not cached, since nothing identifies them.
+    for (unsigned int i = 0; i < _shapes.size() && strlen(mesh->getUrl()) > 0; ++i)
     {
-        GP_ERROR("Failed to load mesh data from url '%s'.", mesh->getUrl());
-        return NULL;
+        shape = _shapes[i];
+        GP_ASSERT(shape);
+        if (shape->getType() == PhysicsCollisionShape::SHAPE_MESH)
+        {
+            PhysicsCollisionShape::MeshData* meshData = shape->_shapeData.meshData;
+            if (meshData && meshData->scale == scale && meshData->url == mesh->getUrl())
+            {
+                shape->addRef();
+                return shape;
+            }
+        }
+    }
+
+    Bundle::MeshData* data = NULL;
+    const unsigned char* vertexData;
+    unsigned int vertexCount;
+    unsigned int vertexStride;
+    size_t partCount;
+    if (positions)
+    {
+        vertexData = (const unsigned char*)positions;
+        vertexCount = mesh->getVertexCount();
+        vertexStride = sizeof(float) * 3;
+        partCount = mesh->getPartCount();
+    }
+    else
+    {
+        data = Bundle::readMeshData(mesh->getUrl());
+        if (data == NULL)
+        {
+            GP_ERROR("Failed to load mesh data from url '%s'.", mesh->getUrl());
+            return NULL;
+        }
+        vertexData = data->vertexData;
+        vertexCount = data->vertexCount;
+        vertexStride = data->vertexFormat.getVertexSize();
+        partCount = data->parts.size();
     }
 
     // Create mesh data to be populated and store in returned collision shape.
     PhysicsCollisionShape::MeshData* shapeMeshData = new PhysicsCollisionShape::MeshData();
     shapeMeshData->vertexData = NULL;
+    shapeMeshData->url = mesh->getUrl();
+    shapeMeshData->scale = scale;
 
     // Copy the scaled vertex position data to the rigid body's local buffer.
     Matrix m;
     Matrix::createScale(scale, &m);
-    unsigned int vertexCount = data->vertexCount;
     shapeMeshData->vertexData = new float[vertexCount * 3];
     Vector3 v;
-    int vertexStride = data->vertexFormat.getVertexSize();
-    for (unsigned int i = 0; i < data->vertexCount; i++)
+    for (unsigned int i = 0; i < vertexCount; i++)
     {
-        v.set(*((float*)&data->vertexData[i * vertexStride + 0 * sizeof(float)]),
-              *((float*)&data->vertexData[i * vertexStride + 1 * sizeof(float)]),
-              *((float*)&data->vertexData[i * vertexStride + 2 * sizeof(float)]));
+        v.set(*((const float*)&vertexData[i * vertexStride + 0 * sizeof(float)]),
+              *((const float*)&vertexData[i * vertexStride + 1 * sizeof(float)]),
+              *((const float*)&vertexData[i * vertexStride + 2 * sizeof(float)]));
         v *= m;
         memcpy(&(shapeMeshData->vertexData[i * 3]), &v, sizeof(float) * 3);
     }
 
     btTriangleIndexVertexArray* meshInterface = bullet_new<btTriangleIndexVertexArray>();
 
-    size_t partCount = data->parts.size();
     if (partCount > 0)
     {
         PHY_ScalarType indexType = PHY_UCHAR;
         int indexStride = 0;
-        Bundle::MeshPartData* meshPart = NULL;
         for (size_t i = 0; i < partCount; i++)
         {
-            meshPart = data->parts[i];
-            GP_ASSERT(meshPart);
+            Mesh::IndexFormat indexFormat;
+            unsigned int indexCount;
+            if (data)
+            {
+                indexFormat = data->parts[i]->indexFormat;
+                indexCount = data->parts[i]->indexCount;
+            }
+            else
+            {
+                indexFormat = mesh->getPart(i)->getIndexFormat();
+                indexCount = mesh->getPart(i)->getIndexCount();
+            }
 
-            switch (meshPart->indexFormat)
+            switch (indexFormat)
             {
             case Mesh::INDEX8:
                 indexType = PHY_UCHAR;
@@ -1144,24 +2198,46 @@ PhysicsCollisionShape* PhysicsController::createMesh(Mesh* mesh, const Vector3&
                 indexStride = 4;
                 break;
             default:
-                GP_ERROR("Unsupported index format (%d).", meshPart->indexFormat);
+                GP_ERROR("Unsupported index format (%d).", indexFormat);
+                indexStride = 0;
+                break;
+            }
+
+            unsigned char* indexData = NULL;
+            if (indexStride > 0 && data)
+            {
+                // Move the index data into the rigid body's local buffer.
+                // Set it to NULL in the MeshPartData so it is not released when the data is freed.
+                indexData = data->parts[i]->indexData;
+                data->parts[i]->indexData = NULL;
+            }
+            else if (indexStride > 0 && mesh->getPart(i)->getIndexData())
+            {
+                // Copy the indices kept by the mesh part.
+                indexData = new unsigned char[indexCount * indexStride];
+                memcpy(indexData, mesh->getPart(i)->getIndexData(), indexCount * indexStride);
+            }
+            if (indexData == NULL)
+            {
+                if (indexStride > 0)
+                    GP_ERROR("Failed to get the indices of part %d of mesh '%s'.", (int)i, mesh->getUrl());
+                for (size_t j = 0; j < shapeMeshData->indexData.size(); ++j)
+                {
+                    SAFE_DELETE_ARRAY(shapeMeshData->indexData[j]);
+                }
                 SAFE_DELETE(meshInterface);
                 SAFE_DELETE_ARRAY(shapeMeshData->vertexData);
                 SAFE_DELETE(shapeMeshData);
                 SAFE_DELETE(data);
                 return NULL;
             }
-
-            // Move the index data into the rigid body's local buffer.
-            // Set it to NULL in the MeshPartData so it is not released when the data is freed.
-            shapeMeshData->indexData.push_back(meshPart->indexData);
-            meshPart->indexData = NULL;
+            shapeMeshData->indexData.push_back(indexData);
 
             // Create a btIndexedMesh object for the current mesh part.
             btIndexedMesh indexedMesh;
             indexedMesh.m_indexType = indexType;
-            indexedMesh.m_numTriangles = meshPart->indexCount / 3; // assume TRIANGLES primitive type
-            indexedMesh.m_numVertices = meshPart->indexCount;
+            indexedMesh.m_numTriangles = indexCount / 3; // assume TRIANGLES primitive type
+            indexedMesh.m_numVertices = indexCount;
             indexedMesh.m_triangleIndexBase = (const unsigned char*)shapeMeshData->indexData[i];
             indexedMesh.m_triangleIndexStride = indexStride*3;
             indexedMesh.m_vertexBase = (const unsigned char*)shapeMeshData->vertexData;
@@ -1175,8 +2251,8 @@ PhysicsCollisionShape* PhysicsController::createMesh(Mesh* mesh, const Vector3&
     else
     {
         // Generate index data for the mesh locally in the rigid body.
-        unsigned int* indexData = new unsigned int[data->vertexCount];
-        for (unsigned int i = 0; i < data->vertexCount; i++)
+        unsigned int* indexData = new unsigned int[vertexCount];
+        for (unsigned int i = 0; i < vertexCount; i++)
         {
             indexData[i] = i;
         }
@@ -1185,8 +2261,8 @@ PhysicsCollisionShape* PhysicsController::createMesh(Mesh* mesh, const Vector3&
         // Create a single btIndexedMesh object for the mesh interface.
         btIndexedMesh indexedMesh;
         indexedMesh.m_indexType = PHY_INTEGER;
-        indexedMesh.m_numTriangles = data->vertexCount / 3; // assume TRIANGLES primitive type
-        indexedMesh.m_numVertices = data->vertexCount;
+        indexedMesh.m_numTriangles = vertexCount / 3; // assume TRIANGLES primitive type
+        indexedMesh.m_numVertices = vertexCount;
         indexedMesh.m_triangleIndexBase = shapeMeshData->indexData[0];
         indexedMesh.m_triangleIndexStride = sizeof(unsigned int);
         indexedMesh.m_vertexBase = (const unsigned char*)shapeMeshData->vertexData;
@@ -1198,8 +2274,7 @@ PhysicsCollisionShape* PhysicsController::createMesh(Mesh* mesh, const Vector3&
     }
 
     // Create our collision shape object and store shapeMeshData in it.
-    PhysicsCollisionShape* shape =
-        new PhysicsCollisionShape(PhysicsCollisionShape::SHAPE_MESH, bullet_new<btBvhTriangleMeshShape>(meshInterface, true), meshInterface);
+    shape = new PhysicsCollisionShape(PhysicsCollisionShape::SHAPE_MESH, bullet_new<btBvhTriangleMeshShape>(meshInterface, true), meshInterface);
     shape->_shapeData.meshData = shapeMeshData;
 
     _shapes.push_back(shape);
@@ -10,6 +10,8 @@
 #include "PhysicsCollisionObject.h"
 #include "MeshBatch.h"
 #include "HeightField.h"
+#include "MemoryPool.h"
+#include "Ray.h"
 #include "ScriptTarget.h"
 
 namespace gameplay
@@ -19,6 +21,29 @@ class ScriptListener;
 
 /**
  * Defines a class for controlling game physics.
+ *
+ * The physics world can be simulated on the threads of the job controller by setting
+ * 'multithreaded = true' in the physics namespace of the game config. Collision detection
+ * and the constraint solving of separate islands of objects are then spread over the
+ * threads. This requires Bullet to be built with BT_THREADSAFE; otherwise the option is
+ * ignored with a warning.
+ *
+ * The physics namespace of the game config also selects the broadphase and tunes sleeping:
+ *
+ * - 'broadphase' is DBVT (the default) or AXIS_SWEEP. The axis sweep broadphase needs the
+ *   bounds of the world, given by 'worldMin' and 'worldMax' (-1000 to 1000 by default),
+ *   and 'maxObjects' (16384 by default).
+ * - 'deactivationTime' is the number of seconds a rigid body must stay below its sleeping
+ *   thresholds before it falls asleep (2 by default), and 'sleeping = false' keeps all the
+ *   rigid bodies awake.
+ * - 'linearSleepingThreshold' and 'angularSleepingThreshold' are the default sleeping
+ *   thresholds of rigid bodies (0.8 and 1.0 by default), which rigid bodies can override in
+ *   their .physics definitions.
+ * - 'splitIslands = false' solves all the constraints of the world together, rather than
+ *   each island of touching objects on its own.
+ *
+ * getStats() returns the counts of active objects, islands and broadphase pairs to tune
+ * these with.
  */
 class PhysicsController : public ScriptTarget
 {
@@ -32,6 +57,62 @@ class PhysicsController : public ScriptTarget
 
 public:
 
+    /**
+     * The broadphases that find the pairs of objects whose bounds overlap.
+     */
+    enum Broadphase
+    {
+        /**
+         * A dynamic tree of bounding boxes, which suits worlds of any size and objects that move a lot.
+         */
+        BROADPHASE_DBVT,
+
+        /**
+         * Sweep and prune along the three axes within fixed world bounds, which suits large worlds of
+         * mostly static objects.
+         */
+        BROADPHASE_AXIS_SWEEP
+    };
+
+    /**
+     * Defines the statistics of the physics world.
+     *
+     * @script{ignore}
+     */
+    struct Stats
+    {
+        /**
+         * Constructor.
+         */
+        Stats();
+
+        /**
+         * The number of collision objects in the world.
+         */
+        unsigned int objectCount;
+
+        /**
+         * The number of objects that are neither static nor asleep.
+         */
+        unsigned int activeObjectCount;
+
+        /**
+         * The number of simulation islands, the groups of touching or constrained objects that
+         * fall asleep and wake up together.
+         */
+        unsigned int islandCount;
+
+        /**
+         * The number of pairs of objects whose bounds overlap in the broadphase.
+         */
+        unsigned int broadphasePairCount;
+
+        /**
+         * The number of pairs of objects that have contact points.
+         */
+        unsigned int contactManifoldCount;
+    };
+
     /**
      * Status listener interface.
      */
@@ -142,6 +223,80 @@ public:
         virtual bool hit(const HitResult& result);
     };
 
+    /**
+     * Defines a ray test run by rayTestBatch().
+     *
+     * @script{ignore}
+     */
+    struct RayQuery
+    {
+        /**
+         * Constructor.
+         */
+        RayQuery();
+
+        /**
+         * Constructor.
+         *
+         * @param ray The ray to test.
+         * @param distance How far along the ray to test for intersections.
+         * @param mask The collision groups of the objects to test, or -1 for all of them.
+         */
+        RayQuery(const Ray& ray, float distance, int mask = -1);
+
+        /**
+         * The ray to test.
+         */
+        Ray ray;
+
+        /**
+         * How far along the ray to test for intersections.
+         */
+        float distance;
+
+        /**
+         * The collision groups of the objects to test, matched against the filter group of each object.
+         */
+        int mask;
+    };
+
+    /**
+     * Defines a sweep test run by sweepTestBatch().
+     *
+     * @script{ignore}
+     */
+    struct SweepQuery
+    {
+        /**
+         * Constructor.
+         */
+        SweepQuery();
+
+        /**
+         * Constructor.
+         *
+         * @param object The collision object whose shape is swept from the world position of its node.
+         * @param endPosition The end position of the sweep, in world space.
+         * @param mask The collision groups of the objects to test, or -1 for all of them.
+         */
+        SweepQuery(PhysicsCollisionObject* object, const Vector3& endPosition, int mask = -1);
+
+        /**
+         * The collision object whose shape is swept, which must be convex. It is never hit by its own sweep.
+         */
+        PhysicsCollisionObject* object;
+
+        /**
+         * The end position of the sweep, in world space.
+         */
+        Vector3 endPosition;
+
+        /**
+         * The collision groups of the objects to test, matched against the filter group of each object.
+         */
+        int mask;
+    };
+
     /**
      * Adds a listener to the physics controller.
      * 
@@ -287,6 +442,133 @@ public:
      */
     void setGravity(const Vector3& gravity);
 
+    /**
+     * Determines whether the physics world is simulated on the threads of the job controller.
+     *
+     * @return True if the world is multithreaded, false otherwise.
+     */
+    bool isMultithreaded() const;
+
+    /**
+     * Sets the rate of the fixed steps the physics world is simulated with.
+     *
+     * The elapsed time given to the controller each update is accumulated, and the world is
+     * stepped once for each whole step of the accumulated time, up to maxSubSteps times per
+     * update; the rest is dropped, which slows the simulation down rather than falling further
+     * behind. Lowering the rate lowers the cost of physics, and interpolation (see
+     * setInterpolationEnabled) hides the steps.
+     *
+     * The rate can also be set with 'stepRate' and 'maxSubSteps' in the physics namespace of
+     * the game config. The default is 60 steps per second and 10 steps per update.
+     *
+     * @param rate The number of steps per second, or 0 to step the world once per update with
+     *      the elapsed time of the update.
+     * @param maxSubSteps The largest number of steps run in an update.
+     */
+    void setStepRate(float rate, unsigned int maxSubSteps = 10);
+
+    /**
+     * Returns the rate of the fixed steps the physics world is simulated with.
+     *
+     * @return The number of steps per second, or 0 if the world is stepped once per update.
+     */
+    float getStepRate() const;
+
+    /**
+     * Returns the largest number of fixed steps run in an update.
+     *
+     * @return The largest number of steps.
+     */
+    unsigned int getMaxSubSteps() const;
+
+    /**
+     * Sets whether the transforms of the nodes of rigid bodies are interpolated between steps.
+     *
+     * When enabled, which is the default, each update sets the nodes of moving rigid bodies to
+     * the transforms of their bodies advanced by the time accumulated since the last fixed step,
+     * so that they move smoothly even when the world is stepped less often than frames are drawn.
+     * When disabled, the nodes are set to the transforms of the last step. This can also be set
+     * with 'interpolation' in the physics namespace of the game config.
+     *
+     * @param enabled True to interpolate the transforms of nodes, false otherwise.
+     */
+    void setInterpolationEnabled(bool enabled);
+
+    /**
+     * Determines whether the transforms of the nodes of rigid bodies are interpolated between steps.
+     *
+     * @return True if the transforms are interpolated, false otherwise.
+     */
+    bool isInterpolationEnabled() const;
+
+    /**
+     * Returns the broadphase of the world, set with 'broadphase' in the physics namespace of the game config.
+     *
+     * @return The broadphase.
+     */
+    Broadphase getBroadphase() const;
+
+    /**
+     * Sets the sleeping thresholds given to the rigid bodies created afterwards that do not set their own.
+     *
+     * @param linear The linear velocity below which a rigid body can fall asleep.
+     * @param angular The angular velocity below which a rigid body can fall asleep.
+     */
+    void setSleepingThresholds(float linear, float angular);
+
+    /**
+     * Returns the default linear sleeping threshold of rigid bodies.
+     *
+     * @return The linear velocity below which a rigid body can fall asleep.
+     */
+    float getLinearSleepingThreshold() const;
+
+    /**
+     * Returns the default angular sleeping threshold of rigid bodies.
+     *
+     * @return The angular velocity below which a rigid body can fall asleep.
+     */
+    float getAngularSleepingThreshold() const;
+
+    /**
+     * Sets how long rigid bodies must stay below their sleeping thresholds before they fall asleep.
+     *
+     * @param seconds The time in seconds.
+     */
+    void setDeactivationTime(float seconds);
+
+    /**
+     * Returns how long rigid bodies must stay below their sleeping thresholds before they fall asleep.
+     *
+     * @return The time in seconds.
+     */
+    float getDeactivationTime() const;
+
+    /**
+     * Sets whether rigid bodies can fall asleep. Bodies that are asleep are not simulated
+     * until something wakes them up.
+     *
+     * @param enabled True to let rigid bodies fall asleep, false to keep them all awake.
+     */
+    void setSleepingEnabled(bool enabled);
+
+    /**
+     * Determines whether rigid bodies can fall asleep.
+     *
+     * @return True if rigid bodies can fall asleep, false otherwise.
+     */
+    bool isSleepingEnabled() const;
+
+    /**
+     * Returns the statistics of the physics world.
+     *
+     * The statistics are counted when this is called, with a pass over the objects of the world.
+     *
+     * @return The statistics.
+     * @script{ignore}
+     */
+    Stats getStats() const;
+
     /**
      * Draws debugging information (rigid body outlines, etc.) using the given view projection matrix.
      * 
@@ -327,38 +609,127 @@ public:
      */
     bool sweepTest(PhysicsCollisionObject* object, const Vector3& endPosition, PhysicsController::HitResult* result = NULL, PhysicsController::HitFilter* filter = NULL);
 
-private:
+    /**
+     * Performs a batch of ray tests on the physics world, in parallel on the threads of the job controller.
+     *
+     * Each query traverses the broadphase on its own, so the queries are independent of each other.
+     * The hits of query i are written to hits[i * maxHits], ordered from the closest, and their number
+     * to hitCounts[i]. With maxHits set to 1, only the closest hit of each query is returned; with
+     * a larger value, all the objects hit are returned, keeping the closest ones when there are more.
+     *
+     * Objects are selected by the masks of the queries rather than by a HitFilter, since filters are
+     * not expected to be called from several threads. This must not be called while the physics
+     * world is being updated.
+     *
+     * @param queries The ray tests to perform.
+     * @param queryCount The number of queries.
+     * @param hits The buffer the hits are written to, which must hold queryCount * maxHits results.
+     * @param hitCounts The buffer the number of hits of each query is written to, which must hold queryCount values.
+     * @param maxHits The largest number of hits returned for each query.
+     *
+     * @return The total number of hits.
+     * @script{ignore}
+     */
+    unsigned int rayTestBatch(const RayQuery* queries, unsigned int queryCount, HitResult* hits, unsigned int* hitCounts, unsigned int maxHits = 1);
 
     /**
-     * Internal class used to integrate with Bullet collision callbacks.
+     * Performs a batch of sweep tests on the physics world, in parallel on the threads of the job controller.
+     *
+     * The results are returned as with rayTestBatch(). Queries whose object does not have a convex
+     * collision shape return no hits.
+     *
+     * @param queries The sweep tests to perform.
+     * @param queryCount The number of queries.
+     * @param hits The buffer the hits are written to, which must hold queryCount * maxHits results.
+     * @param hitCounts The buffer the number of hits of each query is written to, which must hold queryCount values.
+     * @param maxHits The largest number of hits returned for each query.
+     *
+     * @return The total number of hits.
+     * @script{ignore}
+     */
+    unsigned int sweepTestBatch(const SweepQuery* queries, unsigned int queryCount, HitResult* hits, unsigned int* hitCounts, unsigned int maxHits = 1);
+
+    /**
+     * Defines a change in the contact between two collision objects, reported by getContactEvents().
+     *
+     * @script{ignore}
      */
-    class CollisionCallback : public btCollisionWorld::ContactResultCallback
+    struct ContactEvent
     {
-    public:
+        /**
+         * The types of contact events.
+         */
+        enum Type
+        {
+            /**
+             * The objects started touching during the last update.
+             */
+            BEGIN,
+
+            /**
+             * The objects were touching before the last update and still are.
+             */
+            PERSIST,
+
+            /**
+             * The objects stopped touching during the last update.
+             */
+            END
+        };
+
         /**
          * Constructor.
-         * 
-         * @param pc The physics controller that owns the callback.
          */
-        CollisionCallback(PhysicsController* pc) : _pc(pc) {}
+        ContactEvent(Type type, PhysicsCollisionObject* objectA, PhysicsCollisionObject* objectB, const Vector3& pointA, const Vector3& pointB);
 
-    protected:
         /**
-            * Internal function used for Bullet integration (do not use or override).
-            */
-        btScalar addSingleResult(btManifoldPoint& cp, const btCollisionObjectWrapper* a, int partIdA, int indexA, const btCollisionObjectWrapper* b, int partIdB, int indexB);    
+         * The type of the event.
+         */
+        Type type;
 
-    private:
-        PhysicsController* _pc;
+        /**
+         * The objects in contact.
+         */
+        PhysicsCollisionObject::CollisionPair pair;
+
+        /**
+         * The deepest contact point on object A, in world space (zero for END events).
+         */
+        Vector3 pointA;
+
+        /**
+         * The deepest contact point on object B, in world space (zero for END events).
+         */
+        Vector3 pointB;
     };
 
-    // Internal constants for the collision status cache.
-    static const int DIRTY;
-    static const int COLLISION;
+    /**
+     * Returns the contact events of the last update.
+     *
+     * The contacts are read from the contact manifolds Bullet computed while stepping the world,
+     * and compared with the pairs that were touching after the previous update, so that each
+     * pair of touching objects gives one BEGIN event, then one PERSIST event per update, then one
+     * END event. Collision listeners are notified of the BEGIN and END events only.
+     *
+     * Ghost objects in a trigger mode touch the objects their bounding boxes overlap in the
+     * broadphase instead (see PhysicsGhostObject::setTriggerMode), and their events have no
+     * contact points.
+     *
+     * @return The events, which remain valid until the next update or until one of their objects
+     *      is removed from the world.
+     * @script{ignore}
+     */
+    const std::vector<ContactEvent>& getContactEvents() const;
+
+private:
+
+    class TaskScheduler;
+
+    // Internal constants for the collision listener registrations.
     static const int REGISTERED;
     static const int REMOVE;
 
-    // Represents the collision listeners and status for a given collision pair (used by the collision status cache).
+    // Represents the collision listeners registered for a collision pair.
     struct CollisionInfo
     {
         CollisionInfo() : _status(0) { }
@@ -367,6 +738,60 @@ private:
         int _status;
     };
 
+    // The collision listeners by pair, where a pair with a NULL object matches all the contacts of the other object.
+    typedef std::map<PhysicsCollisionObject::CollisionPair, CollisionInfo, std::less<PhysicsCollisionObject::CollisionPair>,
+        PoolAllocator<std::pair<const PhysicsCollisionObject::CollisionPair, CollisionInfo> > > CollisionListenerMap;
+
+    // A pair of touching objects, with objectA at the lower address.
+    struct ContactPair
+    {
+        ContactPair() : objectA(NULL), objectB(NULL) { }
+
+        PhysicsCollisionObject* objectA;
+        PhysicsCollisionObject* objectB;
+        Vector3 pointA;
+        Vector3 pointB;
+    };
+
+    /**
+     * A hash set of touching pairs, using open addressing. It is rebuilt each update rather than
+     * having pairs removed, so it never needs to delete entries.
+     */
+    class ContactPairTable
+    {
+    public:
+
+        ContactPairTable();
+
+        /**
+         * Empties the table and makes room for the given number of pairs.
+         */
+        void clear(unsigned int capacity);
+
+        /**
+         * Adds a pair if it is not in the table yet, and returns its entry.
+         */
+        ContactPair* insert(PhysicsCollisionObject* objectA, PhysicsCollisionObject* objectB, bool* inserted);
+
+        /**
+         * Returns the entry of a pair, or NULL if it is not in the table.
+         */
+        const ContactPair* find(PhysicsCollisionObject* objectA, PhysicsCollisionObject* objectB) const;
+
+        /**
+         * Returns the number of pairs in the table.
+         */
+        unsigned int getCount() const;
+
+        /**
+         * Exchanges the contents of two tables.
+         */
+        void swap(ContactPairTable& table);
+
+        std::vector<ContactPair> _slots;    // The slots of the table, whose size is a power of two; empty slots have NULL objects.
+        unsigned int _count;
+    };
+
     /**
      * Constructor.
      */
@@ -408,6 +833,33 @@ private:
     // Removes the given collision listener.
     void removeCollisionListener(PhysicsCollisionObject::CollisionListener* listener, PhysicsCollisionObject* objectA, PhysicsCollisionObject* objectB);
 
+    // Builds the contact events of the update from Bullet's contact manifolds and the overlaps of the
+    // trigger ghost objects, and notifies the collision listeners.
+    void updateContacts();
+
+    // Adds a ghost object whose touching objects are found from the broadphase, and removes the
+    // contacts that were generated for its pairs.
+    void addTrigger(PhysicsGhostObject* ghost);
+
+    // Removes a ghost object whose touching objects were found from the broadphase.
+    void removeTrigger(PhysicsGhostObject* ghost);
+
+    // Adds a vehicle, which is updated after each step of the world with the hits of its wheel rays.
+    void addVehicle(PhysicsVehicle* vehicle);
+
+    // Removes a vehicle from those updated after each step of the world.
+    void removeVehicle(PhysicsVehicle* vehicle);
+
+    // Called by Bullet after each step of the world.
+    static void tickCallback(btDynamicsWorld* world, btScalar timeStep);
+
+    // Casts the wheel rays of all the vehicles in one batch, and updates the vehicles with their hits.
+    void updateVehicles(float timeStep);
+
+    // Notifies the collision listeners registered for a pair, or for either of its objects, of a contact event.
+    void notifyCollisionListeners(PhysicsCollisionObject::CollisionListener::EventType type, const PhysicsCollisionObject::CollisionPair& pair,
+        const Vector3& pointA, const Vector3& pointB);
+
     // Adds the given collision object to the world.
     void addCollisionObject(PhysicsCollisionObject* object);
     
@@ -433,6 +885,9 @@ private:
     // Creates a heightfield collision shape.
     PhysicsCollisionShape* createHeightfield(Node* node, HeightField* heightfield, Vector3* centerOfMassOffset);
 
+    // Determines whether two heightfields hold the same heights.
+    static bool isSameHeightField(HeightField* a, HeightField* b);
+
     // Creates a triangle mesh collision shape.
     PhysicsCollisionShape* createMesh(Mesh* mesh, const Vector3& scale);
 
@@ -537,16 +992,32 @@ private:
     btDefaultCollisionConfiguration* _collisionConfiguration;
     btCollisionDispatcher* _dispatcher;
     btBroadphaseInterface* _overlappingPairCache;
-    btSequentialImpulseConstraintSolver* _solver;
+    btDbvtBroadphase* _queryBroadphase;     // The tree the batched queries traverse, which is the broadphase or its raycast accelerator.
+    Broadphase _broadphase;
+    btConstraintSolver* _solver;
+    btConstraintSolver* _solverMt;
+    TaskScheduler* _taskScheduler;
     btDynamicsWorld* _world;
     btGhostPairCallback* _ghostPairCallback;
+    float _stepRate;
+    unsigned int _maxSubSteps;
+    bool _interpolation;
+    float _linearSleepingThreshold;
+    float _angularSleepingThreshold;
     std::vector<PhysicsCollisionShape*> _shapes;
     DebugDrawer* _debugDrawer;
     Listener::EventType _status;
     std::vector<Listener*>* _listeners;
     Vector3 _gravity;
-    std::map<PhysicsCollisionObject::CollisionPair, CollisionInfo> _collisionStatus;
-    CollisionCallback* _collisionCallback;
+    CollisionListenerMap _collisionListeners;
+    ContactPairTable _contacts;
+    ContactPairTable _newContacts;
+    std::vector<ContactEvent> _contactEvents;
+    std::vector<PhysicsGhostObject*> _triggers;
+    std::vector<PhysicsVehicle*> _vehicles;
+    std::vector<RayQuery> _vehicleRays;
+    std::vector<HitResult> _vehicleHits;
+    std::vector<unsigned int> _vehicleHitCounts;
 };
 
 }
@@ -7,7 +7,7 @@ namespace gameplay
 {
 
 PhysicsGhostObject::PhysicsGhostObject(Node* node, const PhysicsCollisionShape::Definition& shape)
-    : PhysicsCollisionObject(node), _ghostObject(NULL)
+    : PhysicsCollisionObject(node), _ghostObject(NULL), _triggerMode(CONTACTS)
 {
     Vector3 centerOfMassOffset;
     PhysicsController* physicsController = Game::getInstance()->getPhysicsController();
@@ -38,6 +38,7 @@ PhysicsGhostObject::~PhysicsGhostObject()
     GP_ASSERT(_node);
     _node->removeListener(this);
 
+    setTriggerMode(CONTACTS);
     GP_ASSERT(Game::getInstance()->getPhysicsController());
     Game::getInstance()->getPhysicsController()->removeCollisionObject(this, true);
 
@@ -77,6 +78,17 @@ PhysicsGhostObject* PhysicsGhostObject::create(Node* node, Properties* propertie
     // Create the ghost object.
     PhysicsGhostObject* ghost = new PhysicsGhostObject(node, shape);
 
+    const char* trigger = properties->getString("trigger");
+    if (trigger)
+    {
+        if (strcmp(trigger, "BOUNDS") == 0)
+            ghost->setTriggerMode(TRIGGER_BOUNDS);
+        else if (strcmp(trigger, "EXACT_ENTER") == 0)
+            ghost->setTriggerMode(TRIGGER_EXACT_ENTER);
+        else
+            GP_WARN("Unsupported ghost object trigger mode '%s'; contacts are generated.", trigger);
+    }
+
     return ghost;
 }
 
@@ -90,6 +102,25 @@ btCollisionObject* PhysicsGhostObject::getCollisionObject() const
     return _ghostObject;
 }
 
+void PhysicsGhostObject::setTriggerMode(TriggerMode mode)
+{
+    if (mode == _triggerMode)
+        return;
+
+    GP_ASSERT(Game::getInstance()->getPhysicsController());
+    PhysicsController* physicsController = Game::getInstance()->getPhysicsController();
+    if (_triggerMode == CONTACTS)
+        physicsController->addTrigger(this);
+    else if (mode == CONTACTS)
+        physicsController->removeTrigger(this);
+    _triggerMode = mode;
+}
+
+PhysicsGhostObject::TriggerMode PhysicsGhostObject::getTriggerMode() const
+{
+    return _triggerMode;
+}
+
 void PhysicsGhostObject::transformChanged(Transform* transform, long cookie)
 {
     GP_ASSERT(_motionState);
@@ -10,6 +10,14 @@ namespace gameplay
 
 /**
  * Defines a class for physics ghost objects.
+ *
+ * Ghost objects do not respond to collisions, so they are used as trigger volumes. By default
+ * the narrowphase generates contacts between a ghost object and the objects it overlaps, as for
+ * other collision objects. Trigger volumes only need to know which objects are inside them, so
+ * a ghost object can instead be set to a trigger mode (see setTriggerMode), in which it touches
+ * the objects whose bounding boxes overlap its own in the broadphase, without any contacts
+ * being generated. Either way, objects entering and leaving the ghost object are reported by
+ * PhysicsController::getContactEvents and to the collision listeners.
  */
 class PhysicsGhostObject : public PhysicsCollisionObject, public Transform::Listener
 {
@@ -18,6 +26,29 @@ class PhysicsGhostObject : public PhysicsCollisionObject, public Transform::List
 
 public:
 
+    /**
+     * Defines how the objects a ghost object touches are found.
+     */
+    enum TriggerMode
+    {
+        /**
+         * Objects touch the ghost object when the narrowphase generates contacts between them (the default).
+         */
+        CONTACTS,
+
+        /**
+         * Objects touch the ghost object while their bounding boxes overlap its own.
+         */
+        TRIGGER_BOUNDS,
+
+        /**
+         * Objects start touching the ghost object when their shapes touch, which is tested
+         * once per update while their bounding boxes overlap, and stop touching it when
+         * their bounding boxes no longer overlap.
+         */
+        TRIGGER_EXACT_ENTER
+    };
+
     /**
      * @see PhysicsCollisionObject::getType
      */
@@ -28,6 +59,27 @@ public:
      */
     void transformChanged(Transform* transform, long cookie);
 
+    /**
+     * Sets how the objects this ghost object touches are found.
+     *
+     * In the trigger modes, the contact events of the ghost object have no contact points,
+     * and its pairs are left out of the narrowphase, so thousands of trigger volumes cost
+     * little more than their broadphase proxies. This can also be set with the 'trigger'
+     * property of the collision object namespace, to BOUNDS or EXACT_ENTER.
+     *
+     * @param mode The trigger mode.
+     * @script{ignore}
+     */
+    void setTriggerMode(TriggerMode mode);
+
+    /**
+     * Returns how the objects this ghost object touches are found.
+     *
+     * @return The trigger mode.
+     * @script{ignore}
+     */
+    TriggerMode getTriggerMode() const;
+
 protected:
 
     /**
@@ -64,6 +116,11 @@ protected:
      * Pointer to the Bullet ghost collision object.
      */
     btPairCachingGhostObject* _ghostObject;
+
+    /**
+     * How the objects the ghost object touches are found.
+     */
+    TriggerMode _triggerMode;
 };
 
 }
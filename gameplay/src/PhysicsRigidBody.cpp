@@ -11,7 +11,8 @@ namespace gameplay
 {
 
 PhysicsRigidBody::PhysicsRigidBody(Node* node, const PhysicsCollisionShape::Definition& shape, const Parameters& parameters)
-        : PhysicsCollisionObject(node), _body(NULL), _mass(parameters.mass), _constraints(NULL), _inDestructor(false)
+        : PhysicsCollisionObject(node), _body(NULL), _mass(parameters.mass), _constraints(NULL), _inDestructor(false),
+          _sleepingEnabled(parameters.sleepingEnabled), _inverseIsDirty(true)
 {
     GP_ASSERT(Game::getInstance()->getPhysicsController());
     GP_ASSERT(_node);
@@ -46,6 +47,9 @@ PhysicsRigidBody::PhysicsRigidBody(Node* node, const PhysicsCollisionShape::Defi
     _body->setMotionState(_motionState);
 
     // Set other initially defined properties.
+    PhysicsController* controller = Game::getInstance()->getPhysicsController();
+    _body->setSleepingThresholds(parameters.linearSleepingThreshold >= 0.0f ? parameters.linearSleepingThreshold : controller->getLinearSleepingThreshold(),
+        parameters.angularSleepingThreshold >= 0.0f ? parameters.angularSleepingThreshold : controller->getAngularSleepingThreshold());
     setKinematic(parameters.kinematic);
     setAnisotropicFriction(parameters.anisotropicFriction);
     setAngularFactor(parameters.angularFactor);
@@ -238,6 +242,18 @@ PhysicsRigidBody* PhysicsRigidBody::create(Node* node, Properties* properties, c
         {
             properties->getVector3(NULL, &parameters.linearFactor);
         }
+        else if (strcmp(name, "linearSleepingThreshold") == 0)
+        {
+            parameters.linearSleepingThreshold = properties->getFloat();
+        }
+        else if (strcmp(name, "angularSleepingThreshold") == 0)
+        {
+            parameters.angularSleepingThreshold = properties->getFloat();
+        }
+        else if (strcmp(name, "sleeping") == 0)
+        {
+            parameters.sleepingEnabled = properties->getBool();
+        }
         else
         {
             // Ignore this case (the attributes for the rigid body's collision shape would end up here).
@@ -268,10 +284,20 @@ void PhysicsRigidBody::setKinematic(bool kinematic)
     else
     {
         _body->setCollisionFlags(_body->getCollisionFlags() & ~btCollisionObject::CF_KINEMATIC_OBJECT);
-        _body->setActivationState(ACTIVE_TAG);
+        _body->forceActivationState(_sleepingEnabled ? ACTIVE_TAG : DISABLE_DEACTIVATION);
     }
 }
 
+void PhysicsRigidBody::setSleepingEnabled(bool enabled)
+{
+    GP_ASSERT(_body);
+    _sleepingEnabled = enabled;
+
+    // Kinematic bodies are always kept awake.
+    if (!_body->isKinematicObject())
+        _body->forceActivationState(enabled ? ACTIVE_TAG : DISABLE_DEACTIVATION);
+}
+
 void PhysicsRigidBody::setEnabled(bool enable)
 {
     PhysicsCollisionObject::setEnabled(enable);
@@ -299,11 +325,11 @@ float PhysicsRigidBody::getHeight(float x, float z) const
     GP_ASSERT(_collisionShape->_shapeData.heightfieldData);
 
     // Ensure inverse matrix is updated so we can transform from world back into local heightfield coordinates for indexing
-    if (_collisionShape->_shapeData.heightfieldData->inverseIsDirty)
+    if (_inverseIsDirty)
     {
-        _collisionShape->_shapeData.heightfieldData->inverseIsDirty = false;
+        _inverseIsDirty = false;
 
-        _node->getWorldMatrix().invert(&_collisionShape->_shapeData.heightfieldData->inverse);
+        _node->getWorldMatrix().invert(&_inverse);
     }
 
     // Calculate the correct x, z position relative to the heightfield data.
@@ -313,7 +339,7 @@ float PhysicsRigidBody::getHeight(float x, float z) const
     GP_ASSERT(cols > 0);
     GP_ASSERT(rows > 0);
 
-    Vector3 v = _collisionShape->_shapeData.heightfieldData->inverse * Vector3(x, 0.0f, z);
+    Vector3 v = _inverse * Vector3(x, 0.0f, z);
     x = v.x + (cols - 1) * 0.5f;
     z = v.z + (rows - 1) * 0.5f;
 
@@ -367,7 +393,7 @@ void PhysicsRigidBody::transformChanged(Transform* transform, long cookie)
         GP_ASSERT(_collisionShape && _collisionShape->_shapeData.heightfieldData);
 
         // Dirty the heightfield's inverse matrix (used to compute height values from world-space coordinates)
-        _collisionShape->_shapeData.heightfieldData->inverseIsDirty = true;
+        _inverseIsDirty = true;
 
         // Update local scaling for the heightfield.
         Vector3 scale;
@@ -380,7 +406,26 @@ void PhysicsRigidBody::transformChanged(Transform* transform, long cookie)
             scale.set(scale.x * tScale.x, scale.y * tScale.y, scale.z * tScale.z);
         }
 
-        _collisionShape->_shape->setLocalScaling(BV(scale));
+        if (scale != _collisionShape->_shapeData.heightfieldData->scale)
+        {
+            if (_collisionShape->getRefCount() == 1)
+            {
+                // Only this rigid body uses the shape, so scale it in place.
+                _collisionShape->_shape->setLocalScaling(BV(scale));
+                _collisionShape->_shapeData.heightfieldData->scale = scale;
+            }
+            else
+            {
+                // The shape is shared with rigid bodies of another scale: switch to a shape of the new scale.
+                PhysicsController* controller = Game::getInstance()->getPhysicsController();
+                Vector3 centerOfMassOffset;
+                PhysicsCollisionShape* shape = controller->createHeightfield(_node, _collisionShape->_shapeData.heightfieldData->heightfield, &centerOfMassOffset);
+                GP_ASSERT(shape);
+                _body->setCollisionShape(shape->getShape());
+                controller->destroyShape(_collisionShape);
+                _collisionShape = shape;
+            }
+        }
 
         // Update center of mass offset
         float minHeight = _collisionShape->_shapeData.heightfieldData->minHeight;
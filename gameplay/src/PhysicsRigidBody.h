@@ -87,12 +87,30 @@ public:
          */
         Vector3 angularFactor;
 
+        /**
+         * The linear velocity below which the rigid body can fall asleep, or a negative value to
+         * use the default of the physics controller.
+         */
+        float linearSleepingThreshold;
+
+        /**
+         * The angular velocity below which the rigid body can fall asleep, or a negative value to
+         * use the default of the physics controller.
+         */
+        float angularSleepingThreshold;
+
+        /**
+         * Whether the rigid body can fall asleep.
+         */
+        bool sleepingEnabled;
+
         /**
          * Constructor.
          */
         Parameters() : mass(0.0f), friction(0.5f), restitution(0.0f),
             linearDamping(0.0f), angularDamping(0.0f),
-            kinematic(false), anisotropicFriction(Vector3::one()), linearFactor(Vector3::one()), angularFactor(Vector3::one())
+            kinematic(false), anisotropicFriction(Vector3::one()), linearFactor(Vector3::one()), angularFactor(Vector3::one()),
+            linearSleepingThreshold(-1.0f), angularSleepingThreshold(-1.0f), sleepingEnabled(true)
         {
         }
 
@@ -104,7 +122,8 @@ public:
             const Vector3& anisotropicFriction = Vector3::one(), const Vector3& linearFactor = Vector3::one(), 
             const Vector3& angularFactor = Vector3::one())
             : mass(mass), friction(friction), restitution(restitution), linearDamping(linearDamping), angularDamping(angularDamping),
-              kinematic(kinematic), anisotropicFriction(anisotropicFriction), linearFactor(linearFactor), angularFactor(angularFactor)
+              kinematic(kinematic), anisotropicFriction(anisotropicFriction), linearFactor(linearFactor), angularFactor(angularFactor),
+              linearSleepingThreshold(-1.0f), angularSleepingThreshold(-1.0f), sleepingEnabled(true)
         {
         }
     };
@@ -325,6 +344,47 @@ public:
      */
     void setKinematic(bool kinematic);
 
+    /**
+     * Sets the velocities below which the rigid body can fall asleep, once it stayed below them for
+     * the deactivation time of the physics controller.
+     *
+     * @param linear The linear velocity threshold.
+     * @param angular The angular velocity threshold.
+     */
+    inline void setSleepingThresholds(float linear, float angular);
+
+    /**
+     * Gets the linear velocity below which the rigid body can fall asleep.
+     *
+     * @return The linear velocity threshold.
+     */
+    inline float getLinearSleepingThreshold() const;
+
+    /**
+     * Gets the angular velocity below which the rigid body can fall asleep.
+     *
+     * @return The angular velocity threshold.
+     */
+    inline float getAngularSleepingThreshold() const;
+
+    /**
+     * Sets whether the rigid body can fall asleep.
+     *
+     * A rigid body that never rests, such as one pushed by a constant force, keeps its whole island
+     * awake; disabling sleeping for it makes this explicit, while bodies that should rest can be given
+     * higher thresholds instead.
+     *
+     * @param enabled True to let the rigid body fall asleep, false to keep it awake.
+     */
+    void setSleepingEnabled(bool enabled);
+
+    /**
+     * Determines whether the rigid body can fall asleep.
+     *
+     * @return True if the rigid body can fall asleep, false otherwise.
+     */
+    inline bool isSleepingEnabled() const;
+
     /**
      * Sets whether the rigid body is enabled or disabled in the physics world.
      *
@@ -435,6 +495,9 @@ private:
     float _mass;
     std::vector<PhysicsConstraint*>* _constraints;
     bool _inDestructor;
+    bool _sleepingEnabled;
+    bool _inverseIsDirty;   // Whether _inverse must be computed again (heightfield rigid bodies only).
+    Matrix _inverse;        // The inverse world matrix of the node, used to look up heights (heightfield rigid bodies only).
 
 };
 
@@ -127,6 +127,29 @@ inline void PhysicsRigidBody::setGravity(float x, float y, float z)
     _body->setGravity(btVector3(x, y, z));
 }
 
+inline void PhysicsRigidBody::setSleepingThresholds(float linear, float angular)
+{
+    GP_ASSERT(_body);
+    _body->setSleepingThresholds(linear, angular);
+}
+
+inline float PhysicsRigidBody::getLinearSleepingThreshold() const
+{
+    GP_ASSERT(_body);
+    return _body->getLinearSleepingThreshold();
+}
+
+inline float PhysicsRigidBody::getAngularSleepingThreshold() const
+{
+    GP_ASSERT(_body);
+    return _body->getAngularSleepingThreshold();
+}
+
+inline bool PhysicsRigidBody::isSleepingEnabled() const
+{
+    return _sleepingEnabled;
+}
+
 inline Vector3 PhysicsRigidBody::getAngularFactor() const
 {
     GP_ASSERT(_body);
@@ -8,6 +8,12 @@
 #define AIR_DENSITY (1.2f)
 #define KPH_TO_MPS (1.0f / 3.6f)
 
+// The length of the ray down from the chassis of a simplified vehicle, relative to its ride height.
+#define SIMPLIFIED_RAY_LENGTH 2.0f
+
+// The rate at which a simplified vehicle on the ground is turned upright to it, per second.
+#define SIMPLIFIED_UPRIGHT_RATE 5.0f
+
 namespace gameplay
 {
 
@@ -48,13 +54,49 @@ class VehicleNotMeRaycaster : public btVehicleRaycaster
 
 public:
 
+    /**
+     * The ground hit by a wheel ray that was cast in a batch.
+     */
+    struct Hit
+    {
+        btRigidBody* body;
+        btVector3 point;
+        btVector3 normal;
+        btScalar fraction;
+    };
+
     VehicleNotMeRaycaster(btDynamicsWorld* world, btCollisionObject* me)
-        : _dynamicsWorld(world), _me(me)
+        : _dynamicsWorld(world), _me(me), _next(0)
     {
     }
 
+    /**
+     * Sets the number of rays of the next update of the vehicle that were cast in a batch,
+     * and returns their hits to fill in, in the order the vehicle casts the rays.
+     */
+    Hit* setHitCount(unsigned int count)
+    {
+        _hits.resize(count);
+        _next = 0;
+        return count > 0 ? &_hits[0] : NULL;
+    }
+
     void* castRay(const btVector3& from, const btVector3& to, btVehicleRaycasterResult& result)
     {
+        // Rays that were not cast in a batch are cast into the world.
+        if (_next < _hits.size())
+        {
+            const Hit& hit = _hits[_next++];
+            if (hit.body == NULL)
+                return 0;
+
+            result.m_hitPointInWorld = hit.point;
+            result.m_hitNormalInWorld = hit.normal;
+            result.m_hitNormalInWorld.normalize();
+            result.m_distFraction = hit.fraction;
+            return (void*)hit.body;
+        }
+
         ClosestNotMeRayResultCallback rayCallback(from, to, _me);
         _dynamicsWorld->rayTest(from, to, rayCallback);
 
@@ -77,10 +119,12 @@ private:
 
     btDynamicsWorld* _dynamicsWorld;
     btCollisionObject* _me;
+    std::vector<Hit> _hits;
+    size_t _next;
 };
 
 PhysicsVehicle::PhysicsVehicle(Node* node, const PhysicsCollisionShape::Definition& shape, const PhysicsRigidBody::Parameters& parameters)
-    : PhysicsCollisionObject(node), _speedSmoothed(0)
+    : PhysicsCollisionObject(node), _speedSmoothed(0), _simplified(false)
 {
     // Note that the constructor for PhysicsRigidBody calls addCollisionObject and so
     // that is where the rigid body gets added to the dynamics world.
@@ -90,7 +134,7 @@ PhysicsVehicle::PhysicsVehicle(Node* node, const PhysicsCollisionShape::Definiti
 }
 
 PhysicsVehicle::PhysicsVehicle(Node* node, PhysicsRigidBody* rigidBody)
-    : PhysicsCollisionObject(node), _speedSmoothed(0)
+    : PhysicsCollisionObject(node), _speedSmoothed(0), _simplified(false)
 {
     _rigidBody = rigidBody;
 
@@ -157,6 +201,10 @@ PhysicsVehicle* PhysicsVehicle::create(Node* node, Properties* properties)
         {
             vehicle->_downforce = properties->getFloat();
         }
+        else if (strcmp(name, "simplified") == 0)
+        {
+            vehicle->_simplified = properties->getBool();
+        }
         else
         {
             // Ignore this case (we've already parsed the rigid body parameters).
@@ -180,13 +228,15 @@ void PhysicsVehicle::initialize()
     setBoost(0, 1);
     setDownforce(0);
 
-    // Create the vehicle and add it to world
+    // Create the vehicle. Rather than adding it to the world as an action, the physics
+    // controller updates it after each step, so that the rays of its wheels are cast
+    // together with those of the other vehicles.
+    PhysicsController* physicsController = Game::getInstance()->getPhysicsController();
     btRigidBody* body = static_cast<btRigidBody*>(_rigidBody->getCollisionObject());
-    btDynamicsWorld* dynamicsWorld = Game::getInstance()->getPhysicsController()->_world;
-    _vehicleRaycaster = new VehicleNotMeRaycaster(dynamicsWorld, body);
+    _vehicleRaycaster = new VehicleNotMeRaycaster(physicsController->_world, body);
     _vehicle = bullet_new<btRaycastVehicle>(_vehicleTuning, body, _vehicleRaycaster);
     body->setActivationState(DISABLE_DEACTIVATION);
-    dynamicsWorld->addVehicle(_vehicle);
+    physicsController->addVehicle(this);
     _vehicle->setCoordinateSystem(0, 1, 2);
 
     // Advertise self among ancestor nodes so that wheels can bind to self.
@@ -201,7 +251,9 @@ PhysicsVehicle::~PhysicsVehicle()
 {
     // Note that the destructor for PhysicsRigidBody calls removeCollisionObject and so
     // that is where the rigid body gets removed from the dynamics world. The vehicle
-    // itself is just an action interface in the dynamics world.
+    // itself is updated by the physics controller.
+    GP_ASSERT(Game::getInstance()->getPhysicsController());
+    Game::getInstance()->getPhysicsController()->removeVehicle(this);
     SAFE_DELETE(_vehicle);
     SAFE_DELETE(_vehicleRaycaster);
     SAFE_DELETE(_rigidBody);
@@ -251,7 +303,14 @@ void PhysicsVehicle::addWheel(PhysicsVehicleWheel* wheel)
 
 float PhysicsVehicle::getSpeedKph() const
 {
-    return _vehicle->getCurrentSpeedKmHour();
+    if (!_simplified)
+        return _vehicle->getCurrentSpeedKmHour();
+
+    // btRaycastVehicle only computes the speed of the vehicles it updates; it is negative backwards.
+    const btVector3& velocity = _vehicle->getRigidBody()->getLinearVelocity();
+    const btVector3 forward = _vehicle->getChassisWorldTransform().getBasis().getColumn(_vehicle->getForwardAxis());
+    const float speed = velocity.length() / KPH_TO_MPS;
+    return forward.dot(velocity) < 0 ? -speed : speed;
 }
 
 float PhysicsVehicle::getSpeedSmoothKph() const
@@ -350,6 +409,183 @@ float PhysicsVehicle::getDriving(float v, float rawDriving, float rawBraking) co
     return gain * rawDriving - reduc;
 }
 
+void PhysicsVehicle::getRays(std::vector<PhysicsController::RayQuery>& rays)
+{
+    const int wheelCount = _vehicle->getNumWheels();
+    if (_simplified)
+    {
+        if (wheelCount > 0)
+        {
+            const btTransform& chassis = _vehicle->getChassisWorldTransform();
+            const btVector3& origin = chassis.getOrigin();
+            const btVector3 down = -chassis.getBasis().getColumn(_vehicle->getUpAxis());
+            rays.push_back(PhysicsController::RayQuery(Ray(origin.x(), origin.y(), origin.z(), down.x(), down.y(), down.z()),
+                                                       SIMPLIFIED_RAY_LENGTH * getRideHeight()));
+        }
+        return;
+    }
+
+    // These are the rays btRaycastVehicle::updateVehicle casts, from the wheel transforms
+    // it computes before casting them.
+    for (int i = 0; i < wheelCount; i++)
+    {
+        _vehicle->updateWheelTransform(i, false);
+        const btWheelInfo& wheel = _vehicle->getWheelInfo(i);
+        const btVector3& from = wheel.m_raycastInfo.m_hardPointWS;
+        const btVector3& direction = wheel.m_raycastInfo.m_wheelDirectionWS;
+        rays.push_back(PhysicsController::RayQuery(Ray(from.x(), from.y(), from.z(), direction.x(), direction.y(), direction.z()),
+                                                   wheel.getSuspensionRestLength() + wheel.m_wheelsRadius));
+    }
+}
+
+unsigned int PhysicsVehicle::step(float timeStep, const PhysicsController::HitResult* hits, const unsigned int* hitCounts, unsigned int maxHits)
+{
+    const unsigned int wheelCount = (unsigned int)_vehicle->getNumWheels();
+    btRigidBody* body;
+    if (_simplified)
+    {
+        if (wheelCount == 0)
+            return 0;
+
+        stepSimplified(timeStep, getGround(hits, hitCounts[0], &body), SIMPLIFIED_RAY_LENGTH * getRideHeight());
+        return 1;
+    }
+
+    VehicleNotMeRaycaster* raycaster = static_cast<VehicleNotMeRaycaster*>(_vehicleRaycaster);
+    VehicleNotMeRaycaster::Hit* wheelHits = raycaster->setHitCount(wheelCount);
+    for (unsigned int i = 0; i < wheelCount; i++)
+    {
+        const PhysicsController::HitResult* hit = getGround(hits + i * maxHits, hitCounts[i], &body);
+        wheelHits[i].body = hit ? body : NULL;
+        if (hit)
+        {
+            wheelHits[i].point = BV(hit->point);
+            wheelHits[i].normal = BV(hit->normal);
+            wheelHits[i].fraction = hit->fraction;
+        }
+    }
+    _vehicle->updateVehicle(timeStep);
+    raycaster->setHitCount(0);
+
+    return wheelCount;
+}
+
+void PhysicsVehicle::stepSimplified(float timeStep, const PhysicsController::HitResult* hit, float distance)
+{
+    btRigidBody* body = _vehicle->getRigidBody();
+    const btMatrix3x3& basis = _vehicle->getChassisWorldTransform().getBasis();
+    const btVector3 right = basis.getColumn(_vehicle->getRightAxis());
+    const btVector3 up = basis.getColumn(_vehicle->getUpAxis());
+    const btVector3 forward = basis.getColumn(_vehicle->getForwardAxis());
+    const btScalar mass = body->getInvMass() > 0 ? 1 / body->getInvMass() : 0;
+
+    // The suspensions of the wheels are lumped into one spring, and their controls into one axle.
+    const int wheelCount = _vehicle->getNumWheels();
+    const int forwardAxis = _vehicle->getForwardAxis();
+    float stiffness = 0, dampingCompression = 0, dampingRelaxation = 0, forceMax = 0, travelMax = 0;
+    float engineForce = 0, brake = 0, steering = 0;
+    float front = -FLT_MAX, back = FLT_MAX;
+    int steerableCount = 0;
+    for (int i = 0; i < wheelCount; i++)
+    {
+        const btWheelInfo& wheel = _vehicle->getWheelInfo(i);
+        stiffness += wheel.m_suspensionStiffness;
+        dampingCompression += wheel.m_wheelsDampingCompression;
+        dampingRelaxation += wheel.m_wheelsDampingRelaxation;
+        forceMax += wheel.m_maxSuspensionForce;
+        travelMax = max(travelMax, wheel.m_maxSuspensionTravelCm * 0.01f);
+        engineForce += wheel.m_engineForce;
+        brake += wheel.m_brake;
+        if (_wheels[i]->isSteerable())
+        {
+            steering += wheel.m_steering;
+            steerableCount++;
+        }
+        front = max(front, (float)wheel.m_chassisConnectionPointCS[forwardAxis]);
+        back = min(back, (float)wheel.m_chassisConnectionPointCS[forwardAxis]);
+    }
+    if (steerableCount > 0)
+        steering /= steerableCount;
+
+    // The vehicle is on the ground while the spring is within the travel of the suspension.
+    const float rideHeight = getRideHeight();
+    const bool grounded = hit && hit->fraction * distance < rideHeight + travelMax;
+    const btVector3 velocity = body->getLinearVelocity();
+    const float forwardSpeed = velocity.dot(forward);
+    if (grounded)
+    {
+        // The spring holds the chassis at its ride height, as the suspension of btRaycastVehicle does.
+        const float compression = rideHeight - hit->fraction * distance;
+        const float upSpeed = velocity.dot(up);
+        float force = stiffness * compression - (upSpeed < 0 ? dampingCompression : dampingRelaxation) * upSpeed;
+        force = min(max(force * mass, 0.0f), forceMax);
+        btVector3 impulse = up * (force * timeStep);
+
+        // The engine drives the vehicle, the brakes stop it, and it does not slide sideways.
+        impulse += forward * (engineForce * timeStep);
+        impulse += forward * btClamped(-mass * forwardSpeed, -brake, brake);
+        impulse -= right * (mass * velocity.dot(right));
+        body->applyCentralImpulse(impulse);
+
+        // The vehicle turns around the back axle at the angle of the steering, and is turned upright to the ground.
+        btVector3 angularVelocity = up.cross(BV(hit->normal).normalized()) * SIMPLIFIED_UPRIGHT_RATE;
+        if (front - back > MATH_FLOAT_SMALL)
+            angularVelocity += up * (forwardSpeed * tan(steering) / (front - back));
+        body->setAngularVelocity(angularVelocity);
+    }
+
+    // The wheels are held at the rest length of their suspension, and roll with the vehicle.
+    for (int i = 0; i < wheelCount; i++)
+    {
+        btWheelInfo& wheel = _vehicle->getWheelInfo(i);
+        wheel.m_raycastInfo.m_suspensionLength = wheel.getSuspensionRestLength();
+        wheel.m_raycastInfo.m_isInContact = grounded;
+        if (grounded)
+            wheel.m_deltaRotation = forwardSpeed * timeStep / wheel.m_wheelsRadius;
+        else
+            wheel.m_deltaRotation *= 0.99f;
+        wheel.m_rotation += wheel.m_deltaRotation;
+        _vehicle->updateWheelTransform(i, false);
+    }
+}
+
+const PhysicsController::HitResult* PhysicsVehicle::getGround(const PhysicsController::HitResult* hits, unsigned int hitCount, btRigidBody** body) const
+{
+    GP_ASSERT(body);
+
+    // The rays start inside the chassis, and pass through the objects without contact response.
+    for (unsigned int i = 0; i < hitCount; i++)
+    {
+        PhysicsCollisionObject* object = hits[i].object;
+        if (object == _rigidBody || object->getType() != PhysicsCollisionObject::RIGID_BODY)
+            continue;
+
+        *body = btRigidBody::upcast(static_cast<PhysicsRigidBody*>(object)->getCollisionObject());
+        if (*body && (*body)->hasContactResponse())
+            return &hits[i];
+    }
+    *body = NULL;
+    return NULL;
+}
+
+float PhysicsVehicle::getRideHeight() const
+{
+    const int wheelCount = _vehicle->getNumWheels();
+    if (wheelCount == 0)
+        return 0.0f;
+
+    // The contact point of each wheel at rest is below the chassis by the ride height.
+    const int upAxis = _vehicle->getUpAxis();
+    float height = 0.0f;
+    for (int i = 0; i < wheelCount; i++)
+    {
+        const btWheelInfo& wheel = _vehicle->getWheelInfo(i);
+        const btVector3 contact = wheel.m_chassisConnectionPointCS + wheel.m_wheelDirectionCS * (wheel.getSuspensionRestLength() + wheel.m_wheelsRadius);
+        height -= contact[upAxis];
+    }
+    return height / wheelCount;
+}
+
 void PhysicsVehicle::applyDownforce()
 {
     float v = _speedSmoothed * KPH_TO_MPS;
@@ -465,4 +701,14 @@ void PhysicsVehicle::setDownforce(float downforce)
     _downforce = downforce;
 }
 
+void PhysicsVehicle::setSimplified(bool simplified)
+{
+    _simplified = simplified;
+}
+
+bool PhysicsVehicle::isSimplified() const
+{
+    return _simplified;
+}
+
 }
@@ -3,6 +3,7 @@
 
 #include "PhysicsCollisionObject.h"
 #include "PhysicsRigidBody.h"
+#include "PhysicsController.h"
 
 namespace gameplay
 {
@@ -52,12 +53,19 @@ class PhysicsVehicleWheel;
 
         // Aerodynamic downforce effect (optional)
         downforce      = <float>    // proportional control of downforce
+
+        // Simplified model for distant vehicles (optional)
+        simplified     = <bool>     // see setSimplified
     }
  @endverbatim
+ *
+ * The wheel rays of all the vehicles are cast together in one batch at each step of the
+ * physics world (see PhysicsController::rayTestBatch).
  */
 class PhysicsVehicle : public PhysicsCollisionObject
 {
     friend class Node;
+    friend class PhysicsController;
     friend class PhysicsVehicleWheel;
 
 public:
@@ -316,6 +324,28 @@ public:
      */
     void setDownforce(float downforce);
 
+    /**
+     * Sets whether the vehicle is simulated with a simplified model, such as for AI
+     * vehicles that are far from the camera.
+     *
+     * A simplified vehicle casts a single ray down from its chassis instead of one ray per
+     * wheel, and one spring holds the chassis at its ride height in place of the suspension
+     * of each wheel. The vehicle is driven, braked and steered without its wheels slipping,
+     * and it is kept upright on the ground. Its wheels are drawn at their rest position.
+     *
+     * @param simplified true to use the simplified model, false to simulate each wheel (the default).
+     * @script{ignore}
+     */
+    void setSimplified(bool simplified);
+
+    /**
+     * Determines whether the vehicle is simulated with a simplified model.
+     *
+     * @return true if the vehicle uses the simplified model, false if each wheel is simulated.
+     * @script{ignore}
+     */
+    bool isSimplified() const;
+
 protected:
 
     /**
@@ -404,6 +434,53 @@ private:
      */
     void applyDownforce();
 
+    /**
+     * Adds the rays the vehicle casts at the next step to a batch: the ray of each wheel, or
+     * the ray down from the chassis of a simplified vehicle.
+     *
+     * @param rays The rays of the batch.
+     */
+    void getRays(std::vector<PhysicsController::RayQuery>& rays);
+
+    /**
+     * Updates the vehicle at a step of the physics world, with the hits of its rays.
+     *
+     * @param timeStep The duration of the step, in seconds.
+     * @param hits The hits of the rays of the vehicle, maxHits for each ray.
+     * @param hitCounts The number of hits of each ray.
+     * @param maxHits The number of hits kept for each ray.
+     *
+     * @return The number of rays of the vehicle.
+     */
+    unsigned int step(float timeStep, const PhysicsController::HitResult* hits, const unsigned int* hitCounts, unsigned int maxHits);
+
+    /**
+     * Updates a simplified vehicle at a step of the physics world.
+     *
+     * @param timeStep The duration of the step, in seconds.
+     * @param hit The hit the vehicle stands on, or NULL if it is in the air.
+     * @param distance The length of the ray down from the chassis.
+     */
+    void stepSimplified(float timeStep, const PhysicsController::HitResult* hit, float distance);
+
+    /**
+     * Returns the closest hit of a ray that a wheel can stand on, which is a rigid body with
+     * contact response other than the chassis.
+     *
+     * @param hits The hits of the ray, from the closest.
+     * @param hitCount The number of hits.
+     * @param body Set to the Bullet rigid body of the hit.
+     *
+     * @return The hit, or NULL if there is none.
+     */
+    const PhysicsController::HitResult* getGround(const PhysicsController::HitResult* hits, unsigned int hitCount, btRigidBody** body) const;
+
+    /**
+     * Returns the height of the chassis above the ground at the rest length of the suspension,
+     * averaged over the wheels.
+     */
+    float getRideHeight() const;
+
     float _steeringGain;
     float _brakingForce;
     float _drivingForce;
@@ -422,6 +499,7 @@ private:
     btVehicleRaycaster* _vehicleRaycaster;
     btRaycastVehicle* _vehicle;
     std::vector<PhysicsVehicleWheel*> _wheels;
+    bool _simplified;
 };
 
 }
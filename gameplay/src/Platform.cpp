@@ -4,30 +4,41 @@
 #include "Game.h"
 #include "ScriptController.h"
 #include "Form.h"
+#include "FramePacer.h"
 
 namespace gameplay
 {
 
+static double __inputEventTime = -1.0;
+
 void Platform::touchEventInternal(Touch::TouchEvent evt, int x, int y, unsigned int contactIndex, bool actuallyMouse)
 {
+    FramePacer::notifyInput();
     if (actuallyMouse || !Form::touchEventInternal(evt, x, y, contactIndex))
     {
-        Game::getInstance()->touchEvent(evt, x, y, contactIndex);
-        Game::getInstance()->getScriptController()->touchEvent(evt, x, y, contactIndex);
+        // Input events are not sent to scripts unless scripting was initialized.
+        Game* game = Game::getInstance();
+        game->touchEvent(evt, x, y, contactIndex);
+        if (game->_scriptController)
+            game->_scriptController->touchEvent(evt, x, y, contactIndex);
     }
 }
 
 void Platform::keyEventInternal(Keyboard::KeyEvent evt, int key)
 {
+    FramePacer::notifyInput();
     if (!Form::keyEventInternal(evt, key))
     {
-        Game::getInstance()->keyEvent(evt, key);
-        Game::getInstance()->getScriptController()->keyEvent(evt, key);
+        Game* game = Game::getInstance();
+        game->keyEvent(evt, key);
+        if (game->_scriptController)
+            game->_scriptController->keyEvent(evt, key);
     }
 }
 
 bool Platform::mouseEventInternal(Mouse::MouseEvent evt, int x, int y, int wheelDelta)
 {
+    FramePacer::notifyInput();
     if (Form::mouseEventInternal(evt, x, y, wheelDelta))
     {
         return true;
@@ -38,29 +49,39 @@ bool Platform::mouseEventInternal(Mouse::MouseEvent evt, int x, int y, int wheel
     }
     else
     {
-        return Game::getInstance()->getScriptController()->mouseEvent(evt, x, y, wheelDelta);
+        ScriptController* scriptController = Game::getInstance()->_scriptController;
+        return scriptController && scriptController->mouseEvent(evt, x, y, wheelDelta);
     }
 }
 
 void Platform::gestureSwipeEventInternal(int x, int y, int direction)
 {
+    FramePacer::notifyInput();
     // TODO: Add support to Form for gestures
-    Game::getInstance()->gestureSwipeEvent(x, y, direction);
-    Game::getInstance()->getScriptController()->gestureSwipeEvent(x, y, direction);
+    Game* game = Game::getInstance();
+    game->gestureSwipeEvent(x, y, direction);
+    if (game->_scriptController)
+        game->_scriptController->gestureSwipeEvent(x, y, direction);
 }
 
 void Platform::gesturePinchEventInternal(int x, int y, float scale)
 {
+    FramePacer::notifyInput();
     // TODO: Add support to Form for gestures
-    Game::getInstance()->gesturePinchEvent(x, y, scale);
-    Game::getInstance()->getScriptController()->gesturePinchEvent(x, y, scale);
+    Game* game = Game::getInstance();
+    game->gesturePinchEvent(x, y, scale);
+    if (game->_scriptController)
+        game->_scriptController->gesturePinchEvent(x, y, scale);
 }
 
 void Platform::gestureTapEventInternal(int x, int y)
 {
+    FramePacer::notifyInput();
     // TODO: Add support to Form for gestures
-    Game::getInstance()->gestureTapEvent(x, y);
-    Game::getInstance()->getScriptController()->gestureTapEvent(x, y);
+    Game* game = Game::getInstance();
+    game->gestureTapEvent(x, y);
+    if (game->_scriptController)
+        game->_scriptController->gestureTapEvent(x, y);
 }
 
 void Platform::resizeEventInternal(unsigned int width, unsigned int height)
@@ -72,18 +93,21 @@ void Platform::resizeEventInternal(unsigned int width, unsigned int height)
         game->_width = width;
         game->_height = height;
         game->resizeEvent(width, height);
-        game->getScriptController()->resizeEvent(width, height);
+        if (game->_scriptController)
+            game->_scriptController->resizeEvent(width, height);
     }
 }
 
 void Platform::gamepadEventInternal(Gamepad::GamepadEvent evt, Gamepad* gamepad, unsigned int analogIndex)
 {
+    FramePacer::notifyInput();
 	switch(evt)
 	{
 	case Gamepad::CONNECTED_EVENT:
 	case Gamepad::DISCONNECTED_EVENT:
 		Game::getInstance()->gamepadEvent(evt, gamepad);
-        Game::getInstance()->getScriptController()->gamepadEvent(evt, gamepad);
+        if (Game::getInstance()->_scriptController)
+            Game::getInstance()->_scriptController->gamepadEvent(evt, gamepad);
 		break;
 	case Gamepad::BUTTON_EVENT:
 	case Gamepad::JOYSTICK_EVENT:
@@ -104,4 +128,14 @@ void Platform::gamepadEventDisconnectedInternal(GamepadHandle handle)
     Gamepad::remove(handle);
 }
 
+double Platform::getInputEventTime()
+{
+    return __inputEventTime >= 0.0 ? __inputEventTime : getAbsoluteTime();
+}
+
+void Platform::setInputEventTime(double time)
+{
+    __inputEventTime = time;
+}
+
 }
@@ -26,6 +26,7 @@ public:
     friend class Game;
     friend class Gamepad;
     friend class ScreenDisplayer;
+    friend class FramePacer;
 
     /**
      * Destructor.
@@ -106,6 +107,15 @@ private:
      */
     static void setAbsoluteTime(double time);
 
+    /**
+     * Gets the time at which the input event being handled occurred.
+     *
+     * Platforms that do not timestamp their input events return the current absolute time.
+     *
+     * @return The time of the input event, on the same clock as getAbsoluteTime. (in milliseconds)
+     */
+    static double getInputEventTime();
+
     /**
      * Gets whether vertical sync is enabled for the game display.
      * 
@@ -383,6 +393,16 @@ public:
      */
     static void shutdownInternal();
 
+    /**
+     * Internal method used only from static code in various platform implementation.
+     *
+     * Sets the time of the input events dispatched next, or a negative time to stop
+     * timestamping them.
+     *
+     * @script{ignore}
+     */
+    static void setInputEventTime(double time);
+
 private:
 
     Game* _game;                // The game this platform is interfacing with.
@@ -6,7 +6,9 @@
 #include "Game.h"
 #include "Form.h"
 #include "ScriptController.h"
+#include "FramePacer.h"
 #include <unistd.h>
+#include <dlfcn.h>
 #include <android/sensor.h>
 #include <android_native_app_glue.h>
 #include <android/log.h>
@@ -44,12 +46,33 @@ static bool __multiTouch = false;
 static int __primaryTouchId = -1;
 static bool __displayKeyboard = false;
 
+// Choreographer functions, loaded at runtime since they require API level 24.
+struct AChoreographer;
+typedef void (*AChoreographerFrameCallback)(long frameTimeNanos, void* data);
+typedef AChoreographer* (*PFNACHOREOGRAPHERGETINSTANCEPROC)();
+typedef void (*PFNACHOREOGRAPHERPOSTFRAMECALLBACKPROC)(AChoreographer* choreographer, AChoreographerFrameCallback callback, void* data);
+static AChoreographer* __choreographer = NULL;
+static PFNACHOREOGRAPHERPOSTFRAMECALLBACKPROC __choreographerPostFrameCallback = NULL;
+static bool __frameCallbackPosted = false;
+static bool __frameDue = false;
+static long __lastVsyncNanos = 0;
+static double __vsyncPeriod = 1000.0 / 60.0;
+static unsigned int __vsyncCount = 0;
+
 // OpenGL VAO functions.
 static const char* __glExtensions;
 PFNGLBINDVERTEXARRAYOESPROC glBindVertexArray = NULL;
 PFNGLDELETEVERTEXARRAYSOESPROC glDeleteVertexArrays = NULL;
 PFNGLGENVERTEXARRAYSOESPROC glGenVertexArrays = NULL;
 PFNGLISVERTEXARRAYOESPROC glIsVertexArray = NULL;
+PFNGLGETPROGRAMBINARYOESPROC glGetProgramBinary = NULL;
+PFNGLPROGRAMBINARYOESPROC glProgramBinary = NULL;
+PFNGLGENQUERIESEXTPROC glGenQueries = NULL;
+PFNGLDELETEQUERIESEXTPROC glDeleteQueries = NULL;
+PFNGLQUERYCOUNTEREXTPROC glQueryCounter = NULL;
+PFNGLGETQUERYOBJECTUIVEXTPROC glGetQueryObjectuiv = NULL;
+PFNGLGETQUERYOBJECTUI64VEXTPROC glGetQueryObjectui64v = NULL;
+PFNGLDISCARDFRAMEBUFFEREXTPROC glDiscardFramebuffer = NULL;
 
 #define GESTURE_TAP_DURATION_MAX    200
 #define GESTURE_SWIPE_DURATION_MAX  400
@@ -312,6 +335,26 @@ static bool initEGL()
         glGenVertexArrays = (PFNGLGENVERTEXARRAYSOESPROC)eglGetProcAddress("glGenVertexArraysOES");
         glIsVertexArray = (PFNGLISVERTEXARRAYOESPROC)eglGetProcAddress("glIsVertexArrayOES");
     }
+
+    if (strstr(__glExtensions, "GL_OES_get_program_binary"))
+    {
+        glGetProgramBinary = (PFNGLGETPROGRAMBINARYOESPROC)eglGetProcAddress("glGetProgramBinaryOES");
+        glProgramBinary = (PFNGLPROGRAMBINARYOESPROC)eglGetProcAddress("glProgramBinaryOES");
+    }
+
+    if (strstr(__glExtensions, "GL_EXT_disjoint_timer_query"))
+    {
+        glGenQueries = (PFNGLGENQUERIESEXTPROC)eglGetProcAddress("glGenQueriesEXT");
+        glDeleteQueries = (PFNGLDELETEQUERIESEXTPROC)eglGetProcAddress("glDeleteQueriesEXT");
+        glQueryCounter = (PFNGLQUERYCOUNTEREXTPROC)eglGetProcAddress("glQueryCounterEXT");
+        glGetQueryObjectuiv = (PFNGLGETQUERYOBJECTUIVEXTPROC)eglGetProcAddress("glGetQueryObjectuivEXT");
+        glGetQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VEXTPROC)eglGetProcAddress("glGetQueryObjectui64vEXT");
+    }
+
+    if (strstr(__glExtensions, "GL_EXT_discard_framebuffer"))
+    {
+        glDiscardFramebuffer = (PFNGLDISCARDFRAMEBUFFEREXTPROC)eglGetProcAddress("glDiscardFramebufferEXT");
+    }
     
     return true;
     
@@ -961,6 +1004,44 @@ static void engine_handle_cmd(struct android_app* app, int32_t cmd)
     }
 }
 
+static void choreographerFrameCallback(long frameTimeNanos, void* data)
+{
+    __frameCallbackPosted = false;
+
+    // Measure the refresh period of the display, which is not always 60 Hz.
+    if (__lastVsyncNanos != 0 && frameTimeNanos > __lastVsyncNanos)
+    {
+        double period = (double)(frameTimeNanos - __lastVsyncNanos) / 1000000.0;
+        if (period < __vsyncPeriod * 1.5)
+            __vsyncPeriod = __vsyncPeriod * 0.9 + period * 0.1;
+    }
+    __lastVsyncNanos = frameTimeNanos;
+
+    // Run a frame on every interval of refreshes that matches the frame rate.
+    unsigned int displayRate = (unsigned int)(1000.0 / __vsyncPeriod + 0.5);
+    if (++__vsyncCount >= FramePacer::getSyncInterval(displayRate))
+    {
+        __vsyncCount = 0;
+        __frameDue = true;
+    }
+}
+
+static void initChoreographer()
+{
+    // The frame callbacks are delivered through the looper of this thread.
+    void* library = dlopen("libandroid.so", RTLD_NOW | RTLD_LOCAL);
+    if (library == NULL)
+        return;
+
+    PFNACHOREOGRAPHERGETINSTANCEPROC getInstance = (PFNACHOREOGRAPHERGETINSTANCEPROC)dlsym(library, "AChoreographer_getInstance");
+    __choreographerPostFrameCallback = (PFNACHOREOGRAPHERPOSTFRAMECALLBACKPROC)dlsym(library, "AChoreographer_postFrameCallback");
+    if (getInstance && __choreographerPostFrameCallback)
+    {
+        __choreographer = getInstance();
+    }
+    FramePacer::setDisplayPaced(__choreographer != NULL);
+}
+
 Platform::Platform(Game* game)
     : _game(game)
 {
@@ -1043,14 +1124,24 @@ int Platform::enterMessagePump()
     __timeStart = timespec2millis(&__timespec);
     __timeAbsolute = 0L;
     
+    initChoreographer();
+
     while (true)
     {
+        // Wait for the next vertical sync callback that a frame is due on.
+        bool waitForFrame = __choreographer && __initialized && !__suspended;
+        if (waitForFrame && !__frameCallbackPosted && !__frameDue)
+        {
+            __choreographerPostFrameCallback(__choreographer, choreographerFrameCallback, NULL);
+            __frameCallbackPosted = true;
+        }
+
         // Read all pending events.
         int ident;
         int events;
         struct android_poll_source* source;
         
-        while ((ident=ALooper_pollAll(!__suspended ? 0 : -1, NULL, &events, (void**)&source)) >= 0) 
+        while ((ident=ALooper_pollAll(__suspended || (waitForFrame && !__frameDue) ? -1 : 0, NULL, &events, (void**)&source)) >= 0) 
         {
             // Process this event.
             if (source != NULL)
@@ -1082,8 +1173,9 @@ int Platform::enterMessagePump()
         
         // Idle time (no events left to process) is spent rendering.
         // We skip rendering when the app is paused.
-        if (__initialized && !__suspended)
+        if (__initialized && !__suspended && (!__choreographer || __frameDue))
         {
+            __frameDue = false;
             _game->frame();
 
             // Post the new frame to the display.
@@ -6,6 +6,8 @@
 #include "Game.h"
 #include "Form.h"
 #include "ScriptController.h"
+#include "Mutex.h"
+#include "PerformanceReport.h"
 
 #include <X11/X.h>
 #include <X11/Xlib.h>
@@ -18,6 +20,8 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <pthread.h>
+#include <dlfcn.h>
 #include <fstream>
 
 #define TOUCH_COUNT_MAX     4
@@ -79,6 +83,8 @@ struct ConnectedGamepadDevInfo
 struct timespec __timespec;
 static double __timeStart;
 static double __timeAbsolute;
+static double __eventTimeOffset;                // The absolute time minus the X server time of input events.
+static bool __eventTimeOffsetValid = false;
 static bool __vsync = WINDOW_VSYNC;
 static bool __mouseCaptured = false;
 static float __mouseCapturePointX = 0;
@@ -92,6 +98,63 @@ static GLXContext __context;
 static Window __attachToWindow;
 static Atom __atomWmDeleteWindow;
 static list<ConnectedGamepadDevInfo> __connectedGamepads;
+static vector<gameplay::GamepadHandle> __disconnectedGamepads;   // Gamepads found disconnected on the input thread.
+static gameplay::Mutex __disconnectedGamepadsMutex;
+
+// The parts of EGL used by the headless mode. libEGL is loaded when the headless mode is
+// used, so the engine neither needs the EGL headers to build nor links to EGL.
+typedef void* EGLDisplay;
+typedef void* EGLConfig;
+typedef void* EGLSurface;
+typedef void* EGLContext;
+typedef int EGLint;
+typedef unsigned int EGLBoolean;
+typedef unsigned int EGLenum;
+
+#define EGL_NONE                        0x3038
+#define EGL_ALPHA_SIZE                  0x3021
+#define EGL_BLUE_SIZE                   0x3022
+#define EGL_GREEN_SIZE                  0x3023
+#define EGL_RED_SIZE                    0x3024
+#define EGL_DEPTH_SIZE                  0x3025
+#define EGL_STENCIL_SIZE                0x3026
+#define EGL_SURFACE_TYPE                0x3033
+#define EGL_RENDERABLE_TYPE             0x3040
+#define EGL_EXTENSIONS                  0x3055
+#define EGL_HEIGHT                      0x3056
+#define EGL_WIDTH                       0x3057
+#define EGL_OPENGL_API                  0x30A2
+#define EGL_PLATFORM_SURFACELESS_MESA   0x31DD
+#define EGL_PBUFFER_BIT                 0x0001
+#define EGL_OPENGL_BIT                  0x0008
+
+struct EGLFunctions
+{
+    EGLDisplay (*getDisplay)(void* nativeDisplay);
+    EGLDisplay (*getPlatformDisplayEXT)(EGLenum platform, void* nativeDisplay, const EGLint* attribs);
+    EGLBoolean (*initialize)(EGLDisplay display, EGLint* major, EGLint* minor);
+    const char* (*queryString)(EGLDisplay display, EGLint name);
+    EGLBoolean (*bindAPI)(EGLenum api);
+    EGLBoolean (*chooseConfig)(EGLDisplay display, const EGLint* attribs, EGLConfig* configs, EGLint size, EGLint* count);
+    EGLSurface (*createPbufferSurface)(EGLDisplay display, EGLConfig config, const EGLint* attribs);
+    EGLContext (*createContext)(EGLDisplay display, EGLConfig config, EGLContext share, const EGLint* attribs);
+    EGLBoolean (*makeCurrent)(EGLDisplay display, EGLSurface draw, EGLSurface read, EGLContext context);
+    EGLBoolean (*destroySurface)(EGLDisplay display, EGLSurface surface);
+    EGLBoolean (*destroyContext)(EGLDisplay display, EGLContext context);
+    EGLBoolean (*terminate)(EGLDisplay display);
+    void* (*getProcAddress)(const char* name);
+};
+
+static bool __headless = false;                 // Whether the game runs in an offscreen context, without a window.
+static bool __headlessNull = false;             // Whether the driver discards the rendering, so only the CPU is measured.
+static unsigned int __headlessFrameCount = 600;
+static string __headlessReportPath = "perf.json";
+static gameplay::PerformanceReport* __headlessReport = NULL;
+static void* __eglLibrary = NULL;
+static EGLFunctions __egl;
+static EGLDisplay __eglDisplay = NULL;
+static EGLSurface __eglSurface = NULL;
+static EGLContext __eglContext = NULL;
 
 
 // Gets the gameplay::Keyboard::Key enumeration constant that corresponds to the given X11 key symbol.
@@ -551,6 +614,186 @@ namespace gameplay
     {
     }
 
+    // Reads the settings of the headless mode from the headless namespace of game.config. The command
+    // line overrides them with --headless, --headless=null, --frames=<count>, --frame-time=<ms> and --report=<path>.
+    static void readHeadlessSettings(Game* game)
+    {
+        if (game->getConfig())
+        {
+            Properties* config = game->getConfig()->getNamespace("headless", true);
+            if (config)
+            {
+                __headless = config->getBool("enabled");
+                const char* context = config->getString("context");
+                __headlessNull = context && strcmp(context, "null") == 0;
+                if (config->exists("frames"))
+                    __headlessFrameCount = (unsigned int)config->getInt("frames");
+                if (config->exists("frameTime"))
+                    game->setFixedFrameTime(config->getFloat("frameTime"));
+                if (config->exists("report"))
+                    __headlessReportPath = config->getString("report");
+            }
+        }
+
+        for (int i = 1; i < __argc; ++i)
+        {
+            const char* arg = __argv[i];
+            if (strcmp(arg, "--headless") == 0)
+            {
+                __headless = true;
+            }
+            else if (strncmp(arg, "--headless=", 11) == 0)
+            {
+                __headless = true;
+                __headlessNull = strcmp(arg + 11, "null") == 0;
+            }
+            else if (strncmp(arg, "--frames=", 9) == 0)
+            {
+                __headlessFrameCount = (unsigned int)atoi(arg + 9);
+            }
+            else if (strncmp(arg, "--frame-time=", 13) == 0)
+            {
+                game->setFixedFrameTime((float)atof(arg + 13));
+            }
+            else if (strncmp(arg, "--report=", 9) == 0)
+            {
+                __headlessReportPath = arg + 9;
+            }
+        }
+    }
+
+    // Creates an offscreen OpenGL context with EGL, on the surfaceless platform of Mesa when it is
+    // available, so the game runs without a display server.
+    static bool createHeadlessContext(int width, int height)
+    {
+        if (__headlessNull)
+        {
+            // Use Mesa's software rasterizer behind its no-op driver, which discards all rendering,
+            // so no GPU is needed and only the work of the engine is measured. Variables that are
+            // already set in the environment take precedence.
+            setenv("LIBGL_ALWAYS_SOFTWARE", "1", 0);
+            setenv("GALLIUM_NOOP", "1", 0);
+        }
+
+        __eglLibrary = dlopen("libEGL.so.1", RTLD_NOW | RTLD_GLOBAL);
+        if (!__eglLibrary)
+        {
+            GP_WARN("Failed to load libEGL for the headless mode: %s", dlerror());
+            return false;
+        }
+
+        struct { void** function; const char* name; } functions[] =
+        {
+            { (void**)&__egl.getDisplay, "eglGetDisplay" },
+            { (void**)&__egl.initialize, "eglInitialize" },
+            { (void**)&__egl.queryString, "eglQueryString" },
+            { (void**)&__egl.bindAPI, "eglBindAPI" },
+            { (void**)&__egl.chooseConfig, "eglChooseConfig" },
+            { (void**)&__egl.createPbufferSurface, "eglCreatePbufferSurface" },
+            { (void**)&__egl.createContext, "eglCreateContext" },
+            { (void**)&__egl.makeCurrent, "eglMakeCurrent" },
+            { (void**)&__egl.destroySurface, "eglDestroySurface" },
+            { (void**)&__egl.destroyContext, "eglDestroyContext" },
+            { (void**)&__egl.terminate, "eglTerminate" },
+            { (void**)&__egl.getProcAddress, "eglGetProcAddress" }
+        };
+        for (unsigned int i = 0; i < sizeof(functions) / sizeof(functions[0]); ++i)
+        {
+            *functions[i].function = dlsym(__eglLibrary, functions[i].name);
+            if (*functions[i].function == NULL)
+            {
+                GP_WARN("Failed to find %s in libEGL.", functions[i].name);
+                return false;
+            }
+        }
+
+        const char* clientExtensions = __egl.queryString(NULL, EGL_EXTENSIONS);
+        if (clientExtensions && strstr(clientExtensions, "EGL_MESA_platform_surfaceless"))
+        {
+            *(void**)&__egl.getPlatformDisplayEXT = __egl.getProcAddress("eglGetPlatformDisplayEXT");
+            if (__egl.getPlatformDisplayEXT)
+                __eglDisplay = __egl.getPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, NULL, NULL);
+        }
+        if (__eglDisplay == NULL)
+            __eglDisplay = __egl.getDisplay(NULL);
+
+        EGLint majorEGL = 0, minorEGL = 0;
+        if (__eglDisplay == NULL || !__egl.initialize(__eglDisplay, &majorEGL, &minorEGL))
+        {
+            GP_WARN("Failed to initialize an EGL display.");
+            return false;
+        }
+        printf("EGL version: %d.%d\n", majorEGL, minorEGL);
+
+        if (!__egl.bindAPI(EGL_OPENGL_API))
+        {
+            GP_WARN("Failed to bind the OpenGL API with EGL.");
+            return false;
+        }
+
+        // Prefer a pbuffer the size of the window, so the default framebuffer exists. Without one,
+        // the context is made current without a surface (EGL_KHR_surfaceless_context).
+        EGLint configAttribs[] =
+        {
+            EGL_SURFACE_TYPE,       EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE,    EGL_OPENGL_BIT,
+            EGL_RED_SIZE,           8,
+            EGL_GREEN_SIZE,         8,
+            EGL_BLUE_SIZE,          8,
+            EGL_DEPTH_SIZE,         24,
+            EGL_STENCIL_SIZE,       8,
+            EGL_NONE
+        };
+        EGLConfig config = NULL;
+        EGLint configCount = 0;
+        if (__egl.chooseConfig(__eglDisplay, configAttribs, &config, 1, &configCount) && configCount > 0)
+        {
+            EGLint surfaceAttribs[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+            __eglSurface = __egl.createPbufferSurface(__eglDisplay, config, surfaceAttribs);
+        }
+        else
+        {
+            configAttribs[1] = 0;
+            if (!__egl.chooseConfig(__eglDisplay, configAttribs, &config, 1, &configCount) || configCount == 0)
+            {
+                GP_WARN("Failed to find an EGL config for OpenGL.");
+                return false;
+            }
+        }
+        if (__eglSurface == NULL)
+            GP_WARN("Running headless without a pbuffer; the default framebuffer is not available.");
+
+        __eglContext = __egl.createContext(__eglDisplay, config, NULL, NULL);
+        if (__eglContext == NULL || !__egl.makeCurrent(__eglDisplay, __eglSurface, __eglSurface, __eglContext))
+        {
+            GP_WARN("Failed to create the headless OpenGL context.");
+            return false;
+        }
+
+        // Only the OpenGL entry points are loaded, since there is no GLX display.
+        glewExperimental = GL_TRUE;
+        if (glewContextInit() != GLEW_OK)
+        {
+            perror("glewContextInit");
+            return false;
+        }
+        return true;
+    }
+
+    static void cleanupHeadless()
+    {
+        if (__eglDisplay)
+        {
+            __egl.makeCurrent(__eglDisplay, NULL, NULL, NULL);
+            if (__eglContext)
+                __egl.destroyContext(__eglDisplay, __eglContext);
+            if (__eglSurface)
+                __egl.destroySurface(__eglDisplay, __eglSurface);
+            __egl.terminate(__eglDisplay);
+            __eglDisplay = NULL;
+        }
+    }
+
     Platform* Platform::create(Game* game, void* attachToWindow)
     {
 
@@ -560,6 +803,29 @@ namespace gameplay
         FileSystem::setResourcePath("./");
         Platform* platform = new Platform(game);
 
+        readHeadlessSettings(game);
+        if (__headless)
+        {
+            __windowSize[0] = 1280;
+            __windowSize[1] = 800;
+            Properties* config = game->getConfig() ? game->getConfig()->getNamespace("window", true) : NULL;
+            if (config)
+            {
+                if (config->getInt("width") != 0)
+                    __windowSize[0] = config->getInt("width");
+                if (config->getInt("height") != 0)
+                    __windowSize[1] = config->getInt("height");
+            }
+
+            if (!createHeadlessContext(__windowSize[0], __windowSize[1]))
+            {
+                cleanupHeadless();
+                return NULL;
+            }
+            printf("Running headless (%s) for %u frames.\n", __headlessNull ? "null" : "egl", __headlessFrameCount);
+            return platform;
+        }
+
         // Get the display and initialize
         __display = XOpenDisplay(NULL);
         if (__display == NULL)
@@ -755,6 +1021,23 @@ namespace gameplay
         return (1000.0 * a->tv_sec) + (0.000001 * a->tv_nsec);
     }
 
+    // Converts the X server time of an input event to absolute time.
+    double getEventTime(Time time)
+    {
+        // The events are received after they occur, so the smallest difference between the time
+        // they are received and their server time is the best estimate of the offset between the clocks.
+        clock_gettime(CLOCK_REALTIME, &__timespec);
+        double offset = timespec2millis(&__timespec) - __timeStart - (double)time;
+
+        // The offset is estimated again when the clocks jump, such as when the server time wraps.
+        if (!__eventTimeOffsetValid || offset < __eventTimeOffset || offset - __eventTimeOffset > 1000.0)
+        {
+            __eventTimeOffset = offset;
+            __eventTimeOffsetValid = true;
+        }
+        return (double)time + __eventTimeOffset;
+    }
+
     void updateWindowSize()
     {
         GP_ASSERT(__display);
@@ -766,6 +1049,48 @@ namespace gameplay
     }
 
 
+    // Writes the report of the frames run in the headless mode. It is also called at exit, since
+    // Game::exit ends the process when the game exits before all the frames are run.
+    static void writeHeadlessReport()
+    {
+        if (__headlessReport)
+        {
+            if (__headlessReport->write(__headlessReportPath.c_str(), __headlessNull ? "null" : "egl"))
+                printf("Wrote the report of %u frames to %s.\n", __headlessReport->getFrameCount(), __headlessReportPath.c_str());
+            SAFE_DELETE(__headlessReport);
+        }
+    }
+
+    // Runs the frames of the headless mode, without a window or events, and writes the report.
+    static int runHeadless(Game* game)
+    {
+        clock_gettime(CLOCK_REALTIME, &__timespec);
+        __timeStart = timespec2millis(&__timespec);
+        __timeAbsolute = 0L;
+
+        game->run();
+
+        // The first frame initializes the game, which is not measured.
+        game->frame();
+
+        __headlessReport = new PerformanceReport();
+        __headlessReport->begin();
+        atexit(writeHeadlessReport);
+        for (unsigned int i = 0; i < __headlessFrameCount && game->getState() != Game::UNINITIALIZED; ++i)
+        {
+            double start = Platform::getAbsoluteTime();
+            game->frame();
+
+            // Wait for the frame to be drawn, since there is no swap to pace the frames.
+            glFinish();
+            __headlessReport->addFrame(Platform::getAbsoluteTime() - start);
+        }
+        writeHeadlessReport();
+        cleanupHeadless();
+
+        return 0;
+    }
+
     //Will need to be dynamic, also should be handled in Gamepad class
     static const GamepadInfoEntry gamepadLookupTable[] = 
     {
@@ -1102,6 +1427,19 @@ namespace gameplay
 
     void gamepadHandlingLoop()
     {
+        // Gamepads disconnected on the input thread are removed here, since the connected
+        // gamepads are only changed on the main thread. The gamepad is removed before its
+        // device is closed, so the input thread no longer polls it.
+        __disconnectedGamepadsMutex.lock();
+        vector<gameplay::GamepadHandle> disconnected;
+        disconnected.swap(__disconnectedGamepads);
+        __disconnectedGamepadsMutex.unlock();
+        for (size_t i = 0; i < disconnected.size(); ++i)
+        {
+            gameplay::Platform::gamepadEventDisconnectedInternal(disconnected[i]);
+            unregisterGamepad(disconnected[i]);
+        }
+
         enumGamepads();
     }
 
@@ -1109,6 +1447,9 @@ namespace gameplay
     {
         GP_ASSERT(_game);
 
+        if (__headless)
+            return runHeadless(_game);
+
         updateWindowSize();
 
         static bool shiftDown = false;
@@ -1165,6 +1506,7 @@ namespace gameplay
 
                     case KeyPress:
                         {
+                            gameplay::Platform::setInputEventTime(getEventTime(evt.xkey.time));
                             KeySym sym = XLookupKeysym(&evt.xkey, (evt.xkey.state & shiftDown) ? 1 : 0);
 
 
@@ -1203,6 +1545,7 @@ namespace gameplay
                                 }
                             }
 
+                            gameplay::Platform::setInputEventTime(getEventTime(evt.xkey.time));
                             KeySym sym = XLookupKeysym(&evt.xkey, 0);
                             Keyboard::Key key = getKey(sym);
                             gameplay::Platform::keyEventInternal(gameplay::Keyboard::KEY_RELEASE, key);
@@ -1214,6 +1557,7 @@ namespace gameplay
 
                     case ButtonPress:
                         {
+                            gameplay::Platform::setInputEventTime(getEventTime(evt.xbutton.time));
                             gameplay::Mouse::MouseEvent mouseEvt;
                             switch (evt.xbutton.button)
                             {
@@ -1244,6 +1588,7 @@ namespace gameplay
 
                     case ButtonRelease:
                         {
+                            gameplay::Platform::setInputEventTime(getEventTime(evt.xbutton.time));
                             gameplay::Mouse::MouseEvent mouseEvt;
                             switch (evt.xbutton.button)
                             {
@@ -1268,6 +1613,21 @@ namespace gameplay
 
                     case MotionNotify:
                         {
+                            if (!__mouseCaptured)
+                            {
+                                // Only the last of consecutive motions with the same buttons down is dispatched.
+                                // Captured motions are not coalesced since each one is relative to the capture point.
+                                XEvent next;
+                                while (XPending(__display))
+                                {
+                                    XPeekEvent(__display, &next);
+                                    if (next.type != MotionNotify || next.xmotion.state != evt.xmotion.state)
+                                        break;
+                                    XNextEvent(__display, &evt);
+                                }
+                            }
+
+                            gameplay::Platform::setInputEventTime(getEventTime(evt.xmotion.time));
                             int x = evt.xmotion.x;
                             int y = evt.xmotion.y;
 
@@ -1302,6 +1662,7 @@ namespace gameplay
                         break;
                 }
             }
+            gameplay::Platform::setInputEventTime(-1.0);
 
             gamepadHandlingLoop();
 
@@ -1363,6 +1724,12 @@ namespace gameplay
 
     void Platform::setVsync(bool enable)
     {
+        if (__headless)
+        {
+            __vsync = enable;
+            return;
+        }
+
         if (glXSwapIntervalEXT)
             glXSwapIntervalEXT(__display, __window, __vsync ? 1 : 0);
         else if(glXSwapIntervalMESA)
@@ -1373,6 +1740,9 @@ namespace gameplay
 
     void Platform::swapBuffers()
     {
+        if (__headless)
+            return;
+
         glXSwapBuffers(__display, __window);
     }
 
@@ -1470,7 +1840,7 @@ namespace gameplay
 
     void Platform::setMouseCaptured(bool captured)
     {
-        if (captured != __mouseCaptured)
+        if (captured != __mouseCaptured && !__headless)
         {
             if (captured)
             {
@@ -1499,7 +1869,7 @@ namespace gameplay
 
     void Platform::setCursorVisible(bool visible)
     {
-        if (visible != __cursorVisible)
+        if (visible != __cursorVisible && !__headless)
         {
             if (!visible)
             {
@@ -1640,8 +2010,19 @@ namespace gameplay
         }
         if(errno == ENODEV)
         {
-            unregisterGamepad(gamepad->_handle);
-            gamepadEventDisconnectedInternal(gamepad->_handle);
+            // With a polling frequency this runs on the input thread.
+            if (Gamepad::getPollingFrequency() == 0)
+            {
+                unregisterGamepad(gamepad->_handle);
+                gamepadEventDisconnectedInternal(gamepad->_handle);
+            }
+            else
+            {
+                __disconnectedGamepadsMutex.lock();
+                if (find(__disconnectedGamepads.begin(), __disconnectedGamepads.end(), gamepad->_handle) == __disconnectedGamepads.end())
+                    __disconnectedGamepads.push_back(gamepad->_handle);
+                __disconnectedGamepadsMutex.unlock();
+            }
         }
 
     }
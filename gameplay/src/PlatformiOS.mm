@@ -1,11 +1,13 @@
 #ifdef __APPLE__
 
 #include "Base.h"
+#include "GLStateCache.h"
 #include "Platform.h"
 #include "FileSystem.h"
 #include "Game.h"
 #include "Form.h"
 #include "ScriptController.h"
+#include "FramePacer.h"
 #include <unistd.h>
 #import <UIKit/UIKit.h>
 #import <QuartzCore/QuartzCore.h>
@@ -322,6 +324,9 @@ int getUnicode(int key);
     // and set this bound buffer as the default one during initialization.
     if (multisampleFramebuffer)
         GL_ASSERT( glBindFramebuffer(GL_FRAMEBUFFER, multisampleFramebuffer) );
+
+    // The frame and render buffers were bound directly.
+    GLStateCache::invalidate();
     
     return YES;
 }
@@ -415,6 +420,9 @@ int getUnicode(int key);
         // Present the color buffer
         GL_ASSERT( glBindRenderbuffer(GL_RENDERBUFFER, colorRenderbuffer) );
         [context presentRenderbuffer:GL_RENDERBUFFER];
+
+        // The frame and render buffers were bound directly.
+        GLStateCache::invalidate();
     }
 }
 
@@ -432,6 +440,7 @@ int getUnicode(int key);
 {
     if (!updating)
     {
+        FramePacer::setDisplayPaced(true);
         displayLink = [CADisplayLink displayLinkWithTarget:self selector:@selector(update:)];
         [displayLink setFrameInterval:swapInterval];
         [displayLink addToRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
@@ -490,6 +499,13 @@ int getUnicode(int key);
         
         // Present the contents of the color buffer
         [self swapBuffers];
+
+        // Skip display refreshes to run at the rate of the frame pacer.
+        NSInteger interval = FramePacer::getSyncInterval(60) * swapInterval;
+        if (displayLink && [displayLink frameInterval] != interval)
+        {
+            [displayLink setFrameInterval:interval];
+        }
     }
 }
 
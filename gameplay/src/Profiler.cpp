@@ -0,0 +1,177 @@
+#include "Base.h"
+#include "Profiler.h"
+#include "Game.h"
+#include "FileSystem.h"
+
+// The default number of scopes kept in the buffer.
+#define PROFILER_DEFAULT_CAPACITY 65536
+
+namespace gameplay
+{
+
+/**
+ * A scope that ended, stored in the buffer.
+ */
+struct ProfilerEvent
+{
+    const char* name;
+    double start;
+    double duration;
+    unsigned int depth;
+};
+
+/**
+ * A scope that has begun and not ended yet.
+ */
+struct ProfilerOpenScope
+{
+    const char* name;
+    double start;
+};
+
+bool Profiler::_enabled = false;
+static std::vector<ProfilerEvent> __events;
+static unsigned int __capacity = PROFILER_DEFAULT_CAPACITY;
+static unsigned int __next = 0;
+static unsigned int __count = 0;
+static std::vector<ProfilerOpenScope> __openScopes;
+
+static bool isMainThread()
+{
+    // Before the job controller is initialized, only the main thread runs.
+    return JobController::isMainThread();
+}
+
+static void writeString(Stream* stream, const char* str)
+{
+    stream->write(str, 1, strlen(str));
+}
+
+static void writeEscaped(Stream* stream, const char* str)
+{
+    for (const char* c = str; *c; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+            stream->write("\\", 1, 1);
+        if ((unsigned char)*c >= 0x20)
+            stream->write(c, 1, 1);
+    }
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+    _enabled = enabled;
+}
+
+bool Profiler::isEnabled()
+{
+    return _enabled;
+}
+
+void Profiler::setCapacity(unsigned int capacity)
+{
+    __capacity = capacity > 0 ? capacity : 1;
+    clear();
+    std::vector<ProfilerEvent>().swap(__events);
+}
+
+unsigned int Profiler::getCapacity()
+{
+    return __capacity;
+}
+
+unsigned int Profiler::getEventCount()
+{
+    return __count;
+}
+
+void Profiler::clear()
+{
+    __next = 0;
+    __count = 0;
+}
+
+void Profiler::begin(const char* name)
+{
+    if (!_enabled || !isMainThread())
+        return;
+
+    ProfilerOpenScope scope;
+    scope.name = name;
+    scope.start = Game::getAbsoluteTime();
+    __openScopes.push_back(scope);
+}
+
+void Profiler::end()
+{
+    if (__openScopes.empty() || !isMainThread())
+        return;
+
+    const ProfilerOpenScope& scope = __openScopes.back();
+    if (__events.size() < __capacity)
+        __events.resize(__capacity);
+
+    ProfilerEvent& e = __events[__next];
+    e.name = scope.name;
+    e.start = scope.start;
+    e.duration = Game::getAbsoluteTime() - scope.start;
+    e.depth = __openScopes.size() - 1;
+    __openScopes.pop_back();
+
+    __next = (__next + 1) % __capacity;
+    if (__count < __capacity)
+        ++__count;
+}
+
+double Profiler::getTotalTime(const char* name, unsigned int* count)
+{
+    GP_ASSERT(name);
+
+    double total = 0.0;
+    unsigned int matches = 0;
+    for (unsigned int i = 0; i < __count; ++i)
+    {
+        const ProfilerEvent& e = __events[i];
+        if (e.name == name || strcmp(e.name, name) == 0)
+        {
+            total += e.duration;
+            ++matches;
+        }
+    }
+    if (count)
+        *count = matches;
+    return total;
+}
+
+bool Profiler::writeTrace(const char* path)
+{
+    GP_ASSERT(path);
+
+    Stream* stream = FileSystem::open(path, FileSystem::WRITE);
+    if (stream == NULL)
+    {
+        GP_WARN("Failed to open trace file '%s' for writing.", path);
+        return false;
+    }
+
+    // Complete events, in the order they ended, with times in microseconds.
+    char buffer[128];
+    writeString(stream, "{\"traceEvents\":[\n");
+    unsigned int first = (__next + __capacity - __count) % __capacity;
+    for (unsigned int i = 0; i < __count; ++i)
+    {
+        const ProfilerEvent& e = __events[(first + i) % __capacity];
+        writeString(stream, i > 0 ? ",\n{\"name\":\"" : "{\"name\":\"");
+        writeEscaped(stream, e.name);
+        sprintf(buffer, "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":0,\"args\":{\"depth\":%u}}",
+            e.start * 1000.0, e.duration * 1000.0, e.depth);
+        writeString(stream, buffer);
+    }
+    writeString(stream, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+    stream->close();
+    SAFE_DELETE(stream);
+    return true;
+}
+
+}
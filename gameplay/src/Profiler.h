@@ -0,0 +1,162 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+namespace gameplay
+{
+
+/**
+ * Defines a profiler that records the CPU time of named scopes of the main thread.
+ *
+ * Scopes are recorded with the GP_PROFILE macro, which measures the rest of the enclosing
+ * block. The engine records the stages of Game::frame, the compilation of effects and the
+ * phases of loading: file reads, parsing properties, bundles and scene files, meshes and
+ * their buffer uploads, materials, image decoding, texture uploads and physics shapes.
+ * Each scope is stored as it ends, with its start time, duration and nesting depth, in a
+ * ring buffer that keeps the most recent scopes. The buffer can be written at any time as
+ * a trace in the Chrome trace_event JSON format, which can be opened in chrome://tracing.
+ *
+ * The profiler is disabled by default, and a disabled scope only tests a flag, so the
+ * scopes can remain in release builds. Defining GP_NO_PROFILING removes them entirely.
+ * Scopes on threads other than the main thread are ignored.
+ *
+ @verbatim
+    Profiler::setEnabled(true);
+    // ... run the frames to examine ...
+    Profiler::writeTrace("trace.json");
+ @endverbatim
+ *
+ * @script{ignore}
+ */
+class Profiler
+{
+public:
+
+    /**
+     * Defines a scope that is recorded from its construction to its destruction.
+     */
+    class Scope
+    {
+    public:
+
+        /**
+         * Begins a scope, if the profiler is enabled.
+         *
+         * @param name The name of the scope, which must remain valid while the scope is in
+         *      the buffer, such as a string literal.
+         */
+        inline Scope(const char* name);
+
+        /**
+         * Ends the scope.
+         */
+        inline ~Scope();
+
+    private:
+
+        Scope(const Scope&);
+        Scope& operator=(const Scope&);
+
+        bool _active;
+    };
+
+    friend class Scope;
+
+    /**
+     * Sets whether scopes are recorded.
+     *
+     * @param enabled True to record scopes.
+     */
+    static void setEnabled(bool enabled);
+
+    /**
+     * Determines whether scopes are recorded.
+     *
+     * @return True if the profiler is enabled.
+     */
+    static bool isEnabled();
+
+    /**
+     * Sets the number of scopes kept in the buffer. The buffer is cleared.
+     *
+     * @param capacity The number of scopes. The default is 65536.
+     */
+    static void setCapacity(unsigned int capacity);
+
+    /**
+     * Returns the number of scopes kept in the buffer.
+     *
+     * @return The number of scopes.
+     */
+    static unsigned int getCapacity();
+
+    /**
+     * Returns the number of scopes in the buffer.
+     *
+     * @return The number of recorded scopes, up to the capacity.
+     */
+    static unsigned int getEventCount();
+
+    /**
+     * Removes the recorded scopes from the buffer.
+     */
+    static void clear();
+
+    /**
+     * Begins a scope, which is ended by the next call to end().
+     *
+     * @param name The name of the scope, which must remain valid while the scope is in
+     *      the buffer, such as a string literal.
+     */
+    static void begin(const char* name);
+
+    /**
+     * Ends the scope begun by the last call to begin(), and stores it in the buffer.
+     */
+    static void end();
+
+    /**
+     * Returns the total time of the recorded scopes with the specified name.
+     *
+     * This summarizes the scopes in the buffer without writing a trace, e.g. to report
+     * the time spent in each stage of Game::frame over a run of frames.
+     *
+     * @param name The name of the scopes.
+     * @param count Receives the number of scopes with the name, if not NULL.
+     *
+     * @return The total duration of the scopes, in milliseconds.
+     */
+    static double getTotalTime(const char* name, unsigned int* count = NULL);
+
+    /**
+     * Writes the recorded scopes to a file in the Chrome trace_event JSON format.
+     *
+     * @param path The path of the file to write.
+     *
+     * @return True if the file was written, false otherwise.
+     */
+    static bool writeTrace(const char* path);
+
+private:
+
+    /**
+     * Hidden constructor.
+     */
+    Profiler();
+
+    static bool _enabled;
+};
+
+}
+
+#include "Profiler.inl"
+
+#ifdef GP_NO_PROFILING
+#define GP_PROFILE(name)
+#else
+/**
+ * Records the CPU time of the rest of the enclosing block as a scope of the Profiler.
+ */
+#define GP_PROFILE(name) gameplay::Profiler::Scope __profilerScope(name)
+#endif
+
+#endif
@@ -0,0 +1,18 @@
+#include "Profiler.h"
+
+namespace gameplay
+{
+
+inline Profiler::Scope::Scope(const char* name) : _active(Profiler::_enabled)
+{
+    if (_active)
+        Profiler::begin(name);
+}
+
+inline Profiler::Scope::~Scope()
+{
+    if (_active)
+        Profiler::end();
+}
+
+}
@@ -1,22 +1,123 @@
 #include "Base.h"
+#include "Profiler.h"
 #include "Properties.h"
+#include "StringId.h"
 #include "FileSystem.h"
 #include "Quaternion.h"
 
+// The identifier and version at the start of binary properties files.
+#define PROPERTIES_BINARY_IDENTIFIER "\xABGPP"
+#define PROPERTIES_BINARY_VERSION 1
+
+// The longest string accepted in a binary properties file.
+#define PROPERTIES_BINARY_MAX_STRING 0x100000
+
 namespace gameplay
 {
 
+// The directory parsed text files are cached in, or empty if they are not cached.
+static std::string __cachePath;
+
+/**
+ * Returns the next token of a string delimited by any of the specified characters, and
+ * advances the string past the token and the delimiter that ends it, as strtok_r() does.
+ */
+static char* nextToken(char** str, const char* delimiters)
+{
+    char* token = *str + strspn(*str, delimiters);
+    if (*token == '\0')
+    {
+        *str = token;
+        return NULL;
+    }
+    char* end = token + strcspn(token, delimiters);
+    if (*end != '\0')
+        *end++ = '\0';
+    *str = end;
+    return token;
+}
+
+/**
+ * Reads the rest of a stream into a null-terminated buffer.
+ */
+static bool readText(Stream* stream, std::vector<char>* text)
+{
+    size_t length = stream->length();
+    if (length > 0)
+    {
+        text->resize(length + 1);
+        length = stream->read(&(*text)[0], 1, length);
+    }
+    else
+    {
+        // The length of the stream is unknown, so read it in blocks.
+        const size_t blockSize = 4096;
+        while (!stream->eof())
+        {
+            text->resize(length + blockSize + 1);
+            size_t read = stream->read(&(*text)[length], 1, blockSize);
+            length += read;
+            if (read == 0)
+                break;
+        }
+    }
+    text->resize(length + 1);
+    (*text)[length] = '\0';
+    return true;
+}
+
 /**
- * Reads the next character from the stream. Returns EOF if the end of the stream is reached.
+ * Returns a 64-bit hash of the text of a file (FNV-1a).
  */
-static signed char readChar(Stream* stream)
+static unsigned long long hashText(const std::vector<char>& text)
 {
-    if (stream->eof())
-        return EOF;
-    signed char c;
-    if (stream->read(&c, 1, 1) != 1)
-        return EOF;
-    return c;
+    unsigned long long hash = 14695981039346656037ULL;
+    for (size_t i = 0, count = text.size(); i < count; ++i)
+    {
+        hash ^= (unsigned char)text[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * Reads a string written by writeString().
+ */
+static bool readString(Stream* stream, std::string* str)
+{
+    unsigned int length;
+    if (stream->read(&length, sizeof(length), 1) != 1 || length > PROPERTIES_BINARY_MAX_STRING)
+        return false;
+    str->resize(length);
+    return length == 0 || stream->read(&(*str)[0], 1, length) == length;
+}
+
+/**
+ * Writes a string as its length followed by its characters.
+ */
+static bool writeString(Stream* stream, const char* str)
+{
+    unsigned int length = (unsigned int)strlen(str);
+    return stream->write(&length, sizeof(length), 1) == 1 && (length == 0 || stream->write(str, 1, length) == length);
+}
+
+/**
+ * Determines whether a stream starts with the identifier of the binary properties format,
+ * leaving the stream after it if it does and at its start otherwise.
+ */
+static bool isBinary(Stream* stream)
+{
+    if (!stream->canSeek())
+        return false;
+
+    char identifier[sizeof(PROPERTIES_BINARY_IDENTIFIER) - 1];
+    if (stream->read(identifier, 1, sizeof(identifier)) == sizeof(identifier) &&
+        memcmp(identifier, PROPERTIES_BINARY_IDENTIFIER, sizeof(identifier)) == 0)
+    {
+        return true;
+    }
+    stream->rewind();
+    return false;
 }
 
 // Utility functions (shared with SceneLoader).
@@ -26,7 +127,7 @@ void calculateNamespacePath(const std::string& urlString, std::string& fileStrin
 Properties* getPropertiesFromNamespacePath(Properties* properties, const std::vector<std::string>& namespacePath);
 
 Properties::Properties()
-    : _dirPath(NULL), _parent(NULL)
+    : _namespace(0), _id(0), _dirPath(NULL), _parent(NULL)
 {
 }
 
@@ -45,30 +146,24 @@ Properties::Properties(const Properties& copy)
 }
 
 
-Properties::Properties(Stream* stream)
-    : _dirPath(NULL), _parent(NULL)
+Properties::Properties(char** data, const char* name, const char* id, const char* parentID, Properties* parent)
+    : _namespace(StringId::intern(name)), _id(StringId::intern(id)), _dirPath(NULL), _parent(parent)
 {
-    readProperties(stream);
-    rewind();
-}
-
-Properties::Properties(Stream* stream, const char* name, const char* id, const char* parentID, Properties* parent)
-    : _namespace(name), _dirPath(NULL), _parent(parent)
-{
-    if (id)
-    {
-        _id = id;
-    }
     if (parentID)
     {
         _parentID = parentID;
     }
-    readProperties(stream);
+    if (data)
+    {
+        readProperties(data);
+    }
     rewind();
 }
 
 Properties* Properties::create(const char* url)
 {
+    GP_PROFILE("Properties::create");
+
     if (!url || strlen(url) == 0)
     {
         GP_ERROR("Attempting to create a Properties object from an empty URL!");
@@ -88,9 +183,56 @@ Properties* Properties::create(const char* url)
         return NULL;
     }
 
-    Properties* properties = new Properties(stream.get());
-    properties->resolveInheritance();
-    stream->close();
+    Properties* properties = NULL;
+    if (isBinary(stream.get()))
+    {
+        // Binary files are written with inheritance already resolved.
+        properties = readBinaryFile(stream.get());
+        if (properties == NULL)
+        {
+            GP_ERROR("Failed to read binary properties file '%s'.", fileString.c_str());
+            return NULL;
+        }
+        stream->close();
+    }
+    else
+    {
+        std::vector<char> text;
+        if (!readText(stream.get(), &text))
+        {
+            GP_ERROR("Failed to read properties file '%s'.", fileString.c_str());
+            return NULL;
+        }
+        stream->close();
+
+        // Look for the parsed file in the cache by the hash of its text.
+        std::string cacheFile;
+        if (!__cachePath.empty())
+        {
+            char name[32];
+            sprintf(name, "%016llx.properties", hashText(text));
+            cacheFile = __cachePath + name;
+            std::auto_ptr<Stream> cacheStream(FileSystem::open(cacheFile.c_str()));
+            if (cacheStream.get() && isBinary(cacheStream.get()))
+                properties = readBinaryFile(cacheStream.get());
+        }
+
+        if (properties == NULL)
+        {
+            properties = new Properties();
+            char* data = &text[0];
+            properties->readProperties(&data);
+            properties->rewind();
+            properties->resolveInheritance();
+
+            if (!cacheFile.empty())
+            {
+                std::auto_ptr<Stream> cacheStream(FileSystem::open(cacheFile.c_str(), FileSystem::WRITE));
+                if (cacheStream.get() == NULL || !properties->writeBinary(cacheStream.get()))
+                    GP_WARN("Failed to write properties cache file '%s'.", cacheFile.c_str());
+            }
+        }
+    }
 
     // Get the specified properties object.
     Properties* p = getPropertiesFromNamespacePath(properties, namespacePath);
@@ -112,12 +254,38 @@ Properties* Properties::create(const char* url)
     return p;
 }
 
-void Properties::readProperties(Stream* stream)
+void Properties::setCachePath(const char* path)
 {
-    GP_ASSERT(stream);
+    __cachePath = path ? path : "";
+    if (!__cachePath.empty() && __cachePath[__cachePath.size() - 1] != '/')
+        __cachePath += '/';
+}
 
-    char line[2048];
-    int c;
+const char* Properties::getCachePath()
+{
+    return __cachePath.c_str();
+}
+
+Properties* Properties::readBinaryFile(Stream* stream)
+{
+    unsigned int version;
+    if (stream->read(&version, sizeof(version), 1) != 1 || version != PROPERTIES_BINARY_VERSION)
+        return NULL;
+
+    Properties* properties = new Properties();
+    if (!properties->readBinary(stream))
+    {
+        SAFE_DELETE(properties);
+        return NULL;
+    }
+    return properties;
+}
+
+void Properties::readProperties(char** data)
+{
+    GP_ASSERT(data && *data);
+
+    char* cursor = *data;
     char* name;
     char* value;
     char* parentID;
@@ -127,219 +295,113 @@ void Properties::readProperties(Stream* stream)
 
     while (true)
     {
-        skipWhiteSpace(stream);
-
-        // Stop when we have reached the end of the file.
-        if (stream->eof())
+        // Skip white space, and stop when we have reached the end of the file.
+        while (isspace((unsigned char)*cursor))
+            ++cursor;
+        if (*cursor == '\0')
             break;
 
-        // Read the next line.
-        rc = stream->readLine(line, 2048);
-        if (rc == NULL)
-        {
-            GP_ERROR("Error reading line from file.");
-            return;
-        }
+        // Terminate the next line in place.
+        char* line = cursor;
+        cursor = strchr(line, '\n');
+        if (cursor)
+            *cursor++ = '\0';
+        else
+            cursor = line + strlen(line);
 
         // Ignore comment, skip line.
-        if (strncmp(line, "//", 2) != 0)
-        {
-            // If an '=' appears on this line, parse it as a name/value pair.
-            // Note: strchr() has to be called before strtok(), or a backup of line has to be kept.
-            rc = strchr(line, '=');
-            if (rc != NULL)
-            {
-                // There could be a '}' at the end of the line, ending a namespace.
-                rc = strchr(line, '}');
+        if (strncmp(line, "//", 2) == 0)
+            continue;
 
-                // First token should be the property name.
-                name = strtok(line, "=");
-                if (name == NULL)
-                {
-                    GP_ERROR("Error parsing properties file: attribute without name.");
-                    return;
-                }
-
-                // Remove white-space from name.
-                name = trimWhiteSpace(name);
-
-                // Scan for next token, the property's value.
-                value = strtok(NULL, "=");
-                if (value == NULL)
-                {
-                    GP_ERROR("Error parsing properties file: attribute with name ('%s') but no value.", name);
-                    return;
-                }
-
-                // Remove white-space from value.
-                value = trimWhiteSpace(value);
-
-                // Store name/value pair.
-                _properties[name] = value;
+        // If an '=' appears on this line, parse it as a name/value pair.
+        rc = strchr(line, '=');
+        if (rc != NULL)
+        {
+            // There could be a '}' at the end of the line, ending a namespace.
+            rc = strchr(line, '}');
 
-                if (rc != NULL)
-                {
-                    // End of namespace.
-                    return;
-                }
-            }
-            else
+            // First token should be the property name.
+            name = trimWhiteSpace(nextToken(&line, "="));
+            if (name == NULL)
             {
-                parentID = NULL;
+                GP_ERROR("Error parsing properties file: attribute without name.");
+                break;
+            }
 
-                // Get the last character on the line (ignoring whitespace).
-                const char* lineEnd = trimWhiteSpace(line) + (strlen(trimWhiteSpace(line)) - 1);
+            // Scan for next token, the property's value.
+            value = trimWhiteSpace(nextToken(&line, "="));
+            if (value == NULL)
+            {
+                GP_ERROR("Error parsing properties file: attribute with name ('%s') but no value.", name);
+                break;
+            }
 
-                // This line might begin or end a namespace,
-                // or it might be a key/value pair without '='.
+            // Store name/value pair.
+            _properties[name] = value;
 
-                // Check for '{' on same line.
-                rc = strchr(line, '{');
+            if (rc != NULL)
+            {
+                // End of namespace.
+                break;
+            }
+            continue;
+        }
 
-                // Check for inheritance: ':'
-                rcc = strchr(line, ':');
+        // This line might begin or end a namespace,
+        // or it might be a key/value pair without '='.
+        parentID = NULL;
 
-                // Check for '}' on same line.
-                rccc = strchr(line, '}');
-            
-                // Get the name of the namespace.
-                name = strtok(line, " \t\n{");
-                name = trimWhiteSpace(name);
-                if (name == NULL)
-                {
-                    GP_ERROR("Error parsing properties file: failed to determine a valid token for line '%s'.", line);
-                    return;
-                }
-                else if (name[0] == '}')
-                {
-                    // End of namespace.
-                    return;
-                }
+        // Get the last character on the line (ignoring whitespace).
+        line = trimWhiteSpace(line);
+        const char* lineEnd = line + strlen(line) - 1;
 
-                // Get its ID if it has one.
-                value = strtok(NULL, ":{");
-                value = trimWhiteSpace(value);
+        // Check for '{', inheritance (':') and '}' on the line.
+        rc = strchr(line, '{');
+        rcc = strchr(line, ':');
+        rccc = strchr(line, '}');
 
-                // Get its parent ID if it has one.
-                if (rcc != NULL)
-                {
-                    parentID = strtok(NULL, "{");
-                    parentID = trimWhiteSpace(parentID);
-                }
+        // Get the name of the namespace.
+        name = trimWhiteSpace(nextToken(&line, " \t{"));
+        if (name == NULL || name[0] == '}')
+        {
+            // End of namespace.
+            break;
+        }
 
-                if (value != NULL && value[0] == '{')
-                {
-                    // If the namespace ends on this line, seek back to right before the '}' character.
-                    if (rccc && rccc == lineEnd)
-                    {
-                        if (stream->seek(-1, SEEK_CUR) == false)
-                        {
-                            GP_ERROR("Failed to seek back to before a '}' character in properties file.");
-                            return;
-                        }
-                        while (readChar(stream) != '}')
-                        {
-                            if (stream->seek(-2, SEEK_CUR) == false)
-                            {
-                                GP_ERROR("Failed to seek back to before a '}' character in properties file.");
-                                return;
-                            }
-                        }
-                        if (stream->seek(-1, SEEK_CUR) == false)
-                        {
-                            GP_ERROR("Failed to seek back to before a '}' character in properties file.");
-                            return;
-                        }
-                    }
+        // Get its ID and parent ID if it has them.
+        value = trimWhiteSpace(nextToken(&line, ":{"));
+        if (rcc != NULL)
+            parentID = trimWhiteSpace(nextToken(&line, "{"));
+        if (value != NULL && value[0] == '{')
+            value = NULL;
 
-                    // New namespace without an ID.
-                    Properties* space = new Properties(stream, name, NULL, parentID, this);
-                    _namespaces.push_back(space);
+        if (rc != NULL)
+        {
+            // A namespace that ends on the same line it begins is empty.
+            Properties* space = new Properties((rccc && rccc == lineEnd) ? NULL : &cursor, name, value, parentID, this);
+            _namespaces.push_back(space);
+            continue;
+        }
 
-                    // If the namespace ends on this line, seek to right after the '}' character.
-                    if (rccc && rccc == lineEnd)
-                    {
-                        if (stream->seek(1, SEEK_CUR) == false)
-                        {
-                            GP_ERROR("Failed to seek to immediately after a '}' character in properties file.");
-                            return;
-                        }
-                    }
-                }
-                else
-                {
-                    // If '{' appears on the same line.
-                    if (rc != NULL)
-                    {
-                        // If the namespace ends on this line, seek back to right before the '}' character.
-                        if (rccc && rccc == lineEnd)
-                        {
-                            if (stream->seek(-1, SEEK_CUR) == false)
-                            {
-                                GP_ERROR("Failed to seek back to before a '}' character in properties file.");
-                                return;
-                            }
-                            while (readChar(stream) != '}')
-                            {
-                                if (stream->seek(-2, SEEK_CUR) == false)
-                                {
-                                    GP_ERROR("Failed to seek back to before a '}' character in properties file.");
-                                    return;
-                                }
-                            }
-                            if (stream->seek(-1, SEEK_CUR) == false)
-                            {
-                                GP_ERROR("Failed to seek back to before a '}' character in properties file.");
-                                return;
-                            }
-                        }
-
-                        // Create new namespace.
-                        Properties* space = new Properties(stream, name, value, parentID, this);
-                        _namespaces.push_back(space);
-
-                        // If the namespace ends on this line, seek to right after the '}' character.
-                        if (rccc && rccc == lineEnd)
-                        {
-                            if (stream->seek(1, SEEK_CUR) == false)
-                            {
-                                GP_ERROR("Failed to seek to immediately after a '}' character in properties file.");
-                                return;
-                            }
-                        }
-                    }
-                    else
-                    {
-                        // Find out if the next line starts with "{"
-                        skipWhiteSpace(stream);
-                        c = readChar(stream);
-                        if (c == '{')
-                        {
-                            // Create new namespace.
-                            Properties* space = new Properties(stream, name, value, parentID, this);
-                            _namespaces.push_back(space);
-                        }
-                        else
-                        {
-                            // Back up from fgetc()
-                            if (stream->seek(-1, SEEK_CUR) == false)
-                                GP_ERROR("Failed to seek backwards a single character after testing if the next line starts with '{'.");
-
-                            // Store "name value" as a name/value pair, or even just "name".
-                            if (value != NULL)
-                            {
-                                _properties[name] = value;
-                            }
-                            else
-                            {
-                                _properties[name] = std::string();
-                            }
-                        }
-                    }
-                }
-            }
+        // Find out if the next line starts with "{".
+        char* next = cursor;
+        while (isspace((unsigned char)*next))
+            ++next;
+        if (*next == '{')
+        {
+            // Create new namespace.
+            cursor = next + 1;
+            Properties* space = new Properties(&cursor, name, value, parentID, this);
+            _namespaces.push_back(space);
+        }
+        else
+        {
+            // Store "name value" as a name/value pair, or even just "name".
+            _properties[name] = value ? value : "";
         }
     }
+
+    *data = cursor;
 }
 
 Properties::~Properties()
@@ -351,23 +413,97 @@ Properties::~Properties()
     }
 }
 
-void Properties::skipWhiteSpace(Stream* stream)
+bool Properties::readBinary(Stream* stream)
+{
+    GP_ASSERT(stream);
+
+    std::string str;
+    if (!readString(stream, &str))
+        return false;
+    _namespace = StringId::intern(str.c_str());
+    if (!readString(stream, &str))
+        return false;
+    _id = StringId::intern(str.c_str());
+    if (!readString(stream, &_parentID))
+        return false;
+
+    unsigned char hasDirPath;
+    if (stream->read(&hasDirPath, 1, 1) != 1)
+        return false;
+    if (hasDirPath)
+    {
+        if (!readString(stream, &str))
+            return false;
+        setDirectoryPath(str);
+    }
+
+    unsigned int count;
+    if (stream->read(&count, sizeof(count), 1) != 1)
+        return false;
+    std::string name;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (!readString(stream, &name) || !readString(stream, &str))
+            return false;
+        _properties[name] = str;
+    }
+
+    if (stream->read(&count, sizeof(count), 1) != 1)
+        return false;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        Properties* space = new Properties();
+        space->_parent = this;
+        _namespaces.push_back(space);
+        if (!space->readBinary(stream))
+            return false;
+    }
+
+    rewind();
+    return true;
+}
+
+bool Properties::writeBinary(Stream* stream) const
+{
+    GP_ASSERT(stream);
+
+    unsigned int version = PROPERTIES_BINARY_VERSION;
+    if (stream->write(PROPERTIES_BINARY_IDENTIFIER, 1, sizeof(PROPERTIES_BINARY_IDENTIFIER) - 1) != sizeof(PROPERTIES_BINARY_IDENTIFIER) - 1 ||
+        stream->write(&version, sizeof(version), 1) != 1)
+    {
+        return false;
+    }
+    return writeNamespace(stream);
+}
+
+bool Properties::writeNamespace(Stream* stream) const
 {
-    signed char c;
-    do
+    if (!writeString(stream, getNamespace()) || !writeString(stream, getId()) || !writeString(stream, _parentID.c_str()))
+        return false;
+
+    unsigned char hasDirPath = _dirPath ? 1 : 0;
+    if (stream->write(&hasDirPath, 1, 1) != 1 || (_dirPath && !writeString(stream, _dirPath->c_str())))
+        return false;
+
+    unsigned int count = (unsigned int)_properties.size();
+    if (stream->write(&count, sizeof(count), 1) != 1)
+        return false;
+    for (std::map<std::string, std::string>::const_iterator itr = _properties.begin(); itr != _properties.end(); ++itr)
     {
-        c = readChar(stream);
-    } while (isspace(c) && c != EOF);
+        if (!writeString(stream, itr->first.c_str()) || !writeString(stream, itr->second.c_str()))
+            return false;
+    }
 
-    // If we are not at the end of the file, then since we found a
-    // non-whitespace character, we put the cursor back in front of it.
-    if (c != EOF)
+    count = (unsigned int)_namespaces.size();
+    if (stream->write(&count, sizeof(count), 1) != 1)
+        return false;
+    for (size_t i = 0; i < _namespaces.size(); ++i)
     {
-        if (stream->seek(-1, SEEK_CUR) == false)
-        {
-            GP_ERROR("Failed to seek backwards one character after skipping whitespace.");
-        }
+        GP_ASSERT(_namespaces[i]);
+        if (!_namespaces[i]->writeNamespace(stream))
+            return false;
     }
+    return true;
 }
 
 char* Properties::trimWhiteSpace(char *str)
@@ -578,19 +714,29 @@ Properties* Properties::getNamespace(const char* id, bool searchNames) const
 {
     GP_ASSERT(id);
 
+    // A string that was never interned is not the ID or name of any namespace.
+    unsigned int atom = StringId::find(id);
+    if (atom == 0 && *id != '\0')
+        return NULL;
+
+    return findNamespace(atom, searchNames);
+}
+
+Properties* Properties::findNamespace(unsigned int atom, bool searchNames) const
+{
     Properties* ret = NULL;
     std::vector<Properties*>::const_iterator it;
     
     for (it = _namespaces.begin(); it < _namespaces.end(); ++it)
     {
         ret = *it;
-        if (strcmp(searchNames ? ret->_namespace.c_str() : ret->_id.c_str(), id) == 0)
+        if ((searchNames ? ret->_namespace : ret->_id) == atom)
         {
             return ret;
         }
         
         // Search recursively.
-        ret = ret->getNamespace(id, searchNames);
+        ret = ret->findNamespace(atom, searchNames);
         if (ret != NULL)
         {
             return ret;
@@ -602,12 +748,12 @@ Properties* Properties::getNamespace(const char* id, bool searchNames) const
 
 const char* Properties::getNamespace() const
 {
-    return _namespace.c_str();
+    return StringId::getString(_namespace);
 }
 
 const char* Properties::getId() const
 {
-    return _id.c_str();
+    return StringId::getString(_id);
 }
 
 bool Properties::exists(const char* name) const
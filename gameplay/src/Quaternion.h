@@ -37,11 +37,16 @@ class Matrix;
  * q3 = (0.6, 0.0, 0.8, 0.0), and
  * q4 = (-0.8, 0.0, -0.6, 0.0).
  * For the point p = (1.0, 1.0, 1.0), the following figures show the trajectories of p using lerp, slerp, and squad.
+ *
+ * Values of this type are copied into their Lua userdata when returned to scripts.
+ *
+ * @script{value}
  */
 class Quaternion
 {
     friend class Curve;
     friend class Transform;
+    friend class AnimationController;
 
 public:
 
@@ -1,10 +1,47 @@
 #include "Base.h"
 #include "Ref.h"
 #include "Game.h"
+#include "Mutex.h"
+
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
 
 namespace gameplay
 {
 
+/**
+ * Returns the mutex that guards the deferred objects and the leak records.
+ */
+static Mutex& getRefMutex()
+{
+    static Mutex mutex;
+    return mutex;
+}
+
+// The objects released on other threads, waiting to be destroyed on the main thread.
+static std::vector<Ref*> __deferredRefs;
+
+static unsigned int incrementRefCount(volatile unsigned int* count)
+{
+#ifdef WIN32
+    return (unsigned int)InterlockedIncrement((volatile LONG*)count);
+#else
+    return __sync_add_and_fetch(count, 1);
+#endif
+}
+
+static unsigned int decrementRefCount(volatile unsigned int* count)
+{
+#ifdef WIN32
+    return (unsigned int)InterlockedDecrement((volatile LONG*)count);
+#else
+    return __sync_sub_and_fetch(count, 1);
+#endif
+}
+
 #ifdef GAMEPLAY_MEM_LEAK_DETECTION
 void* trackRef(Ref* ref);
 void untrackRef(Ref* ref, void* record);
@@ -32,13 +69,19 @@ Ref::~Ref()
 
 void Ref::addRef()
 {
-    ++_refCount;
+    incrementRefCount(&_refCount);
 }
 
 void Ref::release()
 {
-    if ((--_refCount) <= 0)
+    if (decrementRefCount(&_refCount) == 0)
     {
+        if (!JobController::isMainThread())
+        {
+            ScopedLock lock(getRefMutex());
+            __deferredRefs.push_back(this);
+            return;
+        }
 #ifdef GAMEPLAY_MEM_LEAK_DETECTION
         untrackRef(this, __record);
 #endif
@@ -46,6 +89,25 @@ void Ref::release()
     }
 }
 
+void Ref::destroyDeferred()
+{
+    // Destructors may release more objects, which are destroyed right away on the main thread,
+    // while other threads may keep deferring objects.
+    std::vector<Ref*> refs;
+    getRefMutex().lock();
+    refs.swap(__deferredRefs);
+    getRefMutex().unlock();
+
+    for (size_t i = 0, count = refs.size(); i < count; ++i)
+    {
+        Ref* ref = refs[i];
+#ifdef GAMEPLAY_MEM_LEAK_DETECTION
+        untrackRef(ref, ref->__record);
+#endif
+        delete ref;
+    }
+}
+
 unsigned int Ref::getRefCount() const
 {
     return _refCount;
@@ -90,9 +152,11 @@ void* trackRef(Ref* ref)
     // Create memory allocation record.
     RefAllocationRecord* rec = (RefAllocationRecord*)malloc(sizeof(RefAllocationRecord));
     rec->ref = ref;
-    rec->next = __refAllocations;
     rec->prev = 0;
 
+    // Objects can be created on any thread.
+    ScopedLock lock(getRefMutex());
+    rec->next = __refAllocations;
     if (__refAllocations)
         __refAllocations->prev = rec;
     __refAllocations = rec;
@@ -117,14 +181,17 @@ void untrackRef(Ref* ref, void* record)
     }
 
     // Link this item out.
+    Mutex& mutex = getRefMutex();
+    mutex.lock();
     if (__refAllocations == rec)
         __refAllocations = rec->next;
     if (rec->prev)
         rec->prev->next = rec->next;
     if (rec->next)
         rec->next->prev = rec->prev;
-    free((void*)rec);
     --__refAllocationCount;
+    mutex.unlock();
+    free((void*)rec);
 }
 
 #endif
@@ -13,9 +13,17 @@ namespace gameplay
  * reference counting eliminates the need for programmers to manually
  * keep track of object ownership and having to worry about when to
  * safely delete such objects.
+ *
+ * References can be added and released from any thread. When the last reference to an
+ * object is released on a thread other than the main thread, the object is not destroyed
+ * right away: it is queued and destroyed on the main thread at the start of the next
+ * frame, since the destructors of most objects release graphics, audio or script resources
+ * that may only be used from the main thread.
  */
 class Ref
 {
+    friend class Game;
+
 public:
 
     /**
@@ -32,7 +40,8 @@ public:
      * When an object is initially created, its reference count is set to 1.
      * Calling addRef() will increment the reference and calling release()
      * will decrement the reference count. When an object reaches a
-     * reference count of zero, the object is destroyed.
+     * reference count of zero, the object is destroyed, or queued to be
+     * destroyed on the main thread if this is called from another thread.
      */
     void release();
 
@@ -64,11 +73,16 @@ protected:
 
 private:
 
-    unsigned int _refCount;
+    /**
+     * Destroys the objects whose last reference was released on another thread than the main thread.
+     * Called by the game on the main thread at the start of each frame, and when it shuts down.
+     */
+    static void destroyDeferred();
+
+    volatile unsigned int _refCount;
 
     // Memory leak diagnostic data (only included when GAMEPLAY_MEM_LEAK_DETECTION is defined)
 #ifdef GAMEPLAY_MEM_LEAK_DETECTION
-    friend class Game;
     static void printLeaks();
     void* __record;
 #endif
@@ -0,0 +1,448 @@
+#include "Base.h"
+#include "RenderQueue.h"
+#include "MeshPart.h"
+#include "Technique.h"
+#include "Pass.h"
+#include "Node.h"
+#include "ParticleEmitter.h"
+
+// Sort key layout for opaque items (front-to-back).
+#define KEY_OPAQUE_EFFECT_SHIFT     48
+#define KEY_OPAQUE_TEXTURE_SHIFT    32
+#define KEY_OPAQUE_STATE_SHIFT      24
+#define KEY_OPAQUE_DEPTH_SHIFT      0
+
+// Sort key layout for blended items (back-to-front).
+#define KEY_BLEND_BIT               (1ULL << 63)
+#define KEY_BLEND_DEPTH_SHIFT       39
+#define KEY_BLEND_EFFECT_SHIFT      24
+#define KEY_BLEND_TEXTURE_SHIFT     8
+#define KEY_BLEND_STATE_SHIFT       0
+
+#define KEY_EFFECT_MASK             0x7FFF
+#define KEY_TEXTURE_MASK            0xFFFF
+#define KEY_STATE_MASK              0xFF
+#define KEY_DEPTH_MASK              0xFFFFFF
+
+// The fragment shader of the effects of the depth pre-pass.
+#define DEPTH_FSH "res/shaders/depth.frag"
+
+namespace gameplay
+{
+
+RenderQueue::RenderQueue() : _sorted(true), _depthPrepass(false), _depthShader(DEPTH_FSH), _prepassState(NULL), _equalState(NULL)
+{
+}
+
+RenderQueue::~RenderQueue()
+{
+    releaseDepthEffects();
+    SAFE_RELEASE(_prepassState);
+    SAFE_RELEASE(_equalState);
+}
+
+RenderQueue* RenderQueue::create(unsigned int initialCapacity)
+{
+    RenderQueue* queue = new RenderQueue();
+    queue->_items.reserve(initialCapacity);
+    return queue;
+}
+
+/**
+ * Returns the depth of a point along the view direction of the active camera of a node's
+ * scene, quantized so that it can be stored in the depth bits of a sort key.
+ */
+static unsigned int getQuantizedDepth(Node* node, const Vector3& point)
+{
+    Vector3 center;
+    node->getViewMatrix().transformPoint(point, &center);
+
+    // The bit pattern of a positive IEEE float increases monotonically with its value,
+    // so the upper bits can be compared as an integer without knowing the depth range.
+    union
+    {
+        float f;
+        unsigned int i;
+    } depth;
+    depth.f = center.z < 0.0f ? -center.z : 0.0f;
+    return (depth.i >> 7) & KEY_DEPTH_MASK;
+}
+
+unsigned int RenderQueue::getTextureKey(RenderState* rs)
+{
+    unsigned int hash = 2166136261u;
+    for (; rs; rs = rs->_parent)
+    {
+        for (size_t i = 0, count = rs->_parameters.size(); i < count; ++i)
+        {
+            MaterialParameter* param = rs->_parameters[i];
+            GP_ASSERT(param);
+            Texture::Sampler* sampler = param->getSampler();
+            if (sampler && sampler->getTexture())
+            {
+                hash ^= (unsigned int)sampler->getTexture()->getHandle();
+                hash *= 16777619u;
+            }
+        }
+    }
+    return (hash ^ (hash >> 16)) & KEY_TEXTURE_MASK;
+}
+
+void RenderQueue::add(Model* model)
+{
+    GP_ASSERT(model);
+    GP_ASSERT(model->getMesh());
+
+    Node* node = model->getNode();
+    unsigned int depth = node ? getQuantizedDepth(node, node->getBoundingSphere().center) : 0;
+
+    unsigned int lod = model->updateLod();
+    Mesh* mesh = model->getLodMesh(lod);
+    unsigned int partCount = mesh->getPartCount();
+    if (partCount == 0)
+    {
+        // No mesh parts (index buffers), so only a shared material can be used.
+        addItem(model, lod, NULL, model->getMaterial(), depth);
+    }
+    else
+    {
+        for (unsigned int i = 0; i < partCount; ++i)
+        {
+            addItem(model, lod, mesh->getPart(i), model->getPartMaterial(i), depth);
+        }
+    }
+}
+
+void RenderQueue::add(ParticleEmitter* emitter)
+{
+    GP_ASSERT(emitter);
+    GP_ASSERT(emitter->getNode());
+
+    Node* node = emitter->getNode();
+    unsigned int depth = getQuantizedDepth(node, node->getTranslationWorld());
+
+    // Emitters bind their own effects and states, so their keys only hold the depth.
+    Item item;
+    if (emitter->getTextureBlending() == ParticleEmitter::BLEND_OPAQUE)
+        item.key = (unsigned long long)depth << KEY_OPAQUE_DEPTH_SHIFT;
+    else
+        item.key = KEY_BLEND_BIT | ((unsigned long long)(KEY_DEPTH_MASK - depth) << KEY_BLEND_DEPTH_SHIFT);
+    item.model = NULL;
+    item.emitter = emitter;
+    item.mesh = NULL;
+    item.part = NULL;
+    item.pass = NULL;
+    item.binding = NULL;
+    item.depth = depth;
+    item.depthEffect = NULL;
+    _items.push_back(item);
+
+    _sorted = false;
+}
+
+void RenderQueue::addItem(Model* model, unsigned int lod, MeshPart* part, Material* material, unsigned int depth)
+{
+    if (material == NULL)
+        return;
+
+    Technique* technique = material->getTechnique();
+    GP_ASSERT(technique);
+    for (unsigned int i = 0, passCount = technique->getPassCount(); i < passCount; ++i)
+    {
+        Pass* pass = technique->getPassByIndex(i);
+        GP_ASSERT(pass);
+
+        unsigned long long effect = getEffectId(pass->getEffect()) & KEY_EFFECT_MASK;
+        unsigned long long texture = getTextureKey(pass);
+        unsigned long long state = pass->getStateId() & KEY_STATE_MASK;
+
+        Item item;
+        if (pass->isBlendEnabled())
+        {
+            // Blended items are drawn last, ordered by decreasing depth first.
+            item.key = KEY_BLEND_BIT |
+                ((unsigned long long)(KEY_DEPTH_MASK - depth) << KEY_BLEND_DEPTH_SHIFT) |
+                (effect << KEY_BLEND_EFFECT_SHIFT) |
+                (texture << KEY_BLEND_TEXTURE_SHIFT) |
+                (state << KEY_BLEND_STATE_SHIFT);
+        }
+        else
+        {
+            item.key = (effect << KEY_OPAQUE_EFFECT_SHIFT) |
+                (texture << KEY_OPAQUE_TEXTURE_SHIFT) |
+                (state << KEY_OPAQUE_STATE_SHIFT) |
+                ((unsigned long long)depth << KEY_OPAQUE_DEPTH_SHIFT);
+        }
+        item.model = model;
+        item.emitter = NULL;
+        item.mesh = model->getLodMesh(lod);
+        item.part = part;
+        item.pass = pass;
+        item.binding = model->getLodBinding(lod, pass);
+        item.depth = depth;
+        item.depthEffect = NULL;
+        _items.push_back(item);
+    }
+
+    _sorted = false;
+}
+
+unsigned int RenderQueue::getEffectId(Effect* effect)
+{
+    std::map<Effect*, unsigned int>::const_iterator itr = _effectIds.find(effect);
+    if (itr != _effectIds.end())
+        return itr->second;
+
+    unsigned int id = (unsigned int)_effectIds.size();
+    _effectIds[effect] = id;
+    return id;
+}
+
+void RenderQueue::clear()
+{
+    _items.clear();
+    _effectIds.clear();
+    _sorted = true;
+}
+
+unsigned int RenderQueue::getItemCount() const
+{
+    return (unsigned int)_items.size();
+}
+
+bool RenderQueue::sortItems(const Item& a, const Item& b)
+{
+    return a.key < b.key;
+}
+
+void RenderQueue::draw(bool wireframe)
+{
+    if (_items.empty())
+        return;
+
+    if (!_sorted)
+    {
+        std::sort(_items.begin(), _items.end(), &RenderQueue::sortItems);
+        _sorted = true;
+    }
+
+    if (_depthPrepass && !wireframe)
+    {
+        drawDepthPrepass();
+    }
+    else
+    {
+        for (size_t i = 0, count = _items.size(); i < count; ++i)
+            _items[i].depthEffect = NULL;
+    }
+
+    Effect* currentEffect = NULL;
+    VertexAttributeBinding* currentBinding = NULL;
+    for (size_t i = 0, count = _items.size(); i < count; ++i)
+    {
+        const Item& item = _items[i];
+        if (item.emitter)
+        {
+            if (currentBinding)
+            {
+                currentBinding->unbind();
+                currentBinding = NULL;
+            }
+            currentEffect = NULL;
+            item.emitter->draw();
+            continue;
+        }
+        Pass* pass = item.pass;
+
+        // Only switch programs and vertex attribute bindings when they change between items.
+        Effect* effect = pass->getEffect();
+        GP_ASSERT(effect);
+        if (effect != currentEffect || Effect::getCurrentEffect() != effect)
+        {
+            effect->bind();
+            currentEffect = effect;
+        }
+
+        // The pixels of the items of the pre-pass are shaded where their depth was written.
+        if (item.depthEffect)
+            pass->RenderState::bind(effect, _equalState);
+        else
+            pass->RenderState::bind(pass);
+
+        VertexAttributeBinding* binding = item.binding;
+        if (binding != currentBinding)
+        {
+            if (currentBinding)
+                currentBinding->unbind();
+            if (binding)
+                binding->bind();
+            currentBinding = binding;
+        }
+
+        item.model->drawPart(item.mesh, item.part, wireframe);
+    }
+
+    if (currentBinding)
+    {
+        currentBinding->unbind();
+    }
+}
+
+void RenderQueue::setDepthPrepass(bool enabled)
+{
+    _depthPrepass = enabled;
+}
+
+bool RenderQueue::isDepthPrepass() const
+{
+    return _depthPrepass;
+}
+
+void RenderQueue::setDepthShader(const char* fshPath, const char* defines)
+{
+    std::string shader = fshPath ? fshPath : DEPTH_FSH;
+    std::string extraDefines = defines ? defines : "";
+    if (shader == _depthShader && extraDefines == _depthDefines)
+        return;
+
+    releaseDepthEffects();
+    _depthShader = shader;
+    _depthDefines = extraDefines;
+}
+
+void RenderQueue::drawDepth(bool writeColor)
+{
+    drawDepthPrepass(writeColor);
+}
+
+void RenderQueue::drawDepthPrepass(bool writeColor)
+{
+    _prepassItems.clear();
+    for (unsigned int i = 0, count = (unsigned int)_items.size(); i < count; ++i)
+    {
+        Item& item = _items[i];
+        item.depthEffect = NULL;
+        if (item.emitter || (item.key & KEY_BLEND_BIT) || !item.pass->isDepthWriteEnabled())
+            continue;
+        item.depthEffect = getDepthEffect(item.pass->getEffect());
+        if (item.depthEffect)
+            _prepassItems.push_back(i);
+    }
+    if (_prepassItems.empty())
+        return;
+
+    if (_prepassState == NULL)
+    {
+        _prepassState = RenderState::StateBlock::create();
+        _prepassState->setDepthTest(true);
+        _prepassState->setDepthWrite(true);
+        _prepassState->setDepthFunction(RenderState::DEPTH_LESS);
+        _equalState = RenderState::StateBlock::create();
+        _equalState->setDepthTest(true);
+        _equalState->setDepthWrite(false);
+        _equalState->setDepthFunction(RenderState::DEPTH_EQUAL);
+    }
+
+    // The opaque items are sorted by state first, so the pre-pass orders them again by depth alone.
+    std::sort(_prepassItems.begin(), _prepassItems.end(), DepthOrder(_items));
+
+    if (!writeColor)
+        GL_ASSERT( glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE) );
+    Effect* currentEffect = NULL;
+    VertexAttributeBinding* currentBinding = NULL;
+    for (size_t i = 0, count = _prepassItems.size(); i < count; ++i)
+    {
+        const Item& item = _items[_prepassItems[i]];
+        Effect* effect = item.depthEffect;
+        if (effect != currentEffect || Effect::getCurrentEffect() != effect)
+        {
+            effect->bind();
+            currentEffect = effect;
+        }
+
+        item.pass->RenderState::bind(effect, _prepassState);
+
+        VertexAttributeBinding* binding = getDepthBinding(item.mesh, effect);
+        if (binding != currentBinding)
+        {
+            if (currentBinding)
+                currentBinding->unbind();
+            if (binding)
+                binding->bind();
+            currentBinding = binding;
+        }
+
+        item.model->drawPart(item.mesh, item.part, false);
+    }
+    if (currentBinding)
+    {
+        currentBinding->unbind();
+    }
+    if (!writeColor)
+        GL_ASSERT( glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE) );
+}
+
+Effect* RenderQueue::getDepthEffect(Effect* effect)
+{
+    GP_ASSERT(effect);
+
+    std::map<Effect*, Effect*>::const_iterator itr = _depthEffects.find(effect);
+    if (itr != _depthEffects.end())
+        return itr->second;
+
+    // The id of an effect loaded from files is made of the paths of its shaders and its defines.
+    Effect* depthEffect = NULL;
+    std::string id = effect->getId();
+    size_t vshEnd = id.find(';');
+    size_t fshEnd = vshEnd == std::string::npos ? std::string::npos : id.find(';', vshEnd + 1);
+    if (fshEnd != std::string::npos)
+    {
+        std::string defines = id.substr(fshEnd + 1);
+        if (defines.find("DISCARD") == std::string::npos)
+        {
+            if (!_depthDefines.empty())
+            {
+                if (!defines.empty())
+                    defines += ';';
+                defines += _depthDefines;
+            }
+            depthEffect = Effect::createFromFile(id.substr(0, vshEnd).c_str(), _depthShader.c_str(), defines.empty() ? NULL : defines.c_str());
+        }
+    }
+
+    // The effect is kept so that no other effect can be created at its address while it is a key.
+    effect->addRef();
+    _depthEffects[effect] = depthEffect;
+    return depthEffect;
+}
+
+VertexAttributeBinding* RenderQueue::getDepthBinding(Mesh* mesh, Effect* depthEffect)
+{
+    std::pair<Mesh*, Effect*> key(mesh, depthEffect);
+    std::map<std::pair<Mesh*, Effect*>, VertexAttributeBinding*>::const_iterator itr = _depthBindings.find(key);
+    if (itr != _depthBindings.end())
+        return itr->second;
+
+    VertexAttributeBinding* binding = VertexAttributeBinding::create(mesh, depthEffect);
+    _depthBindings[key] = binding;
+    return binding;
+}
+
+void RenderQueue::releaseDepthEffects()
+{
+    for (std::map<std::pair<Mesh*, Effect*>, VertexAttributeBinding*>::iterator itr = _depthBindings.begin(); itr != _depthBindings.end(); ++itr)
+    {
+        SAFE_RELEASE(itr->second);
+    }
+    _depthBindings.clear();
+    for (std::map<Effect*, Effect*>::iterator itr = _depthEffects.begin(); itr != _depthEffects.end(); ++itr)
+    {
+        SAFE_RELEASE(itr->second);
+        itr->first->release();
+    }
+    _depthEffects.clear();
+    for (size_t i = 0, count = _items.size(); i < count; ++i)
+        _items[i].depthEffect = NULL;
+}
+
+}
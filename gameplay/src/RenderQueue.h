@@ -0,0 +1,241 @@
+#ifndef RENDERQUEUE_H_
+#define RENDERQUEUE_H_
+
+#include "Model.h"
+
+namespace gameplay
+{
+
+class Pass;
+class MeshPart;
+class ParticleEmitter;
+
+/**
+ * Defines a queue of draw items that are collected, sorted and then drawn together.
+ *
+ * Rather than drawing each Model immediately while visiting a scene, models can be
+ * added to a RenderQueue. Every mesh part and pass of an added model becomes a single
+ * draw item. When the queue is drawn, the items are sorted by a packed 64-bit key made
+ * of the effect, the set of bound textures, the render state and the view depth of
+ * the item, which minimizes the number of program, texture and state changes.
+ *
+ * Opaque items are drawn front-to-back. Items whose render state enables blending are
+ * drawn after all opaque items, from back to front.
+ *
+ * The depth of an item is computed from the bounding sphere of the model's node using
+ * the view matrix of the active camera of the node's scene. Models with levels of detail
+ * add the parts of the level selected for that camera, and are not cross-faded.
+ *
+ * Particle emitters can be added as well, as single items ordered by the position of their
+ * node, so that blended emitters and the blended parts of models are drawn from back to front
+ * together rather than in the order the scene is visited.
+ *
+ * For scenes whose pixel shaders are expensive, the queue can draw a depth pre-pass (see
+ * setDepthPrepass), so that each pixel of the opaque items is shaded only once.
+ */
+class RenderQueue
+{
+public:
+
+    /**
+     * Creates a new render queue.
+     *
+     * @param initialCapacity An optional initial capacity of the queue (number of draw items).
+     *
+     * @return A new render queue.
+     * @script{create}
+     */
+    static RenderQueue* create(unsigned int initialCapacity = 0);
+
+    /**
+     * Destructor.
+     */
+    ~RenderQueue();
+
+    /**
+     * Adds the draw items for all mesh parts and passes of the specified model.
+     *
+     * The model must remain valid until the queue is cleared.
+     *
+     * @param model The model to add.
+     */
+    void add(Model* model);
+
+    /**
+     * Adds a draw item for the particles of the specified emitter.
+     *
+     * Emitters that blend their particles are drawn with the blended items of models,
+     * ordered by the depth of the emitter's node. The emitter must have a node and must
+     * remain valid until the queue is cleared.
+     *
+     * @param emitter The particle emitter to add.
+     */
+    void add(ParticleEmitter* emitter);
+
+    /**
+     * Removes all draw items from the queue.
+     *
+     * This should be called once per frame before adding models to the queue again.
+     */
+    void clear();
+
+    /**
+     * Returns the number of draw items currently in the queue.
+     *
+     * @return The number of draw items.
+     */
+    unsigned int getItemCount() const;
+
+    /**
+     * Sorts and draws all the items currently in the queue.
+     *
+     * The queue is not cleared by this method, so the same items can be drawn
+     * again (for example, into another render target).
+     *
+     * @param wireframe If true, draw the items in wireframe mode.
+     */
+    void draw(bool wireframe = false);
+
+    /**
+     * Sets whether the opaque items are drawn in a depth pre-pass before they are shaded.
+     *
+     * The pre-pass draws the opaque items front-to-back with color writes disabled, each
+     * with an effect derived from the effect of its pass: the same vertex shader and defines
+     * with a fragment shader that does nothing, so the depth buffer is filled at little cost.
+     * The items are then drawn with their own effects, with the depth function set to EQUAL
+     * and depth writes disabled, so only the visible pixels are shaded.
+     *
+     * Only the items whose passes enable depth tests and depth writes are drawn in the
+     * pre-pass, and only if their effect was loaded from files, since the id of the effect
+     * names its shaders. Effects compiled with a define that discards pixels, such as
+     * TEXTURE_DISCARD_ALPHA, are not derived either, since their fragment shader decides
+     * which pixels are written. Blended items are drawn after the opaque items as usual.
+     *
+     * The derived effects and their vertex attribute bindings are kept by the queue until
+     * it is destroyed, so they are only created once. The pre-pass is off by default.
+     *
+     * @param enabled True to draw a depth pre-pass.
+     */
+    void setDepthPrepass(bool enabled);
+
+    /**
+     * Determines whether the opaque items are drawn in a depth pre-pass.
+     *
+     * @return True if a depth pre-pass is drawn.
+     */
+    bool isDepthPrepass() const;
+
+    /**
+     * Sets the fragment shader of the depth-only effects derived from the effects of the items.
+     *
+     * By default the derived effects write nothing but depth. A queue that renders the depth
+     * of its items into a color buffer, such as that of a ShadowMap, sets a fragment shader
+     * that encodes the depth of the fragment in its color. The derived effects created so far
+     * are released when the shader changes.
+     *
+     * @param fshPath The path of the fragment shader, or NULL for the default shader.
+     * @param defines Defines added to those of the effect of each item, separated by ';'. May be NULL.
+     */
+    void setDepthShader(const char* fshPath, const char* defines = NULL);
+
+    /**
+     * Draws only the depth of the opaque items, as the depth pre-pass does.
+     *
+     * This fills the depth buffer of another frame buffer with the items of the queue, such
+     * as that of the particles drawn at a reduced resolution (see OffscreenParticles). The
+     * items the pre-pass does not apply to are not drawn.
+     *
+     * @param writeColor True to keep color writes enabled, for a depth shader that writes color (see setDepthShader).
+     */
+    void drawDepth(bool writeColor = false);
+
+private:
+
+    /**
+     * A single draw call for a mesh part and a pass.
+     */
+    struct Item
+    {
+        unsigned long long key;
+        Model* model;
+        ParticleEmitter* emitter;
+        Mesh* mesh;
+        MeshPart* part;
+        Pass* pass;
+        VertexAttributeBinding* binding;
+        unsigned int depth;
+        Effect* depthEffect;
+    };
+
+    /**
+     * Orders the indices of items by the depth of their items, front to back.
+     */
+    struct DepthOrder
+    {
+        DepthOrder(const std::vector<Item>& items) : items(items) { }
+        bool operator()(unsigned int a, unsigned int b) const { return items[a].depth < items[b].depth; }
+        const std::vector<Item>& items;
+    };
+
+    /**
+     * Constructor.
+     */
+    RenderQueue();
+
+    /**
+     * Hidden copy constructor.
+     */
+    RenderQueue(const RenderQueue& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    RenderQueue& operator=(const RenderQueue&);
+
+    void addItem(Model* model, unsigned int lod, MeshPart* part, Material* material, unsigned int depth);
+
+    unsigned int getEffectId(Effect* effect);
+
+    /**
+     * Hashes the textures bound to sampler parameters anywhere in the hierarchy of a pass.
+     */
+    static unsigned int getTextureKey(RenderState* rs);
+
+    static bool sortItems(const Item& a, const Item& b);
+
+    /**
+     * Draws the depth of the opaque items that have a depth-only effect, and sets the
+     * depth-only effect of the items drawn.
+     *
+     * @param writeColor True to leave color writes enabled.
+     */
+    void drawDepthPrepass(bool writeColor = false);
+
+    /**
+     * Returns the depth-only effect derived from an effect, or NULL if it has none.
+     */
+    Effect* getDepthEffect(Effect* effect);
+
+    VertexAttributeBinding* getDepthBinding(Mesh* mesh, Effect* depthEffect);
+
+    /**
+     * Releases the depth-only effects and their vertex attribute bindings.
+     */
+    void releaseDepthEffects();
+
+    std::vector<Item> _items;
+    std::map<Effect*, unsigned int> _effectIds;
+    bool _sorted;
+    bool _depthPrepass;
+    std::vector<unsigned int> _prepassItems;
+    std::map<Effect*, Effect*> _depthEffects;
+    std::map<std::pair<Mesh*, Effect*>, VertexAttributeBinding*> _depthBindings;
+    std::string _depthShader;
+    std::string _depthDefines;
+    RenderState::StateBlock* _prepassState;
+    RenderState::StateBlock* _equalState;
+};
+
+}
+
+#endif
@@ -1,5 +1,6 @@
 #include "Base.h"
 #include "RenderState.h"
+#include "StringId.h"
 #include "Node.h"
 #include "Pass.h"
 #include "Technique.h"
@@ -15,15 +16,32 @@
 #define RS_DEPTH_FUNC 32
 #define RS_CULL_FACE_SIDE 64
 
+// The id of the bound states when they were changed other than by binding a RenderState.
+#define STATE_ID_UNKNOWN 0xFFFFFFFF
+
+// The positions of the states in the keys of combined states.
+#define STATE_KEY_BLEND_SHIFT 8
+#define STATE_KEY_CULL_FACE_SHIFT 9
+#define STATE_KEY_DEPTH_TEST_SHIFT 10
+#define STATE_KEY_DEPTH_WRITE_SHIFT 11
+#define STATE_KEY_BLEND_SRC_SHIFT 16
+#define STATE_KEY_BLEND_DST_SHIFT 32
+#define STATE_KEY_DEPTH_FUNC_SHIFT 48
+#define STATE_KEY_CULL_FACE_SIDE_SHIFT 56
+
 namespace gameplay
 {
 
 RenderState::StateBlock* RenderState::StateBlock::_defaultState = NULL;
+unsigned int RenderState::StateBlock::_boundId = STATE_ID_UNKNOWN;
+unsigned int RenderState::StateBlock::_nextGeneration = 0;
 std::vector<RenderState::ResolveAutoBindingCallback> RenderState::_customAutoBindingResolvers;
 
 RenderState::RenderState()
-    : _nodeBinding(NULL), _state(NULL), _parent(NULL)
+    : _nodeBinding(NULL), _state(NULL), _parent(NULL), _template(NULL), _stateId(0)
 {
+    // Without StateBlocks, the hierarchy has the default states, whose id is 0.
+    memset(_stateGenerations, 0, sizeof(_stateGenerations));
 }
 
 RenderState::~RenderState()
@@ -60,13 +78,23 @@ MaterialParameter* RenderState::getParameter(const char* name) const
     GP_ASSERT(name);
 
     // Search for an existing parameter with this name.
+    unsigned int nameId = StringId::intern(name);
     MaterialParameter* param;
     for (size_t i = 0, count = _parameters.size(); i < count; ++i)
     {
         param = _parameters[i];
         GP_ASSERT(param);
-        if (strcmp(param->getName(), name) == 0)
+        if (param->_nameId == nameId)
         {
+            if (isSharedParameter(param))
+            {
+                // Copy the parameter of the template, since the caller may change it.
+                MaterialParameter* copy = new MaterialParameter(name);
+                param->cloneInto(copy);
+                _parameters[i] = copy;
+                SAFE_RELEASE(param);
+                return copy;
+            }
             return param;
         }
     }
@@ -80,10 +108,14 @@ MaterialParameter* RenderState::getParameter(const char* name) const
 
 void RenderState::clearParameter(const char* name)
 {
+    unsigned int nameId = StringId::find(name);
+    if (nameId == 0 && *name != '\0')
+        return;
+
     for (size_t i = 0, count = _parameters.size(); i < count; ++i)
     {
         MaterialParameter* p = _parameters[i];
-        if (p->_name == name)
+        if (p->_nameId == nameId)
         {
             _parameters.erase(_parameters.begin() + i);
             SAFE_RELEASE(p);
@@ -133,6 +165,9 @@ const char* autoBindingToString(RenderState::AutoBinding autoBinding)
     case RenderState::MATRIX_PALETTE:
         return "MATRIX_PALETTE";
 
+    case RenderState::DUAL_QUATERNION_PALETTE:
+        return "DUAL_QUATERNION_PALETTE";
+
     case RenderState::SCENE_AMBIENT_COLOR:
         return "SCENE_AMBIENT_COLOR";
 
@@ -142,6 +177,33 @@ const char* autoBindingToString(RenderState::AutoBinding autoBinding)
     case RenderState::SCENE_LIGHT_DIRECTION:
         return "SCENE_LIGHT_DIRECTION";
 
+    case RenderState::POINT_LIGHT_POSITION:
+        return "POINT_LIGHT_POSITION";
+
+    case RenderState::POINT_LIGHT_COLOR:
+        return "POINT_LIGHT_COLOR";
+
+    case RenderState::POINT_LIGHT_RANGE_INVERSE:
+        return "POINT_LIGHT_RANGE_INVERSE";
+
+    case RenderState::SPOT_LIGHT_POSITION:
+        return "SPOT_LIGHT_POSITION";
+
+    case RenderState::SPOT_LIGHT_DIRECTION:
+        return "SPOT_LIGHT_DIRECTION";
+
+    case RenderState::SPOT_LIGHT_COLOR:
+        return "SPOT_LIGHT_COLOR";
+
+    case RenderState::SPOT_LIGHT_RANGE_INVERSE:
+        return "SPOT_LIGHT_RANGE_INVERSE";
+
+    case RenderState::SPOT_LIGHT_INNER_ANGLE_COS:
+        return "SPOT_LIGHT_INNER_ANGLE_COS";
+
+    case RenderState::SPOT_LIGHT_OUTER_ANGLE_COS:
+        return "SPOT_LIGHT_OUTER_ANGLE_COS";
+
     default:
         return "";
     }
@@ -198,6 +260,14 @@ RenderState::StateBlock* RenderState::getStateBlock() const
     {
         _state = StateBlock::create();
     }
+    else if (_template && _state == _template->_state)
+    {
+        // Copy the StateBlock of the template, since the caller may change it.
+        StateBlock* state = StateBlock::create();
+        _state->cloneInto(state);
+        _state->release();
+        _state = state;
+    }
 
     return _state;
 }
@@ -293,6 +363,10 @@ void RenderState::applyAutoBinding(const char* uniformName, const char* autoBind
         {
             param->bindValue(this, &RenderState::autoBindingGetMatrixPalette, &RenderState::autoBindingGetMatrixPaletteSize);
         }
+        else if (strcmp(autoBinding, "DUAL_QUATERNION_PALETTE") == 0)
+        {
+            param->bindValue(this, &RenderState::autoBindingGetDualQuaternionPalette, &RenderState::autoBindingGetDualQuaternionPaletteSize);
+        }
         else if (strcmp(autoBinding, "SCENE_AMBIENT_COLOR") == 0)
         {
             param->bindValue(this, &RenderState::autoBindingGetAmbientColor);
@@ -305,6 +379,42 @@ void RenderState::applyAutoBinding(const char* uniformName, const char* autoBind
         {
             param->bindValue(this, &RenderState::autoBindingGetLightDirection);
         }
+        else if (strcmp(autoBinding, "POINT_LIGHT_POSITION") == 0)
+        {
+            param->bindValue(this, &RenderState::autoBindingGetPointLightPosition);
+        }
+        else if (strcmp(autoBinding, "POINT_LIGHT_COLOR") == 0)
+        {
+            param->bindValue(this, &RenderState::autoBindingGetPointLightColor);
+        }
+        else if (strcmp(autoBinding, "POINT_LIGHT_RANGE_INVERSE") == 0)
+        {
+            param->bindValue(this, &RenderState::autoBindingGetPointLightRangeInverse);
+        }
+        else if (strcmp(autoBinding, "SPOT_LIGHT_POSITION") == 0)
+        {
+            param->bindValue(this, &RenderState::autoBindingGetSpotLightPosition);
+        }
+        else if (strcmp(autoBinding, "SPOT_LIGHT_DIRECTION") == 0)
+        {
+            param->bindValue(this, &RenderState::autoBindingGetSpotLightDirection);
+        }
+        else if (strcmp(autoBinding, "SPOT_LIGHT_COLOR") == 0)
+        {
+            param->bindValue(this, &RenderState::autoBindingGetSpotLightColor);
+        }
+        else if (strcmp(autoBinding, "SPOT_LIGHT_RANGE_INVERSE") == 0)
+        {
+            param->bindValue(this, &RenderState::autoBindingGetSpotLightRangeInverse);
+        }
+        else if (strcmp(autoBinding, "SPOT_LIGHT_INNER_ANGLE_COS") == 0)
+        {
+            param->bindValue(this, &RenderState::autoBindingGetSpotLightInnerAngleCos);
+        }
+        else if (strcmp(autoBinding, "SPOT_LIGHT_OUTER_ANGLE_COS") == 0)
+        {
+            param->bindValue(this, &RenderState::autoBindingGetSpotLightOuterAngleCos);
+        }
         else
         {
             bound = false;
@@ -384,6 +494,20 @@ unsigned int RenderState::autoBindingGetMatrixPaletteSize() const
     return skin ? skin->getMatrixPaletteSize() : 0;
 }
 
+const Vector4* RenderState::autoBindingGetDualQuaternionPalette() const
+{
+    Model* model = _nodeBinding ? _nodeBinding->getModel() : NULL;
+    MeshSkin* skin = model ? model->getSkin() : NULL;
+    return skin ? skin->getDualQuaternionPalette() : NULL;
+}
+
+unsigned int RenderState::autoBindingGetDualQuaternionPaletteSize() const
+{
+    Model* model = _nodeBinding ? _nodeBinding->getModel() : NULL;
+    MeshSkin* skin = model ? model->getSkin() : NULL;
+    return skin ? skin->getDualQuaternionPaletteSize() : 0;
+}
+
 const Vector3& RenderState::autoBindingGetAmbientColor() const
 {
     Scene* scene = _nodeBinding ? _nodeBinding->getScene() : NULL;
@@ -403,34 +527,104 @@ const Vector3& RenderState::autoBindingGetLightDirection() const
     return scene ? scene->getLightDirection() : down;
 }
 
+Node* RenderState::getAssignedLight(int type) const
+{
+    return _nodeBinding ? _nodeBinding->findAssignedLight((Light::Type)type) : NULL;
+}
+
+Vector3 RenderState::autoBindingGetPointLightPosition() const
+{
+    Node* light = getAssignedLight(Light::POINT);
+    return light ? light->getTranslationView() : Vector3::zero();
+}
+
+Vector3 RenderState::autoBindingGetPointLightColor() const
+{
+    Node* light = getAssignedLight(Light::POINT);
+    return light ? light->getLight()->getColor() : Vector3::zero();
+}
+
+float RenderState::autoBindingGetPointLightRangeInverse() const
+{
+    Node* light = getAssignedLight(Light::POINT);
+    return light ? light->getLight()->getRangeInverse() : 1.0f;
+}
+
+Vector3 RenderState::autoBindingGetSpotLightPosition() const
+{
+    Node* light = getAssignedLight(Light::SPOT);
+    return light ? light->getTranslationView() : Vector3::zero();
+}
+
+Vector3 RenderState::autoBindingGetSpotLightDirection() const
+{
+    Node* light = getAssignedLight(Light::SPOT);
+    if (!light)
+        return Vector3(0, 0, -1);
+    Vector3 direction = light->getForwardVectorView();
+    direction.normalize();
+    return direction;
+}
+
+Vector3 RenderState::autoBindingGetSpotLightColor() const
+{
+    Node* light = getAssignedLight(Light::SPOT);
+    return light ? light->getLight()->getColor() : Vector3::zero();
+}
+
+float RenderState::autoBindingGetSpotLightRangeInverse() const
+{
+    Node* light = getAssignedLight(Light::SPOT);
+    return light ? light->getLight()->getRangeInverse() : 1.0f;
+}
+
+float RenderState::autoBindingGetSpotLightInnerAngleCos() const
+{
+    Node* light = getAssignedLight(Light::SPOT);
+    return light ? light->getLight()->getInnerAngleCos() : 1.0f;
+}
+
+float RenderState::autoBindingGetSpotLightOuterAngleCos() const
+{
+    Node* light = getAssignedLight(Light::SPOT);
+    return light ? light->getLight()->getOuterAngleCos() : 1.0f;
+}
+
 void RenderState::bind(Pass* pass)
 {
     GP_ASSERT(pass);
 
-    // Get the combined modified state bits for our RenderState hierarchy.
-    long stateOverrideBits = _state ? _state->_bits : 0;
-    RenderState* rs = _parent;
-    while (rs)
+    // Apply parameter bindings for the entire hierarchy, top-down.
+    RenderState* rs = NULL;
+    Effect* effect = pass->getEffect();
+    while ((rs = getTopmost(rs)))
     {
-        if (rs->_state)
+        for (size_t i = 0, count = rs->_parameters.size(); i < count; ++i)
         {
-            stateOverrideBits |= rs->_state->_bits;
+            GP_ASSERT(rs->_parameters[i]);
+            rs->_parameters[i]->bind(effect);
         }
-        rs = rs->_parent;
     }
 
-    // Restore renderer state to its default, except for explicitly specified states
-    StateBlock::restore(stateOverrideBits);
+    bindStateBlocks();
+}
 
-    // Apply parameter bindings and renderer state for the entire hierarchy, top-down.
-    rs = NULL;
-    Effect* effect = pass->getEffect();
+void RenderState::bind(Effect* effect, StateBlock* overrides)
+{
+    GP_ASSERT(effect);
+    GP_ASSERT(overrides);
+
+    StateBlock::restore(getStateOverrideBits() | overrides->_bits);
+
+    RenderState* rs = NULL;
     while ((rs = getTopmost(rs)))
     {
         for (size_t i = 0, count = rs->_parameters.size(); i < count; ++i)
         {
-            GP_ASSERT(rs->_parameters[i]);
-            rs->_parameters[i]->bind(effect);
+            MaterialParameter* param = rs->_parameters[i];
+            GP_ASSERT(param);
+            if (effect->getUniform(param->getName()))
+                param->bind(effect);
         }
 
         if (rs->_state)
@@ -438,6 +632,111 @@ void RenderState::bind(Pass* pass)
             rs->_state->bindNoRestore();
         }
     }
+    overrides->bindNoRestore();
+}
+
+void RenderState::bindStateBlocks()
+{
+    // The states are already bound if the last hierarchy bound set the same ones.
+    unsigned int stateId = getStateId();
+    if (stateId == StateBlock::_boundId)
+        return;
+
+    // Restore renderer state to its default, except for explicitly specified states
+    StateBlock::restore(getStateOverrideBits());
+
+    RenderState* rs = NULL;
+    while ((rs = getTopmost(rs)))
+    {
+        if (rs->_state)
+        {
+            rs->_state->bindNoRestore();
+        }
+    }
+    StateBlock::_boundId = stateId;
+}
+
+unsigned int RenderState::getStateId() const
+{
+    // The id is kept until a StateBlock of the hierarchy changes or is replaced, which changes
+    // the generation found at its level. Changes to other hierarchies do not affect it.
+    bool changed = false;
+    unsigned int depth = 0;
+    for (const RenderState* rs = this; rs; rs = rs->_parent, ++depth)
+    {
+        unsigned int generation = rs->_state ? rs->_state->_generation : 0;
+        if (depth >= STATE_ID_CACHE_DEPTH)
+        {
+            changed = true;
+        }
+        else if (_stateGenerations[depth] != generation)
+        {
+            _stateGenerations[depth] = generation;
+            changed = true;
+        }
+    }
+    for (; depth < STATE_ID_CACHE_DEPTH; ++depth)
+    {
+        if (_stateGenerations[depth] != 0)
+        {
+            _stateGenerations[depth] = 0;
+            changed = true;
+        }
+    }
+
+    if (changed)
+    {
+        unsigned long long key = 0;
+        RenderState* rs = NULL;
+        while ((rs = const_cast<RenderState*>(this)->getTopmost(rs)))
+        {
+            if (rs->_state)
+                key = rs->_state->mergeKey(key);
+        }
+        _stateId = StateBlock::getId(key);
+    }
+    return _stateId;
+}
+
+long RenderState::getStateOverrideBits() const
+{
+    // Get the combined modified state bits for our RenderState hierarchy.
+    long stateOverrideBits = _state ? _state->_bits : 0;
+    RenderState* rs = _parent;
+    while (rs)
+    {
+        if (rs->_state)
+        {
+            stateOverrideBits |= rs->_state->_bits;
+        }
+        rs = rs->_parent;
+    }
+    return stateOverrideBits;
+}
+
+bool RenderState::isBlendEnabled() const
+{
+    return (getStateOverrideBits() & RS_BLEND) != 0;
+}
+
+bool RenderState::isDepthWriteEnabled() const
+{
+    // The closest state block that sets a state overrides those of its parents.
+    long found = 0;
+    bool depthTest = false;
+    bool depthWrite = true;
+    for (const RenderState* rs = this; rs; rs = rs->_parent)
+    {
+        StateBlock* state = rs->_state;
+        if (state == NULL)
+            continue;
+        if ((state->_bits & RS_DEPTH_TEST) && !(found & RS_DEPTH_TEST))
+            depthTest = state->_depthTestEnabled;
+        if ((state->_bits & RS_DEPTH_WRITE) && !(found & RS_DEPTH_WRITE))
+            depthWrite = state->_depthWriteEnabled;
+        found |= state->_bits;
+    }
+    return depthTest && depthWrite;
 }
 
 RenderState* RenderState::getTopmost(RenderState* below)
@@ -462,10 +761,40 @@ RenderState* RenderState::getTopmost(RenderState* below)
     return NULL;
 }
 
+void RenderState::shareFrom(RenderState* source)
+{
+    GP_ASSERT(source);
+    GP_ASSERT(_parameters.empty() && _template == NULL);
+
+    _template = source;
+    _autoBindings = source->_autoBindings;
+    for (size_t i = 0, count = source->_parameters.size(); i < count; ++i)
+    {
+        MaterialParameter* param = source->_parameters[i];
+        GP_ASSERT(param);
+
+        // Auto bindings are applied to each instance for its own node.
+        if (param->_type == MaterialParameter::METHOD && param->_value.method && param->_value.method->_autoBinding)
+            continue;
+
+        param->addRef();
+        _parameters.push_back(param);
+    }
+    setStateBlock(source->_state);
+}
+
+bool RenderState::isSharedParameter(const MaterialParameter* param) const
+{
+    return _template && std::find(_template->_parameters.begin(), _template->_parameters.end(), param) != _template->_parameters.end();
+}
+
 void RenderState::cloneInto(RenderState* renderState, NodeCloneContext& context) const
 {
     GP_ASSERT(renderState);
 
+    // A clone of an instance shares the same template.
+    renderState->_template = _template;
+
     // Clone parameters
     for (std::map<std::string, std::string>::const_iterator it = _autoBindings.begin(); it != _autoBindings.end(); ++it)
     {
@@ -481,14 +810,25 @@ void RenderState::cloneInto(RenderState* renderState, NodeCloneContext& context)
         if (param->_type == MaterialParameter::METHOD && param->_value.method && param->_value.method->_autoBinding)
             continue;
 
+        if (isSharedParameter(param))
+        {
+            const_cast<MaterialParameter*>(param)->addRef();
+            renderState->_parameters.push_back(const_cast<MaterialParameter*>(param));
+            continue;
+        }
+
         MaterialParameter* paramCopy = new MaterialParameter(param->getName());
         param->cloneInto(paramCopy);
 
         renderState->_parameters.push_back(paramCopy);
     }
 
-    // Clone our state block
-    if (_state)
+    // Clone our state block, or share the template's.
+    if (_state && _template && _state == _template->_state)
+    {
+        renderState->setStateBlock(_state);
+    }
+    else if (_state)
     {
         _state->cloneInto(renderState->getStateBlock());
     }
@@ -501,7 +841,7 @@ void RenderState::cloneInto(RenderState* renderState, NodeCloneContext& context)
 RenderState::StateBlock::StateBlock()
     : _cullFaceEnabled(false), _depthTestEnabled(false), _depthWriteEnabled(true), _depthFunction(RenderState::DEPTH_LESS),
       _blendEnabled(false), _blendSrc(RenderState::BLEND_ONE), _blendDst(RenderState::BLEND_ZERO),
-      _bits(0L)
+      _bits(0L), _generation(++_nextGeneration)
 {
 }
 
@@ -583,6 +923,7 @@ void RenderState::StateBlock::bindNoRestore()
     }
 
     _defaultState->_bits |= _bits;
+    _boundId = STATE_ID_UNKNOWN;
 }
 
 void RenderState::StateBlock::restore(long stateOverrideBits)
@@ -594,6 +935,7 @@ void RenderState::StateBlock::restore(long stateOverrideBits)
     {
         return;
     }
+    _boundId = STATE_ID_UNKNOWN;
 
     // Restore any state that is not overridden and is not default
     if (!(stateOverrideBits & RS_BLEND) && (_defaultState->_bits & RS_BLEND))
@@ -653,6 +995,7 @@ void RenderState::StateBlock::enableDepthWrite()
         GL_ASSERT( glDepthMask(GL_TRUE) );
         _defaultState->_bits &= ~RS_DEPTH_WRITE;
         _defaultState->_depthWriteEnabled = true;
+        _boundId = STATE_ID_UNKNOWN;
     }
 }
 
@@ -669,6 +1012,45 @@ void RenderState::StateBlock::cloneInto(StateBlock* state)
     state->_blendDst = _blendDst;
     state->_cullFaceSide = _cullFaceSide;
     state->_bits = _bits;
+    state->_generation = ++_nextGeneration;
+}
+
+unsigned long long RenderState::StateBlock::mergeKey(unsigned long long key) const
+{
+    key |= (unsigned long long)(_bits & 0xFF);
+    if (_bits & RS_BLEND)
+        key = (key & ~(1ULL << STATE_KEY_BLEND_SHIFT)) | ((unsigned long long)_blendEnabled << STATE_KEY_BLEND_SHIFT);
+    if (_bits & RS_BLEND_FUNC)
+    {
+        key = (key & ~(0xFFFFFFFFULL << STATE_KEY_BLEND_SRC_SHIFT)) |
+            ((unsigned long long)(_blendSrc & 0xFFFF) << STATE_KEY_BLEND_SRC_SHIFT) |
+            ((unsigned long long)(_blendDst & 0xFFFF) << STATE_KEY_BLEND_DST_SHIFT);
+    }
+    if (_bits & RS_CULL_FACE)
+        key = (key & ~(1ULL << STATE_KEY_CULL_FACE_SHIFT)) | ((unsigned long long)_cullFaceEnabled << STATE_KEY_CULL_FACE_SHIFT);
+    if (_bits & RS_CULL_FACE_SIDE)
+        key = (key & ~(0xFFULL << STATE_KEY_CULL_FACE_SIDE_SHIFT)) | ((unsigned long long)(_cullFaceSide & 0xFF) << STATE_KEY_CULL_FACE_SIDE_SHIFT);
+    if (_bits & RS_DEPTH_TEST)
+        key = (key & ~(1ULL << STATE_KEY_DEPTH_TEST_SHIFT)) | ((unsigned long long)_depthTestEnabled << STATE_KEY_DEPTH_TEST_SHIFT);
+    if (_bits & RS_DEPTH_WRITE)
+        key = (key & ~(1ULL << STATE_KEY_DEPTH_WRITE_SHIFT)) | ((unsigned long long)_depthWriteEnabled << STATE_KEY_DEPTH_WRITE_SHIFT);
+    if (_bits & RS_DEPTH_FUNC)
+        key = (key & ~(0xFFULL << STATE_KEY_DEPTH_FUNC_SHIFT)) | ((unsigned long long)(_depthFunction & 0xFF) << STATE_KEY_DEPTH_FUNC_SHIFT);
+    return key;
+}
+
+unsigned int RenderState::StateBlock::getId(unsigned long long key)
+{
+    static std::map<unsigned long long, unsigned int> ids;
+    if (key == 0)
+        return 0;
+
+    std::map<unsigned long long, unsigned int>::iterator itr = ids.find(key);
+    if (itr != ids.end())
+        return itr->second;
+    unsigned int id = (unsigned int)ids.size() + 1;
+    ids[key] = id;
+    return id;
 }
 
 static bool parseBoolean(const char* value)
@@ -821,6 +1203,7 @@ void RenderState::StateBlock::setState(const char* name, const char* value)
 
 void RenderState::StateBlock::setBlend(bool enabled)
 {
+    _generation = ++_nextGeneration;
     _blendEnabled = enabled;
     if (!enabled)
     {
@@ -834,6 +1217,7 @@ void RenderState::StateBlock::setBlend(bool enabled)
 
 void RenderState::StateBlock::setBlendSrc(Blend blend)
 {
+    _generation = ++_nextGeneration;
     _blendSrc = blend;
     if (_blendSrc == BLEND_ONE && _blendDst == BLEND_ZERO)
     {
@@ -848,6 +1232,7 @@ void RenderState::StateBlock::setBlendSrc(Blend blend)
 
 void RenderState::StateBlock::setBlendDst(Blend blend)
 {
+    _generation = ++_nextGeneration;
     _blendDst = blend;
     if (_blendSrc == BLEND_ONE && _blendDst == BLEND_ZERO)
     {
@@ -862,6 +1247,7 @@ void RenderState::StateBlock::setBlendDst(Blend blend)
 
 void RenderState::StateBlock::setCullFace(bool enabled)
 {
+    _generation = ++_nextGeneration;
     _cullFaceEnabled = enabled;
     if (!enabled)
     {
@@ -875,6 +1261,7 @@ void RenderState::StateBlock::setCullFace(bool enabled)
 
 void RenderState::StateBlock::setCullFaceSide(CullFaceSide side)
 {
+    _generation = ++_nextGeneration;
     _cullFaceSide = side;
     if (_cullFaceSide == CULL_FACE_SIDE_BACK)
     {
@@ -889,6 +1276,7 @@ void RenderState::StateBlock::setCullFaceSide(CullFaceSide side)
 
 void RenderState::StateBlock::setDepthTest(bool enabled)
 {
+    _generation = ++_nextGeneration;
     _depthTestEnabled = enabled;
     if (!enabled)
     {
@@ -902,6 +1290,7 @@ void RenderState::StateBlock::setDepthTest(bool enabled)
 
 void RenderState::StateBlock::setDepthWrite(bool enabled)
 {
+    _generation = ++_nextGeneration;
     _depthWriteEnabled = enabled;
     if (enabled)
     {
@@ -915,6 +1304,7 @@ void RenderState::StateBlock::setDepthWrite(bool enabled)
 
 void RenderState::StateBlock::setDepthFunction(DepthFunction func)
 {
+    _generation = ++_nextGeneration;
     _depthFunction = func;
     if (_depthFunction == DEPTH_LESS)
     {
@@ -8,6 +8,7 @@
 namespace gameplay
 {
 
+class Effect;
 class MaterialParameter;
 class Node;
 class NodeCloneContext;
@@ -23,6 +24,10 @@ class RenderState : public Ref
     friend class Technique;
     friend class Pass;
     friend class Model;
+    friend class RenderQueue;
+    friend class FramePacket;
+    friend class TextureStreamer;
+    friend class EffectWarmup;
 
 public:
 
@@ -88,6 +93,11 @@ public:
          */
         MATRIX_PALETTE,
 
+        /**
+         * Binds the dual quaternion palette of MeshSkin attached to a node's model.
+         */
+        DUAL_QUATERNION_PALETTE,
+
         /**
          * Binds the current scene's ambient color (Vector3).
          */
@@ -105,7 +115,60 @@ public:
          *
          * This is typically used for the main directional light in a scene, such as the Sun.
          */
-        SCENE_LIGHT_DIRECTION
+        SCENE_LIGHT_DIRECTION,
+
+        /**
+         * Binds the view space position of the most influential point light assigned
+         * to the node (Vector3).
+         *
+         * Lights are assigned to nodes by Scene::assignLights. This and the following light
+         * bindings resolve to a light with no effect when no light of the type is assigned.
+         */
+        POINT_LIGHT_POSITION,
+
+        /**
+         * Binds the color of the most influential point light assigned to the node (Vector3).
+         */
+        POINT_LIGHT_COLOR,
+
+        /**
+         * Binds the inverse range of the most influential point light assigned to the node (float).
+         */
+        POINT_LIGHT_RANGE_INVERSE,
+
+        /**
+         * Binds the view space position of the most influential spot light assigned
+         * to the node (Vector3).
+         */
+        SPOT_LIGHT_POSITION,
+
+        /**
+         * Binds the view space direction of the most influential spot light assigned
+         * to the node (Vector3).
+         */
+        SPOT_LIGHT_DIRECTION,
+
+        /**
+         * Binds the color of the most influential spot light assigned to the node (Vector3).
+         */
+        SPOT_LIGHT_COLOR,
+
+        /**
+         * Binds the inverse range of the most influential spot light assigned to the node (float).
+         */
+        SPOT_LIGHT_RANGE_INVERSE,
+
+        /**
+         * Binds the cosine of the inner angle of the most influential spot light assigned
+         * to the node (float).
+         */
+        SPOT_LIGHT_INNER_ANGLE_COS,
+
+        /**
+         * Binds the cosine of the outer angle of the most influential spot light assigned
+         * to the node (float).
+         */
+        SPOT_LIGHT_OUTER_ANGLE_COS
     };
 
     /**
@@ -308,6 +371,18 @@ public:
 
         void cloneInto(StateBlock* state);
 
+        /**
+         * Packs the states this block sets into a key of the combined states of a hierarchy of
+         * blocks, over the values set by the blocks above it.
+         */
+        unsigned long long mergeKey(unsigned long long key) const;
+
+        /**
+         * Returns the id of a key of combined states. Keys are interned, so hierarchies that set
+         * the same states to the same values have the same id, and the default state has id 0.
+         */
+        static unsigned int getId(unsigned long long key);
+
         // States
         bool _cullFaceEnabled;
         bool _depthTestEnabled;
@@ -318,8 +393,11 @@ public:
         Blend _blendDst;
         CullFaceSide _cullFaceSide;
         long _bits;
+        unsigned int _generation;           // Changed whenever the states of this block change; unique across blocks.
 
         static StateBlock* _defaultState;
+        static unsigned int _boundId;       // The id of the states last bound by a RenderState, or STATE_ID_UNKNOWN.
+        static unsigned int _nextGeneration;
     };
 
     /**
@@ -473,6 +551,43 @@ protected:
      */
     void bind(Pass* pass);
 
+    /**
+     * Binds the render state for this RenderState and any of its parents with the states
+     * of a block that override them, and sets the parameters of the hierarchy that have
+     * a uniform in the given effect, which may be another effect than that of the pass.
+     */
+    void bind(Effect* effect, StateBlock* overrides);
+
+    /**
+     * Binds the state blocks of this RenderState and any of its parents, without setting
+     * their parameters.
+     */
+    void bindStateBlocks();
+
+    /**
+     * Returns the combined state override bits of the StateBlocks in this RenderState hierarchy.
+     */
+    long getStateOverrideBits() const;
+
+    /**
+     * Returns the id of the combined states of the StateBlocks in this RenderState hierarchy.
+     *
+     * Hierarchies that set the same states to the same values have the same id, so binding
+     * them after each other sets no states, and the id is a compact key to sort draws by.
+     */
+    unsigned int getStateId() const;
+
+    /**
+     * Determines whether blending is enabled by any StateBlock in this RenderState hierarchy.
+     */
+    bool isBlendEnabled() const;
+
+    /**
+     * Determines whether the StateBlocks in this RenderState hierarchy enable both the
+     * depth test and depth writes.
+     */
+    bool isDepthWriteEnabled() const;
+
     /**
      * Returns the topmost RenderState in the hierarchy below the given RenderState.
      */
@@ -486,6 +601,19 @@ protected:
      */
     void cloneInto(RenderState* renderState, NodeCloneContext& context) const;
 
+    /**
+     * Makes this RenderState an instance of the given one, sharing its parameters and
+     * StateBlock until they are accessed to be changed.
+     *
+     * @param source The RenderState to share.
+     */
+    void shareFrom(RenderState* source);
+
+    /**
+     * Determines whether a parameter of this RenderState is shared with its template.
+     */
+    bool isSharedParameter(const MaterialParameter* param) const;
+
 private:
 
     /**
@@ -511,9 +639,21 @@ private:
     Vector3 autoBindingGetCameraViewPosition() const;
     const Vector4* autoBindingGetMatrixPalette() const;
     unsigned int autoBindingGetMatrixPaletteSize() const;
+    const Vector4* autoBindingGetDualQuaternionPalette() const;
+    unsigned int autoBindingGetDualQuaternionPaletteSize() const;
     const Vector3& autoBindingGetAmbientColor() const;
     const Vector3& autoBindingGetLightColor() const;
     const Vector3& autoBindingGetLightDirection() const;
+    Node* getAssignedLight(int type) const;
+    Vector3 autoBindingGetPointLightPosition() const;
+    Vector3 autoBindingGetPointLightColor() const;
+    float autoBindingGetPointLightRangeInverse() const;
+    Vector3 autoBindingGetSpotLightPosition() const;
+    Vector3 autoBindingGetSpotLightDirection() const;
+    Vector3 autoBindingGetSpotLightColor() const;
+    float autoBindingGetSpotLightRangeInverse() const;
+    float autoBindingGetSpotLightInnerAngleCos() const;
+    float autoBindingGetSpotLightOuterAngleCos() const;
 
 protected:
 
@@ -542,6 +682,25 @@ protected:
      */
     RenderState* _parent;
 
+    /**
+     * The RenderState this one is an instance of, whose parameters and StateBlock it shares
+     * until they are changed, or NULL.
+     */
+    RenderState* _template;
+
+    /**
+     * The number of levels of a hierarchy whose StateBlock generations are cached with its state id
+     * (a pass, its technique and its material). The ids of deeper hierarchies are not cached.
+     */
+    static const unsigned int STATE_ID_CACHE_DEPTH = 3;
+
+    /**
+     * The id of the combined states of the hierarchy, and the generations of the StateBlocks of
+     * this RenderState and its parents it was computed from, or 0 for levels without a StateBlock.
+     */
+    mutable unsigned int _stateId;
+    mutable unsigned int _stateGenerations[STATE_ID_CACHE_DEPTH];
+
     /**
      * Map of custom auto binding resolvers.
      */
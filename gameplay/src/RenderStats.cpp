@@ -0,0 +1,134 @@
+#include "Base.h"
+#include "RenderStats.h"
+#include "Font.h"
+
+// The font drawn with when none is given.
+#define RENDER_STATS_DEFAULT_FONT "res/ui/arial.gpb"
+
+namespace gameplay
+{
+
+static unsigned int __counts[RenderStats::COUNTER_COUNT];
+static unsigned int __lastCounts[RenderStats::COUNTER_COUNT];
+static unsigned int __budgets[RenderStats::COUNTER_COUNT];
+static Font* __defaultFont = NULL;
+static bool __defaultFontLoaded = false;
+
+void RenderStats::add(Counter counter, unsigned int count)
+{
+    GP_ASSERT(counter < COUNTER_COUNT);
+    __counts[counter] += count;
+}
+
+void RenderStats::addDraw(GLenum mode, unsigned int count, unsigned int instances)
+{
+    unsigned int triangles = 0;
+    switch (mode)
+    {
+    case GL_TRIANGLES:
+        triangles = count / 3;
+        break;
+    case GL_TRIANGLE_STRIP:
+    case GL_TRIANGLE_FAN:
+        triangles = count > 2 ? count - 2 : 0;
+        break;
+    default:
+        break;
+    }
+    ++__counts[DRAW_CALLS];
+    __counts[TRIANGLES] += triangles * instances;
+}
+
+unsigned int RenderStats::getCount(Counter counter)
+{
+    GP_ASSERT(counter < COUNTER_COUNT);
+    return __lastCounts[counter];
+}
+
+const char* RenderStats::getName(Counter counter)
+{
+    switch (counter)
+    {
+    case DRAW_CALLS:
+        return "Draw calls";
+    case TRIANGLES:
+        return "Triangles";
+    case STATE_CHANGES:
+        return "State changes";
+    case UNIFORM_UPLOADS:
+        return "Uniform uploads";
+    case TEXTURE_BINDS:
+        return "Texture binds";
+    case BUFFER_UPLOADS:
+        return "Buffer uploads";
+    case VISIBLE_NODES:
+        return "Visible nodes";
+    case TERRAIN_PATCHES:
+        return "Terrain patches";
+    default:
+        return "";
+    }
+}
+
+void RenderStats::setBudget(Counter counter, unsigned int budget)
+{
+    GP_ASSERT(counter < COUNTER_COUNT);
+    __budgets[counter] = budget;
+}
+
+unsigned int RenderStats::getBudget(Counter counter)
+{
+    GP_ASSERT(counter < COUNTER_COUNT);
+    return __budgets[counter];
+}
+
+bool RenderStats::isOverBudget(Counter counter)
+{
+    GP_ASSERT(counter < COUNTER_COUNT);
+    return __budgets[counter] > 0 && __lastCounts[counter] > __budgets[counter];
+}
+
+void RenderStats::draw(Font* font, int x, int y, const Vector4& color)
+{
+    if (font == NULL)
+    {
+        // The default font is only looked for once, so a missing font warns once.
+        if (!__defaultFontLoaded)
+        {
+            __defaultFontLoaded = true;
+            __defaultFont = Font::create(RENDER_STATS_DEFAULT_FONT);
+        }
+        font = __defaultFont;
+        if (font == NULL)
+            return;
+    }
+
+    static const Vector4 overBudgetColor(1.0f, 0.25f, 0.25f, 1.0f);
+    char line[128];
+    int lineHeight = (int)font->getSize();
+    font->start();
+    for (unsigned int i = 0; i < COUNTER_COUNT; ++i)
+    {
+        Counter counter = (Counter)i;
+        if (__budgets[i] > 0)
+            sprintf(line, "%-16s %8u / %u", getName(counter), __lastCounts[i], __budgets[i]);
+        else
+            sprintf(line, "%-16s %8u", getName(counter), __lastCounts[i]);
+        font->drawText(line, x, y + (int)i * lineHeight, isOverBudget(counter) ? overBudgetColor : color);
+    }
+    font->finish();
+}
+
+void RenderStats::beginFrame()
+{
+    memcpy(__lastCounts, __counts, sizeof(__counts));
+    memset(__counts, 0, sizeof(__counts));
+}
+
+void RenderStats::finalize()
+{
+    SAFE_RELEASE(__defaultFont);
+    __defaultFontLoaded = false;
+}
+
+}
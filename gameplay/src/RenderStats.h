@@ -0,0 +1,172 @@
+#ifndef RENDERSTATS_H_
+#define RENDERSTATS_H_
+
+#include "Base.h"
+#include "Vector4.h"
+
+namespace gameplay
+{
+
+class Font;
+
+/**
+ * Defines per-frame counters of the rendering work done by the engine.
+ *
+ * The counters are incremented as the engine draws, and are reset at the start of each
+ * frame by Game. The values returned by getCount() are those of the last complete frame.
+ * A budget can be set for each counter, which the overlay drawn by draw() highlights
+ * when it is exceeded, so that content can be checked against per-level limits.
+ *
+ * @script{ignore}
+ */
+class RenderStats
+{
+    friend class Game;
+
+public:
+
+    /**
+     * The counters of a frame.
+     */
+    enum Counter
+    {
+        /**
+         * The number of draw calls.
+         */
+        DRAW_CALLS,
+
+        /**
+         * The number of triangles drawn, counting instances.
+         */
+        TRIANGLES,
+
+        /**
+         * The number of passes bound, each of which binds an effect and render state.
+         */
+        STATE_CHANGES,
+
+        /**
+         * The number of material parameters uploaded to uniforms.
+         */
+        UNIFORM_UPLOADS,
+
+        /**
+         * The number of texture binds that reached OpenGL.
+         */
+        TEXTURE_BINDS,
+
+        /**
+         * The number of vertex and index buffer uploads.
+         */
+        BUFFER_UPLOADS,
+
+        /**
+         * The number of nodes found visible by Scene::findVisibleNodes.
+         */
+        VISIBLE_NODES,
+
+        /**
+         * The number of terrain patches drawn.
+         */
+        TERRAIN_PATCHES,
+
+        /**
+         * The number of counters.
+         */
+        COUNTER_COUNT
+    };
+
+    /**
+     * Adds to a counter of the current frame.
+     *
+     * @param counter The counter.
+     * @param count The amount to add.
+     */
+    static void add(Counter counter, unsigned int count = 1);
+
+    /**
+     * Counts a draw call and the triangles it draws.
+     *
+     * @param mode The primitive type, such as GL_TRIANGLES.
+     * @param count The number of vertices or indices drawn.
+     * @param instances The number of instances drawn.
+     */
+    static void addDraw(GLenum mode, unsigned int count, unsigned int instances = 1);
+
+    /**
+     * Returns the value of a counter in the last complete frame.
+     *
+     * @param counter The counter.
+     *
+     * @return The value of the counter.
+     */
+    static unsigned int getCount(Counter counter);
+
+    /**
+     * Returns the name of a counter.
+     *
+     * @param counter The counter.
+     *
+     * @return The name, such as "Draw calls".
+     */
+    static const char* getName(Counter counter);
+
+    /**
+     * Sets the budget of a counter.
+     *
+     * @param counter The counter.
+     * @param budget The largest value allowed per frame, or 0 for no budget.
+     */
+    static void setBudget(Counter counter, unsigned int budget);
+
+    /**
+     * Returns the budget of a counter.
+     *
+     * @param counter The counter.
+     *
+     * @return The largest value allowed per frame, or 0 if there is no budget.
+     */
+    static unsigned int getBudget(Counter counter);
+
+    /**
+     * Determines whether a counter exceeded its budget in the last complete frame.
+     *
+     * @param counter The counter.
+     *
+     * @return True if the counter has a budget and exceeded it.
+     */
+    static bool isOverBudget(Counter counter);
+
+    /**
+     * Draws the counters of the last complete frame, with those over budget in red.
+     *
+     * The work of drawing the overlay is counted in the current frame.
+     *
+     * @param font The font to draw with, or NULL to use the default font "res/ui/arial.gpb".
+     * @param x The left of the text in pixels.
+     * @param y The top of the text in pixels.
+     * @param color The color of the counters within budget.
+     */
+    static void draw(Font* font = NULL, int x = 0, int y = 0, const Vector4& color = Vector4::one());
+
+private:
+
+    /**
+     * Hidden constructor.
+     */
+    RenderStats();
+
+    /**
+     * Called by Game at the start of each frame to keep the counters of the last frame.
+     */
+    static void beginFrame();
+
+    /**
+     * Called by Game during shutdown to release the default font.
+     */
+    static void finalize();
+};
+
+}
+
+#endif
@@ -0,0 +1,174 @@
+#include "Base.h"
+#include "RenderTargetPool.h"
+
+// The ID of the frame buffers and targets created by the pool.
+#define RENDER_TARGET_POOL_ID "org.gameplay3d.rendertargetpool"
+
+// The default number of frames a released frame buffer is kept for.
+#define RENDER_TARGET_POOL_DEFAULT_MAX_IDLE_FRAMES 120
+
+namespace gameplay
+{
+
+/**
+ * A frame buffer of the pool and the key it is acquired by.
+ */
+struct RenderTargetPoolEntry
+{
+    FrameBuffer* frameBuffer;
+    unsigned int width;
+    unsigned int height;
+    Texture::Format format;
+    bool depthStencil;
+    bool acquired;
+    unsigned int releasedFrame;
+};
+
+static std::vector<RenderTargetPoolEntry> __entries;
+static unsigned int __frame = 0;
+static unsigned int __maxIdleFrames = RENDER_TARGET_POOL_DEFAULT_MAX_IDLE_FRAMES;
+
+FrameBuffer* RenderTargetPool::createFrameBuffer(unsigned int width, unsigned int height, Texture::Format format, bool depthStencil)
+{
+    Texture* texture = Texture::create(format, width, height, NULL, false);
+    if (texture == NULL)
+    {
+        GP_ERROR("Failed to create texture for pooled render target.");
+        return NULL;
+    }
+    RenderTarget* renderTarget = RenderTarget::create(RENDER_TARGET_POOL_ID, texture);
+    SAFE_RELEASE(texture);
+
+    FrameBuffer* frameBuffer = FrameBuffer::create(RENDER_TARGET_POOL_ID);
+    GP_ASSERT(frameBuffer);
+    frameBuffer->_width = width;
+    frameBuffer->_height = height;
+    frameBuffer->setRenderTarget(renderTarget);
+    SAFE_RELEASE(renderTarget);
+
+    if (depthStencil)
+    {
+        DepthStencilTarget* target = DepthStencilTarget::create(RENDER_TARGET_POOL_ID, DepthStencilTarget::DEPTH_STENCIL, width, height);
+        frameBuffer->setDepthStencilTarget(target);
+        SAFE_RELEASE(target);
+    }
+
+    return frameBuffer;
+}
+
+FrameBuffer* RenderTargetPool::acquire(unsigned int width, unsigned int height, Texture::Format format, bool depthStencil)
+{
+    GP_ASSERT(width > 0 && height > 0);
+
+    for (size_t i = 0, count = __entries.size(); i < count; ++i)
+    {
+        RenderTargetPoolEntry& entry = __entries[i];
+        if (!entry.acquired && entry.width == width && entry.height == height &&
+            entry.format == format && entry.depthStencil == depthStencil)
+        {
+            entry.acquired = true;
+            entry.frameBuffer->addRef();
+            return entry.frameBuffer;
+        }
+    }
+
+    FrameBuffer* frameBuffer = createFrameBuffer(width, height, format, depthStencil);
+    if (frameBuffer == NULL)
+        return NULL;
+
+    // The pool keeps its own reference, and the caller's is given back by release().
+    RenderTargetPoolEntry entry;
+    entry.frameBuffer = frameBuffer;
+    entry.width = width;
+    entry.height = height;
+    entry.format = format;
+    entry.depthStencil = depthStencil;
+    entry.acquired = true;
+    entry.releasedFrame = 0;
+    __entries.push_back(entry);
+
+    frameBuffer->addRef();
+    return frameBuffer;
+}
+
+void RenderTargetPool::release(FrameBuffer* frameBuffer)
+{
+    if (frameBuffer == NULL)
+        return;
+
+    for (size_t i = 0, count = __entries.size(); i < count; ++i)
+    {
+        RenderTargetPoolEntry& entry = __entries[i];
+        if (entry.frameBuffer == frameBuffer)
+        {
+            GP_ASSERT(entry.acquired);
+            entry.acquired = false;
+            entry.releasedFrame = __frame;
+            break;
+        }
+    }
+
+    // A frame buffer acquired before the pool was finalized is no longer in it.
+    frameBuffer->release();
+}
+
+void RenderTargetPool::setMaxIdleFrames(unsigned int frames)
+{
+    __maxIdleFrames = frames;
+}
+
+unsigned int RenderTargetPool::getMaxIdleFrames()
+{
+    return __maxIdleFrames;
+}
+
+unsigned int RenderTargetPool::getFrameBufferCount()
+{
+    return __entries.size();
+}
+
+void RenderTargetPool::clear()
+{
+    for (size_t i = 0; i < __entries.size();)
+    {
+        if (__entries[i].acquired)
+        {
+            ++i;
+        }
+        else
+        {
+            SAFE_RELEASE(__entries[i].frameBuffer);
+            __entries.erase(__entries.begin() + i);
+        }
+    }
+}
+
+void RenderTargetPool::beginFrame()
+{
+    ++__frame;
+    for (size_t i = 0; i < __entries.size();)
+    {
+        const RenderTargetPoolEntry& entry = __entries[i];
+        if (entry.acquired || __frame - entry.releasedFrame <= __maxIdleFrames)
+        {
+            ++i;
+        }
+        else
+        {
+            SAFE_RELEASE(__entries[i].frameBuffer);
+            __entries.erase(__entries.begin() + i);
+        }
+    }
+}
+
+void RenderTargetPool::finalize()
+{
+    // The frame buffers still acquired are deleted when their holders release them.
+    for (size_t i = 0, count = __entries.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(__entries[i].frameBuffer);
+    }
+    __entries.clear();
+}
+
+}
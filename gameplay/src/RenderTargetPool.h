@@ -0,0 +1,112 @@
+#ifndef RENDERTARGETPOOL_H_
+#define RENDERTARGETPOOL_H_
+
+#include "Base.h"
+#include "FrameBuffer.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a pool of frame buffers for transient off-screen rendering.
+ *
+ * Each frame buffer in the pool has a single render target and, optionally, a depth-stencil
+ * target. A frame buffer is acquired for a size and format, and released back to the pool
+ * once it is no longer drawn to or read from. Acquiring reuses a released frame buffer of
+ * the same size and format when there is one, so post-processing passes and forms that
+ * allocate their targets each frame, or on each resize, do not create new GL objects.
+ *
+ * Released frame buffers that have not been acquired again for a number of frames are
+ * deleted, so the pool does not keep the targets of sizes that are no longer used.
+ *
+ @verbatim
+    FrameBuffer* blur = RenderTargetPool::acquire(width / 2, height / 2);
+    FrameBuffer* previous = blur->bind();
+    // ... draw ...
+    previous->bind();
+    // ... draw with blur->getRenderTarget()->getTexture() ...
+    RenderTargetPool::release(blur);
+ @endverbatim
+ *
+ * @script{ignore}
+ */
+class RenderTargetPool
+{
+    friend class Game;
+
+public:
+
+    /**
+     * Acquires a frame buffer from the pool, creating one if none of the released frame
+     * buffers matches.
+     *
+     * The attachments of the frame buffer must not be changed. Its contents are undefined.
+     *
+     * @param width The width of the render target.
+     * @param height The height of the render target.
+     * @param format The format of the render target.
+     * @param depthStencil True to attach a depth-stencil target of the same size.
+     *
+     * @return The frame buffer, which must be given back with release().
+     */
+    static FrameBuffer* acquire(unsigned int width, unsigned int height, Texture::Format format = Texture::RGBA, bool depthStencil = false);
+
+    /**
+     * Releases a frame buffer acquired from the pool, so that it can be acquired again.
+     *
+     * @param frameBuffer The frame buffer returned by acquire().
+     */
+    static void release(FrameBuffer* frameBuffer);
+
+    /**
+     * Sets the number of frames a released frame buffer is kept for without being acquired.
+     *
+     * @param frames The number of frames. The default is 120.
+     */
+    static void setMaxIdleFrames(unsigned int frames);
+
+    /**
+     * Returns the number of frames a released frame buffer is kept for without being acquired.
+     *
+     * @return The number of frames.
+     */
+    static unsigned int getMaxIdleFrames();
+
+    /**
+     * Returns the number of frame buffers in the pool, acquired or released.
+     *
+     * @return The number of frame buffers.
+     */
+    static unsigned int getFrameBufferCount();
+
+    /**
+     * Deletes the released frame buffers. Acquired frame buffers remain in the pool.
+     */
+    static void clear();
+
+private:
+
+    /**
+     * Hidden constructor.
+     */
+    RenderTargetPool();
+
+    /**
+     * Creates a frame buffer with a render target, and optionally a depth-stencil target.
+     */
+    static FrameBuffer* createFrameBuffer(unsigned int width, unsigned int height, Texture::Format format, bool depthStencil);
+
+    /**
+     * Called by Game at the start of each frame to delete the frame buffers idle for too long.
+     */
+    static void beginFrame();
+
+    /**
+     * Called by Game during shutdown to delete the frame buffers of the pool.
+     */
+    static void finalize();
+};
+
+}
+
+#endif
@@ -1,11 +1,18 @@
 #include "Base.h"
 #include "AudioListener.h"
 #include "Scene.h"
+#include "StringId.h"
+#include "RenderStats.h"
 #include "SceneLoader.h"
 #include "MeshSkin.h"
+#include "MeshPart.h"
 #include "Joint.h"
 #include "Terrain.h"
 #include "Bundle.h"
+#include "Game.h"
+
+// The minimum number of nodes at a depth for their world matrices to be updated in parallel.
+#define PARALLEL_MIN_NODES 256
 
 namespace gameplay
 {
@@ -61,7 +68,9 @@ static bool endsWith(const char* str, const char* suffix, bool ignoreCase)
 
 Scene::Scene(const char* id)
     : _id(id ? id : ""), _activeCamera(NULL), _firstNode(NULL), _lastNode(NULL), _nodeCount(0), 
-    _lightColor(1,1,1), _lightDirection(0,-1,0), _bindAudioListenerToCamera(true), _debugBatch(NULL)
+    _lightColor(1,1,1), _lightDirection(0,-1,0), _bindAudioListenerToCamera(true), _debugBatch(NULL),
+    _flatRevision(0), _componentHierarchyRevision(0), _componentRevision(0), _componentsIndexed(false),
+    _indexHierarchyRevision(0), _indexIdRevision(0), _indexed(false)
 {
     __sceneList.push_back(this);
 }
@@ -111,6 +120,11 @@ Scene* Scene::load(const char* filePath)
     return SceneLoader::load(filePath);
 }
 
+bool Scene::bake(const char* url, const char* path)
+{
+    return SceneLoader::bake(url, path);
+}
+
 Scene* Scene::getScene(const char* id)
 {
     if (id == NULL)
@@ -139,11 +153,28 @@ Node* Scene::findNode(const char* id, bool recursive, bool exactMatch) const
 {
     GP_ASSERT(id);
 
+    // A string that was never interned is not the ID of any node.
+    unsigned int idAtom = StringId::find(id);
+    if (exactMatch && idAtom == 0 && *id != '\0')
+        return NULL;
+
+    if (recursive && exactMatch)
+    {
+        updateNodeIndex();
+        std::map<unsigned int, Node*>::const_iterator itr = _idIndex.find(idAtom);
+        if (itr == _idIndex.end())
+            return NULL;
+        if (itr->second)
+            return itr->second;
+
+        // The ID is shared by several nodes, so find the first one in the hierarchy.
+    }
+
     // Search immediate children first.
     for (Node* child = getFirstNode(); child != NULL; child = child->getNextSibling())
     {
         // Does this child's ID match?
-        if ((exactMatch && child->_id == id) || (!exactMatch && child->_id.find(id) == 0))
+        if (child->matchesId(id, idAtom, exactMatch))
         {
             return child;
         }
@@ -154,7 +185,7 @@ Node* Scene::findNode(const char* id, bool recursive, bool exactMatch) const
     {
         for (Node* child = getFirstNode(); child != NULL; child = child->getNextSibling())
         {
-            Node* match = child->findNode(id, true, exactMatch);
+            Node* match = child->findNode(id, idAtom, true, exactMatch);
             if (match)
             {
                 return match;
@@ -169,13 +200,30 @@ unsigned int Scene::findNodes(const char* id, std::vector<Node*>& nodes, bool re
 {
     GP_ASSERT(id);
 
+    unsigned int idAtom = StringId::find(id);
+    if (exactMatch && idAtom == 0 && *id != '\0')
+        return 0;
+
+    if (recursive && exactMatch)
+    {
+        updateNodeIndex();
+        std::map<unsigned int, Node*>::const_iterator itr = _idIndex.find(idAtom);
+        if (itr == _idIndex.end())
+            return 0;
+        if (itr->second)
+        {
+            nodes.push_back(itr->second);
+            return 1;
+        }
+    }
+
     unsigned int count = 0;
 
     // Search immediate children first.
     for (Node* child = getFirstNode(); child != NULL; child = child->getNextSibling())
     {
         // Does this child's ID match?
-        if ((exactMatch && child->_id == id) || (!exactMatch && child->_id.find(id) == 0))
+        if (child->matchesId(id, idAtom, exactMatch))
         {
             nodes.push_back(child);
             ++count;
@@ -187,13 +235,743 @@ unsigned int Scene::findNodes(const char* id, std::vector<Node*>& nodes, bool re
     {
         for (Node* child = getFirstNode(); child != NULL; child = child->getNextSibling())
         {
-            count += child->findNodes(id, nodes, true, exactMatch);
+            count += child->findNodes(id, idAtom, nodes, true, exactMatch);
+        }
+    }
+
+    return count;
+}
+
+unsigned int Scene::findNodesByTag(const char* tag, std::vector<Node*>& nodes) const
+{
+    GP_ASSERT(tag);
+
+    updateNodeIndex();
+    unsigned int tagAtom = StringId::find(tag);
+    if (tagAtom == 0 && *tag != '\0')
+        return 0;
+
+    std::map<unsigned int, std::vector<Node*> >::const_iterator itr = _tagIndex.find(tagAtom);
+    if (itr == _tagIndex.end())
+        return 0;
+
+    nodes.insert(nodes.end(), itr->second.begin(), itr->second.end());
+    return (unsigned int)itr->second.size();
+}
+
+void Scene::updateNodeIndex() const
+{
+    if (_indexed && _indexHierarchyRevision == Node::_hierarchyRevision && _indexIdRevision == Node::_idRevision)
+        return;
+
+    _idIndex.clear();
+    _tagIndex.clear();
+    std::set<Node*> skinRoots;
+    for (Node* node = getFirstNode(); node != NULL; node = node->getNextSibling())
+    {
+        indexNode(node, skinRoots);
+    }
+    _indexHierarchyRevision = Node::_hierarchyRevision;
+    _indexIdRevision = Node::_idRevision;
+    _indexed = true;
+}
+
+void Scene::indexNode(Node* node, std::set<Node*>& skinRoots) const
+{
+    GP_ASSERT(node);
+
+    if (node->_id != 0)
+    {
+        // Shared IDs are marked with NULL.
+        std::pair<std::map<unsigned int, Node*>::iterator, bool> result = _idIndex.insert(std::make_pair(node->_id, node));
+        if (!result.second && result.first->second != node)
+            result.first->second = NULL;
+    }
+
+    if (node->_tags)
+    {
+        for (std::map<unsigned int, std::string>::const_iterator itr = node->_tags->begin(); itr != node->_tags->end(); ++itr)
+        {
+            _tagIndex[itr->first].push_back(node);
+        }
+    }
+
+    // Joint hierarchies are searched through the models they skin, and may be shared by several skins.
+    Model* model = node->getModel();
+    if (model && model->_skin && model->_skin->_rootNode && skinRoots.insert(model->_skin->_rootNode).second)
+    {
+        indexNode(model->_skin->_rootNode, skinRoots);
+    }
+
+    for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        indexNode(child, skinRoots);
+    }
+}
+
+// Results of classifying a bounding sphere against a frustum.
+#define CULL_OUTSIDE 0
+#define CULL_INTERSECTING 1
+#define CULL_INSIDE 2
+
+static int classifySphere(const Frustum& frustum, const BoundingSphere& sphere)
+{
+    const Plane* planes[] =
+    {
+        &frustum.getNear(), &frustum.getFar(), &frustum.getLeft(),
+        &frustum.getRight(), &frustum.getBottom(), &frustum.getTop()
+    };
+
+    int result = CULL_INSIDE;
+    for (unsigned int i = 0; i < 6; ++i)
+    {
+        float side = sphere.intersects(*planes[i]);
+        if (side == Plane::INTERSECTS_BACK)
+            return CULL_OUTSIDE;
+        if (side == Plane::INTERSECTS_INTERSECTING)
+            result = CULL_INTERSECTING;
+    }
+    return result;
+}
+
+// The most siblings whose bounds are tested against the frustum together.
+#define CULL_BATCH_SIZE 32
+
+unsigned int Scene::findVisibleNodes(Node* node, const Frustum& frustum, bool inside, std::vector<Node*>& nodes)
+{
+    GP_ASSERT(node);
+
+    // The bounds of a node contain the bounds of all of its children, so once a
+    // node is entirely inside the frustum none of its descendants need to be tested.
+    if (!inside)
+    {
+        const BoundingSphere& sphere = node->getBoundingSphere();
+        if (sphere.isEmpty())
+            return 0;
+
+        int result = classifySphere(frustum, sphere);
+        if (result == CULL_OUTSIDE)
+            return 0;
+        inside = (result == CULL_INSIDE);
+    }
+    return addVisibleNode(node, frustum, inside, nodes);
+}
+
+unsigned int Scene::findVisibleChildren(Node* first, const Frustum& frustum, bool inside, std::vector<Node*>& nodes)
+{
+    unsigned int count = 0;
+    if (inside)
+    {
+        for (Node* child = first; child != NULL; child = child->getNextSibling())
+        {
+            count += addVisibleNode(child, frustum, true, nodes);
         }
+        return count;
     }
 
+    // The bounds of the siblings are gathered into arrays and tested together, which lets
+    // the frustum test four of them at a time.
+    Node* batch[CULL_BATCH_SIZE];
+    float centerX[CULL_BATCH_SIZE];
+    float centerY[CULL_BATCH_SIZE];
+    float centerZ[CULL_BATCH_SIZE];
+    float radius[CULL_BATCH_SIZE];
+    Node* child = first;
+    while (child)
+    {
+        unsigned int size = 0;
+        for (; child != NULL && size < CULL_BATCH_SIZE; child = child->getNextSibling())
+        {
+            const BoundingSphere& sphere = child->getBoundingSphere();
+            if (sphere.isEmpty())
+                continue;
+            batch[size] = child;
+            centerX[size] = sphere.center.x;
+            centerY[size] = sphere.center.y;
+            centerZ[size] = sphere.center.z;
+            radius[size] = sphere.radius;
+            ++size;
+        }
+
+        unsigned int visible = 0;
+        unsigned int insideMask = 0;
+        frustum.intersectsSpheres(centerX, centerY, centerZ, radius, size, &visible, &insideMask);
+        for (unsigned int i = 0; i < size; ++i)
+        {
+            if (visible & (1u << i))
+                count += addVisibleNode(batch[i], frustum, (insideMask & (1u << i)) != 0, nodes);
+        }
+    }
     return count;
 }
 
+unsigned int Scene::addVisibleNode(Node* node, const Frustum& frustum, bool inside, std::vector<Node*>& nodes)
+{
+    GP_ASSERT(node);
+
+    unsigned int count = 0;
+    if (node->getModel() || node->getTerrain())
+    {
+        nodes.push_back(node);
+        ++count;
+    }
+
+    // Nodes such as attachments can be parented to the joints of a mesh skin, which are
+    // not children of this node, so their bounds must be tested separately.
+    Model* model = node->getModel();
+    if (model && model->getSkin() && model->getSkin()->_rootNode)
+    {
+        count += findVisibleNodes(model->getSkin()->_rootNode, frustum, false, nodes);
+    }
+
+    count += findVisibleChildren(node->getFirstChild(), frustum, inside, nodes);
+    return count;
+}
+
+/**
+ * Returns the mask of all of the given number of frusta.
+ */
+static unsigned int getFrustaMask(unsigned int frustumCount)
+{
+    return frustumCount >= 32 ? 0xFFFFFFFF : (1u << frustumCount) - 1;
+}
+
+unsigned int Scene::findVisibleNodes(Node* node, const Frustum* frusta, unsigned int frustumCount, unsigned int testMask,
+                                     unsigned int insideMask, std::vector<Node*>& nodes, std::vector<unsigned int>& masks)
+{
+    GP_ASSERT(node);
+
+    if (testMask)
+    {
+        const BoundingSphere& sphere = node->getBoundingSphere();
+        if (sphere.isEmpty())
+        {
+            testMask = 0;
+        }
+        for (unsigned int i = 0; i < frustumCount; ++i)
+        {
+            unsigned int bit = 1u << i;
+            if (!(testMask & bit))
+                continue;
+            int result = classifySphere(frusta[i], sphere);
+            if (result != CULL_INTERSECTING)
+                testMask &= ~bit;
+            if (result == CULL_INSIDE)
+                insideMask |= bit;
+        }
+    }
+    unsigned int visibleMask = testMask | insideMask;
+    if (visibleMask == 0)
+        return 0;
+
+    unsigned int count = 0;
+    if (node->getModel() || node->getTerrain())
+    {
+        nodes.push_back(node);
+        masks.push_back(visibleMask);
+        ++count;
+    }
+
+    // The joints of a mesh skin are not children of the node, so they are tested against all the frusta.
+    Model* model = node->getModel();
+    if (model && model->getSkin() && model->getSkin()->_rootNode)
+    {
+        count += findVisibleNodes(model->getSkin()->_rootNode, frusta, frustumCount, getFrustaMask(frustumCount), 0, nodes, masks);
+    }
+
+    for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        count += findVisibleNodes(child, frusta, frustumCount, testMask, insideMask, nodes, masks);
+    }
+    return count;
+}
+
+unsigned int Scene::findVisibleNodes(const Frustum* frusta, unsigned int frustumCount, std::vector<Node*>& nodes,
+                                     std::vector<unsigned int>& masks) const
+{
+    GP_ASSERT(frusta || frustumCount == 0);
+    GP_ASSERT(frustumCount <= 32);
+
+    unsigned int count = 0;
+    for (Node* node = getFirstNode(); node != NULL && frustumCount > 0; node = node->getNextSibling())
+    {
+        count += findVisibleNodes(node, frusta, frustumCount, getFrustaMask(frustumCount), 0, nodes, masks);
+    }
+    RenderStats::add(RenderStats::VISIBLE_NODES, count);
+    return count;
+}
+
+unsigned int Scene::findVisibleNodes(const Frustum& frustum, std::vector<Node*>& nodes) const
+{
+    unsigned int count = findVisibleChildren(getFirstNode(), frustum, false, nodes);
+    RenderStats::add(RenderStats::VISIBLE_NODES, count);
+    return count;
+}
+
+unsigned int Scene::findVisibleNodes(std::vector<Node*>& nodes) const
+{
+    if (_activeCamera == NULL)
+        return 0;
+
+    return findVisibleNodes(_activeCamera->getFrustum(), nodes);
+}
+
+unsigned int Scene::findVisibleNodes(std::vector<Node*>& nodes, OcclusionCuller* culler) const
+{
+    GP_ASSERT(culler);
+
+    if (_activeCamera == NULL)
+        return 0;
+
+    // Only the nodes found by this call are passed to the culler.
+    // They are gathered without being counted, so that only those left by the culler are.
+    std::vector<Node*> found;
+    findVisibleChildren(getFirstNode(), _activeCamera->getFrustum(), false, found);
+    culler->cull(_activeCamera, found);
+    RenderStats::add(RenderStats::VISIBLE_NODES, found.size());
+    nodes.insert(nodes.end(), found.begin(), found.end());
+    return found.size();
+}
+
+/**
+ * Returns the distance along a ray at which it enters a bounding sphere, which is 0 if the
+ * origin of the ray is inside the sphere, or Ray::INTERSECTS_NONE if it misses the sphere.
+ */
+static float getRayEntry(const Ray& ray, const BoundingSphere& sphere)
+{
+    if (sphere.isEmpty())
+        return Ray::INTERSECTS_NONE;
+    if (sphere.center.distanceSquared(ray.getOrigin()) <= sphere.radius * sphere.radius)
+        return 0.0f;
+
+    // Spheres behind the origin are hit at a negative distance.
+    float distance = ray.intersects(sphere);
+    return distance < 0.0f ? Ray::INTERSECTS_NONE : distance;
+}
+
+/**
+ * Returns the distance along a ray at which it enters a bounding box, which is 0 if the
+ * origin of the ray is inside the box, or Ray::INTERSECTS_NONE if it misses the box.
+ */
+static float getRayEntry(const Ray& ray, const BoundingBox& box)
+{
+    if (box.isEmpty())
+        return Ray::INTERSECTS_NONE;
+    const Vector3& origin = ray.getOrigin();
+    if (origin.x >= box.min.x && origin.y >= box.min.y && origin.z >= box.min.z &&
+        origin.x <= box.max.x && origin.y <= box.max.y && origin.z <= box.max.z)
+        return 0.0f;
+
+    float distance = ray.intersects(box);
+    return distance < 0.0f ? Ray::INTERSECTS_NONE : distance;
+}
+
+/**
+ * Returns the distance along a ray at which it hits either side of a triangle,
+ * or Ray::INTERSECTS_NONE if it misses the triangle.
+ */
+static float intersectTriangle(const Ray& ray, const float* p0, const float* p1, const float* p2)
+{
+    const Vector3& origin = ray.getOrigin();
+    const Vector3& direction = ray.getDirection();
+    Vector3 edge1(p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]);
+    Vector3 edge2(p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]);
+
+    // Solve for the distance and the barycentric coordinates of the hit (Moller-Trumbore).
+    Vector3 p;
+    Vector3::cross(direction, edge2, &p);
+    float det = Vector3::dot(edge1, p);
+    if (fabs(det) < 1e-12f)
+        return Ray::INTERSECTS_NONE;
+    float invDet = 1.0f / det;
+
+    Vector3 t(origin.x - p0[0], origin.y - p0[1], origin.z - p0[2]);
+    float u = Vector3::dot(t, p) * invDet;
+    if (u < 0.0f || u > 1.0f)
+        return Ray::INTERSECTS_NONE;
+
+    Vector3 q;
+    Vector3::cross(t, edge1, &q);
+    float v = Vector3::dot(direction, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f)
+        return Ray::INTERSECTS_NONE;
+
+    float distance = Vector3::dot(edge2, q) * invDet;
+    return distance < 0.0f ? Ray::INTERSECTS_NONE : distance;
+}
+
+/**
+ * Returns the index at the given position in index data of the given format.
+ */
+static unsigned int getIndex(const void* indices, Mesh::IndexFormat format, unsigned int i)
+{
+    switch (format)
+    {
+    case Mesh::INDEX8:
+        return ((const unsigned char*)indices)[i];
+    case Mesh::INDEX16:
+        return ((const unsigned short*)indices)[i];
+    default:
+        return ((const unsigned int*)indices)[i];
+    }
+}
+
+/**
+ * Returns the distance along a ray at which it first hits the triangles of a mesh, or of
+ * one of its parts, or Ray::INTERSECTS_NONE if it misses them. The vertices are drawn in
+ * order when indices is NULL.
+ */
+static float intersectTriangles(const Ray& ray, const float* positions, unsigned int vertexCount, Mesh::PrimitiveType type,
+                                const void* indices, Mesh::IndexFormat format, unsigned int count)
+{
+    if (type != Mesh::TRIANGLES && type != Mesh::TRIANGLE_STRIP)
+        return Ray::INTERSECTS_NONE;
+
+    float nearest = Ray::INTERSECTS_NONE;
+    unsigned int step = type == Mesh::TRIANGLES ? 3 : 1;
+    for (unsigned int i = 0; i + 2 < count; i += step)
+    {
+        unsigned int i0 = indices ? getIndex(indices, format, i) : i;
+        unsigned int i1 = indices ? getIndex(indices, format, i + 1) : i + 1;
+        unsigned int i2 = indices ? getIndex(indices, format, i + 2) : i + 2;
+        if (i0 >= vertexCount || i1 >= vertexCount || i2 >= vertexCount)
+            continue;
+
+        float distance = intersectTriangle(ray, positions + i0 * 3, positions + i1 * 3, positions + i2 * 3);
+        if (distance >= 0.0f && (nearest < 0.0f || distance < nearest))
+            nearest = distance;
+    }
+    return nearest;
+}
+
+float Scene::pickNode(Node* node, const Ray& ray, bool triangles)
+{
+    GP_ASSERT(node);
+
+    Model* model = node->getModel();
+    Terrain* terrain = node->getTerrain();
+    Mesh* mesh = model ? model->getMesh() : NULL;
+    if (mesh && model->getSkin())
+    {
+        // The bounds of skinned models are only known in world space.
+        return getRayEntry(ray, node->getBoundingSphere());
+    }
+    if (mesh == NULL && terrain == NULL)
+        return Ray::INTERSECTS_NONE;
+
+    // The bounds and the triangles are tested in the local space of the node.
+    const Matrix& worldMatrix = node->getWorldMatrix();
+    Matrix inverse;
+    if (!worldMatrix.invert(&inverse))
+        return Ray::INTERSECTS_NONE;
+    Ray localRay(ray);
+    localRay.transform(inverse);
+
+    float nearest = Ray::INTERSECTS_NONE;
+    if (terrain)
+    {
+        nearest = getRayEntry(localRay, terrain->getBoundingBox());
+    }
+    if (mesh)
+    {
+        float distance = getRayEntry(localRay, mesh->getBoundingBox());
+        const float* positions = mesh->getPositionData();
+        if (distance >= 0.0f && triangles && positions)
+        {
+            unsigned int partCount = mesh->getPartCount();
+            if (partCount == 0)
+            {
+                distance = intersectTriangles(localRay, positions, mesh->getVertexCount(), mesh->getPrimitiveType(),
+                                              NULL, Mesh::INDEX16, mesh->getVertexCount());
+            }
+            else
+            {
+                distance = Ray::INTERSECTS_NONE;
+                for (unsigned int i = 0; i < partCount; ++i)
+                {
+                    MeshPart* part = mesh->getPart(i);
+                    if (part->getIndexData() == NULL)
+                        continue;
+                    float partDistance = intersectTriangles(localRay, positions, mesh->getVertexCount(), part->getPrimitiveType(),
+                                                            part->getIndexData(), part->getIndexFormat(), part->getIndexCount());
+                    if (partDistance >= 0.0f && (distance < 0.0f || partDistance < distance))
+                        distance = partDistance;
+                }
+            }
+        }
+        if (distance >= 0.0f && (nearest < 0.0f || distance < nearest))
+            nearest = distance;
+    }
+    if (nearest < 0.0f)
+        return Ray::INTERSECTS_NONE;
+
+    // Distances in local space are scaled by the world matrix, so the hit is measured in world space.
+    Vector3 point(localRay.getOrigin() + localRay.getDirection() * nearest);
+    worldMatrix.transformPoint(&point);
+    return ray.getOrigin().distance(point);
+}
+
+void Scene::pickNodes(Node* node, const Ray& ray, bool triangles, PickResult* nearest, std::vector<PickResult>* results)
+{
+    GP_ASSERT(node);
+    GP_ASSERT(nearest || results);
+
+    if (node->getModel() || node->getTerrain())
+    {
+        float distance = pickNode(node, ray, triangles);
+        if (distance >= 0.0f && (results || nearest->node == NULL || distance < nearest->distance))
+        {
+            PickResult result;
+            result.node = node;
+            result.point = ray.getOrigin() + ray.getDirection() * distance;
+            result.distance = distance;
+            if (results)
+                results->push_back(result);
+            else
+                *nearest = result;
+        }
+    }
+
+    // Nodes such as attachments can be parented to the joints of a mesh skin, which are
+    // not children of this node.
+    Model* model = node->getModel();
+    if (model && model->getSkin() && model->getSkin()->_rootNode)
+    {
+        Node* root = model->getSkin()->_rootNode;
+        float distance = getRayEntry(ray, root->getBoundingSphere());
+        if (distance >= 0.0f && (results || nearest->node == NULL || distance < nearest->distance))
+            pickNodes(root, ray, triangles, nearest, results);
+    }
+
+    pickChildren(node->getFirstChild(), ray, triangles, nearest, results);
+}
+
+void Scene::pickChildren(Node* first, const Ray& ray, bool triangles, PickResult* nearest, std::vector<PickResult>* results)
+{
+    // The siblings are visited from the nearest to the furthest, so that once a hit is
+    // found the siblings whose bounds the ray enters further than it are rejected.
+    std::vector<std::pair<float, Node*> > nodes;
+    for (Node* node = first; node != NULL; node = node->getNextSibling())
+    {
+        float distance = getRayEntry(ray, node->getBoundingSphere());
+        if (distance >= 0.0f)
+            nodes.push_back(std::make_pair(distance, node));
+    }
+    std::sort(nodes.begin(), nodes.end());
+    for (size_t i = 0, count = nodes.size(); i < count; ++i)
+    {
+        if (results == NULL && nearest->node && nodes[i].first > nearest->distance)
+            break;
+        pickNodes(nodes[i].second, ray, triangles, nearest, results);
+    }
+}
+
+/**
+ * Orders pick results from the nearest to the furthest hit.
+ */
+static bool comparePickResults(const Scene::PickResult& r1, const Scene::PickResult& r2)
+{
+    return r1.distance < r2.distance;
+}
+
+bool Scene::pick(const Ray& ray, PickResult* result, bool triangles) const
+{
+    PickResult nearest;
+    nearest.node = NULL;
+    nearest.distance = 0.0f;
+
+    pickChildren(getFirstNode(), ray, triangles, &nearest, NULL);
+    if (nearest.node == NULL)
+        return false;
+    if (result)
+        *result = nearest;
+    return true;
+}
+
+unsigned int Scene::pick(const Ray& ray, std::vector<PickResult>& results, bool triangles) const
+{
+    std::vector<PickResult> hits;
+    pickChildren(getFirstNode(), ray, triangles, NULL, &hits);
+    std::sort(hits.begin(), hits.end(), comparePickResults);
+    results.insert(results.end(), hits.begin(), hits.end());
+    return hits.size();
+}
+
+// The most grid cells a light or a node is indexed or looked up in, beyond which the light
+// is tested against every node, or the node against every light.
+#define LIGHT_GRID_MAX_CELLS 64
+
+/**
+ * A cell of the uniform grid that lights are indexed in by Scene::assignLights.
+ */
+struct LightGridCell
+{
+    int x, y, z;
+
+    bool operator<(const LightGridCell& c) const
+    {
+        if (x != c.x)
+            return x < c.x;
+        if (y != c.y)
+            return y < c.y;
+        return z < c.z;
+    }
+};
+
+static float computeInfluence(Node* lightNode, const BoundingSphere& sphere)
+{
+    Light* light = lightNode->getLight();
+    float range = light->getRange();
+    if (range <= 0.0f)
+        return 0.0f;
+
+    Vector3 toCenter = sphere.center - lightNode->getTranslationWorld();
+    float distance = toCenter.length() - sphere.radius;
+    if (distance >= range)
+        return 0.0f;
+
+    // Spot lights do not reach spheres that are entirely behind them.
+    if (light->getLightType() == Light::SPOT)
+    {
+        Vector3 forward = lightNode->getForwardVectorWorld();
+        forward.normalize();
+        if (Vector3::dot(forward, toCenter) < -sphere.radius)
+            return 0.0f;
+    }
+
+    float d = std::max(distance, 0.0f) / range;
+    const Vector3& color = light->getColor();
+    return (1.0f - d * d) * (0.2126f * color.x + 0.7152f * color.y + 0.0722f * color.z);
+}
+
+static void getCellRange(const Vector3& center, float radius, float cellSize, LightGridCell* min, LightGridCell* max)
+{
+    min->x = (int)floorf((center.x - radius) / cellSize);
+    min->y = (int)floorf((center.y - radius) / cellSize);
+    min->z = (int)floorf((center.z - radius) / cellSize);
+    max->x = (int)floorf((center.x + radius) / cellSize);
+    max->y = (int)floorf((center.y + radius) / cellSize);
+    max->z = (int)floorf((center.z + radius) / cellSize);
+}
+
+static unsigned int getCellCount(const LightGridCell& min, const LightGridCell& max)
+{
+    // Computed in floating point, since huge ranges overflow integers.
+    float count = (float)(max.x - min.x + 1) * (float)(max.y - min.y + 1) * (float)(max.z - min.z + 1);
+    return count > (float)LIGHT_GRID_MAX_CELLS ? LIGHT_GRID_MAX_CELLS + 1 : (unsigned int)count;
+}
+
+unsigned int Scene::assignLights(const std::vector<Node*>& nodes, unsigned int maxLights)
+{
+    std::vector<Node*> lights;
+    const std::vector<Node*>& lightNodes = getComponentNodes(COMPONENT_LIGHT);
+    for (size_t i = 0, count = lightNodes.size(); i < count; ++i)
+    {
+        if (lightNodes[i]->getLight()->getLightType() != Light::DIRECTIONAL)
+            lights.push_back(lightNodes[i]);
+    }
+
+    // Index the lights in cells the size of their average range. Lights that span too
+    // many cells are kept aside and tested against every node.
+    float cellSize = 0.0f;
+    for (size_t i = 0, count = lights.size(); i < count; ++i)
+    {
+        cellSize += lights[i]->getLight()->getRange();
+    }
+    cellSize = lights.empty() ? 1.0f : std::max(cellSize / lights.size(), 0.001f);
+
+    std::map<LightGridCell, std::vector<unsigned int> > grid;
+    std::vector<unsigned int> globalLights;
+    std::vector<Vector3> positions(lights.size());
+    for (unsigned int i = 0, count = lights.size(); i < count; ++i)
+    {
+        positions[i] = lights[i]->getTranslationWorld();
+
+        LightGridCell min, max;
+        getCellRange(positions[i], lights[i]->getLight()->getRange(), cellSize, &min, &max);
+        if (getCellCount(min, max) > LIGHT_GRID_MAX_CELLS)
+        {
+            globalLights.push_back(i);
+            continue;
+        }
+
+        LightGridCell cell;
+        for (cell.x = min.x; cell.x <= max.x; ++cell.x)
+            for (cell.y = min.y; cell.y <= max.y; ++cell.y)
+                for (cell.z = min.z; cell.z <= max.z; ++cell.z)
+                    grid[cell].push_back(i);
+    }
+
+    // A light indexed in several cells is only tested once per node.
+    std::vector<unsigned int> stamps(lights.size(), 0);
+    std::vector<unsigned int> candidates;
+    std::vector<std::pair<float, unsigned int> > influences;
+    unsigned int assigned = 0;
+    for (size_t n = 0, nodeCount = nodes.size(); n < nodeCount; ++n)
+    {
+        Node* node = nodes[n];
+        GP_ASSERT(node);
+        node->_assignedLights.clear();
+        if (lights.empty() || maxLights == 0)
+            continue;
+
+        const BoundingSphere& sphere = node->getBoundingSphere();
+        LightGridCell min, max;
+        getCellRange(sphere.center, sphere.radius, cellSize, &min, &max);
+
+        candidates.clear();
+        if (getCellCount(min, max) > LIGHT_GRID_MAX_CELLS)
+        {
+            for (unsigned int i = 0, count = lights.size(); i < count; ++i)
+                candidates.push_back(i);
+        }
+        else
+        {
+            candidates.insert(candidates.end(), globalLights.begin(), globalLights.end());
+            LightGridCell cell;
+            for (cell.x = min.x; cell.x <= max.x; ++cell.x)
+            {
+                for (cell.y = min.y; cell.y <= max.y; ++cell.y)
+                {
+                    for (cell.z = min.z; cell.z <= max.z; ++cell.z)
+                    {
+                        std::map<LightGridCell, std::vector<unsigned int> >::const_iterator itr = grid.find(cell);
+                        if (itr == grid.end())
+                            continue;
+                        for (size_t i = 0, count = itr->second.size(); i < count; ++i)
+                        {
+                            unsigned int light = itr->second[i];
+                            if (stamps[light] != n + 1)
+                            {
+                                stamps[light] = n + 1;
+                                candidates.push_back(light);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        influences.clear();
+        for (size_t i = 0, count = candidates.size(); i < count; ++i)
+        {
+            float influence = computeInfluence(lights[candidates[i]], sphere);
+            if (influence > 0.0f)
+                influences.push_back(std::make_pair(-influence, candidates[i]));
+        }
+
+        unsigned int count = std::min((unsigned int)influences.size(), maxLights);
+        std::partial_sort(influences.begin(), influences.begin() + count, influences.end());
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            node->_assignedLights.push_back(lights[influences[i].second]);
+        }
+        assigned += count;
+    }
+
+    return assigned;
+}
+
 void Scene::visitNode(Node* node, const char* visitMethod)
 {
     ScriptController* sc = Game::getInstance()->getScriptController();
@@ -269,6 +1047,7 @@ void Scene::addNode(Node* node)
     node->_scene = this;
 
     ++_nodeCount;
+    ++Node::_hierarchyRevision;
 
     // If we don't have an active camera set, then check for one and set it.
     if (_activeCamera == NULL)
@@ -305,6 +1084,127 @@ void Scene::removeNode(Node* node)
     --_nodeCount;
 }
 
+struct Scene::WorldMatrixUpdate : public JobController::Range
+{
+    WorldMatrixUpdate(Node* const* nodes) : nodes(nodes) { }
+
+    void run(unsigned int begin, unsigned int end)
+    {
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            nodes[i]->updateWorldMatrix();
+        }
+    }
+
+    Node* const* nodes;
+};
+
+void Scene::updateWorldMatrices()
+{
+    flattenHierarchy();
+
+    JobController* jobController = Game::getInstance()->getJobController();
+    for (size_t depth = 0, depthCount = _flatDepths.size(); depth < depthCount; ++depth)
+    {
+        unsigned int begin = _flatDepths[depth];
+        unsigned int end = depth + 1 < depthCount ? _flatDepths[depth + 1] : (unsigned int)_flatNodes.size();
+        if (jobController && end - begin >= PARALLEL_MIN_NODES)
+        {
+            WorldMatrixUpdate update(&_flatNodes[begin]);
+            jobController->parallelFor(end - begin, &update);
+        }
+        else
+        {
+            for (unsigned int i = begin; i < end; ++i)
+            {
+                _flatNodes[i]->updateWorldMatrix();
+            }
+        }
+    }
+}
+
+void Scene::flattenHierarchy()
+{
+    if (_flatRevision == Node::_hierarchyRevision && (!_flatNodes.empty() || !_firstNode))
+        return;
+
+    _flatNodes.clear();
+    _flatDepths.clear();
+    _flatRevision = Node::_hierarchyRevision;
+
+    // Joint hierarchies are not part of the scene, and may be shared by several skins.
+    std::set<Node*> skinRoots;
+
+    // Append the nodes breadth first, so every node follows its parent.
+    for (Node* node = _firstNode; node != NULL; node = node->getNextSibling())
+    {
+        _flatNodes.push_back(node);
+    }
+    size_t begin = 0;
+    while (begin < _flatNodes.size())
+    {
+        size_t end = _flatNodes.size();
+        _flatDepths.push_back((unsigned int)begin);
+        for (size_t i = begin; i < end; ++i)
+        {
+            Node* node = _flatNodes[i];
+            for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+            {
+                _flatNodes.push_back(child);
+            }
+
+            // The root node of a joint hierarchy has no parent, so it can be at any depth.
+            Model* model = node->getModel();
+            if (model && model->_skin && model->_skin->_rootNode && skinRoots.insert(model->_skin->_rootNode).second)
+            {
+                _flatNodes.push_back(model->_skin->_rootNode);
+            }
+        }
+        begin = end;
+    }
+}
+
+const std::vector<Node*>& Scene::getComponentNodes(ComponentType type)
+{
+    GP_ASSERT(type < COMPONENT_TYPE_COUNT);
+
+    updateComponentNodes();
+    return _componentNodes[type];
+}
+
+void Scene::updateComponentNodes()
+{
+    if (_componentsIndexed && _componentHierarchyRevision == Node::_hierarchyRevision && _componentRevision == Node::_componentRevision)
+        return;
+
+    flattenHierarchy();
+    for (unsigned int i = 0; i < COMPONENT_TYPE_COUNT; ++i)
+    {
+        _componentNodes[i].clear();
+    }
+    for (size_t i = 0, count = _flatNodes.size(); i < count; ++i)
+    {
+        Node* node = _flatNodes[i];
+        if (node->_model)
+            _componentNodes[COMPONENT_MODEL].push_back(node);
+        if (node->_light)
+            _componentNodes[COMPONENT_LIGHT].push_back(node);
+        if (node->_camera)
+            _componentNodes[COMPONENT_CAMERA].push_back(node);
+        if (node->_particleEmitter)
+            _componentNodes[COMPONENT_PARTICLE_EMITTER].push_back(node);
+        if (node->_terrain)
+            _componentNodes[COMPONENT_TERRAIN].push_back(node);
+        if (node->_form)
+            _componentNodes[COMPONENT_FORM].push_back(node);
+        if (node->_audioSource)
+            _componentNodes[COMPONENT_AUDIO_SOURCE].push_back(node);
+    }
+    _componentHierarchyRevision = Node::_hierarchyRevision;
+    _componentRevision = Node::_componentRevision;
+    _componentsIndexed = true;
+}
+
 void Scene::removeAllNodes()
 {
     while (_lastNode)
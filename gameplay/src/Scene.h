@@ -5,6 +5,7 @@
 #include "MeshBatch.h"
 #include "ScriptController.h"
 #include "Light.h"
+#include "OcclusionCuller.h"
 
 namespace gameplay
 {
@@ -16,6 +17,29 @@ class Scene : public Ref
 {
 public:
 
+    /**
+     * The result of a ray query on a scene (see Scene::pick).
+     *
+     * @script{ignore}
+     */
+    struct PickResult
+    {
+        /**
+         * The node that was hit.
+         */
+        Node* node;
+
+        /**
+         * The point where the ray hit the node, in world space.
+         */
+        Vector3 point;
+
+        /**
+         * The distance from the origin of the ray to the point.
+         */
+        float distance;
+    };
+
     /**
      * Enumeration of supported scene debug flags for debug drawing.
      */
@@ -25,6 +49,23 @@ public:
         DEBUG_SPHERES = 2
     };
 
+    /**
+     * The types of components whose nodes the scene keeps in lists (see getComponentNodes).
+     *
+     * @script{ignore}
+     */
+    enum ComponentType
+    {
+        COMPONENT_MODEL,
+        COMPONENT_LIGHT,
+        COMPONENT_CAMERA,
+        COMPONENT_PARTICLE_EMITTER,
+        COMPONENT_TERRAIN,
+        COMPONENT_FORM,
+        COMPONENT_AUDIO_SOURCE,
+        COMPONENT_TYPE_COUNT
+    };
+
     /**
      * Creates a new empty scene.
      * 
@@ -45,6 +86,23 @@ public:
      */
     static Scene* load(const char* filePath);
 
+    /**
+     * Bakes a '.scene' file, and the material, physics, particle and other properties files
+     * it references, into a single binary file that can be passed to load() in its place.
+     *
+     * Loading a baked scene reads the properties with inheritance already resolved, and
+     * without parsing any text or opening the referenced files. The meshes, textures and
+     * shaders are still loaded from their own files, so a scene must be baked again when
+     * the properties files it references change.
+     *
+     * @param url The URL of the scene to bake, as passed to load().
+     * @param path The path of the baked file to write.
+     *
+     * @return True if the scene was baked, false otherwise.
+     * @script{ignore}
+     */
+    static bool bake(const char* url, const char* path);
+
     /**
      * Gets a currently active scene.
      *
@@ -96,6 +154,147 @@ public:
      */
     unsigned int findNodes(const char* id, std::vector<Node*>& nodes, bool recursive = true, bool exactMatch = true) const;
 
+    /**
+     * Returns all nodes in the scene, including the joints of skinned models, that have the
+     * given tag set.
+     *
+     * @param tag The name of the tag.
+     * @param nodes Vector of nodes to be populated with matches.
+     *
+     * @return The number of matches found.
+     * @see Node::setTag
+     * @script{ignore}
+     */
+    unsigned int findNodesByTag(const char* tag, std::vector<Node*>& nodes) const;
+
+    /**
+     * Returns all nodes in the scene with a model or terrain whose bounds intersect the specified frustum.
+     *
+     * The node hierarchy of the scene is used as a bounding volume hierarchy: the cached
+     * world-space bounding sphere of each node (see Node::getBoundingSphere()) contains the
+     * bounds of all its children, so any branch of the scene whose bounds are outside the
+     * frustum is rejected without testing its children. Branches whose bounds are entirely
+     * inside the frustum are added without testing their children either. The cached bounds
+     * are only recomputed for the parts of the scene that changed since the last call.
+     *
+     * Nodes are appended to the specified vector in depth-first order.
+     *
+     * @param frustum The frustum to test against, in world space.
+     * @param nodes Vector of nodes to be populated with the visible nodes.
+     *
+     * @return The number of visible nodes found.
+     * @script{ignore}
+     */
+    unsigned int findVisibleNodes(const Frustum& frustum, std::vector<Node*>& nodes) const;
+
+    /**
+     * Returns all nodes in the scene with a model or terrain that are visible from the active camera.
+     *
+     * @param nodes Vector of nodes to be populated with the visible nodes.
+     *
+     * @return The number of visible nodes found, or zero if the scene has no active camera.
+     * @see findVisibleNodes(const Frustum&, std::vector<Node*>&)
+     * @script{ignore}
+     */
+    unsigned int findVisibleNodes(std::vector<Node*>& nodes) const;
+
+    /**
+     * Returns all nodes in the scene with a model or terrain that are visible from the active
+     * camera, and were not occluded when the specified culler last tested them.
+     *
+     * OcclusionCuller::query() should be called with the active camera once the nodes are drawn.
+     *
+     * @param nodes Vector of nodes to be populated with the visible nodes.
+     * @param culler The occlusion culler that removes the occluded nodes.
+     *
+     * @return The number of visible nodes found, or zero if the scene has no active camera.
+     * @see findVisibleNodes(const Frustum&, std::vector<Node*>&)
+     * @see OcclusionCuller::cull
+     * @script{ignore}
+     */
+    unsigned int findVisibleNodes(std::vector<Node*>& nodes, OcclusionCuller* culler) const;
+
+    /**
+     * Returns all nodes in the scene with a model or terrain whose bounds intersect any of
+     * several frusta, with the set of frusta each of them intersects.
+     *
+     * The scene is traversed once for all the frusta, such as those of the cameras of a
+     * split screen. A branch is rejected once its bounds are outside all of the frusta,
+     * and its children are not tested again against the frusta it is entirely inside of.
+     *
+     * @param frusta The frusta to test against, in world space.
+     * @param frustumCount The number of frusta, at most 32.
+     * @param nodes Vector of nodes to be populated with the visible nodes.
+     * @param masks Vector populated with a mask for each node added to nodes, in which
+     *      bit i is set if the node intersects frusta[i].
+     *
+     * @return The number of visible nodes found.
+     * @see MultiView
+     * @script{ignore}
+     */
+    unsigned int findVisibleNodes(const Frustum* frusta, unsigned int frustumCount, std::vector<Node*>& nodes,
+                                  std::vector<unsigned int>& masks) const;
+
+    /**
+     * Assigns to each of the specified nodes the point and spot lights of the scene that
+     * influence it the most, so that they can be bound with the POINT_LIGHT_* and
+     * SPOT_LIGHT_* auto bindings (see RenderState::AutoBinding).
+     *
+     * The influence of a light on a node is the brightness of its color, attenuated as in the
+     * built-in shaders at the point of the bounding sphere of the node that is closest to the
+     * light. Lights whose range does not reach the bounding sphere, and spot lights that face
+     * away from it, have no influence. The lights are indexed in a uniform grid for the call,
+     * so each node is only tested against the lights near it.
+     *
+     * This is typically called once per frame with the visible nodes (see findVisibleNodes).
+     *
+     * @param nodes The nodes to assign lights to.
+     * @param maxLights The maximum number of lights to assign to each node.
+     *
+     * @return The total number of lights assigned.
+     * @see Node::getAssignedLight
+     * @script{ignore}
+     */
+    unsigned int assignLights(const std::vector<Node*>& nodes, unsigned int maxLights = 4);
+
+    /**
+     * Finds the node with a model or terrain that the specified ray hits first, without
+     * requiring any physics collision objects.
+     *
+     * The node hierarchy of the scene is used as a bounding volume hierarchy, as in
+     * findVisibleNodes: a branch whose bounding sphere the ray misses, or enters further than
+     * the nearest hit found so far, is rejected without testing its children, and the
+     * children of a branch are tested from the nearest to the furthest.
+     *
+     * A model is hit where the ray hits the bounding box of its mesh. When triangles is true
+     * and the mesh keeps its positions (see Mesh::DATA_POSITIONS), the ray is tested against
+     * the triangles of the mesh instead. Skinned models, whose vertices are moved by their
+     * joints, are hit at their bounding spheres, and terrains at their bounding boxes.
+     *
+     * @param ray The ray, in world space (see Camera::pickRay).
+     * @param result The result to populate with the nearest hit, or NULL.
+     * @param triangles true to test the triangles of the meshes that keep their positions.
+     *
+     * @return true if the ray hits a node, false otherwise.
+     * @script{ignore}
+     */
+    bool pick(const Ray& ray, PickResult* result, bool triangles = true) const;
+
+    /**
+     * Finds all of the nodes with a model or terrain that the specified ray hits.
+     *
+     * The nodes are hit as described in pick(const Ray&, PickResult*, bool) and are appended
+     * to the specified vector sorted from the nearest to the furthest hit.
+     *
+     * @param ray The ray, in world space.
+     * @param results Vector to be populated with a result for each node that is hit.
+     * @param triangles true to test the triangles of the meshes that keep their positions.
+     *
+     * @return The number of nodes hit.
+     * @script{ignore}
+     */
+    unsigned int pick(const Ray& ray, std::vector<PickResult>& results, bool triangles = true) const;
+
     /**
      * Creates and adds a new node to the scene.
      *
@@ -296,8 +495,86 @@ public:
      */
     void drawDebug(unsigned int debugFlags);
 
+    /**
+     * Updates the world matrices of all the nodes in the scene, including the joints of
+     * skinned models, in one pass over a flattened copy of the hierarchy.
+     *
+     * Node::getWorldMatrix computes world matrices on demand by recursing through parents
+     * and children. This instead keeps the nodes of the scene in an array ordered by depth,
+     * which is rebuilt only when nodes are added, removed or reparented, and computes the
+     * dirty world matrices of each depth in order. The nodes of a depth only depend on the
+     * previous one, so large depths are updated in parallel by the game's JobController.
+     *
+     * This is optional: it is typically called once per frame after the scene is updated and
+     * animated, and before it is drawn, after which getWorldMatrix returns the matrices
+     * without computing them.
+     *
+     * @script{ignore}
+     */
+    void updateWorldMatrices();
+
+    /**
+     * Returns the nodes of the scene that have a component of a type, such as all the nodes
+     * with a model, including those in the joint hierarchies of skinned models.
+     *
+     * Drawing or updating every component of a type with visit() calls a method for every
+     * node of the scene, which tests whether the node has the component. The scene instead
+     * keeps a list of the nodes of each type, which is rebuilt only when nodes are added,
+     * removed or reparented or when a component is set on a node, so systems iterate over
+     * exactly the nodes they process:
+     *
+     @verbatim
+        const std::vector<Node*>& nodes = scene->getComponentNodes(Scene::COMPONENT_MODEL);
+        for (size_t i = 0, count = nodes.size(); i < count; ++i)
+            nodes[i]->getModel()->draw();
+     @endverbatim
+     *
+     * Parents come before their children, in the order of updateWorldMatrices rather than the
+     * depth-first order of visit(). The list is only valid until the hierarchy or the
+     * components of its nodes next change, so it must not be kept across frames, nor used
+     * while components are added or removed.
+     *
+     * @param type The type of component.
+     *
+     * @return The nodes with a component of the type.
+     * @script{ignore}
+     */
+    const std::vector<Node*>& getComponentNodes(ComponentType type);
+
 private:
 
+    /**
+     * The body of the parallel loop that updates the world matrices of a depth (defined in Scene.cpp).
+     */
+    struct WorldMatrixUpdate;
+
+    /**
+     * Rebuilds the array of nodes ordered by depth used by updateWorldMatrices, if the
+     * hierarchy changed since it was built.
+     */
+    void flattenHierarchy();
+
+    /**
+     * Rebuilds the lists of the nodes of each type of component, if the hierarchy or a
+     * component changed since they were built.
+     */
+    void updateComponentNodes();
+
+    /**
+     * Rebuilds the indices of the nodes by ID and by tag if the hierarchy, an ID or a tag
+     * changed since they were built.
+     *
+     * Recursive exact searches by ID use the index. An ID shared by several nodes is marked in
+     * the index, and searches for it traverse the hierarchy so that they return nodes in the
+     * same order as without the index.
+     */
+    void updateNodeIndex() const;
+
+    /**
+     * Adds the given node and all of its descendants to the node indices.
+     */
+    void indexNode(Node* node, std::set<Node*>& skinRoots) const;
+
     /**
      * Constructor.
      */
@@ -335,6 +612,59 @@ private:
      */
     void visitNode(Node* node, const char* visitMethod);
 
+    /**
+     * Finds the visible nodes in the given node's hierarchy.
+     *
+     * If inside is true, the node is known to be inside the frustum and its bounds are not tested.
+     */
+    static unsigned int findVisibleNodes(Node* node, const Frustum& frustum, bool inside, std::vector<Node*>& nodes);
+
+    /**
+     * Finds the visible nodes in the hierarchies of the given node and its next siblings,
+     * testing the bounds of the siblings against the frustum together.
+     *
+     * If inside is true, the siblings are known to be inside the frustum and their bounds are not tested.
+     */
+    static unsigned int findVisibleChildren(Node* first, const Frustum& frustum, bool inside, std::vector<Node*>& nodes);
+
+    /**
+     * Adds the given node, which is known to be visible, and the visible nodes in its hierarchy.
+     *
+     * If inside is true, the node is entirely inside the frustum and its descendants are not tested.
+     */
+    static unsigned int addVisibleNode(Node* node, const Frustum& frustum, bool inside, std::vector<Node*>& nodes);
+
+    /**
+     * Finds the nodes in the given node's hierarchy that are visible from any of several frusta.
+     *
+     * The bounds of the node are tested against the frusta in testMask, and the node is known
+     * to be inside the frusta in insideMask.
+     */
+    static unsigned int findVisibleNodes(Node* node, const Frustum* frusta, unsigned int frustumCount, unsigned int testMask,
+                                         unsigned int insideMask, std::vector<Node*>& nodes, std::vector<unsigned int>& masks);
+
+    /**
+     * Tests the ray against the nodes in the given node's hierarchy.
+     *
+     * If results is NULL, only the hit nearer than nearest->distance is kept in nearest, and
+     * branches that the ray enters further than that are rejected. Otherwise every hit is
+     * appended to results.
+     */
+    static void pickNodes(Node* node, const Ray& ray, bool triangles, PickResult* nearest, std::vector<PickResult>* results);
+
+    /**
+     * Tests the ray against the model or terrain of the given node.
+     *
+     * @return The distance to the hit, or Ray::INTERSECTS_NONE if the node is not hit.
+     */
+    static float pickNode(Node* node, const Ray& ray, bool triangles);
+
+    /**
+     * Tests the ray against the nodes in the hierarchies of the given node and its next
+     * siblings, from the nearest to the furthest.
+     */
+    static void pickChildren(Node* first, const Ray& ray, bool triangles, PickResult* nearest, std::vector<PickResult>* results);
+
     std::string _id;
     Camera* _activeCamera;
     Node* _firstNode;
@@ -345,6 +675,18 @@ private:
     Vector3 _lightDirection;
     bool _bindAudioListenerToCamera;
     MeshBatch* _debugBatch;
+    std::vector<Node*> _flatNodes;
+    std::vector<unsigned int> _flatDepths;
+    unsigned int _flatRevision;
+    std::vector<Node*> _componentNodes[COMPONENT_TYPE_COUNT];
+    unsigned int _componentHierarchyRevision;
+    unsigned int _componentRevision;
+    bool _componentsIndexed;
+    mutable std::map<unsigned int, Node*> _idIndex;
+    mutable std::map<unsigned int, std::vector<Node*> > _tagIndex;
+    mutable unsigned int _indexHierarchyRevision;
+    mutable unsigned int _indexIdRevision;
+    mutable bool _indexed;
 };
 
 template <class T>
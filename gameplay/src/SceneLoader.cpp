@@ -1,10 +1,16 @@
 #include "Base.h"
+#include "Profiler.h"
 #include "AudioSource.h"
 #include "Game.h"
 #include "Bundle.h"
+#include "FileSystem.h"
+#include "Image.h"
+#include "JobController.h"
 #include "SceneLoader.h"
 #include "Terrain.h"
 #include "Light.h"
+#include "StringId.h"
+#include "StaticBatch.h"
 
 namespace gameplay
 {
@@ -13,12 +19,184 @@ namespace gameplay
 extern void calculateNamespacePath(const std::string& urlString, std::string& fileString, std::vector<std::string>& namespacePath);
 extern Properties* getPropertiesFromNamespacePath(Properties* properties, const std::vector<std::string>& namespacePath);
 
+/**
+ * Parses a list of properties files.
+ */
+class ParseFilesRange : public JobController::Range
+{
+public:
+    const std::vector<std::string>* files;
+    std::vector<Properties*>* properties;
+
+    void run(unsigned int begin, unsigned int end)
+    {
+        for (unsigned int i = begin; i < end; ++i)
+            (*properties)[i] = Properties::create((*files)[i].c_str());
+    }
+};
+
+/**
+ * Decodes a list of image files.
+ */
+class DecodeImagesRange : public JobController::Range
+{
+public:
+    const std::vector<std::string>* paths;
+    std::vector<Image*>* images;
+
+    void run(unsigned int begin, unsigned int end)
+    {
+        for (unsigned int i = begin; i < end; ++i)
+            (*images)[i] = Image::create((*paths)[i].c_str());
+    }
+};
+
+/**
+ * Runs the items of a range on the worker threads, or on the calling thread if there are none.
+ */
+static void runRange(JobController::Range* range, unsigned int count)
+{
+    Game* game = Game::getInstance();
+    JobController* jobController = game ? game->getJobController() : NULL;
+    if (jobController && count > 1)
+        jobController->parallelFor(count, range, 1);
+    else if (count > 0)
+        range->run(0, count);
+}
+
+/**
+ * Collects the PNG images of the texture samplers of a properties tree that are not loaded yet.
+ */
+static void collectSamplerImages(Properties* properties, std::map<std::string, size_t>& indices, std::vector<std::string>& paths, std::vector<char>& mipmaps)
+{
+    Properties* ns;
+    properties->rewind();
+    while ((ns = properties->getNextNamespace()) != NULL)
+    {
+        if (strcmp(ns->getNamespace(), "sampler") != 0)
+        {
+            collectSamplerImages(ns, indices, paths, mipmaps);
+            continue;
+        }
+
+        // Resolve the path as Material does, so that it finds the prefetched texture in the cache.
+        std::string path;
+        if (!ns->getPath("path", &path))
+        {
+            const char* value = ns->getString("path");
+            if (value == NULL)
+                continue;
+            path = value;
+        }
+        size_t length = path.length();
+        if (length < 4 || tolower(path[length - 3]) != 'p' || tolower(path[length - 2]) != 'n' ||
+            tolower(path[length - 1]) != 'g' || path[length - 4] != '.')
+        {
+            continue;
+        }
+
+        std::map<std::string, size_t>::const_iterator itr = indices.find(path);
+        if (itr != indices.end())
+        {
+            mipmaps[itr->second] |= ns->getBool("mipmap") ? 1 : 0;
+            continue;
+        }
+        indices[path] = paths.size();
+        paths.push_back(path);
+        mipmaps.push_back(ns->getBool("mipmap") ? 1 : 0);
+    }
+    properties->rewind();
+}
+
+SceneLoader::~SceneLoader()
+{
+    for (size_t i = 0, count = _textures.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_textures[i]);
+    }
+}
+
 Scene* SceneLoader::load(const char* url)
 {
+    GP_PROFILE("SceneLoader::load");
     SceneLoader loader;
     return loader.loadInternal(url);
 }
 
+bool SceneLoader::bake(const char* url, const char* path)
+{
+    GP_ASSERT(path);
+
+    SceneLoader loader;
+    std::string urlStr = url ? url : "";
+    std::string id;
+    splitURL(urlStr, &loader._path, &id);
+
+    Properties* properties = Properties::create(url);
+    if (properties == NULL)
+    {
+        GP_ERROR("Failed to load scene file '%s'.", url);
+        return false;
+    }
+
+    Properties* sceneProperties = (strlen(properties->getNamespace()) > 0) ? properties : properties->getNextNamespace();
+    if (!sceneProperties || !(strcmp(sceneProperties->getNamespace(), "scene") == 0))
+    {
+        GP_ERROR("Failed to bake scene from properties object: must be non-null object and have namespace equal to 'scene'.");
+        SAFE_DELETE(properties);
+        return false;
+    }
+    loader.buildReferenceTables(sceneProperties);
+
+    // The baked file holds the scene namespace, followed by the root of each referenced file
+    // with the path of the file as its ID and no name. Each keeps the directory it was loaded
+    // from, so that paths in them resolve as they did in the text files.
+    Properties baked;
+    Properties* scene = sceneProperties->clone();
+    scene->setDirectoryPath(FileSystem::getDirectoryName(loader._path.c_str()));
+    scene->_parent = &baked;
+    baked._namespaces.push_back(scene);
+    SAFE_DELETE(properties);
+
+    std::set<std::string> files;
+    for (std::map<std::string, Properties*>::const_iterator itr = loader._properties.begin(); itr != loader._properties.end(); ++itr)
+    {
+        if (itr->second)
+            continue;
+
+        std::string fileString;
+        std::vector<std::string> namespacePath;
+        calculateNamespacePath(itr->first, fileString, namespacePath);
+        if (!files.insert(fileString).second)
+            continue;
+
+        Properties* file = Properties::create(fileString.c_str());
+        if (file == NULL)
+        {
+            GP_ERROR("Failed to load referenced properties file '%s'.", fileString.c_str());
+            continue;
+        }
+        file->_namespace = 0;
+        file->_id = StringId::intern(fileString.c_str());
+        file->_parent = &baked;
+        baked._namespaces.push_back(file);
+    }
+
+    std::auto_ptr<Stream> stream(FileSystem::open(path, FileSystem::WRITE));
+    if (stream.get() == NULL)
+    {
+        GP_ERROR("Failed to open file '%s' for writing.", path);
+        return false;
+    }
+    if (!baked.writeBinary(stream.get()))
+    {
+        GP_ERROR("Failed to write baked scene file '%s'.", path);
+        return false;
+    }
+    stream->close();
+    return true;
+}
+
 Scene* SceneLoader::loadInternal(const char* url)
 {
     // Get the file part of the url that we are loading the scene from.
@@ -50,9 +228,21 @@ Scene* SceneLoader::loadInternal(const char* url)
         _gpbPath = path;
     }
 
+    // Files embedded in a baked scene are the unnamed namespaces that follow the scene.
+    if (sceneProperties != properties)
+    {
+        Properties* ns;
+        while ((ns = properties->getNextNamespace()) != NULL)
+        {
+            if (strlen(ns->getNamespace()) == 0 && strlen(ns->getId()) > 0)
+                _bakedFiles[ns->getId()] = ns;
+        }
+    }
+
     // Build the node URL/property and animation reference tables and load the referenced files/store the inline properties objects.
     buildReferenceTables(sceneProperties);
     loadReferencedFiles();
+    prefetchTextures();
 
     // Load the main scene data from GPB and apply the global scene properties.
     Scene* scene = NULL;
@@ -91,7 +281,7 @@ Scene* SceneLoader::loadInternal(const char* url)
         SceneNodeProperty::TRANSLATE);
     applyNodeProperties(scene, sceneProperties, SceneNodeProperty::COLLISION_OBJECT);
 
-    // Apply node tags
+    // Apply node tags and occluder flags
     for (size_t i = 0, sncount = _sceneNodes.size(); i < sncount; ++i)
     {
         SceneNode& sceneNode = _sceneNodes[i];
@@ -100,8 +290,44 @@ Scene* SceneLoader::loadInternal(const char* url)
             for (size_t n = 0, ncount = sceneNode._nodes.size(); n < ncount; ++n)
                 sceneNode._nodes[n]->setTag(itr->first.c_str(), itr->second.c_str());
         }
+        if (sceneNode._occluder)
+        {
+            for (size_t n = 0, ncount = sceneNode._nodes.size(); n < ncount; ++n)
+                sceneNode._nodes[n]->setOccluder(true);
+        }
     }
 
+    // Merge the models of static nodes that share materials. Occluders keep their models,
+    // since the occlusion buffer draws them.
+    StaticBatch staticBatch(sceneProperties->getFloat("staticBatchCellSize"));
+    bool hasStaticNodes = false;
+    for (size_t i = 0, sncount = _sceneNodes.size(); i < sncount; ++i)
+    {
+        SceneNode& sceneNode = _sceneNodes[i];
+        if (!sceneNode._static || sceneNode._occluder)
+            continue;
+
+        // The nodes are batched by the URLs of their materials.
+        std::string materialKey;
+        for (size_t p = 0, pcount = sceneNode._properties.size(); p < pcount; ++p)
+        {
+            const SceneNodeProperty& snp = sceneNode._properties[p];
+            if (snp._type == SceneNodeProperty::MATERIAL)
+            {
+                char index[16];
+                sprintf(index, "[%d]", snp._index);
+                materialKey += snp._url + index + ";";
+            }
+        }
+        if (materialKey.empty())
+            continue;
+
+        for (size_t n = 0, ncount = sceneNode._nodes.size(); n < ncount; ++n)
+            hasStaticNodes |= staticBatch.add(sceneNode._nodes[n], materialKey.c_str());
+    }
+    if (hasStaticNodes)
+        staticBatch.build(scene);
+
     // Set active camera
     const char* activeCamera = sceneProperties->getString("activeCamera");
     if (activeCamera)
@@ -248,7 +474,7 @@ void SceneLoader::applyNodeProperty(SceneNode& sceneNode, Node* node, const Prop
             }
             else
             {
-                Material* material = Material::create(p);
+                Material* material = Material::createFromTemplate(snp._url.c_str(), p);
                 node->getModel()->setMaterial(material, snp._index);
                 SAFE_RELEASE(material);
             }
@@ -682,6 +908,14 @@ void SceneLoader::buildReferenceTables(Properties* sceneProperties)
                 {
                     addSceneNodeProperty(sceneNode, SceneNodeProperty::SCALE);
                 }
+                else if (strcmp(name, "occluder") == 0)
+                {
+                    sceneNode._occluder = ns->getBool();
+                }
+                else if (strcmp(name, "static") == 0)
+                {
+                    sceneNode._static = ns->getBool();
+                }
                 else
                 {
                     GP_ERROR("Unsupported node property: %s = %s", name, ns->getString());
@@ -1003,9 +1237,38 @@ void SceneLoader::loadPhysics(Properties* physics, Scene* scene)
 
 void SceneLoader::loadReferencedFiles()
 {
-    // Load all referenced properties files.
+    // Find the referenced properties files that are not loaded yet.
+    std::vector<std::string> files;
+    std::set<std::string> found;
     std::map<std::string, Properties*>::iterator iter = _properties.begin();
     for (; iter != _properties.end(); ++iter)
+    {
+        if (iter->second == NULL)
+        {
+            std::string fileString;
+            std::vector<std::string> namespacePath;
+            calculateNamespacePath(iter->first, fileString, namespacePath);
+            if (_propertiesFromFile.count(fileString) == 0 && _bakedFiles.count(fileString) == 0 && found.insert(fileString).second)
+                files.push_back(fileString);
+        }
+    }
+
+    // Parse them in parallel, since they do not depend on each other.
+    std::vector<Properties*> loaded(files.size(), (Properties*)NULL);
+    ParseFilesRange range;
+    range.files = &files;
+    range.properties = &loaded;
+    runRange(&range, (unsigned int)files.size());
+    for (size_t i = 0, count = files.size(); i < count; ++i)
+    {
+        if (loaded[i])
+            _propertiesFromFile.insert(std::make_pair(files[i], loaded[i]));
+        else
+            GP_ERROR("Failed to load referenced properties file '%s'.", files[i].c_str());
+    }
+
+    // Resolve the referenced properties objects.
+    for (iter = _properties.begin(); iter != _properties.end(); ++iter)
     {
         if (iter->second == NULL)
         {
@@ -1013,24 +1276,22 @@ void SceneLoader::loadReferencedFiles()
             std::vector<std::string> namespacePath;
             calculateNamespacePath(iter->first, fileString, namespacePath);
 
-            // Check if the referenced properties file has already been loaded.
             Properties* properties = NULL;
             std::map<std::string, Properties*>::iterator pffIter = _propertiesFromFile.find(fileString);
+            std::map<std::string, Properties*>::iterator bakedIter = _bakedFiles.find(fileString);
             if (pffIter != _propertiesFromFile.end() && pffIter->second)
             {
                 properties = pffIter->second;
             }
+            else if (bakedIter != _bakedFiles.end())
+            {
+                // Owned by the baked scene's properties object.
+                properties = bakedIter->second;
+            }
             else
             {
-                properties = Properties::create(fileString.c_str());
-                if (properties == NULL)
-                {
-                    GP_ERROR("Failed to load referenced properties file '%s'.", fileString.c_str());
-                    continue;
-                }
-
-                // Add the properties object to the cache.
-                _propertiesFromFile.insert(std::make_pair(fileString, properties));
+                // The file failed to load.
+                continue;
             }
 
             Properties* p = getPropertiesFromNamespacePath(properties, namespacePath);
@@ -1044,6 +1305,54 @@ void SceneLoader::loadReferencedFiles()
     }
 }
 
+void SceneLoader::prefetchTextures()
+{
+    // Collect the images of the materials that are not loaded yet.
+    std::map<std::string, size_t> indices;
+    std::vector<std::string> paths;
+    std::vector<char> mipmaps;
+    for (std::map<std::string, Properties*>::const_iterator itr = _properties.begin(); itr != _properties.end(); ++itr)
+    {
+        if (itr->second)
+            collectSamplerImages(itr->second, indices, paths, mipmaps);
+    }
+    for (size_t i = 0; i < paths.size(); )
+    {
+        Texture* cached = Texture::findCached(paths[i].c_str(), false);
+        if (cached)
+        {
+            SAFE_RELEASE(cached);
+            paths.erase(paths.begin() + i);
+            mipmaps.erase(mipmaps.begin() + i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    // Decode them in parallel, and then create the textures on this thread, which owns the GL
+    // context. The textures are cached by path, so the materials created later use them.
+    std::vector<Image*> images(paths.size(), (Image*)NULL);
+    DecodeImagesRange range;
+    range.paths = &paths;
+    range.images = &images;
+    runRange(&range, (unsigned int)paths.size());
+    for (size_t i = 0, count = paths.size(); i < count; ++i)
+    {
+        if (images[i] == NULL)
+            continue;
+
+        Texture* texture = Texture::create(images[i], mipmaps[i] != 0);
+        if (texture)
+        {
+            Texture::addToCache(texture, paths[i].c_str());
+            _textures.push_back(texture);
+        }
+        SAFE_RELEASE(images[i]);
+    }
+}
+
 PhysicsConstraint* SceneLoader::loadSocketConstraint(const Properties* constraint, PhysicsRigidBody* rbA, PhysicsRigidBody* rbB)
 {
     GP_ASSERT(rbA);
@@ -1181,7 +1490,7 @@ void splitURL(const std::string& url, std::string* file, std::string* id)
 }
 
 SceneLoader::SceneNode::SceneNode()
-    : _nodeID(""), _exactMatch(true)
+    : _nodeID(""), _exactMatch(true), _occluder(false), _static(false)
 {
 }
 
@@ -28,6 +28,22 @@ private:
      * @param url The URL pointing to the Properties object defining the scene.
      */
     static Scene* load(const char* url);
+
+    /**
+     * Bakes the scene defined at the specified URL, and the properties files it references,
+     * into a binary file.
+     *
+     * @param url The URL pointing to the Properties object defining the scene.
+     * @param path The path of the binary file to write.
+     *
+     * @return True if the scene was baked, false otherwise.
+     */
+    static bool bake(const char* url, const char* path);
+
+    /**
+     * Destructor. Releases the textures prefetched for the scene.
+     */
+    ~SceneLoader();
     
     /**
      * Helper structures and functions for SceneLoader::load(const char*).
@@ -72,6 +88,8 @@ private:
 
         const char* _nodeID;
         bool _exactMatch;
+        bool _occluder;
+        bool _static;
         std::vector<Node*> _nodes;
         std::vector<SceneNodeProperty> _properties;
         std::map<std::string, std::string> _tags;
@@ -105,16 +123,20 @@ private:
 
     void loadReferencedFiles();
 
+    void prefetchTextures();
+
     PhysicsConstraint* loadSocketConstraint(const Properties* constraint, PhysicsRigidBody* rbA, PhysicsRigidBody* rbB);
 
     PhysicsConstraint* loadSpringConstraint(const Properties* constraint, PhysicsRigidBody* rbA, PhysicsRigidBody* rbB);
 
     std::map<std::string, Properties*> _propertiesFromFile;      // Holds the properties object for a given file.
     std::map<std::string, Properties*> _properties;              // Holds the properties object for a given URL.
+    std::map<std::string, Properties*> _bakedFiles;              // Holds the files embedded in a baked scene, by path.
     std::vector<SceneAnimation> _animations;                     // Holds the animations declared in the .scene file.
     std::vector<SceneNode> _sceneNodes;                          // Holds all the nodes+properties declared in the .scene file.
     std::string _gpbPath;                                        // The path of the main GPB for the scene being loaded.
     std::string _path;                                           // The path of the scene file being loaded.
+    std::vector<Texture*> _textures;                             // Holds the textures prefetched for the referenced materials.
 };
 
 /**
@@ -1,11 +1,22 @@
 #include "Base.h"
 #include "FileSystem.h"
 #include "ScriptController.h"
+#include "MemoryStats.h"
 
 #ifndef NO_LUA_BINDINGS
 #include "lua/lua_all_bindings.h"
 #endif
 
+// The identifier at the start of compiled script chunks, which gameplay-encoder writes too.
+#define SCRIPT_CHUNK_IDENTIFIER "\xABGPL"
+
+// The version of Lua that compiled a chunk, which must be the version that runs it.
+#ifdef GP_USE_LUAJIT
+#define SCRIPT_CHUNK_VERSION (0x80000000u | LUAJIT_VERSION_NUM)
+#else
+#define SCRIPT_CHUNK_VERSION ((unsigned int)LUA_VERSION_NUM)
+#endif
+
 #define GENERATE_LUA_GET_POINTER(type, checkFunc) \
     ScriptController* sc = Game::getInstance()->getScriptController(); \
     /* Check that the parameter is the correct type. */ \
@@ -333,6 +344,70 @@ void ScriptUtil::registerClass(const char* name, const luaL_Reg* members, lua_CF
     }
 }
 
+// The address of this variable is the registry key of the table of cached object userdata.
+static char __objectCacheKey;
+
+void ScriptUtil::pushObject(lua_State* state, void* instance, const char* type, bool owns)
+{
+    GP_ASSERT(state);
+    GP_ASSERT(instance);
+    GP_ASSERT(type);
+
+    if (owns)
+    {
+        LuaObject* object = (LuaObject*)lua_newuserdata(state, sizeof(LuaObject));
+        object->instance = instance;
+        object->owns = true;
+        luaL_getmetatable(state, type);
+        lua_setmetatable(state, -2);
+        return;
+    }
+
+    // Get the cache, creating it on first use.
+    lua_pushlightuserdata(state, &__objectCacheKey);
+    lua_rawget(state, LUA_REGISTRYINDEX);
+    if (lua_isnil(state, -1))
+    {
+        lua_pop(state, 1);
+        lua_newtable(state);
+        lua_newtable(state);
+        lua_pushstring(state, "v");
+        lua_setfield(state, -2, "__mode");
+        lua_setmetatable(state, -2);
+        lua_pushlightuserdata(state, &__objectCacheKey);
+        lua_pushvalue(state, -2);
+        lua_rawset(state, LUA_REGISTRYINDEX);
+    }
+
+    // Stack: cache, cached userdata (or nil), metatable of the type.
+    lua_pushlightuserdata(state, instance);
+    lua_rawget(state, -2);
+    luaL_getmetatable(state, type);
+    if (lua_type(state, -2) == LUA_TUSERDATA && lua_getmetatable(state, -2))
+    {
+        if (lua_rawequal(state, -1, -2))
+        {
+            lua_pop(state, 2);
+            lua_remove(state, -2);
+            return;
+        }
+        lua_pop(state, 1);
+    }
+
+    LuaObject* object = (LuaObject*)lua_newuserdata(state, sizeof(LuaObject));
+    object->instance = instance;
+    object->owns = false;
+    lua_insert(state, -2);
+    lua_setmetatable(state, -2);
+    lua_pushlightuserdata(state, instance);
+    lua_pushvalue(state, -2);
+    lua_rawset(state, -5);
+
+    // Leave only the new userdata on the stack.
+    lua_replace(state, -3);
+    lua_pop(state, 1);
+}
+
 void ScriptUtil::registerFunction(const char* luaFunction, lua_CFunction cppFunction)
 {
     lua_pushcfunction(Game::getInstance()->getScriptController()->_lua, cppFunction);
@@ -424,36 +499,159 @@ bool ScriptUtil::luaCheckBool(lua_State* state, int n)
 }
 
 
+/**
+ * Returns a 64-bit hash of the source of a script (FNV-1a).
+ */
+static unsigned long long hashSource(const char* source, size_t size)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= (unsigned char)source[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * Appends the output of lua_dump to a vector.
+ */
+static int writeChunkData(lua_State* state, const void* data, size_t size, void* userdata)
+{
+    std::vector<char>* chunk = (std::vector<char>*)userdata;
+    chunk->insert(chunk->end(), (const char*)data, (const char*)data + size);
+    return 0;
+}
+
+void ScriptController::getSourceFiles(std::set<std::string>& files) const
+{
+    files.insert(_loadedScripts.begin(), _loadedScripts.end());
+}
+
 void ScriptController::loadScript(const char* path, bool forceReload)
 {
     GP_ASSERT(path);
     std::set<std::string>::iterator iter = _loadedScripts.find(path);
     if (iter == _loadedScripts.end() || forceReload)
     {
-#ifdef __ANDROID__
-        const char* scriptContents = FileSystem::readAll(path);
-        if (luaL_dostring(_lua, scriptContents))
+        // Error messages name the script like luaL_dofile does.
+        std::string name = std::string("@") + path;
+        std::string chunkPath = std::string(path) + "c";
+        bool loaded = false;
+        int size = 0;
+        char* source = FileSystem::fileExists(path) ? FileSystem::readAll(path, &size) : NULL;
+        if (source)
         {
-            GP_WARN("Failed to run Lua script with error: '%s'.", lua_tostring(_lua, -1));
+            unsigned long long hash = hashSource(source, (size_t)size);
+            loaded = loadChunk(chunkPath.c_str(), &hash, name.c_str());
+
+            std::string cacheFile;
+            if (!loaded && !_cachePath.empty())
+            {
+                char cacheName[32];
+                sprintf(cacheName, "%016llx.luac", hash);
+                cacheFile = _cachePath + cacheName;
+                loaded = loadChunk(cacheFile.c_str(), &hash, name.c_str());
+            }
+
+            if (!loaded)
+            {
+                if (luaL_loadbuffer(_lua, source, (size_t)size, name.c_str()))
+                {
+                    GP_WARN("Failed to compile Lua script with error: '%s'.", lua_tostring(_lua, -1));
+                    lua_pop(_lua, 1);
+                }
+                else
+                {
+                    loaded = true;
+                    if (!cacheFile.empty() && !writeChunk(cacheFile.c_str(), hash))
+                        GP_WARN("Failed to write script cache file '%s'.", cacheFile.c_str());
+                }
+            }
+            SAFE_DELETE_ARRAY(source);
         }
-        SAFE_DELETE_ARRAY(scriptContents);
-#else
-        std::string fullPath;
-        if (!FileSystem::isAbsolutePath(path))
+        else
         {
-            fullPath.append(FileSystem::getResourcePath());
+            loaded = loadChunk(chunkPath.c_str(), NULL, name.c_str());
+            if (!loaded)
+                GP_WARN("Failed to read Lua script '%s'.", path);
         }
-        fullPath.append(path);
-        if (luaL_dofile(_lua, fullPath.c_str()))
+
+        if (loaded && lua_pcall(_lua, 0, 0, 0))
         {
             GP_WARN("Failed to run Lua script with error: '%s'.", lua_tostring(_lua, -1));
+            lua_pop(_lua, 1);
         }
-#endif
+
         if (iter == _loadedScripts.end())
         {
             _loadedScripts.insert(path);
         }
+
+        // The script may have defined or redefined prepared functions.
+        invalidateFunctions();
+    }
+}
+
+void ScriptController::setCachePath(const char* path)
+{
+    _cachePath = path ? path : "";
+    if (!_cachePath.empty() && _cachePath[_cachePath.size() - 1] != '/')
+        _cachePath += '/';
+}
+
+const char* ScriptController::getCachePath() const
+{
+    return _cachePath.c_str();
+}
+
+bool ScriptController::loadChunk(const char* path, const unsigned long long* hash, const char* name)
+{
+    std::auto_ptr<Stream> stream(FileSystem::open(path));
+    if (stream.get() == NULL)
+        return false;
+
+    char identifier[sizeof(SCRIPT_CHUNK_IDENTIFIER) - 1];
+    unsigned int version;
+    unsigned long long sourceHash;
+    if (stream->read(identifier, 1, sizeof(identifier)) != sizeof(identifier) ||
+        memcmp(identifier, SCRIPT_CHUNK_IDENTIFIER, sizeof(identifier)) != 0 ||
+        stream->read(&version, sizeof(version), 1) != 1 || version != SCRIPT_CHUNK_VERSION ||
+        stream->read(&sourceHash, sizeof(sourceHash), 1) != 1 || (hash && sourceHash != *hash))
+    {
+        return false;
+    }
+
+    size_t size = stream->length() - (size_t)stream->position();
+    std::vector<char> data(size);
+    if (size == 0 || stream->read(&data[0], 1, size) != size)
+        return false;
+
+    // The chunk may still be rejected by Lua, e.g. if it was compiled for another architecture.
+    if (luaL_loadbuffer(_lua, &data[0], size, name))
+    {
+        GP_WARN("Failed to load compiled Lua chunk '%s' with error: '%s'.", path, lua_tostring(_lua, -1));
+        lua_pop(_lua, 1);
+        return false;
     }
+    return true;
+}
+
+bool ScriptController::writeChunk(const char* path, unsigned long long hash)
+{
+    std::vector<char> data;
+    if (lua_dump(_lua, writeChunkData, &data) != 0 || data.empty())
+        return false;
+
+    std::auto_ptr<Stream> stream(FileSystem::open(path, FileSystem::WRITE));
+    if (stream.get() == NULL)
+        return false;
+
+    unsigned int version = SCRIPT_CHUNK_VERSION;
+    return stream->write(SCRIPT_CHUNK_IDENTIFIER, 1, sizeof(SCRIPT_CHUNK_IDENTIFIER) - 1) == sizeof(SCRIPT_CHUNK_IDENTIFIER) - 1 &&
+        stream->write(&version, sizeof(version), 1) == 1 &&
+        stream->write(&hash, sizeof(hash), 1) == 1 &&
+        stream->write(&data[0], 1, data.size()) == data.size();
 }
 
 std::string ScriptController::loadUrl(const char* url)
@@ -655,12 +853,159 @@ void ScriptController::print(const char* str1, const char* str2)
     gameplay::print("%s%s", str1, str2);
 }
 
-ScriptController::ScriptController() : _lua(NULL)
+// The argument signatures of the script callbacks, by ScriptCallback.
+static const char* __callbackSignatures[] =
+{
+    NULL,                                       // INITIALIZE
+    "f",                                        // UPDATE
+    "f",                                        // RENDER
+    NULL,                                       // FINALIZE
+    "uiui",                                     // RESIZE_EVENT
+    "[Keyboard::KeyEvent][Keyboard::Key]",      // KEY_EVENT
+    "[Mouse::MouseEvent]iii",                   // MOUSE_EVENT
+    "[Touch::TouchEvent]iiui",                  // TOUCH_EVENT
+    "iii",                                      // GESTURE_SWIPE_EVENT
+    "iif",                                      // GESTURE_PINCH_EVENT
+    "ii",                                       // GESTURE_TAP_EVENT
+    "[Gamepad::GamepadEvent]<Gamepad>"          // GAMEPAD_EVENT
+};
+
+ScriptFunction::ScriptFunction(ScriptController* controller, const char* name, const char* signature)
+    : _controller(controller), _name(name), _signature(signature ? signature : ""), _ref(LUA_NOREF)
+{
+    // The signature is parsed here, with the same rules as ScriptController::executeFunctionHelper.
+    const char* sig = _signature.c_str();
+    while (*sig)
+    {
+        Argument argument;
+        argument.type = *sig++;
+        switch (argument.type)
+        {
+        case 'c':
+        case 'h':
+        case 'l':
+            argument.type = 'i';
+            break;
+        case 'd':
+            argument.type = 'f';
+            break;
+        case 'u':
+            // Skip past the actual type (long, int, short, char).
+            if (*sig)
+                sig++;
+            break;
+        case 'i':
+        case 'b':
+        case 'f':
+        case 's':
+        case 'p':
+            break;
+        case '[':
+        case '<':
+        {
+            const char* end = strchr(sig, argument.type == '[' ? ']' : '>');
+            if (end == NULL)
+            {
+                GP_ERROR("Invalid argument signature '%s' for function '%s'.", _signature.c_str(), _name.c_str());
+                return;
+            }
+            argument.typeName.assign(sig, end);
+            sig = end + 1;
+
+            // Object types are pushed with the Lua type name, which has no scope separators
+            // (this must match the preprocessor define SCOPE_REPLACEMENT from the gameplay-luagen project).
+            if (argument.type == '<')
+            {
+                size_t i;
+                while ((i = argument.typeName.find("::")) != std::string::npos)
+                    argument.typeName.replace(i, 2, "");
+            }
+            break;
+        }
+        default:
+            GP_ERROR("Invalid argument type '%d'.", argument.type);
+            return;
+        }
+        _arguments.push_back(argument);
+    }
+}
+
+ScriptFunction::~ScriptFunction()
 {
+    if (_controller)
+        _controller->removeFunction(this);
+}
+
+const char* ScriptFunction::getName() const
+{
+    return _name.c_str();
+}
+
+const char* ScriptFunction::getSignature() const
+{
+    return _signature.c_str();
+}
+
+ScriptController::ScriptController()
+    : _lua(NULL), _coalesceMoveEvents(false), _mouseMovePending(false), _mouseMoveX(0), _mouseMoveY(0)
+{
+    memset(_eventFilters, 0, sizeof(_eventFilters));
 }
 
 ScriptController::~ScriptController()
 {
+    // Prepared functions may outlive the controller.
+    for (size_t i = 0, count = _functions.size(); i < count; ++i)
+    {
+        _functions[i]->_controller = NULL;
+    }
+}
+
+ScriptFunction* ScriptController::prepareFunction(const char* func, const char* args)
+{
+    GP_ASSERT(func);
+
+    ScriptFunction* function = new ScriptFunction(this, func, args);
+    _functions.push_back(function);
+    return function;
+}
+
+bool ScriptController::resolveFunction(ScriptFunction* function)
+{
+    GP_ASSERT(function && function->_ref == LUA_NOREF);
+
+    // Looking up a nested function leaves its tables on the stack.
+    int top = lua_gettop(_lua);
+    bool found = getNestedVariable(_lua, function->_name.c_str()) && !lua_isnil(_lua, -1);
+    if (found)
+        function->_ref = luaL_ref(_lua, LUA_REGISTRYINDEX);
+    lua_settop(_lua, top);
+    return found;
+}
+
+void ScriptController::invalidateFunctions()
+{
+    for (size_t i = 0, count = _functions.size(); i < count; ++i)
+    {
+        ScriptFunction* function = _functions[i];
+        if (function->_ref != LUA_NOREF)
+        {
+            if (_lua)
+                luaL_unref(_lua, LUA_REGISTRYINDEX, function->_ref);
+            function->_ref = LUA_NOREF;
+        }
+    }
+}
+
+void ScriptController::removeFunction(ScriptFunction* function)
+{
+    if (_lua && function->_ref != LUA_NOREF)
+        luaL_unref(_lua, LUA_REGISTRYINDEX, function->_ref);
+    function->_ref = LUA_NOREF;
+
+    std::vector<ScriptFunction*>::iterator itr = std::find(_functions.begin(), _functions.end(), function);
+    if (itr != _functions.end())
+        _functions.erase(itr);
 }
 
 static const char* lua_print_function = 
@@ -673,8 +1018,7 @@ static const char* lua_loadfile_function =
     "    local oldLoadfile = loadfile\n"
     "    loadfile = function(filename)\n"
     "        if filename ~= nil and not FileSystem.isAbsolutePath(filename) then\n"
-    "            FileSystem.createFileFromAsset(filename)\n"
-    "            filename = FileSystem.getResourcePath() .. filename\n"
+    "            return loadResourceFile(filename)\n"
     "        end\n"
     "        return oldLoadfile(filename)\n"
     "    end\n"
@@ -685,13 +1029,73 @@ static const char* lua_dofile_function =
     "    local oldDofile = dofile\n"
     "    dofile = function(filename)\n"
     "        if filename ~= nil and not FileSystem.isAbsolutePath(filename) then\n"
-    "            FileSystem.createFileFromAsset(filename)\n"
-    "            filename = FileSystem.getResourcePath() .. filename\n"
+    "            local chunk, message = loadResourceFile(filename)\n"
+    "            if chunk == nil then\n"
+    "                error(message, 2)\n"
+    "            end\n"
+    "            return chunk()\n"
     "        end\n"
     "        return oldDofile(filename)\n"
     "    end\n"
     "end\n";
 
+/**
+ * Compiles a script read through the FileSystem, returning the chunk, or nil and an error message
+ * like loadfile. Reading through the FileSystem resolves aliases and reads Android assets in place
+ * rather than copying them to the file system first.
+ */
+static int loadResourceFile(lua_State* state)
+{
+    const char* path = luaL_checkstring(state, 1);
+    if (!FileSystem::fileExists(path))
+    {
+        lua_pushnil(state);
+        lua_pushfstring(state, "cannot open %s", path);
+        return 2;
+    }
+
+    int size = 0;
+    char* source = FileSystem::readAll(path, &size);
+    if (source == NULL)
+    {
+        lua_pushnil(state);
+        lua_pushfstring(state, "cannot read %s", path);
+        return 2;
+    }
+
+    std::string name("@");
+    name += path;
+    int result = luaL_loadbuffer(state, source, (size_t)size, name.c_str());
+    SAFE_DELETE_ARRAY(source);
+    if (result != 0)
+    {
+        lua_pushnil(state);
+        lua_insert(state, -2);
+        return 2;
+    }
+    return 1;
+}
+
+#ifdef GP_USE_LUAJIT
+// Declares the math value types to the FFI, and ffiPointer(object, type), which returns a pointer
+// to the C++ object of a userdata (e.g. ffiPointer(v, "Vector3").x), for math without binding calls.
+static const char* lua_ffi_types = 
+    "do\n"
+    "    local ffi = require(\"ffi\")\n"
+    "    ffi.cdef[[\n"
+    "        typedef struct { float x, y; } gameplay_Vector2;\n"
+    "        typedef struct { float x, y, z; } gameplay_Vector3;\n"
+    "        typedef struct { float x, y, z, w; } gameplay_Vector4;\n"
+    "        typedef struct { float x, y, z, w; } gameplay_Quaternion;\n"
+    "        typedef struct { float m[16]; } gameplay_Matrix;\n"
+    "        typedef struct { void* instance; bool owns; } gameplay_LuaObject;\n"
+    "    ]]\n"
+    "    ffiPointer = function(object, type)\n"
+    "        return ffi.cast(\"gameplay_\" .. type .. \"*\", ffi.cast(\"gameplay_LuaObject*\", object).instance)\n"
+    "    end\n"
+    "end\n";
+#endif
+
 /**
  * @script{ignore}
  */
@@ -715,17 +1119,52 @@ void appendLuaPath(lua_State* state, const char* path)
     lua_pop(state, 1);
 }
 
+#ifndef GP_USE_LUAJIT
+// The allocator of the Lua state, which counts the memory of the interpreter in MemoryStats.
+static void* luaAllocate(void* ud, void* ptr, size_t osize, size_t nsize)
+{
+    // When ptr is NULL, osize encodes the type of object being allocated rather than a size.
+    if (ptr)
+        MemoryStats::remove(MemoryStats::SCRIPT, osize);
+    if (nsize == 0)
+    {
+        free(ptr);
+        return NULL;
+    }
+    void* p = realloc(ptr, nsize);
+    if (p)
+        MemoryStats::add(MemoryStats::SCRIPT, nsize);
+    else if (ptr)
+        MemoryStats::add(MemoryStats::SCRIPT, osize);
+    return p;
+}
+#endif
+
+static int luaPanic(lua_State* state)
+{
+    GP_ERROR("Unprotected error in call to Lua API (%s).", lua_tostring(state, -1));
+    return 0;
+}
+
 void ScriptController::initialize()
 {
+#ifdef GP_USE_LUAJIT
+    // LuaJIT uses its own allocator on 64-bit platforms, so its memory is not counted in MemoryStats.
     _lua = luaL_newstate();
+#else
+    _lua = lua_newstate(luaAllocate, NULL);
+#endif
     if (!_lua)
         GP_ERROR("Failed to initialize Lua scripting engine.");
+    lua_atpanic(_lua, luaPanic);
     luaL_openlibs(_lua);
 
 #ifndef NO_LUA_BINDINGS
     lua_RegisterAllBindings();
     ScriptUtil::registerFunction("convert", ScriptController::convert);
 #endif
+    lua_register(_lua, "async", ScriptController::async);
+    lua_register(_lua, "await", ScriptController::await);
 
     // Append to the LUA_PATH to allow scripts to be found in the resource folder on all platforms
     appendLuaPath(_lua, FileSystem::getResourcePath());
@@ -734,12 +1173,18 @@ void ScriptController::initialize()
     if (luaL_dostring(_lua, lua_print_function))
         GP_ERROR("Failed to load custom print() function with error: '%s'.", lua_tostring(_lua, -1));
 
-    // Change the functions that read a file to use FileSystem.getResourcePath as their base path.
+    // Change the functions that read a file to read through the FileSystem.
+    lua_register(_lua, "loadResourceFile", loadResourceFile);
     if (luaL_dostring(_lua, lua_loadfile_function))
         GP_ERROR("Failed to load custom loadfile() function with error: '%s'.", lua_tostring(_lua, -1));
     if (luaL_dostring(_lua, lua_dofile_function))
         GP_ERROR("Failed to load custom dofile() function with error: '%s'.", lua_tostring(_lua, -1));
 
+#ifdef GP_USE_LUAJIT
+    if (luaL_dostring(_lua, lua_ffi_types))
+        GP_ERROR("Failed to declare the FFI math types with error: '%s'.", lua_tostring(_lua, -1));
+#endif
+
     // Write game command-line arguments to a global lua "arg" table
     std::ostringstream args;
     int argc;
@@ -760,13 +1205,25 @@ void ScriptController::initialize()
 
 void ScriptController::initializeGame()
 {
-    std::vector<std::string>& list = _callbacks[INITIALIZE];
+    std::vector<ScriptFunction*>& list = _callbacks[INITIALIZE];
     for (size_t i = 0; i < list.size(); ++i)
-        executeFunction<void>(list[i].c_str());
+        executeFunction<void>(list[i]);
 }
 
 void ScriptController::finalize()
 {
+    for (unsigned int i = 0; i < CALLBACK_COUNT; i++)
+    {
+        for (size_t j = 0; j < _callbacks[i].size(); ++j)
+            SAFE_RELEASE(_callbacks[i][j]);
+        _callbacks[i].clear();
+    }
+    _mouseMovePending = false;
+    _touchMoves.clear();
+    _coroutines.clear();
+
+    // The functions still prepared by others are dropped from the registry, which is closed with the state.
+    invalidateFunctions();
     if (_lua)
 	{
         lua_close(_lua);
@@ -776,15 +1233,28 @@ void ScriptController::finalize()
 
 void ScriptController::finalizeGame()
 {
-    std::vector<std::string> finalizeCallbacks = _callbacks[FINALIZE]; // no & : makes a copy of the vector
+    std::vector<ScriptFunction*> finalizeCallbacks = _callbacks[FINALIZE]; // no & : makes a copy of the vector
+    _callbacks[FINALIZE].clear();
 
 	// Remove any registered callbacks so they don't get called after shutdown
 	for (unsigned int i = 0; i < CALLBACK_COUNT; i++)
+    {
+        for (size_t j = 0; j < _callbacks[i].size(); ++j)
+            SAFE_RELEASE(_callbacks[i][j]);
         _callbacks[i].clear();
+    }
+
+    // Stop the coroutines, so they do not resume after shutdown.
+    for (size_t i = 0; i < _coroutines.size(); ++i)
+        releaseCoroutine(_coroutines[i]);
+    _coroutines.clear();
 
 	// Fire script finalize callbacks
     for (size_t i = 0; i < finalizeCallbacks.size(); ++i)
-        executeFunction<void>(finalizeCallbacks[i].c_str());
+    {
+        executeFunction<void>(finalizeCallbacks[i]);
+        SAFE_RELEASE(finalizeCallbacks[i]);
+    }
 
     // Perform a full garbage collection cycle.
 	// Note that this does NOT free any global variables declared in scripts, since 
@@ -795,45 +1265,93 @@ void ScriptController::finalizeGame()
 
 void ScriptController::update(float elapsedTime)
 {
-    std::vector<std::string>& list = _callbacks[UPDATE];
+    flushMoveEvents();
+
+    std::vector<ScriptFunction*>& list = _callbacks[UPDATE];
     for (size_t i = 0; i < list.size(); ++i)
-        executeFunction<void>(list[i].c_str(), "f", elapsedTime);
+        executeFunction<void>(list[i], elapsedTime);
 }
 
 void ScriptController::render(float elapsedTime)
 {
-    std::vector<std::string>& list = _callbacks[RENDER];
+    std::vector<ScriptFunction*>& list = _callbacks[RENDER];
     for (size_t i = 0; i < list.size(); ++i)
-        executeFunction<void>(list[i].c_str(), "f", elapsedTime);
+        executeFunction<void>(list[i], elapsedTime);
 }
 
 void ScriptController::resizeEvent(unsigned int width, unsigned int height)
 {
-    std::vector<std::string>& list = _callbacks[RESIZE_EVENT];
+    std::vector<ScriptFunction*>& list = _callbacks[RESIZE_EVENT];
     for (size_t i = 0; i < list.size(); ++i)
-        executeFunction<void>(list[i].c_str(), "uiui", width, height);
+        executeFunction<void>(list[i], width, height);
 }
 
 void ScriptController::keyEvent(Keyboard::KeyEvent evt, int key)
 {
-    std::vector<std::string>& list = _callbacks[KEY_EVENT];
+    std::vector<ScriptFunction*>& list = _callbacks[KEY_EVENT];
+    if (list.empty() || isEventFiltered(KEY_EVENT, evt))
+        return;
+    if (evt != Keyboard::KEY_CHAR && !_keyFilter.empty() && _keyFilter.find(key) == _keyFilter.end())
+        return;
+
     for (size_t i = 0; i < list.size(); ++i)
-        executeFunction<void>(list[i].c_str(), "[Keyboard::KeyEvent][Keyboard::Key]", evt, key);
+        executeFunction<void>(list[i], evt, key);
 }
 
 void ScriptController::touchEvent(Touch::TouchEvent evt, int x, int y, unsigned int contactIndex)
 {
-    std::vector<std::string>& list = _callbacks[TOUCH_EVENT];
+    std::vector<ScriptFunction*>& list = _callbacks[TOUCH_EVENT];
+    if (list.empty() || isEventFiltered(TOUCH_EVENT, evt))
+        return;
+
+    if (_coalesceMoveEvents)
+    {
+        if (evt == Touch::TOUCH_MOVE)
+        {
+            // Replace the last move of the contact that has not been passed to the scripts yet.
+            for (size_t i = 0, count = _touchMoves.size(); i < count; ++i)
+            {
+                if (_touchMoves[i].contactIndex == contactIndex)
+                {
+                    _touchMoves[i].x = x;
+                    _touchMoves[i].y = y;
+                    return;
+                }
+            }
+            TouchMove move = { contactIndex, x, y };
+            _touchMoves.push_back(move);
+            return;
+        }
+
+        // Pass the moves that came before this event first, to keep the events in order.
+        flushMoveEvents();
+    }
+
     for (size_t i = 0; i < list.size(); ++i)
-        executeFunction<void>(list[i].c_str(), "[Touch::TouchEvent]iiui", evt, x, y, contactIndex);
+        executeFunction<void>(list[i], evt, x, y, contactIndex);
 }
 
 bool ScriptController::mouseEvent(Mouse::MouseEvent evt, int x, int y, int wheelDelta)
 {
-    std::vector<std::string>& list = _callbacks[MOUSE_EVENT];
+    std::vector<ScriptFunction*>& list = _callbacks[MOUSE_EVENT];
+    if (list.empty() || isEventFiltered(MOUSE_EVENT, evt))
+        return false;
+
+    if (_coalesceMoveEvents)
+    {
+        if (evt == Mouse::MOUSE_MOVE)
+        {
+            _mouseMovePending = true;
+            _mouseMoveX = x;
+            _mouseMoveY = y;
+            return false;
+        }
+        flushMoveEvents();
+    }
+
     for (size_t i = 0; i < list.size(); ++i)
     {
-        if (executeFunction<bool>(list[i].c_str(), "[Mouse::MouseEvent]iii", evt, x, y, wheelDelta))
+        if (executeFunction<bool>(list[i], evt, x, y, wheelDelta))
             return true;
     }
     return false;
@@ -841,30 +1359,63 @@ bool ScriptController::mouseEvent(Mouse::MouseEvent evt, int x, int y, int wheel
 
 void ScriptController::gestureSwipeEvent(int x, int y, int direction)
 {
-    std::vector<std::string>& list = _callbacks[GESTURE_SWIPE_EVENT];
+    std::vector<ScriptFunction*>& list = _callbacks[GESTURE_SWIPE_EVENT];
     for (size_t i = 0; i < list.size(); ++i)
-        executeFunction<void>(list[i].c_str(), "iii", x, y, direction);
+        executeFunction<void>(list[i], x, y, direction);
 }
 
 void ScriptController::gesturePinchEvent(int x, int y, float scale)
 {
-    std::vector<std::string>& list = _callbacks[GESTURE_PINCH_EVENT];
+    std::vector<ScriptFunction*>& list = _callbacks[GESTURE_PINCH_EVENT];
     for (size_t i = 0; i < list.size(); ++i)
-        executeFunction<void>(list[i].c_str(), "iif", x, y, scale);
+        executeFunction<void>(list[i], x, y, scale);
 }
 
 void ScriptController::gestureTapEvent(int x, int y)
 {
-    std::vector<std::string>& list = _callbacks[GESTURE_TAP_EVENT];
+    std::vector<ScriptFunction*>& list = _callbacks[GESTURE_TAP_EVENT];
     for (size_t i = 0; i < list.size(); ++i)
-        executeFunction<void>(list[i].c_str(), "ii", x, y);
+        executeFunction<void>(list[i], x, y);
 }
 
 void ScriptController::gamepadEvent(Gamepad::GamepadEvent evt, Gamepad* gamepad, unsigned int analogIndex)
 {
-    std::vector<std::string>& list = _callbacks[GAMEPAD_EVENT];
+    std::vector<ScriptFunction*>& list = _callbacks[GAMEPAD_EVENT];
+    if (isEventFiltered(GAMEPAD_EVENT, evt))
+        return;
     for (size_t i = 0; i < list.size(); ++i)
-        executeFunction<void>(list[i].c_str(), "[Gamepad::GamepadEvent]<Gamepad>", evt, gamepad);
+        executeFunction<void>(list[i], evt, gamepad);
+}
+
+bool ScriptController::isEventFiltered(ScriptCallback callback, int event) const
+{
+    return _eventFilters[callback] != 0 && (_eventFilters[callback] & (1u << event)) == 0;
+}
+
+void ScriptController::flushMoveEvents()
+{
+    if (_mouseMovePending)
+    {
+        _mouseMovePending = false;
+        std::vector<ScriptFunction*>& list = _callbacks[MOUSE_EVENT];
+        for (size_t i = 0; i < list.size(); ++i)
+        {
+            if (executeFunction<bool>(list[i], Mouse::MOUSE_MOVE, _mouseMoveX, _mouseMoveY, 0))
+                break;
+        }
+    }
+
+    if (!_touchMoves.empty())
+    {
+        std::vector<ScriptFunction*>& list = _callbacks[TOUCH_EVENT];
+        for (size_t i = 0; i < _touchMoves.size(); ++i)
+        {
+            const TouchMove& move = _touchMoves[i];
+            for (size_t j = 0; j < list.size(); ++j)
+                executeFunction<void>(list[j], Touch::TOUCH_MOVE, move.x, move.y, move.contactIndex);
+        }
+        _touchMoves.clear();
+    }
 }
 
 void ScriptController::executeFunctionHelper(int resultCount, const char* func, const char* args, va_list* list)
@@ -972,11 +1523,7 @@ void ScriptController::executeFunctionHelper(int resultCount, const char* func,
                 }
                 else
                 {
-                    ScriptUtil::LuaObject* object = (ScriptUtil::LuaObject*)lua_newuserdata(_lua, sizeof(ScriptUtil::LuaObject));
-                    object->instance = ptr;
-                    object->owns = false;
-                    luaL_getmetatable(_lua, type.c_str());
-                    lua_setmetatable(_lua, -2);
+                    ScriptUtil::pushObject(_lua, ptr, type.c_str(), false);
                 }
                 break;
             }
@@ -995,12 +1542,89 @@ void ScriptController::executeFunctionHelper(int resultCount, const char* func,
         GP_WARN("Failed to call function '%s' with error '%s'.", func, lua_tostring(_lua, -1));
 }
 
+void ScriptController::executeFunctionHelper(int resultCount, ScriptFunction* function, va_list* list)
+{
+    if (!_lua)
+        return; // handles calling this method after script is finalized
+
+    GP_ASSERT(function);
+    if (function->_ref == LUA_NOREF && !resolveFunction(function))
+    {
+        GP_WARN("Failed to call function '%s'", function->_name.c_str());
+        return;
+    }
+
+    int argumentCount = (int)function->_arguments.size();
+    GP_ASSERT(argumentCount == 0 || list);
+    luaL_checkstack(_lua, argumentCount + 1, "Too many arguments.");
+    lua_rawgeti(_lua, LUA_REGISTRYINDEX, function->_ref);
+
+    // Push the arguments to the Lua stack.
+    for (int i = 0; i < argumentCount; ++i)
+    {
+        ScriptFunction::Argument& argument = function->_arguments[i];
+        switch (argument.type)
+        {
+        case 'i':
+            lua_pushinteger(_lua, va_arg(*list, int));
+            break;
+        case 'u':
+            lua_pushunsigned(_lua, va_arg(*list, int));
+            break;
+        case 'b':
+            lua_pushboolean(_lua, va_arg(*list, int));
+            break;
+        case 'f':
+            lua_pushnumber(_lua, va_arg(*list, double));
+            break;
+        case 's':
+            lua_pushstring(_lua, va_arg(*list, char*));
+            break;
+        case 'p':
+            lua_pushlightuserdata(_lua, va_arg(*list, void*));
+            break;
+        case '[':
+        {
+            unsigned int value = va_arg(*list, int);
+            const char* enumStr = "";
+            for (unsigned int j = 0; *enumStr == '\0' && j < _stringFromEnum.size(); j++)
+            {
+                const char* str = (*_stringFromEnum[j])(argument.typeName, value);
+                if (str)
+                    enumStr = str;
+            }
+            lua_pushstring(_lua, enumStr);
+            break;
+        }
+        case '<':
+        {
+            void* ptr = va_arg(*list, void*);
+            if (ptr == NULL)
+            {
+                lua_pushnil(_lua);
+            }
+            else
+            {
+                ScriptUtil::pushObject(_lua, ptr, argument.typeName.c_str(), false);
+            }
+            break;
+        }
+        }
+    }
+
+    // The function may release itself, by unregistering its callback for instance.
+    function->addRef();
+    if (lua_pcall(_lua, argumentCount, resultCount, 0) != 0)
+        GP_WARN("Failed to call function '%s' with error '%s'.", function->_name.c_str(), lua_tostring(_lua, -1));
+    function->release();
+}
+
 void ScriptController::registerCallback(const char* callback, const char* function)
 {
     ScriptCallback scb = toCallback(callback);
     if (scb < INVALID_CALLBACK)
     {
-        _callbacks[scb].push_back(function);
+        _callbacks[scb].push_back(prepareFunction(function, __callbackSignatures[scb]));
     }
     else
     {
@@ -1013,10 +1637,16 @@ void ScriptController::unregisterCallback(const char* callback, const char* func
     ScriptCallback scb = toCallback(callback);
     if (scb < INVALID_CALLBACK)
     {
-        std::vector<std::string>& list = _callbacks[scb];
-        std::vector<std::string>::iterator itr = std::find(list.begin(), list.end(), std::string(function));
-        if (itr != list.end())
-            list.erase(itr);
+        std::vector<ScriptFunction*>& list = _callbacks[scb];
+        for (size_t i = 0; i < list.size(); ++i)
+        {
+            if (strcmp(list[i]->getName(), function) == 0)
+            {
+                SAFE_RELEASE(list[i]);
+                list.erase(list.begin() + i);
+                break;
+            }
+        }
     }
     else
     {
@@ -1024,6 +1654,229 @@ void ScriptController::unregisterCallback(const char* callback, const char* func
     }
 }
 
+void ScriptController::addEventFilter(const char* callback, int event)
+{
+    ScriptCallback scb = toCallback(callback);
+    if (scb != KEY_EVENT && scb != TOUCH_EVENT && scb != MOUSE_EVENT && scb != GAMEPAD_EVENT)
+    {
+        GP_WARN("Events can only be filtered for the keyEvent, touchEvent, mouseEvent and gamepadEvent callbacks, not: %s", callback);
+        return;
+    }
+    if (event < 0 || event >= 32)
+    {
+        GP_WARN("Invalid event type %d for script callback: %s", event, callback);
+        return;
+    }
+    _eventFilters[scb] |= 1u << event;
+}
+
+void ScriptController::addKeyFilter(int key)
+{
+    _keyFilter.insert(key);
+}
+
+void ScriptController::clearEventFilters(const char* callback)
+{
+    ScriptCallback scb = toCallback(callback);
+    if (scb < INVALID_CALLBACK)
+    {
+        _eventFilters[scb] = 0;
+        if (scb == KEY_EVENT)
+            _keyFilter.clear();
+    }
+    else
+    {
+        GP_WARN("Invalid script callback function specified: %s", callback);
+    }
+}
+
+void ScriptController::setCoalesceMoveEvents(bool coalesce)
+{
+    if (!coalesce)
+        flushMoveEvents();
+    _coalesceMoveEvents = coalesce;
+}
+
+bool ScriptController::getCoalesceMoveEvents() const
+{
+    return _coalesceMoveEvents;
+}
+
+void ScriptController::resumeCoroutines()
+{
+    if (_coroutines.empty())
+        return;
+
+    // The coroutines started or awaiting again while these are resumed are added back to _coroutines.
+    _resumingCoroutines.swap(_coroutines);
+    for (size_t i = 0, count = _resumingCoroutines.size(); i < count; ++i)
+    {
+        Coroutine& coroutine = _resumingCoroutines[i];
+        lua_rawgeti(_lua, LUA_REGISTRYINDEX, coroutine.thread);
+        lua_State* thread = lua_tothread(_lua, -1);
+        lua_pop(_lua, 1);
+
+        int argCount = pollCoroutine(coroutine, thread);
+        if (argCount < 0 || resumeCoroutine(&coroutine, thread, _lua, argCount))
+            _coroutines.push_back(coroutine);
+        else
+            releaseCoroutine(coroutine);
+    }
+    _resumingCoroutines.clear();
+}
+
+bool ScriptController::resumeCoroutine(Coroutine* coroutine, lua_State* thread, lua_State* from, int argCount)
+{
+    GP_ASSERT(coroutine);
+    GP_ASSERT(thread);
+
+#ifdef GP_USE_LUAJIT
+    int result = lua_resume(thread, argCount);
+#else
+    int result = lua_resume(thread, from, argCount);
+#endif
+    if (result != LUA_YIELD)
+    {
+        if (result != 0)
+            GP_WARN("Coroutine failed with error '%s'.", lua_tostring(thread, -1));
+        lua_settop(thread, 0);
+        return false;
+    }
+
+    // await() yields nothing or a time, a function, or an object and the method that polls it.
+    luaL_unref(thread, LUA_REGISTRYINDEX, coroutine->awaited);
+    luaL_unref(thread, LUA_REGISTRYINDEX, coroutine->method);
+    coroutine->awaited = LUA_NOREF;
+    coroutine->method = LUA_NOREF;
+    coroutine->wakeTime = 0.0;
+    int count = lua_gettop(thread);
+    if (count > 0 && lua_type(thread, 1) == LUA_TNUMBER)
+    {
+        coroutine->wakeTime = Game::getGameTime() + lua_tonumber(thread, 1);
+    }
+    else if (count > 0 && !lua_isnil(thread, 1))
+    {
+        if (count > 1)
+        {
+            lua_pushvalue(thread, 2);
+            coroutine->method = luaL_ref(thread, LUA_REGISTRYINDEX);
+        }
+        lua_pushvalue(thread, 1);
+        coroutine->awaited = luaL_ref(thread, LUA_REGISTRYINDEX);
+    }
+    lua_settop(thread, 0);
+    return true;
+}
+
+int ScriptController::pollCoroutine(const Coroutine& coroutine, lua_State* thread)
+{
+    if (coroutine.awaited == LUA_NOREF)
+        return Game::getGameTime() >= coroutine.wakeTime ? 0 : -1;
+
+    int top = lua_gettop(_lua);
+    if (coroutine.method != LUA_NOREF)
+    {
+        lua_rawgeti(_lua, LUA_REGISTRYINDEX, coroutine.method);
+        lua_rawgeti(_lua, LUA_REGISTRYINDEX, coroutine.awaited);
+        if (lua_pcall(_lua, 1, 1, 0) != 0)
+        {
+            GP_WARN("Failed to poll awaited object with error '%s'.", lua_tostring(_lua, -1));
+            lua_settop(_lua, top);
+            return 0;
+        }
+        bool complete = lua_toboolean(_lua, -1) != 0;
+        lua_settop(_lua, top);
+        if (!complete)
+            return -1;
+
+        lua_rawgeti(thread, LUA_REGISTRYINDEX, coroutine.awaited);
+        return 1;
+    }
+
+    lua_rawgeti(_lua, LUA_REGISTRYINDEX, coroutine.awaited);
+    if (lua_pcall(_lua, 0, LUA_MULTRET, 0) != 0)
+    {
+        GP_WARN("Awaited function failed with error '%s'.", lua_tostring(_lua, -1));
+        lua_settop(_lua, top);
+        return 0;
+    }
+    int count = lua_gettop(_lua) - top;
+    if (count == 0 || !lua_toboolean(_lua, top + 1))
+    {
+        lua_settop(_lua, top);
+        return -1;
+    }
+    lua_xmove(_lua, thread, count);
+    return count;
+}
+
+void ScriptController::releaseCoroutine(const Coroutine& coroutine)
+{
+    luaL_unref(_lua, LUA_REGISTRYINDEX, coroutine.thread);
+    luaL_unref(_lua, LUA_REGISTRYINDEX, coroutine.awaited);
+    luaL_unref(_lua, LUA_REGISTRYINDEX, coroutine.method);
+}
+
+int ScriptController::async(lua_State* state)
+{
+    luaL_checktype(state, 1, LUA_TFUNCTION);
+    ScriptController* sc = Game::getInstance()->getScriptController();
+
+    // Move the function and its arguments to a new thread, which is returned.
+    int argCount = lua_gettop(state) - 1;
+    lua_State* thread = lua_newthread(state);
+    lua_insert(state, 1);
+    lua_xmove(state, thread, argCount + 1);
+
+    Coroutine coroutine;
+    lua_pushvalue(state, 1);
+    coroutine.thread = luaL_ref(state, LUA_REGISTRYINDEX);
+    coroutine.awaited = LUA_NOREF;
+    coroutine.method = LUA_NOREF;
+    coroutine.wakeTime = 0.0;
+
+    // The coroutine runs right away, up to its first await().
+    if (sc->resumeCoroutine(&coroutine, thread, state, argCount))
+        sc->_coroutines.push_back(coroutine);
+    else
+        sc->releaseCoroutine(coroutine);
+    return 1;
+}
+
+int ScriptController::await(lua_State* state)
+{
+    if (lua_pushthread(state))
+        return luaL_error(state, "await() must be called from a function run by async().");
+    lua_pop(state, 1);
+
+    int type = lua_type(state, 1);
+    if (type == LUA_TTABLE || type == LUA_TUSERDATA)
+    {
+        // Objects are polled with their isComplete() or isLoaded() method, which is looked up once.
+        lua_getfield(state, 1, "isComplete");
+        if (lua_isnil(state, -1))
+        {
+            lua_pop(state, 1);
+            lua_getfield(state, 1, "isLoaded");
+        }
+        if (!lua_isfunction(state, -1))
+            return luaL_argerror(state, 1, "object without an isComplete() or isLoaded() method");
+        lua_pushvalue(state, 1);
+        lua_insert(state, -2);
+        return lua_yield(state, 2);
+    }
+    else if (type == LUA_TNUMBER || type == LUA_TFUNCTION)
+    {
+        lua_settop(state, 1);
+        return lua_yield(state, 1);
+    }
+    else if (type == LUA_TNIL || type == LUA_TNONE)
+    {
+        return lua_yield(state, 0);
+    }
+    return luaL_argerror(state, 1, "expected a time, a function or an object");
+}
+
 ScriptController::ScriptCallback ScriptController::toCallback(const char* name)
 {
     if (strcmp(name, "initialize") == 0)
@@ -1345,4 +2198,184 @@ template<> std::string ScriptController::executeFunction<std::string>(const char
     SCRIPT_EXECUTE_FUNCTION_PARAM_LIST(std::string, luaL_checkstring);
 }
 
+#define SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM(type, checkfunc) \
+    int top = lua_gettop(_lua); \
+    va_list list; \
+    va_start(list, function); \
+    executeFunctionHelper(1, function, &list); \
+    type value = (type)checkfunc(_lua, -1); \
+    va_end(list); \
+    lua_settop(_lua, top); \
+    return value;
+
+#define SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM_LIST(type, checkfunc) \
+    int top = lua_gettop(_lua); \
+    executeFunctionHelper(1, function, list); \
+    type value = (type)checkfunc(_lua, -1); \
+    lua_settop(_lua, top); \
+    return value;
+
+/** Template specialization. */
+template<> void ScriptController::executeFunction<void>(ScriptFunction* function, ...)
+{
+    int top = lua_gettop(_lua);
+    va_list list;
+    va_start(list, function);
+    executeFunctionHelper(0, function, &list);
+    va_end(list);
+    lua_settop(_lua, top);
+}
+
+/** Template specialization. */
+template<> bool ScriptController::executeFunction<bool>(ScriptFunction* function, ...)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM(bool, ScriptUtil::luaCheckBool);
+}
+
+/** Template specialization. */
+template<> char ScriptController::executeFunction<char>(ScriptFunction* function, ...)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM(char, luaL_checkint);
+}
+
+/** Template specialization. */
+template<> short ScriptController::executeFunction<short>(ScriptFunction* function, ...)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM(short, luaL_checkint);
+}
+
+/** Template specialization. */
+template<> int ScriptController::executeFunction<int>(ScriptFunction* function, ...)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM(int, luaL_checkint);
+}
+
+/** Template specialization. */
+template<> long ScriptController::executeFunction<long>(ScriptFunction* function, ...)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM(long, luaL_checklong);
+}
+
+/** Template specialization. */
+template<> unsigned char ScriptController::executeFunction<unsigned char>(ScriptFunction* function, ...)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM(unsigned char, luaL_checkunsigned);
+}
+
+/** Template specialization. */
+template<> unsigned short ScriptController::executeFunction<unsigned short>(ScriptFunction* function, ...)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM(unsigned short, luaL_checkunsigned);
+}
+
+/** Template specialization. */
+template<> unsigned int ScriptController::executeFunction<unsigned int>(ScriptFunction* function, ...)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM(unsigned int, luaL_checkunsigned);
+}
+
+/** Template specialization. */
+template<> unsigned long ScriptController::executeFunction<unsigned long>(ScriptFunction* function, ...)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM(unsigned long, luaL_checkunsigned);
+}
+
+/** Template specialization. */
+template<> float ScriptController::executeFunction<float>(ScriptFunction* function, ...)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM(float, luaL_checknumber);
+}
+
+/** Template specialization. */
+template<> double ScriptController::executeFunction<double>(ScriptFunction* function, ...)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM(double, luaL_checknumber);
+}
+
+/** Template specialization. */
+template<> std::string ScriptController::executeFunction<std::string>(ScriptFunction* function, ...)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM(std::string, luaL_checkstring);
+}
+
+/** Template specialization. */
+template<> void ScriptController::executeFunction<void>(ScriptFunction* function, va_list* list)
+{
+    int top = lua_gettop(_lua);
+    executeFunctionHelper(0, function, list);
+    lua_settop(_lua, top);
+}
+
+/** Template specialization. */
+template<> bool ScriptController::executeFunction<bool>(ScriptFunction* function, va_list* list)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM_LIST(bool, ScriptUtil::luaCheckBool);
+}
+
+/** Template specialization. */
+template<> char ScriptController::executeFunction<char>(ScriptFunction* function, va_list* list)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM_LIST(char, luaL_checkint);
+}
+
+/** Template specialization. */
+template<> short ScriptController::executeFunction<short>(ScriptFunction* function, va_list* list)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM_LIST(short, luaL_checkint);
+}
+
+/** Template specialization. */
+template<> int ScriptController::executeFunction<int>(ScriptFunction* function, va_list* list)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM_LIST(int, luaL_checkint);
+}
+
+/** Template specialization. */
+template<> long ScriptController::executeFunction<long>(ScriptFunction* function, va_list* list)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM_LIST(long, luaL_checklong);
+}
+
+/** Template specialization. */
+template<> unsigned char ScriptController::executeFunction<unsigned char>(ScriptFunction* function, va_list* list)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM_LIST(unsigned char, luaL_checkunsigned);
+}
+
+/** Template specialization. */
+template<> unsigned short ScriptController::executeFunction<unsigned short>(ScriptFunction* function, va_list* list)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM_LIST(unsigned short, luaL_checkunsigned);
+}
+
+/** Template specialization. */
+template<> unsigned int ScriptController::executeFunction<unsigned int>(ScriptFunction* function, va_list* list)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM_LIST(unsigned int, luaL_checkunsigned);
+}
+
+/** Template specialization. */
+template<> unsigned long ScriptController::executeFunction<unsigned long>(ScriptFunction* function, va_list* list)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM_LIST(unsigned long, luaL_checkunsigned);
+}
+
+/** Template specialization. */
+template<> float ScriptController::executeFunction<float>(ScriptFunction* function, va_list* list)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM_LIST(float, luaL_checknumber);
+}
+
+/** Template specialization. */
+template<> double ScriptController::executeFunction<double>(ScriptFunction* function, va_list* list)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM_LIST(double, luaL_checknumber);
+}
+
+/** Template specialization. */
+template<> std::string ScriptController::executeFunction<std::string>(ScriptFunction* function, va_list* list)
+{
+    SCRIPT_EXECUTE_PREPARED_FUNCTION_PARAM_LIST(std::string, luaL_checkstring);
+}
+
 }
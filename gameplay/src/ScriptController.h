@@ -315,6 +315,41 @@ LuaArray<double> getDoublePointer(int index);
 template <typename T>
 LuaArray<T> getObjectPointer(int index, const char* type, bool nonNull, bool* success);
 
+/**
+ * Pushes a copy of a value type object (such as a vector, quaternion or matrix) onto the stack.
+ * 
+ * The copy is stored inline in the userdata rather than allocated on the heap, so it is freed
+ * with the userdata by the garbage collector and returning it costs a single Lua allocation.
+ * The type must be trivially copyable.
+ * 
+ * @param state The Lua state.
+ * @param value The value to push.
+ * @param type The script type name of the value.
+ * 
+ * @script{ignore}
+ */
+template <typename T>
+void pushValue(lua_State* state, const T& value, const char* type);
+
+/**
+ * Pushes a native object onto the stack.
+ * 
+ * Objects that Lua does not own are looked up in a table of the userdata already pushed for
+ * them, whose values are weak, so pushing the same object again (such as the node passed to
+ * a script callback every frame) reuses its userdata instead of allocating a new one. The
+ * cached userdata is only reused if its metatable is the one of the given type, so a stale
+ * entry left by an object that was released is replaced when another object of a different
+ * type takes its address. Objects owned by Lua always get a userdata of their own.
+ * 
+ * @param state The Lua state.
+ * @param instance The object to push.
+ * @param type The script type name of the object.
+ * @param owns Whether the userdata owns the object, releasing it when it is collected.
+ * 
+ * @script{ignore}
+ */
+void pushObject(lua_State* state, void* instance, const char* type, bool owns);
+
 /**
  * Gets a string for the given stack index.
  * 
@@ -341,11 +376,93 @@ bool luaCheckBool(lua_State* state, int n);
 
 }
 
+class ScriptController;
+
+/**
+ * Defines a Lua function that is looked up, and has its argument signature parsed, once,
+ * to be called repeatedly with ScriptController::executeFunction.
+ *
+ * The function is kept in the Lua registry, so calling it does not look up its name, which
+ * may be a '.' separated path of nested tables. It is looked up again after each script is
+ * loaded, since the script may redefine it.
+ *
+ * @script{ignore}
+ */
+class ScriptFunction : public Ref
+{
+    friend class ScriptController;
+
+public:
+
+    /**
+     * Returns the name of the function.
+     *
+     * @return The name of the function.
+     */
+    const char* getName() const;
+
+    /**
+     * Returns the argument signature of the function.
+     *
+     * @return The argument signature, in the format of ScriptController::executeFunction.
+     */
+    const char* getSignature() const;
+
+private:
+
+    /**
+     * An argument of the signature.
+     */
+    struct Argument
+    {
+        char type;              // One of 'i', 'u', 'b', 'f', 's', 'p', '[' or '<'.
+        std::string typeName;   // The enumerated type for '[', or the name of the Lua metatable for '<'.
+    };
+
+    ScriptFunction(ScriptController* controller, const char* name, const char* signature);
+
+    ~ScriptFunction();
+
+    ScriptFunction(const ScriptFunction& copy);
+
+    ScriptFunction& operator=(const ScriptFunction&);
+
+    ScriptController* _controller;      // NULL once the controller is destroyed.
+    std::string _name;
+    std::string _signature;
+    std::vector<Argument> _arguments;
+    int _ref;                           // The function in the Lua registry, or LUA_NOREF until it is looked up.
+};
+
 /**
  * Controls and manages all scripts.
+ *
+ * Scripts can wait for asynchronous engine operations without blocking the frame by running
+ * them in coroutines. The global async(f, ...) function runs f with the given arguments in a
+ * new coroutine, until f calls await(x), which suspends the coroutine until x is complete:
+ *
+ * - a number is a time in game milliseconds, so await(500) resumes half a second later;
+ * - nil, or no value, resumes at the next frame;
+ * - a function is called once per frame until it returns a value other than nil or false,
+ *   and await returns the values it returned;
+ * - an object with an isComplete() or isLoaded() method, such as the load returned by
+ *   Bundle:loadSceneAsync() or a texture created with Texture.createAsync(), is complete
+ *   once that method returns true, and await returns the object.
+ *
+ * The waiting coroutines are polled and resumed once per frame, after the update callbacks,
+ * so that the work they do after an operation completes runs at the same point of the frame:
+ *
+ @verbatim
+    async(function()
+        local load = bundle:loadSceneAsync("level2")
+        await(load)
+        startLevel(load:getScene())
+    end)
+ @endverbatim
  */
 class ScriptController
 {
+    friend class ScriptFunction;
     friend class Game;
     friend class Platform;
 
@@ -354,11 +471,46 @@ public:
     /**
      * Loads the given script file and executes its global code.
      * 
+     * The script is run from a compiled chunk rather than compiled from source when one
+     * matches its source: a chunk written next to the script by gameplay-encoder (the path
+     * of the script followed by 'c', e.g. "res/ai.luac"), or a chunk of the cache (see
+     * setCachePath). Chunks are only used when they were compiled from the same source by
+     * the same version of Lua, so an edited script is compiled again. A script that is
+     * only shipped as a compiled chunk is run from it.
+     * 
      * @param path The path to the script.
      * @param forceReload Whether the script should be reloaded if it has already been loaded.
      */
     void loadScript(const char* path, bool forceReload = false);
 
+    /**
+     * Adds the paths of the scripts that were loaded to a set.
+     *
+     * @param files The set to add the paths to.
+     * @see HotReloader
+     * @script{ignore}
+     */
+    void getSourceFiles(std::set<std::string>& files) const;
+
+    /**
+     * Sets the directory in which loadScript caches the chunks it compiles scripts to.
+     * 
+     * Cached chunks are named by a hash of the source they were compiled from. The
+     * directory must exist and be writable with FileSystem::open().
+     * 
+     * @param path The path of the directory, or NULL to not cache chunks, which is the default.
+     * @script{ignore}
+     */
+    void setCachePath(const char* path);
+
+    /**
+     * Returns the directory in which loadScript caches the chunks it compiles scripts to.
+     * 
+     * @return The path of the directory, or an empty string if chunks are not cached.
+     * @script{ignore}
+     */
+    const char* getCachePath() const;
+
     /**
      * Given a URL, loads the referenced file and returns the referenced function name.
      * 
@@ -392,6 +544,66 @@ public:
      */
     void unregisterCallback(const char* callback, const char* function);
 
+    /**
+     * Restricts the events passed to the script functions registered for an input callback.
+     *
+     * Every platform input event calls the functions registered for its callback, even when
+     * the scripts only handle a few kinds of events. Once an event type has been added for a
+     * callback, only the event types added for it are passed to its functions, and the other
+     * events are dropped without calling into Lua.
+     *
+     * The supported callbacks are keyEvent, touchEvent, mouseEvent and gamepadEvent, whose
+     * event types are the values of Keyboard::KeyEvent, Touch::TouchEvent, Mouse::MouseEvent
+     * and Gamepad::GamepadEvent.
+     *
+     * @param callback The script callback to filter.
+     * @param event The event type to pass to the functions registered for the callback.
+     *
+     * @see addKeyFilter(int)
+     */
+    void addEventFilter(const char* callback, int event);
+
+    /**
+     * Restricts the key press and release events passed to the keyEvent script callbacks.
+     *
+     * Once a key has been added, only the press and release events of the keys added are
+     * passed to the keyEvent functions. Character events are not affected.
+     *
+     * @param key The key code, from Keyboard::Key, to pass to the keyEvent functions.
+     */
+    void addKeyFilter(int key);
+
+    /**
+     * Removes the filters of an input callback, so all its events are passed to its functions.
+     *
+     * @param callback The script callback whose filters are removed. The keys added with
+     *      addKeyFilter are removed with the filters of keyEvent.
+     */
+    void clearEventFilters(const char* callback);
+
+    /**
+     * Sets whether mouse and touch move events are coalesced.
+     *
+     * When move events are coalesced, the mouseEvent and touchEvent script callbacks are only
+     * called for the last move of the mouse and of each touch contact before the next script
+     * update, or before the next other event of the mouse or of the touch screen, instead of
+     * once per platform event. A coalesced mouse move is not consumed by the scripts, since
+     * it is delivered after the platform has handled it. Move events are not coalesced by
+     * default.
+     *
+     * @param coalesce Whether to coalesce move events.
+     */
+    void setCoalesceMoveEvents(bool coalesce);
+
+    /**
+     * Returns whether mouse and touch move events are coalesced.
+     *
+     * @return Whether move events are coalesced.
+     *
+     * @see setCoalesceMoveEvents(bool)
+     */
+    bool getCoalesceMoveEvents() const;
+
     /**
      * Calls the specified no-parameter Lua function.
      * 
@@ -452,6 +664,44 @@ public:
      */
     template<typename T> T executeFunction(const char* func, const char* args, va_list* list);
 
+    /**
+     * Prepares a Lua function to be called repeatedly.
+     *
+     * Calling a prepared function neither looks up the function nor parses its signature,
+     * which makes it the way to call script functions every frame.
+     *
+     * @param func The name of the function.
+     * @param args The argument signature of the function (see executeFunction).
+     *
+     * @return The prepared function, which the caller must release.
+     *
+     * @script{ignore}
+     */
+    ScriptFunction* prepareFunction(const char* func, const char* args = NULL);
+
+    /**
+     * Calls a prepared Lua function.
+     *
+     * @param function The function to call.
+     *
+     * @return The return value of the executed Lua function.
+     *
+     * @script{ignore}
+     */
+    template<typename T> T executeFunction(ScriptFunction* function, ...);
+
+    /**
+     * Calls a prepared Lua function.
+     *
+     * @param function The function to call.
+     * @param list The variable argument list containing the function's parameters.
+     *
+     * @return The return value of the executed Lua function.
+     *
+     * @script{ignore}
+     */
+    template<typename T> T executeFunction(ScriptFunction* function, va_list* list);
+
     /**
      * Gets the global boolean script variable with the given name.
      * 
@@ -778,6 +1028,27 @@ private:
         INVALID_CALLBACK = CALLBACK_COUNT
     };
 
+    /**
+     * A coroutine started by the async() script function, and what it awaits.
+     */
+    struct Coroutine
+    {
+        int thread;         // The Lua thread, in the registry.
+        int awaited;        // The awaited function or object, in the registry, or LUA_NOREF for a time.
+        int method;         // The method that polls the awaited object, in the registry, or LUA_NOREF.
+        double wakeTime;    // The game time at which a coroutine awaiting a time resumes.
+    };
+
+    /**
+     * The last move of a touch contact, waiting to be passed to the touchEvent functions.
+     */
+    struct TouchMove
+    {
+        unsigned int contactIndex;
+        int x;
+        int y;
+    };
+
     /**
      * Constructor.
      */
@@ -909,6 +1180,48 @@ private:
      */
     void gamepadEvent(Gamepad::GamepadEvent evt, Gamepad* gamepad, unsigned int analogIndex = 0);
 
+    /**
+     * Determines whether an event is passed to the functions registered for a callback.
+     */
+    bool isEventFiltered(ScriptCallback callback, int event) const;
+
+    /**
+     * Passes the coalesced mouse and touch moves to the script callbacks.
+     */
+    void flushMoveEvents();
+
+    /**
+     * Resumes the coroutines whose awaited operations are complete.
+     *
+     * This is called once per frame, after the script update.
+     */
+    void resumeCoroutines();
+
+    /**
+     * Resumes a coroutine with the values at the top of its stack, and records what it awaits next.
+     *
+     * @param coroutine The coroutine.
+     * @param thread The Lua thread of the coroutine.
+     * @param from The Lua thread resuming the coroutine.
+     * @param argCount The number of values passed to the coroutine.
+     *
+     * @return true if the coroutine awaits again, false if it returned or failed.
+     */
+    bool resumeCoroutine(Coroutine* coroutine, lua_State* thread, lua_State* from, int argCount);
+
+    /**
+     * Determines whether the operation a coroutine awaits is complete, and pushes the values
+     * returned by await() onto the stack of its thread if it is.
+     *
+     * @return The number of values pushed, or -1 if the operation is not complete.
+     */
+    int pollCoroutine(const Coroutine& coroutine, lua_State* thread);
+
+    /**
+     * Releases the references of a coroutine that is no longer waiting.
+     */
+    void releaseCoroutine(const Coroutine& coroutine);
+
     /**
      * Calls the specified Lua function using the given parameters.
      * 
@@ -935,6 +1248,48 @@ private:
      */
     void executeFunctionHelper(int resultCount, const char* func, const char* args, va_list* list);
 
+    /**
+     * Calls a prepared Lua function using the given parameters.
+     *
+     * @param resultCount The expected number of returned values.
+     * @param function The function to call.
+     * @param list The variable argument list.
+     */
+    void executeFunctionHelper(int resultCount, ScriptFunction* function, va_list* list);
+
+    /**
+     * Looks up a prepared function and keeps it in the Lua registry.
+     *
+     * @return true if the function was found, false otherwise.
+     */
+    bool resolveFunction(ScriptFunction* function);
+
+    /**
+     * Makes the prepared functions be looked up again at their next call.
+     */
+    void invalidateFunctions();
+
+    /**
+     * Loads a compiled chunk and pushes its function onto the stack.
+     *
+     * @param path The path of the chunk file.
+     * @param hash The hash of the source the chunk must have been compiled from, or NULL to accept any source.
+     * @param name The name of the chunk, for error messages.
+     *
+     * @return true if the chunk was loaded, false if it is missing, stale or invalid.
+     */
+    bool loadChunk(const char* path, const unsigned long long* hash, const char* name);
+
+    /**
+     * Writes the function at the top of the stack to a compiled chunk file.
+     */
+    bool writeChunk(const char* path, unsigned long long hash);
+
+    /**
+     * Removes a prepared function that is being destroyed.
+     */
+    void removeFunction(ScriptFunction* function);
+
     /**
      * Converts the given string to a valid script callback enumeration value
      * or to ScriptController::INVALID_CALLBACK if there is no valid conversion.
@@ -971,6 +1326,30 @@ private:
      */
     static int convert(lua_State* state);
 
+    /**
+     * Runs a Lua function in a new coroutine, which is resumed by the controller once per frame
+     * while it awaits. This is the global async(f, ...) script function.
+     *
+     * @param state The Lua state.
+     *
+     * @return The number of values being returned by this function (the coroutine).
+     *
+     * @script{ignore}
+     */
+    static int async(lua_State* state);
+
+    /**
+     * Suspends the coroutine running it until the given time, function or object is complete.
+     * This is the global await(x) script function.
+     *
+     * @param state The Lua state.
+     *
+     * @return The number of values being yielded.
+     *
+     * @script{ignore}
+     */
+    static int await(lua_State* state);
+
     // Friend functions (used by Lua script bindings).
     friend void ScriptUtil::registerLibrary(const char* name, const luaL_Reg* functions);
     friend void ScriptUtil::registerConstantBool(const std::string& name, bool value, const std::vector<std::string>& scopePath);
@@ -997,8 +1376,19 @@ private:
     lua_State* _lua;
     unsigned int _returnCount;
     std::map<std::string, std::vector<std::string> > _hierarchy;
-    std::vector<std::string> _callbacks[CALLBACK_COUNT];
+    std::vector<ScriptFunction*> _callbacks[CALLBACK_COUNT];
+    unsigned int _eventFilters[CALLBACK_COUNT];  // The event types passed to each callback, as bits, or 0 for all.
+    std::set<int> _keyFilter;
+    bool _coalesceMoveEvents;
+    bool _mouseMovePending;
+    int _mouseMoveX;
+    int _mouseMoveY;
+    std::vector<TouchMove> _touchMoves;
+    std::vector<Coroutine> _coroutines;             // The coroutines waiting for their awaited operations.
+    std::vector<Coroutine> _resumingCoroutines;     // The coroutines being polled by resumeCoroutines.
+    std::vector<ScriptFunction*> _functions;     // The prepared functions.
     std::set<std::string> _loadedScripts;
+    std::string _cachePath;
     std::vector<luaStringEnumConversionFunction> _stringFromEnum;
 };
 
@@ -1083,6 +1473,60 @@ template<> double ScriptController::executeFunction<double>(const char* func, co
 /** Template specialization. */
 template<> std::string ScriptController::executeFunction<std::string>(const char* func, const char* args, va_list* list);
 
+/** Template specialization. */
+template<> void ScriptController::executeFunction<void>(ScriptFunction* function, ...);
+/** Template specialization. */
+template<> bool ScriptController::executeFunction<bool>(ScriptFunction* function, ...);
+/** Template specialization. */
+template<> char ScriptController::executeFunction<char>(ScriptFunction* function, ...);
+/** Template specialization. */
+template<> short ScriptController::executeFunction<short>(ScriptFunction* function, ...);
+/** Template specialization. */
+template<> int ScriptController::executeFunction<int>(ScriptFunction* function, ...);
+/** Template specialization. */
+template<> long ScriptController::executeFunction<long>(ScriptFunction* function, ...);
+/** Template specialization. */
+template<> unsigned char ScriptController::executeFunction<unsigned char>(ScriptFunction* function, ...);
+/** Template specialization. */
+template<> unsigned short ScriptController::executeFunction<unsigned short>(ScriptFunction* function, ...);
+/** Template specialization. */
+template<> unsigned int ScriptController::executeFunction<unsigned int>(ScriptFunction* function, ...);
+/** Template specialization. */
+template<> unsigned long ScriptController::executeFunction<unsigned long>(ScriptFunction* function, ...);
+/** Template specialization. */
+template<> float ScriptController::executeFunction<float>(ScriptFunction* function, ...);
+/** Template specialization. */
+template<> double ScriptController::executeFunction<double>(ScriptFunction* function, ...);
+/** Template specialization. */
+template<> std::string ScriptController::executeFunction<std::string>(ScriptFunction* function, ...);
+
+/** Template specialization. */
+template<> void ScriptController::executeFunction<void>(ScriptFunction* function, va_list* list);
+/** Template specialization. */
+template<> bool ScriptController::executeFunction<bool>(ScriptFunction* function, va_list* list);
+/** Template specialization. */
+template<> char ScriptController::executeFunction<char>(ScriptFunction* function, va_list* list);
+/** Template specialization. */
+template<> short ScriptController::executeFunction<short>(ScriptFunction* function, va_list* list);
+/** Template specialization. */
+template<> int ScriptController::executeFunction<int>(ScriptFunction* function, va_list* list);
+/** Template specialization. */
+template<> long ScriptController::executeFunction<long>(ScriptFunction* function, va_list* list);
+/** Template specialization. */
+template<> unsigned char ScriptController::executeFunction<unsigned char>(ScriptFunction* function, va_list* list);
+/** Template specialization. */
+template<> unsigned short ScriptController::executeFunction<unsigned short>(ScriptFunction* function, va_list* list);
+/** Template specialization. */
+template<> unsigned int ScriptController::executeFunction<unsigned int>(ScriptFunction* function, va_list* list);
+/** Template specialization. */
+template<> unsigned long ScriptController::executeFunction<unsigned long>(ScriptFunction* function, va_list* list);
+/** Template specialization. */
+template<> float ScriptController::executeFunction<float>(ScriptFunction* function, va_list* list);
+/** Template specialization. */
+template<> double ScriptController::executeFunction<double>(ScriptFunction* function, va_list* list);
+/** Template specialization. */
+template<> std::string ScriptController::executeFunction<std::string>(ScriptFunction* function, va_list* list);
+
 }
 
 #include "ScriptController.inl"
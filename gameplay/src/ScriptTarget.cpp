@@ -16,6 +16,13 @@ ScriptTarget::~ScriptTarget()
     std::map<std::string, std::vector<Callback>* >::iterator iter = _callbacks.begin();
     for (; iter != _callbacks.end(); iter++)
     {
+        if (iter->second)
+        {
+            for (unsigned int i = 0; i < iter->second->size(); i++)
+            {
+                SAFE_RELEASE((*iter->second)[i].function);
+            }
+        }
         SAFE_DELETE(iter->second);
     }
 }
@@ -30,19 +37,10 @@ template<> void ScriptTarget::fireScriptEvent<void>(const char* eventName, ...)
     {
         ScriptController* sc = Game::getInstance()->getScriptController();
 
-        if (_events[eventName].size() > 0)
-        {
-            for (unsigned int i = 0; i < iter->second->size(); i++)
-            {
-                sc->executeFunction<void>((*iter->second)[i].function.c_str(), _events[eventName].c_str(), &list);
-            }
-        }
-        else
+        // The callbacks were prepared with the signature of the event, so firing neither looks them up nor parses it.
+        for (unsigned int i = 0; i < iter->second->size(); i++)
         {
-            for (unsigned int i = 0; i < iter->second->size(); i++)
-            {
-                sc->executeFunction<void>((*iter->second)[i].function.c_str(), _events[eventName].c_str());
-            }
+            sc->executeFunction<void>((*iter->second)[i].function, &list);
         }
     }
 
@@ -59,26 +57,12 @@ template<> bool ScriptTarget::fireScriptEvent<bool>(const char* eventName, ...)
     {
         ScriptController* sc = Game::getInstance()->getScriptController();
 
-        if (_events[eventName].size() > 0)
-        {
-            for (unsigned int i = 0; i < iter->second->size(); i++)
-            {
-                if (sc->executeFunction<bool>((*iter->second)[i].function.c_str(), _events[eventName].c_str(), &list))
-                {
-                    va_end(list);
-                    return true;
-                }
-            }
-        }
-        else
+        for (unsigned int i = 0; i < iter->second->size(); i++)
         {
-            for (unsigned int i = 0; i < iter->second->size(); i++)
+            if (sc->executeFunction<bool>((*iter->second)[i].function, &list))
             {
-                if (sc->executeFunction<bool>((*iter->second)[i].function.c_str(), _events[eventName].c_str()))
-                {
-                    va_end(list);
-                    return true;
-                }
+                va_end(list);
+                return true;
             }
         }
     }
@@ -96,8 +80,9 @@ void ScriptTarget::addScriptCallback(const std::string& eventName, const std::st
             iter->second = new std::vector<Callback>();
 
         // Add the function to the list of callbacks.
-        std::string functionName = Game::getInstance()->getScriptController()->loadUrl(function.c_str());
-        iter->second->push_back(Callback(functionName));
+        ScriptController* sc = Game::getInstance()->getScriptController();
+        std::string functionName = sc->loadUrl(function.c_str());
+        iter->second->push_back(Callback(sc->prepareFunction(functionName.c_str(), _events[eventName].c_str())));
     }
     else
     {
@@ -124,8 +109,9 @@ void ScriptTarget::removeScriptCallback(const std::string& eventName, const std:
         // Remove the function from the list of callbacks.
         for (unsigned int i = 0; i < iter->second->size(); i++)
         {
-            if ((*iter->second)[i].function == id)
+            if (id == (*iter->second)[i].function->getName())
             {
+                SAFE_RELEASE((*iter->second)[i].function);
                 iter->second->erase(iter->second->begin() + i);
                 return;
             }
@@ -143,7 +129,7 @@ void ScriptTarget::addScriptEvent(const std::string& eventName, const char* args
     _callbacks[eventName] = NULL;
 }
 
-ScriptTarget::Callback::Callback(const std::string& function) : function(function)
+ScriptTarget::Callback::Callback(ScriptFunction* function) : function(function)
 {
 }
 
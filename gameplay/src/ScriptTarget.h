@@ -6,6 +6,8 @@
 namespace gameplay
 {
 
+class ScriptFunction;
+
 /**
  * Generic base class for supporting script callbacks.
  */
@@ -63,10 +65,10 @@ protected:
     struct Callback
     {
         /** Constructor. */
-        Callback(const std::string& string);
+        Callback(ScriptFunction* function);
 
-        /** Holds the Lua script callback function. */
-        std::string function;
+        /** Holds the Lua script callback function, prepared with the signature of the event. */
+        ScriptFunction* function;
     };
 
     /** Holds the supported events for this script target. */
@@ -0,0 +1,442 @@
+#include "Base.h"
+#include "ShadowMap.h"
+#include "Game.h"
+#include "Light.h"
+#include "Node.h"
+#include "Scene.h"
+#include "FrameBuffer.h"
+#include "DepthStencilTarget.h"
+#include "RenderQueue.h"
+#include "SpriteBatch.h"
+#include "Frustum.h"
+
+// The fragment shader that packs the depth of the casters into the color of the maps.
+#define SHADOW_CASTER_FSH "res/shaders/shadow-caster.frag"
+
+namespace gameplay
+{
+
+ShadowMap::ShadowMap()
+    : _light(NULL), _size(0), _cascadeCount(0), _distance(100.0f), _splitLambda(0.75f), _casterDistance(50.0f),
+      _bias(0.002f), _frameBuffer(NULL), _scrollBuffer(NULL), _atlasBatch(NULL), _scrollBatch(NULL), _sampler(NULL),
+      _queue(NULL), _cameraNode(NULL)
+{
+    memset(_cascades, 0, sizeof(_cascades));
+    memset(_splits, 0, sizeof(_splits));
+}
+
+ShadowMap::~ShadowMap()
+{
+    SAFE_DELETE(_atlasBatch);
+    SAFE_DELETE(_scrollBatch);
+    SAFE_DELETE(_queue);
+    SAFE_RELEASE(_sampler);
+    SAFE_RELEASE(_cameraNode);
+    SAFE_RELEASE(_frameBuffer);
+    SAFE_RELEASE(_scrollBuffer);
+    SAFE_RELEASE(_light);
+}
+
+/**
+ * Creates a sprite batch that copies the texels of a texture of packed depths unchanged.
+ */
+static SpriteBatch* createCopyBatch(Texture* texture)
+{
+    SpriteBatch* batch = SpriteBatch::create(texture);
+    GP_ASSERT(batch);
+    batch->getSampler()->setFilterMode(Texture::NEAREST, Texture::NEAREST);
+    batch->getSampler()->setWrapMode(Texture::CLAMP, Texture::CLAMP);
+    batch->getStateBlock()->setBlend(false);
+    batch->getStateBlock()->setDepthTest(false);
+    batch->getStateBlock()->setDepthWrite(false);
+    return batch;
+}
+
+ShadowMap* ShadowMap::create(Light* light, unsigned int size, unsigned int cascadeCount)
+{
+    GP_ASSERT(light);
+    GP_ASSERT(size > 0);
+    GP_ASSERT(cascadeCount > 0 && cascadeCount <= MAX_CASCADES);
+    if (light->getLightType() != Light::DIRECTIONAL)
+    {
+        GP_WARN("Shadow maps can only be created for directional lights.");
+        return NULL;
+    }
+
+    FrameBuffer* frameBuffer = FrameBuffer::create("ShadowMap", size * 2, size * cascadeCount);
+    if (frameBuffer == NULL)
+        return NULL;
+    DepthStencilTarget* depthTarget = DepthStencilTarget::create("ShadowMap", DepthStencilTarget::DEPTH, size * 2, size * cascadeCount);
+    frameBuffer->setDepthStencilTarget(depthTarget);
+    SAFE_RELEASE(depthTarget);
+    FrameBuffer* scrollBuffer = FrameBuffer::create("ShadowMapScroll", size, size);
+    if (scrollBuffer == NULL)
+    {
+        SAFE_RELEASE(frameBuffer);
+        return NULL;
+    }
+
+    ShadowMap* shadowMap = new ShadowMap();
+    shadowMap->_light = light;
+    light->addRef();
+    shadowMap->_size = size;
+    shadowMap->_cascadeCount = cascadeCount;
+    shadowMap->_frameBuffer = frameBuffer;
+    shadowMap->_scrollBuffer = scrollBuffer;
+
+    // Packed depths cannot be filtered, and the atlas must not bleed between the maps.
+    Texture* texture = frameBuffer->getRenderTarget()->getTexture();
+    shadowMap->_sampler = Texture::Sampler::create(texture);
+    shadowMap->_sampler->setFilterMode(Texture::NEAREST, Texture::NEAREST);
+    shadowMap->_sampler->setWrapMode(Texture::CLAMP, Texture::CLAMP);
+    shadowMap->_atlasBatch = createCopyBatch(texture);
+    shadowMap->_scrollBatch = createCopyBatch(scrollBuffer->getRenderTarget()->getTexture());
+
+    shadowMap->_queue = RenderQueue::create();
+    shadowMap->_queue->setDepthShader(SHADOW_CASTER_FSH);
+
+    // The projection of the camera of the light is set for each cascade.
+    Camera* camera = Camera::createOrthographic(1.0f, 1.0f, 1.0f, 0.0f, 1.0f);
+    shadowMap->_cameraNode = Node::create("ShadowMap");
+    shadowMap->_cameraNode->setCamera(camera);
+    SAFE_RELEASE(camera);
+
+    return shadowMap;
+}
+
+Light* ShadowMap::getLight() const
+{
+    return _light;
+}
+
+unsigned int ShadowMap::getSize() const
+{
+    return _size;
+}
+
+unsigned int ShadowMap::getCascadeCount() const
+{
+    return _cascadeCount;
+}
+
+void ShadowMap::setDistance(float distance)
+{
+    _distance = distance;
+}
+
+float ShadowMap::getDistance() const
+{
+    return _distance;
+}
+
+void ShadowMap::setSplitLambda(float lambda)
+{
+    _splitLambda = lambda;
+}
+
+float ShadowMap::getSplitLambda() const
+{
+    return _splitLambda;
+}
+
+void ShadowMap::setCasterDistance(float distance)
+{
+    if (distance != _casterDistance)
+    {
+        _casterDistance = distance;
+        invalidate();
+    }
+}
+
+float ShadowMap::getCasterDistance() const
+{
+    return _casterDistance;
+}
+
+void ShadowMap::setBias(float bias)
+{
+    _bias = bias;
+}
+
+float ShadowMap::getBias() const
+{
+    return _bias;
+}
+
+float ShadowMap::getSplitDistance(unsigned int cascade) const
+{
+    GP_ASSERT(cascade < _cascadeCount);
+    return _splits[cascade];
+}
+
+Texture* ShadowMap::getTexture() const
+{
+    return _sampler->getTexture();
+}
+
+void ShadowMap::invalidate()
+{
+    for (unsigned int i = 0; i < MAX_CASCADES; ++i)
+        _cascades[i].valid = false;
+}
+
+void ShadowMap::update(Scene* scene)
+{
+    GP_ASSERT(scene);
+    Camera* camera = scene->getActiveCamera();
+    Node* lightNode = _light->getNode();
+    if (camera == NULL || camera->getNode() == NULL || lightNode == NULL)
+        return;
+    Node* viewNode = camera->getNode();
+
+    // The light looks along its direction from the origin, so moving it changes nothing.
+    Vector3 direction = lightNode->getForwardVectorWorld();
+    if (direction != _direction)
+    {
+        _direction = direction;
+        Quaternion rotation;
+        lightNode->getWorldMatrix().getRotation(&rotation);
+        _cameraNode->setRotation(rotation);
+        invalidate();
+    }
+    Camera* lightCamera = _cameraNode->getCamera();
+    const Matrix& lightView = lightCamera->getViewMatrix();
+
+    Vector3 eye = viewNode->getTranslationWorld();
+    Vector3 forward = viewNode->getForwardVectorWorld();
+    forward.normalize();
+    _viewPlane.set(forward.x, forward.y, forward.z, -forward.dot(eye));
+
+    // The slices of the view are bounded by spheres, whose sizes do not change as the camera
+    // turns, so neither do the sizes of the texels of the cascades.
+    bool perspective = camera->getCameraType() == Camera::PERSPECTIVE;
+    float k2 = 0.0f;
+    float orthographicRadius2 = 0.0f;
+    if (perspective)
+    {
+        float tanY = tan(MATH_DEG_TO_RAD(camera->getFieldOfView()) * 0.5f);
+        float tanX = tanY * camera->getAspectRatio();
+        k2 = tanX * tanX + tanY * tanY;
+    }
+    else
+    {
+        orthographicRadius2 = (camera->getZoomX() * camera->getZoomX() + camera->getZoomY() * camera->getZoomY()) * 0.25f;
+    }
+    float nearPlane = std::max(camera->getNearPlane(), MATH_EPSILON);
+    float farPlane = std::max(std::min(camera->getFarPlane(), _distance), nearPlane);
+
+    Cascade cascades[MAX_CASCADES];
+    Frustum frusta[MAX_CASCADES];
+    float sliceNear = nearPlane;
+    for (unsigned int i = 0; i < _cascadeCount; ++i)
+    {
+        float f = (float)(i + 1) / _cascadeCount;
+        float logSplit = nearPlane * pow(farPlane / nearPlane, f);
+        float uniformSplit = nearPlane + (farPlane - nearPlane) * f;
+        float sliceFar = _splitLambda * logSplit + (1.0f - _splitLambda) * uniformSplit;
+        _splits[i] = sliceFar;
+
+        float center;
+        float radius2;
+        if (perspective)
+        {
+            // The center is as far from the corners of the near plane of the slice as from
+            // those of its far plane, unless the far plane alone is wider than the slice is long.
+            center = std::min((sliceFar + sliceNear) * (1.0f + k2) * 0.5f, sliceFar);
+            radius2 = sliceFar * sliceFar * k2 + (sliceFar - center) * (sliceFar - center);
+        }
+        else
+        {
+            center = (sliceNear + sliceFar) * 0.5f;
+            radius2 = orthographicRadius2 + (sliceFar - center) * (sliceFar - center);
+        }
+        sliceNear = sliceFar;
+
+        // The cascade is snapped to whole texels across the light, and to its radius along it.
+        Cascade& cascade = cascades[i];
+        cascade.radius = sqrt(radius2);
+        Vector3 point = eye + forward * center;
+        lightView.transformPoint(&point);
+        float texel = cascade.radius * 2.0f / _size;
+        cascade.x = (int)floor(point.x / texel);
+        cascade.y = (int)floor(point.y / texel);
+        cascade.z = (int)floor(-point.z / cascade.radius);
+        cascade.valid = true;
+        cascade.dynamicEmpty = _cascades[i].dynamicEmpty;
+
+        Matrix projection;
+        getProjection(cascade, 0, 0, _size, _size, &projection);
+        Matrix viewProjection;
+        Matrix::multiply(projection, lightView, &viewProjection);
+        frusta[i].set(viewProjection);
+
+        // Maps the clip space of the light to the static map of the cascade in the atlas.
+        float rowHeight = 1.0f / _cascadeCount;
+        Matrix atlas;
+        atlas.m[0] = 0.25f;
+        atlas.m[5] = 0.5f * rowHeight;
+        atlas.m[10] = 0.5f;
+        atlas.m[12] = 0.25f;
+        atlas.m[13] = (i + 0.5f) * rowHeight;
+        atlas.m[14] = 0.5f;
+        Matrix::multiply(atlas, viewProjection, &_matrices[i]);
+    }
+
+    _nodes.clear();
+    _masks.clear();
+    scene->findVisibleNodes(frusta, _cascadeCount, _nodes, _masks);
+
+    // The nodes are drawn with the light as the active camera of their scene, which is what
+    // their auto bindings and their depths in the queue are computed for.
+    Game* game = Game::getInstance();
+    camera->addRef();
+    scene->setActiveCamera(lightCamera);
+    FrameBuffer* previousFrameBuffer = _frameBuffer->bind();
+    GL_ASSERT( glEnable(GL_SCISSOR_TEST) );
+
+    int size = (int)_size;
+    for (unsigned int i = 0; i < _cascadeCount; ++i)
+    {
+        _staticCasters.clear();
+        _dynamicCasters.clear();
+        for (size_t j = 0, count = _nodes.size(); j < count; ++j)
+        {
+            Node* node = _nodes[j];
+            if ((_masks[j] & (1u << i)) == 0 || node->getModel() == NULL)
+                continue;
+            if (node->isStatic() || node->hasTag("static"))
+                _staticCasters.push_back(node);
+            else
+                _dynamicCasters.push_back(node);
+        }
+
+        Cascade& previous = _cascades[i];
+        const Cascade& cascade = cascades[i];
+        unsigned int bottom = i * _size;
+        int dx = cascade.x - previous.x;
+        int dy = cascade.y - previous.y;
+        if (!previous.valid || cascade.radius != previous.radius || cascade.z != previous.z ||
+            abs(dx) >= size || abs(dy) >= size)
+        {
+            drawCasters(_staticCasters, cascade, 0, 0, size, size, 0, bottom);
+        }
+        else if (dx != 0 || dy != 0)
+        {
+            // Only the columns and rows that scrolled into the map are drawn.
+            scroll(i, dx, dy);
+            if (dx > 0)
+                drawCasters(_staticCasters, cascade, size - dx, 0, size, size, 0, bottom);
+            else if (dx < 0)
+                drawCasters(_staticCasters, cascade, 0, 0, -dx, size, 0, bottom);
+            int x1 = dx < 0 ? -dx : 0;
+            int x2 = dx > 0 ? size - dx : size;
+            if (dy > 0)
+                drawCasters(_staticCasters, cascade, x1, size - dy, x2, size, 0, bottom);
+            else if (dy < 0)
+                drawCasters(_staticCasters, cascade, x1, 0, x2, -dy, 0, bottom);
+        }
+        previous = cascade;
+
+        // A map that was left empty needs no clearing until a dynamic caster enters it.
+        if (!_dynamicCasters.empty() || !previous.dynamicEmpty)
+        {
+            drawCasters(_dynamicCasters, cascade, 0, 0, size, size, _size, bottom);
+            previous.dynamicEmpty = _dynamicCasters.empty();
+        }
+    }
+    _queue->clear();
+
+    GL_ASSERT( glDisable(GL_SCISSOR_TEST) );
+    previousFrameBuffer->bind();
+    game->setViewport(game->getViewport());
+    scene->setActiveCamera(camera);
+    camera->release();
+}
+
+void ShadowMap::getProjection(const Cascade& cascade, int x1, int y1, int x2, int y2, Matrix* dst) const
+{
+    GP_ASSERT(dst);
+
+    // The map of the cascade covers the texels around the one that contains the center of its
+    // sphere, and depths from a radius behind the sphere to the caster distance in front of it.
+    float texel = cascade.radius * 2.0f / _size;
+    int left = cascade.x - (int)_size / 2;
+    int bottom = cascade.y - (int)_size / 2;
+    float nearPlane = (cascade.z - 1) * cascade.radius - _casterDistance;
+    float farPlane = (cascade.z + 2) * cascade.radius;
+    Matrix::createOrthographicOffCenter((left + x1) * texel, (left + x2) * texel, (bottom + y1) * texel, (bottom + y2) * texel,
+                                        nearPlane, farPlane, dst);
+}
+
+void ShadowMap::drawCasters(const std::vector<Node*>& casters, const Cascade& cascade, int x1, int y1, int x2, int y2,
+                            unsigned int left, unsigned int bottom)
+{
+    // Texels that no caster covers are as far from the light as the map can hold.
+    GL_ASSERT( glViewport(left, bottom, _size, _size) );
+    GL_ASSERT( glScissor(left + x1, bottom + y1, x2 - x1, y2 - y1) );
+    Game::getInstance()->clear(Game::CLEAR_COLOR_DEPTH, Vector4::one(), 1.0f, 0);
+    if (casters.empty())
+        return;
+
+    Camera* camera = _cameraNode->getCamera();
+    Matrix projection;
+    getProjection(cascade, 0, 0, _size, _size, &projection);
+    camera->setProjectionMatrix(projection);
+
+    // The casters outside the range of texels are not drawn, which leaves few of them for
+    // the strips of a scroll.
+    Matrix rangeProjection;
+    getProjection(cascade, x1, y1, x2, y2, &rangeProjection);
+    Matrix rangeViewProjection;
+    Matrix::multiply(rangeProjection, camera->getViewMatrix(), &rangeViewProjection);
+    Frustum frustum(rangeViewProjection);
+
+    _queue->clear();
+    for (size_t i = 0, count = casters.size(); i < count; ++i)
+    {
+        if (frustum.intersects(casters[i]->getBoundingSphere()))
+            _queue->add(casters[i]->getModel());
+    }
+    _queue->drawDepth(true);
+}
+
+void ShadowMap::scroll(unsigned int index, int dx, int dy)
+{
+    GL_ASSERT( glDisable(GL_SCISSOR_TEST) );
+    float size = (float)_size;
+    Matrix projection;
+    Matrix::createOrthographicOffCenter(0.0f, size, 0.0f, size, 0.0f, 1.0f, &projection);
+
+    // The map is copied out of the atlas and back, since a texture cannot be read while it is
+    // drawn into.
+    float rowHeight = 1.0f / _cascadeCount;
+    _scrollBuffer->bind();
+    GL_ASSERT( glViewport(0, 0, _size, _size) );
+    _atlasBatch->setProjectionMatrix(projection);
+    _atlasBatch->start();
+    _atlasBatch->draw(0.0f, 0.0f, size, size, 0.0f, index * rowHeight, 0.5f, (index + 1) * rowHeight, Vector4::one());
+    _atlasBatch->finish();
+
+    // The texel now at x is the one that was at x + dx.
+    _frameBuffer->bind();
+    GL_ASSERT( glViewport(0, index * _size, _size, _size) );
+    _scrollBatch->setProjectionMatrix(projection);
+    _scrollBatch->start();
+    _scrollBatch->draw((float)-dx, (float)-dy, size, size, 0.0f, 0.0f, 1.0f, 1.0f, Vector4::one());
+    _scrollBatch->finish();
+    GL_ASSERT( glEnable(GL_SCISSOR_TEST) );
+}
+
+void ShadowMap::bind(RenderState* renderState)
+{
+    GP_ASSERT(renderState);
+
+    renderState->getParameter("u_shadowMap")->setValue(_sampler);
+    renderState->getParameter("u_shadowMatrix")->setValue(_matrices, _cascadeCount);
+    renderState->getParameter("u_shadowSplits")->setValue(_splits, _cascadeCount);
+    renderState->getParameter("u_shadowViewPlane")->setValue(&_viewPlane, 1);
+    renderState->getParameter("u_shadowBias")->setValue(&_bias, 1);
+    renderState->setParameterAutoBinding("u_worldMatrix", RenderState::WORLD_MATRIX);
+}
+
+}
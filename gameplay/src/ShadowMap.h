@@ -0,0 +1,294 @@
+#ifndef SHADOWMAP_H_
+#define SHADOWMAP_H_
+
+#include "Ref.h"
+#include "Texture.h"
+#include "Matrix.h"
+#include "Vector3.h"
+#include "Vector4.h"
+
+namespace gameplay
+{
+
+class Light;
+class Node;
+class Scene;
+class FrameBuffer;
+class RenderQueue;
+class RenderState;
+class SpriteBatch;
+
+/**
+ * Defines the cascaded shadow map of a directional light.
+ *
+ * The view of the active camera of a scene is split along its depth into cascades, each
+ * covered by a square map of the depth of the casters seen from the light, so near shadows
+ * get more texels than far ones. The cascades are the rows of a texture atlas, and each row
+ * holds two maps: the casters that never move on the left, and those that do on the right.
+ *
+ * Redrawing every caster into every cascade each frame is what makes shadows expensive, and
+ * most of the scene does not move. The map of the static casters of a cascade is therefore
+ * kept from frame to frame, and only drawn again entirely when the direction of the light or
+ * the size of the cascade changes. The bounds of each cascade are snapped to whole texels in
+ * the space of the light, so when the camera moves, the map is scrolled by the number of
+ * texels its bounds moved, and the static casters are only drawn into the strips that were
+ * exposed at its edges. Far cascades scroll less often than near ones, since their texels are
+ * larger. Only the dynamic casters are drawn into their maps every frame.
+ *
+ * A caster is static if its node is static, such as a node with a static rigid body (see
+ * Node::isStatic), or has the "static" tag. Call invalidate() when static casters are added,
+ * removed or changed.
+ *
+ * The engine has no depth textures, so the depth from the light is packed into the RGBA
+ * channels of the maps. The casters are drawn with effects derived from their own, as the
+ * depth pre-pass of a RenderQueue derives them, so casters whose effects discard pixels, such
+ * as TEXTURE_DISCARD_ALPHA, cast no shadows.
+ *
+ * The materials that receive the shadows are compiled with the SHADOWS and
+ * SHADOW_CASCADE_COUNT defines and bound to the shadow map with bind(). The built-in shaders
+ * attenuate the directional light by the nearer of the two maps of the cascade that
+ * contains the pixel.
+ *
+ @verbatim
+    ShadowMap* shadows = ShadowMap::create(sun, 1024, 3);
+    shadows->bind(groundMaterial);
+
+    // In Game::render, before the scene is drawn:
+    shadows->update(scene);
+ @endverbatim
+ *
+ * @script{ignore}
+ */
+class ShadowMap : public Ref
+{
+public:
+
+    /**
+     * The maximum number of cascades of a shadow map.
+     */
+    static const unsigned int MAX_CASCADES = 4;
+
+    /**
+     * Creates a shadow map for a directional light.
+     *
+     * @param light The directional light that casts the shadows. It must have a node.
+     * @param size The width and height in texels of the map of each cascade.
+     * @param cascadeCount The number of cascades, from 1 to MAX_CASCADES.
+     *
+     * @return The new shadow map, or NULL if it could not be created.
+     */
+    static ShadowMap* create(Light* light, unsigned int size = 1024, unsigned int cascadeCount = 3);
+
+    /**
+     * Returns the light that casts the shadows.
+     *
+     * @return The light.
+     */
+    Light* getLight() const;
+
+    /**
+     * Returns the width and height of the map of each cascade.
+     *
+     * @return The size in texels.
+     */
+    unsigned int getSize() const;
+
+    /**
+     * Returns the number of cascades.
+     *
+     * @return The number of cascades.
+     */
+    unsigned int getCascadeCount() const;
+
+    /**
+     * Sets the distance from the camera up to which shadows are drawn.
+     *
+     * The cascades cover the view of the camera from its near plane to the nearer of this
+     * distance and its far plane. The default is 100.
+     *
+     * @param distance The distance in world units.
+     */
+    void setDistance(float distance);
+
+    /**
+     * Returns the distance from the camera up to which shadows are drawn.
+     *
+     * @return The distance in world units.
+     */
+    float getDistance() const;
+
+    /**
+     * Sets how the view of the camera is split into cascades.
+     *
+     * A value of 0 splits the distance into cascades of equal length, and a value of 1 splits
+     * it logarithmically, so each cascade is longer than the previous one by the same factor.
+     * The default is 0.75.
+     *
+     * @param lambda The blend between uniform and logarithmic splits, from 0 to 1.
+     */
+    void setSplitLambda(float lambda);
+
+    /**
+     * Returns how the view of the camera is split into cascades.
+     *
+     * @return The blend between uniform and logarithmic splits.
+     */
+    float getSplitLambda() const;
+
+    /**
+     * Sets the distance towards the light beyond the bounds of each cascade within which
+     * casters are drawn, so that objects outside the view cast shadows into it.
+     *
+     * The default is 50.
+     *
+     * @param distance The distance in world units.
+     */
+    void setCasterDistance(float distance);
+
+    /**
+     * Returns the distance towards the light within which casters outside the view are drawn.
+     *
+     * @return The distance in world units.
+     */
+    float getCasterDistance() const;
+
+    /**
+     * Sets the bias subtracted from the depth of a pixel before it is compared to the map,
+     * to avoid the shadows that surfaces would otherwise cast on themselves.
+     *
+     * The default is 0.002.
+     *
+     * @param bias The bias, as a fraction of the depth range of a cascade.
+     */
+    void setBias(float bias);
+
+    /**
+     * Returns the bias subtracted from the depth of a pixel before it is compared to the map.
+     *
+     * @return The bias.
+     */
+    float getBias() const;
+
+    /**
+     * Returns the distance from the camera at which a cascade ends, as of the last update().
+     *
+     * @param cascade The index of the cascade.
+     *
+     * @return The distance along the view direction of the camera.
+     */
+    float getSplitDistance(unsigned int cascade) const;
+
+    /**
+     * Returns the texture atlas of the maps of the cascades.
+     *
+     * @return The texture.
+     */
+    Texture* getTexture() const;
+
+    /**
+     * Causes the maps of the static casters to be drawn again entirely at the next update().
+     */
+    void invalidate();
+
+    /**
+     * Updates the cascades for the active camera of a scene, and draws the casters of the
+     * scene into their maps.
+     *
+     * This draws into a frame buffer of its own, so it must be called before the frame is
+     * drawn, or outside of the drawing of another frame buffer.
+     *
+     * @param scene The scene whose nodes cast the shadows.
+     */
+    void update(Scene* scene);
+
+    /**
+     * Binds the uniforms of the SHADOWS define of the built-in shaders to the shadow map:
+     * u_shadowMap, u_shadowMatrix, u_shadowSplits, u_shadowViewPlane and u_shadowBias. The
+     * u_worldMatrix uniform is also bound, since the position of each pixel is transformed
+     * to the maps from world space.
+     *
+     * The values are bound rather than copied, so this only needs to be called once.
+     *
+     * @param renderState The material, technique or pass that receives the shadows.
+     */
+    void bind(RenderState* renderState);
+
+private:
+
+    /**
+     * The bounds of a cascade, snapped to texels in the space of the light.
+     */
+    struct Cascade
+    {
+        bool valid;
+        bool dynamicEmpty;
+        float radius;
+        int x;
+        int y;
+        int z;
+    };
+
+    /**
+     * Constructor.
+     */
+    ShadowMap();
+
+    /**
+     * Destructor.
+     */
+    ~ShadowMap();
+
+    /**
+     * Hidden copy constructor.
+     */
+    ShadowMap(const ShadowMap&);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    ShadowMap& operator=(const ShadowMap&);
+
+    /**
+     * Returns the orthographic projection of the light that covers a range of texels of a cascade.
+     */
+    void getProjection(const Cascade& cascade, int x1, int y1, int x2, int y2, Matrix* dst) const;
+
+    /**
+     * Draws the casters that intersect a range of texels of a cascade, within the scissor of the range.
+     */
+    void drawCasters(const std::vector<Node*>& casters, const Cascade& cascade, int x1, int y1, int x2, int y2,
+                     unsigned int left, unsigned int bottom);
+
+    /**
+     * Scrolls the map of the static casters of a cascade by a number of texels.
+     */
+    void scroll(unsigned int index, int dx, int dy);
+
+    Light* _light;
+    unsigned int _size;
+    unsigned int _cascadeCount;
+    float _distance;
+    float _splitLambda;
+    float _casterDistance;
+    float _bias;
+    FrameBuffer* _frameBuffer;
+    FrameBuffer* _scrollBuffer;
+    SpriteBatch* _atlasBatch;
+    SpriteBatch* _scrollBatch;
+    Texture::Sampler* _sampler;
+    RenderQueue* _queue;
+    Node* _cameraNode;
+    Vector3 _direction;
+    Cascade _cascades[MAX_CASCADES];
+    Matrix _matrices[MAX_CASCADES];
+    float _splits[MAX_CASCADES];
+    Vector4 _viewPlane;
+    std::vector<Node*> _nodes;
+    std::vector<unsigned int> _masks;
+    std::vector<Node*> _staticCasters;
+    std::vector<Node*> _dynamicCasters;
+};
+
+}
+
+#endif
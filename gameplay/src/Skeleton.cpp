@@ -0,0 +1,153 @@
+#include "Base.h"
+#include "Skeleton.h"
+#include "MeshSkin.h"
+#include "Joint.h"
+#include "MathUtil.h"
+
+namespace gameplay
+{
+
+Skeleton::Skeleton()
+{
+}
+
+Skeleton::~Skeleton()
+{
+}
+
+/**
+ * Orders joints by their depth in the skeleton, so that each joint comes after its parent.
+ */
+struct JointDepthOrder
+{
+    JointDepthOrder(const std::vector<unsigned int>& depths) : depths(depths) { }
+    bool operator()(unsigned int a, unsigned int b) const { return depths[a] < depths[b]; }
+    const std::vector<unsigned int>& depths;
+};
+
+Skeleton* Skeleton::create(const MeshSkin* skin)
+{
+    GP_ASSERT(skin);
+
+    const unsigned int count = skin->getJointCount();
+    Joint* rootJoint = skin->getRootJoint();
+    Node* rootParent = rootJoint ? rootJoint->getParent() : NULL;
+
+    Skeleton* skeleton = new Skeleton();
+    skeleton->_joints.resize(count);
+    skeleton->_bindMatrices.resize(count * 16);
+    if (rootParent)
+        skeleton->_rootMatrix = rootParent->getWorldMatrix();
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        Joint* joint = skin->getJoint(i);
+        GP_ASSERT(joint);
+        JointDefinition& definition = skeleton->_joints[i];
+        definition.id = joint->getId();
+
+        // Nodes between two joints of the skin are folded into the transform of the child.
+        definition.parent = -1;
+        for (Node* node = joint->getParent(); node != NULL && node != rootParent; node = node->getParent())
+        {
+            int index = node->getType() == Node::JOINT ? skin->getJointIndex(static_cast<Joint*>(node)) : -1;
+            if (index >= 0)
+            {
+                definition.parent = index;
+                break;
+            }
+        }
+        Node* parent = definition.parent >= 0 ? skin->getJoint(definition.parent) : rootParent;
+        definition.direct = joint->getParent() == parent;
+
+        MathUtil::multiplyMatrix(joint->getInverseBindPose().m, skin->getBindShape().m, &skeleton->_bindMatrices[i * 16]);
+    }
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        skeleton->getLocalTransform(skin, i, &skeleton->_joints[i].rest);
+    }
+
+    std::vector<unsigned int> depths(count, 0);
+    skeleton->_order.resize(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        for (int parent = skeleton->_joints[i].parent; parent >= 0; parent = skeleton->_joints[parent].parent)
+            ++depths[i];
+        skeleton->_order[i] = i;
+    }
+    std::stable_sort(skeleton->_order.begin(), skeleton->_order.end(), JointDepthOrder(depths));
+
+    return skeleton;
+}
+
+unsigned int Skeleton::getJointCount() const
+{
+    return (unsigned int)_joints.size();
+}
+
+const char* Skeleton::getJointId(unsigned int index) const
+{
+    GP_ASSERT(index < _joints.size());
+    return _joints[index].id.c_str();
+}
+
+int Skeleton::getJointIndex(const char* id) const
+{
+    GP_ASSERT(id);
+
+    for (size_t i = 0, count = _joints.size(); i < count; ++i)
+    {
+        if (_joints[i].id == id)
+            return (int)i;
+    }
+    return -1;
+}
+
+int Skeleton::getParentIndex(unsigned int index) const
+{
+    GP_ASSERT(index < _joints.size());
+    return _joints[index].parent;
+}
+
+const Skeleton::JointTransform& Skeleton::getRestTransform(unsigned int index) const
+{
+    GP_ASSERT(index < _joints.size());
+    return _joints[index].rest;
+}
+
+const Matrix& Skeleton::getRootMatrix() const
+{
+    return _rootMatrix;
+}
+
+void Skeleton::getLocalTransform(const MeshSkin* skin, unsigned int index, JointTransform* dst) const
+{
+    GP_ASSERT(skin);
+    GP_ASSERT(dst);
+    GP_ASSERT(index < _joints.size());
+
+    const JointDefinition& definition = _joints[index];
+    Joint* joint = skin->getJoint(index);
+    GP_ASSERT(joint);
+
+    // A joint whose node is parented to its parent in the skeleton already has the transform.
+    if (definition.direct)
+    {
+        dst->scale = joint->getScale();
+        dst->rotation = joint->getRotation();
+        dst->translation = joint->getTranslation();
+        return;
+    }
+
+    Matrix inverseParent;
+    if (definition.parent >= 0)
+        skin->getJoint(definition.parent)->getWorldMatrix().invert(&inverseParent);
+    else
+        _rootMatrix.invert(&inverseParent);
+    Matrix local;
+    Matrix::multiply(inverseParent, joint->getWorldMatrix(), &local);
+    local.decompose(&dst->scale, &dst->rotation, &dst->translation);
+}
+
+}
@@ -0,0 +1,161 @@
+#ifndef SKELETON_H_
+#define SKELETON_H_
+
+#include "Ref.h"
+#include "Matrix.h"
+#include "Vector3.h"
+#include "Quaternion.h"
+
+namespace gameplay
+{
+
+class MeshSkin;
+
+/**
+ * Defines the immutable skeleton of a MeshSkin: the names and hierarchy of its joints, their
+ * bind poses and the pose they were in when the skeleton was created.
+ *
+ * A skeleton is created from the joints of a skin the first time the skin is cloned with
+ * shared skeletons (see Node::cloneInstances), and is then shared by every skin cloned from
+ * it. Those skins have no Joint nodes of their own, only an array of the local transforms of
+ * the joints, so a crowd of characters does not clone a hierarchy of nodes per character.
+ *
+ * The transform of each joint is relative to its nearest ancestor among the joints of the
+ * skin, or to the node that the root joint was parented to for joints without such ancestor.
+ *
+ * @see MeshSkin::isSkeletonShared
+ * @script{ignore}
+ */
+class Skeleton : public Ref
+{
+    friend class MeshSkin;
+
+public:
+
+    /**
+     * The local transform of a joint.
+     */
+    struct JointTransform
+    {
+        /**
+         * The scale of the joint.
+         */
+        Vector3 scale;
+
+        /**
+         * The rotation of the joint.
+         */
+        Quaternion rotation;
+
+        /**
+         * The translation of the joint.
+         */
+        Vector3 translation;
+    };
+
+    /**
+     * Returns the number of joints.
+     *
+     * @return The number of joints.
+     */
+    unsigned int getJointCount() const;
+
+    /**
+     * Returns the ID of a joint.
+     *
+     * @param index The index of the joint in the skin.
+     *
+     * @return The ID of the Joint node the joint was created from.
+     */
+    const char* getJointId(unsigned int index) const;
+
+    /**
+     * Returns the index of the joint with the specified ID.
+     *
+     * @param id The ID of the joint.
+     *
+     * @return The index of the joint, or -1 if there is no joint with the ID.
+     */
+    int getJointIndex(const char* id) const;
+
+    /**
+     * Returns the index of the parent of a joint.
+     *
+     * @param index The index of the joint.
+     *
+     * @return The index of the nearest ancestor of the joint in the skin, or -1 if it has none.
+     */
+    int getParentIndex(unsigned int index) const;
+
+    /**
+     * Returns the transform of a joint when the skeleton was created.
+     *
+     * @param index The index of the joint.
+     *
+     * @return The local transform of the joint.
+     */
+    const JointTransform& getRestTransform(unsigned int index) const;
+
+    /**
+     * Returns the world matrix that the node the root joint was parented to had when the
+     * skeleton was created, which the joints without a parent joint are relative to.
+     *
+     * @return The matrix of the parent of the skeleton.
+     */
+    const Matrix& getRootMatrix() const;
+
+private:
+
+    /**
+     * A joint of the skeleton.
+     */
+    struct JointDefinition
+    {
+        std::string id;
+        int parent;
+        bool direct;
+        JointTransform rest;
+    };
+
+    /**
+     * Constructor.
+     */
+    Skeleton();
+
+    /**
+     * Destructor.
+     */
+    ~Skeleton();
+
+    /**
+     * Hidden copy constructor.
+     */
+    Skeleton(const Skeleton&);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    Skeleton& operator=(const Skeleton&);
+
+    /**
+     * Creates a skeleton from the joints of a skin.
+     */
+    static Skeleton* create(const MeshSkin* skin);
+
+    /**
+     * Reads the current local transform of a joint of a skin with joints, relative to its
+     * parent in the skeleton.
+     */
+    void getLocalTransform(const MeshSkin* skin, unsigned int index, JointTransform* dst) const;
+
+    std::vector<JointDefinition> _joints;
+    // The joints ordered so that each joint comes after its parent.
+    std::vector<unsigned int> _order;
+    // The product of the inverse bind pose of each joint and the bind shape, 16 floats per joint.
+    std::vector<float> _bindMatrices;
+    Matrix _rootMatrix;
+};
+
+}
+
+#endif
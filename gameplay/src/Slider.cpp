@@ -483,28 +483,12 @@ void Slider::update(const Control* container, const Vector2& offset)
     }
 }
 
-void Slider::draw(SpriteBatch* spriteBatch, const Rectangle& clip, bool needsClear, bool cleared, float targetHeight)
+void Slider::draw(SpriteBatch* spriteBatch, const Rectangle& clip, const Rectangle& region)
 {
-    if (needsClear)
-    {
-        GL_ASSERT( glEnable(GL_SCISSOR_TEST) );
-        GL_ASSERT( glScissor(_clearBounds.x, targetHeight - _clearBounds.y - _clearBounds.height, _clearBounds.width, _clearBounds.height) );
-        Game::getInstance()->clear(Game::CLEAR_COLOR, Vector4::zero(), 1.0f, 0);
-        GL_ASSERT( glDisable(GL_SCISSOR_TEST) );
-    }
-
-    if (!_visible)
-        return;
-
-    spriteBatch->start();
-    drawBorder(spriteBatch, clip);
-    drawImages(spriteBatch, clip);
-    spriteBatch->finish();
-
-    drawText(clip);
-    if (_delta == 0.0f)
+    Control::draw(spriteBatch, clip, region);
+    if (_delta != 0.0f)
     {
-        _dirty = false;
+        _dirty = true;
     }
 }
 
@@ -568,7 +552,8 @@ void Slider::drawText(const Rectangle& clip)
     if (_valueTextVisible && _font)
     {
         _font->start();
-        _font->drawText(_valueText.c_str(), _textBounds, _textColor, getFontSize(_state), _valueTextAlignment, true, getTextRightToLeft(_state), &_viewportClipBounds);
+        const ResolvedStyle& style = getResolvedStyle();
+        _font->drawText(_valueText.c_str(), _textBounds, _textColor, style.fontSize, _valueTextAlignment, true, style.textRightToLeft, &_viewportClipBounds);
         _font->finish();
     }
 }
@@ -233,7 +233,7 @@ protected:
      * Slider overrides draw() so that it can avoid resetting the _dirty flag
      * when a joystick is being used to change its value.
      */
-    void draw(SpriteBatch* spriteBatch, const Rectangle& clip, bool needsClear, bool cleared, float targetHeight);
+    void draw(SpriteBatch* spriteBatch, const Rectangle& clip, const Rectangle& region);
 
     /**
      * Draw the images associated with this control.
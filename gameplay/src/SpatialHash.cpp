@@ -0,0 +1,297 @@
+#include "Base.h"
+#include "SpatialHash.h"
+#include "Node.h"
+
+// The number of buckets of an empty index.
+#define SPATIAL_HASH_BUCKET_COUNT 64
+
+namespace gameplay
+{
+
+SpatialHash::SpatialHash(float cellSize)
+    : _cellSize(cellSize), _inverseCellSize(0.0f), _maxRadius(0.0f), _freeList(-1), _nodeCount(0)
+{
+    GP_ASSERT(cellSize > 0.0f);
+    _inverseCellSize = 1.0f / _cellSize;
+    _buckets.resize(SPATIAL_HASH_BUCKET_COUNT, -1);
+}
+
+SpatialHash::~SpatialHash()
+{
+    clear();
+}
+
+float SpatialHash::getCellSize() const
+{
+    return _cellSize;
+}
+
+void SpatialHash::insert(Node* node, float radius)
+{
+    GP_ASSERT(node);
+    GP_ASSERT(radius >= 0.0f);
+
+    if (radius > _maxRadius)
+        _maxRadius = radius;
+
+    std::map<Node*, int>::iterator itr = _indices.find(node);
+    if (itr != _indices.end())
+    {
+        _entries[itr->second].radius = radius;
+        return;
+    }
+
+    int index;
+    if (_freeList >= 0)
+    {
+        index = _freeList;
+        _freeList = _entries[index].next;
+    }
+    else
+    {
+        index = (int)_entries.size();
+        _entries.push_back(Entry());
+    }
+
+    Entry& entry = _entries[index];
+    entry.node = node;
+    entry.position = node->getTranslationWorld();
+    entry.radius = radius;
+    entry.bucket = -1;
+    entry.dirty = false;
+    _indices[node] = index;
+    ++_nodeCount;
+
+    if (_nodeCount > _buckets.size() * 2)
+        grow();
+    link(index);
+
+    // The entry index is passed as the cookie, so transform changes find the entry without a lookup.
+    node->addListener(this, index);
+}
+
+void SpatialHash::remove(Node* node)
+{
+    std::map<Node*, int>::iterator itr = _indices.find(node);
+    if (itr == _indices.end())
+        return;
+
+    int index = itr->second;
+    _indices.erase(itr);
+    node->removeListener(this);
+    unlink(index);
+
+    // A dirty entry stays in the dirty list until the next update, which skips freed entries.
+    Entry& entry = _entries[index];
+    entry.node = NULL;
+    entry.dirty = false;
+    entry.next = _freeList;
+    _freeList = index;
+    --_nodeCount;
+}
+
+bool SpatialHash::contains(Node* node) const
+{
+    return _indices.find(node) != _indices.end();
+}
+
+unsigned int SpatialHash::getNodeCount() const
+{
+    return _nodeCount;
+}
+
+void SpatialHash::clear()
+{
+    for (std::map<Node*, int>::iterator itr = _indices.begin(); itr != _indices.end(); ++itr)
+    {
+        itr->first->removeListener(this);
+    }
+    _indices.clear();
+    _entries.clear();
+    _dirty.clear();
+    std::fill(_buckets.begin(), _buckets.end(), -1);
+    _freeList = -1;
+    _nodeCount = 0;
+    _maxRadius = 0.0f;
+}
+
+void SpatialHash::transformChanged(Transform* transform, long cookie)
+{
+    Entry& entry = _entries[cookie];
+    GP_ASSERT(entry.node == transform);
+    if (!entry.dirty)
+    {
+        entry.dirty = true;
+        _dirty.push_back((int)cookie);
+    }
+}
+
+void SpatialHash::update()
+{
+    for (size_t i = 0, count = _dirty.size(); i < count; ++i)
+    {
+        int index = _dirty[i];
+        Entry& entry = _entries[index];
+        if (!entry.dirty)
+            continue;
+
+        entry.dirty = false;
+        entry.position = entry.node->getTranslationWorld();
+        if (getCell(entry.position.x) != entry.cell[0] || getCell(entry.position.y) != entry.cell[1] || getCell(entry.position.z) != entry.cell[2])
+        {
+            unlink(index);
+            link(index);
+        }
+    }
+    _dirty.clear();
+}
+
+void SpatialHash::link(int index)
+{
+    Entry& entry = _entries[index];
+    entry.cell[0] = getCell(entry.position.x);
+    entry.cell[1] = getCell(entry.position.y);
+    entry.cell[2] = getCell(entry.position.z);
+    entry.bucket = getBucket(entry.cell[0], entry.cell[1], entry.cell[2]);
+    entry.prev = -1;
+    entry.next = _buckets[entry.bucket];
+    if (entry.next >= 0)
+        _entries[entry.next].prev = index;
+    _buckets[entry.bucket] = index;
+}
+
+void SpatialHash::unlink(int index)
+{
+    Entry& entry = _entries[index];
+    if (entry.bucket < 0)
+        return;
+
+    if (entry.prev >= 0)
+        _entries[entry.prev].next = entry.next;
+    else
+        _buckets[entry.bucket] = entry.next;
+    if (entry.next >= 0)
+        _entries[entry.next].prev = entry.prev;
+    entry.bucket = -1;
+}
+
+void SpatialHash::grow()
+{
+    _buckets.assign(_buckets.size() * 2, -1);
+    for (size_t i = 0, count = _entries.size(); i < count; ++i)
+    {
+        if (_entries[i].node)
+        {
+            _entries[i].bucket = -1;
+            link((int)i);
+        }
+    }
+}
+
+int SpatialHash::getCell(float x) const
+{
+    return (int)floorf(x * _inverseCellSize);
+}
+
+int SpatialHash::getBucket(int x, int y, int z) const
+{
+    unsigned int hash = ((unsigned int)x * 73856093u) ^ ((unsigned int)y * 19349663u) ^ ((unsigned int)z * 83492791u);
+    return (int)(hash & (unsigned int)(_buckets.size() - 1));
+}
+
+/**
+ * Tests whether the sphere of an entry overlaps a sphere.
+ */
+struct SphereTest
+{
+    Vector3 center;
+    float radius;
+
+    bool operator()(const Vector3& position, float r) const
+    {
+        float distance = radius + r;
+        return center.distanceSquared(position) <= distance * distance;
+    }
+};
+
+/**
+ * Tests whether the sphere of an entry overlaps a box.
+ */
+struct BoxTest
+{
+    Vector3 min;
+    Vector3 max;
+
+    bool operator()(const Vector3& position, float r) const
+    {
+        Vector3 closest(std::min(std::max(position.x, min.x), max.x),
+                        std::min(std::max(position.y, min.y), max.y),
+                        std::min(std::max(position.z, min.z), max.z));
+        return closest.distanceSquared(position) <= r * r;
+    }
+};
+
+template <class Test>
+unsigned int SpatialHash::query(const Vector3& min, const Vector3& max, const Test& test, std::vector<Node*>& nodes)
+{
+    update();
+
+    unsigned int found = 0;
+    int minCell[3] = { getCell(min.x - _maxRadius), getCell(min.y - _maxRadius), getCell(min.z - _maxRadius) };
+    int maxCell[3] = { getCell(max.x + _maxRadius), getCell(max.y + _maxRadius), getCell(max.z + _maxRadius) };
+    double cellCount = (double)(maxCell[0] - minCell[0] + 1) * (maxCell[1] - minCell[1] + 1) * (maxCell[2] - minCell[2] + 1);
+    if (cellCount > (double)_nodeCount)
+    {
+        // The query covers more cells than there are nodes, so testing every node is faster than visiting the cells.
+        for (size_t i = 0, count = _entries.size(); i < count; ++i)
+        {
+            const Entry& entry = _entries[i];
+            if (entry.node && test(entry.position, entry.radius))
+            {
+                nodes.push_back(entry.node);
+                ++found;
+            }
+        }
+        return found;
+    }
+
+    for (int z = minCell[2]; z <= maxCell[2]; ++z)
+    {
+        for (int y = minCell[1]; y <= maxCell[1]; ++y)
+        {
+            for (int x = minCell[0]; x <= maxCell[0]; ++x)
+            {
+                // Several cells can share a bucket, so the entries of other cells are skipped.
+                for (int i = _buckets[getBucket(x, y, z)]; i >= 0; i = _entries[i].next)
+                {
+                    const Entry& entry = _entries[i];
+                    if (entry.cell[0] == x && entry.cell[1] == y && entry.cell[2] == z && test(entry.position, entry.radius))
+                    {
+                        nodes.push_back(entry.node);
+                        ++found;
+                    }
+                }
+            }
+        }
+    }
+    return found;
+}
+
+unsigned int SpatialHash::query(const Vector3& center, float radius, std::vector<Node*>& nodes)
+{
+    SphereTest test;
+    test.center = center;
+    test.radius = radius;
+    return query(Vector3(center.x - radius, center.y - radius, center.z - radius),
+                 Vector3(center.x + radius, center.y + radius, center.z + radius), test, nodes);
+}
+
+unsigned int SpatialHash::query(const BoundingBox& box, std::vector<Node*>& nodes)
+{
+    BoxTest test;
+    test.min = box.min;
+    test.max = box.max;
+    return query(box.min, box.max, test, nodes);
+}
+
+}
@@ -0,0 +1,190 @@
+#ifndef SPATIALHASH_H_
+#define SPATIALHASH_H_
+
+#include "Transform.h"
+#include "BoundingBox.h"
+
+namespace gameplay
+{
+
+class Node;
+
+/**
+ * Defines an index of nodes by position, for finding the nodes near a point.
+ *
+ * Space is divided into a uniform grid of cubic cells, and each node is stored in the
+ * cell that contains its world translation. Only the cells that are in use are stored,
+ * in a hash table, so the grid has no bounds. A query only visits the cells that overlap
+ * the query volume, which makes finding the neighbors of every node of a crowd linear in
+ * the number of nodes rather than quadratic.
+ *
+ * The index listens to the transform changes of its nodes and moves them to their new
+ * cell lazily, at the next query, so a node that moves several times in a frame is only
+ * moved in the index once. The cell size should be about the radius of the most common
+ * queries: smaller cells make queries visit many empty cells, larger cells make them test
+ * many nodes that are too far.
+ *
+ * The index does not keep references to its nodes: a node must be removed from the index
+ * before it is destroyed.
+ *
+ * @script{ignore}
+ */
+class SpatialHash : public Transform::Listener
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param cellSize The size of the cells of the grid.
+     */
+    SpatialHash(float cellSize = 10.0f);
+
+    /**
+     * Destructor.
+     */
+    ~SpatialHash();
+
+    /**
+     * Returns the size of the cells of the grid.
+     *
+     * @return The cell size.
+     */
+    float getCellSize() const;
+
+    /**
+     * Adds a node to the index.
+     *
+     * The node is found by the queries that overlap the sphere of the given radius around
+     * its world translation. Nodes already in the index are only updated with the new radius.
+     *
+     * @param node The node to add.
+     * @param radius The radius of the node, or zero to treat the node as a point.
+     */
+    void insert(Node* node, float radius = 0.0f);
+
+    /**
+     * Removes a node from the index.
+     *
+     * @param node The node to remove.
+     */
+    void remove(Node* node);
+
+    /**
+     * Determines whether a node is in the index.
+     *
+     * @param node The node.
+     *
+     * @return true if the node is in the index, false otherwise.
+     */
+    bool contains(Node* node) const;
+
+    /**
+     * Returns the number of nodes in the index.
+     *
+     * @return The number of nodes.
+     */
+    unsigned int getNodeCount() const;
+
+    /**
+     * Removes all the nodes from the index.
+     */
+    void clear();
+
+    /**
+     * Finds the nodes that overlap a sphere.
+     *
+     * @param center The center of the sphere, in world space.
+     * @param radius The radius of the sphere.
+     * @param nodes The array to add the nodes to. Nodes are appended, in no particular order.
+     *
+     * @return The number of nodes found.
+     */
+    unsigned int query(const Vector3& center, float radius, std::vector<Node*>& nodes);
+
+    /**
+     * Finds the nodes that overlap a box.
+     *
+     * @param box The box, in world space.
+     * @param nodes The array to add the nodes to. Nodes are appended, in no particular order.
+     *
+     * @return The number of nodes found.
+     */
+    unsigned int query(const BoundingBox& box, std::vector<Node*>& nodes);
+
+    /**
+     * @see Transform::Listener::transformChanged
+     */
+    void transformChanged(Transform* transform, long cookie);
+
+private:
+
+    /**
+     * A node in the index. Entries are linked in the list of the bucket of their cell.
+     */
+    struct Entry
+    {
+        Node* node;             // NULL for the entries on the free list.
+        Vector3 position;       // The world translation of the node when it was last moved in the index.
+        float radius;
+        int cell[3];
+        int bucket;             // The bucket the entry is linked in, or -1.
+        int prev;
+        int next;               // The next entry of the bucket, or of the free list.
+        bool dirty;             // Whether the node moved since it was last moved in the index.
+    };
+
+    SpatialHash(const SpatialHash& copy);
+
+    SpatialHash& operator=(const SpatialHash&);
+
+    /**
+     * Moves the nodes that moved since the last query to their new cell.
+     */
+    void update();
+
+    /**
+     * Links an entry in the bucket of the cell of its position.
+     */
+    void link(int index);
+
+    /**
+     * Unlinks an entry from its bucket.
+     */
+    void unlink(int index);
+
+    /**
+     * Doubles the number of buckets and relinks all the entries.
+     */
+    void grow();
+
+    /**
+     * Returns the cell coordinate of a position along one axis.
+     */
+    int getCell(float x) const;
+
+    /**
+     * Returns the bucket of a cell.
+     */
+    int getBucket(int x, int y, int z) const;
+
+    /**
+     * Finds the entries whose cell is in the given range and that pass the test, and adds their nodes to the array.
+     */
+    template <class Test>
+    unsigned int query(const Vector3& min, const Vector3& max, const Test& test, std::vector<Node*>& nodes);
+
+    float _cellSize;
+    float _inverseCellSize;
+    float _maxRadius;                   // The largest radius of the nodes in the index, which queries are expanded by.
+    std::vector<Entry> _entries;
+    std::map<Node*, int> _indices;      // The entry of each node.
+    std::vector<int> _buckets;          // The first entry of the list of each bucket, or -1. The count is a power of two.
+    std::vector<int> _dirty;            // The entries that moved since the last query.
+    int _freeList;
+    unsigned int _nodeCount;
+};
+
+}
+
+#endif
@@ -24,13 +24,32 @@ namespace gameplay
 
 static Effect* __spriteEffect = NULL;
 
+// Returns the vertex format of sprite batches.
+static VertexFormat getSpriteVertexFormat()
+{
+    VertexFormat::Element vertexElements[] =
+    {
+        VertexFormat::Element(VertexFormat::POSITION, 3),
+        VertexFormat::Element(VertexFormat::TEXCOORD0, 2),
+        VertexFormat::Element(VertexFormat::COLOR, 4)
+    };
+    return VertexFormat(vertexElements, 3);
+}
+
 SpriteBatch::SpriteBatch()
-    : _batch(NULL), _sampler(NULL), _textureWidthRatio(0.0f), _textureHeightRatio(0.0f)
+    : _batch(NULL), _sampler(NULL), _atlas(NULL), _samplerParameter(NULL), _pageCapacity(0), _textureWidthRatio(0.0f), _textureHeightRatio(0.0f)
 {
 }
 
 SpriteBatch::~SpriteBatch()
 {
+    // The first page uses the batch and sampler of the sprite batch itself.
+    for (size_t i = 1, count = _pageBatches.size(); i < count; ++i)
+    {
+        SAFE_DELETE(_pageBatches[i]);
+        SAFE_RELEASE(_pageSamplers[i]);
+    }
+    SAFE_RELEASE(_atlas);
     SAFE_DELETE(_batch);
     SAFE_RELEASE(_sampler);
     if (!_customEffect)
@@ -108,19 +127,12 @@ SpriteBatch* SpriteBatch::create(Texture* texture,  Effect* effect, unsigned int
 
     // Bind the texture to the material as a sampler
     Texture::Sampler* sampler = Texture::Sampler::create(texture); // +ref texture
-    material->getParameter(samplerUniform->getName())->setValue(sampler);
-    
-    // Define the vertex format for the batch
-    VertexFormat::Element vertexElements[] =
-    {
-        VertexFormat::Element(VertexFormat::POSITION, 3),
-        VertexFormat::Element(VertexFormat::TEXCOORD0, 2),
-        VertexFormat::Element(VertexFormat::COLOR, 4)
-    };
-    VertexFormat vertexFormat(vertexElements, 3);
+    MaterialParameter* samplerParameter = material->getParameter(samplerUniform->getName());
+    samplerParameter->setValue(sampler);
 
     // Create the mesh batch
-    MeshBatch* meshBatch = MeshBatch::create(vertexFormat, Mesh::TRIANGLE_STRIP, material, true, initialCapacity > 0 ? initialCapacity : SPRITE_BATCH_DEFAULT_SIZE);
+    unsigned int capacity = initialCapacity > 0 ? initialCapacity : SPRITE_BATCH_DEFAULT_SIZE;
+    MeshBatch* meshBatch = MeshBatch::create(getSpriteVertexFormat(), Mesh::TRIANGLE_STRIP, material, true, capacity);
     material->release(); // don't call SAFE_RELEASE since material is used below
 
     // Create the batch
@@ -128,6 +140,8 @@ SpriteBatch* SpriteBatch::create(Texture* texture,  Effect* effect, unsigned int
     batch->_sampler = sampler;
     batch->_customEffect = customEffect;
     batch->_batch = meshBatch;
+    batch->_samplerParameter = samplerParameter;
+    batch->_pageCapacity = capacity;
     batch->_textureWidthRatio = 1.0f / (float)texture->getWidth();
     batch->_textureHeightRatio = 1.0f / (float)texture->getHeight();
 
@@ -139,9 +153,85 @@ SpriteBatch* SpriteBatch::create(Texture* texture,  Effect* effect, unsigned int
     return batch;
 }
 
+SpriteBatch* SpriteBatch::create(TextureAtlas* atlas, Effect* effect, unsigned int initialCapacity)
+{
+    GP_ASSERT(atlas);
+    if (atlas->getPageCount() == 0)
+    {
+        GP_ERROR("Failed to create sprite batch for a texture atlas without pages.");
+        return NULL;
+    }
+
+    SpriteBatch* batch = SpriteBatch::create(atlas->getPage(0), effect, initialCapacity);
+    if (batch)
+    {
+        batch->_atlas = atlas;
+        atlas->addRef();
+        batch->_pageBatches.push_back(batch->_batch);
+        batch->_pageSamplers.push_back(batch->_sampler);
+    }
+    return batch;
+}
+
 void SpriteBatch::start()
 {
     _batch->start();
+    for (size_t i = 1, count = _pageBatches.size(); i < count; ++i)
+    {
+        _pageBatches[i]->start();
+    }
+}
+
+void SpriteBatch::draw(const TextureAtlas::Region* region, const Rectangle& dst, const Vector4& color)
+{
+    GP_ASSERT(region);
+
+    static SpriteVertex v[4];
+    addSprite(dst.x, dst.y, dst.width, dst.height, region->u1, region->v1, region->u2, region->v2, color, v);
+
+    static unsigned short indices[4] = { 0, 1, 2, 3 };
+
+    getPageBatch(region->page)->add(v, 4, indices, 4);
+}
+
+void SpriteBatch::draw(const TextureAtlas::Region* region, const Rectangle& dst, const Vector4& color, const Rectangle& clip)
+{
+    GP_ASSERT(region);
+
+    // Only draw if at least part of the sprite is within the clip region.
+    float x = dst.x;
+    float y = dst.y;
+    float width = dst.width;
+    float height = dst.height;
+    float u1 = region->u1;
+    float v1 = region->v1;
+    float u2 = region->u2;
+    float v2 = region->v2;
+    if (clipSprite(clip, x, y, width, height, u1, v1, u2, v2))
+    {
+        static SpriteVertex v[4];
+        addSprite(x, y, width, height, u1, v1, u2, v2, color, v);
+
+        static unsigned short indices[4] = { 0, 1, 2, 3 };
+
+        getPageBatch(region->page)->add(v, 4, indices, 4);
+    }
+}
+
+MeshBatch* SpriteBatch::getPageBatch(unsigned int page)
+{
+    GP_ASSERT(_atlas);
+    GP_ASSERT(page < _atlas->getPageCount());
+
+    // Pages added to the atlas after the batch was created share the material of the first page.
+    while (_pageBatches.size() <= page)
+    {
+        Texture::Sampler* sampler = Texture::Sampler::create(_atlas->getPage(_pageBatches.size()));
+        MeshBatch* meshBatch = MeshBatch::create(getSpriteVertexFormat(), Mesh::TRIANGLE_STRIP, _batch->getMaterial(), true, _pageCapacity);
+        _pageSamplers.push_back(sampler);
+        _pageBatches.push_back(meshBatch);
+    }
+    return _pageBatches[page];
 }
 
 void SpriteBatch::draw(const Rectangle& dst, const Rectangle& src, const Vector4& color)
@@ -367,6 +457,22 @@ void SpriteBatch::finish()
     // Finish and draw the batch
     _batch->finish();
     _batch->draw();
+
+    // Draw the batches of the other atlas pages with their own textures.
+    for (size_t i = 1, count = _pageBatches.size(); i < count; ++i)
+    {
+        Texture::Sampler* sampler = _pageSamplers[i];
+        sampler->setWrapMode(_sampler->_wrapS, _sampler->_wrapT);
+        sampler->setFilterMode(_sampler->_minFilter, _sampler->_magFilter);
+        _samplerParameter->setValue(sampler);
+
+        _pageBatches[i]->finish();
+        _pageBatches[i]->draw();
+    }
+    if (_pageBatches.size() > 1)
+    {
+        _samplerParameter->setValue(_sampler);
+    }
 }
 
 RenderState::StateBlock* SpriteBatch::getStateBlock() const
@@ -379,6 +485,11 @@ Texture::Sampler* SpriteBatch::getSampler() const
     return _sampler;
 }
 
+TextureAtlas* SpriteBatch::getAtlas() const
+{
+    return _atlas;
+}
+
 Material* SpriteBatch::getMaterial() const
 {
     return _batch->getMaterial();
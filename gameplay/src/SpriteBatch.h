@@ -8,6 +8,7 @@
 #include "Matrix.h"
 #include "RenderState.h"
 #include "MeshBatch.h"
+#include "TextureAtlas.h"
 
 namespace gameplay
 {
@@ -21,6 +22,10 @@ namespace gameplay
  * implicit sorting to minimize state changes. Therefore, it is highly
  * recommended to combine multiple small textures into larger texture atlases
  * where possible when drawing sprites.
+ *
+ * A SpriteBatch can also be created for a TextureAtlas, in which case sprites can be
+ * drawn from any region of the atlas. The sprites are sorted by atlas page, so the batch
+ * issues a single draw call per page that is used.
  */
 class SpriteBatch
 {
@@ -83,6 +88,26 @@ public:
      */
     static SpriteBatch* create(Texture* texture, Effect* effect = NULL, unsigned int initialCapacity = 0);
 
+    /**
+     * Creates a new SpriteBatch for drawing sprites from the regions of the given texture atlas.
+     *
+     * Sprites drawn with an atlas region are added to a batch for the page of the region,
+     * so sprites from different pages do not break up the batch. When the batch is finished,
+     * the pages are drawn in order, which means that overlapping sprites from different pages
+     * are not necessarily drawn in the order they were added. Sprites drawn without a region
+     * use the first page of the atlas.
+     *
+     * The requirements on the effect are the same as for the other create methods.
+     *
+     * @param atlas The texture atlas, which must have at least one page.
+     * @param effect An optional effect to use with the SpriteBatch.
+     * @param initialCapacity An optional initial capacity of the batch of each page (number of sprites).
+     *
+     * @return A new SpriteBatch for drawing sprites from the atlas.
+     * @script{ignore}
+     */
+    static SpriteBatch* create(TextureAtlas* atlas, Effect* effect = NULL, unsigned int initialCapacity = 0);
+
     /**
      * Destructor.
      */
@@ -237,6 +262,27 @@ public:
      */
     void draw(float x, float y, float z, float width, float height, float u1, float v1, float u2, float v2, const Vector4& color, bool positionIsCenter = false);
 
+    /**
+     * Draws a single sprite from a region of the batch's texture atlas.
+     *
+     * @param region The atlas region to draw.
+     * @param dst The destination rectangle.
+     * @param color The color to tint the sprite. Use white for no tint.
+     * @script{ignore}
+     */
+    void draw(const TextureAtlas::Region* region, const Rectangle& dst, const Vector4& color = Vector4::one());
+
+    /**
+     * Draws a single sprite from a region of the batch's texture atlas, clipped within a rectangle.
+     *
+     * @param region The atlas region to draw.
+     * @param dst The destination rectangle.
+     * @param color The color to tint the sprite. Use white for no tint.
+     * @param clip The clip rectangle.
+     * @script{ignore}
+     */
+    void draw(const TextureAtlas::Region* region, const Rectangle& dst, const Vector4& color, const Rectangle& clip);
+
     /**
      * Finishes sprite drawing.
      *
@@ -250,10 +296,18 @@ public:
      *
      * This return texture sampler is used when sampling the texture in the
      * effect. This can be modified for controlling sampler setting such as
-     * filtering modes.
+     * filtering modes. For a batch created for a texture atlas, this is the sampler
+     * of the first page, and its settings are applied to the samplers of all pages.
      */
     Texture::Sampler* getSampler() const;
 
+    /**
+     * Gets the texture atlas the batch draws sprites from.
+     *
+     * @return The texture atlas, or NULL if the batch was created for a single texture.
+     */
+    TextureAtlas* getAtlas() const;
+
     /**
      * Gets the StateBlock for the SpriteBatch.
      *
@@ -371,8 +425,22 @@ private:
      */
     bool clipSprite(const Rectangle& clip, float& x, float& y, float& width, float& height, float& u1, float& v1, float& u2, float& v2);
 
+    /**
+     * Returns the batch for the specified atlas page, creating it if needed.
+     *
+     * @param page The index of the atlas page.
+     *
+     * @return The batch of the page.
+     */
+    MeshBatch* getPageBatch(unsigned int page);
+
     MeshBatch* _batch;
     Texture::Sampler* _sampler;
+    TextureAtlas* _atlas;
+    std::vector<MeshBatch*> _pageBatches;
+    std::vector<Texture::Sampler*> _pageSamplers;
+    MaterialParameter* _samplerParameter;
+    unsigned int _pageCapacity;
     bool _customEffect;
     float _textureWidthRatio;
     float _textureHeightRatio;
@@ -0,0 +1,375 @@
+#include "Base.h"
+#include "StaticBatch.h"
+#include "Node.h"
+#include "Scene.h"
+#include "Model.h"
+#include "Bundle.h"
+
+// The largest number of vertices of a batch, so that it can be indexed with 16-bit indices.
+#define STATIC_BATCH_MAX_VERTICES 65535
+
+namespace gameplay
+{
+
+/**
+ * The mesh parts merged into one batch.
+ */
+struct StaticBatch::Batch
+{
+    Batch(const VertexFormat& vertexFormat) : vertexFormat(vertexFormat), vertexCount(0), material(NULL) { }
+
+    VertexFormat vertexFormat;
+    std::vector<unsigned char> vertices;
+    std::vector<unsigned short> indices;
+    unsigned int vertexCount;
+    BoundingBox box;
+    Material* material;         // The material of the first part added, with a reference.
+};
+
+/**
+ * Determines whether the elements of a vertex format can be transformed into world space.
+ */
+static bool isTransformable(const VertexFormat& format)
+{
+    bool hasPosition = false;
+    for (unsigned int i = 0, count = format.getElementCount(); i < count; ++i)
+    {
+        const VertexFormat::Element& element = format.getElement(i);
+        switch (element.usage)
+        {
+        case VertexFormat::POSITION:
+            if (element.type != VertexFormat::FLOAT || element.size < 3)
+                return false;
+            hasPosition = true;
+            break;
+        case VertexFormat::NORMAL:
+        case VertexFormat::TANGENT:
+        case VertexFormat::BINORMAL:
+            if (!(element.type == VertexFormat::FLOAT && element.size >= 3) && element.type != VertexFormat::INT_2_10_10_10_REV)
+                return false;
+            break;
+        default:
+            break;
+        }
+    }
+    return hasPosition;
+}
+
+/**
+ * Reads a direction from a vertex element.
+ */
+static Vector3 readDirection(const unsigned char* data, const VertexFormat::Element& element)
+{
+    if (element.type == VertexFormat::FLOAT)
+    {
+        const float* v = (const float*)data;
+        return Vector3(v[0], v[1], v[2]);
+    }
+
+    // Sign extend each 10-bit component.
+    unsigned int packed;
+    memcpy(&packed, data, sizeof(packed));
+    int x = (int)(packed << 22) >> 22;
+    int y = (int)(packed << 12) >> 22;
+    int z = (int)(packed << 2) >> 22;
+    return Vector3(std::max(x / 511.0f, -1.0f), std::max(y / 511.0f, -1.0f), std::max(z / 511.0f, -1.0f));
+}
+
+/**
+ * Writes a direction to a vertex element, keeping the fourth component of packed directions.
+ */
+static void writeDirection(unsigned char* data, const VertexFormat::Element& element, const Vector3& direction)
+{
+    if (element.type == VertexFormat::FLOAT)
+    {
+        float* v = (float*)data;
+        v[0] = direction.x;
+        v[1] = direction.y;
+        v[2] = direction.z;
+        return;
+    }
+
+    unsigned int packed;
+    memcpy(&packed, data, sizeof(packed));
+    int x = (int)floorf(MATH_CLAMP(direction.x, -1.0f, 1.0f) * 511.0f + 0.5f);
+    int y = (int)floorf(MATH_CLAMP(direction.y, -1.0f, 1.0f) * 511.0f + 0.5f);
+    int z = (int)floorf(MATH_CLAMP(direction.z, -1.0f, 1.0f) * 511.0f + 0.5f);
+    packed = (packed & 0xC0000000u) | ((unsigned int)x & 0x3FFu) | (((unsigned int)y & 0x3FFu) << 10) | (((unsigned int)z & 0x3FFu) << 20);
+    memcpy(data, &packed, sizeof(packed));
+}
+
+/**
+ * Transforms a vertex into world space in place.
+ */
+static void transformVertex(unsigned char* vertex, const VertexFormat& format, const Matrix& world, const Matrix& normalMatrix, Vector3* position)
+{
+    unsigned int offset = 0;
+    for (unsigned int i = 0, count = format.getElementCount(); i < count; ++i)
+    {
+        const VertexFormat::Element& element = format.getElement(i);
+        unsigned char* data = vertex + offset;
+        switch (element.usage)
+        {
+        case VertexFormat::POSITION:
+            {
+                float* v = (float*)data;
+                position->set(v[0], v[1], v[2]);
+                world.transformPoint(position);
+                v[0] = position->x;
+                v[1] = position->y;
+                v[2] = position->z;
+            }
+            break;
+        case VertexFormat::NORMAL:
+        case VertexFormat::TANGENT:
+        case VertexFormat::BINORMAL:
+            {
+                Vector3 direction = readDirection(data, element);
+                (element.usage == VertexFormat::NORMAL ? normalMatrix : world).transformVector(&direction);
+                direction.normalize();
+                writeDirection(data, element, direction);
+            }
+            break;
+        default:
+            break;
+        }
+        offset += element.getByteSize();
+    }
+}
+
+/**
+ * Reads an index of a mesh part.
+ */
+static unsigned int readIndex(const Bundle::MeshPartData* part, unsigned int i)
+{
+    switch (part->indexFormat)
+    {
+    case Mesh::INDEX8:
+        return part->indexData[i];
+    case Mesh::INDEX16:
+        return ((const unsigned short*)part->indexData)[i];
+    default:
+        return ((const unsigned int*)part->indexData)[i];
+    }
+}
+
+StaticBatch::StaticBatch(float cellSize)
+    : _cellSize(cellSize)
+{
+}
+
+StaticBatch::~StaticBatch()
+{
+    for (size_t i = 0, count = _entries.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_entries[i].node);
+    }
+}
+
+bool StaticBatch::add(Node* node, const char* materialKey)
+{
+    GP_ASSERT(node);
+    GP_ASSERT(materialKey);
+
+    Model* model = node->getModel();
+    if (model == NULL || model->getSkin() || model->getLodCount() > 1)
+        return false;
+    Mesh* mesh = model->getMesh();
+    if (mesh == NULL || mesh->getPrimitiveType() != Mesh::TRIANGLES || strlen(mesh->getUrl()) == 0 || !isTransformable(mesh->getVertexFormat()))
+        return false;
+
+    Entry entry;
+    entry.node = node;
+    entry.materialKey = materialKey;
+    node->addRef();
+    _entries.push_back(entry);
+    return true;
+}
+
+unsigned int StaticBatch::build(Scene* scene)
+{
+    GP_ASSERT(scene);
+
+    // Meshes shared by many nodes are only read once.
+    std::map<std::string, Bundle::MeshData*> meshData;
+    std::map<std::string, Batch*> openBatches;
+    std::vector<Batch*> batches;
+    std::vector<int> remap;
+    std::vector<Node*> batchedNodes;
+
+    for (size_t i = 0, count = _entries.size(); i < count; ++i)
+    {
+        Node* node = _entries[i].node;
+        Model* model = node->getModel();
+        if (model == NULL)
+            continue;
+        Mesh* mesh = model->getMesh();
+
+        Bundle::MeshData* data;
+        std::map<std::string, Bundle::MeshData*>::iterator itr = meshData.find(mesh->getUrl());
+        if (itr != meshData.end())
+        {
+            data = itr->second;
+        }
+        else
+        {
+            data = Bundle::readMeshData(mesh->getUrl());
+            meshData[mesh->getUrl()] = data;
+        }
+        // The mesh may have been loaded with some of its vertex elements stripped.
+        if (data == NULL || !Bundle::convertMeshData(data, mesh->getVertexFormat()))
+        {
+            GP_WARN("Failed to read the vertices of mesh '%s' for static batching.", mesh->getUrl());
+            continue;
+        }
+
+        // The whole model is removed from the node, so the node is only batched if every part can be.
+        bool batchable = !data->parts.empty();
+        for (size_t p = 0, partCount = data->parts.size(); p < partCount && batchable; ++p)
+        {
+            const Bundle::MeshPartData* part = data->parts[p];
+            batchable = part->primitiveType == Mesh::TRIANGLES && model->getMaterial((int)p) != NULL &&
+                std::min(part->indexCount, data->vertexCount) <= STATIC_BATCH_MAX_VERTICES;
+        }
+        if (!batchable)
+            continue;
+
+        // The cell of the node, by the center of its bounding sphere.
+        int cell[3] = { 0, 0, 0 };
+        if (_cellSize > 0.0f)
+        {
+            const Vector3& center = node->getBoundingSphere().center;
+            cell[0] = (int)floorf(center.x / _cellSize);
+            cell[1] = (int)floorf(center.y / _cellSize);
+            cell[2] = (int)floorf(center.z / _cellSize);
+        }
+
+        const Matrix& world = node->getWorldMatrix();
+        const Matrix& normalMatrix = node->getInverseTransposeWorldMatrix();
+        unsigned int stride = data->vertexFormat.getVertexSize();
+        for (size_t p = 0, partCount = data->parts.size(); p < partCount; ++p)
+        {
+            const Bundle::MeshPartData* part = data->parts[p];
+            if (part->indexCount == 0)
+                continue;
+
+            // Parts that have their own material are only batched with the same part of other nodes.
+            Material* material = model->getMaterial((int)p);
+            int materialIndex = material == model->getMaterial() ? -1 : (int)p;
+
+            char cellKey[64];
+            sprintf(cellKey, "|%d|%d,%d,%d|", materialIndex, cell[0], cell[1], cell[2]);
+            std::string key = _entries[i].materialKey + cellKey;
+
+            // A batch that would overflow is closed and a new one started.
+            unsigned int partVertexCount = std::min(part->indexCount, data->vertexCount);
+            Batch*& batch = openBatches[key];
+            if (batch && (batch->vertexCount + partVertexCount > STATIC_BATCH_MAX_VERTICES || !(batch->vertexFormat == data->vertexFormat)))
+                batch = NULL;
+            if (batch == NULL)
+            {
+                batch = new Batch(data->vertexFormat);
+                batch->material = material;
+                material->addRef();
+                batches.push_back(batch);
+            }
+
+            remap.assign(data->vertexCount, -1);
+            for (unsigned int j = 0; j < part->indexCount; ++j)
+            {
+                unsigned int index = readIndex(part, j);
+                if (index >= data->vertexCount)
+                    index = data->vertexCount - 1;
+                if (remap[index] < 0)
+                {
+                    remap[index] = (int)batch->vertexCount++;
+                    size_t vertexOffset = batch->vertices.size();
+                    batch->vertices.insert(batch->vertices.end(), data->vertexData + index * stride, data->vertexData + (index + 1) * stride);
+
+                    Vector3 position;
+                    transformVertex(&batch->vertices[vertexOffset], data->vertexFormat, world, normalMatrix, &position);
+                    if (batch->vertexCount == 1)
+                        batch->box.set(position, position);
+                    else
+                        batch->box.merge(BoundingBox(position, position));
+                }
+                batch->indices.push_back((unsigned short)remap[index]);
+            }
+        }
+        batchedNodes.push_back(node);
+    }
+
+    for (std::map<std::string, Bundle::MeshData*>::iterator itr = meshData.begin(); itr != meshData.end(); ++itr)
+    {
+        SAFE_DELETE(itr->second);
+    }
+
+    // The models are removed before the batches are created, so the materials that are shared
+    // with them are bound to the nodes of the batches.
+    for (size_t i = 0, count = batchedNodes.size(); i < count; ++i)
+    {
+        batchedNodes[i]->setModel(NULL);
+    }
+
+    unsigned int batchCount = 0;
+    for (size_t i = 0, count = batches.size(); i < count; ++i)
+    {
+        Batch* batch = batches[i];
+        if (!batch->indices.empty())
+        {
+            Node* node = createNode(batch, batchCount++);
+            scene->addNode(node);
+            SAFE_RELEASE(node);
+        }
+        SAFE_RELEASE(batch->material);
+        SAFE_DELETE(batch);
+    }
+
+    for (size_t i = 0, count = _entries.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_entries[i].node);
+    }
+    _entries.clear();
+    return batchCount;
+}
+
+Node* StaticBatch::createNode(Batch* batch, unsigned int index)
+{
+    Mesh* mesh = Mesh::createMesh(batch->vertexFormat, batch->vertexCount, false);
+    mesh->setVertexData((const float*)&batch->vertices[0], 0, batch->vertexCount);
+    MeshPart* part = mesh->addPart(Mesh::TRIANGLES, Mesh::INDEX16, (unsigned int)batch->indices.size(), false);
+    part->setIndexData(&batch->indices[0], 0, (unsigned int)batch->indices.size());
+
+    // The bounds are in world space, since the batch is drawn with an identity transform.
+    mesh->setBoundingBox(batch->box);
+    Vector3 center = (batch->box.min + batch->box.max) * 0.5f;
+    float radiusSquared = 0.0f;
+    unsigned int stride = batch->vertexFormat.getVertexSize();
+    unsigned int positionOffset = 0;
+    for (unsigned int i = 0, count = batch->vertexFormat.getElementCount(); i < count; ++i)
+    {
+        const VertexFormat::Element& element = batch->vertexFormat.getElement(i);
+        if (element.usage == VertexFormat::POSITION)
+            break;
+        positionOffset += element.getByteSize();
+    }
+    for (unsigned int i = 0; i < batch->vertexCount; ++i)
+    {
+        const float* v = (const float*)&batch->vertices[i * stride + positionOffset];
+        radiusSquared = std::max(radiusSquared, center.distanceSquared(Vector3(v[0], v[1], v[2])));
+    }
+    mesh->setBoundingSphere(BoundingSphere(center, sqrtf(radiusSquared)));
+
+    Model* model = Model::create(mesh);
+    SAFE_RELEASE(mesh);
+    model->setMaterial(batch->material);
+
+    char id[32];
+    sprintf(id, "staticBatch%u", index);
+    Node* node = Node::create(id);
+    node->setModel(model);
+    SAFE_RELEASE(model);
+    return node;
+}
+
+}
@@ -0,0 +1,111 @@
+#ifndef STATICBATCH_H_
+#define STATICBATCH_H_
+
+#include "VertexFormat.h"
+#include "BoundingBox.h"
+
+namespace gameplay
+{
+
+class Node;
+class Scene;
+class Material;
+
+/**
+ * Defines a builder that merges the models of nodes that never move into a few large models.
+ *
+ * Level geometry is often made of thousands of small props, each drawn with its own draw
+ * call. Static batching transforms the vertices of the models of static nodes into world
+ * space and merges the mesh parts that are drawn with the same material into combined
+ * vertex and index buffers, so they are drawn with a few draw calls instead.
+ *
+ * The parts are also grouped by a grid of cells, by the center of the bounding sphere of
+ * their node, so each batch covers a limited area and batches that are out of view are
+ * still culled. Batches are limited to 65535 vertices, so they use 16-bit indices.
+ *
+ * The vertex data is read again from the bundles the meshes were loaded from, so only
+ * models whose meshes were loaded from a bundle and are drawn as indexed triangles can be
+ * batched, and every part must have a material and fewer than 65536 vertices.
+ * Skinned models and models with levels of detail are not batched. Positions must be
+ * floats; normals, tangents and binormals must be floats or 10:10:10:2 integers.
+ *
+ * The batched nodes keep their transforms and other components, but their models are
+ * removed, so moving them afterwards does not move what is drawn. SceneLoader batches the
+ * nodes marked with "static = true" in .scene files.
+ *
+ * @script{ignore}
+ */
+class StaticBatch
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param cellSize The size of the cells of the grid the batches are split by, or 0 to not split batches by position.
+     */
+    StaticBatch(float cellSize = 0.0f);
+
+    /**
+     * Destructor.
+     */
+    ~StaticBatch();
+
+    /**
+     * Adds the model of a node to be batched.
+     *
+     * Nodes are only batched with the nodes that have the same material key. Materials are
+     * compared by key rather than by object, since each node usually has its own material
+     * created from the same file, so the key should identify the materials of the node,
+     * e.g. by their URLs. Parts that have their own material are only batched with the same
+     * part of other nodes.
+     *
+     * @param node The node whose model to batch.
+     * @param materialKey The key of the materials of the node.
+     *
+     * @return true if the model can be batched, false if it is not supported.
+     */
+    bool add(Node* node, const char* materialKey);
+
+    /**
+     * Merges the models that were added and adds the batches to a scene.
+     *
+     * Each batch is a new node at the root of the scene, with an identity transform, which
+     * draws with the material of the first node batched in it. The models of the batched
+     * nodes are removed.
+     *
+     * @param scene The scene to add the batches to.
+     *
+     * @return The number of batches added.
+     */
+    unsigned int build(Scene* scene);
+
+private:
+
+    struct Batch;
+
+    /**
+     * A node to batch.
+     */
+    struct Entry
+    {
+        Node* node;
+        std::string materialKey;
+    };
+
+    StaticBatch(const StaticBatch& copy);
+
+    StaticBatch& operator=(const StaticBatch&);
+
+    /**
+     * Creates the node that draws a batch.
+     */
+    Node* createNode(Batch* batch, unsigned int index);
+
+    float _cellSize;
+    std::vector<Entry> _entries;
+};
+
+}
+
+#endif
@@ -155,6 +155,22 @@ public:
      */
     virtual bool rewind() = 0;
 
+    /**
+     * Returns a pointer to the next bytes of the stream and moves the file pointer past them.
+     *
+     * This allows streams over memory, such as memory mapped files, to be read without
+     * copying. The returned memory is read-only and remains valid until the stream is closed.
+     * The default implementation returns NULL, in which case read() must be used instead.
+     *
+     * @param size The number of bytes to read.
+     *
+     * @return A pointer to the data, or NULL if direct reads are not supported or fewer
+     *      than size bytes remain (in which case the file pointer is not moved).
+     *
+     * @see FileSystem::MAP
+     */
+    virtual const void* readDirect(size_t size) { return NULL; }
+
 protected:
     Stream() {};
 private:
@@ -0,0 +1,188 @@
+#include "Base.h"
+#include "StringId.h"
+#include "Mutex.h"
+
+// The number of strings in each block of the string list.
+#define STRING_ID_BLOCK_SIZE 1024
+
+// The maximum number of blocks of the string list, which limits the table to about a million strings.
+#define STRING_ID_MAX_BLOCKS 1024
+
+// The size of each pool the characters of the strings are copied into.
+#define STRING_ID_POOL_SIZE 16384
+
+// The initial number of slots of the hash table, which must be a power of two.
+#define STRING_ID_INITIAL_SLOTS 1024
+
+namespace gameplay
+{
+
+/**
+ * The table of interned strings.
+ *
+ * The strings are listed in blocks that are never moved, so that getString() can read them
+ * without locking: an identifier is only known after the block that holds it was written.
+ */
+struct StringIdTable
+{
+    Mutex mutex;
+    std::vector<unsigned int> slots;        // The identifiers of the strings, by hash, or 0.
+    std::vector<unsigned int> hashes;       // The hashes of the strings, by identifier - 1.
+    const char** blocks[STRING_ID_MAX_BLOCKS];
+    unsigned int count;
+    char* pool;
+    size_t poolUsed;
+
+    StringIdTable() : count(0), pool(NULL), poolUsed(STRING_ID_POOL_SIZE)
+    {
+        memset(blocks, 0, sizeof(blocks));
+        slots.resize(STRING_ID_INITIAL_SLOTS, 0);
+    }
+};
+
+static StringIdTable* __table = NULL;
+
+static StringIdTable* getTable()
+{
+    // Created on first use, since strings may be interned during static initialization.
+    // The table is never destroyed, since the strings must remain valid until exit.
+    if (__table == NULL)
+        __table = new StringIdTable();
+    return __table;
+}
+
+static unsigned int hashString(const char* str, size_t* length)
+{
+    // FNV-1a.
+    unsigned int hash = 2166136261u;
+    const char* c = str;
+    for (; *c; ++c)
+    {
+        hash ^= (unsigned char)*c;
+        hash *= 16777619u;
+    }
+    *length = (size_t)(c - str);
+    return hash;
+}
+
+static const char* getEntry(const StringIdTable* table, unsigned int id)
+{
+    unsigned int index = id - 1;
+    return table->blocks[index / STRING_ID_BLOCK_SIZE][index % STRING_ID_BLOCK_SIZE];
+}
+
+static unsigned int findSlot(const StringIdTable* table, const char* str, unsigned int hash, unsigned int* slot)
+{
+    unsigned int mask = (unsigned int)table->slots.size() - 1;
+    unsigned int i = hash & mask;
+    for (;;)
+    {
+        unsigned int id = table->slots[i];
+        if (id == 0 || (table->hashes[id - 1] == hash && strcmp(getEntry(table, id), str) == 0))
+        {
+            *slot = i;
+            return id;
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+static void growSlots(StringIdTable* table)
+{
+    std::vector<unsigned int> slots(table->slots.size() * 2, 0);
+    unsigned int mask = (unsigned int)slots.size() - 1;
+    for (unsigned int id = 1; id <= table->count; ++id)
+    {
+        unsigned int i = table->hashes[id - 1] & mask;
+        while (slots[i] != 0)
+            i = (i + 1) & mask;
+        slots[i] = id;
+    }
+    table->slots.swap(slots);
+}
+
+static const char* copyString(StringIdTable* table, const char* str, size_t length)
+{
+    size_t size = length + 1;
+    if (size > STRING_ID_POOL_SIZE / 4)
+    {
+        // Long strings get their own allocation rather than wasting the rest of a pool.
+        char* copy = new char[size];
+        memcpy(copy, str, size);
+        return copy;
+    }
+    if (table->poolUsed + size > STRING_ID_POOL_SIZE)
+    {
+        table->pool = new char[STRING_ID_POOL_SIZE];
+        table->poolUsed = 0;
+    }
+    char* copy = table->pool + table->poolUsed;
+    memcpy(copy, str, size);
+    table->poolUsed += size;
+    return copy;
+}
+
+unsigned int StringId::intern(const char* str)
+{
+    if (str == NULL || *str == '\0')
+        return 0;
+
+    size_t length;
+    unsigned int hash = hashString(str, &length);
+
+    StringIdTable* table = getTable();
+    table->mutex.lock();
+
+    unsigned int slot;
+    unsigned int id = findSlot(table, str, hash, &slot);
+    if (id == 0)
+    {
+        unsigned int index = table->count;
+        unsigned int block = index / STRING_ID_BLOCK_SIZE;
+        if (block >= STRING_ID_MAX_BLOCKS)
+        {
+            table->mutex.unlock();
+            GP_ERROR("Failed to intern string '%s'; the string table is full.", str);
+            return 0;
+        }
+        if (table->blocks[block] == NULL)
+            table->blocks[block] = new const char*[STRING_ID_BLOCK_SIZE];
+
+        table->blocks[block][index % STRING_ID_BLOCK_SIZE] = copyString(table, str, length);
+        table->hashes.push_back(hash);
+        id = ++table->count;
+        table->slots[slot] = id;
+
+        // Keep the table at most half full so that probe sequences stay short.
+        if (table->count * 2 > table->slots.size())
+            growSlots(table);
+    }
+
+    table->mutex.unlock();
+    return id;
+}
+
+unsigned int StringId::find(const char* str)
+{
+    if (str == NULL || *str == '\0')
+        return 0;
+
+    size_t length;
+    unsigned int hash = hashString(str, &length);
+
+    StringIdTable* table = getTable();
+    ScopedLock lock(table->mutex);
+    unsigned int slot;
+    return findSlot(table, str, hash, &slot);
+}
+
+const char* StringId::getString(unsigned int id)
+{
+    if (id == 0)
+        return "";
+
+    GP_ASSERT(__table && id <= __table->count);
+    return getEntry(__table, id);
+}
+
+}
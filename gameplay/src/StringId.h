@@ -0,0 +1,67 @@
+#ifndef STRINGID_H_
+#define STRINGID_H_
+
+namespace gameplay
+{
+
+/**
+ * Defines a global table of interned strings, which identifies each distinct string by an
+ * integer.
+ *
+ * Interning a string returns the same non-zero integer for every string with the same
+ * characters, so interned strings are compared by comparing their integers. The characters
+ * of each distinct string are stored once, and stay valid until the program exits, which
+ * is what Node IDs and tags, Properties namespaces and material parameter names use to
+ * avoid a string allocation per object.
+ *
+ * Strings are never removed from the table, so only names, rather than arbitrary data,
+ * should be interned. The table can be used from any thread.
+ *
+ * @script{ignore}
+ */
+class StringId
+{
+public:
+
+    /**
+     * Returns the integer that identifies a string, adding the string to the table if it is
+     * not there yet.
+     *
+     * @param str The string to intern.
+     *
+     * @return The identifier of the string, or 0 for NULL and the empty string.
+     */
+    static unsigned int intern(const char* str);
+
+    /**
+     * Returns the integer that identifies a string, without adding the string to the table.
+     *
+     * This is used to look up strings that objects were interned with: a string that is not
+     * in the table cannot match any of them.
+     *
+     * @param str The string to look up.
+     *
+     * @return The identifier of the string, or 0 if it has not been interned.
+     */
+    static unsigned int find(const char* str);
+
+    /**
+     * Returns the characters of an interned string.
+     *
+     * @param id The identifier of the string.
+     *
+     * @return The string, which remains valid until the program exits, or the empty string for 0.
+     */
+    static const char* getString(unsigned int id);
+
+private:
+
+    /**
+     * Hidden constructor.
+     */
+    StringId();
+};
+
+}
+
+#endif
@@ -1,7 +1,10 @@
 #include "Base.h"
+#include "GPUProfiler.h"
+#include "RenderStats.h"
 #include "Terrain.h"
 #include "TerrainPatch.h"
 #include "Node.h"
+#include "Scene.h"
 #include "FileSystem.h"
 
 namespace gameplay
@@ -20,10 +23,16 @@ namespace gameplay
 //
 #define DEFAULT_TERRAIN_HEIGHT_RATIO 0.3f
 
+// The maximum number of layers of a terrain with a splat map: the base
+// layer and one layer for each channel of the splat map.
+//
+#define MAX_SPLAT_LAYERS 5
+
 // Terrain dirty flag bits
 #define TERRAIN_DIRTY_WORLD_MATRIX 1
 #define TERRAIN_DIRTY_INV_WORLD_MATRIX 2
 #define TERRAIN_DIRTY_NORMAL_MATRIX 4
+#define TERRAIN_DIRTY_PATCH_BOUNDS 8
 
 /**
  * @script{ignore}
@@ -32,7 +41,8 @@ float getDefaultHeight(unsigned int width, unsigned int height);
 
 Terrain::Terrain() :
     _heightfield(NULL), _node(NULL), _normalMap(NULL), _flags(FRUSTUM_CULLING | LEVEL_OF_DETAIL),
-    _dirtyFlags(TERRAIN_DIRTY_WORLD_MATRIX | TERRAIN_DIRTY_INV_WORLD_MATRIX | TERRAIN_DIRTY_NORMAL_MATRIX)
+    _dirtyFlags(TERRAIN_DIRTY_WORLD_MATRIX | TERRAIN_DIRTY_INV_WORLD_MATRIX | TERRAIN_DIRTY_NORMAL_MATRIX | TERRAIN_DIRTY_PATCH_BOUNDS),
+    _splatMap(NULL), _columnCount(0), _visibilityTestCount(0)
 {
 }
 
@@ -49,6 +59,8 @@ Terrain::~Terrain()
         _node->removeListener(this);
 
     SAFE_RELEASE(_normalMap);
+    clearSplatLayers();
+    SAFE_RELEASE(_splatMap);
     SAFE_RELEASE(_heightfield);
 }
 
@@ -111,7 +123,7 @@ Terrain* Terrain::create(const char* path, Properties* properties)
                 // Read normalized height values from heightmap image
                 heightfield = HeightField::createFromImage(heightmap.c_str(), 0, 1);
             }
-            else if (ext == ".RAW" || ext == ".R16")
+            else if (ext == ".RAW" || ext == ".R16" || ext == ".R32")
             {
                 // Require additional properties to be specified for RAW files
                 Vector2 imageSize;
@@ -153,7 +165,7 @@ Terrain* Terrain::create(const char* path, Properties* properties)
                 // Read normalized height values from heightmap image
                 heightfield = HeightField::createFromImage(heightmap.c_str(), 0, 1);
             }
-            else if (ext == ".RAW" || ext == ".R16")
+            else if (ext == ".RAW" || ext == ".R16" || ext == ".R32")
             {
                 GP_WARN("RAW heightmaps must be specified inside a heightmap block with width and height properties.");
                 if (!externalProperties)
@@ -263,31 +275,81 @@ Terrain* Terrain::create(HeightField* heightfield, const Vector3& scale, unsigne
     float halfHeight = (height - 1) * 0.5f;
     unsigned int maxStep = (unsigned int)std::pow(2.0, (double)(detailLevels-1));
 
+    // The heights of a mapped heightfield are converted one patch at a time, into a block that
+    // includes the heights around the patch that the normals of its coarsest level are computed from.
+    const bool mapped = heightfield->isMapped();
+    std::vector<float> block;
+    TerrainPatch::Heights heights;
+    heights.block = mapped ? NULL : heightfield->getArray();
+    heights.x = heights.z = 0;
+    heights.stride = width;
+    heights.width = width;
+    heights.height = height;
+
     // Create terrain patches
     unsigned int x1, x2, z1, z2;
-    unsigned int row = 0, column = 0;
+    unsigned int row = 0, column = 0, columnCount = 0;
     for (unsigned int z = 0; z < height-1; z = z2, ++row)
     {
         z1 = z;
         z2 = std::min(z1 + patchSize, height-1);
 
+        column = 0;
         for (unsigned int x = 0; x < width-1; x = x2, ++column)
         {
             x1 = x;
             x2 = std::min(x1 + patchSize, width-1);
 
+            if (mapped)
+            {
+                heights.x = x1 > maxStep ? x1 - maxStep : 0;
+                heights.z = z1 > maxStep ? z1 - maxStep : 0;
+                heights.stride = std::min(x2 + maxStep, width-1) - heights.x + 1;
+                unsigned int blockRows = std::min(z2 + maxStep, height-1) - heights.z + 1;
+                block.resize(heights.stride * blockRows);
+                heightfield->getBlock(heights.x, heights.z, heights.stride, blockRows, &block[0]);
+                heights.block = &block[0];
+            }
+
             // Create this patch
-            TerrainPatch* patch = TerrainPatch::create(terrain, row, column, heightfield->getArray(), width, height, x1, z1, x2, z2, -halfWidth, -halfHeight, maxStep, skirtScale);
+            TerrainPatch* patch = TerrainPatch::create(terrain, row, column, heights, x1, z1, x2, z2, -halfWidth, -halfHeight, maxStep, skirtScale);
             terrain->_patches.push_back(patch);
 
             // Append the new patch's local bounds to the terrain local bounds
             bounds.merge(patch->getBoundingBox(false));
         }
+        columnCount = column;
+    }
+    terrain->_columnCount = columnCount;
+
+    // Build a quadtree over the patches, so that whole regions of them can be culled at once
+    if (row > 0 && columnCount > 0)
+        terrain->buildQuadTree(0, row, 0, columnCount);
+
+    // Link the patches to their neighbours, which their edges are stitched to
+    for (size_t i = 0, count = terrain->_patches.size(); i < count; ++i)
+    {
+        TerrainPatch* patch = terrain->_patches[i];
+        if (patch->_column > 0)
+            patch->_neighbors[TerrainPatch::EDGE_X1] = terrain->_patches[i - 1];
+        if (patch->_column + 1 < columnCount)
+            patch->_neighbors[TerrainPatch::EDGE_X2] = terrain->_patches[i + 1];
+        if (patch->_row > 0)
+            patch->_neighbors[TerrainPatch::EDGE_Z1] = terrain->_patches[i - columnCount];
+        if (i + columnCount < count)
+            patch->_neighbors[TerrainPatch::EDGE_Z2] = terrain->_patches[i + columnCount];
     }
 
     // Read additional layer information from properties (if specified)
     if (properties)
     {
+        // Layers are blended with a splat map instead of blend maps if there is one
+        std::string splatMap;
+        if (properties->getPath("splatMap", &splatMap) && !terrain->setSplatMap(splatMap.c_str()))
+        {
+            GP_WARN("Failed to load terrain splat map: %s", splatMap.c_str());
+        }
+
         // Parse terrain layers
         Properties* lp;
         int index = -1;
@@ -377,7 +439,7 @@ void Terrain::setNode(Node* node)
         if (_node)
             _node->addListener(this);
 
-        _dirtyFlags |= TERRAIN_DIRTY_WORLD_MATRIX | TERRAIN_DIRTY_INV_WORLD_MATRIX | TERRAIN_DIRTY_NORMAL_MATRIX;
+        _dirtyFlags |= TERRAIN_DIRTY_WORLD_MATRIX | TERRAIN_DIRTY_INV_WORLD_MATRIX | TERRAIN_DIRTY_NORMAL_MATRIX | TERRAIN_DIRTY_PATCH_BOUNDS;
     }
 }
 
@@ -386,6 +448,13 @@ bool Terrain::setLayer(int index, const char* texturePath, const Vector2& textur
     if (!texturePath)
         return false;
 
+    if (_splatMap)
+    {
+        if (row != -1 || column != -1)
+            GP_WARN("Layers of terrains with a splat map always apply to the entire terrain: %s", texturePath);
+        return setSplatLayer(index, texturePath, textureRepeat);
+    }
+
     // Set layer on applicable patches
     bool result = true;
     for (size_t i = 0, count = _patches.size(); i < count; ++i)
@@ -402,6 +471,88 @@ bool Terrain::setLayer(int index, const char* texturePath, const Vector2& textur
     return result;
 }
 
+bool Terrain::setSplatMap(const char* path)
+{
+    Texture::Sampler* splatMap = NULL;
+    if (path)
+    {
+        Texture* texture = Texture::create(path, true);
+        if (!texture)
+            return false;
+        splatMap = Texture::Sampler::create(texture);
+        texture->release();
+        splatMap->setWrapMode(Texture::CLAMP, Texture::CLAMP);
+        splatMap->setFilterMode(Texture::LINEAR_MIPMAP_LINEAR, Texture::LINEAR);
+    }
+
+    // The layers of the patches and of the terrain are blended differently, so drop both.
+    for (size_t i = 0, count = _patches.size(); i < count; ++i)
+    {
+        _patches[i]->clearLayers();
+    }
+    clearSplatLayers();
+
+    SAFE_RELEASE(_splatMap);
+    _splatMap = splatMap;
+
+    return true;
+}
+
+bool Terrain::setSplatLayer(int index, const char* texturePath, const Vector2& textureRepeat)
+{
+    // Find where the layer goes among the layers ordered by index, replacing any layer with the same index.
+    size_t position = 0;
+    while (position < _splatLayerIndices.size() && _splatLayerIndices[position] < index)
+        ++position;
+    bool replace = position < _splatLayerIndices.size() && _splatLayerIndices[position] == index;
+    if (!replace && _splatLayerIndices.size() >= MAX_SPLAT_LAYERS)
+    {
+        GP_WARN("Terrains with a splat map support at most %d layers: %s", MAX_SPLAT_LAYERS, texturePath);
+        return false;
+    }
+
+    Texture* texture = Texture::create(texturePath, true);
+    if (!texture)
+        return false;
+    Texture::Sampler* sampler = Texture::Sampler::create(texture);
+    texture->release();
+    sampler->setWrapMode(Texture::REPEAT, Texture::REPEAT);
+    sampler->setFilterMode(Texture::LINEAR_MIPMAP_LINEAR, Texture::LINEAR);
+
+    if (replace)
+    {
+        SAFE_RELEASE(_splatSamplers[position]);
+        _splatSamplers[position] = sampler;
+        _splatRepeats[position] = textureRepeat;
+    }
+    else
+    {
+        _splatLayerIndices.insert(_splatLayerIndices.begin() + position, index);
+        _splatSamplers.insert(_splatSamplers.begin() + position, sampler);
+        _splatRepeats.insert(_splatRepeats.begin() + position, textureRepeat);
+    }
+
+    // The materials of all patches refer to the layer arrays.
+    for (size_t i = 0, count = _patches.size(); i < count; ++i)
+        _patches[i]->_materialDirty = true;
+
+    return true;
+}
+
+void Terrain::clearSplatLayers()
+{
+    for (size_t i = 0, count = _splatSamplers.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_splatSamplers[i]);
+    }
+    _splatSamplers.clear();
+    _splatRepeats.clear();
+    _splatLayerIndices.clear();
+
+    for (size_t i = 0, count = _patches.size(); i < count; ++i)
+        _patches[i]->_materialDirty = true;
+}
+
 Node* Terrain::getNode() const
 {
     return _node;
@@ -448,13 +599,18 @@ unsigned int Terrain::getPatchCount() const
 
 unsigned int Terrain::getVisiblePatchCount() const
 {
-    unsigned int visibleCount = 0;
-    for (size_t i = 0, count = _patches.size(); i < count; ++i)
-    {
-        if (_patches[i]->isVisible())
-            ++visibleCount;
-    }
-    return visibleCount;
+    Scene* scene = _node ? _node->getScene() : NULL;
+    Camera* camera = scene ? scene->getActiveCamera() : NULL;
+    if (!camera)
+        return 0;
+
+    cullPatches(camera);
+    return _visiblePatches.size();
+}
+
+unsigned int Terrain::getVisibilityTestCount() const
+{
+    return _visibilityTestCount;
 }
 
 unsigned int Terrain::getTriangleCount() const
@@ -509,17 +665,214 @@ float Terrain::getHeight(float x, float z) const
     return height;
 }
 
+void Terrain::getHeights(const Vector3* positions, unsigned int count, float* heights, Vector3* normals) const
+{
+    GP_ASSERT(positions || count == 0);
+    GP_ASSERT(heights || count == 0);
+
+    const float offsetX = (_heightfield->getColumnCount() - 1) * 0.5f;
+    const float offsetZ = (_heightfield->getRowCount() - 1) * 0.5f;
+    const Matrix& inverseWorld = getInverseWorldMatrix();
+    Vector3 worldScale;
+    getWorldMatrix().getScale(&worldScale);
+
+    // The positions are transformed and sampled in fixed size blocks, to keep the scratch on the stack.
+    const unsigned int BLOCK_SIZE = 64;
+    Vector3 local[BLOCK_SIZE];
+    float columns[BLOCK_SIZE];
+    float rows[BLOCK_SIZE];
+    for (unsigned int start = 0; start < count; start += BLOCK_SIZE)
+    {
+        const unsigned int blockCount = std::min(BLOCK_SIZE, count - start);
+        for (unsigned int i = 0; i < blockCount; ++i)
+            local[i].set(positions[start + i].x, 0.0f, positions[start + i].z);
+        inverseWorld.transformVectors(local, local, blockCount);
+        for (unsigned int i = 0; i < blockCount; ++i)
+        {
+            columns[i] = local[i].x + offsetX;
+            rows[i] = local[i].z + offsetZ;
+        }
+
+        float* blockHeights = heights + start;
+        Vector3* blockNormals = normals ? normals + start : NULL;
+        _heightfield->getHeights(columns, rows, blockCount, blockHeights, blockNormals);
+        for (unsigned int i = 0; i < blockCount; ++i)
+            blockHeights[i] *= worldScale.y;
+
+        if (blockNormals)
+        {
+            // The heightfield normals are in the local space of the terrain.
+            getNormalMatrix().transformVectors(blockNormals, blockNormals, blockCount);
+            for (unsigned int i = 0; i < blockCount; ++i)
+                blockNormals[i].normalize();
+        }
+    }
+}
+
 void Terrain::draw(bool wireframe)
 {
+    GP_GPU_PROFILE("terrain");
+
+    Scene* scene = _node ? _node->getScene() : NULL;
+    Camera* camera = scene ? scene->getActiveCamera() : NULL;
+    if (!camera)
+        return;
+
+    updateLOD(camera);
+
+    cullPatches(camera);
+    RenderStats::add(RenderStats::TERRAIN_PATCHES, _visiblePatches.size());
+    for (size_t i = 0, count = _visiblePatches.size(); i < count; ++i)
+    {
+        _visiblePatches[i]->draw(wireframe);
+    }
+}
+
+unsigned int Terrain::buildQuadTree(unsigned int row1, unsigned int row2, unsigned int column1, unsigned int column2)
+{
+    GP_ASSERT(row1 < row2 && column1 < column2);
+
+    unsigned int index = _quadTree.size();
+    _quadTree.push_back(QuadTreeNode());
+    QuadTreeNode& node = _quadTree.back();
+    node.row1 = row1;
+    node.row2 = row2;
+    node.column1 = column1;
+    node.column2 = column2;
+    for (unsigned int i = 0; i < 4; ++i)
+        node.children[i] = 0;
+
+    if (row2 - row1 == 1 && column2 - column1 == 1)
+    {
+        _quadTree[index].bounds = _patches[row1 * _columnCount + column1]->getBoundingBox(false);
+        return index;
+    }
+
+    // Split the region in half along each side that is longer than one patch. The root is node
+    // zero, so a child index of zero means there is no child.
+    unsigned int rowSplit = row2 - row1 > 1 ? (row1 + row2) / 2 : row2;
+    unsigned int columnSplit = column2 - column1 > 1 ? (column1 + column2) / 2 : column2;
+    unsigned int rows[3] = { row1, rowSplit, row2 };
+    unsigned int columns[3] = { column1, columnSplit, column2 };
+    BoundingBox bounds;
+    unsigned int childCount = 0;
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+        for (unsigned int j = 0; j < 2; ++j)
+        {
+            if (rows[i] == rows[i + 1] || columns[j] == columns[j + 1])
+                continue;
+
+            // Children are added after the node, so it must be looked up again afterwards.
+            unsigned int child = buildQuadTree(rows[i], rows[i + 1], columns[j], columns[j + 1]);
+            bounds.merge(_quadTree[child].bounds);
+            _quadTree[index].children[childCount++] = child;
+        }
+    }
+    _quadTree[index].bounds = bounds;
+
+    return index;
+}
+
+void Terrain::cullPatches(Camera* camera) const
+{
+    GP_ASSERT(camera);
+
+    _visiblePatches.clear();
+    _visibilityTestCount = 0;
+    if (_quadTree.empty())
+        return;
+
+    // Patch bounds are kept in world space, and only transformed again when the node moves.
+    if (_dirtyFlags & TERRAIN_DIRTY_PATCH_BOUNDS)
+    {
+        _dirtyFlags &= ~TERRAIN_DIRTY_PATCH_BOUNDS;
+        for (size_t i = 0, count = _quadTree.size(); i < count; ++i)
+        {
+            const QuadTreeNode& node = _quadTree[i];
+            node.worldBounds = node.bounds;
+            if (_node)
+                node.worldBounds.transform(_node->getWorldMatrix());
+        }
+    }
+
+    cullQuadTree(0, camera->getFrustum(), (_flags & FRUSTUM_CULLING) == 0);
+}
+
+void Terrain::cullQuadTree(unsigned int index, const Frustum& frustum, bool inside) const
+{
+    const QuadTreeNode& node = _quadTree[index];
+
+    if (!inside)
+    {
+        // Cull the node if it is behind any plane of the frustum, and stop testing its children
+        // if it is in front of all of them.
+        const Plane* planes[6] = { &frustum.getNear(), &frustum.getFar(), &frustum.getLeft(),
+                                   &frustum.getRight(), &frustum.getBottom(), &frustum.getTop() };
+        ++_visibilityTestCount;
+        inside = true;
+        for (unsigned int i = 0; i < 6; ++i)
+        {
+            float side = node.worldBounds.intersects(*planes[i]);
+            if (side == Plane::INTERSECTS_BACK)
+                return;
+            if (side != Plane::INTERSECTS_FRONT)
+                inside = false;
+        }
+    }
+
+    // Leaves hold a single patch.
+    if (node.children[0] == 0)
+    {
+        _visiblePatches.push_back(_patches[node.row1 * _columnCount + node.column1]);
+        return;
+    }
+
+    for (unsigned int i = 0; i < 4 && node.children[i] != 0; ++i)
+    {
+        cullQuadTree(node.children[i], frustum, inside);
+    }
+}
+
+void Terrain::updateLOD(Camera* camera)
+{
+    for (size_t i = 0, count = _patches.size(); i < count; ++i)
+    {
+        _patches[i]->updateLOD(camera);
+    }
+
+    // The edges of neighbouring patches can only be stitched when their levels differ by one
+    // at most, so refine patches that are coarser than that until none are. Refined patches
+    // are morphed fully towards their coarser level, which they would otherwise be drawn at.
+    bool refined = true;
+    while (refined)
+    {
+        refined = false;
+        for (size_t i = 0, count = _patches.size(); i < count; ++i)
+        {
+            TerrainPatch* patch = _patches[i];
+            for (unsigned int j = 0; j < TerrainPatch::EDGE_COUNT; ++j)
+            {
+                TerrainPatch* neighbor = patch->_neighbors[j];
+                if (neighbor && patch->_lod > neighbor->_lod + 1)
+                {
+                    patch->_lod = neighbor->_lod + 1;
+                    patch->_morph = 1.0f;
+                    refined = true;
+                }
+            }
+        }
+    }
+
     for (size_t i = 0, count = _patches.size(); i < count; ++i)
     {
-        _patches[i]->draw(wireframe);
+        _patches[i]->updateEdges();
     }
 }
 
 void Terrain::transformChanged(Transform* transform, long cookie)
 {
-    _dirtyFlags |= TERRAIN_DIRTY_WORLD_MATRIX | TERRAIN_DIRTY_INV_WORLD_MATRIX | TERRAIN_DIRTY_NORMAL_MATRIX;
+    _dirtyFlags |= TERRAIN_DIRTY_WORLD_MATRIX | TERRAIN_DIRTY_INV_WORLD_MATRIX | TERRAIN_DIRTY_NORMAL_MATRIX | TERRAIN_DIRTY_PATCH_BOUNDS;
 }
 
 void Terrain::addListener(Terrain::Listener* listener)
@@ -24,8 +24,10 @@ class TerrainPatch;
  * 2. 24-bit high precision heightmap image (PNG), which can be generated from a mesh using
  *    gameplay-encoder.
  * 3. 8-bit or 16-bit RAW heightmap image using PC byte ordering (little endian), which is
- *    compatible with many external tools such as World Machine, Unity and more. The file
- *    extension must be either .raw or .r16 for RAW files.
+ *    compatible with many external tools such as World Machine, Unity and more, or a RAW
+ *    heightmap of 32-bit floats from 0 to 1. The file extension must be .raw, .r16 or .r32
+ *    for RAW files. RAW files are mapped into memory where possible, and their heights
+ *    converted one patch at a time as the terrain is built.
  *
  * Physics/collision is supported by setting a rigid body collision object on the Node that
  * the terrain is attached to. The collision shape should be specified using
@@ -40,7 +42,9 @@ class TerrainPatch;
  * of supported layers depends on the target hardware, although typically 2-3 levels is
  * sufficient. Multiple blend maps for different layers can be packed into different channels
  * of a single texture for more efficient texture utilization. Levels can be applied across
- * the entire terrain, or in more complex cases, for individual patches only.
+ * the entire terrain, or in more complex cases, for individual patches only. Alternatively,
+ * up to five layers can be blended with a single splat map that spans the entire terrain,
+ * so that all patches share the same shader and textures (see setSplatMap).
  *
  * Surface lighting is achieved with either vertex normals or with a normal map. If a
  * normal map is used, it should be an object-space normal map containing normal vectors for
@@ -62,11 +66,12 @@ class TerrainPatch;
  * A distance-to-camera based test, using a simple screen-space error metric is used to decide
  * the appropriate LOD for a terrain patch. The number of LOD levels is 1 by default (which
  * means only the base level is used), but can be specified via the detailLevels property.
- * Using too large a number for detailLevels can result in excessive popping in the distance
- * for very hilly terrains, so a smaller number (2-3) often works best in these cases.
+ * Patches are morphed towards the next level in the vertex shader as they approach it
+ * (geomorphing), so levels change without popping. Neighbouring patches differ by one level
+ * at most, and the edges of the finer patch are stitched to the coarser one.
  *
- * Finally, when LOD is enabled, cracks can begin to appear between terrain patches of
- * different LOD levels. If the cracks are only minor (depends on your terrain topology
+ * Finally, when LOD is enabled, small cracks (T-junctions) can still appear between terrain
+ * patches of different LOD levels. If the cracks are only minor (depends on your terrain topology
  * and tetures used), an acceptable appraoch might be to simply use a background clear 
  * color that closely matches your terrain to make the cracks much less visible. However,
  * often that is not acceptable, so the Terrain class also supports a simple solution called
@@ -83,6 +88,7 @@ class Terrain : public Ref, public Transform::Listener
     friend class TerrainPatch;
     friend class PhysicsController;
     friend class PhysicsRigidBody;
+    friend class TiledTerrain;
 
 public:
 
@@ -110,6 +116,9 @@ public:
           * This flag enables or disables level of detail, however it does nothing if
           * "detailLevels" was not set to a value greater than 1 in the terrain
           * properties file at creation time.
+          *
+          * Patches morph smoothly between levels, and the edges of patches are stitched
+          * to neighbouring patches of a coarser level, so that no popping or cracks occur.
           */
          LEVEL_OF_DETAIL = 8
     };
@@ -230,6 +239,25 @@ public:
                   const char* blendPath = NULL, int blendChannel = 0, 
                   int row = -1, int column = -1);
 
+    /**
+     * Sets a splat map, which blends the layers of the entire terrain in a single pass.
+     *
+     * The red, green, blue and alpha channels of the splat map are the blend weights of the
+     * second to fifth layers, in order of their indexes, over the layers below them. The layers
+     * are then shared by all patches, so every patch uses the same shader and textures regardless
+     * of the number of layers, rather than selecting its own samplers and blend maps. Layers set
+     * afterwards always apply to the entire terrain, and their blend maps are ignored.
+     *
+     * Setting or clearing the splat map removes all layers.
+     *
+     * @param path Path to the splat map, or NULL to blend layers with blend maps.
+     *
+     * @return True if the splat map was set, false if it could not be loaded.
+     *
+     * @script{ignore}
+     */
+    bool setSplatMap(const char* path);
+
     /**
      * Returns the node that this terrain is bound to.
      *
@@ -271,6 +299,17 @@ public:
      */
     unsigned int getVisiblePatchCount() const;
 
+    /**
+     * Returns the number of frustum tests made to find the visible patches, the last time the
+     * terrain was drawn or getVisiblePatchCount() was called.
+     *
+     * Patches are culled with a quadtree, so regions of patches that are entirely inside or
+     * outside the view frustum take a single test. Should be used for debug purposes only.
+     *
+     * @return The number of frustum tests.
+     */
+    unsigned int getVisibilityTestCount() const;
+
     /**
      * Returns the total number of triangles for this terrain at the base LOD.
      *
@@ -307,6 +346,24 @@ public:
      */
     float getHeight(float x, float z) const;
 
+    /**
+     * Returns the world-space heights of the terrain at a number of positions on the X,Z
+     * plane, as getHeight() returns the height at one position, and optionally the normals of
+     * the terrain at the positions.
+     *
+     * The matrices and the scale of the terrain are read once for the whole batch, and the
+     * positions are transformed to the heightfield together, so vehicles, foliage placement
+     * and AI should query the terrain with this method rather than calling getHeight() for
+     * each position.
+     *
+     * @param positions The positions, in world space. Their Y coordinates are ignored.
+     * @param count The number of positions.
+     * @param heights Destination array of count heights.
+     * @param normals Optional destination array of count unit normals, in world space.
+     * @script{ignore}
+     */
+    void getHeights(const Vector3* positions, unsigned int count, float* heights, Vector3* normals = NULL) const;
+
     /**
      * Draws the terrain.
      *
@@ -374,11 +431,60 @@ public:
 
 private:
 
+    /**
+     * A node of the quadtree over the patches, which covers a region of rows and columns of them.
+     */
+    struct QuadTreeNode
+    {
+        unsigned int row1;
+        unsigned int row2;
+        unsigned int column1;
+        unsigned int column2;
+        unsigned int children[4];
+        BoundingBox bounds;
+        mutable BoundingBox worldBounds;
+    };
+
     /**
      * Constructor.
      */
     Terrain();
 
+    /**
+     * Selects the level of detail of every patch, and how their edges are stitched, from
+     * the viewpoint of the specified camera.
+     */
+    void updateLOD(Camera* camera);
+
+    /**
+     * Builds the quadtree node for the specified region of patches and its children.
+     *
+     * @return The index of the node.
+     */
+    unsigned int buildQuadTree(unsigned int row1, unsigned int row2, unsigned int column1, unsigned int column2);
+
+    /**
+     * Finds the patches that are visible from the specified camera.
+     */
+    void cullPatches(Camera* camera) const;
+
+    /**
+     * Adds the visible patches of a quadtree node to the visible patches.
+     *
+     * @param inside Whether the node is known to be inside the frustum.
+     */
+    void cullQuadTree(unsigned int index, const Frustum& frustum, bool inside) const;
+
+    /**
+     * Sets a layer of a terrain with a splat map.
+     */
+    bool setSplatLayer(int index, const char* texturePath, const Vector2& textureRepeat);
+
+    /**
+     * Removes the layers of a terrain with a splat map.
+     */
+    void clearSplatLayers();
+
     /**
      * Hidden copy constructor.
      */
@@ -414,6 +520,10 @@ private:
     std::vector<TerrainPatch*> _patches;
     Vector3 _localScale;
     Texture::Sampler* _normalMap;
+    Texture::Sampler* _splatMap;
+    std::vector<Texture::Sampler*> _splatSamplers;
+    std::vector<Vector2> _splatRepeats;
+    std::vector<int> _splatLayerIndices;
     unsigned int _flags;
     mutable Matrix _worldMatrix;
     mutable Matrix _inverseWorldMatrix;
@@ -421,6 +531,10 @@ private:
     mutable unsigned int _dirtyFlags;
     BoundingBox _boundingBox;
     std::vector<Terrain::Listener*> _listeners;
+    unsigned int _columnCount;
+    std::vector<QuadTreeNode> _quadTree;
+    mutable std::vector<TerrainPatch*> _visiblePatches;
+    mutable unsigned int _visibilityTestCount;
 };
 
 }
@@ -15,16 +15,143 @@ namespace gameplay
 /**
  * @script{ignore}
  */
-float calculateHeight(float* heights, unsigned int width, unsigned int height, unsigned int x, unsigned int z);
+float calculateHeight(const TerrainPatch::Heights& heights, unsigned int x, unsigned int z);
 
 /**
  * @script{ignore}
  */
 template <class T> T clamp(T value, T min, T max) { return value < min ? min : (value > max ? max : value); }
 
+/**
+ * Returns the height that a vertex of a level with the specified step has at the next coarser
+ * level, where the vertex lies in (or on the edge of) one of the coarser level's triangles.
+ */
+static float calculateMorphHeight(const TerrainPatch::Heights& heights,
+    unsigned int x1, unsigned int z1, unsigned int x2, unsigned int z2,
+    unsigned int x, unsigned int z, unsigned int step)
+{
+    // Find the cell of the coarser level that contains the vertex.
+    const unsigned int coarseStep = step * 2;
+    unsigned int xl = x == x2 ? x2 : x1 + ((x - x1) / coarseStep) * coarseStep;
+    unsigned int zl = z == z2 ? z2 : z1 + ((z - z1) / coarseStep) * coarseStep;
+    unsigned int xh = std::min(xl + coarseStep, x2);
+    unsigned int zh = std::min(zl + coarseStep, z2);
+    float u = xh > xl ? (float)(x - xl) / (xh - xl) : 0.0f;
+    float v = zh > zl ? (float)(z - zl) / (zh - zl) : 0.0f;
+
+    // Cells are split along the diagonal from (xh, zl) to (xl, zh).
+    if (u + v <= 1.0f)
+    {
+        float h00 = calculateHeight(heights, xl, zl);
+        return h00 + u * (calculateHeight(heights, xh, zl) - h00) + v * (calculateHeight(heights, xl, zh) - h00);
+    }
+    float h11 = calculateHeight(heights, xh, zh);
+    return h11 + (1.0f - u) * (calculateHeight(heights, xl, zh) - h11) + (1.0f - v) * (calculateHeight(heights, xh, zl) - h11);
+}
+
+/**
+ * Encodes a unit normal with an octahedral mapping around the y axis, as two 16-bit values.
+ */
+static void encodeNormal(const Vector3& normal, short* encoded)
+{
+    float sum = fabs(normal.x) + fabs(normal.y) + fabs(normal.z);
+    float u = normal.x / sum;
+    float v = normal.z / sum;
+    if (normal.y < 0.0f)
+    {
+        // Fold the lower hemisphere over the diagonals of the octahedron.
+        float foldedU = (1.0f - fabs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+        v = (1.0f - fabs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+        u = foldedU;
+    }
+    encoded[0] = (short)(u * SHRT_MAX + (u >= 0.0f ? 0.5f : -0.5f));
+    encoded[1] = (short)(v * SHRT_MAX + (v >= 0.0f ? 0.5f : -0.5f));
+}
+
+/**
+ * Adds a triangle between vertices of a patch grid, facing up.
+ */
+static void addTriangle(std::vector<unsigned short>* indices, unsigned int gridWidth,
+    unsigned int ax, unsigned int az, unsigned int bx, unsigned int bz, unsigned int cx, unsigned int cz)
+{
+    // Triangles are front facing when they wind counter-clockwise seen from above.
+    float y = ((float)bz - az) * ((float)cx - ax) - ((float)bx - ax) * ((float)cz - az);
+    if (y < 0.0f)
+    {
+        std::swap(bx, cx);
+        std::swap(bz, cz);
+    }
+    indices->push_back((unsigned short)(az * gridWidth + ax));
+    indices->push_back((unsigned short)(bz * gridWidth + bx));
+    indices->push_back((unsigned short)(cz * gridWidth + cx));
+}
+
+/**
+ * Adds the two triangles of a cell of a patch grid.
+ */
+static void addCell(std::vector<unsigned short>* indices, unsigned int gridWidth, unsigned int x, unsigned int z)
+{
+    addTriangle(indices, gridWidth, x, z, x, z + 1, x + 1, z);
+    addTriangle(indices, gridWidth, x + 1, z, x, z + 1, x + 1, z + 1);
+}
+
+/**
+ * Adds a triangle between vertices of a patch grid that are given by their position along
+ * an edge and the row or column they are in.
+ */
+static void addEdgeTriangle(std::vector<unsigned short>* indices, unsigned int gridWidth, bool alongZ,
+    unsigned int a, unsigned int aLine, unsigned int b, unsigned int bLine, unsigned int c, unsigned int cLine)
+{
+    if (alongZ)
+        addTriangle(indices, gridWidth, aLine, a, bLine, b, cLine, c);
+    else
+        addTriangle(indices, gridWidth, a, aLine, b, bLine, c, cLine);
+}
+
+/**
+ * Adds the triangles of a row or column of cells along an edge of a patch grid, skipping
+ * the vertices of the edge that a neighbour of the next coarser level does not have.
+ *
+ * @param alongZ Whether the edge is a column (true) or a row (false) of the grid.
+ * @param edgeLine The column or row of the edge vertices.
+ * @param innerLine The column or row of the vertices next to the edge.
+ * @param from The first vertex along the edge.
+ * @param to The last vertex along the edge.
+ * @param coords The heightfield coordinates of the vertices along the edge.
+ */
+static void addStitchedEdge(std::vector<unsigned short>* indices, unsigned int gridWidth, bool alongZ,
+    unsigned int edgeLine, unsigned int innerLine, unsigned int from, unsigned int to,
+    const std::vector<unsigned int>& coords, unsigned int c1, unsigned int c2, unsigned int step)
+{
+    const unsigned int coarseStep = step * 2;
+    for (unsigned int a = from; a < to; )
+    {
+        // Find the next edge vertex that the coarser level has as well.
+        unsigned int b = a + 1;
+        while (b < to && (coords[b] - c1) % coarseStep != 0 && coords[b] != c2)
+            ++b;
+
+        // Fan the edge vertices at both ends of the span to the inner vertices.
+        unsigned int mid = (a + b) / 2;
+        for (unsigned int i = a; i < mid; ++i)
+        {
+            addEdgeTriangle(indices, gridWidth, alongZ, a, edgeLine, i, innerLine, i + 1, innerLine);
+        }
+        addEdgeTriangle(indices, gridWidth, alongZ, a, edgeLine, mid, innerLine, b, edgeLine);
+        for (unsigned int i = mid; i < b; ++i)
+        {
+            addEdgeTriangle(indices, gridWidth, alongZ, b, edgeLine, i, innerLine, i + 1, innerLine);
+        }
+
+        a = b;
+    }
+}
+
 TerrainPatch::TerrainPatch() :
-    _terrain(NULL), _row(0), _column(0), _materialDirty(true)
+    _terrain(NULL), _row(0), _column(0), _materialDirty(true), _lod(0), _morph(0.0f), _stitchedEdges(0)
 {
+    for (unsigned int i = 0; i < EDGE_COUNT; ++i)
+        _neighbors[i] = NULL;
 }
 
 TerrainPatch::~TerrainPatch()
@@ -45,7 +172,7 @@ TerrainPatch::~TerrainPatch()
 
 TerrainPatch* TerrainPatch::create(Terrain* terrain,
     unsigned int row, unsigned int column,
-    float* heights, unsigned int width, unsigned int height,
+    const Heights& heights,
     unsigned int x1, unsigned int z1, unsigned int x2, unsigned int z2,
     float xOffset, float zOffset,
     unsigned int maxStep, float verticalSkirtSize)
@@ -55,11 +182,12 @@ TerrainPatch* TerrainPatch::create(Terrain* terrain,
     patch->_terrain = terrain;
     patch->_row = row;
     patch->_column = column;
+    patch->_grid.set(xOffset, zOffset, 1.0f / heights.width, 1.0f / heights.height);
 
     // Add patch lods
     for (unsigned int step = 1; step <= maxStep; step *= 2)
     {
-        patch->addLOD(heights, width, height, x1, z1, x2, z2, xOffset, zOffset, step, verticalSkirtSize);
+        patch->addLOD(heights, x1, z1, x2, z2, xOffset, zOffset, step, verticalSkirtSize);
     }
 
     // Set our bounding box using the base LOD mesh
@@ -77,11 +205,14 @@ TerrainPatch* TerrainPatch::create(Terrain* terrain,
     return patch;
 }
 
-void TerrainPatch::addLOD(float* heights, unsigned int width, unsigned int height,
+void TerrainPatch::addLOD(const Heights& heights,
     unsigned int x1, unsigned int z1, unsigned int x2, unsigned int z2,
     float xOffset, float zOffset,
     unsigned int step, float verticalSkirtSize)
 {
+    const unsigned int width = heights.width;
+    const unsigned int height = heights.height;
+
     // Allocate vertex data for this patch
     unsigned int patchWidth;
     unsigned int patchHeight;
@@ -105,56 +236,79 @@ void TerrainPatch::addLOD(float* heights, unsigned int width, unsigned int heigh
         patchHeight += 2;
     }
 
+    // Vertices are compact and expanded by the vertex shader. They hold the grid position of
+    // the vertex, which its texture coordinates are derived from, its height and the height
+    // it morphs to at the next coarser level quantized to the height range of the level, its
+    // normal encoded in two values and the edge of the patch that it lies on.
+    GP_ASSERT(width <= USHRT_MAX + 1 && height <= USHRT_MAX + 1);
     unsigned int vertexCount = patchHeight * patchWidth;
-    unsigned int vertexElements = _terrain->_normalMap ? 5 : 8; //<x,y,z>[i,j,k]<u,v>
-    float* vertices = new float[vertexCount * vertexElements];
+    unsigned int vertexSize = _terrain->_normalMap ? 12 : 16; //<x,y,z,m>[i,j]<x1,x2,z1,z2>
+    unsigned char* vertices = new unsigned char[vertexCount * vertexSize];
+    std::vector<float> vertexHeights(vertexCount * 2);
+    float heightMin = FLT_MAX;
+    float heightMax = -FLT_MAX;
     unsigned int index = 0;
     Vector3 min(FLT_MAX, FLT_MAX, FLT_MAX);
     Vector3 max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
     bool zskirt = verticalSkirtSize > 0 ? true : false;
+    std::vector<unsigned int> columnX;
+    std::vector<unsigned int> rowZ;
     for (unsigned int z = z1; ; )
     {
+        rowZ.push_back(z);
         bool xskirt = verticalSkirtSize > 0 ? true : false;
         for (unsigned int x = x1; ; )
         {
             GP_ASSERT(index < vertexCount);
+            if (rowZ.size() == 1)
+                columnX.push_back(x);
 
-            float* v = vertices + (index * vertexElements);
+            unsigned char* v = vertices + (index * vertexSize);
+            float* h = &vertexHeights[index * 2];
             index++;
 
-            // Compute position
-            v[0] = x + xOffset;
-            v[1] = calculateHeight(heights, width, height, x, z);
+            // Compute position, and the height the vertex is moved to when morphing to the
+            // next coarser level. The heights are quantized once the range of the level is known.
+            unsigned short* position = (unsigned short*)v;
+            position[0] = (unsigned short)x;
+            position[2] = (unsigned short)z;
+            h[0] = calculateHeight(heights, x, z);
+            h[1] = calculateMorphHeight(heights, x1, z1, x2, z2, x, z, step);
             if (xskirt || zskirt)
-                v[1] -= verticalSkirtSize;
-            v[2] = z + zOffset;
+            {
+                h[0] -= verticalSkirtSize;
+                h[1] -= verticalSkirtSize;
+            }
+            heightMin = std::min(heightMin, std::min(h[0], h[1]));
+            heightMax = std::max(heightMax, std::max(h[0], h[1]));
 
             // Update bounding box min/max (don't include vertical skirt vertices in bounding box)
             if (!(xskirt || zskirt))
             {
-                if (v[0] < min.x)
-                    min.x = v[0];
-                if (v[1] < min.y)
-                    min.y = v[1];
-                if (v[2] < min.z)
-                    min.z = v[2];
-                if (v[0] > max.x)
-                    max.x = v[0];
-                if (v[1] > max.y)
-                    max.y = v[1];
-                if (v[2] > max.z)
-                    max.z = v[2];
+                Vector3 p(x + xOffset, h[0], z + zOffset);
+                if (p.x < min.x)
+                    min.x = p.x;
+                if (p.y < min.y)
+                    min.y = p.y;
+                if (p.z < min.z)
+                    min.z = p.z;
+                if (p.x > max.x)
+                    max.x = p.x;
+                if (p.y > max.y)
+                    max.y = p.y;
+                if (p.z > max.z)
+                    max.z = p.z;
             }
-            v += 3;
+            v += 8;
 
             // Compute normal
             if (!_terrain->_normalMap)
             {
-                Vector3 p(x, calculateHeight(heights, width, height, x, z), z);
-                Vector3 w(Vector3(x>=step ? x-step : x, calculateHeight(heights, width, height, x>=step ? x-step : x, z), z), p);
-                Vector3 e(Vector3(x<width-step ? x+step : x, calculateHeight(heights, width, height, x<width-step ? x+step : x, z), z), p);
-                Vector3 s(Vector3(x, calculateHeight(heights, width, height, x, z>=step ? z-step : z), z>=step ? z-step : z), p);
-                Vector3 n(Vector3(x, calculateHeight(heights, width, height, x, z<height-step ? z+step : z), z<height-step ? z+step : z), p);
+                Vector3 p(x, calculateHeight(heights, x, z), z);
+                Vector3 w(Vector3(x>=step ? x-step : x, calculateHeight(heights, x>=step ? x-step : x, z), z), p);
+                Vector3 e(Vector3(x<width-step ? x+step : x, calculateHeight(heights, x<width-step ? x+step : x, z), z), p);
+                Vector3 s(Vector3(x, calculateHeight(heights, x, z>=step ? z-step : z), z>=step ? z-step : z), p);
+                Vector3 n(Vector3(x, calculateHeight(heights, x, z<height-step ? z+step : z), z<height-step ? z+step : z), p);
                 Vector3 normals[4];
                 Vector3::cross(n, w, &normals[0]);
                 Vector3::cross(w, s, &normals[1]);
@@ -162,25 +316,15 @@ void TerrainPatch::addLOD(float* heights, unsigned int width, unsigned int heigh
                 Vector3::cross(s, e, &normals[3]);
                 Vector3 normal = -(normals[0] + normals[1] + normals[2] + normals[3]);
                 normal.normalize();
-                v[0] = normal.x;
-                v[1] = normal.y;
-                v[2] = normal.z;
-                v += 3;
+                encodeNormal(normal, (short*)v);
+                v += 4;
             }
 
-            // Compute texture coord
-            v[0] = (float)x / width;
-            v[1] = 1.0f - (float)z / height;
-            if (xskirt)
-            {
-                float offset = verticalSkirtSize / width;
-                v[0] = x == x1 ? v[0]-offset : v[0]+offset;
-            }
-            else if (zskirt)
-            {
-                float offset = verticalSkirtSize / height;
-                v[1] = z == z1 ? v[1]-offset : v[1]+offset;
-            }
+            // Compute the edge of the patch the vertex lies on (if any)
+            v[0] = x == x1 ? 255 : 0;
+            v[1] = x != x1 && x == x2 ? 255 : 0;
+            v[2] = x != x1 && x != x2 && z == z1 ? 255 : 0;
+            v[3] = x != x1 && x != x2 && z != z1 && z == z2 ? 255 : 0;
 
             if (x == x2)
             {
@@ -217,99 +361,111 @@ void TerrainPatch::addLOD(float* heights, unsigned int width, unsigned int heigh
     }
     GP_ASSERT(index == vertexCount);
 
+    // Quantize the heights to the height range of the level
+    float heightStep = (heightMax - heightMin) / USHRT_MAX;
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        unsigned short* position = (unsigned short*)(vertices + (i * vertexSize));
+        const float* h = &vertexHeights[i * 2];
+        position[1] = heightStep > 0.0f ? (unsigned short)((h[0] - heightMin) / heightStep + 0.5f) : 0;
+        position[3] = heightStep > 0.0f ? (unsigned short)((h[1] - heightMin) / heightStep + 0.5f) : 0;
+    }
+
     Vector3 center(min + ((max - min) * 0.5f));
 
     // Create mesh
     VertexFormat::Element elements[3];
-    elements[0] = VertexFormat::Element(VertexFormat::POSITION, 3);
-    if (_terrain->_normalMap)
-    {
-        elements[1] = VertexFormat::Element(VertexFormat::TEXCOORD0, 2);
-    }
-    else
-    {
-        elements[1] = VertexFormat::Element(VertexFormat::NORMAL, 3);
-        elements[2] = VertexFormat::Element(VertexFormat::TEXCOORD0, 2);
-    }
-    VertexFormat format(elements, _terrain->_normalMap ? 2 : 3);
+    unsigned int elementCount = 0;
+    elements[elementCount++] = VertexFormat::Element(VertexFormat::POSITION, 4, VertexFormat::UNSIGNED_SHORT, false);
+    if (!_terrain->_normalMap)
+        elements[elementCount++] = VertexFormat::Element(VertexFormat::NORMAL, 2, VertexFormat::SHORT, true);
+    elements[elementCount++] = VertexFormat::Element(VertexFormat::TEXCOORD2, 4, VertexFormat::UNSIGNED_BYTE, true);
+    VertexFormat format(elements, elementCount);
+    GP_ASSERT(format.getVertexSize() == vertexSize);
     Mesh* mesh = Mesh::createMesh(format, vertexCount);
-    mesh->setVertexData(vertices);
+    mesh->setVertexData((const float*)vertices);
     mesh->setBoundingBox(BoundingBox(min, max));
     mesh->setBoundingSphere(BoundingSphere(center, center.distance(max)));
 
-    // Add mesh part for indices
-    unsigned int indexCount =
-        (patchWidth * 2) *      // # indices per row of tris
-        (patchHeight - 1) +     // # rows of tris
-        (patchHeight-2) * 2;    // # degenerate tris
-
-    // Support a maximum number of indices of USHRT_MAX. Any more indices we will require breaking up the
+    // Index values are limited to USHRT_MAX. Any more vertices will require breaking up the
     // terrain into smaller patches.
-    if (indexCount > USHRT_MAX)
+    if (vertexCount > USHRT_MAX + 1)
     {
-        GP_WARN("Index count of %d for terrain patch exceeds the limit of 65535. Please specifiy a smaller patch size.", indexCount);
-        GP_ASSERT(indexCount <= USHRT_MAX);
+        GP_WARN("Vertex count of %d for terrain patch exceeds the limit of 65536. Please specifiy a smaller patch size.", vertexCount);
+        GP_ASSERT(vertexCount <= USHRT_MAX + 1);
     }
 
-    MeshPart* part = mesh->addPart(Mesh::TRIANGLE_STRIP, Mesh::INDEX16, indexCount);
-    unsigned short* indices = new unsigned short[indexCount];
-    index = 0;
-    for (unsigned int z = 0; z < patchHeight-1; ++z)
+    // Split the cells into the interior and the four edges of the patch. The cells along the
+    // real (non-skirt) edge rows and columns are triangulated twice: to match a neighbour
+    // of the same level, and stitched to a neighbour of the next coarser level. The corner
+    // cells belong to the x edges.
+    std::vector<unsigned short> indices[PART_COUNT];
+    const unsigned int skirt = verticalSkirtSize > 0.0f ? 1 : 0;
+    const unsigned int firstColumn = skirt;
+    const unsigned int lastColumn = patchWidth - 2 - skirt;
+    const unsigned int firstRow = skirt;
+    const unsigned int lastRow = patchHeight - 2 - skirt;
+    for (unsigned int z = 0; z < patchHeight - 1; ++z)
     {
-        unsigned int i1 = z * patchWidth;
-        unsigned int i2 = (z+1) * patchWidth;
-
-        // Move left to right for even rows and right to left for odd rows.
-        // Note that this results in two degenerate triangles between rows
-        // for stitching purposes, but actually does not require any extra
-        // indices to achieve this.
-        if (z % 2 == 0)
+        for (unsigned int x = 0; x < patchWidth - 1; ++x)
         {
-            if (z > 0)
+            bool edgeCell;
+            unsigned int part;
+            if (x <= firstColumn)
             {
-                // Add degenerate indices to connect strips
-                indices[index] = indices[index-1];
-                ++index;
-                indices[index++] = i1;
+                part = PART_EDGE + EDGE_X1;
+                edgeCell = x == firstColumn && z >= firstRow && z <= lastRow;
             }
-
-            // Add row strip
-            for (unsigned int x = 0; x < patchWidth; ++x)
+            else if (x >= lastColumn)
             {
-                indices[index++] = i1 + x;
-                indices[index++] = i2 + x;
+                part = PART_EDGE + EDGE_X2;
+                edgeCell = x == lastColumn && z >= firstRow && z <= lastRow;
             }
-        }
-        else
-        {
-            // Add degenerate indices to connect strips
-            if (z > 0)
+            else if (z <= firstRow)
             {
-                indices[index] = indices[index-1];
-                ++index;
-                indices[index++] = i2 + ((int)patchWidth-1);
+                part = PART_EDGE + EDGE_Z1;
+                edgeCell = z == firstRow;
             }
-
-            // Add row strip
-            for (int x = (int)patchWidth-1; x >= 0; --x)
+            else if (z >= lastRow)
             {
-                indices[index++] = i2 + x;
-                indices[index++] = i1 + x;
+                part = PART_EDGE + EDGE_Z2;
+                edgeCell = z == lastRow;
             }
+            else
+            {
+                addCell(&indices[PART_INTERIOR], patchWidth, x, z);
+                continue;
+            }
+
+            addCell(&indices[part], patchWidth, x, z);
+            if (!edgeCell)
+                addCell(&indices[part + EDGE_COUNT], patchWidth, x, z);
         }
     }
-    GP_ASSERT(index == indexCount);
-    part->setIndexData(indices, 0, indexCount);
+    addStitchedEdge(&indices[PART_STITCHED_EDGE + EDGE_X1], patchWidth, true, firstColumn, firstColumn + 1, firstRow, lastRow + 1, rowZ, z1, z2, step);
+    addStitchedEdge(&indices[PART_STITCHED_EDGE + EDGE_X2], patchWidth, true, lastColumn + 1, lastColumn, firstRow, lastRow + 1, rowZ, z1, z2, step);
+    addStitchedEdge(&indices[PART_STITCHED_EDGE + EDGE_Z1], patchWidth, false, firstRow, firstRow + 1, firstColumn + 1, lastColumn, columnX, x1, x2, step);
+    addStitchedEdge(&indices[PART_STITCHED_EDGE + EDGE_Z2], patchWidth, false, lastRow + 1, lastRow, firstColumn + 1, lastColumn, columnX, x1, x2, step);
+
+    Level* level = new Level();
+    level->heightRange.set(heightMin, heightStep);
+    for (unsigned int i = 0; i < PART_COUNT; ++i)
+    {
+        if (indices[i].empty())
+            continue;
+
+        MeshPart* part = mesh->addPart(Mesh::TRIANGLES, Mesh::INDEX16, (unsigned int)indices[i].size());
+        part->setIndexData(&indices[i][0], 0, (unsigned int)indices[i].size());
+        level->parts[i] = part;
+    }
 
     SAFE_DELETE_ARRAY(vertices);
-    SAFE_DELETE_ARRAY(indices);
 
     // Create model
     Model* model = Model::create(mesh);
     mesh->release();
 
     // Add this level
-    Level* level = new Level();
     level->model = model;
     _levels.push_back(level);
 }
@@ -347,9 +503,6 @@ void TerrainPatch::deleteLayer(Layer* layer)
 
 int TerrainPatch::addSampler(const char* path)
 {
-    // TODO: Support shared samplers stored in Terrain class for layers that span all patches
-    // on the terrain (row == col == -1).
-
     // Load the texture. If this texture is already loaded, it will return
     // a pointer to the same one, with its ref count incremented.
     Texture* texture = Texture::create(path, true);
@@ -431,6 +584,15 @@ bool TerrainPatch::setLayer(int index, const char* texturePath, const Vector2& t
     return true;
 }
 
+void TerrainPatch::clearLayers()
+{
+    while (_layers.size() > 0)
+    {
+        deleteLayer(*_layers.begin());
+    }
+    _materialDirty = true;
+}
+
 bool TerrainPatch::updateMaterial()
 {
     if (!_materialDirty)
@@ -440,38 +602,20 @@ bool TerrainPatch::updateMaterial()
 
     for (size_t i = 0, count = _levels.size(); i < count; ++i)
     {
-        // Build preprocessor string to pass to shader.
-        // NOTE: I make heavy use of preprocessor definitions, rather than passing in arrays and doing
-        // non-constant array access in the shader. This is due to the fact that non-constant array access
-        // in GLES is very slow on some GLES 2.x hardware.
+        // Build preprocessor string to pass to shader. Terrains with a splat map share their
+        // layers between all patches, so only the number of layers changes the shader.
         std::ostringstream defines;
-        defines << "LAYER_COUNT " << _layers.size();
-        defines << ";SAMPLER_COUNT " << _samplers.size();
-        if (_terrain->isFlagSet(Terrain::DEBUG_PATCHES))
-            defines << ";DEBUG_PATCHES";
-        if (_terrain->_normalMap)
-            defines << ";NORMAL_MAP";
-
-        // Append texture and blend index constants to preprocessor definition.
-        // We need to do this since older versions of GLSL only allow sampler arrays
-        // to be indexed using constant expressions (otherwise we could simply pass an
-        // array of indices to use for sampler lookup).
-        //
-        // Rebuild layer lists while we're at it.
-        //
-        int layerIndex = 0;
-        for (std::set<Layer*, LayerCompare>::iterator itr = _layers.begin(); itr != _layers.end(); ++itr, ++layerIndex)
+        if (_terrain->_splatMap)
         {
-            Layer* layer = *itr;
-
-            defines << ";TEXTURE_INDEX_" << layerIndex << " " << layer->textureIndex;
-            defines << ";TEXTURE_REPEAT_" << layerIndex << " vec2(" << layer->textureRepeat.x << "," << layer->textureRepeat.y << ")";
-
-            if (layerIndex > 0)
-            {
-                defines << ";BLEND_INDEX_" << layerIndex << " " << layer->blendIndex;
-                defines << ";BLEND_CHANNEL_" << layerIndex << " " << layer->blendChannel;
-            }
+            defines << "SPLAT_MAP;LAYER_COUNT " << _terrain->_splatSamplers.size();
+            if (_terrain->isFlagSet(Terrain::DEBUG_PATCHES))
+                defines << ";DEBUG_PATCHES";
+            if (_terrain->_normalMap)
+                defines << ";NORMAL_MAP";
+        }
+        else
+        {
+            buildLayerDefines(defines);
         }
 
         Material* material = Material::create(TERRAIN_VSH, TERRAIN_FSH, defines.str().c_str());
@@ -489,8 +633,24 @@ bool TerrainPatch::updateMaterial()
         material->getParameter("u_ambientColor")->bindValue(this, &TerrainPatch::getAmbientColor);
         material->getParameter("u_lightColor")->bindValue(this, &TerrainPatch::getLightColor);
         material->getParameter("u_lightDirection")->bindValue(this, &TerrainPatch::getLightDirection);
-        if (_layers.size() > 0)
+        material->getParameter("u_morph")->bindValue(this, &TerrainPatch::getMorph);
+        material->getParameter("u_edgeMorph")->bindValue(this, &TerrainPatch::getEdgeMorph);
+        material->getParameter("u_grid")->setValue(_grid);
+        material->getParameter("u_heightRange")->setValue(_levels[i]->heightRange);
+        if (_terrain->_splatMap)
+        {
+            unsigned int layerCount = (unsigned int)_terrain->_splatSamplers.size();
+            if (layerCount > 0)
+            {
+                material->getParameter("u_splatMap")->setValue(_terrain->_splatMap);
+                material->getParameter("u_layerSamplers")->setValue((const Texture::Sampler**)&_terrain->_splatSamplers[0], layerCount);
+                material->getParameter("u_layerRepeats")->setValue(&_terrain->_splatRepeats[0], layerCount);
+            }
+        }
+        else if (_layers.size() > 0)
+        {
             material->getParameter("u_samplers")->setValue((const Texture::Sampler**)&_samplers[0], (unsigned int)_samplers.size());
+        }
 
         if (_terrain->isFlagSet(Terrain::DEBUG_PATCHES))
         {
@@ -513,6 +673,38 @@ bool TerrainPatch::updateMaterial()
     return true;
 }
 
+void TerrainPatch::buildLayerDefines(std::ostringstream& defines) const
+{
+    // NOTE: I make heavy use of preprocessor definitions, rather than passing in arrays and doing
+    // non-constant array access in the shader. This is due to the fact that non-constant array access
+    // in GLES is very slow on some GLES 2.x hardware.
+    defines << "LAYER_COUNT " << _layers.size();
+    defines << ";SAMPLER_COUNT " << _samplers.size();
+    if (_terrain->isFlagSet(Terrain::DEBUG_PATCHES))
+        defines << ";DEBUG_PATCHES";
+    if (_terrain->_normalMap)
+        defines << ";NORMAL_MAP";
+
+    // Append texture and blend index constants to preprocessor definition.
+    // We need to do this since older versions of GLSL only allow sampler arrays
+    // to be indexed using constant expressions (otherwise we could simply pass an
+    // array of indices to use for sampler lookup).
+    int layerIndex = 0;
+    for (std::set<Layer*, LayerCompare>::const_iterator itr = _layers.begin(); itr != _layers.end(); ++itr, ++layerIndex)
+    {
+        Layer* layer = *itr;
+
+        defines << ";TEXTURE_INDEX_" << layerIndex << " " << layer->textureIndex;
+        defines << ";TEXTURE_REPEAT_" << layerIndex << " vec2(" << layer->textureRepeat.x << "," << layer->textureRepeat.y << ")";
+
+        if (layerIndex > 0)
+        {
+            defines << ";BLEND_INDEX_" << layerIndex << " " << layer->blendIndex;
+            defines << ";BLEND_CHANNEL_" << layerIndex << " " << layer->blendChannel;
+        }
+    }
+}
+
 void TerrainPatch::draw(bool wireframe)
 {
     Scene* scene = _terrain->_node ? _terrain->_node->getScene() : NULL;
@@ -520,21 +712,73 @@ void TerrainPatch::draw(bool wireframe)
     if (!camera)
         return;
 
-    // Get our world-space bounding box
-    BoundingBox bounds = getBoundingBox(true);
-
-    // If the box does not intersect the view frustum, cull it
-    if (_terrain->isFlagSet(Terrain::FRUSTUM_CULLING) && !camera->getFrustum().intersects(bounds))
-        return;
-
+    // Patches outside the view frustum are culled by the terrain.
     if (!updateMaterial())
         return;
 
-    // Compute the LOD level from the camera's perspective
-    size_t lod = computeLOD(camera, bounds);
+    // Draw the interior of the current LOD, and each edge either matching its neighbour
+    // or stitched to its coarser neighbour.
+    Level* level = _levels[std::min(_lod, _levels.size() - 1)];
+    MeshPart* parts[1 + EDGE_COUNT];
+    parts[0] = level->parts[PART_INTERIOR];
+    for (unsigned int i = 0; i < EDGE_COUNT; ++i)
+    {
+        parts[1 + i] = level->parts[(_stitchedEdges & (1 << i)) ? PART_STITCHED_EDGE + i : PART_EDGE + i];
+    }
 
-    // Draw the model for the current LOD
-    _levels[lod]->model->draw(wireframe);
+    Model* model = level->model;
+    Material* material = model->getMaterial();
+    GP_ASSERT(material);
+    Technique* technique = material->getTechnique();
+    GP_ASSERT(technique);
+    for (unsigned int i = 0, passCount = technique->getPassCount(); i < passCount; ++i)
+    {
+        Pass* pass = technique->getPassByIndex(i);
+        GP_ASSERT(pass);
+        pass->bind();
+        for (unsigned int j = 0; j < 1 + EDGE_COUNT; ++j)
+        {
+            if (parts[j])
+                model->drawPart(parts[j], wireframe);
+        }
+        pass->unbind();
+    }
+}
+
+void TerrainPatch::updateLOD(Camera* camera)
+{
+    _lod = computeLOD(camera, getBoundingBox(true), &_morph);
+}
+
+void TerrainPatch::updateEdges()
+{
+    // Both patches along an edge morph its vertices by the same amount. Where the levels
+    // differ, the finer patch morphs its edge fully towards the coarser level and skips
+    // the edge vertices the coarser patch does not have, while the coarser one does not morph it.
+    float edgeMorph[EDGE_COUNT];
+    _stitchedEdges = 0;
+    for (unsigned int i = 0; i < EDGE_COUNT; ++i)
+    {
+        TerrainPatch* neighbor = _neighbors[i];
+        if (neighbor == NULL)
+        {
+            edgeMorph[i] = _morph;
+        }
+        else if (neighbor->_lod > _lod)
+        {
+            edgeMorph[i] = 1.0f;
+            _stitchedEdges |= (1 << i);
+        }
+        else if (neighbor->_lod < _lod)
+        {
+            edgeMorph[i] = 0.0f;
+        }
+        else
+        {
+            edgeMorph[i] = std::max(_morph, neighbor->_morph);
+        }
+    }
+    _edgeMorph.set(edgeMorph[EDGE_X1], edgeMorph[EDGE_X2], edgeMorph[EDGE_Z1], edgeMorph[EDGE_Z2]);
 }
 
 bool TerrainPatch::isVisible() const
@@ -554,8 +798,21 @@ bool TerrainPatch::isVisible() const
 
 unsigned int TerrainPatch::getTriangleCount() const
 {
-    // Patches are made up of a single mesh part using triangle strips
-    return _levels[0]->model->getMesh()->getPart(0)->getIndexCount() - 2;
+    return getTriangleCount(0, 0);
+}
+
+unsigned int TerrainPatch::getTriangleCount(size_t lod, unsigned int stitchedEdges) const
+{
+    // Levels are made up of the triangle lists of their interior and edges
+    const Level* level = _levels[lod];
+    unsigned int indexCount = level->parts[PART_INTERIOR] ? level->parts[PART_INTERIOR]->getIndexCount() : 0;
+    for (unsigned int i = 0; i < EDGE_COUNT; ++i)
+    {
+        const MeshPart* part = level->parts[(stitchedEdges & (1 << i)) ? PART_STITCHED_EDGE + i : PART_EDGE + i];
+        if (part)
+            indexCount += part->getIndexCount();
+    }
+    return indexCount / 3;
 }
 
 unsigned int TerrainPatch::getVisibleTriangleCount() const
@@ -573,9 +830,10 @@ unsigned int TerrainPatch::getVisibleTriangleCount() const
             return 0;
     }
 
-    // Return the triangle count of the LOD level depending on the camera
+    // Return the triangle count of the LOD level depending on the camera, with the edges
+    // stitched as they were when the terrain was last drawn.
     size_t lod = computeLOD(camera, bounds);
-    return _levels[lod]->model->getMesh()->getPart(0)->getIndexCount() - 2;
+    return getTriangleCount(lod, lod == _lod ? _stitchedEdges : 0);
 }
 
 BoundingBox TerrainPatch::getBoundingBox(bool worldSpace) const
@@ -620,8 +878,21 @@ const Vector3& TerrainPatch::getLightDirection() const
     return scene->getLightDirection();
 }
 
-size_t TerrainPatch::computeLOD(Camera* camera, const BoundingBox& worldBounds) const
+float TerrainPatch::getMorph() const
+{
+    return _morph;
+}
+
+const Vector4& TerrainPatch::getEdgeMorph() const
 {
+    return _edgeMorph;
+}
+
+size_t TerrainPatch::computeLOD(Camera* camera, const BoundingBox& worldBounds, float* morph) const
+{
+    if (morph)
+        *morph = 0.0f;
+
     if (!_terrain->isFlagSet(Terrain::LEVEL_OF_DETAIL) || _levels.size() == 0)
         return 0; // base level
 
@@ -651,17 +922,21 @@ size_t TerrainPatch::computeLOD(Camera* camera, const BoundingBox& worldBounds)
     float screenArea = game->getWidth() * game->getHeight() / 10.0f;
     float error = screenArea / area;
 
-    // Level LOD based on distance from camera
+    // Level LOD based on distance from camera. The fraction of the error is how far the
+    // patch is morphed towards the next level, so the levels blend into each other.
     size_t maxLod = _levels.size()-1;
+    if (!(area > 0.0f) || error >= (float)maxLod)
+        return maxLod;
     size_t lod = (size_t)error;
-    lod = std::max(lod, (size_t)0);
-    lod = std::min(lod, maxLod);
+    if (morph)
+        *morph = error - (float)lod;
     return lod;
 }
 
-float calculateHeight(float* heights, unsigned int width, unsigned int height, unsigned int x, unsigned int z)
+float calculateHeight(const TerrainPatch::Heights& heights, unsigned int x, unsigned int z)
 {
-    return heights[z * width + x];
+    GP_ASSERT(x >= heights.x && z >= heights.z);
+    return heights.block[(z - heights.z) * heights.stride + (x - heights.x)];
 }
 
 TerrainPatch::Layer::Layer() :
@@ -675,6 +950,8 @@ TerrainPatch::Layer::~Layer()
 
 TerrainPatch::Level::Level() : model(NULL)
 {
+    for (unsigned int i = 0; i < PART_COUNT; ++i)
+        parts[i] = NULL;
 }
 
 bool TerrainPatch::LayerCompare::operator() (const Layer* lhs, const Layer* rhs) const
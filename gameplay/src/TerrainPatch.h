@@ -20,6 +20,22 @@ class TerrainPatch
 {
     friend class Terrain;
 
+public:
+
+    /**
+     * A block of the heights of a heightfield, which holds the heights that a patch is
+     * created from, so that the heights of mapped heightfields are converted per patch.
+     */
+    struct Heights
+    {
+        const float* block;         // The heights of the block, in row major order.
+        unsigned int x;             // The first column of the block.
+        unsigned int z;             // The first row of the block.
+        unsigned int stride;        // The number of columns of the block.
+        unsigned int width;         // The number of columns of the heightfield.
+        unsigned int height;        // The number of rows of the heightfield.
+    };
+
 private:
 
     struct Layer
@@ -38,9 +54,36 @@ private:
         int blendChannel;
     };
 
+    /**
+     * The edges of a patch.
+     */
+    enum Edge
+    {
+        EDGE_X1 = 0,
+        EDGE_X2 = 1,
+        EDGE_Z1 = 2,
+        EDGE_Z2 = 3,
+        EDGE_COUNT = 4
+    };
+
+    /**
+     * The mesh parts of a level. The cells along each edge have two parts: one that
+     * matches a neighbour of the same level, and one that is stitched to a neighbour
+     * of the next coarser level.
+     */
+    enum Part
+    {
+        PART_INTERIOR = 0,
+        PART_EDGE = 1,
+        PART_STITCHED_EDGE = 1 + EDGE_COUNT,
+        PART_COUNT = 1 + EDGE_COUNT * 2
+    };
+
     struct Level
     {
         Model* model;
+        MeshPart* parts[PART_COUNT];
+        Vector2 heightRange;            // The minimum height and the height of a step of the quantized heights.
 
         Level();
     };
@@ -75,14 +118,14 @@ private:
      */
     static TerrainPatch* create(Terrain* terrain, 
                                 unsigned int row, unsigned int column,
-                                float* heights, unsigned int width, unsigned int height,
+                                const Heights& heights,
                                 unsigned int x1, unsigned int z1, unsigned int x2, unsigned int z2,
                                 float xOffset, float zOffset, unsigned int maxStep, float verticalSkirtSize);
 
     /**
      * Adds a single LOD level to the terrain patch.
      */
-    void addLOD(float* heights, unsigned int width, unsigned int height,
+    void addLOD(const Heights& heights,
                 unsigned int x1, unsigned int z1, unsigned int x2, unsigned int z2,
                 float xOffset, float zOffset, unsigned int step, float verticalSkirtSize);
 
@@ -101,6 +144,11 @@ private:
      */
     void deleteLayer(Layer* layer);
 
+    /**
+     * Deletes all layers of this patch.
+     */
+    void clearLayers();
+
     /**
      * Determines whether this patch is current visible by the scene's active camera.
      */
@@ -117,19 +165,44 @@ private:
     unsigned int getVisibleTriangleCount() const;
 
     /**
-     * Draws the terrain patch.
+     * Draws the terrain patch, at the level selected by the last call to updateLOD().
      */
     void draw(bool wireframe);
 
+    /**
+     * Selects the level and morph factor of this patch, from the viewpoint of the specified camera.
+     *
+     * The selected level may afterwards be lowered so that it differs from the levels of the
+     * neighbouring patches by at most one, and then updateEdges() must be called.
+     */
+    void updateLOD(Camera* camera);
+
+    /**
+     * Selects how the edges of this patch are drawn, from the levels of the neighbouring patches.
+     */
+    void updateEdges();
+
     /**
      * Updates the material for the patch.
      */
     bool updateMaterial();
 
+    /**
+     * Appends the shader definitions for the layers of this patch, which select its samplers and blend maps.
+     */
+    void buildLayerDefines(std::ostringstream& defines) const;
+
     /**
      * Computes the current LOD for this patch, from the viewpoint of the specified camera.
+     *
+     * @param morph If not NULL, receives how far (0 to 1) the patch is towards the next coarser level.
+     */
+    size_t computeLOD(Camera* camera, const BoundingBox& worldBounds, float* morph = NULL) const;
+
+    /**
+     * Returns the number of triangles drawn for a level with the specified edges stitched.
      */
-    size_t computeLOD(Camera* camera, const BoundingBox& worldBounds) const;
+    unsigned int getTriangleCount(size_t lod, unsigned int stitchedEdges) const;
 
     /**
      * Returns the local bounding box for this patch, at the base LOD level.
@@ -142,6 +215,10 @@ private:
 
     const Vector3& getLightDirection() const;
 
+    float getMorph() const;
+
+    const Vector4& getEdgeMorph() const;
+
     Terrain* _terrain;
     std::vector<Level*> _levels;
     unsigned int _row;
@@ -150,6 +227,12 @@ private:
     std::vector<Texture::Sampler*> _samplers;
     bool _materialDirty;
     BoundingBox _boundingBox;
+    TerrainPatch* _neighbors[EDGE_COUNT];
+    size_t _lod;
+    float _morph;
+    Vector4 _edgeMorph;
+    unsigned int _stitchedEdges;
+    Vector4 _grid;                      // The offset of the grid positions and the scale of the texture coordinates.
 
 };
 
@@ -4,7 +4,7 @@
 namespace gameplay
 {
 
-TextBox::TextBox() : _lastKeypress(0), _fontSize(0), _caretImage(NULL)
+TextBox::TextBox() : _lastKeypress(0), _fontSize(0), _caretImage(NULL), _caretFont(NULL), _caretFontSize(0)
 {
 }
 
@@ -127,18 +127,12 @@ bool TextBox::keyEvent(Keyboard::KeyEvent evt, int key)
                 }
                 case Keyboard::KEY_DELETE:
                 {
-                    Font* font = getFont(_state);
-                    GP_ASSERT(font);
-                    unsigned int fontSize = getFontSize(_state);
-                    Font::Justify textAlignment = getTextAlignment(_state);
-                    bool rightToLeft = getTextRightToLeft(_state);
-
-                    int textIndex = font->getIndexAtLocation(_text.c_str(), _textBounds, fontSize, _caretLocation, &_caretLocation,
-                        textAlignment, true, rightToLeft);
-                        
+                    int textIndex = getCaretIndex(_caretLocation, &_caretLocation);
+                    if (textIndex == -1)
+                        break;
+
                     _text.erase(textIndex, 1);
-                    font->getLocationAtIndex(_text.c_str(), _textBounds, fontSize, &_caretLocation, textIndex,
-                        textAlignment, true, rightToLeft);
+                    getCaretLocation(textIndex, &_caretLocation);
                     _dirty = true;
                     notifyListeners(Control::Listener::TEXT_CHANGED);
                     break;
@@ -151,45 +145,23 @@ bool TextBox::keyEvent(Keyboard::KeyEvent evt, int key)
                 }
                 case Keyboard::KEY_LEFT_ARROW:
                 {
-                    Font* font = getFont(_state);
-                    GP_ASSERT(font);
-                    unsigned int fontSize = getFontSize(_state);
-                    Font::Justify textAlignment = getTextAlignment(_state);
-                    bool rightToLeft = getTextRightToLeft(_state);
-
-                    int textIndex = font->getIndexAtLocation(_text.c_str(), _textBounds, fontSize, _caretLocation, &_caretLocation,
-                        textAlignment, true, rightToLeft);
-                    font->getLocationAtIndex(_text.c_str(), _textBounds, fontSize, &_caretLocation, textIndex - 1,
-                        textAlignment, true, rightToLeft);
+                    int textIndex = getCaretIndex(_caretLocation, &_caretLocation);
+                    getCaretLocation((unsigned int)std::max(textIndex - 1, 0), &_caretLocation);
                     _dirty = true;
                     break;
                 }
                 case Keyboard::KEY_RIGHT_ARROW:
                 {
-                    Font* font = getFont(_state);
-                    GP_ASSERT(font);
-                    unsigned int fontSize = getFontSize(_state);
-                    Font::Justify textAlignment = getTextAlignment(_state);
-                    bool rightToLeft = getTextRightToLeft(_state);
-
-                    int textIndex = font->getIndexAtLocation(_text.c_str(), _textBounds, fontSize, _caretLocation, &_caretLocation,
-                        textAlignment, true, rightToLeft);
-                    font->getLocationAtIndex(_text.c_str(), _textBounds, fontSize, &_caretLocation, textIndex + 1,
-                        textAlignment, true, rightToLeft);
+                    int textIndex = getCaretIndex(_caretLocation, &_caretLocation);
+                    getCaretLocation((unsigned int)std::max(textIndex + 1, 0), &_caretLocation);
                     _dirty = true;
                     break;
                 }
                 case Keyboard::KEY_UP_ARROW:
                 {
-                    Font* font = getFont(_state);
-                    GP_ASSERT(font);
-                    unsigned int fontSize = getFontSize(_state);
-                    Font::Justify textAlignment = getTextAlignment(_state);
-                    bool rightToLeft = getTextRightToLeft(_state);
                     _prevCaretLocation.set(_caretLocation);
-                    _caretLocation.y -= fontSize;
-                    int textIndex = font->getIndexAtLocation(_text.c_str(), _textBounds, fontSize, _caretLocation, &_caretLocation,
-                        textAlignment, true, rightToLeft);
+                    _caretLocation.y -= _fontSize;
+                    int textIndex = getCaretIndex(_caretLocation, &_caretLocation);
                     if (textIndex == -1)
                     {
                         _caretLocation.set(_prevCaretLocation);
@@ -200,15 +172,9 @@ bool TextBox::keyEvent(Keyboard::KeyEvent evt, int key)
                 }
                 case Keyboard::KEY_DOWN_ARROW:
                 {
-                    Font* font = getFont(_state);
-                    GP_ASSERT(font);
-                    unsigned int fontSize = getFontSize(_state);
-                    Font::Justify textAlignment = getTextAlignment(_state);
-                    bool rightToLeft = getTextRightToLeft(_state);
                     _prevCaretLocation.set(_caretLocation);
-                    _caretLocation.y += fontSize;
-                    int textIndex = font->getIndexAtLocation(_text.c_str(), _textBounds, fontSize, _caretLocation, &_caretLocation,
-                        textAlignment, true, rightToLeft);
+                    _caretLocation.y += _fontSize;
+                    int textIndex = getCaretIndex(_caretLocation, &_caretLocation);
                     if (textIndex == -1)
                     {
                         _caretLocation.set(_prevCaretLocation);
@@ -223,19 +189,11 @@ bool TextBox::keyEvent(Keyboard::KeyEvent evt, int key)
 
         case Keyboard::KEY_CHAR:
         {
-            Font* font = getFont(_state);
-            GP_ASSERT(font);
-            unsigned int fontSize = getFontSize(_state);
-            Font::Justify textAlignment = getTextAlignment(_state);
-            bool rightToLeft = getTextRightToLeft(_state);
-
-            int textIndex = font->getIndexAtLocation(_text.c_str(), _textBounds, fontSize, _caretLocation, &_caretLocation,
-                textAlignment, true, rightToLeft);
+            int textIndex = getCaretIndex(_caretLocation, &_caretLocation);
             if (textIndex == -1)
             {
                 textIndex = 0;
-                font->getLocationAtIndex(_text.c_str(), _textBounds, fontSize, &_caretLocation, 0,
-                    textAlignment, true, rightToLeft);
+                getCaretLocation(0, &_caretLocation);
             }
 
             switch (key)
@@ -246,8 +204,7 @@ bool TextBox::keyEvent(Keyboard::KeyEvent evt, int key)
                     {
                         --textIndex;
                         _text.erase(textIndex, 1);
-                        font->getLocationAtIndex(_text.c_str(), _textBounds, fontSize, &_caretLocation, textIndex,
-                            textAlignment, true, rightToLeft);
+                        getCaretLocation(textIndex, &_caretLocation);
 
                         _dirty = true;
                     }
@@ -268,8 +225,7 @@ bool TextBox::keyEvent(Keyboard::KeyEvent evt, int key)
                     _text.insert(textIndex, 1, (char)key);
 
                     // Get new location of caret.
-                    font->getLocationAtIndex(_text.c_str(), _textBounds, fontSize, &_caretLocation, textIndex + 1,
-                        textAlignment, true, rightToLeft);
+                    getCaretLocation(textIndex + 1, &_caretLocation);
 
                     if (key == ' ')
                     {
@@ -279,8 +235,7 @@ bool TextBox::keyEvent(Keyboard::KeyEvent evt, int key)
                         {
                             // If not, undo the character insertion.
                             _text.erase(textIndex, 1);
-                            font->getLocationAtIndex(_text.c_str(), _textBounds, fontSize, &_caretLocation, textIndex,
-                                textAlignment, true, rightToLeft);
+                            getCaretLocation(textIndex, &_caretLocation);
 
                             // No need to check again.
                             break;
@@ -289,14 +244,13 @@ bool TextBox::keyEvent(Keyboard::KeyEvent evt, int key)
 
                     // Always check that the text still fits within the clip region.
                     Rectangle textBounds;
-                    font->measureText(_text.c_str(), _textBounds, fontSize, &textBounds, textAlignment, true, true);
+                    measureCaretText(&textBounds);
                     if (textBounds.x < _textBounds.x || textBounds.y < _textBounds.y ||
                         textBounds.width >= _textBounds.width || textBounds.height >= _textBounds.height)
                     {
                         // If not, undo the character insertion.
                         _text.erase(textIndex, 1);
-                        font->getLocationAtIndex(_text.c_str(), _textBounds, fontSize, &_caretLocation, textIndex,
-                            textAlignment, true, rightToLeft);
+                        getCaretLocation(textIndex, &_caretLocation);
 
                         // TextBox is not dirty.
                         break;
@@ -325,7 +279,7 @@ void TextBox::update(const Control* container, const Vector2& offset)
 {
     Label::update(container, offset);
 
-    _fontSize = getFontSize(_state);
+    _fontSize = getResolvedStyle().fontSize;
     _caretImage = getImage("textCaret", _state);
 }
 
@@ -356,25 +310,18 @@ void TextBox::setCaretLocation(int x, int y)
     _caretLocation.set(x + _absoluteBounds.x,
                        y + _absoluteBounds.y);
 
-    Font* font = getFont(_state);
-    unsigned int fontSize = getFontSize(_state);
-    Font::Justify textAlignment = getTextAlignment(_state);
-    bool rightToLeft = getTextRightToLeft(_state);
-
-    int index = font->getIndexAtLocation(_text.c_str(), _textBounds, fontSize, _caretLocation, &_caretLocation,
-            textAlignment, true, rightToLeft);
+    int index = getCaretIndex(_caretLocation, &_caretLocation);
 
     if (index == -1)
     {
         // Attempt to find the nearest valid caret location.
         Rectangle textBounds;
-        font->measureText(_text.c_str(), _textBounds, fontSize, &textBounds, textAlignment, true, true);
+        measureCaretText(&textBounds);
 
         if (_caretLocation.x > textBounds.x + textBounds.width &&
             _caretLocation.y > textBounds.y + textBounds.height)
         {
-            font->getLocationAtIndex(_text.c_str(), _textBounds, fontSize, &_caretLocation, (unsigned int)_text.length(),
-                textAlignment, true, rightToLeft);
+            getCaretLocation((unsigned int)_text.length(), &_caretLocation);
             return;
         }
 
@@ -393,14 +340,10 @@ void TextBox::setCaretLocation(int x, int y)
         }
         else if (_caretLocation.y > textBounds.y + textBounds.height)
         {
-            Font* font = getFont(_state);
-            GP_ASSERT(font);
-            unsigned int fontSize = getFontSize(_state);
-            _caretLocation.y = textBounds.y + textBounds.height - fontSize;
+            _caretLocation.y = textBounds.y + textBounds.height - getResolvedStyle().fontSize;
         }
 
-        index = font->getIndexAtLocation(_text.c_str(), _textBounds, fontSize, _caretLocation, &_caretLocation,
-            textAlignment, true, rightToLeft);
+        index = getCaretIndex(_caretLocation, &_caretLocation);
 
         if (index == -1)
         {
@@ -410,6 +353,177 @@ void TextBox::setCaretLocation(int x, int y)
     }
 }
 
+bool TextBox::usesCaretLayout() const
+{
+    const ResolvedStyle& style = getResolvedStyle();
+    return style.textAlignment == Font::ALIGN_TOP_LEFT && !style.textRightToLeft;
+}
+
+void TextBox::updateCaretLayout()
+{
+    const ResolvedStyle& style = getResolvedStyle();
+    Font* font = style.font;
+    GP_ASSERT(font);
+
+    const char* text = _text.c_str();
+    unsigned int length = (unsigned int)_text.length();
+    unsigned int oldLength = (unsigned int)_caretText.length();
+    bool layoutChanged = (font != _caretFont || style.fontSize != _caretFontSize || _caretLocations.empty() ||
+        _textBounds.x != _caretArea.x || _textBounds.y != _caretArea.y ||
+        _textBounds.width != _caretArea.width || _textBounds.height != _caretArea.height);
+    if (!layoutChanged && length == oldLength && _text == _caretText)
+        return;
+
+    // Only the characters between the common start and end of the old and the new text changed.
+    unsigned int prefix = 0;
+    unsigned int suffix = 0;
+    if (!layoutChanged)
+    {
+        const char* oldText = _caretText.c_str();
+        unsigned int common = std::min(length, oldLength);
+        while (prefix < common && text[prefix] == oldText[prefix])
+            ++prefix;
+        while (suffix < common - prefix && text[length - suffix - 1] == oldText[oldLength - suffix - 1])
+            ++suffix;
+    }
+
+    // The paragraphs before the one the change starts in are kept.
+    unsigned int first = 0;
+    while (!layoutChanged && first + 1 < _caretParagraphs.size() && _caretParagraphs[first + 1].start <= prefix)
+        ++first;
+    std::vector<CaretParagraph> paragraphs(_caretParagraphs.begin(), _caretParagraphs.begin() + first);
+    std::vector<Vector2> locations(length + 1);
+    unsigned int start = 0;
+    int y = (int)_textBounds.y;
+    if (!layoutChanged && first < _caretParagraphs.size())
+    {
+        start = _caretParagraphs[first].start;
+        y = _caretParagraphs[first].y;
+    }
+    std::copy(_caretLocations.begin(), _caretLocations.begin() + std::min(start, (unsigned int)_caretLocations.size()), locations.begin());
+
+    // Lay the paragraphs out until one starts after a newline in the unchanged end of the text.
+    int delta = (int)length - (int)oldLength;
+    int next = (int)start;
+    while (next >= 0)
+    {
+        if (!layoutChanged && next > (int)start && next > (int)(length - suffix))
+        {
+            // The rest of the paragraphs are unchanged, but may have moved up or down.
+            unsigned int oldNext = (unsigned int)(next - delta);
+            unsigned int p = first;
+            while (p < _caretParagraphs.size() && _caretParagraphs[p].start < oldNext)
+                ++p;
+            GP_ASSERT(p < _caretParagraphs.size() && _caretParagraphs[p].start == oldNext);
+            int dy = y - _caretParagraphs[p].y;
+            for (unsigned int i = oldNext; i <= oldLength; ++i)
+                locations[i + delta].set(_caretLocations[i].x, _caretLocations[i].y + dy);
+            for (; p < _caretParagraphs.size(); ++p)
+            {
+                CaretParagraph paragraph = _caretParagraphs[p];
+                paragraph.start += delta;
+                paragraph.y += dy;
+                paragraphs.push_back(paragraph);
+            }
+            break;
+        }
+
+        CaretParagraph paragraph;
+        paragraph.start = (unsigned int)next;
+        paragraph.y = y;
+        next = font->layoutParagraph(text, paragraph.start, _textBounds, style.fontSize, &y, &locations[0], &paragraph.right);
+        paragraphs.push_back(paragraph);
+    }
+
+    _caretLocations.swap(locations);
+    _caretParagraphs.swap(paragraphs);
+    _caretText = _text;
+    _caretFont = font;
+    _caretFontSize = style.fontSize;
+    _caretArea = _textBounds;
+}
+
+int TextBox::getCaretIndex(const Vector2& location, Vector2* outLocation)
+{
+    GP_ASSERT(outLocation);
+
+    const ResolvedStyle& style = getResolvedStyle();
+    if (!usesCaretLayout())
+    {
+        GP_ASSERT(style.font);
+        return style.font->getIndexAtLocation(_text.c_str(), _textBounds, style.fontSize, location, outLocation,
+            style.textAlignment, true, style.textRightToLeft);
+    }
+    updateCaretLayout();
+
+    // The locations are in order, by line and then from left to right.
+    int size = (int)(style.fontSize ? style.fontSize : style.font->getSize());
+    unsigned int count = (unsigned int)_caretLocations.size();
+    if (location.y < _caretLocations[0].y || location.y >= _caretLocations[count - 1].y + size)
+        return -1;
+
+    // Find the first line that ends below the location, then the character boundary on it
+    // that is nearest to the location.
+    unsigned int low = 0;
+    unsigned int high = count - 1;
+    while (low < high)
+    {
+        unsigned int middle = (low + high) / 2;
+        if (_caretLocations[middle].y + size > location.y)
+            high = middle;
+        else
+            low = middle + 1;
+    }
+    float lineY = _caretLocations[low].y;
+    unsigned int index = low;
+    while (index + 1 < count && _caretLocations[index + 1].y == lineY && _caretLocations[index + 1].x <= location.x)
+        ++index;
+    if (index + 1 < count && _caretLocations[index + 1].y == lineY &&
+        _caretLocations[index + 1].x - location.x < location.x - _caretLocations[index].x)
+        ++index;
+
+    outLocation->set(_caretLocations[index]);
+    return (int)index;
+}
+
+void TextBox::getCaretLocation(unsigned int index, Vector2* outLocation)
+{
+    GP_ASSERT(outLocation);
+
+    const ResolvedStyle& style = getResolvedStyle();
+    if (!usesCaretLayout())
+    {
+        GP_ASSERT(style.font);
+        style.font->getLocationAtIndex(_text.c_str(), _textBounds, style.fontSize, outLocation, index,
+            style.textAlignment, true, style.textRightToLeft);
+        return;
+    }
+    updateCaretLayout();
+
+    outLocation->set(_caretLocations[std::min(index, (unsigned int)_text.length())]);
+}
+
+void TextBox::measureCaretText(Rectangle* out)
+{
+    GP_ASSERT(out);
+
+    const ResolvedStyle& style = getResolvedStyle();
+    if (!usesCaretLayout())
+    {
+        GP_ASSERT(style.font);
+        style.font->measureText(_text.c_str(), _textBounds, style.fontSize, out, style.textAlignment, true, true);
+        return;
+    }
+    updateCaretLayout();
+
+    // The text spans from the top left of the area to the rightmost word and the last line.
+    int right = (int)_textBounds.x;
+    for (unsigned int i = 0; i < _caretParagraphs.size(); ++i)
+        right = std::max(right, _caretParagraphs[i].right);
+    int size = (int)(style.fontSize ? style.fontSize : style.font->getSize());
+    out->set(_textBounds.x, _textBounds.y, right - _textBounds.x, _caretLocations.back().y + size - _textBounds.y);
+}
+
 const char* TextBox::getType() const
 {
     return "textBox";
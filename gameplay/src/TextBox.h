@@ -172,6 +172,52 @@ private:
     TextBox(const TextBox& copy);
 
     void setCaretLocation(int x, int y);
+
+    /**
+     * A paragraph of the caret layout, which starts on a new line.
+     */
+    struct CaretParagraph
+    {
+        unsigned int start;
+        int y;
+        int right;
+    };
+
+    /**
+     * Whether the caret is placed with the caret layout, which is kept for text that is
+     * aligned to the top left and drawn left to right.
+     */
+    bool usesCaretLayout() const;
+
+    /**
+     * Lays out the locations of the characters of the text again where it changed since it
+     * was last laid out: the paragraph the change starts in is laid out again, and the
+     * paragraphs after the change are moved.
+     */
+    void updateCaretLayout();
+
+    /**
+     * Gets the index of the character nearest a location, and its location, or -1 if the
+     * location is above or below the text.
+     */
+    int getCaretIndex(const Vector2& location, Vector2* outLocation);
+
+    /**
+     * Gets the location of the caret before the character at an index.
+     */
+    void getCaretLocation(unsigned int index, Vector2* outLocation);
+
+    /**
+     * Measures the bounds of the text, without clipping.
+     */
+    void measureCaretText(Rectangle* out);
+
+    std::string _caretText;
+    Font* _caretFont;
+    unsigned int _caretFontSize;
+    Rectangle _caretArea;
+    std::vector<Vector2> _caretLocations;
+    std::vector<CaretParagraph> _caretParagraphs;
 };
 
 }
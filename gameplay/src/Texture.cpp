@@ -1,7 +1,12 @@
 #include "Base.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
 #include "Image.h"
 #include "Texture.h"
 #include "FileSystem.h"
+#include "Game.h"
+#include "TextureStreamer.h"
+#include "MemoryStats.h"
 
 // PVRTC (GL_IMG_texture_compression_pvrtc) : Imagination based gpus
 #ifndef GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG
@@ -39,24 +44,420 @@
 #define ATC_RGBA_INTERPOLATED_ALPHA_AMD 0x87EE
 #endif
 
+// ETC1 (GL_OES_compressed_ETC1_RGB8_texture) : Most OpenGL ES 2 gpus
+#ifndef GL_ETC1_RGB8_OES
+#define GL_ETC1_RGB8_OES 0x8D64
+#endif
+
+// KTX file identifier
+static const unsigned char KTX_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+
 namespace gameplay
 {
 
 static std::vector<Texture*> __textureCache;
 static TextureHandle __currentTextureId;
+static unsigned int __textureCacheBudget = 0;
+static unsigned int __textureCacheClock = 0;
+static std::vector<GLint> __compressedFormats;
+static bool __compressedFormatsQueried = false;
+#ifdef USE_SAMPLER_OBJECTS
+// The sampler objects shared by all the samplers with the same filters and wrap modes.
+static std::map<unsigned long long, GLuint> __samplerObjects;
+#endif
+
+// Returns the GL format of the pixels passed to the texture for an uncompressed format.
+static GLenum getPixelFormat(Texture::Format format)
+{
+    switch (format)
+    {
+    case Texture::RGB565:
+        return GL_RGB;
+    case Texture::RGBA4444:
+    case Texture::RGBA5551:
+        return GL_RGBA;
+    default:
+        return (GLenum)format;
+    }
+}
+
+// Returns the GL type of the pixels passed to the texture for an uncompressed format.
+static GLenum getPixelType(Texture::Format format)
+{
+    switch (format)
+    {
+    case Texture::RGB565:
+    case Texture::RGBA4444:
+    case Texture::RGBA5551:
+        return (GLenum)format;
+    default:
+        return GL_UNSIGNED_BYTE;
+    }
+}
+
+// Returns the internal format of the texture for an uncompressed format. OpenGL ES requires
+// the internal format to match the pixel format, while desktop drivers are free to widen
+// unsized formats to 8 bits per channel, so the 16-bit formats are sized there.
+static GLint getInternalFormat(Texture::Format format)
+{
+#ifndef OPENGL_ES
+    switch (format)
+    {
+    case Texture::RGB565:
+        return GL_RGB5;
+    case Texture::RGBA4444:
+        return GL_RGBA4;
+    case Texture::RGBA5551:
+        return GL_RGB5_A1;
+    default:
+        break;
+    }
+#endif
+    return (GLint)getPixelFormat(format);
+}
+
+// Returns the number of bytes of each pixel of an uncompressed format.
+static unsigned int getBytesPerPixel(Texture::Format format)
+{
+    switch (format)
+    {
+    case Texture::RGB:
+        return 3;
+    case Texture::ALPHA:
+    case Texture::LUMINANCE:
+        return 1;
+    case Texture::RGB565:
+    case Texture::RGBA4444:
+    case Texture::RGBA5551:
+        return 2;
+    default:
+        return 4;
+    }
+}
+
+static Texture::Format toTextureFormat(Image::Format format)
+{
+    switch (format)
+    {
+    case Image::RGB:
+        return Texture::RGB;
+    case Image::RGBA:
+        return Texture::RGBA;
+    case Image::LUMINANCE:
+        return Texture::LUMINANCE;
+    case Image::ALPHA:
+        return Texture::ALPHA;
+    case Image::RGB565:
+        return Texture::RGB565;
+    case Image::RGBA4444:
+        return Texture::RGBA4444;
+    case Image::RGBA5551:
+        return Texture::RGBA5551;
+    default:
+        return Texture::UNKNOWN;
+    }
+}
+
+static Image::Format toImageFormat(Texture::Format format)
+{
+    switch (format)
+    {
+    case Texture::RGB:
+        return Image::RGB;
+    case Texture::ALPHA:
+        return Image::ALPHA;
+    case Texture::LUMINANCE:
+        return Image::LUMINANCE;
+    case Texture::RGB565:
+        return Image::RGB565;
+    case Texture::RGBA4444:
+        return Image::RGBA4444;
+    case Texture::RGBA5551:
+        return Image::RGBA5551;
+    default:
+        return Image::RGBA;
+    }
+}
+
+// KTX file header.
+struct ktx_header
+{
+    unsigned char identifier[12];
+    unsigned int endianness;
+    unsigned int glType;
+    unsigned int glTypeSize;
+    unsigned int glFormat;
+    unsigned int glInternalFormat;
+    unsigned int glBaseInternalFormat;
+    unsigned int pixelWidth;
+    unsigned int pixelHeight;
+    unsigned int pixelDepth;
+    unsigned int numberOfArrayElements;
+    unsigned int numberOfFaces;
+    unsigned int numberOfMipmapLevels;
+    unsigned int bytesOfKeyValueData;
+};
+
+static unsigned int swapBytes(unsigned int value)
+{
+    return (value >> 24) | ((value >> 8) & 0xff00) | ((value << 8) & 0xff0000) | (value << 24);
+}
+
+// Reads and validates a KTX header, converting it to the byte order of this machine.
+static bool readKTXHeader(Stream* stream, ktx_header* header, bool* swap)
+{
+    GP_ASSERT(stream);
+    GP_ASSERT(header);
+    GP_ASSERT(swap);
+
+    if (stream->read(header, sizeof(ktx_header), 1) != 1 || memcmp(header->identifier, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER)) != 0)
+        return false;
+
+    *swap = header->endianness == 0x01020304;
+    if (*swap)
+    {
+        unsigned int* fields = &header->endianness;
+        for (unsigned int i = 0; i < 13; ++i)
+            fields[i] = swapBytes(fields[i]);
+    }
+    return header->endianness == 0x04030201;
+}
+
+// The number of bytes of pixels uploaded per frame by textures created with createAsync(),
+// when pixel buffer objects are not available.
+#define ASYNC_UPLOAD_BYTES_PER_FRAME (256 * 1024)
 
-Texture::Texture() : _handle(0), _format(UNKNOWN), _width(0), _height(0), _mipmapped(false), _cached(false), _compressed(false),
+/**
+ * Decodes the image of a texture created with createAsync() on a worker thread, and then
+ * uploads it on the main thread.
+ */
+class Texture::AsyncLoad
+{
+public:
+
+    class WorkerJob : public JobController::Job
+    {
+    public:
+        AsyncLoad* load;
+        void run() { load->work(); }
+    };
+
+    class MainJob : public JobController::Job
+    {
+    public:
+        AsyncLoad* load;
+        void run() { load->upload(); }
+    };
+
+    AsyncLoad(Texture* texture, const std::string& path, bool generateMipmaps);
+
+    ~AsyncLoad();
+
+    void start();
+
+    void work();
+
+    void upload();
+
+    void finish();
+
+    Texture* texture;
+    std::string path;
+    bool generateMipmaps;
+    Image* image;
+    std::string error;
+    GLuint handle;
+    GLuint buffer;
+    void* mapped;
+    unsigned int row;
+    bool done;
+    WorkerJob workerJob;
+    MainJob mainJob;
+};
+
+Texture::AsyncLoad::AsyncLoad(Texture* texture, const std::string& path, bool generateMipmaps)
+    : texture(texture), path(path), generateMipmaps(generateMipmaps), image(NULL), handle(0), buffer(0),
+      mapped(NULL), row(0), done(false)
+{
+    workerJob.load = this;
+    mainJob.load = this;
+}
+
+Texture::AsyncLoad::~AsyncLoad()
+{
+    GP_ASSERT(done);
+}
+
+void Texture::AsyncLoad::start()
+{
+    // The texture is kept alive until the load is done.
+    texture->addRef();
+    JobController* jobController = Game::getInstance()->getJobController();
+    JobController::JobId workerId = jobController->add(&workerJob);
+    jobController->add(&mainJob, workerId, JobController::MAIN_THREAD);
+}
+
+void Texture::AsyncLoad::work()
+{
+    // This runs on a worker thread, so failures are reported by upload().
+    if (mapped)
+    {
+        memcpy(mapped, image->getData(), image->getWidth() * image->getHeight() * (image->getFormat() == Image::RGBA ? 4 : 3));
+    }
+    else
+    {
+        image = Image::load(path.c_str(), &error);
+    }
+}
+
+void Texture::AsyncLoad::upload()
+{
+    if (image == NULL)
+    {
+        GP_WARN("Failed to load texture from file '%s': %s", path.c_str(), error.c_str());
+        finish();
+        return;
+    }
+
+    const GLenum format = image->getFormat() == Image::RGBA ? GL_RGBA : GL_RGB;
+    const unsigned int stride = image->getWidth() * (image->getFormat() == Image::RGBA ? 4 : 3);
+    const unsigned int height = image->getHeight();
+    JobController* jobController = Game::getInstance()->getJobController();
+
+    if (handle == 0)
+    {
+        GL_ASSERT( glGenTextures(1, &handle) );
+
+#ifdef USE_PIXEL_BUFFER_OBJECT
+        // Map a pixel buffer and copy the pixels into it on a worker thread. The driver then
+        // transfers them to the texture without blocking the main thread.
+        GL_ASSERT( glGenBuffers(1, &buffer) );
+        GLStateCache::bindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        GL_ASSERT( glBufferData(GL_PIXEL_UNPACK_BUFFER, stride * height, NULL, GL_STREAM_DRAW) );
+        mapped = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+        GLStateCache::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        if (mapped)
+        {
+            JobController::JobId workerId = jobController->add(&workerJob);
+            jobController->add(&mainJob, workerId, JobController::MAIN_THREAD);
+            return;
+        }
+        GLStateCache::deleteBuffers(1, &buffer);
+        buffer = 0;
+#endif
+
+        GLStateCache::bindTexture(GL_TEXTURE_2D, handle);
+        GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 1) );
+        GL_ASSERT( glTexImage2D(GL_TEXTURE_2D, 0, format, image->getWidth(), height, 0, format, GL_UNSIGNED_BYTE, NULL) );
+    }
+
+#ifdef USE_PIXEL_BUFFER_OBJECT
+    if (buffer)
+    {
+        GLStateCache::bindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        GLboolean unmapped = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        mapped = NULL;
+        GLStateCache::bindTexture(GL_TEXTURE_2D, handle);
+        GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 1) );
+        if (unmapped)
+        {
+            // The pixels are read from the start of the bound pixel buffer.
+            GL_ASSERT( glTexImage2D(GL_TEXTURE_2D, 0, format, image->getWidth(), height, 0, format, GL_UNSIGNED_BYTE, NULL) );
+            row = height;
+        }
+        GLStateCache::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        GLStateCache::deleteBuffers(1, &buffer);
+        buffer = 0;
+
+        // The contents of a buffer are undefined if unmapping it fails, so upload the pixels directly.
+        if (!unmapped)
+        {
+            GL_ASSERT( glTexImage2D(GL_TEXTURE_2D, 0, format, image->getWidth(), height, 0, format, GL_UNSIGNED_BYTE, NULL) );
+        }
+    }
+#endif
+
+    // Upload a few rows per frame.
+    if (row < height)
+    {
+        unsigned int count = std::min(std::max(ASYNC_UPLOAD_BYTES_PER_FRAME / stride, 1u), height - row);
+        GLStateCache::bindTexture(GL_TEXTURE_2D, handle);
+        GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 1) );
+        GL_ASSERT( glTexSubImage2D(GL_TEXTURE_2D, 0, 0, row, image->getWidth(), count, format, GL_UNSIGNED_BYTE, image->getData() + row * stride) );
+        row += count;
+    }
+    GLStateCache::bindTexture(GL_TEXTURE_2D, __currentTextureId);
+
+    if (row < height)
+    {
+        // Main thread jobs added while the jobs of a frame run are run on the next frame.
+        jobController->add(&mainJob, JobController::MAIN_THREAD);
+        return;
+    }
+    finish();
+}
+
+void Texture::AsyncLoad::finish()
+{
+    if (image && handle)
+    {
+        // Replace the placeholder, keeping the sampler state the texture was given meanwhile.
+        GLStateCache::bindTexture(GL_TEXTURE_2D, handle);
+        GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (GLenum)texture->_minFilter) );
+        GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (GLenum)texture->_magFilter) );
+        GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, (GLenum)texture->_wrapS) );
+        GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, (GLenum)texture->_wrapT) );
+        GLStateCache::deleteTextures(1, &texture->_handle);
+        texture->_handle = handle;
+        texture->_width = image->getWidth();
+        texture->_height = image->getHeight();
+        texture->_format = image->getFormat() == Image::RGBA ? RGBA : RGB;
+        texture->_mipmapped = false;
+        if (generateMipmaps)
+        {
+            texture->generateMipmaps();
+        }
+        texture->trackMemorySize();
+        GLStateCache::bindTexture(GL_TEXTURE_2D, __currentTextureId);
+        handle = 0;
+    }
+    else if (handle)
+    {
+        GLStateCache::deleteTextures(1, &handle);
+        handle = 0;
+    }
+    SAFE_RELEASE(image);
+    done = true;
+
+    // Releasing the texture may destroy it and this load with it, so this must be last.
+    texture->release();
+}
+
+Texture::Texture() : _decodeFormat(UNKNOWN), _decodeDither(false), _handle(0), _type(TEXTURE_2D), _format(UNKNOWN), _width(0), _height(0), _layerCount(1), _bindlessHandles(0), _mipmapped(false), _cached(false), _compressed(false), _streamed(false), _asyncLoad(NULL),
+    _cacheReferenced(false), _lastUsed(0), _trackedSize(0),
     _wrapS(Texture::REPEAT), _wrapT(Texture::REPEAT), _minFilter(Texture::NEAREST_MIPMAP_LINEAR), _magFilter(Texture::LINEAR)
 {
 }
 
 Texture::~Texture()
 {
+    if (_streamed)
+    {
+        TextureStreamer* streamer = Game::getInstance()->getTextureStreamer();
+        if (streamer)
+        {
+            streamer->removeTexture(this);
+        }
+    }
+
+    SAFE_DELETE(_asyncLoad);
+
     if (_handle)
     {
-        GL_ASSERT( glDeleteTextures(1, &_handle) );
+        GLStateCache::deleteTextures(1, &_handle);
         _handle = 0;
     }
+    MemoryStats::remove(MemoryStats::GPU_TEXTURES, _trackedSize);
 
     // Remove ourself from the texture cache.
     if (_cached)
@@ -70,34 +471,39 @@ Texture::~Texture()
 }
 
 Texture* Texture::create(const char* path, bool generateMipmaps)
+{
+    return create(path, generateMipmaps, UNKNOWN, false);
+}
+
+Texture* Texture::create(const char* path, bool generateMipmaps, Format format, bool dither)
 {
     GP_ASSERT(path);
+    GP_PROFILE("Texture::create");
+
+    // Dithering only applies to conversions.
+    if (format == UNKNOWN)
+        dither = false;
 
     // Search texture cache first.
-    for (size_t i = 0, count = __textureCache.size(); i < count; ++i)
+    Texture* texture = findCached(path, generateMipmaps, format, dither);
+    if (texture)
     {
-        Texture* t = __textureCache[i];
-        GP_ASSERT(t);
-        if (t->_path == path)
-        {
-            // If 'generateMipmaps' is true, call Texture::generateMipamps() to force the 
-            // texture to generate its mipmap chain if it hasn't already done so.
-            if (generateMipmaps)
-            {
-                t->generateMipmaps();
-            }
+        return texture;
+    }
 
-            // Found a match.
-            t->addRef();
+    // Make room for the new texture among the textures that are no longer used.
+    trimCache();
 
-            return t;
-        }
+    // A path without an extension selects the file the device supports best.
+    std::string filePath = path;
+    const char* ext = strrchr(FileSystem::resolvePath(path), '.');
+    if (ext == NULL || strchr(ext, '/') || strchr(ext, '\\'))
+    {
+        filePath = findSupportedFile(path);
+        ext = strrchr(filePath.c_str(), '.');
     }
 
-    Texture* texture = NULL;
-
     // Filter loading based on file extension.
-    const char* ext = strrchr(FileSystem::resolvePath(path), '.');
     if (ext)
     {
         switch (strlen(ext))
@@ -105,7 +511,9 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
         case 4:
             if (tolower(ext[1]) == 'p' && tolower(ext[2]) == 'n' && tolower(ext[3]) == 'g')
             {
-                Image* image = Image::create(path);
+                Image* image = Image::create(filePath.c_str());
+                if (image && format != UNKNOWN && !image->convert(toImageFormat(format), dither))
+                    GP_WARN("Failed to convert texture '%s' to format %d.", path, format);
                 if (image)
                     texture = create(image, generateMipmaps);
                 SAFE_RELEASE(image);
@@ -113,12 +521,17 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
             else if (tolower(ext[1]) == 'p' && tolower(ext[2]) == 'v' && tolower(ext[3]) == 'r')
             {
                 // PowerVR Compressed Texture RGBA.
-                texture = createCompressedPVRTC(path);
+                texture = createCompressedPVRTC(filePath.c_str());
             }
             else if (tolower(ext[1]) == 'd' && tolower(ext[2]) == 'd' && tolower(ext[3]) == 's')
             {
                 // DDS file format (DXT/S3TC) compressed textures
-                texture = createCompressedDDS(path);
+                texture = createCompressedDDS(filePath.c_str());
+            }
+            else if (tolower(ext[1]) == 'k' && tolower(ext[2]) == 't' && tolower(ext[3]) == 'x')
+            {
+                // KTX file format (ETC1/ETC2/EAC/ASTC and other) textures
+                texture = createCompressedKTX(filePath.c_str());
             }
             break;
         }
@@ -126,11 +539,8 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
 
     if (texture)
     {
-        texture->_path = path;
-        texture->_cached = true;
-
         // Add to texture cache.
-        __textureCache.push_back(texture);
+        addToCache(texture, path, format, dither);
 
         return texture;
     }
@@ -139,30 +549,66 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
     return NULL;
 }
 
+Texture* Texture::createAsync(const char* path, bool generateMipmaps)
+{
+    GP_ASSERT(path);
+
+    // Return the texture from the cache, even while it is still loading.
+    Texture* cached = findCached(path, generateMipmaps);
+    if (cached)
+    {
+        return cached;
+    }
+
+    // Only PNG files need decoding; other formats are loaded now.
+    std::string filePath = path;
+    const char* ext = strrchr(FileSystem::resolvePath(path), '.');
+    if (ext == NULL || strchr(ext, '/') || strchr(ext, '\\'))
+    {
+        filePath = findSupportedFile(path);
+        ext = strrchr(filePath.c_str(), '.');
+    }
+    JobController* jobController = Game::getInstance()->getJobController();
+    if (jobController == NULL || ext == NULL || strlen(ext) != 4 || tolower(ext[1]) != 'p' || tolower(ext[2]) != 'n' || tolower(ext[3]) != 'g')
+    {
+        return create(path, generateMipmaps);
+    }
+
+    // Draw a white pixel until the image is uploaded.
+    static unsigned char white[] = { 255, 255, 255, 255 };
+    trimCache();
+    Texture* texture = create(RGBA, 1, 1, white, generateMipmaps);
+    addToCache(texture, path);
+
+    texture->_asyncLoad = new AsyncLoad(texture, filePath, generateMipmaps);
+    texture->_asyncLoad->start();
+
+    return texture;
+}
+
 Texture* Texture::create(Image* image, bool generateMipmaps)
 {
     GP_ASSERT(image);
 
-    switch (image->getFormat())
+    Format format = toTextureFormat(image->getFormat());
+    if (format == UNKNOWN)
     {
-    case Image::RGB:
-        return create(Texture::RGB, image->getWidth(), image->getHeight(), image->getData(), generateMipmaps);
-    case Image::RGBA:
-        return create(Texture::RGBA, image->getWidth(), image->getHeight(), image->getData(), generateMipmaps);
-    default:
         GP_ERROR("Unsupported image format (%d).", image->getFormat());
         return NULL;
     }
+    return create(format, image->getWidth(), image->getHeight(), image->getData(), generateMipmaps);
 }
 
 Texture* Texture::create(Format format, unsigned int width, unsigned int height, unsigned char* data, bool generateMipmaps)
 {
+    GP_PROFILE("Texture::upload");
+
     // Create and load the texture.
     GLuint textureId;
     GL_ASSERT( glGenTextures(1, &textureId) );
-    GL_ASSERT( glBindTexture(GL_TEXTURE_2D, textureId) );
+    GLStateCache::bindTexture(GL_TEXTURE_2D, textureId);
     GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 1) );
-    GL_ASSERT( glTexImage2D(GL_TEXTURE_2D, 0, (GLenum)format, width, height, 0, (GLenum)format, GL_UNSIGNED_BYTE, data) );
+    GL_ASSERT( glTexImage2D(GL_TEXTURE_2D, 0, getInternalFormat(format), width, height, 0, getPixelFormat(format), getPixelType(format), data) );
 
     // Set initial minification filter based on whether or not mipmaping was enabled.
     Filter minFilter = generateMipmaps ? NEAREST_MIPMAP_LINEAR : LINEAR;
@@ -178,9 +624,10 @@ Texture* Texture::create(Format format, unsigned int width, unsigned int height,
     {
         texture->generateMipmaps();
     }
+    texture->trackMemorySize();
 
     // Restore the texture id
-    GL_ASSERT( glBindTexture(GL_TEXTURE_2D, __currentTextureId) );
+    GLStateCache::bindTexture(GL_TEXTURE_2D, __currentTextureId);
 
     return texture;
 }
@@ -194,6 +641,488 @@ Texture* Texture::create(TextureHandle handle, int width, int height, Format for
     texture->_format = format;
     texture->_width = width;
     texture->_height = height;
+    texture->trackMemorySize();
+
+    return texture;
+}
+
+Texture* Texture::createArray(Image** images, unsigned int count, bool generateMipmaps)
+{
+    GP_ASSERT(images);
+    GP_ASSERT(count > 0);
+    GP_ASSERT(images[0]);
+
+    Format format = toTextureFormat(images[0]->getFormat());
+    if (format == UNKNOWN)
+    {
+        GP_ERROR("Unsupported image format (%d).", images[0]->getFormat());
+        return NULL;
+    }
+    unsigned int width = images[0]->getWidth();
+    unsigned int height = images[0]->getHeight();
+    for (unsigned int i = 1; i < count; ++i)
+    {
+        GP_ASSERT(images[i]);
+        if (images[i]->getFormat() != images[0]->getFormat() || images[i]->getWidth() != width || images[i]->getHeight() != height)
+        {
+            GP_ERROR("The layers of a texture array must have the same size and format (layer %d differs from layer 0).", i);
+            return NULL;
+        }
+    }
+
+    // The layers are uploaded one by one rather than copied into a single buffer, and the
+    // mipmaps are generated once they are all in place.
+    Texture* texture = createArray(format, width, height, count, NULL, false);
+    if (texture)
+    {
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            texture->setLayerData(i, images[i]->getData());
+        }
+        if (generateMipmaps)
+        {
+            texture->generateMipmaps();
+        }
+    }
+    return texture;
+}
+
+Texture* Texture::createArray(Format format, unsigned int width, unsigned int height, unsigned int layerCount,
+                              const unsigned char* data, bool generateMipmaps)
+{
+    GP_ASSERT(layerCount > 0);
+    if (!isArraySupported())
+    {
+        GP_ERROR("Texture arrays are not supported.");
+        return NULL;
+    }
+
+#ifdef USE_TEXTURE_ARRAY
+    GP_PROFILE("Texture::upload");
+
+    GLuint textureId;
+    GL_ASSERT( glGenTextures(1, &textureId) );
+    GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, textureId);
+    GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 1) );
+    GL_ASSERT( glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, getInternalFormat(format), width, height, layerCount, 0, getPixelFormat(format), getPixelType(format), data) );
+
+    Filter minFilter = generateMipmaps ? NEAREST_MIPMAP_LINEAR : LINEAR;
+    GL_ASSERT( glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, minFilter) );
+
+    Texture* texture = new Texture();
+    texture->_handle = textureId;
+    texture->_type = TEXTURE_2D_ARRAY;
+    texture->_format = format;
+    texture->_width = width;
+    texture->_height = height;
+    texture->_layerCount = layerCount;
+    texture->_minFilter = minFilter;
+    if (generateMipmaps)
+    {
+        texture->generateMipmaps();
+    }
+    texture->trackMemorySize();
+
+    return texture;
+#else
+    return NULL;
+#endif
+}
+
+bool Texture::isArraySupported()
+{
+#if defined(USE_TEXTURE_ARRAY) && defined(__glew_h__)
+    return (GLEW_VERSION_3_0 || GLEW_EXT_texture_array) ? true : false;
+#else
+    return false;
+#endif
+}
+
+bool Texture::isSamplerObjectSupported()
+{
+#if defined(USE_SAMPLER_OBJECTS) && defined(__glew_h__)
+    return (GLEW_VERSION_3_3 || GLEW_ARB_sampler_objects) ? true : false;
+#else
+    return false;
+#endif
+}
+
+bool Texture::isBindlessSupported()
+{
+#if defined(USE_BINDLESS_TEXTURE) && defined(__glew_h__)
+    return GLEW_ARB_bindless_texture ? true : false;
+#else
+    return false;
+#endif
+}
+
+void Texture::setCacheBudget(unsigned int bytes)
+{
+    __textureCacheBudget = bytes;
+
+    // The cache holds a reference to each texture while it has a budget, which keeps textures
+    // that are no longer used elsewhere loaded until they are evicted.
+    std::vector<Texture*> textures(__textureCache);
+    for (size_t i = 0, count = textures.size(); i < count; ++i)
+    {
+        Texture* t = textures[i];
+        if (bytes > 0 && !t->_cacheReferenced)
+        {
+            t->_cacheReferenced = true;
+            t->addRef();
+        }
+        else if (bytes == 0 && t->_cacheReferenced)
+        {
+            t->_cacheReferenced = false;
+            t->release();
+        }
+    }
+    trimCache();
+}
+
+unsigned int Texture::getCacheBudget()
+{
+    return __textureCacheBudget;
+}
+
+unsigned int Texture::getCacheSize(bool unusedOnly)
+{
+    unsigned int size = 0;
+    for (size_t i = 0, count = __textureCache.size(); i < count; ++i)
+    {
+        Texture* t = __textureCache[i];
+        if (!unusedOnly || (t->_cacheReferenced && t->getRefCount() == 1))
+        {
+            size += t->getMemorySize();
+        }
+    }
+    return size;
+}
+
+void Texture::trimCache()
+{
+    // Textures that only the cache references are evicted, least recently used first,
+    // until the memory they use fits the budget.
+    std::vector<std::pair<unsigned int, Texture*> > unused;
+    unsigned int size = 0;
+    for (size_t i = 0, count = __textureCache.size(); i < count; ++i)
+    {
+        Texture* t = __textureCache[i];
+        if (t->_cacheReferenced && t->getRefCount() == 1)
+        {
+            unused.push_back(std::make_pair(t->_lastUsed, t));
+            size += t->getMemorySize();
+        }
+    }
+    std::sort(unused.begin(), unused.end());
+
+    for (size_t i = 0, count = unused.size(); i < count && size > __textureCacheBudget; ++i)
+    {
+        Texture* t = unused[i].second;
+        size -= t->getMemorySize();
+        t->_cacheReferenced = false;
+        t->release();
+    }
+}
+
+Texture* Texture::findCached(const char* path, bool generateMipmaps, Format decodeFormat, bool dither)
+{
+    for (size_t i = 0, count = __textureCache.size(); i < count; ++i)
+    {
+        Texture* t = __textureCache[i];
+        GP_ASSERT(t);
+        if (t->_path == path && t->_decodeFormat == decodeFormat && t->_decodeDither == dither)
+        {
+            // If 'generateMipmaps' is true, call Texture::generateMipamps() to force the 
+            // texture to generate its mipmap chain if it hasn't already done so.
+            if (generateMipmaps)
+            {
+                if (t->isLoaded())
+                    t->generateMipmaps();
+                else
+                    t->_asyncLoad->generateMipmaps = true;
+            }
+
+            // Found a match.
+            t->_lastUsed = ++__textureCacheClock;
+            t->addRef();
+
+            return t;
+        }
+    }
+    return NULL;
+}
+
+void Texture::addToCache(Texture* texture, const char* path, Format decodeFormat, bool dither)
+{
+    GP_ASSERT(texture);
+    GP_ASSERT(path);
+
+    texture->_path = path;
+    texture->_decodeFormat = decodeFormat;
+    texture->_decodeDither = dither;
+    texture->_cached = true;
+    texture->_lastUsed = ++__textureCacheClock;
+    if (__textureCacheBudget > 0)
+    {
+        texture->_cacheReferenced = true;
+        texture->addRef();
+    }
+    __textureCache.push_back(texture);
+}
+
+bool Texture::isCompressedFormatSupported(GLenum format)
+{
+    if (!__compressedFormatsQueried)
+    {
+        __compressedFormatsQueried = true;
+        GLint count = 0;
+        GL_ASSERT( glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count) );
+        if (count > 0)
+        {
+            __compressedFormats.resize(count);
+            GL_ASSERT( glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, &__compressedFormats[0]) );
+        }
+
+        // Some drivers expose ETC1 through the extension without listing it.
+        const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+        if (extensions && strstr(extensions, "GL_OES_compressed_ETC1_RGB8_texture"))
+        {
+            __compressedFormats.push_back(GL_ETC1_RGB8_OES);
+        }
+    }
+    return std::find(__compressedFormats.begin(), __compressedFormats.end(), (GLint)format) != __compressedFormats.end();
+}
+
+std::string Texture::findSupportedFile(const char* path)
+{
+    GP_ASSERT(path);
+
+    std::string file = path;
+    file += ".ktx";
+    if (FileSystem::fileExists(file.c_str()))
+    {
+        std::auto_ptr<Stream> stream(FileSystem::open(file.c_str()));
+        ktx_header header;
+        bool swap;
+        if (stream.get() && readKTXHeader(stream.get(), &header, &swap) && (header.glType != 0 || isCompressedFormatSupported(header.glInternalFormat)))
+            return file;
+    }
+
+    file = path;
+    file += ".pvr";
+    if (FileSystem::fileExists(file.c_str()) && isCompressedFormatSupported(GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG))
+        return file;
+
+    file = path;
+    file += ".dds";
+    if (FileSystem::fileExists(file.c_str()) && isCompressedFormatSupported(GL_COMPRESSED_RGBA_S3TC_DXT1_EXT))
+        return file;
+
+    file = path;
+    file += ".png";
+    return file;
+}
+
+Texture* Texture::createCompressedKTX(const char* path)
+{
+    GP_ASSERT(path);
+
+    // The file is mapped so the levels can be uploaded without copying them.
+    std::auto_ptr<Stream> stream(FileSystem::open(path, FileSystem::READ | FileSystem::MAP));
+    if (stream.get() == NULL || !stream->canRead())
+    {
+        GP_ERROR("Failed to open file '%s'.", path);
+        return NULL;
+    }
+
+    ktx_header header;
+    bool swap;
+    if (!readKTXHeader(stream.get(), &header, &swap))
+    {
+        GP_ERROR("Failed to read KTX file '%s': invalid KTX header.", path);
+        return NULL;
+    }
+    if (header.pixelDepth > 1 || header.numberOfFaces != 1)
+    {
+        GP_ERROR("Failed to create texture from KTX file '%s': only 2D textures and 2D texture arrays are supported.", path);
+        return NULL;
+    }
+    bool array = header.numberOfArrayElements > 0;
+    if (array && !isArraySupported())
+    {
+        GP_ERROR("Failed to create texture from KTX file '%s': texture arrays are not supported.", path);
+        return NULL;
+    }
+
+    // A gl type of zero means the data is compressed.
+    bool compressed = header.glType == 0;
+    if (compressed && !isCompressedFormatSupported(header.glInternalFormat))
+    {
+        GP_ERROR("Failed to create texture from KTX file '%s': compressed format 0x%x is not supported.", path, header.glInternalFormat);
+        return NULL;
+    }
+    if (!compressed && swap && header.glTypeSize > 1)
+    {
+        GP_ERROR("Failed to create texture from KTX file '%s': byte swapping of pixels is not supported.", path);
+        return NULL;
+    }
+
+    // Skip the key/value data.
+    if (header.bytesOfKeyValueData > 0 && stream->seek(header.bytesOfKeyValueData, SEEK_CUR) == false)
+    {
+        GP_ERROR("Failed to seek past the key/value data of KTX file '%s'.", path);
+        return NULL;
+    }
+
+    // Levels are generated when the file has none, which only uncompressed data allows.
+    bool generateMipmaps = header.numberOfMipmapLevels == 0 && !compressed;
+    unsigned int mipMapCount = std::max(header.numberOfMipmapLevels, 1u);
+
+    // Textures with mip levels are streamed when a streaming budget is set. Only the position
+    // of each level in the file is read here; the streamer loads the smallest levels.
+    // Texture arrays are always loaded whole.
+    TextureStreamer* streamer = Game::getInstance()->getTextureStreamer();
+    if (streamer && streamer->isEnabled() && mipMapCount > 1 && !array)
+    {
+        TextureStreamer::Entry* entry = new TextureStreamer::Entry();
+        entry->path = path;
+        entry->internalFormat = header.glInternalFormat;
+        entry->format = header.glFormat;
+        entry->type = header.glType;
+        entry->compressed = compressed;
+        for (unsigned int level = 0; level < mipMapCount; ++level)
+        {
+            unsigned int imageSize;
+            if (stream->read(&imageSize, sizeof(imageSize), 1) != 1)
+            {
+                GP_ERROR("Failed to read the size of mip level %d of KTX file '%s'.", level, path);
+                SAFE_DELETE(entry);
+                return NULL;
+            }
+            if (swap)
+            {
+                imageSize = swapBytes(imageSize);
+            }
+            entry->offsets.push_back((unsigned int)stream->position());
+            entry->sizes.push_back(imageSize);
+            if (!stream->seek((imageSize + 3) & ~3u, SEEK_CUR))
+            {
+                GP_ERROR("Failed to seek past mip level %d of KTX file '%s'.", level, path);
+                SAFE_DELETE(entry);
+                return NULL;
+            }
+        }
+        stream->close();
+
+        Texture* texture = new Texture();
+        texture->_width = header.pixelWidth;
+        texture->_height = std::max(header.pixelHeight, 1u);
+        texture->_mipmapped = true;
+        texture->_compressed = compressed;
+        texture->_minFilter = NEAREST_MIPMAP_LINEAR;
+        if (!compressed && (header.glFormat == RGB || header.glFormat == RGBA || header.glFormat == ALPHA))
+        {
+            texture->_format = (Format)header.glFormat;
+        }
+        if (!streamer->addTexture(texture, entry))
+        {
+            SAFE_RELEASE(texture);
+        }
+        return texture;
+    }
+
+    GLenum target = array ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+    GLuint textureId;
+    GL_ASSERT( glGenTextures(1, &textureId) );
+    GLStateCache::bindTexture(target, textureId);
+    GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 4) );
+
+    Filter minFilter = (mipMapCount > 1 || generateMipmaps) ? NEAREST_MIPMAP_LINEAR : LINEAR;
+    GL_ASSERT( glTexParameteri(target, GL_TEXTURE_MIN_FILTER, minFilter) );
+
+    Texture* texture = new Texture();
+    texture->_handle = textureId;
+    texture->_type = (Type)target;
+    texture->_width = header.pixelWidth;
+    texture->_height = std::max(header.pixelHeight, 1u);
+    texture->_layerCount = std::max(header.numberOfArrayElements, 1u);
+    texture->_mipmapped = mipMapCount > 1;
+    texture->_compressed = compressed;
+    texture->_minFilter = minFilter;
+    if (!compressed && (header.glFormat == RGB || header.glFormat == RGBA || header.glFormat == ALPHA))
+    {
+        texture->_format = (Format)header.glFormat;
+    }
+
+    // Load the data for each level, which is padded to 4 bytes. The data of a level of an
+    // array holds all of its layers.
+    GLsizei width = texture->_width;
+    GLsizei height = texture->_height;
+    std::vector<GLubyte> data;
+    for (unsigned int level = 0; level < mipMapCount; ++level)
+    {
+        unsigned int imageSize;
+        if (stream->read(&imageSize, sizeof(imageSize), 1) != 1)
+        {
+            GP_ERROR("Failed to read the size of mip level %d of KTX file '%s'.", level, path);
+            SAFE_RELEASE(texture);
+            return NULL;
+        }
+        if (swap)
+        {
+            imageSize = swapBytes(imageSize);
+        }
+        unsigned int paddedSize = (imageSize + 3) & ~3u;
+        const GLubyte* levelData = (const GLubyte*)stream->readDirect(paddedSize);
+        if (levelData == NULL)
+        {
+            data.resize(std::max(paddedSize, 1u));
+            if (stream->read(&data[0], 1, paddedSize) != paddedSize)
+            {
+                GP_ERROR("Failed to read mip level %d of KTX file '%s'.", level, path);
+                SAFE_RELEASE(texture);
+                return NULL;
+            }
+            levelData = &data[0];
+        }
+
+#ifdef USE_TEXTURE_ARRAY
+        if (array)
+        {
+            GLsizei layers = texture->_layerCount;
+            if (compressed)
+            {
+                GL_ASSERT( glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, header.glInternalFormat, width, height, layers, 0, imageSize, levelData) );
+            }
+            else
+            {
+                GL_ASSERT( glTexImage3D(GL_TEXTURE_2D_ARRAY, level, header.glInternalFormat, width, height, layers, 0, header.glFormat, header.glType, levelData) );
+            }
+        }
+        else
+#endif
+        if (compressed)
+        {
+            GL_ASSERT( glCompressedTexImage2D(GL_TEXTURE_2D, level, header.glInternalFormat, width, height, 0, imageSize, levelData) );
+        }
+        else
+        {
+            GL_ASSERT( glTexImage2D(GL_TEXTURE_2D, level, header.glInternalFormat, width, height, 0, header.glFormat, header.glType, levelData) );
+        }
+
+        width = std::max(width >> 1, 1);
+        height = std::max(height >> 1, 1);
+    }
+
+    if (generateMipmaps)
+    {
+        texture->generateMipmaps();
+    }
+    texture->trackMemorySize();
+
+    // Restore the texture id
+    GLStateCache::bindTexture(GL_TEXTURE_2D, __currentTextureId);
 
     return texture;
 }
@@ -275,7 +1204,7 @@ Texture* Texture::createCompressedPVRTC(const char* path)
     // Generate our texture.
     GLuint textureId;
     GL_ASSERT( glGenTextures(1, &textureId) );
-    GL_ASSERT( glBindTexture(GL_TEXTURE_2D, textureId) );
+    GLStateCache::bindTexture(GL_TEXTURE_2D, textureId);
 
     Filter minFilter = mipMapCount > 1 ? NEAREST_MIPMAP_LINEAR : LINEAR;
     GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter) );
@@ -304,6 +1233,7 @@ Texture* Texture::createCompressedPVRTC(const char* path)
 
     // Free data.
     SAFE_DELETE_ARRAY(data);
+    texture->trackMemorySize();
 
     return texture;
 }
@@ -771,7 +1701,7 @@ Texture* Texture::createCompressedDDS(const char* path)
     // Generate GL texture.
     GLuint textureId;
     GL_ASSERT( glGenTextures(1, &textureId) );
-    GL_ASSERT( glBindTexture(GL_TEXTURE_2D, textureId) );
+    GLStateCache::bindTexture(GL_TEXTURE_2D, textureId);
 
     Filter minFilter = header.dwMipMapCount > 1 ? NEAREST_MIPMAP_LINEAR : LINEAR;
     GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter ) );
@@ -804,6 +1734,7 @@ Texture* Texture::createCompressedDDS(const char* path)
 
     // Clean up mip levels structure.
     SAFE_DELETE_ARRAY(mipLevels);
+    texture->trackMemorySize();
 
     return texture;
 }
@@ -833,15 +1764,65 @@ TextureHandle Texture::getHandle() const
     return _handle;
 }
 
+Texture::Type Texture::getType() const
+{
+    return _type;
+}
+
+unsigned int Texture::getLayerCount() const
+{
+    return _layerCount;
+}
+
+void Texture::setLayerData(unsigned int layer, const unsigned char* data)
+{
+    GP_ASSERT(data);
+    GP_ASSERT(!_compressed);
+    GP_ASSERT(_type == TEXTURE_2D_ARRAY && layer < _layerCount);
+
+#ifdef USE_TEXTURE_ARRAY
+    GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, _handle);
+    GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 1) );
+    GL_ASSERT( glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, _width, _height, 1, getPixelFormat(_format), getPixelType(_format), data) );
+    if (_mipmapped)
+    {
+        GL_ASSERT( glGenerateMipmap(GL_TEXTURE_2D_ARRAY) );
+    }
+#endif
+}
+
+void Texture::setData(const unsigned char* data, unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+    GP_ASSERT(data);
+    GP_ASSERT(!_compressed);
+    GP_ASSERT(_type == TEXTURE_2D);
+    GP_ASSERT(x + width <= _width && y + height <= _height);
+
+    GLStateCache::bindTexture(GL_TEXTURE_2D, _handle);
+    GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 1) );
+    GL_ASSERT( glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, getPixelFormat(_format), getPixelType(_format), data) );
+    if (_mipmapped)
+    {
+        GL_ASSERT( glGenerateMipmap(GL_TEXTURE_2D) );
+    }
+
+    // Restore the texture id
+    GLStateCache::bindTexture(GL_TEXTURE_2D, __currentTextureId);
+}
+
 void Texture::generateMipmaps()
 {
     if (!_mipmapped)
     {
-        GL_ASSERT( glBindTexture(GL_TEXTURE_2D, _handle) );
+        // The levels of a texture that has bindless handles can no longer change.
+        GP_ASSERT(_bindlessHandles == 0);
+
+        GLStateCache::bindTexture((GLenum)_type, _handle);
         GL_ASSERT( glHint(GL_GENERATE_MIPMAP_HINT, GL_NICEST) );
-        GL_ASSERT( glGenerateMipmap(GL_TEXTURE_2D) );
+        GL_ASSERT( glGenerateMipmap((GLenum)_type) );
 
         _mipmapped = true;
+        trackMemorySize();
     }
 }
 
@@ -855,8 +1836,39 @@ bool Texture::isCompressed() const
     return _compressed;
 }
 
+unsigned int Texture::getMemorySize() const
+{
+    // Compressed textures are assumed to use 4 bits per pixel, as ETC1, PVRTC 4bpp and DXT1 do.
+    unsigned int size;
+    if (_compressed)
+        size = std::max(_width * _height / 2, 8u);
+    else
+        size = _width * _height * getBytesPerPixel(_format);
+
+    // A full mipmap chain adds a third.
+    if (_mipmapped)
+        size += size / 3;
+    return size * _layerCount;
+}
+
+void Texture::trackMemorySize()
+{
+    // The memory of streamed textures is counted by the texture streamer, level by level.
+    unsigned int size = _streamed || _handle == 0 ? 0 : getMemorySize();
+    if (size > _trackedSize)
+        MemoryStats::add(MemoryStats::GPU_TEXTURES, size - _trackedSize);
+    else
+        MemoryStats::remove(MemoryStats::GPU_TEXTURES, _trackedSize - size);
+    _trackedSize = size;
+}
+
+bool Texture::isLoaded() const
+{
+    return _asyncLoad == NULL || _asyncLoad->done;
+}
+
 Texture::Sampler::Sampler(Texture* texture)
-    : _texture(texture), _wrapS(Texture::REPEAT), _wrapT(Texture::REPEAT)
+    : _texture(texture), _wrapS(Texture::REPEAT), _wrapT(Texture::REPEAT), _layer(0), _samplerObject(0), _stateObject(0), _bindlessHandle(0)
 {
     GP_ASSERT(texture);
     _minFilter = texture->_minFilter;
@@ -865,6 +1877,7 @@ Texture::Sampler::Sampler(Texture* texture)
 
 Texture::Sampler::~Sampler()
 {
+    setBindless(false);
     SAFE_RELEASE(_texture);
 }
 
@@ -881,16 +1894,26 @@ Texture::Sampler* Texture::Sampler::create(const char* path, bool generateMipmap
     return texture ? new Sampler(texture) : NULL;
 }
 
+Texture::Sampler* Texture::Sampler::create(const char* path, bool generateMipmaps, Format format, bool dither)
+{
+    Texture* texture = Texture::create(path, generateMipmaps, format, dither);
+    return texture ? new Sampler(texture) : NULL;
+}
+
 void Texture::Sampler::setWrapMode(Wrap wrapS, Wrap wrapT)
 {
+    GP_ASSERT(_bindlessHandle == 0);
     _wrapS = wrapS;
     _wrapT = wrapT;
+    _stateObject = 0;
 }
 
 void Texture::Sampler::setFilterMode(Filter minificationFilter, Filter magnificationFilter)
 {
+    GP_ASSERT(_bindlessHandle == 0);
     _minFilter = minificationFilter;
     _magFilter = magnificationFilter;
+    _stateObject = 0;
 }
 
 Texture* Texture::Sampler::getTexture() const
@@ -898,34 +1921,134 @@ Texture* Texture::Sampler::getTexture() const
     return _texture;
 }
 
+void Texture::Sampler::setLayer(unsigned int layer)
+{
+    GP_ASSERT(layer < _texture->_layerCount);
+    _layer = layer;
+}
+
+unsigned int Texture::Sampler::getLayer() const
+{
+    return _layer;
+}
+
+bool Texture::Sampler::setBindless(bool bindless)
+{
+    GP_ASSERT(_texture);
+    if (bindless == (_bindlessHandle != 0))
+        return bindless;
+
+#ifdef USE_BINDLESS_TEXTURE
+    if (bindless)
+    {
+        // Streamed and loading textures still have levels to upload, which a handle would prevent.
+        if (!isBindlessSupported() || _texture->_streamed || !_texture->isLoaded())
+            return false;
+
+        // The handle samples with a sampler object holding the state of this sampler, so the
+        // parameters of the texture do not need to match it.
+        GL_ASSERT( glGenSamplers(1, &_samplerObject) );
+        GL_ASSERT( glSamplerParameteri(_samplerObject, GL_TEXTURE_MIN_FILTER, (GLenum)_minFilter) );
+        GL_ASSERT( glSamplerParameteri(_samplerObject, GL_TEXTURE_MAG_FILTER, (GLenum)_magFilter) );
+        GL_ASSERT( glSamplerParameteri(_samplerObject, GL_TEXTURE_WRAP_S, (GLenum)_wrapS) );
+        GL_ASSERT( glSamplerParameteri(_samplerObject, GL_TEXTURE_WRAP_T, (GLenum)_wrapT) );
+        GL_ASSERT( _bindlessHandle = glGetTextureSamplerHandleARB(_texture->_handle, _samplerObject) );
+        GL_ASSERT( glMakeTextureHandleResidentARB(_bindlessHandle) );
+        ++_texture->_bindlessHandles;
+    }
+    else
+    {
+        GL_ASSERT( glMakeTextureHandleNonResidentARB(_bindlessHandle) );
+        GL_ASSERT( glDeleteSamplers(1, &_samplerObject) );
+        _samplerObject = 0;
+        _bindlessHandle = 0;
+        --_texture->_bindlessHandles;
+    }
+    return bindless;
+#else
+    return false;
+#endif
+}
+
+bool Texture::Sampler::isBindless() const
+{
+    return _bindlessHandle != 0;
+}
+
+unsigned long long Texture::Sampler::getBindlessHandle() const
+{
+    return _bindlessHandle;
+}
+
+#ifdef USE_SAMPLER_OBJECTS
+/**
+ * Returns the shared sampler object with the specified state, creating it the first time.
+ */
+static GLuint getSamplerObject(Texture::Filter minFilter, Texture::Filter magFilter, Texture::Wrap wrapS, Texture::Wrap wrapT)
+{
+    // The GL enums of the filters and wrap modes all fit in 16 bits.
+    unsigned long long key = ((unsigned long long)minFilter << 48) | ((unsigned long long)magFilter << 32) |
+                             ((unsigned long long)wrapS << 16) | (unsigned long long)wrapT;
+    std::map<unsigned long long, GLuint>::const_iterator itr = __samplerObjects.find(key);
+    if (itr != __samplerObjects.end())
+        return itr->second;
+
+    GLuint sampler = 0;
+    GL_ASSERT( glGenSamplers(1, &sampler) );
+    GL_ASSERT( glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, (GLenum)minFilter) );
+    GL_ASSERT( glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, (GLenum)magFilter) );
+    GL_ASSERT( glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, (GLenum)wrapS) );
+    GL_ASSERT( glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, (GLenum)wrapT) );
+    __samplerObjects[key] = sampler;
+    return sampler;
+}
+#endif
+
 void Texture::Sampler::bind()
 {
     GP_ASSERT(_texture);
 
-    GL_ASSERT( glBindTexture(GL_TEXTURE_2D, _texture->_handle) );
+    GLenum target = (GLenum)_texture->_type;
+    GLStateCache::bindTexture(target, _texture->_handle);
+
+#ifdef USE_SAMPLER_OBJECTS
+    // The sampler state is bound to the texture unit, so textures shared by samplers with
+    // different states keep their parameters.
+    if (isSamplerObjectSupported())
+    {
+        if (_stateObject == 0)
+            _stateObject = getSamplerObject(_minFilter, _magFilter, _wrapS, _wrapT);
+        GLStateCache::bindSampler(_stateObject);
+        return;
+    }
+#endif
+
+    // The parameters of a texture that has bindless handles can no longer change.
+    if (_texture->_bindlessHandles > 0)
+        return;
 
     if (_texture->_minFilter != _minFilter)
     {
         _texture->_minFilter = _minFilter;
-        GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (GLenum)_minFilter) );
+        GL_ASSERT( glTexParameteri(target, GL_TEXTURE_MIN_FILTER, (GLenum)_minFilter) );
     }
 
     if (_texture->_magFilter != _magFilter)
     {
         _texture->_magFilter = _magFilter;
-        GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (GLenum)_magFilter) );
+        GL_ASSERT( glTexParameteri(target, GL_TEXTURE_MAG_FILTER, (GLenum)_magFilter) );
     }
 
     if (_texture->_wrapS != _wrapS)
     {
         _texture->_wrapS = _wrapS;
-        GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, (GLenum)_wrapS) );
+        GL_ASSERT( glTexParameteri(target, GL_TEXTURE_WRAP_S, (GLenum)_wrapS) );
     }
 
     if (_texture->_wrapT != _wrapT)
     {
         _texture->_wrapT = _wrapT;
-        GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, (GLenum)_wrapT) );
+        GL_ASSERT( glTexParameteri(target, GL_TEXTURE_WRAP_T, (GLenum)_wrapT) );
     }
 }
 
@@ -4,6 +4,11 @@
 #include "Ref.h"
 #include "Stream.h"
 
+// Texture arrays are core in OpenGL 3.0 and OpenGL ES 3.0.
+#ifndef GL_TEXTURE_2D_ARRAY
+#define GL_TEXTURE_2D_ARRAY 0x8C1A
+#endif
+
 namespace gameplay
 {
 
@@ -11,22 +16,37 @@ class Image;
 
 /**
  * Represents a texture.
+ *
+ * A texture is either a 2D texture or, where supported, a 2D texture array: a stack of
+ * layers of the same size and format that a shader samples as a sampler2DArray with a
+ * layer index. Drawing many objects that each use a different texture of the same size
+ * from the layers of one array needs no texture binds between them.
  */
 class Texture : public Ref
 {
     friend class Sampler;
+    friend class TextureStreamer;
+    friend class LightGrid;
+    friend class SceneLoader;
 
 public:
 
     /**
      * Defines the set of supported texture formats.
+     *
+     * The 16-bit formats take half the memory and bandwidth of RGBA, and their values are
+     * the GL pixel types that pack their channels into an unsigned short.
      */
     enum Format
     {
-        UNKNOWN = 0,
-        RGB     = GL_RGB,
-        RGBA    = GL_RGBA,
-        ALPHA   = GL_ALPHA
+        UNKNOWN   = 0,
+        RGB       = GL_RGB,
+        RGBA      = GL_RGBA,
+        ALPHA     = GL_ALPHA,
+        LUMINANCE = GL_LUMINANCE,
+        RGB565    = GL_UNSIGNED_SHORT_5_6_5,
+        RGBA4444  = GL_UNSIGNED_SHORT_4_4_4_4,
+        RGBA5551  = GL_UNSIGNED_SHORT_5_5_5_1
     };
 
     /**
@@ -50,6 +70,15 @@ public:
         REPEAT = GL_REPEAT,
         CLAMP = GL_CLAMP_TO_EDGE
     };
+
+    /**
+     * Defines the set of supported texture types.
+     */
+    enum Type
+    {
+        TEXTURE_2D = GL_TEXTURE_2D,
+        TEXTURE_2D_ARRAY = GL_TEXTURE_2D_ARRAY
+    };
     
     /**
      * Defines a texture sampler.
@@ -58,10 +87,20 @@ public:
      * used to sample a texture from a material. In addition to the texture
      * itself, a sampler stores per-instance texture state information, such
      * as wrap and filter modes.
+     *
+     * A sampler of a texture array also stores the layer it samples. When the sampler
+     * is set on a sampler2DArray uniform, the layer is set on the float uniform of the
+     * same name followed by "Layer" (for example u_diffuseTextureLayer), if the effect
+     * has one.
+     *
+     * Where bindless textures are supported (see Texture::isBindlessSupported), a sampler
+     * can be made bindless: it is then passed to shaders as a 64-bit handle rather than
+     * bound to a texture unit, so setting it costs no texture bind and uses no unit.
      */
     class Sampler : public Ref
     {
         friend class Texture;
+        friend class SpriteBatch;
 
     public:
 
@@ -91,6 +130,20 @@ public:
          */
         static Sampler* create(const char* path, bool generateMipmaps = false);
 
+        /**
+         * Creates a sampler for the specified texture, converting PNG images to a format.
+         *
+         * @param path Path to the texture to create a sampler for.
+         * @param generateMipmaps True to force a full mipmap chain to be generated for the texture, false otherwise.
+         * @param format The format PNG images are converted to when they are decoded.
+         * @param dither True to dither the channels that lose precision in the conversion.
+         *
+         * @return The new sampler.
+         * @see Texture::create(const char*, bool, Format, bool)
+         * @script{ignore}
+         */
+        static Sampler* create(const char* path, bool generateMipmaps, Format format, bool dither = false);
+
         /**
          * Sets the wrap mode for this sampler.
          *
@@ -114,6 +167,53 @@ public:
          */
         Texture* getTexture() const;
 
+        /**
+         * Sets the layer of a texture array that this sampler samples.
+         *
+         * @param layer The layer, less than the layer count of the texture.
+         * @script{ignore}
+         */
+        void setLayer(unsigned int layer);
+
+        /**
+         * Returns the layer of a texture array that this sampler samples.
+         *
+         * @return The layer, which is 0 for 2D textures.
+         * @script{ignore}
+         */
+        unsigned int getLayer() const;
+
+        /**
+         * Makes this sampler bindless, or bound to a texture unit again.
+         *
+         * The handle of a bindless sampler is created with the wrap and filter modes of the
+         * sampler, which can no longer change; neither can the parameters of its texture,
+         * so other samplers of the texture keep the state it had when the handle was made.
+         * Shaders must enable GL_ARB_bindless_texture to be passed bindless samplers.
+         *
+         * @param bindless True to pass the sampler to shaders as a handle.
+         *
+         * @return True if the sampler is bindless, false if bindless textures are not supported.
+         * @script{ignore}
+         */
+        bool setBindless(bool bindless);
+
+        /**
+         * Determines if this sampler is passed to shaders as a handle.
+         *
+         * @return True if the sampler is bindless.
+         * @script{ignore}
+         */
+        bool isBindless() const;
+
+        /**
+         * Returns the resident handle of a bindless sampler.
+         *
+         * @return The handle, or 0 if the sampler is not bindless.
+         * @script{ignore}
+         */
+        unsigned long long getBindlessHandle() const;
+
         /**
          * Binds the texture of this sampler to the renderer and applies the sampler state.
          */
@@ -136,6 +236,11 @@ public:
         Wrap _wrapT;
         Filter _minFilter;
         Filter _magFilter;
+        unsigned int _layer;
+        unsigned int _samplerObject;
+        // The shared sampler object bound with the texture, or 0 until it is first bound.
+        unsigned int _stateObject;
+        unsigned long long _bindlessHandle;
     };
 
     /**
@@ -144,7 +249,13 @@ public:
      * Note that for textures that include mipmap data in the source data (such as most compressed textures),
      * the generateMipmaps flags should NOT be set to true.
      *
-     * @param path The image resource path.
+     * PNG, PVR (PVRTC), DDS (DXT) and KTX files are supported. KTX files may hold ETC1, ETC2, EAC, ASTC
+     * or any other format the device supports, with their mip levels. If the path has no extension,
+     * the first file among path.ktx, path.pvr and path.dds whose format the device supports is loaded,
+     * and path.png otherwise, so that a texture can be shipped in several formats. KTX files
+     * with mip levels are streamed when a budget is set on the TextureStreamer of the game.
+     *
+     * @param path The image resource path, with or without an extension.
      * @param generateMipmaps true to auto-generate a full mipmap chain, false otherwise.
      * 
      * @return The new texture, or NULL if the texture could not be loaded/created.
@@ -152,6 +263,26 @@ public:
      */
     static Texture* create(const char* path, bool generateMipmaps = false);
 
+    /**
+     * Creates a texture from the given image resource, converting PNG images to a format when
+     * they are decoded.
+     *
+     * Textures whose colors do not need 8 bits per channel, such as most UI art, take half
+     * the memory as RGB565, RGBA4444 or RGBA5551, and masks a quarter as LUMINANCE or ALPHA.
+     * The conversion is done on the CPU before the upload (see Image::convert), so it has no
+     * effect on compressed files. Textures are only shared through the cache with textures
+     * created from the same path with the same format and dithering.
+     *
+     * @param path The image resource path, with or without an extension.
+     * @param generateMipmaps true to auto-generate a full mipmap chain, false otherwise.
+     * @param format The format PNG images are converted to, or UNKNOWN to keep their format.
+     * @param dither True to dither the channels that lose precision in the conversion.
+     *
+     * @return The new texture, or NULL if the texture could not be loaded/created.
+     * @script{ignore}
+     */
+    static Texture* create(const char* path, bool generateMipmaps, Format format, bool dither = false);
+
     /**
      * Creates a texture from the given image.
      *
@@ -199,6 +330,129 @@ public:
      */
     static Texture* create(TextureHandle handle, int width, int height, Format format = UNKNOWN);
 
+    /**
+     * Creates a texture array from a list of images, one per layer.
+     *
+     * The images must all have the same size and format. KTX files holding an array of
+     * layers are loaded as texture arrays by create() as well.
+     *
+     * @param images The images of the layers.
+     * @param count The number of images.
+     * @param generateMipmaps True to generate a full mipmap chain, false otherwise.
+     *
+     * @return The new texture array, or NULL if texture arrays are not supported or the images differ.
+     * @script{ignore}
+     */
+    static Texture* createArray(Image** images, unsigned int count, bool generateMipmaps = false);
+
+    /**
+     * Creates a texture array from the given texture data.
+     *
+     * The data is expected to be tightly packed, with the layers one after another.
+     *
+     * @param format Format of the texture data.
+     * @param width Width of each layer.
+     * @param height Height of each layer.
+     * @param layerCount The number of layers.
+     * @param data Raw texture data of all the layers, or NULL to leave the layers undefined.
+     * @param generateMipmaps True to generate a full mipmap chain, false otherwise.
+     *
+     * @return The new texture array, or NULL if texture arrays are not supported.
+     * @script{ignore}
+     */
+    static Texture* createArray(Format format, unsigned int width, unsigned int height, unsigned int layerCount,
+                                const unsigned char* data, bool generateMipmaps = false);
+
+    /**
+     * Determines if texture arrays are supported by the device.
+     *
+     * @return True if texture arrays can be created.
+     * @script{ignore}
+     */
+    static bool isArraySupported();
+
+    /**
+     * Determines if sampler objects (GL 3.3 or GL_ARB_sampler_objects) are supported by the device.
+     *
+     * Where they are, samplers bind a sampler object shared by all the samplers with the same
+     * state, instead of setting the parameters of their texture whenever they differ.
+     *
+     * @return True if samplers bind sampler objects.
+     * @script{ignore}
+     */
+    static bool isSamplerObjectSupported();
+
+    /**
+     * Determines if bindless textures (GL_ARB_bindless_texture) are supported by the device.
+     *
+     * @return True if samplers can be made bindless.
+     * @see Sampler::setBindless
+     * @script{ignore}
+     */
+    static bool isBindlessSupported();
+
+    /**
+     * Creates a texture from the given image resource, decoding the image on the worker threads.
+     *
+     * The texture is returned right away as a single white pixel, and its contents are replaced
+     * once the image is decoded and uploaded, some frames later (see isLoaded). PNG files are
+     * decoded asynchronously; other formats, which need no decoding, are loaded before this
+     * returns, as they are by create(). Textures are cached by path as they are by create(),
+     * including while they load. If the image cannot be loaded, a warning is logged and the
+     * texture stays white.
+     *
+     * Where pixel buffer objects are available, the pixels are copied into one on a worker
+     * thread and transferred by the driver without blocking. Otherwise they are uploaded a
+     * few rows per frame, so that a large image does not stall a single frame.
+     *
+     * @param path The image resource path, with or without an extension.
+     * @param generateMipmaps true to auto-generate a full mipmap chain once the image is uploaded, false otherwise.
+     *
+     * @return The new texture, or NULL if a texture in a format other than PNG could not be loaded.
+     * @script{create}
+     */
+    static Texture* createAsync(const char* path, bool generateMipmaps = false);
+
+    /**
+     * Sets the memory that textures loaded from files may keep using once they are no longer used.
+     *
+     * Textures created from a path are cached by that path, so loading the same path again
+     * returns the same texture. By default a texture leaves the cache when it is released
+     * for the last time. With a budget, the cache keeps its own reference to each texture,
+     * so textures that are no longer used stay loaded and are returned again if their path
+     * is loaded, for example by the next level. When the unused textures exceed the budget,
+     * the least recently used of them are destroyed. This is checked whenever a texture
+     * that is not in the cache is loaded.
+     *
+     * @param bytes The memory in bytes, as estimated by getMemorySize(), or 0 to destroy textures when they are no longer used.
+     * @script{ignore}
+     */
+    static void setCacheBudget(unsigned int bytes);
+
+    /**
+     * Returns the memory that unused textures may keep using.
+     *
+     * @return The budget in bytes.
+     * @script{ignore}
+     */
+    static unsigned int getCacheBudget();
+
+    /**
+     * Returns the estimated memory used by the textures in the cache.
+     *
+     * @param unusedOnly true to only count the textures that are no longer used outside the cache.
+     *
+     * @return The memory in bytes.
+     * @script{ignore}
+     */
+    static unsigned int getCacheSize(bool unusedOnly = false);
+
+    /**
+     * Destroys the least recently used of the unused textures in the cache, until they fit the budget.
+     * @script{ignore}
+     */
+    static void trimCache();
+
     /**
      * Returns the path that the texture was originally loaded from (if applicable).
      *
@@ -227,6 +481,50 @@ public:
      */
     unsigned int getHeight() const;
 
+    /**
+     * Returns the type of the texture.
+     *
+     * @return The texture type.
+     * @script{ignore}
+     */
+    Type getType() const;
+
+    /**
+     * Returns the number of layers of the texture.
+     *
+     * @return The number of layers of a texture array, or 1 for a 2D texture.
+     * @script{ignore}
+     */
+    unsigned int getLayerCount() const;
+
+    /**
+     * Replaces the data of a layer of a texture array.
+     *
+     * The data is expected to be tightly packed and in the format of the texture.
+     * The mipmap chain is regenerated if the texture is mipmapped.
+     *
+     * @param layer The layer to replace.
+     * @param data The new data of the layer.
+     * @script{ignore}
+     */
+    void setLayerData(unsigned int layer, const unsigned char* data);
+
+    /**
+     * Replaces the texture data within a rectangular area of the texture.
+     *
+     * The data is expected to be tightly packed and in the format of the texture. As with the
+     * data passed to create(), the first row of the data is the bottom row of the area.
+     * The mipmap chain is regenerated if the texture is mipmapped.
+     *
+     * @param data The new texture data of the area.
+     * @param x The offset of the area from the left edge of the texture, in pixels.
+     * @param y The offset of the area from the bottom edge of the texture, in pixels.
+     * @param width The width of the area.
+     * @param height The height of the area.
+     * @script{ignore}
+     */
+    void setData(const unsigned char* data, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+
     /**
      * Generates a full mipmap chain for this texture if it isn't already mipmapped.
      */
@@ -244,6 +542,23 @@ public:
      */
     bool isCompressed() const;
 
+    /**
+     * Determines if the image of a texture created with createAsync() has been uploaded.
+     *
+     * @return False while the image is loading, true otherwise (including when it failed to load).
+     */
+    bool isLoaded() const;
+
+    /**
+     * Returns an estimate of the GPU memory used by this texture.
+     *
+     * The estimate is based on the size and format of the texture, counting 4 bits per
+     * pixel for compressed textures and a third more for mipmapped textures.
+     *
+     * @return The memory in bytes.
+     */
+    unsigned int getMemorySize() const;
+
     /**
      * Returns the texture handle.
      *
@@ -273,24 +588,53 @@ private:
      */
     Texture& operator=(const Texture&);
 
+    class AsyncLoad;
+
     static Texture* createCompressedPVRTC(const char* path);
 
     static Texture* createCompressedDDS(const char* path);
 
+    static Texture* createCompressedKTX(const char* path);
+
+    static bool isCompressedFormatSupported(GLenum format);
+
+    static Texture* findCached(const char* path, bool generateMipmaps, Format decodeFormat = UNKNOWN, bool dither = false);
+
+    static void addToCache(Texture* texture, const char* path, Format decodeFormat = UNKNOWN, bool dither = false);
+
+    static std::string findSupportedFile(const char* path);
+
     static GLubyte* readCompressedPVRTC(const char* path, Stream* stream, GLsizei* width, GLsizei* height, GLenum* format, unsigned int* mipMapCount);
 
     static GLubyte* readCompressedPVRTCLegacy(const char* path, Stream* stream, GLsizei* width, GLsizei* height, GLenum* format, unsigned int* mipMapCount);
 
     static int getMaskByteIndex(unsigned int mask);
 
+    /**
+     * Updates the memory counted for the texture in MemoryStats after its size or format changed.
+     */
+    void trackMemorySize();
+
     std::string _path;
+    // The format and dithering the image was converted with when it was decoded, which are
+    // part of the key of the texture in the cache.
+    Format _decodeFormat;
+    bool _decodeDither;
     TextureHandle _handle;
+    Type _type;
     Format _format;
     unsigned int _width;
     unsigned int _height;
+    unsigned int _layerCount;
+    unsigned int _bindlessHandles;
     bool _mipmapped;
     bool _cached;
     bool _compressed;
+    bool _streamed;
+    AsyncLoad* _asyncLoad;
+    bool _cacheReferenced;
+    unsigned int _lastUsed;
+    unsigned int _trackedSize;
     Wrap _wrapS;
     Wrap _wrapT;
     Filter _minFilter;
@@ -0,0 +1,299 @@
+#include "Base.h"
+#include "TextureAtlas.h"
+#include "Image.h"
+
+namespace gameplay
+{
+
+TextureAtlas::TextureAtlas()
+    : _pageWidth(0), _pageHeight(0), _format(Texture::RGBA), _padding(0)
+{
+}
+
+TextureAtlas::~TextureAtlas()
+{
+    for (size_t i = 0, count = _pages.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_pages[i]->texture);
+        SAFE_DELETE(_pages[i]);
+    }
+    for (size_t i = 0, count = _regions.size(); i < count; ++i)
+    {
+        SAFE_DELETE(_regions[i]);
+    }
+}
+
+TextureAtlas* TextureAtlas::create(unsigned int pageWidth, unsigned int pageHeight, Texture::Format format, unsigned int padding)
+{
+    if (pageWidth == 0 || pageHeight == 0)
+    {
+        GP_ERROR("Invalid texture atlas page size (%d x %d).", pageWidth, pageHeight);
+        return NULL;
+    }
+    if (format != Texture::RGB && format != Texture::RGBA)
+    {
+        GP_ERROR("Unsupported texture atlas format (%d); only RGB and RGBA are supported.", format);
+        return NULL;
+    }
+
+    TextureAtlas* atlas = new TextureAtlas();
+    atlas->_pageWidth = pageWidth;
+    atlas->_pageHeight = pageHeight;
+    atlas->_format = format;
+    atlas->_padding = padding;
+    return atlas;
+}
+
+const TextureAtlas::Region* TextureAtlas::add(Image* image, const char* id)
+{
+    GP_ASSERT(image);
+
+    if (id && _regionsById.find(id) != _regionsById.end())
+    {
+        GP_ERROR("Texture atlas already contains an image with id '%s'.", id);
+        return NULL;
+    }
+
+    unsigned int width = image->getWidth() + _padding * 2;
+    unsigned int height = image->getHeight() + _padding * 2;
+    if (width > _pageWidth || height > _pageHeight)
+    {
+        GP_ERROR("Image (%d x %d) does not fit in a texture atlas page (%d x %d).", image->getWidth(), image->getHeight(), _pageWidth, _pageHeight);
+        return NULL;
+    }
+
+    // Place the image in the first page that has room for it.
+    unsigned int x, y;
+    Page* page = NULL;
+    unsigned int pageIndex = 0;
+    for (unsigned int count = _pages.size(); pageIndex < count; ++pageIndex)
+    {
+        if (pack(_pages[pageIndex], width, height, &x, &y))
+        {
+            page = _pages[pageIndex];
+            break;
+        }
+    }
+    if (page == NULL)
+    {
+        page = addPage();
+        if (page == NULL || !pack(page, width, height, &x, &y))
+            return NULL;
+    }
+
+    copyImage(image, page, x, y);
+
+    Region* region = new Region();
+    region->page = pageIndex;
+    region->bounds.set(x + _padding, y + _padding, image->getWidth(), image->getHeight());
+    region->u1 = region->bounds.x / (float)_pageWidth;
+    region->v1 = 1.0f - region->bounds.y / (float)_pageHeight;
+    region->u2 = region->bounds.right() / (float)_pageWidth;
+    region->v2 = 1.0f - region->bounds.bottom() / (float)_pageHeight;
+    _regions.push_back(region);
+    if (id)
+    {
+        _regionsById[id] = region;
+    }
+
+    return region;
+}
+
+const TextureAtlas::Region* TextureAtlas::add(const char* path)
+{
+    GP_ASSERT(path);
+
+    const Region* region = getRegion(path);
+    if (region)
+        return region;
+
+    Image* image = Image::create(path);
+    if (image == NULL)
+    {
+        GP_ERROR("Failed to load image '%s' for texture atlas.", path);
+        return NULL;
+    }
+    region = add(image, path);
+    SAFE_RELEASE(image);
+    return region;
+}
+
+const TextureAtlas::Region* TextureAtlas::getRegion(const char* id) const
+{
+    GP_ASSERT(id);
+
+    std::map<std::string, Region*>::const_iterator itr = _regionsById.find(id);
+    return itr != _regionsById.end() ? itr->second : NULL;
+}
+
+unsigned int TextureAtlas::getRegionCount() const
+{
+    return _regions.size();
+}
+
+const TextureAtlas::Region* TextureAtlas::getRegion(unsigned int index) const
+{
+    GP_ASSERT(index < _regions.size());
+    return _regions[index];
+}
+
+unsigned int TextureAtlas::getPageCount() const
+{
+    return _pages.size();
+}
+
+Texture* TextureAtlas::getPage(unsigned int index) const
+{
+    GP_ASSERT(index < _pages.size());
+    return _pages[index]->texture;
+}
+
+unsigned int TextureAtlas::getPageWidth() const
+{
+    return _pageWidth;
+}
+
+unsigned int TextureAtlas::getPageHeight() const
+{
+    return _pageHeight;
+}
+
+TextureAtlas::Page* TextureAtlas::addPage()
+{
+    // The contents of the page are only defined where images are copied to.
+    Texture* texture = Texture::create(_format, _pageWidth, _pageHeight, NULL);
+    if (texture == NULL)
+    {
+        GP_ERROR("Failed to create texture atlas page.");
+        return NULL;
+    }
+
+    Page* page = new Page();
+    page->texture = texture;
+    SkylineNode node = { 0, 0, _pageWidth };
+    page->skyline.push_back(node);
+    _pages.push_back(page);
+    return page;
+}
+
+bool TextureAtlas::pack(Page* page, unsigned int width, unsigned int height, unsigned int* x, unsigned int* y)
+{
+    GP_ASSERT(page);
+    GP_ASSERT(x);
+    GP_ASSERT(y);
+
+    // Find the position along the skyline where the rectangle ends up lowest (closest to the top
+    // of the page), preferring narrower segments so that wide gaps are kept for wide images.
+    std::vector<SkylineNode>& skyline = page->skyline;
+    size_t bestIndex = skyline.size();
+    unsigned int bestBottom = UINT_MAX;
+    unsigned int bestWidth = UINT_MAX;
+    for (size_t i = 0, count = skyline.size(); i < count; ++i)
+    {
+        if (skyline[i].x + width > _pageWidth)
+            break;
+
+        // The rectangle rests on the highest segment it spans.
+        unsigned int top = 0;
+        unsigned int widthLeft = width;
+        for (size_t j = i; widthLeft > 0; ++j)
+        {
+            GP_ASSERT(j < count);
+            top = std::max(top, skyline[j].y);
+            widthLeft -= std::min(widthLeft, skyline[j].width);
+        }
+        if (top + height > _pageHeight)
+            continue;
+
+        if (top + height < bestBottom || (top + height == bestBottom && skyline[i].width < bestWidth))
+        {
+            bestIndex = i;
+            bestBottom = top + height;
+            bestWidth = skyline[i].width;
+            *x = skyline[i].x;
+            *y = top;
+        }
+    }
+    if (bestIndex == skyline.size())
+        return false;
+
+    // Add a segment for the top of the rectangle and remove the parts of the segments it covers.
+    SkylineNode node = { *x, bestBottom, width };
+    skyline.insert(skyline.begin() + bestIndex, node);
+    for (size_t i = bestIndex + 1; i < skyline.size(); )
+    {
+        unsigned int previousRight = skyline[i - 1].x + skyline[i - 1].width;
+        if (skyline[i].x >= previousRight)
+            break;
+
+        unsigned int shrink = previousRight - skyline[i].x;
+        if (skyline[i].width <= shrink)
+        {
+            skyline.erase(skyline.begin() + i);
+        }
+        else
+        {
+            skyline[i].x += shrink;
+            skyline[i].width -= shrink;
+            break;
+        }
+    }
+
+    // Merge neighbouring segments of the same height.
+    for (size_t i = 1; i < skyline.size(); )
+    {
+        if (skyline[i - 1].y == skyline[i].y)
+        {
+            skyline[i - 1].width += skyline[i].width;
+            skyline.erase(skyline.begin() + i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    return true;
+}
+
+void TextureAtlas::copyImage(Image* image, Page* page, unsigned int x, unsigned int y)
+{
+    GP_ASSERT(image);
+    GP_ASSERT(image->getData());
+    GP_ASSERT(page);
+
+    unsigned int imageWidth = image->getWidth();
+    unsigned int imageHeight = image->getHeight();
+    unsigned int imageBpp = image->getFormat() == Image::RGBA ? 4 : 3;
+    unsigned int bpp = _format == Texture::RGBA ? 4 : 3;
+    unsigned int width = imageWidth + _padding * 2;
+    unsigned int height = imageHeight + _padding * 2;
+
+    // Convert the image to the page format, repeating its edge pixels in the padding.
+    // Like the image data, the rows are stored from the bottom up.
+    const unsigned char* src = image->getData();
+    unsigned char* data = new unsigned char[width * height * bpp];
+    unsigned char* dst = data;
+    for (unsigned int row = 0; row < height; ++row)
+    {
+        unsigned int imageRow = (unsigned int)std::min(std::max((int)row - (int)_padding, 0), (int)imageHeight - 1);
+        for (unsigned int column = 0; column < width; ++column, dst += bpp)
+        {
+            unsigned int imageColumn = (unsigned int)std::min(std::max((int)column - (int)_padding, 0), (int)imageWidth - 1);
+            const unsigned char* pixel = src + (imageRow * imageWidth + imageColumn) * imageBpp;
+            dst[0] = pixel[0];
+            dst[1] = pixel[1];
+            dst[2] = pixel[2];
+            if (bpp == 4)
+            {
+                dst[3] = imageBpp == 4 ? pixel[3] : 255;
+            }
+        }
+    }
+
+    // Texture rows are counted from the bottom of the page.
+    page->texture->setData(data, x, _pageHeight - y - height, width, height);
+    SAFE_DELETE_ARRAY(data);
+}
+
+}
@@ -0,0 +1,212 @@
+#ifndef TEXTUREATLAS_H_
+#define TEXTUREATLAS_H_
+
+#include "Ref.h"
+#include "Texture.h"
+#include "Rectangle.h"
+
+namespace gameplay
+{
+
+class Image;
+
+/**
+ * Packs images into shared textures at runtime.
+ *
+ * The atlas consists of one or more pages, which are textures of the same size. Each image
+ * that is added is copied into the first page that has room for it (a new page is created
+ * if none has), using a skyline packer that keeps the pages tightly filled. The region of
+ * a page an image was placed in can then be drawn by a SpriteBatch created for the atlas,
+ * which draws all the sprites of a page with a single draw call.
+ *
+ * Images are surrounded by a border of padding pixels that repeat their edges, so that
+ * filtering does not blend in the neighbouring images.
+ */
+class TextureAtlas : public Ref
+{
+public:
+
+    /**
+     * Defines an area of an atlas page that holds an image.
+     */
+    struct Region
+    {
+        /**
+         * The index of the page that holds the image.
+         */
+        unsigned int page;
+
+        /**
+         * The area of the page that holds the image, in pixels from the top left corner of the page.
+         */
+        Rectangle bounds;
+
+        /**
+         * u component of the top left corner of the image.
+         */
+        float u1;
+
+        /**
+         * v component of the top left corner of the image.
+         */
+        float v1;
+
+        /**
+         * u component of the bottom right corner of the image.
+         */
+        float u2;
+
+        /**
+         * v component of the bottom right corner of the image.
+         */
+        float v2;
+    };
+
+    /**
+     * Creates an empty texture atlas.
+     *
+     * @param pageWidth The width of the atlas pages.
+     * @param pageHeight The height of the atlas pages.
+     * @param format The texture format of the pages (RGB or RGBA).
+     * @param padding The number of pixels left around each image.
+     *
+     * @return The new texture atlas.
+     * @script{create}
+     */
+    static TextureAtlas* create(unsigned int pageWidth = 1024, unsigned int pageHeight = 1024, Texture::Format format = Texture::RGBA, unsigned int padding = 1);
+
+    /**
+     * Adds an image to the atlas.
+     *
+     * @param image The image to add.
+     * @param id An optional identifier to look the region up by.
+     *
+     * @return The region of the atlas that holds the image, or NULL if the image does not fit in a page.
+     *      The region remains valid until the atlas is destroyed.
+     * @script{ignore}
+     */
+    const Region* add(Image* image, const char* id = NULL);
+
+    /**
+     * Adds an image file to the atlas.
+     *
+     * The path is used as the identifier of the region, so images are only loaded once.
+     *
+     * @param path The path of the (PNG) image file.
+     *
+     * @return The region of the atlas that holds the image, or NULL if the image could not be added.
+     * @script{ignore}
+     */
+    const Region* add(const char* path);
+
+    /**
+     * Returns the region with the specified identifier.
+     *
+     * @param id The identifier the region was added with.
+     *
+     * @return The region, or NULL if there is no region with the identifier.
+     * @script{ignore}
+     */
+    const Region* getRegion(const char* id) const;
+
+    /**
+     * Returns the number of regions in the atlas.
+     *
+     * @return The number of regions.
+     */
+    unsigned int getRegionCount() const;
+
+    /**
+     * Returns the region at the specified index.
+     *
+     * @param index The index of the region, in the order the images were added.
+     *
+     * @return The region.
+     * @script{ignore}
+     */
+    const Region* getRegion(unsigned int index) const;
+
+    /**
+     * Returns the number of pages in the atlas.
+     *
+     * @return The number of pages.
+     */
+    unsigned int getPageCount() const;
+
+    /**
+     * Returns the texture of the page at the specified index.
+     *
+     * @param index The index of the page.
+     *
+     * @return The texture of the page.
+     */
+    Texture* getPage(unsigned int index) const;
+
+    /**
+     * Returns the width of the atlas pages.
+     *
+     * @return The page width.
+     */
+    unsigned int getPageWidth() const;
+
+    /**
+     * Returns the height of the atlas pages.
+     *
+     * @return The page height.
+     */
+    unsigned int getPageHeight() const;
+
+private:
+
+    /**
+     * A horizontal segment of the top of the packed area of a page.
+     */
+    struct SkylineNode
+    {
+        unsigned int x;
+        unsigned int y;
+        unsigned int width;
+    };
+
+    /**
+     * An atlas page.
+     */
+    struct Page
+    {
+        Texture* texture;
+        std::vector<SkylineNode> skyline;
+    };
+
+    /**
+     * Constructor.
+     */
+    TextureAtlas();
+
+    /**
+     * Destructor.
+     */
+    ~TextureAtlas();
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    TextureAtlas& operator=(const TextureAtlas&);
+
+    Page* addPage();
+
+    bool pack(Page* page, unsigned int width, unsigned int height, unsigned int* x, unsigned int* y);
+
+    void copyImage(Image* image, Page* page, unsigned int x, unsigned int y);
+
+    unsigned int _pageWidth;
+    unsigned int _pageHeight;
+    Texture::Format _format;
+    unsigned int _padding;
+    std::vector<Page*> _pages;
+    std::vector<Region*> _regions;
+    std::map<std::string, Region*> _regionsById;
+};
+
+}
+
+#endif
@@ -0,0 +1,541 @@
+#include "Base.h"
+#include "GLStateCache.h"
+#include "TextureStreamer.h"
+#include "Texture.h"
+#include "Game.h"
+#include "Camera.h"
+#include "Node.h"
+#include "Model.h"
+#include "Material.h"
+#include "Technique.h"
+#include "Pass.h"
+#include "MaterialParameter.h"
+#include "FileSystem.h"
+#include "MemoryStats.h"
+
+// The number of textures whose larger levels may be loading at the same time.
+#define MAX_PENDING_LOADS 2
+
+// The default size of the largest level loaded when a streamed texture is created.
+#define DEFAULT_MINIMUM_LEVEL_SIZE 64
+
+namespace gameplay
+{
+
+/**
+ * Reads the levels of a texture on a worker thread, then replaces its resident levels on the main thread.
+ */
+class TextureStreamer::Load
+{
+public:
+
+    class ReadJob : public JobController::Job
+    {
+    public:
+        Load* load;
+        void run() { load->read(); }
+    };
+
+    class UploadJob : public JobController::Job
+    {
+    public:
+        Load* load;
+        void run() { load->streamer->completeLoad(load); }
+    };
+
+    Load(TextureStreamer* streamer, Entry* entry, unsigned int level)
+        : streamer(streamer), entry(entry), level(level), failed(false)
+    {
+        readJob.load = this;
+        uploadJob.load = this;
+    }
+
+    void read()
+    {
+        failed = !TextureStreamer::readLevels(*entry, level, &data);
+    }
+
+    TextureStreamer* streamer;
+    Entry* entry;
+    unsigned int level;
+    std::vector<unsigned char> data;
+    bool failed;
+    ReadJob readJob;
+    UploadJob uploadJob;
+    JobController::JobId id;
+};
+
+TextureStreamer::Entry::Entry()
+    : texture(NULL), internalFormat(0), format(0), type(0), compressed(false), minimumLevel(0),
+      residentLevel(0), requestedLevel(0), targetLevel(0), frame(0), load(NULL)
+{
+}
+
+TextureStreamer::TextureStreamer()
+    : _budget(0), _minimumLevelSize(DEFAULT_MINIMUM_LEVEL_SIZE), _residentSize(0), _frame(0)
+{
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    GP_ASSERT(_entries.empty());
+    GP_ASSERT(_loads.empty());
+}
+
+void TextureStreamer::finalize()
+{
+    // Wait for the loads in progress, which release their textures once they are uploaded.
+    if (!_loads.empty())
+    {
+        std::vector<JobController::JobId> ids;
+        for (unsigned int i = 0; i < _loads.size(); ++i)
+        {
+            ids.push_back(_loads[i]->id);
+        }
+        Game::getInstance()->getJobController()->wait(&ids[0], ids.size());
+    }
+
+    for (unsigned int i = 0; i < _completedLoads.size(); ++i)
+    {
+        SAFE_DELETE(_completedLoads[i]);
+    }
+    _completedLoads.clear();
+
+    // Textures that outlive the streamer keep the levels that are resident.
+    for (std::map<Texture*, Entry*>::iterator itr = _entries.begin(); itr != _entries.end(); ++itr)
+    {
+        itr->first->_streamed = false;
+        itr->first->trackMemorySize();
+        SAFE_DELETE(itr->second);
+    }
+    _entries.clear();
+    MemoryStats::remove(MemoryStats::GPU_TEXTURES, _residentSize);
+    _residentSize = 0;
+}
+
+void TextureStreamer::setBudget(unsigned int bytes)
+{
+    _budget = bytes;
+}
+
+unsigned int TextureStreamer::getBudget() const
+{
+    return _budget;
+}
+
+bool TextureStreamer::isEnabled() const
+{
+    return _budget > 0;
+}
+
+void TextureStreamer::setMinimumLevelSize(unsigned int size)
+{
+    _minimumLevelSize = std::max(size, 1u);
+}
+
+unsigned int TextureStreamer::getMinimumLevelSize() const
+{
+    return _minimumLevelSize;
+}
+
+unsigned int TextureStreamer::getResidentSize() const
+{
+    return _residentSize;
+}
+
+unsigned int TextureStreamer::getTextureCount() const
+{
+    return _entries.size();
+}
+
+unsigned int TextureStreamer::getPendingCount() const
+{
+    return _loads.size();
+}
+
+unsigned int TextureStreamer::getResidentLevel(Texture* texture) const
+{
+    std::map<Texture*, Entry*>::const_iterator itr = _entries.find(texture);
+    return itr != _entries.end() ? itr->second->residentLevel : 0;
+}
+
+void TextureStreamer::request(Texture* texture, unsigned int level)
+{
+    std::map<Texture*, Entry*>::iterator itr = _entries.find(texture);
+    if (itr != _entries.end())
+    {
+        requestLevel(itr->second, level);
+    }
+}
+
+void TextureStreamer::update(Camera* camera, const std::vector<Node*>& nodes)
+{
+    for (unsigned int i = 0; i < _completedLoads.size(); ++i)
+    {
+        SAFE_DELETE(_completedLoads[i]);
+    }
+    _completedLoads.clear();
+
+    if (!_entries.empty())
+    {
+        if (camera && !nodes.empty())
+        {
+            // The number of pixels covered by one unit at a distance of one unit from the camera.
+            const float scale = camera->getProjectionMatrix().m[5] * Game::getInstance()->getViewport().height * 0.5f;
+            const bool perspective = camera->getCameraType() == Camera::PERSPECTIVE;
+            Vector3 eye;
+            if (camera->getNode())
+            {
+                eye = camera->getNode()->getTranslationWorld();
+            }
+
+            for (unsigned int i = 0; i < nodes.size(); ++i)
+            {
+                Node* node = nodes[i];
+                Model* model = node ? node->getModel() : NULL;
+                if (model == NULL)
+                {
+                    continue;
+                }
+
+                // Estimate the size of the model on screen from its bounding sphere.
+                const BoundingSphere& sphere = node->getBoundingSphere();
+                float pixels = 2.0f * sphere.radius * scale;
+                if (perspective)
+                {
+                    float distance = sphere.center.distance(eye);
+                    pixels = distance > sphere.radius ? pixels / distance : FLT_MAX;
+                }
+
+                unsigned int partCount = model->getMeshPartCount();
+                if (partCount == 0)
+                {
+                    requestMaterial(model->getMaterial(), pixels);
+                }
+                for (unsigned int j = 0; j < partCount; ++j)
+                {
+                    requestMaterial(model->getMaterial(j), pixels);
+                }
+            }
+        }
+
+        schedule();
+    }
+
+    ++_frame;
+}
+
+bool TextureStreamer::addTexture(Texture* texture, Entry* entry)
+{
+    GP_ASSERT(texture);
+    GP_ASSERT(entry);
+    GP_ASSERT(!entry->offsets.empty() && entry->offsets.size() == entry->sizes.size());
+
+    // Find the largest level that fits the minimum level size.
+    const unsigned int count = entry->offsets.size();
+    unsigned int level = 0;
+    while (level + 1 < count && std::max(texture->_width >> level, texture->_height >> level) > _minimumLevelSize)
+    {
+        ++level;
+    }
+
+    std::vector<unsigned char> data;
+    entry->texture = texture;
+    if (!readLevels(*entry, level, &data))
+    {
+        GP_ERROR("Failed to read mip level %d of texture '%s'.", level, entry->path.c_str());
+        SAFE_DELETE(entry);
+        return false;
+    }
+
+    entry->minimumLevel = level;
+    entry->residentLevel = count;
+    entry->requestedLevel = level;
+    entry->targetLevel = level;
+    entry->frame = _frame;
+    upload(entry, level, &data[0]);
+
+    texture->_streamed = true;
+    _entries[texture] = entry;
+    return true;
+}
+
+void TextureStreamer::removeTexture(Texture* texture)
+{
+    std::map<Texture*, Entry*>::iterator itr = _entries.find(texture);
+    if (itr != _entries.end())
+    {
+        // A pending load holds a reference to the texture, so it cannot be destroyed while loading.
+        Entry* entry = itr->second;
+        GP_ASSERT(entry->load == NULL);
+        unsigned int size = getLevelsSize(*entry, entry->residentLevel);
+        _residentSize -= size;
+        MemoryStats::remove(MemoryStats::GPU_TEXTURES, size);
+        SAFE_DELETE(entry);
+        _entries.erase(itr);
+    }
+}
+
+void TextureStreamer::requestMaterial(Material* material, float pixels)
+{
+    if (material == NULL)
+    {
+        return;
+    }
+
+    // Samplers may be set on the material, its current technique or the passes of the technique.
+    std::vector<RenderState*> states;
+    states.push_back(material);
+    Technique* technique = material->getTechnique();
+    if (technique)
+    {
+        states.push_back(technique);
+        for (unsigned int i = 0, count = technique->getPassCount(); i < count; ++i)
+        {
+            states.push_back(technique->getPassByIndex(i));
+        }
+    }
+
+    for (unsigned int i = 0; i < states.size(); ++i)
+    {
+        const std::vector<MaterialParameter*>& parameters = states[i]->_parameters;
+        for (unsigned int j = 0; j < parameters.size(); ++j)
+        {
+            MaterialParameter* parameter = parameters[j];
+            unsigned int samplerCount = 0;
+            if (parameter->_type == MaterialParameter::SAMPLER)
+                samplerCount = 1;
+            else if (parameter->_type == MaterialParameter::SAMPLER_ARRAY)
+                samplerCount = parameter->_count;
+
+            for (unsigned int k = 0; k < samplerCount; ++k)
+            {
+                Texture::Sampler* sampler = parameter->getSampler(k);
+                std::map<Texture*, Entry*>::iterator itr = sampler ? _entries.find(sampler->getTexture()) : _entries.end();
+                if (itr == _entries.end())
+                {
+                    continue;
+                }
+
+                // Each level halves the size of the texture, so the level needed is the number of
+                // times the texture can be halved before it is smaller than the model on screen.
+                Entry* entry = itr->second;
+                float size = (float)std::max(entry->texture->_width, entry->texture->_height);
+                unsigned int level = 0;
+                while (level < entry->minimumLevel && size * 0.5f >= pixels)
+                {
+                    size *= 0.5f;
+                    ++level;
+                }
+                requestLevel(entry, level);
+            }
+        }
+    }
+}
+
+void TextureStreamer::requestLevel(Entry* entry, unsigned int level)
+{
+    GP_ASSERT(entry);
+
+    level = std::min(level, entry->minimumLevel);
+    if (entry->frame == _frame)
+    {
+        entry->requestedLevel = std::min(entry->requestedLevel, level);
+    }
+    else
+    {
+        entry->requestedLevel = level;
+        entry->frame = _frame;
+    }
+}
+
+void TextureStreamer::schedule()
+{
+    // Allocate the budget to the most recently used textures first. Every texture keeps its
+    // smallest levels, and each texture gets the largest of its requested levels that fits.
+    std::vector<std::pair<unsigned int, Entry*> > order;
+    unsigned int total = 0;
+    for (std::map<Texture*, Entry*>::iterator itr = _entries.begin(); itr != _entries.end(); ++itr)
+    {
+        Entry* entry = itr->second;
+        // Sorting by the number of frames since the last request puts the most recently used first.
+        order.push_back(std::make_pair(_frame - entry->frame, entry));
+        total += getLevelsSize(*entry, entry->minimumLevel);
+    }
+    std::sort(order.begin(), order.end());
+
+    for (unsigned int i = 0; i < order.size(); ++i)
+    {
+        Entry* entry = order[i].second;
+        const unsigned int minimumSize = getLevelsSize(*entry, entry->minimumLevel);
+        unsigned int level = entry->requestedLevel;
+        while (level < entry->minimumLevel && total + getLevelsSize(*entry, level) - minimumSize > _budget)
+        {
+            ++level;
+        }
+        entry->targetLevel = level;
+        total += getLevelsSize(*entry, level) - minimumSize;
+    }
+
+    // Include the loads in progress in the memory that will be resident.
+    unsigned int projected = _residentSize;
+    for (unsigned int i = 0; i < _loads.size(); ++i)
+    {
+        const Entry* entry = _loads[i]->entry;
+        projected += getLevelsSize(*entry, _loads[i]->level);
+        projected -= getLevelsSize(*entry, entry->residentLevel);
+    }
+
+    // Levels that are no longer requested stay resident until the memory is needed. The
+    // least recently used textures are then reduced first.
+    for (unsigned int i = order.size(); i-- > 0 && projected > _budget;)
+    {
+        Entry* entry = order[i].second;
+        if (entry->load == NULL && entry->targetLevel > entry->residentLevel)
+        {
+            projected -= getLevelsSize(*entry, entry->residentLevel);
+            projected += getLevelsSize(*entry, entry->targetLevel);
+            startLoad(entry, entry->targetLevel);
+        }
+    }
+
+    // Load the larger levels of the most recently used textures first, while they fit.
+    for (unsigned int i = 0; i < order.size() && _loads.size() < MAX_PENDING_LOADS; ++i)
+    {
+        Entry* entry = order[i].second;
+        if (entry->load == NULL && entry->targetLevel < entry->residentLevel)
+        {
+            unsigned int size = projected + getLevelsSize(*entry, entry->targetLevel) - getLevelsSize(*entry, entry->residentLevel);
+            if (size <= _budget)
+            {
+                projected = size;
+                startLoad(entry, entry->targetLevel);
+            }
+        }
+    }
+}
+
+void TextureStreamer::startLoad(Entry* entry, unsigned int level)
+{
+    GP_ASSERT(entry && entry->load == NULL);
+
+    // The texture is kept alive until the load is complete.
+    Load* load = new Load(this, entry, level);
+    entry->load = load;
+    entry->texture->addRef();
+    _loads.push_back(load);
+
+    JobController* jobController = Game::getInstance()->getJobController();
+    GP_ASSERT(jobController);
+    JobController::JobId readId = jobController->add(&load->readJob);
+    load->id = jobController->add(&load->uploadJob, readId, JobController::MAIN_THREAD);
+}
+
+void TextureStreamer::completeLoad(Load* load)
+{
+    GP_ASSERT(load);
+
+    std::vector<Load*>::iterator itr = std::find(_loads.begin(), _loads.end(), load);
+    GP_ASSERT(itr != _loads.end());
+    _loads.erase(itr);
+
+    Entry* entry = load->entry;
+    entry->load = NULL;
+    if (load->failed)
+    {
+        // Keep the levels that are resident and stop streaming the texture.
+        GP_WARN("Failed to read mip level %d of texture '%s'.", load->level, entry->path.c_str());
+        entry->minimumLevel = entry->residentLevel;
+    }
+    else
+    {
+        upload(entry, load->level, &load->data[0]);
+    }
+
+    // The jobs of the load are deleted once they are complete, during the next update.
+    load->data.clear();
+    _completedLoads.push_back(load);
+
+    // Releasing the texture may destroy it and its entry.
+    entry->texture->release();
+}
+
+void TextureStreamer::upload(Entry* entry, unsigned int level, const unsigned char* data)
+{
+    GP_ASSERT(entry && entry->texture);
+    GP_ASSERT(data);
+
+    // Create a new texture object whose first level is the requested level, with the sampler
+    // state of the texture, and replace the texture object that is resident.
+    Texture* texture = entry->texture;
+    GLuint handle;
+    GL_ASSERT( glGenTextures(1, &handle) );
+    GLStateCache::bindTexture(GL_TEXTURE_2D, handle);
+    GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 4) );
+    GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (GLenum)texture->_minFilter) );
+    GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (GLenum)texture->_magFilter) );
+    GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, (GLenum)texture->_wrapS) );
+    GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, (GLenum)texture->_wrapT) );
+
+    const unsigned int base = entry->offsets[level];
+    GLsizei width = std::max(texture->_width >> level, 1u);
+    GLsizei height = std::max(texture->_height >> level, 1u);
+    for (unsigned int i = level; i < entry->offsets.size(); ++i)
+    {
+        const unsigned char* pixels = data + (entry->offsets[i] - base);
+        if (entry->compressed)
+        {
+            GL_ASSERT( glCompressedTexImage2D(GL_TEXTURE_2D, i - level, entry->internalFormat, width, height, 0, entry->sizes[i], pixels) );
+        }
+        else
+        {
+            GL_ASSERT( glTexImage2D(GL_TEXTURE_2D, i - level, entry->internalFormat, width, height, 0, entry->format, entry->type, pixels) );
+        }
+        width = std::max(width >> 1, 1);
+        height = std::max(height >> 1, 1);
+    }
+    GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+
+    if (texture->_handle)
+    {
+        GLStateCache::deleteTextures(1, &texture->_handle);
+    }
+    texture->_handle = handle;
+
+    unsigned int oldSize = getLevelsSize(*entry, entry->residentLevel);
+    unsigned int newSize = getLevelsSize(*entry, level);
+    _residentSize += newSize - oldSize;
+    MemoryStats::remove(MemoryStats::GPU_TEXTURES, oldSize);
+    MemoryStats::add(MemoryStats::GPU_TEXTURES, newSize);
+    entry->residentLevel = level;
+}
+
+bool TextureStreamer::readLevels(const Entry& entry, unsigned int level, std::vector<unsigned char>* data)
+{
+    GP_ASSERT(data);
+    GP_ASSERT(level < entry.offsets.size());
+
+    // The levels are stored in order, so the requested level and all smaller levels are read
+    // at once, along with the sizes and padding between them. This runs on the worker threads.
+    std::auto_ptr<Stream> stream(FileSystem::open(entry.path.c_str()));
+    if (stream.get() == NULL || !stream->canRead() || !stream->seek(entry.offsets[level], SEEK_SET))
+    {
+        return false;
+    }
+
+    const unsigned int size = entry.offsets.back() + entry.sizes.back() - entry.offsets[level];
+    data->resize(std::max(size, 1u));
+    return stream->read(&(*data)[0], 1, size) == size;
+}
+
+unsigned int TextureStreamer::getLevelsSize(const Entry& entry, unsigned int level)
+{
+    unsigned int size = 0;
+    for (unsigned int i = level; i < entry.sizes.size(); ++i)
+    {
+        size += entry.sizes[i];
+    }
+    return size;
+}
+
+}
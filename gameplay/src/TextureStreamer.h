@@ -0,0 +1,218 @@
+#ifndef TEXTURESTREAMER_H_
+#define TEXTURESTREAMER_H_
+
+#include "JobController.h"
+
+namespace gameplay
+{
+
+class Texture;
+class Camera;
+class Node;
+class Material;
+
+/**
+ * Defines a class that streams the mip levels of textures within a GPU memory budget.
+ *
+ * Streaming is disabled until a budget is set. While it is enabled, textures loaded from
+ * KTX files that contain mip levels are created with only their smallest levels, those no
+ * larger than getMinimumLevelSize(). Each frame, update() estimates the level each texture
+ * needs from the screen size of the visible models whose materials use it, and the larger
+ * levels are then read on the worker threads and uploaded on the main thread. The most
+ * recently used textures are given their levels first; when the budget is exceeded, the
+ * textures that were used least recently are reduced back towards their smallest levels.
+ *
+ * Streamed textures always report the size of their largest level. Since OpenGL ES 2
+ * cannot limit the levels a texture samples, the levels are changed by creating a new
+ * texture object, so the handle of a streamed texture changes while it streams.
+ *
+ * @script{ignore}
+ */
+class TextureStreamer
+{
+    friend class Game;
+    friend class Texture;
+
+public:
+
+    /**
+     * Sets the amount of GPU memory the levels of streamed textures may use.
+     *
+     * The smallest levels of streamed textures are always resident, even when they exceed
+     * the budget. Textures that were loaded while streaming was enabled remain streamed.
+     *
+     * @param bytes The budget in bytes, or 0 to disable streaming of textures loaded from now on.
+     */
+    void setBudget(unsigned int bytes);
+
+    /**
+     * Returns the GPU memory budget of streamed textures.
+     *
+     * @return The budget in bytes, or 0 if streaming is disabled.
+     */
+    unsigned int getBudget() const;
+
+    /**
+     * Determines whether textures are streamed when they are loaded.
+     *
+     * @return True if a budget is set, false otherwise.
+     */
+    bool isEnabled() const;
+
+    /**
+     * Sets the size of the largest level that is loaded when a streamed texture is created.
+     *
+     * @param size The width and height in pixels. The default is 64.
+     */
+    void setMinimumLevelSize(unsigned int size);
+
+    /**
+     * Returns the size of the largest level that is loaded when a streamed texture is created.
+     *
+     * @return The width and height in pixels.
+     */
+    unsigned int getMinimumLevelSize() const;
+
+    /**
+     * Returns the GPU memory used by the resident levels of streamed textures.
+     *
+     * @return The size in bytes.
+     */
+    unsigned int getResidentSize() const;
+
+    /**
+     * Returns the number of streamed textures.
+     *
+     * @return The number of textures.
+     */
+    unsigned int getTextureCount() const;
+
+    /**
+     * Returns the number of textures whose levels are being loaded.
+     *
+     * @return The number of loads in progress.
+     */
+    unsigned int getPendingCount() const;
+
+    /**
+     * Returns the largest level of a streamed texture that is resident.
+     *
+     * @param texture The texture.
+     *
+     * @return The index of the level, where 0 is the full size of the texture.
+     */
+    unsigned int getResidentLevel(Texture* texture) const;
+
+    /**
+     * Requests a level of a streamed texture for the current frame.
+     *
+     * This can be used for textures that are not drawn by models, such as those of sprites.
+     * Textures that are not streamed are ignored.
+     *
+     * @param texture The texture.
+     * @param level The level needed, where 0 is the full size of the texture.
+     */
+    void request(Texture* texture, unsigned int level);
+
+    /**
+     * Requests the levels of the textures used by a set of models, and starts loading or
+     * evicting levels to match the requests of this and previous frames.
+     *
+     * This should be called once per frame, with the nodes that are visible from the camera.
+     *
+     * @param camera The camera the nodes are drawn with.
+     * @param nodes The visible nodes. Nodes without a model are ignored.
+     */
+    void update(Camera* camera, const std::vector<Node*>& nodes);
+
+private:
+
+    class Load;
+
+    /**
+     * The levels of a streamed texture and where they are stored in its file.
+     */
+    struct Entry
+    {
+        Entry();
+
+        Texture* texture;
+        std::string path;
+        unsigned int internalFormat;
+        unsigned int format;
+        unsigned int type;
+        bool compressed;
+        std::vector<unsigned int> offsets;
+        std::vector<unsigned int> sizes;
+        unsigned int minimumLevel;
+        unsigned int residentLevel;
+        unsigned int requestedLevel;
+        unsigned int targetLevel;
+        unsigned int frame;
+        Load* load;
+    };
+
+    /**
+     * Constructor.
+     */
+    TextureStreamer();
+
+    /**
+     * Destructor.
+     */
+    ~TextureStreamer();
+
+    /**
+     * Hidden copy constructor.
+     */
+    TextureStreamer(const TextureStreamer&);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    TextureStreamer& operator=(const TextureStreamer&);
+
+    /**
+     * Called during shutdown to wait for the loads in progress.
+     */
+    void finalize();
+
+    /**
+     * Called by Texture to start streaming a texture, once the levels of its file are known.
+     * The smallest levels are loaded before this returns. The streamer takes ownership of the entry.
+     */
+    bool addTexture(Texture* texture, Entry* entry);
+
+    /**
+     * Called by Texture when a streamed texture is destroyed.
+     */
+    void removeTexture(Texture* texture);
+
+    void requestMaterial(Material* material, float pixels);
+
+    void requestLevel(Entry* entry, unsigned int level);
+
+    void schedule();
+
+    void startLoad(Entry* entry, unsigned int level);
+
+    void completeLoad(Load* load);
+
+    void upload(Entry* entry, unsigned int level, const unsigned char* data);
+
+    static bool readLevels(const Entry& entry, unsigned int level, std::vector<unsigned char>* data);
+
+    static unsigned int getLevelsSize(const Entry& entry, unsigned int level);
+
+    unsigned int _budget;
+    unsigned int _minimumLevelSize;
+    unsigned int _residentSize;
+    unsigned int _frame;
+    std::map<Texture*, Entry*> _entries;
+    std::vector<Load*> _loads;
+    std::vector<Load*> _completedLoads;
+};
+
+}
+
+#endif
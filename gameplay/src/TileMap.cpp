@@ -0,0 +1,488 @@
+#include "Base.h"
+#include "TileMap.h"
+#include "Camera.h"
+#include "BoundingBox.h"
+#include "FileSystem.h"
+#include "GLStateCache.h"
+#include "RenderStats.h"
+
+// The number of tiles along each side of a chunk. The vertices of a chunk must be
+// addressable by 16-bit indices.
+#define TILEMAP_CHUNK_SIZE 32
+#define TILEMAP_CHUNK_TILES (TILEMAP_CHUNK_SIZE * TILEMAP_CHUNK_SIZE)
+
+// The position and texture coordinates of a vertex.
+#define TILEMAP_VERTEX_FLOATS 4
+#define TILEMAP_VERTEX_SIZE (TILEMAP_VERTEX_FLOATS * sizeof(float))
+
+// Tile map shaders
+#define TILEMAP_VSH "res/shaders/tilemap.vert"
+#define TILEMAP_FSH "res/shaders/tilemap.frag"
+
+namespace gameplay
+{
+
+TileMap::TileMap()
+    : _sampler(NULL), _material(NULL), _indexBuffer(0), _tileWidth(0), _tileHeight(0), _tilesetColumns(0),
+      _columns(0), _rows(0), _layerCount(0), _chunkColumns(0), _chunkRows(0)
+{
+}
+
+TileMap::~TileMap()
+{
+    for (size_t i = 0, count = _chunks.size(); i < count; ++i)
+    {
+        if (_chunks[i].vertexBuffer)
+        {
+            GLStateCache::deleteBuffers(1, &_chunks[i].vertexBuffer);
+        }
+    }
+    if (_indexBuffer)
+    {
+        GLStateCache::deleteBuffers(1, &_indexBuffer);
+    }
+    SAFE_RELEASE(_material);
+    SAFE_RELEASE(_sampler);
+}
+
+TileMap* TileMap::create(const char* path)
+{
+    GP_ASSERT(path);
+
+    Properties* p = Properties::create(path);
+    if (p == NULL)
+    {
+        GP_WARN("Failed to load properties for tile map definition: %s", path);
+        return NULL;
+    }
+
+    Properties* pTileMap = (strlen(p->getNamespace()) > 0) ? p : p->getNextNamespace();
+    TileMap* map = pTileMap ? create(pTileMap) : NULL;
+    SAFE_DELETE(p);
+
+    return map;
+}
+
+TileMap* TileMap::create(Properties* properties)
+{
+    GP_ASSERT(properties);
+
+    std::string tilesetPath;
+    if (!properties->getPath("tileset", &tilesetPath))
+    {
+        GP_WARN("No 'tileset' property supplied in tile map definition.");
+        return NULL;
+    }
+
+    Vector2 tileSize;
+    if (!properties->getVector2("tileSize", &tileSize) || tileSize.x < 1 || tileSize.y < 1)
+    {
+        GP_WARN("Invalid or missing 'tileSize' value in tile map definition.");
+        return NULL;
+    }
+
+    Vector2 size;
+    if (!properties->getVector2("size", &size) || size.x < 1 || size.y < 1)
+    {
+        GP_WARN("Invalid or missing 'size' value in tile map definition.");
+        return NULL;
+    }
+
+    std::vector<std::string> layerPaths;
+    Properties* layer;
+    while ((layer = properties->getNextNamespace()) != NULL)
+    {
+        if (strcmp(layer->getNamespace(), "layer") == 0)
+        {
+            std::string path;
+            layer->getPath("tiles", &path);
+            layerPaths.push_back(path);
+        }
+    }
+    if (layerPaths.empty())
+    {
+        layerPaths.push_back(std::string());
+    }
+
+    Texture* tileset = Texture::create(tilesetPath.c_str());
+    if (tileset == NULL)
+    {
+        GP_WARN("Failed to load tile map tileset: %s", tilesetPath.c_str());
+        return NULL;
+    }
+
+    TileMap* map = create(tileset, (unsigned int)tileSize.x, (unsigned int)tileSize.y, (unsigned int)size.x, (unsigned int)size.y,
+                          (unsigned int)layerPaths.size());
+    SAFE_RELEASE(tileset);
+    if (map == NULL)
+        return NULL;
+
+    for (unsigned int i = 0; i < layerPaths.size(); ++i)
+    {
+        if (!layerPaths[i].empty() && !map->loadLayer(i, layerPaths[i].c_str()))
+        {
+            GP_WARN("Failed to load tile map layer: %s", layerPaths[i].c_str());
+        }
+    }
+    return map;
+}
+
+TileMap* TileMap::create(Texture* tileset, unsigned int tileWidth, unsigned int tileHeight,
+                         unsigned int columns, unsigned int rows, unsigned int layerCount)
+{
+    GP_ASSERT(tileset);
+
+    if (tileWidth == 0 || tileHeight == 0 || tileWidth > tileset->getWidth() || tileHeight > tileset->getHeight())
+    {
+        GP_WARN("Invalid tile size %ux%u for a tileset of %ux%u.", tileWidth, tileHeight, tileset->getWidth(), tileset->getHeight());
+        return NULL;
+    }
+    if (columns == 0 || rows == 0 || layerCount == 0)
+    {
+        GP_WARN("Invalid tile map size %ux%u with %u layers.", columns, rows, layerCount);
+        return NULL;
+    }
+
+    Material* material = Material::create(TILEMAP_VSH, TILEMAP_FSH);
+    if (material == NULL)
+    {
+        GP_ERROR("Failed to create the tile map material.");
+        return NULL;
+    }
+    material->getStateBlock()->setBlend(true);
+    material->getStateBlock()->setBlendSrc(RenderState::BLEND_SRC_ALPHA);
+    material->getStateBlock()->setBlendDst(RenderState::BLEND_ONE_MINUS_SRC_ALPHA);
+
+    // Tiles are drawn at their size in pixels, and filtering would blend in the edges of the
+    // tiles next to them in the tileset.
+    Texture::Sampler* sampler = Texture::Sampler::create(tileset);
+    sampler->setFilterMode(Texture::NEAREST, Texture::NEAREST);
+    material->getParameter("u_texture")->setValue(sampler);
+
+    TileMap* map = new TileMap();
+    map->_sampler = sampler;
+    map->_material = material;
+    map->_tileWidth = tileWidth;
+    map->_tileHeight = tileHeight;
+    map->_tilesetColumns = tileset->getWidth() / tileWidth;
+    map->_columns = columns;
+    map->_rows = rows;
+    map->_layerCount = layerCount;
+    map->_chunkColumns = (columns + TILEMAP_CHUNK_SIZE - 1) / TILEMAP_CHUNK_SIZE;
+    map->_chunkRows = (rows + TILEMAP_CHUNK_SIZE - 1) / TILEMAP_CHUNK_SIZE;
+    map->_tiles.assign(layerCount * columns * rows, -1);
+    Chunk chunk = { 0, 0, 0, false };
+    map->_chunks.assign(layerCount * map->_chunkColumns * map->_chunkRows, chunk);
+
+    // Every chunk uses the same indices, for the quads of its tiles.
+    std::vector<unsigned short> indices(TILEMAP_CHUNK_TILES * 6);
+    for (unsigned int i = 0; i < TILEMAP_CHUNK_TILES; i++)
+    {
+        unsigned short v = (unsigned short)(i * 4);
+        unsigned short* index = &indices[i * 6];
+        index[0] = v;
+        index[1] = v + 1;
+        index[2] = v + 2;
+        index[3] = v + 2;
+        index[4] = v + 1;
+        index[5] = v + 3;
+    }
+    GL_ASSERT( glGenBuffers(1, &map->_indexBuffer) );
+    GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, map->_indexBuffer);
+    GL_ASSERT( glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned short), &indices[0], GL_STATIC_DRAW) );
+    GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    return map;
+}
+
+unsigned int TileMap::getColumnCount() const
+{
+    return _columns;
+}
+
+unsigned int TileMap::getRowCount() const
+{
+    return _rows;
+}
+
+unsigned int TileMap::getLayerCount() const
+{
+    return _layerCount;
+}
+
+unsigned int TileMap::getTileWidth() const
+{
+    return _tileWidth;
+}
+
+unsigned int TileMap::getTileHeight() const
+{
+    return _tileHeight;
+}
+
+int TileMap::getTile(unsigned int layer, unsigned int column, unsigned int row) const
+{
+    if (layer >= _layerCount || column >= _columns || row >= _rows)
+        return -1;
+    return _tiles[(layer * _rows + row) * _columns + column];
+}
+
+void TileMap::setTile(unsigned int layer, unsigned int column, unsigned int row, int tile)
+{
+    GP_ASSERT(layer < _layerCount && column < _columns && row < _rows);
+    if (layer >= _layerCount || column >= _columns || row >= _rows)
+        return;
+
+    int& current = _tiles[(layer * _rows + row) * _columns + column];
+    tile = std::max(tile, -1);
+    if (current != tile)
+    {
+        current = tile;
+        getChunk(layer, column / TILEMAP_CHUNK_SIZE, row / TILEMAP_CHUNK_SIZE).dirty = true;
+    }
+}
+
+Material* TileMap::getMaterial() const
+{
+    return _material;
+}
+
+unsigned int TileMap::draw(const Rectangle& view)
+{
+    if (view.width <= 0.0f || view.height <= 0.0f)
+        return 0;
+
+    // Find the chunks the rectangle covers.
+    float mapWidth = (float)(_columns * _tileWidth);
+    float mapHeight = (float)(_rows * _tileHeight);
+    if (view.right() <= 0.0f || view.bottom() <= 0.0f || view.x >= mapWidth || view.y >= mapHeight)
+        return 0;
+    float chunkWidth = (float)(TILEMAP_CHUNK_SIZE * _tileWidth);
+    float chunkHeight = (float)(TILEMAP_CHUNK_SIZE * _tileHeight);
+    unsigned int firstColumn = (unsigned int)(std::max(view.x, 0.0f) / chunkWidth);
+    unsigned int firstRow = (unsigned int)(std::max(view.y, 0.0f) / chunkHeight);
+    unsigned int lastColumn = (unsigned int)(std::min(view.right(), mapWidth) / chunkWidth);
+    unsigned int lastRow = (unsigned int)(std::min(view.bottom(), mapHeight) / chunkHeight);
+    lastColumn = std::min(lastColumn, _chunkColumns - 1);
+    lastRow = std::min(lastRow, _chunkRows - 1);
+
+    Matrix projection;
+    Matrix::createOrthographicOffCenter(view.x, view.right(), view.bottom(), view.y, 0, 1, &projection);
+    return draw(projection, firstColumn, firstRow, lastColumn, lastRow, NULL);
+}
+
+unsigned int TileMap::draw(Camera* camera)
+{
+    GP_ASSERT(camera);
+
+    // The rows go down the map, and up the Y axis of the world.
+    Matrix viewProjection(camera->getViewProjectionMatrix());
+    viewProjection.scale(1.0f, -1.0f, 1.0f);
+    return draw(viewProjection, 0, 0, _chunkColumns - 1, _chunkRows - 1, &camera->getFrustum());
+}
+
+bool TileMap::loadLayer(unsigned int layer, const char* path)
+{
+    GP_ASSERT(layer < _layerCount);
+    GP_ASSERT(path);
+
+    char* text = FileSystem::readAll(path);
+    if (text == NULL)
+        return false;
+
+    int* tiles = &_tiles[layer * _rows * _columns];
+    unsigned int count = _rows * _columns;
+    const char* c = text;
+    for (unsigned int i = 0; i < count; )
+    {
+        // Skip the separators between the tiles.
+        while (*c != '\0' && *c != '-' && !isdigit((unsigned char)*c))
+            ++c;
+        if (*c == '\0')
+            break;
+
+        char* end;
+        long tile = strtol(c, &end, 10);
+        if (end == c)
+        {
+            ++c;
+            continue;
+        }
+        tiles[i++] = tile < 0 ? -1 : (int)tile;
+        c = end;
+    }
+    SAFE_DELETE_ARRAY(text);
+
+    for (unsigned int row = 0; row < _chunkRows; ++row)
+    {
+        for (unsigned int column = 0; column < _chunkColumns; ++column)
+            getChunk(layer, column, row).dirty = true;
+    }
+    return true;
+}
+
+TileMap::Chunk& TileMap::getChunk(unsigned int layer, unsigned int chunkColumn, unsigned int chunkRow)
+{
+    return _chunks[(layer * _chunkRows + chunkRow) * _chunkColumns + chunkColumn];
+}
+
+void TileMap::bake(unsigned int layer, unsigned int chunkColumn, unsigned int chunkRow)
+{
+    Chunk& chunk = getChunk(layer, chunkColumn, chunkRow);
+    chunk.dirty = false;
+
+    Texture* tileset = _sampler->getTexture();
+    GP_ASSERT(tileset);
+    float tileWidth = (float)_tileWidth;
+    float tileHeight = (float)_tileHeight;
+    float tileU = tileWidth / tileset->getWidth();
+    float tileV = tileHeight / tileset->getHeight();
+
+    // Only the tiles that are not empty are baked.
+    _vertices.clear();
+    unsigned int firstColumn = chunkColumn * TILEMAP_CHUNK_SIZE;
+    unsigned int lastColumn = std::min(firstColumn + TILEMAP_CHUNK_SIZE, _columns);
+    unsigned int firstRow = chunkRow * TILEMAP_CHUNK_SIZE;
+    unsigned int lastRow = std::min(firstRow + TILEMAP_CHUNK_SIZE, _rows);
+    for (unsigned int row = firstRow; row < lastRow; ++row)
+    {
+        const int* tiles = &_tiles[(layer * _rows + row) * _columns];
+        for (unsigned int column = firstColumn; column < lastColumn; ++column)
+        {
+            int tile = tiles[column];
+            if (tile < 0)
+                continue;
+
+            float x1 = column * tileWidth;
+            float y1 = row * tileHeight;
+            float x2 = x1 + tileWidth;
+            float y2 = y1 + tileHeight;
+
+            // Textures are stored bottom up, as for SpriteBatch.
+            float u1 = (tile % _tilesetColumns) * tileU;
+            float v1 = 1.0f - (tile / _tilesetColumns) * tileV;
+            float u2 = u1 + tileU;
+            float v2 = v1 - tileV;
+
+            const float vertices[] =
+            {
+                x1, y1, u1, v1,
+                x1, y2, u1, v2,
+                x2, y1, u2, v1,
+                x2, y2, u2, v2
+            };
+            _vertices.insert(_vertices.end(), vertices, vertices + 4 * TILEMAP_VERTEX_FLOATS);
+        }
+    }
+
+    chunk.tileCount = (unsigned int)(_vertices.size() / (4 * TILEMAP_VERTEX_FLOATS));
+    if (chunk.tileCount == 0)
+        return;
+
+    // The buffer of a chunk is only reallocated when it grows.
+    if (chunk.vertexBuffer == 0)
+    {
+        GL_ASSERT( glGenBuffers(1, &chunk.vertexBuffer) );
+    }
+    GLStateCache::bindBuffer(GL_ARRAY_BUFFER, chunk.vertexBuffer);
+    if (chunk.tileCount > chunk.capacity)
+    {
+        GL_ASSERT( glBufferData(GL_ARRAY_BUFFER, _vertices.size() * sizeof(float), &_vertices[0], GL_STATIC_DRAW) );
+        chunk.capacity = chunk.tileCount;
+    }
+    else
+    {
+        GL_ASSERT( glBufferSubData(GL_ARRAY_BUFFER, 0, _vertices.size() * sizeof(float), &_vertices[0]) );
+    }
+    GLStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+unsigned int TileMap::draw(const Matrix& viewProjection, unsigned int firstColumn, unsigned int firstRow,
+                           unsigned int lastColumn, unsigned int lastRow, const Frustum* frustum)
+{
+    // Find the chunks in view once for all of the layers.
+    _visibleChunks.clear();
+    float chunkWidth = (float)(TILEMAP_CHUNK_SIZE * _tileWidth);
+    float chunkHeight = (float)(TILEMAP_CHUNK_SIZE * _tileHeight);
+    for (unsigned int row = firstRow; row <= lastRow; ++row)
+    {
+        for (unsigned int column = firstColumn; column <= lastColumn; ++column)
+        {
+            if (frustum)
+            {
+                BoundingBox box(column * chunkWidth, -(std::min((row + 1) * TILEMAP_CHUNK_SIZE, _rows) * (float)_tileHeight), 0.0f,
+                                std::min((column + 1) * TILEMAP_CHUNK_SIZE, _columns) * (float)_tileWidth, -(row * chunkHeight), 0.0f);
+                if (!frustum->intersects(box))
+                    continue;
+            }
+            _visibleChunks.push_back(row * _chunkColumns + column);
+        }
+    }
+    if (_visibleChunks.empty())
+        return 0;
+
+    Pass* pass = _material->getTechnique()->getPassByIndex(0);
+    GP_ASSERT(pass);
+    pass->getParameter("u_projectionMatrix")->setValue(viewProjection);
+    pass->bind();
+
+    Effect* effect = pass->getEffect();
+    GP_ASSERT(effect);
+    VertexAttribute position = effect->getVertexAttribute("a_position");
+    VertexAttribute texCoord = effect->getVertexAttribute("a_texCoord");
+    if (position != -1)
+    {
+        GL_ASSERT( glEnableVertexAttribArray(position) );
+    }
+    if (texCoord != -1)
+    {
+        GL_ASSERT( glEnableVertexAttribArray(texCoord) );
+    }
+
+    GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer);
+
+    // Each layer is drawn over the layers before it.
+    unsigned int drawCount = 0;
+    for (unsigned int layer = 0; layer < _layerCount; ++layer)
+    {
+        for (size_t i = 0, count = _visibleChunks.size(); i < count; ++i)
+        {
+            unsigned int column = _visibleChunks[i] % _chunkColumns;
+            unsigned int row = _visibleChunks[i] / _chunkColumns;
+            Chunk& chunk = getChunk(layer, column, row);
+            if (chunk.dirty)
+                bake(layer, column, row);
+            if (chunk.tileCount == 0)
+                continue;
+
+            GLStateCache::bindBuffer(GL_ARRAY_BUFFER, chunk.vertexBuffer);
+            if (position != -1)
+            {
+                GL_ASSERT( glVertexAttribPointer(position, 2, GL_FLOAT, GL_FALSE, TILEMAP_VERTEX_SIZE, (const GLvoid*)0) );
+            }
+            if (texCoord != -1)
+            {
+                GL_ASSERT( glVertexAttribPointer(texCoord, 2, GL_FLOAT, GL_FALSE, TILEMAP_VERTEX_SIZE, (const GLvoid*)(2 * sizeof(float))) );
+            }
+            GL_ASSERT( glDrawElements(GL_TRIANGLES, chunk.tileCount * 6, GL_UNSIGNED_SHORT, 0) );
+            RenderStats::addDraw(GL_TRIANGLES, chunk.tileCount * 6);
+            ++drawCount;
+        }
+    }
+
+    GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GLStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
+    if (position != -1)
+    {
+        GL_ASSERT( glDisableVertexAttribArray(position) );
+    }
+    if (texCoord != -1)
+    {
+        GL_ASSERT( glDisableVertexAttribArray(texCoord) );
+    }
+
+    pass->unbind();
+    return drawCount;
+}
+
+}
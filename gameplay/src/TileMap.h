@@ -0,0 +1,236 @@
+#ifndef TILEMAP_H_
+#define TILEMAP_H_
+
+#include "Ref.h"
+#include "Texture.h"
+#include "Material.h"
+#include "Properties.h"
+#include "Rectangle.h"
+
+namespace gameplay
+{
+
+class Camera;
+class Frustum;
+
+/**
+ * Defines a 2D map of tiles drawn from a tileset texture, in one or more layers.
+ *
+ * The map is split into chunks of 32 x 32 tiles, and the tiles of each chunk of a layer are
+ * baked into a static vertex buffer, so a chunk is drawn with a single draw call instead of
+ * submitting its tiles to a SpriteBatch every frame. A chunk is baked when it is first drawn,
+ * and again only after setTile() changes one of its tiles. Chunks outside of the view are
+ * neither baked nor drawn.
+ *
+ * The tileset is a texture with the tiles in a grid, numbered from 0 across the rows from
+ * the top left. A tile of -1 is empty. Tiles are positioned in pixels, with the top left of
+ * the map at the origin and the rows going down.
+ *
+ * The following properties are available for tile maps:
+
+ @verbatim
+    tileMap
+    {
+        tileset = res/tiles.png     // Texture of the tiles.
+        tileSize = <int>, <int>     // Width and height of a tile in pixels.
+        size = <int>, <int>         // Number of columns and rows of the map.
+
+        // Each layer is drawn over the layers before it.
+        layer
+        {
+            // Text file of the tiles of the layer, row by row, separated by commas or
+            // spaces. The map is left empty past the end of the file.
+            tiles = res/level1-ground.csv
+        }
+    }
+ @endverbatim
+ *
+ * @script{ignore}
+ */
+class TileMap : public Ref
+{
+public:
+
+    /**
+     * Creates a tile map from the specified properties file.
+     *
+     * @param path Path to the properties file, which may be followed by a '#' and the
+     *      namespace of the tile map.
+     *
+     * @return The new tile map, or NULL if it could not be created.
+     */
+    static TileMap* create(const char* path);
+
+    /**
+     * Creates a tile map from the specified properties.
+     *
+     * @param properties The properties of the tile map.
+     *
+     * @return The new tile map, or NULL if it could not be created.
+     */
+    static TileMap* create(Properties* properties);
+
+    /**
+     * Creates an empty tile map.
+     *
+     * @param tileset The texture of the tiles.
+     * @param tileWidth The width of a tile in pixels.
+     * @param tileHeight The height of a tile in pixels.
+     * @param columns The number of columns of the map.
+     * @param rows The number of rows of the map.
+     * @param layerCount The number of layers of the map.
+     *
+     * @return The new tile map, or NULL if it could not be created.
+     */
+    static TileMap* create(Texture* tileset, unsigned int tileWidth, unsigned int tileHeight,
+                           unsigned int columns, unsigned int rows, unsigned int layerCount = 1);
+
+    /**
+     * Returns the number of columns of the map.
+     *
+     * @return The number of columns.
+     */
+    unsigned int getColumnCount() const;
+
+    /**
+     * Returns the number of rows of the map.
+     *
+     * @return The number of rows.
+     */
+    unsigned int getRowCount() const;
+
+    /**
+     * Returns the number of layers of the map.
+     *
+     * @return The number of layers.
+     */
+    unsigned int getLayerCount() const;
+
+    /**
+     * Returns the width of a tile in pixels.
+     *
+     * @return The width of a tile.
+     */
+    unsigned int getTileWidth() const;
+
+    /**
+     * Returns the height of a tile in pixels.
+     *
+     * @return The height of a tile.
+     */
+    unsigned int getTileHeight() const;
+
+    /**
+     * Returns a tile of the map.
+     *
+     * @param layer The layer of the tile.
+     * @param column The column of the tile.
+     * @param row The row of the tile.
+     *
+     * @return The index of the tile in the tileset, or -1 if it is empty or outside of the map.
+     */
+    int getTile(unsigned int layer, unsigned int column, unsigned int row) const;
+
+    /**
+     * Sets a tile of the map.
+     *
+     * The chunk of the tile is baked again the next time it is drawn.
+     *
+     * @param layer The layer of the tile.
+     * @param column The column of the tile.
+     * @param row The row of the tile.
+     * @param tile The index of the tile in the tileset, or -1 for an empty tile.
+     */
+    void setTile(unsigned int layer, unsigned int column, unsigned int row, int tile);
+
+    /**
+     * Returns the material the tiles are drawn with, which can be used to change its state.
+     *
+     * @return The material.
+     */
+    Material* getMaterial() const;
+
+    /**
+     * Draws the part of the map in a rectangle, so that it fills the viewport.
+     *
+     * @param view The rectangle of the map to draw, in pixels.
+     *
+     * @return The number of draw calls, one for each layer of each chunk that is drawn.
+     */
+    unsigned int draw(const Rectangle& view);
+
+    /**
+     * Draws the map as seen from a camera.
+     *
+     * The map lies in the XY plane of the world with one unit per pixel and the first row at
+     * the top, so the tile of column c and row r spans from (c, -r - 1) to (c + 1, -r) times the
+     * tile size. Chunks are culled against the frustum of the camera.
+     *
+     * @param camera The camera.
+     *
+     * @return The number of draw calls, one for each layer of each chunk that is drawn.
+     */
+    unsigned int draw(Camera* camera);
+
+private:
+
+    /**
+     * The tiles of a layer in one chunk of the map.
+     */
+    struct Chunk
+    {
+        VertexBufferHandle vertexBuffer;
+        unsigned int capacity;
+        unsigned int tileCount;
+        bool dirty;
+    };
+
+    /**
+     * Constructor.
+     */
+    TileMap();
+
+    /**
+     * Destructor.
+     */
+    ~TileMap();
+
+    /**
+     * Hidden copy constructor.
+     */
+    TileMap(const TileMap&);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    TileMap& operator=(const TileMap&);
+
+    bool loadLayer(unsigned int layer, const char* path);
+
+    Chunk& getChunk(unsigned int layer, unsigned int chunkColumn, unsigned int chunkRow);
+
+    void bake(unsigned int layer, unsigned int chunkColumn, unsigned int chunkRow);
+
+    unsigned int draw(const Matrix& viewProjection, unsigned int firstColumn, unsigned int firstRow,
+                      unsigned int lastColumn, unsigned int lastRow, const Frustum* frustum);
+
+    Texture::Sampler* _sampler;
+    Material* _material;
+    IndexBufferHandle _indexBuffer;
+    unsigned int _tileWidth;
+    unsigned int _tileHeight;
+    unsigned int _tilesetColumns;
+    unsigned int _columns;
+    unsigned int _rows;
+    unsigned int _layerCount;
+    unsigned int _chunkColumns;
+    unsigned int _chunkRows;
+    std::vector<int> _tiles;
+    std::vector<Chunk> _chunks;
+    std::vector<unsigned int> _visibleChunks;
+    std::vector<float> _vertices;
+};
+
+}
+
+#endif
@@ -0,0 +1,457 @@
+#include "Base.h"
+#include "TiledTerrain.h"
+#include "Node.h"
+#include "Game.h"
+#include "FileSystem.h"
+
+// The number of tiles that are read at the same time.
+#define MAX_LOADING_TILES 2
+
+// Default memory budget of the loaded tiles, in megabytes.
+#define DEFAULT_MEMORY_BUDGET 256
+
+// Default tile patch size.
+#define DEFAULT_TILE_PATCH_SIZE 32
+
+namespace gameplay
+{
+
+// Defined in Terrain.cpp.
+float getDefaultHeight(unsigned int width, unsigned int height);
+
+TiledTerrain::TiledTerrain()
+    : _node(NULL), _properties(NULL), _tileSize(0), _columns(0), _rows(0), _patchSize(DEFAULT_TILE_PATCH_SIZE),
+    _detailLevels(1), _skirtScale(0), _loadDistance(0), _unloadDistance(0), _memoryBudget(DEFAULT_MEMORY_BUDGET * 1024 * 1024),
+    _loadingCount(0)
+{
+}
+
+TiledTerrain::~TiledTerrain()
+{
+    // Wait for the tiles being loaded; the loads are cancelled, so their results are released.
+    JobController* jobs = Game::getInstance()->getJobController();
+    for (size_t i = 0, count = _tiles.size(); i < count; ++i)
+    {
+        Tile* tile = _tiles[i];
+        if (tile->state == TILE_LOADING)
+        {
+            tile->cancelled = true;
+            jobs->wait(tile->jobId);
+        }
+        unload(tile);
+        SAFE_DELETE(tile);
+    }
+    _tiles.clear();
+
+    SAFE_RELEASE(_node);
+    SAFE_DELETE(_properties);
+}
+
+TiledTerrain* TiledTerrain::create(const char* path)
+{
+    GP_ASSERT(path);
+
+    Properties* p = Properties::create(path);
+    if (p == NULL)
+    {
+        GP_WARN("Failed to load properties for tiled terrain definition: %s", path);
+        return NULL;
+    }
+
+    Properties* pTerrain = (strlen(p->getNamespace()) > 0) ? p : p->getNextNamespace();
+    TiledTerrain* terrain = pTerrain ? create(pTerrain) : NULL;
+    SAFE_DELETE(p);
+
+    return terrain;
+}
+
+TiledTerrain* TiledTerrain::create(Properties* properties)
+{
+    GP_ASSERT(properties);
+
+    const char* tiles = properties->getString("tiles");
+    if (tiles == NULL || strlen(tiles) == 0)
+    {
+        GP_WARN("No 'tiles' property supplied in tiled terrain definition.");
+        return NULL;
+    }
+
+    int tileSize = properties->getInt("tileSize");
+    if (tileSize < 2)
+    {
+        GP_WARN("Invalid or missing 'tileSize' value in tiled terrain definition.");
+        return NULL;
+    }
+
+    Vector2 tileCount;
+    if (!properties->getVector2("tileCount", &tileCount) || tileCount.x < 1 || tileCount.y < 1)
+    {
+        GP_WARN("Invalid or missing 'tileCount' value in tiled terrain definition.");
+        return NULL;
+    }
+
+    TiledTerrain* terrain = new TiledTerrain();
+    terrain->_properties = properties->clone();
+    terrain->_tileSize = (unsigned int)tileSize;
+    terrain->_columns = (unsigned int)tileCount.x;
+    terrain->_rows = (unsigned int)tileCount.y;
+
+    // The whole map is sized like a single terrain with the samples of all the tiles.
+    unsigned int width = terrain->_columns * (terrain->_tileSize - 1);
+    unsigned int height = terrain->_rows * (terrain->_tileSize - 1);
+    Vector3 size;
+    if (!properties->getVector3("size", &size) || size.isZero())
+    {
+        size.set(width, getDefaultHeight(width + 1, height + 1), height);
+    }
+    terrain->_scale.set(size.x / width, size.y, size.z / height);
+
+    if (properties->exists("patchSize"))
+    {
+        int patchSize = properties->getInt("patchSize");
+        if (patchSize > 0 && patchSize <= tileSize)
+            terrain->_patchSize = (unsigned int)patchSize;
+    }
+    terrain->_patchSize = std::min(terrain->_patchSize, terrain->_tileSize);
+
+    if (properties->exists("detailLevels"))
+        terrain->_detailLevels = (unsigned int)std::max(properties->getInt("detailLevels"), 1);
+
+    if (properties->exists("skirtScale"))
+        terrain->_skirtScale = std::max(properties->getFloat("skirtScale"), 0.0f);
+
+    // By default, load the tiles around the viewer and the tiles next to them.
+    float tileWidth = std::max(size.x / terrain->_columns, size.z / terrain->_rows);
+    float loadDistance = properties->exists("loadDistance") ? properties->getFloat("loadDistance") : tileWidth;
+    float unloadDistance = properties->exists("unloadDistance") ? properties->getFloat("unloadDistance") : loadDistance * 1.25f;
+    terrain->setLoadDistance(loadDistance, unloadDistance);
+
+    if (properties->exists("memoryBudget"))
+        terrain->_memoryBudget = (size_t)std::max(properties->getInt("memoryBudget"), 0) * 1024 * 1024;
+
+    terrain->_node = Node::create(properties->getId());
+
+    for (unsigned int row = 0; row < terrain->_rows; ++row)
+    {
+        for (unsigned int column = 0; column < terrain->_columns; ++column)
+        {
+            char path[1024];
+            sprintf(path, tiles, column, row);
+
+            Tile* tile = new Tile();
+            tile->owner = terrain;
+            tile->column = column;
+            tile->row = row;
+            tile->state = TILE_UNLOADED;
+            tile->path = path;
+            tile->heightfield = NULL;
+            tile->terrain = NULL;
+            tile->node = NULL;
+            tile->readJob.tile = tile;
+            tile->createJob.tile = tile;
+            tile->jobId = 0;
+            tile->cancelled = false;
+            tile->failed = false;
+            tile->distance = 0;
+            terrain->_tiles.push_back(tile);
+        }
+    }
+
+    return terrain;
+}
+
+Node* TiledTerrain::getNode() const
+{
+    return _node;
+}
+
+void TiledTerrain::update(const Vector3& position)
+{
+    // Tile distances are measured in the space of the terrain node.
+    Matrix inverse;
+    _node->getWorldMatrix().invert(&inverse);
+    Vector3 viewer;
+    inverse.transformPoint(position, &viewer);
+
+    std::vector<Tile*> candidates;
+    for (size_t i = 0, count = _tiles.size(); i < count; ++i)
+    {
+        Tile* tile = _tiles[i];
+        tile->distance = getTileDistance(tile, viewer);
+
+        if (tile->state == TILE_LOADING)
+        {
+            // Keep the results of loads that come back in range before they finish.
+            tile->cancelled = tile->distance > _unloadDistance;
+        }
+        else if (tile->state == TILE_LOADED && tile->distance > _unloadDistance)
+        {
+            unload(tile);
+        }
+        else if (tile->state == TILE_UNLOADED && !tile->failed && tile->distance <= _loadDistance)
+        {
+            candidates.push_back(tile);
+        }
+    }
+
+    if (candidates.empty())
+        return;
+
+    // Load the nearest tiles first, making room for them by unloading farther tiles.
+    std::sort(candidates.begin(), candidates.end(), compareDistance);
+    size_t tileMemory = getTileMemory();
+    for (size_t i = 0, count = candidates.size(); i < count && _loadingCount < MAX_LOADING_TILES; ++i)
+    {
+        Tile* tile = candidates[i];
+        while (getMemoryUsage() + tileMemory > _memoryBudget)
+        {
+            Tile* farthest = NULL;
+            for (size_t j = 0, tileCount = _tiles.size(); j < tileCount; ++j)
+            {
+                Tile* loaded = _tiles[j];
+                if (loaded->state == TILE_LOADED && loaded->distance > tile->distance &&
+                    (farthest == NULL || loaded->distance > farthest->distance))
+                {
+                    farthest = loaded;
+                }
+            }
+            if (farthest == NULL)
+                return;
+            unload(farthest);
+        }
+        load(tile);
+    }
+}
+
+float TiledTerrain::getHeight(float x, float z) const
+{
+    const Tile* tile = findTile(x, z);
+    if (tile == NULL || tile->state != TILE_LOADED)
+        return 0.0f;
+
+    return tile->terrain->getHeight(x, z);
+}
+
+unsigned int TiledTerrain::getTileCount() const
+{
+    return _tiles.size();
+}
+
+unsigned int TiledTerrain::getLoadedTileCount() const
+{
+    unsigned int count = 0;
+    for (size_t i = 0, tileCount = _tiles.size(); i < tileCount; ++i)
+    {
+        if (_tiles[i]->state == TILE_LOADED)
+            ++count;
+    }
+    return count;
+}
+
+unsigned int TiledTerrain::getLoadingTileCount() const
+{
+    return _loadingCount;
+}
+
+size_t TiledTerrain::getMemoryUsage() const
+{
+    return (getLoadedTileCount() + _loadingCount) * getTileMemory();
+}
+
+size_t TiledTerrain::getMemoryBudget() const
+{
+    return _memoryBudget;
+}
+
+void TiledTerrain::setMemoryBudget(size_t bytes)
+{
+    _memoryBudget = bytes;
+}
+
+float TiledTerrain::getLoadDistance() const
+{
+    return _loadDistance;
+}
+
+void TiledTerrain::setLoadDistance(float loadDistance, float unloadDistance)
+{
+    _loadDistance = std::max(loadDistance, 0.0f);
+    _unloadDistance = std::max(unloadDistance, _loadDistance);
+}
+
+void TiledTerrain::load(Tile* tile)
+{
+    GP_ASSERT(tile && tile->state == TILE_UNLOADED);
+
+    tile->state = TILE_LOADING;
+    tile->cancelled = false;
+    ++_loadingCount;
+
+    JobController* jobs = Game::getInstance()->getJobController();
+    JobController::JobId readId = jobs->add(&tile->readJob, JobController::ANY_THREAD);
+    tile->jobId = jobs->add(&tile->createJob, readId, JobController::MAIN_THREAD);
+}
+
+void TiledTerrain::unload(Tile* tile)
+{
+    GP_ASSERT(tile);
+
+    if (tile->state == TILE_LOADING)
+    {
+        // The terrain is released when the load completes.
+        tile->cancelled = true;
+    }
+    else if (tile->state == TILE_LOADED)
+    {
+        _node->removeChild(tile->node);
+        tile->node->setTerrain(NULL);
+        SAFE_RELEASE(tile->node);
+        SAFE_RELEASE(tile->terrain);
+        tile->state = TILE_UNLOADED;
+    }
+}
+
+void TiledTerrain::createTerrain(Tile* tile)
+{
+    GP_ASSERT(tile && tile->state == TILE_LOADING);
+
+    --_loadingCount;
+    tile->state = TILE_UNLOADED;
+
+    if (tile->cancelled)
+    {
+        SAFE_RELEASE(tile->heightfield);
+        return;
+    }
+    if (tile->heightfield == NULL)
+    {
+        GP_WARN("Failed to read terrain tile heightmap: %s", tile->path.c_str());
+        tile->failed = true;
+        return;
+    }
+
+    // The terrain takes ownership of the heightfield.
+    _properties->rewind();
+    Terrain* terrain = Terrain::create(tile->heightfield, _scale, _patchSize, _detailLevels, _skirtScale, NULL, _properties);
+    tile->heightfield = NULL;
+    if (terrain == NULL)
+    {
+        GP_WARN("Failed to create terrain for tile: %s", tile->path.c_str());
+        tile->failed = true;
+        return;
+    }
+
+    // Position the tile around its centre, as terrains are centred on their nodes.
+    float tileWidth = (float)(_tileSize - 1);
+    Node* node = Node::create();
+    node->setTranslation(((tile->column + 0.5f) * tileWidth - _columns * tileWidth * 0.5f) * _scale.x, 0,
+                         ((tile->row + 0.5f) * tileWidth - _rows * tileWidth * 0.5f) * _scale.z);
+    node->setTerrain(terrain);
+    _node->addChild(node);
+
+    tile->terrain = terrain;
+    tile->node = node;
+    tile->state = TILE_LOADED;
+}
+
+size_t TiledTerrain::getTileMemory() const
+{
+    // Heights, plus the vertices and indices of the patches, with about a third more for the detail levels.
+    size_t samples = (size_t)_tileSize * _tileSize;
+    return samples * (sizeof(float) + (13 * sizeof(float) + 12) * 4 / 3);
+}
+
+float TiledTerrain::getTileDistance(const Tile* tile, const Vector3& position) const
+{
+    // Distance in the xz plane from the position to the rectangle of the tile.
+    float tileWidth = (float)(_tileSize - 1);
+    float minX = (tile->column * tileWidth - _columns * tileWidth * 0.5f) * _scale.x;
+    float minZ = (tile->row * tileWidth - _rows * tileWidth * 0.5f) * _scale.z;
+    float maxX = minX + tileWidth * _scale.x;
+    float maxZ = minZ + tileWidth * _scale.z;
+    float dx = std::max(std::max(minX - position.x, position.x - maxX), 0.0f);
+    float dz = std::max(std::max(minZ - position.z, position.z - maxZ), 0.0f);
+    return sqrt(dx * dx + dz * dz);
+}
+
+bool TiledTerrain::compareDistance(const Tile* a, const Tile* b)
+{
+    return a->distance < b->distance;
+}
+
+const TiledTerrain::Tile* TiledTerrain::findTile(float x, float z) const
+{
+    Matrix inverse;
+    _node->getWorldMatrix().invert(&inverse);
+    Vector3 v;
+    inverse.transformPoint(Vector3(x, 0.0f, z), &v);
+    float tileWidth = (float)(_tileSize - 1);
+    float column = (v.x / _scale.x + _columns * tileWidth * 0.5f) / tileWidth;
+    float row = (v.z / _scale.z + _rows * tileWidth * 0.5f) / tileWidth;
+    if (column < 0 || row < 0 || column > _columns || row > _rows)
+        return NULL;
+
+    // Positions on the far edge of the map belong to the last tile.
+    unsigned int c = std::min((unsigned int)column, _columns - 1);
+    unsigned int r = std::min((unsigned int)row, _rows - 1);
+    return _tiles[r * _columns + c];
+}
+
+void TiledTerrain::ReadJob::run()
+{
+    // This runs on a worker thread, so failures are reported by createTerrain().
+    unsigned int size = tile->owner->_tileSize;
+    tile->heightfield = NULL;
+
+    Stream* stream = FileSystem::open(tile->path.c_str());
+    if (stream == NULL)
+        return;
+
+    // The bit depth of the heights follows from the file size.
+    size_t samples = (size_t)size * size;
+    size_t length = stream->length();
+    unsigned int bits = samples > 0 ? (unsigned int)(length / samples) * 8 : 0;
+    if (bits != 8 && bits != 16)
+    {
+        stream->close();
+        SAFE_DELETE(stream);
+        return;
+    }
+
+    unsigned char* bytes = new unsigned char[length];
+    size_t read = stream->read(bytes, 1, length);
+    stream->close();
+    SAFE_DELETE(stream);
+    if (read != length)
+    {
+        SAFE_DELETE_ARRAY(bytes);
+        return;
+    }
+
+    HeightField* heightfield = HeightField::create(size, size);
+    float* heights = heightfield->getArray();
+    if (bits == 16)
+    {
+        for (size_t i = 0; i < samples; ++i)
+        {
+            heights[i] = (bytes[i * 2] | (bytes[i * 2 + 1] << 8)) / 65535.0f;
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < samples; ++i)
+        {
+            heights[i] = bytes[i] / 255.0f;
+        }
+    }
+    SAFE_DELETE_ARRAY(bytes);
+
+    tile->heightfield = heightfield;
+}
+
+void TiledTerrain::CreateJob::run()
+{
+    tile->owner->createTerrain(tile);
+}
+
+}
@@ -0,0 +1,261 @@
+#ifndef TILEDTERRAIN_H_
+#define TILEDTERRAIN_H_
+
+#include "Ref.h"
+#include "Terrain.h"
+#include "JobController.h"
+
+namespace gameplay
+{
+
+class Node;
+
+/**
+ * Defines a terrain that is split into tiles, which are paged in and out around a viewer.
+ *
+ * Each tile is a separate RAW heightmap file, from which a Terrain is created when the tile
+ * comes within the load distance of the viewer. The heights are read on a worker thread of
+ * the game's job controller, and the terrain patches and layer textures of the tile are
+ * created on the main thread once the heights are read. Tiles are unloaded when they are
+ * beyond the unload distance, and also when memory is needed for nearer tiles and loading
+ * them would exceed the memory budget.
+ *
+ * Adjacent tiles share the samples along their common edges, so a map of columns x rows
+ * tiles of tileSize x tileSize samples has (columns * (tileSize - 1) + 1) samples across.
+ * The tiles are attached as children of the node returned by getNode(), which must be
+ * added to a scene for the tiles to be drawn.
+ *
+ * The following properties are available for tiled terrains:
+
+ @verbatim
+    tiledTerrain
+    {
+        // Path of the tile heightmaps, with the column and row of the tile as printf
+        // arguments. The files are 8 or 16-bit RAW heightmaps.
+        tiles = res/terrain/tile_%d_%d.raw
+
+        tileSize = <int>            // Samples along each side of a tile (e.g. 1025).
+        tileCount = <int>, <int>    // Number of tile columns and rows.
+        size = <x>, <y>, <z>        // Size of the whole map.
+        loadDistance = <float>      // Distance from the viewer within which tiles are loaded.
+        unloadDistance = <float>    // Distance from the viewer beyond which tiles are unloaded.
+        memoryBudget = <int>        // Memory the loaded tiles may use, in megabytes.
+
+        // The terrain properties patchSize, detailLevels, skirtScale and layers are
+        // applied to every tile.
+    }
+ @endverbatim
+ *
+ * @script{ignore}
+ */
+class TiledTerrain : public Ref
+{
+public:
+
+    /**
+     * Creates a tiled terrain from the specified properties file.
+     *
+     * @param path Path to the properties file, which may be followed by a '#' and the
+     *      namespace of the tiled terrain.
+     *
+     * @return The new tiled terrain, or NULL if the properties are invalid.
+     */
+    static TiledTerrain* create(const char* path);
+
+    /**
+     * Creates a tiled terrain from the specified properties.
+     *
+     * @param properties The properties of the tiled terrain.
+     *
+     * @return The new tiled terrain, or NULL if the properties are invalid.
+     */
+    static TiledTerrain* create(Properties* properties);
+
+    /**
+     * Returns the node that the tiles are attached to.
+     *
+     * @return The node of the tiled terrain.
+     */
+    Node* getNode() const;
+
+    /**
+     * Pages tiles in and out around the specified viewer position.
+     *
+     * This should be called once per frame, typically with the position of the active camera.
+     *
+     * @param position The position of the viewer, in world space.
+     */
+    void update(const Vector3& position);
+
+    /**
+     * Returns the height of the terrain at the specified world position.
+     *
+     * @param x The world x coordinate.
+     * @param z The world z coordinate.
+     *
+     * @return The height of the terrain, or 0 if the tile that contains the position is not loaded.
+     */
+    float getHeight(float x, float z) const;
+
+    /**
+     * Returns the total number of tiles of the terrain.
+     *
+     * @return The number of tiles.
+     */
+    unsigned int getTileCount() const;
+
+    /**
+     * Returns the number of tiles that are loaded.
+     *
+     * @return The number of loaded tiles.
+     */
+    unsigned int getLoadedTileCount() const;
+
+    /**
+     * Returns the number of tiles that are being loaded.
+     *
+     * @return The number of tiles being loaded.
+     */
+    unsigned int getLoadingTileCount() const;
+
+    /**
+     * Returns the estimated memory used by the loaded and loading tiles.
+     *
+     * @return The memory usage in bytes.
+     */
+    size_t getMemoryUsage() const;
+
+    /**
+     * Returns the memory that the loaded tiles may use.
+     *
+     * @return The memory budget in bytes.
+     */
+    size_t getMemoryBudget() const;
+
+    /**
+     * Sets the memory that the loaded tiles may use.
+     *
+     * @param bytes The memory budget in bytes.
+     */
+    void setMemoryBudget(size_t bytes);
+
+    /**
+     * Returns the distance from the viewer within which tiles are loaded.
+     *
+     * @return The load distance.
+     */
+    float getLoadDistance() const;
+
+    /**
+     * Sets the distances from the viewer within which tiles are loaded and beyond which they are unloaded.
+     *
+     * @param loadDistance The load distance.
+     * @param unloadDistance The unload distance, which should be greater than the load distance.
+     */
+    void setLoadDistance(float loadDistance, float unloadDistance);
+
+private:
+
+    /**
+     * The states of a tile.
+     */
+    enum TileState
+    {
+        TILE_UNLOADED,
+        TILE_LOADING,
+        TILE_LOADED
+    };
+
+    struct Tile;
+
+    /**
+     * Reads the heights of a tile on a worker thread.
+     */
+    class ReadJob : public JobController::Job
+    {
+    public:
+        Tile* tile;
+        void run();
+    };
+
+    /**
+     * Creates the terrain of a tile on the main thread, once its heights are read.
+     */
+    class CreateJob : public JobController::Job
+    {
+    public:
+        Tile* tile;
+        void run();
+    };
+
+    struct Tile
+    {
+        TiledTerrain* owner;
+        unsigned int column;
+        unsigned int row;
+        TileState state;
+        std::string path;
+        HeightField* heightfield;
+        Terrain* terrain;
+        Node* node;
+        ReadJob readJob;
+        CreateJob createJob;
+        JobController::JobId jobId;
+        bool cancelled;
+        bool failed;
+        float distance;
+    };
+
+    /**
+     * Constructor.
+     */
+    TiledTerrain();
+
+    /**
+     * Destructor.
+     */
+    ~TiledTerrain();
+
+    /**
+     * Hidden copy constructor.
+     */
+    TiledTerrain(const TiledTerrain&);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    TiledTerrain& operator=(const TiledTerrain&);
+
+    void load(Tile* tile);
+
+    void unload(Tile* tile);
+
+    void createTerrain(Tile* tile);
+
+    size_t getTileMemory() const;
+
+    float getTileDistance(const Tile* tile, const Vector3& position) const;
+
+    const Tile* findTile(float x, float z) const;
+
+    static bool compareDistance(const Tile* a, const Tile* b);
+
+    Node* _node;
+    Properties* _properties;
+    std::vector<Tile*> _tiles;
+    unsigned int _tileSize;
+    unsigned int _columns;
+    unsigned int _rows;
+    Vector3 _scale;
+    unsigned int _patchSize;
+    unsigned int _detailLevels;
+    float _skirtScale;
+    float _loadDistance;
+    float _unloadDistance;
+    size_t _memoryBudget;
+    unsigned int _loadingCount;
+};
+
+}
+
+#endif
@@ -0,0 +1,325 @@
+#include "Base.h"
+#include "TimerWheel.h"
+
+// The slots of the first wheel are a millisecond each, and the slots of each of the coarser
+// wheels are as long as all of the slots of the wheel below it.
+#define WHEEL0_BITS 8
+#define WHEEL_BITS 6
+#define WHEEL0_SIZE (1 << WHEEL0_BITS)
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_COUNT 3
+
+// The lists are the slots of the wheels, the timers beyond the last wheel, and the timers that are due.
+#define OVERFLOW_LIST (WHEEL0_SIZE + WHEEL_COUNT * WHEEL_SIZE)
+#define DUE_LIST (OVERFLOW_LIST + 1)
+#define LIST_COUNT (DUE_LIST + 1)
+#define LEVEL_COUNT (WHEEL_COUNT + 2)
+
+// A handle is the index of the timer plus one, with the generation of the node in the high bits.
+#define HANDLE_INDEX_BITS 20
+#define HANDLE_INDEX_MASK ((1u << HANDLE_INDEX_BITS) - 1)
+#define HANDLE_GENERATION_MASK ((1u << (32 - HANDLE_INDEX_BITS)) - 1)
+
+namespace gameplay
+{
+
+static long long getTick(double time)
+{
+    return (long long)floor(time);
+}
+
+/**
+ * Returns the level of the wheel a list is a slot of, where the overflow list is the level
+ * above the last wheel, or -1 for the due list.
+ */
+static int getLevel(int list)
+{
+    if (list < WHEEL0_SIZE)
+        return 0;
+    if (list < OVERFLOW_LIST)
+        return 1 + (list - WHEEL0_SIZE) / WHEEL_SIZE;
+    return list == OVERFLOW_LIST ? WHEEL_COUNT + 1 : -1;
+}
+
+TimerWheel::TimerWheel(double time)
+    : _heads(LIST_COUNT, -1), _tails(LIST_COUNT, -1), _free(-1), _count(0), _tick(getTick(time))
+{
+    memset(_levelCounts, 0, sizeof(_levelCounts));
+}
+
+TimerWheel::~TimerWheel()
+{
+}
+
+unsigned int TimerWheel::add(double time, float interval, TimeListener* listener, void* cookie)
+{
+    int index = _free;
+    if (index >= 0)
+    {
+        _free = _nodes[index].next;
+    }
+    else
+    {
+        GP_ASSERT(_nodes.size() < HANDLE_INDEX_MASK);
+        index = (int)_nodes.size();
+        _nodes.push_back(Node());
+        _nodes[index].generation = 0;
+    }
+
+    Node& node = _nodes[index];
+    node.timer.time = time;
+    node.timer.interval = interval > 0.0f ? interval : 0.0f;
+    node.timer.listener = listener;
+    node.timer.cookie = cookie;
+    node.timer.handle = (node.generation << HANDLE_INDEX_BITS) | (unsigned int)(index + 1);
+    node.tick = getTick(time);
+    insert(index);
+    ++_count;
+    return node.timer.handle;
+}
+
+bool TimerWheel::remove(unsigned int handle, Timer* timer)
+{
+    int index = find(handle);
+    if (index < 0)
+        return false;
+
+    if (timer)
+        *timer = _nodes[index].timer;
+    unlink(index);
+    release(index);
+    return true;
+}
+
+unsigned int TimerWheel::remove(TimeListener* listener)
+{
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < _nodes.size(); ++i)
+    {
+        if (_nodes[i].list >= 0 && _nodes[i].timer.listener == listener)
+        {
+            unlink(i);
+            release(i);
+            ++count;
+        }
+    }
+    return count;
+}
+
+bool TimerWheel::contains(unsigned int handle) const
+{
+    return find(handle) >= 0;
+}
+
+bool TimerWheel::next(double time, Timer* timer, bool* finished)
+{
+    GP_ASSERT(timer);
+    GP_ASSERT(finished);
+
+    advance(getTick(time));
+
+    // Only the timers of the current millisecond can be in the due list before their exact time.
+    int index = _heads[DUE_LIST];
+    while (index >= 0 && _nodes[index].timer.time > time)
+        index = _nodes[index].next;
+    if (index < 0)
+        return false;
+
+    Node& node = _nodes[index];
+    *timer = node.timer;
+    unlink(index);
+    if (node.timer.interval > 0.0f)
+    {
+        // Repeat at the next time after this one on the same period, skipping any that were missed.
+        double interval = node.timer.interval;
+        double next = node.timer.time + interval * (floor((time - node.timer.time) / interval) + 1.0);
+        if (next <= time)
+            next += interval;
+        node.timer.time = next;
+        node.tick = getTick(next);
+        insert(index);
+        *finished = false;
+    }
+    else
+    {
+        release(index);
+        *finished = true;
+    }
+    return true;
+}
+
+unsigned int TimerWheel::getCount() const
+{
+    return _count;
+}
+
+void TimerWheel::clear()
+{
+    for (unsigned int i = 0; i < _nodes.size(); ++i)
+    {
+        if (_nodes[i].list >= 0)
+        {
+            unlink(i);
+            release(i);
+        }
+    }
+}
+
+void TimerWheel::insert(int index)
+{
+    long long tick = _nodes[index].tick;
+    long long delta = tick - _tick;
+    int list;
+    if (delta <= 0)
+    {
+        list = DUE_LIST;
+    }
+    else if (delta < WHEEL0_SIZE)
+    {
+        list = (int)(tick & (WHEEL0_SIZE - 1));
+    }
+    else
+    {
+        list = OVERFLOW_LIST;
+        for (int level = 0; level < WHEEL_COUNT; ++level)
+        {
+            int shift = WHEEL0_BITS + level * WHEEL_BITS;
+            if (delta < (1ll << (shift + WHEEL_BITS)))
+            {
+                list = WHEEL0_SIZE + level * WHEEL_SIZE + (int)((tick >> shift) & (WHEEL_SIZE - 1));
+                break;
+            }
+        }
+    }
+    link(index, list);
+}
+
+void TimerWheel::link(int index, int list)
+{
+    Node& node = _nodes[index];
+    node.list = list;
+    node.next = -1;
+    int level = getLevel(list);
+    if (level >= 0)
+        ++_levelCounts[level];
+    node.prev = _tails[list];
+    if (node.prev >= 0)
+        _nodes[node.prev].next = index;
+    else
+        _heads[list] = index;
+    _tails[list] = index;
+}
+
+void TimerWheel::unlink(int index)
+{
+    Node& node = _nodes[index];
+    if (node.prev >= 0)
+        _nodes[node.prev].next = node.next;
+    else
+        _heads[node.list] = node.next;
+    if (node.next >= 0)
+        _nodes[node.next].prev = node.prev;
+    else
+        _tails[node.list] = node.prev;
+    int level = getLevel(node.list);
+    if (level >= 0)
+        --_levelCounts[level];
+    node.list = -1;
+}
+
+void TimerWheel::release(int index)
+{
+    Node& node = _nodes[index];
+    node.list = -1;
+    node.generation = (node.generation + 1) & HANDLE_GENERATION_MASK;
+    node.next = _free;
+    _free = index;
+    --_count;
+}
+
+void TimerWheel::cascade(int list)
+{
+    // Take the whole list first, since the timers may be linked back into the same list.
+    int index = _heads[list];
+    _heads[list] = _tails[list] = -1;
+    while (index >= 0)
+    {
+        int next = _nodes[index].next;
+        --_levelCounts[getLevel(list)];
+        insert(index);
+        index = next;
+    }
+}
+
+void TimerWheel::advance(long long tick)
+{
+    while (_tick < tick)
+    {
+        // Skip to the next turn of the finest wheel that has timers, since nothing is due before it.
+        int shift = 0;
+        int level = 0;
+        while (level < LEVEL_COUNT && _levelCounts[level] == 0)
+        {
+            shift = WHEEL0_BITS + level * WHEEL_BITS;
+            ++level;
+        }
+        if (level == LEVEL_COUNT)
+        {
+            _tick = tick;
+            break;
+        }
+        if (shift > 0)
+        {
+            long long next = ((_tick >> shift) + 1) << shift;
+            if (next > tick)
+            {
+                _tick = tick;
+                break;
+            }
+            _tick = next - 1;
+        }
+
+        ++_tick;
+
+        // When a wheel turns past its first slot, the next slot of the wheel above it is moved
+        // down, starting with the coarsest so its timers can cascade through the finer ones.
+        if ((_tick & (WHEEL0_SIZE - 1)) == 0)
+        {
+            int levels = 1;
+            while (levels < WHEEL_COUNT && ((_tick >> (WHEEL0_BITS + levels * WHEEL_BITS)) << (WHEEL0_BITS + levels * WHEEL_BITS)) == _tick)
+                ++levels;
+            if (levels == WHEEL_COUNT && ((_tick >> (WHEEL0_BITS + WHEEL_COUNT * WHEEL_BITS)) << (WHEEL0_BITS + WHEEL_COUNT * WHEEL_BITS)) == _tick)
+                cascade(OVERFLOW_LIST);
+            for (int level = levels - 1; level >= 0; --level)
+            {
+                int shift = WHEEL0_BITS + level * WHEEL_BITS;
+                cascade(WHEEL0_SIZE + level * WHEEL_SIZE + (int)((_tick >> shift) & (WHEEL_SIZE - 1)));
+            }
+        }
+
+        // The timers of the current slot are now due.
+        int list = (int)(_tick & (WHEEL0_SIZE - 1));
+        int index = _heads[list];
+        _heads[list] = _tails[list] = -1;
+        while (index >= 0)
+        {
+            int next = _nodes[index].next;
+            --_levelCounts[0];
+            link(index, DUE_LIST);
+            index = next;
+        }
+    }
+}
+
+int TimerWheel::find(unsigned int handle) const
+{
+    unsigned int index = (handle & HANDLE_INDEX_MASK) - 1;
+    if (index >= _nodes.size())
+        return -1;
+    const Node& node = _nodes[index];
+    if (node.list < 0 || node.generation != (handle >> HANDLE_INDEX_BITS))
+        return -1;
+    return (int)index;
+}
+
+}
@@ -0,0 +1,172 @@
+#ifndef TIMERWHEEL_H_
+#define TIMERWHEEL_H_
+
+#include "TimeListener.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a hierarchical timer wheel, which keeps the time events scheduled with Game::schedule().
+ *
+ * Timers are kept in lists by the millisecond they are due in, in a wheel of 256 slots for
+ * the next 256 milliseconds and in coarser wheels of 64 slots for later times. A timer is
+ * added and removed in constant time, and as time advances the timers of the slots of a
+ * coarser wheel are moved down into the finer one. Each timer is identified by a handle,
+ * which becomes invalid when the timer is removed or, unless it repeats, when it is due.
+ *
+ * Timers that are due in the same millisecond are returned in the order they were added.
+ *
+ * @script{ignore}
+ */
+class TimerWheel
+{
+public:
+
+    /**
+     * A timer of the wheel.
+     */
+    struct Timer
+    {
+        /**
+         * The game time the timer is due at, in milliseconds.
+         */
+        double time;
+
+        /**
+         * The time between the events of a repeating timer in milliseconds, or 0.
+         */
+        float interval;
+
+        /**
+         * The listener to send the event to.
+         */
+        TimeListener* listener;
+
+        /**
+         * The cookie data of the event.
+         */
+        void* cookie;
+
+        /**
+         * The handle of the timer.
+         */
+        unsigned int handle;
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param time The game time to start the wheel at, in milliseconds.
+     */
+    TimerWheel(double time = 0.0);
+
+    /**
+     * Destructor.
+     */
+    ~TimerWheel();
+
+    /**
+     * Adds a timer.
+     *
+     * @param time The game time the timer is due at, in milliseconds. A time that has already
+     *      passed is due the next time the wheel advances.
+     * @param interval The time between the events of a repeating timer in milliseconds, or 0
+     *      for a timer that is due once.
+     * @param listener The listener to send the event to.
+     * @param cookie The cookie data of the event.
+     *
+     * @return The handle of the timer, which is never 0.
+     */
+    unsigned int add(double time, float interval, TimeListener* listener, void* cookie);
+
+    /**
+     * Removes a timer.
+     *
+     * @param handle The handle of the timer.
+     * @param timer Destination for the timer that was removed, or NULL.
+     *
+     * @return True if the timer was removed, false if the handle is no longer valid.
+     */
+    bool remove(unsigned int handle, Timer* timer = NULL);
+
+    /**
+     * Removes all of the timers of a listener.
+     *
+     * This visits each timer of the wheel.
+     *
+     * @param listener The listener.
+     *
+     * @return The number of timers removed.
+     */
+    unsigned int remove(TimeListener* listener);
+
+    /**
+     * Determines whether a handle is of a timer of the wheel.
+     *
+     * @param handle The handle of the timer.
+     *
+     * @return True if the timer is in the wheel.
+     */
+    bool contains(unsigned int handle) const;
+
+    /**
+     * Advances the wheel to a game time and takes the next timer that is due by then.
+     *
+     * A repeating timer is added again at its next time after the given time, and keeps its handle.
+     *
+     * @param time The game time, in milliseconds.
+     * @param timer Destination for the timer that is due.
+     * @param finished Set to true if the timer is not repeating, and its handle is no longer valid.
+     *
+     * @return True if a timer was due, false if no timer is due by the given time.
+     */
+    bool next(double time, Timer* timer, bool* finished);
+
+    /**
+     * Gets the number of timers in the wheel.
+     *
+     * @return The number of timers.
+     */
+    unsigned int getCount() const;
+
+    /**
+     * Removes all of the timers.
+     */
+    void clear();
+
+private:
+
+    struct Node
+    {
+        Timer timer;
+        long long tick;
+        int prev;
+        int next;
+        int list;
+        unsigned int generation;
+    };
+
+    TimerWheel(const TimerWheel&);
+    TimerWheel& operator=(const TimerWheel&);
+
+    void insert(int index);
+    void link(int index, int list);
+    void unlink(int index);
+    void release(int index);
+    void cascade(int list);
+    void advance(long long tick);
+    int find(unsigned int handle) const;
+
+    std::vector<Node> _nodes;
+    std::vector<int> _heads;
+    std::vector<int> _tails;
+    int _free;
+    unsigned int _count;
+    unsigned int _levelCounts[5];
+    long long _tick;
+};
+
+}
+
+#endif
@@ -8,9 +8,11 @@ namespace gameplay
 
 int Transform::_suspendTransformChanged(0);
 std::vector<Transform*> Transform::_transformsChanged;
+bool Transform::_deferTransformChanged(false);
+std::vector<Transform*> Transform::_transformsDeferred;
 
 Transform::Transform()
-    : _matrixDirtyBits(0), _listeners(NULL)
+    : _matrixDirtyBits(0), _listeners(NULL), _notifyDeferred(false)
 {
     _targetType = AnimationTarget::TRANSFORM;
     _scale.set(Vector3::one());
@@ -18,7 +20,7 @@ Transform::Transform()
 }
 
 Transform::Transform(const Vector3& scale, const Quaternion& rotation, const Vector3& translation)
-    : _matrixDirtyBits(0), _listeners(NULL)
+    : _matrixDirtyBits(0), _listeners(NULL), _notifyDeferred(false)
 {
     _targetType = AnimationTarget::TRANSFORM;
     set(scale, rotation, translation);
@@ -26,7 +28,7 @@ Transform::Transform(const Vector3& scale, const Quaternion& rotation, const Vec
 }
 
 Transform::Transform(const Vector3& scale, const Matrix& rotation, const Vector3& translation)
-    : _matrixDirtyBits(0), _listeners(NULL)
+    : _matrixDirtyBits(0), _listeners(NULL), _notifyDeferred(false)
 {
     _targetType = AnimationTarget::TRANSFORM;
     set(scale, rotation, translation);
@@ -34,7 +36,7 @@ Transform::Transform(const Vector3& scale, const Matrix& rotation, const Vector3
 }
 
 Transform::Transform(const Transform& copy)
-    : _matrixDirtyBits(0), _listeners(NULL)
+    : _matrixDirtyBits(0), _listeners(NULL), _notifyDeferred(false)
 {
     _targetType = AnimationTarget::TRANSFORM;
     set(copy);
@@ -43,6 +45,12 @@ Transform::Transform(const Transform& copy)
 
 Transform::~Transform()
 {
+    if (_notifyDeferred)
+    {
+        std::vector<Transform*>::iterator itr = std::find(_transformsDeferred.begin(), _transformsDeferred.end(), this);
+        if (itr != _transformsDeferred.end())
+            *itr = NULL;
+    }
     SAFE_DELETE(_listeners);
 }
 
@@ -88,6 +96,35 @@ bool Transform::isTransformChangedSuspended()
     return (_suspendTransformChanged > 0);
 }
 
+void Transform::setTransformChangedDeferred(bool deferred)
+{
+    if (_deferTransformChanged && !deferred)
+    {
+        flushTransformChanged();
+    }
+    _deferTransformChanged = deferred;
+}
+
+bool Transform::isTransformChangedDeferred()
+{
+    return _deferTransformChanged;
+}
+
+void Transform::flushTransformChanged()
+{
+    // Listeners may change transforms while they are notified, which are then notified in turn.
+    for (size_t i = 0; i < _transformsDeferred.size(); ++i)
+    {
+        Transform* t = _transformsDeferred[i];
+        if (t)
+        {
+            t->_notifyDeferred = false;
+            t->notifyTransformChanged();
+        }
+    }
+    _transformsDeferred.clear();
+}
+
 const Matrix& Transform::getMatrix() const
 {
     if (_matrixDirtyBits)
@@ -955,7 +992,7 @@ void Transform::addListener(Transform::Listener* listener, long cookie)
     GP_ASSERT(listener);
 
     if (_listeners == NULL)
-        _listeners = new std::list<TransformListener>();
+        _listeners = new std::list<TransformListener, PoolAllocator<TransformListener> >();
 
     TransformListener l;
     l.listener = listener;
@@ -969,7 +1006,7 @@ void Transform::removeListener(Transform::Listener* listener)
 
     if (_listeners)
     {
-        for (std::list<TransformListener>::iterator itr = _listeners->begin(); itr != _listeners->end(); ++itr)
+        for (std::list<TransformListener, PoolAllocator<TransformListener> >::iterator itr = _listeners->begin(); itr != _listeners->end(); ++itr)
         {
             if ((*itr).listener == listener)
             {
@@ -981,10 +1018,24 @@ void Transform::removeListener(Transform::Listener* listener)
 }
 
 void Transform::transformChanged()
+{
+    if (_deferTransformChanged)
+    {
+        if (!_notifyDeferred)
+        {
+            _notifyDeferred = true;
+            _transformsDeferred.push_back(this);
+        }
+        return;
+    }
+    notifyTransformChanged();
+}
+
+void Transform::notifyTransformChanged()
 {
     if (_listeners)
     {
-        for (std::list<TransformListener>::iterator itr = _listeners->begin(); itr != _listeners->end(); ++itr)
+        for (std::list<TransformListener, PoolAllocator<TransformListener> >::iterator itr = _listeners->begin(); itr != _listeners->end(); ++itr)
         {
             TransformListener& l = *itr;
             GP_ASSERT(l.listener);
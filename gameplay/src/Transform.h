@@ -7,6 +7,7 @@
 #include "Matrix.h"
 #include "AnimationTarget.h"
 #include "ScriptTarget.h"
+#include "MemoryPool.h"
 
 namespace gameplay
 {
@@ -120,6 +121,41 @@ public:
      */
     static bool isTransformChangedSuspended();
 
+    /**
+     * Sets whether transform listeners are notified of changes once per frame.
+     *
+     * By default, the listeners of a transform (and its transformChanged script event) are
+     * notified every time it changes. When deferred, the nodes' own world matrices and bounds
+     * are still marked dirty immediately, but the transforms that changed are recorded, and
+     * their listeners are notified once by flushTransformChanged(), which Game calls every
+     * frame after the game and its scripts are updated and before audio is updated and the
+     * frame is rendered. A node moved many times in a frame then notifies its listeners, and
+     * those of its descendants, once.
+     *
+     * Listeners that must see every change, or that must see them before the end of the
+     * update, should not be used with deferred notification.
+     *
+     * @param deferred True to notify listeners once per frame, false to notify them of every change.
+     * @script{ignore}
+     */
+    static void setTransformChangedDeferred(bool deferred);
+
+    /**
+     * Determines whether transform listeners are notified of changes once per frame.
+     *
+     * @return True if notifications are deferred, false otherwise.
+     * @script{ignore}
+     */
+    static bool isTransformChangedDeferred();
+
+    /**
+     * Notifies the listeners of all the transforms that changed since the last call, while
+     * notifications are deferred.
+     *
+     * @script{ignore}
+     */
+    static void flushTransformChanged();
+
     /**
      * Listener interface for Transform events.
      */
@@ -841,6 +877,11 @@ protected:
      */
     virtual void transformChanged();
 
+    /**
+     * Notifies the listeners and the transformChanged script event of the transform.
+     */
+    void notifyTransformChanged();
+
     /**
      * Copies from data from this node into transform for the purpose of cloning.
      * 
@@ -877,7 +918,12 @@ protected:
     /** 
      * List of TransformListener's on the Transform.
      */
-    std::list<TransformListener>* _listeners;
+    std::list<TransformListener, PoolAllocator<TransformListener> >* _listeners;
+
+    /**
+     * Whether the transform is waiting for its listeners to be notified by flushTransformChanged().
+     */
+    bool _notifyDeferred;
 
 private:
    
@@ -885,6 +931,8 @@ private:
 
     static int _suspendTransformChanged;
     static std::vector<Transform*> _transformsChanged;
+    static bool _deferTransformChanged;
+    static std::vector<Transform*> _transformsDeferred;
     
 };
 
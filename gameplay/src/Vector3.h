@@ -15,6 +15,10 @@ class Quaternion;
  * Other uses of directional vectors may wish to leave
  * the magnitude of the vector intact. When used as a point,
  * the elements of the vector represent a position in 3D space.
+ *
+ * Values of this type are copied into their Lua userdata when returned to scripts.
+ *
+ * @script{value}
  */
 class Vector3
 {
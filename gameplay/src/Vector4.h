@@ -8,6 +8,10 @@ class Matrix;
 
 /**
  * Defines 4-element floating point vector.
+ *
+ * Values of this type are copied into their Lua userdata when returned to scripts.
+ *
+ * @script{value}
  */
 class Vector4
 {
@@ -1,26 +1,105 @@
 #include "Base.h"
+#include "GLStateCache.h"
 #include "VertexAttributeBinding.h"
 #include "Mesh.h"
 #include "Effect.h"
 
+#ifndef GL_HALF_FLOAT
+#ifdef GL_HALF_FLOAT_OES
+#define GL_HALF_FLOAT GL_HALF_FLOAT_OES
+#else
+#define GL_HALF_FLOAT 0x140B
+#endif
+#endif
+#ifndef GL_INT_2_10_10_10_REV
+#define GL_INT_2_10_10_10_REV 0x8D9F
+#endif
+
 namespace gameplay
 {
 
+/**
+ * Identifies a cached binding. Bindings of the same vertex buffer and format to the same
+ * effect are identical, so meshes that share a vertex buffer also share their bindings.
+ * The format is owned by the mesh the binding references.
+ */
+struct BindingKey
+{
+    VertexBufferHandle vertexBuffer;
+    const Effect* effect;
+    const VertexFormat* vertexFormat;
+
+    BindingKey(VertexBufferHandle vertexBuffer, const Effect* effect, const VertexFormat* vertexFormat)
+        : vertexBuffer(vertexBuffer), effect(effect), vertexFormat(vertexFormat)
+    {
+    }
+
+    bool operator<(const BindingKey& key) const
+    {
+        if (vertexBuffer != key.vertexBuffer)
+            return vertexBuffer < key.vertexBuffer;
+        if (effect != key.effect)
+            return effect < key.effect;
+
+        unsigned int count = vertexFormat->getElementCount();
+        if (count != key.vertexFormat->getElementCount())
+            return count < key.vertexFormat->getElementCount();
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            const VertexFormat::Element& a = vertexFormat->getElement(i);
+            const VertexFormat::Element& b = key.vertexFormat->getElement(i);
+            if (a.usage != b.usage)
+                return a.usage < b.usage;
+            if (a.size != b.size)
+                return a.size < b.size;
+            if (a.type != b.type)
+                return a.type < b.type;
+            if (a.normalized != b.normalized)
+                return b.normalized;
+        }
+        return false;
+    }
+};
+
 static GLuint __maxVertexAttribs = 0;
-static std::vector<VertexAttributeBinding*> __vertexAttributeBindingCache;
+static std::map<BindingKey, VertexAttributeBinding*> __vertexAttributeBindingCache;
+
+static GLenum toGLType(VertexFormat::Type type)
+{
+    switch (type)
+    {
+    case VertexFormat::HALF_FLOAT:
+        return GL_HALF_FLOAT;
+    case VertexFormat::BYTE:
+        return GL_BYTE;
+    case VertexFormat::UNSIGNED_BYTE:
+        return GL_UNSIGNED_BYTE;
+    case VertexFormat::SHORT:
+        return GL_SHORT;
+    case VertexFormat::UNSIGNED_SHORT:
+        return GL_UNSIGNED_SHORT;
+    case VertexFormat::INT_2_10_10_10_REV:
+        return GL_INT_2_10_10_10_REV;
+    default:
+        return GL_FLOAT;
+    }
+}
 
 VertexAttributeBinding::VertexAttributeBinding() :
-    _handle(0), _attributes(NULL), _mesh(NULL), _effect(NULL)
+    _handle(0), _attributes(NULL), _mesh(NULL), _vertexBuffer(0), _effect(NULL), _vertexOffset(0)
 {
 }
 
 VertexAttributeBinding::~VertexAttributeBinding()
 {
     // Delete from the vertex attribute binding cache.
-    std::vector<VertexAttributeBinding*>::iterator itr = std::find(__vertexAttributeBindingCache.begin(), __vertexAttributeBindingCache.end(), this);
-    if (itr != __vertexAttributeBindingCache.end())
+    if (_mesh)
     {
-        __vertexAttributeBindingCache.erase(itr);
+        std::map<BindingKey, VertexAttributeBinding*>::iterator itr = __vertexAttributeBindingCache.find(BindingKey(_vertexBuffer, _effect, &_mesh->getVertexFormat()));
+        if (itr != __vertexAttributeBindingCache.end() && itr->second == this)
+        {
+            __vertexAttributeBindingCache.erase(itr);
+        }
     }
 
     SAFE_RELEASE(_mesh);
@@ -29,7 +108,7 @@ VertexAttributeBinding::~VertexAttributeBinding()
 
     if (_handle)
     {
-        GL_ASSERT( glDeleteVertexArrays(1, &_handle) );
+        GLStateCache::deleteVertexArrays(1, &_handle);
         _handle = 0;
     }
 }
@@ -37,27 +116,30 @@ VertexAttributeBinding::~VertexAttributeBinding()
 VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, Effect* effect)
 {
     GP_ASSERT(mesh);
+    GP_ASSERT(effect);
+
+    // Effects whose attributes are all at their canonical locations share the bindings
+    // of the mesh, which are keyed and created without an effect.
+    if (effect->hasCanonicalAttributeLocations())
+        effect = NULL;
 
     // Search for an existing vertex attribute binding that can be used.
-    VertexAttributeBinding* b;
-    for (size_t i = 0, count = __vertexAttributeBindingCache.size(); i < count; ++i)
+    BindingKey key(mesh->getVertexBuffer(), effect, &mesh->getVertexFormat());
+    std::map<BindingKey, VertexAttributeBinding*>::iterator itr = __vertexAttributeBindingCache.find(key);
+    if (itr != __vertexAttributeBindingCache.end())
     {
-        b = __vertexAttributeBindingCache[i];
-        GP_ASSERT(b);
-        if (b->_mesh == mesh && b->_effect == effect)
-        {
-            // Found a match!
-            b->addRef();
-            return b;
-        }
+        // Found a match!
+        GP_ASSERT(itr->second);
+        itr->second->addRef();
+        return itr->second;
     }
 
-    b = create(mesh, mesh->getVertexFormat(), 0, effect);
+    VertexAttributeBinding* b = create(mesh, mesh->getVertexBuffer(), mesh->getVertexFormat(), 0, effect);
 
-    // Add the new vertex attribute binding to the cache.
+    // Add the new vertex attribute binding to the cache, keyed by the format of its own mesh.
     if (b)
     {
-        __vertexAttributeBindingCache.push_back(b);
+        __vertexAttributeBindingCache[BindingKey(b->_vertexBuffer, effect, &mesh->getVertexFormat())] = b;
     }
 
     return b;
@@ -65,12 +147,18 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, Effect* effec
 
 VertexAttributeBinding* VertexAttributeBinding::create(const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect)
 {
-    return create(NULL, vertexFormat, vertexPointer, effect);
+    return create(NULL, 0, vertexFormat, vertexPointer, effect);
 }
 
-VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect)
+VertexAttributeBinding* VertexAttributeBinding::create(VertexBufferHandle vertexBuffer, const VertexFormat& vertexFormat, unsigned int vertexOffset, Effect* effect)
 {
-    GP_ASSERT(effect);
+    GP_ASSERT(vertexBuffer);
+    return create(NULL, vertexBuffer, vertexFormat, (void*)(size_t)vertexOffset, effect);
+}
+
+VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, VertexBufferHandle vertexBuffer, const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect)
+{
+    GP_ASSERT(effect || mesh);
 
     // One-time initialization.
     if (__maxVertexAttribs == 0)
@@ -90,10 +178,10 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexF
     VertexAttributeBinding* b = new VertexAttributeBinding();
 
 #ifdef USE_VAO
-    if (mesh && glGenVertexArrays)
+    if (vertexBuffer && glGenVertexArrays)
     {
-        GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
-        GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
+        GLStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
+        GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
         // Use hardware VAOs.
         GL_ASSERT( glGenVertexArrays(1, &b->_handle) );
@@ -106,37 +194,40 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexF
         }
 
         // Bind the new VAO.
-        GL_ASSERT( glBindVertexArray(b->_handle) );
+        GLStateCache::bindVertexArray(b->_handle);
 
-        // Bind the Mesh VBO so our glVertexAttribPointer calls use it.
-        GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, mesh->getVertexBuffer()) );
+        // Bind the VBO so our glVertexAttribPointer calls use it.
+        GLStateCache::bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
     }
-    else
 #endif
+
+    // Construct a software representation of a VAO. VAOs keep it too, to point their
+    // attributes into another copy of the vertices of a mesh (see Mesh::setBufferCount).
+    VertexAttribute* attribs = new VertexAttribute[__maxVertexAttribs];
+    for (unsigned int i = 0; i < __maxVertexAttribs; ++i)
     {
-        // Construct a software representation of a VAO.
-        VertexAttribute* attribs = new VertexAttribute[__maxVertexAttribs];
-        for (unsigned int i = 0; i < __maxVertexAttribs; ++i)
-        {
-            // Set GL defaults
-            attribs[i].enabled = GL_FALSE;
-            attribs[i].size = 4;
-            attribs[i].stride = 0;
-            attribs[i].type = GL_FLOAT;
-            attribs[i].normalized = GL_FALSE;
-            attribs[i].pointer = 0;
-        }
-        b->_attributes = attribs;
+        // Set GL defaults
+        attribs[i].enabled = GL_FALSE;
+        attribs[i].size = 4;
+        attribs[i].stride = 0;
+        attribs[i].type = GL_FLOAT;
+        attribs[i].normalized = GL_FALSE;
+        attribs[i].pointer = 0;
     }
+    b->_attributes = attribs;
 
     if (mesh)
     {
         b->_mesh = mesh;
         mesh->addRef();
     }
+    b->_vertexBuffer = vertexBuffer;
     
-    b->_effect = effect;
-    effect->addRef();
+    if (effect)
+    {
+        b->_effect = effect;
+        effect->addRef();
+    }
 
     // Call setVertexAttribPointer for each vertex element.
     std::string name;
@@ -146,57 +237,65 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexF
         const VertexFormat::Element& e = vertexFormat.getElement(i);
         gameplay::VertexAttribute attrib;
 
-        // Constructor vertex attribute name expected in shader.
-        switch (e.usage)
+        if (effect == NULL)
         {
-        case VertexFormat::POSITION:
-            attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_POSITION_NAME);
-            break;
-        case VertexFormat::NORMAL:
-            attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_NORMAL_NAME);
-            break;
-        case VertexFormat::COLOR:
-            attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_COLOR_NAME);
-            break;
-        case VertexFormat::TANGENT:
-            attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_TANGENT_NAME);
-            break;
-        case VertexFormat::BINORMAL:
-            attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_BINORMAL_NAME);
-            break;
-        case VertexFormat::BLENDWEIGHTS:
-            attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_BLENDWEIGHTS_NAME);
-            break;
-        case VertexFormat::BLENDINDICES:
-            attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_BLENDINDICES_NAME);
-            break;
-        case VertexFormat::TEXCOORD0:
-            if ((attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_TEXCOORD_PREFIX_NAME)) != -1)
-                break;
-
-            /*// Try adding a "0" after the texcoord attrib name (flexible name for this case).
-            if (attrib == -1)
+            // Bind every element at its canonical location (see Effect::setCanonicalAttributeLocations).
+            attrib = (e.usage > 0 && (GLuint)e.usage - 1 < __maxVertexAttribs) ? (gameplay::VertexAttribute)(e.usage - 1) : -1;
+        }
+        else
+        {
+            // Constructor vertex attribute name expected in shader.
+            switch (e.usage)
             {
+            case VertexFormat::POSITION:
+                attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_POSITION_NAME);
+                break;
+            case VertexFormat::NORMAL:
+                attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_NORMAL_NAME);
+                break;
+            case VertexFormat::COLOR:
+                attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_COLOR_NAME);
+                break;
+            case VertexFormat::TANGENT:
+                attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_TANGENT_NAME);
+                break;
+            case VertexFormat::BINORMAL:
+                attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_BINORMAL_NAME);
+                break;
+            case VertexFormat::BLENDWEIGHTS:
+                attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_BLENDWEIGHTS_NAME);
+                break;
+            case VertexFormat::BLENDINDICES:
+                attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_BLENDINDICES_NAME);
+                break;
+            case VertexFormat::TEXCOORD0:
+                if ((attrib = effect->getVertexAttribute(VERTEX_ATTRIBUTE_TEXCOORD_PREFIX_NAME)) != -1)
+                    break;
+
+                /*// Try adding a "0" after the texcoord attrib name (flexible name for this case).
+                if (attrib == -1)
+                {
+                    name = VERTEX_ATTRIBUTE_TEXCOORD_PREFIX_NAME;
+                    name += '0';
+                    attrib = effect->getVertexAttribute(name.c_str());
+                }
+                break;*/
+            case VertexFormat::TEXCOORD1:
+            case VertexFormat::TEXCOORD2:
+            case VertexFormat::TEXCOORD3:
+            case VertexFormat::TEXCOORD4:
+            case VertexFormat::TEXCOORD5:
+            case VertexFormat::TEXCOORD6:
+            case VertexFormat::TEXCOORD7:
                 name = VERTEX_ATTRIBUTE_TEXCOORD_PREFIX_NAME;
-                name += '0';
+                name += '0' + (e.usage - VertexFormat::TEXCOORD0);
                 attrib = effect->getVertexAttribute(name.c_str());
+                break;
+            default:
+                // This happens whenever vertex data contains extra information (not an error).
+                attrib = -1;
+                break;
             }
-            break;*/
-        case VertexFormat::TEXCOORD1:
-        case VertexFormat::TEXCOORD2:
-        case VertexFormat::TEXCOORD3:
-        case VertexFormat::TEXCOORD4:
-        case VertexFormat::TEXCOORD5:
-        case VertexFormat::TEXCOORD6:
-        case VertexFormat::TEXCOORD7:
-            name = VERTEX_ATTRIBUTE_TEXCOORD_PREFIX_NAME;
-            name += '0' + (e.usage - VertexFormat::TEXCOORD0);
-            attrib = effect->getVertexAttribute(name.c_str());
-            break;
-        default:
-            // This happens whenever vertex data contains extra information (not an error).
-            attrib = -1;
-            break;
         }
 
         if (attrib == -1)
@@ -206,15 +305,15 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexF
         else
         {
             void* pointer = vertexPointer ? (void*)(((unsigned char*)vertexPointer) + offset) : (void*)offset;
-            b->setVertexAttribPointer(attrib, (GLint)e.size, GL_FLOAT, GL_FALSE, (GLsizei)vertexFormat.getVertexSize(), pointer);
+            b->setVertexAttribPointer(attrib, (GLint)e.size, toGLType(e.type), e.normalized ? GL_TRUE : GL_FALSE, (GLsizei)vertexFormat.getVertexSize(), pointer);
         }
 
-        offset += e.size * sizeof(float);
+        offset += e.getByteSize();
     }
 
     if (b->_handle)
     {
-        GL_ASSERT( glBindVertexArray(0) );
+        GLStateCache::bindVertexArray(0);
     }
 
     return b;
@@ -230,49 +329,55 @@ void VertexAttributeBinding::setVertexAttribPointer(GLuint indx, GLint size, GLe
         GL_ASSERT( glVertexAttribPointer(indx, size, type, normalize, stride, pointer) );
         GL_ASSERT( glEnableVertexAttribArray(indx) );
     }
-    else
-    {
-        // Software mode.
-        GP_ASSERT(_attributes);
-        _attributes[indx].enabled = true;
-        _attributes[indx].size = size;
-        _attributes[indx].type = type;
-        _attributes[indx].normalized = normalize;
-        _attributes[indx].stride = stride;
-        _attributes[indx].pointer = pointer;
-    }
+
+    GP_ASSERT(_attributes);
+    _attributes[indx].enabled = true;
+    _attributes[indx].size = size;
+    _attributes[indx].type = type;
+    _attributes[indx].normalized = normalize;
+    _attributes[indx].stride = stride;
+    _attributes[indx].pointer = pointer;
 }
 
 void VertexAttributeBinding::bind()
 {
+    // Dynamic meshes with several copies of their vertices write new data to the next copy
+    // and draw from it.
+    unsigned int vertexOffset = 0;
+    if (_mesh)
+    {
+        _mesh->updateBuffers();
+        vertexOffset = _mesh->getVertexOffset();
+    }
+
     if (_handle)
     {
         // Hardware mode
-        GL_ASSERT( glBindVertexArray(_handle) );
+        GLStateCache::bindVertexArray(_handle);
+        if (vertexOffset == _vertexOffset)
+            return;
+        GLStateCache::bindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
     }
     else
     {
         // Software mode
-        if (_mesh)
-        {
-            GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _mesh->getVertexBuffer()) );
-        }
-        else
-        {
-            GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
-        }
+        GLStateCache::bindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
+    }
 
-        GP_ASSERT(_attributes);
-        for (unsigned int i = 0; i < __maxVertexAttribs; ++i)
+    GP_ASSERT(_attributes);
+    for (unsigned int i = 0; i < __maxVertexAttribs; ++i)
+    {
+        VertexAttribute& a = _attributes[i];
+        if (a.enabled)
         {
-            VertexAttribute& a = _attributes[i];
-            if (a.enabled)
+            GL_ASSERT( glVertexAttribPointer(i, a.size, a.type, a.normalized, a.stride, (unsigned char*)a.pointer + vertexOffset) );
+            if (_handle == 0)
             {
-                GL_ASSERT( glVertexAttribPointer(i, a.size, a.type, a.normalized, a.stride, a.pointer) );
                 GL_ASSERT( glEnableVertexAttribArray(i) );
             }
         }
     }
+    _vertexOffset = vertexOffset;
 }
 
 void VertexAttributeBinding::unbind()
@@ -280,14 +385,14 @@ void VertexAttributeBinding::unbind()
     if (_handle)
     {
         // Hardware mode
-        GL_ASSERT( glBindVertexArray(0) );
+        GLStateCache::bindVertexArray(0);
     }
     else
     {
         // Software mode
-        if (_mesh)
+        if (_vertexBuffer)
         {
-            GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
+            GLStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
         }
 
         GP_ASSERT(_attributes);
@@ -37,7 +37,10 @@ public:
      * Creates a new VertexAttributeBinding between the given Mesh and Effect.
      *
      * If a VertexAttributeBinding matching the specified Mesh and Effect already
-     * exists, it will be returned. Otherwise, a new VertexAttributeBinding will
+     * exists, it will be returned. Bindings are shared by meshes that have the same
+     * vertex buffer and vertex format, and effects whose attributes are all at their
+     * canonical locations (see Effect::setCanonicalAttributeLocations) share a single
+     * binding per mesh. Otherwise, a new VertexAttributeBinding will
      * be returned. If OpenGL VAOs are enabled, the a new VAO will be created and
      * stored in the returned VertexAttributeBinding, otherwise a client-side
      * array of vertex attribute bindings will be stored.
@@ -68,6 +71,23 @@ public:
      */
     static VertexAttributeBinding* create(const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect);
 
+    /**
+     * Creates a vertex attribute binding for vertices stored in a vertex buffer.
+     *
+     * This is used for vertex buffers that are not owned by a Mesh, such as the streaming
+     * buffers of a MeshBatch. The vertex attribute pointers are offsets from the start of
+     * the vertex buffer plus vertexOffset, formatted as indicated in the specified vertexFormat parameter.
+     *
+     * @param vertexBuffer The vertex buffer.
+     * @param vertexFormat The vertex format.
+     * @param vertexOffset The offset of the first vertex in the buffer, in bytes.
+     * @param effect The effect.
+     *
+     * @return A VertexAttributeBinding for the requested parameters.
+     * @script{ignore}
+     */
+    static VertexAttributeBinding* create(VertexBufferHandle vertexBuffer, const VertexFormat& vertexFormat, unsigned int vertexOffset, Effect* effect);
+
     /**
      * Binds this vertex array object.
      */
@@ -106,14 +126,17 @@ private:
      */
     VertexAttributeBinding& operator=(const VertexAttributeBinding&);
 
-    static VertexAttributeBinding* create(Mesh* mesh, const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect);
+    static VertexAttributeBinding* create(Mesh* mesh, VertexBufferHandle vertexBuffer, const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect);
 
     void setVertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboolean normalize, GLsizei stride, void* pointer);
 
     GLuint _handle;
     VertexAttribute* _attributes;
     Mesh* _mesh;
+    VertexBufferHandle _vertexBuffer;
     Effect* _effect;
+    // The offset of the copy of the vertices of the mesh that the attributes point into.
+    unsigned int _vertexOffset;
 };
 
 }
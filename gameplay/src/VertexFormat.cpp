@@ -4,6 +4,17 @@
 namespace gameplay
 {
 
+static int __halfFloatSupported = -1;
+static int __int2101010Supported = -1;
+
+#if defined(OPENGL_ES) || defined(__APPLE__)
+static bool hasExtension(const char* name)
+{
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    return extensions && strstr(extensions, name) != NULL;
+}
+#endif
+
 VertexFormat::VertexFormat(const Element* elements, unsigned int elementCount)
     : _vertexSize(0)
 {
@@ -17,7 +28,7 @@ VertexFormat::VertexFormat(const Element* elements, unsigned int elementCount)
         memcpy(&element, &elements[i], sizeof(Element));
         _elements.push_back(element);
 
-        _vertexSize += element.size * sizeof(float);
+        _vertexSize += element.getByteSize();
     }
 }
 
@@ -62,18 +73,42 @@ bool VertexFormat::operator != (const VertexFormat& f) const
 }
 
 VertexFormat::Element::Element() :
-    usage(POSITION), size(0)
+    usage(POSITION), size(0), type(FLOAT), normalized(false)
 {
 }
 
 VertexFormat::Element::Element(Usage usage, unsigned int size) :
-    usage(usage), size(size)
+    usage(usage), size(size), type(FLOAT), normalized(false)
+{
+}
+
+VertexFormat::Element::Element(Usage usage, unsigned int size, Type type, bool normalized) :
+    usage(usage), size(size), type(type), normalized(normalized)
 {
+    GP_ASSERT(type != INT_2_10_10_10_REV || size == 4);
+}
+
+unsigned int VertexFormat::Element::getByteSize() const
+{
+    switch (type)
+    {
+    case HALF_FLOAT:
+    case SHORT:
+    case UNSIGNED_SHORT:
+        return size * 2;
+    case BYTE:
+    case UNSIGNED_BYTE:
+        return size;
+    case INT_2_10_10_10_REV:
+        return 4;
+    default:
+        return size * sizeof(float);
+    }
 }
 
 bool VertexFormat::Element::operator == (const VertexFormat::Element& e) const
 {
-    return (size == e.size && usage == e.usage);
+    return (size == e.size && usage == e.usage && type == e.type && normalized == e.normalized);
 }
 
 bool VertexFormat::Element::operator != (const VertexFormat::Element& e) const
@@ -120,4 +155,37 @@ const char* VertexFormat::toString(Usage usage)
     }
 }
 
+bool VertexFormat::isTypeSupported(Type type)
+{
+    switch (type)
+    {
+    case HALF_FLOAT:
+        if (__halfFloatSupported == -1)
+        {
+#if defined(OPENGL_ES)
+            __halfFloatSupported = hasExtension("GL_OES_vertex_half_float") ? 1 : 0;
+#elif defined(__APPLE__)
+            __halfFloatSupported = hasExtension("GL_ARB_half_float_vertex") ? 1 : 0;
+#else
+            __halfFloatSupported = (GLEW_VERSION_3_0 || GLEW_ARB_half_float_vertex) ? 1 : 0;
+#endif
+        }
+        return __halfFloatSupported == 1;
+    case INT_2_10_10_10_REV:
+        if (__int2101010Supported == -1)
+        {
+#if defined(OPENGL_ES)
+            __int2101010Supported = 0;
+#elif defined(__APPLE__)
+            __int2101010Supported = hasExtension("GL_ARB_vertex_type_2_10_10_10_rev") ? 1 : 0;
+#else
+            __int2101010Supported = (GLEW_VERSION_3_3 || GLEW_ARB_vertex_type_2_10_10_10_rev) ? 1 : 0;
+#endif
+        }
+        return __int2101010Supported == 1;
+    default:
+        return true;
+    }
+}
+
 }
@@ -36,13 +36,61 @@ public:
         TEXCOORD7 = 15
     };
 
+    /**
+     * Defines the types of the values in vertex elements.
+     *
+     * Values of the integer types are mapped to [0, 1] (unsigned) or [-1, 1] (signed)
+     * in shaders if the element is normalized, and converted to floats as they are otherwise.
+     *
+     * @script{ignore}
+     */
+    enum Type
+    {
+        /**
+         * 32-bit floating point values.
+         */
+        FLOAT = 0,
+
+        /**
+         * 16-bit floating point values.
+         */
+        HALF_FLOAT = 1,
+
+        /**
+         * 8-bit signed integer values.
+         */
+        BYTE = 2,
+
+        /**
+         * 8-bit unsigned integer values.
+         */
+        UNSIGNED_BYTE = 3,
+
+        /**
+         * 16-bit signed integer values.
+         */
+        SHORT = 4,
+
+        /**
+         * 16-bit unsigned integer values.
+         */
+        UNSIGNED_SHORT = 5,
+
+        /**
+         * Four signed integer values packed in 32 bits: 10 bits each for x, y and z
+         * from the lowest bit, and 2 bits for w. The element must have a size of 4.
+         */
+        INT_2_10_10_10_REV = 6
+    };
+
     /**
      * Defines a single element within a vertex format.
      *
-     * All vertex elements are assumed to be of type float, but can
-     * have a varying number of float values (1-4), which is represented
-     * by the size attribute. Additionally, vertex elements are assumed
-     * to be tightly packed.
+     * Vertex elements are of type float unless another type is given, and
+     * can have a varying number of values (1-4), which is represented by
+     * the size attribute. Additionally, vertex elements are assumed to be
+     * tightly packed, so elements of the smaller types should have sizes
+     * that keep the following elements aligned to 4 bytes.
      */
     class Element
     {
@@ -57,6 +105,20 @@ public:
          */
         unsigned int size;
 
+        /**
+         * The type of the values in the vertex element.
+         *
+         * @script{ignore}
+         */
+        Type type;
+
+        /**
+         * Whether integer values are normalized to [0, 1] or [-1, 1].
+         *
+         * @script{ignore}
+         */
+        bool normalized;
+
         /**
          * Constructor.
          */
@@ -70,6 +132,27 @@ public:
          */
         Element(Usage usage, unsigned int size);
 
+        /**
+         * Constructor.
+         *
+         * @param usage The vertex element usage semantic.
+         * @param size The number of values in the vertex element.
+         * @param type The type of the values.
+         * @param normalized Whether integer values are normalized.
+         *
+         * @script{ignore}
+         */
+        Element(Usage usage, unsigned int size, Type type, bool normalized);
+
+        /**
+         * Returns the size of the vertex element in bytes.
+         *
+         * @return The number of bytes taken by the values of the element.
+         *
+         * @script{ignore}
+         */
+        unsigned int getByteSize() const;
+
         /**
          * Compares two vertex elements for equality.
          *
@@ -146,6 +229,19 @@ public:
      */
     static const char* toString(Usage usage);
 
+    /**
+     * Determines whether vertex elements of a type can be drawn on this platform.
+     *
+     * Bundles that contain vertices with unsupported types are converted to floats when loaded.
+     *
+     * @param type The type of the values in a vertex element.
+     *
+     * @return True if the type is supported.
+     *
+     * @script{ignore}
+     */
+    static bool isTypeSupported(Type type);
+
 private:
 
     std::vector<Element> _elements;
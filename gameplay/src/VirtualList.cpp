@@ -0,0 +1,201 @@
+#include "Base.h"
+#include "VirtualList.h"
+#include "AbsoluteLayout.h"
+
+namespace gameplay
+{
+
+VirtualList::VirtualList()
+    : _dataSource(NULL), _itemHeight(0.0f), _reload(false)
+{
+}
+
+VirtualList::~VirtualList()
+{
+}
+
+VirtualList* VirtualList::create(const char* id, Theme::Style* style, float itemHeight)
+{
+    GP_ASSERT(style);
+
+    VirtualList* list = new VirtualList();
+    list->_layout = AbsoluteLayout::create();
+    list->_scroll = SCROLL_VERTICAL;
+    list->_itemHeight = itemHeight;
+    if (id)
+        list->_id = id;
+    list->_style = style;
+    return list;
+}
+
+VirtualList* VirtualList::create(Theme::Style* style, Properties* properties, Theme* theme)
+{
+    GP_ASSERT(properties);
+
+    VirtualList* list = new VirtualList();
+    list->_layout = AbsoluteLayout::create();
+    list->initialize(style, properties);
+    list->_scroll = SCROLL_VERTICAL;
+    list->_itemHeight = properties->getFloat("itemHeight");
+    list->setScrollBarsAutoHide(properties->getBool("scrollBarsAutoHide"));
+    list->setScrollWheelRequiresFocus(properties->getBool("scrollWheelRequiresFocus"));
+    if (properties->exists("scrollingFriction"))
+        list->setScrollingFriction(properties->getFloat("scrollingFriction"));
+    if (properties->exists("scrollWheelSpeed"))
+        list->setScrollWheelSpeed(properties->getFloat("scrollWheelSpeed"));
+
+    return list;
+}
+
+void VirtualList::setDataSource(DataSource* dataSource)
+{
+    if (dataSource != _dataSource)
+    {
+        clearItems();
+        _dataSource = dataSource;
+        _dirty = true;
+    }
+}
+
+VirtualList::DataSource* VirtualList::getDataSource() const
+{
+    return _dataSource;
+}
+
+void VirtualList::setItemHeight(float height)
+{
+    if (height != _itemHeight)
+    {
+        _itemHeight = height;
+        _dirty = true;
+    }
+}
+
+float VirtualList::getItemHeight() const
+{
+    return _itemHeight;
+}
+
+void VirtualList::reloadItems()
+{
+    _reload = true;
+    _dirty = true;
+}
+
+int VirtualList::getItemIndex(Control* item) const
+{
+    for (size_t i = 0, count = _items.size(); i < count; ++i)
+    {
+        if (_items[i] == item)
+            return item->isVisible() ? _itemIndices[i] : -1;
+    }
+    return -1;
+}
+
+unsigned int VirtualList::getItemControlCount() const
+{
+    return _items.size();
+}
+
+const char* VirtualList::getType() const
+{
+    return "virtualList";
+}
+
+void VirtualList::updateLayout(const Vector2& offset)
+{
+    bindItems(offset);
+    Container::updateLayout(offset);
+}
+
+void VirtualList::measureContents(float* width, float* height)
+{
+    GP_ASSERT(width);
+    GP_ASSERT(height);
+
+    // The content is as tall as all the items, not just the ones that have controls.
+    Container::measureContents(width, height);
+    *height = _dataSource ? _dataSource->getItemCount() * _itemHeight : 0.0f;
+}
+
+void VirtualList::bindItems(const Vector2& offset)
+{
+    unsigned int itemCount = _dataSource ? _dataSource->getItemCount() : 0;
+    if (itemCount == 0 || _itemHeight <= 0.0f)
+    {
+        for (size_t i = 0, count = _items.size(); i < count; ++i)
+        {
+            _items[i]->setVisible(false);
+        }
+        return;
+    }
+
+    // Find the items that intersect the viewport at the scroll offset.
+    float top = std::max(-offset.y, 0.0f);
+    float height = _viewportBounds.height;
+    unsigned int first = std::min((unsigned int)(top / _itemHeight), itemCount);
+    unsigned int last = std::min((unsigned int)ceilf((top + height) / _itemHeight), itemCount);
+
+    // Create enough controls for every item that can be visible at once. Item i is always
+    // displayed by control i % n, so items that stay visible while scrolling keep their controls
+    // and only the items that scroll into view have to be bound.
+    unsigned int controlCount = (unsigned int)ceilf(height / _itemHeight) + 1;
+    if (_items.size() < controlCount)
+    {
+        while (_items.size() < controlCount)
+        {
+            Control* item = _dataSource->createItem(this);
+            if (item == NULL)
+            {
+                GP_ERROR("Failed to create item control for virtual list '%s'.", getId());
+                break;
+            }
+            addControl(item);
+            item->release(); // the list now owns the control
+            _items.push_back(item);
+        }
+
+        // The controls of the items change with the number of controls.
+        _itemIndices.assign(_items.size(), -1);
+    }
+    if (_items.empty())
+        return;
+
+    unsigned int n = _items.size();
+    std::vector<bool> visible(n, false);
+    for (unsigned int i = first; i < last; ++i)
+    {
+        unsigned int slot = i % n;
+        Control* item = _items[slot];
+        if (_itemIndices[slot] != (int)i || _reload)
+        {
+            _dataSource->bindItem(item, i);
+            _itemIndices[slot] = (int)i;
+        }
+        item->setPosition(0, i * _itemHeight);
+        item->setVisible(true);
+        visible[slot] = true;
+    }
+    for (unsigned int slot = 0; slot < n; ++slot)
+    {
+        if (!visible[slot])
+        {
+            _items[slot]->setVisible(false);
+            if (_reload)
+                _itemIndices[slot] = -1;
+        }
+    }
+    _reload = false;
+}
+
+void VirtualList::clearItems()
+{
+    for (size_t i = 0, count = _items.size(); i < count; ++i)
+    {
+        removeControl(_items[i]);
+    }
+    _items.clear();
+    _itemIndices.clear();
+}
+
+}
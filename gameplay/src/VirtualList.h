@@ -0,0 +1,209 @@
+#ifndef VIRTUALLIST_H_
+#define VIRTUALLIST_H_
+
+#include "Container.h"
+
+namespace gameplay
+{
+
+/**
+ * A vertically scrolling list of items that only creates controls for the visible items.
+ *
+ * The items of the list are provided by a data source. All items have the same height, so
+ * the list knows which items are visible at any scroll position without creating controls
+ * for the others. The list keeps a pool of item controls, which are created by the data
+ * source as they are needed, and binds them to the items that scroll into view, so only
+ * about as many controls as fit in the list exist, regardless of the number of items.
+ *
+ * The following properties are available for virtual lists:
+
+ @verbatim
+     virtualList <listID>
+     {
+         // All the properties of containers, except layout and scroll, which are
+         // always LAYOUT_ABSOLUTE and SCROLL_VERTICAL. Nested controls are ignored.
+         itemHeight = <float>  // The height of every item in the list.
+     }
+ @endverbatim
+ */
+class VirtualList : public Container
+{
+    friend class Container;
+
+public:
+
+    /**
+     * Provides the items of a virtual list.
+     *
+     * @script{ignore}
+     */
+    class DataSource
+    {
+    public:
+
+        /**
+         * Destructor.
+         */
+        virtual ~DataSource() { }
+
+        /**
+         * Returns the number of items in the list.
+         *
+         * @return The number of items.
+         */
+        virtual unsigned int getItemCount() = 0;
+
+        /**
+         * Creates a control to display items with.
+         *
+         * The list takes ownership of the control and reuses it for different items.
+         *
+         * @param list The list the control is created for.
+         *
+         * @return The new control.
+         */
+        virtual Control* createItem(VirtualList* list) = 0;
+
+        /**
+         * Sets up a control created by createItem() to display an item.
+         *
+         * The list positions the control; this method should only change its contents.
+         *
+         * @param item The control.
+         * @param index The index of the item to display.
+         */
+        virtual void bindItem(Control* item, unsigned int index) = 0;
+    };
+
+    /**
+     * Creates a new virtual list.
+     *
+     * @param id The list's ID.
+     * @param style The list's style.
+     * @param itemHeight The height of every item in the list.
+     *
+     * @return The new virtual list.
+     * @script{create}
+     */
+    static VirtualList* create(const char* id, Theme::Style* style, float itemHeight);
+
+    /**
+     * Sets the data source that provides the items of the list.
+     *
+     * The controls created by the previous data source are removed from the list.
+     * The data source is not owned by the list and must remain valid while it is set.
+     *
+     * @param dataSource The data source, or NULL to empty the list.
+     * @script{ignore}
+     */
+    void setDataSource(DataSource* dataSource);
+
+    /**
+     * Returns the data source that provides the items of the list.
+     *
+     * @return The data source.
+     * @script{ignore}
+     */
+    DataSource* getDataSource() const;
+
+    /**
+     * Sets the height of every item in the list.
+     *
+     * @param height The item height.
+     */
+    void setItemHeight(float height);
+
+    /**
+     * Returns the height of every item in the list.
+     *
+     * @return The item height.
+     */
+    float getItemHeight() const;
+
+    /**
+     * Binds all visible items again, after the items of the data source have changed.
+     */
+    void reloadItems();
+
+    /**
+     * Returns the index of the item a control of the list currently displays.
+     *
+     * @param item A control created by the data source.
+     *
+     * @return The index of the item, or -1 if the control does not display an item.
+     */
+    int getItemIndex(Control* item) const;
+
+    /**
+     * Returns the number of item controls the list has created.
+     *
+     * @return The number of item controls.
+     */
+    unsigned int getItemControlCount() const;
+
+    /**
+     * @see Control::getType
+     */
+    const char* getType() const;
+
+protected:
+
+    /**
+     * Constructor.
+     */
+    VirtualList();
+
+    /**
+     * Destructor.
+     */
+    ~VirtualList();
+
+    /**
+     * Create a virtual list with a given style and properties.
+     *
+     * @param style The style to apply to this list.
+     * @param properties The properties to set on this list.
+     * @param theme The theme of the form.
+     *
+     * @return The new virtual list.
+     */
+    static VirtualList* create(Theme::Style* style, Properties* properties, Theme* theme);
+
+    /**
+     * Binds the item controls to the items that are visible at the offset, then lays them out.
+     *
+     * @see Container::updateLayout
+     */
+    void updateLayout(const Vector2& offset);
+
+    /**
+     * @see Container::measureContents
+     */
+    void measureContents(float* width, float* height);
+
+private:
+
+    /**
+     * Hidden copy constructor.
+     */
+    VirtualList(const VirtualList& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    VirtualList& operator=(const VirtualList&);
+
+    void bindItems(const Vector2& offset);
+
+    void clearItems();
+
+    DataSource* _dataSource;
+    float _itemHeight;
+    std::vector<Control*> _items;
+    std::vector<int> _itemIndices;
+    bool _reload;
+};
+
+}
+
+#endif
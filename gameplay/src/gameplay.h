@@ -7,10 +7,23 @@
 #include "Touch.h"
 #include "Gesture.h"
 #include "Gamepad.h"
+#include "GLStateCache.h"
+#include "GPUProfiler.h"
+#include "Profiler.h"
+#include "PerformanceReport.h"
+#include "TimerWheel.h"
+#include "RenderStats.h"
 #include "FileSystem.h"
 #include "Bundle.h"
+#include "HotReloader.h"
 #include "MathUtil.h"
 #include "Logger.h"
+#include "JobController.h"
+#include "Mutex.h"
+#include "IOController.h"
+#include "StringId.h"
+#include "MemoryPool.h"
+#include "MemoryStats.h"
 
 // Math
 #include "Rectangle.h"
@@ -26,32 +39,54 @@
 #include "BoundingSphere.h"
 #include "BoundingBox.h"
 #include "Curve.h"
+#include "SpatialHash.h"
 
 // Graphics
 #include "Texture.h"
+#include "TextureAtlas.h"
+#include "TextureStreamer.h"
 #include "Image.h"
 #include "Mesh.h"
 #include "MeshPart.h"
 #include "Effect.h"
+#include "EffectWarmup.h"
 #include "Material.h"
 #include "RenderState.h"
 #include "VertexFormat.h"
 #include "VertexAttributeBinding.h"
 #include "Model.h"
+#include "RenderQueue.h"
+#include "MultiView.h"
+#include "FramePacket.h"
+#include "InstancedModel.h"
+#include "Impostor.h"
 #include "Camera.h"
 #include "Light.h"
+#include "LightGrid.h"
 #include "Scene.h"
+#include "OcclusionBuffer.h"
+#include "OcclusionCuller.h"
 #include "Node.h"
 #include "Joint.h"
+#include "Skeleton.h"
 #include "Font.h"
 #include "SpriteBatch.h"
+#include "TileMap.h"
+#include "StaticBatch.h"
 #include "ParticleEmitter.h"
+#include "OffscreenParticles.h"
 #include "FrameBuffer.h"
+#include "RenderTargetPool.h"
+#include "FrameGraph.h"
+#include "DynamicResolution.h"
+#include "FramePacer.h"
 #include "RenderTarget.h"
 #include "DepthStencilTarget.h"
+#include "ShadowMap.h"
 #include "ScreenDisplayer.h"
 #include "HeightField.h"
 #include "Terrain.h"
+#include "TiledTerrain.h"
 
 // Audio
 #include "AudioController.h"
@@ -65,6 +100,7 @@
 #include "AnimationValue.h"
 #include "Animation.h"
 #include "AnimationClip.h"
+#include "BakedAnimation.h"
 
 // Physics
 #include "PhysicsController.h"
@@ -87,6 +123,7 @@
 #include "AIAgent.h"
 #include "AIState.h"
 #include "AIStateMachine.h"
+#include "NavigationMesh.h"
 
 // UI
 #include "Theme.h"
@@ -100,6 +137,7 @@
 #include "RadioButton.h"
 #include "Slider.h"
 #include "ImageControl.h"
+#include "VirtualList.h"
 #include "Joystick.h"
 #include "Layout.h"
 #include "AbsoluteLayout.h"
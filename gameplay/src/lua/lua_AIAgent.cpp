@@ -207,11 +207,7 @@ int lua_AIAgent_getNode(lua_State* state)
                 void* returnPtr = (void*)instance->getNode();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Node");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Node", false);
                 }
                 else
                 {
@@ -286,11 +282,7 @@ int lua_AIAgent_getStateMachine(lua_State* state)
                 void* returnPtr = (void*)instance->getStateMachine();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "AIStateMachine");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "AIStateMachine", false);
                 }
                 else
                 {
@@ -512,11 +504,7 @@ int lua_AIAgent_static_create(lua_State* state)
             void* returnPtr = (void*)AIAgent::create();
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = true;
-                luaL_getmetatable(state, "AIAgent");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "AIAgent", true);
             }
             else
             {
@@ -49,11 +49,7 @@ int lua_AIController_findAgent(lua_State* state)
                 void* returnPtr = (void*)instance->findAgent(param1);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "AIAgent");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "AIAgent", false);
                 }
                 else
                 {
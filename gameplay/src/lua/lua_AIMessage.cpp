@@ -732,11 +732,7 @@ int lua_AIMessage_static_create(lua_State* state)
                 void* returnPtr = (void*)AIMessage::create(param1, param2, param3, param4);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "AIMessage");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "AIMessage", false);
                 }
                 else
                 {
@@ -354,11 +354,7 @@ int lua_AIState_static_create(lua_State* state)
                 void* returnPtr = (void*)AIState::create(param1);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = true;
-                    luaL_getmetatable(state, "AIState");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "AIState", true);
                 }
                 else
                 {
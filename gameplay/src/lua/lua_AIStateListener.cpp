@@ -86,11 +86,7 @@ int lua_AIStateListener__init(lua_State* state)
             void* returnPtr = (void*)new AIState::Listener();
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = true;
-                luaL_getmetatable(state, "AIStateListener");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "AIStateListener", true);
             }
             else
             {
@@ -57,11 +57,7 @@ int lua_AIStateMachine_addState(lua_State* state)
                     void* returnPtr = (void*)instance->addState(param1);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "AIState");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "AIState", false);
                     }
                     else
                     {
@@ -120,11 +116,7 @@ int lua_AIStateMachine_getActiveState(lua_State* state)
                 void* returnPtr = (void*)instance->getActiveState();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "AIState");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "AIState", false);
                 }
                 else
                 {
@@ -164,11 +156,7 @@ int lua_AIStateMachine_getAgent(lua_State* state)
                 void* returnPtr = (void*)instance->getAgent();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "AIAgent");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "AIAgent", false);
                 }
                 else
                 {
@@ -212,11 +200,7 @@ int lua_AIStateMachine_getState(lua_State* state)
                 void* returnPtr = (void*)instance->getState(param1);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "AIState");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "AIState", false);
                 }
                 else
                 {
@@ -304,11 +288,7 @@ int lua_AIStateMachine_setState(lua_State* state)
                     void* returnPtr = (void*)instance->setState(param1);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "AIState");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "AIState", false);
                     }
                     else
                     {
@@ -144,11 +144,7 @@ int lua_Animation_createClip(lua_State* state)
                 void* returnPtr = (void*)instance->createClip(param1, param2, param3);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = true;
-                    luaL_getmetatable(state, "AnimationClip");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "AnimationClip", true);
                 }
                 else
                 {
@@ -226,11 +222,7 @@ int lua_Animation_getClip(lua_State* state)
                     void* returnPtr = (void*)instance->getClip();
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "AnimationClip");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "AnimationClip", false);
                     }
                     else
                     {
@@ -259,11 +251,7 @@ int lua_Animation_getClip(lua_State* state)
                     void* returnPtr = (void*)instance->getClip(param1);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "AnimationClip");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "AnimationClip", false);
                     }
                     else
                     {
@@ -286,11 +274,7 @@ int lua_Animation_getClip(lua_State* state)
                     void* returnPtr = (void*)instance->getClip(param1);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "AnimationClip");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "AnimationClip", false);
                     }
                     else
                     {
@@ -64,11 +64,7 @@ int lua_AnimationTarget_createAnimation(lua_State* state)
                     void* returnPtr = (void*)instance->createAnimation(param1, param2);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "Animation");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Animation", false);
                     }
                     else
                     {
@@ -98,11 +94,7 @@ int lua_AnimationTarget_createAnimation(lua_State* state)
                     void* returnPtr = (void*)instance->createAnimation(param1, param2);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "Animation");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Animation", false);
                     }
                     else
                     {
@@ -151,11 +143,7 @@ int lua_AnimationTarget_createAnimation(lua_State* state)
                     void* returnPtr = (void*)instance->createAnimation(param1, param2, param3, param4, param5, param6);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "Animation");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Animation", false);
                     }
                     else
                     {
@@ -212,11 +200,7 @@ int lua_AnimationTarget_createAnimation(lua_State* state)
                     void* returnPtr = (void*)instance->createAnimation(param1, param2, param3, param4, param5, param6, param7, param8);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "Animation");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Animation", false);
                     }
                     else
                     {
@@ -281,11 +265,7 @@ int lua_AnimationTarget_createAnimationFromBy(lua_State* state)
                 void* returnPtr = (void*)instance->createAnimationFromBy(param1, param2, param3, param4, param5, param6);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Animation");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Animation", false);
                 }
                 else
                 {
@@ -349,11 +329,7 @@ int lua_AnimationTarget_createAnimationFromTo(lua_State* state)
                 void* returnPtr = (void*)instance->createAnimationFromTo(param1, param2, param3, param4, param5, param6);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Animation");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Animation", false);
                 }
                 else
                 {
@@ -443,11 +419,7 @@ int lua_AnimationTarget_getAnimation(lua_State* state)
                 void* returnPtr = (void*)instance->getAnimation();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Animation");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Animation", false);
                 }
                 else
                 {
@@ -473,11 +445,7 @@ int lua_AnimationTarget_getAnimation(lua_State* state)
                 void* returnPtr = (void*)instance->getAnimation(param1);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Animation");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Animation", false);
                 }
                 else
                 {
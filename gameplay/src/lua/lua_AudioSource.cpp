@@ -181,11 +181,7 @@ int lua_AudioSource_getNode(lua_State* state)
                 void* returnPtr = (void*)instance->getNode();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Node");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Node", false);
                 }
                 else
                 {
@@ -330,11 +326,7 @@ int lua_AudioSource_getVelocity(lua_State* state)
                 void* returnPtr = (void*)&(instance->getVelocity());
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Vector3");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Vector3", false);
                 }
                 else
                 {
@@ -752,11 +744,7 @@ int lua_AudioSource_static_create(lua_State* state)
                     void* returnPtr = (void*)AudioSource::create(param1);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "AudioSource");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "AudioSource", true);
                     }
                     else
                     {
@@ -780,11 +768,7 @@ int lua_AudioSource_static_create(lua_State* state)
                     void* returnPtr = (void*)AudioSource::create(param1);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "AudioSource");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "AudioSource", true);
                     }
                     else
                     {
@@ -92,11 +92,7 @@ int lua_BoundingBox__init(lua_State* state)
             void* returnPtr = (void*)new BoundingBox();
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = true;
-                luaL_getmetatable(state, "BoundingBox");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "BoundingBox", true);
             }
             else
             {
@@ -121,11 +117,7 @@ int lua_BoundingBox__init(lua_State* state)
                     void* returnPtr = (void*)new BoundingBox(*param1);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "BoundingBox");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "BoundingBox", true);
                     }
                     else
                     {
@@ -162,11 +154,7 @@ int lua_BoundingBox__init(lua_State* state)
                     void* returnPtr = (void*)new BoundingBox(*param1, *param2);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "BoundingBox");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "BoundingBox", true);
                     }
                     else
                     {
@@ -213,11 +201,7 @@ int lua_BoundingBox__init(lua_State* state)
                     void* returnPtr = (void*)new BoundingBox(param1, param2, param3, param4, param5, param6);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "BoundingBox");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "BoundingBox", true);
                     }
                     else
                     {
@@ -257,19 +241,8 @@ int lua_BoundingBox_getCenter(lua_State* state)
                 if ((lua_type(state, 1) == LUA_TUSERDATA))
                 {
                     BoundingBox* instance = getInstance(state);
-                    void* returnPtr = (void*)new Vector3(instance->getCenter());
-                    if (returnPtr)
-                    {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Vector3");
-                        lua_setmetatable(state, -2);
-                    }
-                    else
-                    {
-                        lua_pushnil(state);
-                    }
+                    Vector3 returnValue = instance->getCenter();
+                    gameplay::ScriptUtil::pushValue(state, returnValue, "Vector3");
 
                     return 1;
                 }
@@ -545,19 +518,8 @@ int lua_BoundingBox_max(lua_State* state)
     }
     else
     {
-        void* returnPtr = (void*)new Vector3(instance->max);
-        if (returnPtr)
-        {
-            gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-            object->instance = returnPtr;
-            object->owns = true;
-            luaL_getmetatable(state, "Vector3");
-            lua_setmetatable(state, -2);
-        }
-        else
-        {
-            lua_pushnil(state);
-        }
+        Vector3 returnValue = instance->max;
+        gameplay::ScriptUtil::pushValue(state, returnValue, "Vector3");
 
         return 1;
     }
@@ -649,19 +611,8 @@ int lua_BoundingBox_min(lua_State* state)
     }
     else
     {
-        void* returnPtr = (void*)new Vector3(instance->min);
-        if (returnPtr)
-        {
-            gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-            object->instance = returnPtr;
-            object->owns = true;
-            luaL_getmetatable(state, "Vector3");
-            lua_setmetatable(state, -2);
-        }
-        else
-        {
-            lua_pushnil(state);
-        }
+        Vector3 returnValue = instance->min;
+        gameplay::ScriptUtil::pushValue(state, returnValue, "Vector3");
 
         return 1;
     }
@@ -812,11 +763,7 @@ int lua_BoundingBox_static_empty(lua_State* state)
             void* returnPtr = (void*)&(BoundingBox::empty());
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = false;
-                luaL_getmetatable(state, "BoundingBox");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "BoundingBox", false);
             }
             else
             {
@@ -89,11 +89,7 @@ int lua_BoundingSphere__init(lua_State* state)
             void* returnPtr = (void*)new BoundingSphere();
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = true;
-                luaL_getmetatable(state, "BoundingSphere");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "BoundingSphere", true);
             }
             else
             {
@@ -118,11 +114,7 @@ int lua_BoundingSphere__init(lua_State* state)
                     void* returnPtr = (void*)new BoundingSphere(*param1);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "BoundingSphere");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "BoundingSphere", true);
                     }
                     else
                     {
@@ -156,11 +148,7 @@ int lua_BoundingSphere__init(lua_State* state)
                     void* returnPtr = (void*)new BoundingSphere(*param1, param2);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "BoundingSphere");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "BoundingSphere", true);
                     }
                     else
                     {
@@ -211,19 +199,8 @@ int lua_BoundingSphere_center(lua_State* state)
     }
     else
     {
-        void* returnPtr = (void*)new Vector3(instance->center);
-        if (returnPtr)
-        {
-            gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-            object->instance = returnPtr;
-            object->owns = true;
-            luaL_getmetatable(state, "Vector3");
-            lua_setmetatable(state, -2);
-        }
-        else
-        {
-            lua_pushnil(state);
-        }
+        Vector3 returnValue = instance->center;
+        gameplay::ScriptUtil::pushValue(state, returnValue, "Vector3");
 
         return 1;
     }
@@ -583,11 +560,7 @@ int lua_BoundingSphere_static_empty(lua_State* state)
             void* returnPtr = (void*)&(BoundingSphere::empty());
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = false;
-                luaL_getmetatable(state, "BoundingSphere");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "BoundingSphere", false);
             }
             else
             {
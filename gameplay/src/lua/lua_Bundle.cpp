@@ -26,6 +26,7 @@ void luaRegister_Bundle()
         {"loadMesh", lua_Bundle_loadMesh},
         {"loadNode", lua_Bundle_loadNode},
         {"loadScene", lua_Bundle_loadScene},
+        {"loadSceneAsync", lua_Bundle_loadSceneAsync},
         {"release", lua_Bundle_release},
         {NULL, NULL}
     };
@@ -284,11 +285,7 @@ int lua_Bundle_loadFont(lua_State* state)
                 void* returnPtr = (void*)instance->loadFont(param1);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = true;
-                    luaL_getmetatable(state, "Font");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Font", true);
                 }
                 else
                 {
@@ -332,11 +329,7 @@ int lua_Bundle_loadMesh(lua_State* state)
                 void* returnPtr = (void*)instance->loadMesh(param1);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = true;
-                    luaL_getmetatable(state, "Mesh");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Mesh", true);
                 }
                 else
                 {
@@ -380,11 +373,7 @@ int lua_Bundle_loadNode(lua_State* state)
                 void* returnPtr = (void*)instance->loadNode(param1);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = true;
-                    luaL_getmetatable(state, "Node");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Node", true);
                 }
                 else
                 {
@@ -424,11 +413,7 @@ int lua_Bundle_loadScene(lua_State* state)
                 void* returnPtr = (void*)instance->loadScene();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = true;
-                    luaL_getmetatable(state, "Scene");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Scene", true);
                 }
                 else
                 {
@@ -454,11 +439,7 @@ int lua_Bundle_loadScene(lua_State* state)
                 void* returnPtr = (void*)instance->loadScene(param1);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = true;
-                    luaL_getmetatable(state, "Scene");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Scene", true);
                 }
                 else
                 {
@@ -482,6 +463,72 @@ int lua_Bundle_loadScene(lua_State* state)
     return 0;
 }
 
+int lua_Bundle_loadSceneAsync(lua_State* state)
+{
+    // Get the number of parameters.
+    int paramCount = lua_gettop(state);
+
+    // Attempt to match the parameters to a valid binding.
+    switch (paramCount)
+    {
+        case 1:
+        {
+            if ((lua_type(state, 1) == LUA_TUSERDATA))
+            {
+                Bundle* instance = getInstance(state);
+                void* returnPtr = (void*)instance->loadSceneAsync();
+                if (returnPtr)
+                {
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "BundleAsyncLoad", true);
+                }
+                else
+                {
+                    lua_pushnil(state);
+                }
+
+                return 1;
+            }
+
+            lua_pushstring(state, "lua_Bundle_loadSceneAsync - Failed to match the given parameters to a valid function signature.");
+            lua_error(state);
+            break;
+        }
+        case 2:
+        {
+            if ((lua_type(state, 1) == LUA_TUSERDATA) &&
+                (lua_type(state, 2) == LUA_TSTRING || lua_type(state, 2) == LUA_TNIL))
+            {
+                // Get parameter 1 off the stack.
+                const char* param1 = gameplay::ScriptUtil::getString(2, false);
+
+                Bundle* instance = getInstance(state);
+                void* returnPtr = (void*)instance->loadSceneAsync(param1);
+                if (returnPtr)
+                {
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "BundleAsyncLoad", true);
+                }
+                else
+                {
+                    lua_pushnil(state);
+                }
+
+                return 1;
+            }
+
+            lua_pushstring(state, "lua_Bundle_loadSceneAsync - Failed to match the given parameters to a valid function signature.");
+            lua_error(state);
+            break;
+        }
+        default:
+        {
+            lua_pushstring(state, "Invalid number of parameters (expected 1 or 2).");
+            lua_error(state);
+            break;
+        }
+    }
+    return 0;
+}
+
 int lua_Bundle_release(lua_State* state)
 {
     // Get the number of parameters.
@@ -532,11 +579,7 @@ int lua_Bundle_static_create(lua_State* state)
                 void* returnPtr = (void*)Bundle::create(param1);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = true;
-                    luaL_getmetatable(state, "Bundle");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Bundle", true);
                 }
                 else
                 {
@@ -15,6 +15,7 @@ int lua_Bundle_loadFont(lua_State* state);
 int lua_Bundle_loadMesh(lua_State* state);
 int lua_Bundle_loadNode(lua_State* state);
 int lua_Bundle_loadScene(lua_State* state);
+int lua_Bundle_loadSceneAsync(lua_State* state);
 int lua_Bundle_release(lua_State* state);
 int lua_Bundle_static_create(lua_State* state);
 
@@ -0,0 +1,21 @@
+#ifndef LUA_BUNDLEASYNCLOAD_H_
+#define LUA_BUNDLEASYNCLOAD_H_
+
+namespace gameplay
+{
+
+// Lua bindings for Bundle::AsyncLoad.
+int lua_BundleAsyncLoad___gc(lua_State* state);
+int lua_BundleAsyncLoad_addRef(lua_State* state);
+int lua_BundleAsyncLoad_cancel(lua_State* state);
+int lua_BundleAsyncLoad_getProgress(lua_State* state);
+int lua_BundleAsyncLoad_getRefCount(lua_State* state);
+int lua_BundleAsyncLoad_getScene(lua_State* state);
+int lua_BundleAsyncLoad_isComplete(lua_State* state);
+int lua_BundleAsyncLoad_release(lua_State* state);
+
+void luaRegister_BundleAsyncLoad();
+
+}
+
+#endif
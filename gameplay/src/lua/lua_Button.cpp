@@ -60,6 +60,7 @@ void luaRegister_Button()
         {"getOpacity", lua_Button_getOpacity},
         {"getPadding", lua_Button_getPadding},
         {"getRefCount", lua_Button_getRefCount},
+        {"getScriptEventFilter", lua_Button_getScriptEventFilter},
         {"getSkinColor", lua_Button_getSkinColor},
         {"getSkinRegion", lua_Button_getSkinRegion},
         {"getState", lua_Button_getState},
@@ -98,6 +99,7 @@ void luaRegister_Button()
         {"setOpacity", lua_Button_setOpacity},
         {"setPadding", lua_Button_setPadding},
         {"setPosition", lua_Button_setPosition},
+        {"setScriptEventFilter", lua_Button_setScriptEventFilter},
         {"setSize", lua_Button_setSize},
         {"setSkinColor", lua_Button_setSkinColor},
         {"setSkinRegion", lua_Button_setSkinRegion},
@@ -318,11 +320,7 @@ int lua_Button_createAnimation(lua_State* state)
                     void* returnPtr = (void*)instance->createAnimation(param1, param2);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "Animation");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Animation", false);
                     }
                     else
                     {
@@ -352,11 +350,7 @@ int lua_Button_createAnimation(lua_State* state)
                     void* returnPtr = (void*)instance->createAnimation(param1, param2);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "Animation");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Animation", false);
                     }
                     else
                     {
@@ -405,11 +399,7 @@ int lua_Button_createAnimation(lua_State* state)
                     void* returnPtr = (void*)instance->createAnimation(param1, param2, param3, param4, param5, param6);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "Animation");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Animation", false);
                     }
                     else
                     {
@@ -466,11 +456,7 @@ int lua_Button_createAnimation(lua_State* state)
                     void* returnPtr = (void*)instance->createAnimation(param1, param2, param3, param4, param5, param6, param7, param8);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "Animation");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Animation", false);
                     }
                     else
                     {
@@ -535,11 +521,7 @@ int lua_Button_createAnimationFromBy(lua_State* state)
                 void* returnPtr = (void*)instance->createAnimationFromBy(param1, param2, param3, param4, param5, param6);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Animation");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Animation", false);
                 }
                 else
                 {
@@ -603,11 +585,7 @@ int lua_Button_createAnimationFromTo(lua_State* state)
                 void* returnPtr = (void*)instance->createAnimationFromTo(param1, param2, param3, param4, param5, param6);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Animation");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Animation", false);
                 }
                 else
                 {
@@ -697,11 +675,7 @@ int lua_Button_getAbsoluteBounds(lua_State* state)
                 void* returnPtr = (void*)&(instance->getAbsoluteBounds());
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Rectangle");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Rectangle", false);
                 }
                 else
                 {
@@ -776,11 +750,7 @@ int lua_Button_getAnimation(lua_State* state)
                 void* returnPtr = (void*)instance->getAnimation();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Animation");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Animation", false);
                 }
                 else
                 {
@@ -806,11 +776,7 @@ int lua_Button_getAnimation(lua_State* state)
                 void* returnPtr = (void*)instance->getAnimation(param1);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Animation");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Animation", false);
                 }
                 else
                 {
@@ -1005,11 +971,7 @@ int lua_Button_getBorder(lua_State* state)
                 void* returnPtr = (void*)&(instance->getBorder());
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "ThemeSideRegions");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "ThemeSideRegions", false);
                 }
                 else
                 {
@@ -1035,11 +997,7 @@ int lua_Button_getBorder(lua_State* state)
                 void* returnPtr = (void*)&(instance->getBorder(param1));
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "ThemeSideRegions");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "ThemeSideRegions", false);
                 }
                 else
                 {
@@ -1079,11 +1037,7 @@ int lua_Button_getBounds(lua_State* state)
                 void* returnPtr = (void*)&(instance->getBounds());
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Rectangle");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Rectangle", false);
                 }
                 else
                 {
@@ -1123,11 +1077,7 @@ int lua_Button_getClip(lua_State* state)
                 void* returnPtr = (void*)&(instance->getClip());
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Rectangle");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Rectangle", false);
                 }
                 else
                 {
@@ -1167,11 +1117,7 @@ int lua_Button_getClipBounds(lua_State* state)
                 void* returnPtr = (void*)&(instance->getClipBounds());
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Rectangle");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Rectangle", false);
                 }
                 else
                 {
@@ -1250,11 +1196,7 @@ int lua_Button_getCursorColor(lua_State* state)
                 void* returnPtr = (void*)&(instance->getCursorColor(param1));
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Vector4");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Vector4", false);
                 }
                 else
                 {
@@ -1298,11 +1240,7 @@ int lua_Button_getCursorRegion(lua_State* state)
                 void* returnPtr = (void*)&(instance->getCursorRegion(param1));
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Rectangle");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Rectangle", false);
                 }
                 else
                 {
@@ -1346,11 +1284,7 @@ int lua_Button_getCursorUVs(lua_State* state)
                 void* returnPtr = (void*)&(instance->getCursorUVs(param1));
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "ThemeUVs");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "ThemeUVs", false);
                 }
                 else
                 {
@@ -1425,11 +1359,7 @@ int lua_Button_getFont(lua_State* state)
                 void* returnPtr = (void*)instance->getFont();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Font");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Font", false);
                 }
                 else
                 {
@@ -1455,11 +1385,7 @@ int lua_Button_getFont(lua_State* state)
                 void* returnPtr = (void*)instance->getFont(param1);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Font");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Font", false);
                 }
                 else
                 {
@@ -1633,11 +1559,7 @@ int lua_Button_getImageColor(lua_State* state)
                 void* returnPtr = (void*)&(instance->getImageColor(param1, param2));
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Vector4");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Vector4", false);
                 }
                 else
                 {
@@ -1685,11 +1607,7 @@ int lua_Button_getImageRegion(lua_State* state)
                 void* returnPtr = (void*)&(instance->getImageRegion(param1, param2));
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Rectangle");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Rectangle", false);
                 }
                 else
                 {
@@ -1737,11 +1655,7 @@ int lua_Button_getImageUVs(lua_State* state)
                 void* returnPtr = (void*)&(instance->getImageUVs(param1, param2));
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "ThemeUVs");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "ThemeUVs", false);
                 }
                 else
                 {
@@ -1781,11 +1695,7 @@ int lua_Button_getMargin(lua_State* state)
                 void* returnPtr = (void*)&(instance->getMargin());
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "ThemeSideRegions");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "ThemeSideRegions", false);
                 }
                 else
                 {
@@ -1881,11 +1791,7 @@ int lua_Button_getPadding(lua_State* state)
                 void* returnPtr = (void*)&(instance->getPadding());
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "ThemeSideRegions");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "ThemeSideRegions", false);
                 }
                 else
                 {
@@ -1944,6 +1850,41 @@ int lua_Button_getRefCount(lua_State* state)
     return 0;
 }
 
+int lua_Button_getScriptEventFilter(lua_State* state)
+{
+    // Get the number of parameters.
+    int paramCount = lua_gettop(state);
+
+    // Attempt to match the parameters to a valid binding.
+    switch (paramCount)
+    {
+        case 1:
+        {
+            if ((lua_type(state, 1) == LUA_TUSERDATA))
+            {
+                Button* instance = getInstance(state);
+                int result = instance->getScriptEventFilter();
+
+                // Push the return value onto the stack.
+                lua_pushinteger(state, result);
+
+                return 1;
+            }
+
+            lua_pushstring(state, "lua_Button_getScriptEventFilter - Failed to match the given parameters to a valid function signature.");
+            lua_error(state);
+            break;
+        }
+        default:
+        {
+            lua_pushstring(state, "Invalid number of parameters (expected 1).");
+            lua_error(state);
+            break;
+        }
+    }
+    return 0;
+}
+
 int lua_Button_getSkinColor(lua_State* state)
 {
     // Get the number of parameters.
@@ -1960,11 +1901,7 @@ int lua_Button_getSkinColor(lua_State* state)
                 void* returnPtr = (void*)&(instance->getSkinColor());
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Vector4");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Vector4", false);
                 }
                 else
                 {
@@ -1990,11 +1927,7 @@ int lua_Button_getSkinColor(lua_State* state)
                 void* returnPtr = (void*)&(instance->getSkinColor(param1));
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Vector4");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Vector4", false);
                 }
                 else
                 {
@@ -2034,11 +1967,7 @@ int lua_Button_getSkinRegion(lua_State* state)
                 void* returnPtr = (void*)&(instance->getSkinRegion());
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Rectangle");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Rectangle", false);
                 }
                 else
                 {
@@ -2064,11 +1993,7 @@ int lua_Button_getSkinRegion(lua_State* state)
                 void* returnPtr = (void*)&(instance->getSkinRegion(param1));
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Rectangle");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Rectangle", false);
                 }
                 else
                 {
@@ -2143,11 +2068,7 @@ int lua_Button_getStyle(lua_State* state)
                 void* returnPtr = (void*)instance->getStyle();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "ThemeStyle");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "ThemeStyle", false);
                 }
                 else
                 {
@@ -2278,11 +2199,7 @@ int lua_Button_getTextColor(lua_State* state)
                 void* returnPtr = (void*)&(instance->getTextColor());
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Vector4");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Vector4", false);
                 }
                 else
                 {
@@ -2308,11 +2225,7 @@ int lua_Button_getTextColor(lua_State* state)
                 void* returnPtr = (void*)&(instance->getTextColor(param1));
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Vector4");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Vector4", false);
                 }
                 else
                 {
@@ -3775,6 +3688,42 @@ int lua_Button_setPosition(lua_State* state)
     return 0;
 }
 
+int lua_Button_setScriptEventFilter(lua_State* state)
+{
+    // Get the number of parameters.
+    int paramCount = lua_gettop(state);
+
+    // Attempt to match the parameters to a valid binding.
+    switch (paramCount)
+    {
+        case 2:
+        {
+            if ((lua_type(state, 1) == LUA_TUSERDATA) &&
+                lua_type(state, 2) == LUA_TNUMBER)
+            {
+                // Get parameter 1 off the stack.
+                int param1 = (int)luaL_checkint(state, 2);
+
+                Button* instance = getInstance(state);
+                instance->setScriptEventFilter(param1);
+                
+                return 0;
+            }
+
+            lua_pushstring(state, "lua_Button_setScriptEventFilter - Failed to match the given parameters to a valid function signature.");
+            lua_error(state);
+            break;
+        }
+        default:
+        {
+            lua_pushstring(state, "Invalid number of parameters (expected 2).");
+            lua_error(state);
+            break;
+        }
+    }
+    return 0;
+}
+
 int lua_Button_setSize(lua_State* state)
 {
     // Get the number of parameters.
@@ -4510,11 +4459,7 @@ int lua_Button_static_create(lua_State* state)
                 void* returnPtr = (void*)Button::create(param1, param2);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = true;
-                    luaL_getmetatable(state, "Button");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Button", true);
                 }
                 else
                 {
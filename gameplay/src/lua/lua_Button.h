@@ -40,6 +40,7 @@ int lua_Button_getMargin(lua_State* state);
 int lua_Button_getOpacity(lua_State* state);
 int lua_Button_getPadding(lua_State* state);
 int lua_Button_getRefCount(lua_State* state);
+int lua_Button_getScriptEventFilter(lua_State* state);
 int lua_Button_getSkinColor(lua_State* state);
 int lua_Button_getSkinRegion(lua_State* state);
 int lua_Button_getState(lua_State* state);
@@ -78,6 +79,7 @@ int lua_Button_setMargin(lua_State* state);
 int lua_Button_setOpacity(lua_State* state);
 int lua_Button_setPadding(lua_State* state);
 int lua_Button_setPosition(lua_State* state);
+int lua_Button_setScriptEventFilter(lua_State* state);
 int lua_Button_setSize(lua_State* state);
 int lua_Button_setSkinColor(lua_State* state);
 int lua_Button_setSkinRegion(lua_State* state);
@@ -41,6 +41,7 @@ int lua_CheckBox_getMargin(lua_State* state);
 int lua_CheckBox_getOpacity(lua_State* state);
 int lua_CheckBox_getPadding(lua_State* state);
 int lua_CheckBox_getRefCount(lua_State* state);
+int lua_CheckBox_getScriptEventFilter(lua_State* state);
 int lua_CheckBox_getSkinColor(lua_State* state);
 int lua_CheckBox_getSkinRegion(lua_State* state);
 int lua_CheckBox_getState(lua_State* state);
@@ -83,6 +84,7 @@ int lua_CheckBox_setMargin(lua_State* state);
 int lua_CheckBox_setOpacity(lua_State* state);
 int lua_CheckBox_setPadding(lua_State* state);
 int lua_CheckBox_setPosition(lua_State* state);
+int lua_CheckBox_setScriptEventFilter(lua_State* state);
 int lua_CheckBox_setSize(lua_State* state);
 int lua_CheckBox_setSkinColor(lua_State* state);
 int lua_CheckBox_setSkinRegion(lua_State* state);
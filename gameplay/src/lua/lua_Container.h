@@ -43,6 +43,7 @@ int lua_Container_getMargin(lua_State* state);
 int lua_Container_getOpacity(lua_State* state);
 int lua_Container_getPadding(lua_State* state);
 int lua_Container_getRefCount(lua_State* state);
+int lua_Container_getScriptEventFilter(lua_State* state);
 int lua_Container_getScroll(lua_State* state);
 int lua_Container_getScrollWheelRequiresFocus(lua_State* state);
 int lua_Container_getScrollWheelSpeed(lua_State* state);
@@ -89,6 +90,7 @@ int lua_Container_setMargin(lua_State* state);
 int lua_Container_setOpacity(lua_State* state);
 int lua_Container_setPadding(lua_State* state);
 int lua_Container_setPosition(lua_State* state);
+int lua_Container_setScriptEventFilter(lua_State* state);
 int lua_Container_setScroll(lua_State* state);
 int lua_Container_setScrollBarsAutoHide(lua_State* state);
 int lua_Container_setScrollWheelRequiresFocus(lua_State* state);
@@ -40,6 +40,7 @@ int lua_Control_getMargin(lua_State* state);
 int lua_Control_getOpacity(lua_State* state);
 int lua_Control_getPadding(lua_State* state);
 int lua_Control_getRefCount(lua_State* state);
+int lua_Control_getScriptEventFilter(lua_State* state);
 int lua_Control_getSkinColor(lua_State* state);
 int lua_Control_getSkinRegion(lua_State* state);
 int lua_Control_getState(lua_State* state);
@@ -78,6 +79,7 @@ int lua_Control_setMargin(lua_State* state);
 int lua_Control_setOpacity(lua_State* state);
 int lua_Control_setPadding(lua_State* state);
 int lua_Control_setPosition(lua_State* state);
+int lua_Control_setScriptEventFilter(lua_State* state);
 int lua_Control_setSize(lua_State* state);
 int lua_Control_setSkinColor(lua_State* state);
 int lua_Control_setSkinRegion(lua_State* state);
@@ -384,11 +384,7 @@ int lua_DepthStencilTarget_static_create(lua_State* state)
                 void* returnPtr = (void*)DepthStencilTarget::create(param1, param2, param3, param4);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = true;
-                    luaL_getmetatable(state, "DepthStencilTarget");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "DepthStencilTarget", true);
                 }
                 else
                 {
@@ -430,11 +426,7 @@ int lua_DepthStencilTarget_static_getDepthStencilTarget(lua_State* state)
                 void* returnPtr = (void*)DepthStencilTarget::getDepthStencilTarget(param1);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "DepthStencilTarget");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "DepthStencilTarget", false);
                 }
                 else
                 {
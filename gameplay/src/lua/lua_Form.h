@@ -44,6 +44,7 @@ int lua_Form_getMargin(lua_State* state);
 int lua_Form_getOpacity(lua_State* state);
 int lua_Form_getPadding(lua_State* state);
 int lua_Form_getRefCount(lua_State* state);
+int lua_Form_getScriptEventFilter(lua_State* state);
 int lua_Form_getScroll(lua_State* state);
 int lua_Form_getScrollWheelRequiresFocus(lua_State* state);
 int lua_Form_getScrollWheelSpeed(lua_State* state);
@@ -92,6 +93,7 @@ int lua_Form_setNode(lua_State* state);
 int lua_Form_setOpacity(lua_State* state);
 int lua_Form_setPadding(lua_State* state);
 int lua_Form_setPosition(lua_State* state);
+int lua_Form_setScriptEventFilter(lua_State* state);
 int lua_Form_setScroll(lua_State* state);
 int lua_Form_setScrollBarsAutoHide(lua_State* state);
 int lua_Form_setScrollWheelRequiresFocus(lua_State* state);
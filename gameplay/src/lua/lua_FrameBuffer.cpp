@@ -135,11 +135,7 @@ int lua_FrameBuffer_bind(lua_State* state)
                 void* returnPtr = (void*)instance->bind();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "FrameBuffer");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "FrameBuffer", false);
                 }
                 else
                 {
@@ -179,11 +175,7 @@ int lua_FrameBuffer_getDepthStencilTarget(lua_State* state)
                 void* returnPtr = (void*)instance->getDepthStencilTarget();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "DepthStencilTarget");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "DepthStencilTarget", false);
                 }
                 else
                 {
@@ -328,11 +320,7 @@ int lua_FrameBuffer_getRenderTarget(lua_State* state)
                 void* returnPtr = (void*)instance->getRenderTarget();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "RenderTarget");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "RenderTarget", false);
                 }
                 else
                 {
@@ -358,11 +346,7 @@ int lua_FrameBuffer_getRenderTarget(lua_State* state)
                 void* returnPtr = (void*)instance->getRenderTarget(param1);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "RenderTarget");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "RenderTarget", false);
                 }
                 else
                 {
@@ -648,11 +632,7 @@ int lua_FrameBuffer_static_bindDefault(lua_State* state)
             void* returnPtr = (void*)FrameBuffer::bindDefault();
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = false;
-                luaL_getmetatable(state, "FrameBuffer");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "FrameBuffer", false);
             }
             else
             {
@@ -692,11 +672,7 @@ int lua_FrameBuffer_static_create(lua_State* state)
                     void* returnPtr = (void*)FrameBuffer::create(param1);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "FrameBuffer");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "FrameBuffer", true);
                     }
                     else
                     {
@@ -731,11 +707,7 @@ int lua_FrameBuffer_static_create(lua_State* state)
                     void* returnPtr = (void*)FrameBuffer::create(param1, param2, param3);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "FrameBuffer");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "FrameBuffer", true);
                     }
                     else
                     {
@@ -773,11 +745,7 @@ int lua_FrameBuffer_static_getCurrent(lua_State* state)
             void* returnPtr = (void*)FrameBuffer::getCurrent();
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = false;
-                luaL_getmetatable(state, "FrameBuffer");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "FrameBuffer", false);
             }
             else
             {
@@ -815,11 +783,7 @@ int lua_FrameBuffer_static_getFrameBuffer(lua_State* state)
                 void* returnPtr = (void*)FrameBuffer::getFrameBuffer(param1);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "FrameBuffer");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "FrameBuffer", false);
                 }
                 else
                 {
@@ -68,6 +68,7 @@ void luaRegister_Game()
         {"resume", lua_Game_resume},
         {"run", lua_Game_run},
         {"schedule", lua_Game_schedule},
+        {"scheduleRepeating", lua_Game_scheduleRepeating},
         {"setCursorVisible", lua_Game_setCursorVisible},
         {"setMouseCaptured", lua_Game_setMouseCaptured},
         {"setMultiSampling", lua_Game_setMultiSampling},
@@ -75,6 +76,7 @@ void luaRegister_Game()
         {"setViewport", lua_Game_setViewport},
         {"touchEvent", lua_Game_touchEvent},
         {"unregisterGesture", lua_Game_unregisterGesture},
+        {"unschedule", lua_Game_unschedule},
         {NULL, NULL}
     };
     const luaL_Reg lua_statics[] = 
@@ -560,11 +562,7 @@ int lua_Game_getAIController(lua_State* state)
                 void* returnPtr = (void*)instance->getAIController();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "AIController");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "AIController", false);
                 }
                 else
                 {
@@ -644,11 +642,7 @@ int lua_Game_getAnimationController(lua_State* state)
                 void* returnPtr = (void*)instance->getAnimationController();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "AnimationController");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "AnimationController", false);
                 }
                 else
                 {
@@ -723,11 +717,7 @@ int lua_Game_getAudioController(lua_State* state)
                 void* returnPtr = (void*)instance->getAudioController();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "AudioController");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "AudioController", false);
                 }
                 else
                 {
@@ -767,11 +757,7 @@ int lua_Game_getAudioListener(lua_State* state)
                 void* returnPtr = (void*)instance->getAudioListener();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "AudioListener");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "AudioListener", false);
                 }
                 else
                 {
@@ -811,11 +797,7 @@ int lua_Game_getConfig(lua_State* state)
                 void* returnPtr = (void*)instance->getConfig();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Properties");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Properties", false);
                 }
                 else
                 {
@@ -894,11 +876,7 @@ int lua_Game_getGamepad(lua_State* state)
                 void* returnPtr = (void*)instance->getGamepad(param1);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Gamepad");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Gamepad", false);
                 }
                 else
                 {
@@ -928,11 +906,7 @@ int lua_Game_getGamepad(lua_State* state)
                 void* returnPtr = (void*)instance->getGamepad(param1, param2);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Gamepad");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Gamepad", false);
                 }
                 else
                 {
@@ -1042,11 +1016,7 @@ int lua_Game_getPhysicsController(lua_State* state)
                 void* returnPtr = (void*)instance->getPhysicsController();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "PhysicsController");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsController", false);
                 }
                 else
                 {
@@ -1142,11 +1112,7 @@ int lua_Game_getScriptController(lua_State* state)
                 void* returnPtr = (void*)instance->getScriptController();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "ScriptController");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "ScriptController", false);
                 }
                 else
                 {
@@ -1221,11 +1187,7 @@ int lua_Game_getViewport(lua_State* state)
                 void* returnPtr = (void*)&(instance->getViewport());
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Rectangle");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Rectangle", false);
                 }
                 else
                 {
@@ -1965,9 +1927,12 @@ int lua_Game_schedule(lua_State* state)
                 const char* param2 = gameplay::ScriptUtil::getString(3, false);
 
                 Game* instance = getInstance(state);
-                instance->schedule(param1, param2);
-                
-                return 0;
+                unsigned int result = instance->schedule(param1, param2);
+
+                // Push the return value onto the stack.
+                lua_pushunsigned(state, result);
+
+                return 1;
             }
 
             lua_pushstring(state, "lua_Game_schedule - Failed to match the given parameters to a valid function signature.");
@@ -1984,6 +1949,49 @@ int lua_Game_schedule(lua_State* state)
     return 0;
 }
 
+int lua_Game_scheduleRepeating(lua_State* state)
+{
+    // Get the number of parameters.
+    int paramCount = lua_gettop(state);
+
+    // Attempt to match the parameters to a valid binding.
+    switch (paramCount)
+    {
+        case 3:
+        {
+            if ((lua_type(state, 1) == LUA_TUSERDATA) &&
+                lua_type(state, 2) == LUA_TNUMBER &&
+                (lua_type(state, 3) == LUA_TSTRING || lua_type(state, 3) == LUA_TNIL))
+            {
+                // Get parameter 1 off the stack.
+                float param1 = (float)luaL_checknumber(state, 2);
+
+                // Get parameter 2 off the stack.
+                const char* param2 = gameplay::ScriptUtil::getString(3, false);
+
+                Game* instance = getInstance(state);
+                unsigned int result = instance->scheduleRepeating(param1, param2);
+
+                // Push the return value onto the stack.
+                lua_pushunsigned(state, result);
+
+                return 1;
+            }
+
+            lua_pushstring(state, "lua_Game_scheduleRepeating - Failed to match the given parameters to a valid function signature.");
+            lua_error(state);
+            break;
+        }
+        default:
+        {
+            lua_pushstring(state, "Invalid number of parameters (expected 3).");
+            lua_error(state);
+            break;
+        }
+    }
+    return 0;
+}
+
 int lua_Game_setCursorVisible(lua_State* state)
 {
     // Get the number of parameters.
@@ -2239,11 +2247,7 @@ int lua_Game_static_getInstance(lua_State* state)
             void* returnPtr = (void*)Game::getInstance();
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = false;
-                luaL_getmetatable(state, "Game");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "Game", false);
             }
             else
             {
@@ -2409,4 +2413,43 @@ int lua_Game_unregisterGesture(lua_State* state)
     return 0;
 }
 
+int lua_Game_unschedule(lua_State* state)
+{
+    // Get the number of parameters.
+    int paramCount = lua_gettop(state);
+
+    // Attempt to match the parameters to a valid binding.
+    switch (paramCount)
+    {
+        case 2:
+        {
+            if ((lua_type(state, 1) == LUA_TUSERDATA) &&
+                lua_type(state, 2) == LUA_TNUMBER)
+            {
+                // Get parameter 1 off the stack.
+                unsigned int param1 = (unsigned int)luaL_checkunsigned(state, 2);
+
+                Game* instance = getInstance(state);
+                bool result = instance->unschedule(param1);
+
+                // Push the return value onto the stack.
+                lua_pushboolean(state, result);
+
+                return 1;
+            }
+
+            lua_pushstring(state, "lua_Game_unschedule - Failed to match the given parameters to a valid function signature.");
+            lua_error(state);
+            break;
+        }
+        default:
+        {
+            lua_pushstring(state, "Invalid number of parameters (expected 2).");
+            lua_error(state);
+            break;
+        }
+    }
+    return 0;
+}
+
 }
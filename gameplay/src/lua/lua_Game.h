@@ -51,6 +51,7 @@ int lua_Game_resizeEvent(lua_State* state);
 int lua_Game_resume(lua_State* state);
 int lua_Game_run(lua_State* state);
 int lua_Game_schedule(lua_State* state);
+int lua_Game_scheduleRepeating(lua_State* state);
 int lua_Game_setCursorVisible(lua_State* state);
 int lua_Game_setMouseCaptured(lua_State* state);
 int lua_Game_setMultiSampling(lua_State* state);
@@ -63,6 +64,7 @@ int lua_Game_static_isVsync(lua_State* state);
 int lua_Game_static_setVsync(lua_State* state);
 int lua_Game_touchEvent(lua_State* state);
 int lua_Game_unregisterGesture(lua_State* state);
+int lua_Game_unschedule(lua_State* state);
 
 void luaRegister_Game();
 
@@ -66,6 +66,7 @@ void luaRegister_lua_Global()
     gameplay::ScriptUtil::setGlobalHierarchyPair("Ref", "AudioBuffer");
     gameplay::ScriptUtil::setGlobalHierarchyPair("Ref", "AudioSource");
     gameplay::ScriptUtil::setGlobalHierarchyPair("Ref", "Bundle");
+    gameplay::ScriptUtil::setGlobalHierarchyPair("Ref", "BundleAsyncLoad");
     gameplay::ScriptUtil::setGlobalHierarchyPair("Ref", "Button");
     gameplay::ScriptUtil::setGlobalHierarchyPair("Ref", "Camera");
     gameplay::ScriptUtil::setGlobalHierarchyPair("Ref", "CheckBox");
@@ -349,11 +349,7 @@ int lua_HeightField_static_create(lua_State* state)
                 void* returnPtr = (void*)HeightField::create(param1, param2);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "HeightField");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "HeightField", false);
                 }
                 else
                 {
@@ -395,11 +391,7 @@ int lua_HeightField_static_createFromImage(lua_State* state)
                 void* returnPtr = (void*)HeightField::createFromImage(param1);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "HeightField");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "HeightField", false);
                 }
                 else
                 {
@@ -427,11 +419,7 @@ int lua_HeightField_static_createFromImage(lua_State* state)
                 void* returnPtr = (void*)HeightField::createFromImage(param1, param2);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "HeightField");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "HeightField", false);
                 }
                 else
                 {
@@ -463,11 +451,7 @@ int lua_HeightField_static_createFromImage(lua_State* state)
                 void* returnPtr = (void*)HeightField::createFromImage(param1, param2, param3);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "HeightField");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "HeightField", false);
                 }
                 else
                 {
@@ -517,11 +501,7 @@ int lua_HeightField_static_createFromRAW(lua_State* state)
                 void* returnPtr = (void*)HeightField::createFromRAW(param1, param2, param3);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "HeightField");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "HeightField", false);
                 }
                 else
                 {
@@ -557,11 +537,7 @@ int lua_HeightField_static_createFromRAW(lua_State* state)
                 void* returnPtr = (void*)HeightField::createFromRAW(param1, param2, param3, param4);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "HeightField");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "HeightField", false);
                 }
                 else
                 {
@@ -601,11 +577,7 @@ int lua_HeightField_static_createFromRAW(lua_State* state)
                 void* returnPtr = (void*)HeightField::createFromRAW(param1, param2, param3, param4, param5);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "HeightField");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "HeightField", false);
                 }
                 else
                 {
@@ -42,6 +42,7 @@ int lua_ImageControl_getPadding(lua_State* state);
 int lua_ImageControl_getRefCount(lua_State* state);
 int lua_ImageControl_getRegionDst(lua_State* state);
 int lua_ImageControl_getRegionSrc(lua_State* state);
+int lua_ImageControl_getScriptEventFilter(lua_State* state);
 int lua_ImageControl_getSkinColor(lua_State* state);
 int lua_ImageControl_getSkinRegion(lua_State* state);
 int lua_ImageControl_getState(lua_State* state);
@@ -84,6 +85,7 @@ int lua_ImageControl_setPadding(lua_State* state);
 int lua_ImageControl_setPosition(lua_State* state);
 int lua_ImageControl_setRegionDst(lua_State* state);
 int lua_ImageControl_setRegionSrc(lua_State* state);
+int lua_ImageControl_setScriptEventFilter(lua_State* state);
 int lua_ImageControl_setSize(lua_State* state);
 int lua_ImageControl_setSkinColor(lua_State* state);
 int lua_ImageControl_setSkinRegion(lua_State* state);
@@ -8,6 +8,11 @@ static const char* enumStringEmpty = "";
 
 static const char* luaEnumString_ImageFormat_RGB = "RGB";
 static const char* luaEnumString_ImageFormat_RGBA = "RGBA";
+static const char* luaEnumString_ImageFormat_LUMINANCE = "LUMINANCE";
+static const char* luaEnumString_ImageFormat_ALPHA = "ALPHA";
+static const char* luaEnumString_ImageFormat_RGB565 = "RGB565";
+static const char* luaEnumString_ImageFormat_RGBA4444 = "RGBA4444";
+static const char* luaEnumString_ImageFormat_RGBA5551 = "RGBA5551";
 
 Image::Format lua_enumFromString_ImageFormat(const char* s)
 {
@@ -15,6 +20,16 @@ Image::Format lua_enumFromString_ImageFormat(const char* s)
         return Image::RGB;
     if (strcmp(s, luaEnumString_ImageFormat_RGBA) == 0)
         return Image::RGBA;
+    if (strcmp(s, luaEnumString_ImageFormat_LUMINANCE) == 0)
+        return Image::LUMINANCE;
+    if (strcmp(s, luaEnumString_ImageFormat_ALPHA) == 0)
+        return Image::ALPHA;
+    if (strcmp(s, luaEnumString_ImageFormat_RGB565) == 0)
+        return Image::RGB565;
+    if (strcmp(s, luaEnumString_ImageFormat_RGBA4444) == 0)
+        return Image::RGBA4444;
+    if (strcmp(s, luaEnumString_ImageFormat_RGBA5551) == 0)
+        return Image::RGBA5551;
     return Image::RGB;
 }
 
@@ -24,6 +39,16 @@ const char* lua_stringFromEnum_ImageFormat(Image::Format e)
         return luaEnumString_ImageFormat_RGB;
     if (e == Image::RGBA)
         return luaEnumString_ImageFormat_RGBA;
+    if (e == Image::LUMINANCE)
+        return luaEnumString_ImageFormat_LUMINANCE;
+    if (e == Image::ALPHA)
+        return luaEnumString_ImageFormat_ALPHA;
+    if (e == Image::RGB565)
+        return luaEnumString_ImageFormat_RGB565;
+    if (e == Image::RGBA4444)
+        return luaEnumString_ImageFormat_RGBA4444;
+    if (e == Image::RGBA5551)
+        return luaEnumString_ImageFormat_RGBA5551;
     return enumStringEmpty;
 }
 
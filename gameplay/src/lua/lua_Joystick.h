@@ -43,6 +43,7 @@ int lua_Joystick_getOpacity(lua_State* state);
 int lua_Joystick_getOuterRegionSize(lua_State* state);
 int lua_Joystick_getPadding(lua_State* state);
 int lua_Joystick_getRefCount(lua_State* state);
+int lua_Joystick_getScriptEventFilter(lua_State* state);
 int lua_Joystick_getSkinColor(lua_State* state);
 int lua_Joystick_getSkinRegion(lua_State* state);
 int lua_Joystick_getState(lua_State* state);
@@ -86,6 +87,7 @@ int lua_Joystick_setOuterRegionSize(lua_State* state);
 int lua_Joystick_setPadding(lua_State* state);
 int lua_Joystick_setPosition(lua_State* state);
 int lua_Joystick_setRelative(lua_State* state);
+int lua_Joystick_setScriptEventFilter(lua_State* state);
 int lua_Joystick_setSize(lua_State* state);
 int lua_Joystick_setSkinColor(lua_State* state);
 int lua_Joystick_setSkinRegion(lua_State* state);
@@ -40,6 +40,7 @@ int lua_Label_getMargin(lua_State* state);
 int lua_Label_getOpacity(lua_State* state);
 int lua_Label_getPadding(lua_State* state);
 int lua_Label_getRefCount(lua_State* state);
+int lua_Label_getScriptEventFilter(lua_State* state);
 int lua_Label_getSkinColor(lua_State* state);
 int lua_Label_getSkinRegion(lua_State* state);
 int lua_Label_getState(lua_State* state);
@@ -79,6 +80,7 @@ int lua_Label_setMargin(lua_State* state);
 int lua_Label_setOpacity(lua_State* state);
 int lua_Label_setPadding(lua_State* state);
 int lua_Label_setPosition(lua_State* state);
+int lua_Label_setScriptEventFilter(lua_State* state);
 int lua_Label_setSize(lua_State* state);
 int lua_Label_setSkinColor(lua_State* state);
 int lua_Label_setSkinRegion(lua_State* state);
@@ -127,19 +127,8 @@ int lua_Matrix__init(lua_State* state)
     {
         case 0:
         {
-            void* returnPtr = (void*)new Matrix();
-            if (returnPtr)
-            {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = true;
-                luaL_getmetatable(state, "Matrix");
-                lua_setmetatable(state, -2);
-            }
-            else
-            {
-                lua_pushnil(state);
-            }
+            Matrix returnValue = Matrix();
+            gameplay::ScriptUtil::pushValue(state, returnValue, "Matrix");
 
             return 1;
             break;
@@ -153,19 +142,8 @@ int lua_Matrix__init(lua_State* state)
                     // Get parameter 1 off the stack.
                     gameplay::ScriptUtil::LuaArray<float> param1 = gameplay::ScriptUtil::getFloatPointer(1);
 
-                    void* returnPtr = (void*)new Matrix(param1);
-                    if (returnPtr)
-                    {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Matrix");
-                        lua_setmetatable(state, -2);
-                    }
-                    else
-                    {
-                        lua_pushnil(state);
-                    }
+                    Matrix returnValue = Matrix(param1);
+                    gameplay::ScriptUtil::pushValue(state, returnValue, "Matrix");
 
                     return 1;
                 }
@@ -181,19 +159,8 @@ int lua_Matrix__init(lua_State* state)
                     if (!param1Valid)
                         break;
 
-                    void* returnPtr = (void*)new Matrix(*param1);
-                    if (returnPtr)
-                    {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Matrix");
-                        lua_setmetatable(state, -2);
-                    }
-                    else
-                    {
-                        lua_pushnil(state);
-                    }
+                    Matrix returnValue = Matrix(*param1);
+                    gameplay::ScriptUtil::pushValue(state, returnValue, "Matrix");
 
                     return 1;
                 }
@@ -272,19 +239,8 @@ int lua_Matrix__init(lua_State* state)
                     // Get parameter 16 off the stack.
                     float param16 = (float)luaL_checknumber(state, 16);
 
-                    void* returnPtr = (void*)new Matrix(param1, param2, param3, param4, param5, param6, param7, param8, param9, param10, param11, param12, param13, param14, param15, param16);
-                    if (returnPtr)
-                    {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Matrix");
-                        lua_setmetatable(state, -2);
-                    }
-                    else
-                    {
-                        lua_pushnil(state);
-                    }
+                    Matrix returnValue = Matrix(param1, param2, param3, param4, param5, param6, param7, param8, param9, param10, param11, param12, param13, param14, param15, param16);
+                    gameplay::ScriptUtil::pushValue(state, returnValue, "Matrix");
 
                     return 1;
                 }
@@ -2753,11 +2709,7 @@ int lua_Matrix_static_identity(lua_State* state)
             void* returnPtr = (void*)&(Matrix::identity());
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = false;
-                luaL_getmetatable(state, "Matrix");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "Matrix", false);
             }
             else
             {
@@ -2931,11 +2883,7 @@ int lua_Matrix_static_zero(lua_State* state)
             void* returnPtr = (void*)&(Matrix::zero());
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = false;
-                luaL_getmetatable(state, "Matrix");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "Matrix", false);
             }
             else
             {
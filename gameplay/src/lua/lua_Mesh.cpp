@@ -127,11 +127,7 @@ int lua_Mesh_addPart(lua_State* state)
                 void* returnPtr = (void*)instance->addPart(param1, param2, param3);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "MeshPart");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "MeshPart", false);
                 }
                 else
                 {
@@ -169,11 +165,7 @@ int lua_Mesh_addPart(lua_State* state)
                 void* returnPtr = (void*)instance->addPart(param1, param2, param3, param4);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "MeshPart");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "MeshPart", false);
                 }
                 else
                 {
@@ -245,11 +237,7 @@ int lua_Mesh_getBoundingBox(lua_State* state)
                 void* returnPtr = (void*)&(instance->getBoundingBox());
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "BoundingBox");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "BoundingBox", false);
                 }
                 else
                 {
@@ -289,11 +277,7 @@ int lua_Mesh_getBoundingSphere(lua_State* state)
                 void* returnPtr = (void*)&(instance->getBoundingSphere());
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "BoundingSphere");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "BoundingSphere", false);
                 }
                 else
                 {
@@ -337,11 +321,7 @@ int lua_Mesh_getPart(lua_State* state)
                 void* returnPtr = (void*)instance->getPart(param1);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "MeshPart");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "MeshPart", false);
                 }
                 else
                 {
@@ -521,11 +501,7 @@ int lua_Mesh_getVertexBuffer(lua_State* state)
                 void* returnPtr = (void*)new GLuint(instance->getVertexBuffer());
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = true;
-                    luaL_getmetatable(state, "GLuint");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "GLuint", true);
                 }
                 else
                 {
@@ -600,11 +576,7 @@ int lua_Mesh_getVertexFormat(lua_State* state)
                 void* returnPtr = (void*)&(instance->getVertexFormat());
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "VertexFormat");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "VertexFormat", false);
                 }
                 else
                 {
@@ -958,11 +930,7 @@ int lua_Mesh_static_createBoundingBox(lua_State* state)
                 void* returnPtr = (void*)Mesh::createBoundingBox(*param1);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = true;
-                    luaL_getmetatable(state, "Mesh");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Mesh", true);
                 }
                 else
                 {
@@ -1014,11 +982,7 @@ int lua_Mesh_static_createLines(lua_State* state)
                 void* returnPtr = (void*)Mesh::createLines(param1, param2);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = true;
-                    luaL_getmetatable(state, "Mesh");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Mesh", true);
                 }
                 else
                 {
@@ -1070,11 +1034,7 @@ int lua_Mesh_static_createMesh(lua_State* state)
                 void* returnPtr = (void*)Mesh::createMesh(*param1, param2);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = true;
-                    luaL_getmetatable(state, "Mesh");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Mesh", true);
                 }
                 else
                 {
@@ -1112,11 +1072,7 @@ int lua_Mesh_static_createMesh(lua_State* state)
                 void* returnPtr = (void*)Mesh::createMesh(*param1, param2, param3);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = true;
-                    luaL_getmetatable(state, "Mesh");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Mesh", true);
                 }
                 else
                 {
@@ -1184,11 +1140,7 @@ int lua_Mesh_static_createQuad(lua_State* state)
                     void* returnPtr = (void*)Mesh::createQuad(*param1, *param2, *param3, *param4);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Mesh");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Mesh", true);
                     }
                     else
                     {
@@ -1221,11 +1173,7 @@ int lua_Mesh_static_createQuad(lua_State* state)
                     void* returnPtr = (void*)Mesh::createQuad(param1, param2, param3, param4);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Mesh");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Mesh", true);
                     }
                     else
                     {
@@ -1268,11 +1216,7 @@ int lua_Mesh_static_createQuad(lua_State* state)
                     void* returnPtr = (void*)Mesh::createQuad(param1, param2, param3, param4, param5);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Mesh");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Mesh", true);
                     }
                     else
                     {
@@ -1319,11 +1263,7 @@ int lua_Mesh_static_createQuad(lua_State* state)
                     void* returnPtr = (void*)Mesh::createQuad(param1, param2, param3, param4, param5, param6);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Mesh");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Mesh", true);
                     }
                     else
                     {
@@ -1374,11 +1314,7 @@ int lua_Mesh_static_createQuad(lua_State* state)
                     void* returnPtr = (void*)Mesh::createQuad(param1, param2, param3, param4, param5, param6, param7);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Mesh");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Mesh", true);
                     }
                     else
                     {
@@ -1433,11 +1369,7 @@ int lua_Mesh_static_createQuad(lua_State* state)
                     void* returnPtr = (void*)Mesh::createQuad(param1, param2, param3, param4, param5, param6, param7, param8);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Mesh");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Mesh", true);
                     }
                     else
                     {
@@ -1475,11 +1407,7 @@ int lua_Mesh_static_createQuadFullscreen(lua_State* state)
             void* returnPtr = (void*)Mesh::createQuadFullscreen();
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = true;
-                luaL_getmetatable(state, "Mesh");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "Mesh", true);
             }
             else
             {
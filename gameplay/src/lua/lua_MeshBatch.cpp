@@ -288,11 +288,7 @@ int lua_MeshBatch_getMaterial(lua_State* state)
                 void* returnPtr = (void*)instance->getMaterial();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Material");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Material", false);
                 }
                 else
                 {
@@ -419,11 +415,7 @@ int lua_MeshBatch_static_create(lua_State* state)
                     void* returnPtr = (void*)MeshBatch::create(*param1, param2, param3, param4);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "MeshBatch");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "MeshBatch", true);
                     }
                     else
                     {
@@ -462,11 +454,7 @@ int lua_MeshBatch_static_create(lua_State* state)
                     void* returnPtr = (void*)MeshBatch::create(*param1, param2, param3, param4);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "MeshBatch");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "MeshBatch", true);
                     }
                     else
                     {
@@ -512,11 +500,7 @@ int lua_MeshBatch_static_create(lua_State* state)
                     void* returnPtr = (void*)MeshBatch::create(*param1, param2, param3, param4, param5);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "MeshBatch");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "MeshBatch", true);
                     }
                     else
                     {
@@ -559,11 +543,7 @@ int lua_MeshBatch_static_create(lua_State* state)
                     void* returnPtr = (void*)MeshBatch::create(*param1, param2, param3, param4, param5);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "MeshBatch");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "MeshBatch", true);
                     }
                     else
                     {
@@ -613,11 +593,7 @@ int lua_MeshBatch_static_create(lua_State* state)
                     void* returnPtr = (void*)MeshBatch::create(*param1, param2, param3, param4, param5, param6);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "MeshBatch");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "MeshBatch", true);
                     }
                     else
                     {
@@ -664,11 +640,7 @@ int lua_MeshBatch_static_create(lua_State* state)
                     void* returnPtr = (void*)MeshBatch::create(*param1, param2, param3, param4, param5, param6);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "MeshBatch");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "MeshBatch", true);
                     }
                     else
                     {
@@ -88,11 +88,7 @@ int lua_MeshPart_getIndexBuffer(lua_State* state)
                 void* returnPtr = (void*)new GLuint(instance->getIndexBuffer());
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = true;
-                    luaL_getmetatable(state, "GLuint");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "GLuint", true);
                 }
                 else
                 {
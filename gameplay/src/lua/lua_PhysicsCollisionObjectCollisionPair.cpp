@@ -113,11 +113,7 @@ int lua_PhysicsCollisionObjectCollisionPair__init(lua_State* state)
                 void* returnPtr = (void*)new PhysicsCollisionObject::CollisionPair(param1, param2);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = true;
-                    luaL_getmetatable(state, "PhysicsCollisionObjectCollisionPair");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsCollisionObjectCollisionPair", true);
                 }
                 else
                 {
@@ -170,11 +166,7 @@ int lua_PhysicsCollisionObjectCollisionPair_objectA(lua_State* state)
         void* returnPtr = (void*)instance->objectA;
         if (returnPtr)
         {
-            gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-            object->instance = returnPtr;
-            object->owns = false;
-            luaL_getmetatable(state, "PhysicsCollisionObject");
-            lua_setmetatable(state, -2);
+            gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsCollisionObject", false);
         }
         else
         {
@@ -214,11 +206,7 @@ int lua_PhysicsCollisionObjectCollisionPair_objectB(lua_State* state)
         void* returnPtr = (void*)instance->objectB;
         if (returnPtr)
         {
-            gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-            object->instance = returnPtr;
-            object->owns = false;
-            luaL_getmetatable(state, "PhysicsCollisionObject");
-            lua_setmetatable(state, -2);
+            gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsCollisionObject", false);
         }
         else
         {
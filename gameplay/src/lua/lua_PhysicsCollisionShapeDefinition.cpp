@@ -87,11 +87,7 @@ int lua_PhysicsCollisionShapeDefinition__init(lua_State* state)
             void* returnPtr = (void*)new PhysicsCollisionShape::Definition();
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = true;
-                luaL_getmetatable(state, "PhysicsCollisionShapeDefinition");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsCollisionShapeDefinition", true);
             }
             else
             {
@@ -116,11 +112,7 @@ int lua_PhysicsCollisionShapeDefinition__init(lua_State* state)
                     void* returnPtr = (void*)new PhysicsCollisionShape::Definition(*param1);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "PhysicsCollisionShapeDefinition");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsCollisionShapeDefinition", true);
                     }
                     else
                     {
@@ -157,11 +157,7 @@ int lua_PhysicsController_createFixedConstraint(lua_State* state)
                 void* returnPtr = (void*)instance->createFixedConstraint(param1);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "PhysicsFixedConstraint");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsFixedConstraint", false);
                 }
                 else
                 {
@@ -203,11 +199,7 @@ int lua_PhysicsController_createFixedConstraint(lua_State* state)
                 void* returnPtr = (void*)instance->createFixedConstraint(param1, param2);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "PhysicsFixedConstraint");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsFixedConstraint", false);
                 }
                 else
                 {
@@ -256,11 +248,7 @@ int lua_PhysicsController_createGenericConstraint(lua_State* state)
                     void* returnPtr = (void*)instance->createGenericConstraint(param1);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "PhysicsGenericConstraint");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsGenericConstraint", false);
                     }
                     else
                     {
@@ -299,11 +287,7 @@ int lua_PhysicsController_createGenericConstraint(lua_State* state)
                     void* returnPtr = (void*)instance->createGenericConstraint(param1, param2);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "PhysicsGenericConstraint");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsGenericConstraint", false);
                     }
                     else
                     {
@@ -349,11 +333,7 @@ int lua_PhysicsController_createGenericConstraint(lua_State* state)
                     void* returnPtr = (void*)instance->createGenericConstraint(param1, *param2, *param3);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "PhysicsGenericConstraint");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsGenericConstraint", false);
                     }
                     else
                     {
@@ -406,11 +386,7 @@ int lua_PhysicsController_createGenericConstraint(lua_State* state)
                     void* returnPtr = (void*)instance->createGenericConstraint(param1, *param2, *param3, param4);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "PhysicsGenericConstraint");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsGenericConstraint", false);
                     }
                     else
                     {
@@ -470,11 +446,7 @@ int lua_PhysicsController_createGenericConstraint(lua_State* state)
                     void* returnPtr = (void*)instance->createGenericConstraint(param1, *param2, *param3, param4, *param5);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "PhysicsGenericConstraint");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsGenericConstraint", false);
                     }
                     else
                     {
@@ -541,11 +513,7 @@ int lua_PhysicsController_createGenericConstraint(lua_State* state)
                     void* returnPtr = (void*)instance->createGenericConstraint(param1, *param2, *param3, param4, *param5, *param6);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "PhysicsGenericConstraint");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsGenericConstraint", false);
                     }
                     else
                     {
@@ -616,11 +584,7 @@ int lua_PhysicsController_createHingeConstraint(lua_State* state)
                 void* returnPtr = (void*)instance->createHingeConstraint(param1, *param2, *param3);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "PhysicsHingeConstraint");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsHingeConstraint", false);
                 }
                 else
                 {
@@ -682,11 +646,7 @@ int lua_PhysicsController_createHingeConstraint(lua_State* state)
                 void* returnPtr = (void*)instance->createHingeConstraint(param1, *param2, *param3, param4);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "PhysicsHingeConstraint");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsHingeConstraint", false);
                 }
                 else
                 {
@@ -758,11 +718,7 @@ int lua_PhysicsController_createHingeConstraint(lua_State* state)
                 void* returnPtr = (void*)instance->createHingeConstraint(param1, *param2, *param3, param4, *param5);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "PhysicsHingeConstraint");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsHingeConstraint", false);
                 }
                 else
                 {
@@ -844,11 +800,7 @@ int lua_PhysicsController_createHingeConstraint(lua_State* state)
                 void* returnPtr = (void*)instance->createHingeConstraint(param1, *param2, *param3, param4, *param5, *param6);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "PhysicsHingeConstraint");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsHingeConstraint", false);
                 }
                 else
                 {
@@ -897,11 +849,7 @@ int lua_PhysicsController_createSocketConstraint(lua_State* state)
                     void* returnPtr = (void*)instance->createSocketConstraint(param1);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "PhysicsSocketConstraint");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsSocketConstraint", false);
                     }
                     else
                     {
@@ -940,11 +888,7 @@ int lua_PhysicsController_createSocketConstraint(lua_State* state)
                     void* returnPtr = (void*)instance->createSocketConstraint(param1, param2);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "PhysicsSocketConstraint");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsSocketConstraint", false);
                     }
                     else
                     {
@@ -977,11 +921,7 @@ int lua_PhysicsController_createSocketConstraint(lua_State* state)
                     void* returnPtr = (void*)instance->createSocketConstraint(param1, *param2);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "PhysicsSocketConstraint");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsSocketConstraint", false);
                     }
                     else
                     {
@@ -1027,11 +967,7 @@ int lua_PhysicsController_createSocketConstraint(lua_State* state)
                     void* returnPtr = (void*)instance->createSocketConstraint(param1, *param2, param3);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "PhysicsSocketConstraint");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsSocketConstraint", false);
                     }
                     else
                     {
@@ -1084,11 +1020,7 @@ int lua_PhysicsController_createSocketConstraint(lua_State* state)
                     void* returnPtr = (void*)instance->createSocketConstraint(param1, *param2, param3, *param4);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "PhysicsSocketConstraint");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsSocketConstraint", false);
                     }
                     else
                     {
@@ -1145,11 +1077,7 @@ int lua_PhysicsController_createSpringConstraint(lua_State* state)
                     void* returnPtr = (void*)instance->createSpringConstraint(param1, param2);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "PhysicsSpringConstraint");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsSpringConstraint", false);
                     }
                     else
                     {
@@ -1216,11 +1144,7 @@ int lua_PhysicsController_createSpringConstraint(lua_State* state)
                     void* returnPtr = (void*)instance->createSpringConstraint(param1, *param2, *param3, param4, *param5, *param6);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "PhysicsSpringConstraint");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsSpringConstraint", false);
                     }
                     else
                     {
@@ -1303,11 +1227,7 @@ int lua_PhysicsController_getGravity(lua_State* state)
                 void* returnPtr = (void*)&(instance->getGravity());
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Vector3");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Vector3", false);
                 }
                 else
                 {
@@ -89,11 +89,7 @@ int lua_PhysicsControllerHitFilter__init(lua_State* state)
             void* returnPtr = (void*)new PhysicsController::HitFilter();
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = true;
-                luaL_getmetatable(state, "PhysicsControllerHitFilter");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsControllerHitFilter", true);
             }
             else
             {
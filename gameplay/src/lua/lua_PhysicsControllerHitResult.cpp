@@ -91,11 +91,7 @@ int lua_PhysicsControllerHitResult__init(lua_State* state)
             void* returnPtr = (void*)new PhysicsController::HitResult();
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = true;
-                luaL_getmetatable(state, "PhysicsControllerHitResult");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsControllerHitResult", true);
             }
             else
             {
@@ -170,19 +166,8 @@ int lua_PhysicsControllerHitResult_normal(lua_State* state)
     }
     else
     {
-        void* returnPtr = (void*)new Vector3(instance->normal);
-        if (returnPtr)
-        {
-            gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-            object->instance = returnPtr;
-            object->owns = true;
-            luaL_getmetatable(state, "Vector3");
-            lua_setmetatable(state, -2);
-        }
-        else
-        {
-            lua_pushnil(state);
-        }
+        Vector3 returnValue = instance->normal;
+        gameplay::ScriptUtil::pushValue(state, returnValue, "Vector3");
 
         return 1;
     }
@@ -217,11 +202,7 @@ int lua_PhysicsControllerHitResult_object(lua_State* state)
         void* returnPtr = (void*)instance->object;
         if (returnPtr)
         {
-            gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-            object->instance = returnPtr;
-            object->owns = false;
-            luaL_getmetatable(state, "PhysicsCollisionObject");
-            lua_setmetatable(state, -2);
+            gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsCollisionObject", false);
         }
         else
         {
@@ -258,19 +239,8 @@ int lua_PhysicsControllerHitResult_point(lua_State* state)
     }
     else
     {
-        void* returnPtr = (void*)new Vector3(instance->point);
-        if (returnPtr)
-        {
-            gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-            object->instance = returnPtr;
-            object->owns = true;
-            luaL_getmetatable(state, "Vector3");
-            lua_setmetatable(state, -2);
-        }
-        else
-        {
-            lua_pushnil(state);
-        }
+        Vector3 returnValue = instance->point;
+        gameplay::ScriptUtil::pushValue(state, returnValue, "Vector3");
 
         return 1;
     }
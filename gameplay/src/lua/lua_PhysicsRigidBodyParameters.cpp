@@ -107,11 +107,7 @@ int lua_PhysicsRigidBodyParameters__init(lua_State* state)
             void* returnPtr = (void*)new PhysicsRigidBody::Parameters();
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = true;
-                luaL_getmetatable(state, "PhysicsRigidBodyParameters");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsRigidBodyParameters", true);
             }
             else
             {
@@ -133,11 +129,7 @@ int lua_PhysicsRigidBodyParameters__init(lua_State* state)
                     void* returnPtr = (void*)new PhysicsRigidBody::Parameters(param1);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "PhysicsRigidBodyParameters");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsRigidBodyParameters", true);
                     }
                     else
                     {
@@ -168,11 +160,7 @@ int lua_PhysicsRigidBodyParameters__init(lua_State* state)
                     void* returnPtr = (void*)new PhysicsRigidBody::Parameters(param1, param2);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "PhysicsRigidBodyParameters");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsRigidBodyParameters", true);
                     }
                     else
                     {
@@ -207,11 +195,7 @@ int lua_PhysicsRigidBodyParameters__init(lua_State* state)
                     void* returnPtr = (void*)new PhysicsRigidBody::Parameters(param1, param2, param3);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "PhysicsRigidBodyParameters");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsRigidBodyParameters", true);
                     }
                     else
                     {
@@ -250,11 +234,7 @@ int lua_PhysicsRigidBodyParameters__init(lua_State* state)
                     void* returnPtr = (void*)new PhysicsRigidBody::Parameters(param1, param2, param3, param4);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "PhysicsRigidBodyParameters");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsRigidBodyParameters", true);
                     }
                     else
                     {
@@ -297,11 +277,7 @@ int lua_PhysicsRigidBodyParameters__init(lua_State* state)
                     void* returnPtr = (void*)new PhysicsRigidBody::Parameters(param1, param2, param3, param4, param5);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "PhysicsRigidBodyParameters");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsRigidBodyParameters", true);
                     }
                     else
                     {
@@ -348,11 +324,7 @@ int lua_PhysicsRigidBodyParameters__init(lua_State* state)
                     void* returnPtr = (void*)new PhysicsRigidBody::Parameters(param1, param2, param3, param4, param5, param6);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "PhysicsRigidBodyParameters");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsRigidBodyParameters", true);
                     }
                     else
                     {
@@ -406,11 +378,7 @@ int lua_PhysicsRigidBodyParameters__init(lua_State* state)
                     void* returnPtr = (void*)new PhysicsRigidBody::Parameters(param1, param2, param3, param4, param5, param6, *param7);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "PhysicsRigidBodyParameters");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsRigidBodyParameters", true);
                     }
                     else
                     {
@@ -471,11 +439,7 @@ int lua_PhysicsRigidBodyParameters__init(lua_State* state)
                     void* returnPtr = (void*)new PhysicsRigidBody::Parameters(param1, param2, param3, param4, param5, param6, *param7, *param8);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "PhysicsRigidBodyParameters");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsRigidBodyParameters", true);
                     }
                     else
                     {
@@ -543,11 +507,7 @@ int lua_PhysicsRigidBodyParameters__init(lua_State* state)
                     void* returnPtr = (void*)new PhysicsRigidBody::Parameters(param1, param2, param3, param4, param5, param6, *param7, *param8, *param9);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "PhysicsRigidBodyParameters");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "PhysicsRigidBodyParameters", true);
                     }
                     else
                     {
@@ -627,19 +587,8 @@ int lua_PhysicsRigidBodyParameters_angularFactor(lua_State* state)
     }
     else
     {
-        void* returnPtr = (void*)new Vector3(instance->angularFactor);
-        if (returnPtr)
-        {
-            gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-            object->instance = returnPtr;
-            object->owns = true;
-            luaL_getmetatable(state, "Vector3");
-            lua_setmetatable(state, -2);
-        }
-        else
-        {
-            lua_pushnil(state);
-        }
+        Vector3 returnValue = instance->angularFactor;
+        gameplay::ScriptUtil::pushValue(state, returnValue, "Vector3");
 
         return 1;
     }
@@ -671,19 +620,8 @@ int lua_PhysicsRigidBodyParameters_anisotropicFriction(lua_State* state)
     }
     else
     {
-        void* returnPtr = (void*)new Vector3(instance->anisotropicFriction);
-        if (returnPtr)
-        {
-            gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-            object->instance = returnPtr;
-            object->owns = true;
-            luaL_getmetatable(state, "Vector3");
-            lua_setmetatable(state, -2);
-        }
-        else
-        {
-            lua_pushnil(state);
-        }
+        Vector3 returnValue = instance->anisotropicFriction;
+        gameplay::ScriptUtil::pushValue(state, returnValue, "Vector3");
 
         return 1;
     }
@@ -802,19 +740,8 @@ int lua_PhysicsRigidBodyParameters_linearFactor(lua_State* state)
     }
     else
     {
-        void* returnPtr = (void*)new Vector3(instance->linearFactor);
-        if (returnPtr)
-        {
-            gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-            object->instance = returnPtr;
-            object->owns = true;
-            luaL_getmetatable(state, "Vector3");
-            lua_setmetatable(state, -2);
-        }
-        else
-        {
-            lua_pushnil(state);
-        }
+        Vector3 returnValue = instance->linearFactor;
+        gameplay::ScriptUtil::pushValue(state, returnValue, "Vector3");
 
         return 1;
     }
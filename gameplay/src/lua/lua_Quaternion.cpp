@@ -98,19 +98,8 @@ int lua_Quaternion__init(lua_State* state)
     {
         case 0:
         {
-            void* returnPtr = (void*)new Quaternion();
-            if (returnPtr)
-            {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = true;
-                luaL_getmetatable(state, "Quaternion");
-                lua_setmetatable(state, -2);
-            }
-            else
-            {
-                lua_pushnil(state);
-            }
+            Quaternion returnValue = Quaternion();
+            gameplay::ScriptUtil::pushValue(state, returnValue, "Quaternion");
 
             return 1;
             break;
@@ -124,19 +113,8 @@ int lua_Quaternion__init(lua_State* state)
                     // Get parameter 1 off the stack.
                     gameplay::ScriptUtil::LuaArray<float> param1 = gameplay::ScriptUtil::getFloatPointer(1);
 
-                    void* returnPtr = (void*)new Quaternion(param1);
-                    if (returnPtr)
-                    {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Quaternion");
-                        lua_setmetatable(state, -2);
-                    }
-                    else
-                    {
-                        lua_pushnil(state);
-                    }
+                    Quaternion returnValue = Quaternion(param1);
+                    gameplay::ScriptUtil::pushValue(state, returnValue, "Quaternion");
 
                     return 1;
                 }
@@ -152,19 +130,8 @@ int lua_Quaternion__init(lua_State* state)
                     if (!param1Valid)
                         break;
 
-                    void* returnPtr = (void*)new Quaternion(*param1);
-                    if (returnPtr)
-                    {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Quaternion");
-                        lua_setmetatable(state, -2);
-                    }
-                    else
-                    {
-                        lua_pushnil(state);
-                    }
+                    Quaternion returnValue = Quaternion(*param1);
+                    gameplay::ScriptUtil::pushValue(state, returnValue, "Quaternion");
 
                     return 1;
                 }
@@ -180,19 +147,8 @@ int lua_Quaternion__init(lua_State* state)
                     if (!param1Valid)
                         break;
 
-                    void* returnPtr = (void*)new Quaternion(*param1);
-                    if (returnPtr)
-                    {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Quaternion");
-                        lua_setmetatable(state, -2);
-                    }
-                    else
-                    {
-                        lua_pushnil(state);
-                    }
+                    Quaternion returnValue = Quaternion(*param1);
+                    gameplay::ScriptUtil::pushValue(state, returnValue, "Quaternion");
 
                     return 1;
                 }
@@ -218,19 +174,8 @@ int lua_Quaternion__init(lua_State* state)
                     // Get parameter 2 off the stack.
                     float param2 = (float)luaL_checknumber(state, 2);
 
-                    void* returnPtr = (void*)new Quaternion(*param1, param2);
-                    if (returnPtr)
-                    {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Quaternion");
-                        lua_setmetatable(state, -2);
-                    }
-                    else
-                    {
-                        lua_pushnil(state);
-                    }
+                    Quaternion returnValue = Quaternion(*param1, param2);
+                    gameplay::ScriptUtil::pushValue(state, returnValue, "Quaternion");
 
                     return 1;
                 }
@@ -261,19 +206,8 @@ int lua_Quaternion__init(lua_State* state)
                     // Get parameter 4 off the stack.
                     float param4 = (float)luaL_checknumber(state, 4);
 
-                    void* returnPtr = (void*)new Quaternion(param1, param2, param3, param4);
-                    if (returnPtr)
-                    {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Quaternion");
-                        lua_setmetatable(state, -2);
-                    }
-                    else
-                    {
-                        lua_pushnil(state);
-                    }
+                    Quaternion returnValue = Quaternion(param1, param2, param3, param4);
+                    gameplay::ScriptUtil::pushValue(state, returnValue, "Quaternion");
 
                     return 1;
                 }
@@ -873,11 +807,7 @@ int lua_Quaternion_static_identity(lua_State* state)
             void* returnPtr = (void*)&(Quaternion::identity());
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = false;
-                luaL_getmetatable(state, "Quaternion");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "Quaternion", false);
             }
             else
             {
@@ -1182,11 +1112,7 @@ int lua_Quaternion_static_zero(lua_State* state)
             void* returnPtr = (void*)&(Quaternion::zero());
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = false;
-                luaL_getmetatable(state, "Quaternion");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "Quaternion", false);
             }
             else
             {
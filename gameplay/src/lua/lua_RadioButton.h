@@ -42,6 +42,7 @@ int lua_RadioButton_getMargin(lua_State* state);
 int lua_RadioButton_getOpacity(lua_State* state);
 int lua_RadioButton_getPadding(lua_State* state);
 int lua_RadioButton_getRefCount(lua_State* state);
+int lua_RadioButton_getScriptEventFilter(lua_State* state);
 int lua_RadioButton_getSkinColor(lua_State* state);
 int lua_RadioButton_getSkinRegion(lua_State* state);
 int lua_RadioButton_getState(lua_State* state);
@@ -84,6 +85,7 @@ int lua_RadioButton_setMargin(lua_State* state);
 int lua_RadioButton_setOpacity(lua_State* state);
 int lua_RadioButton_setPadding(lua_State* state);
 int lua_RadioButton_setPosition(lua_State* state);
+int lua_RadioButton_setScriptEventFilter(lua_State* state);
 int lua_RadioButton_setSelected(lua_State* state);
 int lua_RadioButton_setSize(lua_State* state);
 int lua_RadioButton_setSkinColor(lua_State* state);
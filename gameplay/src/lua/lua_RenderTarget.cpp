@@ -231,11 +231,7 @@ int lua_RenderTarget_getTexture(lua_State* state)
                 void* returnPtr = (void*)instance->getTexture();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Texture");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Texture", false);
                 }
                 else
                 {
@@ -353,11 +349,7 @@ int lua_RenderTarget_static_create(lua_State* state)
                     void* returnPtr = (void*)RenderTarget::create(param1, param2);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "RenderTarget");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "RenderTarget", true);
                     }
                     else
                     {
@@ -392,11 +384,7 @@ int lua_RenderTarget_static_create(lua_State* state)
                     void* returnPtr = (void*)RenderTarget::create(param1, param2, param3);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "RenderTarget");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "RenderTarget", true);
                     }
                     else
                     {
@@ -439,11 +427,7 @@ int lua_RenderTarget_static_getRenderTarget(lua_State* state)
                 void* returnPtr = (void*)RenderTarget::getRenderTarget(param1);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "RenderTarget");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "RenderTarget", false);
                 }
                 else
                 {
@@ -82,11 +82,7 @@ int lua_ScreenDisplayer__init(lua_State* state)
             void* returnPtr = (void*)new ScreenDisplayer();
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = true;
-                luaL_getmetatable(state, "ScreenDisplayer");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "ScreenDisplayer", true);
             }
             else
             {
@@ -5,9 +5,14 @@ namespace gameplay
 {
 
 // Lua bindings for ScriptController.
+int lua_ScriptController_addEventFilter(lua_State* state);
+int lua_ScriptController_addKeyFilter(lua_State* state);
+int lua_ScriptController_clearEventFilters(lua_State* state);
+int lua_ScriptController_getCoalesceMoveEvents(lua_State* state);
 int lua_ScriptController_loadScript(lua_State* state);
 int lua_ScriptController_loadUrl(lua_State* state);
 int lua_ScriptController_registerCallback(lua_State* state);
+int lua_ScriptController_setCoalesceMoveEvents(lua_State* state);
 int lua_ScriptController_static_print(lua_State* state);
 int lua_ScriptController_unregisterCallback(lua_State* state);
 
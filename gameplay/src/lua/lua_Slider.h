@@ -42,6 +42,7 @@ int lua_Slider_getMin(lua_State* state);
 int lua_Slider_getOpacity(lua_State* state);
 int lua_Slider_getPadding(lua_State* state);
 int lua_Slider_getRefCount(lua_State* state);
+int lua_Slider_getScriptEventFilter(lua_State* state);
 int lua_Slider_getSkinColor(lua_State* state);
 int lua_Slider_getSkinRegion(lua_State* state);
 int lua_Slider_getState(lua_State* state);
@@ -88,6 +89,7 @@ int lua_Slider_setMin(lua_State* state);
 int lua_Slider_setOpacity(lua_State* state);
 int lua_Slider_setPadding(lua_State* state);
 int lua_Slider_setPosition(lua_State* state);
+int lua_Slider_setScriptEventFilter(lua_State* state);
 int lua_Slider_setSize(lua_State* state);
 int lua_Slider_setSkinColor(lua_State* state);
 int lua_Slider_setSkinRegion(lua_State* state);
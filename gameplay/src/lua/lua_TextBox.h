@@ -41,6 +41,7 @@ int lua_TextBox_getMargin(lua_State* state);
 int lua_TextBox_getOpacity(lua_State* state);
 int lua_TextBox_getPadding(lua_State* state);
 int lua_TextBox_getRefCount(lua_State* state);
+int lua_TextBox_getScriptEventFilter(lua_State* state);
 int lua_TextBox_getSkinColor(lua_State* state);
 int lua_TextBox_getSkinRegion(lua_State* state);
 int lua_TextBox_getState(lua_State* state);
@@ -80,6 +81,7 @@ int lua_TextBox_setMargin(lua_State* state);
 int lua_TextBox_setOpacity(lua_State* state);
 int lua_TextBox_setPadding(lua_State* state);
 int lua_TextBox_setPosition(lua_State* state);
+int lua_TextBox_setScriptEventFilter(lua_State* state);
 int lua_TextBox_setSize(lua_State* state);
 int lua_TextBox_setSkinColor(lua_State* state);
 int lua_TextBox_setSkinRegion(lua_State* state);
@@ -27,6 +27,7 @@ void luaRegister_Texture()
         {"getRefCount", lua_Texture_getRefCount},
         {"getWidth", lua_Texture_getWidth},
         {"isCompressed", lua_Texture_isCompressed},
+        {"isLoaded", lua_Texture_isLoaded},
         {"isMipmapped", lua_Texture_isMipmapped},
         {"release", lua_Texture_release},
         {NULL, NULL}
@@ -34,6 +35,7 @@ void luaRegister_Texture()
     const luaL_Reg lua_statics[] = 
     {
         {"create", lua_Texture_static_create},
+        {"createAsync", lua_Texture_static_createAsync},
         {NULL, NULL}
     };
     std::vector<std::string> scopePath;
@@ -201,11 +203,7 @@ int lua_Texture_getHandle(lua_State* state)
                 void* returnPtr = (void*)new GLuint(instance->getHandle());
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = true;
-                    luaL_getmetatable(state, "GLuint");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "GLuint", true);
                 }
                 else
                 {
@@ -404,6 +402,41 @@ int lua_Texture_isCompressed(lua_State* state)
     return 0;
 }
 
+int lua_Texture_isLoaded(lua_State* state)
+{
+    // Get the number of parameters.
+    int paramCount = lua_gettop(state);
+
+    // Attempt to match the parameters to a valid binding.
+    switch (paramCount)
+    {
+        case 1:
+        {
+            if ((lua_type(state, 1) == LUA_TUSERDATA))
+            {
+                Texture* instance = getInstance(state);
+                bool result = instance->isLoaded();
+
+                // Push the return value onto the stack.
+                lua_pushboolean(state, result);
+
+                return 1;
+            }
+
+            lua_pushstring(state, "lua_Texture_isLoaded - Failed to match the given parameters to a valid function signature.");
+            lua_error(state);
+            break;
+        }
+        default:
+        {
+            lua_pushstring(state, "Invalid number of parameters (expected 1).");
+            lua_error(state);
+            break;
+        }
+    }
+    return 0;
+}
+
 int lua_Texture_isMipmapped(lua_State* state)
 {
     // Get the number of parameters.
@@ -491,11 +524,7 @@ int lua_Texture_static_create(lua_State* state)
                     void* returnPtr = (void*)Texture::create(param1);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Texture");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Texture", true);
                     }
                     else
                     {
@@ -519,11 +548,7 @@ int lua_Texture_static_create(lua_State* state)
                     void* returnPtr = (void*)Texture::create(param1);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Texture");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Texture", true);
                     }
                     else
                     {
@@ -554,11 +579,7 @@ int lua_Texture_static_create(lua_State* state)
                     void* returnPtr = (void*)Texture::create(param1, param2);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Texture");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Texture", true);
                     }
                     else
                     {
@@ -586,11 +607,7 @@ int lua_Texture_static_create(lua_State* state)
                     void* returnPtr = (void*)Texture::create(param1, param2);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Texture");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Texture", true);
                     }
                     else
                     {
@@ -628,11 +645,7 @@ int lua_Texture_static_create(lua_State* state)
                     void* returnPtr = (void*)Texture::create(*param1, param2, param3);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Texture");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Texture", true);
                     }
                     else
                     {
@@ -671,11 +684,7 @@ int lua_Texture_static_create(lua_State* state)
                     void* returnPtr = (void*)Texture::create(param1, param2, param3, param4);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Texture");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Texture", true);
                     }
                     else
                     {
@@ -711,11 +720,7 @@ int lua_Texture_static_create(lua_State* state)
                     void* returnPtr = (void*)Texture::create(*param1, param2, param3, param4);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Texture");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Texture", true);
                     }
                     else
                     {
@@ -758,11 +763,7 @@ int lua_Texture_static_create(lua_State* state)
                     void* returnPtr = (void*)Texture::create(param1, param2, param3, param4, param5);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Texture");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Texture", true);
                     }
                     else
                     {
@@ -787,4 +788,74 @@ int lua_Texture_static_create(lua_State* state)
     return 0;
 }
 
+int lua_Texture_static_createAsync(lua_State* state)
+{
+    // Get the number of parameters.
+    int paramCount = lua_gettop(state);
+
+    // Attempt to match the parameters to a valid binding.
+    switch (paramCount)
+    {
+        case 1:
+        {
+            if ((lua_type(state, 1) == LUA_TSTRING || lua_type(state, 1) == LUA_TNIL))
+            {
+                // Get parameter 1 off the stack.
+                const char* param1 = gameplay::ScriptUtil::getString(1, false);
+
+                void* returnPtr = (void*)Texture::createAsync(param1);
+                if (returnPtr)
+                {
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Texture", true);
+                }
+                else
+                {
+                    lua_pushnil(state);
+                }
+
+                return 1;
+            }
+
+            lua_pushstring(state, "lua_Texture_static_createAsync - Failed to match the given parameters to a valid function signature.");
+            lua_error(state);
+            break;
+        }
+        case 2:
+        {
+            if ((lua_type(state, 1) == LUA_TSTRING || lua_type(state, 1) == LUA_TNIL) &&
+                lua_type(state, 2) == LUA_TBOOLEAN)
+            {
+                // Get parameter 1 off the stack.
+                const char* param1 = gameplay::ScriptUtil::getString(1, false);
+
+                // Get parameter 2 off the stack.
+                bool param2 = gameplay::ScriptUtil::luaCheckBool(state, 2);
+
+                void* returnPtr = (void*)Texture::createAsync(param1, param2);
+                if (returnPtr)
+                {
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Texture", true);
+                }
+                else
+                {
+                    lua_pushnil(state);
+                }
+
+                return 1;
+            }
+
+            lua_pushstring(state, "lua_Texture_static_createAsync - Failed to match the given parameters to a valid function signature.");
+            lua_error(state);
+            break;
+        }
+        default:
+        {
+            lua_pushstring(state, "Invalid number of parameters (expected 1 or 2).");
+            lua_error(state);
+            break;
+        }
+    }
+    return 0;
+}
+
 }
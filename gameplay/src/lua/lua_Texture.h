@@ -15,9 +15,11 @@ int lua_Texture_getPath(lua_State* state);
 int lua_Texture_getRefCount(lua_State* state);
 int lua_Texture_getWidth(lua_State* state);
 int lua_Texture_isCompressed(lua_State* state);
+int lua_Texture_isLoaded(lua_State* state);
 int lua_Texture_isMipmapped(lua_State* state);
 int lua_Texture_release(lua_State* state);
 int lua_Texture_static_create(lua_State* state);
+int lua_Texture_static_createAsync(lua_State* state);
 
 void luaRegister_Texture();
 
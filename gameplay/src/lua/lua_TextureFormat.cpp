@@ -10,6 +10,10 @@ static const char* luaEnumString_TextureFormat_UNKNOWN = "UNKNOWN";
 static const char* luaEnumString_TextureFormat_RGB = "RGB";
 static const char* luaEnumString_TextureFormat_RGBA = "RGBA";
 static const char* luaEnumString_TextureFormat_ALPHA = "ALPHA";
+static const char* luaEnumString_TextureFormat_LUMINANCE = "LUMINANCE";
+static const char* luaEnumString_TextureFormat_RGB565 = "RGB565";
+static const char* luaEnumString_TextureFormat_RGBA4444 = "RGBA4444";
+static const char* luaEnumString_TextureFormat_RGBA5551 = "RGBA5551";
 
 Texture::Format lua_enumFromString_TextureFormat(const char* s)
 {
@@ -21,6 +25,14 @@ Texture::Format lua_enumFromString_TextureFormat(const char* s)
         return Texture::RGBA;
     if (strcmp(s, luaEnumString_TextureFormat_ALPHA) == 0)
         return Texture::ALPHA;
+    if (strcmp(s, luaEnumString_TextureFormat_LUMINANCE) == 0)
+        return Texture::LUMINANCE;
+    if (strcmp(s, luaEnumString_TextureFormat_RGB565) == 0)
+        return Texture::RGB565;
+    if (strcmp(s, luaEnumString_TextureFormat_RGBA4444) == 0)
+        return Texture::RGBA4444;
+    if (strcmp(s, luaEnumString_TextureFormat_RGBA5551) == 0)
+        return Texture::RGBA5551;
     return Texture::UNKNOWN;
 }
 
@@ -34,6 +46,14 @@ const char* lua_stringFromEnum_TextureFormat(Texture::Format e)
         return luaEnumString_TextureFormat_RGBA;
     if (e == Texture::ALPHA)
         return luaEnumString_TextureFormat_ALPHA;
+    if (e == Texture::LUMINANCE)
+        return luaEnumString_TextureFormat_LUMINANCE;
+    if (e == Texture::RGB565)
+        return luaEnumString_TextureFormat_RGB565;
+    if (e == Texture::RGBA4444)
+        return luaEnumString_TextureFormat_RGBA4444;
+    if (e == Texture::RGBA5551)
+        return luaEnumString_TextureFormat_RGBA5551;
     return enumStringEmpty;
 }
 
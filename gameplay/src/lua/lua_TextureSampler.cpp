@@ -198,11 +198,7 @@ int lua_TextureSampler_getTexture(lua_State* state)
                 void* returnPtr = (void*)instance->getTexture();
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "Texture");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "Texture", false);
                 }
                 else
                 {
@@ -361,11 +357,7 @@ int lua_TextureSampler_static_create(lua_State* state)
                     void* returnPtr = (void*)Texture::Sampler::create(param1);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "TextureSampler");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "TextureSampler", true);
                     }
                     else
                     {
@@ -386,11 +378,7 @@ int lua_TextureSampler_static_create(lua_State* state)
                     void* returnPtr = (void*)Texture::Sampler::create(param1);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "TextureSampler");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "TextureSampler", true);
                     }
                     else
                     {
@@ -421,11 +409,7 @@ int lua_TextureSampler_static_create(lua_State* state)
                     void* returnPtr = (void*)Texture::Sampler::create(param1, param2);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "TextureSampler");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "TextureSampler", true);
                     }
                     else
                     {
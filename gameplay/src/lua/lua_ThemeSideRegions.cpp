@@ -89,11 +89,7 @@ int lua_ThemeSideRegions__init(lua_State* state)
             void* returnPtr = (void*)new Theme::SideRegions();
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = true;
-                luaL_getmetatable(state, "ThemeSideRegions");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "ThemeSideRegions", true);
             }
             else
             {
@@ -213,11 +209,7 @@ int lua_ThemeSideRegions_static_empty(lua_State* state)
             void* returnPtr = (void*)&(Theme::SideRegions::empty());
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = false;
-                luaL_getmetatable(state, "ThemeSideRegions");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "ThemeSideRegions", false);
             }
             else
             {
@@ -90,11 +90,7 @@ int lua_ThemeUVs__init(lua_State* state)
             void* returnPtr = (void*)new Theme::UVs();
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = true;
-                luaL_getmetatable(state, "ThemeUVs");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "ThemeUVs", true);
             }
             else
             {
@@ -128,11 +124,7 @@ int lua_ThemeUVs__init(lua_State* state)
                     void* returnPtr = (void*)new Theme::UVs(param1, param2, param3, param4);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "ThemeUVs");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "ThemeUVs", true);
                     }
                     else
                     {
@@ -170,11 +162,7 @@ int lua_ThemeUVs_static_empty(lua_State* state)
             void* returnPtr = (void*)&(Theme::UVs::empty());
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = false;
-                luaL_getmetatable(state, "ThemeUVs");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "ThemeUVs", false);
             }
             else
             {
@@ -207,11 +195,7 @@ int lua_ThemeUVs_static_full(lua_State* state)
             void* returnPtr = (void*)&(Theme::UVs::full());
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = false;
-                luaL_getmetatable(state, "ThemeUVs");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "ThemeUVs", false);
             }
             else
             {
@@ -104,19 +104,8 @@ int lua_Vector2__init(lua_State* state)
     {
         case 0:
         {
-            void* returnPtr = (void*)new Vector2();
-            if (returnPtr)
-            {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = true;
-                luaL_getmetatable(state, "Vector2");
-                lua_setmetatable(state, -2);
-            }
-            else
-            {
-                lua_pushnil(state);
-            }
+            Vector2 returnValue = Vector2();
+            gameplay::ScriptUtil::pushValue(state, returnValue, "Vector2");
 
             return 1;
             break;
@@ -130,19 +119,8 @@ int lua_Vector2__init(lua_State* state)
                     // Get parameter 1 off the stack.
                     gameplay::ScriptUtil::LuaArray<float> param1 = gameplay::ScriptUtil::getFloatPointer(1);
 
-                    void* returnPtr = (void*)new Vector2(param1);
-                    if (returnPtr)
-                    {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Vector2");
-                        lua_setmetatable(state, -2);
-                    }
-                    else
-                    {
-                        lua_pushnil(state);
-                    }
+                    Vector2 returnValue = Vector2(param1);
+                    gameplay::ScriptUtil::pushValue(state, returnValue, "Vector2");
 
                     return 1;
                 }
@@ -158,19 +136,8 @@ int lua_Vector2__init(lua_State* state)
                     if (!param1Valid)
                         break;
 
-                    void* returnPtr = (void*)new Vector2(*param1);
-                    if (returnPtr)
-                    {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Vector2");
-                        lua_setmetatable(state, -2);
-                    }
-                    else
-                    {
-                        lua_pushnil(state);
-                    }
+                    Vector2 returnValue = Vector2(*param1);
+                    gameplay::ScriptUtil::pushValue(state, returnValue, "Vector2");
 
                     return 1;
                 }
@@ -193,19 +160,8 @@ int lua_Vector2__init(lua_State* state)
                     // Get parameter 2 off the stack.
                     float param2 = (float)luaL_checknumber(state, 2);
 
-                    void* returnPtr = (void*)new Vector2(param1, param2);
-                    if (returnPtr)
-                    {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Vector2");
-                        lua_setmetatable(state, -2);
-                    }
-                    else
-                    {
-                        lua_pushnil(state);
-                    }
+                    Vector2 returnValue = Vector2(param1, param2);
+                    gameplay::ScriptUtil::pushValue(state, returnValue, "Vector2");
 
                     return 1;
                 }
@@ -228,19 +184,8 @@ int lua_Vector2__init(lua_State* state)
                     if (!param2Valid)
                         break;
 
-                    void* returnPtr = (void*)new Vector2(*param1, *param2);
-                    if (returnPtr)
-                    {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "Vector2");
-                        lua_setmetatable(state, -2);
-                    }
-                    else
-                    {
-                        lua_pushnil(state);
-                    }
+                    Vector2 returnValue = Vector2(*param1, *param2);
+                    gameplay::ScriptUtil::pushValue(state, returnValue, "Vector2");
 
                     return 1;
                 }
@@ -679,11 +624,7 @@ int lua_Vector2_normalize(lua_State* state)
                     void* returnPtr = (void*)&(instance->normalize());
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = false;
-                        luaL_getmetatable(state, "Vector2");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "Vector2", false);
                     }
                     else
                     {
@@ -1241,11 +1182,7 @@ int lua_Vector2_static_one(lua_State* state)
             void* returnPtr = (void*)&(Vector2::one());
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = false;
-                luaL_getmetatable(state, "Vector2");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "Vector2", false);
             }
             else
             {
@@ -1338,11 +1275,7 @@ int lua_Vector2_static_unitX(lua_State* state)
             void* returnPtr = (void*)&(Vector2::unitX());
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = false;
-                luaL_getmetatable(state, "Vector2");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "Vector2", false);
             }
             else
             {
@@ -1375,11 +1308,7 @@ int lua_Vector2_static_unitY(lua_State* state)
             void* returnPtr = (void*)&(Vector2::unitY());
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = false;
-                luaL_getmetatable(state, "Vector2");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "Vector2", false);
             }
             else
             {
@@ -1412,11 +1341,7 @@ int lua_Vector2_static_zero(lua_State* state)
             void* returnPtr = (void*)&(Vector2::zero());
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = false;
-                luaL_getmetatable(state, "Vector2");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "Vector2", false);
             }
             else
             {
@@ -100,11 +100,7 @@ int lua_VertexFormat__init(lua_State* state)
                 void* returnPtr = (void*)new VertexFormat(param1, param2);
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = true;
-                    luaL_getmetatable(state, "VertexFormat");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "VertexFormat", true);
                 }
                 else
                 {
@@ -148,11 +144,7 @@ int lua_VertexFormat_getElement(lua_State* state)
                 void* returnPtr = (void*)&(instance->getElement(param1));
                 if (returnPtr)
                 {
-                    gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                    object->instance = returnPtr;
-                    object->owns = false;
-                    luaL_getmetatable(state, "VertexFormatElement");
-                    lua_setmetatable(state, -2);
+                    gameplay::ScriptUtil::pushObject(state, returnPtr, "VertexFormatElement", false);
                 }
                 else
                 {
@@ -81,11 +81,7 @@ int lua_VertexFormatElement__init(lua_State* state)
             void* returnPtr = (void*)new VertexFormat::Element();
             if (returnPtr)
             {
-                gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                object->instance = returnPtr;
-                object->owns = true;
-                luaL_getmetatable(state, "VertexFormatElement");
-                lua_setmetatable(state, -2);
+                gameplay::ScriptUtil::pushObject(state, returnPtr, "VertexFormatElement", true);
             }
             else
             {
@@ -111,11 +107,7 @@ int lua_VertexFormatElement__init(lua_State* state)
                     void* returnPtr = (void*)new VertexFormat::Element(param1, param2);
                     if (returnPtr)
                     {
-                        gameplay::ScriptUtil::LuaObject* object = (gameplay::ScriptUtil::LuaObject*)lua_newuserdata(state, sizeof(gameplay::ScriptUtil::LuaObject));
-                        object->instance = returnPtr;
-                        object->owns = true;
-                        luaL_getmetatable(state, "VertexFormatElement");
-                        lua_setmetatable(state, -2);
+                        gameplay::ScriptUtil::pushObject(state, returnPtr, "VertexFormatElement", true);
                     }
                     else
                     {
@@ -27,6 +27,7 @@ void lua_RegisterAllBindings()
     luaRegister_BoundingBox();
     luaRegister_BoundingSphere();
     luaRegister_Bundle();
+    luaRegister_BundleAsyncLoad();
     luaRegister_Button();
     luaRegister_Camera();
     luaRegister_CheckBox();
@@ -22,6 +22,7 @@
 #include "lua_BoundingBox.h"
 #include "lua_BoundingSphere.h"
 #include "lua_Bundle.h"
+#include "lua_BundleAsyncLoad.h"
 #include "lua_Button.h"
 #include "lua_Camera.h"
 #include "lua_CheckBox.h"
@@ -0,0 +1,592 @@
+#include "BenchmarkGame.h"
+
+// Declare our game instance
+BenchmarkGame game;
+
+// The time each frame advances the scenes by, so every run simulates the same frames.
+#define BENCHMARK_FRAME_TIME (1000.0f / 60.0f)
+
+static const char* __sceneNames[] =
+{
+    "models",
+    "crowd",
+    "particles",
+    "physics",
+    "forms",
+    "terrain"
+};
+
+// The profiler scopes reported for each scene.
+static const char* __stageNames[] =
+{
+    "JobController::update",
+    "AnimationController::update",
+    "PhysicsController::update",
+    "AIController::update",
+    "Game::update",
+    "Form::update",
+    "AudioController::update",
+    "Game::render"
+};
+
+/**
+ * Returns the frame time below which the specified percentage of the sorted frame times are.
+ */
+static float getPercentile(const std::vector<float>& sortedTimes, float percent)
+{
+    if (sortedTimes.empty())
+        return 0.0f;
+    unsigned int rank = (unsigned int)ceil(percent * 0.01f * sortedTimes.size());
+    return sortedTimes[rank > 0 ? rank - 1 : 0];
+}
+
+BenchmarkGame::BenchmarkGame()
+    : _font(NULL), _scene(NULL), _form(NULL), _sceneIndex(0), _frame(0), _frameCount(600), _warmupFrameCount(60),
+      _scale(1.0f), _lastFrameTime(0.0)
+{
+}
+
+BenchmarkGame::~BenchmarkGame()
+{
+}
+
+void BenchmarkGame::initialize()
+{
+    _font = Font::create("res/arial40.gpb");
+
+    // Read the settings of the run.
+    std::string scenes = "models,crowd,particles,physics,forms,terrain";
+    _reportPath = "benchmark.txt";
+    Properties* config = getConfig()->getNamespace("benchmark", true);
+    if (config)
+    {
+        if (config->exists("frames"))
+            _frameCount = (unsigned int)config->getInt("frames");
+        if (config->exists("warmupFrames"))
+            _warmupFrameCount = (unsigned int)config->getInt("warmupFrames");
+        if (config->exists("scale"))
+            _scale = config->getFloat("scale");
+        if (config->exists("scenes"))
+            scenes = config->getString("scenes");
+        if (config->exists("report"))
+            _reportPath = config->getString("report");
+    }
+    if (_frameCount == 0)
+        _frameCount = 1;
+
+    // Parse the comma separated list of scenes.
+    size_t start = 0;
+    while (start <= scenes.size())
+    {
+        size_t end = scenes.find(',', start);
+        if (end == std::string::npos)
+            end = scenes.size();
+        std::string name = scenes.substr(start, end - start);
+        name.erase(0, name.find_first_not_of(" \t"));
+        name.erase(name.find_last_not_of(" \t") + 1);
+        for (unsigned int i = 0; i < SCENE_TYPE_COUNT; ++i)
+        {
+            if (name == __sceneNames[i])
+            {
+                _scenes.push_back((SceneType)i);
+                break;
+            }
+        }
+        start = end + 1;
+    }
+
+    // Every frame simulates the same time, regardless of how long it took.
+    setFixedFrameTime(BENCHMARK_FRAME_TIME);
+    setVsync(false);
+    Profiler::setCapacity((_frameCount + _warmupFrameCount) * 64);
+
+    char line[256];
+    sprintf(line, "%-10s %8s %8s %8s %8s %8s %8s %8s  (frame times in ms)\n", "scene", "frames", "mean", "p50", "p90", "p95", "p99", "max");
+    _report = line;
+
+    if (_scenes.empty())
+    {
+        GP_WARN("No benchmark scenes to run.");
+        exit();
+        return;
+    }
+    loadScene(_scenes[0]);
+}
+
+void BenchmarkGame::finalize()
+{
+    unloadScene();
+    SAFE_RELEASE(_font);
+}
+
+void BenchmarkGame::update(float elapsedTime)
+{
+    if (_sceneIndex >= _scenes.size())
+        return;
+
+    // Record the time between frames once the scene has warmed up.
+    double now = getAbsoluteTime();
+    if (_frame == _warmupFrameCount)
+    {
+        Profiler::clear();
+        Profiler::setEnabled(true);
+    }
+    else if (_frame > _warmupFrameCount)
+    {
+        _frameTimes.push_back((float)(now - _lastFrameTime));
+    }
+    _lastFrameTime = now;
+
+    if (_frame >= _warmupFrameCount + _frameCount)
+    {
+        reportScene();
+        unloadScene();
+        if (++_sceneIndex >= _scenes.size())
+        {
+            finish();
+            return;
+        }
+        loadScene(_scenes[_sceneIndex]);
+        return;
+    }
+
+    updateCamera((float)_frame / (float)(_warmupFrameCount + _frameCount));
+    if (_scene)
+        _scene->visit(this, &BenchmarkGame::updateEmitter, elapsedTime);
+
+    // Change the text of a few labels each frame, so the form is laid out again.
+    for (unsigned int i = 0; i < 8 && !_labels.empty(); ++i)
+    {
+        char text[32];
+        sprintf(text, "Label %u", _frame * 8 + i);
+        _labels[(_frame * 8 + i) % _labels.size()]->setText(text);
+    }
+
+    ++_frame;
+}
+
+void BenchmarkGame::render(float elapsedTime)
+{
+    clear(CLEAR_COLOR_DEPTH, Vector4(0.1f, 0.1f, 0.15f, 1.0f), 1.0f, 0);
+
+    if (_scene)
+    {
+        _scene->visit(this, &BenchmarkGame::drawOpaque);
+        _scene->visit(this, &BenchmarkGame::drawTransparent);
+    }
+    if (_form)
+        _form->draw();
+
+    if (_font && _sceneIndex < _scenes.size())
+    {
+        char text[64];
+        sprintf(text, "%s %u/%u", __sceneNames[_scenes[_sceneIndex]], _frame, _warmupFrameCount + _frameCount);
+        _font->start();
+        _font->drawText(text, 5, 1, Vector4(0, 0.5f, 1, 1), _font->getSize());
+        _font->finish();
+    }
+}
+
+void BenchmarkGame::keyEvent(Keyboard::KeyEvent evt, int key)
+{
+    if (evt == Keyboard::KEY_PRESS && key == Keyboard::KEY_ESCAPE)
+    {
+        exit();
+    }
+}
+
+void BenchmarkGame::loadScene(SceneType type)
+{
+    // Random numbers are used by the particles and to place content, so seed them the same way for every run.
+    srand(1);
+
+    _frame = 0;
+    _frameTimes.clear();
+    Profiler::setEnabled(false);
+
+    switch (type)
+    {
+    case MODELS:
+        createModels();
+        break;
+    case CROWD:
+        createCrowd();
+        break;
+    case PARTICLES:
+        createParticles();
+        break;
+    case PHYSICS:
+        createPhysics();
+        break;
+    case FORMS:
+        createForms();
+        break;
+    case TERRAIN:
+        createTerrain();
+        break;
+    default:
+        break;
+    }
+}
+
+void BenchmarkGame::unloadScene()
+{
+    Profiler::setEnabled(false);
+    _labels.clear();
+    SAFE_RELEASE(_form);
+    SAFE_RELEASE(_scene);
+}
+
+void BenchmarkGame::createScene()
+{
+    _scene = Scene::create();
+    _scene->setAmbientColor(0.2f, 0.2f, 0.2f);
+    _scene->setLightColor(0.75f, 0.75f, 0.75f);
+    Vector3 lightDirection(-0.5f, -1.0f, -0.5f);
+    lightDirection.normalize();
+    _scene->setLightDirection(lightDirection);
+
+    Camera* camera = Camera::createPerspective(45.0f, getAspectRatio(), 0.5f, 2000.0f);
+    Node* cameraNode = _scene->addNode("camera");
+    cameraNode->setCamera(camera);
+    _scene->setActiveCamera(camera);
+    SAFE_RELEASE(camera);
+}
+
+void BenchmarkGame::createModels()
+{
+    createScene();
+
+    Bundle* bundle = Bundle::create("res/duck.gpb");
+    Node* duck = bundle ? bundle->loadNode("duck") : NULL;
+    SAFE_RELEASE(bundle);
+    if (duck == NULL || duck->getModel() == NULL)
+    {
+        GP_WARN("Failed to load the model of the models scene.");
+        SAFE_RELEASE(duck);
+        return;
+    }
+    duck->getModel()->setMaterial("res/benchmark.material#duck");
+    float scale = 1.0f / duck->getModel()->getMesh()->getBoundingSphere().radius;
+
+    // A grid of models with their own materials, so each is drawn on its own.
+    unsigned int count = (unsigned int)(4000 * _scale);
+    unsigned int columns = (unsigned int)ceil(sqrt((float)count));
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        Node* node = duck->clone();
+        node->setTranslation(((float)(i % columns) - columns * 0.5f) * 3.0f, 0.0f, ((float)(i / columns) - columns * 0.5f) * 3.0f);
+        node->rotateY(MATH_RANDOM_0_1() * MATH_PIX2);
+        node->setScale(scale);
+        _scene->addNode(node);
+        SAFE_RELEASE(node);
+    }
+    SAFE_RELEASE(duck);
+}
+
+void BenchmarkGame::createCrowd()
+{
+    createScene();
+
+    Bundle* bundle = Bundle::create("res/common/scene.gpb");
+    Node* character = bundle ? bundle->loadNode("boycharacter") : NULL;
+    SAFE_RELEASE(bundle);
+    Node* mesh = character ? character->findNode("boymesh") : NULL;
+    Animation* animation = character ? character->getAnimation("animations") : NULL;
+    if (mesh == NULL || mesh->getModel() == NULL || animation == NULL)
+    {
+        GP_WARN("Failed to load the character of the crowd scene.");
+        SAFE_RELEASE(character);
+        return;
+    }
+    mesh->getModel()->setMaterial("res/benchmark.material#crowd");
+    Node* shadow = character->findNode("boyshadow");
+    if (shadow)
+        shadow->setModel(NULL);
+    animation->createClips("res/common/boy.animation");
+
+    // Skinned characters walking in place, at a few different speeds.
+    unsigned int count = (unsigned int)(200 * _scale);
+    unsigned int columns = (unsigned int)ceil(sqrt((float)count));
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        Node* node = character->clone();
+        node->setTranslation(((float)(i % columns) - columns * 0.5f) * 8.0f, 0.0f, ((float)(i / columns) - columns * 0.5f) * 8.0f);
+        _scene->addNode(node);
+
+        AnimationClip* clip = node->getAnimation("animations")->getClip("walking");
+        if (clip)
+        {
+            clip->setRepeatCount(AnimationClip::REPEAT_INDEFINITE);
+            clip->setSpeed(0.8f + (i % 5) * 0.1f);
+            clip->play();
+        }
+        SAFE_RELEASE(node);
+    }
+    SAFE_RELEASE(character);
+}
+
+void BenchmarkGame::createParticles()
+{
+    createScene();
+
+    // Emitters spread on a circle, each emitting its share of the particles continuously.
+    const unsigned int EMITTER_COUNT = 10;
+    const long PARTICLE_ENERGY = 2000;
+    unsigned int particleCount = (unsigned int)(100000 * _scale) / EMITTER_COUNT;
+    for (unsigned int i = 0; i < EMITTER_COUNT; ++i)
+    {
+        ParticleEmitter* emitter = ParticleEmitter::create("res/fire.png", ParticleEmitter::BLEND_ADDITIVE, particleCount);
+        if (emitter == NULL)
+            continue;
+        emitter->setEmissionRate((unsigned int)(particleCount * 1000 / PARTICLE_ENERGY));
+        emitter->setEnergy(PARTICLE_ENERGY, PARTICLE_ENERGY);
+        emitter->setSize(0.5f, 1.0f, 0.1f, 0.2f);
+        emitter->setColor(Vector4(1.0f, 0.6f, 0.2f, 1.0f), Vector4(0.1f, 0.1f, 0.1f, 0.0f), Vector4(0.6f, 0.1f, 0.0f, 0.0f), Vector4::zero());
+        emitter->setPosition(Vector3::zero(), Vector3(2.0f, 0.5f, 2.0f));
+        emitter->setVelocity(Vector3(0.0f, 4.0f, 0.0f), Vector3(2.0f, 2.0f, 2.0f));
+        emitter->start();
+
+        float angle = MATH_PIX2 * i / EMITTER_COUNT;
+        Node* node = _scene->addNode();
+        node->setTranslation(cos(angle) * 15.0f, 0.0f, sin(angle) * 15.0f);
+        node->setParticleEmitter(emitter);
+        SAFE_RELEASE(emitter);
+    }
+}
+
+void BenchmarkGame::createPhysics()
+{
+    createScene();
+
+    Bundle* bundle = Bundle::create("res/box.gpb");
+    Node* box = bundle ? bundle->loadNode("box") : NULL;
+    SAFE_RELEASE(bundle);
+    if (box == NULL || box->getModel() == NULL)
+    {
+        GP_WARN("Failed to load the model of the physics scene.");
+        SAFE_RELEASE(box);
+        return;
+    }
+    box->getModel()->setMaterial("res/benchmark.material#box");
+    const BoundingBox& bounds = box->getModel()->getMesh()->getBoundingBox();
+    float scale = 2.0f / (bounds.max.x - bounds.min.x);
+
+    // The floor.
+    Node* floor = box->clone();
+    floor->setScale(60.0f * scale, scale, 60.0f * scale);
+    floor->setTranslation(0.0f, -1.0f, 0.0f);
+    _scene->addNode(floor);
+    PhysicsRigidBody::Parameters floorParameters(0.0f);
+    floor->setCollisionObject(PhysicsCollisionObject::RIGID_BODY, PhysicsCollisionShape::box(), &floorParameters);
+    SAFE_RELEASE(floor);
+
+    // Columns of boxes dropped from above, which collapse into a pile.
+    unsigned int count = (unsigned int)(1000 * _scale);
+    const unsigned int LAYER_SIZE = 100;
+    PhysicsRigidBody::Parameters parameters(1.0f);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        unsigned int layer = i / LAYER_SIZE;
+        unsigned int j = i % LAYER_SIZE;
+        Node* node = box->clone();
+        node->setTranslation(((float)(j % 10) - 5.0f) * 2.5f + MATH_RANDOM_MINUS1_1() * 0.5f,
+                             5.0f + layer * 2.5f,
+                             ((float)(j / 10) - 5.0f) * 2.5f + MATH_RANDOM_MINUS1_1() * 0.5f);
+        node->rotateY(MATH_RANDOM_0_1() * MATH_PIX2);
+        node->setScale(scale);
+        _scene->addNode(node);
+        node->setCollisionObject(PhysicsCollisionObject::RIGID_BODY, PhysicsCollisionShape::box(), &parameters);
+        SAFE_RELEASE(node);
+    }
+    SAFE_RELEASE(box);
+}
+
+void BenchmarkGame::createForms()
+{
+    Theme* theme = Theme::create("res/editor.theme");
+    if (theme == NULL)
+    {
+        GP_WARN("Failed to load the theme of the forms scene.");
+        return;
+    }
+
+    // A form filled with labels and buttons, which are laid out again as labels change.
+    _form = Form::create("benchmark", theme->getStyle("basic"), Layout::LAYOUT_FLOW);
+    _form->setSize(getWidth(), getHeight());
+    unsigned int count = (unsigned int)(2000 * _scale);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        char text[32];
+        if (i % 4 == 0)
+        {
+            Button* button = Button::create(NULL, theme->getStyle("buttonStyle"));
+            sprintf(text, "Button %u", i);
+            button->setText(text);
+            button->setSize(120, 30);
+            _form->addControl(button);
+            SAFE_RELEASE(button);
+        }
+        else
+        {
+            Label* label = Label::create(NULL, theme->getStyle("basic"));
+            sprintf(text, "Label %u", i);
+            label->setText(text);
+            label->setSize(120, 30);
+            _form->addControl(label);
+            _labels.push_back(label);
+            SAFE_RELEASE(label);
+        }
+    }
+    SAFE_RELEASE(theme);
+}
+
+void BenchmarkGame::createTerrain()
+{
+    createScene();
+
+    // Rolling hills generated from a sum of waves.
+    const unsigned int SIZE = 513;
+    HeightField* heightField = HeightField::create(SIZE, SIZE);
+    float* heights = heightField->getArray();
+    for (unsigned int z = 0; z < SIZE; ++z)
+    {
+        for (unsigned int x = 0; x < SIZE; ++x)
+        {
+            float h = sin(x * 0.02f) * cos(z * 0.03f) * 0.5f + sin(x * 0.11f + z * 0.07f) * 0.1f;
+            heights[z * SIZE + x] = (h + 0.6f) * 0.8f;
+        }
+    }
+    // The terrain takes ownership of the height field.
+    Terrain* terrain = Terrain::create(heightField, Vector3(2.0f, 120.0f, 2.0f), 32, 4, 0.1f);
+    if (terrain == NULL)
+    {
+        GP_WARN("Failed to create the terrain of the terrain scene.");
+        return;
+    }
+    terrain->setLayer(0, "res/asphalt.png", Vector2(128, 128));
+
+    Node* node = _scene->addNode("terrain");
+    node->setTerrain(terrain);
+    SAFE_RELEASE(terrain);
+}
+
+void BenchmarkGame::updateCamera(float t)
+{
+    Node* cameraNode = _scene ? _scene->findNode("camera") : NULL;
+    if (cameraNode == NULL || _sceneIndex >= _scenes.size())
+        return;
+
+    // Orbit the content of the scene, or fly over the terrain.
+    Vector3 eye;
+    Vector3 target;
+    float angle = t * MATH_PIX2;
+    switch (_scenes[_sceneIndex])
+    {
+    case MODELS:
+        eye.set(cos(angle) * 150.0f, 40.0f, sin(angle) * 150.0f);
+        break;
+    case CROWD:
+        eye.set(cos(angle) * 90.0f, 25.0f, sin(angle) * 90.0f);
+        target.set(0.0f, 5.0f, 0.0f);
+        break;
+    case PARTICLES:
+        eye.set(cos(angle) * 40.0f, 15.0f, sin(angle) * 40.0f);
+        target.set(0.0f, 5.0f, 0.0f);
+        break;
+    case PHYSICS:
+        eye.set(cos(angle) * 50.0f, 30.0f, sin(angle) * 50.0f);
+        break;
+    case TERRAIN:
+        {
+            Terrain* terrain = _scene->findNode("terrain") ? _scene->findNode("terrain")->getTerrain() : NULL;
+            eye.set(-400.0f + t * 800.0f, 0.0f, sin(angle) * 200.0f);
+            target.set(eye.x + 50.0f, 0.0f, sin(angle + 0.1f) * 200.0f);
+            eye.y = (terrain ? terrain->getHeight(eye.x, eye.z) : 0.0f) + 30.0f;
+            target.y = eye.y - 10.0f;
+        }
+        break;
+    default:
+        return;
+    }
+
+    Matrix view;
+    Matrix::createLookAt(eye, target, Vector3::unitY(), &view);
+    view.invert();
+    Quaternion rotation;
+    view.getRotation(&rotation);
+    cameraNode->setRotation(rotation);
+    cameraNode->setTranslation(eye);
+}
+
+void BenchmarkGame::reportScene()
+{
+    std::vector<float> times(_frameTimes);
+    std::sort(times.begin(), times.end());
+    double total = 0.0;
+    for (unsigned int i = 0; i < times.size(); ++i)
+        total += times[i];
+    float mean = times.empty() ? 0.0f : (float)(total / times.size());
+
+    char line[256];
+    sprintf(line, "%-10s %8u %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f\n", __sceneNames[_scenes[_sceneIndex]], (unsigned int)times.size(),
+        mean, getPercentile(times, 50), getPercentile(times, 90), getPercentile(times, 95), getPercentile(times, 99), times.empty() ? 0.0f : times.back());
+    _report += line;
+
+    // The time of each stage, per measured frame.
+    unsigned int frames = _frameCount > 0 ? _frameCount : 1;
+    for (unsigned int i = 0; i < sizeof(__stageNames) / sizeof(__stageNames[0]); ++i)
+    {
+        double time = Profiler::getTotalTime(__stageNames[i]);
+        if (time > 0.0)
+        {
+            sprintf(line, "    %-30s %8.3f ms/frame\n", __stageNames[i], time / frames);
+            _report += line;
+        }
+    }
+}
+
+void BenchmarkGame::finish()
+{
+    print("%s", _report.c_str());
+
+    Stream* stream = FileSystem::open(_reportPath.c_str(), FileSystem::WRITE);
+    if (stream)
+    {
+        stream->write(_report.c_str(), 1, _report.size());
+        stream->close();
+        SAFE_DELETE(stream);
+    }
+    else
+    {
+        GP_WARN("Failed to write the benchmark report to '%s'.", _reportPath.c_str());
+    }
+    exit();
+}
+
+bool BenchmarkGame::updateEmitter(Node* node, float elapsedTime)
+{
+    ParticleEmitter* emitter = node->getParticleEmitter();
+    if (emitter)
+        emitter->update(elapsedTime);
+    return true;
+}
+
+bool BenchmarkGame::drawOpaque(Node* node)
+{
+    Model* model = node->getModel();
+    if (model)
+        model->draw();
+    Terrain* terrain = node->getTerrain();
+    if (terrain)
+        terrain->draw();
+    return true;
+}
+
+bool BenchmarkGame::drawTransparent(Node* node)
+{
+    ParticleEmitter* emitter = node->getParticleEmitter();
+    if (emitter)
+        emitter->draw();
+    return true;
+}
@@ -0,0 +1,142 @@
+#ifndef BENCHMARKGAME_H_
+#define BENCHMARKGAME_H_
+
+#include "gameplay.h"
+
+using namespace gameplay;
+
+/**
+ * Sample game that measures the performance of the engine with a suite of stress scenes.
+ *
+ * Each scene is run for a fixed number of frames, after a few warm-up frames, with a fixed
+ * frame time and a camera that follows a fixed path, so every run draws and simulates the
+ * same frames. The percentiles of the frame times and the time spent in each stage of
+ * Game::frame are written to a report, which can be compared between engine versions.
+ *
+ * The scenes, frame counts and the scale of the scenes are set in the benchmark namespace
+ * of game.config.
+ */
+class BenchmarkGame: public Game
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    BenchmarkGame();
+
+    /**
+     * Destructor.
+     */
+    virtual ~BenchmarkGame();
+
+    /**
+     * @see Game::keyEvent
+     */
+    void keyEvent(Keyboard::KeyEvent evt, int key);
+
+protected:
+
+    /**
+     * @see Game::initialize
+     */
+    void initialize();
+
+    /**
+     * @see Game::finalize
+     */
+    void finalize();
+
+    /**
+     * @see Game::update
+     */
+    void update(float elapsedTime);
+
+    /**
+     * @see Game::render
+     */
+    void render(float elapsedTime);
+
+private:
+
+    /**
+     * The stress scenes.
+     */
+    enum SceneType
+    {
+        MODELS,
+        CROWD,
+        PARTICLES,
+        PHYSICS,
+        FORMS,
+        TERRAIN,
+        SCENE_TYPE_COUNT
+    };
+
+    /**
+     * Creates the content of a scene.
+     */
+    void loadScene(SceneType type);
+
+    /**
+     * Releases the content of the current scene.
+     */
+    void unloadScene();
+
+    void createModels();
+
+    void createCrowd();
+
+    void createParticles();
+
+    void createPhysics();
+
+    void createForms();
+
+    void createTerrain();
+
+    /**
+     * Creates a scene with a camera and a light.
+     */
+    void createScene();
+
+    /**
+     * Moves the camera along the path of the current scene.
+     *
+     * @param t The progress along the path, from 0 to 1.
+     */
+    void updateCamera(float t);
+
+    /**
+     * Adds the results of the current scene to the report.
+     */
+    void reportScene();
+
+    /**
+     * Writes the report and exits.
+     */
+    void finish();
+
+    bool updateEmitter(Node* node, float elapsedTime);
+
+    bool drawOpaque(Node* node);
+
+    bool drawTransparent(Node* node);
+
+    Font* _font;
+    Scene* _scene;
+    Form* _form;
+    std::vector<Label*> _labels;
+    std::vector<SceneType> _scenes;
+    unsigned int _sceneIndex;
+    unsigned int _frame;
+    unsigned int _frameCount;
+    unsigned int _warmupFrameCount;
+    float _scale;
+    double _lastFrameTime;
+    std::vector<float> _frameTimes;
+    std::string _reportPath;
+    std::string _report;
+};
+
+#endif
@@ -0,0 +1,158 @@
+#include "LoadBenchmarkGame.h"
+
+// Declare our game instance
+LoadBenchmarkGame game;
+
+/**
+ * A phase of loading, and the profiler scope that measures it.
+ */
+struct LoadPhase
+{
+    const char* name;
+    const char* scope;
+};
+
+// Phases are measured by their own scope, so a phase includes the phases it calls, such as
+// the image decoding and upload of a texture.
+static const LoadPhase __phases[] =
+{
+    { "Scene file", "SceneLoader::load" },
+    { "Bundle open", "Bundle::create" },
+    { "Bundle scene", "Bundle::loadScene" },
+    { "File reads", "FileSystem::readAll" },
+    { "Properties parsing", "Properties::create" },
+    { "Mesh creation", "Bundle::loadMesh" },
+    { "Vertex uploads", "Mesh::setVertexData" },
+    { "Index uploads", "MeshPart::setIndexData" },
+    { "Materials", "Material::create" },
+    { "Effect compilation", "Effect::compile" },
+    { "Textures", "Texture::create" },
+    { "Image decoding", "Image::load" },
+    { "Texture uploads", "Texture::upload" },
+    { "Physics shapes", "PhysicsController::createShape" }
+};
+
+#define PHASE_COUNT (sizeof(__phases) / sizeof(__phases[0]))
+
+LoadBenchmarkGame::LoadBenchmarkGame()
+{
+}
+
+LoadBenchmarkGame::~LoadBenchmarkGame()
+{
+}
+
+void LoadBenchmarkGame::initialize()
+{
+    std::string filePath = "res/load.scene";
+    unsigned int iterations = 20;
+    std::string reportPath = "loadbenchmark.txt";
+    Properties* config = getConfig()->getNamespace("loadbenchmark", true);
+    if (config)
+    {
+        if (config->exists("file"))
+            filePath = config->getString("file");
+        if (config->exists("iterations"))
+            iterations = std::max(config->getInt("iterations"), 1);
+        if (config->exists("report"))
+            reportPath = config->getString("report");
+    }
+
+    // Destroy textures as soon as they are released, so each load decodes and uploads them.
+    unsigned int cacheBudget = Texture::getCacheBudget();
+    Texture::setCacheBudget(0);
+    Texture::trimCache();
+    bool profilerEnabled = Profiler::isEnabled();
+    Profiler::setEnabled(true);
+
+    std::vector<double> loadTimes;
+    std::vector<double> phaseTimes(PHASE_COUNT, 0.0);
+    std::vector<unsigned int> phaseCounts(PHASE_COUNT, 0);
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        Profiler::clear();
+        double start = getAbsoluteTime();
+        Scene* scene = Scene::load(filePath.c_str());
+        double time = getAbsoluteTime() - start;
+        if (scene == NULL)
+        {
+            GP_WARN("Failed to load '%s'.", filePath.c_str());
+            break;
+        }
+        SAFE_RELEASE(scene);
+        Texture::trimCache();
+
+        loadTimes.push_back(time);
+        for (unsigned int p = 0; p < PHASE_COUNT; ++p)
+        {
+            unsigned int count = 0;
+            phaseTimes[p] += Profiler::getTotalTime(__phases[p].scope, &count);
+            phaseCounts[p] += count;
+        }
+    }
+
+    Profiler::clear();
+    Profiler::setEnabled(profilerEnabled);
+    Texture::setCacheBudget(cacheBudget);
+
+    // The first load also reads the files from the disk rather than the file cache of the
+    // system, so it is reported on its own as well.
+    char line[256];
+    unsigned int loads = (unsigned int)loadTimes.size();
+    double total = 0.0;
+    double fastest = 0.0;
+    double slowest = 0.0;
+    for (unsigned int i = 0; i < loads; ++i)
+    {
+        total += loadTimes[i];
+        if (i == 0 || loadTimes[i] < fastest)
+            fastest = loadTimes[i];
+        if (loadTimes[i] > slowest)
+            slowest = loadTimes[i];
+    }
+    sprintf(line, "File: %s\nLoads: %u\n", filePath.c_str(), loads);
+    std::string report = line;
+    if (loads > 0)
+    {
+        sprintf(line, "%-20s %10s %10s %10s %10s\n%-20s %10.2f %10.2f %10.2f %10.2f\n\n",
+            "load (ms)", "first", "mean", "min", "max", "", loadTimes[0], total / loads, fastest, slowest);
+        report += line;
+        sprintf(line, "%-20s %-32s %10s %12s\n", "phase", "scope", "calls", "ms/load");
+        report += line;
+        for (unsigned int p = 0; p < PHASE_COUNT; ++p)
+        {
+            if (phaseCounts[p] == 0)
+                continue;
+            sprintf(line, "%-20s %-32s %10.1f %12.3f\n", __phases[p].name, __phases[p].scope,
+                (float)phaseCounts[p] / loads, phaseTimes[p] / loads);
+            report += line;
+        }
+    }
+
+    print("%s", report.c_str());
+    Stream* stream = FileSystem::open(reportPath.c_str(), FileSystem::WRITE);
+    if (stream)
+    {
+        stream->write(report.c_str(), 1, report.size());
+        stream->close();
+        SAFE_DELETE(stream);
+    }
+    else
+    {
+        GP_WARN("Failed to write the load benchmark report to '%s'.", reportPath.c_str());
+    }
+    exit();
+}
+
+void LoadBenchmarkGame::finalize()
+{
+}
+
+void LoadBenchmarkGame::update(float elapsedTime)
+{
+}
+
+void LoadBenchmarkGame::render(float elapsedTime)
+{
+    clear(CLEAR_COLOR, Vector4::zero(), 1.0f, 0);
+}
@@ -0,0 +1,57 @@
+#ifndef LOADBENCHMARKGAME_H_
+#define LOADBENCHMARKGAME_H_
+
+#include "gameplay.h"
+
+using namespace gameplay;
+
+/**
+ * Sample game that measures the time to load a scene.
+ *
+ * A .scene or .gpb file is loaded and released a number of times, and the time of each load
+ * is written to a report, broken down by phase with the scopes the engine records with the
+ * Profiler: file reads, parsing, mesh creation, buffer uploads, materials, effect compilation,
+ * image decoding, texture uploads and physics shapes. The texture cache is disabled, so every
+ * load creates its textures again.
+ *
+ * The file, the number of loads and the report are set in the loadbenchmark namespace of
+ * game.config. It runs on build servers with the headless mode of the platform.
+ */
+class LoadBenchmarkGame: public Game
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    LoadBenchmarkGame();
+
+    /**
+     * Destructor.
+     */
+    virtual ~LoadBenchmarkGame();
+
+protected:
+
+    /**
+     * @see Game::initialize
+     */
+    void initialize();
+
+    /**
+     * @see Game::finalize
+     */
+    void finalize();
+
+    /**
+     * @see Game::update
+     */
+    void update(float elapsedTime);
+
+    /**
+     * @see Game::render
+     */
+    void render(float elapsedTime);
+};
+
+#endif
@@ -0,0 +1,303 @@
+#include "MicroBenchmarkGame.h"
+
+// Declare our game instance
+MicroBenchmarkGame game;
+
+// The number of random inputs each operation cycles through (a power of two).
+#define INPUT_COUNT 256
+#define INPUT_MASK (INPUT_COUNT - 1)
+
+#ifdef USE_NEON
+#define MATH_IMPLEMENTATION "NEON"
+#elif defined(USE_AVX)
+#define MATH_IMPLEMENTATION "AVX"
+#elif defined(USE_SSE)
+#define MATH_IMPLEMENTATION "SSE"
+#else
+#define MATH_IMPLEMENTATION "scalar"
+#endif
+
+/**
+ * Runs an operation the specified number of times.
+ */
+typedef void (*BenchmarkFunction)(unsigned int iterations);
+
+/**
+ * An operation to measure.
+ */
+struct Benchmark
+{
+    const char* name;
+    BenchmarkFunction function;
+    unsigned int iterationDivisor;  // Divides the number of iterations of slow operations.
+};
+
+static Matrix __matrices[INPUT_COUNT];
+static Quaternion __quaternions[INPUT_COUNT];
+static Vector3 __vectors[INPUT_COUNT];
+static BoundingSphere __spheres[INPUT_COUNT];
+static Frustum __frustum;
+static Curve* __curve = NULL;
+
+// Results are accumulated here, so the operations are not optimized away.
+static volatile float __sink = 0.0f;
+
+static void initializeInputs()
+{
+    srand(1);
+    for (unsigned int i = 0; i < INPUT_COUNT; ++i)
+    {
+        Quaternion rotation(Vector3(MATH_RANDOM_MINUS1_1(), MATH_RANDOM_MINUS1_1(), MATH_RANDOM_MINUS1_1()), MATH_RANDOM_0_1() * MATH_PIX2);
+        Vector3 translation(MATH_RANDOM_MINUS1_1() * 100.0f, MATH_RANDOM_MINUS1_1() * 100.0f, MATH_RANDOM_MINUS1_1() * 100.0f);
+        Matrix::createRotation(rotation, &__matrices[i]);
+        __matrices[i].translate(translation);
+        __matrices[i].scale(0.5f + MATH_RANDOM_0_1());
+
+        __quaternions[i] = rotation;
+        __vectors[i].set(MATH_RANDOM_MINUS1_1(), MATH_RANDOM_MINUS1_1(), MATH_RANDOM_MINUS1_1());
+        __spheres[i].set(translation, 1.0f + MATH_RANDOM_0_1() * 10.0f);
+    }
+
+    Matrix projection;
+    Matrix view;
+    Matrix::createPerspective(45.0f, 16.0f / 9.0f, 1.0f, 100.0f, &projection);
+    Matrix::createLookAt(Vector3(0, 0, 50), Vector3::zero(), Vector3::unitY(), &view);
+    __frustum.set(projection * view);
+
+    // A curve with the keys of a typical animation channel: a rotation, translation and scale.
+    const unsigned int POINT_COUNT = 64;
+    __curve = Curve::create(POINT_COUNT, 10);
+    float value[10];
+    for (unsigned int i = 0; i < POINT_COUNT; ++i)
+    {
+        const Quaternion& q = __quaternions[i];
+        value[0] = value[1] = value[2] = 1.0f;
+        value[3] = q.x;
+        value[4] = q.y;
+        value[5] = q.z;
+        value[6] = q.w;
+        value[7] = __vectors[i].x;
+        value[8] = __vectors[i].y;
+        value[9] = __vectors[i].z;
+        __curve->setPoint(i, (float)i / (POINT_COUNT - 1), value, Curve::LINEAR);
+    }
+}
+
+static void benchmarkMatrixMultiply(unsigned int iterations)
+{
+    Matrix dst;
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        Matrix::multiply(__matrices[i & INPUT_MASK], __matrices[(i + 1) & INPUT_MASK], &dst);
+        __sink += dst.m[12];
+    }
+}
+
+static void benchmarkMatrixInvert(unsigned int iterations)
+{
+    Matrix dst;
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        __matrices[i & INPUT_MASK].invert(&dst);
+        __sink += dst.m[12];
+    }
+}
+
+static void benchmarkMatrixTransformPoint(unsigned int iterations)
+{
+    Vector3 dst;
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        __matrices[i & INPUT_MASK].transformPoint(__vectors[(i + 1) & INPUT_MASK], &dst);
+        __sink += dst.x;
+    }
+}
+
+static void benchmarkMatrixTransformPoints(unsigned int iterations)
+{
+    // An operation is one point, transformed in batches of all the inputs.
+    Vector3 dst[INPUT_COUNT];
+    for (unsigned int i = 0; i < iterations; i += INPUT_COUNT)
+    {
+        __matrices[(i / INPUT_COUNT) & INPUT_MASK].transformPoints(__vectors, dst, INPUT_COUNT);
+        __sink += dst[(i / INPUT_COUNT) & INPUT_MASK].x;
+    }
+}
+
+static void benchmarkQuaternionSlerp(unsigned int iterations)
+{
+    Quaternion dst;
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        Quaternion::slerp(__quaternions[i & INPUT_MASK], __quaternions[(i + 1) & INPUT_MASK], (float)(i & INPUT_MASK) / INPUT_COUNT, &dst);
+        __sink += dst.w;
+    }
+}
+
+static void benchmarkVector3Cross(unsigned int iterations)
+{
+    Vector3 dst;
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        Vector3::cross(__vectors[i & INPUT_MASK], __vectors[(i + 1) & INPUT_MASK], &dst);
+        __sink += dst.x;
+    }
+}
+
+static void benchmarkVector3Normalize(unsigned int iterations)
+{
+    Vector3 dst;
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        __vectors[i & INPUT_MASK].normalize(&dst);
+        __sink += dst.x;
+    }
+}
+
+static void benchmarkVector3Arithmetic(unsigned int iterations)
+{
+    Vector3 dst;
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        const Vector3& a = __vectors[i & INPUT_MASK];
+        const Vector3& b = __vectors[(i + 1) & INPUT_MASK];
+        dst = (a + b) * 0.5f - a;
+        __sink += dst.x + Vector3::dot(a, b);
+    }
+}
+
+static void benchmarkFrustumIntersects(unsigned int iterations)
+{
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        if (__frustum.intersects(__spheres[i & INPUT_MASK]))
+            ++count;
+    }
+    __sink += (float)count;
+}
+
+static void benchmarkBoundingSphereMerge(unsigned int iterations)
+{
+    BoundingSphere dst;
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        dst = __spheres[i & INPUT_MASK];
+        dst.merge(__spheres[(i + 1) & INPUT_MASK]);
+        __sink += dst.radius;
+    }
+}
+
+static void benchmarkCurveEvaluate(unsigned int iterations)
+{
+    float dst[10];
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        __curve->evaluate((float)(i & INPUT_MASK) / INPUT_MASK, dst);
+        __sink += dst[6];
+    }
+}
+
+static void benchmarkPropertiesCreate(unsigned int iterations)
+{
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        Properties* properties = Properties::create("res/benchmark.material");
+        if (properties)
+            __sink += (float)strlen(properties->getNamespace());
+        SAFE_DELETE(properties);
+    }
+}
+
+static const Benchmark __benchmarks[] =
+{
+    { "Matrix::multiply", &benchmarkMatrixMultiply, 1 },
+    { "Matrix::invert", &benchmarkMatrixInvert, 1 },
+    { "Matrix::transformPoint", &benchmarkMatrixTransformPoint, 1 },
+    { "Matrix::transformPoints", &benchmarkMatrixTransformPoints, 1 },
+    { "Quaternion::slerp", &benchmarkQuaternionSlerp, 1 },
+    { "Vector3::cross", &benchmarkVector3Cross, 1 },
+    { "Vector3::normalize", &benchmarkVector3Normalize, 1 },
+    { "Vector3 arithmetic", &benchmarkVector3Arithmetic, 1 },
+    { "Frustum::intersects", &benchmarkFrustumIntersects, 1 },
+    { "BoundingSphere::merge", &benchmarkBoundingSphereMerge, 1 },
+    { "Curve::evaluate", &benchmarkCurveEvaluate, 1 },
+    { "Properties::create", &benchmarkPropertiesCreate, 10000 }
+};
+
+MicroBenchmarkGame::MicroBenchmarkGame()
+{
+}
+
+MicroBenchmarkGame::~MicroBenchmarkGame()
+{
+}
+
+void MicroBenchmarkGame::initialize()
+{
+    unsigned int iterations = 10000000;
+    std::string reportPath = "microbenchmark.txt";
+    Properties* config = getConfig()->getNamespace("microbenchmark", true);
+    if (config)
+    {
+        if (config->exists("iterations"))
+            iterations = (unsigned int)config->getInt("iterations");
+        if (config->exists("report"))
+            reportPath = config->getString("report");
+    }
+
+    initializeInputs();
+
+    char line[256];
+    sprintf(line, "Math implementation: %s\n%-26s %12s %12s %12s\n", MATH_IMPLEMENTATION, "operation", "iterations", "ns/op", "Mops/s");
+    std::string report = line;
+    for (unsigned int i = 0; i < sizeof(__benchmarks) / sizeof(__benchmarks[0]); ++i)
+    {
+        const Benchmark& benchmark = __benchmarks[i];
+        unsigned int count = std::max(iterations / benchmark.iterationDivisor, 1u);
+
+        // Warm the caches, then take the fastest of a few runs.
+        benchmark.function(std::max(count / 10, 1u));
+        double best = 0.0;
+        for (unsigned int run = 0; run < 3; ++run)
+        {
+            double start = getAbsoluteTime();
+            benchmark.function(count);
+            double time = getAbsoluteTime() - start;
+            if (run == 0 || time < best)
+                best = time;
+        }
+
+        double nanoseconds = best * 1000000.0 / count;
+        sprintf(line, "%-26s %12u %12.2f %12.2f\n", benchmark.name, count, nanoseconds, nanoseconds > 0.0 ? 1000.0 / nanoseconds : 0.0);
+        report += line;
+    }
+    SAFE_RELEASE(__curve);
+
+    print("%s", report.c_str());
+    Stream* stream = FileSystem::open(reportPath.c_str(), FileSystem::WRITE);
+    if (stream)
+    {
+        stream->write(report.c_str(), 1, report.size());
+        stream->close();
+        SAFE_DELETE(stream);
+    }
+    else
+    {
+        GP_WARN("Failed to write the micro-benchmark report to '%s'.", reportPath.c_str());
+    }
+    exit();
+}
+
+void MicroBenchmarkGame::finalize()
+{
+}
+
+void MicroBenchmarkGame::update(float elapsedTime)
+{
+}
+
+void MicroBenchmarkGame::render(float elapsedTime)
+{
+    clear(CLEAR_COLOR, Vector4::zero(), 1.0f, 0);
+}
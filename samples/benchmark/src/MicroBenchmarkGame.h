@@ -0,0 +1,55 @@
+#ifndef MICROBENCHMARKGAME_H_
+#define MICROBENCHMARKGAME_H_
+
+#include "gameplay.h"
+
+using namespace gameplay;
+
+/**
+ * Sample game that measures the throughput of the math classes and other core operations.
+ *
+ * Each operation is run many times over a small set of random inputs, and the time per
+ * operation is written to a report, along with the math implementation the engine was
+ * built with (NEON, SSE or scalar, see MathUtil). Building with and without USE_SSE or
+ * USE_NEON and comparing the reports validates the vectorized implementations.
+ *
+ * The number of iterations is set in the microbenchmark namespace of game.config.
+ */
+class MicroBenchmarkGame: public Game
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    MicroBenchmarkGame();
+
+    /**
+     * Destructor.
+     */
+    virtual ~MicroBenchmarkGame();
+
+protected:
+
+    /**
+     * @see Game::initialize
+     */
+    void initialize();
+
+    /**
+     * @see Game::finalize
+     */
+    void finalize();
+
+    /**
+     * @see Game::update
+     */
+    void update(float elapsedTime);
+
+    /**
+     * @see Game::render
+     */
+    void render(float elapsedTime);
+};
+
+#endif
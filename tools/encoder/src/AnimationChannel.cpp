@@ -1,12 +1,20 @@
 #include "Base.h"
 #include "AnimationChannel.h"
 #include "Transform.h"
+#include "Quaternion.h"
+
+// The formats of the key values of a channel in the bundle (version 1.6).
+#define CHANNEL_FORMAT_FLOAT        0
+#define CHANNEL_FORMAT_COMPRESSED   1
+
+// The range of the three smallest components of a unit quaternion.
+#define QUATERNION_COMPONENT_RANGE  0.70710678f
 
 namespace gameplay
 {
 
 AnimationChannel::AnimationChannel(void) :
-    _targetAttrib(0)
+    _targetAttrib(0), _compressed(false)
 {
 }
 
@@ -28,6 +36,13 @@ void AnimationChannel::writeBinary(FILE* file)
     Object::writeBinary(file);
     write(_targetId, file);
     write(_targetAttrib, file);
+    if (_compressed)
+    {
+        write((unsigned int)CHANNEL_FORMAT_COMPRESSED, file);
+        writeCompressedBinary(file);
+        return;
+    }
+    write((unsigned int)CHANNEL_FORMAT_FLOAT, file);
     write((unsigned int)_keytimes.size(), file);
     for (std::vector<float>::const_iterator i = _keytimes.begin(); i != _keytimes.end(); ++i)
     {
@@ -175,6 +190,290 @@ void AnimationChannel::removeDuplicates()
     LOG(3, "      Removed %d duplicate keyframes from channel.\n", startCount- _keytimes.size());
 }
 
+void AnimationChannel::compress(float translationTolerance, float rotationTolerance, float scaleTolerance)
+{
+    size_t propSize = Transform::getPropertySize(_targetAttrib);
+    if (propSize == 0 || _keytimes.empty() || (!_interpolations.empty() && _interpolations[0] != LINEAR))
+    {
+        return;
+    }
+
+    LOG(3, "      Compressing channel with target attribute: %u.\n", _targetAttrib);
+
+    const std::vector<float> tolerances = getTolerances(translationTolerance, rotationTolerance, scaleTolerance);
+    size_t startCount = _keytimes.size();
+    if (startCount > 2 && isConstant(&_keyValues[0], translationTolerance, rotationTolerance, scaleTolerance))
+    {
+        // Keep the first and last key times, so the channel lasts as long as before.
+        LOG(3, "      Collapsing constant channel.\n");
+        std::vector<float> keytimes;
+        keytimes.push_back(_keytimes.front());
+        keytimes.push_back(_keytimes.back());
+        _keytimes.swap(keytimes);
+        _keyValues.resize(propSize * 2);
+        std::copy(_keyValues.begin(), _keyValues.begin() + propSize, _keyValues.begin() + propSize);
+        if (_interpolations.size() > 1)
+        {
+            setInterpolation(LINEAR);
+        }
+        _tangentsIn.clear();
+        _tangentsOut.clear();
+    }
+    else if (startCount > 2)
+    {
+        // Keep the first keyframe, and from each kept keyframe skip to the furthest one
+        // that the keyframes in between can be interpolated to.
+        std::vector<size_t> kept;
+        kept.push_back(0);
+        size_t begin = 0;
+        while (begin < startCount - 1)
+        {
+            size_t end = begin + 1;
+            while (end + 1 < startCount && isReproduced(begin, end + 1, propSize, tolerances))
+            {
+                ++end;
+            }
+            kept.push_back(end);
+            begin = end;
+        }
+
+        std::vector<float> keytimes;
+        std::vector<float> keyValues;
+        for (size_t i = 0; i < kept.size(); ++i)
+        {
+            keytimes.push_back(_keytimes[kept[i]]);
+            keyValues.insert(keyValues.end(), _keyValues.begin() + kept[i] * propSize, _keyValues.begin() + (kept[i] + 1) * propSize);
+        }
+        _keytimes.swap(keytimes);
+        _keyValues.swap(keyValues);
+        if (_interpolations.size() > 1)
+        {
+            setInterpolation(LINEAR);
+        }
+        _tangentsIn.clear();
+        _tangentsOut.clear();
+    }
+    _compressed = true;
+
+    LOG(3, "      Removed %d keyframes from channel.\n", (int)(startCount - _keytimes.size()));
+}
+
+int AnimationChannel::getQuaternionOffset() const
+{
+    switch (_targetAttrib)
+    {
+    case Transform::ANIMATE_ROTATE:
+    case Transform::ANIMATE_ROTATE_TRANSLATE:
+        return 0;
+    case Transform::ANIMATE_SCALE_ROTATE_TRANSLATE:
+    case Transform::ANIMATE_SCALE_ROTATE:
+        return 3;
+    default:
+        return -1;
+    }
+}
+
+std::vector<float> AnimationChannel::getTolerances(float translationTolerance, float rotationTolerance, float scaleTolerance) const
+{
+    // The components of each attribute are in the order scale, rotation, translation.
+    size_t scaleSize = 0;
+    size_t rotationSize = 0;
+    switch (_targetAttrib)
+    {
+    case Transform::ANIMATE_SCALE_ROTATE_TRANSLATE:
+    case Transform::ANIMATE_SCALE_ROTATE:
+        scaleSize = 3;
+        rotationSize = 4;
+        break;
+    case Transform::ANIMATE_SCALE_TRANSLATE:
+    case Transform::ANIMATE_SCALE:
+        scaleSize = 3;
+        break;
+    case Transform::ANIMATE_SCALE_X:
+    case Transform::ANIMATE_SCALE_Y:
+    case Transform::ANIMATE_SCALE_Z:
+        scaleSize = 1;
+        break;
+    case Transform::ANIMATE_ROTATE_TRANSLATE:
+    case Transform::ANIMATE_ROTATE:
+        rotationSize = 4;
+        break;
+    default:
+        break;
+    }
+
+    std::vector<float> tolerances(Transform::getPropertySize(_targetAttrib), translationTolerance);
+    for (size_t i = 0; i < tolerances.size() && i < scaleSize + rotationSize; ++i)
+    {
+        tolerances[i] = i < scaleSize ? scaleTolerance : rotationTolerance;
+    }
+    return tolerances;
+}
+
+bool AnimationChannel::isWithinTolerances(const float* a, const float* b, const std::vector<float>& tolerances) const
+{
+    const int quaternionOffset = getQuaternionOffset();
+    for (size_t j = 0; j < tolerances.size(); ++j)
+    {
+        if ((int)j == quaternionOffset)
+        {
+            float sign = a[j] * b[j] + a[j + 1] * b[j + 1] + a[j + 2] * b[j + 2] + a[j + 3] * b[j + 3] < 0.0f ? -1.0f : 1.0f;
+            for (size_t k = j; k < j + 4; ++k)
+            {
+                if (fabs(a[k] - sign * b[k]) > tolerances[k])
+                    return false;
+            }
+            j += 3;
+        }
+        else if (fabs(a[j] - b[j]) > tolerances[j])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AnimationChannel::isConstant(const float* value, float translationTolerance, float rotationTolerance, float scaleTolerance) const
+{
+    const std::vector<float> tolerances = getTolerances(translationTolerance, rotationTolerance, scaleTolerance);
+    const size_t propSize = tolerances.size();
+    if (propSize == 0)
+    {
+        return false;
+    }
+    for (size_t i = 0, count = _keytimes.size(); i < count; ++i)
+    {
+        if (!isWithinTolerances(value, &_keyValues[i * propSize], tolerances))
+            return false;
+    }
+    return true;
+}
+
+bool AnimationChannel::isReproduced(size_t begin, size_t end, size_t propSize, const std::vector<float>& tolerances) const
+{
+    const int quaternionOffset = getQuaternionOffset();
+    const float* from = &_keyValues[begin * propSize];
+    const float* to = &_keyValues[end * propSize];
+    const float duration = _keytimes[end] - _keytimes[begin];
+
+    std::vector<float> interpolated(propSize);
+    for (size_t i = begin + 1; i < end; ++i)
+    {
+        const float t = duration > 0.0f ? (_keytimes[i] - _keytimes[begin]) / duration : 0.0f;
+        for (size_t j = 0; j < propSize; ++j)
+        {
+            if ((int)j == quaternionOffset)
+            {
+                // Rotations are compared with the slerp the runtime evaluates.
+                Quaternion q;
+                Quaternion::slerp(Quaternion(from[j], from[j + 1], from[j + 2], from[j + 3]), Quaternion(to[j], to[j + 1], to[j + 2], to[j + 3]), t, &q);
+                interpolated[j] = q.x;
+                interpolated[j + 1] = q.y;
+                interpolated[j + 2] = q.z;
+                interpolated[j + 3] = q.w;
+                j += 3;
+            }
+            else
+            {
+                interpolated[j] = from[j] + (to[j] - from[j]) * t;
+            }
+        }
+        if (!isWithinTolerances(&interpolated[0], &_keyValues[i * propSize], tolerances))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Quantizes a value within a range to 16 bits.
+ */
+static unsigned short quantize(float value, float min, float extent)
+{
+    if (extent <= 0.0f)
+        return 0;
+    float s = std::min(std::max((value - min) / extent, 0.0f), 1.0f);
+    return (unsigned short)(s * 65535.0f + 0.5f);
+}
+
+/**
+ * Writes a quaternion as its three smallest components, as 15 bits each, and the index of
+ * the largest component in the top bits of the first two. The largest component is made
+ * positive, so that it can be restored from the length of the quaternion.
+ */
+static void packQuaternion(const float* q, unsigned short* dst)
+{
+    unsigned int largest = 0;
+    for (unsigned int i = 1; i < 4; ++i)
+    {
+        if (fabs(q[i]) > fabs(q[largest]))
+            largest = i;
+    }
+    float length = sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    float scale = (q[largest] < 0.0f ? -1.0f : 1.0f) / (length > 0.0f ? length : 1.0f);
+
+    for (unsigned int i = 0, j = 0; i < 4; ++i)
+    {
+        if (i == largest)
+            continue;
+        float s = (q[i] * scale / QUATERNION_COMPONENT_RANGE) * 0.5f + 0.5f;
+        dst[j++] = (unsigned short)(std::min(std::max(s, 0.0f), 1.0f) * 32767.0f + 0.5f);
+    }
+    dst[0] |= (unsigned short)((largest >> 1) << 15);
+    dst[1] |= (unsigned short)((largest & 1) << 15);
+}
+
+void AnimationChannel::writeCompressedBinary(FILE* file)
+{
+    const size_t propSize = Transform::getPropertySize(_targetAttrib);
+    const size_t keyCount = _keytimes.size();
+    const int quaternionOffset = getQuaternionOffset();
+
+    write((unsigned int)keyCount, file);
+    for (std::vector<float>::const_iterator i = _keytimes.begin(); i != _keytimes.end(); ++i)
+    {
+        write((unsigned int)*i, file);
+    }
+
+    // The minimum and extent of every component (unused by the quaternion's).
+    std::vector<float> ranges(propSize * 2, 0.0f);
+    for (size_t j = 0; j < propSize; ++j)
+    {
+        float min = FLT_MAX;
+        float max = -FLT_MAX;
+        for (size_t i = 0; i < keyCount; ++i)
+        {
+            min = std::min(min, _keyValues[i * propSize + j]);
+            max = std::max(max, _keyValues[i * propSize + j]);
+        }
+        ranges[j * 2] = keyCount > 0 ? min : 0.0f;
+        ranges[j * 2 + 1] = keyCount > 0 ? max - min : 0.0f;
+    }
+    write(ranges, file);
+    write((unsigned int)quaternionOffset, file);
+
+    // Each keyframe takes one value per component, and three for the quaternion.
+    std::vector<unsigned short> values;
+    for (size_t i = 0; i < keyCount; ++i)
+    {
+        const float* value = &_keyValues[i * propSize];
+        for (size_t j = 0; j < propSize; ++j)
+        {
+            if ((int)j == quaternionOffset)
+            {
+                unsigned short packed[3];
+                packQuaternion(value + j, packed);
+                values.insert(values.end(), packed, packed + 3);
+                j += 3;
+            }
+            else
+            {
+                values.push_back(quantize(value[j], ranges[j * 2], ranges[j * 2 + 1]));
+            }
+        }
+    }
+    write(values, file);
+}
+
 unsigned int AnimationChannel::getInterpolationType(const char* str)
 {
     unsigned int value = 0;
@@ -65,6 +65,31 @@ public:
      */
     void removeDuplicates();
 
+    /**
+     * Compresses the channel: removes the keyframes that linear interpolation between the
+     * remaining keyframes reproduces within the tolerances, and writes the values quantized
+     * to 16 bits. Rotations are written as the three smallest components of the quaternion,
+     * and the other values within the range of each component. A channel whose keyframes
+     * are all within the tolerances of the first is collapsed to two keyframes of its value.
+     *
+     * Only channels with linear interpolation are compressed.
+     *
+     * @param translationTolerance The largest difference allowed in a translation component.
+     * @param rotationTolerance The largest difference allowed in a component of a rotation quaternion.
+     * @param scaleTolerance The largest difference allowed in a scale component.
+     */
+    void compress(float translationTolerance, float rotationTolerance, float scaleTolerance);
+
+    /**
+     * Determines whether every keyframe of the channel is within the tolerances of a value.
+     *
+     * @param value The value, with the components of the target attribute.
+     * @param translationTolerance The largest difference allowed in a translation component.
+     * @param rotationTolerance The largest difference allowed in a component of a rotation quaternion.
+     * @param scaleTolerance The largest difference allowed in a scale component.
+     */
+    bool isConstant(const float* value, float translationTolerance, float rotationTolerance, float scaleTolerance) const;
+
     /**
      * Returns the interpolation type value for the given string or zero if not valid.
      * Example: "LINEAR" returns AnimationChannel::LINEAR
@@ -86,6 +111,34 @@ private:
      */
     void deleteRange(size_t begin, size_t end, size_t propSize);
 
+    /**
+     * Returns the offset of the rotation quaternion in the values of a keyframe, or -1 if the
+     * target attribute has no rotation.
+     */
+    int getQuaternionOffset() const;
+
+    /**
+     * Returns the tolerance of each component of the values of the target attribute.
+     */
+    std::vector<float> getTolerances(float translationTolerance, float rotationTolerance, float scaleTolerance) const;
+
+    /**
+     * Determines whether two values are within the tolerances of each other. Rotations are
+     * compared with their signs matched, since q and -q are the same rotation.
+     */
+    bool isWithinTolerances(const float* a, const float* b, const std::vector<float>& tolerances) const;
+
+    /**
+     * Determines whether interpolating linearly from keyframe begin to keyframe end reproduces
+     * every keyframe in between within the tolerances.
+     */
+    bool isReproduced(size_t begin, size_t end, size_t propSize, const std::vector<float>& tolerances) const;
+
+    /**
+     * Writes the key times and the quantized values of a compressed channel.
+     */
+    void writeCompressedBinary(FILE* file);
+
 private:
 
     std::string _targetId;
@@ -95,6 +148,7 @@ private:
     std::vector<float> _tangentsIn;
     std::vector<float> _tangentsOut;
     std::vector<unsigned int> _interpolations;
+    bool _compressed;
 };
 
 }
@@ -0,0 +1,450 @@
+#include "Base.h"
+#include "BatchEncoder.h"
+
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <dirent.h>
+    #include <unistd.h>
+    #include <sys/types.h>
+    #include <sys/wait.h>
+#endif
+#include "Thread.h"
+
+// Changing the version makes every input out of date, e.g. when the output format changes.
+#define ENCODER_CACHE_VERSION 1
+
+// The FNV-1a hash constants.
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+namespace gameplay
+{
+
+/**
+ * A file to encode in a batch.
+ */
+struct BatchInput
+{
+    std::string inputPath;
+    std::string outputPath;
+    unsigned long long key;
+    long size;
+};
+
+#ifdef WIN32
+typedef HANDLE Process;
+#else
+typedef pid_t Process;
+#endif
+
+/**
+ * Adds the hash of a block of bytes to a hash.
+ */
+static unsigned long long hashBytes(unsigned long long hash, const void* data, size_t size)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * Adds the files of a directory and its subdirectories to a list, named by their path relative to the root.
+ */
+static bool listFiles(const std::string& dirPath, const std::string& prefix, std::vector<std::string>& names)
+{
+#ifdef WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA((dirPath + "/*").c_str(), &data);
+    if (find == INVALID_HANDLE_VALUE)
+        return false;
+    do
+    {
+        std::string name(data.cFileName);
+        if (name == "." || name == "..")
+            continue;
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+            listFiles(dirPath + "/" + name, prefix + name + "/", names);
+        else
+            names.push_back(prefix + name);
+    } while (FindNextFileA(find, &data) != 0);
+    FindClose(find);
+    return true;
+#else
+    DIR* dir = opendir(dirPath.c_str());
+    if (dir == NULL)
+        return false;
+    struct dirent* dp;
+    while ((dp = readdir(dir)) != NULL)
+    {
+        std::string name(dp->d_name);
+        if (name == "." || name == "..")
+            continue;
+        std::string path = dirPath + "/" + name;
+        struct stat buf;
+        if (stat(path.c_str(), &buf) != 0)
+            continue;
+        if (S_ISDIR(buf.st_mode))
+            listFiles(path, prefix + name + "/", names);
+        else
+            names.push_back(prefix + name);
+    }
+    closedir(dir);
+    return true;
+#endif
+}
+
+/**
+ * Creates a directory and the directories above it that do not exist.
+ */
+static void makeDirectories(const std::string& path)
+{
+    for (size_t i = 1; i <= path.size(); ++i)
+    {
+        if (i == path.size() || path[i] == '/')
+        {
+            std::string dir = path.substr(0, i);
+#ifdef WIN32
+            CreateDirectoryA(dir.c_str(), NULL);
+#else
+            mkdir(dir.c_str(), 0777);
+#endif
+        }
+    }
+}
+
+/**
+ * Orders inputs from the largest to the smallest, so the longest encodes start first.
+ */
+static bool compareInputSizes(const BatchInput& a, const BatchInput& b)
+{
+    return a.size > b.size;
+}
+
+/**
+ * Starts an encoder process with the given arguments, the first of which is the executable.
+ */
+static bool startProcess(const std::vector<std::string>& args, Process* process)
+{
+#ifdef WIN32
+    std::string commandLine;
+    for (size_t i = 0; i < args.size(); ++i)
+    {
+        if (i > 0)
+            commandLine += ' ';
+        commandLine += '"';
+        commandLine += args[i];
+        commandLine += '"';
+    }
+    STARTUPINFOA startupInfo;
+    ZeroMemory(&startupInfo, sizeof(startupInfo));
+    startupInfo.cb = sizeof(startupInfo);
+    PROCESS_INFORMATION processInfo;
+    if (!CreateProcessA(NULL, &commandLine[0], NULL, NULL, FALSE, 0, NULL, NULL, &startupInfo, &processInfo))
+        return false;
+    CloseHandle(processInfo.hThread);
+    *process = processInfo.hProcess;
+    return true;
+#else
+    std::vector<char*> argv;
+    for (size_t i = 0; i < args.size(); ++i)
+    {
+        argv.push_back(const_cast<char*>(args[i].c_str()));
+    }
+    argv.push_back(NULL);
+
+    // Flush the log first, so it is not interleaved with the output of the new process.
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0)
+        return false;
+    if (pid == 0)
+    {
+        execvp(argv[0], &argv[0]);
+        _exit(127);
+    }
+    *process = pid;
+    return true;
+#endif
+}
+
+/**
+ * Waits for one of the running processes to exit.
+ *
+ * @return The index of the process that exited.
+ */
+static size_t waitForProcess(const std::vector<Process>& processes, int* exitCode)
+{
+#ifdef WIN32
+    DWORD result = WaitForMultipleObjects((DWORD)processes.size(), &processes[0], FALSE, INFINITE);
+    size_t index = result >= WAIT_OBJECT_0 && result < WAIT_OBJECT_0 + processes.size() ? result - WAIT_OBJECT_0 : 0;
+    DWORD code = 1;
+    GetExitCodeProcess(processes[index], &code);
+    CloseHandle(processes[index]);
+    *exitCode = (int)code;
+    return index;
+#else
+    while (true)
+    {
+        int status = 0;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0)
+        {
+            // No child left to wait for, which should not happen; report the first as failed.
+            *exitCode = -1;
+            return 0;
+        }
+        for (size_t i = 0; i < processes.size(); ++i)
+        {
+            if (processes[i] == pid)
+            {
+                *exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+                return i;
+            }
+        }
+    }
+#endif
+}
+
+EncoderCache::EncoderCache(const std::string& path)
+    : _path(path)
+{
+    std::ifstream stream(path.c_str());
+    std::string line;
+    while (std::getline(stream, line))
+    {
+        // Each line is the key in hexadecimal followed by the path of the input.
+        unsigned long long key;
+        if (line.size() > 17 && sscanf(line.c_str(), "%llx", &key) == 1)
+        {
+            _keys[line.substr(17)] = key;
+        }
+    }
+}
+
+unsigned long long EncoderCache::computeKey(const std::string& inputPath, const std::string& outputPath, const std::vector<std::string>& options)
+{
+    FILE* file = fopen(inputPath.c_str(), "rb");
+    if (file == NULL)
+        return 0;
+
+    unsigned long long hash = FNV_OFFSET_BASIS;
+    unsigned int version = ENCODER_CACHE_VERSION;
+    hash = hashBytes(hash, &version, sizeof(version));
+    char buffer[65536];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        hash = hashBytes(hash, buffer, read);
+    }
+    fclose(file);
+
+    // The strings include their null characters, so that they cannot run into each other.
+    hash = hashBytes(hash, outputPath.c_str(), outputPath.size() + 1);
+    for (size_t i = 0; i < options.size(); ++i)
+    {
+        hash = hashBytes(hash, options[i].c_str(), options[i].size() + 1);
+    }
+    return hash != 0 ? hash : 1;
+}
+
+bool EncoderCache::isUpToDate(const std::string& inputPath, const std::string& outputPath, unsigned long long key) const
+{
+    std::map<std::string, unsigned long long>::const_iterator itr = _keys.find(inputPath);
+    if (itr == _keys.end() || itr->second != key || key == 0)
+        return false;
+    struct stat buf;
+    return stat(outputPath.c_str(), &buf) == 0;
+}
+
+void EncoderCache::set(const std::string& inputPath, unsigned long long key)
+{
+    _keys[inputPath] = key;
+}
+
+void EncoderCache::remove(const std::string& inputPath)
+{
+    _keys.erase(inputPath);
+}
+
+bool EncoderCache::save() const
+{
+    FILE* file = fopen(_path.c_str(), "w");
+    if (file == NULL)
+    {
+        LOG(1, "Error: Failed to write the encoder cache: %s\n", _path.c_str());
+        return false;
+    }
+    for (std::map<std::string, unsigned long long>::const_iterator itr = _keys.begin(); itr != _keys.end(); ++itr)
+    {
+        fprintf(file, "%016llx %s\n", itr->second, itr->first.c_str());
+    }
+    fclose(file);
+    return true;
+}
+
+int encodeBatch(const EncoderArguments& arguments, const char* executablePath)
+{
+    std::string inputDir = arguments.getFilePath();
+    std::string outputDir = arguments.getOutputDirPath();
+    std::vector<std::string> names;
+    if (!listFiles(inputDir, "", names))
+    {
+        LOG(1, "Error: Failed to list directory: %s\n", inputDir.c_str());
+        return -1;
+    }
+
+    // The options are passed on to each process. Animations cannot be grouped interactively, since
+    // several processes would prompt at once.
+    std::vector<std::string> options = arguments.getEncoderOptions();
+    if (arguments.getAnimationGrouping() == EncoderArguments::ANIMATIONGROUP_PROMPT)
+        options.push_back("-g:off");
+
+    std::vector<BatchInput> inputs;
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        const std::string& name = names[i];
+        size_t dot = name.find_last_of('.');
+        if (dot == std::string::npos || dot < name.find_last_of('/') + 1)
+            continue;
+        std::string outputPath = outputDir + "/" + name.substr(0, dot);
+        EncoderArguments::FileFormat format = EncoderArguments::getFileFormat(name);
+        switch (format)
+        {
+        case EncoderArguments::FILEFORMAT_FBX:
+            outputPath += ".gpb";
+            break;
+        case EncoderArguments::FILEFORMAT_TTF:
+            if (arguments.getFontSize() == 0)
+            {
+                LOG(1, "Warning: Skipping %s, since fonts need a size (-s) in batch mode.\n", name.c_str());
+                continue;
+            }
+            outputPath += ".gpb";
+            break;
+        case EncoderArguments::FILEFORMAT_LUA:
+            outputPath += ".luac";
+            break;
+        case EncoderArguments::FILEFORMAT_PNG:
+        case EncoderArguments::FILEFORMAT_RAW:
+            if (arguments.normalMapGeneration())
+                outputPath += "_normalmap.png";
+            else if (arguments.getTextureFormat() != EncoderArguments::TEXTUREFORMAT_NONE && format == EncoderArguments::FILEFORMAT_PNG)
+                outputPath += ".ktx";
+            else
+                continue;
+            break;
+        default:
+            continue;
+        }
+
+        BatchInput input;
+        input.inputPath = inputDir + "/" + name;
+        input.outputPath = outputPath;
+        input.key = 0;
+        struct stat buf;
+        input.size = stat(input.inputPath.c_str(), &buf) == 0 ? (long)buf.st_size : 0;
+        inputs.push_back(input);
+    }
+
+    EncoderCache* cache = arguments.getCachePath().empty() ? NULL : new EncoderCache(arguments.getCachePath());
+    unsigned int upToDate = 0;
+    if (cache)
+    {
+        std::vector<BatchInput> outOfDate;
+        for (size_t i = 0; i < inputs.size(); ++i)
+        {
+            BatchInput& input = inputs[i];
+            input.key = EncoderCache::computeKey(input.inputPath, input.outputPath, options);
+            if (cache->isUpToDate(input.inputPath, input.outputPath, input.key))
+                ++upToDate;
+            else
+                outOfDate.push_back(input);
+        }
+        inputs.swap(outOfDate);
+    }
+    std::sort(inputs.begin(), inputs.end(), compareInputSizes);
+
+    unsigned int jobCount = arguments.getJobCount() > 0 ? arguments.getJobCount() : getProcessorCount();
+#ifdef WIN32
+    if (jobCount > MAXIMUM_WAIT_OBJECTS)
+        jobCount = MAXIMUM_WAIT_OBJECTS;
+    char modulePath[MAX_PATH];
+    std::string executable = GetModuleFileNameA(NULL, modulePath, MAX_PATH) > 0 ? modulePath : executablePath;
+#else
+    std::string executable = executablePath;
+#endif
+    LOG(1, "Encoding %u files with %u processes (%u up to date).\n", (unsigned int)inputs.size(), jobCount, upToDate);
+
+    std::vector<Process> processes;
+    std::vector<size_t> running;        // The input encoded by each process.
+    unsigned int failed = 0;
+    size_t next = 0;
+    while (next < inputs.size() || !processes.empty())
+    {
+        while (next < inputs.size() && processes.size() < jobCount)
+        {
+            const BatchInput& input = inputs[next];
+            std::vector<std::string> args;
+            args.push_back(executable);
+            args.insert(args.end(), options.begin(), options.end());
+            args.push_back(input.inputPath);
+            args.push_back(input.outputPath);
+
+            size_t slash = input.outputPath.find_last_of('/');
+            if (slash != std::string::npos)
+                makeDirectories(input.outputPath.substr(0, slash));
+
+            Process process;
+            if (startProcess(args, &process))
+            {
+                processes.push_back(process);
+                running.push_back(next);
+            }
+            else
+            {
+                LOG(1, "Error: Failed to start the encoder for %s\n", input.inputPath.c_str());
+                ++failed;
+            }
+            ++next;
+        }
+        if (processes.empty())
+            continue;
+
+        int exitCode;
+        size_t index = waitForProcess(processes, &exitCode);
+        const BatchInput& input = inputs[running[index]];
+        if (exitCode == 0)
+        {
+            if (cache)
+                cache->set(input.inputPath, input.key);
+        }
+        else
+        {
+            LOG(1, "Error: Failed to encode %s\n", input.inputPath.c_str());
+            if (cache)
+                cache->remove(input.inputPath);
+            ++failed;
+        }
+        processes.erase(processes.begin() + index);
+        running.erase(running.begin() + index);
+    }
+
+    if (cache)
+    {
+        cache->save();
+        SAFE_DELETE(cache);
+    }
+    if (failed > 0)
+    {
+        LOG(1, "Error: %u of %u files failed to encode.\n", failed, (unsigned int)inputs.size());
+        return -1;
+    }
+    return 0;
+}
+
+}
@@ -0,0 +1,88 @@
+#ifndef BATCHENCODER_H_
+#define BATCHENCODER_H_
+
+#include "EncoderArguments.h"
+
+namespace gameplay
+{
+
+/**
+ * Records the inputs encoded by previous runs of the encoder, so unchanged inputs are skipped.
+ *
+ * Each input is recorded with a key that hashes its content, the path of its output and the
+ * options it was encoded with. An input is up to date when its key has not changed and its
+ * output still exists. Only the input file itself is hashed: the files an FBX file refers to,
+ * such as textures, are not.
+ */
+class EncoderCache
+{
+public:
+
+    /**
+     * Constructor. Loads the cache from a file, which does not need to exist.
+     *
+     * @param path The path of the cache file.
+     */
+    EncoderCache(const std::string& path);
+
+    /**
+     * Computes the key of an input.
+     *
+     * @param inputPath The path of the input file.
+     * @param outputPath The path of the output file.
+     * @param options The options the input is encoded with.
+     *
+     * @return The key, or 0 if the input cannot be read.
+     */
+    static unsigned long long computeKey(const std::string& inputPath, const std::string& outputPath, const std::vector<std::string>& options);
+
+    /**
+     * Determines whether an input was encoded with the given key and its output still exists.
+     */
+    bool isUpToDate(const std::string& inputPath, const std::string& outputPath, unsigned long long key) const;
+
+    /**
+     * Records that an input was encoded with the given key.
+     */
+    void set(const std::string& inputPath, unsigned long long key);
+
+    /**
+     * Forgets an input, so that it is encoded again by the next run.
+     */
+    void remove(const std::string& inputPath);
+
+    /**
+     * Writes the cache to its file.
+     *
+     * @return true if the cache was written, false otherwise.
+     */
+    bool save() const;
+
+private:
+
+    std::string _path;
+    std::map<std::string, unsigned long long> _keys;
+};
+
+/**
+ * Encodes the supported files of a directory and its subdirectories in parallel.
+ *
+ * FBX, TTF and Lua files are encoded, as are PNG and RAW heightmaps when normal map
+ * generation is enabled, and PNG images when textures are enabled (-tex). Each file is encoded by a separate encoder process, started with
+ * the same options, and up to EncoderArguments::getJobCount() processes run at once. The
+ * outputs mirror the directory tree under the output directory, or are written next to
+ * their inputs when there is none.
+ *
+ * When a cache file is given, the files that are up to date in it are skipped (see
+ * EncoderCache) and the cache is updated with the files that were encoded.
+ *
+ * @param arguments The arguments, whose file path is the directory to encode.
+ * @param executablePath The path the encoder was started with, which is used to start the other processes.
+ *
+ * @return 0 if every file was encoded or up to date, -1 if any failed.
+ */
+int encodeBatch(const EncoderArguments& arguments, const char* executablePath);
+
+}
+
+#endif
@@ -15,21 +15,41 @@ namespace gameplay
 
 static EncoderArguments* __instance;
 
+static bool isDirectoryPath(const std::string& path)
+{
+    struct stat buf;
+    return stat(path.c_str(), &buf) == 0 && (buf.st_mode & S_IFDIR) != 0;
+}
+
 extern int __logVerbosity = 1;
 
 EncoderArguments::EncoderArguments(size_t argc, const char** argv) :
     _fontSize(0),
     _normalMap(false),
+    _textureFormat(TEXTUREFORMAT_NONE),
+    _textureLinear(false),
     _parseError(false),
     _fontPreview(false),
+    _fontDistanceField(false),
     _textOutput(false),
     _optimizeAnimations(false),
+    _optimizeMeshes(false),
+    _quantizeVertices(false),
+    _dualQuaternionSkinning(false),
+    _compressAnimations(false),
     _animationGrouping(ANIMATIONGROUP_PROMPT),
-    _outputMaterial(false)
+    _outputMaterial(false),
+    _package(false),
+    _packageCompression(true),
+    _binaryCompression(false),
+    _batch(false),
+    _directory(false),
+    _jobCount(0)
 {
     __instance = this;
 
     memset(_heightmapResolution, 0, sizeof(int) * 2);
+    memset(_animationTolerances, 0, sizeof(_animationTolerances));
 
     if (argc > 1)
     {
@@ -44,11 +64,28 @@ EncoderArguments::EncoderArguments(size_t argc, const char** argv) :
         {
             if (arguments[i][0] == '-')
             {
+                size_t start = i;
                 readOption(arguments, &i);
                 index = i + 1;
+
+                const std::string& option = arguments[start];
+                if (option != "-batch" && option != "-j" && option != "-cache")
+                    _encoderOptions.insert(_encoderOptions.end(), arguments.begin() + start, arguments.begin() + index);
             }
         }
-        if (arguments.size() - index == 2)
+        if (arguments.size() - index >= 1 && (_batch || (_normalMap && isDirectoryPath(arguments[index]))))
+        {
+            // The output of a batch or of the normal maps of a directory is a directory, which is used as given.
+            _directory = true;
+            setInputfilePath(arguments[index]);
+            if (arguments.size() - index == 2)
+            {
+                _fileOutputPath = arguments[index + 1];
+                while (_fileOutputPath.size() > 1 && (_fileOutputPath[_fileOutputPath.size() - 1] == '/' || _fileOutputPath[_fileOutputPath.size() - 1] == '\\'))
+                    _fileOutputPath.erase(_fileOutputPath.size() - 1);
+            }
+        }
+        else if (arguments.size() - index == 2)
         {
             setInputfilePath(arguments[index]);
             setOutputfilePath(arguments[index + 1]);
@@ -85,7 +122,11 @@ const char* EncoderArguments::getFilePathPointer() const
 
 std::string EncoderArguments::getOutputDirPath() const
 {
-    if (_fileOutputPath.size() > 0)
+    if (_directory)
+    {
+        return _fileOutputPath.size() > 0 ? _fileOutputPath : _filePath;
+    }
+    else if (_fileOutputPath.size() > 0)
     {
         int pos = _fileOutputPath.find_last_of('/');
         return (pos == -1 ? _fileOutputPath : _fileOutputPath.substr(0, pos));
@@ -99,12 +140,21 @@ std::string EncoderArguments::getOutputDirPath() const
 
 std::string EncoderArguments::getOutputFileExtension() const
 {
+    if (_package)
+        return ".gpk";
+
     switch (getFileFormat())
     {
     case FILEFORMAT_PNG:
     case FILEFORMAT_RAW:
         if (_normalMap)
             return ".png";
+        if (_textureFormat != TEXTUREFORMAT_NONE && getFileFormat() == FILEFORMAT_PNG)
+            return ".ktx";
+        return ".gpb";
+
+    case FILEFORMAT_LUA:
+        return ".luac";
 
     default:
         return ".gpb";
@@ -172,6 +222,11 @@ const std::vector<EncoderArguments::HeightmapOption>& EncoderArguments::getHeigh
     return _heightmaps;
 }
 
+const std::vector<EncoderArguments::NavigationMeshOption>& EncoderArguments::getNavigationMeshOptions() const
+{
+    return _navigationMeshes;
+}
+
 unsigned int EncoderArguments::tangentBinormalIdCount() const
 {
     return _tangentBinormalId.size();
@@ -198,6 +253,16 @@ const Vector3& EncoderArguments::getHeightmapWorldSize() const
     return _heightmapWorldSize;
 }
 
+EncoderArguments::TextureFormatOption EncoderArguments::getTextureFormat() const
+{
+    return _textureFormat;
+}
+
+bool EncoderArguments::textureLinearFilteringEnabled() const
+{
+    return _textureLinear;
+}
+
 bool EncoderArguments::parseErrorOccured() const
 {
     return _parseError;
@@ -216,6 +281,11 @@ bool EncoderArguments::fileExists() const
     return false;
 }
 
+const std::vector<float>& EncoderArguments::getLodRatios() const
+{
+    return _lodRatios;
+}
+
 void splitString(const char* str, std::vector<std::string>* tokens)
 {
     // Split node id list into tokens
@@ -237,9 +307,28 @@ void EncoderArguments::printUsage() const
     "Supported file extensions:\n" \
     "  .fbx\t(FBX)\n" \
     "  .ttf\t(TrueType Font)\n" \
+    "  .lua\t(Lua script, compiled to a .luac chunk that the runtime loads\n" \
+        "\t\tinstead of compiling the script)\n" \
+    "  .png\t(PNG image, with -tex or -n)\n" \
     "\n" \
     "General Options:\n" \
     "  -v <verbosity>\tVerbosity level (0-4).\n" \
+    "  -pack\t\tWrites the files of the input directory to a .gpk package,\n" \
+        "\t\twhich FileSystem::mountPackage mounts. Files are compressed\n" \
+        "\t\twith LZ4 when it saves space; use -pack:store to store every\n" \
+        "\t\tfile as is.\n" \
+    "  -lz4\t\tCompresses the .gpb files written from FBX and TTF files in\n" \
+        "\t\tLZ4 blocks, which Bundle decompresses as it reads them.\n" \
+    "  -batch\tEncodes the FBX, TTF and Lua files of the input directory and\n" \
+        "\t\tits subdirectories, PNG/RAW heightmaps with -n and PNG images\n" \
+        "\t\twith -tex, each in its own encoder process. The outputs mirror\n" \
+        "\t\tthe directory tree in the output directory, or are written\n" \
+        "\t\tnext to their inputs.\n" \
+        "\t\tFonts need -s. Animations are not grouped interactively.\n" \
+    "  -j <count>\tThe number of encoder processes run at once in batch mode.\n" \
+        "\t\tDefaults to the number of processors.\n" \
+    "  -cache <file>\tSkips the inputs whose content, output path and options\n" \
+        "\t\tare unchanged since they were encoded, as recorded in the file.\n" \
     "\n" \
     "FBX file options:\n" \
     "  -i <id>\tFilter by node ID.\n" \
@@ -250,13 +339,36 @@ void EncoderArguments::printUsage() const
         "\t\tGroup all animation channels targeting the nodes into a \n" \
         "\t\tnew animation.\n" \
     "  -m\t\tOutput material file for scene.\n" \
+    "  -dq\t\tWrites materials that skin with dual quaternions, which take\n" \
+        "\t\t2 uniforms per joint instead of 3, so more joints fit in a\n" \
+        "\t\tdraw call. Joints must not be scaled.\n" \
     "  -tb <node id>\n" \
         "\t\tGenerates tangents and binormals for the given node.\n" \
+    "  -l <levels|ratios>\n" \
+        "\t\tGenerates simplified levels of detail for every mesh that is\n" \
+        "\t\tnot already in an LOD group. Either the number of levels, each\n" \
+        "\t\twith half the triangles of the previous level, or the comma-\n" \
+        "\t\tseparated fractions of the triangles to keep, e.g. \"0.5,0.2\".\n" \
     "  -oa\n" \
         "\t\tOptimizes animations by analyzing animation channel data and\n" \
         "\t\tremoving any channels that contain default/identity values\n" \
         "\t\tand removing any duplicate contiguous keyframes, which are \n" \
         "\t\tcommon when exporting baked animation data.\n" \
+    "  -ac <tolerance>\n" \
+        "\t\tCompresses animations by removing the keyframes that linear\n" \
+        "\t\tinterpolation reproduces within the tolerance, e.g. 0.001, and\n" \
+        "\t\tquantizing the values to 16 bits, with rotations stored as the\n" \
+        "\t\tthree smallest components of the quaternion. The tolerance may\n" \
+        "\t\tbe given per translation, rotation (quaternion component) and\n" \
+        "\t\tscale, e.g. \"0.01,0.001,0.001\". Constant channels are reduced\n" \
+        "\t\tto two keyframes, and node channels that hold the node's own\n" \
+        "\t\ttransform are removed.\n" \
+    "  -om\n" \
+        "\t\tOptimizes meshes by reordering triangles for the vertex cache\n" \
+        "\t\tand to reduce overdraw, and vertices in the order they are used.\n" \
+    "  -q\t\tQuantizes vertices: normals, tangents and binormals are written\n" \
+        "\t\tas 10:10:10:2 integers, colors and blend weights as bytes, and\n" \
+        "\t\ttexture coordinates as shorts or half floats.\n" \
     "  -h <size> \"<node ids>\" <filename>\n" \
         "\t\tGenerates a single heightmap image using meshes from the \n" \
         "\t\tspecified nodes. \n" \
@@ -266,9 +378,16 @@ void EncoderArguments::printUsage() const
         "\t\tFilename is the name of the image (PNG) to be saved.\n" \
         "\t\tMultiple -h arguments can be supplied to generate more than one \n" \
         "\t\theightmap. For 24-bit packed height data use -hp instead of -h.\n" \
+    "  -nav <max slope> \"<node ids>\" <id>\n" \
+        "\t\tGenerates a navigation mesh with the given id from the triangles\n" \
+        "\t\tof the meshes of the specified nodes whose slope is at most\n" \
+        "\t\t<max slope> degrees, e.g. 45. It is loaded at runtime with\n" \
+        "\t\tBundle::loadNavigationMesh.\n" \
+        "\t\t<node ids> should be in quotes with a space between each id.\n" \
     "\n" \
     "Normal map generation options:\n" \
-        "  -n\t\tGenerate normal map (requires input file of type PNG or RAW)\n" \
+        "  -n\t\tGenerate normal map (requires input file of type PNG or RAW,\n" \
+        "\t\tor a directory of them, such as the tiles of a terrain)\n" \
         "  -s\t\tSize/resolution of the input heightmap image \n" \
         "    \t\t(required for RAW files)\n" \
         "  -w <size>\tSpecifies the size of an input terrain heightmap file in world\n" \
@@ -283,9 +402,20 @@ void EncoderArguments::printUsage() const
         "  (8 or 16-bit), which is a common headerless format supported by most \n" \
         "  terrain generation tools.\n" \
     "\n" \
+    "Texture options:\n" \
+    "  -tex\t\tWrites a PNG image to a .ktx texture with all of its mip levels,\n" \
+        "\t\twhich the runtime uploads instead of generating mipmaps.\n" \
+        "\t\tColors are filtered in linear space, assuming sRGB images.\n" \
+    "  -tex:16\tWrites the levels as 16-bit RGB565, or RGBA4444 with alpha.\n" \
+    "  -tex:etc1\tCompresses the levels to ETC1. Images with alpha are\n" \
+        "\t\twritten uncompressed.\n" \
+    "  -tl\t\tFilters the levels without converting them from sRGB, for\n" \
+        "\t\tnormal maps and other data.\n" \
+    "\n" \
     "TTF file options:\n" \
     "  -s <size>\tSize of the font.\n" \
     "  -p\t\tOutput font preview.\n" \
+    "  -d\t\tOutput a distance field font, which can be drawn at any size.\n" \
     "\n");
     exit(8);
 }
@@ -295,6 +425,51 @@ bool EncoderArguments::fontPreviewEnabled() const
     return _fontPreview;
 }
 
+bool EncoderArguments::packageEnabled() const
+{
+    return _package;
+}
+
+bool EncoderArguments::packageCompressionEnabled() const
+{
+    return _packageCompression;
+}
+
+bool EncoderArguments::binaryCompressionEnabled() const
+{
+    return _binaryCompression;
+}
+
+bool EncoderArguments::batchEnabled() const
+{
+    return _batch;
+}
+
+bool EncoderArguments::isDirectory() const
+{
+    return _directory;
+}
+
+unsigned int EncoderArguments::getJobCount() const
+{
+    return _jobCount;
+}
+
+const std::string& EncoderArguments::getCachePath() const
+{
+    return _cachePath;
+}
+
+const std::vector<std::string>& EncoderArguments::getEncoderOptions() const
+{
+    return _encoderOptions;
+}
+
+bool EncoderArguments::fontDistanceFieldEnabled() const
+{
+    return _fontDistanceField;
+}
+
 bool EncoderArguments::textOutputEnabled() const
 {
     return _textOutput;
@@ -305,6 +480,33 @@ bool EncoderArguments::optimizeAnimationsEnabled() const
     return _optimizeAnimations;
 }
 
+bool EncoderArguments::optimizeMeshesEnabled() const
+{
+    return _optimizeMeshes;
+}
+
+bool EncoderArguments::quantizeVerticesEnabled() const
+{
+    return _quantizeVertices;
+}
+
+bool EncoderArguments::compressAnimationsEnabled() const
+{
+    return _compressAnimations;
+}
+
+void EncoderArguments::getAnimationTolerances(float* translation, float* rotation, float* scale) const
+{
+    *translation = _animationTolerances[0];
+    *rotation = _animationTolerances[1];
+    *scale = _animationTolerances[2];
+}
+
+bool EncoderArguments::dualQuaternionSkinningEnabled() const
+{
+    return _dualQuaternionSkinning;
+}
+
 bool EncoderArguments::outputMaterialEnabled() const
 {
     return _outputMaterial;
@@ -326,16 +528,21 @@ unsigned int EncoderArguments::getFontSize() const
 
 EncoderArguments::FileFormat EncoderArguments::getFileFormat() const
 {
-    if (_filePath.length() < 5)
+    return getFileFormat(_filePath);
+}
+
+EncoderArguments::FileFormat EncoderArguments::getFileFormat(const std::string& filePath)
+{
+    if (filePath.length() < 5)
     {
         return FILEFORMAT_UNKNOWN;
     }
     // Extract the extension
     std::string ext = "";
-    size_t pos = _filePath.find_last_of(".");
+    size_t pos = filePath.find_last_of(".");
     if (pos != std::string::npos)
     {
-        ext = _filePath.substr(pos + 1);
+        ext = filePath.substr(pos + 1);
     }
     for (size_t i = 0; i < ext.size(); ++i)
         ext[i] = (char)tolower(ext[i]);
@@ -365,6 +572,10 @@ EncoderArguments::FileFormat EncoderArguments::getFileFormat() const
     {
         return FILEFORMAT_RAW;
     }
+    if (ext.compare("lua") == 0)
+    {
+        return FILEFORMAT_LUA;
+    }
 
     return FILEFORMAT_UNKNOWN;
 }
@@ -378,6 +589,69 @@ void EncoderArguments::readOption(const std::vector<std::string>& options, size_
     }
     switch (str[1])
     {
+    case 'a':
+        if (str == "-ac")
+        {
+            // Compress animations
+            (*index)++;
+            if (*index >= options.size())
+            {
+                LOG(1, "Error: missing argument for -ac.\n");
+                _parseError = true;
+                return;
+            }
+            // Either one tolerance for every component, or one each for translation, rotation and scale.
+            std::vector<std::string> parts;
+            splitString(options[*index].c_str(), &parts);
+            if (parts.size() != 1 && parts.size() != 3)
+            {
+                LOG(1, "Error: invalid tolerance argument for -ac.\n");
+                _parseError = true;
+                return;
+            }
+            for (unsigned int i = 0; i < 3; ++i)
+            {
+                _animationTolerances[i] = (float)atof(parts[parts.size() == 3 ? i : 0].c_str());
+                if (_animationTolerances[i] < 0.0f)
+                {
+                    LOG(1, "Error: invalid tolerance argument for -ac.\n");
+                    _parseError = true;
+                    return;
+                }
+            }
+            _compressAnimations = true;
+        }
+        break;
+    case 'b':
+        if (str.compare("-batch") == 0)
+        {
+            _batch = true;
+        }
+        break;
+    case 'c':
+        if (str.compare("-cache") == 0)
+        {
+            (*index)++;
+            if (*index >= options.size())
+            {
+                LOG(1, "Error: missing argument for -cache.\n");
+                _parseError = true;
+                return;
+            }
+            _cachePath = options[*index];
+        }
+        break;
+    case 'd':
+        if (str == "-dq")
+        {
+            // Skin with dual quaternions
+            _dualQuaternionSkinning = true;
+        }
+        else
+        {
+            _fontDistanceField = true;
+        }
+        break;
     case 'g':
         if (str.compare("-groupAnimations:auto") == 0 || str.compare("-g:auto") == 0)
         {
@@ -423,6 +697,11 @@ void EncoderArguments::readOption(const std::vector<std::string>& options, size_
             // Optimize animations
             _optimizeAnimations = true;
         }
+        else if (str == "-om")
+        {
+            // Optimize meshes
+            _optimizeMeshes = true;
+        }
         break;
     case 'h':
         {
@@ -490,6 +769,66 @@ void EncoderArguments::readOption(const std::vector<std::string>& options, size_
             }
         }
         break;
+    case 'j':
+        (*index)++;
+        if (*index >= options.size() || atoi(options[*index].c_str()) <= 0)
+        {
+            LOG(1, "Error: invalid argument for -j.\n");
+            _parseError = true;
+            return;
+        }
+        _jobCount = (unsigned int)atoi(options[*index].c_str());
+        break;
+    case 'l':
+        if (str.compare("-lz4") == 0)
+        {
+            _binaryCompression = true;
+        }
+        else if (str.compare("-l") == 0 || str.compare("-lod") == 0)
+        {
+            (*index)++;
+            if (*index >= options.size())
+            {
+                LOG(1, "Error: missing argument for -l.\n");
+                _parseError = true;
+                return;
+            }
+            _lodRatios.clear();
+            std::vector<std::string> parts;
+            splitString(options[*index].c_str(), &parts);
+            if (parts.size() == 1 && parts[0].find('.') == std::string::npos)
+            {
+                // Number of levels
+                int levels = atoi(parts[0].c_str());
+                for (int i = 1; i <= levels && i < 16; ++i)
+                {
+                    _lodRatios.push_back(1.0f / (float)(1 << i));
+                }
+            }
+            else
+            {
+                for (unsigned int i = 0; i < parts.size(); ++i)
+                {
+                    _lodRatios.push_back((float)atof(parts[i].c_str()));
+                }
+            }
+            for (unsigned int i = 0; i < _lodRatios.size(); ++i)
+            {
+                if (_lodRatios[i] <= 0.0f || _lodRatios[i] >= 1.0f || (i > 0 && _lodRatios[i] >= _lodRatios[i - 1]))
+                {
+                    LOG(1, "Error: -l requires decreasing ratios between 0 and 1.\n");
+                    _parseError = true;
+                    return;
+                }
+            }
+            if (_lodRatios.empty())
+            {
+                LOG(1, "Error: invalid argument for -l.\n");
+                _parseError = true;
+                return;
+            }
+        }
+        break;
     case 'm':
         if (str.compare("-m") == 0)
         {
@@ -498,7 +837,45 @@ void EncoderArguments::readOption(const std::vector<std::string>& options, size_
         }
         break;
     case 'n':
-        _normalMap = true;
+        if (str.compare("-nav") == 0)
+        {
+            if (*index + 3 >= options.size())
+            {
+                LOG(1, "Error: missing argument for -nav.\n");
+                _parseError = true;
+                return;
+            }
+            _navigationMeshes.resize(_navigationMeshes.size() + 1);
+            NavigationMeshOption& navigationMesh = _navigationMeshes.back();
+
+            // Read the maximum slope, in degrees
+            (*index)++;
+            navigationMesh.maxSlope = (float)atof(options[*index].c_str());
+            if (navigationMesh.maxSlope <= 0.0f || navigationMesh.maxSlope >= 90.0f)
+            {
+                LOG(1, "Error: max slope argument for -nav must be between 0 and 90 degrees.\n");
+                _parseError = true;
+                return;
+            }
+
+            // Split node id list into tokens
+            (*index)++;
+            splitString(options[*index].c_str(), &navigationMesh.nodeIds);
+
+            // Store the id of the navigation mesh
+            (*index)++;
+            navigationMesh.id = options[*index];
+            if (navigationMesh.id.empty())
+            {
+                LOG(1, "Error: missing id argument for -nav.\n");
+                _parseError = true;
+                return;
+            }
+        }
+        else
+        {
+            _normalMap = true;
+        }
         break;
     case 'w':
         {
@@ -530,7 +907,23 @@ void EncoderArguments::readOption(const std::vector<std::string>& options, size_
         }
         break;
     case 'p':
-        _fontPreview = true;
+        if (str.compare("-pack") == 0)
+        {
+            _package = true;
+        }
+        else if (str.compare("-pack:store") == 0)
+        {
+            _package = true;
+            _packageCompression = false;
+        }
+        else
+        {
+            _fontPreview = true;
+        }
+        break;
+    case 'q':
+        // Quantize vertices
+        _quantizeVertices = true;
         break;
     case 's':
         if (_normalMap)
@@ -588,6 +981,22 @@ void EncoderArguments::readOption(const std::vector<std::string>& options, size_
         {
             _textOutput = true;
         }
+        else if (str.compare("-tex") == 0)
+        {
+            _textureFormat = TEXTUREFORMAT_UNCOMPRESSED;
+        }
+        else if (str.compare("-tex:16") == 0)
+        {
+            _textureFormat = TEXTUREFORMAT_16BIT;
+        }
+        else if (str.compare("-tex:etc1") == 0)
+        {
+            _textureFormat = TEXTUREFORMAT_ETC1;
+        }
+        else if (str.compare("-tl") == 0)
+        {
+            _textureLinear = true;
+        }
         else if (str.compare("-tb") == 0)
         {
             if ((*index + 1) >= options.size())
@@ -22,7 +22,8 @@ public:
         FILEFORMAT_TTF,
         FILEFORMAT_GPB,
         FILEFORMAT_PNG,
-        FILEFORMAT_RAW
+        FILEFORMAT_RAW,
+        FILEFORMAT_LUA
     };
 
     struct HeightmapOption
@@ -34,6 +35,13 @@ public:
         int height;
     };
 
+    struct NavigationMeshOption
+    {
+        std::vector<std::string> nodeIds;
+        std::string id;
+        float maxSlope;
+    };
+
     struct NormalMapOption
     {
         std::string inputFile;
@@ -47,6 +55,17 @@ public:
         ANIMATIONGROUP_AUTO,
         ANIMATIONGROUP_OFF
     };
+
+    /**
+     * The formats PNG images are written to KTX textures in (see writeTexture).
+     */
+    enum TextureFormatOption
+    {
+        TEXTUREFORMAT_NONE,
+        TEXTUREFORMAT_UNCOMPRESSED,
+        TEXTUREFORMAT_16BIT,
+        TEXTUREFORMAT_ETC1
+    };
     
     /**
      * Constructor.
@@ -68,6 +87,11 @@ public:
      */
     FileFormat getFileFormat() const;
 
+    /**
+     * Gets the file format of a file path based on the extension.
+     */
+    static FileFormat getFileFormat(const std::string& filePath);
+
     /**
      * Returns the file path.
      */
@@ -79,7 +103,7 @@ public:
     const char* getFilePathPointer() const;
 
     /**
-     * Returns the output path/folder.
+     * Returns the output path/folder. In batch mode, this is the directory the outputs are written to.
      * Example: "C:/dir"
      */
     std::string getOutputDirPath() const;
@@ -105,6 +129,14 @@ public:
 
     const std::vector<HeightmapOption>& getHeightmapOptions() const;
 
+    const std::vector<NavigationMeshOption>& getNavigationMeshOptions() const;
+
+    /**
+     * Returns the fractions of the triangles of each mesh to keep in the levels of detail
+     * that are generated for it, in decreasing order. Empty if no levels are generated.
+     */
+    const std::vector<float>& getLodRatios() const;
+
     /**
      * Returns the number of node IDs that were marked as needing to compute tangents and binormals.
      */
@@ -133,6 +165,17 @@ public:
      * This option is only applicable for normal map generation.
      */
     const Vector3& getHeightmapWorldSize() const;
+
+    /**
+     * Returns the format PNG images are written to KTX textures in, or TEXTUREFORMAT_NONE
+     * if they are not.
+     */
+    TextureFormatOption getTextureFormat() const;
+
+    /**
+     * Returns true if the mip levels of textures are filtered without converting them from sRGB.
+     */
+    bool textureLinearFilteringEnabled() const;
     
     /**
      * Returns true if an error occurred while parsing the command line arguments.
@@ -152,9 +195,56 @@ public:
     void printUsage() const;
 
     bool fontPreviewEnabled() const;
+    bool fontDistanceFieldEnabled() const;
     bool textOutputEnabled() const;
     bool optimizeAnimationsEnabled() const;
+    bool optimizeMeshesEnabled() const;
+    bool quantizeVerticesEnabled() const;
+    bool dualQuaternionSkinningEnabled() const;
+    bool compressAnimationsEnabled() const;
+
+    /**
+     * Returns the tolerances of the translation, rotation and scale components of compressed animations.
+     */
+    void getAnimationTolerances(float* translation, float* rotation, float* scale) const;
+
     bool outputMaterialEnabled() const;
+    bool packageEnabled() const;
+    bool packageCompressionEnabled() const;
+
+    /**
+     * Returns true if the binary files written from FBX and TTF files are compressed with LZ4 (see GPBFile::compressBinary).
+     */
+    bool binaryCompressionEnabled() const;
+
+    /**
+     * Returns true if the input is a directory whose files are encoded in parallel (see encodeBatch).
+     */
+    bool batchEnabled() const;
+
+    /**
+     * Returns true if the input is a directory, whose files are encoded in batch mode or
+     * whose heightmaps normal maps are generated for.
+     */
+    bool isDirectory() const;
+
+    /**
+     * Returns the number of encoder processes run at once in batch mode, or 0 for one per processor.
+     */
+    unsigned int getJobCount() const;
+
+    /**
+     * Returns the path of the cache file that records the inputs already encoded, or an empty string.
+     */
+    const std::string& getCachePath() const;
+
+    /**
+     * Returns the options that affect how files are encoded, as they were given on the command line.
+     *
+     * The batch and cache options are left out, so these can be passed on to the encoder
+     * processes of a batch and hashed into the keys of the cache.
+     */
+    const std::vector<std::string>& getEncoderOptions() const;
 
     const char* getNodeId() const;
     unsigned int getFontSize() const;
@@ -197,17 +287,35 @@ private:
     bool _normalMap;
     Vector3 _heightmapWorldSize;
     int _heightmapResolution[2];
+    TextureFormatOption _textureFormat;
+    bool _textureLinear;
 
     bool _parseError;
     bool _fontPreview;
+    bool _fontDistanceField;
     bool _textOutput;
     bool _optimizeAnimations;
+    bool _optimizeMeshes;
+    bool _quantizeVertices;
+    bool _dualQuaternionSkinning;
+    bool _compressAnimations;
+    float _animationTolerances[3];
     AnimationGroupOption _animationGrouping;
     bool _outputMaterial;
+    bool _package;
+    bool _packageCompression;
+    bool _binaryCompression;
+    bool _batch;
+    bool _directory;
+    unsigned int _jobCount;
+    std::string _cachePath;
+    std::vector<std::string> _encoderOptions;
 
     std::vector<std::string> _groupAnimationNodeId;
     std::vector<std::string> _groupAnimationAnimationId;
     std::vector<HeightmapOption> _heightmaps;
+    std::vector<NavigationMeshOption> _navigationMeshes;
+    std::vector<float> _lodRatios;
     std::set<std::string> _tangentBinormalId;
 
 };
@@ -505,6 +505,7 @@ Node* FBXSceneEncoder::loadNode(FbxNode* fbxNode)
             node->addChild(child);
         }
     }
+    loadLodGroup(fbxNode, node);
     _nodeMap[fbxNode] = node;
     return node;
 }
@@ -901,6 +902,46 @@ void FBXSceneEncoder::loadModel(FbxNode* fbxNode, Node* node)
     }
 }
 
+void FBXSceneEncoder::loadLodGroup(FbxNode* fbxNode, Node* node)
+{
+    FbxNodeAttribute* attribute = fbxNode->GetNodeAttribute();
+    if (!attribute || attribute->GetAttributeType() != FbxNodeAttribute::eLODGroup)
+    {
+        return;
+    }
+    FbxLODGroup* lodGroup = static_cast<FbxLODGroup*>(attribute);
+
+    Model* model = NULL;
+    int level = 0;
+    for (Node* child = node->getFirstChild(); child; child = child->getNextSibling())
+    {
+        Model* childModel = child->getModel();
+        if (!childModel)
+        {
+            continue;
+        }
+        if (!model)
+        {
+            model = childModel;
+            continue;
+        }
+
+        // Thresholds given as percentages of the screen are used directly. Distances depend
+        // on the camera, so each of those levels starts at half the size of the previous level.
+        float screenSize = 1.0f / (float)(2 << level);
+        FbxDistance threshold;
+#if FBXSDK_VERSION_MAJOR >= 2014
+        if (lodGroup->ThresholdsUsedAsPercentage.Get() && lodGroup->GetThreshold(level, threshold))
+        {
+            screenSize = threshold.value() * 0.01f;
+        }
+#endif
+        model->addLod(childModel->getMesh(), screenSize);
+        child->setModel(NULL);
+        ++level;
+    }
+}
+
 void FBXSceneEncoder::loadMaterials(FbxScene* fbxScene)
 {
     FbxNode* rootNode = fbxScene->GetRootNode();
@@ -1144,8 +1185,16 @@ Material* FBXSceneEncoder::createMaterial(const string& name, FbxSurfaceMaterial
     MeshSkin* skin = (model) ? model->getSkin() : NULL;
     if (skin && skin->getJointCount() > 0)
     {
-        material->setUniform("u_matrixPalette", "MATRIX_PALETTE");
         material->addDefine("SKINNING");
+        if (EncoderArguments::getInstance()->dualQuaternionSkinningEnabled())
+        {
+            material->setUniform("u_dualQuaternionPalette", "DUAL_QUATERNION_PALETTE");
+            material->addDefine("SKINNING_DUAL_QUATERNION");
+        }
+        else
+        {
+            material->setUniform("u_matrixPalette", "MATRIX_PALETTE");
+        }
         ostringstream stream;
         stream << "SKINNING_JOINT_COUNT " << skin->getJointCount();
         material->addDefine(stream.str());
@@ -133,6 +133,15 @@ private:
      */
     void loadModel(FbxNode* fbxNode, Node* node);
 
+    /**
+     * Turns the models of the children of an FBX LOD group into the levels of detail of
+     * the model of its first child.
+     *
+     * @param fbxNode The FBX node of the LOD group.
+     * @param node The GamePlay node of the LOD group, whose children are already loaded.
+     */
+    void loadLodGroup(FbxNode* fbxNode, Node* node);
+
     /**
      * Loads materials for each node in the scene.
      */
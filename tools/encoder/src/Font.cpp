@@ -7,6 +7,7 @@ namespace gameplay
 Font::Font(void) :
     style(0),
     size(0),
+    format(BITMAP),
     texMapWidth(0),
     texMapHeight(0)
 {
@@ -32,6 +33,7 @@ void Font::writeBinary(FILE* file)
     write(style, file);
     write(size, file);
     write(charset, file);
+    write(format, file);
     writeBinaryObjects(glyphs, file);
     write(texMapWidth, file);
     write(texMapHeight, file);
@@ -44,6 +46,7 @@ void Font::writeText(FILE* file)
     fprintfElement(file, "style", style);
     fprintfElement(file, "size", size);
     fprintfElement(file, "alphabet", charset);
+    fprintfElement(file, "format", format);
     //fprintfElement(file, "glyphs", glyphs);
     fprintfElement(file, "texMapWidth", texMapWidth);
     fprintfElement(file, "texMapHeight", texMapHeight);
@@ -1,5 +1,6 @@
 #include "Base.h"
 #include "GPBDecoder.h"
+#include "GPBFile.h"
 
 namespace gameplay
 {
@@ -54,7 +55,16 @@ bool GPBDecoder::validateHeading()
     // read version
     unsigned char version[2];
     fread(version, sizeof(unsigned char), 2, _file);
-    // don't care about version
+    if (version[1] >= 8)
+    {
+        unsigned int flags = 0;
+        fread(&flags, sizeof(unsigned int), 1, _file);
+        if (flags & GPB_FLAG_LZ4)
+        {
+            LOG(1, "Error: Compressed binary files cannot be decoded.\n");
+            return false;
+        }
+    }
 
     return true;
 }
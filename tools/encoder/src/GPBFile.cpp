@@ -4,8 +4,25 @@
 #include "StringUtil.h"
 #include "EncoderArguments.h"
 #include "Heightmap.h"
+#include "NavigationMesh.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "PackageWriter.h"
 
-#define EPSILON 1.2e-7f;
+// The size of the header of binary files: the identifier, the version and the flags.
+#define GPB_HEADER_SIZE 15
+
+// The largest size of the compressed blocks of binary files, which LZ4 matches can span.
+#define GPB_BLOCK_SIZE 65536
+
+// The size from which a block ends at the next object of the reference table.
+#define GPB_BLOCK_SPLIT_SIZE 16384
+
+// The alignment of the compressed blocks.
+#define GPB_BLOCK_ALIGNMENT 16
+
+// The tolerance of channels compared with the transform of their node, which decomposing the transform loses some precision of.
+#define BIND_POSE_TOLERANCE 0.00001f
 
 namespace gameplay
 {
@@ -13,14 +30,11 @@ namespace gameplay
 static GPBFile* __instance = NULL;
 
 /**
- * Returns true if the given value is close to one.
- */
-static bool isAlmostOne(float value);
-
-/**
- * Returns true if the given value is close to zero.
+ * Gets the value of a transform attribute of a node in its bind pose, with the components of the attribute.
+ *
+ * @return false if the attribute is not a transform attribute or the transform cannot be decomposed.
  */
-static bool isAlmostZero(float value);
+static bool getBindValue(const Node* node, unsigned int attribute, std::vector<float>* value);
 
 /**
  * Gets the common node ancestor for the given list of nodes.
@@ -83,6 +97,9 @@ bool GPBFile::saveBinary(const std::string& filepath)
         return false;
     }
 
+    // flags, set by compressBinary
+    write((unsigned int)0, _file);
+
     // TODO: Check for errors on all file writing.
 
     // write refs
@@ -105,9 +122,142 @@ bool GPBFile::saveBinary(const std::string& filepath)
     _refTable.updateOffsets(_file);
     
     fclose(_file);
+
+    if (EncoderArguments::getInstance()->binaryCompressionEnabled())
+    {
+        return compressBinary(filepath);
+    }
     return true;
 }
 
+/**
+ * Reads an unsigned int from file data, advancing the position.
+ */
+static bool readUint(const std::vector<unsigned char>& data, size_t* position, unsigned int* value)
+{
+    if (data.size() - *position < sizeof(unsigned int))
+        return false;
+    memcpy(value, &data[*position], sizeof(unsigned int));
+    *position += sizeof(unsigned int);
+    return true;
+}
+
+/**
+ * A block of the contents of a compressed binary file.
+ */
+struct GPBBlock
+{
+    unsigned int offset;
+    unsigned int size;
+    unsigned int storedSize;
+    std::vector<unsigned char> data;
+};
+
+bool GPBFile::compressBinary(const std::string& filepath)
+{
+    FILE* file = fopen(filepath.c_str(), "rb");
+    if (!file)
+    {
+        return false;
+    }
+    std::vector<unsigned char> data;
+    unsigned char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        data.insert(data.end(), buffer, buffer + read);
+    fclose(file);
+
+    size_t position = 9 + sizeof(GPB_VERSION);
+    unsigned int flags;
+    if (data.size() < GPB_HEADER_SIZE || !readUint(data, &position, &flags) || (flags & GPB_FLAG_LZ4))
+    {
+        LOG(1, "Error: Not an uncompressed binary file: %s\n", filepath.c_str());
+        return false;
+    }
+
+    // The objects of the reference table are where blocks may start early.
+    std::vector<unsigned int> objectOffsets;
+    unsigned int refCount;
+    if (!readUint(data, &position, &refCount))
+    {
+        return false;
+    }
+    for (unsigned int i = 0; i < refCount; ++i)
+    {
+        unsigned int length, type, offset;
+        if (!readUint(data, &position, &length) || data.size() - position < length)
+        {
+            return false;
+        }
+        position += length;
+        if (!readUint(data, &position, &type) || !readUint(data, &position, &offset))
+        {
+            return false;
+        }
+        objectOffsets.push_back(offset);
+    }
+    std::sort(objectOffsets.begin(), objectOffsets.end());
+
+    std::vector<GPBBlock> blocks;
+    std::vector<unsigned int>::const_iterator nextObject = objectOffsets.begin();
+    for (size_t start = GPB_HEADER_SIZE; start < data.size(); )
+    {
+        size_t end = std::min(start + GPB_BLOCK_SIZE, data.size());
+        while (nextObject != objectOffsets.end() && *nextObject < start + GPB_BLOCK_SPLIT_SIZE)
+            ++nextObject;
+        if (nextObject != objectOffsets.end() && *nextObject < end)
+            end = *nextObject;
+
+        GPBBlock block;
+        block.size = (unsigned int)(end - start);
+        compressLZ4(&data[start], block.size, block.data);
+        if (block.data.size() >= block.size - block.size / 8)
+        {
+            block.data.assign(data.begin() + start, data.begin() + end);
+        }
+        block.storedSize = (unsigned int)block.data.size();
+        blocks.push_back(block);
+        start = end;
+    }
+
+    size_t offset = GPB_HEADER_SIZE + sizeof(unsigned int) * (1 + blocks.size() * 3);
+    size_t storedSize = 0;
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        offset = (offset + GPB_BLOCK_ALIGNMENT - 1) & ~(size_t)(GPB_BLOCK_ALIGNMENT - 1);
+        blocks[i].offset = (unsigned int)offset;
+        offset += blocks[i].storedSize;
+        storedSize += blocks[i].storedSize;
+    }
+
+    file = fopen(filepath.c_str(), "wb");
+    if (!file)
+    {
+        return false;
+    }
+    flags |= GPB_FLAG_LZ4;
+    fwrite(&data[0], 1, 9 + sizeof(GPB_VERSION), file);
+    write(flags, file);
+    write((unsigned int)blocks.size(), file);
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        write(blocks[i].offset, file);
+        write(blocks[i].size, file);
+        write(blocks[i].storedSize, file);
+    }
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        while ((size_t)ftell(file) < blocks[i].offset)
+            fputc(0, file);
+        fwrite(&blocks[i].data[0], 1, blocks[i].storedSize, file);
+    }
+    bool written = ferror(file) == 0;
+    fclose(file);
+
+    LOG(2, "Compressed %u bytes to %u bytes in %u blocks.\n", (unsigned int)(data.size() - GPB_HEADER_SIZE), (unsigned int)storedSize, (unsigned int)blocks.size());
+    return written;
+}
+
 bool GPBFile::saveText(const std::string& filepath)
 {
     _file = fopen(filepath.c_str(), "w");
@@ -320,12 +470,36 @@ void GPBFile::adjust()
         computeBounds(*i);
     }
 
+    if (!EncoderArguments::getInstance()->getLodRatios().empty())
+    {
+        LOG(1, "Generating levels of detail.\n");
+        generateLods();
+    }
+
+    if (EncoderArguments::getInstance()->optimizeMeshesEnabled())
+    {
+        LOG(1, "Optimizing meshes.\n");
+        optimizeMeshes();
+    }
+
+    if (EncoderArguments::getInstance()->quantizeVerticesEnabled())
+    {
+        LOG(1, "Quantizing vertices.\n");
+        quantizeMeshes();
+    }
+
     if (EncoderArguments::getInstance()->optimizeAnimationsEnabled())
     {
         LOG(1, "Optimizing animations.\n");
         optimizeAnimations();
     }
 
+    if (EncoderArguments::getInstance()->compressAnimationsEnabled())
+    {
+        LOG(1, "Compressing animations.\n");
+        compressAnimations();
+    }
+
     // TODO:
     // remove ambient _lights
     // for each node
@@ -339,6 +513,18 @@ void GPBFile::adjust()
     //   Blender will output a simple translation animation to 3 separate animations with the same key times but targeting X, Y and Z.
     //   This can be merged into one animation. Same for scale animations.
 
+    // Generate navigation meshes
+    const std::vector<EncoderArguments::NavigationMeshOption>& navigationMeshes = EncoderArguments::getInstance()->getNavigationMeshOptions();
+    for (unsigned int i = 0, count = navigationMeshes.size(); i < count; ++i)
+    {
+        NavigationMesh* navigationMesh = NavigationMesh::generate(navigationMeshes[i].nodeIds, navigationMeshes[i].maxSlope, navigationMeshes[i].id.c_str());
+        if (navigationMesh)
+        {
+            addToRefTable(navigationMesh);
+            _objects.push_back(navigationMesh);
+        }
+    }
+
     // Generate heightmaps
     const std::vector<EncoderArguments::HeightmapOption>& heightmaps = EncoderArguments::getInstance()->getHeightmapOptions();
     for (unsigned int i = 0, count = heightmaps.size(); i < count; ++i)
@@ -398,6 +584,99 @@ void GPBFile::computeBounds(Node* node)
     }
 }
 
+void GPBFile::generateLods()
+{
+    const std::vector<float>& ratios = EncoderArguments::getInstance()->getLodRatios();
+
+    // Meshes shared by several models are only simplified once.
+    std::map<Mesh*, std::pair<std::vector<Mesh*>, std::vector<float> > > lods;
+    for (std::list<Node*>::const_iterator i = _nodes.begin(); i != _nodes.end(); ++i)
+    {
+        Model* model = (*i)->getModel();
+        Mesh* mesh = model ? model->getMesh() : NULL;
+        if (!mesh || model->getLodCount() > 0)
+        {
+            continue;
+        }
+
+        std::map<Mesh*, std::pair<std::vector<Mesh*>, std::vector<float> > >::iterator it = lods.find(mesh);
+        if (it == lods.end())
+        {
+            it = lods.insert(std::make_pair(mesh, std::make_pair(std::vector<Mesh*>(), std::vector<float>()))).first;
+            MeshSimplifier simplifier(mesh);
+            simplifier.simplify(ratios, &it->second.first, &it->second.second);
+            for (unsigned int j = 0; j < it->second.first.size(); ++j)
+            {
+                Mesh* lod = it->second.first[j];
+                lod->computeBounds();
+                addMesh(lod);
+            }
+        }
+
+        // The triangles covering the screen stay about as dense when a level with a fraction
+        // r of the triangles is used below a fraction sqrt(r) of the viewport height.
+        for (unsigned int j = 0; j < it->second.first.size(); ++j)
+        {
+            model->addLod(it->second.first[j], sqrt(it->second.second[j]));
+        }
+    }
+}
+
+void GPBFile::optimizeMeshes()
+{
+    for (std::list<Mesh*>::const_iterator i = _geometry.begin(); i != _geometry.end(); ++i)
+    {
+        MeshOptimizer optimizer(*i);
+        optimizer.optimize();
+    }
+}
+
+void GPBFile::quantizeMeshes()
+{
+    for (std::list<Mesh*>::const_iterator i = _geometry.begin(); i != _geometry.end(); ++i)
+    {
+        (*i)->quantizeVertexFormat();
+    }
+}
+
+void GPBFile::compressAnimations()
+{
+    float translationTolerance, rotationTolerance, scaleTolerance;
+    EncoderArguments::getInstance()->getAnimationTolerances(&translationTolerance, &rotationTolerance, &scaleTolerance);
+    const unsigned int animationCount = _animations.getAnimationCount();
+    for (unsigned int animationIndex = 0; animationIndex < animationCount; ++animationIndex)
+    {
+        Animation* animation = _animations.getAnimation(animationIndex);
+        assert(animation);
+
+        const unsigned int channelCount = animation->getAnimationChannelCount();
+        LOG(2, "Compressing %u channel(s) in animation '%s'.\n", channelCount, animation->getId().c_str());
+
+        // Loop backwards because channels are removed.
+        for (int channelIndex = (int)channelCount - 1; channelIndex >= 0; --channelIndex)
+        {
+            AnimationChannel* channel = animation->getAnimationChannel(channelIndex);
+            assert(channel);
+
+            // Channels that hold the transform of their node throughout do not change it, so they are
+            // removed. The last channel is kept, so that the animation can still be found and played.
+            const Object* obj = _refTable.get(channel->getTargetId());
+            std::vector<float> bindValue;
+            if (animation->getAnimationChannelCount() > 1 && obj && obj->getTypeId() == Object::NODE_ID &&
+                getBindValue(static_cast<const Node*>(obj), channel->getTargetAttribute(), &bindValue) &&
+                channel->isConstant(&bindValue[0], std::max(translationTolerance, BIND_POSE_TOLERANCE),
+                                    std::max(rotationTolerance, BIND_POSE_TOLERANCE), std::max(scaleTolerance, BIND_POSE_TOLERANCE)))
+            {
+                LOG(3, "  Removing channel of '%s' that holds its bind pose.\n", channel->getTargetId().c_str());
+                animation->remove(channel);
+                SAFE_DELETE(channel);
+                continue;
+            }
+            channel->compress(translationTolerance, rotationTolerance, scaleTolerance);
+        }
+    }
+}
+
 void GPBFile::optimizeAnimations()
 {
     const unsigned int animationCount = _animations.getAnimationCount();
@@ -465,87 +744,50 @@ void GPBFile::decomposeTransformAnimationChannel(Animation* animation, Animation
         translateKeyValues.push_back(keyValues[kv+9]);
     }
 
-    // replace transform animation channel with translate, rotate and scale animation channels
-
-    // Don't add the scale channel if all the key values are close to 1.0
-    size_t oneCount = (size_t)std::count_if(scaleKeyValues.begin(), scaleKeyValues.end(), isAlmostOne);
-    if (scaleKeyValues.size() == oneCount)
-    {
-        LOG(2, "    Discarding scale channel.\n");
-    }
-    else
-    {
-        LOG(3, "    Keeping scale channel.\n");
-        AnimationChannel* scaleChannel = new AnimationChannel();
-        scaleChannel->setTargetId(channel->getTargetId());
-        scaleChannel->setKeyTimes(channel->getKeyTimes());
-        scaleChannel->setTangentsIn(channel->getTangentsIn());
-        scaleChannel->setTangentsOut(channel->getTangentsOut());
-        scaleChannel->setInterpolations(channel->getInterpolationTypes());
-        scaleChannel->setTargetAttribute(Transform::ANIMATE_SCALE);
-        scaleChannel->setKeyValues(scaleKeyValues);
-        scaleChannel->removeDuplicates();
-        animation->add(scaleChannel);
-    }
-
-    // Don't add the rotation channel if all quaternions are close to identity
-    oneCount = 0;
-    for (unsigned int i = 0, count = rotateKeyValues.size(); i < count; i += 4)
-    {
-        float x = rotateKeyValues[i];
-        float y = rotateKeyValues[i+1];
-        float z = rotateKeyValues[i+2];
-        float w = rotateKeyValues[i+3];
-        if (ISZERO(x) && ISZERO(y) && ISZERO(z) && ISONE(w))
-            ++oneCount;
+    // Replace the transform animation channel with scale, rotation and translation channels,
+    // leaving out those that hold the transform of the node throughout.
+    Vector3 bindScale(1.0f, 1.0f, 1.0f);
+    Quaternion bindRotation;
+    Vector3 bindTranslation;
+    const Node* node = static_cast<const Node*>(_refTable.get(channel->getTargetId()));
+    node->getTransformMatrix().decompose(&bindScale, &bindRotation, &bindTranslation);
+    const float bindValues[10] = { bindScale.x, bindScale.y, bindScale.z, bindRotation.x, bindRotation.y, bindRotation.z, bindRotation.w,
+                                   bindTranslation.x, bindTranslation.y, bindTranslation.z };
+
+    const struct
+    {
+        unsigned int attribute;
+        const std::vector<float>* keyValues;
+        const float* bindValue;
+        const char* name;
+    } parts[] =
+    {
+        { Transform::ANIMATE_SCALE, &scaleKeyValues, &bindValues[0], "scale" },
+        { Transform::ANIMATE_ROTATE, &rotateKeyValues, &bindValues[3], "rotation" },
+        { Transform::ANIMATE_TRANSLATE, &translateKeyValues, &bindValues[7], "translation" }
+    };
+    for (size_t i = 0; i < sizeof(parts) / sizeof(parts[0]); ++i)
+    {
+        AnimationChannel* partChannel = new AnimationChannel();
+        partChannel->setTargetId(channel->getTargetId());
+        partChannel->setKeyTimes(channel->getKeyTimes());
+        partChannel->setTangentsIn(channel->getTangentsIn());
+        partChannel->setTangentsOut(channel->getTangentsOut());
+        partChannel->setInterpolations(channel->getInterpolationTypes());
+        partChannel->setTargetAttribute(parts[i].attribute);
+        partChannel->setKeyValues(*parts[i].keyValues);
+        if (partChannel->isConstant(parts[i].bindValue, BIND_POSE_TOLERANCE, BIND_POSE_TOLERANCE, BIND_POSE_TOLERANCE))
+        {
+            LOG(2, "    Discarding %s channel.\n", parts[i].name);
+            SAFE_DELETE(partChannel);
+        }
         else
         {
-            LOG(4, "Rotation not identity: %u\n", i);
-            Quaternion q(x, y, z, w);
-            Vector3 axis;
-            float angle = q.toAxisAngle(&axis);
-            angle = 0;
+            LOG(3, "    Keeping %s channel.\n", parts[i].name);
+            partChannel->removeDuplicates();
+            animation->add(partChannel);
         }
     }
-    if ((rotateKeyValues.size()>>2) == oneCount)
-    {
-        LOG(2, "    Discarding rotation channel.\n");
-    }
-    else
-    {
-        LOG(3, "    Keeping rotation channel.\n");
-        AnimationChannel* rotateChannel = new AnimationChannel();
-        rotateChannel->setTargetId(channel->getTargetId());
-        rotateChannel->setKeyTimes(channel->getKeyTimes());
-        rotateChannel->setTangentsIn(channel->getTangentsIn());
-        rotateChannel->setTangentsOut(channel->getTangentsOut());
-        rotateChannel->setInterpolations(channel->getInterpolationTypes());
-        rotateChannel->setTargetAttribute(Transform::ANIMATE_ROTATE);
-        rotateChannel->setKeyValues(rotateKeyValues);
-        rotateChannel->removeDuplicates();
-        animation->add(rotateChannel);
-    }
-
-    // Don't add the translation channel if all values are close to zero
-    oneCount = (size_t)std::count_if(translateKeyValues.begin(), translateKeyValues.end(), isAlmostZero);
-    if (translateKeyValues.size() == oneCount)
-    {
-        LOG(2, "    Discarding translation channel.\n");
-    }
-    else
-    {
-        LOG(3, "    Keeping translation channel.\n");
-        AnimationChannel* translateChannel = new AnimationChannel();
-        translateChannel->setTargetId(channel->getTargetId());
-        translateChannel->setKeyTimes(channel->getKeyTimes());
-        translateChannel->setTangentsIn(channel->getTangentsIn());
-        translateChannel->setTangentsOut(channel->getTangentsOut());
-        translateChannel->setInterpolations(channel->getInterpolationTypes());
-        translateChannel->setTargetAttribute(Transform::ANIMATE_TRANSLATE);
-        translateChannel->setKeyValues(translateKeyValues);
-        translateChannel->removeDuplicates();
-        animation->add(translateChannel);
-    }
 }
 
 void GPBFile::moveAnimationChannels(Node* node, Animation* dstAnimation)
@@ -576,14 +818,62 @@ void GPBFile::moveAnimationChannels(Node* node, Animation* dstAnimation)
     }
 }
 
-bool isAlmostOne(float value)
+bool getBindValue(const Node* node, unsigned int attribute, std::vector<float>* value)
 {
-    return (value - 1.0f) < EPSILON;
-}
+    Vector3 scale;
+    Quaternion rotation;
+    Vector3 translation;
+    if (!node->getTransformMatrix().decompose(&scale, &rotation, &translation))
+        return false;
 
-bool isAlmostZero(float value)
-{
-    return std::fabs(value) < EPSILON;
+    const float s[3] = { scale.x, scale.y, scale.z };
+    const float r[4] = { rotation.x, rotation.y, rotation.z, rotation.w };
+    const float t[3] = { translation.x, translation.y, translation.z };
+    bool hasScale = false, hasRotation = false, hasTranslation = false;
+    value->clear();
+    switch (attribute)
+    {
+    case Transform::ANIMATE_SCALE_ROTATE_TRANSLATE:
+        hasScale = hasRotation = hasTranslation = true;
+        break;
+    case Transform::ANIMATE_SCALE_ROTATE:
+        hasScale = hasRotation = true;
+        break;
+    case Transform::ANIMATE_SCALE_TRANSLATE:
+        hasScale = hasTranslation = true;
+        break;
+    case Transform::ANIMATE_ROTATE_TRANSLATE:
+        hasRotation = hasTranslation = true;
+        break;
+    case Transform::ANIMATE_SCALE:
+        hasScale = true;
+        break;
+    case Transform::ANIMATE_ROTATE:
+        hasRotation = true;
+        break;
+    case Transform::ANIMATE_TRANSLATE:
+        hasTranslation = true;
+        break;
+    case Transform::ANIMATE_SCALE_X:
+    case Transform::ANIMATE_SCALE_Y:
+    case Transform::ANIMATE_SCALE_Z:
+        value->push_back(s[attribute - Transform::ANIMATE_SCALE_X]);
+        return true;
+    case Transform::ANIMATE_TRANSLATE_X:
+    case Transform::ANIMATE_TRANSLATE_Y:
+    case Transform::ANIMATE_TRANSLATE_Z:
+        value->push_back(t[attribute - Transform::ANIMATE_TRANSLATE_X]);
+        return true;
+    default:
+        return false;
+    }
+    if (hasScale)
+        value->insert(value->end(), s, s + 3);
+    if (hasRotation)
+        value->insert(value->end(), r, r + 4);
+    if (hasTranslation)
+        value->insert(value->end(), t, t + 3);
+    return true;
 }
 
 Node* getCommonNodeAncestor(const std::vector<Node*>& nodes)
@@ -21,7 +21,12 @@ namespace gameplay
  * Increment the version number when making a change that break binary compatibility.
  * [0] is major, [1] is minor.
  */
-const unsigned char GPB_VERSION[2] = {1, 2};
+const unsigned char GPB_VERSION[2] = {1, 8};
+
+/**
+ * The flag of the header of files whose contents are compressed in LZ4 blocks.
+ */
+const unsigned int GPB_FLAG_LZ4 = 1;
 
 /**
  * The GamePlay Binary file class handles writing the GamePlay Binary file.
@@ -54,6 +59,21 @@ public:
      */
     bool saveBinary(const std::string& filepath);
 
+    /**
+     * Compresses the contents of a binary file in place, in LZ4 blocks.
+     *
+     * The contents after the header are split into blocks of at most 64 KB, which start at
+     * the objects of the reference table once they hold 16 KB, so loading an object only
+     * decompresses the blocks it spans. Each block is stored compressed if LZ4 makes it
+     * smaller by at least an eighth, or as is, and aligned to 16 bytes. The offsets of the
+     * reference table are unchanged, since they are those of the uncompressed contents.
+     *
+     * @param filepath The path of a binary file that is not compressed.
+     * 
+     * @return True if successful, false if error.
+     */
+    static bool compressBinary(const std::string& filepath);
+
     /**
      * Saves the GPBFile as a text file at filepath. Useful for debugging.
      *
@@ -127,11 +147,31 @@ private:
      */
     void computeBounds(Node* node);
 
+    /**
+     * Generates simplified levels of detail for the models that have none.
+     */
+    void generateLods();
+
+    /**
+     * Reorders the triangles and vertices of every mesh for faster drawing.
+     */
+    void optimizeMeshes();
+
+    /**
+     * Writes the vertices of every mesh with smaller types than floats.
+     */
+    void quantizeMeshes();
+
     /**
      * Optimizes animation data by removing unneccessary channels and keyframes.
      */
     void optimizeAnimations();
 
+    /**
+     * Removes keyframes within the animation tolerance and quantizes the key values of every animation channel.
+     */
+    void compressAnimations();
+
     /**
      * Decomposes an ANIMATE_SCALE_ROTATE_TRANSLATE channel into 3 new channels. (Scale, Rotate and Translate)
      * 
@@ -0,0 +1,91 @@
+#include "Base.h"
+#include "LuaCompiler.h"
+#include <lua.hpp>
+
+// The identifier at the start of compiled chunks, which must match gameplay's ScriptController.
+#define SCRIPT_CHUNK_IDENTIFIER "\xABGPL"
+
+namespace gameplay
+{
+
+/**
+ * Returns a 64-bit hash of the source of a script (FNV-1a), as ScriptController computes it.
+ */
+static unsigned long long hashSource(const std::vector<char>& source)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    for (size_t i = 0, count = source.size(); i < count; ++i)
+    {
+        hash ^= (unsigned char)source[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * Appends the output of lua_dump to a vector.
+ */
+static int writeChunkData(lua_State* state, const void* data, size_t size, void* userdata)
+{
+    std::vector<char>* chunk = (std::vector<char>*)userdata;
+    chunk->insert(chunk->end(), (const char*)data, (const char*)data + size);
+    return 0;
+}
+
+int compileScript(const char* inFilePath, const char* outFilePath)
+{
+    FILE* file = fopen(inFilePath, "rb");
+    if (!file)
+    {
+        LOG(1, "Error: Failed to open script: %s\n", inFilePath);
+        return -1;
+    }
+    std::vector<char> source;
+    char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        source.insert(source.end(), buffer, buffer + read);
+    fclose(file);
+
+    // The chunk is named like the runtime names scripts, so error messages match.
+    std::string name = std::string("@") + inFilePath;
+    lua_State* state = luaL_newstate();
+    if (!state)
+    {
+        LOG(1, "Error: Failed to create a Lua state.\n");
+        return -1;
+    }
+    if (luaL_loadbuffer(state, source.empty() ? "" : &source[0], source.size(), name.c_str()))
+    {
+        LOG(1, "Error: Failed to compile script: %s\n", lua_tostring(state, -1));
+        lua_close(state);
+        return -1;
+    }
+    std::vector<char> chunk;
+    int result = lua_dump(state, writeChunkData, &chunk);
+    lua_close(state);
+    if (result != 0 || chunk.empty())
+    {
+        LOG(1, "Error: Failed to write the bytecode of script: %s\n", inFilePath);
+        return -1;
+    }
+
+    file = fopen(outFilePath, "wb");
+    if (!file)
+    {
+        LOG(1, "Error: Failed to open file for writing: %s\n", outFilePath);
+        return -1;
+    }
+    unsigned int version = LUA_VERSION_NUM;
+    unsigned long long hash = hashSource(source);
+    fwrite(SCRIPT_CHUNK_IDENTIFIER, 1, sizeof(SCRIPT_CHUNK_IDENTIFIER) - 1, file);
+    fwrite(&version, sizeof(version), 1, file);
+    fwrite(&hash, sizeof(hash), 1, file);
+    fwrite(&chunk[0], 1, chunk.size(), file);
+    fclose(file);
+
+    LOG(1, "Compiled script: %s\n", outFilePath);
+    return 0;
+}
+
+}
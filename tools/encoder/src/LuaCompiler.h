@@ -0,0 +1,24 @@
+#ifndef LUACOMPILER_H_
+#define LUACOMPILER_H_
+
+namespace gameplay
+{
+
+/**
+ * Compiles a Lua script to the chunk format that ScriptController::loadScript runs scripts from.
+ *
+ * The chunk starts with an identifier, the version of Lua that compiled it and a hash of
+ * the source, followed by the Lua bytecode. The runtime only uses a chunk that was compiled
+ * from the current source by its own version of Lua (and architecture), and compiles the
+ * source otherwise. Write the chunk next to the script with the extension ".luac".
+ *
+ * @param inFilePath The path of the script.
+ * @param outFilePath The path of the chunk to write.
+ *
+ * @return 0 if successful, -1 if error.
+ */
+int compileScript(const char* inFilePath, const char* outFilePath);
+
+}
+
+#endif
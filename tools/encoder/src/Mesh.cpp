@@ -5,6 +5,42 @@
 namespace gameplay
 {
 
+// Gets the values of a vertex for a vertex element usage, as floats.
+static void getVertexValues(const Vertex& vertex, unsigned int usage, float* values)
+{
+    values[0] = values[1] = values[2] = values[3] = 0.0f;
+    switch (usage)
+    {
+    case POSITION:
+        memcpy(values, &vertex.position.x, 3 * sizeof(float));
+        break;
+    case NORMAL:
+        memcpy(values, &vertex.normal.x, 3 * sizeof(float));
+        break;
+    case TANGENT:
+        memcpy(values, &vertex.tangent.x, 3 * sizeof(float));
+        break;
+    case BINORMAL:
+        memcpy(values, &vertex.binormal.x, 3 * sizeof(float));
+        break;
+    case COLOR:
+        memcpy(values, &vertex.diffuse.x, 4 * sizeof(float));
+        break;
+    case BLENDWEIGHTS:
+        memcpy(values, &vertex.blendWeights.x, 4 * sizeof(float));
+        break;
+    case BLENDINDICES:
+        memcpy(values, &vertex.blendIndices.x, 4 * sizeof(float));
+        break;
+    default:
+        if (usage >= TEXCOORD0 && usage <= TEXCOORD7)
+        {
+            memcpy(values, &vertex.texCoord[usage - TEXCOORD0].x, 2 * sizeof(float));
+        }
+        break;
+    }
+}
+
 Mesh::Mesh(void) : model(NULL)
 {
 }
@@ -40,7 +76,29 @@ void Mesh::writeBinary(FILE* file)
 
 void Mesh::writeBinaryVertices(FILE* file)
 {
-    if (vertices.size() > 0)
+    bool quantized = false;
+    unsigned int vertexSize = 0;
+    for (std::vector<VertexElement>::const_iterator i = _vertexFormat.begin(); i != _vertexFormat.end(); ++i)
+    {
+        quantized |= i->type != VertexElement::FLOAT;
+        vertexSize += i->byteSize();
+    }
+
+    if (vertices.size() > 0 && quantized)
+    {
+        write((unsigned int)(vertices.size() * vertexSize), file);
+
+        float values[4];
+        for (std::vector<Vertex>::const_iterator i = vertices.begin(); i != vertices.end(); ++i)
+        {
+            for (std::vector<VertexElement>::const_iterator e = _vertexFormat.begin(); e != _vertexFormat.end(); ++e)
+            {
+                getVertexValues(*i, e->usage, values);
+                e->writeBinaryValues(values, file);
+            }
+        }
+    }
+    else if (vertices.size() > 0)
     {
         // Assumes that all vertices are the same size.
         // Write the number of bytes for the vertex data
@@ -126,6 +184,49 @@ void Mesh::addVetexAttribute(unsigned int usage, unsigned int count)
     _vertexFormat.push_back(VertexElement(usage, count));
 }
 
+void Mesh::quantizeVertexFormat()
+{
+    float values[4];
+    for (std::vector<VertexElement>::iterator i = _vertexFormat.begin(); i != _vertexFormat.end(); ++i)
+    {
+        switch (i->usage)
+        {
+        case NORMAL:
+        case TANGENT:
+        case BINORMAL:
+            *i = VertexElement(i->usage, 4, VertexElement::INT_2_10_10_10_REV, true);
+            break;
+        case COLOR:
+        case BLENDWEIGHTS:
+            *i = VertexElement(i->usage, i->size, VertexElement::UNSIGNED_BYTE, true);
+            break;
+        case BLENDINDICES:
+            {
+                float maxIndex = 0.0f;
+                for (std::vector<Vertex>::const_iterator v = vertices.begin(); v != vertices.end(); ++v)
+                {
+                    getVertexValues(*v, i->usage, values);
+                    maxIndex = std::max(maxIndex, std::max(std::max(values[0], values[1]), std::max(values[2], values[3])));
+                }
+                *i = VertexElement(i->usage, i->size, maxIndex < 256.0f ? VertexElement::UNSIGNED_BYTE : VertexElement::UNSIGNED_SHORT, false);
+            }
+            break;
+        default:
+            if (i->usage >= TEXCOORD0 && i->usage <= TEXCOORD7)
+            {
+                bool unit = true;
+                for (std::vector<Vertex>::const_iterator v = vertices.begin(); v != vertices.end() && unit; ++v)
+                {
+                    getVertexValues(*v, i->usage, values);
+                    unit = values[0] >= 0.0f && values[0] <= 1.0f && values[1] >= 0.0f && values[1] <= 1.0f;
+                }
+                *i = VertexElement(i->usage, i->size, unit ? VertexElement::UNSIGNED_SHORT : VertexElement::HALF_FLOAT, unit);
+            }
+            break;
+        }
+    }
+}
+
 size_t Mesh::getVertexCount() const
 {
     return vertices.size();
@@ -42,6 +42,14 @@ public:
     void addMeshPart(Vertex* vertex);
     void addVetexAttribute(unsigned int usage, unsigned int count);
 
+    /**
+     * Changes the vertex format to write normals, tangents and binormals as 10:10:10:2 integers,
+     * colors and blend weights as bytes, blend indices as bytes or shorts, and texture coordinates
+     * as normalized shorts if they are all between 0 and 1, or half floats otherwise.
+     * Positions are kept as floats.
+     */
+    void quantizeVertexFormat();
+
     size_t getVertexCount() const;
     const Vertex& getVertex(unsigned int index) const;
 
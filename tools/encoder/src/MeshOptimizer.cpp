@@ -0,0 +1,334 @@
+#include "Base.h"
+#include "MeshOptimizer.h"
+
+namespace gameplay
+{
+
+// The number of vertices assumed to fit in the post-transform cache.
+static const unsigned int CACHE_SIZE = 16;
+
+MeshOptimizer::MeshOptimizer(Mesh* mesh) :
+    _mesh(mesh)
+{
+    assert(mesh);
+}
+
+MeshOptimizer::~MeshOptimizer()
+{
+}
+
+void MeshOptimizer::optimize()
+{
+    const unsigned int vertexCount = _mesh->getVertexCount();
+    if (vertexCount == 0)
+    {
+        return;
+    }
+
+    std::vector<std::vector<unsigned int> > parts(_mesh->parts.size());
+    std::vector<unsigned int> before;
+    for (unsigned int i = 0; i < _mesh->parts.size(); ++i)
+    {
+        const MeshPart* part = _mesh->parts[i];
+        std::vector<unsigned int>& indices = parts[i];
+        indices.resize(part->getIndicesCount());
+        for (unsigned int j = 0; j < indices.size(); ++j)
+        {
+            indices[j] = part->getIndex(j);
+            if (indices[j] >= vertexCount)
+            {
+                LOG(1, "Warning: Mesh '%s' has an index out of range and is not optimized.\n", _mesh->getId().c_str());
+                return;
+            }
+        }
+        before.insert(before.end(), indices.begin(), indices.end());
+    }
+
+    for (unsigned int i = 0; i < parts.size(); ++i)
+    {
+        if (parts[i].size() % 3 != 0)
+        {
+            LOG(1, "Warning: Mesh part of '%s' is not a triangle list and is not optimized.\n", _mesh->getId().c_str());
+            continue;
+        }
+
+        std::vector<unsigned int> clusters;
+        optimizeVertexCache(parts[i], &clusters);
+        optimizeOverdraw(parts[i], clusters);
+    }
+
+    optimizeVertexFetch(parts);
+
+    std::vector<unsigned int> after;
+    for (unsigned int i = 0; i < _mesh->parts.size(); ++i)
+    {
+        _mesh->parts[i]->setIndices(parts[i]);
+        after.insert(after.end(), parts[i].begin(), parts[i].end());
+    }
+
+    LOG(2, "Optimized mesh '%s' from %.3f to %.3f vertices transformed per triangle.\n", _mesh->getId().c_str(),
+        computeACMR(before, vertexCount, CACHE_SIZE), computeACMR(after, vertexCount, CACHE_SIZE));
+}
+
+float MeshOptimizer::computeACMR(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize)
+{
+    if (indices.size() < 3)
+    {
+        return 0.0f;
+    }
+
+    // A vertex is in the cache until cacheSize other vertices missed after it.
+    std::vector<unsigned int> evictions(vertexCount, 0);
+    unsigned int misses = 0;
+    for (unsigned int i = 0; i < indices.size(); ++i)
+    {
+        unsigned int v = indices[i];
+        if (v < vertexCount && misses >= evictions[v])
+        {
+            evictions[v] = misses + cacheSize + 1;
+            ++misses;
+        }
+    }
+    return (float)misses / (float)(indices.size() / 3);
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<unsigned int>& indices, std::vector<unsigned int>* clusters) const
+{
+    const unsigned int vertexCount = _mesh->getVertexCount();
+    const unsigned int triangleCount = indices.size() / 3;
+
+    std::vector<std::vector<unsigned int> > vertexTriangles(vertexCount);
+    std::vector<unsigned int> live(vertexCount, 0);
+    for (unsigned int i = 0; i < triangleCount; ++i)
+    {
+        for (unsigned int k = 0; k < 3; ++k)
+        {
+            unsigned int v = indices[i * 3 + k];
+            vertexTriangles[v].push_back(i);
+            ++live[v];
+        }
+    }
+
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+    std::vector<unsigned int> timestamps(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> deadEnds;
+    std::vector<unsigned int> candidates;
+    unsigned int time = CACHE_SIZE + 1;
+    unsigned int cursor = 0;
+
+    while (cursor < vertexCount && live[cursor] == 0)
+    {
+        ++cursor;
+    }
+    int fan = cursor < vertexCount ? (int)cursor : -1;
+    clusters->clear();
+    if (fan >= 0)
+    {
+        clusters->push_back(0);
+    }
+
+    while (fan >= 0)
+    {
+        // Emit all the triangles around the fanning vertex.
+        candidates.clear();
+        const std::vector<unsigned int>& triangles = vertexTriangles[fan];
+        for (unsigned int i = 0; i < triangles.size(); ++i)
+        {
+            unsigned int t = triangles[i];
+            if (emitted[t])
+            {
+                continue;
+            }
+            for (unsigned int k = 0; k < 3; ++k)
+            {
+                unsigned int v = indices[t * 3 + k];
+                output.push_back(v);
+                deadEnds.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+                if (time - timestamps[v] > CACHE_SIZE)
+                {
+                    timestamps[v] = time++;
+                }
+            }
+            emitted[t] = true;
+        }
+
+        // Fan next around the oldest vertex that will still be in the cache once its
+        // remaining triangles are emitted.
+        int next = -1;
+        int bestPriority = -1;
+        for (unsigned int i = 0; i < candidates.size(); ++i)
+        {
+            unsigned int v = candidates[i];
+            if (live[v] == 0)
+            {
+                continue;
+            }
+            int priority = 0;
+            if (time - timestamps[v] + 2 * live[v] <= CACHE_SIZE)
+            {
+                priority = time - timestamps[v];
+            }
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                next = v;
+            }
+        }
+
+        if (next < 0)
+        {
+            // Dead end: go back to a recently used vertex, or else the next vertex in index order.
+            // The triangles after a dead end start a new cluster for the overdraw ordering.
+            while (next < 0 && !deadEnds.empty())
+            {
+                unsigned int v = deadEnds.back();
+                deadEnds.pop_back();
+                if (live[v] > 0)
+                {
+                    next = v;
+                }
+            }
+            while (next < 0 && cursor < vertexCount)
+            {
+                if (live[cursor] > 0)
+                {
+                    next = cursor;
+                }
+                else
+                {
+                    ++cursor;
+                }
+            }
+            if (next >= 0)
+            {
+                clusters->push_back(output.size() / 3);
+            }
+        }
+        fan = next;
+    }
+
+    indices.swap(output);
+}
+
+void MeshOptimizer::optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<unsigned int>& clusters) const
+{
+    const unsigned int triangleCount = indices.size() / 3;
+    if (clusters.size() < 2)
+    {
+        return;
+    }
+
+    // Area weighted centroid and normal of each cluster, and centroid of the part.
+    const std::vector<Vertex>& vertices = _mesh->vertices;
+    std::vector<Vector3> centroids(clusters.size());
+    std::vector<Vector3> normals(clusters.size());
+    std::vector<float> areas(clusters.size(), 0.0f);
+    Vector3 partCentroid;
+    float partArea = 0.0f;
+    for (unsigned int c = 0; c < clusters.size(); ++c)
+    {
+        unsigned int end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+        for (unsigned int t = clusters[c]; t < end; ++t)
+        {
+            const Vector3& p0 = vertices[indices[t * 3]].position;
+            const Vector3& p1 = vertices[indices[t * 3 + 1]].position;
+            const Vector3& p2 = vertices[indices[t * 3 + 2]].position;
+            Vector3 e1, e2, normal;
+            Vector3::subtract(p1, p0, &e1);
+            Vector3::subtract(p2, p0, &e2);
+            Vector3::cross(e1, e2, &normal);
+            float area = normal.length() * 0.5f;
+
+            Vector3 centroid(p0);
+            centroid.add(p1);
+            centroid.add(p2);
+            centroid.scale(area / 3.0f);
+            centroids[c].add(centroid);
+            normals[c].add(normal);
+            areas[c] += area;
+        }
+        partCentroid.add(centroids[c]);
+        partArea += areas[c];
+    }
+    if (partArea <= 0.0f)
+    {
+        return;
+    }
+    partCentroid.scale(1.0f / partArea);
+
+    // Clusters that face away from the center of the part are drawn first.
+    std::vector<std::pair<float, unsigned int> > order(clusters.size());
+    for (unsigned int c = 0; c < clusters.size(); ++c)
+    {
+        float score = 0.0f;
+        float length = normals[c].length();
+        if (areas[c] > 0.0f && length > 0.0f)
+        {
+            Vector3 offset(centroids[c]);
+            offset.scale(1.0f / areas[c]);
+            Vector3::subtract(offset, partCentroid, &offset);
+            score = Vector3::dot(offset, normals[c]) / length;
+        }
+        order[c] = std::make_pair(-score, c);
+    }
+    std::stable_sort(order.begin(), order.end());
+
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+    for (unsigned int i = 0; i < order.size(); ++i)
+    {
+        unsigned int c = order[i].second;
+        unsigned int end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+        output.insert(output.end(), indices.begin() + clusters[c] * 3, indices.begin() + end * 3);
+    }
+    indices.swap(output);
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<std::vector<unsigned int> >& parts)
+{
+    const unsigned int vertexCount = _mesh->getVertexCount();
+    const unsigned int unused = (unsigned int)-1;
+
+    // Number the vertices in the order they are first drawn, and keep unused vertices at the end.
+    std::vector<unsigned int> remap(vertexCount, unused);
+    unsigned int next = 0;
+    for (unsigned int i = 0; i < parts.size(); ++i)
+    {
+        std::vector<unsigned int>& indices = parts[i];
+        for (unsigned int j = 0; j < indices.size(); ++j)
+        {
+            unsigned int v = indices[j];
+            if (remap[v] == unused)
+            {
+                remap[v] = next++;
+            }
+            indices[j] = remap[v];
+        }
+    }
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        if (remap[i] == unused)
+        {
+            remap[i] = next++;
+        }
+    }
+
+    std::vector<Vertex> vertices(vertexCount);
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        vertices[remap[i]] = _mesh->vertices[i];
+    }
+    _mesh->vertices.swap(vertices);
+
+    _mesh->vertexLookupTable.clear();
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        _mesh->vertexLookupTable[_mesh->vertices[i]] = i;
+    }
+}
+
+}
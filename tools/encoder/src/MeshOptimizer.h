@@ -0,0 +1,68 @@
+#ifndef MESHOPTIMIZER_H_
+#define MESHOPTIMIZER_H_
+
+#include "Mesh.h"
+
+namespace gameplay
+{
+
+/**
+ * Reorders the triangles and vertices of a mesh for faster drawing.
+ *
+ * The triangles of each part are first ordered for the post-transform vertex cache with
+ * Tipsify, which fans around vertices that are still in the cache. The runs of triangles
+ * between the points where Tipsify had to jump to a vertex outside the cache are then
+ * sorted so that the runs facing away from the center of the part are drawn first, since
+ * they are the most likely to occlude the rest of the part. Finally the vertices are
+ * renumbered in the order they are first used, so that vertex fetches read memory in order.
+ *
+ * The parts must be indexed triangle lists. The triangles and their winding are unchanged.
+ */
+class MeshOptimizer
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param mesh The mesh to optimize.
+     */
+    MeshOptimizer(Mesh* mesh);
+
+    /**
+     * Destructor.
+     */
+    ~MeshOptimizer();
+
+    /**
+     * Reorders the triangles of every part and the vertices of the mesh.
+     */
+    void optimize();
+
+    /**
+     * Returns the average number of vertices transformed per triangle, with a FIFO cache.
+     *
+     * @param indices The indices of a triangle list.
+     * @param vertexCount The number of vertices the indices refer to.
+     * @param cacheSize The number of vertices in the cache.
+     *
+     * @return The average cache miss ratio, between 0.5 at best and 3.
+     */
+    static float computeACMR(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize);
+
+private:
+
+    // Hidden copy/assignment
+    MeshOptimizer(const MeshOptimizer&);
+    MeshOptimizer& operator=(const MeshOptimizer&);
+
+    void optimizeVertexCache(std::vector<unsigned int>& indices, std::vector<unsigned int>* clusters) const;
+    void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<unsigned int>& clusters) const;
+    void optimizeVertexFetch(std::vector<std::vector<unsigned int> >& parts);
+
+    Mesh* _mesh;
+};
+
+}
+
+#endif
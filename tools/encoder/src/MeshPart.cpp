@@ -55,6 +55,17 @@ void MeshPart::addIndex(unsigned int index)
     _indices.push_back(index);
 }
 
+void MeshPart::setIndices(const std::vector<unsigned int>& indices)
+{
+    _indexFormat = INDEX16;
+    _indices.clear();
+    _indices.reserve(indices.size());
+    for (std::vector<unsigned int>::const_iterator i = indices.begin(); i != indices.end(); ++i)
+    {
+        addIndex(*i);
+    }
+}
+
 size_t MeshPart::getIndicesCount() const
 {
     return _indices.size();
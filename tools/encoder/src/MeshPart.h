@@ -47,6 +47,11 @@ public:
      */
     void addIndex(unsigned int index);
 
+    /**
+     * Replaces the list of indices.
+     */
+    void setIndices(const std::vector<unsigned int>& indices);
+
     /**
      * Returns the number of indices.
      */
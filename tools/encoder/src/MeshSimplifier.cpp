@@ -0,0 +1,412 @@
+#include "Base.h"
+#include "MeshSimplifier.h"
+
+#include <set>
+
+namespace gameplay
+{
+
+MeshSimplifier::Quadric::Quadric() :
+    a2(0), ab(0), ac(0), ad(0), b2(0), bc(0), bd(0), c2(0), cd(0), d2(0)
+{
+}
+
+void MeshSimplifier::Quadric::addPlane(const Vector3& n, double d, double weight)
+{
+    a2 += weight * n.x * n.x; ab += weight * n.x * n.y; ac += weight * n.x * n.z; ad += weight * n.x * d;
+    b2 += weight * n.y * n.y; bc += weight * n.y * n.z; bd += weight * n.y * d;
+    c2 += weight * n.z * n.z; cd += weight * n.z * d;
+    d2 += weight * d * d;
+}
+
+void MeshSimplifier::Quadric::add(const Quadric& q)
+{
+    a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+    b2 += q.b2; bc += q.bc; bd += q.bd;
+    c2 += q.c2; cd += q.cd;
+    d2 += q.d2;
+}
+
+double MeshSimplifier::Quadric::evaluate(const Vector3& p) const
+{
+    double x = p.x, y = p.y, z = p.z;
+    return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x +
+        b2 * y * y + 2 * bc * y * z + 2 * bd * y +
+        c2 * z * z + 2 * cd * z +
+        d2;
+}
+
+bool MeshSimplifier::Collapse::operator>(const Collapse& c) const
+{
+    return cost > c.cost;
+}
+
+static void computeNormal(const Vector3& p0, const Vector3& p1, const Vector3& p2, Vector3* normal)
+{
+    Vector3 e1, e2;
+    Vector3::subtract(p1, p0, &e1);
+    Vector3::subtract(p2, p0, &e2);
+    Vector3::cross(e1, e2, normal);
+}
+
+MeshSimplifier::MeshSimplifier(const Mesh* mesh) :
+    _mesh(mesh),
+    _triangleCount(0)
+{
+    assert(mesh);
+
+    const size_t vertexCount = mesh->getVertexCount();
+    _vertexTriangles.resize(vertexCount);
+    _quadrics.resize(vertexCount);
+    _versions.resize(vertexCount, 0);
+    _removed.resize(vertexCount, false);
+    _locked.resize(vertexCount, false);
+
+    for (unsigned int i = 0; i < mesh->parts.size(); ++i)
+    {
+        const MeshPart* part = mesh->parts[i];
+        for (unsigned int j = 0; j + 2 < part->getIndicesCount(); j += 3)
+        {
+            Triangle t;
+            t.v[0] = part->getIndex(j);
+            t.v[1] = part->getIndex(j + 1);
+            t.v[2] = part->getIndex(j + 2);
+            t.part = i;
+            t.removed = t.v[0] == t.v[1] || t.v[1] == t.v[2] || t.v[2] == t.v[0];
+            if (t.removed || t.v[0] >= vertexCount || t.v[1] >= vertexCount || t.v[2] >= vertexCount)
+            {
+                continue;
+            }
+
+            // Every vertex of the triangle measures its distance to the plane of the triangle,
+            // weighted by the area so that small triangles do not dominate the error.
+            Vector3 normal;
+            computeNormal(mesh->vertices[t.v[0]].position, mesh->vertices[t.v[1]].position, mesh->vertices[t.v[2]].position, &normal);
+            float length = normal.length();
+            if (length > 0.0f)
+            {
+                normal.scale(1.0f / length);
+                double d = -Vector3::dot(normal, mesh->vertices[t.v[0]].position);
+                for (unsigned int k = 0; k < 3; ++k)
+                {
+                    _quadrics[t.v[k]].addPlane(normal, d, length * 0.5);
+                }
+            }
+
+            unsigned int index = _triangles.size();
+            _triangles.push_back(t);
+            for (unsigned int k = 0; k < 3; ++k)
+            {
+                _vertexTriangles[t.v[k]].push_back(index);
+            }
+        }
+    }
+    _triangleCount = _triangles.size();
+
+    lockSeamsAndBorders();
+}
+
+MeshSimplifier::~MeshSimplifier()
+{
+}
+
+void MeshSimplifier::lockSeamsAndBorders()
+{
+    // Vertices that share a position with another vertex sit on a seam of their attributes.
+    std::map<Vector3, std::vector<unsigned int> > positions;
+    for (unsigned int i = 0; i < _mesh->getVertexCount(); ++i)
+    {
+        positions[_mesh->vertices[i].position].push_back(i);
+    }
+    std::vector<unsigned int> positionIds(_mesh->getVertexCount());
+    unsigned int positionId = 0;
+    for (std::map<Vector3, std::vector<unsigned int> >::const_iterator it = positions.begin(); it != positions.end(); ++it, ++positionId)
+    {
+        for (unsigned int i = 0; i < it->second.size(); ++i)
+        {
+            positionIds[it->second[i]] = positionId;
+            if (it->second.size() > 1)
+            {
+                _locked[it->second[i]] = true;
+            }
+        }
+    }
+
+    // Edges used by a single triangle are borders, and edges used by more than two are not manifold.
+    std::map<std::pair<unsigned int, unsigned int>, unsigned int> edges;
+    for (unsigned int i = 0; i < _triangles.size(); ++i)
+    {
+        const Triangle& t = _triangles[i];
+        for (unsigned int k = 0; k < 3; ++k)
+        {
+            unsigned int a = positionIds[t.v[k]], b = positionIds[t.v[(k + 1) % 3]];
+            ++edges[std::make_pair(std::min(a, b), std::max(a, b))];
+        }
+    }
+    for (unsigned int i = 0; i < _triangles.size(); ++i)
+    {
+        const Triangle& t = _triangles[i];
+        for (unsigned int k = 0; k < 3; ++k)
+        {
+            unsigned int a = positionIds[t.v[k]], b = positionIds[t.v[(k + 1) % 3]];
+            if (edges[std::make_pair(std::min(a, b), std::max(a, b))] != 2)
+            {
+                _locked[t.v[k]] = true;
+                _locked[t.v[(k + 1) % 3]] = true;
+            }
+        }
+    }
+}
+
+void MeshSimplifier::pushCollapse(unsigned int from, unsigned int to)
+{
+    if (_locked[from])
+    {
+        return;
+    }
+    Quadric q = _quadrics[from];
+    q.add(_quadrics[to]);
+
+    Collapse c;
+    c.cost = q.evaluate(_mesh->vertices[to].position);
+    c.from = from;
+    c.to = to;
+    c.fromVersion = _versions[from];
+    c.toVersion = _versions[to];
+    _heap.push_back(c);
+    std::push_heap(_heap.begin(), _heap.end(), std::greater<Collapse>());
+}
+
+void MeshSimplifier::pushCollapses(unsigned int v)
+{
+    const std::vector<unsigned int>& triangles = _vertexTriangles[v];
+    for (unsigned int i = 0; i < triangles.size(); ++i)
+    {
+        const Triangle& t = _triangles[triangles[i]];
+        for (unsigned int k = 0; k < 3; ++k)
+        {
+            if (t.v[k] != v)
+            {
+                pushCollapse(v, t.v[k]);
+                pushCollapse(t.v[k], v);
+            }
+        }
+    }
+}
+
+bool MeshSimplifier::collapse(unsigned int from, unsigned int to)
+{
+    const std::vector<unsigned int>& fromTriangles = _vertexTriangles[from];
+    const Vector3& target = _mesh->vertices[to].position;
+
+    // The vertices connected to both ends must be the opposite corners of the triangles
+    // on the edge, or the collapse would pinch the surface into a non-manifold edge.
+    std::set<unsigned int> fromNeighbours, toNeighbours;
+    unsigned int sharedCount = 0;
+    for (unsigned int i = 0; i < fromTriangles.size(); ++i)
+    {
+        const Triangle& t = _triangles[fromTriangles[i]];
+        bool shared = t.v[0] == to || t.v[1] == to || t.v[2] == to;
+        sharedCount += shared ? 1 : 0;
+        for (unsigned int k = 0; k < 3; ++k)
+        {
+            fromNeighbours.insert(t.v[k]);
+        }
+        if (shared)
+        {
+            continue;
+        }
+
+        // Reject collapses that flip a triangle or make it degenerate.
+        Vector3 p[3], before, after;
+        for (unsigned int k = 0; k < 3; ++k)
+        {
+            p[k] = _mesh->vertices[t.v[k]].position;
+        }
+        computeNormal(p[0], p[1], p[2], &before);
+        for (unsigned int k = 0; k < 3; ++k)
+        {
+            if (t.v[k] == from)
+            {
+                p[k] = target;
+            }
+        }
+        computeNormal(p[0], p[1], p[2], &after);
+        if (Vector3::dot(before, after) <= 0.1f * before.length() * after.length() || after.lengthSquared() == 0.0f)
+        {
+            return false;
+        }
+    }
+    if (sharedCount == 0)
+    {
+        return false;
+    }
+    const std::vector<unsigned int>& toTriangles = _vertexTriangles[to];
+    for (unsigned int i = 0; i < toTriangles.size(); ++i)
+    {
+        const Triangle& t = _triangles[toTriangles[i]];
+        for (unsigned int k = 0; k < 3; ++k)
+        {
+            toNeighbours.insert(t.v[k]);
+        }
+    }
+    unsigned int commonCount = 0;
+    for (std::set<unsigned int>::const_iterator it = fromNeighbours.begin(); it != fromNeighbours.end(); ++it)
+    {
+        if (*it != from && *it != to && toNeighbours.count(*it))
+        {
+            ++commonCount;
+        }
+    }
+    if (commonCount != sharedCount)
+    {
+        return false;
+    }
+
+    // Move the triangles of the removed vertex onto the kept vertex.
+    std::vector<unsigned int> triangles;
+    for (unsigned int i = 0; i < toTriangles.size(); ++i)
+    {
+        if (!_triangles[toTriangles[i]].removed)
+        {
+            triangles.push_back(toTriangles[i]);
+        }
+    }
+    for (unsigned int i = 0; i < fromTriangles.size(); ++i)
+    {
+        Triangle& t = _triangles[fromTriangles[i]];
+        if (t.v[0] == to || t.v[1] == to || t.v[2] == to)
+        {
+            t.removed = true;
+            --_triangleCount;
+            continue;
+        }
+        for (unsigned int k = 0; k < 3; ++k)
+        {
+            if (t.v[k] == from)
+            {
+                t.v[k] = to;
+            }
+        }
+        triangles.push_back(fromTriangles[i]);
+    }
+    for (unsigned int i = 0; i < triangles.size(); )
+    {
+        if (_triangles[triangles[i]].removed)
+        {
+            triangles.erase(triangles.begin() + i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    _vertexTriangles[to].swap(triangles);
+    _vertexTriangles[from].clear();
+
+    _quadrics[to].add(_quadrics[from]);
+    _removed[from] = true;
+    ++_versions[to];
+    return true;
+}
+
+void MeshSimplifier::simplify(const std::vector<float>& ratios, std::vector<Mesh*>* lods, std::vector<float>* lodRatios)
+{
+    assert(lods);
+    assert(lodRatios);
+
+    const unsigned int originalCount = _triangleCount;
+    if (originalCount == 0)
+    {
+        return;
+    }
+
+    _heap.clear();
+    for (unsigned int i = 0; i < _vertexTriangles.size(); ++i)
+    {
+        for (unsigned int j = 0; j < _vertexTriangles[i].size(); ++j)
+        {
+            const Triangle& t = _triangles[_vertexTriangles[i][j]];
+            for (unsigned int k = 0; k < 3; ++k)
+            {
+                if (t.v[k] != i)
+                {
+                    pushCollapse(i, t.v[k]);
+                }
+            }
+        }
+    }
+
+    unsigned int previousCount = originalCount;
+    for (unsigned int level = 0; level < ratios.size(); ++level)
+    {
+        const unsigned int targetCount = (unsigned int)(ratios[level] * originalCount);
+        while (_triangleCount > targetCount && !_heap.empty())
+        {
+            std::pop_heap(_heap.begin(), _heap.end(), std::greater<Collapse>());
+            Collapse c = _heap.back();
+            _heap.pop_back();
+
+            // Skip collapses whose ends were removed or changed since they were queued.
+            if (_removed[c.from] || _removed[c.to] || c.fromVersion != _versions[c.from] || c.toVersion != _versions[c.to])
+            {
+                continue;
+            }
+            if (collapse(c.from, c.to))
+            {
+                pushCollapses(c.to);
+            }
+        }
+
+        if (_triangleCount >= previousCount)
+        {
+            LOG(2, "Mesh '%s' cannot be simplified beyond %u triangles.\n", _mesh->getId().c_str(), _triangleCount);
+            break;
+        }
+        previousCount = _triangleCount;
+
+        lods->push_back(createMesh(lods->size() + 1));
+        lodRatios->push_back((float)_triangleCount / (float)originalCount);
+        LOG(2, "Simplified mesh '%s' to %u of %u triangles.\n", _mesh->getId().c_str(), _triangleCount, originalCount);
+    }
+}
+
+Mesh* MeshSimplifier::createMesh(unsigned int level) const
+{
+    Mesh* mesh = new Mesh();
+    char suffix[16];
+    sprintf(suffix, "_lod%u", level);
+    mesh->setId(_mesh->getId() + suffix);
+    for (unsigned int i = 0; i < _mesh->getVertexElementCount(); ++i)
+    {
+        const VertexElement& element = _mesh->getVertexElement(i);
+        mesh->addVetexAttribute(element.usage, element.size);
+    }
+
+    // Keep only the vertices that are still used, in the order they are first used.
+    std::vector<unsigned int> indices(_mesh->getVertexCount(), UINT_MAX);
+    for (unsigned int i = 0; i < _mesh->parts.size(); ++i)
+    {
+        mesh->addMeshPart(new MeshPart());
+    }
+    for (unsigned int i = 0; i < _triangles.size(); ++i)
+    {
+        const Triangle& t = _triangles[i];
+        if (t.removed)
+        {
+            continue;
+        }
+        for (unsigned int k = 0; k < 3; ++k)
+        {
+            if (indices[t.v[k]] == UINT_MAX)
+            {
+                indices[t.v[k]] = mesh->vertices.size();
+                mesh->vertices.push_back(_mesh->vertices[t.v[k]]);
+            }
+            mesh->parts[t.part]->addIndex(indices[t.v[k]]);
+        }
+    }
+    return mesh;
+}
+
+}
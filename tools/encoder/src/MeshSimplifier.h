@@ -0,0 +1,102 @@
+#ifndef MESHSIMPLIFIER_H_
+#define MESHSIMPLIFIER_H_
+
+#include "Mesh.h"
+
+namespace gameplay
+{
+
+/**
+ * Generates simplified copies of a triangle mesh, for use as levels of detail.
+ *
+ * Edges are collapsed in the order of the quadric error metric. Each collapse moves one
+ * vertex onto one of its neighbours, so every vertex of the simplified meshes is a vertex
+ * of the original mesh, with its own texture coordinates, normals and blend weights.
+ * Vertices on UV or normal seams (positions shared by several vertices) and on open borders
+ * are never removed, so seams stay closed and borders keep their shape. Collapses that
+ * would flip a triangle or make the mesh non-manifold are rejected.
+ */
+class MeshSimplifier
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param mesh The mesh to simplify, whose parts must be indexed triangle lists.
+     */
+    MeshSimplifier(const Mesh* mesh);
+
+    /**
+     * Destructor.
+     */
+    ~MeshSimplifier();
+
+    /**
+     * Simplifies the mesh, keeping a copy of it each time it reaches one of the given ratios.
+     *
+     * Levels that cannot be simplified further than the previous level are skipped.
+     *
+     * @param ratios The fractions of the triangles of the mesh to keep, in decreasing order.
+     * @param lods Populated with the simplified meshes, which are owned by the caller.
+     * @param lodRatios Populated with the fraction of the triangles each simplified mesh kept.
+     */
+    void simplify(const std::vector<float>& ratios, std::vector<Mesh*>* lods, std::vector<float>* lodRatios);
+
+private:
+
+    /**
+     * A symmetric 4x4 matrix summing the squared distances to a set of planes.
+     */
+    struct Quadric
+    {
+        double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+
+        Quadric();
+        void addPlane(const Vector3& normal, double d, double weight);
+        void add(const Quadric& q);
+        double evaluate(const Vector3& p) const;
+    };
+
+    struct Triangle
+    {
+        unsigned int v[3];
+        unsigned int part;
+        bool removed;
+    };
+
+    struct Collapse
+    {
+        double cost;
+        unsigned int from;
+        unsigned int to;
+        unsigned int fromVersion;
+        unsigned int toVersion;
+
+        bool operator>(const Collapse& c) const;
+    };
+
+    // Hidden copy/assignment
+    MeshSimplifier(const MeshSimplifier&);
+    MeshSimplifier& operator=(const MeshSimplifier&);
+
+    void lockSeamsAndBorders();
+    void pushCollapses(unsigned int v);
+    void pushCollapse(unsigned int from, unsigned int to);
+    bool collapse(unsigned int from, unsigned int to);
+    Mesh* createMesh(unsigned int level) const;
+
+    const Mesh* _mesh;
+    std::vector<Triangle> _triangles;
+    std::vector<std::vector<unsigned int> > _vertexTriangles;
+    std::vector<Quadric> _quadrics;
+    std::vector<unsigned int> _versions;
+    std::vector<bool> _removed;
+    std::vector<bool> _locked;
+    std::vector<Collapse> _heap;
+    unsigned int _triangleCount;
+};
+
+}
+
+#endif
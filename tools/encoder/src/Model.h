@@ -34,12 +34,25 @@ public:
     void setSkin(MeshSkin* skin);
     void setMaterial(Material* material, int partIndex = -1);
 
+    /**
+     * Adds a level of detail that is drawn instead of the mesh of this model when the
+     * model covers less than the given fraction of the viewport height.
+     */
+    void addLod(Mesh* mesh, float screenSize);
+
+    /**
+     * Returns the number of levels of detail added to this model.
+     */
+    unsigned int getLodCount() const;
+
 private:
 
     Mesh* _mesh;
     MeshSkin* _meshSkin;
     std::vector<Material*> _materials;
     Material* _material;
+    std::vector<Mesh*> _lodMeshes;
+    std::vector<float> _lodScreenSizes;
 };
 
 }
@@ -0,0 +1,141 @@
+#include "Base.h"
+#include "NavigationMesh.h"
+#include "GPBFile.h"
+
+// The distance under which vertices are welded, in world units.
+#define NAVIGATION_MESH_WELD_DISTANCE 0.001f
+
+namespace gameplay
+{
+
+NavigationMesh::NavigationMesh(void)
+{
+}
+
+NavigationMesh::~NavigationMesh(void)
+{
+}
+
+unsigned int NavigationMesh::getTypeId(void) const
+{
+    return NAVIGATIONMESH_ID;
+}
+
+const char* NavigationMesh::getElementName(void) const
+{
+    return "NavigationMesh";
+}
+
+void NavigationMesh::writeBinary(FILE* file)
+{
+    Object::writeBinary(file);
+    write(_vertices, file);
+    write(_indices, file);
+}
+
+void NavigationMesh::writeText(FILE* file)
+{
+    fprintElementStart(file);
+    fprintfElement(file, "%f ", "vertices", _vertices);
+    fprintfElement(file, "%u ", "indices", _indices);
+    fprintElementEnd(file);
+}
+
+NavigationMesh* NavigationMesh::generate(const std::vector<std::string>& nodeIds, float maxSlope, const char* id)
+{
+    LOG(1, "Generating navigation mesh: %s...\n", id);
+
+    GPBFile* gpbFile = GPBFile::getInstance();
+    NavigationMesh* navigationMesh = new NavigationMesh();
+    navigationMesh->setId(id);
+
+    // Vertices are welded by their position rounded to the weld distance.
+    typedef std::pair<std::pair<long long, long long>, long long> VertexKey;
+    std::map<VertexKey, unsigned int> vertexIndices;
+    float minNormalY = cos(MATH_DEG_TO_RAD(maxSlope));
+    unsigned int skippedTriangles = 0;
+
+    for (size_t i = 0, nodeCount = nodeIds.size(); i < nodeCount; ++i)
+    {
+        Node* node = gpbFile->getNode(nodeIds[i].c_str());
+        if (node == NULL)
+        {
+            LOG(1, "WARNING: Failed to locate node for navigation mesh argument: %s\n", nodeIds[i].c_str());
+            continue;
+        }
+        Mesh* mesh = node->getModel() ? node->getModel()->getMesh() : NULL;
+        if (mesh == NULL)
+        {
+            LOG(1, "WARNING: Node passed to navigation mesh argument does not have a mesh: %s\n", nodeIds[i].c_str());
+            continue;
+        }
+
+        const Matrix& world = node->getWorldMatrix();
+        for (size_t j = 0, partCount = mesh->parts.size(); j < partCount; ++j)
+        {
+            MeshPart* part = mesh->parts[j];
+            for (unsigned int k = 0, indexCount = (unsigned int)part->getIndicesCount(); k + 2 < indexCount; k += 3)
+            {
+                Vector3 positions[3];
+                for (unsigned int v = 0; v < 3; ++v)
+                {
+                    world.transformPoint(mesh->vertices[part->getIndex(k + v)].position, &positions[v]);
+                }
+
+                // Skip the triangles that face down or are too steep to walk on.
+                Vector3 edge1, edge2, normal;
+                Vector3::subtract(positions[1], positions[0], &edge1);
+                Vector3::subtract(positions[2], positions[0], &edge2);
+                Vector3::cross(edge1, edge2, &normal);
+                if (normal.length() == 0.0f)
+                    continue;
+                normal.normalize();
+                if (normal.y < minNormalY)
+                {
+                    ++skippedTriangles;
+                    continue;
+                }
+
+                unsigned int indices[3];
+                for (unsigned int v = 0; v < 3; ++v)
+                {
+                    const Vector3& p = positions[v];
+                    VertexKey key(std::make_pair((long long)floor(p.x / NAVIGATION_MESH_WELD_DISTANCE + 0.5f),
+                                                 (long long)floor(p.y / NAVIGATION_MESH_WELD_DISTANCE + 0.5f)),
+                                  (long long)floor(p.z / NAVIGATION_MESH_WELD_DISTANCE + 0.5f));
+                    std::map<VertexKey, unsigned int>::iterator itr = vertexIndices.find(key);
+                    if (itr == vertexIndices.end())
+                    {
+                        indices[v] = (unsigned int)(navigationMesh->_vertices.size() / 3);
+                        vertexIndices[key] = indices[v];
+                        navigationMesh->_vertices.push_back(p.x);
+                        navigationMesh->_vertices.push_back(p.y);
+                        navigationMesh->_vertices.push_back(p.z);
+                    }
+                    else
+                    {
+                        indices[v] = itr->second;
+                    }
+                }
+
+                // Welding can collapse small triangles.
+                if (indices[0] == indices[1] || indices[1] == indices[2] || indices[2] == indices[0])
+                    continue;
+                navigationMesh->_indices.insert(navigationMesh->_indices.end(), indices, indices + 3);
+            }
+        }
+    }
+
+    if (navigationMesh->_indices.empty())
+    {
+        LOG(1, "WARNING: Skipping generation of navigation mesh '%s'. No walkable triangles found.\n", id);
+        delete navigationMesh;
+        return NULL;
+    }
+
+    LOG(1, "\t%u triangles, %u vertices (%u triangles too steep).\n", (unsigned int)navigationMesh->_indices.size() / 3,
+        (unsigned int)navigationMesh->_vertices.size() / 3, skippedTriangles);
+    return navigationMesh;
+}
+
+}
@@ -0,0 +1,54 @@
+#ifndef NAVIGATIONMESH_H_
+#define NAVIGATIONMESH_H_
+
+#include "Object.h"
+
+namespace gameplay
+{
+
+/**
+ * Generates a navigation mesh from the walkable triangles of the meshes of a scene.
+ *
+ * The triangles whose slope is at most the maximum slope are transformed to world space,
+ * and their vertices are welded so that neighboring triangles share their edges, which is
+ * how the runtime finds the neighbors of each triangle.
+ */
+class NavigationMesh : public Object
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    NavigationMesh(void);
+
+    /**
+     * Destructor.
+     */
+    virtual ~NavigationMesh(void);
+
+    virtual unsigned int getTypeId(void) const;
+    virtual const char* getElementName(void) const;
+    virtual void writeBinary(FILE* file);
+    virtual void writeText(FILE* file);
+
+    /**
+     * Generates a navigation mesh from the meshes of the specified nodes.
+     *
+     * @param nodeIds The ids of the nodes whose meshes are walkable. Their parts must be indexed triangle lists.
+     * @param maxSlope The largest slope that can be walked on, in degrees.
+     * @param id The id of the navigation mesh.
+     *
+     * @return The navigation mesh, or NULL if none of the triangles are walkable.
+     */
+    static NavigationMesh* generate(const std::vector<std::string>& nodeIds, float maxSlope, const char* id);
+
+private:
+
+    std::vector<float> _vertices;
+    std::vector<unsigned int> _indices;
+};
+
+}
+
+#endif
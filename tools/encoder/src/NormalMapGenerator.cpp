@@ -2,6 +2,21 @@
 #include "Image.h"
 #include "Base.h"
 
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <dirent.h>
+#endif
+#include "Thread.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    #define USE_NEON
+    #include <arm_neon.h>
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #define USE_SSE
+    #include <xmmintrin.h>
+#endif
+
 namespace gameplay
 {
 
@@ -30,34 +45,195 @@ bool equalsIgnoreCase(const std::string& s1, const std::string& s2)
     return true;
 }
 
-float getHeight(float* heights, int width, int height, int x, int y)
+// Four lanes of floats, used to compute the normals of four samples at a time.
+#if defined(USE_NEON)
+
+typedef float32x4_t Float4;
+
+static inline Float4 loadFloat4(const float* p) { return vld1q_f32(p); }
+static inline void storeFloat4(float* p, Float4 v) { vst1q_f32(p, v); }
+static inline Float4 splatFloat4(float f) { return vdupq_n_f32(f); }
+static inline Float4 addFloat4(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+static inline Float4 subFloat4(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+static inline Float4 mulFloat4(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+
+#elif defined(USE_SSE)
+
+typedef __m128 Float4;
+
+static inline Float4 loadFloat4(const float* p) { return _mm_loadu_ps(p); }
+static inline void storeFloat4(float* p, Float4 v) { _mm_storeu_ps(p, v); }
+static inline Float4 splatFloat4(float f) { return _mm_set1_ps(f); }
+static inline Float4 addFloat4(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+static inline Float4 subFloat4(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+static inline Float4 mulFloat4(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+
+#else
+
+struct Float4
 {
-    if (x < 0)
-        x = 0;
-    else if (x >= width)
-        x = width-1;
-    if (y < 0)
-        y = 0;
-    else if (y >= height)
-        y = height-1;
-    return heights[y*width+x];
+    float v[4];
+};
+
+static inline Float4 loadFloat4(const float* p) { Float4 r = { { p[0], p[1], p[2], p[3] } }; return r; }
+static inline void storeFloat4(float* p, Float4 v) { p[0] = v.v[0]; p[1] = v.v[1]; p[2] = v.v[2]; p[3] = v.v[3]; }
+static inline Float4 splatFloat4(float f) { Float4 r = { { f, f, f, f } }; return r; }
+static inline Float4 addFloat4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+static inline Float4 subFloat4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] -= b.v[i]; return a; }
+static inline Float4 mulFloat4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+
+#endif
+
+/**
+ * The normals of the two triangles of each quad of a row of the heightmap, stored by component.
+ *
+ * The quads of a row are stored from index 1, with zero normals at index 0 and after the
+ * last quad, so that the normals of the edge samples are summed like the others.
+ */
+struct FaceRow
+{
+    std::vector<float> n1x, n1z, n2x, n2z, ny;
+
+    void resize(int width)
+    {
+        n1x.assign(width + 1, 0.0f);
+        n1z.assign(width + 1, 0.0f);
+        n2x.assign(width + 1, 0.0f);
+        n2z.assign(width + 1, 0.0f);
+        ny.assign(width + 1, 0.0f);
+    }
+};
+
+/**
+ * The rows of the heightmap a thread computes the normals of.
+ */
+struct NormalMapThreadData
+{
+    const float* heights;
+    unsigned char* pixels;
+    int width;
+    int height;
+    float scaleX;
+    float scaleZ;
+    int startRow;
+    int endRow;
+};
+
+/**
+ * Computes the normals of the quads between a row of heights and the next.
+ *
+ * The first triangle of a quad is (bottom left, top left, top right) and the second is
+ * (bottom left, top right, bottom right); the cross products of their edges reduce to the
+ * height differences scaled by the size of the quad. Every normal has the same y component,
+ * since every triangle has the same area when projected onto the xz plane.
+ */
+static void computeFaceRow(const float* heights, int width, int row, float scaleX, float scaleZ, FaceRow* faces)
+{
+    const float* top = heights + row * width;
+    const float* bottom = top + width;
+    float* n1x = &faces->n1x[1];
+    float* n1z = &faces->n1z[1];
+    float* n2x = &faces->n2x[1];
+    float* n2z = &faces->n2z[1];
+    float* ny = &faces->ny[1];
+    int count = width - 1;
+
+    Float4 sx = splatFloat4(scaleX);
+    Float4 sz = splatFloat4(scaleZ);
+    Float4 sy = splatFloat4(scaleX * scaleZ);
+    int x = 0;
+    for (; x + 4 <= count; x += 4)
+    {
+        Float4 topLeft = loadFloat4(top + x);
+        Float4 topRight = loadFloat4(top + x + 1);
+        Float4 bottomLeft = loadFloat4(bottom + x);
+        Float4 bottomRight = loadFloat4(bottom + x + 1);
+        storeFloat4(n1x + x, mulFloat4(sz, subFloat4(topLeft, topRight)));
+        storeFloat4(n1z + x, mulFloat4(sx, subFloat4(topLeft, bottomLeft)));
+        storeFloat4(n2x + x, mulFloat4(sz, subFloat4(bottomLeft, bottomRight)));
+        storeFloat4(n2z + x, mulFloat4(sx, subFloat4(topRight, bottomRight)));
+        storeFloat4(ny + x, sy);
+    }
+    for (; x < count; ++x)
+    {
+        n1x[x] = scaleZ * (top[x] - top[x + 1]);
+        n1z[x] = scaleX * (top[x] - bottom[x]);
+        n2x[x] = scaleZ * (bottom[x] - bottom[x + 1]);
+        n2z[x] = scaleX * (top[x + 1] - bottom[x + 1]);
+        ny[x] = scaleX * scaleZ;
+    }
 }
 
-void calculateNormal(
-    float x1, float y1, float z1,
-    float x2, float y2, float z2,
-    float x3, float y3, float z3,
-    Vector3* normal)
+/**
+ * Computes the normals of a row of samples as the sum of the normals of the triangles
+ * around them, from the quads above and below the row, and writes them as pixels.
+ */
+static void computeNormalRow(const FaceRow& above, const FaceRow& below, int width, float* sums, unsigned char* pixels)
 {
-    Vector3 E(x1, y1, z1);
-    Vector3 F(x2, y2, z2);
-    Vector3 G(x3, y3, z3);
+    // For sample x, the quad to its left is at index x and the quad to its right at index x + 1.
+    // The sample is a corner of the second triangle of the quad above left, of both triangles of
+    // the quads below left and above right, and of the first triangle of the quad below right.
+    float* sumX = sums;
+    float* sumY = sums + width;
+    float* sumZ = sums + width * 2;
+    int x = 0;
+    for (; x + 4 <= width; x += 4)
+    {
+        Float4 nx = addFloat4(addFloat4(loadFloat4(&above.n2x[x]), addFloat4(loadFloat4(&below.n1x[x]), loadFloat4(&below.n2x[x]))),
+                              addFloat4(addFloat4(loadFloat4(&above.n1x[x + 1]), loadFloat4(&above.n2x[x + 1])), loadFloat4(&below.n1x[x + 1])));
+        Float4 nz = addFloat4(addFloat4(loadFloat4(&above.n2z[x]), addFloat4(loadFloat4(&below.n1z[x]), loadFloat4(&below.n2z[x]))),
+                              addFloat4(addFloat4(loadFloat4(&above.n1z[x + 1]), loadFloat4(&above.n2z[x + 1])), loadFloat4(&below.n1z[x + 1])));
+        Float4 nyAbove = addFloat4(loadFloat4(&above.ny[x]), mulFloat4(loadFloat4(&above.ny[x + 1]), splatFloat4(2.0f)));
+        Float4 nyBelow = addFloat4(mulFloat4(loadFloat4(&below.ny[x]), splatFloat4(2.0f)), loadFloat4(&below.ny[x + 1]));
+        storeFloat4(sumX + x, nx);
+        storeFloat4(sumY + x, addFloat4(nyAbove, nyBelow));
+        storeFloat4(sumZ + x, nz);
+    }
+    for (; x < width; ++x)
+    {
+        sumX[x] = above.n2x[x] + below.n1x[x] + below.n2x[x] + above.n1x[x + 1] + above.n2x[x + 1] + below.n1x[x + 1];
+        sumY[x] = above.ny[x] + 2.0f * below.ny[x] + 2.0f * above.ny[x + 1] + below.ny[x + 1];
+        sumZ[x] = above.n2z[x] + below.n1z[x] + below.n2z[x] + above.n1z[x + 1] + above.n2z[x + 1] + below.n1z[x + 1];
+    }
 
-    Vector3 P, Q;
-    Vector3::subtract(F, E, &P);
-    Vector3::subtract(G, E, &Q);
+    // We don't have to worry about weighting the normals by the surface area of the
+    // triangles since a heightmap guarantees that all triangles have the same surface area.
+    for (x = 0; x < width; ++x)
+    {
+        float scale = 1.0f / sqrt(sumX[x] * sumX[x] + sumY[x] * sumY[x] + sumZ[x] * sumZ[x]);
+        pixels[x * 3] = (unsigned char)((sumX[x] * scale + 1.0f) * 0.5f * 255.0f);
+        pixels[x * 3 + 1] = (unsigned char)((sumY[x] * scale + 1.0f) * 0.5f * 255.0f);
+        pixels[x * 3 + 2] = (unsigned char)((sumZ[x] * scale + 1.0f) * 0.5f * 255.0f);
+    }
+}
 
-    Vector3::cross(Q, P, normal);
+/**
+ * Computes the normals of a range of rows of the heightmap on a thread.
+ */
+static int generateNormalMapRows(void* threadData)
+{
+    NormalMapThreadData* data = (NormalMapThreadData*)threadData;
+
+    // The quads below each row are the quads above the next, so each row of quads is computed once.
+    FaceRow rows[2];
+    rows[0].resize(data->width);
+    rows[1].resize(data->width);
+    FaceRow* above = &rows[0];
+    FaceRow* below = &rows[1];
+    if (data->startRow > 0)
+        computeFaceRow(data->heights, data->width, data->startRow - 1, data->scaleX, data->scaleZ, above);
+
+    std::vector<float> sums(data->width * 3);
+    for (int z = data->startRow; z < data->endRow; ++z)
+    {
+        if (z < data->height - 1)
+            computeFaceRow(data->heights, data->width, z, data->scaleX, data->scaleZ, below);
+        else
+            below->resize(data->width);
+        computeNormalRow(*above, *below, data->width, &sums[0], data->pixels + z * data->width * 3);
+        std::swap(above, below);
+    }
+    return 0;
 }
 
 float normalizedHeightPacked(float r, float g, float b)
@@ -202,117 +378,43 @@ void NormalMapGenerator::generate()
     //
     ///////////////////////////////////////////////////////////////////////////////////////////////
 
-    struct NormalPixel
-    {
-        unsigned char r, g, b;
-    };
-    NormalPixel* normalPixels = new NormalPixel[_resolutionX * _resolutionY];
+    unsigned char* normalPixels = new unsigned char[_resolutionX * _resolutionY * 3];
 
-    struct Face
+    // Split the rows between threads to make use of all cpu cores.
+    LOG(1, "Calculating normals...");
+    int threadCount = std::min((int)getProcessorCount(), _resolutionY);
+    NormalMapThreadData* threadData = new NormalMapThreadData[threadCount];
+    THREAD_HANDLE* threads = new THREAD_HANDLE[threadCount];
+    int startedCount = 0;
+    for (int i = 0; i < threadCount; ++i)
     {
-        Vector3 normal1;
-        Vector3 normal2;
-    };
-
-    int progressMax = (_resolutionX-1) * (_resolutionY-1) + _resolutionX * _resolutionY;
-    int progress = 0;
-
-    Vector2 scale(_worldSize.x / (_resolutionX-1), _worldSize.z / (_resolutionY-1));
-
-    // First calculate all face normals for the heightmap
-    LOG(1, "Calculating normals... 0%%");
-    Face* faceNormals = new Face[(_resolutionX - 1) * (_resolutionY - 1)];
-    Vector3 v1, v2;
-    for (int z = 0; z < _resolutionY-1; z++)
-    {
-        for (int x = 0; x < _resolutionX-1; x++)
-        {
-            float topLeftHeight = getHeight(heights, _resolutionX, _resolutionY, x, z);
-            float bottomLeftHeight = getHeight(heights, _resolutionX, _resolutionY, x, z + 1);
-            float bottomRightHeight = getHeight(heights, _resolutionX, _resolutionY, x + 1, z + 1);
-            float topRightHeight = getHeight(heights, _resolutionX, _resolutionY, x + 1, z);
-
-            // Triangle 1
-            calculateNormal(
-                (float)x*scale.x, bottomLeftHeight, (float)(z + 1)*scale.y,
-                (float)x*scale.x, topLeftHeight, (float)z*scale.y,
-                (float)(x + 1)*scale.x, topRightHeight, (float)z*scale.y,
-                &faceNormals[z*(_resolutionX-1)+x].normal1);
-
-            // Triangle 2
-            calculateNormal(
-                (float)x*scale.x, bottomLeftHeight, (float)(z + 1)*scale.y,
-                (float)(x + 1)*scale.x, topRightHeight, (float)z*scale.y,
-                (float)(x + 1)*scale.x, bottomRightHeight, (float)(z + 1)*scale.y,
-                &faceNormals[z*(_resolutionX-1)+x].normal2);
-
-            ++progress;
-            LOG(1, "\rCalculating normals... %d%%", (int)(((float)progress / progressMax) * 100));
-        }
+        NormalMapThreadData& data = threadData[i];
+        data.heights = heights;
+        data.pixels = normalPixels;
+        data.width = _resolutionX;
+        data.height = _resolutionY;
+        data.scaleX = _worldSize.x / (_resolutionX - 1);
+        data.scaleZ = _worldSize.z / (_resolutionY - 1);
+        data.startRow = (int)((long long)_resolutionY * i / threadCount);
+        data.endRow = (int)((long long)_resolutionY * (i + 1) / threadCount);
+
+        // The rows of a thread that fails to start are computed on this thread.
+        if (createThread(&threads[startedCount], &generateNormalMapRows, &data))
+            ++startedCount;
+        else
+            generateNormalMapRows(&data);
     }
+    waitForThreads(startedCount, threads);
+    for (int i = 0; i < startedCount; ++i)
+        closeThread(threads[i]);
+    delete[] threads;
+    delete[] threadData;
 
     // Free height array
     delete[] heights;
     heights = NULL;
 
-    // Smooth normals by taking an average for each vertex
-    Vector3 normal;
-    for (int z = 0; z < _resolutionY; z++)
-    {
-        for (int x = 0; x < _resolutionX; x++)
-        {
-            // Reset normal sum
-            normal.set(0, 0, 0);
-
-            if (x > 0)
-            {
-                if (z > 0)
-                {
-                    // Top left
-                    normal.add(faceNormals[(z-1)*(_resolutionX-1) + (x-1)].normal2);
-                }
-
-                if (z < (_resolutionY - 1))
-                {
-                    // Bottom left
-                    normal.add(faceNormals[z*(_resolutionX-1) + (x - 1)].normal1);
-                    normal.add(faceNormals[z*(_resolutionX-1) + (x - 1)].normal2);
-                }
-            }
-
-            if (x < (_resolutionX - 1))
-            {
-                if (z > 0)
-                {
-                    // Top right
-                    normal.add(faceNormals[(z-1)*(_resolutionX-1) + x].normal1);
-                    normal.add(faceNormals[(z-1)*(_resolutionX-1) + x].normal2);
-                }
-
-                if (z < (_resolutionY - 1))
-                {
-                    // Bottom right
-                    normal.add(faceNormals[z*(_resolutionX-1) + x].normal1);
-                }
-            }
-
-            // We don't have to worry about weighting the normals by
-            // the surface area of the triangles since a heightmap 
-            // guarantees that all triangles have the same surface area.
-            normal.normalize();
-
-            // Store this vertex normal
-            NormalPixel& pixel = normalPixels[z*_resolutionX + x];
-            pixel.r = (unsigned char)((normal.x + 1.0f) * 0.5f * 255.0f);
-            pixel.g = (unsigned char)((normal.y + 1.0f) * 0.5f * 255.0f);
-            pixel.b = (unsigned char)((normal.z + 1.0f) * 0.5f * 255.0f);
-
-            ++progress;
-            LOG(1, "\rCalculating normals... %d%%", (int)(((float)progress / progressMax) * 100));
-        }
-    }
-
-    LOG(1, "\rCalculating normals... Done.\n");
+    LOG(1, " Done.\n");
 
     // Create and save an image for the normal map
     Image* normalMap = Image::create(Image::RGB, _resolutionX, _resolutionY);
@@ -326,4 +428,61 @@ void NormalMapGenerator::generate()
     normalPixels = NULL;
 }
 
+int generateNormalMaps(const char* inputDir, const char* outputDir, int resolutionX, int resolutionY, const Vector3& worldSize)
+{
+    std::vector<std::string> names;
+#ifdef WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA((std::string(inputDir) + "/*").c_str(), &data);
+    if (find != INVALID_HANDLE_VALUE)
+    {
+        do
+        {
+            if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+                names.push_back(data.cFileName);
+        } while (FindNextFileA(find, &data) != 0);
+        FindClose(find);
+    }
+#else
+    DIR* dir = opendir(inputDir);
+    if (dir)
+    {
+        struct dirent* dp;
+        while ((dp = readdir(dir)) != NULL)
+            names.push_back(dp->d_name);
+        closedir(dir);
+    }
+#endif
+    std::sort(names.begin(), names.end());
+
+    int count = 0;
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        const std::string& name = names[i];
+        size_t pos = name.find_last_of('.');
+        if (pos == std::string::npos)
+            continue;
+
+        // Skip the normal maps written by previous runs.
+        std::string ext = name.substr(pos);
+        std::string baseName = name.substr(0, pos);
+        if ((!equalsIgnoreCase(ext, ".png") && !equalsIgnoreCase(ext, ".raw")) ||
+            (baseName.size() >= 10 && equalsIgnoreCase(baseName.substr(baseName.size() - 10), "_normalmap")))
+            continue;
+
+        std::string inputPath = std::string(inputDir) + "/" + name;
+        std::string outputPath = std::string(outputDir) + "/" + baseName + "_normalmap.png";
+        LOG(1, "Generating normal map: %s\n", inputPath.c_str());
+        NormalMapGenerator generator(inputPath.c_str(), outputPath.c_str(), resolutionX, resolutionY, worldSize);
+        generator.generate();
+        ++count;
+    }
+    if (count == 0)
+    {
+        LOG(1, "Error: No PNG or RAW heightmaps found in directory: %s\n", inputDir);
+        return -1;
+    }
+    return 0;
+}
+
 }
@@ -30,6 +30,24 @@ private:
 
 };
 
+/**
+ * Generates the normal maps of every PNG and RAW heightmap in a directory, such as the tiles
+ * of a large terrain, in one run.
+ *
+ * Each heightmap is written to "<name>_normalmap.png" in the output directory, and all of
+ * them share the world size and RAW resolution given. The normals at the borders of each
+ * tile are computed from that tile alone.
+ *
+ * @param inputDir The directory of the heightmaps.
+ * @param outputDir The directory to write the normal maps to.
+ * @param resolutionX The width of RAW heightmaps.
+ * @param resolutionY The height of RAW heightmaps.
+ * @param worldSize The size of each heightmap in world units.
+ *
+ * @return 0 if any heightmap was found, -1 otherwise.
+ */
+int generateNormalMaps(const char* inputDir, const char* outputDir, int resolutionX, int resolutionY, const Vector3& worldSize);
+
 }
 
 #endif
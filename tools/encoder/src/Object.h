@@ -31,6 +31,7 @@ public:
         MESH_ID = 34,
         MESHPART_ID = 35,
         MESHSKIN_ID = 36,
+        NAVIGATIONMESH_ID = 40,
         FONT_ID = 128,
     };
 
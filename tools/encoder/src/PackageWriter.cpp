@@ -0,0 +1,280 @@
+#include "Base.h"
+#include "PackageWriter.h"
+
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <dirent.h>
+#endif
+
+// The identifier at the start of packages, which must match gameplay's FileSystem.
+#define PACKAGE_IDENTIFIER "\xABGPK"
+#define PACKAGE_VERSION 1
+
+// The flag of package entries that are compressed with LZ4.
+#define PACKAGE_ENTRY_LZ4 1
+
+// The alignment of the entries in the package.
+#define PACKAGE_ALIGNMENT 16
+
+// The number of bits of the hash table of the LZ4 compressor.
+#define LZ4_HASH_BITS 16
+
+namespace gameplay
+{
+
+/**
+ * A file to write to the package.
+ */
+struct PackageEntry
+{
+    std::string name;
+    std::string path;
+    unsigned int offset;
+    unsigned int size;
+    unsigned int storedSize;
+    unsigned int flags;
+    std::vector<unsigned char> data;
+};
+
+/**
+ * Adds the files of a directory and its subdirectories to a list, named by their path relative to the root.
+ */
+static bool listFiles(const std::string& dirPath, const std::string& prefix, std::vector<PackageEntry>& entries)
+{
+#ifdef WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA((dirPath + "/*").c_str(), &data);
+    if (find == INVALID_HANDLE_VALUE)
+        return false;
+    do
+    {
+        std::string name(data.cFileName);
+        if (name == "." || name == "..")
+            continue;
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        {
+            listFiles(dirPath + "/" + name, prefix + name + "/", entries);
+        }
+        else
+        {
+            PackageEntry entry;
+            entry.name = prefix + name;
+            entry.path = dirPath + "/" + name;
+            entries.push_back(entry);
+        }
+    } while (FindNextFileA(find, &data) != 0);
+    FindClose(find);
+    return true;
+#else
+    DIR* dir = opendir(dirPath.c_str());
+    if (dir == NULL)
+        return false;
+    struct dirent* dp;
+    while ((dp = readdir(dir)) != NULL)
+    {
+        std::string name(dp->d_name);
+        if (name == "." || name == "..")
+            continue;
+        std::string path = dirPath + "/" + name;
+        struct stat buf;
+        if (stat(path.c_str(), &buf) != 0)
+            continue;
+        if (S_ISDIR(buf.st_mode))
+        {
+            listFiles(path, prefix + name + "/", entries);
+        }
+        else
+        {
+            PackageEntry entry;
+            entry.name = prefix + name;
+            entry.path = path;
+            entries.push_back(entry);
+        }
+    }
+    closedir(dir);
+    return true;
+#endif
+}
+
+/**
+ * Orders entries by name.
+ */
+static bool compareEntryNames(const PackageEntry& a, const PackageEntry& b)
+{
+    return a.name < b.name;
+}
+
+/**
+ * Appends a length that does not fit in its token to an LZ4 block.
+ */
+static void writeLZ4Length(size_t length, std::vector<unsigned char>& dst)
+{
+    for (; length >= 255; length -= 255)
+        dst.push_back(255);
+    dst.push_back((unsigned char)length);
+}
+
+/**
+ * Appends a sequence of literals followed by a match to an LZ4 block. A match length of zero
+ * writes the last sequence, which has no match.
+ */
+static void writeLZ4Sequence(const unsigned char* literals, size_t literalLength, size_t offset, size_t matchLength, std::vector<unsigned char>& dst)
+{
+    size_t token = std::min(literalLength, (size_t)15) << 4;
+    if (matchLength > 0)
+        token |= std::min(matchLength - 4, (size_t)15);
+    dst.push_back((unsigned char)token);
+    if (literalLength >= 15)
+        writeLZ4Length(literalLength - 15, dst);
+    dst.insert(dst.end(), literals, literals + literalLength);
+    if (matchLength > 0)
+    {
+        dst.push_back((unsigned char)(offset & 0xff));
+        dst.push_back((unsigned char)(offset >> 8));
+        if (matchLength - 4 >= 15)
+            writeLZ4Length(matchLength - 4 - 15, dst);
+    }
+}
+
+void compressLZ4(const unsigned char* src, size_t size, std::vector<unsigned char>& dst)
+{
+    // Matches are found with a hash table of the last position of each 4-byte sequence.
+    dst.clear();
+    std::vector<int> table((size_t)1 << LZ4_HASH_BITS, -1);
+    size_t anchor = 0;
+    size_t i = 0;
+
+    // The format requires the last match to start 12 bytes before the end and the last 5 bytes to be literals.
+    size_t matchLimit = size > 12 ? size - 12 : 0;
+    while (i < matchLimit)
+    {
+        unsigned int sequence;
+        memcpy(&sequence, src + i, 4);
+        unsigned int hash = (sequence * 2654435761u) >> (32 - LZ4_HASH_BITS);
+        int candidate = table[hash];
+        table[hash] = (int)i;
+        if (candidate < 0 || i - (size_t)candidate > 65535 || memcmp(src + candidate, src + i, 4) != 0)
+        {
+            ++i;
+            continue;
+        }
+
+        size_t length = 4;
+        while (i + length < size - 5 && src[candidate + length] == src[i + length])
+            ++length;
+        writeLZ4Sequence(src + anchor, i - anchor, i - (size_t)candidate, length, dst);
+        i += length;
+        anchor = i;
+    }
+    writeLZ4Sequence(src + anchor, size - anchor, 0, 0, dst);
+}
+
+int writePackage(const char* dirPath, const char* outFilePath, bool compress)
+{
+    std::vector<PackageEntry> entries;
+    if (!listFiles(dirPath, "", entries))
+    {
+        LOG(1, "Error: Failed to list the files of directory: %s\n", dirPath);
+        return -1;
+    }
+
+    // The package itself is skipped when it is written to the directory it packages.
+    std::string outName(outFilePath);
+    std::replace(outName.begin(), outName.end(), '\\', '/');
+    std::vector<PackageEntry>::iterator itr = entries.begin();
+    while (itr != entries.end())
+    {
+        std::string path(itr->path);
+        std::replace(path.begin(), path.end(), '\\', '/');
+        if (path == outName)
+            itr = entries.erase(itr);
+        else
+            ++itr;
+    }
+
+    // Entries are written in name order, so files of the same directory are read sequentially.
+    std::sort(entries.begin(), entries.end(), compareEntryNames);
+
+    size_t offset = 12;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        offset += sizeof(unsigned int) * 5 + entries[i].name.size();
+    }
+
+    size_t totalSize = 0;
+    size_t totalStoredSize = 0;
+    std::vector<unsigned char> compressed;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        PackageEntry& entry = entries[i];
+        FILE* file = fopen(entry.path.c_str(), "rb");
+        if (!file)
+        {
+            LOG(1, "Error: Failed to open file: %s\n", entry.path.c_str());
+            return -1;
+        }
+        unsigned char buffer[4096];
+        size_t read;
+        while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+            entry.data.insert(entry.data.end(), buffer, buffer + read);
+        fclose(file);
+
+        entry.size = (unsigned int)entry.data.size();
+        entry.flags = 0;
+        if (compress && !entry.data.empty())
+        {
+            compressLZ4(&entry.data[0], entry.data.size(), compressed);
+            if (compressed.size() < entry.data.size() - entry.data.size() / 8)
+            {
+                entry.data.swap(compressed);
+                entry.flags |= PACKAGE_ENTRY_LZ4;
+            }
+        }
+        entry.storedSize = (unsigned int)entry.data.size();
+
+        offset = (offset + PACKAGE_ALIGNMENT - 1) & ~(size_t)(PACKAGE_ALIGNMENT - 1);
+        entry.offset = (unsigned int)offset;
+        offset += entry.storedSize;
+        totalSize += entry.size;
+        totalStoredSize += entry.storedSize;
+        if (offset > 0xffffffffu)
+        {
+            LOG(1, "Error: The package is larger than 4 GB: %s\n", outFilePath);
+            return -1;
+        }
+    }
+
+    FILE* file = fopen(outFilePath, "wb");
+    if (!file)
+    {
+        LOG(1, "Error: Failed to open file for writing: %s\n", outFilePath);
+        return -1;
+    }
+    unsigned int header[2] = { PACKAGE_VERSION, (unsigned int)entries.size() };
+    fwrite(PACKAGE_IDENTIFIER, 1, sizeof(PACKAGE_IDENTIFIER) - 1, file);
+    fwrite(header, sizeof(unsigned int), 2, file);
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        const PackageEntry& entry = entries[i];
+        unsigned int values[5] = { (unsigned int)entry.name.size(), entry.offset, entry.size, entry.storedSize, entry.flags };
+        fwrite(&values[0], sizeof(unsigned int), 1, file);
+        fwrite(entry.name.c_str(), 1, entry.name.size(), file);
+        fwrite(&values[1], sizeof(unsigned int), 4, file);
+    }
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        const PackageEntry& entry = entries[i];
+        static const unsigned char padding[PACKAGE_ALIGNMENT] = { 0 };
+        fwrite(padding, 1, entry.offset - (unsigned int)ftell(file), file);
+        if (!entry.data.empty())
+            fwrite(&entry.data[0], 1, entry.data.size(), file);
+    }
+    fclose(file);
+
+    LOG(1, "Packaged %u files (%u KB, %u KB stored): %s\n", (unsigned int)entries.size(),
+        (unsigned int)(totalSize / 1024), (unsigned int)(totalStoredSize / 1024), outFilePath);
+    return 0;
+}
+
+}
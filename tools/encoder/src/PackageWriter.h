@@ -0,0 +1,37 @@
+#ifndef PACKAGEWRITER_H_
+#define PACKAGEWRITER_H_
+
+namespace gameplay
+{
+
+/**
+ * Writes the files of a directory to a package that FileSystem::mountPackage mounts.
+ *
+ * The package starts with a table of contents that names each file by its path relative
+ * to the directory, followed by the files in that order, each aligned to 16 bytes. Files
+ * that LZ4 makes smaller by at least an eighth are stored compressed; other files are
+ * stored as is, so the runtime can read them in place from a mapped package.
+ *
+ * @param dirPath The directory to package, usually the resource folder of a game.
+ * @param outFilePath The path of the package to write.
+ * @param compress false to store every file as is.
+ *
+ * @return 0 if successful, -1 if error.
+ */
+int writePackage(const char* dirPath, const char* outFilePath, bool compress);
+
+/**
+ * Compresses data to an LZ4 block, which gameplay's FileSystem::decompressLZ4 decompresses.
+ *
+ * Matches are found greedily within the last 64 KB, so the block is larger than what the
+ * reference compressor writes but is as fast to decompress.
+ *
+ * @param src The data to compress.
+ * @param size The size of the data.
+ * @param dst Set to the compressed block.
+ */
+void compressLZ4(const unsigned char* src, size_t size, std::vector<unsigned char>& dst);
+
+}
+
+#endif
@@ -1,6 +1,7 @@
 #include "Base.h"
 #include "TTFFontEncoder.h"
 #include "GPBFile.h"
+#include "EncoderArguments.h"
 #include "StringUtil.h"
 
 namespace gameplay
@@ -34,9 +35,118 @@ static void writeString(FILE* fp, const char* str)
     }
 }
 
-int writeFont(const char* inFilePath, const char* outFilePath, unsigned int fontSize, const char* id, bool fontpreview = false)
+/**
+ * Replaces the vector from pixel (x, y) to its nearest seed pixel by the one through
+ * its neighbour at (x + ox, y + oy), if that one is shorter.
+ */
+static void compareNearest(int* offsets, int width, int height, int x, int y, int ox, int oy)
+{
+    if (x + ox < 0 || x + ox >= width || y + oy < 0 || y + oy >= height)
+        return;
+
+    int* offset = offsets + (y * width + x) * 2;
+    const int* neighbour = offsets + ((y + oy) * width + x + ox) * 2;
+    int dx = neighbour[0] + ox;
+    int dy = neighbour[1] + oy;
+    if (dx * dx + dy * dy < offset[0] * offset[0] + offset[1] * offset[1])
+    {
+        offset[0] = dx;
+        offset[1] = dy;
+    }
+}
+
+/**
+ * Computes the vector from each pixel to the nearest seed pixel, using the 8-point
+ * sequential Euclidean distance transform (two passes over the image).
+ *
+ * The offsets of seed pixels must be (0, 0) and the others must be large.
+ */
+static void computeNearest(int* offsets, int width, int height)
+{
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            compareNearest(offsets, width, height, x, y, -1, 0);
+            compareNearest(offsets, width, height, x, y, 0, -1);
+            compareNearest(offsets, width, height, x, y, -1, -1);
+            compareNearest(offsets, width, height, x, y, 1, -1);
+        }
+        for (int x = width - 1; x >= 0; --x)
+        {
+            compareNearest(offsets, width, height, x, y, 1, 0);
+        }
+    }
+    for (int y = height - 1; y >= 0; --y)
+    {
+        for (int x = width - 1; x >= 0; --x)
+        {
+            compareNearest(offsets, width, height, x, y, 1, 0);
+            compareNearest(offsets, width, height, x, y, 0, 1);
+            compareNearest(offsets, width, height, x, y, -1, 1);
+            compareNearest(offsets, width, height, x, y, 1, 1);
+        }
+        for (int x = 0; x < width; ++x)
+        {
+            compareNearest(offsets, width, height, x, y, -1, 0);
+        }
+    }
+}
+
+/**
+ * Converts a glyph coverage bitmap into a signed distance field that is 'scale' times smaller.
+ *
+ * The distance is stored with the outline at 128, increasing inside the glyphs, and
+ * reaches 0 and 255 at 'spread' pixels (of the distance field) from the outline.
+ */
+static void computeDistanceField(const unsigned char* src, int width, int height, int scale, int spread, unsigned char* dst)
+{
+    const int distant = width + height;
+    const int count = width * height;
+
+    // Vectors to the nearest pixel inside and outside the glyphs.
+    int* inside = new int[count * 2];
+    int* outside = new int[count * 2];
+    for (int i = 0; i < count; ++i)
+    {
+        bool in = src[i] >= 128;
+        inside[i * 2] = inside[i * 2 + 1] = in ? 0 : distant;
+        outside[i * 2] = outside[i * 2 + 1] = in ? distant : 0;
+    }
+    computeNearest(inside, width, height);
+    computeNearest(outside, width, height);
+
+    const int dstWidth = width / scale;
+    const int dstHeight = height / scale;
+    const float range = (float)(spread * scale);
+    for (int y = 0; y < dstHeight; ++y)
+    {
+        for (int x = 0; x < dstWidth; ++x)
+        {
+            // Sample the distance at the center of the block of source pixels.
+            int i = (y * scale + scale / 2) * width + x * scale + scale / 2;
+            float toInside = sqrtf((float)(inside[i * 2] * inside[i * 2] + inside[i * 2 + 1] * inside[i * 2 + 1]));
+            float toOutside = sqrtf((float)(outside[i * 2] * outside[i * 2] + outside[i * 2 + 1] * outside[i * 2 + 1]));
+            float distance = toOutside - toInside;
+
+            float value = 0.5f + 0.5f * distance / range;
+            value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+            dst[y * dstWidth + x] = (unsigned char)(value * 255.0f + 0.5f);
+        }
+    }
+
+    delete[] inside;
+    delete[] outside;
+}
+
+int writeFont(const char* inFilePath, const char* outFilePath, unsigned int fontSize, const char* id, bool fontpreview, bool distanceField)
 {
     Glyph glyphArray[END_INDEX - START_INDEX];
+
+    // Distance fields are computed from glyphs rendered at a larger size, which are kept far
+    // enough apart that each glyph's distances are not affected by its neighbours.
+    const unsigned int scale = distanceField ? DISTANCE_FIELD_SCALE : 1;
+    const int padding = distanceField ? DISTANCE_FIELD_SPREAD * DISTANCE_FIELD_SCALE : GLYPH_PADDING;
     
     // Initialize freetype library.
     FT_Library library;
@@ -60,7 +170,7 @@ int writeFont(const char* inFilePath, const char* outFilePath, unsigned int font
     error = FT_Set_Char_Size(
             face,           // handle to face object.
             0,              // char_width in 1/64th of points.
-            fontSize * 64,   // char_height in 1/64th of points.
+            fontSize * scale * 64,   // char_height in 1/64th of points.
             0,              // horizontal device resolution (defaults to 72 dpi if resolution (0, 0)).
             0 );            // vertical device resolution.
     
@@ -106,7 +216,7 @@ int writeFont(const char* inFilePath, const char* outFilePath, unsigned int font
     }
 
     // Include padding in the rowSize.
-    rowSize += GLYPH_PADDING;
+    rowSize += padding;
     
     // Initialize with padding.
     int penX = 0;
@@ -144,7 +254,7 @@ int writeFont(const char* inFilePath, const char* outFilePath, unsigned int font
             int glyphWidth = slot->bitmap.pitch;
             int glyphHeight = slot->bitmap.rows;
 
-            advance = glyphWidth + GLYPH_PADDING; //((int)slot->advance.x >> 6) + GLYPH_PADDING;
+            advance = glyphWidth + padding; //((int)slot->advance.x >> 6) + padding;
 
             // If we reach the end of the image wrap aroud to the next row.
             if ((penX + advance) > (int)imageWidth)
@@ -212,7 +322,7 @@ int writeFont(const char* inFilePath, const char* outFilePath, unsigned int font
         int glyphWidth = slot->bitmap.pitch;
         int glyphHeight = slot->bitmap.rows;
 
-        advance = glyphWidth + GLYPH_PADDING;//((int)slot->advance.x >> 6) + GLYPH_PADDING;
+        advance = glyphWidth + padding;//((int)slot->advance.x >> 6) + padding;
 
         // If we reach the end of the image wrap aroud to the next row.
         if ((penX + advance) > (int)imageWidth)
@@ -238,12 +348,12 @@ int writeFont(const char* inFilePath, const char* outFilePath, unsigned int font
         penY = row * rowSize;
 
         glyphArray[i].index = ascii;
-        glyphArray[i].width = advance - GLYPH_PADDING;
+        glyphArray[i].width = (advance - padding + scale / 2) / scale;
         
         // Generate UV coords.
         glyphArray[i].uvCoords[0] = (float)penX / (float)imageWidth;
         glyphArray[i].uvCoords[1] = (float)penY / (float)imageHeight;
-        glyphArray[i].uvCoords[2] = (float)(penX + advance - GLYPH_PADDING) / (float)imageWidth;
+        glyphArray[i].uvCoords[2] = (float)(penX + advance - padding) / (float)imageWidth;
         glyphArray[i].uvCoords[3] = (float)(penY + rowSize) / (float)imageHeight;
 
         // Set the pen position for the next glyph
@@ -251,6 +361,17 @@ int writeFont(const char* inFilePath, const char* outFilePath, unsigned int font
         i++;
     }
 
+    if (distanceField)
+    {
+        // Replace the rendered glyphs by their distance field, at the requested font size.
+        unsigned char* fieldBuffer = (unsigned char *)malloc((imageWidth / scale) * (imageHeight / scale));
+        computeDistanceField(imageBuffer, imageWidth, imageHeight, scale, DISTANCE_FIELD_SPREAD, fieldBuffer);
+        free(imageBuffer);
+        imageBuffer = fieldBuffer;
+        imageWidth /= scale;
+        imageHeight /= scale;
+        rowSize /= scale;
+    }
 
     FILE *gpbFp = fopen(outFilePath, "wb");
     
@@ -258,6 +379,7 @@ int writeFont(const char* inFilePath, const char* outFilePath, unsigned int font
     char fileHeader[9]     = {'', 'G', 'P', 'B', '', '\r', '\n', '\x1A', '\n'};
     fwrite(fileHeader, sizeof(char), 9, gpbFp);
     fwrite(gameplay::GPB_VERSION, sizeof(char), 2, gpbFp);
+    writeUint(gpbFp, 0);                // Flags, set by GPBFile::compressBinary
 
     // Write Ref table (for a single font)
     writeUint(gpbFp, 1);                // Ref[] count
@@ -282,6 +404,9 @@ int writeFont(const char* inFilePath, const char* outFilePath, unsigned int font
     // Character set.
     // TODO: Empty for now
     writeString(gpbFp, "");
+
+    // Format.
+    writeUint(gpbFp, distanceField ? 1 : 0); // 1 == DISTANCE_FIELD, 0 == BITMAP
     
     // Glyphs.
     unsigned int glyphSetSize = END_INDEX - START_INDEX;
@@ -298,6 +423,12 @@ int writeFont(const char* inFilePath, const char* outFilePath, unsigned int font
     // Close file.
     fclose(gpbFp);
 
+    if (EncoderArguments::getInstance()->binaryCompressionEnabled() && !GPBFile::compressBinary(outFilePath))
+    {
+        LOG(1, "Error: Failed to compress file: %s\n", outFilePath);
+        return -1;
+    }
+
     LOG(1, "%s.gpb created successfully. \n", getBaseName(outFilePath).c_str());
 
     if (fontpreview)
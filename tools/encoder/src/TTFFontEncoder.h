@@ -5,6 +5,11 @@
 #define END_INDEX       127
 #define GLYPH_PADDING   4
 
+// Distance field fonts are rendered at DISTANCE_FIELD_SCALE times the font size, and store
+// distances of up to DISTANCE_FIELD_SPREAD pixels (at the font size) from the glyph outlines.
+#define DISTANCE_FIELD_SCALE    4
+#define DISTANCE_FIELD_SPREAD   4
+
 namespace gameplay
 {
 
@@ -25,9 +30,11 @@ public:
  * @param fontSize Size of the font.
  * @param id ID string of the font in the ref table.
  * @param fontpreview True if the pgm font preview file should be written. (For debugging)
+ * @param distanceField True if the texture should hold a signed distance field of the glyphs
+ *      instead of their coverage, so that the font can be drawn at any size.
  * 
  * @return 0 if successful, -1 if error.
  */
-int writeFont(const char* inFilePath, const char* outFilePath, unsigned int fontSize, const char* id, bool fontpreview);
+int writeFont(const char* inFilePath, const char* outFilePath, unsigned int fontSize, const char* id, bool fontpreview, bool distanceField = false);
 
 }
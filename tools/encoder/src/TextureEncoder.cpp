@@ -0,0 +1,453 @@
+#include "Base.h"
+#include "TextureEncoder.h"
+#include "Image.h"
+#include "FileIO.h"
+
+// The GL enums written to the KTX header.
+#define KTX_GL_UNSIGNED_BYTE 0x1401
+#define KTX_GL_UNSIGNED_SHORT_4_4_4_4 0x8033
+#define KTX_GL_UNSIGNED_SHORT_5_6_5 0x8363
+#define KTX_GL_RGB 0x1907
+#define KTX_GL_RGBA 0x1908
+#define KTX_GL_LUMINANCE 0x1909
+#define KTX_GL_ETC1_RGB8_OES 0x8D64
+
+namespace gameplay
+{
+
+static const unsigned char KTX_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+// The intensity modifiers of the ETC1 tables; the other two modifiers of each table are their negations.
+static const int ETC1_MODIFIERS[8][2] = { { 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 }, { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 } };
+
+/**
+ * A mip level, as linear RGBA floats with the colors premultiplied by alpha.
+ */
+struct TextureLevel
+{
+    unsigned int width;
+    unsigned int height;
+    std::vector<float> pixels;
+};
+
+static float toLinear(float c)
+{
+    return c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+}
+
+static float toSRGB(float c)
+{
+    return c <= 0.0031308f ? c * 12.92f : 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+}
+
+static unsigned char toByte(float c)
+{
+    int value = (int)(c * 255.0f + 0.5f);
+    return (unsigned char)std::min(std::max(value, 0), 255);
+}
+
+static int clampByte(int value)
+{
+    return std::min(std::max(value, 0), 255);
+}
+
+/**
+ * Converts an image to the first level, flipping its rows so that the first row is the bottom row.
+ */
+static void readLevel(Image* image, bool linear, TextureLevel* level)
+{
+    level->width = image->getWidth();
+    level->height = image->getHeight();
+    level->pixels.resize(level->width * level->height * 4);
+
+    const unsigned char* data = (const unsigned char*)image->getData();
+    unsigned int bpp = image->getBpp();
+    for (unsigned int y = 0; y < level->height; ++y)
+    {
+        const unsigned char* row = data + (level->height - 1 - y) * level->width * bpp;
+        for (unsigned int x = 0; x < level->width; ++x)
+        {
+            const unsigned char* pixel = row + x * bpp;
+            float* out = &level->pixels[(y * level->width + x) * 4];
+            float alpha = bpp == 4 ? pixel[3] / 255.0f : 1.0f;
+            for (unsigned int c = 0; c < 3; ++c)
+            {
+                float value = pixel[bpp >= 3 ? c : 0] / 255.0f;
+                out[c] = (linear ? value : toLinear(value)) * alpha;
+            }
+            out[3] = alpha;
+        }
+    }
+}
+
+/**
+ * Filters a level to the next smaller level with a box filter.
+ */
+static void downsample(const TextureLevel& source, TextureLevel* level)
+{
+    level->width = std::max(source.width / 2, 1u);
+    level->height = std::max(source.height / 2, 1u);
+    level->pixels.resize(level->width * level->height * 4);
+
+    for (unsigned int y = 0; y < level->height; ++y)
+    {
+        unsigned int y0 = std::min(y * 2, source.height - 1);
+        unsigned int y1 = std::min(y * 2 + 1, source.height - 1);
+        for (unsigned int x = 0; x < level->width; ++x)
+        {
+            unsigned int x0 = std::min(x * 2, source.width - 1);
+            unsigned int x1 = std::min(x * 2 + 1, source.width - 1);
+            const float* p00 = &source.pixels[(y0 * source.width + x0) * 4];
+            const float* p01 = &source.pixels[(y0 * source.width + x1) * 4];
+            const float* p10 = &source.pixels[(y1 * source.width + x0) * 4];
+            const float* p11 = &source.pixels[(y1 * source.width + x1) * 4];
+            float* out = &level->pixels[(y * level->width + x) * 4];
+            for (unsigned int c = 0; c < 4; ++c)
+            {
+                out[c] = (p00[c] + p01[c] + p10[c] + p11[c]) * 0.25f;
+            }
+        }
+    }
+}
+
+/**
+ * Converts a level to 8-bit RGBA, undoing the premultiplication.
+ */
+static void writeBytes(const TextureLevel& level, bool linear, std::vector<unsigned char>* rgba)
+{
+    size_t count = level.width * level.height;
+    rgba->resize(count * 4);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float* pixel = &level.pixels[i * 4];
+        float alpha = pixel[3];
+        for (unsigned int c = 0; c < 3; ++c)
+        {
+            float value = alpha > 0.0f ? std::min(pixel[c] / alpha, 1.0f) : 0.0f;
+            (*rgba)[i * 4 + c] = toByte(linear ? value : toSRGB(value));
+        }
+        (*rgba)[i * 4 + 3] = toByte(alpha);
+    }
+}
+
+/**
+ * Finds the table of an ETC1 subblock with the least error for the given base color.
+ *
+ * @return The squared error of the subblock.
+ */
+static int encodeETC1Subblock(const int block[16][3], const int pixels[8], const int base[3], unsigned int* table, unsigned int indices[8])
+{
+    int bestError = INT_MAX;
+    for (unsigned int t = 0; t < 8; ++t)
+    {
+        int modifiers[4] = { ETC1_MODIFIERS[t][0], ETC1_MODIFIERS[t][1], -ETC1_MODIFIERS[t][0], -ETC1_MODIFIERS[t][1] };
+        int error = 0;
+        unsigned int tableIndices[8];
+        for (unsigned int i = 0; i < 8 && error < bestError; ++i)
+        {
+            const int* color = block[pixels[i]];
+            int pixelError = INT_MAX;
+            for (unsigned int m = 0; m < 4; ++m)
+            {
+                int dr = clampByte(base[0] + modifiers[m]) - color[0];
+                int dg = clampByte(base[1] + modifiers[m]) - color[1];
+                int db = clampByte(base[2] + modifiers[m]) - color[2];
+                int e = dr * dr + dg * dg + db * db;
+                if (e < pixelError)
+                {
+                    pixelError = e;
+                    tableIndices[i] = m;
+                }
+            }
+            error += pixelError;
+        }
+        if (error < bestError)
+        {
+            bestError = error;
+            *table = t;
+            memcpy(indices, tableIndices, sizeof(tableIndices));
+        }
+    }
+    return bestError;
+}
+
+/**
+ * Compresses a 4x4 block of RGB pixels, stored row by row, to ETC1.
+ *
+ * Both orientations of the subblocks are tried, in the individual mode and, when the base
+ * colors are close enough, the differential mode.
+ */
+static void encodeETC1Block(const int block[16][3], unsigned char out[8])
+{
+    int bestError = INT_MAX;
+    for (unsigned int flip = 0; flip < 2; ++flip)
+    {
+        // The pixels of each subblock: the left and right halves, or the top and bottom halves when flipped.
+        int pixels[2][8];
+        float average[2][3] = { { 0, 0, 0 }, { 0, 0, 0 } };
+        unsigned int counts[2] = { 0, 0 };
+        for (unsigned int y = 0; y < 4; ++y)
+        {
+            for (unsigned int x = 0; x < 4; ++x)
+            {
+                unsigned int s = flip ? y / 2 : x / 2;
+                pixels[s][counts[s]++] = y * 4 + x;
+                for (unsigned int c = 0; c < 3; ++c)
+                    average[s][c] += block[y * 4 + x][c] / 8.0f;
+            }
+        }
+
+        for (unsigned int differential = 0; differential < 2; ++differential)
+        {
+            int quantized[2][3];
+            int base[2][3];
+            bool valid = true;
+            for (unsigned int s = 0; s < 2; ++s)
+            {
+                for (unsigned int c = 0; c < 3; ++c)
+                {
+                    if (differential)
+                    {
+                        quantized[s][c] = (int)(average[s][c] * 31.0f / 255.0f + 0.5f);
+                        base[s][c] = (quantized[s][c] << 3) | (quantized[s][c] >> 2);
+                    }
+                    else
+                    {
+                        quantized[s][c] = (int)(average[s][c] * 15.0f / 255.0f + 0.5f);
+                        base[s][c] = (quantized[s][c] << 4) | quantized[s][c];
+                    }
+                }
+            }
+            if (differential)
+            {
+                for (unsigned int c = 0; c < 3; ++c)
+                {
+                    int delta = quantized[1][c] - quantized[0][c];
+                    valid = valid && delta >= -4 && delta <= 3;
+                }
+            }
+            if (!valid)
+                continue;
+
+            unsigned int tables[2];
+            unsigned int indices[2][8];
+            int error = encodeETC1Subblock(block, pixels[0], base[0], &tables[0], indices[0]);
+            if (error >= bestError)
+                continue;
+            error += encodeETC1Subblock(block, pixels[1], base[1], &tables[1], indices[1]);
+            if (error >= bestError)
+                continue;
+            bestError = error;
+
+            for (unsigned int c = 0; c < 3; ++c)
+            {
+                if (differential)
+                    out[c] = (unsigned char)((quantized[0][c] << 3) | ((quantized[1][c] - quantized[0][c]) & 7));
+                else
+                    out[c] = (unsigned char)((quantized[0][c] << 4) | quantized[1][c]);
+            }
+            out[3] = (unsigned char)((tables[0] << 5) | (tables[1] << 2) | (differential << 1) | flip);
+
+            // The indices are stored column by column, the most significant bits first.
+            unsigned int msb = 0;
+            unsigned int lsb = 0;
+            for (unsigned int s = 0; s < 2; ++s)
+            {
+                for (unsigned int i = 0; i < 8; ++i)
+                {
+                    unsigned int x = pixels[s][i] % 4;
+                    unsigned int y = pixels[s][i] / 4;
+                    unsigned int bit = x * 4 + y;
+                    msb |= (indices[s][i] >> 1) << bit;
+                    lsb |= (indices[s][i] & 1) << bit;
+                }
+            }
+            out[4] = (unsigned char)(msb >> 8);
+            out[5] = (unsigned char)msb;
+            out[6] = (unsigned char)(lsb >> 8);
+            out[7] = (unsigned char)lsb;
+        }
+    }
+}
+
+/**
+ * Writes the data of a level in the format of the texture.
+ */
+static void encodeLevel(const std::vector<unsigned char>& rgba, unsigned int width, unsigned int height, unsigned int glType, unsigned int glFormat, std::vector<unsigned char>* data)
+{
+    data->clear();
+    if (glType == 0)
+    {
+        // ETC1 blocks, with the pixels outside of the level repeating its edges.
+        for (unsigned int by = 0; by < height; by += 4)
+        {
+            for (unsigned int bx = 0; bx < width; bx += 4)
+            {
+                int block[16][3];
+                for (unsigned int y = 0; y < 4; ++y)
+                {
+                    for (unsigned int x = 0; x < 4; ++x)
+                    {
+                        const unsigned char* pixel = &rgba[((std::min(by + y, height - 1)) * width + std::min(bx + x, width - 1)) * 4];
+                        for (unsigned int c = 0; c < 3; ++c)
+                            block[y * 4 + x][c] = pixel[c];
+                    }
+                }
+                unsigned char bytes[8];
+                encodeETC1Block(block, bytes);
+                data->insert(data->end(), bytes, bytes + 8);
+            }
+        }
+        return;
+    }
+
+    // Rows are padded to 4 bytes, the unpack alignment the runtime uploads with.
+    unsigned int pixelSize = glType == KTX_GL_UNSIGNED_BYTE ? (glFormat == KTX_GL_RGBA ? 4 : glFormat == KTX_GL_RGB ? 3 : 1) : 2;
+    unsigned int stride = (width * pixelSize + 3) & ~3u;
+    data->resize(stride * height, 0);
+    for (unsigned int y = 0; y < height; ++y)
+    {
+        unsigned char* row = &(*data)[y * stride];
+        for (unsigned int x = 0; x < width; ++x)
+        {
+            const unsigned char* pixel = &rgba[(y * width + x) * 4];
+            unsigned char* out = row + x * pixelSize;
+            if (glType == KTX_GL_UNSIGNED_SHORT_5_6_5)
+            {
+                unsigned short value = (unsigned short)((((pixel[0] * 31 + 127) / 255) << 11) | (((pixel[1] * 63 + 127) / 255) << 5) | ((pixel[2] * 31 + 127) / 255));
+                memcpy(out, &value, sizeof(value));
+            }
+            else if (glType == KTX_GL_UNSIGNED_SHORT_4_4_4_4)
+            {
+                unsigned short value = (unsigned short)((((pixel[0] * 15 + 127) / 255) << 12) | (((pixel[1] * 15 + 127) / 255) << 8) |
+                                                        (((pixel[2] * 15 + 127) / 255) << 4) | ((pixel[3] * 15 + 127) / 255));
+                memcpy(out, &value, sizeof(value));
+            }
+            else
+            {
+                memcpy(out, pixel, pixelSize);
+            }
+        }
+    }
+}
+
+int writeTexture(const char* inFilePath, const char* outFilePath, EncoderArguments::TextureFormatOption format, bool linear)
+{
+    Image* image = Image::create(inFilePath);
+    if (image == NULL)
+    {
+        LOG(1, "Error: Failed to load image: %s\n", inFilePath);
+        return -1;
+    }
+
+    // Alpha that is opaque everywhere is not written.
+    bool alpha = false;
+    if (image->getFormat() == Image::RGBA)
+    {
+        const unsigned char* data = (const unsigned char*)image->getData();
+        for (unsigned int i = 0, count = image->getWidth() * image->getHeight(); i < count && !alpha; ++i)
+            alpha = data[i * 4 + 3] != 255;
+    }
+    if (format == EncoderArguments::TEXTUREFORMAT_ETC1 && alpha)
+    {
+        LOG(1, "Warning: ETC1 has no alpha, so %s is written uncompressed.\n", inFilePath);
+        format = EncoderArguments::TEXTUREFORMAT_UNCOMPRESSED;
+    }
+
+    unsigned int glType;
+    unsigned int glTypeSize;
+    unsigned int glFormat;
+    unsigned int glInternalFormat;
+    switch (format)
+    {
+    case EncoderArguments::TEXTUREFORMAT_ETC1:
+        glType = 0;
+        glTypeSize = 1;
+        glFormat = 0;
+        glInternalFormat = KTX_GL_ETC1_RGB8_OES;
+        break;
+    case EncoderArguments::TEXTUREFORMAT_16BIT:
+        glType = alpha ? KTX_GL_UNSIGNED_SHORT_4_4_4_4 : KTX_GL_UNSIGNED_SHORT_5_6_5;
+        glTypeSize = 2;
+        glFormat = alpha ? KTX_GL_RGBA : KTX_GL_RGB;
+        glInternalFormat = glFormat;
+        break;
+    default:
+        glType = KTX_GL_UNSIGNED_BYTE;
+        glTypeSize = 1;
+        glFormat = alpha ? KTX_GL_RGBA : (image->getFormat() == Image::LUMINANCE ? KTX_GL_LUMINANCE : KTX_GL_RGB);
+        glInternalFormat = glFormat;
+        break;
+    }
+
+    unsigned int width = image->getWidth();
+    unsigned int height = image->getHeight();
+    if ((width & (width - 1)) != 0 || (height & (height - 1)) != 0)
+    {
+        LOG(1, "Warning: %s is not a power of two in size; OpenGL ES 2 does not sample the mip levels of such textures.\n", inFilePath);
+    }
+    unsigned int levelCount = 1;
+    while ((width >> levelCount) > 0 || (height >> levelCount) > 0)
+        ++levelCount;
+
+    TextureLevel level;
+    readLevel(image, linear, &level);
+    SAFE_DELETE(image);
+
+    FILE* file = fopen(outFilePath, "wb");
+    if (file == NULL)
+    {
+        LOG(1, "Error: Failed to open file for writing: %s\n", outFilePath);
+        return -1;
+    }
+
+    // The header is written in the byte order of this machine, which its endianness field records.
+    fwrite(KTX_IDENTIFIER, 1, sizeof(KTX_IDENTIFIER), file);
+    write((unsigned int)0x04030201, file);
+    write(glType, file);
+    write(glTypeSize, file);
+    write(glFormat, file);
+    write(glInternalFormat, file);
+    write(glFormat == 0 ? (unsigned int)KTX_GL_RGB : glFormat, file);
+    write(width, file);
+    write(height, file);
+    write((unsigned int)0, file);
+    write((unsigned int)0, file);
+    write((unsigned int)1, file);
+    write(levelCount, file);
+    write((unsigned int)0, file);
+
+    // Each level is filtered from the previous level, before it is rounded to bytes.
+    std::vector<unsigned char> rgba;
+    std::vector<unsigned char> data;
+    for (unsigned int i = 0; i < levelCount; ++i)
+    {
+        if (i > 0)
+        {
+            TextureLevel next;
+            downsample(level, &next);
+            level.pixels.swap(next.pixels);
+            level.width = next.width;
+            level.height = next.height;
+        }
+        writeBytes(level, linear, &rgba);
+        encodeLevel(rgba, level.width, level.height, glType, glFormat, &data);
+
+        unsigned int imageSize = (unsigned int)data.size();
+        write(imageSize, file);
+        fwrite(&data[0], 1, data.size(), file);
+        static const unsigned char padding[3] = { 0, 0, 0 };
+        fwrite(padding, 1, ((imageSize + 3) & ~3u) - imageSize, file);
+    }
+
+    bool failed = ferror(file) != 0;
+    if (fclose(file) != 0 || failed)
+    {
+        LOG(1, "Error: Failed to write file: %s\n", outFilePath);
+        return -1;
+    }
+    LOG(2, "Wrote %u mip levels of %ux%u to %s\n", levelCount, width, height, outFilePath);
+    return 0;
+}
+
+}
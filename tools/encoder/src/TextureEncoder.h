@@ -0,0 +1,33 @@
+#ifndef TEXTUREENCODER_H_
+#define TEXTUREENCODER_H_
+
+#include "EncoderArguments.h"
+
+namespace gameplay
+{
+
+/**
+ * Writes a PNG image to a KTX texture with a complete chain of mip levels, which
+ * Texture::create uploads level by level instead of generating the levels at load time.
+ *
+ * Each level is filtered from the previous one with a box filter. Colors are filtered in
+ * linear space, assuming the image is sRGB, unless linear filtering is requested, which
+ * suits normal maps and other data. Colors are weighted by their alpha, so transparent
+ * pixels do not bleed into the levels.
+ *
+ * The rows are written bottom up, as the runtime loads PNG images. Images whose alpha is
+ * opaque everywhere are written without alpha. ETC1 has no alpha, so images with alpha are
+ * written uncompressed when ETC1 is requested.
+ *
+ * @param inFilePath The path of the PNG image.
+ * @param outFilePath The path of the KTX file to write.
+ * @param format The format to write the levels in.
+ * @param linear true to filter the levels without converting them from sRGB, false otherwise.
+ *
+ * @return 0 if successful, -1 if error.
+ */
+int writeTexture(const char* inFilePath, const char* outFilePath, EncoderArguments::TextureFormatOption format, bool linear);
+
+}
+
+#endif
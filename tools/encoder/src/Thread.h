@@ -1,6 +1,10 @@
 #ifndef THREAD_H_
 #define THREAD_H_
 
+#ifndef WIN32
+    #include <unistd.h>
+#endif
+
 namespace gameplay
 {
 
@@ -16,7 +20,7 @@ namespace gameplay
         void* arg;
     };
 
-    DWORD WINAPI WindowsThreadProc(LPVOID lpParam)
+    static DWORD WINAPI WindowsThreadProc(LPVOID lpParam)
     {
         WindowsThreadData* data = (WindowsThreadData*)lpParam;
         int(*threadFunction)(void*) = data->threadFunction;
@@ -45,6 +49,13 @@ namespace gameplay
         CloseHandle(thread);
     }
 
+    static unsigned int getProcessorCount()
+    {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwNumberOfProcessors > 0 ? (unsigned int)info.dwNumberOfProcessors : 1;
+    }
+
 #else
 
     #include <pthread.h>
@@ -57,7 +68,7 @@ namespace gameplay
         void* arg;
     };
 
-    void* PThreadProc(void* threadData)
+    static void* PThreadProc(void* threadData)
     {
         PThreadData* data = (PThreadData*)threadData;
         int(*threadFunction)(void*) = data->threadFunction;
@@ -92,6 +103,12 @@ namespace gameplay
         // nothing to do... waitForThreads (which calls join) cleans up
     }
 
+    static unsigned int getProcessorCount()
+    {
+        long count = sysconf(_SC_NPROCESSORS_ONLN);
+        return count > 0 ? (unsigned int)count : 1;
+    }
+
 #endif
 
 }
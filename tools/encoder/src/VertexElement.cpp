@@ -6,10 +6,21 @@ namespace gameplay
 
 VertexElement::VertexElement(unsigned int t, unsigned int c) :
     usage(t),
-    size(c)
+    size(c),
+    type(FLOAT),
+    normalized(false)
 {
 }
 
+VertexElement::VertexElement(unsigned int t, unsigned int c, Type type, bool normalized) :
+    usage(t),
+    size(c),
+    type(type),
+    normalized(normalized)
+{
+    assert(type != INT_2_10_10_10_REV || c == 4);
+}
+
 VertexElement::~VertexElement(void)
 {
 }
@@ -23,12 +34,16 @@ void VertexElement::writeBinary(FILE* file)
     Object::writeBinary(file);
     write(usage, file);
     write(size, file);
+    write((unsigned int)type, file);
+    write(normalized, file);
 }
 void VertexElement::writeText(FILE* file)
 {
     fprintElementStart(file);
     fprintfElement(file, "usage", usageStr(usage));
     fprintfElement(file, "size", size);
+    fprintfElement(file, "type", (unsigned int)type);
+    fprintfElement(file, "normalized", (unsigned int)normalized);
     fprintElementEnd(file);
 }
 
@@ -73,4 +88,132 @@ const char* VertexElement::usageStr(unsigned int usage)
     }
 }
 
+unsigned int VertexElement::byteSize() const
+{
+    switch (type)
+    {
+    case HALF_FLOAT:
+    case SHORT:
+    case UNSIGNED_SHORT:
+        return size * 2;
+    case BYTE:
+    case UNSIGNED_BYTE:
+        return size;
+    case INT_2_10_10_10_REV:
+        return 4;
+    default:
+        return size * sizeof(float);
+    }
+}
+
+// Converts a float to a 16-bit float, rounding to the nearest value.
+static unsigned short floatToHalf(float value)
+{
+    unsigned int bits;
+    memcpy(&bits, &value, sizeof(bits));
+    unsigned short sign = (unsigned short)((bits >> 16) & 0x8000);
+    int exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+    unsigned int mantissa = bits & 0x7fffff;
+    if (exponent >= 31)
+    {
+        return sign | 0x7c00;
+    }
+    if (exponent <= 0)
+    {
+        // Denormalized
+        if (exponent < -10)
+        {
+            return sign;
+        }
+        mantissa |= 0x800000;
+        unsigned int shift = 14 - exponent;
+        unsigned int half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1)
+        {
+            ++half;
+        }
+        return sign | (unsigned short)half;
+    }
+    // Rounding may carry into the exponent, which gives the next power of two as it should.
+    unsigned int half = ((unsigned int)exponent << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000)
+    {
+        ++half;
+    }
+    return sign | (unsigned short)std::min(half, 0x7c00u);
+}
+
+// Converts a float to an integer of the given number of bits, as read back by the GPU.
+static int quantize(float value, unsigned int bits, bool isSigned, bool normalized)
+{
+    int maxValue = isSigned ? (1 << (bits - 1)) - 1 : (1 << bits) - 1;
+    int minValue = isSigned ? -maxValue - (normalized ? 0 : 1) : 0;
+    float v = normalized ? value * maxValue : value;
+    int i = (int)floor(v + 0.5f);
+    return std::max(minValue, std::min(maxValue, i));
+}
+
+void VertexElement::writeBinaryValues(const float* values, FILE* file) const
+{
+    float weights[4];
+    if (usage == BLENDWEIGHTS && normalized && type == UNSIGNED_BYTE && size <= 4)
+    {
+        // Keep quantized blend weights adding up to one, by giving the
+        // rounding error to the largest weight.
+        int total = 0;
+        unsigned int largest = 0;
+        for (unsigned int i = 0; i < size; ++i)
+        {
+            total += quantize(values[i], 8, false, true);
+            if (values[i] > values[largest])
+            {
+                largest = i;
+            }
+        }
+        memcpy(weights, values, size * sizeof(float));
+        if (total > 0 && abs(255 - total) <= (int)size)
+        {
+            weights[largest] += (255 - total) / 255.0f;
+        }
+        values = weights;
+    }
+
+    switch (type)
+    {
+    case HALF_FLOAT:
+        for (unsigned int i = 0; i < size; ++i)
+            write(floatToHalf(values[i]), file);
+        break;
+    case BYTE:
+        for (unsigned int i = 0; i < size; ++i)
+            write((char)quantize(values[i], 8, true, normalized), file);
+        break;
+    case UNSIGNED_BYTE:
+        for (unsigned int i = 0; i < size; ++i)
+            write((unsigned char)quantize(values[i], 8, false, normalized), file);
+        break;
+    case SHORT:
+        for (unsigned int i = 0; i < size; ++i)
+            write((unsigned short)quantize(values[i], 16, true, normalized), file);
+        break;
+    case UNSIGNED_SHORT:
+        for (unsigned int i = 0; i < size; ++i)
+            write((unsigned short)quantize(values[i], 16, false, normalized), file);
+        break;
+    case INT_2_10_10_10_REV:
+        {
+            unsigned int packed =
+                ((unsigned int)quantize(values[0], 10, true, normalized) & 0x3ff) |
+                (((unsigned int)quantize(values[1], 10, true, normalized) & 0x3ff) << 10) |
+                (((unsigned int)quantize(values[2], 10, true, normalized) & 0x3ff) << 20) |
+                (((unsigned int)quantize(values[3], 2, true, normalized) & 0x3) << 30);
+            write(packed, file);
+        }
+        break;
+    default:
+        write(values, size, file);
+        break;
+    }
+}
+
 }
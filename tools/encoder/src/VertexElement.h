@@ -10,11 +10,30 @@ class VertexElement : public Object
 {
 public:
 
+    /**
+     * The types of the values of vertex elements, as in VertexFormat::Type.
+     */
+    enum Type
+    {
+        FLOAT = 0,
+        HALF_FLOAT = 1,
+        BYTE = 2,
+        UNSIGNED_BYTE = 3,
+        SHORT = 4,
+        UNSIGNED_SHORT = 5,
+        INT_2_10_10_10_REV = 6
+    };
+
     /**
      * Constructor.
      */
     VertexElement(unsigned int t, unsigned int c);
 
+    /**
+     * Constructor.
+     */
+    VertexElement(unsigned int t, unsigned int c, Type type, bool normalized);
+
     /**
      * Destructor.
      */
@@ -26,8 +45,22 @@ public:
 
     static const char* usageStr(unsigned int usage);
 
+    /**
+     * Returns the size of the element in bytes.
+     */
+    unsigned int byteSize() const;
+
+    /**
+     * Converts the values of the element to its type and writes them to the binary file stream.
+     *
+     * @param values The size values of the element, as floats.
+     */
+    void writeBinaryValues(const float* values, FILE* file) const;
+
     unsigned int usage;
     unsigned int size;
+    Type type;
+    bool normalized;
 };
 
 }
@@ -4,6 +4,10 @@
 #include "GPBDecoder.h"
 #include "EncoderArguments.h"
 #include "NormalMapGenerator.h"
+#include "LuaCompiler.h"
+#include "PackageWriter.h"
+#include "BatchEncoder.h"
+#include "TextureEncoder.h"
 
 using namespace gameplay;
 
@@ -32,35 +36,12 @@ static unsigned int promptUserFontSize()
 }
 
 /**
- * Main application entry point.
- *
- * @param argc The number of command line arguments
- * @param argv The array of command line arguments.
- *
- * usage:   gameplay-encoder[options] <file_list>
- * example: gameplay-encoder C:/assets/duck.fbx
- * example: gameplay-encoder -i boy duck.fbx
+ * Encodes the input file.
  *
- * @stod: Improve argument parsing.
+ * @return 0 if successful, -1 if error.
  */
-int main(int argc, const char** argv)
+static int encode(const EncoderArguments& arguments)
 {
-    EncoderArguments arguments(argc, argv);
-
-    if (arguments.parseErrorOccured())
-    {
-        arguments.printUsage();
-        return 0;
-    }
-
-    // Check if the file exists.
-    if (!arguments.fileExists())
-    {
-        LOG(1, "Error: File not found: %s\n", arguments.getFilePathPointer());
-        return -1;
-    }
-
-    // File exists
     LOG(1, "Encoding file: %s\n", arguments.getFilePathPointer());
 
     switch (arguments.getFileFormat())
@@ -85,7 +66,7 @@ int main(int argc, const char** argv)
                 fontSize = promptUserFontSize();
             }
             std::string id = getBaseName(arguments.getFilePath());
-            writeFont(arguments.getFilePath().c_str(), arguments.getOutputFilePath().c_str(), fontSize, id.c_str(), arguments.fontPreviewEnabled());
+            writeFont(arguments.getFilePath().c_str(), arguments.getOutputFilePath().c_str(), fontSize, id.c_str(), arguments.fontPreviewEnabled(), arguments.fontDistanceFieldEnabled());
             break;
         }
     case EncoderArguments::FILEFORMAT_GPB:
@@ -105,6 +86,11 @@ int main(int argc, const char** argv)
                 NormalMapGenerator generator(arguments.getFilePath().c_str(), arguments.getOutputFilePath().c_str(), x, y, arguments.getHeightmapWorldSize());
                 generator.generate();
             }
+            else if (arguments.getTextureFormat() != EncoderArguments::TEXTUREFORMAT_NONE && arguments.getFileFormat() == EncoderArguments::FILEFORMAT_PNG)
+            {
+                if (writeTexture(arguments.getFilePath().c_str(), arguments.getOutputFilePath().c_str(), arguments.getTextureFormat(), arguments.textureLinearFilteringEnabled()) != 0)
+                    return -1;
+            }
             else
             {
                 LOG(1, "Error: Nothing to do for specified file format. Did you forget an option?\n");
@@ -112,6 +98,12 @@ int main(int argc, const char** argv)
             }
             break;
         }
+    case EncoderArguments::FILEFORMAT_LUA:
+        {
+            if (compileScript(arguments.getFilePath().c_str(), arguments.getOutputFilePath().c_str()) != 0)
+                return -1;
+            break;
+        }
    default:
         {
             LOG(1, "Error: Unsupported file format: %s\n", arguments.getFilePathPointer());
@@ -121,3 +113,74 @@ int main(int argc, const char** argv)
 
     return 0;
 }
+
+/**
+ * Main application entry point.
+ *
+ * @param argc The number of command line arguments
+ * @param argv The array of command line arguments.
+ *
+ * usage:   gameplay-encoder[options] <file_list>
+ * example: gameplay-encoder C:/assets/duck.fbx
+ * example: gameplay-encoder -i boy duck.fbx
+ *
+ * @stod: Improve argument parsing.
+ */
+int main(int argc, const char** argv)
+{
+    EncoderArguments arguments(argc, argv);
+
+    if (arguments.parseErrorOccured())
+    {
+        arguments.printUsage();
+        return 0;
+    }
+
+    // Check if the file exists.
+    if (!arguments.fileExists())
+    {
+        LOG(1, "Error: File not found: %s\n", arguments.getFilePathPointer());
+        return -1;
+    }
+
+    if (arguments.packageEnabled())
+    {
+        LOG(1, "Packaging directory: %s\n", arguments.getFilePathPointer());
+        return writePackage(arguments.getFilePathPointer(), arguments.getOutputFilePath().c_str(), arguments.packageCompressionEnabled());
+    }
+
+    if (arguments.batchEnabled())
+    {
+        LOG(1, "Encoding directory: %s\n", arguments.getFilePathPointer());
+        return encodeBatch(arguments, argv[0]);
+    }
+
+    if (arguments.normalMapGeneration() && arguments.isDirectory())
+    {
+        int x, y;
+        arguments.getHeightmapResolution(&x, &y);
+        return generateNormalMaps(arguments.getFilePathPointer(), arguments.getOutputDirPath().c_str(), x, y, arguments.getHeightmapWorldSize());
+    }
+
+    if (arguments.getCachePath().empty())
+    {
+        return encode(arguments);
+    }
+
+    // Skip the input if it is unchanged since it was last encoded.
+    EncoderCache cache(arguments.getCachePath());
+    std::string outputPath = arguments.getOutputFilePath();
+    unsigned long long key = EncoderCache::computeKey(arguments.getFilePath(), outputPath, arguments.getEncoderOptions());
+    if (cache.isUpToDate(arguments.getFilePath(), outputPath, key))
+    {
+        LOG(1, "Up to date: %s\n", arguments.getFilePathPointer());
+        return 0;
+    }
+    int result = encode(arguments);
+    if (result == 0)
+        cache.set(arguments.getFilePath(), key);
+    else
+        cache.remove(arguments.getFilePath());
+    cache.save();
+    return result;
+}
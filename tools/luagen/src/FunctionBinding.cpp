@@ -9,9 +9,15 @@ static inline void outputLuaTypeCheck(ostream& o, int index, const FunctionBindi
 static inline void indent(ostream& o, int indentLevel);
 static inline void outputBindingInvocation(ostream& o, const FunctionBinding& b, unsigned int paramCount, unsigned int indentLevel, int numBindings);
 static inline void outputGetParam(ostream& o, const FunctionBinding::Param& p, int i, int indentLevel, bool offsetIndex, int numBindings);
-static inline void outputMatchedBinding(ostream& o, const FunctionBinding& b, unsigned int paramCount, unsigned int indentLevel, int numBindings);
+static inline void outputMatchedBinding(ostream& o, const FunctionBinding& b, unsigned int paramCount, unsigned int indentLevel, int numBindings,
+    unsigned int dispatchIndex, bool checkTypes);
+static inline void outputDispatchSwitch(ostream& o, const vector<const FunctionBinding*>& candidates, unsigned int paramCount, unsigned int dispatchIndex, int numBindings);
+static inline void getLuaTypes(const FunctionBinding& b, unsigned int index, vector<string>& types);
+static inline unsigned int getDispatchIndex(const vector<const FunctionBinding*>& candidates, unsigned int paramCount);
+static inline bool isCheckedByConversion(const FunctionBinding::Param& p);
 static inline void outputReturnValue(ostream& o, const FunctionBinding& b, int indentLevel);
 static inline std::string getTypeName(const FunctionBinding::Param& param);
+static inline bool isInlineValue(const FunctionBinding::Param& param);
 
 FunctionBinding::Param::Param(FunctionBinding::Param::Type type, Kind kind, const string& info) : 
     type(type), kind(kind), info(info), hasDefaultValue(false), levelsOfIndirection(0)
@@ -133,7 +139,10 @@ void FunctionBinding::write(ostream& o, const vector<FunctionBinding>& bindings)
                 o << "        void* returnPtr = (void*)instance->" << bindings[0].name << ";\n";
                 break;
             case FunctionBinding::Param::KIND_VALUE:
-                o << "        void* returnPtr = (void*)new " << bindings[0].returnParam << "(instance->" << bindings[0].name << ");\n";
+                if (isInlineValue(bindings[0].returnParam))
+                    o << "        " << bindings[0].returnParam << " returnValue = instance->" << bindings[0].name << ";\n";
+                else
+                    o << "        void* returnPtr = (void*)new " << bindings[0].returnParam << "(instance->" << bindings[0].name << ");\n";
                 break;
             case FunctionBinding::Param::KIND_REFERENCE:
                 o << "        void* returnPtr = (void*)&(instance->" << bindings[0].name << ");\n";
@@ -208,10 +217,13 @@ void FunctionBinding::write(ostream& o, const vector<FunctionBinding>& bindings)
                 o << bindings[0].name << ";\n";
                 break;
             case FunctionBinding::Param::KIND_VALUE:
-                o << "        void* returnPtr = (void*)new " << bindings[0].returnParam << "(";
+                if (isInlineValue(bindings[0].returnParam))
+                    o << "        " << bindings[0].returnParam << " returnValue = ";
+                else
+                    o << "        void* returnPtr = (void*)new " << bindings[0].returnParam << "(";
                 if (bindings[0].classname.size() > 0)
                     o << bindings[0].classname << "::";
-                o << bindings[0].name << ");\n";
+                o << bindings[0].name << (isInlineValue(bindings[0].returnParam) ? ";\n" : ");\n");
                 break;
             case FunctionBinding::Param::KIND_REFERENCE:
                 o << "        void* returnPtr = (void*)&(";
@@ -255,7 +267,10 @@ void FunctionBinding::write(ostream& o, const vector<FunctionBinding>& bindings)
                 o << "    void* returnPtr = (void*)instance->" << bindings[0].name << ";\n";
                 break;
             case FunctionBinding::Param::KIND_VALUE:
-                o << "    void* returnPtr = (void*)new " << bindings[0].returnParam << "(instance->" << bindings[0].name << ");\n";
+                if (isInlineValue(bindings[0].returnParam))
+                    o << "    " << bindings[0].returnParam << " returnValue = instance->" << bindings[0].name << ";\n";
+                else
+                    o << "    void* returnPtr = (void*)new " << bindings[0].returnParam << "(instance->" << bindings[0].name << ");\n";
                 break;
             case FunctionBinding::Param::KIND_REFERENCE:
                 o << "    void* returnPtr = (void*)&(instance->" << bindings[0].name << ");\n";
@@ -296,10 +311,13 @@ void FunctionBinding::write(ostream& o, const vector<FunctionBinding>& bindings)
                 o << bindings[0].name << ";\n";
                 break;
             case FunctionBinding::Param::KIND_VALUE:
-                o << "    void* returnPtr = (void*)new " << bindings[0].returnParam << "(";
+                if (isInlineValue(bindings[0].returnParam))
+                    o << "    " << bindings[0].returnParam << " returnValue = ";
+                else
+                    o << "    void* returnPtr = (void*)new " << bindings[0].returnParam << "(";
                 if (bindings[0].classname.size() > 0)
                     o << bindings[0].classname << "::";
-                o << bindings[0].name << ");\n";
+                o << bindings[0].name << (isInlineValue(bindings[0].returnParam) ? ";\n" : ");\n");
                 break;
             case FunctionBinding::Param::KIND_REFERENCE:
                 o << "    void* returnPtr = (void*)&(";
@@ -358,13 +376,22 @@ void FunctionBinding::write(ostream& o, const vector<FunctionBinding>& bindings)
             o << "        case " << iter->first << ":\n";
             o << "        {\n";
 
-            for (unsigned int i = 0, count = iter->second.size(); i < count; i++)
+            // A single candidate is called directly, since the parameter conversions check
+            // the types. Overloads are told apart by switching on the type of the first
+            // parameter that differs between them, so each call only tests the overloads
+            // that can match.
+            const vector<const FunctionBinding*>& candidates = iter->second;
+            unsigned int dispatchIndex = candidates.size() > 1 ? getDispatchIndex(candidates, iter->first) : 0;
+            if (dispatchIndex > 0)
             {
-                // Only indent if there are parameters.
-                if (iter->first > 0)
-                    indent(o, 3);
-
-                outputMatchedBinding(o, *(iter->second[i]), iter->first, 3, bindings.size());
+                outputDispatchSwitch(o, candidates, iter->first, dispatchIndex, bindings.size());
+            }
+            else
+            {
+                for (unsigned int i = 0, count = candidates.size(); i < count; i++)
+                {
+                    outputMatchedBinding(o, *candidates[i], iter->first, 3, bindings.size(), 0, count > 1);
+                }
             }
 
             // Only print an else clause with error report if there are parameters.
@@ -491,6 +518,17 @@ static inline std::string getTypeName(const FunctionBinding::Param& param)
     }
 }
 
+static inline bool isInlineValue(const FunctionBinding::Param& param)
+{
+    // Value types returned by value (or constructed) are stored in the user data rather than on the heap.
+    if (param.type == FunctionBinding::Param::TYPE_CONSTRUCTOR ||
+        (param.type == FunctionBinding::Param::TYPE_OBJECT && param.kind == FunctionBinding::Param::KIND_VALUE))
+    {
+        return Generator::getInstance()->isValueType(param.info);
+    }
+    return false;
+}
+
 ostream& operator<<(ostream& o, const FunctionBinding::Param& param)
 {
     o << getTypeName(param);
@@ -631,7 +669,14 @@ static inline void outputBindingInvocation(ostream& o, const FunctionBinding& b,
         }
 
         // For functions that return objects, create the appropriate user data in Lua.
-        if (b.returnParam.type == FunctionBinding::Param::TYPE_CONSTRUCTOR || b.returnParam.type == FunctionBinding::Param::TYPE_OBJECT)
+        // Value types are kept in a local and copied into their user data.
+        bool inlineValue = isInlineValue(b.returnParam);
+        if (inlineValue)
+        {
+            indent(o, indentLevel);
+            o << getTypeName(b.returnParam) << " returnValue = ";
+        }
+        else if (b.returnParam.type == FunctionBinding::Param::TYPE_CONSTRUCTOR || b.returnParam.type == FunctionBinding::Param::TYPE_OBJECT)
         {
             indent(o, indentLevel);
             switch (b.returnParam.kind)
@@ -667,7 +712,9 @@ static inline void outputBindingInvocation(ostream& o, const FunctionBinding& b,
         {
             if (b.returnParam.type == FunctionBinding::Param::TYPE_CONSTRUCTOR)
             {
-                o << "new " << Generator::getInstance()->getIdentifier(b.returnParam.info) << "(";
+                if (!inlineValue)
+                    o << "new ";
+                o << Generator::getInstance()->getIdentifier(b.returnParam.info) << "(";
             }
             else
             {
@@ -689,7 +736,7 @@ static inline void outputBindingInvocation(ostream& o, const FunctionBinding& b,
         }
 
         // Output the matching parenthesis for the case where a non-pointer object is being returned.
-        if (b.returnParam.type == FunctionBinding::Param::TYPE_OBJECT && b.returnParam.kind != FunctionBinding::Param::KIND_POINTER)
+        if (b.returnParam.type == FunctionBinding::Param::TYPE_OBJECT && b.returnParam.kind != FunctionBinding::Param::KIND_POINTER && !inlineValue)
             o << ")";
 
         o << ");\n";
@@ -862,7 +909,8 @@ static inline void outputGetParam(ostream& o, const FunctionBinding::Param& p, i
     o << "\n";
 }
 
-static inline void outputMatchedBinding(ostream& o, const FunctionBinding& b, unsigned int paramCount, unsigned int indentLevel, int numBindings)
+static inline void outputMatchedBinding(ostream& o, const FunctionBinding& b, unsigned int paramCount, unsigned int indentLevel, int numBindings,
+    unsigned int dispatchIndex, bool checkTypes)
 {
     bool isNonStatic = (b.type == FunctionBinding::MEMBER_FUNCTION && b.returnParam.type != FunctionBinding::Param::TYPE_CONSTRUCTOR);
 
@@ -870,37 +918,62 @@ static inline void outputMatchedBinding(ostream& o, const FunctionBinding& b, un
     if (paramCount == 0)
     {
         outputBindingInvocation(o, b, paramCount, indentLevel, numBindings);
+        return;
     }
-    else
+
+    // NOTE: The way this currently works may cause some issues since Lua
+    // has a smaller set of types than C++. There may be cases where functions
+    // that take types with less precision (i.e. int vs. float) are called
+    // when the user in fact wanted to call the version with more precision.
+    // (this will only happen for overloaded functions).
+
+    // Gather the type checks, leaving out the parameter that was already switched on
+    // and, when there is nothing to choose between, the ones the conversions make.
+    vector<string> checks;
+    for (unsigned int i = 0; i < paramCount; i++)
     {
-        // NOTE: The way this currently works may cause some issues since Lua
-        // has a smaller set of types than C++. There may be cases where functions
-        // that take types with less precision (i.e. int vs. float) are called
-        // when the user in fact wanted to call the version with more precision.
-        // (this will only happen for overloaded functions).
+        if (i + 1 == dispatchIndex)
+            continue;
 
-        if (numBindings > 1)
+        ostringstream check;
+        if (isNonStatic && i == 0)
         {
-            o << "do\n";
-            indent(o, indentLevel);
-            o << "{\n";
-            indent(o, ++indentLevel);
+            // This is always the "this / self" pointer for a member function (checked by getInstance).
+            if (!checkTypes)
+                continue;
+            outputLuaTypeCheckInstance(check);
         }
+        else
+        {
+            // Function parameter
+            const FunctionBinding::Param& p = b.paramTypes[(isNonStatic ? i - 1 : i)];
+            if (!checkTypes && isCheckedByConversion(p))
+                continue;
+            outputLuaTypeCheck(check, i + 1, p);
+        }
+        checks.push_back(check.str());
+    }
 
+    if (numBindings > 1)
+    {
+        indent(o, indentLevel);
+        o << "do\n";
+        indent(o, indentLevel);
+        o << "{\n";
+        indentLevel++;
+    }
+
+    if (checks.empty())
+    {
+        outputBindingInvocation(o, b, paramCount, indentLevel, numBindings);
+    }
+    else
+    {
+        indent(o, indentLevel);
         o << "if (";
-        for (unsigned int i = 0, count = paramCount; i < count; i++)
+        for (unsigned int i = 0, count = checks.size(); i < count; i++)
         {
-            if (isNonStatic && i == 0)
-            {
-                // This is always the "this / self" pointer for a member function
-                outputLuaTypeCheckInstance(o);
-            }
-            else
-            {
-                // Function parameter
-                outputLuaTypeCheck(o, i + 1, b.paramTypes[(isNonStatic ? i - 1 : i)]);
-            }
-
+            o << checks[i];
             if (i == count - 1)
                 o << ")\n";
             else
@@ -911,19 +984,168 @@ static inline void outputMatchedBinding(ostream& o, const FunctionBinding& b, un
         }
         indent(o, indentLevel);
         o << "{\n";
-            
+
         outputBindingInvocation(o, b, paramCount, indentLevel + 1, numBindings);
 
         indent(o, indentLevel);
         o << "}\n";
+    }
+
+    if (numBindings > 1)
+    {
+        indent(o, --indentLevel);
+        o << "} while (0);\n";
+    }
+
+    o << "\n";
+}
 
-        if (numBindings > 1)
+static inline void outputDispatchSwitch(ostream& o, const vector<const FunctionBinding*>& candidates, unsigned int paramCount, unsigned int dispatchIndex, int numBindings)
+{
+    // Collect the candidates that accept each Lua type, keeping the order of the overloads
+    // so the first overload that matches is still the one called.
+    vector<string> types;
+    map<string, vector<const FunctionBinding*> > typeCandidates;
+    for (unsigned int i = 0, count = candidates.size(); i < count; i++)
+    {
+        vector<string> candidateTypes;
+        getLuaTypes(*candidates[i], dispatchIndex, candidateTypes);
+        for (unsigned int j = 0; j < candidateTypes.size(); j++)
         {
-            indent(o, --indentLevel);
-            o << "} while (0);\n";
+            if (typeCandidates.find(candidateTypes[j]) == typeCandidates.end())
+                types.push_back(candidateTypes[j]);
+            typeCandidates[candidateTypes[j]].push_back(candidates[i]);
         }
+    }
 
-        o << "\n";
+    indent(o, 3);
+    o << "switch (lua_type(state, " << dispatchIndex << "))\n";
+    indent(o, 3);
+    o << "{\n";
+    vector<bool> written(types.size(), false);
+    for (unsigned int i = 0, count = types.size(); i < count; i++)
+    {
+        if (written[i])
+            continue;
+
+        // Types that accept the same overloads share a case.
+        const vector<const FunctionBinding*>& matches = typeCandidates[types[i]];
+        for (unsigned int j = i; j < count; j++)
+        {
+            if (!written[j] && typeCandidates[types[j]] == matches)
+            {
+                indent(o, 4);
+                o << "case " << types[j] << ":\n";
+                written[j] = true;
+            }
+        }
+        indent(o, 4);
+        o << "{\n";
+        for (unsigned int j = 0; j < matches.size(); j++)
+        {
+            outputMatchedBinding(o, *matches[j], paramCount, 5, numBindings, dispatchIndex, matches.size() > 1);
+        }
+        indent(o, 5);
+        o << "break;\n";
+        indent(o, 4);
+        o << "}\n";
+    }
+    indent(o, 3);
+    o << "}\n\n";
+}
+
+static inline void getLuaTypes(const FunctionBinding& b, unsigned int index, vector<string>& types)
+{
+    // Mirrors the checks made by outputLuaTypeCheckInstance and outputLuaTypeCheck.
+    bool isNonStatic = (b.type == FunctionBinding::MEMBER_FUNCTION && b.returnParam.type != FunctionBinding::Param::TYPE_CONSTRUCTOR);
+    if (isNonStatic && index == 1)
+    {
+        types.push_back("LUA_TUSERDATA");
+        return;
+    }
+
+    const FunctionBinding::Param& p = b.paramTypes[isNonStatic ? index - 2 : index - 1];
+    switch (p.type)
+    {
+    case FunctionBinding::Param::TYPE_BOOL:
+    case FunctionBinding::Param::TYPE_CHAR:
+    case FunctionBinding::Param::TYPE_SHORT:
+    case FunctionBinding::Param::TYPE_INT:
+    case FunctionBinding::Param::TYPE_LONG:
+    case FunctionBinding::Param::TYPE_UCHAR:
+    case FunctionBinding::Param::TYPE_USHORT:
+    case FunctionBinding::Param::TYPE_UINT:
+    case FunctionBinding::Param::TYPE_ULONG:
+    case FunctionBinding::Param::TYPE_FLOAT:
+    case FunctionBinding::Param::TYPE_DOUBLE:
+        if (p.kind == FunctionBinding::Param::KIND_POINTER)
+        {
+            types.push_back("LUA_TTABLE");
+            types.push_back("LUA_TLIGHTUSERDATA");
+        }
+        else
+        {
+            types.push_back(p.type == FunctionBinding::Param::TYPE_BOOL ? "LUA_TBOOLEAN" : "LUA_TNUMBER");
+        }
+        break;
+    case FunctionBinding::Param::TYPE_STRING:
+    case FunctionBinding::Param::TYPE_ENUM:
+        types.push_back("LUA_TSTRING");
+        types.push_back("LUA_TNIL");
+        break;
+    case FunctionBinding::Param::TYPE_OBJECT:
+        types.push_back("LUA_TUSERDATA");
+        if (p.kind == FunctionBinding::Param::KIND_POINTER)
+            types.push_back("LUA_TTABLE");
+        types.push_back("LUA_TNIL");
+        break;
+    default:
+        types.push_back("LUA_TNONE");
+        break;
+    }
+}
+
+static inline unsigned int getDispatchIndex(const vector<const FunctionBinding*>& candidates, unsigned int paramCount)
+{
+    // Find the first parameter whose accepted types differ between the candidates.
+    for (unsigned int index = 1; index <= paramCount; index++)
+    {
+        vector<string> firstTypes;
+        getLuaTypes(*candidates[0], index, firstTypes);
+        for (unsigned int i = 1, count = candidates.size(); i < count; i++)
+        {
+            vector<string> types;
+            getLuaTypes(*candidates[i], index, types);
+            if (types != firstTypes)
+                return index;
+        }
+    }
+    return 0;
+}
+
+static inline bool isCheckedByConversion(const FunctionBinding::Param& p)
+{
+    // These parameters are fetched with luaL_check* functions or getObjectPointer,
+    // which fail on values of the wrong type.
+    switch (p.type)
+    {
+    case FunctionBinding::Param::TYPE_BOOL:
+    case FunctionBinding::Param::TYPE_CHAR:
+    case FunctionBinding::Param::TYPE_SHORT:
+    case FunctionBinding::Param::TYPE_INT:
+    case FunctionBinding::Param::TYPE_LONG:
+    case FunctionBinding::Param::TYPE_UCHAR:
+    case FunctionBinding::Param::TYPE_USHORT:
+    case FunctionBinding::Param::TYPE_UINT:
+    case FunctionBinding::Param::TYPE_ULONG:
+    case FunctionBinding::Param::TYPE_FLOAT:
+    case FunctionBinding::Param::TYPE_DOUBLE:
+        return p.kind != FunctionBinding::Param::KIND_POINTER;
+    case FunctionBinding::Param::TYPE_ENUM:
+    case FunctionBinding::Param::TYPE_OBJECT:
+        return true;
+    default:
+        return false;
     }
 }
 
@@ -988,24 +1210,21 @@ static inline void outputReturnValue(ostream& o, const FunctionBinding& b, int i
         break;
     case FunctionBinding::Param::TYPE_OBJECT:
     case FunctionBinding::Param::TYPE_CONSTRUCTOR:
+        if (isInlineValue(b.returnParam))
+        {
+            o << "gameplay::ScriptUtil::pushValue(state, returnValue, \"" << Generator::getInstance()->getUniqueNameFromRef(b.returnParam.info) << "\");\n";
+            break;
+        }
         o << "if (returnPtr)\n";
         indent(o, indentLevel);
         o << "{\n";
         indent(o, indentLevel + 1);
-        o << LUA_OBJECT << "* object = (" << LUA_OBJECT << "*)lua_newuserdata(state, sizeof(" << LUA_OBJECT << "));\n";
-        indent(o, indentLevel + 1);
-        o << "object->instance = returnPtr;\n";
-        indent(o, indentLevel + 1);
-        o << "object->owns = ";
+        o << "gameplay::ScriptUtil::pushObject(state, returnPtr, \"" << Generator::getInstance()->getUniqueNameFromRef(b.returnParam.info) << "\", ";
         if (b.own || (b.returnParam.type == FunctionBinding::Param::TYPE_OBJECT && b.returnParam.kind == FunctionBinding::Param::KIND_VALUE))
             o << "true";
         else
             o << "false";
-        o << ";\n";
-        indent(o, indentLevel + 1);
-        o << "luaL_getmetatable(state, \"" << Generator::getInstance()->getUniqueNameFromRef(b.returnParam.info) << "\");\n";
-        indent(o, indentLevel + 1);
-        o << "lua_setmetatable(state, -2);\n";
+        o << ");\n";
         indent(o, indentLevel);
         o << "}\n";
         indent(o, indentLevel);
@@ -142,6 +142,11 @@ bool Generator::isRef(string classname)
     return classname == REF_CLASS_NAME;
 }
 
+bool Generator::isValueType(string refId)
+{
+    return _valueTypes.find(refId) != _valueTypes.end();
+}
+
 string Generator::getCompoundName(XMLElement* node)
 {
     // Get the name of the namespace, class, struct, or file that we are processing.
@@ -421,9 +426,14 @@ void Generator::getClass(XMLElement* classNode, const string& name)
     Generator::getInstance()->setIdentifier(refId, classBinding.classname);
 
     // Check if we should ignore this class.
-    if (getScriptFlag(classNode) == "ignore")
+    string flag = getScriptFlag(classNode);
+    if (flag == "ignore")
         return;
 
+    // Value types are returned to Lua by copy, inline in the userdata.
+    if (flag == "value")
+        _valueTypes.insert(refId);
+
     // Get the include header for the original class declaration.
     XMLElement* includeElement = classNode->FirstChildElement("includes");
     if (includeElement)
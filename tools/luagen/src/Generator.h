@@ -100,6 +100,15 @@ public:
      */
     bool isRef(string classname);
 
+    /**
+     * Retrieves whether the given class is a value type (marked with @script{value}),
+     * which is copied into its Lua userdata instead of being allocated on the heap.
+     * 
+     * @param refId The reference ID for the class (generated by Doxygen).
+     * @return True if the class is a value type; false otherwise.
+     */
+    bool isValueType(string refId);
+
 protected:
     /**
      * Constructor.
@@ -201,6 +210,7 @@ private:
     map<string, EnumBinding> _enums;
     map<string, set<string> > _namespaces;
     map<string, TypedefBinding> _typedefs;
+    set<string> _valueTypes;
     set<string> __warnings;
 };
 